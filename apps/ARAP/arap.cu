@@ -1,4 +1,5 @@
 #include "rxmesh/matrix/cholesky_solver.h"
+#include "rxmesh/matrix/element_assembler.h"
 #include "rxmesh/matrix/gmg_solver.h"
 #include "rxmesh/matrix/sparse_matrix.h"
 #include "rxmesh/query.cuh"
@@ -22,6 +23,15 @@ void calc_edge_weights_mat(const RXMeshStatic&       rx,
                            const VertexAttribute<T>& ref_vertex_pos,
                            SparseMatrix<T>&          weight_matrix)
 {
+    // every edge writes its (symmetric) weight into its own 2x2 block and the
+    // blocks are then gathered into the matrix, i.e., no column search per
+    // write. The assembler map could be kept around if the weights are
+    // recomputed
+    ElementAssembler<T, Op::EV> assembler(rx, weight_matrix);
+
+    DenseMatrix<T> edge_weights = assembler.create_element_values(rx);
+    edge_weights.reset(T(0), DEVICE);
+
     rx.run_query_kernel<Op::EVDiamond, 256>(
         [=] __device__(const EdgeHandle      edge_id,
                        const VertexIterator& vv) mutable {
@@ -55,132 +65,121 @@ void calc_edge_weights_mat(const RXMeshStatic&       rx,
             weight /= 2;
             weight = std::max(0.f, weight);
 
-            weight_matrix(p_id, r_id) = weight;
-            weight_matrix(r_id, p_id) = weight;
+            // the off-diagonal entries of the edge block
+            edge_weights(edge_id, 1) = weight;
+            edge_weights(edge_id, 2) = weight;
         });
+
+    assembler.assemble(edge_weights, weight_matrix);
+
+    edge_weights.release();
+    assembler.release();
 }
 
 
+/**
+ * @brief the ARAP local step fused with the assembly of the right-hand side of
+ * the global step. Every vertex i computes its rotation R_i from the
+ * covariance of its one-ring and directly scatters the R_i part of
+ * 0.5 * w_ij * (R_i + R_j) * (p_i - p_j) to b_i and b_j, so the rotations are
+ * never written to (or read back from) global memory and one VV pass replaces
+ * the rotation pass and the RHS pass. b_mat is reset here
+ */
 template <typename T>
-void calculate_rotation_matrix(const RXMeshStatic&       rx,
-                               const VertexAttribute<T>& ref_vertex_pos,
-                               const VertexAttribute<T>& deformed_vertex_pos,
-                               const SparseMatrix<T>&    weight_matrix,
-                               VertexAttribute<T>&       rotations)
+void arap_local_step(const RXMeshStatic&                  rx,
+                     const VertexAttribute<T>&            ref_vertex_pos,
+                     const VertexAttribute<T>&            deformed_vertex_pos,
+                     const SparseMatrix<T>&               weight_matrix,
+                     const VertexAttribute<ConstraintsT>& constraints,
+                     DenseMatrix<T>&                      b_mat,
+                     cudaStream_t                         stream = NULL)
 {
-    rx.run_query_kernel<Op::VV, 256>([=] __device__(const VertexHandle    v_id,
-                                                    const VertexIterator& vv) {
-        Eigen::Matrix3f S = Eigen::Matrix3f::Zero();
-
-        for (int j = 0; j < vv.size(); j++) {
+    b_mat.reset(0, DEVICE, stream);
 
-            float w = weight_matrix(v_id, vv[j]);
-
-            Eigen::Vector<float, 3> pi_vector = {
-                ref_vertex_pos(v_id, 0) - ref_vertex_pos(vv[j], 0),
-                ref_vertex_pos(v_id, 1) - ref_vertex_pos(vv[j], 1),
-                ref_vertex_pos(v_id, 2) - ref_vertex_pos(vv[j], 2)};
+    rx.run_query_kernel<Op::VV, 256>(
+        [=] __device__(const VertexHandle    v_id,
+                       const VertexIterator& vv) mutable {
+            const bool v_free = constraints(v_id) == Free;
 
+            if (!v_free) {
+                // the constrained vertices only keep their (deformed) position
+                for (int j = 0; j < 3; ++j) {
+                    ::atomicAdd(&b_mat(v_id, j), deformed_vertex_pos(v_id, j));
+                }
+                return;
+            }
 
-            Eigen::Vector<float, 3> pi_dash_vector = {
-                deformed_vertex_pos(v_id, 0) - deformed_vertex_pos(vv[j], 0),
-                deformed_vertex_pos(v_id, 1) - deformed_vertex_pos(vv[j], 1),
-                deformed_vertex_pos(v_id, 2) - deformed_vertex_pos(vv[j], 2)};
+            const Eigen::Vector3f pi(ref_vertex_pos(v_id, 0),
+                                     ref_vertex_pos(v_id, 1),
+                                     ref_vertex_pos(v_id, 2));
+            const Eigen::Vector3f pi_dash(deformed_vertex_pos(v_id, 0),
+                                          deformed_vertex_pos(v_id, 1),
+                                          deformed_vertex_pos(v_id, 2));
 
-            S = S + w * pi_vector * pi_dash_vector.transpose();
-        }
+            // covariance
+            Eigen::Matrix3f S = Eigen::Matrix3f::Zero();
 
-        Eigen::Matrix3f U;         // left singular vectors
-        Eigen::Matrix3f V;         // right singular vectors
-        Eigen::Vector3f sing_val;  // singular values
+            for (int i = 0; i < vv.size(); i++) {
+                const float w = weight_matrix(v_id, vv[i]);
 
-        svd(S, U, sing_val, V);
+                const Eigen::Vector3f pj(ref_vertex_pos(vv[i], 0),
+                                         ref_vertex_pos(vv[i], 1),
+                                         ref_vertex_pos(vv[i], 2));
+                const Eigen::Vector3f pj_dash(deformed_vertex_pos(vv[i], 0),
+                                              deformed_vertex_pos(vv[i], 1),
+                                              deformed_vertex_pos(vv[i], 2));
 
-        const float smallest_singular_value = sing_val.minCoeff();
+                S += w * (pi - pj) * (pi_dash - pj_dash).transpose();
+            }
 
+            // rotation
+            Eigen::Matrix3f U;         // left singular vectors
+            Eigen::Matrix3f V;         // right singular vectors
+            Eigen::Vector3f sing_val;  // singular values
 
-        Eigen::Matrix3f R = V * U.transpose();
+            svd(S, U, sing_val, V);
 
-        if (R.determinant() < 0) {
-            U.col(smallest_singular_value) =
-                U.col(smallest_singular_value) * -1;
-            R = V * U.transpose();
-        }
+            Eigen::Matrix3f R = V * U.transpose();
 
-        // Matrix R to vector attribute R
-        for (int i = 0; i < 3; i++) {
-            for (int j = 0; j < 3; j++) {
-                rotations(v_id, i * 3 + j) = R(i, j);
+            if (R.determinant() < 0) {
+                int smallest;
+                sing_val.minCoeff(&smallest);
+                U.col(smallest) = U.col(smallest) * -1;
+                R               = V * U.transpose();
             }
-        }
-    });
-}
 
-template <typename T>
-void calculate_b(const RXMeshStatic&                  rx,
-                 const VertexAttribute<T>&            ref_vertex_pos,
-                 const VertexAttribute<T>&            deformed_vertex_pos,
-                 const VertexAttribute<T>&            rotations,
-                 const SparseMatrix<T>&               weight_matrix,
-                 const VertexAttribute<ConstraintsT>& constraints,
-                 DenseMatrix<T>&                      b_mat)
-{
-    rx.run_query_kernel<Op::VV, 256>([=] __device__(
-                                         const VertexHandle    v_id,
-                                         const VertexIterator& vv) mutable {
-        if (constraints(v_id) == Free) {
-            // variable to store ith entry of b_mat
+            // scatter the rotation contribution of this vertex to the RHS
             Eigen::Vector3f bi(0.0f, 0.0f, 0.0f);
 
-            // get rotation matrix for ith vertex
-            Eigen::Matrix3f Ri = Eigen::Matrix3f::Zero(3, 3);
+            for (int i = 0; i < vv.size(); i++) {
+                const float w = weight_matrix(v_id, vv[i]);
 
-            for (int i = 0; i < 3; i++) {
-                for (int j = 0; j < 3; j++)
-                    Ri(i, j) = rotations(v_id, i * 3 + j);
-            }
+                const Eigen::Vector3f pj(ref_vertex_pos(vv[i], 0),
+                                         ref_vertex_pos(vv[i], 1),
+                                         ref_vertex_pos(vv[i], 2));
 
-            for (int i = 0; i < vv.size(); i++) {
-                // get rotation matrix for neightbor j
-                Eigen::Matrix3f Rj = Eigen::Matrix3f::Zero(3, 3);
-                for (int i = 0; i < 3; i++)
-                    for (int j = 0; j < 3; j++)
-                        Rj(i, j) = rotations(vv[i], i * 3 + j);
-
-                // find rotation addition
-                Eigen::Matrix3f rot_add = Ri + Rj;
-                // find coord difference
-                Eigen::Vector3f vert_diff = {
-                    ref_vertex_pos(v_id, 0) - ref_vertex_pos(vv[i], 0),
-                    ref_vertex_pos(v_id, 1) - ref_vertex_pos(vv[i], 1),
-                    ref_vertex_pos(v_id, 2) - ref_vertex_pos(vv[i], 2)};
-
-                // update bi
-                bi =
-                    bi + 0.5 * weight_matrix(v_id, vv[i]) * rot_add * vert_diff;
-            }
+                const Eigen::Vector3f r = 0.5f * w * R * (pi - pj);
 
+                bi += r;
 
-            // fix the b due to eliminating the constrained vertices
-            for (int i = 0; i < vv.size(); i++) {
-                if (constraints(vv[i]) != Free) {
-                    T w = -weight_matrix(v_id, vv[i]);
+                if (constraints(vv[i]) == Free) {
+                    for (int j = 0; j < 3; ++j) {
+                        ::atomicAdd(&b_mat(vv[i], j), -r[j]);
+                    }
+                } else {
+                    // fix the b due to eliminating the constrained vertices
                     for (int j = 0; j < 3; ++j) {
-                        bi[j] -= w * deformed_vertex_pos(vv[i], j);
+                        bi[j] += w * deformed_vertex_pos(vv[i], j);
                     }
                 }
             }
 
             for (int j = 0; j < 3; ++j) {
-                b_mat(v_id, j) = bi[j];
-            }
-
-        } else {
-            for (int j = 0; j < 3; ++j) {
-                b_mat(v_id, j) = deformed_vertex_pos(v_id, j);
+                ::atomicAdd(&b_mat(v_id, j), bi[j]);
             }
-        }
-    });
+        },
+        false,
+        stream);
 }
 
 
@@ -279,9 +278,6 @@ int main(int argc, char** argv)
     SparseMatrix<float> laplace_mat(rx);
     laplace_mat.reset(0.f, LOCATION_ALL);
 
-    // rotation matrix as a very attribute where every vertex has 3x3 matrix
-    auto rotations = *rx.add_vertex_attribute<float>("RotationMatrix", 9);
-
     // b-matrix
     DenseMatrix<float> b_mat(rx, rx.get_num_vertices(), 3);
     b_mat.reset(0.f, LOCATION_ALL);
@@ -366,26 +362,33 @@ int main(int argc, char** argv)
 
 
         // process step
+        gtimer.start();
         for (int i = 0; i < iterations; i++) {
-            // solver for rotation
-            calculate_rotation_matrix(rx,
-                                      ref_vertex_pos,
-                                      deformed_vertex_pos,
-                                      weight_matrix,
-                                      rotations);
-
-
-            // solve for position
-            calculate_b(rx,
-                        ref_vertex_pos,
-                        deformed_vertex_pos,
-                        rotations,
-                        weight_matrix,
-                        constraints,
-                        b_mat);
-
+            // solve for rotations and assemble the RHS in one pass
+            arap_local_step(rx,
+                            ref_vertex_pos,
+                            deformed_vertex_pos,
+                            weight_matrix,
+                            constraints,
+                            b_mat);
+
+            // solve for position (reusing the factorization from pre_solve)
             solver.solve(b_mat, deformed_vertex_pos_mat);
+
+            // the next local step reads the new positions on the device
+            rx.for_each_vertex(
+                DEVICE, [=] __device__(const VertexHandle& vh) mutable {
+                    for (int j = 0; j < 3; ++j) {
+                        deformed_vertex_pos(vh, j) =
+                            deformed_vertex_pos_mat(vh, j);
+                    }
+                });
         }
+        gtimer.stop();
+
+        RXMESH_INFO("ARAP: {} iterations took {} (ms)",
+                    iterations,
+                    gtimer.elapsed_millis());
 
         // move mat to the host
         deformed_vertex_pos_mat.move(DEVICE, HOST);
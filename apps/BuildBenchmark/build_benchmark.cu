@@ -0,0 +1,147 @@
+// Measure the time to construct RXMesh (host build, patching, and device
+// allocation) versus the number of OpenMP threads used by the host build
+
+#include <omp.h>
+
+#include "gtest/gtest.h"
+#include "rxmesh/rxmesh_static.h"
+#include "rxmesh/util/import_mesh.h"
+#include "rxmesh/util/report.h"
+#include "rxmesh/util/timer.h"
+
+struct arg
+{
+    std::string obj_file_name = STRINGIFY(INPUT_DIR) "sphere3.obj";
+    std::string output_folder = STRINGIFY(OUTPUT_DIR);
+    uint32_t    num_run       = 5;
+    uint32_t    patch_size    = 512;
+    uint32_t    device_id     = 0;
+    char**      argv;
+    int         argc;
+} Arg;
+
+TEST(Apps, BuildBenchmark)
+{
+    using namespace rxmesh;
+
+    // Select device
+    cuda_query(Arg.device_id);
+
+    // Load mesh
+    std::vector<float>    verts;
+    std::vector<uint32_t> faces;
+    std::vector<uint32_t> face_offset;
+
+    ASSERT_TRUE(import_mesh(Arg.obj_file_name, verts, faces, face_offset));
+    ASSERT_TRUE(face_offset.empty()) << "Input mesh should be triangle mesh";
+
+    const uint32_t num_faces = static_cast<uint32_t>(faces.size() / 3);
+
+    Report report("BuildBenchmark");
+    report.command_line(Arg.argc, Arg.argv);
+    report.device();
+    report.system();
+    report.add_member("model_name", extract_file_name(Arg.obj_file_name));
+    report.add_member("num_faces", num_faces);
+    report.add_member("patch_size", Arg.patch_size);
+
+    const int max_num_threads = omp_get_max_threads();
+    report.add_member("max_num_threads", max_num_threads);
+
+    // powers of two up to (and including) the max number of threads
+    std::vector<int> num_threads;
+    for (int t = 1; t < max_num_threads; t *= 2) {
+        num_threads.push_back(t);
+    }
+    num_threads.push_back(max_num_threads);
+
+    for (int t : num_threads) {
+        omp_set_num_threads(t);
+
+        TestData td;
+        td.test_name   = "Build_" + std::to_string(t) + "_threads";
+        td.num_threads = t;
+
+        for (uint32_t itr = 0; itr < Arg.num_run; ++itr) {
+            CPUTimer timer;
+            timer.start();
+            RXMeshStatic rx(faces.data(), num_faces, "", Arg.patch_size);
+            CUDA_ERROR(cudaDeviceSynchronize());
+            timer.stop();
+
+            td.time_ms.push_back(timer.elapsed_millis());
+            td.passed.push_back(rx.get_num_faces() == num_faces);
+        }
+
+        float sum = 0;
+        for (float ms : td.time_ms) {
+            sum += ms;
+        }
+        RXMESH_INFO("BuildBenchmark: #threads = {}, build time = {} (ms)",
+                    t,
+                    sum / float(td.time_ms.size()));
+
+        report.add_test(td);
+    }
+
+    omp_set_num_threads(max_num_threads);
+
+    report.write(Arg.output_folder + "/rxmesh",
+                 "BuildBenchmark_" + extract_file_name(Arg.obj_file_name));
+}
+
+int main(int argc, char** argv)
+{
+    using namespace rxmesh;
+    Log::init();
+
+    ::testing::InitGoogleTest(&argc, argv);
+    Arg.argv = argv;
+    Arg.argc = argc;
+
+    if (argc > 1) {
+        if (cmd_option_exists(argv, argc + argv, "-h")) {
+            // clang-format off
+            RXMESH_INFO("\nUsage: BuildBenchmark.exe < -option X>\n"
+                        " -h:          Display this massage and exit\n"
+                        " -input:      Input OBJ/PLY mesh file. Default is {} \n"
+                        " -o:          JSON file output folder. Default is {} \n"
+                        " -num_run:    Number of builds per thread count. Default is {} \n"
+                        " -patch_size: Patch size. Default is {} \n"
+                        " -device_id:  GPU device ID. Default is {}",
+            Arg.obj_file_name, Arg.output_folder, Arg.num_run, Arg.patch_size, Arg.device_id);
+            // clang-format on
+            exit(EXIT_SUCCESS);
+        }
+
+        if (cmd_option_exists(argv, argc + argv, "-num_run")) {
+            Arg.num_run = atoi(get_cmd_option(argv, argv + argc, "-num_run"));
+        }
+
+        if (cmd_option_exists(argv, argc + argv, "-patch_size")) {
+            Arg.patch_size =
+                atoi(get_cmd_option(argv, argv + argc, "-patch_size"));
+        }
+
+        if (cmd_option_exists(argv, argc + argv, "-input")) {
+            Arg.obj_file_name =
+                std::string(get_cmd_option(argv, argv + argc, "-input"));
+        }
+        if (cmd_option_exists(argv, argc + argv, "-o")) {
+            Arg.output_folder =
+                std::string(get_cmd_option(argv, argv + argc, "-o"));
+        }
+        if (cmd_option_exists(argv, argc + argv, "-device_id")) {
+            Arg.device_id =
+                atoi(get_cmd_option(argv, argv + argc, "-device_id"));
+        }
+    }
+
+    RXMESH_TRACE("input= {}", Arg.obj_file_name);
+    RXMESH_TRACE("output_folder= {}", Arg.output_folder);
+    RXMESH_TRACE("num_run= {}", Arg.num_run);
+    RXMESH_TRACE("patch_size= {}", Arg.patch_size);
+    RXMESH_TRACE("device_id= {}", Arg.device_id);
+
+    return RUN_ALL_TESTS();
+}
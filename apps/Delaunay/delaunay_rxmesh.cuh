@@ -1,7 +1,6 @@
 #include <cuda_profiler_api.h>
 #include <glm/glm.hpp>
-#include "rxmesh/cavity_manager.cuh"
-#include "rxmesh/query.cuh"
+#include "rxmesh/algo/make_delaunay.cuh"
 #include "rxmesh/rxmesh_dynamic.h"
 #include "rxmesh/util/report.h"
 
@@ -11,188 +10,6 @@
 
 #include "mcf_rxmesh.h"
 
-template <typename T, uint32_t blockThreads>
-__global__ static void __launch_bounds__(blockThreads)
-    delaunay_edge_flip(rxmesh::Context            context,
-                       rxmesh::VertexAttribute<T> coords,
-                       int*                       d_flipped)
-{
-    using namespace rxmesh;
-    using vec3           = glm::vec<3, T, glm::defaultp>;
-    auto           block = cooperative_groups::this_thread_block();
-    ShmemAllocator shrd_alloc;
-    CavityManager<blockThreads, CavityOp::E> cavity(
-        block, context, shrd_alloc, false);
-
-    const uint32_t pid = cavity.patch_id();
-
-    if (pid == INVALID32) {
-        return;
-    }
-
-    uint32_t shmem_before = shrd_alloc.get_allocated_size_bytes();
-
-    // for each edge we want to flip, we its id in one of its opposite vertices
-    // along with the other opposite vertex
-    uint16_t* v_info =
-        shrd_alloc.alloc<uint16_t>(2 * cavity.patch_info().num_vertices[0]);
-    fill_n<blockThreads>(
-        v_info, 2 * cavity.patch_info().num_vertices[0], uint16_t(INVALID16));
-
-    // a bitmask that indicates which edge we want to flip
-    Bitmask e_flip(cavity.patch_info().num_edges[0], shrd_alloc);
-    e_flip.reset(block);
-
-    // edge diamond query to and calc delaunay condition
-    auto is_delaunay = [&](const EdgeHandle& eh, const VertexIterator& iter) {
-        // iter[0] and iter[2] are the edge two vertices
-        // iter[1] and iter[3] are the two opposite vertices
-
-        auto v0 = iter[0];
-        auto v1 = iter[2];
-
-        auto v2 = iter[1];
-        auto v3 = iter[3];
-
-
-        // if not a boundary edge
-        if (v2.is_valid() && v3.is_valid()) {
-
-            if (v0 == v1 || v0 == v2 || v0 == v3 || v1 == v2 || v1 == v3 ||
-                v2 == v3) {
-                return;
-            }
-
-            if (coords(v0, 2) < 40 && coords(v1, 2) < 40 &&
-                coords(v2, 2) < 40 && coords(v3, 2) < 40) {
-                return;
-            }
-
-            constexpr T PII = 3.14159265358979323f;
-
-            const vec3 V0 = coords.to_glm<3>(v0);
-            const vec3 V1 = coords.to_glm<3>(v1);
-            const vec3 V2 = coords.to_glm<3>(v2);
-            const vec3 V3 = coords.to_glm<3>(v3);
-
-            // find the angle between S, M, Q vertices (i.e., angle at M)
-            auto angle_between_three_vertices = [](const vec3& S,
-                                                   const vec3& M,
-                                                   const vec3& Q) {
-                vec3 p1      = S - M;
-                vec3 p2      = Q - M;
-                T    dot_pro = glm::dot(p1, p2);
-                if constexpr (std::is_same_v<T, float>) {
-                    return acosf(dot_pro / (glm::length(p1) * glm::length(p2)));
-                } else {
-                    return acos(dot_pro / (glm::length(p1) * glm::length(p2)));
-                }
-            };
-
-            // first check if the edge formed by v0-v1 is a delaunay edge
-            // where v2 and v3 are the opposite vertices to the edge
-            /*
-                0
-              / | \
-             3  |  2
-             \  |  /
-                1
-            */
-            // if not delaunay, then we check if flipping it won't create a
-            // foldover The case below would create a fold over
-            /*
-                  0
-                / | \
-               /  1  \
-              / /  \  \
-              2       3
-            */
-
-
-            T lambda = angle_between_three_vertices(V0, V2, V1);
-            T gamma  = angle_between_three_vertices(V0, V3, V1);
-
-            if (lambda + gamma > PII + std::numeric_limits<T>::epsilon()) {
-                // check if flipping won't create foldover
-
-                const T alpha0 = angle_between_three_vertices(V3, V0, V1);
-                const T beta0  = angle_between_three_vertices(V2, V0, V1);
-
-                const T alpha1 = angle_between_three_vertices(V3, V1, V0);
-                const T beta1  = angle_between_three_vertices(V2, V1, V0);
-
-                if (alpha0 + beta0 < PII - std::numeric_limits<T>::epsilon() &&
-                    alpha1 + beta1 < PII - std::numeric_limits<T>::epsilon()) {
-                    // cavity.create(eh);
-                    e_flip.set(eh.local_id(), true);
-                }
-            }
-        }
-    };
-
-    // 1. mark edge that we want to flip
-    Query<blockThreads> query(context, pid);
-    query.dispatch<Op::EVDiamond>(block, shrd_alloc, is_delaunay);
-    block.sync();
-
-    // 2. make sure that the two vertices opposite to a flipped edge are not
-    // connected
-    auto check_edges = [&](const VertexHandle& vh, const VertexIterator& iter) {
-        uint16_t opposite_v = v_info[2 * vh.local_id()];
-        if (opposite_v != INVALID16) {
-            bool is_valid = true;
-            for (uint16_t v = 0; v < iter.size(); ++v) {
-                if (iter.local(v) == opposite_v) {
-                    is_valid = false;
-                    break;
-                }
-            }
-            if (!is_valid) {
-                e_flip.reset(v_info[2 * vh.local_id() + 1], true);
-            }
-        }
-    };
-    query.dispatch<Op::VV>(block, shrd_alloc, check_edges);
-    block.sync();
-
-    // 3. create cavity for the surviving edges
-    for_each_edge(cavity.patch_info(), [&](EdgeHandle eh) {
-        if (e_flip(eh.local_id())) {
-            cavity.create(eh);
-        }
-    });
-    block.sync();
-
-    shrd_alloc.dealloc(shrd_alloc.get_allocated_size_bytes() - shmem_before);
-
-    // create cavities
-    if (cavity.prologue(block, shrd_alloc, coords)) {
-
-        cavity.for_each_cavity(block, [&](uint16_t c, uint16_t size) {
-            assert(size == 4);
-
-            DEdgeHandle new_edge = cavity.add_edge(
-                cavity.get_cavity_vertex(c, 1), cavity.get_cavity_vertex(c, 3));
-
-            if (new_edge.is_valid()) {
-                cavity.add_face(cavity.get_cavity_edge(c, 0),
-                                new_edge,
-                                cavity.get_cavity_edge(c, 3));
-
-
-                cavity.add_face(cavity.get_cavity_edge(c, 1),
-                                cavity.get_cavity_edge(c, 2),
-                                new_edge.get_flip_dedge());
-            }
-
-            d_flipped[0] = 1;
-        });
-    }
-
-    cavity.epilogue(block);
-}
-
-
 inline uint32_t count_non_delaunay_edges(TriMesh& mesh)
 {
     // verify that mesh is a delaunay mesh
@@ -287,18 +104,9 @@ inline void delaunay_rxmesh(rxmesh::RXMeshDynamic& rx,
 
     EXPECT_TRUE(rx.validate());
 
-    int* d_flipped = nullptr;
-    CUDA_ERROR(cudaMalloc((void**)&d_flipped, sizeof(int)));
-
-    int h_flipped  = 1;
-    int outer_iter = 0;
-
     Timers<GPUTimer> timers;
 
     timers.add("Total");
-    timers.add("App");
-    timers.add("Slice");
-    timers.add("Cleanup");
 
     RXMESH_INFO("Input mesh #Vertices {}", rx.get_num_vertices());
     RXMESH_INFO("Input mesh #Edges {}", rx.get_num_edges());
@@ -307,75 +115,8 @@ inline void delaunay_rxmesh(rxmesh::RXMeshDynamic& rx,
 
     CUDA_ERROR(cudaProfilerStart());
 
-    LaunchBox<blockThreads> launch_box;
-    rx.prepare_launch_box({Op::EVDiamond, Op::VV},
-                          launch_box,
-                          (void*)delaunay_edge_flip<float, blockThreads>,
-                          true,
-                          false,
-                          false,
-                          false,
-                          [&](uint32_t v, uint32_t e, uint32_t f) {
-                              return detail::mask_num_bytes(e) +
-                                     2 * v * sizeof(uint16_t) +
-                                     2 * ShmemAllocator::default_alignment;
-                          });
-
     timers.start("Total");
-
-    int id = 1;
-
-    auto render = [&]() {
-        polyscope::removeAllStructures();
-        rx.update_host();
-        coords->move(DEVICE, HOST);
-
-        rx.update_polyscope();
-        rx.get_polyscope_mesh()->updateVertexPositions(*coords);
-        rx.get_polyscope_mesh()->setEdgeWidth(0.2);
-        rx.get_polyscope_mesh()->setSurfaceColor(glm::vec3(1.0, 1.0, 1.0));
-        // if (id == 1) {
-        polyscope::show();
-        //}
-
-        std::ostringstream oss;
-        oss << std::setw(3) << std::setfill('0') << id;
-
-        id++;
-        polyscope::screenshot("flip_" + oss.str() + ".png");
-    };
-
-
-    while (h_flipped != 0) {
-        CUDA_ERROR(cudaMemset(d_flipped, 0, sizeof(int)));
-
-        h_flipped = 0;
-        rx.reset_scheduler();
-        int inner_iter = 0;
-        while (!rx.is_queue_empty()) {
-
-            timers.start("App");
-            delaunay_edge_flip<float, blockThreads>
-                <<<launch_box.blocks,
-                   launch_box.num_threads,
-                   launch_box.smem_bytes_dyn>>>(
-                    rx.get_context(), *coords, d_flipped);
-            timers.stop("App");
-
-            // timers.start("Slice");
-            // rx.slice_patches(*coords);
-            // timers.stop("Slice");
-
-            timers.start("Cleanup");
-            rx.cleanup();
-            timers.stop("Cleanup");
-        }
-        render();
-        CUDA_ERROR(cudaMemcpy(
-            &h_flipped, d_flipped, sizeof(int), cudaMemcpyDeviceToHost));
-        // break;
-        outer_iter++;
-    }
+    DelaunayStats stats = make_delaunay<float, blockThreads>(rx, *coords);
     timers.stop("Total");
 
     CUDA_ERROR(cudaDeviceSynchronize());
@@ -384,24 +125,16 @@ inline void delaunay_rxmesh(rxmesh::RXMeshDynamic& rx,
 
     RXMESH_INFO("delaunay_rxmesh() RXMesh Delaunay Edge Flip took {} (ms)",
                 timers.elapsed_millis("Total"));
-    RXMESH_INFO("delaunay_rxmesh() App time {} (ms)",
-                timers.elapsed_millis("App"));
-    RXMESH_INFO("delaunay_rxmesh() Slice timer {} (ms)",
-                timers.elapsed_millis("Slice"));
-    RXMESH_INFO("delaunay_rxmesh() Cleanup timer {} (ms)",
-                timers.elapsed_millis("Cleanup"));
-
+    RXMESH_INFO("delaunay_rxmesh() #flips= {}, #rounds= {}",
+                stats.num_flips,
+                stats.num_rounds);
 
     rx.update_host();
 
     report.add_member("delaunay_edge_flip_time",
                       timers.elapsed_millis("Total"));
-    report.add_member("delaunay_edge_flip_app_time",
-                      timers.elapsed_millis("App"));
-    report.add_member("delaunay_edge_flip_slice_time",
-                      timers.elapsed_millis("Slice"));
-    report.add_member("delaunay_edge_flip_cleanup_time",
-                      timers.elapsed_millis("Cleanup"));
+    report.add_member("delaunay_num_flips", stats.num_flips);
+    report.add_member("delaunay_num_rounds", stats.num_rounds);
 
     report.model_data(Arg.obj_file_name + "_after", rx, "model_after");
 
@@ -458,8 +191,6 @@ inline void delaunay_rxmesh(rxmesh::RXMeshDynamic& rx,
     // polyscope::show();
 #endif
 
-    CUDA_ERROR(cudaFree(d_flipped));
-
     report.write(Arg.output_folder + "/rxmesh_delaunay",
                  "Delaunay_RXMesh_" + extract_file_name(Arg.obj_file_name));
 }
\ No newline at end of file
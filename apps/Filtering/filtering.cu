@@ -17,6 +17,8 @@ struct arg
     std::string output_folder   = STRINGIFY(OUTPUT_DIR);
     uint32_t    device_id       = 0;
     uint32_t    num_filter_iter = 5;
+    bool        cache           = false;
+    bool        fuse_normals    = false;
     char**      argv;
     int         argc;
 } Arg;
@@ -68,6 +70,8 @@ int main(int argc, char** argv)
                         " -input:      Input OBJ mesh file. Default is {} \n"
                         " -o:                JSON file output folder. Default is {} \n"
                         " -num_filter_iter:  Iteration count. Default is {} \n"
+                        " -cache:            Precompute the filtering neighborhoods once and filter by gathering over them\n"
+                        " -fuse_normals:     With -cache, compute the vertex normals in the filtering pass\n"
                         " -device_id:        GPU device ID. Default is {}",
              Arg.obj_file_name, Arg.output_folder ,Arg.num_filter_iter ,Arg.device_id);
             // clang-format on
@@ -87,6 +91,12 @@ int main(int argc, char** argv)
             Arg.output_folder =
                 std::string(get_cmd_option(argv, argv + argc, "-o"));
         }
+        if (cmd_option_exists(argv, argc + argv, "-cache")) {
+            Arg.cache = true;
+        }
+        if (cmd_option_exists(argv, argc + argv, "-fuse_normals")) {
+            Arg.fuse_normals = true;
+        }
         if (cmd_option_exists(argv, argc + argv, "-device_id")) {
             Arg.device_id =
                 atoi(get_cmd_option(argv, argv + argc, "-device_id"));
@@ -96,6 +106,8 @@ int main(int argc, char** argv)
     RXMESH_TRACE("input= {}", Arg.obj_file_name);
     RXMESH_TRACE("output_folder= {}", Arg.output_folder);
     RXMESH_TRACE("num_filter_iter= {}", Arg.num_filter_iter);
+    RXMESH_TRACE("cache= {}", Arg.cache);
+    RXMESH_TRACE("fuse_normals= {}", Arg.fuse_normals);
     RXMESH_TRACE("device_id= {}", Arg.device_id);
 
     return RUN_ALL_TESTS();
@@ -3,6 +3,7 @@
 #include <cuda_profiler_api.h>
 
 #include "filtering_rxmesh_kernel.cuh"
+#include "neighborhood_cache.cuh"
 #include "rxmesh/attribute.h"
 #include "rxmesh/util/report.h"
 #include "rxmesh/util/timer.h"
@@ -34,6 +35,8 @@ void filtering_rxmesh(const std::string                  file_path,
     report.model_data(Arg.obj_file_name, rx);
     report.add_member("method", std::string("RXMesh"));
     report.add_member("num_filter_iter", Arg.num_filter_iter);
+    report.add_member("cache", Arg.cache);
+    report.add_member("fuse_normals", Arg.cache && Arg.fuse_normals);
 
 
     // input coords
@@ -67,28 +70,51 @@ void filtering_rxmesh(const std::string                  file_path,
     // double buffer
     VertexAttribute<T>* double_buffer[2] = {coords.get(), filtered_coord.get()};
 
+    // neighborhood cache
+    NeighborhoodCache cache;
+    if (Arg.cache) {
+        GPUTimer cache_timer;
+        cache_timer.start();
+        cache = build_neighborhood_cache(rx, *coords);
+        cache_timer.stop();
+        RXMESH_TRACE("filtering_rxmesh() building the cache took {} (ms)",
+                     cache_timer.elapsed_millis());
+        report.add_member("cache_time (ms)", cache_timer.elapsed_millis());
+    }
+
     CUDA_ERROR(cudaProfilerStart());
     GPUTimer timer;
     timer.start();
     uint32_t d = 0;
 
     for (uint32_t itr = 0; itr < Arg.num_filter_iter; ++itr) {
-        vertex_normal->reset(0, rxmesh::DEVICE);
-
-        // update vertex normal before filtering
-        compute_vertex_normal<T, vn_block_threads>
-            <<<vn_launch_box.blocks,
-               vn_block_threads,
-               vn_launch_box.smem_bytes_dyn>>>(
-                rx.get_context(), *double_buffer[d], *vertex_normal);
-
-        bilateral_filtering<T, filter_block_threads, maxVVSize>
-            <<<filter_launch_box.blocks,
-               filter_block_threads,
-               filter_launch_box.smem_bytes_dyn>>>(rx.get_context(),
-                                                   *double_buffer[d],
-                                                   *double_buffer[!d],
-                                                   *vertex_normal);
+        if (!Arg.cache || !Arg.fuse_normals) {
+            vertex_normal->reset(0, rxmesh::DEVICE);
+
+            // update vertex normal before filtering
+            compute_vertex_normal<T, vn_block_threads>
+                <<<vn_launch_box.blocks,
+                   vn_block_threads,
+                   vn_launch_box.smem_bytes_dyn>>>(
+                    rx.get_context(), *double_buffer[d], *vertex_normal);
+        }
+
+        if (Arg.cache) {
+            bilateral_filtering_cached(rx,
+                                       cache,
+                                       *double_buffer[d],
+                                       *double_buffer[!d],
+                                       *vertex_normal,
+                                       Arg.fuse_normals);
+        } else {
+            bilateral_filtering<T, filter_block_threads, maxVVSize>
+                <<<filter_launch_box.blocks,
+                   filter_block_threads,
+                   filter_launch_box.smem_bytes_dyn>>>(rx.get_context(),
+                                                       *double_buffer[d],
+                                                       *double_buffer[!d],
+                                                       *vertex_normal);
+        }
 
         d = !d;
         CUDA_ERROR(cudaDeviceSynchronize());
@@ -104,6 +130,8 @@ void filtering_rxmesh(const std::string                  file_path,
     // move output to host
     coords->copy_from(*double_buffer[d], rxmesh::DEVICE, rxmesh::HOST);
 
+    cache.release();
+
     // output to obj
     // rx.export_obj(STRINGIFY(OUTPUT_DIR) "output_rxmesh" +
     //                  std::to_string(Arg.num_filter_iter) + ".obj",
@@ -0,0 +1,310 @@
+#pragma once
+
+#include <cub/device/device_scan.cuh>
+
+#include "rxmesh/attribute.h"
+#include "rxmesh/k_ring.h"
+#include "rxmesh/query.cuh"
+#include "rxmesh/rxmesh_static.h"
+
+/**
+ * NeighborhoodCache is the precomputed filtering neighborhood of every vertex
+ * stored in CSR (indexed by the vertex linear id). Every vertex stores 1) its
+ * candidate neighbors i.e., the vertex itself followed by the vertices of its
+ * k-ring that are within the (enlarged) filtering radius and 2) its fan i.e.,
+ * the two other vertices of every incident face (in the face orientation)
+ * from which the vertex normal and the 1-ring are computed. With the cache,
+ * every filtering iteration is a gather over these lists instead of growing
+ * the neighborhood with repeated VV queries. The candidates are computed once
+ * from the input positions and the radius is enlarged by slack such that the
+ * vertices that move into the radius during filtering are still considered
+ * (every iteration still tests the distance against the current radius).
+ * The memory should be released explicitly by calling release()
+ */
+struct NeighborhoodCache
+{
+    rxmesh::Context       context;
+    uint32_t              num_rings    = 0;
+    uint32_t*             d_nb_offset  = nullptr;
+    rxmesh::VertexHandle* d_nb         = nullptr;
+    uint32_t*             d_fan_offset = nullptr;
+    rxmesh::VertexHandle* d_fan        = nullptr;
+
+    void release()
+    {
+        GPU_FREE(d_nb_offset);
+        GPU_FREE(d_nb);
+        GPU_FREE(d_fan_offset);
+        GPU_FREE(d_fan);
+    }
+};
+
+/**
+ * exclusive_scan_total() exclusive scan of d_count (num+1 entries) into
+ * d_offset and return the total
+ */
+inline uint32_t exclusive_scan_total(uint32_t*      d_count,
+                                     uint32_t*      d_offset,
+                                     const uint32_t num)
+{
+    void*  d_temp     = nullptr;
+    size_t temp_bytes = 0;
+    cub::DeviceScan::ExclusiveSum(
+        d_temp, temp_bytes, d_count, d_offset, num + 1);
+    CUDA_ERROR(cudaMalloc((void**)&d_temp, temp_bytes));
+    cub::DeviceScan::ExclusiveSum(
+        d_temp, temp_bytes, d_count, d_offset, num + 1);
+    GPU_FREE(d_temp);
+
+    uint32_t total = 0;
+    CUDA_ERROR(cudaMemcpy(
+        &total, d_offset + num, sizeof(uint32_t), cudaMemcpyDeviceToHost));
+    return total;
+}
+
+/**
+ * build_neighborhood_cache()
+ */
+template <typename T>
+NeighborhoodCache build_neighborhood_cache(
+    const rxmesh::RXMeshStatic&       rx,
+    const rxmesh::VertexAttribute<T>& coords,
+    const T                           slack     = 1.5,
+    const uint32_t                    max_rings = 8)
+{
+    using namespace rxmesh;
+
+    NeighborhoodCache cache;
+    cache.context = rx.get_context();
+
+    const Context  context = cache.context;
+    const uint32_t num_v   = rx.get_num_vertices();
+    const size_t   bytes   = (num_v + 1) * sizeof(uint32_t);
+
+    uint32_t* d_count;
+    CUDA_ERROR(cudaMalloc((void**)&d_count, bytes));
+
+    // fan
+    CUDA_ERROR(cudaMemset(d_count, 0, bytes));
+    CUDA_ERROR(cudaMalloc((void**)&cache.d_fan_offset, bytes));
+
+    rx.run_query_kernel<Op::FV, 256>(
+        [=] __device__(const FaceHandle& fh, const VertexIterator& fv) {
+            for (int i = 0; i < 3; ++i) {
+                ::atomicAdd(&d_count[context.linear_id(fv[i])], 2u);
+            }
+        });
+
+    const uint32_t fan_size =
+        exclusive_scan_total(d_count, cache.d_fan_offset, num_v);
+
+    CUDA_ERROR(
+        cudaMalloc((void**)&cache.d_fan, fan_size * sizeof(VertexHandle)));
+    CUDA_ERROR(cudaMemset(d_count, 0, bytes));
+
+    uint32_t*     d_fan_offset = cache.d_fan_offset;
+    VertexHandle* d_fan        = cache.d_fan;
+
+    rx.run_query_kernel<Op::FV, 256>(
+        [=] __device__(const FaceHandle& fh, const VertexIterator& fv) {
+            for (int i = 0; i < 3; ++i) {
+                const uint32_t v = context.linear_id(fv[i]);
+                const uint32_t o =
+                    d_fan_offset[v] + ::atomicAdd(&d_count[v], 2u);
+                d_fan[o]     = fv[(i + 1) % 3];
+                d_fan[o + 1] = fv[(i + 2) % 3];
+            }
+        });
+
+    // candidates: grow the k-ring until no vertex has a vertex in its last
+    // ring that is within the (enlarged) radius
+    const T radius_scale = T(4) * slack * slack;
+
+    int* d_deeper;
+    CUDA_ERROR(cudaMalloc((void**)&d_deeper, sizeof(int)));
+
+    KRing ring;
+    for (uint32_t k = 1;; ++k) {
+        ring = KRing(rx, k);
+
+        CUDA_ERROR(cudaMemset(d_count, 0, bytes));
+        CUDA_ERROR(cudaMemset(d_deeper, 0, sizeof(int)));
+
+        rx.for_each_vertex(DEVICE, [=] __device__(const VertexHandle& vh) {
+            const vec3<T> p = coords.template to_glm<3>(vh);
+
+            T sigma_c_sq = 1e10;
+            for (uint32_t i = 0; i < ring.size(vh, 1); ++i) {
+                const vec3<T> q = coords.template to_glm<3>(ring(vh, 1, i));
+                sigma_c_sq      = std::min(sigma_c_sq, glm::distance2(p, q));
+            }
+            const T radius = radius_scale * sigma_c_sq;
+
+            uint32_t count = 1;
+            for (uint32_t i = 0; i < ring.size(vh); ++i) {
+                const vec3<T> q = coords.template to_glm<3>(ring(vh, i));
+                if (glm::distance2(p, q) <= radius) {
+                    count++;
+                }
+            }
+            d_count[context.linear_id(vh)] = count;
+
+            const uint32_t last = ring.get_num_rings();
+            for (uint32_t i = 0; i < ring.size(vh, last); ++i) {
+                const vec3<T> q = coords.template to_glm<3>(ring(vh, last, i));
+                if (glm::distance2(p, q) <= radius) {
+                    *d_deeper = 1;
+                    break;
+                }
+            }
+        });
+
+        int deeper = 0;
+        CUDA_ERROR(cudaMemcpy(
+            &deeper, d_deeper, sizeof(int), cudaMemcpyDeviceToHost));
+
+        if (deeper == 0 || k == max_rings) {
+            if (deeper != 0) {
+                RXMESH_WARN(
+                    "build_neighborhood_cache() the filtering radius of some "
+                    "vertices goes beyond {} rings",
+                    max_rings);
+            }
+            cache.num_rings = k;
+            break;
+        }
+        ring.release();
+    }
+
+    CUDA_ERROR(cudaMalloc((void**)&cache.d_nb_offset, bytes));
+    const uint32_t nb_size =
+        exclusive_scan_total(d_count, cache.d_nb_offset, num_v);
+    CUDA_ERROR(cudaMalloc((void**)&cache.d_nb, nb_size * sizeof(VertexHandle)));
+
+    uint32_t*     d_nb_offset = cache.d_nb_offset;
+    VertexHandle* d_nb        = cache.d_nb;
+
+    rx.for_each_vertex(DEVICE, [=] __device__(const VertexHandle& vh) {
+        const vec3<T> p = coords.template to_glm<3>(vh);
+
+        T sigma_c_sq = 1e10;
+        for (uint32_t i = 0; i < ring.size(vh, 1); ++i) {
+            const vec3<T> q = coords.template to_glm<3>(ring(vh, 1, i));
+            sigma_c_sq      = std::min(sigma_c_sq, glm::distance2(p, q));
+        }
+        const T radius = radius_scale * sigma_c_sq;
+
+        uint32_t o = d_nb_offset[context.linear_id(vh)];
+        d_nb[o++]  = vh;
+        for (uint32_t i = 0; i < ring.size(vh); ++i) {
+            const VertexHandle uh = ring(vh, i);
+            if (glm::distance2(p, coords.template to_glm<3>(uh)) <= radius) {
+                d_nb[o++] = uh;
+            }
+        }
+    });
+
+    CUDA_ERROR(cudaDeviceSynchronize());
+    ring.release();
+    GPU_FREE(d_count);
+    GPU_FREE(d_deeper);
+
+    RXMESH_TRACE(
+        "build_neighborhood_cache() #rings= {}, avg. #candidates= {}, "
+        "memory= {} (MB)",
+        cache.num_rings,
+        float(nb_size) / float(num_v),
+        float((nb_size + fan_size) * sizeof(VertexHandle) + 2 * bytes) /
+            float(1024 * 1024));
+
+    return cache;
+}
+
+/**
+ * bilateral_filtering_cached() one filtering iteration as a gather over the
+ * cached neighborhood. If fuse_normals is true, the vertex normal is computed
+ * from the fan in the same pass (vertex_normals is not used). Otherwise,
+ * vertex_normals should be computed (from input_coords) before
+ */
+template <typename T>
+void bilateral_filtering_cached(
+    const rxmesh::RXMeshStatic&       rx,
+    const NeighborhoodCache&          cache,
+    const rxmesh::VertexAttribute<T>& input_coords,
+    rxmesh::VertexAttribute<T>&       filtered_coords,
+    const rxmesh::VertexAttribute<T>& vertex_normals,
+    const bool                        fuse_normals)
+{
+    using namespace rxmesh;
+
+    rx.for_each_vertex(DEVICE, [=] __device__(const VertexHandle& vh) mutable {
+        const uint32_t v_id = cache.context.linear_id(vh);
+
+        vec3<T> v = input_coords.template to_glm<3>(vh);
+
+        // normal and sigma_c
+        vec3<T> n(0, 0, 0);
+        T       sigma_c_sq = 1e10;
+        for (uint32_t i = cache.d_fan_offset[v_id];
+             i < cache.d_fan_offset[v_id + 1];
+             i += 2) {
+            const vec3<T> a = input_coords.template to_glm<3>(cache.d_fan[i]);
+            const vec3<T> b =
+                input_coords.template to_glm<3>(cache.d_fan[i + 1]);
+            if (fuse_normals) {
+                n += glm::normalize(glm::cross(a - v, b - v));
+            }
+            sigma_c_sq = std::min(sigma_c_sq, glm::distance2(v, a));
+        }
+        if (!fuse_normals) {
+            n = vertex_normals.template to_glm<3>(vh);
+        }
+        n = glm::normalize(n);
+
+        const T radius = 4.0 * sigma_c_sq;
+
+        const uint32_t begin = cache.d_nb_offset[v_id];
+        const uint32_t end   = cache.d_nb_offset[v_id + 1];
+
+        // sigma_s
+        T sum     = 0;
+        T sum_sqs = 0;
+        T c       = 0;
+        for (uint32_t i = begin; i < end; ++i) {
+            const vec3<T> q = input_coords.template to_glm<3>(cache.d_nb[i]);
+            if (glm::distance2(q, v) > radius) {
+                continue;
+            }
+            T t = std::abs(dot(q - v, n));
+            sum += t;
+            sum_sqs += t * t;
+            c += 1;
+        }
+        T sigma_s_sq = (sum_sqs / c) - ((sum * sum) / (c * c));
+        sigma_s_sq =
+            (sigma_s_sq < 1.0e-20) ? (sigma_s_sq + 1.0e-20) : sigma_s_sq;
+
+        // new position
+        sum          = 0;
+        T normalizer = 0;
+        for (uint32_t i = begin; i < end; ++i) {
+            vec3<T> q = input_coords.template to_glm<3>(cache.d_nb[i]);
+            q -= v;
+            T t = glm::length(q);
+            if (t * t > radius) {
+                continue;
+            }
+            T h  = dot(q, n);
+            T wc = exp(-0.5 * t * t / sigma_c_sq);
+            T ws = exp(-0.5 * h * h / sigma_s_sq);
+
+            sum += wc * ws * h;
+            normalizer += wc * ws;
+        }
+        v += (n * (sum / normalizer));
+
+        filtered_coords(vh, 0) = v[0];
+        filtered_coords(vh, 1) = v[1];
+        filtered_coords(vh, 2) = v[2];
+    });
+}
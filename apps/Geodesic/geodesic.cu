@@ -22,6 +22,7 @@ struct arg
     char**      argv;
     int         argc;
     uint32_t    num_seeds = 1;
+    uint32_t    num_sources = 1;
 
 } Arg;
 
@@ -50,7 +51,7 @@ TEST(App, Geodesic)
     std::random_device    dev;
     std::mt19937          rng(dev());
     std::uniform_int_distribution<std::mt19937::result_type> dist(
-        0, rx.get_num_vertices());
+        0, rx.get_num_vertices() - 1);
     for (auto& s : h_seeds) {
         s = dist(rng);
         // s = 0;
@@ -58,17 +59,40 @@ TEST(App, Geodesic)
 
 
     // Save a map from vertex id to topleset (number of hops from
-    // (closest?) source). It's used by OpenMesh to help construct
-    // sorted_index and limit. We keep it for RXMesh because it is
+    // closest source) along with the toplesets limits. Both are computed on
+    // the device (see LevelSets). We keep the toplesets because they are
     // used to quickly determine whether or not a vertex is within
     // the "update band".
+    LevelSets             ls(rx);
     std::vector<uint32_t> toplesets(rx.get_num_vertices(), 1u);
     std::vector<uint32_t> sorted_index;
     std::vector<uint32_t> limits;
-    geodesic_ptp_openmesh<dataT>(h_seeds, sorted_index, limits, toplesets);
+    toplesets_rxmesh(rx, ls, h_seeds, limits, toplesets);
 
     // RXMesh Impl
-    geodesic_rxmesh<dataT>(rx, h_seeds, sorted_index, limits, toplesets);
+    if (Arg.num_sources <= 1) {
+        geodesic_rxmesh<dataT>(rx, h_seeds, sorted_index, limits, toplesets);
+        return;
+    }
+
+    // batched mode: num_sources independent distance fields each with its
+    // own set of seeds
+    std::vector<std::vector<uint32_t>> b_seeds(Arg.num_sources);
+    std::vector<std::vector<uint32_t>> b_limits(Arg.num_sources);
+    std::vector<std::vector<uint32_t>> b_toplesets(
+        Arg.num_sources, std::vector<uint32_t>(rx.get_num_vertices(), 1u));
+    b_seeds[0] = h_seeds;
+    for (uint32_t s = 0; s < Arg.num_sources; ++s) {
+        if (s > 0) {
+            b_seeds[s].resize(Arg.num_seeds);
+            for (auto& seed : b_seeds[s]) {
+                seed = dist(rng);
+            }
+        }
+        toplesets_rxmesh(rx, ls, b_seeds[s], b_limits[s], b_toplesets[s]);
+    }
+
+    geodesic_rxmesh<dataT>(rx, b_seeds, b_limits, b_toplesets);
 }
 
 int main(int argc, char** argv)
@@ -89,8 +113,9 @@ int main(int argc, char** argv)
                         " -input:      Input OBJ mesh file. Default is {} \n"
                         " -o:          JSON file output folder. Default is {} \n"
                        // "-num_seeds:   Number of input seeds. Default is {}\n"
+                        " -num_sources: Number of independent sources (distance fields) computed at once. Default is {}\n"
                         " -device_id:  GPU device ID. Default is {}",
-            Arg.obj_file_name, Arg.output_folder ,Arg.num_seeds, Arg.device_id);
+            Arg.obj_file_name, Arg.output_folder, Arg.num_sources, Arg.device_id);
             // clang-format on
             exit(EXIT_SUCCESS);
         }
@@ -107,6 +132,10 @@ int main(int argc, char** argv)
             Arg.device_id =
                 atoi(get_cmd_option(argv, argv + argc, "-device_id"));
         }
+        if (cmd_option_exists(argv, argc + argv, "-num_sources")) {
+            Arg.num_sources =
+                atoi(get_cmd_option(argv, argv + argc, "-num_sources"));
+        }
         // if (cmd_option_exists(argv, argc + argv, "-num_seeds")) {
         //    Arg.num_seeds =
         //        atoi(get_cmd_option(argv, argv + argc, "-num_seeds"));
@@ -116,6 +145,7 @@ int main(int argc, char** argv)
     RXMESH_TRACE("input= {}", Arg.obj_file_name);
     RXMESH_TRACE("output_folder= {}", Arg.output_folder);
     RXMESH_TRACE("num_seeds= {}", Arg.num_seeds);
+    RXMESH_TRACE("num_sources= {}", Arg.num_sources);
     RXMESH_TRACE("device_id= {}", Arg.device_id);
 
     return RUN_ALL_TESTS();
@@ -15,7 +15,8 @@ __device__ __inline__ T update_step(
     const rxmesh::VertexHandle&       v2_id,
     const rxmesh::VertexAttribute<T>& geo_distance,
     const rxmesh::VertexAttribute<T>& coords,
-    const T                           infinity_val)
+    const T                           infinity_val,
+    const uint32_t                    col = 0)
 {
     using namespace rxmesh;
     const vec3<T> v0 = coords.to_glm<3>(v0_id);
@@ -26,8 +27,8 @@ __device__ __inline__ T update_step(
     const vec3<T> x1 = v2 - v0;
 
     T t[2];
-    t[0] = geo_distance(v1_id);
-    t[1] = geo_distance(v2_id);
+    t[0] = geo_distance(v1_id, col);
+    t[1] = geo_distance(v2_id, col);
 
     T q[2][2];
 
@@ -66,14 +67,34 @@ __device__ __inline__ T update_step(
     if (t[0] == infinity_val || t[1] == infinity_val || dis < 0 || c[0] >= 0 ||
         c[1] >= 0) {
         T dp[2];
-        dp[0] = geo_distance(v1_id) + glm::length(x0);
-        dp[1] = geo_distance(v2_id) + glm::length(x1);
+        dp[0] = geo_distance(v1_id, col) + glm::length(x0);
+        dp[1] = geo_distance(v2_id, col) + glm::length(x1);
         p     = dp[dp[1] < dp[0]];
     }
     return p;
 }
 
 
+/**
+ * @brief the topleset window [band_start, band_end) of one source along with
+ * its convergence state. It lives on the device such that the window is moved
+ * without reading the error back to the host after every iteration
+ */
+struct PTPWindow
+{
+    uint32_t band_start;
+    uint32_t band_end;
+    // the number of vertices in band_start that converged in this iteration
+    uint32_t error;
+    uint32_t iter;
+    uint32_t max_iter;
+    // which of the two buffers has the latest distance of this source
+    uint32_t result;
+    // whether this source still needs more iterations
+    uint32_t active;
+};
+
+
 template <typename T, uint32_t blockThreads>
 __global__ static void relax_ptp_rxmesh(
     const rxmesh::Context                   context,
@@ -81,47 +102,64 @@ __global__ static void relax_ptp_rxmesh(
     rxmesh::VertexAttribute<T>              new_geo_dist,
     const rxmesh::VertexAttribute<T>        old_geo_dist,
     const rxmesh::VertexAttribute<uint32_t> toplesets,
-    const uint32_t                          band_start,
-    const uint32_t                          band_end,
-    uint32_t*                               d_error,
+    PTPWindow*                              d_windows,
+    const uint32_t                          num_sources,
+    const uint32_t*                         d_num_active,
     const T                                 infinity_val,
     const T                                 error_tol)
 {
     using namespace rxmesh;
 
+    if (*d_num_active == 0) {
+        return;
+    }
+
+    auto in_band = [&](const VertexHandle& p_id, const uint32_t s) {
+        const PTPWindow& w       = d_windows[s];
+        const uint32_t   my_band = toplesets(p_id, s);
+        return w.active && my_band >= w.band_start && my_band < w.band_end;
+    };
+
     auto in_active_set = [&](VertexHandle p_id) {
-        uint32_t my_band = toplesets(p_id);
-        return my_band >= band_start && my_band < band_end;
+        for (uint32_t s = 0; s < num_sources; ++s) {
+            if (in_band(p_id, s)) {
+                return true;
+            }
+        }
+        return false;
     };
 
     auto geo_lambda = [&](VertexHandle& p_id, const VertexIterator& iter) {
-        // this vertex (p_id) update_band
-        uint32_t my_band = toplesets(p_id);
-
-        // this is the last vertex in the one-ring (before r_id)
-        auto q_id = iter.back();
-
-        // one-ring enumeration
-        T current_dist = old_geo_dist(p_id);
-        T new_dist     = current_dist;
-        for (uint32_t v = 0; v < iter.size(); ++v) {
-            // the current one ring vertex
-            auto r_id = iter[v];
-
-            T dist = update_step(
-                p_id, q_id, r_id, old_geo_dist, coords, infinity_val);
-            if (dist < new_dist) {
-                new_dist = dist;
+        for (uint32_t s = 0; s < num_sources; ++s) {
+            if (!in_band(p_id, s)) {
+                continue;
+            }
+
+            // this is the last vertex in the one-ring (before r_id)
+            auto q_id = iter.back();
+
+            // one-ring enumeration
+            T current_dist = old_geo_dist(p_id, s);
+            T new_dist     = current_dist;
+            for (uint32_t v = 0; v < iter.size(); ++v) {
+                // the current one ring vertex
+                auto r_id = iter[v];
+
+                T dist = update_step(
+                    p_id, q_id, r_id, old_geo_dist, coords, infinity_val, s);
+                if (dist < new_dist) {
+                    new_dist = dist;
+                }
+                q_id = r_id;
             }
-            q_id = r_id;
-        }
 
-        new_geo_dist(p_id) = new_dist;
-        // update our distance
-        if (my_band == band_start) {
-            T error = fabs(new_dist - current_dist) / current_dist;
-            if (error < error_tol) {
-                atomicAdd(d_error, 1);
+            new_geo_dist(p_id, s) = new_dist;
+            // update our distance
+            if (toplesets(p_id, s) == d_windows[s].band_start) {
+                T error = fabs(new_dist - current_dist) / current_dist;
+                if (error < error_tol) {
+                    atomicAdd(&d_windows[s].error, 1);
+                }
             }
         }
     };
@@ -132,3 +170,68 @@ __global__ static void relax_ptp_rxmesh(
     ShmemAllocator      shrd_alloc;
     query.dispatch<Op::VV>(block, shrd_alloc, geo_lambda, in_active_set, true);
 }
+
+
+/**
+ * @brief move the topleset window of every active source after an iteration
+ * that wrote its distance to the buffer written_buffer. The window moves
+ * forward (band_start) once all the vertices of band_start have converged
+ * and grows (band_end) by one topleset per iteration. d_limits stores the
+ * toplesets limits of all sources where the limits of source s start at
+ * d_limits_offset[s]. The number of sources that are still active is
+ * written to d_num_active. Launched with one block
+ */
+template <uint32_t blockThreads>
+__global__ static void update_ptp_window(PTPWindow*      d_windows,
+                                         const uint32_t  num_sources,
+                                         const uint32_t* d_limits,
+                                         const uint32_t* d_limits_offset,
+                                         const uint32_t  written_buffer,
+                                         uint32_t*       d_num_active)
+{
+    __shared__ uint32_t s_num_active;
+    if (threadIdx.x == 0) {
+        s_num_active = 0;
+    }
+    __syncthreads();
+
+    for (uint32_t s = threadIdx.x; s < num_sources; s += blockThreads) {
+        PTPWindow w = d_windows[s];
+        if (!w.active) {
+            continue;
+        }
+
+        const uint32_t* limits = d_limits + d_limits_offset[s];
+        const uint32_t  num_limits =
+            d_limits_offset[s + 1] - d_limits_offset[s];
+
+        const uint32_t n_cond =
+            limits[w.band_start + 1] - limits[w.band_start];
+
+        if (n_cond == w.error) {
+            w.band_start++;
+        }
+        if (w.band_end < num_limits - 1) {
+            w.band_end++;
+        }
+        w.error  = 0;
+        w.result = written_buffer;
+        w.iter++;
+
+        // the window of the next iteration
+        if (w.band_start < (w.band_end / 2)) {
+            w.band_start = w.band_end / 2;
+        }
+        w.active = w.band_start < w.band_end && w.iter < w.max_iter;
+
+        if (w.active) {
+            atomicAdd(&s_num_active, 1u);
+        }
+        d_windows[s] = w;
+    }
+    __syncthreads();
+
+    if (threadIdx.x == 0) {
+        *d_num_active = s_num_active;
+    }
+}
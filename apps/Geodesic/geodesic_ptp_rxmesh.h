@@ -1,130 +1,258 @@
 #pragma once
 #include "geodesic_kernel.cuh"
+#include "rxmesh/algo/level_sets.h"
+#include "rxmesh/cuda_graph.h"
 #include "rxmesh/rxmesh_static.h"
 #include "rxmesh/util/report.h"
 #include "rxmesh/util/timer.h"
 
 constexpr float EPS = 10e-6;
 
+/**
+ * @brief compute the toplesets (the number of hops from the closest seed
+ * indexed by the global vertex id) and their limits on the device
+ */
+inline void toplesets_rxmesh(rxmesh::RXMeshStatic&        rx,
+                             rxmesh::LevelSets&           ls,
+                             const std::vector<uint32_t>& h_seeds,
+                             std::vector<uint32_t>&       limits,
+                             std::vector<uint32_t>&       toplesets)
+{
+    using namespace rxmesh;
+
+    std::vector<VertexHandle> seeds;
+    for (uint32_t s : h_seeds) {
+        seeds.push_back(rx.map_to_local_vertex(s));
+    }
+
+    GPUTimer timer;
+    timer.start();
+    ls.compute(seeds);
+    timer.stop();
+    RXMESH_TRACE("RXMesh: Computing toplesets took {} (ms)",
+                 timer.elapsed_millis());
+
+    if (ls.get_num_reached() != rx.get_num_vertices()) {
+        RXMESH_ERROR(
+            "toplesets_rxmesh() could not compute toplesets for all vertices "
+            "maybe because the input is not manifold or contain duplicate "
+            "vertices!");
+        exit(EXIT_FAILURE);
+    }
+
+    limits = ls.offset();
+
+    toplesets.resize(rx.get_num_vertices());
+    rx.for_each_vertex(HOST, [&](const VertexHandle vh) {
+        toplesets[rx.map_to_global(vh)] = ls.level()(vh);
+    });
+}
+
+/**
+ * @brief compute the geodesic distance from many independent sources at once
+ * where source s has its own seeds (h_seeds[s]), toplesets limits
+ * (h_limits[s]), and toplesets (toplesets[s]) and its distance is stored in
+ * column s of the output. Every source has its own topleset window that is
+ * moved on the device. Two iterations (one per double buffer) are captured
+ * in a CUDA graph that is replayed until all sources converge where the host
+ * only checks for convergence every check_freq replays
+ */
 template <typename T>
-inline void geodesic_rxmesh(rxmesh::RXMeshStatic&        rx,
-                            const std::vector<uint32_t>& h_seeds,
-                            const std::vector<uint32_t>& h_sorted_index,
-                            const std::vector<uint32_t>& h_limits,
-                            const std::vector<uint32_t>& toplesets)
+inline void geodesic_rxmesh(rxmesh::RXMeshStatic&                     rx,
+                            const std::vector<std::vector<uint32_t>>& h_seeds,
+                            const std::vector<std::vector<uint32_t>>& h_limits,
+                            const std::vector<std::vector<uint32_t>>& toplesets,
+                            const uint32_t check_freq = 8)
 {
     using namespace rxmesh;
     constexpr uint32_t blockThreads = 256;
 
+    const uint32_t num_sources = h_seeds.size();
+
     // Report
     Report report("Geodesic_RXMesh");
     report.command_line(Arg.argc, Arg.argv);
     report.device();
     report.system();
     report.model_data(Arg.obj_file_name, rx);
-    report.add_member("seeds", h_seeds);
+    if (num_sources == 1) {
+        report.add_member("seeds", h_seeds[0]);
+    }
+    report.add_member("num_sources", num_sources);
     report.add_member("method", std::string("RXMesh"));
 
     // input coords
     auto input_coord = rx.get_input_vertex_coordinates();
 
-    // toplesets
-    auto d_toplesets = rx.add_vertex_attribute(toplesets, "topleset");
-
-
-    // RXMesh launch box
-    LaunchBox<blockThreads> launch_box;
-    rx.prepare_launch_box({rxmesh::Op::VV},
-                          launch_box,
-                          (void*)relax_ptp_rxmesh<T, blockThreads>,
-                          true);
-
+    // toplesets of every source
+    auto d_toplesets =
+        rx.add_vertex_attribute<uint32_t>("topleset", num_sources);
 
     // Geodesic distance attribute for all vertices (seeds set to zero
     // and infinity otherwise)
-    auto rxmesh_geo = rx.add_vertex_attribute<T>("geo", 1u);
+    auto rxmesh_geo = rx.add_vertex_attribute<T>("geo", num_sources);
     rxmesh_geo->reset(std::numeric_limits<T>::infinity(), rxmesh::HOST);
     rx.for_each_vertex(rxmesh::HOST, [&](const VertexHandle vh) {
         uint32_t v_id = rx.map_to_global(vh);
-        for (uint32_t s : h_seeds) {
-            if (s == v_id) {
-                (*rxmesh_geo)(vh) = 0;
-                break;
+        for (uint32_t s = 0; s < num_sources; ++s) {
+            (*d_toplesets)(vh, s) = toplesets[s][v_id];
+            for (uint32_t seed : h_seeds[s]) {
+                if (seed == v_id) {
+                    (*rxmesh_geo)(vh, s) = 0;
+                    break;
+                }
             }
         }
     });
+    d_toplesets->move(rxmesh::HOST, rxmesh::DEVICE);
     rxmesh_geo->move(rxmesh::HOST, rxmesh::DEVICE);
 
     // second buffer for geodesic distance for double buffering
-    auto rxmesh_geo_2 = rx.add_vertex_attribute<T>("geo2", 1u, rxmesh::DEVICE);
+    auto rxmesh_geo_2 =
+        rx.add_vertex_attribute<T>("geo2", num_sources, rxmesh::DEVICE);
 
     rxmesh_geo_2->copy_from(*rxmesh_geo, rxmesh::DEVICE, rxmesh::DEVICE);
 
 
-    // Error
-    uint32_t *d_error(nullptr), h_error(0);
-    CUDA_ERROR(cudaMalloc((void**)&d_error, sizeof(uint32_t)));
+    // RXMesh launch box
+    LaunchBox<blockThreads> launch_box;
+    rx.prepare_launch_box({rxmesh::Op::VV},
+                          launch_box,
+                          (void*)relax_ptp_rxmesh<T, blockThreads>,
+                          true);
+
+
+    // the toplesets limits of all sources and the initial window of every
+    // source
+    std::vector<uint32_t>  h_limits_all;
+    std::vector<uint32_t>  h_limits_offset(1, 0);
+    std::vector<PTPWindow> h_windows(num_sources);
+    uint32_t               num_active = 0;
+    uint32_t               max_iter   = 0;
+    for (uint32_t s = 0; s < num_sources; ++s) {
+        h_limits_all.insert(
+            h_limits_all.end(), h_limits[s].begin(), h_limits[s].end());
+        h_limits_offset.push_back(h_limits_all.size());
+
+        PTPWindow& w = h_windows[s];
+        w.band_start = 1;
+        w.band_end   = 2;
+        w.error      = 0;
+        w.iter       = 0;
+        w.max_iter   = 2 * h_limits[s].size();
+        w.result     = 0;
+        w.active     = h_limits[s].size() > w.band_end;
+
+        num_active += w.active;
+        max_iter = std::max(max_iter, w.max_iter);
+    }
+
+    PTPWindow* d_windows(nullptr);
+    uint32_t * d_limits(nullptr), *d_limits_offset(nullptr),
+        *d_num_active(nullptr);
+    CUDA_ERROR(cudaMalloc((void**)&d_windows, num_sources * sizeof(PTPWindow)));
+    CUDA_ERROR(
+        cudaMalloc((void**)&d_limits, h_limits_all.size() * sizeof(uint32_t)));
+    CUDA_ERROR(cudaMalloc((void**)&d_limits_offset,
+                          h_limits_offset.size() * sizeof(uint32_t)));
+    CUDA_ERROR(cudaMalloc((void**)&d_num_active, sizeof(uint32_t)));
+
+    CUDA_ERROR(cudaMemcpy(d_windows,
+                          h_windows.data(),
+                          num_sources * sizeof(PTPWindow),
+                          cudaMemcpyHostToDevice));
+    CUDA_ERROR(cudaMemcpy(d_limits,
+                          h_limits_all.data(),
+                          h_limits_all.size() * sizeof(uint32_t),
+                          cudaMemcpyHostToDevice));
+    CUDA_ERROR(cudaMemcpy(d_limits_offset,
+                          h_limits_offset.data(),
+                          h_limits_offset.size() * sizeof(uint32_t),
+                          cudaMemcpyHostToDevice));
+    CUDA_ERROR(cudaMemcpy(
+        d_num_active, &num_active, sizeof(uint32_t), cudaMemcpyHostToDevice));
 
     // double buffer
     VertexAttribute<T>* double_buffer[2] = {rxmesh_geo.get(),
                                             rxmesh_geo_2.get()};
 
-    // start time
-    GPUTimer timer;
-    timer.start();
+    cudaStream_t stream;
+    CUDA_ERROR(cudaStreamCreate(&stream));
 
-    // actual computation
-    uint32_t d = 0;
-    uint32_t i(1), j(2);
-    uint32_t iter     = 0;
-    uint32_t max_iter = 2 * h_limits.size();
-    while (i < j && iter < max_iter) {
-        iter++;
-        if (i < (j / 2)) {
-            i = j / 2;
-        }
+    // two iterations such that the graph ends with the buffers in the same
+    // order it started with
+    CUDAGraph graph;
+    graph.capture(stream, [&](cudaStream_t st) {
+        for (uint32_t d = 0; d < 2; ++d) {
+            relax_ptp_rxmesh<T, blockThreads>
+                <<<launch_box.blocks,
+                   blockThreads,
+                   launch_box.smem_bytes_dyn,
+                   st>>>(rx.get_context(),
+                         *input_coord,
+                         *double_buffer[!d],
+                         *double_buffer[d],
+                         *d_toplesets,
+                         d_windows,
+                         num_sources,
+                         d_num_active,
+                         std::numeric_limits<T>::infinity(),
+                         T(1e-3));
 
-        // compute new geodesic
-        relax_ptp_rxmesh<T, blockThreads>
-            <<<launch_box.blocks, blockThreads, launch_box.smem_bytes_dyn>>>(
-                rx.get_context(),
-                *input_coord,
-                *double_buffer[!d],
-                *double_buffer[d],
-                *d_toplesets,
-                i,
-                j,
-                d_error,
-                std::numeric_limits<T>::infinity(),
-                T(1e-3));
-
-        CUDA_ERROR(cudaMemcpy(
-            &h_error, d_error, sizeof(uint32_t), cudaMemcpyDeviceToHost));
-        CUDA_ERROR(cudaMemset(d_error, 0, sizeof(uint32_t)));
-
-
-        const uint32_t n_cond = h_limits[i + 1] - h_limits[i];
-
-        if (n_cond == h_error) {
-            i++;
-        }
-        if (j < h_limits.size() - 1) {
-            j++;
+            update_ptp_window<blockThreads>
+                <<<1, blockThreads, 0, st>>>(d_windows,
+                                             num_sources,
+                                             d_limits,
+                                             d_limits_offset,
+                                             !d,
+                                             d_num_active);
         }
+    });
 
-        d = !d;
-    }
+    // start time
+    GPUTimer timer(stream);
+    timer.start();
+
+    // actual computation
+    const uint32_t num_launches = graph.launch_until(
+        d_num_active, 1u, DIVIDE_UP(max_iter, 2), check_freq, stream);
 
     timer.stop();
-    CUDA_ERROR(cudaDeviceSynchronize());
+    CUDA_ERROR(cudaStreamSynchronize(stream));
     CUDA_ERROR(cudaGetLastError());
     CUDA_ERROR(cudaProfilerStop());
 
-    rxmesh_geo->copy_from(*double_buffer[d], rxmesh::DEVICE, rxmesh::HOST);
+    CUDA_ERROR(cudaMemcpy(h_windows.data(),
+                          d_windows,
+                          num_sources * sizeof(PTPWindow),
+                          cudaMemcpyDeviceToHost));
+    uint32_t iter = 0;
+    for (const PTPWindow& w : h_windows) {
+        iter = std::max(iter, w.iter);
+    }
+
+    // gather the latest distance of every source
+    rx.for_each_vertex(
+        DEVICE,
+        [num_sources,
+         d_windows,
+         geo   = *rxmesh_geo,
+         geo_2 = *rxmesh_geo_2] __device__(const VertexHandle vh) mutable {
+            for (uint32_t s = 0; s < num_sources; ++s) {
+                if (d_windows[s].result == 1) {
+                    geo(vh, s) = geo_2(vh, s);
+                }
+            }
+        });
+    rxmesh_geo->move(rxmesh::DEVICE, rxmesh::HOST);
 
-    RXMESH_TRACE("Geodesic_RXMesh took {} (ms) -- #iter= {}",
-                 timer.elapsed_millis(),
-                 iter);
+    RXMESH_TRACE(
+        "Geodesic_RXMesh took {} (ms) -- #iter= {}, #graph launches= {}, "
+        "#sources= {}",
+        timer.elapsed_millis(),
+        iter,
+        num_launches,
+        num_sources);
 
 #if USE_POLYSCOPE
     auto ps_mesh = rx.get_polyscope_mesh();
@@ -132,10 +260,16 @@ inline void geodesic_rxmesh(rxmesh::RXMeshStatic&        rx,
     polyscope::show();
 #endif
 
-    GPU_FREE(d_error);
+    graph.release();
+    CUDA_ERROR(cudaStreamDestroy(stream));
+    GPU_FREE(d_windows);
+    GPU_FREE(d_limits);
+    GPU_FREE(d_limits_offset);
+    GPU_FREE(d_num_active);
 
     // Finalize report
     report.add_member("num_iter_taken", iter);
+    report.add_member("num_graph_launches", num_launches);
     TestData td;
     td.test_name   = "Geodesic";
     td.num_threads = launch_box.num_threads;
@@ -147,4 +281,14 @@ inline void geodesic_rxmesh(rxmesh::RXMeshStatic&        rx,
     report.add_test(td);
     report.write(Arg.output_folder + "/rxmesh",
                  "Geodesic_RXMesh_" + extract_file_name(Arg.obj_file_name));
-}
\ No newline at end of file
+}
+
+template <typename T>
+inline void geodesic_rxmesh(rxmesh::RXMeshStatic&        rx,
+                            const std::vector<uint32_t>& h_seeds,
+                            const std::vector<uint32_t>& h_sorted_index,
+                            const std::vector<uint32_t>& h_limits,
+                            const std::vector<uint32_t>& toplesets)
+{
+    geodesic_rxmesh<T>(rx, {h_seeds}, {h_limits}, {toplesets});
+}
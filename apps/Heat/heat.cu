@@ -1,19 +1,445 @@
+// Compute geodesic distance using the heat method
+// Crane, Keenan, Clarisse Weischedel, and Max Wardetzky. "Geodesics in heat: A
+// new approach to computing distance based on heat flow." ACM Transactions on
+// Graphics (TOG) 32.5 (2013): 1-11.
+//
+// The heat matrix (M + tL) and the Poisson matrix L are factorized once and
+// then any number of source sets are solved in batches where every source set
+// is one column of the right-hand side
+
+#include <random>
+#include <unordered_map>
+
+#include "rxmesh/geometry_util.cuh"
+#include "rxmesh/matrix/cholesky_solver.h"
+#include "rxmesh/matrix/dense_matrix.h"
+#include "rxmesh/matrix/laplacian_operator.h"
+#include "rxmesh/matrix/sparse_matrix.h"
 #include "rxmesh/query.cuh"
 #include "rxmesh/reduce_handle.h"
 #include "rxmesh/rxmesh_static.h"
-
-#include "rxmesh/matrix/sparse_matrix.h"
+#include "rxmesh/util/timer.h"
 
 using namespace rxmesh;
 
+/**
+ * @brief the time step of the heat flow, i.e., the mean edge length squared
+ */
+template <typename T>
+T heat_time_step(RXMeshStatic& rx, const VertexAttribute<T>& coords)
+{
+    auto e_len = *rx.add_edge_attribute<T>("eLen", 1);
+
+    rx.run_query_kernel<Op::EV, 256>(
+        [=] __device__(const EdgeHandle& eh, const VertexIterator& ev) mutable {
+            e_len(eh) =
+                glm::distance(coords.to_glm<3>(ev[0]), coords.to_glm<3>(ev[1]));
+        });
+
+    ReduceHandle rh(e_len);
+    const T      h = rh.reduce(e_len, cub::Sum(), 0) / T(rx.get_num_edges());
+
+    rx.remove_attribute("eLen");
+
+    return h * h;
+}
+
+/**
+ * @brief assemble the heat matrix (M + tL) and the Poisson matrix L from the
+ * (shared) Laplacian operator where L is the (positive semi-definite) cotan
+ * Laplacian and M is the lumped mass matrix. The row/column of the vertex pin
+ * in the Poisson matrix is replaced by the identity such that the matrix is
+ * positive definite (the distance is only defined up to a constant which is
+ * fixed later)
+ */
+template <typename T>
+void heat_setup(const RXMeshStatic&         rx,
+                const LaplacianOperator<T>& lap,
+                const T                     t,
+                const VertexHandle          pin,
+                SparseMatrix<T>&            heat_mat,
+                SparseMatrix<T>&            poisson_mat)
+{
+    lap.assemble(heat_mat, T(1), t);
+    lap.assemble(poisson_mat, T(0), T(1));
+
+    rx.run_query_kernel<Op::EV, 256>(
+        [=] __device__(const EdgeHandle&     eh,
+                       const VertexIterator& ev) mutable {
+            if (ev[0] == pin || ev[1] == pin) {
+                poisson_mat(ev[0], ev[1]) = T(0);
+                poisson_mat(ev[1], ev[0]) = T(0);
+            }
+        });
+
+    rx.for_each_vertex(DEVICE,
+                       [=] __device__(const VertexHandle& vh) mutable {
+                           if (vh == pin) {
+                               poisson_mat(vh, vh) = T(1);
+                           }
+                       });
+}
+
+/**
+ * @brief the right-hand side of the Poisson equation for all the columns (one
+ * per source set) of the heat u in one pass over the faces. Every face
+ * computes the normalized gradient of the heat X = -grad(u)/|grad(u)| and
+ * scatters its (negated) integrated divergence to its three vertices. The
+ * gradient is never stored
+ */
+template <typename T>
+void heat_divergence(const RXMeshStatic&       rx,
+                     const VertexAttribute<T>& coords,
+                     const VertexHandle        pin,
+                     const DenseMatrix<T>&     u,
+                     DenseMatrix<T>&           div)
+{
+    div.reset(0, DEVICE);
+
+    const int num_sources = u.cols();
+
+    rx.run_query_kernel<Op::FV, 256>(
+        [=] __device__(const FaceHandle&     fh,
+                       const VertexIterator& fv) mutable {
+            const vec3<T> p[3] = {coords.to_glm<3>(fv[0]),
+                                  coords.to_glm<3>(fv[1]),
+                                  coords.to_glm<3>(fv[2])};
+
+            const vec3<T> N           = glm::cross(p[1] - p[0], p[2] - p[0]);
+            const T       double_area = glm::length(N);
+            if (double_area <= std::numeric_limits<T>::min()) {
+                return;
+            }
+            const vec3<T> n = N / double_area;
+
+            // the cotan of the angle at every vertex
+            T cot[3];
+            for (int i = 0; i < 3; ++i) {
+                const vec3<T> a = p[(i + 1) % 3] - p[i];
+                const vec3<T> b = p[(i + 2) % 3] - p[i];
+                cot[i] = glm::dot(a, b) / glm::length(glm::cross(a, b));
+            }
+
+            for (int s = 0; s < num_sources; ++s) {
+                vec3<T> grad(0, 0, 0);
+                for (int i = 0; i < 3; ++i) {
+                    const vec3<T> e = p[(i + 2) % 3] - p[(i + 1) % 3];
+                    grad += u(fv[i], s) * glm::cross(n, e);
+                }
+
+                const T len = glm::length(grad);
+                if (len <= std::numeric_limits<T>::min()) {
+                    continue;
+                }
+                const vec3<T> X = -grad / len;
+
+                for (int i = 0; i < 3; ++i) {
+                    if (fv[i] == pin) {
+                        continue;
+                    }
+                    const int j = (i + 1) % 3;
+                    const int k = (i + 2) % 3;
+
+                    const T d = T(0.5) * (cot[k] * glm::dot(p[j] - p[i], X) +
+                                          cot[j] * glm::dot(p[k] - p[i], X));
+
+                    ::atomicAdd(&div(fv[i], s), -d);
+                }
+            }
+        });
+}
+
+template <typename T>
+__global__ static void heat_origin(const DenseMatrix<T> dist,
+                                   const VertexHandle*  d_seeds,
+                                   const int            num_sources,
+                                   T*                   d_origin)
+{
+    const int s = threadIdx.x + blockIdx.x * blockDim.x;
+    if (s < num_sources) {
+        d_origin[s] = dist(d_seeds[s], s);
+    }
+}
+
+/**
+ * @brief shift the distance of every source set such that it is zero at (the
+ * first vertex of) the source set
+ */
+template <typename T>
+void heat_shift(const RXMeshStatic& rx,
+                const VertexHandle* d_seeds,
+                T*                  d_origin,
+                DenseMatrix<T>&     dist)
+{
+    const int num_sources = dist.cols();
+
+    heat_origin<<<DIVIDE_UP(num_sources, 256), 256>>>(
+        dist, d_seeds, num_sources, d_origin);
+
+    rx.for_each_vertex(
+        DEVICE, [=] __device__(const VertexHandle& vh) mutable {
+            for (int s = 0; s < num_sources; ++s) {
+                dist(vh, s) = std::max(T(0), dist(vh, s) - d_origin[s]);
+            }
+        });
+}
+
+/**
+ * @brief heat method geodesic distance where the two factorizations are
+ * computed once (in the constructor) and reused by every call to compute()
+ */
+template <typename T>
+struct HeatGeodesic
+{
+    HeatGeodesic(RXMeshStatic& rx, const VertexAttribute<T>& coords)
+        : m_rx(rx),
+          m_coords(coords),
+          m_heat_mat(rx),
+          m_poisson_mat(rx),
+          m_heat_solver(&m_heat_mat),
+          m_poisson_solver(&m_poisson_mat),
+          m_d_seeds(nullptr),
+          m_d_origin(nullptr),
+          m_capacity(0)
+    {
+        m_rx.for_each_vertex(
+            HOST,
+            [&](const VertexHandle& vh) {
+                if (!m_pin.is_valid()) {
+                    m_pin = vh;
+                }
+            },
+            NULL,
+            false);
+
+        const T t = heat_time_step(m_rx, m_coords);
+
+        // the Laplacian is attached to the mesh and shared with any other
+        // stage that uses the same coordinates
+        auto lap = get_laplacian_operator(
+            m_rx, m_coords, LaplacianMass::Barycentric);
+
+        heat_setup(m_rx, *lap, t, m_pin, m_heat_mat, m_poisson_mat);
+
+        m_heat_solver.pre_solve(m_rx);
+        m_poisson_solver.pre_solve(m_rx);
+    }
+
+    HeatGeodesic(const HeatGeodesic&)            = delete;
+    HeatGeodesic& operator=(const HeatGeodesic&) = delete;
+
+    /**
+     * @brief compute the distance to every source set (given as global vertex
+     * ids) where the distance to sources[s] is written to column s of dist
+     * (#vertices x sources.size()) on the device
+     */
+    void compute(const std::vector<std::vector<uint32_t>>& sources,
+                 DenseMatrix<T>&                          dist)
+    {
+        const int num_sources = sources.size();
+
+        if (dist.cols() != num_sources ||
+            dist.rows() != m_rx.get_num_vertices()) {
+            RXMESH_ERROR(
+                "HeatGeodesic::compute() the output size ({}, {}) does not "
+                "match the number of vertices ({}) and the number of source "
+                "sets ({})",
+                dist.rows(),
+                dist.cols(),
+                m_rx.get_num_vertices(),
+                num_sources);
+            return;
+        }
+
+        alloc(num_sources);
+
+        // the initial heat i.e., one at the sources
+        std::unordered_map<uint32_t, std::vector<int>> v_sources;
+        for (int s = 0; s < num_sources; ++s) {
+            for (uint32_t v : sources[s]) {
+                v_sources[v].push_back(s);
+            }
+        }
+
+        std::vector<VertexHandle> h_seeds(num_sources);
+        m_delta.reset(0, HOST);
+        m_rx.for_each_vertex(
+            HOST,
+            [&](const VertexHandle& vh) {
+                auto it = v_sources.find(m_rx.map_to_global(vh));
+                if (it != v_sources.end()) {
+                    for (int s : it->second) {
+                        m_delta(vh, s) = T(1);
+                        if (sources[s][0] == it->first) {
+                            h_seeds[s] = vh;
+                        }
+                    }
+                }
+            },
+            NULL,
+            false);
+        m_delta.move(HOST, DEVICE);
+
+        CUDA_ERROR(cudaMemcpy(m_d_seeds,
+                              h_seeds.data(),
+                              num_sources * sizeof(VertexHandle),
+                              cudaMemcpyHostToDevice));
+
+        // 1) heat flow
+        m_heat_solver.solve(m_delta, m_u);
+
+        // 2+3) normalized gradient and its divergence
+        heat_divergence(m_rx, m_coords, m_pin, m_u, m_div);
+
+        // 4) Poisson
+        m_poisson_solver.solve(m_div, dist);
+
+        heat_shift(m_rx, m_d_seeds, m_d_origin, dist);
+    }
+
+    void release()
+    {
+        m_heat_mat.release();
+        m_poisson_mat.release();
+        if (m_capacity > 0) {
+            m_delta.release();
+            m_u.release();
+            m_div.release();
+        }
+        GPU_FREE(m_d_seeds);
+        GPU_FREE(m_d_origin);
+    }
+
+   private:
+    void alloc(const int num_sources)
+    {
+        if (m_capacity == num_sources) {
+            return;
+        }
+        if (m_capacity > 0) {
+            m_delta.release();
+            m_u.release();
+            m_div.release();
+            GPU_FREE(m_d_seeds);
+            GPU_FREE(m_d_origin);
+        }
+        const int n = m_rx.get_num_vertices();
+        m_delta     = DenseMatrix<T>(m_rx, n, num_sources);
+        m_u         = DenseMatrix<T>(m_rx, n, num_sources);
+        m_div       = DenseMatrix<T>(m_rx, n, num_sources);
+        CUDA_ERROR(cudaMalloc((void**)&m_d_seeds,
+                              num_sources * sizeof(VertexHandle)));
+        CUDA_ERROR(cudaMalloc((void**)&m_d_origin, num_sources * sizeof(T)));
+        m_capacity = num_sources;
+    }
+
+    RXMeshStatic&                   m_rx;
+    const VertexAttribute<T>&       m_coords;
+    VertexHandle                    m_pin;
+    SparseMatrix<T>                 m_heat_mat;
+    SparseMatrix<T>                 m_poisson_mat;
+    CholeskySolver<SparseMatrix<T>> m_heat_solver;
+    CholeskySolver<SparseMatrix<T>> m_poisson_solver;
+    DenseMatrix<T>                  m_delta;
+    DenseMatrix<T>                  m_u;
+    DenseMatrix<T>                  m_div;
+    VertexHandle*                   m_d_seeds;
+    T*                              m_d_origin;
+    int                             m_capacity;
+};
+
 
 int main(int argc, char** argv)
 {
     rx_init(0);
 
-    RXMeshStatic rx(STRINGIFY(INPUT_DIR) "sphere3.obj");
+    std::string obj_file_name = STRINGIFY(INPUT_DIR) "sphere3.obj";
+    int         num_sources   = 1;
+    int         batch_size    = 32;
+
+    if (cmd_option_exists(argv, argc + argv, "-h")) {
+        // clang-format off
+        RXMESH_INFO("\nUsage: Heat.exe < -option X>\n"
+                    " -h:              Display this massage and exit\n"
+                    " -input:          Input OBJ mesh file. Default is {} \n"
+                    " -num_sources:    Number of (random) source vertices i.e., distance fields. Default is {}\n"
+                    " -batch:          Number of sources solved at once. Default is {}",
+                    obj_file_name, num_sources, batch_size);
+        // clang-format on
+        exit(EXIT_SUCCESS);
+    }
+    if (cmd_option_exists(argv, argc + argv, "-input")) {
+        obj_file_name =
+            std::string(get_cmd_option(argv, argv + argc, "-input"));
+    }
+    if (cmd_option_exists(argv, argc + argv, "-num_sources")) {
+        num_sources = atoi(get_cmd_option(argv, argv + argc, "-num_sources"));
+    }
+    if (cmd_option_exists(argv, argc + argv, "-batch")) {
+        batch_size = atoi(get_cmd_option(argv, argv + argc, "-batch"));
+    }
+    num_sources = std::max(1, num_sources);
+    batch_size  = std::max(1, std::min(batch_size, num_sources));
+
+    RXMeshStatic rx(obj_file_name);
+
+    auto coords = rx.get_input_vertex_coordinates();
+
+    CPUTimer timer;
+    GPUTimer gtimer;
+
+    timer.start();
+    gtimer.start();
+    HeatGeodesic<float> heat(rx, *coords);
+    timer.stop();
+    gtimer.stop();
+    RXMESH_INFO("Heat: setup and factorization took {} (ms)",
+                std::max(timer.elapsed_millis(), gtimer.elapsed_millis()));
+
+    std::mt19937                            rng(0);
+    std::uniform_int_distribution<uint32_t> dist(0, rx.get_num_vertices() - 1);
+
+    DenseMatrix<float> geo(rx, rx.get_num_vertices(), batch_size);
+
+    float solve_time = 0;
+
+    for (int b = 0; b < num_sources; b += batch_size) {
+        const int n = std::min(batch_size, num_sources - b);
+
+        std::vector<std::vector<uint32_t>> sources(n);
+        for (auto& s : sources) {
+            s.push_back(dist(rng));
+        }
+
+        if (n != geo.cols()) {
+            geo.release();
+            geo = DenseMatrix<float>(rx, rx.get_num_vertices(), n);
+        }
+
+        timer.start();
+        gtimer.start();
+        heat.compute(sources, geo);
+        timer.stop();
+        gtimer.stop();
+        solve_time += std::max(timer.elapsed_millis(), gtimer.elapsed_millis());
+    }
+
+    RXMESH_INFO("Heat: {} sources in batches of {} took {} (ms), {} (ms) per "
+                "source",
+                num_sources,
+                batch_size,
+                solve_time,
+                solve_time / float(num_sources));
 
 #if USE_POLYSCOPE
+    geo.move(DEVICE, HOST);
+    auto geo_attr = *rx.add_vertex_attribute<float>("geo", 1);
+    rx.for_each_vertex(
+        HOST, [&](const VertexHandle& vh) { geo_attr(vh) = geo(vh, 0); });
+    rx.get_polyscope_mesh()->addVertexScalarQuantity("geo", geo_attr);
     polyscope::show();
 #endif
-}
\ No newline at end of file
+
+    geo.release();
+    heat.release();
+}
@@ -20,12 +20,17 @@ struct arg
     bool        use_uniform_laplace  = true;
     std::string gmg_csolver          = "cholesky";
     std::string gmg_sampling         = "random";
+    std::string gmg_smoother         = "jacobi";
     int         gmg_levels           = 5;
     int         gmg_threshold        = 1000;
     bool        gmg_render_hierarchy = false;
     bool        create_mat           = false;
     bool        gmg_pruned_ptap      = false;
     bool        gmg_verify_ptap      = false;
+    bool        benchmark            = false;
+    std::string input_dir            = "";
+    std::string backends =
+        "cg,pcg,cg_mat_free,pcg_mat_free,chol,cudss_chol,gmg,gmg_pcg";
     char**      argv;
     int         argc;
 } Arg;
@@ -34,6 +39,7 @@ struct arg
 #include "mcf_cg_mat_free.h"
 #include "mcf_chol.h"
 #include "mcf_gmg.h"
+#include "mcf_benchmark.h"
 
 #ifdef USE_CUDSS
 #include "mcf_cudss.h"
@@ -99,6 +105,11 @@ TEST(App, MCF)
     // Select device
     cuda_query(Arg.device_id);
 
+    if (Arg.benchmark) {
+        mcf_benchmark<dataT>(Arg.input_dir, Arg.obj_file_name, Arg.backends);
+        return;
+    }
+
     RXMeshStatic rx(Arg.obj_file_name, "", 256);
 
     ASSERT_TRUE(rx.is_edge_manifold());
@@ -116,6 +127,10 @@ TEST(App, MCF)
         mcf_gmg<dataT>(rx,
                        string_to_coarse_solver(Arg.gmg_csolver),
                        string_to_sampling(Arg.gmg_sampling));
+    } else if (Arg.solver == "gmg_pcg") {
+        mcf_gmg_pcg<dataT>(rx,
+                           string_to_coarse_solver(Arg.gmg_csolver),
+                           string_to_sampling(Arg.gmg_sampling));
     } else if (Arg.solver == "chol") {
         mcf_cusolver_chol<dataT>(rx, string_to_permute_method(Arg.perm_method));
 #ifdef USE_CUDSS
@@ -145,19 +160,23 @@ int main(int argc, char** argv)
                         " -uniform_laplace:   Toggle the use of uniform Laplace weights. Default is {}\n"
                         " -dt:                Time step (delta t). Default is {}\n"
                         "                     Hint: should be between (0.001, 1) for cotan Laplace or between (1, 100) for uniform Laplace\n"
-                        " -solver:            Solver to use. Options are cg_mat_free, pcg_mat_free, cg, pcg, chol, cudss_chol, or gmg. Default is {}\n"                         
-                        " -perm:              Permutation method for Cholesky factorization (symrcm, symamd, nstdis, gpumgnd, gpund). Default is {}\n"
+                        " -solver:            Solver to use. Options are cg_mat_free, pcg_mat_free, cg, pcg, chol, cudss_chol, gmg, or gmg_pcg. Default is {}\n"                         
+                        " -perm:              Permutation method for Cholesky factorization (symrcm, symamd, nstdis, gpumgnd, gpund, auto). Default is {}\n"
                         " -max_iter:          Maximum number of iterations for iterative solvers. Default is {}\n"                                            
                         " -tol_abs:           Iterative solver absolute tolerance. Default is {}\n"
                         " -tol_rel:           Iterative solver relative tolerance. Default is {}\n"
                         " -create_mat:        Export the linear system matrices (.mtx) and mesh obj to files and exit. Default is {}\n"
                         " -gmg_levels:        GMG number of levels in the hierarchy, includes the finest level. Default is {}\n"
-                        " -gmg_csolver:       GMG coarse solver (jacobi, cholesky, cudsscholesky). Default is {}\n"
-                        " -gmg_sampling:      GMG sampling method to create the hierarchy (random, fps, kmeans). Default is {}\n"
+                        " -gmg_csolver:       GMG coarse solver (jacobi, gs, cholesky, cudsscholesky). Default is {}\n"
+                        " -gmg_sampling:      GMG sampling method to create the hierarchy (random, fps, bfps, kmeans). Default is {}\n"
+                        " -gmg_smoother:      GMG smoother (jacobi, gs, chebyshev) or a comma-separated list with one smoother per level starting from the finest level. Default is {}\n"
                         " -gmg_threshold:     GMG threshold for the coarsest level in the hierarchy, i.e., number of vertices in the coarsest level. Default is {}\n"
                         " -gmg_pruned_ptap:   GMG toggle using pruned PtAP for fast construction. Default is {}\n"
                         " -gmg_verify_ptap:   GMG toggle verifying the construction of PtAP. Default is {}\n"
                         " -gmg_rh:            GMG toggle rendering the hierarchy. Default is {}\n"
+                        " -benchmark:         Run all the backends in -backends and write the per-phase timings (setup, permute, factorize, solve), iterations, and memory to JSON. Default is {}\n"
+                        " -input_dir:         With -benchmark, run on all the OBJ files in this folder instead of -input. Default is {}\n"
+                        " -backends:          With -benchmark, comma-separated list of the backends (same names as -solver). GMG backends accept a sampling suffix to override -gmg_sampling, e.g., gmg:fps,gmg:bfps. Default is {}\n"
                         " -device_id:         GPU device ID. Default is {}\n",
             Arg.obj_file_name, Arg.output_folder,  
             (Arg.use_uniform_laplace? "true" : "false"), 
@@ -171,10 +190,14 @@ int main(int argc, char** argv)
             Arg.gmg_levels,
             Arg.gmg_csolver,
             Arg.gmg_sampling,
+            Arg.gmg_smoother,
             Arg.gmg_threshold,
             (Arg.gmg_pruned_ptap? "true" : "false"),
             (Arg.gmg_verify_ptap? "true" : "false"),
             (Arg.gmg_render_hierarchy? "true" : "false"),            
+            (Arg.benchmark? "true" : "false"),
+            Arg.input_dir,
+            Arg.backends,
             Arg.device_id);
             // clang-format on
             exit(EXIT_SUCCESS);
@@ -236,6 +259,10 @@ int main(int argc, char** argv)
             Arg.gmg_sampling =
                 std::string(get_cmd_option(argv, argv + argc, "-gmg_sampling"));
         }
+        if (cmd_option_exists(argv, argc + argv, "-gmg_smoother")) {
+            Arg.gmg_smoother =
+                std::string(get_cmd_option(argv, argv + argc, "-gmg_smoother"));
+        }
         if (cmd_option_exists(argv, argc + argv, "-gmg_rh")) {
             Arg.gmg_render_hierarchy = !Arg.gmg_render_hierarchy;
         }
@@ -249,6 +276,17 @@ int main(int argc, char** argv)
         if (cmd_option_exists(argv, argc + argv, "-gmg_verify_ptap")) {
             Arg.gmg_verify_ptap = !Arg.gmg_verify_ptap;
         }
+        if (cmd_option_exists(argv, argc + argv, "-benchmark")) {
+            Arg.benchmark = true;
+        }
+        if (cmd_option_exists(argv, argc + argv, "-input_dir")) {
+            Arg.input_dir =
+                std::string(get_cmd_option(argv, argv + argc, "-input_dir"));
+        }
+        if (cmd_option_exists(argv, argc + argv, "-backends")) {
+            Arg.backends =
+                std::string(get_cmd_option(argv, argv + argc, "-backends"));
+        }
     }
 
     RXMESH_INFO("input= {}", Arg.obj_file_name);
@@ -268,6 +306,9 @@ int main(int argc, char** argv)
     RXMESH_INFO("gmg_pruned_ptap= {}", Arg.gmg_pruned_ptap);
     RXMESH_INFO("gmg_verify_ptap= {}", Arg.gmg_verify_ptap);
     RXMESH_INFO("gmg_render_hierarchy= {}", Arg.gmg_render_hierarchy);
+    RXMESH_INFO("benchmark= {}", Arg.benchmark);
+    RXMESH_INFO("input_dir= {}", Arg.input_dir);
+    RXMESH_INFO("backends= {}", Arg.backends);
     RXMESH_INFO("device_id= {}", Arg.device_id);
 
     return RUN_ALL_TESTS();
@@ -0,0 +1,442 @@
+#pragma once
+
+#include <algorithm>
+#include <filesystem>
+#include <limits>
+#include <map>
+#include <sstream>
+
+#include "rxmesh/attribute.h"
+#include "rxmesh/matrix/cg_mat_free_attr_solver.h"
+#include "rxmesh/matrix/cg_solver.h"
+#include "rxmesh/matrix/cholesky_solver.h"
+#include "rxmesh/matrix/dense_matrix.h"
+#include "rxmesh/matrix/gmg/gmg_preconditioner.h"
+#include "rxmesh/matrix/gmg_solver.h"
+#include "rxmesh/matrix/pcg_mat_free_attr_solver.h"
+#include "rxmesh/matrix/pcg_solver.h"
+#include "rxmesh/matrix/sparse_matrix.h"
+#include "rxmesh/rxmesh_static.h"
+#include "rxmesh/util/report.h"
+#include "rxmesh/util/timer.h"
+
+#ifdef USE_CUDSS
+#include "rxmesh/matrix/cudss_cholesky_solver.h"
+#endif
+
+#include "mcf_kernels.cuh"
+
+/**
+ * The timings (in ms) and the memory of one backend on one mesh. setup is the
+ * assembly of the linear system, permute is the fill-reducing reordering
+ * (direct solvers only), factorize is everything else done before the solve
+ * (i.e., the symbolic and numeric factorization of the direct solvers, the
+ * hierarchy construction of GMG, or the pre_solve of CG), and memory is the
+ * peak increase in the used device memory while running the backend
+ */
+struct MCFBenchmarkResult
+{
+    std::string backend;
+    float       setup_ms       = 0;
+    float       permute_ms     = 0;
+    float       factorize_ms   = 0;
+    float       solve_ms       = 0;
+    int         iterations     = -1;
+    float       final_residual = -1;
+    double      memory_mb      = 0;
+    bool        skipped        = false;
+
+    float total_ms() const
+    {
+        return setup_ms + permute_ms + factorize_ms + solve_ms;
+    }
+
+    std::map<std::string, double> to_map() const
+    {
+        return {{"setup (ms)", setup_ms},
+                {"permute (ms)", permute_ms},
+                {"factorize (ms)", factorize_ms},
+                {"solve (ms)", solve_ms},
+                {"total (ms)", total_ms()},
+                {"iterations", iterations},
+                {"final_residual", final_residual},
+                {"memory (MB)", memory_mb}};
+    }
+};
+
+/**
+ * mcf_device_used_bytes() the device memory in use (by any allocation)
+ */
+inline size_t mcf_device_used_bytes()
+{
+    CUDA_ERROR(cudaDeviceSynchronize());
+    size_t free_bytes, total_bytes;
+    CUDA_ERROR(cudaMemGetInfo(&free_bytes, &total_bytes));
+    return total_bytes - free_bytes;
+}
+
+/**
+ * Time one phase (the max of the CPU and GPU timers like the other MCF
+ * drivers) and record the device memory in use after it
+ */
+struct MCFPhaseTimer
+{
+    size_t base_bytes = mcf_device_used_bytes();
+    size_t peak_bytes = base_bytes;
+
+    template <typename FuncT>
+    void operator()(float& phase_ms, FuncT func)
+    {
+        CPUTimer timer;
+        GPUTimer gtimer;
+        timer.start();
+        gtimer.start();
+        func();
+        timer.stop();
+        gtimer.stop();
+        phase_ms += std::max(timer.elapsed_millis(), gtimer.elapsed_millis());
+        peak_bytes = std::max(peak_bytes, mcf_device_used_bytes());
+    }
+
+    double memory_mb() const
+    {
+        return BYTES_TO_MEGABYTES(peak_bytes - base_bytes);
+    }
+};
+
+/**
+ * mcf_benchmark_backend() run one backend (same names as -solver) on rx. The
+ * GMG backends take an optional sampling suffix that overrides -gmg_sampling
+ * (e.g., gmg:fps and gmg:bfps) to compare the setup time and the convergence
+ * of the hierarchies built with different sampling methods on the same mesh
+ */
+template <typename T>
+MCFBenchmarkResult mcf_benchmark_backend(rxmesh::RXMeshStatic& rx,
+                                         const std::string&    name)
+{
+    using namespace rxmesh;
+    constexpr uint32_t blockThreads = 256;
+
+    MCFBenchmarkResult res;
+    res.backend = name;
+
+    const size_t      sep      = name.find(':');
+    const std::string backend  = name.substr(0, sep);
+    const Sampling    sampling = string_to_sampling(
+        sep == std::string::npos ? Arg.gmg_sampling : name.substr(sep + 1));
+
+    const bool mat_free = backend == "cg_mat_free" || backend == "pcg_mat_free";
+
+    if (mat_free && !rx.is_closed()) {
+        RXMESH_WARN(
+            "mcf_benchmark_backend() skipping {} since the mesh is not closed",
+            backend);
+        res.skipped = true;
+        return res;
+    }
+#ifndef USE_CUDSS
+    if (backend == "cudss_chol") {
+        RXMESH_WARN(
+            "mcf_benchmark_backend() skipping {} since RXMesh is not built "
+            "with cuDSS",
+            backend);
+        res.skipped = true;
+        return res;
+    }
+#endif
+
+    auto coords = rx.get_input_vertex_coordinates();
+
+    MCFPhaseTimer phase;
+
+    if (mat_free) {
+        auto B = rx.add_vertex_attribute<T>("benchB", 3, DEVICE, SoA);
+        auto X = rx.add_vertex_attribute<T>("benchX", 3, DEVICE);
+
+        LaunchBox<blockThreads> lb, mlb, plb;
+        rx.prepare_launch_box({Op::VV},
+                              lb,
+                              (void*)init_B<T, blockThreads>,
+                              !Arg.use_uniform_laplace);
+        rx.prepare_launch_box({Op::VV},
+                              mlb,
+                              (void*)matvec<T, blockThreads>,
+                              !Arg.use_uniform_laplace);
+        rx.prepare_launch_box({Op::VV},
+                              plb,
+                              (void*)precond_matvec<T, blockThreads>,
+                              !Arg.use_uniform_laplace);
+
+        phase(res.setup_ms, [&]() {
+            B->reset(0.0, DEVICE);
+            X->copy_from(*coords, DEVICE, DEVICE);
+            rx.run_kernel(
+                lb, init_B<T, blockThreads>, *X, *B, Arg.use_uniform_laplace);
+        });
+
+        auto mat_vec = [&](const VertexAttribute<T>& in,
+                           VertexAttribute<T>&       out,
+                           cudaStream_t              stream) {
+            rx.run_kernel(mlb,
+                          matvec<T, blockThreads>,
+                          stream,
+                          *coords,
+                          in,
+                          out,
+                          Arg.use_uniform_laplace,
+                          Arg.time_step);
+        };
+
+        auto precond_mat_vec = [&](const VertexAttribute<T>& in,
+                                   VertexAttribute<T>&       out,
+                                   cudaStream_t              stream) {
+            rx.run_kernel(plb,
+                          precond_matvec<T, blockThreads>,
+                          stream,
+                          *coords,
+                          in,
+                          out,
+                          Arg.use_uniform_laplace,
+                          Arg.time_step);
+        };
+
+        auto run = [&](auto& solver) {
+            phase(res.factorize_ms, [&]() { solver.pre_solve(*B, *X); });
+            phase(res.solve_ms, [&]() { solver.solve(*B, *X); });
+            res.iterations     = solver.iter_taken();
+            res.final_residual = solver.final_residual();
+        };
+
+        if (backend == "cg_mat_free") {
+            CGMatFreeAttrSolver<T, VertexHandle> solver(rx,
+                                                        mat_vec,
+                                                        3,
+                                                        Arg.max_num_iter,
+                                                        Arg.tol_abs,
+                                                        Arg.tol_rel);
+            run(solver);
+        } else {
+            PCGMatFreeAttrSolver<T, VertexHandle> solver(rx,
+                                                         mat_vec,
+                                                         precond_mat_vec,
+                                                         3,
+                                                         Arg.max_num_iter,
+                                                         Arg.tol_abs,
+                                                         Arg.tol_rel);
+            run(solver);
+        }
+
+        rx.remove_attribute("benchB");
+        rx.remove_attribute("benchX");
+
+        res.memory_mb = phase.memory_mb();
+        return res;
+    }
+
+    SparseMatrix<T> A_mat;
+    DenseMatrix<T>  B_mat;
+    DenseMatrix<T>  X_mat;
+
+    phase(res.setup_ms, [&]() {
+        A_mat = SparseMatrix<T>(rx);
+        B_mat = DenseMatrix<T>(rx, rx.get_num_vertices(), 3);
+        X_mat = *coords->to_matrix();
+
+        rx.run_kernel<blockThreads>({Op::VV},
+                                    mcf_B_setup<T, blockThreads>,
+                                    *coords,
+                                    B_mat,
+                                    Arg.use_uniform_laplace);
+
+        rx.run_kernel<blockThreads>({Op::VV},
+                                    mcf_A_setup<T, blockThreads>,
+                                    *coords,
+                                    A_mat,
+                                    Arg.use_uniform_laplace,
+                                    Arg.time_step);
+    });
+
+    auto run_iterative = [&](auto& solver) {
+        phase(res.factorize_ms, [&]() { solver.pre_solve(B_mat, X_mat); });
+        phase(res.solve_ms, [&]() { solver.solve(B_mat, X_mat); });
+        res.iterations     = solver.iter_taken();
+        res.final_residual = solver.final_residual();
+    };
+
+    const PermuteMethod perm = string_to_permute_method(Arg.perm_method);
+
+    if (backend == "cg") {
+        CGSolver<T> solver(
+            A_mat, X_mat.cols(), Arg.max_num_iter, Arg.tol_abs, Arg.tol_rel);
+        run_iterative(solver);
+    } else if (backend == "pcg") {
+        PCGSolver<T> solver(
+            A_mat, X_mat.cols(), Arg.max_num_iter, Arg.tol_abs, Arg.tol_rel);
+        run_iterative(solver);
+    } else if (backend == "gmg") {
+        GMGSolver solver(rx,
+                         A_mat,
+                         Arg.max_num_iter,
+                         Arg.gmg_levels,
+                         2,
+                         2,
+                         string_to_coarse_solver(Arg.gmg_csolver),
+                         sampling,
+                         Arg.tol_abs,
+                         Arg.tol_rel,
+                         Arg.gmg_threshold,
+                         Arg.gmg_pruned_ptap,
+                         Arg.gmg_verify_ptap);
+        solver.set_smoothers(string_to_smoothers(Arg.gmg_smoother));
+        run_iterative(solver);
+    } else if (backend == "gmg_pcg") {
+        PCGSolver<T> solver(
+            A_mat, X_mat.cols(), Arg.max_num_iter, Arg.tol_abs, Arg.tol_rel);
+        GMGPreconditioner<T> gmg(rx,
+                                 A_mat,
+                                 Arg.gmg_levels,
+                                 2,
+                                 2,
+                                 string_to_coarse_solver(Arg.gmg_csolver),
+                                 sampling,
+                                 Arg.gmg_threshold,
+                                 Arg.gmg_pruned_ptap);
+        gmg.set_smoothers(string_to_smoothers(Arg.gmg_smoother));
+        gmg.attach(solver);
+        run_iterative(solver);
+    } else if (backend == "chol") {
+        CholeskySolver solver(&A_mat, perm);
+        phase(res.permute_ms, [&]() {
+            solver.permute_alloc();
+            solver.permute(rx);
+            solver.premute_value_ptr();
+        });
+        phase(res.factorize_ms, [&]() {
+            solver.analyze_pattern();
+            solver.post_analyze_alloc();
+            solver.factorize();
+        });
+        phase(res.solve_ms, [&]() { solver.solve(B_mat, X_mat); });
+#ifdef USE_CUDSS
+    } else if (backend == "cudss_chol") {
+        cuDSSCholeskySolver solver(&A_mat, perm);
+        phase(res.permute_ms, [&]() { solver.permute(rx, B_mat, X_mat); });
+        phase(res.factorize_ms, [&]() {
+            solver.analyze_pattern();
+            solver.factorize();
+        });
+        phase(res.solve_ms, [&]() { solver.solve(B_mat, X_mat); });
+#endif
+    } else {
+        RXMESH_ERROR("mcf_benchmark_backend() unrecognized backend {}",
+                     backend);
+        res.skipped = true;
+    }
+
+    res.memory_mb = phase.memory_mb();
+
+    A_mat.release();
+    B_mat.release();
+    X_mat.release();
+
+    return res;
+}
+
+/**
+ * mcf_benchmark() run every backend in the comma-separated list backends on
+ * every OBJ file in the input directory (or only the input mesh if the input
+ * directory is empty). One JSON report per mesh is written to
+ * output_folder/rxmesh with one sub-object per backend that has the per-phase
+ * timings along with the fastest backend (by total time) for this mesh
+ */
+template <typename T>
+void mcf_benchmark(const std::string& input_dir,
+                   const std::string& input_file,
+                   const std::string& backends)
+{
+    using namespace rxmesh;
+
+    std::vector<std::string> files;
+    if (input_dir.empty()) {
+        files.push_back(input_file);
+    } else {
+        for (const auto& entry :
+             std::filesystem::directory_iterator(input_dir)) {
+            if (entry.path().extension() == ".obj") {
+                files.push_back(entry.path().string());
+            }
+        }
+        std::sort(files.begin(), files.end());
+    }
+
+    std::vector<std::string> names;
+    {
+        std::stringstream ss(backends);
+        std::string       name;
+        while (std::getline(ss, name, ',')) {
+            if (!name.empty()) {
+                names.push_back(name);
+            }
+        }
+    }
+
+    for (const std::string& file : files) {
+        RXMeshStatic rx(file, "", 256);
+
+        if (!rx.is_edge_manifold()) {
+            RXMESH_WARN("mcf_benchmark() skipping {} since it is not edge "
+                        "manifold",
+                        file);
+            continue;
+        }
+
+        Report report("MCF_Benchmark");
+        report.command_line(Arg.argc, Arg.argv);
+        report.device();
+        report.system();
+        report.model_data(file, rx);
+        report.add_member("application", std::string("MCF"));
+        report.add_member("time_step", Arg.time_step);
+        report.add_member("use_uniform_laplace", Arg.use_uniform_laplace);
+        report.add_member("tol_abs", Arg.tol_abs);
+        report.add_member("tol_rel", Arg.tol_rel);
+        report.add_member("max_num_iter", Arg.max_num_iter);
+        report.add_member("PermuteMethod", Arg.perm_method);
+
+        std::string fastest;
+        float       fastest_ms = std::numeric_limits<float>::max();
+
+        for (const std::string& backend : names) {
+            MCFBenchmarkResult res = mcf_benchmark_backend<T>(rx, backend);
+            if (res.skipped) {
+                continue;
+            }
+
+            RXMESH_INFO(
+                "{} on {}: setup= {}, permute= {}, factorize= {}, solve= {}, "
+                "total= {} (ms), #iter= {}, memory= {} (MB)",
+                backend,
+                extract_file_name(file),
+                res.setup_ms,
+                res.permute_ms,
+                res.factorize_ms,
+                res.solve_ms,
+                res.total_ms(),
+                res.iterations,
+                res.memory_mb);
+
+            report.add_object(backend, res.to_map());
+
+            if (res.total_ms() < fastest_ms) {
+                fastest_ms = res.total_ms();
+                fastest    = backend;
+            }
+        }
+
+        report.add_member("fastest_backend", fastest);
+        report.add_member("fastest_total (ms)", fastest_ms);
+
+        report.write(Arg.output_folder + "/rxmesh",
+                     "MCF_Benchmark_" + extract_file_name(file));
+    }
+}
@@ -4,7 +4,9 @@
 #include "rxmesh/matrix/sparse_matrix.h"
 #include "rxmesh/rxmesh_static.h"
 
+#include "rxmesh/matrix/gmg/gmg_preconditioner.h"
 #include "rxmesh/matrix/gmg_solver.h"
+#include "rxmesh/matrix/pcg_solver.h"
 
 #include "mcf_kernels.cuh"
 
@@ -59,6 +61,7 @@ void mcf_gmg(rxmesh::RXMeshStatic& rx,
                      Arg.gmg_threshold,
                      Arg.gmg_pruned_ptap,
                      Arg.gmg_verify_ptap);
+    solver.set_smoothers(string_to_smoothers(Arg.gmg_smoother));
 
 
     CPUTimer timer;
@@ -110,6 +113,12 @@ void mcf_gmg(rxmesh::RXMeshStatic& rx,
                       solver.gmg_memory_alloc_time());
     report.add_member("v_cycle_memory_alloc_time(ms)",
                       solver.v_cycle_memory_alloc_time());
+    report.add_member("gmg_sampling_time(ms)", solver.gmg_sampling_time());
+    report.add_member("gmg_clustering_time(ms)", solver.gmg_clustering_time());
+    report.add_member("gmg_csr_time(ms)", solver.gmg_csr_time());
+    report.add_member("gmg_prolongation_time(ms)",
+                      solver.gmg_prolongation_time());
+    report.add_member("ptap_time(ms)", solver.ptap_time());
     report.add_member("solve_time(ms)", solve_time);
     report.add_member("total_time(ms)", total_time);
     report.add_member("avg_iteration_time(ms)",
@@ -121,6 +130,7 @@ void mcf_gmg(rxmesh::RXMeshStatic& rx,
     report.add_member("gmg_verify_ptap", Arg.gmg_verify_ptap);
     report.add_member("gmg_coarse_solver", Arg.gmg_csolver);
     report.add_member("gmg_sampling", Arg.gmg_sampling);
+    report.add_member("gmg_smoother", Arg.gmg_smoother);
 
 
     X_mat.move(rxmesh::DEVICE, rxmesh::HOST);
@@ -151,3 +161,133 @@ void mcf_gmg(rxmesh::RXMeshStatic& rx,
     report.write(Arg.output_folder + "/rxmesh",
                  "MCF_" + solver.name() + extract_file_name(Arg.obj_file_name));
 }
+
+
+template <typename T>
+void mcf_gmg_pcg(rxmesh::RXMeshStatic& rx,
+                 rxmesh::CoarseSolver  csolver,
+                 rxmesh::Sampling      sampling)
+{
+    using namespace rxmesh;
+    constexpr uint32_t blockThreads = 256;
+
+    uint32_t num_vertices = rx.get_num_vertices();
+
+    auto coords = rx.get_input_vertex_coordinates();
+
+    SparseMatrix<float> A_mat(rx);
+    DenseMatrix<float>  B_mat(rx, num_vertices, 3);
+
+    DenseMatrix<float> X_mat = *(coords->to_matrix());
+
+    rx.run_kernel<blockThreads>({Op::VV},
+                                mcf_B_setup<float, blockThreads>,
+                                *coords,
+                                B_mat,
+                                Arg.use_uniform_laplace);
+
+    rx.run_kernel<blockThreads>({Op::VV},
+                                mcf_A_setup<float, blockThreads>,
+                                *coords,
+                                A_mat,
+                                Arg.use_uniform_laplace,
+                                Arg.time_step);
+
+    Report report("MCF_GMG_PCG");
+    report.command_line(Arg.argc, Arg.argv);
+    report.device();
+    report.system();
+    report.model_data(Arg.obj_file_name, rx);
+
+    PCGSolver<float> solver(
+        A_mat, X_mat.cols(), Arg.max_num_iter, Arg.tol_abs, Arg.tol_rel);
+
+    GMGPreconditioner<float> gmg(rx,
+                                 A_mat,
+                                 Arg.gmg_levels,
+                                 2,
+                                 2,
+                                 csolver,
+                                 sampling,
+                                 Arg.gmg_threshold,
+                                 Arg.gmg_pruned_ptap);
+    gmg.set_smoothers(string_to_smoothers(Arg.gmg_smoother));
+    gmg.attach(solver);
+
+    CPUTimer timer;
+    GPUTimer gtimer;
+
+    timer.start();
+    gtimer.start();
+    solver.pre_solve(B_mat, X_mat);
+    timer.stop();
+    gtimer.stop();
+
+    float pre_solve_time =
+        std::max(timer.elapsed_millis(), gtimer.elapsed_millis());
+
+    // a second pre_solve (e.g., after the matrix values changed) reuses the
+    // hierarchy and only rebuilds the coarse operators
+    timer.start();
+    gtimer.start();
+    solver.pre_solve(B_mat, X_mat);
+    timer.stop();
+    gtimer.stop();
+
+    float re_pre_solve_time =
+        std::max(timer.elapsed_millis(), gtimer.elapsed_millis());
+
+    RXMESH_INFO("GMG-PCG pre-solve took {} (ms), re-pre-solve took {} (ms)",
+                pre_solve_time,
+                re_pre_solve_time);
+
+    timer.start();
+    gtimer.start();
+    solver.solve(B_mat, X_mat);
+    timer.stop();
+    gtimer.stop();
+
+    float solve_time =
+        std::max(timer.elapsed_millis(), gtimer.elapsed_millis());
+
+    RXMESH_INFO("GMG-PCG solve took {} (ms). #iter= {}, final_residual {}",
+                solve_time,
+                solver.iter_taken(),
+                solver.final_residual());
+
+    report.add_member("solver", std::string("GMG-PCG"));
+    report.add_member("application", std::string("MCF"));
+    report.add_member("blockThreads", blockThreads);
+    report.add_member("levels", gmg.get_num_levels());
+    report.add_member("iterations", solver.iter_taken());
+    report.add_member("pre_solve_time(ms)", pre_solve_time);
+    report.add_member("re_pre_solve_time(ms)", re_pre_solve_time);
+    report.add_member("solve_time(ms)", solve_time);
+    report.add_member("total_time(ms)", pre_solve_time + solve_time);
+    report.add_member("max_iterations", Arg.max_num_iter);
+    report.add_member("threshold", Arg.gmg_threshold);
+    report.add_member("final_residual", solver.final_residual());
+    report.add_member("gmg_coarse_solver", Arg.gmg_csolver);
+    report.add_member("gmg_sampling", Arg.gmg_sampling);
+    report.add_member("gmg_smoother", Arg.gmg_smoother);
+
+    X_mat.move(rxmesh::DEVICE, rxmesh::HOST);
+
+    coords->from_matrix(&X_mat);
+
+#if USE_POLYSCOPE
+    polyscope::registerSurfaceMesh("old mesh",
+                                   rx.get_polyscope_mesh()->vertices,
+                                   rx.get_polyscope_mesh()->faces);
+    rx.get_polyscope_mesh()->updateVertexPositions(*coords);
+
+    polyscope::show();
+#endif
+
+    B_mat.release();
+    X_mat.release();
+    A_mat.release();
+
+    report.write(Arg.output_folder + "/rxmesh",
+                 "MCF_GMG_PCG" + extract_file_name(Arg.obj_file_name));
+}
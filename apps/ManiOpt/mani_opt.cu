@@ -15,6 +15,7 @@ struct arg
     std::string solver          = "newton";
     int         history         = 5;
     uint32_t    max_iter        = 100;
+    int         ls_batch        = 0;
     char**      argv;
     int         argc;
 } Arg;
@@ -267,9 +268,17 @@ void manifold_optimization(RXMeshStatic&                          rx,
         }
 
         if (Arg.solver == "newton") {
-            solver.line_search();
+            if (Arg.ls_batch > 0) {
+                solver.line_search_batched(1.0, 0.8, 64, 1e-4, Arg.ls_batch);
+            } else {
+                solver.line_search();
+            }
         } else {
-            solver.line_search(1.0, 0.8, 200);
+            if (Arg.ls_batch > 0) {
+                solver.line_search_batched(1.0, 0.8, 200, 1e-4, Arg.ls_batch);
+            } else {
+                solver.line_search(1.0, 0.8, 200);
+            }
             timer.stop("Diff");
         }
 
@@ -336,8 +345,9 @@ int main(int argc, char** argv)
                         " -solver:            Solver to use. Options are newton and lbfgs. Default is {}\n",
                         " -max_iter:          Maximum number of iterations for Newton solver. Default is {}\n"
                         " -history:           History size in LBFGS. Default is {}\n"
+                        " -ls_batch:          Number of step sizes evaluated at once by the line search (0 for the sequential line search). Default is {}\n"
                         " -device_id:         GPU device ID. Default is {}",                        
-            Arg.obj_file_name, Arg.embed_file_name, Arg.output_folder, Arg.solver, Arg.max_iter, Arg.history, Arg.device_id);
+            Arg.obj_file_name, Arg.embed_file_name, Arg.output_folder, Arg.solver, Arg.max_iter, Arg.history, Arg.ls_batch, Arg.device_id);
             // clang-format on
             exit(EXIT_SUCCESS);
         }
@@ -371,6 +381,11 @@ int main(int argc, char** argv)
                 std::atoi(get_cmd_option(argv, argv + argc, "-history"));
         }
 
+        if (cmd_option_exists(argv, argc + argv, "-ls_batch")) {
+            Arg.ls_batch =
+                std::atoi(get_cmd_option(argv, argv + argc, "-ls_batch"));
+        }
+
         if (cmd_option_exists(argv, argc + argv, "-device_id")) {
             Arg.device_id =
                 atoi(get_cmd_option(argv, argv + argc, "-device_id"));
@@ -382,6 +397,7 @@ int main(int argc, char** argv)
     RXMESH_INFO("output_folder= {}", Arg.output_folder);
     RXMESH_INFO("solver= {}", Arg.solver);
     RXMESH_INFO("max_iter= {}", Arg.max_iter);
+    RXMESH_INFO("ls_batch= {}", Arg.ls_batch);
     RXMESH_INFO("device_id= {}", Arg.device_id);
 
 
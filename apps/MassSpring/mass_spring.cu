@@ -4,7 +4,7 @@
 #include "rxmesh/geometry_factory.h"
 
 #include "rxmesh/diff/diff_scalar_problem.h"
-#include "rxmesh/diff/newton_solver.h"
+#include "rxmesh/diff/implicit_integrator.h"
 
 #include "barrier_energy.h"
 #include "boundary_condition.h"
@@ -38,7 +38,6 @@ void mass_spring(RXMeshStatic& rx, T dx, Scenario scenario)
     const T initial_stretch = 1.3;
     const T tol             = 0.01;
     const T h               = 0.01;  // time step
-    const T inv_h           = T(1) / h;
     const T y_ground        = T(-1.0);
 
     glm::vec3 bb_lower(0), bb_upper(0);
@@ -53,20 +52,30 @@ void mass_spring(RXMeshStatic& rx, T dx, Scenario scenario)
     CholeskySolver<HessMatT, ProblemT::DenseMatT::OrderT> solver(
         problem.hess.get());
 
-    NetwtonSolver newton_solver(problem, &solver);
-
     auto rest_l = *rx.add_edge_attribute<T>("RestLen", 1);
 
     auto velocity = *rx.add_vertex_attribute<T>("Velocity", 3);
     velocity.reset(0, DEVICE);
 
+    ImplicitIntegratorOptions<T> options;
+    options.h   = h;
+    options.tol = tol;
+
+    // the Newton solver, the Hessian, and the factorization are reused by all
+    // time steps
+    ImplicitIntegrator integrator(problem, &solver, velocity, options);
+
+    auto& newton_solver = integrator.newton;
+
     auto is_bc = *rx.add_vertex_attribute<int8_t>("isBC", 1);
     is_bc.reset(0, DEVICE);
 
     auto contact_area = *rx.add_vertex_attribute<T>("ContactArea", 1);
     contact_area.reset(dx, DEVICE);
 
-    auto x = *rx.get_input_vertex_coordinates();
+    // the positions at the start of the time step
+    auto& x = integrator.get_x_n();
+    x.copy_from(*rx.get_input_vertex_coordinates(), DEVICE, DEVICE);
 
     auto& x_tilde = *problem.objective;
     x_tilde.copy_from(x, DEVICE, DEVICE);
@@ -119,89 +128,30 @@ void mass_spring(RXMeshStatic& rx, T dx, Scenario scenario)
 
     Timers<GPUTimer> timer;
     timer.add("Step");
-    timer.add("LineSearch");
-    timer.add("LinearSolver");
-    timer.add("Diff");
 
+    // apply bc
+    integrator.post_eval = [&](cudaStream_t stream) {
+        newton_solver.apply_bc(is_bc, stream);
+    };
 
-    auto step_forward = [&]() {
-        // evaluate energy
-        timer.start("Diff");
-        problem.eval_terms();
-        timer.stop("Diff");
-
+    integrator.max_step = [&](cudaStream_t) {
+        if (scenario == Scenario::DropBox) {
+            return init_step_size(rx, newton_solver.dir, alpha, x, y_ground);
+        }
+        return T(1);
+    };
 
-        // update x_tilde
+    auto step_forward = [&]() {
         timer.start("Step");
-        rx.for_each_vertex(
-            DEVICE,
-            [x, x_tilde, velocity, h] __device__(VertexHandle vh) mutable {
-                for (int i = 0; i < 3; ++i) {
-                    x_tilde(vh, i) = x(vh, i) + h * velocity(vh, i);
-                }
-            });
-
-        // apply bc
-        newton_solver.apply_bc(is_bc);
-
-        // get newton direction
-        timer.start("LinearSolver");
-        newton_solver.compute_direction();
-        timer.stop("LinearSolver");
-
-        // residual is abs_max(newton_dir)/ h
-        T residual = newton_solver.dir.abs_max() / h;
 
+        // x_tilde starts from x + h * velocity and velocity is updated at the
+        // end of the step
+        int iter = integrator.step();
 
-        T f = problem.get_current_loss();
-
-
-        int iter = 0;
-        while (residual > tol) {
-
-            RXMESH_INFO("Time step: {}, Energy: {}, Residual: {}",
-                        time_step,
-                        f,
-                        residual);
-
-            timer.start("LineSearch");
-            T line_search_init_step = 1;
-            if (scenario == Scenario::DropBox) {
-                line_search_init_step =
-                    init_step_size(rx, newton_solver.dir, alpha, x, y_ground);
-            }
-            newton_solver.line_search(line_search_init_step, 0.5);
-            timer.stop("LineSearch");
-
-            // evaluate energy
-            timer.start("Diff");
-            problem.eval_terms();
-            timer.stop("Diff");
-
-            // apply bc
-            newton_solver.apply_bc(is_bc);
-
-            // get newton direction
-            timer.start("LinearSolver");
-            newton_solver.compute_direction();
-            timer.stop("LinearSolver");
-
-            // residual is abs_max(newton_dir)/ h
-            residual = newton_solver.dir.abs_max() / h;
-
-            iter++;
-        }
-
-        //  update velocity
-        rx.for_each_vertex(
-            DEVICE,
-            [x, x_tilde, velocity, inv_h] __device__(VertexHandle vh) mutable {
-                for (int i = 0; i < 3; ++i) {
-                    velocity(vh, i) = inv_h * (x_tilde(vh, i) - x(vh, i));
-
-                    x(vh, i) = x_tilde(vh, i);
-                }
-            });
+        RXMESH_INFO("Time step: {}, Energy: {}, #Newton iterations: {}",
+                    time_step,
+                    problem.get_current_loss(),
+                    iter);
 
         time_step++;
         timer.stop("Step");
@@ -222,16 +172,11 @@ void mass_spring(RXMeshStatic& rx, T dx, Scenario scenario)
         time_step,
         timer.elapsed_millis("Step"),
         timer.elapsed_millis("Step") / float(time_step));
-    RXMESH_INFO("LinearSolver {} (ms), Diff {} (ms), LineSearch {} (ms)",
-                timer.elapsed_millis("LinearSolver"),
-                timer.elapsed_millis("Diff"),
-                timer.elapsed_millis("LineSearch"));
-
     RXMESH_INFO(
-        "LinearSolver/iter {} (ms), Diff/iter {} (ms), LineSearch/iter {} (ms)",
-        timer.elapsed_millis("LinearSolver") / float(time_step),
-        timer.elapsed_millis("Diff") / float(time_step),
-        timer.elapsed_millis("LineSearch") / float(time_step));
+        "#Newton iterations= {}, #factorizations= {}, LinearSolver {} (ms)",
+        integrator.num_newton_iterations(),
+        integrator.num_factorizations(),
+        newton_solver.solve_time);
 }
 
 int main(int argc, char** argv)
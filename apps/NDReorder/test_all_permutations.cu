@@ -27,6 +27,8 @@ struct arg
     uint32_t device_id = 0;
 
     int n = -1;
+
+    NDPermuteOptions nd_options;
 } Arg;
 
 template <typename EigeMatT>
@@ -203,12 +205,29 @@ void with_gpu_nd(RXMeshStatic& rx, EigeMatT eigen_mat)
 {
     std::vector<int> h_permute(eigen_mat.rows());
 
-    nd_permute(rx, h_permute.data());
+    CPUTimer timer;
+    timer.start();
+    nd_permute(rx, h_permute.data(), Arg.nd_options);
+    timer.stop();
 
     if (!is_unique_permutation(h_permute.size(), h_permute.data())) {
         RXMESH_ERROR("GPUND Permutation is not unique.");
     }
 
+    // symbolic fill-in (before inverting the permutation since
+    // cholesky_fill_in() uses the same convention as the solvers)
+    size_t nnz_l = cholesky_fill_in(int(eigen_mat.rows()),
+                                    eigen_mat.outerIndexPtr(),
+                                    eigen_mat.innerIndexPtr(),
+                                    h_permute.data());
+
+    RXMESH_INFO(
+        " GPUND (ggp_iter= {}, fm_max_moves= {}) took {} (ms), nnz(L)= {}",
+        Arg.nd_options.ggp_iter,
+        Arg.nd_options.fm_max_moves,
+        timer.elapsed_millis(),
+        nnz_l);
+
     std::vector<int> helper(rx.get_num_vertices());
     inverse_permutation(rx.get_num_vertices(), h_permute.data(), helper.data());
 
@@ -343,8 +362,10 @@ int main(int argc, char** argv)
                         " -h:          Display this massage and exits\n"
                         " -input:      Input file. Only accepts OBJ files. Default is {}\n"
                         " -n:          Number of grid points for a grid mesh. Default is {}\n"
+                        " -ggp_iter:   GPUND in-patch graph growing iterations. Default is {}\n"
+                        " -fm_moves:   GPUND max FM refinement moves per patch (-1 no cap, 0 no refinement). Default is {}\n"
                         " -device_id:  GPU device ID. Default is {}",
-            Arg.obj_file_name,  Arg.n, Arg.device_id);
+            Arg.obj_file_name,  Arg.n, Arg.nd_options.ggp_iter, Arg.nd_options.fm_max_moves, Arg.device_id);
             // clang-format on
             exit(EXIT_SUCCESS);
         }
@@ -362,6 +383,16 @@ int main(int argc, char** argv)
         if (cmd_option_exists(argv, argc + argv, "-n")) {
             Arg.n = atoi(get_cmd_option(argv, argv + argc, "-n"));
         }
+
+        if (cmd_option_exists(argv, argc + argv, "-ggp_iter")) {
+            Arg.nd_options.ggp_iter =
+                atoi(get_cmd_option(argv, argv + argc, "-ggp_iter"));
+        }
+
+        if (cmd_option_exists(argv, argc + argv, "-fm_moves")) {
+            Arg.nd_options.fm_max_moves =
+                atoi(get_cmd_option(argv, argv + argc, "-fm_moves"));
+        }
     }
 
     RXMESH_TRACE("input= {}", Arg.obj_file_name);
@@ -3,7 +3,7 @@
 #include "rxmesh/geometry_factory.h"
 
 #include "rxmesh/diff/diff_scalar_problem.h"
-#include "rxmesh/diff/newton_solver.h"
+#include "rxmesh/diff/implicit_integrator.h"
 
 #include "barrier_energy.h"
 #include "boundary_condition.h"
@@ -24,7 +24,7 @@ using T = float;
 constexpr uint32_t num_dbc_vertices = 3;
 VertexHandle       v_dbc[num_dbc_vertices];  // Dirichlet node index
 
-void neo_hookean(RXMeshStatic& rx, T dx)
+void neo_hookean(RXMeshStatic& rx, T dx, PSDProjection hess_projection)
 {
     constexpr int VariableDim = 3;
 
@@ -106,13 +106,23 @@ void neo_hookean(RXMeshStatic& rx, T dx)
     CholeskySolver<HessMatT, ProblemT::DenseMatT::OrderT> solver(
         problem.hess.get());
 
-    NetwtonSolver newton_solver(problem, &solver);
+    ImplicitIntegratorOptions<T> options;
+    options.h   = time_step;
+    options.tol = tol;
+    // Newton starts from x since x_tilde is the target of the inertial term
+    options.warm_start = false;
+
+    // the Newton solver, the Hessian, and the factorization are reused by all
+    // time steps
+    ImplicitIntegrator integrator(problem, &solver, velocity, options);
+
+    auto& newton_solver = integrator.newton;
 
     auto& x = *problem.objective;
     x.copy_from(*rx.get_input_vertex_coordinates(), DEVICE, DEVICE);
 
-    auto x_n     = *rx.add_vertex_attribute_like("x_n", x);
-    auto x_tilde = *rx.add_vertex_attribute_like("x_tilde", x);
+    auto& x_n     = integrator.get_x_n();
+    auto  x_tilde = *rx.add_vertex_attribute_like("x_tilde", x);
 
 
     // Initializations
@@ -187,11 +197,60 @@ void neo_hookean(RXMeshStatic& rx, T dx)
 
     int steps = 0;
 
+    // the energy terms are added with ProjectHess
+    problem.set_hess_projection(hess_projection);
+
     Timers<GPUTimer> timer;
     timer.add("Step");
-    timer.add("LineSearch");
-    timer.add("LinearSolver");
-    timer.add("Diff");
+
+    int num_satisfied = 0;
+
+    // evaluate energy
+    integrator.pre_eval = [&](cudaStream_t stream) {
+        add_contact(rx, problem.vv_pairs, v_dbc[0], is_dbc, x, dhat);
+        problem.update_hessian(stream);
+    };
+
+    integrator.post_eval = [&](cudaStream_t stream) {
+        // DBC satisfied
+        check_dbc_satisfied(
+            rx, is_dbc_satisfied, x, is_dbc, dbc_target, time_step, tol);
+
+        // how many DBC are satisfied
+        num_satisfied = rh.reduce(is_dbc_satisfied, cub::Sum(), 0);
+
+        // satisfied DBC are eliminated from the system which is the same
+        // as adding boundary conditions where we zero out their gradients
+        // and hessian (except the diagonal entries)
+        newton_solver.apply_bc(is_dbc_satisfied, stream);
+    };
+
+    integrator.converged = [&](T residual) {
+        if (num_satisfied == num_dbc_vertices) {
+            return residual <= tol;
+        }
+        if (residual <= tol) {
+            dbc_stiff.multiply(T(2));
+        }
+        return false;
+    };
+
+    integrator.max_step = [&](cudaStream_t) {
+        T nh_step = neo_hookean_step_size(rx, x, newton_solver.dir, alpha);
+
+        T bar_step = barrier_step_size(rx,
+                                       newton_solver.dir,
+                                       alpha,
+                                       v_dbc[0],
+                                       x,
+                                       is_dbc,
+                                       ground_n,
+                                       ground_o);
+
+        // TODO: line search should pass the step to the friction energy
+        line_search_init_step = std::min(nh_step, bar_step);
+        return line_search_init_step;
+    };
 
     auto step_forward = [&]() {
         // x_tilde = x + v*h
@@ -202,9 +261,6 @@ void neo_hookean(RXMeshStatic& rx, T dx)
             }
         });
 
-        // copy current position
-        x_n.copy_from(x, DEVICE, DEVICE);
-
         // compute mu * lambda for each node using x_n
         /*compute_mu_lambda(rx,
                           fricition_coef,
@@ -220,93 +276,14 @@ void neo_hookean(RXMeshStatic& rx, T dx)
         update_dbc(
             rx, is_dbc, x, v_dbc_vel, v_dbc_limit, time_step, dbc_target);
 
-        // evaluate energy
-        add_contact(rx, problem.vv_pairs, v_dbc[0], is_dbc, x, dhat);
-        problem.update_hessian();
-        problem.eval_terms();
-
-        // DBC satisfied
-        check_dbc_satisfied(
-            rx, is_dbc_satisfied, x, is_dbc, dbc_target, time_step, tol);
-
-        // how many DBC are satisfied
-        int num_satisfied = rh.reduce(is_dbc_satisfied, cub::Sum(), 0);
-
-        // satisfied DBC are eliminated from the system which is the same
-        // as adding boundary conditions where we zero out their gradients
-        // and hessian (except the diagonal entries)
-        newton_solver.apply_bc(is_dbc_satisfied);
-
-        // get newton direction
-        newton_solver.compute_direction();
-
-        // residual is abs_max(newton_dir)/ h
-        T residual = newton_solver.dir.abs_max() / time_step;
-
-        T f = problem.get_current_loss();
-        RXMESH_INFO("Step: {}, Energy: {}, Residual: {}", steps, f, residual);
-
-        int iter = 0;
-        while (residual > tol || num_satisfied != num_dbc_vertices) {
-
-            if (residual <= tol && num_satisfied != num_dbc_vertices) {
-                dbc_stiff.multiply(T(2));
-            }
-
-            T nh_step = neo_hookean_step_size(rx, x, newton_solver.dir, alpha);
-
-            T bar_step = barrier_step_size(rx,
-                                           newton_solver.dir,
-                                           alpha,
-                                           v_dbc[0],
-                                           x,
-                                           is_dbc,
-                                           ground_n,
-                                           ground_o);
-
-            line_search_init_step = std::min(nh_step, bar_step);
-
-            // TODO: line search should pass the step to the friction energy
-            newton_solver.line_search(line_search_init_step, 0.5);
-
-            // evaluate energy
-            add_contact(rx, problem.vv_pairs, v_dbc[0], is_dbc, x, dhat);
-            problem.update_hessian();
-            problem.eval_terms();
+        // Newton iterations where x_n is the current position and velocity
+        // is updated at the end
+        int iter = integrator.step();
 
-            // T f = problem.get_current_loss();
-            // RXMESH_INFO("Subsetp, Energy: {}", f);
-
-            // DBC satisfied
-            check_dbc_satisfied(
-                rx, is_dbc_satisfied, x, is_dbc, dbc_target, time_step, tol);
-
-            // how many DBC are satisfied
-            num_satisfied = rh.reduce(is_dbc_satisfied, cub::Sum(), 0);
-
-            // apply bc
-            newton_solver.apply_bc(is_dbc_satisfied);
-
-            // get newton direction
-            newton_solver.compute_direction();
-
-            // residual is abs_max(newton_dir)/ h
-            residual = newton_solver.dir.abs_max() / time_step;
-
-            iter++;
-        }
-
-        //  update velocity
-        rx.for_each_vertex(
-            DEVICE,
-            [x, x_n, velocity, inv_time_step = 1.0 / time_step] __device__(
-                VertexHandle vh) mutable {
-                for (int i = 0; i < 3; ++i) {
-                    velocity(vh, i) = inv_time_step * (x(vh, i) - x_n(vh, i));
-
-                    // x(vh, i) = x_tilde(vh, i);
-                }
-            });
+        RXMESH_INFO("Step: {}, Energy: {}, #Newton iterations: {}",
+                    steps,
+                    problem.get_current_loss(),
+                    iter);
 
         steps++;
         timer.stop("Step");
@@ -327,6 +304,13 @@ void neo_hookean(RXMeshStatic& rx, T dx)
         timer.elapsed_millis("Step"),
         timer.elapsed_millis("Step") / float(steps));
 
+    RXMESH_INFO(
+        "NeoHookean: Hessian projection = {}, #Newton iterations = {}, "
+        "#Newton iterations/step = {}",
+        int(hess_projection),
+        integrator.num_newton_iterations(),
+        integrator.num_newton_iterations() / float(steps));
+
     // RXMESH_INFO("LinearSolver {} (ms), Diff {} (ms), LineSearch {} (ms)",
     //             timer.elapsed_millis("LinearSolver"),
     //             timer.elapsed_millis("Diff"),
@@ -349,10 +333,17 @@ int main(int argc, char** argv)
 
     int n = 5;
 
-    if (argc == 2) {
+    // 0: clamp, 1: abs, 2: diagonal shift (see PSDProjection)
+    PSDProjection hess_projection = PSDProjection::Clamp;
+
+    if (argc >= 2) {
         n = atoi(argv[1]);
     }
 
+    if (argc >= 3) {
+        hess_projection = static_cast<PSDProjection>(atoi(argv[2]));
+    }
+
     T dx = 1 / T(n - 1);
 
     create_plane(verts, fv, n, n, 2, dx, false, vec3<float>(-0.5, -0.5, 0));
@@ -398,5 +389,5 @@ int main(int argc, char** argv)
         false);
 
 
-    neo_hookean(rx, dx);
+    neo_hookean(rx, dx, hess_projection);
 }
\ No newline at end of file
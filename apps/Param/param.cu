@@ -19,6 +19,7 @@ struct arg
     float       cg_rel_tol      = 0.0;
     uint32_t    cg_max_iter     = 10;
     uint32_t    newton_max_iter = 100;
+    bool        hess_cache      = false;
     char**      argv;
     int         argc;
 } Arg;
@@ -57,14 +58,26 @@ void parameterize(RXMeshStatic& rx, ProblemT& problem, SolverT& solver)
 {
     NetwtonSolver newton_solver(problem, &solver);
 
-    auto coordinates = *rx.get_input_vertex_coordinates();
+    // the input coordinates are float. Copy them into T so that the problem
+    // can be solved in double (e.g., with the mixed-precision solver)
+    auto input_coordinates = *rx.get_input_vertex_coordinates();
+
+    auto coordinates = *rx.add_vertex_attribute<T>("coordinates", 3);
+
+    rx.for_each_vertex(HOST, [&](const VertexHandle vh) {
+        for (int i = 0; i < 3; ++i) {
+            coordinates(vh, i) = T(input_coordinates(vh, i));
+        }
+    });
+    coordinates.move(HOST, DEVICE);
 
     // TODO this is a AoS and should be converted into SoA
     auto rest_shape =
         *rx.add_face_attribute<Eigen::Matrix<T, 2, 2>>("fRestShape", 1);
 
     if (Arg.uv_file_name.empty()) {
-        tutte_embedding(rx, coordinates, *problem.objective);
+        TutteEmbedding<T> tutte(rx);
+        tutte.embed(coordinates, *problem.objective);
     } else {
         std::vector<std::vector<uint32_t>> fv;
         std::vector<std::vector<float>>    uv;
@@ -109,9 +122,9 @@ void parameterize(RXMeshStatic& rx, ProblemT& problem, SolverT& solver)
             assert(v0.is_valid() && v1.is_valid() && v2.is_valid());
 
             // 3d position
-            Eigen::Vector3<T> ar_3d = coordinates.to_eigen<3>(v0);
-            Eigen::Vector3<T> br_3d = coordinates.to_eigen<3>(v1);
-            Eigen::Vector3<T> cr_3d = coordinates.to_eigen<3>(v2);
+            Eigen::Vector3<T> ar_3d = coordinates.template to_eigen<3>(v0);
+            Eigen::Vector3<T> br_3d = coordinates.template to_eigen<3>(v1);
+            Eigen::Vector3<T> cr_3d = coordinates.template to_eigen<3>(v2);
 
             // Local 2D coordinate system
             Eigen::Vector3<T> n  = (br_3d - ar_3d).cross(cr_3d - ar_3d);
@@ -244,6 +257,51 @@ void parameterize(RXMeshStatic& rx, ProblemT& problem, SolverT& solver)
 #endif
 }
 
+template <typename T>
+void param(RXMeshStatic& rx)
+{
+    constexpr int VariableDim = 2;
+
+    using ProblemT = DiffScalarProblem<T, VariableDim, VertexHandle, true>;
+
+    bool assmble_hessian = Arg.solver != "cg_mat_free";
+
+    ProblemT problem(rx, assmble_hessian);
+
+    using HessMatT      = typename ProblemT::HessMatT;
+    constexpr int Order = ProblemT::DenseMatT::OrderT;
+
+    if (Arg.solver == "chol") {
+        CholeskySolver<HessMatT, Order> solver(problem.hess.get());
+        parameterize<T>(rx, problem, solver);
+    } else if (Arg.solver == "lu") {
+        CholeskySolver<HessMatT, Order> solver(problem.hess.get());
+        parameterize<T>(rx, problem, solver);
+    } else if (Arg.solver == "mixed_chol") {
+        MixedPrecisionCholeskySolver<HessMatT, Order> solver(
+            problem.hess.get());
+        parameterize<T>(rx, problem, solver);
+    } else if (Arg.solver == "cg") {
+        CGSolver<T, Order> solver(
+            *problem.hess, 1, Arg.cg_max_iter, Arg.cg_abs_tol, Arg.cg_rel_tol);
+        parameterize<T>(rx, problem, solver);
+    } else if (Arg.solver == "pcg") {
+        PCGSolver<T, Order> solver(
+            *problem.hess, 1, Arg.cg_max_iter, Arg.cg_abs_tol, Arg.cg_rel_tol);
+        parameterize<T>(rx, problem, solver);
+    } else if (Arg.solver == "cg_mat_free") {
+        int num_rows = VariableDim * rx.get_num_vertices();
+
+        if (Arg.hess_cache) {
+            problem.enable_hessian_cache();
+        }
+
+        CGMatFreeSolver<T, Order> solver(
+            num_rows, 1, Arg.cg_max_iter, Arg.cg_abs_tol, Arg.cg_rel_tol);
+        parameterize<T>(rx, problem, solver);
+    }
+}
+
 int main(int argc, char** argv)
 {
     Log::init(spdlog::level::info);
@@ -258,13 +316,14 @@ int main(int argc, char** argv)
                         " -input:             Input OBJ mesh file. Default is {} \n"                  
                         " -uv:                Input UV OBJ file. If empty, will compyte tutte embedding. Default is {} \n"                        
                         " -o:                 JSON file output folder. Default is {} \n"
-                        " -solver:            Solver to use. Options are cg_mat_free, cg, pcg, chol, or lu. Default is {}\n"
+                        " -solver:            Solver to use. Options are cg_mat_free, cg, pcg, chol, mixed_chol, or lu. Default is {}\n"
                         " -abs_eps:           Iterative solvers absolute tolerance. Default is {}\n"
                         " -rel_eps:           Iterative solvers relative tolerance. Default is {}\n"
                         " -cg_max_iter:       Maximum number of iterations for iterative solvers. Default is {}\n"
                         " -newton_max_iter:   Maximum number of iterations for Newton solver. Default is {}\n"
+                        " -hess_cache:        Cache the element Hessians once per Newton iteration for cg_mat_free solver. Default is {}\n"
                         " -device_id:         GPU device ID. Default is {}",
-            Arg.obj_file_name,Arg.uv_file_name, Arg.output_folder,  Arg.solver, Arg.cg_abs_tol, Arg.cg_rel_tol, Arg.cg_max_iter, Arg.newton_max_iter, Arg.device_id);
+            Arg.obj_file_name,Arg.uv_file_name, Arg.output_folder,  Arg.solver, Arg.cg_abs_tol, Arg.cg_rel_tol, Arg.cg_max_iter, Arg.newton_max_iter, Arg.hess_cache, Arg.device_id);
             // clang-format on
             exit(EXIT_SUCCESS);
         }
@@ -302,6 +361,10 @@ int main(int argc, char** argv)
                 std::atof(get_cmd_option(argv, argv + argc, "-rel_eps"));
         }
 
+        if (cmd_option_exists(argv, argc + argv, "-hess_cache")) {
+            Arg.hess_cache = true;
+        }
+
         if (cmd_option_exists(argv, argc + argv, "-device_id")) {
             Arg.device_id =
                 atoi(get_cmd_option(argv, argv + argc, "-device_id"));
@@ -320,6 +383,7 @@ int main(int argc, char** argv)
     RXMESH_INFO("newton_max_iter= {}", Arg.newton_max_iter);
     RXMESH_INFO("abs_eps= {0:f}", Arg.cg_abs_tol);
     RXMESH_INFO("rel_eps= {0:f}", Arg.cg_rel_tol);
+    RXMESH_INFO("hess_cache= {}", Arg.hess_cache);
     RXMESH_INFO("device_id= {}", Arg.device_id);
 
 
@@ -333,36 +397,11 @@ int main(int argc, char** argv)
         exit(EXIT_FAILURE);
     }
 
-    constexpr int VariableDim = 2;
-
-    using ProblemT = DiffScalarProblem<T, VariableDim, VertexHandle, true>;
-
-    bool assmble_hessian = Arg.solver != "cg_mat_free";
-
-    ProblemT problem(rx, assmble_hessian);
-
-    using HessMatT      = typename ProblemT::HessMatT;
-    constexpr int Order = ProblemT::DenseMatT::OrderT;
-
-    if (Arg.solver == "chol") {
-        CholeskySolver<HessMatT, Order> solver(problem.hess.get());
-        parameterize<T>(rx, problem, solver);
-    } else if (Arg.solver == "lu") {
-        CholeskySolver<HessMatT, Order> solver(problem.hess.get());
-        parameterize<T>(rx, problem, solver);
-    } else if (Arg.solver == "cg") {
-        CGSolver<T, Order> solver(
-            *problem.hess, 1, Arg.cg_max_iter, Arg.cg_abs_tol, Arg.cg_rel_tol);
-        parameterize<T>(rx, problem, solver);
-    } else if (Arg.solver == "pcg") {
-        PCGSolver<T, Order> solver(
-            *problem.hess, 1, Arg.cg_max_iter, Arg.cg_abs_tol, Arg.cg_rel_tol);
-        parameterize<T>(rx, problem, solver);
-    } else if (Arg.solver == "cg_mat_free") {
-        int num_rows = VariableDim * rx.get_num_vertices();
-
-        CGMatFreeSolver<T, Order> solver(
-            num_rows, 1, Arg.cg_max_iter, Arg.cg_abs_tol, Arg.cg_rel_tol);
-        parameterize<T>(rx, problem, solver);
+    if (Arg.solver == "mixed_chol") {
+        // the problem is solved in double while the Hessian is factorized in
+        // float (see MixedPrecisionCholeskySolver)
+        param<double>(rx);
+    } else {
+        param<T>(rx);
     }
 }
\ No newline at end of file
@@ -0,0 +1,32 @@
+#!/bin/bash
+echo "Please make sure to first compile PatchOrdering twice: once with -DRX_PATCH_ORDERING=ON in ../../build and once with -DRX_PATCH_ORDERING=OFF in ../../build_no_ordering. Then enter the input OBJ files directory."
+read -p "OBJ files directory (no trailing slash): " input_dir
+
+echo "Input directory= $input_dir"
+exe_ordered="../../build/bin/PatchOrdering"
+exe_unordered="../../build_no_ordering/bin/PatchOrdering"
+
+for exe in $exe_ordered $exe_unordered; do
+	if [ ! -f $exe ]; then 
+		echo "$exe has not been compiled. Please compile PatchOrdering and retry!"
+		exit 1
+	fi
+done
+
+num_run=10
+device_id=0
+
+# L2 hit rate of the query kernels is collected with Nsight Compute if available
+ncu_cmd=""
+if command -v ncu &> /dev/null; then
+	ncu_cmd="ncu --metrics lts__t_sector_hit_rate.pct,dram__bytes_read.sum -k regex:query_kernel"
+fi
+
+for file in $input_dir/*.obj; do 	 
+    if [ -f "$file" ]; then
+		for exe in $exe_ordered $exe_unordered; do
+			echo $ncu_cmd $exe -input "$file" -num_run $num_run -device_id $device_id
+			$ncu_cmd $exe -input "$file" -num_run $num_run -device_id $device_id
+		done
+    fi 
+done
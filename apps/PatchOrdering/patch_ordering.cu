@@ -0,0 +1,186 @@
+// Measure the locality of the patch numbering and the query throughput. Run it
+// once with RX_PATCH_ORDERING=ON and once with OFF to compare the patch
+// ordering against the Lloyd patch ids. benchmark.sh also collects the L2 hit
+// rate of the query kernels using Nsight Compute
+
+#include "gtest/gtest.h"
+#include "rxmesh/rxmesh_static.h"
+#include "rxmesh/util/report.h"
+#include "rxmesh/util/timer.h"
+
+struct arg
+{
+    std::string obj_file_name = STRINGIFY(INPUT_DIR) "sphere3.obj";
+    std::string output_folder = STRINGIFY(OUTPUT_DIR);
+    uint32_t    num_run       = 10;
+    uint32_t    patch_size    = 512;
+    uint32_t    device_id     = 0;
+    char**      argv;
+    int         argc;
+} Arg;
+
+template <rxmesh::Op op, uint32_t blockThreads>
+rxmesh::TestData run_query(rxmesh::RXMeshStatic& rx, const std::string name)
+{
+    using namespace rxmesh;
+
+    using InputHandleT = typename InputHandle<op>::type;
+    using IteratorT    = typename IteratorType<op>::type;
+
+    auto attr = rx.add_attribute<uint32_t, InputHandleT>(name, 1, DEVICE);
+    attr->reset(0, DEVICE);
+
+    auto a = *attr;
+
+    auto query = [a] __device__(const InputHandleT& h,
+                                const IteratorT&    iter) mutable {
+        uint32_t sum = 0;
+        for (uint32_t i = 0; i < iter.size(); ++i) {
+            sum += iter.local(i);
+        }
+        a(h) = sum;
+    };
+
+    LaunchBox<blockThreads> lb;
+    rx.prepare_launch_box(
+        {op},
+        lb,
+        (void*)detail::query_kernel<blockThreads, op, decltype(query)>);
+
+    TestData td;
+    td.test_name   = name;
+    td.num_threads = blockThreads;
+    td.num_blocks  = lb.blocks;
+    td.dyn_smem    = lb.smem_bytes_dyn;
+
+    // warm up
+    rx.run_query_kernel<op>(lb, query);
+
+    for (uint32_t itr = 0; itr < Arg.num_run; ++itr) {
+        GPUTimer timer;
+        timer.start();
+        rx.run_query_kernel<op>(lb, query);
+        timer.stop();
+        CUDA_ERROR(cudaDeviceSynchronize());
+        td.time_ms.push_back(timer.elapsed_millis());
+        td.passed.push_back(true);
+    }
+
+    float sum = 0;
+    for (float ms : td.time_ms) {
+        sum += ms;
+    }
+    RXMESH_INFO("PatchOrdering: {} query time = {} (ms)",
+                name,
+                sum / float(td.time_ms.size()));
+
+    rx.remove_attribute(name);
+
+    return td;
+}
+
+TEST(Apps, PatchOrdering)
+{
+    using namespace rxmesh;
+
+    // Select device
+    cuda_query(Arg.device_id);
+
+    RXMeshStatic rx(Arg.obj_file_name, "", false, Arg.patch_size);
+
+    Report report("PatchOrdering");
+    report.command_line(Arg.argc, Arg.argv);
+    report.device();
+    report.system();
+    report.model_data(Arg.obj_file_name, rx);
+
+#ifdef USE_PATCH_ORDERING
+    report.add_member("patch_ordering", true);
+#else
+    report.add_member("patch_ordering", false);
+#endif
+
+    // locality of the patch numbering: the average distance between the id
+    // of a patch and the ids of the patches in its patch stash. This is what
+    // a block touches when it looks up the owner of its ribbon elements
+    double   sum_dist = 0;
+    uint64_t num_dist = 0;
+    for (uint32_t p = 0; p < rx.get_num_patches(); ++p) {
+        const PatchStash& stash = rx.get_patch(p).patch_stash;
+        for (uint8_t i = 0; i < PatchStash::stash_size; ++i) {
+            const uint32_t q = stash.get_patch(i);
+            if (q != INVALID32) {
+                sum_dist += std::abs(double(p) - double(q));
+                num_dist++;
+            }
+        }
+    }
+    const double avg_dist = (num_dist == 0) ? 0 : sum_dist / double(num_dist);
+    RXMESH_INFO("PatchOrdering: avg. patch stash id distance = {}", avg_dist);
+    report.add_member("avg_patch_stash_id_distance", avg_dist);
+
+    report.add_test(run_query<Op::VV, 256>(rx, "VV"));
+    report.add_test(run_query<Op::VE, 256>(rx, "VE"));
+    report.add_test(run_query<Op::VF, 256>(rx, "VF"));
+    report.add_test(run_query<Op::FV, 256>(rx, "FV"));
+    report.add_test(run_query<Op::FF, 256>(rx, "FF"));
+
+    report.write(Arg.output_folder + "/rxmesh",
+                 "PatchOrdering_" + extract_file_name(Arg.obj_file_name));
+}
+
+int main(int argc, char** argv)
+{
+    using namespace rxmesh;
+    Log::init();
+
+    ::testing::InitGoogleTest(&argc, argv);
+    Arg.argv = argv;
+    Arg.argc = argc;
+
+    if (argc > 1) {
+        if (cmd_option_exists(argv, argc + argv, "-h")) {
+            // clang-format off
+            RXMESH_INFO("\nUsage: PatchOrdering.exe < -option X>\n"
+                        " -h:          Display this massage and exit\n"
+                        " -input:      Input OBJ/PLY mesh file. Default is {} \n"
+                        " -o:          JSON file output folder. Default is {} \n"
+                        " -num_run:    Number of runs per query. Default is {} \n"
+                        " -patch_size: Patch size. Default is {} \n"
+                        " -device_id:  GPU device ID. Default is {}",
+            Arg.obj_file_name, Arg.output_folder, Arg.num_run, Arg.patch_size, Arg.device_id);
+            // clang-format on
+            exit(EXIT_SUCCESS);
+        }
+
+        if (cmd_option_exists(argv, argc + argv, "-num_run")) {
+            Arg.num_run = atoi(get_cmd_option(argv, argv + argc, "-num_run"));
+        }
+
+        if (cmd_option_exists(argv, argc + argv, "-patch_size")) {
+            Arg.patch_size =
+                atoi(get_cmd_option(argv, argv + argc, "-patch_size"));
+        }
+
+        if (cmd_option_exists(argv, argc + argv, "-input")) {
+            Arg.obj_file_name =
+                std::string(get_cmd_option(argv, argv + argc, "-input"));
+        }
+        if (cmd_option_exists(argv, argc + argv, "-o")) {
+            Arg.output_folder =
+                std::string(get_cmd_option(argv, argv + argc, "-o"));
+        }
+        if (cmd_option_exists(argv, argc + argv, "-device_id")) {
+            Arg.device_id =
+                atoi(get_cmd_option(argv, argv + argc, "-device_id"));
+        }
+    }
+
+    RXMESH_TRACE("input= {}", Arg.obj_file_name);
+    RXMESH_TRACE("output_folder= {}", Arg.output_folder);
+    RXMESH_TRACE("num_run= {}", Arg.num_run);
+    RXMESH_TRACE("patch_size= {}", Arg.patch_size);
+    RXMESH_TRACE("device_id= {}", Arg.device_id);
+
+    return RUN_ALL_TESTS();
+}
@@ -3,12 +3,16 @@
 #include "rxmesh/util/macros.h"
 #include "rxmesh/util/util.h"
 
+#include <sstream>
+
 struct arg
 {
     std::string obj_file_name = STRINGIFY(INPUT_DIR) "torus.obj";
     std::string output_folder = STRINGIFY(OUTPUT_DIR);
     float       target        = 0.1;
     float       reduce_ratio  = 0.1;
+    int         sync_every    = 1;
+    std::string lods          = "";
     uint32_t    device_id     = 0;
     char**      argv;
     int         argc;
@@ -37,7 +41,14 @@ TEST(Apps, QSlim)
 
     uint32_t final_num_vertices = Arg.target * rx.get_num_vertices();
 
-    qslim_rxmesh(rx, final_num_vertices);
+    std::vector<uint32_t> lod_num_vertices;
+    std::stringstream     lods(Arg.lods);
+    std::string           lod;
+    while (std::getline(lods, lod, ',')) {
+        lod_num_vertices.push_back(std::stof(lod) * rx.get_num_vertices());
+    }
+
+    qslim_rxmesh(rx, final_num_vertices, Arg.sync_every, lod_num_vertices);
 }
 
 
@@ -59,9 +70,11 @@ int main(int argc, char** argv)
                         " -input:      Input OBJ mesh file. Default is {} \n"
                         " -target:     The fraction of output #vertices from the input. Default is {}\n"
                         " -r:          Reduction ratio. Default is {}\n"
+                        " -sync:       Read the number of vertices from the device every this many rounds. Default is {}\n"
+                        " -lods:       Comma-separated fractions of the input #vertices (larger than -target) to export as LODs in the same run e.g., 0.5,0.25\n"
                         " -o:          JSON file output folder. Default is {} \n"
                         " -device_id:  GPU device ID. Default is {}",
-            Arg.obj_file_name,Arg.target, Arg.reduce_ratio, Arg.output_folder, Arg.device_id);
+            Arg.obj_file_name,Arg.target, Arg.reduce_ratio, Arg.sync_every, Arg.output_folder, Arg.device_id);
             // clang-format on
             exit(EXIT_SUCCESS);
         }
@@ -84,6 +97,12 @@ int main(int argc, char** argv)
         if (cmd_option_exists(argv, argc + argv, "-r")) {
             Arg.reduce_ratio = atof(get_cmd_option(argv, argv + argc, "-r"));
         }
+        if (cmd_option_exists(argv, argc + argv, "-sync")) {
+            Arg.sync_every = atoi(get_cmd_option(argv, argv + argc, "-sync"));
+        }
+        if (cmd_option_exists(argv, argc + argv, "-lods")) {
+            Arg.lods = std::string(get_cmd_option(argv, argv + argc, "-lods"));
+        }
     }
 
     RXMESH_TRACE("input= {}", Arg.obj_file_name);
@@ -91,6 +110,8 @@ int main(int argc, char** argv)
     RXMESH_TRACE("device_id= {}", Arg.device_id);
     RXMESH_TRACE("target= {}", Arg.target);
     RXMESH_TRACE("reduce_ratio= {}", Arg.reduce_ratio);
+    RXMESH_TRACE("sync_every= {}", Arg.sync_every);
+    RXMESH_TRACE("lods= {}", Arg.lods);
 
     return RUN_ALL_TESTS();
 }
\ No newline at end of file
@@ -2,9 +2,9 @@
 
 #include <glm/glm.hpp>
 #include "rxmesh/cavity_manager.cuh"
+#include "rxmesh/cavity_ops.cuh"
 #include "rxmesh/query.cuh"
 
-#include "link_condition.cuh"
 
 template <typename T>
 using Vec3 = glm::vec<3, T, glm::defaultp>;
@@ -15,6 +15,57 @@ using Vec4 = glm::vec<4, T, glm::defaultp>;
 template <typename T>
 using Mat4 = glm::mat<4, 4, T, glm::defaultp>;
 
+/**
+ * @brief the state of the decimation that is kept on the device such that the
+ * host does not need to read the number of vertices after every round. The
+ * number of vertices/edges are tracked by counting the collapses (every
+ * collapse of an interior edge removes one vertex and three edges) and are
+ * corrected by the host whenever it reads the actual count
+ */
+struct DecimationState
+{
+    // the current number of vertices
+    int num_vertices;
+    // the current number of edges
+    int num_edges;
+    // the number of collapses still allowed before reaching the current target
+    int budget;
+    // the number of collapses done in the current round
+    int round_collapses;
+    // the histogram threshold of the current round (0 before the first round)
+    int threshold;
+};
+
+/**
+ * @brief compute the histogram threshold (i.e., how many of the cheapest
+ * edges are candidates for collapsing) of the next round. It is capped by
+ * reduce_ratio of the edges and, after the first round, by the remaining
+ * budget divided by the fraction of the candidates that were actually
+ * collapsed in the last round (the rest fail the link condition or conflict
+ * with other cavities) such that the last rounds before a target do not
+ * evaluate many more candidates than they can collapse
+ */
+__global__ static void update_threshold(DecimationState* d_state,
+                                        const float      reduce_ratio)
+{
+    const int max_threshold =
+        std::max(1, int(reduce_ratio * float(d_state->num_edges)));
+
+    int threshold = max_threshold;
+
+    if (d_state->threshold > 0) {
+        const float success =
+            std::max(0.05f,
+                     float(d_state->round_collapses) /
+                         float(d_state->threshold));
+        threshold = std::min(
+            max_threshold, int(std::ceil(float(d_state->budget) / success)));
+    }
+
+    d_state->threshold       = std::max(1, threshold);
+    d_state->round_collapses = 0;
+}
+
 template <typename T>
 __device__ __inline__ __host__ T
 compute_cost(const Mat4<T>& quadric, const T x, const T y, const T z)
@@ -358,7 +409,7 @@ template <typename T, uint32_t blockThreads>
 __global__ static void simplify_ev(rxmesh::Context            context,
                                    rxmesh::VertexAttribute<T> coords,
                                    const rxmesh::Histogram<T> histo,
-                                   const int                  reduce_threshold,
+                                   DecimationState*           d_state,
                                    rxmesh::VertexAttribute<T> vertex_quadrics,
                                    rxmesh::EdgeAttribute<T>   edge_cost,
                                    rxmesh::EdgeAttribute<T>   edge_col_coord)
@@ -381,11 +432,18 @@ __global__ static void simplify_ev(rxmesh::Context            context,
     Bitmask edge_mask(cavity.patch_info().edges_capacity, shrd_alloc);
     edge_mask.reset(block);
 
-    // we use this bitmask to mark the other end of to-be-collapse edge during
-    // checking for the link condition
-    Bitmask v0_mask(cavity.patch_info().num_vertices[0], shrd_alloc);
-    Bitmask v1_mask(cavity.patch_info().num_vertices[0], shrd_alloc);
 
+    // the number of collapses reserved from the budget by this block and the
+    // number of collapses actually done
+    __shared__ int s_reserved;
+    __shared__ int s_collapsed;
+    if (threadIdx.x == 0) {
+        s_reserved  = 0;
+        s_collapsed = 0;
+    }
+
+    const int  reduce_threshold = d_state->threshold;
+    const bool has_budget       = d_state->budget > 0;
 
     // Precompute EV
     Query<blockThreads> ev_query(context, pid);
@@ -393,27 +451,36 @@ __global__ static void simplify_ev(rxmesh::Context            context,
 
 
     // 1) mark edge we want to collapse
-    for_each_edge(cavity.patch_info(), [&](EdgeHandle eh) {
-        assert(eh.local_id() < cavity.patch_info().num_edges[0]);
-        T cost = edge_cost(eh);
-        if (histo.below_threshold(cost, reduce_threshold)) {
-            edge_mask.set(eh.local_id(), true);
-        }
-    });
+    if (has_budget) {
+        for_each_edge(cavity.patch_info(), [&](EdgeHandle eh) {
+            assert(eh.local_id() < cavity.patch_info().num_edges[0]);
+            T cost = edge_cost(eh);
+            if (histo.below_threshold(cost, reduce_threshold)) {
+                edge_mask.set(eh.local_id(), true);
+            }
+        });
+    }
     block.sync();
 
 
     // 2) check edge link condition.
     link_condition(
-        block, cavity.patch_info(), ev_query, edge_mask, v0_mask, v1_mask);
+        block, cavity.patch_info(), ev_query, shrd_alloc, edge_mask, 0, 1);
 
 
     block.sync();
 
+    // 3) reserve a collapse from the budget for every cavity such that the
+    // mesh does not go below the target
     for_each_edge(cavity.patch_info(), [&](EdgeHandle eh) {
         assert(eh.local_id() < cavity.patch_info().num_edges[0]);
         if (edge_mask(eh.local_id())) {
-            cavity.create(eh);
+            if (::atomicSub(&d_state->budget, 1) > 0) {
+                ::atomicAdd(&s_reserved, 1);
+                cavity.create(eh);
+            } else {
+                ::atomicAdd(&d_state->budget, 1);
+            }
         }
     });
     block.sync();
@@ -444,6 +511,7 @@ __global__ static void simplify_ev(rxmesh::Context            context,
             const VertexHandle new_v = cavity.add_vertex();
 
             if (new_v.is_valid()) {
+                ::atomicAdd(&s_collapsed, 1);
 
                 // coords(new_v, 0) = edge_col_coord(src, 0);
                 // coords(new_v, 1) = edge_col_coord(src, 1);
@@ -506,6 +574,20 @@ __global__ static void simplify_ev(rxmesh::Context            context,
         });
     }
 
+    // give back the reserved collapses that did not happen (e.g., because of
+    // a conflict) and update the tracked mesh size
+    block.sync();
+    if (threadIdx.x == 0) {
+        if (s_reserved > s_collapsed) {
+            ::atomicAdd(&d_state->budget, s_reserved - s_collapsed);
+        }
+        if (s_collapsed > 0) {
+            ::atomicAdd(&d_state->round_collapses, s_collapsed);
+            ::atomicSub(&d_state->num_vertices, s_collapsed);
+            ::atomicSub(&d_state->num_edges, 3 * s_collapsed);
+        }
+    }
+
     cavity.epilogue(block);
 }
 
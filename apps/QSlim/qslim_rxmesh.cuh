@@ -2,6 +2,9 @@
 
 #include <cuda_profiler_api.h>
 
+#include <algorithm>
+#include <functional>
+
 #include "cub/device/device_scan.cuh"
 
 #include "rxmesh/rxmesh_dynamic.h"
@@ -61,8 +64,19 @@ void calc_edge_cost(const rxmesh::RXMeshDynamic&      rx,
                                         histo);
 }
 
-inline void qslim_rxmesh(rxmesh::RXMeshDynamic& rx,
-                         const uint32_t         final_num_vertices)
+/**
+ * @brief QSlim decimation down to final_num_vertices. The remaining number of
+ * collapses (the budget) is tracked on the device such that the host only
+ * reads the actual number of vertices every sync_every rounds. In between,
+ * the collapse kernel stops collapsing once the budget is used up.
+ * Optionally, lod_num_vertices lists intermediate targets (more vertices than
+ * final_num_vertices) where the mesh is exported in the same run as an OBJ file
+ * to Arg.output_folder
+ */
+inline void qslim_rxmesh(rxmesh::RXMeshDynamic&       rx,
+                         const uint32_t               final_num_vertices,
+                         const int                    sync_every       = 1,
+                         const std::vector<uint32_t>& lod_num_vertices = {})
 {
     EXPECT_TRUE(rx.validate());
 
@@ -81,12 +95,14 @@ inline void qslim_rxmesh(rxmesh::RXMeshDynamic& rx,
     auto coords = rx.get_input_vertex_coordinates();
 
 
-    Timers<GPUTimer> timers;
+    Timers<DeferredGPUTimer> timers;
     timers.add("Total");
     timers.add("App");
     timers.add("Slice");
     timers.add("Cleanup");
     timers.add("Histo");
+    timers.add("Merge");
+    timers.add("LOD");
 
     const int num_bins = 256;
 
@@ -104,10 +120,51 @@ inline void qslim_rxmesh(rxmesh::RXMeshDynamic& rx,
 
     bool validate = false;
 
+    // the targets from the finest to the coarsest one. Only the intermediate
+    // ones are exported
+    std::vector<uint32_t> targets;
+    for (uint32_t t : lod_num_vertices) {
+        if (t > final_num_vertices && t < rx.get_num_vertices()) {
+            targets.push_back(t);
+        }
+    }
+    std::sort(targets.begin(), targets.end(), std::greater<uint32_t>());
+    targets.erase(std::unique(targets.begin(), targets.end()), targets.end());
+    targets.push_back(final_num_vertices);
+
+    DecimationState* d_state(nullptr);
+    CUDA_ERROR(cudaMalloc((void**)&d_state, sizeof(DecimationState)));
+    CUDA_ERROR(cudaMemset(d_state, 0, sizeof(DecimationState)));
+
+    // set the mesh size and the budget of the current target from the actual
+    // (device) count. The threshold of the last round is kept
+    auto sync_state = [&](const uint32_t num_vertices, const uint32_t target) {
+        DecimationState state;
+        state.num_vertices    = int(num_vertices);
+        state.num_edges       = int(rx.get_num_edges(true));
+        state.budget          = int(num_vertices) - int(target);
+        state.round_collapses = 0;
+        state.threshold       = 0;
+        CUDA_ERROR(cudaMemcpy(&state.round_collapses,
+                              &d_state->round_collapses,
+                              2 * sizeof(int),
+                              cudaMemcpyDeviceToHost));
+        CUDA_ERROR(cudaMemcpy(
+            d_state, &state, sizeof(DecimationState), cudaMemcpyHostToDevice));
+    };
+
+    uint32_t num_vertices = rx.get_num_vertices(true);
+    uint32_t lod          = 0;
+    int      num_rounds   = 0;
+    int      num_syncs    = 0;
+
+    sync_state(num_vertices, targets[lod]);
+
     CUDA_ERROR(cudaProfilerStart());
 
     timers.start("Total");
-    while (rx.get_num_vertices(true) > final_num_vertices) {
+    while (num_vertices > final_num_vertices) {
+        ++num_rounds;
 
         timers.start("Histo");
         histo.init();
@@ -127,18 +184,14 @@ inline void qslim_rxmesh(rxmesh::RXMeshDynamic& rx,
 
         histo.scan();
 
-        // loop over the mesh, and try to collapse
-        const int num_edges_before = int(rx.get_num_edges(true));
-
-        const int reduce_threshold =
-            std::max(1, int(Arg.reduce_ratio * float(num_edges_before)));
+        update_threshold<<<1, 1>>>(d_state, Arg.reduce_ratio);
 
         timers.stop("Histo");
 
+        // loop over the mesh, and try to collapse
         rx.reset_scheduler();
 
-        while (!rx.is_queue_empty() &&
-               rx.get_num_vertices(true) > final_num_vertices) {
+        while (!rx.is_queue_empty()) {
 
             LaunchBox<blockThreads> lb;
             rx.update_launch_box(
@@ -151,8 +204,8 @@ inline void qslim_rxmesh(rxmesh::RXMeshDynamic& rx,
                 false,
                 [](uint32_t v, uint32_t e, uint32_t f) {
                     return detail::mask_num_bytes(e) +
-                           2 * detail::mask_num_bytes(v) +
-                           3 * ShmemAllocator::default_alignment;
+                           ShmemAllocator::default_alignment +
+                           link_condition_shmem_bytes(v, e);
                 });
 
 
@@ -162,7 +215,7 @@ inline void qslim_rxmesh(rxmesh::RXMeshDynamic& rx,
                     rx.get_context(),
                     *coords,
                     histo,
-                    reduce_threshold,
+                    d_state,
                     *vertex_quadrics,
                     *edge_cost,
                     *edge_col_coord);
@@ -183,18 +236,84 @@ inline void qslim_rxmesh(rxmesh::RXMeshDynamic& rx,
             // timers.stop("Cleanup");
 
             if (validate) {
-                rx.update_host();
                 EXPECT_TRUE(rx.validate());
             }
         }
+
+        if (num_rounds % std::max(1, sync_every) != 0) {
+            continue;
+        }
+
+        // read the actual number of vertices
+        ++num_syncs;
+        const uint32_t prv_num_vertices = num_vertices;
+        num_vertices                    = rx.get_num_vertices(true);
+
+        if (num_vertices <= targets[lod] && lod + 1 < targets.size()) {
+            timers.start("LOD");
+            rx.update_host();
+            coords->move(DEVICE, HOST);
+            const std::string lod_file =
+                Arg.output_folder + "/" + extract_file_name(Arg.obj_file_name) +
+                "_lod" + std::to_string(lod) + ".obj";
+            rx.export_obj(lod_file, *coords);
+            RXMESH_INFO("qslim_rxmesh() LOD {} with {} vertices written to {}",
+                        lod,
+                        num_vertices,
+                        lod_file);
+            ++lod;
+            timers.stop("LOD");
+        } else if (num_vertices == prv_num_vertices) {
+            RXMESH_WARN(
+                "qslim_rxmesh() no edge was collapsed in the last {} rounds. "
+                "Stopping at {} vertices",
+                std::max(1, sync_every),
+                num_vertices);
+            break;
+        }
+
+        sync_state(num_vertices, targets[lod]);
     }
 
     timers.stop("Total");
     CUDA_ERROR(cudaDeviceSynchronize());
     CUDA_ERROR(cudaProfilerStop());
 
-    RXMESH_INFO("qslim_rxmesh() RXMesh QSlim took {} (ms)",
-                timers.elapsed_millis("Total"));
+    // merge the patches that became underfull after the collapses
+    {
+        uint32_t min_p(0), max_p(0), avg_p(0);
+        rx.get_max_min_avg_patch_size(min_p, max_p, avg_p, true);
+        RXMESH_INFO("qslim_rxmesh() patch size (max, min, avg) before "
+                    "merging = ({}, {}, {})",
+                    max_p,
+                    min_p,
+                    avg_p);
+
+        timers.start("Merge");
+        const uint32_t num_merged =
+            rx.merge_patches(0.25f, *coords, *vertex_quadrics);
+        timers.stop("Merge");
+
+        rx.get_max_min_avg_patch_size(min_p, max_p, avg_p, true);
+        RXMESH_INFO("qslim_rxmesh() merged {} patches in {} (ms), patch "
+                    "size (max, min, avg) after merging = ({}, {}, {})",
+                    num_merged,
+                    timers.elapsed_millis("Merge"),
+                    max_p,
+                    min_p,
+                    avg_p);
+
+        if (validate) {
+            EXPECT_TRUE(rx.validate());
+        }
+    }
+
+    RXMESH_INFO(
+        "qslim_rxmesh() RXMesh QSlim took {} (ms), num_rounds= {}, "
+        "num_syncs= {}",
+        timers.elapsed_millis("Total"),
+        num_rounds,
+        num_syncs);
     RXMESH_INFO("qslim_rxmesh() Histo time {} (ms)",
                 timers.elapsed_millis("Histo"));
     RXMESH_INFO("qslim_rxmesh() App time {} (ms)",
@@ -216,10 +335,15 @@ inline void qslim_rxmesh(rxmesh::RXMeshDynamic& rx,
 
 
     report.add_member("qslim_rxmesh_time", timers.elapsed_millis("Total"));
+    report.add_member("num_rounds", num_rounds);
+    report.add_member("num_syncs", num_syncs);
+    report.add_member("sync_every", sync_every);
+    report.add_member("num_lods", int(targets.size()) - 1);
     report.add_member("histogram_time", timers.elapsed_millis("Histo"));
     report.add_member("app_time", timers.elapsed_millis("App"));
     report.add_member("slice_time", timers.elapsed_millis("Slice"));
     report.add_member("cleanup_time", timers.elapsed_millis("Cleanup"));
+    report.add_member("merge_time", timers.elapsed_millis("Merge"));
     report.add_member("attributes_memory_mg", coords->get_memory_mg());
     report.model_data(Arg.obj_file_name + "_after", rx, "model_after");
 
@@ -238,6 +362,7 @@ inline void qslim_rxmesh(rxmesh::RXMeshDynamic& rx,
 #endif
 
     histo.free();
+    GPU_FREE(d_state);
 
     report.write(Arg.output_folder + "/rxmesh_qslim",
                  "QSlim_RXMesh_" + extract_file_name(Arg.obj_file_name));
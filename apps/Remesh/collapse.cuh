@@ -4,6 +4,7 @@
 #include "rxmesh/cavity_manager.cuh"
 #include "rxmesh/rxmesh_dynamic.h"
 
+#include "convergence.cuh"
 #include "util.cuh"
 
 
@@ -35,11 +36,6 @@ __global__ static void __launch_bounds__(blockThreads)
 
     uint32_t shmem_before = shrd_alloc.get_allocated_size_bytes();
 
-    // we use this bitmask to mark the other end of to-be-collapse edge during
-    // checking for the link condition
-    Bitmask v0_mask(cavity.patch_info().num_vertices[0], shrd_alloc);
-    Bitmask v1_mask(cavity.patch_info().num_vertices[0], shrd_alloc);
-
     // Precompute EV
     Query<blockThreads> query(context, pid);
     query.prologue<Op::EVDiamond>(block, shrd_alloc);
@@ -94,7 +90,7 @@ __global__ static void __launch_bounds__(blockThreads)
 
     // 2. check link condition
     link_condition(
-        block, cavity.patch_info(), query, edge_mask, v0_mask, v1_mask, 0, 2);
+        block, cavity.patch_info(), query, shrd_alloc, edge_mask, 0, 2);
     block.sync();
 
 
@@ -495,7 +491,7 @@ __global__ static void __launch_bounds__(blockThreads)
 }
 
 
-template <typename T>
+template <typename T, typename TimerT>
 inline void collapse_short_edges(rxmesh::RXMeshDynamic&             rx,
                                  rxmesh::VertexAttribute<T>*        coords,
                                  rxmesh::EdgeAttribute<EdgeStatus>* edge_status,
@@ -503,14 +499,16 @@ inline void collapse_short_edges(rxmesh::RXMeshDynamic&             rx,
                                  rxmesh::VertexAttribute<bool>*     v_boundary,
                                  const T low_edge_len_sq,
                                  const T high_edge_len_sq,
-                                 rxmesh::Timers<rxmesh::GPUTimer>& timers,
-                                 int*                              d_buffer)
+                                 rxmesh::Timers<TimerT>&           timers,
+                                 int*                              d_buffer,
+                                 PatchConvergence&                 conv)
 {
     using namespace rxmesh;
 
     constexpr uint32_t blockThreads = 256;
 
     edge_status->reset(UNSEEN, DEVICE);
+    conv.skip_inactive(rx, edge_status);
 
     int prv_remaining_work = rx.get_num_edges();
 
@@ -539,7 +537,7 @@ inline void collapse_short_edges(rxmesh::RXMeshDynamic&             rx,
     timers.start("CollapseTotal");
     while (true) {
         num_outer_iter++;
-        rx.reset_scheduler();
+        conv.reset_scheduler(rx);
         while (!rx.is_queue_empty()) {
             // RXMESH_INFO(" Queue size = {}",
             //             rx.get_context().m_patch_scheduler.size());
@@ -561,16 +559,8 @@ inline void collapse_short_edges(rxmesh::RXMeshDynamic&             rx,
             timers.stop("Collapse");
 
             timers.start("CollapseCleanup");
-            rx.cleanup();
-            timers.stop("CollapseCleanup");
-
-            timers.start("CollapseSlice");
-            rx.slice_patches(
+            rx.cleanup_and_slice(
                 *coords, *edge_status, *v_boundary /*, *edge_link */);
-            timers.stop("CollapseSlice");
-
-            timers.start("CollapseCleanup");
-            rx.cleanup();
             timers.stop("CollapseCleanup");
 
 #ifdef USE_POLYSCOPE
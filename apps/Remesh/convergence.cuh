@@ -0,0 +1,249 @@
+#pragma once
+#include <vector>
+
+#include "rxmesh/rxmesh_dynamic.h"
+
+#include "util.cuh"
+
+/**
+ * @brief track which patches are converged, i.e., none of split, collapse,
+ * or flip committed an operation in the patch and the last smoothing
+ * iteration did not move any of the patch vertices by more than a tolerance.
+ * After each remeshing iteration, the next one only processes the patches that
+ * changed (and their neighbor patches since their cavities/one-rings could
+ * reach into them) in both the scheduler and smoothing. A non-positive
+ * tolerance disables the skipping
+ */
+struct PatchConvergence
+{
+    PatchConvergence(rxmesh::RXMeshDynamic& rx, const float tol)
+        : m_enabled(tol > 0),
+          m_all_active(true),
+          m_converged(false),
+          m_tol_sq(tol * tol),
+          m_num_patches(rx.get_num_patches()),
+          m_max_num_patches(rx.get_max_num_patches()),
+          m_d_changed(nullptr),
+          m_d_active(nullptr),
+          m_d_active_flags(nullptr)
+    {
+        CUDA_ERROR(cudaMalloc((void**)&m_d_changed,
+                              m_max_num_patches * sizeof(uint32_t)));
+        CUDA_ERROR(cudaMalloc((void**)&m_d_active,
+                              m_max_num_patches * sizeof(uint32_t)));
+        CUDA_ERROR(cudaMalloc((void**)&m_d_active_flags,
+                              m_max_num_patches * sizeof(uint8_t)));
+        CUDA_ERROR(cudaMemset(
+            m_d_active_flags, 1, m_max_num_patches * sizeof(uint8_t)));
+    }
+
+    PatchConvergence(const PatchConvergence&) = delete;
+
+    ~PatchConvergence()
+    {
+        GPU_FREE(m_d_changed);
+        GPU_FREE(m_d_active);
+        GPU_FREE(m_d_active_flags);
+    }
+
+    /**
+     * @brief start a new remeshing iteration
+     */
+    void begin_iteration(const rxmesh::RXMeshDynamic& rx)
+    {
+        m_num_patches = rx.get_num_patches();
+        CUDA_ERROR(
+            cudaMemset(m_d_changed, 0, m_max_num_patches * sizeof(uint32_t)));
+    }
+
+    /**
+     * @brief fill the scheduler with the active patches and the patches that
+     * were created by slicing during this iteration
+     */
+    void reset_scheduler(rxmesh::RXMeshDynamic& rx) const
+    {
+        if (m_all_active) {
+            rx.reset_scheduler();
+            return;
+        }
+        std::vector<uint32_t> patches = m_active;
+        for (uint32_t p = m_num_patches; p < rx.get_num_patches(); ++p) {
+            patches.push_back(p);
+        }
+        rx.reset_scheduler(patches);
+    }
+
+    /**
+     * @brief mark the edges of the inactive patches as SKIP such that the
+     * remaining work (is_done()) only counts the active patches. Should be
+     * called after resetting the edge status
+     */
+    void skip_inactive(const rxmesh::RXMeshDynamic&       rx,
+                       rxmesh::EdgeAttribute<EdgeStatus>* edge_status) const
+    {
+        using namespace rxmesh;
+
+        if (m_all_active) {
+            return;
+        }
+
+        const uint32_t            num_patches = m_num_patches;
+        const uint8_t*            d_flags     = m_d_active_flags;
+        EdgeAttribute<EdgeStatus> status      = *edge_status;
+
+        rx.for_each_edge(DEVICE, [=] __device__(const EdgeHandle eh) {
+            const uint32_t p = eh.patch_id();
+            if (p < num_patches && d_flags[p] == 0) {
+                status(eh) = SKIP;
+            }
+        });
+    }
+
+    /**
+     * @brief mark the patches where an operation was committed, i.e., the
+     * patches with ADDED edges. Should be called after each of
+     * split/collapse/flip
+     */
+    void mark_topology_changes(
+        const rxmesh::RXMeshDynamic&             rx,
+        const rxmesh::EdgeAttribute<EdgeStatus>* edge_status) const
+    {
+        using namespace rxmesh;
+
+        if (!m_enabled) {
+            return;
+        }
+
+        uint32_t*                       d_changed = m_d_changed;
+        const EdgeAttribute<EdgeStatus> status    = *edge_status;
+
+        rx.for_each_edge(DEVICE, [=] __device__(const EdgeHandle eh) {
+            if (status(eh) == ADDED) {
+                d_changed[eh.patch_id()] = 1;
+            }
+        });
+    }
+
+    /**
+     * @brief the per-patch flags that the smoothing kernel sets when one of
+     * the patch vertices moves by more than the tolerance (or nullptr if the
+     * skipping is disabled)
+     */
+    uint32_t* get_changed_flags() const
+    {
+        return m_enabled ? m_d_changed : nullptr;
+    }
+
+    float get_tol_sq() const
+    {
+        return m_tol_sq;
+    }
+
+    /**
+     * @brief set the active patches as the patch subset of rx (see
+     * RXMeshStatic::set_patch_subset()) such that smoothing only launches one
+     * block per active patch
+     * @return false if all patches are active (no subset is set)
+     */
+    bool set_patch_subset(rxmesh::RXMeshDynamic& rx)
+    {
+        if (m_all_active) {
+            return false;
+        }
+        std::vector<uint32_t> patches = m_active;
+        for (uint32_t p = m_num_patches; p < rx.get_num_patches(); ++p) {
+            patches.push_back(p);
+        }
+        CUDA_ERROR(cudaMemcpy(m_d_active,
+                              patches.data(),
+                              patches.size() * sizeof(uint32_t),
+                              cudaMemcpyHostToDevice));
+        rx.set_patch_subset(m_d_active, uint32_t(patches.size()));
+        return true;
+    }
+
+    /**
+     * @brief finish the remeshing iteration and compute the active patches of
+     * the next one
+     * @return false if all patches are converged
+     */
+    bool end_iteration(rxmesh::RXMeshDynamic& rx)
+    {
+        if (!m_enabled) {
+            return true;
+        }
+
+        const uint32_t        num_patches = rx.get_num_patches();
+        std::vector<uint32_t> h_changed(num_patches);
+        CUDA_ERROR(cudaMemcpy(h_changed.data(),
+                              m_d_changed,
+                              num_patches * sizeof(uint32_t),
+                              cudaMemcpyDeviceToHost));
+
+        std::vector<uint32_t> changed;
+        for (uint32_t p = 0; p < num_patches; ++p) {
+            if (h_changed[p] != 0 || p >= m_num_patches) {
+                changed.push_back(p);
+            }
+        }
+
+        m_num_patches = num_patches;
+
+        if (changed.empty()) {
+            m_converged = true;
+            return false;
+        }
+
+        // grow the changed patches by their neighbor patches
+        CUDA_ERROR(cudaMemcpy(m_d_active,
+                              changed.data(),
+                              changed.size() * sizeof(uint32_t),
+                              cudaMemcpyHostToDevice));
+        rx.set_patch_subset(m_d_active, uint32_t(changed.size()), true);
+        m_active.resize(rx.get_patch_subset_size());
+        CUDA_ERROR(cudaMemcpy(m_active.data(),
+                              rx.get_patch_subset(),
+                              m_active.size() * sizeof(uint32_t),
+                              cudaMemcpyDeviceToHost));
+        rx.clear_patch_subset();
+
+        std::vector<uint8_t> h_flags(m_max_num_patches, 0);
+        for (const uint32_t p : m_active) {
+            h_flags[p] = 1;
+        }
+        CUDA_ERROR(cudaMemcpy(m_d_active_flags,
+                              h_flags.data(),
+                              m_max_num_patches * sizeof(uint8_t),
+                              cudaMemcpyHostToDevice));
+
+        m_all_active = false;
+        return true;
+    }
+
+    /**
+     * @brief the number of patches processed in the current iteration
+     */
+    uint32_t get_num_active(const rxmesh::RXMeshDynamic& rx) const
+    {
+        return m_all_active ? rx.get_num_patches() :
+                              uint32_t(m_active.size()) +
+                                  (rx.get_num_patches() - m_num_patches);
+    }
+
+    bool is_converged() const
+    {
+        return m_converged;
+    }
+
+   private:
+    bool                  m_enabled;
+    bool                  m_all_active;
+    bool                  m_converged;
+    float                 m_tol_sq;
+    uint32_t              m_num_patches;
+    uint32_t              m_max_num_patches;
+    uint32_t*             m_d_changed;
+    uint32_t*             m_d_active;
+    uint8_t*              m_d_active_flags;
+    std::vector<uint32_t> m_active;
+};
@@ -5,6 +5,7 @@
 #include "rxmesh/query.cuh"
 #include "rxmesh/rxmesh_dynamic.h"
 
+#include "convergence.cuh"
 #include "util.cuh"
 
 
@@ -58,11 +59,6 @@ __global__ static void __launch_bounds__(blockThreads)
 
     uint32_t shmem_before = shrd_alloc.get_allocated_size_bytes();
 
-    // we use this bitmask to mark the other end of to-be-collapse edge during
-    // checking for the link condition
-    Bitmask v0_mask(cavity.patch_info().num_vertices[0], shrd_alloc);
-    Bitmask v1_mask(cavity.patch_info().num_vertices[0], shrd_alloc);
-
     // precompute EVDiamond
     Query<blockThreads> query(context, cavity.patch_id());
     query.prologue<Op::EVDiamond>(block, shrd_alloc);
@@ -124,7 +120,7 @@ __global__ static void __launch_bounds__(blockThreads)
 
     // 2. check link condition
     link_condition(
-        block, cavity.patch_info(), query, edge_mask, v0_mask, v1_mask, 0, 2);
+        block, cavity.patch_info(), query, shrd_alloc, edge_mask, 0, 2);
     block.sync();
 
 
@@ -378,15 +374,16 @@ __global__ static void __launch_bounds__(blockThreads)
 }
 
 
-template <typename T>
+template <typename T, typename TimerT>
 inline void equalize_valences(rxmesh::RXMeshDynamic&             rx,
                               rxmesh::VertexAttribute<T>*        coords,
                               rxmesh::VertexAttribute<uint8_t>*  v_valence,
                               rxmesh::EdgeAttribute<EdgeStatus>* edge_status,
                               rxmesh::EdgeAttribute<int8_t>*     edge_link,
                               rxmesh::VertexAttribute<bool>*     v_boundary,
-                              rxmesh::Timers<rxmesh::GPUTimer>&  timers,
-                              int*                               d_buffer)
+                              rxmesh::Timers<TimerT>&            timers,
+                              int*                               d_buffer,
+                              PatchConvergence&                  conv)
 {
 
     using namespace rxmesh;
@@ -422,6 +419,7 @@ inline void equalize_valences(rxmesh::RXMeshDynamic&             rx,
                          });
 
     edge_status->reset(UNSEEN, DEVICE);
+    conv.skip_inactive(rx, edge_status);
 
     int prv_remaining_work = rx.get_num_edges();
 
@@ -432,7 +430,7 @@ inline void equalize_valences(rxmesh::RXMeshDynamic&             rx,
     timers.start("FlipTotal");
     while (true) {
         num_outer_iter++;
-        rx.reset_scheduler();
+        conv.reset_scheduler(rx);
         while (!rx.is_queue_empty()) {
             // RXMESH_INFO(" Queue size = {}",
             //             rx.get_context().m_patch_scheduler.size());
@@ -459,15 +457,8 @@ inline void equalize_valences(rxmesh::RXMeshDynamic&             rx,
             timers.stop("Flip");
 
             timers.start("FlipCleanup");
-            rx.cleanup();
-            timers.stop("FlipCleanup");
-
-            timers.start("FlipSlice");
-            rx.slice_patches(*coords, *edge_status, *v_boundary /*,edge_link*/);
-            timers.stop("FlipSlice");
-
-            timers.start("FlipCleanup");
-            rx.cleanup();
+            rx.cleanup_and_slice(
+                *coords, *edge_status, *v_boundary /*,edge_link*/);
             timers.stop("FlipCleanup");
         }
 
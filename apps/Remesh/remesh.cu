@@ -13,7 +13,9 @@ struct arg
     float       relative_len     = 1.0;
     int         num_smooth_iters = 5;
     uint32_t    num_iter         = 3;
+    float       conv_tol         = 1e-3;
     uint32_t    device_id        = 0;
+    bool        adaptive         = false;
     char**      argv;
     int         argc;
 } Arg;
@@ -45,6 +47,10 @@ TEST(Apps, Remesh)
 
     ASSERT_TRUE(rx.is_edge_manifold());
 
+    if (Arg.adaptive) {
+        rx.enable_adaptive_capacity();
+    }
+
     // rx.export_obj("grid_" + std::to_string(Arg.nx) + "_" +
     //                   std::to_string(Arg.ny) + ".obj",
     //               *rx.get_input_vertex_coordinates());
@@ -73,9 +79,11 @@ int main(int argc, char** argv)
                         " -num_iter:       Number of remeshing iterations. Default is {}\n"
                         " -relative_len:   Target edge length as a ratio of the input mesh average edge length. Default is {}\n"
                         "                  Hint: should be slightly less than the average edge length of the input mesh\n"
+                        " -conv_tol:       Smoothing displacement (as a ratio of the target edge length) below which a patch with no split/collapse/flip is converged and skipped in the next iterations. Zero disables the skipping. Default is {}\n"
                         " -o:              JSON file output folder. Default is {} \n"
+                        " -adaptive:       Grow the patches capacity on demand instead of preallocating every patch at the max capacity. Default is {}\n"
                         " -device_id:      GPU device ID. Default is {}",
-            Arg.obj_file_name, Arg.num_iter,Arg.relative_len, Arg.output_folder, Arg.device_id);
+            Arg.obj_file_name, Arg.num_iter,Arg.relative_len, Arg.conv_tol, Arg.output_folder, (Arg.adaptive ? "true" : "false"), Arg.device_id);
             // clang-format on
             exit(EXIT_SUCCESS);
         }
@@ -99,6 +107,14 @@ int main(int argc, char** argv)
             Arg.relative_len =
                 std::stof(get_cmd_option(argv, argv + argc, "-relative_len"));
         }
+        if (cmd_option_exists(argv, argc + argv, "-conv_tol")) {
+            Arg.conv_tol =
+                std::stof(get_cmd_option(argv, argv + argc, "-conv_tol"));
+        }
+
+        if (cmd_option_exists(argv, argc + argv, "-adaptive")) {
+            Arg.adaptive = true;
+        }
 
         if (cmd_option_exists(argv, argc + argv, "-nx")) {
             Arg.nx = atoi(get_cmd_option(argv, argv + argc, "-nx"));
@@ -113,6 +129,8 @@ int main(int argc, char** argv)
     RXMESH_TRACE("device_id= {}", Arg.device_id);
     RXMESH_TRACE("num_iter= {}", Arg.num_iter);
     RXMESH_TRACE("relative_len= {}", Arg.relative_len);
+    RXMESH_TRACE("conv_tol= {}", Arg.conv_tol);
+    RXMESH_TRACE("adaptive= {}", Arg.adaptive);
     RXMESH_TRACE("nx= {}", Arg.nx);
     RXMESH_TRACE("ny= {}", Arg.ny);
 
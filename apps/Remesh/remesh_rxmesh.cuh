@@ -12,6 +12,8 @@
 
 #include "split.cuh"
 
+#include "convergence.cuh"
+
 #include "util.cuh"
 
 int ps_iddd = 0;
@@ -215,6 +217,7 @@ inline void remesh_rxmesh(rxmesh::RXMeshDynamic& rx)
     report.model_data(Arg.obj_file_name + "_before", rx, "model_before");
     report.add_member("method", std::string("RXMesh"));
 
+    rx.enable_cavity_stats();
 
     auto coords     = rx.get_input_vertex_coordinates();
     auto new_coords = rx.add_vertex_attribute<float>("newCoords", 3);
@@ -245,24 +248,21 @@ inline void remesh_rxmesh(rxmesh::RXMeshDynamic& rx)
 
     // compute stats
 
-    Timers<GPUTimer> timers;
+    Timers<DeferredGPUTimer> timers;
 
     timers.add("Total");
 
     timers.add("SplitTotal");
     timers.add("Split");
     timers.add("SplitCleanup");
-    timers.add("SplitSlice");
 
     timers.add("CollapseTotal");
     timers.add("Collapse");
     timers.add("CollapseCleanup");
-    timers.add("CollapseSlice");
 
     timers.add("FlipTotal");
     timers.add("Flip");
     timers.add("FlipCleanup");
-    timers.add("FlipSlice");
 
     timers.add("SmoothTotal");
 
@@ -297,8 +297,18 @@ inline void remesh_rxmesh(rxmesh::RXMeshDynamic& rx)
 
     // stats(rx);
 
+    // the smoothing tolerance is relative to the target edge length
+    PatchConvergence conv(rx,
+                          Arg.conv_tol * Arg.relative_len * stats.avg_edge_len);
+
     timers.start("Total");
     for (uint32_t iter = 0; iter < Arg.num_iter; ++iter) {
+        conv.begin_iteration(rx);
+        RXMESH_INFO(" Active patches {} of {} -- iter {}",
+                    conv.get_num_active(rx),
+                    rx.get_num_patches(),
+                    iter);
+
         RXMESH_INFO(" Edge Split -- iter {}", iter);
         split_long_edges(rx,
                          coords.get(),
@@ -307,7 +317,9 @@ inline void remesh_rxmesh(rxmesh::RXMeshDynamic& rx)
                          high_edge_len_sq,
                          low_edge_len_sq,
                          timers,
-                         d_buffer);
+                         d_buffer,
+                         conv);
+        conv.mark_topology_changes(rx, edge_status.get());
 
         RXMESH_INFO(" Edge Collapse -- iter {}", iter);
         collapse_short_edges(rx,
@@ -318,7 +330,9 @@ inline void remesh_rxmesh(rxmesh::RXMeshDynamic& rx)
                              low_edge_len_sq,
                              high_edge_len_sq,
                              timers,
-                             d_buffer);
+                             d_buffer,
+                             conv);
+        conv.mark_topology_changes(rx, edge_status.get());
 
 
         RXMESH_INFO(" Edge Flip -- iter {}", iter);
@@ -329,7 +343,9 @@ inline void remesh_rxmesh(rxmesh::RXMeshDynamic& rx)
                           edge_link.get(),
                           v_boundary.get(),
                           timers,
-                          d_buffer);
+                          d_buffer,
+                          conv);
+        conv.mark_topology_changes(rx, edge_status.get());
 
         RXMESH_INFO(" Vertex Smoothing -- iter {}", iter);
         tangential_relaxation(rx,
@@ -337,8 +353,15 @@ inline void remesh_rxmesh(rxmesh::RXMeshDynamic& rx)
                               new_coords.get(),
                               v_boundary.get(),
                               Arg.num_smooth_iters,
-                              timers);
+                              timers,
+                              conv);
         std::swap(new_coords, coords);
+
+        if (!conv.end_iteration(rx)) {
+            RXMESH_INFO(" All patches converged after {} iterations",
+                        iter + 1);
+            break;
+        }
     }
 
     timers.stop("Total");
@@ -357,6 +380,11 @@ inline void remesh_rxmesh(rxmesh::RXMeshDynamic& rx)
     RXMESH_INFO("Output mesh #Patches {}", rx.get_num_patches());
 
     report.add_member("total_remesh_time", timers.elapsed_millis("Total"));
+
+    const CavityStats cavity_stats = rx.get_cavity_stats();
+    cavity_stats.print();
+    report.cavity_stats(cavity_stats);
+
     report.model_data(Arg.obj_file_name + "_after", rx, "model_after");
 
     compute_stats(
@@ -4,6 +4,7 @@
 #include "rxmesh/cavity_manager.cuh"
 #include "rxmesh/rxmesh_dynamic.h"
 
+#include "convergence.cuh"
 #include "util.cuh"
 
 
@@ -12,7 +13,9 @@ __global__ static void __launch_bounds__(blockThreads)
     vertex_smoothing(const rxmesh::Context            context,
                      const rxmesh::VertexAttribute<T> coords,
                      rxmesh::VertexAttribute<T>       new_coords,
-                     rxmesh::VertexAttribute<bool>    v_boundary)
+                     rxmesh::VertexAttribute<bool>    v_boundary,
+                     uint32_t*                        d_patch_changed,
+                     const T                          tol_sq)
 {
     // VV to compute vertex sum and normal
     using namespace rxmesh;
@@ -91,6 +94,10 @@ __global__ static void __launch_bounds__(blockThreads)
         assert(!isnan(new_v[1]));
         assert(!isnan(new_v[2]));
 
+        if (d_patch_changed && glm::distance2(v, new_v) > tol_sq) {
+            d_patch_changed[v_id.patch_id()] = 1;
+        }
+
         new_coords(v_id, 0) = new_v[0];
         new_coords(v_id, 1) = new_v[1];
         new_coords(v_id, 2) = new_v[2];
@@ -101,13 +108,14 @@ __global__ static void __launch_bounds__(blockThreads)
     query.dispatch<Op::VV>(block, shrd_alloc, smooth, true);
 }
 
-template <typename T>
+template <typename T, typename TimerT>
 inline void tangential_relaxation(rxmesh::RXMeshDynamic&         rx,
                                   rxmesh::VertexAttribute<T>*    coords,
                                   rxmesh::VertexAttribute<T>*    new_coords,
                                   rxmesh::VertexAttribute<bool>* v_boundary,
                                   const int num_smooth_iters,
-                                  rxmesh::Timers<rxmesh::GPUTimer>& timers)
+                                  rxmesh::Timers<TimerT>&        timers,
+                                  PatchConvergence&              conv)
 {
     using namespace rxmesh;
 
@@ -121,13 +129,37 @@ inline void tangential_relaxation(rxmesh::RXMeshDynamic&         rx,
                          true);
 
     timers.start("SmoothTotal");
+
+    // only smooth the vertices of the active patches. The other vertices are
+    // not written and so they are copied once to both buffers
+    const bool     is_subset  = conv.set_patch_subset(rx);
+    const uint32_t num_blocks =
+        is_subset ? rx.get_patch_subset_size() : launch_box.blocks;
+    if (is_subset) {
+        new_coords->copy_from(*coords, DEVICE, DEVICE);
+    }
+
     for (int i = 0; i < num_smooth_iters; ++i) {
-        vertex_smoothing<T, blockThreads><<<launch_box.blocks,
+        // the convergence is measured by the displacement of the last
+        // iteration
+        uint32_t* d_patch_changed =
+            (i == num_smooth_iters - 1) ? conv.get_changed_flags() : nullptr;
+
+        vertex_smoothing<T, blockThreads><<<num_blocks,
                                             launch_box.num_threads,
                                             launch_box.smem_bytes_dyn>>>(
-            rx.get_context(), *coords, *new_coords, *v_boundary);
+            rx.get_context(),
+            *coords,
+            *new_coords,
+            *v_boundary,
+            d_patch_changed,
+            T(conv.get_tol_sq()));
         std::swap(new_coords, coords);
     }
+
+    if (is_subset) {
+        rx.clear_patch_subset();
+    }
     timers.stop("SmoothTotal");
 
     // RXMESH_INFO("Relax time {} (ms)", timers.elapsed_millis("SmoothTotal"));
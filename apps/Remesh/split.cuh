@@ -4,6 +4,7 @@
 #include "rxmesh/cavity_manager.cuh"
 #include "rxmesh/rxmesh_dynamic.h"
 
+#include "convergence.cuh"
 #include "util.cuh"
 
 template <typename T, uint32_t blockThreads>
@@ -202,15 +203,16 @@ __global__ static void edge_split(rxmesh::Context                   context,
 }
 
 
-template <typename T>
+template <typename T, typename TimerT>
 inline void split_long_edges(rxmesh::RXMeshDynamic&             rx,
                              rxmesh::VertexAttribute<T>*        coords,
                              rxmesh::EdgeAttribute<EdgeStatus>* edge_status,
                              rxmesh::VertexAttribute<bool>*     v_boundary,
                              const T                           high_edge_len_sq,
                              const T                           low_edge_len_sq,
-                             rxmesh::Timers<rxmesh::GPUTimer>& timers,
-                             int*                              d_buffer)
+                             rxmesh::Timers<TimerT>&           timers,
+                             int*                              d_buffer,
+                             PatchConvergence&                 conv)
 {
     using namespace rxmesh;
 
@@ -218,6 +220,7 @@ inline void split_long_edges(rxmesh::RXMeshDynamic&             rx,
 
 
     edge_status->reset(UNSEEN, DEVICE);
+    conv.skip_inactive(rx, edge_status);
 
     int prv_remaining_work = rx.get_num_edges();
 
@@ -246,7 +249,7 @@ inline void split_long_edges(rxmesh::RXMeshDynamic&             rx,
 
     while (true) {
         num_outer_iter++;
-        rx.reset_scheduler();
+        conv.reset_scheduler(rx);
 
         while (!rx.is_queue_empty()) {
             num_inner_iter++;
@@ -273,21 +276,12 @@ inline void split_long_edges(rxmesh::RXMeshDynamic&             rx,
             // prv_time = timers.elapsed_millis("Split");
 
             timers.start("SplitCleanup");
-            rx.cleanup();
-            timers.stop("SplitCleanup");
-
-            timers.start("SplitSlice");
-            rx.slice_patches(*coords, *edge_status, *v_boundary);
-            timers.stop("SplitSlice");
-
-            timers.start("SplitCleanup");
-            rx.cleanup();
+            rx.cleanup_and_slice(*coords, *edge_status, *v_boundary);
             timers.stop("SplitCleanup");
 
             bool show = false;
             if (show) {
 
-                rx.update_host();
                 EXPECT_TRUE(rx.validate());
 
                 // float max_v(0), min_v(5000.0), max_e(0), min_e(5000.0),
@@ -1,4 +1,5 @@
 #include "rxmesh/matrix/cholesky_solver.h"
+#include "rxmesh/matrix/eigen_solver.h"
 #include "rxmesh/matrix/sparse_matrix.h"
 #include "rxmesh/query.cuh"
 #include "rxmesh/reduce_handle.h"
@@ -96,6 +97,27 @@ __global__ static void conformal_energy(const Context                context,
     query.dispatch<Op::EVDiamond>(block, shrd_alloc, compute);
 }
 
+/**
+ * @brief out = (B - eb eb^T) in for every column of in
+ */
+void scp_mat_vec(const RXMeshStatic&            rx,
+                 const SparseMatrix<cuComplex>& B,
+                 const DenseMatrix<cuComplex>&  eb,
+                 const DenseMatrix<cuComplex>&  in,
+                 DenseMatrix<cuComplex>&        out)
+{
+    for (int c = 0; c < in.cols(); ++c) {
+        const cuComplex T2 = eb.dot(in.col(c));
+        rx.for_each_vertex(
+            rxmesh::DEVICE,
+            [eb, T2, c, in, out, B] __device__(
+                const rxmesh::VertexHandle vh) mutable {
+                out(vh, c) = cuCsubf(cuCmulf(B(vh, vh), in(vh, c)),
+                                     cuCmulf(eb(vh, 0), T2));
+            });
+    }
+}
+
 int main(int argc, char** argv)
 {
     Log::init();
@@ -153,44 +175,28 @@ int main(int argc, char** argv)
             B(vh, vh) = make_cuComplex((float)v_bd(vh, 0), 0.0f);
         });
 
-    // temp mat needed for the power method
-    DenseMatrix<cuComplex> T1(rx, rx.get_num_vertices(), 1);
-    T1.reset(make_cuComplex(0.f, 0.f), LOCATION_ALL);
-
-
-    // fill-in the init solution of the eigen vector with random values
-    uv_mat.fill_random();
-
     // factorize the matrix
     CholeskySolver solver(&Lc);
     solver.pre_solve(rx);
 
-    // the power method
-    int iterations = 32;
+    // the eigenvector of (B - eb eb^T) x = mu Lc x with the largest mu. All
+    // the block vectors are solved for at once with the same factorization
+    ShiftInvertEigenSolver<cuComplex> eig_solver(rx, 1, 0.f, 32, 1e-5f);
 
-    float prv_norm = std::numeric_limits<float>::max();
-
-    for (int i = 0; i < iterations; i++) {
-        cuComplex T2 = eb.dot(uv_mat);
-        rx.for_each_vertex(rxmesh::DEVICE,
-                           [eb, T2, T1, uv_mat, B] __device__(
-                               const rxmesh::VertexHandle vh) mutable {
-                               T1(vh, 0) =
-                                   cuCsubf(cuCmulf(B(vh, vh), uv_mat(vh, 0)),
-                                           cuCmulf(eb(vh, 0), T2));
-                           });
-
-        solver.solve(T1, uv_mat);
-
-        float norm = uv_mat.norm2();
+    eig_solver.m_solve = [&](DenseMatrix<cuComplex>& rhs,
+                             DenseMatrix<cuComplex>& x) {
+        solver.solve(rhs, x);
+    };
+    eig_solver.m_mat_vec = [&](const DenseMatrix<cuComplex>& in,
+                               DenseMatrix<cuComplex>&       out) {
+        scp_mat_vec(rx, B, eb, in, out);
+    };
 
-        uv_mat.multiply(1.0f / norm);
+    std::vector<float> eig_vals;
+    eig_solver.solve(uv_mat, eig_vals);
 
-        if (std::abs(prv_norm - norm) < 0.0001) {
-            break;
-        }
-        prv_norm = norm;
-    }
+    RXMESH_INFO("SCP eigen solver took {} iterations",
+                eig_solver.iter_taken());
 
     // convert from matrix format to attributes
     rx.for_each_vertex(
@@ -239,7 +245,6 @@ int main(int argc, char** argv)
     Lc.release();
     eb.release();
     B.release();
-    T1.release();
 
     return 0;
 }
\ No newline at end of file
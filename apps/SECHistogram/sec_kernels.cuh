@@ -1,10 +1,9 @@
 #pragma once
 #include "rxmesh/cavity_manager.cuh"
+#include "rxmesh/cavity_ops.cuh"
 
 #include "rxmesh/util/histogram.cuh"
 
-#include "link_condition.cuh"
-
 template <typename T, uint32_t blockThreads>
 __global__ static void sec(rxmesh::Context            context,
                            rxmesh::VertexAttribute<T> coords,
@@ -29,11 +28,6 @@ __global__ static void sec(rxmesh::Context            context,
     Bitmask edge_mask(cavity.patch_info().edges_capacity, shrd_alloc);
     edge_mask.reset(block);
 
-    // we use this bitmask to mark the other end of to-be-collapse edge during
-    // checking for the link condition
-    Bitmask v0_mask(cavity.patch_info().num_vertices[0], shrd_alloc);
-    Bitmask v1_mask(cavity.patch_info().num_vertices[0], shrd_alloc);
-
 
     // Precompute EV
     Query<blockThreads> ev_query(context, pid);
@@ -64,7 +58,7 @@ __global__ static void sec(rxmesh::Context            context,
 
     // 2) check edge link condition.
     link_condition(
-        block, cavity.patch_info(), ev_query, edge_mask, v0_mask, v1_mask);
+        block, cavity.patch_info(), ev_query, shrd_alloc, edge_mask, 0, 1);
 
 
     block.sync();
@@ -113,8 +113,8 @@ inline void sec_rxmesh(rxmesh::RXMeshDynamic& rx,
                 false,
                 [&](uint32_t v, uint32_t e, uint32_t f) {
                     return detail::mask_num_bytes(e) +
-                           2 * detail::mask_num_bytes(v) +
-                           3 * ShmemAllocator::default_alignment;
+                           ShmemAllocator::default_alignment +
+                           link_condition_shmem_bytes(v, e);
                 });
 
 
@@ -1,10 +1,10 @@
 #pragma once
+#include "rxmesh/priority_queue.h"
 #include "rxmesh/query.cuh"
 #include "rxmesh/rxmesh_dynamic.h"
 #include "rxmesh/util/report.h"
 
 #include "secp_kernels.cuh"
-#include "secp_pair.h"
 
 inline void secp_rxmesh(rxmesh::RXMeshDynamic& rx,
                         const uint32_t         final_num_vertices,
@@ -27,7 +27,7 @@ inline void secp_rxmesh(rxmesh::RXMeshDynamic& rx,
 
     LaunchBox<blockThreads> launch_box;
 
-    Timers<GPUTimer> timers;
+    Timers<DeferredGPUTimer> timers;
     timers.add("Total");
 
     timers.add("App");
@@ -60,8 +60,12 @@ inline void secp_rxmesh(rxmesh::RXMeshDynamic& rx,
 
     int num_passes = 0;
 
+    // the edge length is the key. The queue keeps it for every edge and only
+    // the edges created by a collapse (marked dirty by the secp kernel) are
+    // recomputed every round
+    PriorityQueue<EdgeHandle, float> priority_queue(rx);
+
     CUDA_ERROR(cudaProfilerStart());
-    // PriorityQueueT priority_queue(rx.get_num_edges());
 
     timers.start("Total");
     while (rx.get_num_vertices(true) > final_num_vertices) {
@@ -69,65 +73,36 @@ inline void secp_rxmesh(rxmesh::RXMeshDynamic& rx,
 
         timers.start("PriorityQueue");
 
-        // rebuild every round? Not necessarily a great way to use a priority
-        // queue.
-        PriorityQueueT priority_queue(rx.get_num_edges());
-        // priority_queue.clear();
-        to_collapse->reset(false, DEVICE);
-        rx.update_launch_box(
-            {Op::EV},
-            launch_box,
-            (void*)compute_edge_priorities<float, blockThreads>,
-            false,
-            false,
-            false,
-            false,
-            [&](uint32_t v, uint32_t e, uint32_t f) {
-                // Allocate enough additional memory
-                // for the priority queue and the intermediate
-                // array of PriorityPairT.
-                return priority_queue.get_shmem_size(blockThreads) +
-                       (e * sizeof(PriorityPairT));
-            });
-
         timers.start("EdgePriority");
-        compute_edge_priorities<float, blockThreads>
-            <<<launch_box.blocks,
-               launch_box.num_threads,
-               launch_box.smem_bytes_dyn>>>(
-                rx.get_context(),
-                *coords,
-                priority_queue.get_mutable_device_view(),
-                priority_queue.get_shmem_size(blockThreads));
+        priority_queue.update<Op::EV, blockThreads>(
+            [coords = *coords] __device__(const EdgeHandle&     eh,
+                                          const VertexIterator& iter) {
+                const vec3<float> p0 = coords.to_glm<3>(iter[0]);
+                const vec3<float> p1 = coords.to_glm<3>(iter[1]);
+                return glm::distance2(p0, p1);
+            });
         timers.stop("EdgePriority");
 
-        // Next kernel needs to pop some percentage of the top
-        // elements in the priority queue and store popped elements
-        // to be used by the next kernel that actually does the collapses
+        // mark the shortest edge_reduce_ratio of the edges to be collapsed
         const int num_edges_before = int(rx.get_num_edges(true));
         const int reduce_threshold =
             std::max(1, int(edge_reduce_ratio * float(num_edges_before)));
-        // Mark the edge attributes to be collapsed
-        uint32_t pop_num_edges = reduce_threshold;
-
-        constexpr uint32_t threads_per_block = 256;
-        uint32_t           number_of_blocks =
-            (pop_num_edges + threads_per_block - 1) / threads_per_block;
-        int shared_mem_bytes =
-            priority_queue.get_shmem_size(threads_per_block) +
-            (threads_per_block * sizeof(PriorityPairT));
 
         timers.start("PriorityQueuePop");
-        pop_and_mark_edges_to_collapse<threads_per_block>
-            <<<number_of_blocks, threads_per_block, shared_mem_bytes>>>(
-                priority_queue.get_mutable_device_view(),
-                *to_collapse,
-                pop_num_edges);
-
+        const uint32_t num_selected =
+            priority_queue.select(reduce_threshold, *to_collapse);
         timers.stop("PriorityQueuePop");
 
         timers.stop("PriorityQueue");
 
+        if (num_selected == 0) {
+            RXMESH_WARN(
+                "secp_rxmesh() no more edges to collapse. Stopping at {} "
+                "vertices",
+                rx.get_num_vertices(true));
+            break;
+        }
+
         //{
         //    to_collapse->move(DEVICE, HOST);
         //
@@ -160,15 +135,19 @@ inline void secp_rxmesh(rxmesh::RXMeshDynamic& rx,
                 false,
                 [&](uint32_t v, uint32_t e, uint32_t f) {
                     return detail::mask_num_bytes(e) +
-                           2 * detail::mask_num_bytes(v) +
-                           3 * ShmemAllocator::default_alignment;
+                           ShmemAllocator::default_alignment +
+                           link_condition_shmem_bytes(v, e);
                 });
 
             timers.start("App");
             secp<float, blockThreads><<<launch_box.blocks,
                                         launch_box.num_threads,
                                         launch_box.smem_bytes_dyn>>>(
-                rx.get_context(), *coords, *to_collapse);
+                rx.get_context(),
+                *coords,
+                *to_collapse,
+                priority_queue.keys(),
+                priority_queue.dirty());
             timers.stop("App");
 
             timers.start("Cleanup");
@@ -176,7 +155,10 @@ inline void secp_rxmesh(rxmesh::RXMeshDynamic& rx,
             timers.stop("Cleanup");
 
             timers.start("Slice");
-            rx.slice_patches(*coords);
+            rx.slice_patches(*coords,
+                             *to_collapse,
+                             priority_queue.keys(),
+                             priority_queue.dirty());
             timers.stop("Slice");
 
             timers.start("Cleanup");
@@ -227,6 +209,8 @@ inline void secp_rxmesh(rxmesh::RXMeshDynamic& rx,
     RXMESH_INFO("#Patches {}", rx.get_num_patches(true));
 
 
+    priority_queue.release();
+
     rx.update_host();
     coords->move(DEVICE, HOST);
     EXPECT_TRUE(rx.validate());
@@ -3,12 +3,11 @@
 #include <Eigen/Dense>
 
 #include "rxmesh/cavity_manager.cuh"
+#include "rxmesh/cavity_ops.cuh"
 #include "rxmesh/query.cuh"
 
 #include "rxmesh/geometry_util.cuh"
 
-#include "link_condition.cuh"
-
 
 template <typename T, uint32_t blockThreads>
 __global__ static void  //__launch_bounds__(blockThreads)
@@ -73,11 +72,6 @@ edge_collapse(rxmesh::Context                   context,
 
     uint32_t shmem_before = shrd_alloc.get_allocated_size_bytes();
 
-    // we use this bitmask to mark the other end of to-be-collapse edge during
-    // checking for the link condition
-    Bitmask v0_mask(cavity.patch_info().num_vertices[0], shrd_alloc);
-    Bitmask v1_mask(cavity.patch_info().num_vertices[0], shrd_alloc);
-
     // Precompute EVDiamond
     Query<blockThreads> query(context, pid);
     query.prologue<Op::EVDiamond>(block, shrd_alloc);
@@ -152,8 +146,14 @@ edge_collapse(rxmesh::Context                   context,
 
 
     // 2. check link condition
-    link_condition(
-        block, cavity.patch_info(), query, edge_mask, v0_mask, v1_mask, 0, 2);
+    link_condition(block,
+                   cavity.patch_info(),
+                   query,
+                   shrd_alloc,
+                   edge_mask,
+                   0,
+                   2,
+                   true);
     block.sync();
 
 
@@ -3,9 +3,9 @@
 #include <Eigen/Dense>
 
 #include "rxmesh/cavity_manager.cuh"
+#include "rxmesh/cavity_ops.cuh"
 #include "rxmesh/query.cuh"
 
-#include "link_condition.cuh"
 #include "rxmesh/geometry_util.cuh"
 
 template <typename T, uint32_t blockThreads>
@@ -143,11 +143,6 @@ edge_flip(rxmesh::Context                   context,
     fill_n<blockThreads>(
         v_info, 2 * cavity.patch_info().num_vertices[0], uint16_t(INVALID16));
 
-    // we use this bitmask to mark the other end of to-be-collapse edge during
-    // checking for the link condition
-    Bitmask v0_mask(cavity.patch_info().num_vertices[0], shrd_alloc);
-    Bitmask v1_mask(cavity.patch_info().num_vertices[0], shrd_alloc);
-
 
     // precompute EVDiamond
     Query<blockThreads> query(context, cavity.patch_id());
@@ -350,8 +345,14 @@ edge_flip(rxmesh::Context                   context,
 
     // 2. make sure that the two vertices opposite to a flipped edge are not
     // connected (link condition)
-    link_condition(
-        block, cavity.patch_info(), query, edge_mask, v0_mask, v1_mask, 0, 2);
+    link_condition(block,
+                   cavity.patch_info(),
+                   query,
+                   shrd_alloc,
+                   edge_mask,
+                   0,
+                   2,
+                   true);
     block.sync();
 
     query.epilogue(block, shrd_alloc);
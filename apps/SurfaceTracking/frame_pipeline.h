@@ -0,0 +1,349 @@
+#pragma once
+
+#include <condition_variable>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "rxmesh/rxmesh_dynamic.h"
+
+/**
+ * @brief one captured frame in pinned host memory as passed to the sink of
+ * FramePipeline. The pointers are only valid during the sink call
+ */
+template <typename T>
+struct FrameData
+{
+    int             frame;
+    uint32_t        num_vertices;
+    uint32_t        num_faces;
+    const T*        positions;  // num_vertices x 3
+    const uint32_t* faces;      // num_faces x 3 (indices into positions)
+};
+
+/**
+ * @brief the compacted mesh (positions and face indices) of one frame on the
+ * device and in pinned host memory
+ */
+template <typename T>
+struct FrameSlot
+{
+    T*          d_pos      = nullptr;
+    uint32_t*   d_fv       = nullptr;
+    uint32_t*   d_count    = nullptr;
+    T*          h_pos      = nullptr;
+    uint32_t*   h_fv       = nullptr;
+    uint32_t    capacity_v = 0;
+    uint32_t    capacity_f = 0;
+    cudaEvent_t captured;
+    cudaEvent_t copied;
+    int         frame        = -1;
+    uint32_t    num_vertices = 0;
+    uint32_t    num_faces    = 0;
+    bool        busy         = false;
+};
+
+/**
+ * @brief host-side pipelined frame output where the output of frame N (the
+ * device-to-host copy and writing the frame e.g., to an OBJ file) overlaps
+ * with simulating frame N+1 on the device. submit() compacts the current
+ * mesh into the device buffers of the next free slot on the simulation
+ * stream (so the simulation can change the topology right after) and the copy
+ * into the pinned buffers of the slot is done on a dedicated (non-blocking)
+ * copy stream. A writer thread waits for the copy and passes the frame to the
+ * sink. submit() only blocks if all slots are still being written (i.e., the
+ * sink is slower than the simulation). The default is two slots (double
+ * buffering)
+ */
+template <typename T>
+struct FramePipeline
+{
+    using SinkT = std::function<void(const FrameData<T>&)>;
+
+    FramePipeline(rxmesh::RXMeshDynamic& rx, SinkT sink, int num_slots = 2)
+        : m_rx(rx), m_sink(sink), m_slots(num_slots), m_next(0), m_stop(false)
+    {
+        using namespace rxmesh;
+
+        m_vid = rx.add_vertex_attribute<uint32_t>("fpVid", 1, DEVICE);
+
+        CUDA_ERROR(
+            cudaStreamCreateWithFlags(&m_copy_stream, cudaStreamNonBlocking));
+
+        for (auto& s : m_slots) {
+            CUDA_ERROR(cudaEventCreateWithFlags(&s.captured,
+                                                cudaEventDisableTiming));
+            CUDA_ERROR(
+                cudaEventCreateWithFlags(&s.copied, cudaEventDisableTiming));
+            CUDA_ERROR(tracked_malloc(
+                &s.d_count, 2 * sizeof(uint32_t), MemoryCategory::Other));
+        }
+
+        m_writer = std::thread([this]() { write_loop(); });
+    }
+
+    FramePipeline(const FramePipeline&)            = delete;
+    FramePipeline& operator=(const FramePipeline&) = delete;
+
+    ~FramePipeline()
+    {
+        flush();
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_cv.notify_all();
+        m_writer.join();
+
+        for (auto& s : m_slots) {
+            free_slot(s);
+            GPU_FREE(s.d_count);
+            CUDA_ERROR(cudaEventDestroy(s.captured));
+            CUDA_ERROR(cudaEventDestroy(s.copied));
+        }
+        CUDA_ERROR(cudaStreamDestroy(m_copy_stream));
+        m_rx.remove_attribute("fpVid");
+    }
+
+    /**
+     * @brief capture the current mesh with the vertex positions pos as frame
+     * and send it to the sink asynchronously. stream is the simulation stream
+     */
+    void submit(const int                   frame,
+                rxmesh::VertexAttribute<T>& pos,
+                cudaStream_t                stream = NULL)
+    {
+        using namespace rxmesh;
+
+        FrameSlot<T>& s = m_slots[m_next];
+        m_next          = (m_next + 1) % m_slots.size();
+
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cv.wait(lock, [&]() { return !s.busy; });
+        }
+
+        s.frame        = frame;
+        s.num_vertices = m_rx.get_num_vertices(true);
+        s.num_faces    = m_rx.get_num_faces(true);
+
+        grow_slot(s);
+
+        capture(s, pos, stream);
+
+        CUDA_ERROR(cudaEventRecord(s.captured, stream));
+        CUDA_ERROR(cudaStreamWaitEvent(m_copy_stream, s.captured, 0));
+        CUDA_ERROR(cudaMemcpyAsync(s.h_pos,
+                                   s.d_pos,
+                                   3 * s.num_vertices * sizeof(T),
+                                   cudaMemcpyDeviceToHost,
+                                   m_copy_stream));
+        CUDA_ERROR(cudaMemcpyAsync(s.h_fv,
+                                   s.d_fv,
+                                   3 * s.num_faces * sizeof(uint32_t),
+                                   cudaMemcpyDeviceToHost,
+                                   m_copy_stream));
+        CUDA_ERROR(cudaEventRecord(s.copied, m_copy_stream));
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            s.busy = true;
+            m_queue.push(&s);
+        }
+        m_cv.notify_all();
+    }
+
+    /**
+     * @brief block until all submitted frames have been passed to the sink
+     */
+    void flush()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_cv.wait(lock, [&]() {
+            if (!m_queue.empty()) {
+                return false;
+            }
+            for (const auto& s : m_slots) {
+                if (s.busy) {
+                    return false;
+                }
+            }
+            return true;
+        });
+    }
+
+    /**
+     * @brief compact the owned vertices and faces of the mesh into the slot on
+     * stream. Vertices are numbered in the order they are visited
+     */
+    void capture(FrameSlot<T>&               s,
+                 rxmesh::VertexAttribute<T>& pos,
+                 cudaStream_t                stream)
+    {
+        using namespace rxmesh;
+
+        CUDA_ERROR(
+            cudaMemsetAsync(s.d_count, 0, 2 * sizeof(uint32_t), stream));
+
+        VertexAttribute<uint32_t> vid     = *m_vid;
+        VertexAttribute<T>        p       = pos;
+        T*                        d_pos   = s.d_pos;
+        uint32_t*                 d_fv    = s.d_fv;
+        uint32_t*                 d_count = s.d_count;
+
+        m_rx.for_each_vertex(
+            DEVICE,
+            [=] __device__(const VertexHandle vh) mutable {
+                const uint32_t id = ::atomicAdd(d_count, 1u);
+                vid(vh)           = id;
+                for (int i = 0; i < 3; ++i) {
+                    d_pos[3 * id + i] = p(vh, i);
+                }
+            },
+            stream);
+
+        m_rx.template run_query_kernel<Op::FV, 256>(
+            [=] __device__(const FaceHandle& fh, const VertexIterator& fv) {
+                const uint32_t f = ::atomicAdd(d_count + 1, 1u);
+                for (int i = 0; i < 3; ++i) {
+                    d_fv[3 * f + i] = vid(fv[i]);
+                }
+            },
+            false,
+            stream);
+    }
+
+    /**
+     * @brief a sink that writes every frame to prefix + frame + ".obj"
+     */
+    static SinkT obj_writer(const std::string& prefix)
+    {
+        return [prefix](const FrameData<T>& f) {
+            std::ofstream file(prefix + std::to_string(f.frame) + ".obj");
+            for (uint32_t v = 0; v < f.num_vertices; ++v) {
+                file << "v " << f.positions[3 * v] << " "
+                     << f.positions[3 * v + 1] << " "
+                     << f.positions[3 * v + 2] << "\n";
+            }
+            for (uint32_t i = 0; i < f.num_faces; ++i) {
+                file << "f " << f.faces[3 * i] + 1 << " "
+                     << f.faces[3 * i + 1] + 1 << " " << f.faces[3 * i + 2] + 1
+                     << "\n";
+            }
+        };
+    }
+
+    /**
+     * @brief a sink that writes every frame to prefix + frame + ".bin" as the
+     * number of vertices and faces (uint32_t) followed by the positions and
+     * the face indices
+     */
+    static SinkT binary_writer(const std::string& prefix)
+    {
+        return [prefix](const FrameData<T>& f) {
+            std::ofstream file(prefix + std::to_string(f.frame) + ".bin",
+                               std::ios::binary);
+            file.write(reinterpret_cast<const char*>(&f.num_vertices),
+                       sizeof(uint32_t));
+            file.write(reinterpret_cast<const char*>(&f.num_faces),
+                       sizeof(uint32_t));
+            file.write(reinterpret_cast<const char*>(f.positions),
+                       3 * size_t(f.num_vertices) * sizeof(T));
+            file.write(reinterpret_cast<const char*>(f.faces),
+                       3 * size_t(f.num_faces) * sizeof(uint32_t));
+        };
+    }
+
+   private:
+    void write_loop()
+    {
+        while (true) {
+            FrameSlot<T>* s = nullptr;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_cv.wait(lock, [&]() { return m_stop || !m_queue.empty(); });
+                if (m_queue.empty()) {
+                    return;
+                }
+                s = m_queue.front();
+                m_queue.pop();
+            }
+
+            CUDA_ERROR(cudaEventSynchronize(s->copied));
+
+            if (m_sink) {
+                m_sink(FrameData<T>{s->frame,
+                                    s->num_vertices,
+                                    s->num_faces,
+                                    s->h_pos,
+                                    s->h_fv});
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                s->busy = false;
+            }
+            m_cv.notify_all();
+        }
+    }
+
+    void grow_slot(FrameSlot<T>& s)
+    {
+        using namespace rxmesh;
+
+        if (s.num_vertices > s.capacity_v) {
+            GPU_FREE(s.d_pos);
+            if (s.h_pos != nullptr) {
+                CUDA_ERROR(cudaFreeHost(s.h_pos));
+            }
+            // leave room for the mesh to grow
+            s.capacity_v = s.num_vertices + s.num_vertices / 4;
+            CUDA_ERROR(tracked_malloc(
+                &s.d_pos, 3 * s.capacity_v * sizeof(T), MemoryCategory::Other));
+            CUDA_ERROR(
+                cudaMallocHost((void**)&s.h_pos, 3 * s.capacity_v * sizeof(T)));
+        }
+
+        if (s.num_faces > s.capacity_f) {
+            GPU_FREE(s.d_fv);
+            if (s.h_fv != nullptr) {
+                CUDA_ERROR(cudaFreeHost(s.h_fv));
+            }
+            s.capacity_f = s.num_faces + s.num_faces / 4;
+            CUDA_ERROR(tracked_malloc(&s.d_fv,
+                                      3 * s.capacity_f * sizeof(uint32_t),
+                                      MemoryCategory::Other));
+            CUDA_ERROR(cudaMallocHost((void**)&s.h_fv,
+                                      3 * s.capacity_f * sizeof(uint32_t)));
+        }
+    }
+
+    void free_slot(FrameSlot<T>& s)
+    {
+        GPU_FREE(s.d_pos);
+        GPU_FREE(s.d_fv);
+        if (s.h_pos != nullptr) {
+            CUDA_ERROR(cudaFreeHost(s.h_pos));
+        }
+        if (s.h_fv != nullptr) {
+            CUDA_ERROR(cudaFreeHost(s.h_fv));
+        }
+    }
+
+    rxmesh::RXMeshDynamic&                             m_rx;
+    SinkT                                              m_sink;
+    std::vector<FrameSlot<T>>                          m_slots;
+    size_t                                             m_next;
+    std::shared_ptr<rxmesh::VertexAttribute<uint32_t>> m_vid;
+    cudaStream_t                                       m_copy_stream;
+    std::thread                                        m_writer;
+    std::mutex                                         m_mutex;
+    std::condition_variable                            m_cv;
+    std::queue<FrameSlot<T>*>                          m_queue;
+    bool                                               m_stop;
+};
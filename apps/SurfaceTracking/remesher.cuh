@@ -0,0 +1,591 @@
+#pragma once
+
+#include <Eigen/Dense>
+
+#include "rxmesh/cavity_manager.cuh"
+#include "rxmesh/cavity_ops.cuh"
+#include "rxmesh/query.cuh"
+
+#include "rxmesh/geometry_util.cuh"
+
+/**
+ * The operation picked for an edge by the fused remeshing kernel
+ */
+enum RemeshOp : uint8_t
+{
+    REMESH_NONE     = 0,
+    REMESH_SPLIT    = 1,
+    REMESH_COLLAPSE = 2,
+    REMESH_FLIP     = 3,
+};
+
+/**
+ * @brief check if splitting the edge a-b (with opposite vertices c and d)
+ * creates good triangles. Same checks as in split_edges()
+ */
+template <typename T>
+__device__ __inline__ bool split_is_valid(const rxmesh::vec3<T>& va,
+                                          const rxmesh::vec3<T>& vb,
+                                          const rxmesh::vec3<T>& vc,
+                                          const rxmesh::vec3<T>& vd,
+                                          const T min_triangle_area,
+                                          const T min_triangle_angle,
+                                          const T max_triangle_angle)
+{
+    using namespace rxmesh;
+
+    // splitting degenerate triangles causes problems
+    if (tri_area(va, vb, vc) < min_triangle_area ||
+        tri_area(va, vb, vd) < min_triangle_area) {
+        return false;
+    }
+
+    // mid point (new) vertex
+    const vec3<T> ve = T(0.5) * (va + vb);
+
+    // new triangles angle
+    T min1, min2, min3, min4, max1, max2, max3, max4;
+
+    triangle_min_max_angle(va, ve, vc, min1, max1);
+    triangle_min_max_angle(vc, ve, vb, min2, max2);
+    triangle_min_max_angle(vd, vb, ve, min3, max3);
+    triangle_min_max_angle(vd, ve, va, min4, max4);
+
+    if (min1 < min_triangle_angle || min2 < min_triangle_angle ||
+        min3 < min_triangle_angle || min4 < min_triangle_angle) {
+        return false;
+    }
+
+    if (max1 > max_triangle_angle || max2 > max_triangle_angle ||
+        max3 > max_triangle_angle || max4 > max_triangle_angle) {
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief check if flipping the edge a-b (with opposite vertices c and d)
+ * improves the mesh and creates good triangles. Same checks as in edge_flip()
+ */
+template <typename T>
+__device__ __inline__ bool flip_is_valid(const rxmesh::vec3<T>& va,
+                                         const rxmesh::vec3<T>& vb,
+                                         const rxmesh::vec3<T>& vc,
+                                         const rxmesh::vec3<T>& vd,
+                                         const T edge_flip_min_length_change,
+                                         const T max_volume_change,
+                                         const T min_triangle_area,
+                                         const T min_triangle_angle,
+                                         const T max_triangle_angle)
+{
+    using namespace rxmesh;
+
+    // change in length i.e., delaunay check
+    if (glm::distance2(vc, vd) >=
+        glm::distance2(va, vb) - edge_flip_min_length_change) {
+        return false;
+    }
+
+    // control volume change
+    if (std::fabs(signed_volume(va, vb, vc, vd)) > max_volume_change) {
+        return false;
+    }
+
+    // if both old triangle normals agree before flipping, make sure they
+    // agree after flipping
+    const vec3<T> n0 = tri_normal(va, vb, vc);
+    const vec3<T> n1 = tri_normal(va, vd, vb);
+    const vec3<T> n2 = tri_normal(vc, vd, vb);
+    const vec3<T> n3 = tri_normal(vc, va, vd);
+
+    if (glm::dot(n0, n1) > T(0)) {
+        if (glm::dot(n2, n3) < T(0) || glm::dot(n2, n0) < T(0) ||
+            glm::dot(n2, n1) < T(0) || glm::dot(n3, n0) < T(0) ||
+            glm::dot(n3, n1) < T(0)) {
+            return false;
+        }
+    }
+
+    // prevent creating degenerate/tiny triangles
+    if (tri_area(vc, vb, vd) < min_triangle_area ||
+        tri_area(vc, va, vd) < min_triangle_area) {
+        return false;
+    }
+
+    // control change in area
+    const T old_area = tri_area(va, vc, vb) + tri_area(va, vd, vb);
+    const T new_area = tri_area(vc, vb, vd) + tri_area(vc, va, vd);
+    if (std::fabs(old_area - new_area) > T(0.1) * old_area) {
+        return false;
+    }
+
+    // don't introduce a large or small angle
+    T min_angle0, min_angle1, max_angle0, max_angle1;
+    triangle_min_max_angle(vc, vb, vd, min_angle0, max_angle0);
+    triangle_min_max_angle(vc, va, vd, min_angle1, max_angle1);
+
+    if (min_angle0 < min_triangle_angle || min_angle1 < min_triangle_angle ||
+        max_angle0 > max_triangle_angle || max_angle1 > max_triangle_angle) {
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief one fused remeshing pass where every UNSEEN edge picks the operation
+ * it needs, i.e., collapse if it is short, split if it is long (or opposite
+ * to a large angle), or flip if this improves the Delaunay-ness, and all of
+ * them are applied by the same cavity manager. The cavity of an edge is its
+ * two end vertices along with all their incident faces (CavityOp::EV) which
+ * is what the collapse needs. The split and flip re-create the two end
+ * vertices and re-triangulate the one ring of each of them. Thus, all the
+ * operations only apply to edges whose two end vertices are not on the
+ * boundary and that pass the link condition (i.e., the cavity is a disk)
+ */
+template <typename T, uint32_t blockThreads>
+__global__ static void  //__launch_bounds__(blockThreads)
+remesh_edges(rxmesh::Context                   context,
+             rxmesh::VertexAttribute<T>        position,
+             rxmesh::VertexAttribute<int8_t>   vertex_rank,
+             rxmesh::EdgeAttribute<EdgeStatus> edge_status,
+             rxmesh::VertexAttribute<int8_t>   is_vertex_bd,
+             const T                           splitter_max_edge_length,
+             const T                           collapser_min_edge_length,
+             const T                           edge_flip_min_length_change,
+             const T                           max_volume_change,
+             const T                           min_triangle_area,
+             const T                           min_triangle_angle,
+             const T                           max_triangle_angle)
+{
+    using namespace rxmesh;
+    auto           block = cooperative_groups::this_thread_block();
+    ShmemAllocator shrd_alloc;
+    CavityManager<blockThreads, CavityOp::EV> cavity(
+        block, context, shrd_alloc, true);
+
+    const uint32_t pid = cavity.patch_id();
+
+    if (pid == INVALID32) {
+        return;
+    }
+
+    const uint16_t num_edges = cavity.patch_info().edges_capacity;
+    const uint16_t num_v     = cavity.patch_info().num_vertices[0];
+
+    // a bitmask that indicates which edge we want to change
+    // we also use it to mark updated edges (for edge_status)
+    Bitmask edge_mask(num_edges, shrd_alloc);
+    edge_mask.reset(block);
+
+    // the operation of every edge and its two opposite vertices (local index)
+    // where s_opposite[2 * e] is the vertex of the face that goes from the
+    // edge v0 to v1 and s_opposite[2 * e + 1] is the one of the other face
+    uint8_t*  s_op       = shrd_alloc.alloc<uint8_t>(num_edges);
+    uint16_t* s_opposite = shrd_alloc.alloc<uint16_t>(2 * num_edges);
+    fill_n<blockThreads>(s_op, num_edges, uint8_t(REMESH_NONE));
+
+    uint32_t shmem_before = shrd_alloc.get_allocated_size_bytes();
+
+    // for each edge we want to flip, we store its id in one of its opposite
+    // vertices along with the other opposite vertex
+    uint16_t* v_info = shrd_alloc.alloc<uint16_t>(2 * num_v);
+    fill_n<blockThreads>(v_info, 2 * num_v, uint16_t(INVALID16));
+
+    // Precompute EVDiamond
+    Query<blockThreads> query(context, pid);
+    query.prologue<Op::EVDiamond>(block, shrd_alloc);
+    block.sync();
+
+    // lambda function that picks the operation of an edge
+    auto pick_op = [&](const EdgeHandle& eh, const VertexIterator& iter) {
+        // iter[0] and iter[2] are the edge two vertices
+        // iter[1] and iter[3] are the two opposite vertices
+        /*
+            0a
+          /  | \
+         c3  |  1d
+          \  |  /
+            2b
+        */
+        const VertexHandle ah = iter[0];
+        const VertexHandle bh = iter[2];
+        const VertexHandle dh = iter[1];
+        const VertexHandle ch = iter[3];
+
+        // don't change boundary edges or edges with boundary vertices
+        if (!ch.is_valid() || !dh.is_valid() || is_vertex_bd(ah) != 0 ||
+            is_vertex_bd(bh) != 0) {
+            return;
+        }
+
+        // degenerate cases
+        if (ah == bh || ah == ch || ah == dh || bh == ch || bh == dh ||
+            ch == dh) {
+            return;
+        }
+
+        const vec3<T> va = position.template to_glm<3>(ah);
+        const vec3<T> vb = position.template to_glm<3>(bh);
+        const vec3<T> vc = position.template to_glm<3>(ch);
+        const vec3<T> vd = position.template to_glm<3>(dh);
+
+        const T len = glm::distance2(va, vb);
+
+        uint8_t op = REMESH_NONE;
+
+        if (len < collapser_min_edge_length) {
+            op = REMESH_COLLAPSE;
+        } else if ((len >= splitter_max_edge_length ||
+                    tri_angle(va, vc, vb) >= max_triangle_angle ||
+                    tri_angle(va, vd, vb) >= max_triangle_angle) &&
+                   split_is_valid(va,
+                                  vb,
+                                  vc,
+                                  vd,
+                                  min_triangle_area,
+                                  min_triangle_angle,
+                                  max_triangle_angle)) {
+            op = REMESH_SPLIT;
+        } else if (vertex_rank(ah) <= 1 && vertex_rank(bh) <= 1 &&
+                   flip_is_valid(va,
+                                 vb,
+                                 vc,
+                                 vd,
+                                 edge_flip_min_length_change,
+                                 max_volume_change,
+                                 min_triangle_area,
+                                 min_triangle_angle,
+                                 max_triangle_angle)) {
+            // the new edge c-d should not exist already (checked below)
+            const uint16_t v_c(iter.local(3)), v_d(iter.local(1));
+            if (ch.patch_id() == pid &&
+                ::atomicCAS(v_info + 2 * v_c, INVALID16, v_d) == INVALID16) {
+                v_info[2 * v_c + 1] = eh.local_id();
+                op                  = REMESH_FLIP;
+            } else if (dh.patch_id() == pid &&
+                       ::atomicCAS(v_info + 2 * v_d, INVALID16, v_c) ==
+                           INVALID16) {
+                v_info[2 * v_d + 1] = eh.local_id();
+                op                  = REMESH_FLIP;
+            }
+        }
+
+        if (op != REMESH_NONE) {
+            s_op[eh.local_id()]               = op;
+            s_opposite[2 * eh.local_id()]     = iter.local(1);
+            s_opposite[2 * eh.local_id() + 1] = iter.local(3);
+            edge_mask.set(eh.local_id(), true);
+        }
+    };
+
+    // 1. pick the operation of every edge
+    for_each_edge(cavity.patch_info(), [&](EdgeHandle eh) {
+        assert(eh.local_id() < cavity.patch_info().num_edges[0]);
+
+        if (edge_status(eh) == UNSEEN) {
+            const VertexIterator iter =
+                query.template get_iterator<VertexIterator>(eh.local_id());
+
+            pick_op(eh, iter);
+        }
+    });
+    block.sync();
+
+    // 2. check link condition
+    link_condition(block,
+                   cavity.patch_info(),
+                   query,
+                   shrd_alloc,
+                   edge_mask,
+                   0,
+                   2,
+                   true);
+    block.sync();
+
+    // 3. the two vertices opposite to a flipped edge should not be connected
+    for_each_edge(
+        cavity.patch_info(),
+        [&](EdgeHandle eh) {
+            const VertexIterator iter =
+                query.template get_iterator<VertexIterator>(eh.local_id());
+            const uint16_t v0 = iter.local(0);
+            const uint16_t v1 = iter.local(2);
+            if (v_info[2 * v0] == v1) {
+                edge_mask.reset(v_info[2 * v0 + 1], true);
+            }
+            if (v_info[2 * v1] == v0) {
+                edge_mask.reset(v_info[2 * v1 + 1], true);
+            }
+        },
+        true);
+    block.sync();
+
+    // 4. create cavity for the surviving edges
+    for_each_edge(cavity.patch_info(), [&](EdgeHandle eh) {
+        if (edge_mask(eh.local_id())) {
+            cavity.create(eh);
+        } else {
+            edge_status(eh) = SKIP;
+        }
+    });
+    block.sync();
+
+    shrd_alloc.dealloc(shrd_alloc.get_allocated_size_bytes() - shmem_before);
+
+    // create the cavity
+    if (cavity.prologue(block,
+                        shrd_alloc,
+                        position,
+                        vertex_rank,
+                        edge_status,
+                        is_vertex_bd)) {
+
+        edge_mask.reset(block);
+        block.sync();
+
+        // add the faces (center, l_i, l_i+1) for n cavity edges starting from
+        // the begin-th one where l_i is the i-th cavity vertex. first is the
+        // edge center->l_begin. If last is valid, it is used as the last edge
+        // l_end->center. Returns the edge center->l_end (invalid if we run out
+        // of space)
+        auto add_fan = [&](uint16_t           c,
+                           uint16_t           size,
+                           const VertexHandle center,
+                           uint16_t           begin,
+                           uint16_t           n,
+                           DEdgeHandle        first,
+                           const DEdgeHandle  last) {
+            DEdgeHandle e0 = first;
+            for (uint16_t k = 0; k < n; ++k) {
+                const uint16_t i = (begin + k) % size;
+
+                const DEdgeHandle e = cavity.get_cavity_edge(c, i);
+
+                DEdgeHandle e1;
+                if (k == n - 1 && last.is_valid()) {
+                    e1 = last;
+                } else {
+                    const DEdgeHandle s = cavity.add_edge(
+                        center, cavity.get_cavity_vertex(c, (i + 1) % size));
+                    if (!s.is_valid()) {
+                        return DEdgeHandle();
+                    }
+                    edge_mask.set(s.local_id(), true);
+                    e1 = s.get_flip_dedge();
+                }
+
+                if (!cavity.add_face(e0, e, e1).is_valid()) {
+                    return DEdgeHandle();
+                }
+                e0 = e1.get_flip_dedge();
+            }
+            return e0;
+        };
+
+        // a new vertex that replaces old_v
+        auto copy_vertex = [&](const VertexHandle old_v) {
+            const VertexHandle new_v = cavity.add_vertex();
+            if (new_v.is_valid()) {
+                position(new_v, 0)  = position(old_v, 0);
+                position(new_v, 1)  = position(old_v, 1);
+                position(new_v, 2)  = position(old_v, 2);
+                vertex_rank(new_v)  = vertex_rank(old_v);
+                is_vertex_bd(new_v) = 0;
+            }
+            return new_v;
+        };
+
+        cavity.for_each_cavity(block, [&](uint16_t c, uint16_t size) {
+            const EdgeHandle src = cavity.template get_creator<EdgeHandle>(c);
+
+            const uint8_t op = s_op[src.local_id()];
+
+            VertexHandle v0, v1;
+            cavity.get_vertices(src, v0, v1);
+
+            const vec3<T> p0 = position.template to_glm<3>(v0);
+            const vec3<T> p1 = position.template to_glm<3>(v1);
+
+            if (op == REMESH_COLLAPSE) {
+                // decide on new vertex position
+                vec3<T> new_p;
+
+                const int8_t r0 = vertex_rank(v0);
+                const int8_t r1 = vertex_rank(v1);
+                if (r0 > r1) {
+                    new_p = p0;
+                } else if (r1 > r0) {
+                    new_p = p1;
+                } else {
+                    new_p = (p0 + p1) * T(0.5);
+                }
+
+                // check if the new triangles will be bad i.e., will have
+                // normal inversion, will have tiny area, will have bad angles
+                bool is_bad = false;
+
+                // only if the edge not so tiny
+                if (glm::distance2(p0, p1) >
+                    std::numeric_limits<T>::epsilon()) {
+                    for (uint16_t i = 0; i < size; ++i) {
+                        const VertexHandle vi = cavity.get_cavity_vertex(c, i);
+                        const VertexHandle vj =
+                            cavity.get_cavity_vertex(c, (i + 1) % size);
+
+                        const vec3<T> pi = position.template to_glm<3>(vi);
+                        const vec3<T> pj = position.template to_glm<3>(vj);
+
+                        // the new triangle will be pi-pj-new_p
+                        const vec3<T> n_new = tri_normal(pi, pj, new_p);
+                        const vec3<T> n_0   = tri_normal(pi, pj, p0);
+                        const vec3<T> n_1   = tri_normal(pi, pj, p1);
+
+                        T min_ang_new, max_ang_new;
+                        triangle_min_max_angle(
+                            pi, pj, new_p, min_ang_new, max_ang_new);
+
+                        if (tri_area(pi, pj, new_p) < min_triangle_area ||
+                            min_ang_new < min_triangle_angle ||
+                            max_ang_new > max_triangle_angle ||
+                            glm::dot(n_new, n_0) < 1e-5 ||
+                            glm::dot(n_new, n_1) < 1e-5) {
+                            is_bad = true;
+                            break;
+                        }
+                    }
+                }
+
+                if (is_bad) {
+                    // roll back and don't attempt this edge again
+                    cavity.recover(src);
+                    edge_status(src) = SKIP;
+                    return;
+                }
+
+                const VertexHandle new_v = cavity.add_vertex();
+                if (!new_v.is_valid()) {
+                    return;
+                }
+                position(new_v, 0) = new_p[0];
+                position(new_v, 1) = new_p[1];
+                position(new_v, 2) = new_p[2];
+
+                const DEdgeHandle e0 =
+                    cavity.add_edge(new_v, cavity.get_cavity_vertex(c, 0));
+                if (!e0.is_valid()) {
+                    return;
+                }
+                edge_mask.set(e0.local_id(), true);
+
+                add_fan(c, size, new_v, 0, size, e0, e0.get_flip_dedge());
+                return;
+            }
+
+            // split and flip: find the two opposite vertices in the cavity
+            // boundary. The one ring of v0 goes from d to c and the one ring
+            // of v1 goes from c to d (following the cavity edges)
+            const uint16_t d = s_opposite[2 * src.local_id()];
+            const uint16_t o = s_opposite[2 * src.local_id() + 1];
+
+            uint16_t id = INVALID16, ic = INVALID16;
+            for (uint16_t i = 0; i < size; ++i) {
+                const uint16_t v = cavity.get_cavity_vertex(c, i).local_id();
+                if (v == d) {
+                    id = i;
+                }
+                if (v == o) {
+                    ic = i;
+                }
+            }
+
+            if (id == INVALID16 || ic == INVALID16) {
+                cavity.recover(src);
+                edge_status(src) = SKIP;
+                return;
+            }
+
+            const VertexHandle dh = cavity.get_cavity_vertex(c, id);
+            const VertexHandle ch = cavity.get_cavity_vertex(c, ic);
+
+            // number of cavity edges in the one ring of v0 and v1
+            const uint16_t n0 = (ic + size - id) % size;
+            const uint16_t n1 = size - n0;
+
+            const VertexHandle a = copy_vertex(v0);
+            const VertexHandle b = copy_vertex(v1);
+            if (!a.is_valid() || !b.is_valid()) {
+                return;
+            }
+
+            const DEdgeHandle ad = cavity.add_edge(a, dh);
+            const DEdgeHandle bc = cavity.add_edge(b, ch);
+            if (!ad.is_valid() || !bc.is_valid()) {
+                return;
+            }
+            edge_mask.set(ad.local_id(), true);
+            edge_mask.set(bc.local_id(), true);
+
+            // the one rings of the (new) two end vertices
+            const DEdgeHandle ac =
+                add_fan(c, size, a, id, n0, ad, DEdgeHandle());
+            const DEdgeHandle bd =
+                add_fan(c, size, b, ic, n1, bc, DEdgeHandle());
+            if (!ac.is_valid() || !bd.is_valid()) {
+                return;
+            }
+
+            if (op == REMESH_SPLIT) {
+                const VertexHandle m = cavity.add_vertex();
+                if (!m.is_valid()) {
+                    return;
+                }
+                position(m, 0) = T(0.5) * (p0[0] + p1[0]);
+                position(m, 1) = T(0.5) * (p0[1] + p1[1]);
+                position(m, 2) = T(0.5) * (p0[2] + p1[2]);
+
+                const DEdgeHandle am = cavity.add_edge(a, m);
+                const DEdgeHandle mb = cavity.add_edge(m, b);
+                const DEdgeHandle mc = cavity.add_edge(m, ch);
+                const DEdgeHandle md = cavity.add_edge(m, dh);
+                if (!am.is_valid() || !mb.is_valid() || !mc.is_valid() ||
+                    !md.is_valid()) {
+                    return;
+                }
+                edge_mask.set(am.local_id(), true);
+                edge_mask.set(mb.local_id(), true);
+                edge_mask.set(mc.local_id(), true);
+                edge_mask.set(md.local_id(), true);
+
+                // (a, m, d), (m, b, d), (b, m, c), (m, a, c)
+                cavity.add_face(am, md, ad.get_flip_dedge());
+                cavity.add_face(mb, bd, md.get_flip_dedge());
+                cavity.add_face(mb.get_flip_dedge(), mc, bc.get_flip_dedge());
+                cavity.add_face(am.get_flip_dedge(), ac, mc.get_flip_dedge());
+            } else {
+                const DEdgeHandle cd = cavity.add_edge(ch, dh);
+                if (!cd.is_valid()) {
+                    return;
+                }
+                edge_mask.set(cd.local_id(), true);
+
+                // (a, c, d), (b, d, c)
+                cavity.add_face(ac, cd, ad.get_flip_dedge());
+                cavity.add_face(bd, cd.get_flip_dedge(), bc.get_flip_dedge());
+            }
+        });
+    }
+    block.sync();
+
+    cavity.epilogue(block);
+    block.sync();
+
+    if (cavity.is_successful()) {
+        for_each_edge(cavity.patch_info(), [&](EdgeHandle eh) {
+            if (edge_mask(eh.local_id()) || cavity.is_recovered(eh)) {
+                edge_status(eh) = ADDED;
+            }
+        });
+    }
+}
@@ -30,6 +30,8 @@ struct arg
     float       min_triangle_area           = 1e-7;
     float       min_triangle_angle          = deg2rad(0.f);
     float       max_triangle_angle          = deg2rad(180.f);
+    bool        fused                       = false;
+    bool        export_frames               = false;
     char**      argv;
     int         argc;
 } Arg;
@@ -89,8 +91,10 @@ int main(int argc, char** argv)
                         " -n:          Number of point along x(or y) direction. Default is {} \n"
                         " -d:          Simulation duration. Default is {} \n"
                         " -o:          JSON file output folder. Default is {} \n"
+                        " -fused:      Split, collapse, and flip edges in one fused pass instead of one pass for each. Default is {} \n"
+                        " -export:     Write every frame as OBJ to the output folder (asynchronously). Default is {} \n"
                         " -device_id:  GPU device ID. Default is {}",
-            Arg.obj_file_name, Arg.n, Arg.end_sim_t, Arg.output_folder, Arg.device_id);
+            Arg.obj_file_name, Arg.n, Arg.end_sim_t, Arg.output_folder, (Arg.fused ? "true" : "false"), (Arg.export_frames ? "true" : "false"), Arg.device_id);
             // clang-format on
             exit(EXIT_SUCCESS);
         }
@@ -114,11 +118,19 @@ int main(int argc, char** argv)
         if (cmd_option_exists(argv, argc + argv, "-d")) {
             Arg.end_sim_t = atof(get_cmd_option(argv, argv + argc, "-d"));
         }
+        if (cmd_option_exists(argv, argc + argv, "-fused")) {
+            Arg.fused = true;
+        }
+        if (cmd_option_exists(argv, argc + argv, "-export")) {
+            Arg.export_frames = true;
+        }
     }
 
     RXMESH_TRACE("output_folder= {}", Arg.output_folder);
     RXMESH_TRACE("device_id= {}", Arg.device_id);
     RXMESH_TRACE("n= {}", Arg.n);
+    RXMESH_TRACE("fused= {}", Arg.fused);
+    RXMESH_TRACE("export_frames= {}", Arg.export_frames);
 
     return RUN_ALL_TESTS();
 }
\ No newline at end of file
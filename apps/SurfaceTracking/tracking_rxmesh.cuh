@@ -4,6 +4,7 @@
 
 #include "util.cuh"
 
+#include "frame_pipeline.h"
 #include "frame_stepper.h"
 #include "rxmesh/rxmesh_dynamic.h"
 #include "simulation.h"
@@ -13,6 +14,7 @@
 #include "collapser.cuh"
 #include "flipper.cuh"
 #include "noise.h"
+#include "remesher.cuh"
 #include "smoother.cuh"
 #include "splitter.cuh"
 #include "tracking_kernels.cuh"
@@ -258,8 +260,8 @@ void flipper(rxmesh::RXMeshDynamic&             rx,
                          [&](uint32_t v, uint32_t e, uint32_t f) {
                              return 2 * detail::mask_num_bytes(e) +
                                     2 * v * sizeof(uint16_t) +
-                                    2 * detail::mask_num_bytes(v) +
-                                    4 * ShmemAllocator::default_alignment;
+                                    2 * ShmemAllocator::default_alignment +
+                                    link_condition_shmem_bytes(v, e);
                          });
 
     edge_status->reset(UNSEEN, DEVICE);
@@ -340,8 +342,8 @@ void collapser(rxmesh::RXMeshDynamic&             rx,
                          false,
                          [&](uint32_t v, uint32_t e, uint32_t f) {
                              return detail::mask_num_bytes(e) +
-                                    2 * detail::mask_num_bytes(v) +
-                                    3 * ShmemAllocator::default_alignment;
+                                    ShmemAllocator::default_alignment +
+                                    link_condition_shmem_bytes(v, e);
                          });
 
 
@@ -398,6 +400,91 @@ void collapser(rxmesh::RXMeshDynamic&             rx,
 }
 
 
+template <typename T>
+void remesher(rxmesh::RXMeshDynamic&             rx,
+              rxmesh::VertexAttribute<T>*        position,
+              rxmesh::VertexAttribute<int8_t>*   vertex_rank,
+              rxmesh::EdgeAttribute<EdgeStatus>* edge_status,
+              rxmesh::VertexAttribute<int8_t>*   is_vertex_bd)
+{
+    using namespace rxmesh;
+
+    timers.start("RemeshTotal");
+
+    classify_vertices(rx, position, is_vertex_bd, vertex_rank);
+
+    constexpr uint32_t blockThreads = 256;
+
+    LaunchBox<blockThreads> launch_box;
+
+    rx.update_launch_box({Op::EVDiamond},
+                         launch_box,
+                         (void*)remesh_edges<T, blockThreads>,
+                         true,
+                         false,
+                         false,
+                         false,
+                         [&](uint32_t v, uint32_t e, uint32_t f) {
+                             return detail::mask_num_bytes(e) +
+                                    e * sizeof(uint8_t) +
+                                    2 * e * sizeof(uint16_t) +
+                                    2 * v * sizeof(uint16_t) +
+                                    4 * ShmemAllocator::default_alignment +
+                                    link_condition_shmem_bytes(v, e);
+                         });
+
+    edge_status->reset(UNSEEN, DEVICE);
+
+    int prv_remaining_work = rx.get_num_edges();
+
+    while (true) {
+        rx.reset_scheduler();
+        while (!rx.is_queue_empty()) {
+
+            timers.start("Remesh");
+            remesh_edges<T, blockThreads>
+                <<<launch_box.blocks,
+                   launch_box.num_threads,
+                   launch_box.smem_bytes_dyn>>>(rx.get_context(),
+                                                *position,
+                                                *vertex_rank,
+                                                *edge_status,
+                                                *is_vertex_bd,
+                                                Arg.splitter_max_edge_length,
+                                                Arg.collapser_min_edge_length,
+                                                Arg.edge_flip_min_length_change,
+                                                Arg.max_volume_change,
+                                                Arg.min_triangle_area,
+                                                Arg.min_triangle_angle,
+                                                Arg.max_triangle_angle);
+            timers.stop("Remesh");
+
+            timers.start("RemeshCleanup");
+            rx.cleanup();
+            timers.stop("RemeshCleanup");
+
+            timers.start("RemeshSlice");
+            rx.slice_patches(
+                *position, *vertex_rank, *edge_status, *is_vertex_bd);
+            timers.stop("RemeshSlice");
+
+            timers.start("RemeshCleanup");
+            rx.cleanup();
+            timers.stop("RemeshCleanup");
+        }
+
+        int remaining_work = is_done(rx, edge_status, d_buffer);
+
+        if (remaining_work == 0 || prv_remaining_work == remaining_work) {
+            break;
+        }
+        prv_remaining_work = remaining_work;
+    }
+
+    timers.stop("RemeshTotal");
+}
+
+
 template <typename T>
 void smoother(rxmesh::RXMeshDynamic&                 rx,
               const rxmesh::VertexAttribute<int8_t>* is_vertex_bd,
@@ -435,6 +522,14 @@ void improve_mesh(rxmesh::RXMeshDynamic&             rx,
                   rxmesh::EdgeAttribute<EdgeStatus>* edge_status,
                   rxmesh::VertexAttribute<int8_t>*   is_vertex_bd)
 {
+    if (Arg.fused) {
+        // split, collapse, and flip in one pass
+        remesher(rx, current_position, vertex_rank, edge_status, is_vertex_bd);
+
+        smoother(rx, is_vertex_bd, current_position, new_position);
+        return;
+    }
+
     // edge splitting
     // RXMESH_INFO("Splitter");
     splitter(rx, current_position, edge_status, is_vertex_bd);
@@ -572,7 +667,8 @@ void run_simulation(Simulation<T>&                     sim,
                     rxmesh::VertexAttribute<T>*        new_position,
                     rxmesh::VertexAttribute<int8_t>*   vertex_rank,
                     rxmesh::EdgeAttribute<EdgeStatus>* edge_status,
-                    rxmesh::VertexAttribute<int8_t>*   is_vertex_bd)
+                    rxmesh::VertexAttribute<int8_t>*   is_vertex_bd,
+                    FramePipeline<T>*                  pipeline = nullptr)
 {
     sim.m_running = true;
     while (sim.m_running) {
@@ -585,6 +681,11 @@ void run_simulation(Simulation<T>&                     sim,
                       vertex_rank,
                       edge_status,
                       is_vertex_bd);
+
+        // the output of this frame overlaps with advancing the next one
+        if (pipeline) {
+            pipeline->submit(frame_stepper.get_frame(), *current_position);
+        }
     }
     sim.m_running = false;
 }
@@ -613,6 +714,8 @@ inline void tracking_rxmesh(rxmesh::RXMeshDynamic& rx)
     report.add_member("min_triangle_area", Arg.min_triangle_area);
     report.add_member("min_triangle_angle", Arg.min_triangle_angle);
     report.add_member("max_triangle_angle", Arg.max_triangle_angle);
+    report.add_member("fused", Arg.fused);
+    report.add_member("export_frames", Arg.export_frames);
 
     auto current_position = rx.get_input_vertex_coordinates();
 
@@ -683,6 +786,11 @@ inline void tracking_rxmesh(rxmesh::RXMeshDynamic& rx)
     timers.add("FlipCleanup");
     timers.add("FlipSlice");
 
+    timers.add("RemeshTotal");
+    timers.add("Remesh");
+    timers.add("RemeshCleanup");
+    timers.add("RemeshSlice");
+
     timers.add("SmoothTotal");
 
     timers.add("MeshImprove");
@@ -693,6 +801,14 @@ inline void tracking_rxmesh(rxmesh::RXMeshDynamic& rx)
 
     CUDA_ERROR(cudaProfilerStart());
 
+    std::unique_ptr<FramePipeline<float>> pipeline;
+    if (Arg.export_frames) {
+        pipeline = std::make_unique<FramePipeline<float>>(
+            rx,
+            FramePipeline<float>::obj_writer(Arg.output_folder +
+                                             "tracking_frame_"));
+    }
+
     timers.start("Total");
 
     run_simulation(sim,
@@ -703,7 +819,12 @@ inline void tracking_rxmesh(rxmesh::RXMeshDynamic& rx)
                    new_position.get(),
                    vertex_rank.get(),
                    edge_status.get(),
-                   is_vertex_bd.get());
+                   is_vertex_bd.get(),
+                   pipeline.get());
+
+    if (pipeline) {
+        pipeline->flush();
+    }
 
     timers.stop("Total");
 
@@ -748,6 +869,14 @@ inline void tracking_rxmesh(rxmesh::RXMeshDynamic& rx)
         timers.elapsed_millis("FlipCleanup"),
         timers.elapsed_millis("FlipSlice"));
 
+    RXMESH_INFO(
+        "tracking_rxmesh() RemeshTotal {} (ms), Remesh {} (ms), "
+        "RemeshCleanup {} (ms), RemeshSlice {} (ms)",
+        timers.elapsed_millis("RemeshTotal"),
+        timers.elapsed_millis("Remesh"),
+        timers.elapsed_millis("RemeshCleanup"),
+        timers.elapsed_millis("RemeshSlice"));
+
     RXMESH_INFO("tracking_rxmesh() SmoothTotal {} (ms)",
                 timers.elapsed_millis("SmoothTotal"));
 
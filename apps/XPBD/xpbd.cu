@@ -1,6 +1,8 @@
 // Reference
 // https://github.com/taichi-dev/meshtaichi/blob/main/xpbd_cloth/solver.py
 
+#include "rxmesh/algo/stencil_coloring.h"
+#include "rxmesh/cuda_graph.h"
 #include "rxmesh/query.cuh"
 #include "rxmesh/rxmesh_static.h"
 
@@ -184,133 +186,231 @@ void __global__ solve_bending(const Context                context,
     query.dispatch<Op::EVDiamond>(block, shrd_alloc, solve);
 }
 
-template <uint32_t blockThreads, bool XPBD>
-void __global__ solve_stretch_and_bending(const Context                context,
-                                          VertexAttribute<float>       dp,
-                                          EdgeAttribute<float>         la_s,
-                                          EdgeAttribute<float>         la_b,
-                                          const VertexAttribute<float> invM,
-                                          const VertexAttribute<float> new_x,
-                                          const EdgeAttribute<float>   rest_len,
-                                          const float stretch_compliance,
-                                          const float stretch_relaxation,
-                                          const float bending_compliance,
-                                          const float bending_relaxation,
-                                          const float dt2_inv)
+/**
+ * @brief the stretch and bending constraints of one edge where EVDiamond iter
+ * gives the edge two vertices (iter[0] and iter[2]) and the two opposite
+ * vertices (iter[1] and iter[3]). The position correction of iter[i] is
+ * written to corr[i]
+ */
+template <bool XPBD>
+__device__ __inline__ void stretch_and_bending(
+    const EdgeHandle&             eh,
+    const VertexIterator&         iter,
+    EdgeAttribute<float>&         la_s,
+    EdgeAttribute<float>&         la_b,
+    const VertexAttribute<float>& invM,
+    const VertexAttribute<float>& new_x,
+    const EdgeAttribute<float>&   rest_len,
+    const float                   stretch_compliance,
+    const float                   stretch_relaxation,
+    const float                   bending_compliance,
+    const float                   bending_relaxation,
+    const float                   dt2_inv,
+    glm::fvec3                    corr[4])
 {
-    auto solve = [&](const EdgeHandle& eh, const VertexIterator& iter) {
-        // iter[0] and iter[2] are the edge two vertices
-        // iter[1] and iter[3] are the two opposite vertices
+    auto v1 = iter[0];
+    auto v2 = iter[2];
 
-        auto v1 = iter[0];
-        auto v2 = iter[2];
+    auto v3 = iter[1];
+    auto v4 = iter[3];
 
-        auto v3 = iter[1];
-        auto v4 = iter[3];
-
-        float v1_st[3] = {0, 0, 0};
-        float v2_st[3] = {0, 0, 0};
-
-        const float w1(invM(v1, 0)), w2(invM(v2, 0));
+    for (int i = 0; i < 4; ++i) {
+        corr[i] = glm::fvec3(0.f, 0.f, 0.f);
+    }
 
-        const glm::fvec3 x1 = new_x.to_glm<3>(v1);
-        const glm::fvec3 x2 = new_x.to_glm<3>(v2);
+    const float w1(invM(v1, 0)), w2(invM(v2, 0));
 
-        // stretch term (for v1 and v2)
-        if (w1 + w2 > 0.f) {
-            glm::fvec3  n = x1 - x2;
-            const float d = glm::length(n);
-            glm::fvec3  dpp(0.f, 0.f, 0.f);
-            const float constraint = (d - rest_len(eh, 0));
+    const glm::fvec3 x1 = new_x.to_glm<3>(v1);
+    const glm::fvec3 x2 = new_x.to_glm<3>(v2);
 
-            n = glm::normalize(n);
-            if constexpr (XPBD) {
-                const float compliance = stretch_compliance * dt2_inv;
+    // stretch term (for v1 and v2)
+    if (w1 + w2 > 0.f) {
+        glm::fvec3  n = x1 - x2;
+        const float d = glm::length(n);
+        glm::fvec3  dpp(0.f, 0.f, 0.f);
+        const float constraint = (d - rest_len(eh, 0));
 
-                const float d_lambda =
-                    -(constraint + compliance * la_s(eh, 0)) /
-                    (w1 + w2 + compliance) * stretch_relaxation;
+        n = glm::normalize(n);
+        if constexpr (XPBD) {
+            const float compliance = stretch_compliance * dt2_inv;
 
-                for (int i = 0; i < 3; ++i) {
-                    dpp[i] = d_lambda * n[i];
-                }
-                la_s(eh, 0) += d_lambda;
+            const float d_lambda = -(constraint + compliance * la_s(eh, 0)) /
+                                   (w1 + w2 + compliance) * stretch_relaxation;
 
-            } else {
-                for (int i = 0; i < 3; ++i) {
-                    dpp[i] =
-                        -constraint / (w1 + w2) * n[i] * stretch_relaxation;
-                }
+            for (int i = 0; i < 3; ++i) {
+                dpp[i] = d_lambda * n[i];
             }
+            la_s(eh, 0) += d_lambda;
 
+        } else {
             for (int i = 0; i < 3; ++i) {
-                v1_st[i] = dpp[i] * w1;
-                v2_st[i] = -(dpp[i] * w2);
+                dpp[i] = -constraint / (w1 + w2) * n[i] * stretch_relaxation;
             }
         }
 
-        // bending term (for v1, v2, v3, and v4)
-        if (v3.is_valid() && v4.is_valid()) {
-            const float w3(invM(v3, 0)), w4(invM(v4, 0));
+        corr[0] = dpp * w1;
+        corr[2] = -(dpp * w2);
+    }
 
-            const glm::fvec3 x3 = new_x.to_glm<3>(v3);
-            const glm::fvec3 x4 = new_x.to_glm<3>(v4);
+    // bending term (for v1, v2, v3, and v4)
+    if (v3.is_valid() && v4.is_valid()) {
+        const float w3(invM(v3, 0)), w4(invM(v4, 0));
 
+        const glm::fvec3 x3 = new_x.to_glm<3>(v3);
+        const glm::fvec3 x4 = new_x.to_glm<3>(v4);
 
-            if (w1 + w2 + w3 + w4 > 0.f) {
 
-                glm::fvec3 p2 = x2 - x1;
-                glm::fvec3 p3 = x3 - x1;
-                glm::fvec3 p4 = x4 - x1;
+        if (w1 + w2 + w3 + w4 > 0.f) {
 
-                float l23 = glm::length(glm::cross(p2, p3));
-                float l24 = glm::length(glm::cross(p2, p4));
-                if (l23 < 1e-8) {
-                    l23 = 1.f;
-                }
-                if (l24 < 1e-8) {
-                    l24 = 1.f;
-                }
-                glm::fvec3 n1 = glm::cross(p2, p3);
-                n1 /= l23;
-                glm::fvec3 n2 = glm::cross(p2, p4);
-                n2 /= l24;
+            glm::fvec3 p2 = x2 - x1;
+            glm::fvec3 p3 = x3 - x1;
+            glm::fvec3 p4 = x4 - x1;
 
-                // clamp(dot(n1, n2), -1., 1.)
-                float d = std::max(1.f, std::min(dot(n1, n2), -1.f));
+            float l23 = glm::length(glm::cross(p2, p3));
+            float l24 = glm::length(glm::cross(p2, p4));
+            if (l23 < 1e-8) {
+                l23 = 1.f;
+            }
+            if (l24 < 1e-8) {
+                l24 = 1.f;
+            }
+            glm::fvec3 n1 = glm::cross(p2, p3);
+            n1 /= l23;
+            glm::fvec3 n2 = glm::cross(p2, p4);
+            n2 /= l24;
 
-                glm::fvec3 q3 = (cross(p2, n2) + cross(n1, p2) * d) / l23;
-                glm::fvec3 q4 = (cross(p2, n1) + cross(n2, p2) * d) / l24;
-                glm::fvec3 q2 = -(cross(p3, n2) + cross(n1, p3) * d) / l23 -
-                                (cross(p4, n1) + cross(n2, p4) * d) / l24;
-                glm::fvec3 q1 = -q2 - q3 - q4;
+            // clamp(dot(n1, n2), -1., 1.)
+            float d = std::max(1.f, std::min(dot(n1, n2), -1.f));
 
-                float sum_wq = w1 * glm::length2(q1) + w2 * glm::length2(q2) +
-                               w3 * glm::length2(q3) + w4 * glm::length2(q4);
-                float constraint = acos(d) - acos(-1.);
+            glm::fvec3 q3 = (cross(p2, n2) + cross(n1, p2) * d) / l23;
+            glm::fvec3 q4 = (cross(p2, n1) + cross(n2, p2) * d) / l24;
+            glm::fvec3 q2 = -(cross(p3, n2) + cross(n1, p3) * d) / l23 -
+                            (cross(p4, n1) + cross(n2, p4) * d) / l24;
+            glm::fvec3 q1 = -q2 - q3 - q4;
 
-                if constexpr (XPBD) {
-                    float compliance = bending_compliance * dt2_inv;
-                    float d_lambda = -(constraint + compliance * la_b(eh, 0)) /
-                                     (sum_wq + compliance) * bending_relaxation;
+            float sum_wq = w1 * glm::length2(q1) + w2 * glm::length2(q2) +
+                           w3 * glm::length2(q3) + w4 * glm::length2(q4);
+            float constraint = acos(d) - acos(-1.);
 
-                    constraint = sqrt(1 - d * d) * d_lambda;
-                    la_b(eh, 0) += d_lambda;
-                } else {
-                    constraint = -sqrt(1 - d * d) * constraint /
-                                 (sum_wq + 1e-7) * bending_relaxation;
-                }
+            if constexpr (XPBD) {
+                float compliance = bending_compliance * dt2_inv;
+                float d_lambda   = -(constraint + compliance * la_b(eh, 0)) /
+                                 (sum_wq + compliance) * bending_relaxation;
+
+                constraint = sqrt(1 - d * d) * d_lambda;
+                la_b(eh, 0) += d_lambda;
+            } else {
+                constraint = -sqrt(1 - d * d) * constraint /
+                             (sum_wq + 1e-7) * bending_relaxation;
+            }
+
+            corr[0] += w1 * constraint * q1;
+            corr[2] += w2 * constraint * q2;
+            corr[1] = w3 * constraint * q3;
+            corr[3] = w4 * constraint * q4;
+        }
+    }
+}
+
+/**
+ * @brief Jacobi-style solve where all edges are processed at once and the
+ * corrections are accumulated in dp (with atomics) and applied after
+ */
+template <uint32_t blockThreads, bool XPBD>
+void __global__ solve_stretch_and_bending(const Context                context,
+                                          VertexAttribute<float>       dp,
+                                          EdgeAttribute<float>         la_s,
+                                          EdgeAttribute<float>         la_b,
+                                          const VertexAttribute<float> invM,
+                                          const VertexAttribute<float> new_x,
+                                          const EdgeAttribute<float>   rest_len,
+                                          const float stretch_compliance,
+                                          const float stretch_relaxation,
+                                          const float bending_compliance,
+                                          const float bending_relaxation,
+                                          const float dt2_inv)
+{
+    auto solve = [&](const EdgeHandle& eh, const VertexIterator& iter) {
+        glm::fvec3 corr[4];
+
+        stretch_and_bending<XPBD>(eh,
+                                  iter,
+                                  la_s,
+                                  la_b,
+                                  invM,
+                                  new_x,
+                                  rest_len,
+                                  stretch_compliance,
+                                  stretch_relaxation,
+                                  bending_compliance,
+                                  bending_relaxation,
+                                  dt2_inv,
+                                  corr);
+
+        for (int v = 0; v < 4; ++v) {
+            if (iter[v].is_valid()) {
                 for (int i = 0; i < 3; ++i) {
-                    ::atomicAdd(&dp(v1, i), w1 * constraint * q1[i] + v1_st[i]);
-                    ::atomicAdd(&dp(v2, i), w2 * constraint * q2[i] + v2_st[i]);
-                    ::atomicAdd(&dp(v3, i), w3 * constraint * q3[i]);
-                    ::atomicAdd(&dp(v4, i), w4 * constraint * q4[i]);
+                    ::atomicAdd(&dp(iter[v], i), corr[v][i]);
                 }
             }
-        } else {
-            for (int i = 0; i < 3; ++i) {
-                ::atomicAdd(&dp(v1, i), v1_st[i]);
-                ::atomicAdd(&dp(v2, i), v2_st[i]);
+        }
+    };
+
+    auto block = cooperative_groups::this_thread_block();
+
+    Query<blockThreads> query(context);
+    ShmemAllocator      shrd_alloc;
+    query.dispatch<Op::EVDiamond>(block, shrd_alloc, solve);
+}
+
+/**
+ * @brief Gauss-Seidel solve of the edges of one color (see
+ * stencil_coloring()). Edges of the same color do not share a vertex in their
+ * diamonds so the corrections are applied to new_x directly without atomics
+ * and the result does not depend on the scheduling of the threads
+ */
+template <uint32_t blockThreads, bool XPBD>
+void __global__
+solve_stretch_and_bending_colored(const Context                  context,
+                                  const EdgeAttribute<uint32_t>  e_color,
+                                  const uint32_t                 color,
+                                  EdgeAttribute<float>           la_s,
+                                  EdgeAttribute<float>           la_b,
+                                  const VertexAttribute<float>   invM,
+                                  VertexAttribute<float>         new_x,
+                                  const EdgeAttribute<float>     rest_len,
+                                  const float stretch_compliance,
+                                  const float stretch_relaxation,
+                                  const float bending_compliance,
+                                  const float bending_relaxation,
+                                  const float dt2_inv)
+{
+    auto solve = [&](const EdgeHandle& eh, const VertexIterator& iter) {
+        if (e_color(eh) != color) {
+            return;
+        }
+
+        glm::fvec3 corr[4];
+
+        stretch_and_bending<XPBD>(eh,
+                                  iter,
+                                  la_s,
+                                  la_b,
+                                  invM,
+                                  new_x,
+                                  rest_len,
+                                  stretch_compliance,
+                                  stretch_relaxation,
+                                  bending_compliance,
+                                  bending_relaxation,
+                                  dt2_inv,
+                                  corr);
+
+        for (int v = 0; v < 4; ++v) {
+            if (iter[v].is_valid()) {
+                for (int i = 0; i < 3; ++i) {
+                    new_x(iter[v], i) += corr[v][i];
+                }
             }
         }
     };
@@ -362,6 +462,9 @@ int main(int argc, char** argv)
     const float      bending_compliance = 1e-6;
     const float      mass               = 1.0;
     constexpr bool   XPBD               = true;
+    // Gauss-Seidel over the edge colors (deterministic) vs. Jacobi with
+    // atomics
+    constexpr bool Colored = true;
 
     // fixtures paramters
     const glm::fvec4 fixure_spheres[4] = {{0.f, 1.f, 0.f, 0.004},
@@ -402,19 +505,25 @@ int main(int argc, char** argv)
 
 
     LaunchBox<blockThreads> solve_lb;
+    LaunchBox<blockThreads> solve_colored_lb;
 
-    LaunchBox<blockThreads> solve_stretch_lb;
-    LaunchBox<blockThreads> solve_bending_lb;
+    rx.prepare_launch_box({Op::EVDiamond},
+                          solve_lb,
+                          (void*)solve_stretch_and_bending<blockThreads, XPBD>);
 
     rx.prepare_launch_box(
-        {Op::EV}, solve_stretch_lb, (void*)solve_stretch<blockThreads>);
+        {Op::EVDiamond},
+        solve_colored_lb,
+        (void*)solve_stretch_and_bending_colored<blockThreads, XPBD>);
 
-    rx.prepare_launch_box(
-        {Op::EVDiamond}, solve_bending_lb, (void*)solve_bending<blockThreads>);
+    // color the constraints (edges) such that edges of the same color do not
+    // share a vertex in their diamond stencil
+    auto e_color = rx.add_edge_attribute<uint32_t>("eColor", 1);
 
-    rx.prepare_launch_box({Op::EVDiamond},
-                          solve_lb,
-                          (void*)solve_stretch_and_bending<blockThreads, XPBD>);
+    const uint32_t num_colors =
+        stencil_coloring<Op::EVDiamond, blockThreads>(rx, *e_color);
+
+    RXMESH_INFO("XPBD: #constraint colors = {}", num_colors);
 
     // init edges
     rx.run_kernel<blockThreads>(
@@ -428,6 +537,122 @@ int main(int argc, char** argv)
     float mean2(0.f);
 
 
+    // every frame is num_substeps (equal) substeps where one substep is
+    // captured once into a CUDA graph and replayed since its launches do not
+    // change between substeps
+    const uint32_t num_substeps = uint32_t(std::ceil(frame_dt / dt));
+    const float    dt0          = frame_dt / float(num_substeps);
+
+    auto substep = [&](cudaStream_t st) {
+        // applyExtForce
+        rx.for_each_vertex(
+            DEVICE,
+            [dt0,
+             gravity,
+             invM  = *invM,
+             v     = *v,
+             new_x = *new_x,
+             x     = *x] __device__(VertexHandle vh) {
+                if (invM(vh, 0) > 0.0) {
+                    v(vh, 0) += gravity[0] * dt0;
+                    v(vh, 1) += gravity[1] * dt0;
+                    v(vh, 2) += gravity[2] * dt0;
+                }
+                new_x(vh, 0) = x(vh, 0) + v(vh, 0) * dt0;
+                new_x(vh, 1) = x(vh, 1) + v(vh, 1) * dt0;
+                new_x(vh, 2) = x(vh, 2) + v(vh, 2) * dt0;
+            },
+            st);
+
+        if (XPBD) {
+            la_s->reset(0.0, DEVICE, st);
+            la_b->reset(0.0, DEVICE, st);
+        }
+
+        for (uint32_t iter = 0; iter < rest_iter; ++iter) {
+            if constexpr (Colored) {
+                // solve stretch and bending one color at a time
+                for (uint32_t c = 0; c < num_colors; ++c) {
+                    rx.run_kernel(
+                        solve_colored_lb,
+                        solve_stretch_and_bending_colored<blockThreads, XPBD>,
+                        st,
+                        *e_color,
+                        c,
+                        *la_s,
+                        *la_b,
+                        *invM,
+                        *new_x,
+                        *rest_len,
+                        stretch_compliance,
+                        stretch_relaxation,
+                        bending_compliance,
+                        bending_relaxation,
+                        1.0f / (dt0 * dt0));
+                }
+            } else {
+                // preSolve
+                dp->reset(0, DEVICE, st);
+
+                // solve Stretch and bending
+                rx.run_kernel(solve_lb,
+                              solve_stretch_and_bending<blockThreads, XPBD>,
+                              st,
+                              *dp,
+                              *la_s,
+                              *la_b,
+                              *invM,
+                              *new_x,
+                              *rest_len,
+                              stretch_compliance,
+                              stretch_relaxation,
+                              bending_compliance,
+                              bending_relaxation,
+                              1.0f / (dt0 * dt0));
+
+                // postSolve
+                rx.for_each_vertex(
+                    DEVICE,
+                    [dp = *dp, new_x = *new_x] __device__(VertexHandle vh) {
+                        new_x(vh, 0) += dp(vh, 0);
+                        new_x(vh, 1) += dp(vh, 1);
+                        new_x(vh, 2) += dp(vh, 2);
+                    },
+                    st);
+            }
+        }
+
+        // update;
+        rx.for_each_vertex(
+            DEVICE,
+            [dt0,
+             invM  = *invM,
+             v     = *v,
+             new_x = *new_x,
+             x     = *x] __device__(VertexHandle vh) {
+                if (invM(vh, 0) <= 0.0) {
+                    new_x(vh, 0) = x(vh, 0);
+                    new_x(vh, 1) = x(vh, 1);
+                    new_x(vh, 2) = x(vh, 2);
+                } else {
+                    v(vh, 0) = (new_x(vh, 0) - x(vh, 0)) / dt0;
+                    v(vh, 1) = (new_x(vh, 1) - x(vh, 1)) / dt0;
+                    v(vh, 2) = (new_x(vh, 2) - x(vh, 2)) / dt0;
+
+                    x(vh, 0) = new_x(vh, 0);
+                    x(vh, 1) = new_x(vh, 1);
+                    x(vh, 2) = new_x(vh, 2);
+                }
+            },
+            st);
+    };
+
+    cudaStream_t stream;
+    CUDA_ERROR(cudaStreamCreate(&stream));
+
+    CUDAGraph substep_graph;
+    substep_graph.capture(stream, substep);
+
     // solve
     bool started = false;
 
@@ -440,114 +665,10 @@ int main(int argc, char** argv)
         if (ImGui::Button("Start Simulation") || started) {
             started = true;
 
-            GPUTimer timer;
+            GPUTimer timer(stream);
             timer.start();
-            float frame_time_left = frame_dt;
-            while (frame_time_left > 0.0) {
-                float dt0 = std::min(dt, frame_time_left);
-                frame_time_left -= dt0;
-
-                // applyExtForce
-                rx.for_each_vertex(DEVICE,
-                                   [dt0,
-                                    gravity,
-                                    invM  = *invM,
-                                    v     = *v,
-                                    new_x = *new_x,
-                                    x     = *x] __device__(VertexHandle vh) {
-                                       if (invM(vh, 0) > 0.0) {
-                                           v(vh, 0) += gravity[0] * dt0;
-                                           v(vh, 1) += gravity[1] * dt0;
-                                           v(vh, 2) += gravity[2] * dt0;
-                                       }
-                                       new_x(vh, 0) = x(vh, 0) + v(vh, 0) * dt0;
-                                       new_x(vh, 1) = x(vh, 1) + v(vh, 1) * dt0;
-                                       new_x(vh, 2) = x(vh, 2) + v(vh, 2) * dt0;
-                                   });
-
-                if (XPBD) {
-                    la_s->reset(0.0, DEVICE);
-                    la_b->reset(0.0, DEVICE);
-                }
-
-                for (uint32_t iter = 0; iter < rest_iter; ++iter) {
-                    // preSolve
-                    dp->reset(0, DEVICE);
-
-                    // solveStretch
-                    // rx.run_kernel(solve_stretch_lb,
-                    //              solve_stretch<blockThreads>,
-                    //              *dp,
-                    //              *la_s,
-                    //              *invM,
-                    //              *new_x,
-                    //              *rest_len,
-                    //              XPBD,
-                    //              stretch_compliance,
-                    //              stretch_relaxation,
-                    //              dt0 * dt0);
-                    //
-                    //
-                    ////  solveBending
-                    // rx.run_kernel(solve_bending_lb,
-                    //               solve_bending<blockThreads>,
-                    //               *dp,
-                    //               *la_b,
-                    //               *invM,
-                    //               *new_x,
-                    //               XPBD,
-                    //               bending_compliance,
-                    //               bending_relaxation,
-                    //               dt0 * dt0);
-
-                    // solve Stretch and bending
-                    rx.run_kernel(solve_lb,
-                                  solve_stretch_and_bending<blockThreads, XPBD>,
-                                  *dp,
-                                  *la_b,
-                                  *la_s,
-                                  *invM,
-                                  *new_x,
-                                  *rest_len,
-                                  stretch_compliance,
-                                  stretch_relaxation,
-                                  bending_compliance,
-                                  bending_relaxation,
-                                  1.0f / (dt0 * dt0));
-
-                    // postSolve
-                    rx.for_each_vertex(
-                        DEVICE,
-                        [dp = *dp, new_x = *new_x] __device__(VertexHandle vh) {
-                            new_x(vh, 0) += dp(vh, 0);
-                            new_x(vh, 1) += dp(vh, 1);
-                            new_x(vh, 2) += dp(vh, 2);
-                        });
-                }
 
-                // update;
-                rx.for_each_vertex(
-                    DEVICE,
-                    [dt0,
-                     invM  = *invM,
-                     v     = *v,
-                     new_x = *new_x,
-                     x     = *x] __device__(VertexHandle vh) {
-                        if (invM(vh, 0) <= 0.0) {
-                            new_x(vh, 0) = x(vh, 0);
-                            new_x(vh, 1) = x(vh, 1);
-                            new_x(vh, 2) = x(vh, 2);
-                        } else {
-                            v(vh, 0) = (new_x(vh, 0) - x(vh, 0)) / dt0;
-                            v(vh, 1) = (new_x(vh, 1) - x(vh, 1)) / dt0;
-                            v(vh, 2) = (new_x(vh, 2) - x(vh, 2)) / dt0;
-
-                            x(vh, 0) = new_x(vh, 0);
-                            x(vh, 1) = new_x(vh, 1);
-                            x(vh, 2) = new_x(vh, 2);
-                        }
-                    });
-            }
+            substep_graph.launch(stream, num_substeps);
 
             timer.stop();
             RXMESH_INFO(
@@ -591,4 +712,7 @@ int main(int argc, char** argv)
     if (test) {
         RXMESH_INFO("mean= {}, mean2= {}", mean, mean2);
     }
+
+    substep_graph.release();
+    CUDA_ERROR(cudaStreamDestroy(stream));
 }
\ No newline at end of file
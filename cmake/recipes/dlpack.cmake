@@ -0,0 +1,11 @@
+# dlpack recipe (header-only)
+include(FetchContent)
+
+set(BUILD_MOCK OFF CACHE BOOL "Build the DLPack mock library" FORCE)
+
+FetchContent_Declare(dlpack
+    GIT_REPOSITORY https://github.com/dmlc/dlpack.git
+    GIT_TAG        v1.0
+)
+
+FetchContent_MakeAvailable(dlpack)
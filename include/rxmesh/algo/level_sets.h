@@ -0,0 +1,276 @@
+#pragma once
+
+#include <sstream>
+#include <vector>
+
+#include "rxmesh/query.cuh"
+#include "rxmesh/rxmesh_static.h"
+#include "rxmesh/worklist.h"
+
+namespace rxmesh {
+
+namespace detail {
+
+/**
+ * @brief seed the search i.e., level 0. Duplicate seeds are only added once
+ */
+__global__ static void level_sets_seed(const uint32_t            num_seeds,
+                                       const VertexHandle*       seeds,
+                                       VertexAttribute<uint32_t> level,
+                                       VertexHandle*             sorted,
+                                       uint32_t*                 d_size)
+{
+    const uint32_t i = threadIdx.x + blockIdx.x * blockDim.x;
+    if (i < num_seeds) {
+        const VertexHandle vh = seeds[i];
+        if (::atomicCAS(&level(vh), INVALID32, 0u) == INVALID32) {
+            sorted[::atomicAdd(d_size, 1u)] = vh;
+        }
+    }
+}
+
+/**
+ * @brief expand the frontier (the vertices with level cur_level) by one ring
+ * where every unvisited neighbor is claimed by exactly one frontier vertex
+ * and appended to the sorted list
+ */
+template <uint32_t blockThreads>
+__global__ static void level_sets_expand(const Context             context,
+                                         const uint32_t            cur_level,
+                                         VertexAttribute<uint32_t> level,
+                                         VertexHandle*             sorted,
+                                         uint32_t*                 d_size)
+{
+    auto block = cooperative_groups::this_thread_block();
+
+    Query<blockThreads> query(context);
+
+    ShmemAllocator shrd_alloc;
+
+    query.dispatch<Op::VV>(
+        block,
+        shrd_alloc,
+        [&](const VertexHandle& vh, const VertexIterator& iter) {
+            for (uint16_t i = 0; i < iter.size(); ++i) {
+                const VertexHandle nh = iter[i];
+                if (nh.is_valid() &&
+                    ::atomicCAS(&level(nh), INVALID32, cur_level + 1) ==
+                        INVALID32) {
+                    sorted[::atomicAdd(d_size, 1u)] = nh;
+                }
+            }
+        },
+        [&](const VertexHandle& vh) { return level(vh) == cur_level; });
+}
+}  // namespace detail
+
+/**
+ * @brief multi-source breadth-first search on the vertices of the mesh that
+ * computes the topological level sets (toplesets) i.e., the number of hops
+ * of every vertex from the closest seed. The search is frontier-based where
+ * every level only launches the patches that have vertices in the frontier
+ * and the frontier vertices are the only query sources. The output is in
+ * sorted CSR form: the reached vertices sorted by level (sorted()) where the
+ * vertices of level l are sorted()[offset()[l], offset()[l + 1]) along with
+ * the level of every vertex (level()) which is INVALID32 for the vertices that
+ * are not reachable from the seeds. The order of the vertices within one level
+ * is not deterministic. The topology should not change while it is in use
+ */
+struct LevelSets
+{
+    LevelSets(RXMeshStatic& rx)
+        : m_rx(rx),
+          m_num_reached(0),
+          m_d_sorted(nullptr),
+          m_d_seeds(nullptr),
+          m_d_patches(nullptr),
+          m_d_size(nullptr),
+          m_seeds_capacity(0)
+    {
+        std::ostringstream address;
+        address << (void const*)this;
+
+        m_level = m_rx.add_vertex_attribute<uint32_t>(
+            "ls_level" + address.str(), 1, LOCATION_ALL);
+        m_level->reset(INVALID32, LOCATION_ALL);
+
+        const uint32_t num_vertices = m_rx.get_num_vertices();
+
+        CUDA_ERROR(tracked_malloc((void**)&m_d_sorted,
+                                  num_vertices * sizeof(VertexHandle),
+                                  MemoryCategory::Other));
+        CUDA_ERROR(tracked_malloc((void**)&m_d_patches,
+                                  num_vertices * sizeof(uint32_t),
+                                  MemoryCategory::Other));
+        CUDA_ERROR(tracked_malloc(
+            (void**)&m_d_size, sizeof(uint32_t), MemoryCategory::Other));
+
+        m_offset.push_back(0);
+    }
+
+    LevelSets(const LevelSets&)            = delete;
+    LevelSets& operator=(const LevelSets&) = delete;
+
+    ~LevelSets()
+    {
+        m_rx.remove_attribute(m_level->get_name());
+        GPU_FREE(m_d_sorted);
+        GPU_FREE(m_d_seeds);
+        GPU_FREE(m_d_patches);
+        GPU_FREE(m_d_size);
+    }
+
+    /**
+     * @brief compute the level sets from the seeds. The level of the seeds is
+     * 0. The level attribute is updated on the host and the device
+     * @param seeds the (owned) handles of the seed vertices
+     * @param stream the stream to run the search on
+     * @return the number of levels
+     */
+    template <uint32_t blockThreads = 256>
+    uint32_t compute(const std::vector<VertexHandle>& seeds,
+                     cudaStream_t                     stream = NULL)
+    {
+        if (m_rx.has_patch_subset()) {
+            RXMESH_ERROR(
+                "LevelSets::compute() can not be used while a patch subset is "
+                "set");
+            return get_num_levels();
+        }
+
+        m_offset.clear();
+        m_offset.push_back(0);
+        m_num_reached = 0;
+
+        m_level->reset(INVALID32, DEVICE, stream);
+        CUDA_ERROR(cudaMemsetAsync(m_d_size, 0, sizeof(uint32_t), stream));
+
+        if (seeds.empty()) {
+            m_level->reset(INVALID32, HOST);
+            return 0;
+        }
+
+        // level 0
+        const uint32_t num_seeds = seeds.size();
+        if (num_seeds > m_seeds_capacity) {
+            GPU_FREE(m_d_seeds);
+            m_seeds_capacity = num_seeds;
+            CUDA_ERROR(tracked_malloc((void**)&m_d_seeds,
+                                      m_seeds_capacity * sizeof(VertexHandle),
+                                      MemoryCategory::Other));
+        }
+        CUDA_ERROR(cudaMemcpyAsync(m_d_seeds,
+                                   seeds.data(),
+                                   num_seeds * sizeof(VertexHandle),
+                                   cudaMemcpyHostToDevice,
+                                   stream));
+        detail::level_sets_seed<<<DIVIDE_UP(num_seeds, 256), 256, 0, stream>>>(
+            num_seeds, m_d_seeds, *m_level, m_d_sorted, m_d_size);
+        read_size(stream);
+
+        LaunchBox<blockThreads> lb;
+        m_rx.prepare_launch_box(
+            {Op::VV},
+            lb,
+            (void*)detail::level_sets_expand<blockThreads>,
+            false);
+
+        // every level is the frontier of the next one until the frontier is
+        // empty
+        while (m_num_reached > m_offset.back()) {
+            const uint32_t start = m_offset.back();
+            const uint32_t num   = m_num_reached - start;
+            const uint32_t level = m_offset.size() - 1;
+            m_offset.push_back(m_num_reached);
+
+            detail::worklist_patches<<<DIVIDE_UP(num, 256), 256, 0, stream>>>(
+                num, m_d_sorted + start, m_d_patches);
+            CUDA_ERROR(cudaStreamSynchronize(stream));
+
+            m_rx.set_patch_subset(m_d_patches, num);
+
+            m_rx.run_kernel(lb,
+                            detail::level_sets_expand<blockThreads>,
+                            {Op::VV},
+                            stream,
+                            level,
+                            *m_level,
+                            m_d_sorted,
+                            m_d_size);
+
+            m_rx.clear_patch_subset();
+
+            read_size(stream);
+        }
+
+        m_level->move(DEVICE, HOST, stream);
+        CUDA_ERROR(cudaStreamSynchronize(stream));
+
+        return get_num_levels();
+    }
+
+    /**
+     * @brief the number of levels of the last compute()
+     */
+    uint32_t get_num_levels() const
+    {
+        return m_offset.size() - 1;
+    }
+
+    /**
+     * @brief the number of vertices that are reachable from the seeds i.e.,
+     * the size of sorted()
+     */
+    uint32_t get_num_reached() const
+    {
+        return m_num_reached;
+    }
+
+    /**
+     * @brief (host) offset of every level in sorted() with
+     * get_num_levels() + 1 entries where the last one is get_num_reached()
+     */
+    const std::vector<uint32_t>& offset() const
+    {
+        return m_offset;
+    }
+
+    /**
+     * @brief device pointer to the reached vertices sorted by their level
+     */
+    const VertexHandle* sorted() const
+    {
+        return m_d_sorted;
+    }
+
+    /**
+     * @brief the level of every vertex (INVALID32 if not reachable)
+     */
+    VertexAttribute<uint32_t>& level()
+    {
+        return *m_level;
+    }
+
+   private:
+    void read_size(cudaStream_t stream)
+    {
+        CUDA_ERROR(cudaMemcpyAsync(&m_num_reached,
+                                   m_d_size,
+                                   sizeof(uint32_t),
+                                   cudaMemcpyDeviceToHost,
+                                   stream));
+        CUDA_ERROR(cudaStreamSynchronize(stream));
+    }
+
+    RXMeshStatic&                              m_rx;
+    std::shared_ptr<VertexAttribute<uint32_t>> m_level;
+    std::vector<uint32_t>                      m_offset;
+    uint32_t                                   m_num_reached;
+    VertexHandle*                              m_d_sorted;
+    VertexHandle*                              m_d_seeds;
+    uint32_t*                                  m_d_patches;
+    uint32_t*                                  m_d_size;
+    uint32_t                                   m_seeds_capacity;
+};
+
+}  // namespace rxmesh
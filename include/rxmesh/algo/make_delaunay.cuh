@@ -0,0 +1,333 @@
+#pragma once
+
+#include <limits>
+
+#include "rxmesh/cavity_manager.cuh"
+#include "rxmesh/query.cuh"
+#include "rxmesh/rxmesh_dynamic.h"
+
+namespace rxmesh {
+
+/**
+ * @brief the output of make_delaunay()
+ */
+struct DelaunayStats
+{
+    // the total number of flipped edges
+    uint32_t num_flips = 0;
+    // the number of rounds where every round goes over all patches once (or
+    // more if some patches failed and got re-scheduled)
+    uint32_t num_rounds = 0;
+};
+
+namespace detail {
+
+/**
+ * @brief the angle at M between S, M, and Q
+ */
+template <typename T>
+__device__ __inline__ T delaunay_angle(const vec3<T>& S,
+                                       const vec3<T>& M,
+                                       const vec3<T>& Q)
+{
+    const vec3<T> p1      = S - M;
+    const vec3<T> p2      = Q - M;
+    const T       dot_pro = glm::dot(p1, p2);
+    return std::acos(dot_pro / (glm::length(p1) * glm::length(p2)));
+}
+
+/**
+ * @brief one round of Delaunay edge flips over the active edges of a patch.
+ * An active edge is tested and deactivated unless it is a non-Delaunay edge
+ * that can be flipped (i.e., it stays active until it is flipped). When an
+ * edge is flipped, the new edge and the four edges of its diamond (which are
+ * the only edges whose Delaunay-ness may change) are activated. Patches
+ * without active edges skip the query altogether
+ */
+template <typename T, uint32_t blockThreads>
+__global__ static void __launch_bounds__(blockThreads)
+    delaunay_flip_active(Context             context,
+                         VertexAttribute<T>  coords,
+                         EdgeAttribute<bool> active,
+                         uint32_t*           d_num_flips)
+{
+    auto           block = cooperative_groups::this_thread_block();
+    ShmemAllocator shrd_alloc;
+    CavityManager<blockThreads, CavityOp::E> cavity(
+        block, context, shrd_alloc, false);
+
+    const uint32_t pid = cavity.patch_id();
+
+    if (pid == INVALID32) {
+        return;
+    }
+
+    const uint16_t num_v = cavity.patch_info().num_vertices[0];
+
+    // the edges we want to flip. After the prologue, the edges that should be
+    // activated (the new edges and the cavity boundary edges)
+    Bitmask e_flip(cavity.patch_info().edges_capacity, shrd_alloc);
+    e_flip.reset(block);
+
+    uint32_t shmem_before = shrd_alloc.get_allocated_size_bytes();
+
+    int has_active = 0;
+    for_each_edge(cavity.patch_info(), [&](EdgeHandle eh) {
+        if (active(eh)) {
+            has_active = 1;
+        }
+    });
+    has_active = __syncthreads_or(has_active);
+
+    if (has_active) {
+        // for each edge we want to flip, we store its id in one of its
+        // opposite vertices along with the other opposite vertex
+        uint16_t* v_info = shrd_alloc.alloc<uint16_t>(2 * num_v);
+        fill_n<blockThreads>(v_info, 2 * num_v, uint16_t(INVALID16));
+
+        Query<blockThreads> query(context, pid);
+        query.prologue<Op::EVDiamond>(block, shrd_alloc);
+        block.sync();
+
+        // 1. test the active edges
+        for_each_edge(cavity.patch_info(), [&](EdgeHandle eh) {
+            if (!active(eh)) {
+                return;
+            }
+
+            // iter[0] and iter[2] are the edge two vertices
+            // iter[1] and iter[3] are the two opposite vertices
+            const VertexIterator iter =
+                query.template get_iterator<VertexIterator>(eh.local_id());
+
+            const VertexHandle v0 = iter[0];
+            const VertexHandle v1 = iter[2];
+            const VertexHandle v2 = iter[1];
+            const VertexHandle v3 = iter[3];
+
+            // boundary and degenerate edges are never flipped
+            if (!v2.is_valid() || !v3.is_valid() || v0 == v1 || v0 == v2 ||
+                v0 == v3 || v1 == v2 || v1 == v3 || v2 == v3) {
+                active(eh) = false;
+                return;
+            }
+
+            constexpr T PII = 3.14159265358979323f;
+            constexpr T eps = std::numeric_limits<T>::epsilon();
+
+            const vec3<T> V0 = coords.template to_glm<3>(v0);
+            const vec3<T> V1 = coords.template to_glm<3>(v1);
+            const vec3<T> V2 = coords.template to_glm<3>(v2);
+            const vec3<T> V3 = coords.template to_glm<3>(v3);
+
+            const T lambda = delaunay_angle(V0, V2, V1);
+            const T gamma  = delaunay_angle(V0, V3, V1);
+
+            // Delaunay edge
+            if (lambda + gamma <= PII + eps) {
+                active(eh) = false;
+                return;
+            }
+
+            // flipping it would create a foldover
+            if (delaunay_angle(V3, V0, V1) + delaunay_angle(V2, V0, V1) >=
+                    PII - eps ||
+                delaunay_angle(V3, V1, V0) + delaunay_angle(V2, V1, V0) >=
+                    PII - eps) {
+                active(eh) = false;
+                return;
+            }
+
+            const uint16_t l2(iter.local(1)), l3(iter.local(3));
+
+            if (v2.patch_id() == pid &&
+                ::atomicCAS(v_info + 2 * l2, INVALID16, l3) == INVALID16) {
+                v_info[2 * l2 + 1] = eh.local_id();
+                e_flip.set(eh.local_id(), true);
+            } else if (v3.patch_id() == pid &&
+                       ::atomicCAS(v_info + 2 * l3, INVALID16, l2) ==
+                           INVALID16) {
+                v_info[2 * l3 + 1] = eh.local_id();
+                e_flip.set(eh.local_id(), true);
+            }
+        });
+        block.sync();
+
+        // 2. make sure that the two vertices opposite to a flipped edge are
+        // not connected
+        for_each_edge(
+            cavity.patch_info(),
+            [&](EdgeHandle eh) {
+                const VertexIterator iter =
+                    query.template get_iterator<VertexIterator>(eh.local_id());
+                const uint16_t l0 = iter.local(0);
+                const uint16_t l1 = iter.local(2);
+                if (v_info[2 * l0] == l1) {
+                    e_flip.reset(v_info[2 * l0 + 1], true);
+                }
+                if (v_info[2 * l1] == l0) {
+                    e_flip.reset(v_info[2 * l1 + 1], true);
+                }
+            },
+            true);
+        block.sync();
+
+        // 3. create cavity for the surviving edges
+        for_each_edge(cavity.patch_info(), [&](EdgeHandle eh) {
+            if (e_flip(eh.local_id())) {
+                cavity.create(eh);
+            }
+        });
+        block.sync();
+
+        shrd_alloc.dealloc(shrd_alloc.get_allocated_size_bytes() -
+                           shmem_before);
+    }
+
+    // create cavities
+    if (cavity.prologue(block, shrd_alloc, coords, active)) {
+
+        e_flip.reset(block);
+        block.sync();
+
+        cavity.for_each_cavity(block, [&](uint16_t c, uint16_t size) {
+            assert(size == 4);
+
+            DEdgeHandle new_edge = cavity.add_edge(
+                cavity.get_cavity_vertex(c, 1), cavity.get_cavity_vertex(c, 3));
+
+            if (new_edge.is_valid()) {
+                cavity.add_face(cavity.get_cavity_edge(c, 0),
+                                new_edge,
+                                cavity.get_cavity_edge(c, 3));
+
+
+                cavity.add_face(cavity.get_cavity_edge(c, 1),
+                                cavity.get_cavity_edge(c, 2),
+                                new_edge.get_flip_dedge());
+
+                e_flip.set(new_edge.local_id(), true);
+                for (uint16_t i = 0; i < size; ++i) {
+                    e_flip.set(cavity.get_cavity_edge(c, i).local_id(), true);
+                }
+
+                ::atomicAdd(d_num_flips, 1u);
+            }
+        });
+    }
+
+    cavity.epilogue(block);
+    block.sync();
+
+    // activate the edges around the flipped ones in their owner patch
+    if (cavity.is_successful()) {
+        for (uint16_t e = threadIdx.x; e < e_flip.size(); e += blockThreads) {
+            if (e_flip(e)) {
+                active(context.get_owner_handle(EdgeHandle(pid, e))) = true;
+            }
+        }
+    }
+}
+}  // namespace detail
+
+/**
+ * @brief make the mesh (intrinsically) Delaunay by flipping non-Delaunay
+ * edges. Instead of testing all the edges in every round, an active-edge flag
+ * (an edge attribute that follows the edges through the topology changes) is
+ * kept on the device. Initially all edges are active, an edge is deactivated
+ * once it is tested and found Delaunay (or can not be flipped), and flipping
+ * an edge only activates the new edge and its diamond. Thus, later rounds only
+ * test the few edges around the last flips and patches with no active edges
+ * skip the query. The host only reads the number of flips after every round.
+ * When a round does not flip any edge, one final round with all edges active
+ * confirms the convergence (the activation of an edge in a neighbor patch
+ * could race with that patch being changed)
+ * @param rx the input mesh
+ * @param coords the vertex coordinates
+ * @param max_rounds the maximum number of rounds
+ * @return the number of flips and rounds
+ */
+template <typename T, uint32_t blockThreads = 256>
+DelaunayStats make_delaunay(RXMeshDynamic&      rx,
+                            VertexAttribute<T>& coords,
+                            const uint32_t      max_rounds = 1000)
+{
+    DelaunayStats stats;
+
+    auto active = rx.add_edge_attribute<bool>("delaunayActive", 1, DEVICE);
+    active->reset(true, DEVICE);
+
+    uint32_t* d_num_flips = nullptr;
+    CUDA_ERROR(tracked_malloc((void**)&d_num_flips,
+                              sizeof(uint32_t),
+                              MemoryCategory::Other));
+
+    LaunchBox<blockThreads> launch_box;
+    rx.prepare_launch_box(
+        {Op::EVDiamond},
+        launch_box,
+        (void*)detail::delaunay_flip_active<T, blockThreads>,
+        true,
+        false,
+        false,
+        false,
+        [&](uint32_t v, uint32_t e, uint32_t f) {
+            return detail::mask_num_bytes(e) + 2 * v * sizeof(uint16_t) +
+                   2 * ShmemAllocator::default_alignment;
+        });
+
+    bool confirming = false;
+    bool converged  = false;
+
+    while (stats.num_rounds < max_rounds) {
+        CUDA_ERROR(cudaMemset(d_num_flips, 0, sizeof(uint32_t)));
+
+        rx.reset_scheduler();
+        while (!rx.is_queue_empty()) {
+            detail::delaunay_flip_active<T, blockThreads>
+                <<<launch_box.blocks,
+                   launch_box.num_threads,
+                   launch_box.smem_bytes_dyn>>>(
+                    rx.get_context(), coords, *active, d_num_flips);
+
+            rx.cleanup();
+        }
+        stats.num_rounds++;
+
+        uint32_t h_num_flips = 0;
+        CUDA_ERROR(cudaMemcpy(&h_num_flips,
+                              d_num_flips,
+                              sizeof(uint32_t),
+                              cudaMemcpyDeviceToHost));
+        stats.num_flips += h_num_flips;
+
+        if (h_num_flips == 0) {
+            if (confirming) {
+                converged = true;
+                break;
+            }
+            confirming = true;
+            active->reset(true, DEVICE);
+        } else {
+            confirming = false;
+        }
+    }
+
+    if (!converged) {
+        RXMESH_WARN(
+            "make_delaunay() did not converge after {} rounds. The mesh may "
+            "still have non-Delaunay edges",
+            max_rounds);
+    }
+
+    RXMESH_TRACE("make_delaunay() #flips= {}, #rounds= {}",
+                 stats.num_flips,
+                 stats.num_rounds);
+
+    GPU_FREE(d_num_flips);
+    rx.remove_attribute("delaunayActive");
+
+    return stats;
+}
+
+}  // namespace rxmesh
@@ -0,0 +1,171 @@
+#pragma once
+
+#include <numeric>
+#include <vector>
+
+#include "rxmesh/query.cuh"
+#include "rxmesh/rxmesh_static.h"
+
+namespace rxmesh {
+
+/**
+ * @brief color the mesh elements such that two elements of the same color do
+ * not share a vertex in their stencil where the stencil of an element is the
+ * output of the query op, e.g., with Op::EVDiamond, two edges get different
+ * colors if their diamonds (the two edge end vertices and the two opposite
+ * vertices) overlap. The stencil of a vertex (e.g., Op::VV) also contains the
+ * vertex itself. A kernel that only processes the elements of one color can
+ * then write to all the vertices in the stencil without atomics and
+ * processing the colors one after the other is a race-free (and
+ * deterministic) Gauss-Seidel sweep. The coloring is a greedy coloring
+ * computed on the host once (i.e., the topology should not change after)
+ * @param rx the input mesh
+ * @param color the output color of every element (should be allocated on the
+ * host and device)
+ * @return the number of colors
+ */
+template <Op op, uint32_t blockThreads = 256>
+uint32_t stencil_coloring(
+    const RXMeshStatic&                                  rx,
+    Attribute<uint32_t, typename InputHandle<op>::type>& color)
+{
+    using HandleT = typename InputHandle<op>::type;
+
+    static_assert(
+        std::is_same_v<typename IteratorType<op>::type, VertexIterator>,
+        "stencil_coloring() the output of the query should be vertices");
+
+    constexpr bool with_self = std::is_same_v<HandleT, VertexHandle>;
+
+    const uint32_t num_elements = rx.get_num_elements<HandleT>();
+    const uint32_t num_vertices = rx.get_num_vertices();
+
+    const Context context = rx.get_context();
+
+    // 1) the stencil size of every element
+    uint32_t* d_offset = nullptr;
+    CUDA_ERROR(tracked_malloc((void**)&d_offset,
+                              (num_elements + 1) * sizeof(uint32_t),
+                              MemoryCategory::Other));
+
+    rx.run_query_kernel<op, blockThreads>(
+        [=] __device__(const HandleT& h, const VertexIterator& iter) {
+            uint32_t size = with_self ? 1 : 0;
+            for (uint16_t i = 0; i < iter.size(); ++i) {
+                if (iter[i].is_valid()) {
+                    size++;
+                }
+            }
+            d_offset[context.linear_id(h)] = size;
+        });
+
+    std::vector<uint32_t> h_offset(num_elements + 1, 0);
+    CUDA_ERROR(cudaMemcpy(h_offset.data(),
+                          d_offset,
+                          num_elements * sizeof(uint32_t),
+                          cudaMemcpyDeviceToHost));
+    std::exclusive_scan(
+        h_offset.begin(), h_offset.end(), h_offset.begin(), uint32_t(0));
+    CUDA_ERROR(cudaMemcpy(d_offset,
+                          h_offset.data(),
+                          (num_elements + 1) * sizeof(uint32_t),
+                          cudaMemcpyHostToDevice));
+
+    // 2) the (linear id of the) stencil vertices of every element
+    const uint32_t num_entries = h_offset.back();
+
+    uint32_t* d_stencil = nullptr;
+    CUDA_ERROR(
+        tracked_malloc((void**)&d_stencil,
+                       std::max(num_entries, num_elements) * sizeof(uint32_t),
+                       MemoryCategory::Other));
+
+    rx.run_query_kernel<op, blockThreads>(
+        [=] __device__(const HandleT& h, const VertexIterator& iter) {
+            uint32_t o = d_offset[context.linear_id(h)];
+            if constexpr (with_self) {
+                d_stencil[o++] = context.linear_id(h);
+            }
+            for (uint16_t i = 0; i < iter.size(); ++i) {
+                if (iter[i].is_valid()) {
+                    d_stencil[o++] = context.linear_id(iter[i]);
+                }
+            }
+        });
+
+    std::vector<uint32_t> h_stencil(num_entries);
+    CUDA_ERROR(cudaMemcpy(h_stencil.data(),
+                          d_stencil,
+                          num_entries * sizeof(uint32_t),
+                          cudaMemcpyDeviceToHost));
+
+    // 3) the elements incident to every vertex (i.e., the transpose)
+    std::vector<uint32_t> v_offset(num_vertices + 1, 0);
+    for (uint32_t v : h_stencil) {
+        v_offset[v + 1]++;
+    }
+    std::inclusive_scan(v_offset.begin(), v_offset.end(), v_offset.begin());
+
+    std::vector<uint32_t> v_elements(num_entries);
+    {
+        std::vector<uint32_t> pos(v_offset.begin(), v_offset.end() - 1);
+        for (uint32_t e = 0; e < num_elements; ++e) {
+            for (uint32_t i = h_offset[e]; i < h_offset[e + 1]; ++i) {
+                v_elements[pos[h_stencil[i]]++] = e;
+            }
+        }
+    }
+
+    // 4) greedy coloring where the forbidden colors of an element are the
+    // colors of the (already colored) elements that share a stencil vertex
+    std::vector<uint32_t> h_color(num_elements, INVALID32);
+    std::vector<uint32_t> forbidden;
+    uint32_t              num_colors = 0;
+
+    for (uint32_t e = 0; e < num_elements; ++e) {
+        for (uint32_t i = h_offset[e]; i < h_offset[e + 1]; ++i) {
+            const uint32_t v = h_stencil[i];
+            for (uint32_t j = v_offset[v]; j < v_offset[v + 1]; ++j) {
+                const uint32_t c = h_color[v_elements[j]];
+                if (c != INVALID32) {
+                    forbidden[c] = e;
+                }
+            }
+        }
+
+        uint32_t c = 0;
+        while (c < num_colors && forbidden[c] == e) {
+            c++;
+        }
+        if (c == num_colors) {
+            num_colors++;
+            forbidden.push_back(INVALID32);
+        }
+        h_color[e] = c;
+    }
+
+    // 5) move the colors to the attribute
+    CUDA_ERROR(cudaMemcpy(d_stencil,
+                          h_color.data(),
+                          num_elements * sizeof(uint32_t),
+                          cudaMemcpyHostToDevice));
+
+    rx.for_each<HandleT>(DEVICE,
+                         [=] __device__(const HandleT& h) mutable {
+                             color(h) = d_stencil[context.linear_id(h)];
+                         });
+
+    rx.for_each<HandleT>(
+        HOST,
+        [&](const HandleT& h) { color(h) = h_color[rx.linear_id(h)]; },
+        NULL,
+        false);
+
+    CUDA_ERROR(cudaDeviceSynchronize());
+    GPU_FREE(d_offset);
+    GPU_FREE(d_stencil);
+
+    return num_colors;
+}
+
+}  // namespace rxmesh
@@ -4,11 +4,17 @@
 
 #include "rxmesh/geometry_util.cuh"
 
+#include "rxmesh/matrix/cholesky_solver.h"
+#include "rxmesh/matrix/dense_matrix.h"
 #include "rxmesh/matrix/lu_solver.h"
+#include "rxmesh/matrix/pcg_solver.h"
 #include "rxmesh/matrix/sparse_matrix.h"
 
 #include <glm/gtc/constants.hpp>
 
+#include <memory>
+#include <vector>
+
 namespace rxmesh {
 
 namespace detail {
@@ -184,7 +190,9 @@ inline void map_vertices_to_circle(RXMeshStatic&             rx,
 
     VertexHandle*      d_next_v = nullptr;
     const VertexHandle h_next_v = VertexHandle();
-    CUDA_ERROR(cudaMalloc((void**)&d_next_v, sizeof(VertexHandle)));
+    CUDA_ERROR(tracked_malloc((void**)&d_next_v,
+                              sizeof(VertexHandle),
+                              MemoryCategory::Other));
     CUDA_ERROR(cudaMemcpy(
         d_next_v, &h_next_v, sizeof(VertexHandle), cudaMemcpyHostToDevice));
 
@@ -327,4 +335,479 @@ inline void tutte_embedding(RXMeshStatic&             rx,
     L.release();
 }
 
-}  // namespace rxmesh
\ No newline at end of file
+/**
+ * @brief the linear solver used by TutteEmbedding
+ */
+enum class TutteSolver
+{
+    // one Cholesky factorization of the (block-diagonal) system of all charts.
+    // The factorization only depends on which vertices are fixed and thus it
+    // is reused when only the boundary positions change
+    Cholesky = 0,
+    // Jacobi-preconditioned CG over all charts at once that can be
+    // warm-started from a previous embedding
+    PCG = 1,
+};
+
+/**
+ * @brief batched Tutte embedding of a set of charts. Every vertex is assigned
+ * to a chart (v_chart) and only the edges whose two end vertices belong to the
+ * same chart are coupled such that the system of all charts is block-diagonal
+ * and is solved at once (rather than one solve per chart). The boundary of a
+ * chart is its (longest) mesh boundary loop, i.e., every chart is expected to
+ * be a disk-like (e.g., disconnected) component of the mesh. The boundary
+ * vertices are Dirichlet constraints that are moved to the right-hand side so
+ * that the system is symmetric positive definite. Since the matrix only
+ * depends on which vertices are fixed, changing the boundary map (e.g., a
+ * slightly different boundary between calls) only changes the right-hand
+ * side. With TutteSolver::Cholesky, the factorization is reused and with
+ * TutteSolver::PCG, the solve can be warm-started from the previous embedding
+ */
+template <typename T>
+class TutteEmbedding
+{
+   public:
+    /**
+     * @brief single-chart embedding of the whole mesh
+     */
+    TutteEmbedding(RXMeshStatic& rx,
+                   TutteSolver   solver   = TutteSolver::Cholesky,
+                   int           max_iter = 1000,
+                   T             tol      = 1e-6)
+        : TutteEmbedding(rx,
+                         rx.add_vertex_attribute<uint32_t>("tutteChart", 1),
+                         solver,
+                         max_iter,
+                         tol)
+    {
+        m_chart_ptr->reset(0, LOCATION_ALL);
+        m_num_charts = 1;
+    }
+
+    /**
+     * @brief multi-chart embedding
+     * @param v_chart the chart of every vertex (0, 1, ...). Should be
+     * allocated on the host and the device
+     */
+    TutteEmbedding(RXMeshStatic&                    rx,
+                   const VertexAttribute<uint32_t>& v_chart,
+                   TutteSolver solver   = TutteSolver::Cholesky,
+                   int         max_iter = 1000,
+                   T           tol      = 1e-6)
+        : TutteEmbedding(rx, nullptr, solver, max_iter, tol)
+    {
+        m_chart = v_chart;
+
+        m_num_charts = 0;
+        m_rx.for_each_vertex(HOST, [&](const VertexHandle& vh) {
+            m_num_charts = std::max(m_num_charts, m_chart(vh) + 1);
+        });
+    }
+
+    TutteEmbedding(const TutteEmbedding&)            = delete;
+    TutteEmbedding& operator=(const TutteEmbedding&) = delete;
+
+    ~TutteEmbedding()
+    {
+        m_chol.reset();
+        m_pcg.reset();
+        m_L.release();
+        m_B.release();
+        m_X.release();
+        m_rx.remove_attribute("tutteFixed");
+        m_rx.remove_attribute("tutteNext");
+        if (m_chart_ptr) {
+            m_rx.remove_attribute("tutteChart");
+        }
+    }
+
+    /**
+     * @brief map the boundary loop of every chart to the unit circle using the
+     * arc length and solve for the interior vertices
+     * @param coordinates the vertex coordinates (on the host and the device)
+     * @param uv the output (2-component) embedding
+     */
+    void embed(const VertexAttribute<T>& coordinates, VertexAttribute<T>& uv)
+    {
+        map_boundary_to_circle(coordinates, uv);
+        solve(uv);
+    }
+
+    /**
+     * @brief find the boundary loop of every chart and map it to the unit
+     * circle using the arc length. The loops (and thus the fixed vertices)
+     * are only computed once. The boundary vertices of uv are written (on the
+     * host and the device) and the interior ones are set to zero
+     */
+    void map_boundary_to_circle(const VertexAttribute<T>& coordinates,
+                                VertexAttribute<T>&       uv)
+    {
+        if (!m_has_loops) {
+            find_boundary_loops(coordinates);
+        }
+
+        uv.reset(0, LOCATION_ALL);
+
+        for (const auto& loop : m_loops) {
+            for (size_t i = 0; i < loop.vertices.size(); ++i) {
+                const T frac =
+                    loop.arc_length[i] * T(2.0) * glm::pi<T>() / loop.length;
+
+                uv(loop.vertices[i], 0) = std::cos(frac);
+                uv(loop.vertices[i], 1) = std::sin(frac);
+            }
+        }
+        uv.move(HOST, DEVICE);
+    }
+
+    /**
+     * @brief solve for the interior vertices of all charts given the position
+     * of the charts' boundary vertices in uv (on the device). The loops
+     * should have been found first by calling map_boundary_to_circle() (whose
+     * boundary map could be then modified by the caller)
+     * @param uv the (2-component) embedding. The boundary vertices are read
+     * and the interior vertices are written (on the device, and on the host if
+     * uv is allocated there)
+     * @param warm_start use the current interior vertices of uv as the initial
+     * guess. Only used with TutteSolver::PCG
+     * @return the number of iterations taken (zero for TutteSolver::Cholesky)
+     */
+    int solve(VertexAttribute<T>& uv, bool warm_start = false)
+    {
+        if (!m_has_loops) {
+            RXMESH_ERROR(
+                "TutteEmbedding::solve() map_boundary_to_circle() should be "
+                "called first to find the charts boundary. Returning without "
+                "solving.");
+            return 0;
+        }
+
+        if (!m_is_assembled) {
+            assemble();
+        }
+
+        setup_rhs(uv, warm_start);
+
+        int iters = 0;
+        if (m_solver == TutteSolver::Cholesky) {
+            m_chol->solve(m_B, m_X);
+        } else {
+            m_pcg->pre_solve(m_B, m_X);
+            m_pcg->solve(m_B, m_X);
+            iters = m_pcg->iter_taken();
+        }
+
+        const VertexAttribute<bool> fixed = *m_fixed;
+        const DenseMatrix<T>        X     = m_X;
+
+        m_rx.for_each_vertex(DEVICE,
+                             [uv, fixed, X] __device__(
+                                 const VertexHandle& vh) mutable {
+                                 if (!fixed(vh)) {
+                                     uv(vh, 0) = X(vh, 0);
+                                     uv(vh, 1) = X(vh, 1);
+                                 }
+                             });
+
+        if (uv.is_host_allocated()) {
+            uv.move(DEVICE, HOST);
+        }
+
+        return iters;
+    }
+
+    /**
+     * @brief the number of charts
+     */
+    uint32_t num_charts() const
+    {
+        return m_num_charts;
+    }
+
+    /**
+     * @brief the fixed (i.e., boundary loop) vertices. Only valid after
+     * map_boundary_to_circle()
+     */
+    VertexAttribute<bool>& fixed_vertices()
+    {
+        return *m_fixed;
+    }
+
+    /**
+     * @brief the assembled system matrix
+     */
+    const SparseMatrix<T>& system_matrix() const
+    {
+        return m_L;
+    }
+
+    /**
+     * @brief the assembled system. The edges between the vertices of the same
+     * chart have a unit (Tutte) weight. The rows of the fixed vertices are the
+     * identity and their columns are moved to the right-hand side. Should be
+     * called after the loops are found
+     */
+    void assemble()
+    {
+        const VertexAttribute<bool>     fixed = *m_fixed;
+        const VertexAttribute<uint32_t> chart = m_chart;
+        SparseMatrix<T>                 L     = m_L;
+
+        m_L.reset(0, DEVICE);
+
+        m_rx.for_each_vertex(
+            DEVICE, [L, fixed] __device__(const VertexHandle& vh) mutable {
+                L(vh, vh) = fixed(vh) ? T(1) : T(0);
+            });
+
+        m_rx.run_query_kernel<Op::EV, 256>(
+            [L, fixed, chart] __device__(const EdgeHandle&     eh,
+                                         const VertexIterator& ev) mutable {
+                const VertexHandle p = ev[0];
+                const VertexHandle r = ev[1];
+
+                if (chart(p) != chart(r)) {
+                    return;
+                }
+
+                if (!fixed(p)) {
+                    ::atomicAdd(&L(p, p), T(1));
+                    if (!fixed(r)) {
+                        L(p, r) = T(-1);
+                    }
+                }
+                if (!fixed(r)) {
+                    ::atomicAdd(&L(r, r), T(1));
+                    if (!fixed(p)) {
+                        L(r, p) = T(-1);
+                    }
+                }
+            });
+
+        if (m_solver == TutteSolver::Cholesky) {
+            m_L.move(DEVICE, HOST);
+            m_chol->pre_solve(m_rx);
+        }
+
+        m_is_assembled = true;
+    }
+
+    /**
+     * @brief the right-hand side from the boundary positions in uv and the
+     * initial guess. This is public only because of the device lambdas
+     */
+    void setup_rhs(const VertexAttribute<T>& uv, bool warm_start)
+    {
+        const VertexAttribute<bool>     fixed = *m_fixed;
+        const VertexAttribute<uint32_t> chart = m_chart;
+        DenseMatrix<T>                  B     = m_B;
+        DenseMatrix<T>                  X     = m_X;
+
+        m_rx.for_each_vertex(
+            DEVICE,
+            [uv, fixed, B, X, warm_start] __device__(
+                const VertexHandle& vh) mutable {
+                const bool is_fixed = fixed(vh);
+                for (int i = 0; i < 2; ++i) {
+                    B(vh, i) = is_fixed ? uv(vh, i) : T(0);
+                    X(vh, i) = (is_fixed || warm_start) ? uv(vh, i) : T(0);
+                }
+            });
+
+        m_rx.run_query_kernel<Op::EV, 256>(
+            [uv, fixed, chart, B] __device__(const EdgeHandle&     eh,
+                                             const VertexIterator& ev) mutable {
+                const VertexHandle p = ev[0];
+                const VertexHandle r = ev[1];
+
+                if (chart(p) != chart(r) || fixed(p) == fixed(r)) {
+                    return;
+                }
+
+                const VertexHandle f = fixed(p) ? p : r;
+                const VertexHandle u = fixed(p) ? r : p;
+                for (int i = 0; i < 2; ++i) {
+                    ::atomicAdd(&B(u, i), uv(f, i));
+                }
+            });
+    }
+
+    /**
+     * @brief store for every boundary vertex the linear id of the next vertex
+     * along its boundary loop (following the orientation of the faces). This
+     * is public only because of the device lambdas
+     */
+    void find_next_boundary_vertex()
+    {
+        const Context                   context = m_rx.get_context();
+        const VertexAttribute<uint32_t> chart   = m_chart;
+        VertexAttribute<uint32_t>       next    = *m_next;
+
+        m_next->reset(INVALID32, DEVICE);
+
+        m_rx.run_query_kernel<Op::EVDiamond, 256>(
+            [context, chart, next] __device__(
+                const EdgeHandle& eh, const VertexIterator& iter) mutable {
+                // Edge: iter[0]-iter[2]
+                // Opposite vertices: iter[1] and iter[3] where iter[1] is
+                // valid if the face traverses the edge from iter[0] to iter[2]
+                const VertexHandle p = iter[0];
+                const VertexHandle r = iter[2];
+
+                if (iter[1].is_valid() == iter[3].is_valid() ||
+                    chart(p) != chart(r)) {
+                    return;
+                }
+
+                if (iter[1].is_valid()) {
+                    next(p) = context.linear_id(r);
+                } else {
+                    next(r) = context.linear_id(p);
+                }
+            });
+
+        m_next->move(DEVICE, HOST);
+    }
+
+   private:
+    TutteEmbedding(RXMeshStatic&                             rx,
+                   std::shared_ptr<VertexAttribute<uint32_t>> chart_ptr,
+                   TutteSolver                               solver,
+                   int                                       max_iter,
+                   T                                         tol)
+        : m_rx(rx),
+          m_chart_ptr(chart_ptr),
+          m_solver(solver),
+          m_num_charts(0),
+          m_has_loops(false),
+          m_is_assembled(false),
+          m_L(rx),
+          m_B(rx, rx.get_num_vertices(), 2),
+          m_X(rx, rx.get_num_vertices(), 2)
+    {
+        if (m_chart_ptr) {
+            m_chart = *m_chart_ptr;
+        }
+        m_fixed = rx.add_vertex_attribute<bool>("tutteFixed", 1);
+        m_next  = rx.add_vertex_attribute<uint32_t>("tutteNext", 1);
+
+        if (m_solver == TutteSolver::Cholesky) {
+            m_chol = std::make_unique<CholeskySolver<SparseMatrix<T>>>(&m_L);
+        } else {
+            m_pcg = std::make_unique<PCGSolver<T>>(m_L, 2, max_iter, tol);
+        }
+    }
+
+    struct BoundaryLoop
+    {
+        std::vector<VertexHandle> vertices;
+        // the arc length from the first vertex
+        std::vector<T> arc_length;
+        // the total length of the (closed) loop
+        T length = 0;
+    };
+
+    /**
+     * @brief walk the boundary loops on the host (all loops are walked in one
+     * pass) and keep the longest loop of every chart
+     */
+    void find_boundary_loops(const VertexAttribute<T>& coordinates)
+    {
+        find_next_boundary_vertex();
+
+        const uint32_t num_vertices = m_rx.get_num_vertices();
+
+        std::vector<VertexHandle> handles(num_vertices);
+        m_rx.for_each_vertex(HOST, [&](const VertexHandle& vh) {
+            handles[m_rx.linear_id(vh)] = vh;
+        });
+
+        std::vector<BoundaryLoop> chart_loop(m_num_charts);
+        std::vector<uint32_t>     chart_num_loops(m_num_charts, 0);
+        std::vector<bool>         visited(num_vertices, false);
+
+        for (uint32_t v = 0; v < num_vertices; ++v) {
+            if (visited[v] || (*m_next)(handles[v]) == INVALID32) {
+                continue;
+            }
+
+            BoundaryLoop loop;
+
+            uint32_t cur = v;
+            while (cur != INVALID32 && !visited[cur]) {
+                visited[cur] = true;
+
+                const VertexHandle vh = handles[cur];
+                loop.vertices.push_back(vh);
+                loop.arc_length.push_back(loop.length);
+
+                const uint32_t nxt = (*m_next)(vh);
+                if (nxt != INVALID32) {
+                    loop.length +=
+                        glm::distance(coordinates.template to_glm<3>(vh),
+                                      coordinates.template to_glm<3>(
+                                          handles[nxt]));
+                }
+                cur = nxt;
+            }
+
+            const uint32_t c = m_chart(handles[v]);
+            chart_num_loops[c]++;
+            if (loop.length > chart_loop[c].length) {
+                chart_loop[c] = std::move(loop);
+            }
+        }
+
+        m_fixed->reset(false, HOST);
+
+        m_loops.clear();
+        for (uint32_t c = 0; c < m_num_charts; ++c) {
+            if (chart_num_loops[c] == 0) {
+                RXMESH_WARN(
+                    "TutteEmbedding chart {} does not have a boundary loop. "
+                    "Its vertices will be fixed to the origin.",
+                    c);
+            } else if (chart_num_loops[c] > 1) {
+                RXMESH_WARN(
+                    "TutteEmbedding chart {} has {} boundary loops. Only the "
+                    "longest one is mapped to the circle.",
+                    c,
+                    chart_num_loops[c]);
+            }
+            for (const VertexHandle& vh : chart_loop[c].vertices) {
+                (*m_fixed)(vh) = true;
+            }
+            if (!chart_loop[c].vertices.empty()) {
+                m_loops.push_back(std::move(chart_loop[c]));
+            }
+        }
+
+        m_rx.for_each_vertex(HOST, [&](const VertexHandle& vh) {
+            if (chart_num_loops[m_chart(vh)] == 0) {
+                (*m_fixed)(vh) = true;
+            }
+        });
+        m_fixed->move(HOST, DEVICE);
+
+        m_has_loops    = true;
+        m_is_assembled = false;
+    }
+
+    RXMeshStatic&                              m_rx;
+    std::shared_ptr<VertexAttribute<uint32_t>> m_chart_ptr;
+    VertexAttribute<uint32_t>                  m_chart;
+    std::shared_ptr<VertexAttribute<bool>>     m_fixed;
+    std::shared_ptr<VertexAttribute<uint32_t>> m_next;
+    TutteSolver                                m_solver;
+    uint32_t                                   m_num_charts;
+    bool                                       m_has_loops;
+    bool                                       m_is_assembled;
+    std::vector<BoundaryLoop>                  m_loops;
+    SparseMatrix<T>                            m_L;
+    DenseMatrix<T>                             m_B;
+    DenseMatrix<T>                             m_X;
+    std::unique_ptr<CholeskySolver<SparseMatrix<T>>> m_chol;
+    std::unique_ptr<PCGSolver<T>>                    m_pcg;
+};
+
+}  // namespace rxmesh
@@ -1,7 +1,14 @@
 #pragma once
 
 #include <assert.h>
+#include <algorithm>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <type_traits>
 #include <utility>
+#include <vector>
 
 #include "rxmesh/handle.h"
 #include "rxmesh/kernels/attribute.cuh"
@@ -11,7 +18,9 @@
 #include "rxmesh/rxmesh.h"
 #include "rxmesh/types.h"
 #include "rxmesh/util/cuda_query.h"
+#include "rxmesh/util/gds_file.h"
 #include "rxmesh/util/log.h"
+#include "rxmesh/util/out_of_core.h"
 #include "rxmesh/util/util.h"
 
 #include "rxmesh/matrix/dense_matrix.h"
@@ -45,9 +54,33 @@ class AttributeBase
 
     virtual void release(locationT location = LOCATION_ALL) = 0;
 
+    virtual void prefetch(const uint32_t p, cudaStream_t stream) const = 0;
+
     virtual ~AttributeBase() = default;
 };
 
+namespace detail {
+/**
+ * @brief state of the host mirror of an attribute (see
+ * Attribute::mirror_to_host())
+ */
+struct HostMirror
+{
+    // copy of the host pointers (of every patch) on the device
+    uint8_t** d_host_ptr = nullptr;
+    // size of every patch in bytes
+    uint32_t* d_num_bytes = nullptr;
+    // hash of every patch as of the last mirroring
+    uint64_t* d_hash = nullptr;
+    // number of patches transferred by the last mirroring
+    uint32_t* d_num_dirty = nullptr;
+    uint32_t* h_num_dirty = nullptr;
+
+    cudaEvent_t done  = nullptr;
+    bool        force = true;
+};
+}  // namespace detail
+
 /**
  * @brief  Here we manage the attributes on top of the mesh. An attributes is
  * attached to mesh element (e.g., vertices, edges, or faces).
@@ -58,7 +91,11 @@ class AttributeBase
  * way, the user does not have to specify the number of mesh elements or
  * deallocate/release the Attribute (attribute garbage collection is managed by
  * RXMeshStatic)
- * @tparam T type of the attribute
+ * @tparam T type of the attribute. With reduced-precision types (half and
+ * bfloat16), T is only the storage type while to_glm(), to_eigen(),
+ * to_matrix(), and ReduceHandle compute in float (see ComputeType). This
+ * halves the memory and bandwidth of attributes that do not need full
+ * precision
  */
 template <class T, typename HandleT>
 class Attribute : public AttributeBase
@@ -66,9 +103,19 @@ class Attribute : public AttributeBase
     template <typename S, typename H>
     friend class ReduceHandle;
 
+    template <typename S, typename H>
+    friend class MultiGPUAttribute;
+
+    template <typename S, typename H>
+    friend class DistributedAttribute;
+
+    template <class S, typename H>
+    friend class Attribute;
+
    public:
     using HandleType = HandleT;
     using Type       = T;
+    using ComputeT   = compute_t<T>;
 
     /**
      * @brief Default constructor which initializes all pointers to nullptr
@@ -80,13 +127,20 @@ class Attribute : public AttributeBase
           m_d_patches_info(nullptr),
           m_name(nullptr),
           m_num_attributes(0),
+          m_num_samples(1),
           m_allocated(LOCATION_NONE),
           m_h_attr(nullptr),
           m_h_ptr_on_device(nullptr),
           m_d_attr(nullptr),
           m_max_num_patches(0),
           m_layout(AoS),
-          m_memory_mega_bytes(0)
+          m_memory_mega_bytes(0),
+          m_h_pinned(nullptr),
+          m_host_mirror(nullptr),
+          m_view_pitch_x(0),
+          m_view_pitch_y(0),
+          m_view_d_base(nullptr),
+          m_view_h_base(nullptr)
     {
 
         this->m_name    = (char*)malloc(sizeof(char) * 1);
@@ -113,13 +167,20 @@ class Attribute : public AttributeBase
           m_d_patches_info(rxmesh->m_d_patches_info),
           m_name(nullptr),
           m_num_attributes(num_attributes),
+          m_num_samples(1),
           m_allocated(LOCATION_NONE),
           m_h_attr(nullptr),
           m_h_ptr_on_device(nullptr),
           m_d_attr(nullptr),
           m_max_num_patches(rxmesh->get_max_num_patches()),
           m_layout(layout),
-          m_memory_mega_bytes(0)
+          m_memory_mega_bytes(0),
+          m_h_pinned(nullptr),
+          m_host_mirror(nullptr),
+          m_view_pitch_x(0),
+          m_view_pitch_y(0),
+          m_view_d_base(nullptr),
+          m_view_h_base(nullptr)
     {
         if (name != nullptr) {
             this->m_name = (char*)malloc(sizeof(char) * (strlen(name) + 1));
@@ -133,6 +194,98 @@ class Attribute : public AttributeBase
         allocate(location);
     }
 
+    /**
+     * @brief Non-owning view over a user-owned buffer that stores the
+     * attributes in linear_id() order i.e., the attribute j of the mesh
+     * element with linear id i is stored at ptr[i * pitch_x + j * pitch_y].
+     * For example, a column-major DenseMatrix has pitch_x = 1 and pitch_y =
+     * number of rows. d_ptr or h_ptr could be nullptr if the buffer does not
+     * exist on the device/host. The view assumes that the owned elements of
+     * every patch are numbered first (i.e., the topology has not been
+     * modified) and only owned elements (i.e., handles returned by for_each
+     * and queries) can be accessed. The buffer is not freed when the view is
+     * released and the view can not be moved or copied into (move the buffer
+     * instead). Use RXMeshStatic::add_attribute_view() instead of calling this
+     * constructor directly
+     */
+    explicit Attribute(const char*    name,
+                       const uint32_t num_attributes,
+                       T*             d_ptr,
+                       T*             h_ptr,
+                       const uint32_t pitch_x,
+                       const uint32_t pitch_y,
+                       RXMeshStatic*  rxmesh)
+        : Attribute(name,
+                    num_attributes,
+                    LOCATION_NONE,
+                    (pitch_x == 1 && num_attributes > 1) ? SoA : AoS,
+                    rxmesh)
+    {
+        assert(pitch_x > 0 && pitch_y > 0);
+
+        m_view_pitch_x = pitch_x;
+        m_view_pitch_y = pitch_y;
+        m_view_d_base  = d_ptr;
+        m_view_h_base  = h_ptr;
+
+        const uint32_t* prefix = nullptr;
+        if constexpr (std::is_same_v<HandleT, VertexHandle>) {
+            prefix = m_rxmesh->m_h_vertex_prefix;
+        }
+        if constexpr (std::is_same_v<HandleT, EdgeHandle>) {
+            prefix = m_rxmesh->m_h_edge_prefix;
+        }
+        if constexpr (std::is_same_v<HandleT, FaceHandle>) {
+            prefix = m_rxmesh->m_h_face_prefix;
+        }
+
+        // owned elements should be numbered first
+        for (uint32_t p = 0; p < m_rxmesh->get_num_patches(); ++p) {
+            const uint32_t num_owned = prefix[p + 1] - prefix[p];
+            for (uint16_t i = 0; i < num_owned; ++i) {
+                using LocalT = typename HandleT::LocalT;
+                if (!m_h_patches_info[p].is_owned(LocalT(i)) ||
+                    m_h_patches_info[p].is_deleted(LocalT(i))) {
+                    RXMESH_ERROR(
+                        "Attribute::Attribute() can not create a view since "
+                        "the owned elements of patch {} are not numbered "
+                        "first",
+                        p);
+                    return;
+                }
+            }
+        }
+
+        if (h_ptr != nullptr) {
+            m_h_attr =
+                static_cast<T**>(malloc(sizeof(T*) * m_max_num_patches));
+            for (uint32_t p = 0; p < m_max_num_patches; ++p) {
+                m_h_attr[p] = (p < m_rxmesh->get_num_patches()) ?
+                                  h_ptr + size_t(prefix[p]) * pitch_x :
+                                  nullptr;
+            }
+            m_allocated = m_allocated | HOST;
+        }
+
+        if (d_ptr != nullptr) {
+            m_h_ptr_on_device =
+                static_cast<T**>(malloc(sizeof(T*) * m_max_num_patches));
+            for (uint32_t p = 0; p < m_max_num_patches; ++p) {
+                m_h_ptr_on_device[p] = (p < m_rxmesh->get_num_patches()) ?
+                                           d_ptr + size_t(prefix[p]) * pitch_x :
+                                           nullptr;
+            }
+            CUDA_ERROR(tracked_malloc((void**)&m_d_attr,
+                                      sizeof(T*) * m_max_num_patches,
+                                      MemoryCategory::Attribute));
+            CUDA_ERROR(cudaMemcpy(m_d_attr,
+                                  m_h_ptr_on_device,
+                                  sizeof(T*) * m_max_num_patches,
+                                  cudaMemcpyHostToDevice));
+            m_allocated = m_allocated | DEVICE;
+        }
+    }
+
 
     T& operator()(size_t i, size_t j = 0)
     {
@@ -190,15 +343,15 @@ class Attribute : public AttributeBase
      * rows represent the number of mesh elements of this attribute and number
      * of columns is the number of attributes
      */
-    std::shared_ptr<DenseMatrix<T>> to_matrix() const
+    std::shared_ptr<DenseMatrix<ComputeT>> to_matrix() const
     {
-        std::shared_ptr<DenseMatrix<T>> mat =
-            std::make_shared<DenseMatrix<T>>(*m_rxmesh, rows(), cols());
+        std::shared_ptr<DenseMatrix<ComputeT>> mat =
+            std::make_shared<DenseMatrix<ComputeT>>(*m_rxmesh, rows(), cols());
 
         if constexpr (std::is_same_v<HandleT, VertexHandle>) {
             m_rxmesh->for_each_vertex(HOST, [&](const VertexHandle vh) {
                 for (uint32_t j = 0; j < cols(); ++j) {
-                    (*mat)(vh, j) = this->operator()(vh, j);
+                    (*mat)(vh, j) = ComputeT(this->operator()(vh, j));
                 }
             });
         }
@@ -206,7 +359,7 @@ class Attribute : public AttributeBase
         if constexpr (std::is_same_v<HandleT, EdgeHandle>) {
             m_rxmesh->for_each_edge(HOST, [&](const EdgeHandle eh) {
                 for (uint32_t j = 0; j < cols(); ++j) {
-                    (*mat)(eh, j) = this->operator()(eh, j);
+                    (*mat)(eh, j) = ComputeT(this->operator()(eh, j));
                 }
             });
         }
@@ -214,7 +367,7 @@ class Attribute : public AttributeBase
         if constexpr (std::is_same_v<HandleT, FaceHandle>) {
             m_rxmesh->for_each_face(HOST, [&](const FaceHandle fh) {
                 for (uint32_t j = 0; j < cols(); ++j) {
-                    (*mat)(fh, j) = this->operator()(fh, j);
+                    (*mat)(fh, j) = ComputeT(this->operator()(fh, j));
                 }
             });
         }
@@ -230,7 +383,7 @@ class Attribute : public AttributeBase
      * attribute on the host side
      * @param mat
      */
-    void from_matrix(DenseMatrix<T>* mat)
+    void from_matrix(DenseMatrix<ComputeT>* mat)
     {
         assert(mat->rows() == rows());
         assert(mat->cols() == cols());
@@ -239,7 +392,7 @@ class Attribute : public AttributeBase
         if constexpr (std::is_same_v<HandleT, VertexHandle>) {
             m_rxmesh->for_each_vertex(HOST, [&](const VertexHandle vh) {
                 for (uint32_t j = 0; j < cols(); ++j) {
-                    this->operator()(vh, j) = (*mat)(vh, j);
+                    this->operator()(vh, j) = T((*mat)(vh, j));
                 }
             });
         }
@@ -247,7 +400,7 @@ class Attribute : public AttributeBase
         if constexpr (std::is_same_v<HandleT, EdgeHandle>) {
             m_rxmesh->for_each_edge(HOST, [&](const EdgeHandle eh) {
                 for (uint32_t j = 0; j < cols(); ++j) {
-                    this->operator()(eh, j) = (*mat)(eh, j);
+                    this->operator()(eh, j) = T((*mat)(eh, j));
                 }
             });
         }
@@ -255,7 +408,7 @@ class Attribute : public AttributeBase
         if constexpr (std::is_same_v<HandleT, FaceHandle>) {
             m_rxmesh->for_each_face(HOST, [&](const FaceHandle fh) {
                 for (uint32_t j = 0; j < cols(); ++j) {
-                    this->operator()(fh, j) = (*mat)(fh, j);
+                    this->operator()(fh, j) = T((*mat)(fh, j));
                 }
             });
         }
@@ -304,14 +457,102 @@ class Attribute : public AttributeBase
 
     __host__ __device__ __forceinline__ uint32_t pitch_x() const
     {
-
-        return (m_layout == AoS) ? m_num_attributes : 1;
+        if (m_view_pitch_x != 0) {
+            return m_view_pitch_x;
+        }
+        return (m_layout == SoA) ? 1 : get_num_stored_attributes();
     }
 
     __host__ __device__ __forceinline__ uint32_t pitch_y(const uint32_t p) const
     {
+        if (m_view_pitch_y != 0) {
+            return m_view_pitch_y;
+        }
+        return (m_layout == SoA) ? capacity(p) : 1;
+    }
 
-        return (m_layout == AoS) ? 1 : capacity(p);
+    /**
+     * @brief check if this attribute is a non-owning view over a user buffer
+     */
+    __host__ __device__ __forceinline__ bool is_view() const
+    {
+        return m_view_pitch_x != 0;
+    }
+
+    /**
+     * @brief the user buffer of a view (see is_view()) on the given location.
+     * nullptr if this is not a view or the buffer does not exist there
+     */
+    __host__ T* get_view_data(locationT location = DEVICE) const
+    {
+        return (location == DEVICE) ? m_view_d_base : m_view_h_base;
+    }
+
+    /**
+     * @brief the stride between two consecutive mesh elements of a view
+     */
+    __host__ uint32_t get_view_pitch_x() const
+    {
+        return m_view_pitch_x;
+    }
+
+    /**
+     * @brief the stride between two consecutive attributes of a view
+     */
+    __host__ uint32_t get_view_pitch_y() const
+    {
+        return m_view_pitch_y;
+    }
+
+    /**
+     * @brief number of elements of patch p that can be accessed i.e., the
+     * patch capacity or, for views, the number of owned elements
+     */
+    __host__ __device__ __forceinline__ uint32_t
+    num_accessible(const uint32_t p) const
+    {
+        if (is_view()) {
+            return get_patch_info(p).template get_num_owned<HandleT>();
+        }
+        return capacity(p);
+    }
+
+    /**
+     * @brief a DenseMatrix sharing the memory of this view. Order should match
+     * the pitch of the view i.e., ColMajor for pitch_x = 1 and pitch_y =
+     * rows() and RowMajor for pitch_x = cols() and pitch_y = 1. Only valid for
+     * views (see is_view())
+     */
+    template <int Order = Eigen::ColMajor>
+    std::shared_ptr<DenseMatrix<T, Order>> as_matrix() const
+    {
+        const bool col_major = m_view_pitch_x == 1 && m_view_pitch_y == rows();
+        const bool row_major = m_view_pitch_x == cols() && m_view_pitch_y == 1;
+
+        if (!is_view() || (Order == Eigen::ColMajor && !col_major) ||
+            (Order == Eigen::RowMajor && !row_major)) {
+            RXMESH_ERROR(
+                "Attribute::as_matrix() the attribute is not a view or its "
+                "pitch does not match the matrix order");
+            return nullptr;
+        }
+
+        return std::make_shared<DenseMatrix<T, Order>>(
+            *m_rxmesh, rows(), cols(), m_view_d_base, m_view_h_base);
+    }
+
+    /**
+     * @brief the number of attributes stored per mesh element. This is the
+     * same as get_num_attributes() except for AoSPadded layout where it is
+     * padded to the next power of two (if get_num_attributes() <= 4)
+     */
+    __host__ __device__ __forceinline__ uint32_t
+    get_num_stored_attributes() const
+    {
+        if (m_layout == AoSPadded && m_num_attributes == 3) {
+            return 4;
+        }
+        return m_num_attributes;
     }
 
     Attribute(const Attribute& rhs) = default;
@@ -334,6 +575,20 @@ class Attribute : public AttributeBase
         return m_memory_mega_bytes;
     }
 
+    /**
+     * @brief asynchronously migrate the attribute of patch p to the device
+     * ahead of its use. This is only effective if RXMesh is compiled with
+     * USE_OUT_OF_CORE (see device_malloc()), otherwise it is a no-op
+     */
+    void prefetch(const uint32_t p, cudaStream_t stream = NULL) const override
+    {
+        if ((m_allocated & DEVICE) == DEVICE && p < m_max_num_patches &&
+            !is_view()) {
+            prefetch_to_device(
+                m_h_ptr_on_device[p], patch_num_bytes(p), stream);
+        }
+    }
+
     /**
      * @brief get the number of attributes per mesh element
      */
@@ -342,6 +597,49 @@ class Attribute : public AttributeBase
         return this->m_num_attributes;
     }
 
+    /**
+     * @brief get the number of samples of an ensemble attribute (see
+     * set_num_samples()). It is 1 for non-ensemble attributes
+     */
+    __host__ __device__ __forceinline__ uint32_t get_num_samples() const
+    {
+        return this->m_num_samples;
+    }
+
+    /**
+     * @brief get the number of attributes per mesh element of one sample of an
+     * ensemble attribute i.e., get_num_attributes() / get_num_samples()
+     */
+    __host__ __device__ __forceinline__ uint32_t
+    get_num_sample_attributes() const
+    {
+        return this->m_num_attributes / this->m_num_samples;
+    }
+
+    /**
+     * @brief turn this attribute into an ensemble of num_samples instances
+     * (e.g., perturbed copies of the vertex coordinates) over the same mesh
+     * where the attributes of every mesh element are split evenly between the
+     * samples. The attribute j of sample s is stored as the attribute
+     * s * get_num_sample_attributes() + j such that, with AoS layout, all the
+     * samples of the same mesh element are contiguous in memory. All other
+     * operations (e.g., move(), reset(), copy_from()) treat the ensemble as
+     * one attribute with get_num_attributes() attributes. Use
+     * RXMeshStatic::add_ensemble_attribute() instead of calling this directly
+     */
+    __host__ void set_num_samples(const uint32_t num_samples)
+    {
+        if (num_samples == 0 || m_num_attributes % num_samples != 0) {
+            RXMESH_ERROR(
+                "Attribute::set_num_samples() the number of attributes ({}) "
+                "should be a multiple of the number of samples ({})",
+                m_num_attributes,
+                num_samples);
+            return;
+        }
+        m_num_samples = num_samples;
+    }
+
     /**
      * @brief Flag that indicates where the memory is allocated
      */
@@ -400,8 +698,16 @@ class Attribute : public AttributeBase
 #pragma omp parallel for
             for (int p = 0; p < static_cast<int>(m_rxmesh->get_num_patches());
                  ++p) {
-                for (uint32_t e = 0; e < capacity(p); ++e) {
-                    m_h_attr[p][e] = value;
+                if (is_view()) {
+                    for (uint32_t e = 0; e < num_accessible(p); ++e) {
+                        for (uint32_t j = 0; j < m_num_attributes; ++j) {
+                            this->operator()(p, e, j) = value;
+                        }
+                    }
+                } else {
+                    for (size_t e = 0; e < patch_num_elements(p); ++e) {
+                        m_h_attr[p][e] = value;
+                    }
                 }
             }
         }
@@ -420,6 +726,13 @@ class Attribute : public AttributeBase
      */
     void move(locationT source, locationT target, cudaStream_t stream = NULL)
     {
+        if (is_view()) {
+            RXMESH_ERROR(
+                "Attribute::move() can not move a view. Move the viewed "
+                "buffer instead");
+            return;
+        }
+
         if (source == target) {
             RXMESH_WARN(
                 "Attribute::move() source ({}) and target ({}) "
@@ -454,31 +767,424 @@ class Attribute : public AttributeBase
                 CUDA_ERROR(
                     cudaMemcpyAsync(m_h_ptr_on_device[p],
                                     m_h_attr[p],
-                                    sizeof(T) * capacity(p) * m_num_attributes,
+                                    patch_num_bytes(p),
                                     cudaMemcpyHostToDevice,
                                     stream));
             }
         } else if (source == DEVICE && target == HOST) {
+            if (m_host_mirror != nullptr) {
+                mirror_to_host(stream);
+                wait_host_mirror();
+                return;
+            }
             for (uint32_t p = 0; p < m_rxmesh->get_num_patches(); ++p) {
                 CUDA_ERROR(
                     cudaMemcpyAsync(m_h_attr[p],
                                     m_h_ptr_on_device[p],
-                                    sizeof(T) * capacity(p) * m_num_attributes,
+                                    patch_num_bytes(p),
                                     cudaMemcpyDeviceToHost,
                                     stream));
             }
         }
     }
 
+    /**
+     * @brief write the device content of the attribute to a binary stream in
+     * its patch-native layout i.e., patch by patch with the same capacity and
+     * padding as in memory such that it can be restored with
+     * load_checkpoint() into an attribute with the same name, type, layout,
+     * and number of attributes defined on a mesh with the same patch
+     * capacities (see RXMeshDynamic::save_checkpoint()). Patches are staged
+     * through two pinned buffers such that copying a patch to the host
+     * overlaps writing the previous one
+     * @return false if the attribute could not be written
+     */
+    bool save_checkpoint(std::ostream& out, cudaStream_t stream = NULL) const
+    {
+        if ((m_allocated & DEVICE) != DEVICE || is_view()) {
+            RXMESH_ERROR(
+                "Attribute::save_checkpoint() attribute {} should be allocated "
+                "on the device and should not be a view",
+                m_name);
+            return false;
+        }
+
+        const uint32_t num_patches = m_rxmesh->get_num_patches();
+
+        const uint32_t name_len  = static_cast<uint32_t>(std::strlen(m_name));
+        const uint32_t type_size = sizeof(T);
+        const uint32_t layout    = static_cast<uint32_t>(m_layout);
+        out.write(reinterpret_cast<const char*>(&name_len), sizeof(uint32_t));
+        out.write(m_name, name_len);
+        out.write(reinterpret_cast<const char*>(&type_size), sizeof(uint32_t));
+        out.write(reinterpret_cast<const char*>(&layout), sizeof(uint32_t));
+        out.write(reinterpret_cast<const char*>(&m_num_attributes),
+                  sizeof(uint32_t));
+        out.write(reinterpret_cast<const char*>(&num_patches),
+                  sizeof(uint32_t));
+
+        return stage_checkpoint(
+            num_patches, stream, [&](uint32_t p, uint8_t* staging) {
+                const uint64_t num_bytes = patch_num_bytes(p);
+                out.write(reinterpret_cast<const char*>(&num_bytes),
+                          sizeof(uint64_t));
+                out.write(reinterpret_cast<const char*>(staging), num_bytes);
+                return out.good();
+            });
+    }
+
+    /**
+     * @brief restore the attribute from a binary stream written by
+     * save_checkpoint(). The device (and the host, if allocated) copy is
+     * updated. The attribute name, type, layout, number of attributes, and
+     * the patch sizes should match the checkpoint
+     * @return false if the stored attribute does not match this attribute,
+     * in which case the stream position is undefined
+     */
+    bool load_checkpoint(std::istream& in, cudaStream_t stream = NULL)
+    {
+        if ((m_allocated & DEVICE) != DEVICE || is_view()) {
+            RXMESH_ERROR(
+                "Attribute::load_checkpoint() attribute {} should be "
+                "allocated on the device and should not be a view",
+                m_name);
+            return false;
+        }
+
+        uint32_t name_len(0), type_size(0), layout(0), num_attributes(0),
+            num_patches(0);
+        in.read(reinterpret_cast<char*>(&name_len), sizeof(uint32_t));
+        std::string name(name_len, ' ');
+        in.read(name.data(), name_len);
+        in.read(reinterpret_cast<char*>(&type_size), sizeof(uint32_t));
+        in.read(reinterpret_cast<char*>(&layout), sizeof(uint32_t));
+        in.read(reinterpret_cast<char*>(&num_attributes), sizeof(uint32_t));
+        in.read(reinterpret_cast<char*>(&num_patches), sizeof(uint32_t));
+
+        if (!in.good() || name != m_name || type_size != sizeof(T) ||
+            layout != static_cast<uint32_t>(m_layout) ||
+            num_attributes != m_num_attributes ||
+            num_patches != m_rxmesh->get_num_patches()) {
+            RXMESH_ERROR(
+                "Attribute::load_checkpoint() the stored attribute {} does "
+                "not match attribute {}",
+                name,
+                m_name);
+            return false;
+        }
+
+        std::vector<uint8_t> patch(0);
+        bool                 ok = true;
+
+        for (uint32_t p = 0; p < num_patches && ok; ++p) {
+            uint64_t num_bytes = 0;
+            in.read(reinterpret_cast<char*>(&num_bytes), sizeof(uint64_t));
+            if (!in.good() || num_bytes != patch_num_bytes(p)) {
+                RXMESH_ERROR(
+                    "Attribute::load_checkpoint() the size of patch {} of "
+                    "attribute {} does not match",
+                    p,
+                    m_name);
+                ok = false;
+                break;
+            }
+            // synchronize before reusing the host buffer
+            CUDA_ERROR(cudaStreamSynchronize(stream));
+            patch.resize(num_bytes);
+            in.read(reinterpret_cast<char*>(patch.data()), num_bytes);
+            ok = in.good();
+
+            CUDA_ERROR(cudaMemcpyAsync(m_h_ptr_on_device[p],
+                                       patch.data(),
+                                       num_bytes,
+                                       cudaMemcpyHostToDevice,
+                                       stream));
+            if ((m_allocated & HOST) == HOST) {
+                std::memcpy(m_h_attr[p], patch.data(), num_bytes);
+            }
+        }
+        CUDA_ERROR(cudaStreamSynchronize(stream));
+
+        return ok;
+    }
+
+    /**
+     * @brief write the device content of the attribute to a GDSFile in the
+     * same format as save_checkpoint(std::ostream&). The patches (along with
+     * their sizes) are packed on the device into batches of up to the file
+     * chunk size such that every batch is a single transfer i.e., a DMA to the
+     * storage with GPUDirect Storage
+     * @return false if the attribute could not be written
+     */
+    bool save_checkpoint(GDSFile& out, cudaStream_t stream = NULL) const
+    {
+        if ((m_allocated & DEVICE) != DEVICE || is_view()) {
+            RXMESH_ERROR(
+                "Attribute::save_checkpoint() attribute {} should be allocated "
+                "on the device and should not be a view",
+                m_name);
+            return false;
+        }
+
+        const uint32_t num_patches = m_rxmesh->get_num_patches();
+
+        const uint32_t name_len  = static_cast<uint32_t>(std::strlen(m_name));
+        const uint32_t type_size = sizeof(T);
+        const uint32_t layout    = static_cast<uint32_t>(m_layout);
+
+        const bool ok = out.write(&name_len, sizeof(uint32_t), HOST) &&
+                        out.write(m_name, name_len, HOST) &&
+                        out.write(&type_size, sizeof(uint32_t), HOST) &&
+                        out.write(&layout, sizeof(uint32_t), HOST) &&
+                        out.write(&m_num_attributes, sizeof(uint32_t), HOST) &&
+                        out.write(&num_patches, sizeof(uint32_t), HOST);
+        if (!ok) {
+            return false;
+        }
+
+        std::vector<uint64_t> sizes;
+
+        return pack_checkpoint(
+            num_patches,
+            out.get_chunk_bytes(),
+            [&](uint32_t begin, uint32_t end, char* d_packed, size_t bytes) {
+                sizes.resize(end - begin);
+                size_t offset = 0;
+                for (uint32_t p = begin; p < end; ++p) {
+                    sizes[p - begin] = patch_num_bytes(p);
+                    CUDA_ERROR(cudaMemcpyAsync(d_packed + offset,
+                                               &sizes[p - begin],
+                                               sizeof(uint64_t),
+                                               cudaMemcpyHostToDevice,
+                                               stream));
+                    offset += sizeof(uint64_t);
+                    CUDA_ERROR(cudaMemcpyAsync(d_packed + offset,
+                                               m_h_ptr_on_device[p],
+                                               patch_num_bytes(p),
+                                               cudaMemcpyDeviceToDevice,
+                                               stream));
+                    offset += patch_num_bytes(p);
+                }
+                return out.write(d_packed, bytes, DEVICE, stream);
+            });
+    }
+
+    /**
+     * @brief restore the attribute from a GDSFile written by
+     * save_checkpoint(GDSFile&) or save_checkpoint(std::ostream&). The
+     * patches are read in batches (see save_checkpoint(GDSFile&)) and
+     * unpacked on the device. The device (and the host, if allocated) copy is
+     * updated
+     * @return false if the stored attribute does not match this attribute,
+     * in which case the attribute content is undefined
+     */
+    bool load_checkpoint(GDSFile& in, cudaStream_t stream = NULL)
+    {
+        if ((m_allocated & DEVICE) != DEVICE || is_view()) {
+            RXMESH_ERROR(
+                "Attribute::load_checkpoint() attribute {} should be "
+                "allocated on the device and should not be a view",
+                m_name);
+            return false;
+        }
+
+        uint32_t name_len(0), type_size(0), layout(0), num_attributes(0),
+            num_patches(0);
+
+        bool        ok = in.read(&name_len, sizeof(uint32_t), HOST);
+        std::string name(ok ? name_len : 0, ' ');
+        ok = ok && in.read(name.data(), name.size(), HOST) &&
+             in.read(&type_size, sizeof(uint32_t), HOST) &&
+             in.read(&layout, sizeof(uint32_t), HOST) &&
+             in.read(&num_attributes, sizeof(uint32_t), HOST) &&
+             in.read(&num_patches, sizeof(uint32_t), HOST);
+
+        if (!ok || name != m_name || type_size != sizeof(T) ||
+            layout != static_cast<uint32_t>(m_layout) ||
+            num_attributes != m_num_attributes ||
+            num_patches != m_rxmesh->get_num_patches()) {
+            RXMESH_ERROR(
+                "Attribute::load_checkpoint() the stored attribute {} does "
+                "not match attribute {}",
+                name,
+                m_name);
+            return false;
+        }
+
+        std::vector<uint64_t> sizes;
+
+        return pack_checkpoint(
+            num_patches,
+            in.get_chunk_bytes(),
+            [&](uint32_t begin, uint32_t end, char* d_packed, size_t bytes) {
+                if (!in.read(d_packed, bytes, DEVICE, stream)) {
+                    return false;
+                }
+                sizes.resize(end - begin);
+                size_t offset = 0;
+                for (uint32_t p = begin; p < end; ++p) {
+                    CUDA_ERROR(cudaMemcpyAsync(&sizes[p - begin],
+                                               d_packed + offset,
+                                               sizeof(uint64_t),
+                                               cudaMemcpyDeviceToHost,
+                                               stream));
+                    offset += sizeof(uint64_t);
+                    CUDA_ERROR(cudaMemcpyAsync(m_h_ptr_on_device[p],
+                                               d_packed + offset,
+                                               patch_num_bytes(p),
+                                               cudaMemcpyDeviceToDevice,
+                                               stream));
+                    if ((m_allocated & HOST) == HOST) {
+                        CUDA_ERROR(cudaMemcpyAsync(m_h_attr[p],
+                                                   d_packed + offset,
+                                                   patch_num_bytes(p),
+                                                   cudaMemcpyDeviceToHost,
+                                                   stream));
+                    }
+                    offset += patch_num_bytes(p);
+                }
+                CUDA_ERROR(cudaStreamSynchronize(stream));
+
+                for (uint32_t p = begin; p < end; ++p) {
+                    if (sizes[p - begin] != patch_num_bytes(p)) {
+                        RXMESH_ERROR(
+                            "Attribute::load_checkpoint() the size of patch "
+                            "{} of attribute {} does not match",
+                            p,
+                            m_name);
+                        return false;
+                    }
+                }
+                return true;
+            });
+    }
+
+    /**
+     * @brief asynchronously mirror the device data to the host transferring
+     * only the patches whose content changed since the last mirroring. On the
+     * first call, the host memory is re-allocated as pinned memory (keeping
+     * its content) and all patches are transferred. Changed patches are
+     * detected by hashing every patch on the device and written directly to
+     * the (mapped) host memory by the same kernel. After the first call,
+     * move(DEVICE, HOST) also goes through the mirror. The host data should
+     * not be read before wait_host_mirror() (or is_host_mirror_done()). Host
+     * writes are not tracked and are overwritten by the next mirroring only
+     * if the patch changed on the device
+     * @param stream to be used to launch the kernel
+     */
+    void mirror_to_host(cudaStream_t stream = NULL)
+    {
+        if (!is_device_allocated() || is_view()) {
+            RXMESH_ERROR(
+                "Attribute::mirror_to_host() the attribute is not allocated "
+                "on the device or is a view");
+            return;
+        }
+
+        if (m_host_mirror == nullptr) {
+            init_host_mirror();
+        }
+
+        const uint32_t num_patches = m_rxmesh->get_num_patches();
+
+        CUDA_ERROR(cudaMemsetAsync(
+            m_host_mirror->d_num_dirty, 0, sizeof(uint32_t), stream));
+
+        if (num_patches > 0) {
+            detail::mirror_dirty_patches<m_block_size>
+                <<<num_patches, m_block_size, 0, stream>>>(
+                    reinterpret_cast<const uint8_t* const*>(m_d_attr),
+                    m_host_mirror->d_host_ptr,
+                    m_host_mirror->d_num_bytes,
+                    m_host_mirror->d_hash,
+                    num_patches,
+                    m_host_mirror->force,
+                    m_host_mirror->d_num_dirty);
+        }
+
+        CUDA_ERROR(cudaMemcpyAsync(m_host_mirror->h_num_dirty,
+                                   m_host_mirror->d_num_dirty,
+                                   sizeof(uint32_t),
+                                   cudaMemcpyDeviceToHost,
+                                   stream));
+
+        CUDA_ERROR(cudaEventRecord(m_host_mirror->done, stream));
+
+        m_host_mirror->force = false;
+    }
+
+    /**
+     * @brief block until the last mirror_to_host() is done
+     */
+    void wait_host_mirror() const
+    {
+        if (m_host_mirror != nullptr) {
+            CUDA_ERROR(cudaEventSynchronize(m_host_mirror->done));
+        }
+    }
+
+    /**
+     * @brief check (without blocking) if the last mirror_to_host() is done
+     */
+    bool is_host_mirror_done() const
+    {
+        if (m_host_mirror == nullptr) {
+            return true;
+        }
+        cudaError_t err = cudaEventQuery(m_host_mirror->done);
+        if (err == cudaErrorNotReady) {
+            return false;
+        }
+        CUDA_ERROR(err);
+        return true;
+    }
+
+    /**
+     * @brief the number of patches transferred by the last mirror_to_host().
+     * Only valid after the mirroring is done
+     */
+    uint32_t get_num_mirrored_patches() const
+    {
+        if (m_host_mirror == nullptr) {
+            return 0;
+        }
+        return m_host_mirror->h_num_dirty[0];
+    }
+
     /**
      * @brief Release allocated memory in certain location
      * @param location where memory will be released
      */
     void release(locationT location = LOCATION_ALL)
     {
+        if (is_view()) {
+            if (((location & HOST) == HOST) && is_host_allocated()) {
+                free(m_h_attr);
+                m_h_attr    = nullptr;
+                m_allocated = m_allocated & (~HOST);
+            }
+            if (((location & DEVICE) == DEVICE) && is_device_allocated()) {
+                free(m_h_ptr_on_device);
+                m_h_ptr_on_device = nullptr;
+                GPU_FREE(m_d_attr);
+                m_allocated = m_allocated & (~DEVICE);
+            }
+            return;
+        }
+
+        if ((location & LOCATION_ALL) != LOCATION_NONE) {
+            release_host_mirror();
+        }
+
         if (((location & HOST) == HOST) && is_host_allocated()) {
-            for (uint32_t p = 0; p < m_rxmesh->get_max_num_patches(); ++p) {
-                free(m_h_attr[p]);
+            if (m_h_pinned != nullptr) {
+                CUDA_ERROR(cudaFreeHost(m_h_pinned));
+                m_h_pinned = nullptr;
+            } else {
+                for (uint32_t p = 0; p < m_rxmesh->get_max_num_patches();
+                     ++p) {
+                    free(m_h_attr[p]);
+                }
             }
             free(m_h_attr);
             m_h_attr    = nullptr;
@@ -486,10 +1192,13 @@ class Attribute : public AttributeBase
         }
 
         if (((location & DEVICE) == DEVICE) && is_device_allocated()) {
+            MemoryPool& pool = m_rxmesh->get_memory_pool();
             for (uint32_t p = 0; p < m_rxmesh->get_max_num_patches(); ++p) {
-                GPU_FREE(m_h_ptr_on_device[p]);
+                pool.deallocate(m_h_ptr_on_device[p]);
+                m_h_ptr_on_device[p] = nullptr;
             }
-            GPU_FREE(m_d_attr);
+            pool.deallocate(m_d_attr);
+            m_d_attr    = nullptr;
             m_allocated = m_allocated & (~DEVICE);
         }
     }
@@ -512,7 +1221,12 @@ class Attribute : public AttributeBase
                    locationT              dst_flag,
                    cudaStream_t           stream = NULL)
     {
-
+        if (is_view() || source.is_view()) {
+            RXMESH_ERROR(
+                "Attribute::copy_from() does not support views. Copy the "
+                "viewed buffer instead");
+            return;
+        }
 
         if (source.m_layout != m_layout) {
             RXMESH_ERROR(
@@ -553,9 +1267,8 @@ class Attribute : public AttributeBase
             }
 
             for (uint32_t p = 0; p < m_rxmesh->get_num_patches(); ++p) {
-                std::memcpy(m_h_attr[p],
-                            source.m_h_attr[p],
-                            sizeof(T) * capacity(p) * m_num_attributes);
+                std::memcpy(
+                    m_h_attr[p], source.m_h_attr[p], patch_num_bytes(p));
             }
         }
 
@@ -579,7 +1292,7 @@ class Attribute : public AttributeBase
                 CUDA_ERROR(
                     cudaMemcpyAsync(m_h_ptr_on_device[p],
                                     source.m_h_ptr_on_device[p],
-                                    sizeof(T) * capacity(p) * m_num_attributes,
+                                    patch_num_bytes(p),
                                     cudaMemcpyDeviceToDevice,
                                     stream));
             }
@@ -606,7 +1319,7 @@ class Attribute : public AttributeBase
                 CUDA_ERROR(
                     cudaMemcpyAsync(m_h_attr[p],
                                     source.m_h_ptr_on_device[p],
-                                    sizeof(T) * capacity(p) * m_num_attributes,
+                                    patch_num_bytes(p),
                                     cudaMemcpyDeviceToHost,
                                     stream));
             }
@@ -633,13 +1346,141 @@ class Attribute : public AttributeBase
                 CUDA_ERROR(
                     cudaMemcpyAsync(m_h_ptr_on_device[p],
                                     source.m_h_attr[p],
-                                    sizeof(T) * capacity(p) * m_num_attributes,
+                                    patch_num_bytes(p),
                                     cudaMemcpyHostToDevice,
                                     stream));
             }
         }
     }
 
+    /**
+     * @brief Deep copy from a source attribute of a different type (e.g., from
+     * Attribute<float> to Attribute<half>) where every value is converted
+     * through the source compute type. The source and destination flags are
+     * the same as the above copy_from(). Copying across locations converts
+     * on the host using a per-patch staging buffer and synchronizes the stream
+     * @param source attribute to copy from
+     * @param source_flag defines where we will copy from
+     * @param dst_flag defines where we will copy to
+     * @param stream used to launch kernel/memcpy
+     */
+    template <typename S, typename = std::enable_if_t<!std::is_same_v<S, T>>>
+    void copy_from(Attribute<S, HandleT>& source,
+                   locationT              source_flag,
+                   locationT              dst_flag,
+                   cudaStream_t           stream = NULL)
+    {
+        if (is_view() || source.is_view()) {
+            RXMESH_ERROR(
+                "Attribute::copy_from() does not support views. Copy the "
+                "viewed buffer instead");
+            return;
+        }
+
+        if (source.get_layout() != m_layout) {
+            RXMESH_ERROR(
+                "Attribute::copy_from() does not support copy from "
+                "source of different layout!");
+        }
+
+        if ((source_flag & LOCATION_ALL) == LOCATION_ALL &&
+            (dst_flag & LOCATION_ALL) != LOCATION_ALL) {
+            RXMESH_ERROR("Attribute::copy_from() Invalid configuration!");
+            return;
+        }
+
+        if (m_num_attributes != source.get_num_attributes()) {
+            RXMESH_ERROR(
+                "Attribute::copy_from() number of attributes is "
+                "different!");
+            return;
+        }
+
+        if (this->is_empty() || m_rxmesh->get_num_patches() == 0) {
+            return;
+        }
+
+        const uint32_t num_patches = m_rxmesh->get_num_patches();
+
+        auto check = [&](locationT src, locationT dst) {
+            if ((src & source.get_allocated()) != src ||
+                (dst & m_allocated) != dst) {
+                RXMESH_ERROR(
+                    "Attribute::copy_from() copying is not valid because "
+                    "the source or the destination is not allocated on {} "
+                    "or {}",
+                    location_to_string(src),
+                    location_to_string(dst));
+                return false;
+            }
+            return true;
+        };
+
+        auto convert = [](T* dst, const S* src, size_t n) {
+            for (size_t i = 0; i < n; ++i) {
+                dst[i] = T(compute_t<S>(src[i]));
+            }
+        };
+
+        // 1) copy from HOST to HOST
+        if ((source_flag & HOST) == HOST && (dst_flag & HOST) == HOST) {
+            if (!check(HOST, HOST)) {
+                return;
+            }
+            for (uint32_t p = 0; p < num_patches; ++p) {
+                convert(m_h_attr[p], source.m_h_attr[p], patch_num_elements(p));
+            }
+        }
+
+        // 2) copy from DEVICE to DEVICE
+        if ((source_flag & DEVICE) == DEVICE && (dst_flag & DEVICE) == DEVICE) {
+            if (!check(DEVICE, DEVICE)) {
+                return;
+            }
+            const int threads = 256;
+            detail::convert_attribute<<<num_patches, threads, 0, stream>>>(
+                *this, source, num_patches, m_num_attributes);
+        }
+
+        // 3) copy from DEVICE to HOST
+        if ((source_flag & DEVICE) == DEVICE && (dst_flag & HOST) == HOST) {
+            if (!check(DEVICE, HOST)) {
+                return;
+            }
+            std::vector<S> staging;
+            for (uint32_t p = 0; p < num_patches; ++p) {
+                const size_t n = patch_num_elements(p);
+                staging.resize(n);
+                CUDA_ERROR(cudaMemcpyAsync(staging.data(),
+                                           source.m_h_ptr_on_device[p],
+                                           sizeof(S) * n,
+                                           cudaMemcpyDeviceToHost,
+                                           stream));
+                CUDA_ERROR(cudaStreamSynchronize(stream));
+                convert(m_h_attr[p], staging.data(), n);
+            }
+        }
+
+        // 4) copy from HOST to DEVICE
+        if ((source_flag & HOST) == HOST && (dst_flag & DEVICE) == DEVICE) {
+            if (!check(HOST, DEVICE)) {
+                return;
+            }
+            std::vector<T> staging;
+            for (uint32_t p = 0; p < num_patches; ++p) {
+                const size_t n = patch_num_elements(p);
+                staging.resize(n);
+                convert(staging.data(), source.m_h_attr[p], n);
+                CUDA_ERROR(cudaMemcpyAsync(m_h_ptr_on_device[p],
+                                           staging.data(),
+                                           sizeof(T) * n,
+                                           cudaMemcpyHostToDevice,
+                                           stream));
+                CUDA_ERROR(cudaStreamSynchronize(stream));
+            }
+        }
+    }
+
     /**
      * @brief Accessing an attribute using a handle to the mesh element
      * @param handle input handle
@@ -654,20 +1495,41 @@ class Attribute : public AttributeBase
         return this->operator()(pl.first, pl.second, attr);
     }
 
+    /**
+     * @brief Accessing an attribute of one sample of an ensemble attribute
+     * (see set_num_samples()) using a handle to the mesh element
+     * @param handle input handle
+     * @param attr the attribute id within the sample
+     * @param sample the sample id
+     * @return const reference to the attribute
+     */
+    __host__ __device__ __forceinline__ T& operator()(
+        const HandleT  handle,
+        const uint32_t attr,
+        const uint32_t sample) const
+    {
+        assert(sample < m_num_samples);
+        assert(attr < get_num_sample_attributes());
+        auto pl = handle.unpack();
+        return this->operator()(
+            pl.first, pl.second, sample * get_num_sample_attributes() + attr);
+    }
+
 
     /**
      * @brief Accessing the attribute a glm vector. This is used for read only
      * since the return result is a copy.
      */
     template <int N>
-    __host__ __device__ __inline__ vec<T, N> to_glm(const HandleT& handle) const
+    __host__ __device__ __inline__ vec<ComputeT, N> to_glm(
+        const HandleT& handle) const
     {
         assert(N <= get_num_attributes());
 
-        vec<T, N> ret;
+        vec<ComputeT, N> ret;
 
         for (int i = 0; i < N; ++i) {
-            ret[i] = this->operator()(handle, i);
+            ret[i] = ComputeT(this->operator()(handle, i));
         }
         return ret;
     }
@@ -677,13 +1539,13 @@ class Attribute : public AttributeBase
      * should match the number of attributes in this attribute
      */
     template <int N>
-    __host__ __device__ __inline__ void from_glm(const HandleT&   handle,
-                                                 const vec<T, N>& in)
+    __host__ __device__ __inline__ void from_glm(const HandleT&          handle,
+                                                 const vec<ComputeT, N>& in)
     {
         assert(N <= get_num_attributes());
 
         for (int i = 0; i < N; ++i) {
-            this->operator()(handle, i) = in[i];
+            this->operator()(handle, i) = T(in[i]);
         }
     }
 
@@ -692,15 +1554,15 @@ class Attribute : public AttributeBase
      * since the return result is a copy.
      */
     template <int N>
-    __host__ __device__ __inline__ Eigen::Matrix<T, N, 1> to_eigen(
+    __host__ __device__ __inline__ Eigen::Matrix<ComputeT, N, 1> to_eigen(
         const HandleT& handle) const
     {
         assert(N <= get_num_attributes());
 
-        Eigen::Matrix<T, N, 1> ret;
+        Eigen::Matrix<ComputeT, N, 1> ret;
 
         for (Eigen::Index i = 0; i < N; ++i) {
-            ret[i] = this->operator()(handle, i);
+            ret[i] = ComputeT(this->operator()(handle, i));
         }
         return ret;
     }
@@ -712,14 +1574,81 @@ class Attribute : public AttributeBase
      */
     template <int N>
     __host__ __device__ __inline__ void from_eigen(
-        const HandleT&                handle,
-        const Eigen::Matrix<T, N, 1>& in)
+        const HandleT&                       handle,
+        const Eigen::Matrix<ComputeT, N, 1>& in)
     {
         assert(N <= get_num_attributes());
 
         for (Eigen::Index i = 0; i < N; ++i) {
-            this->operator()(handle, i) = in[i];
+            this->operator()(handle, i) = T(in[i]);
+        }
+    }
+
+    /**
+     * @brief same as to_glm() but for AoSPadded layout, the attributes are
+     * loaded with a single 8- or 16-byte load (when sizeof(T) times N padded
+     * to the next power of two is 8 or 16). Otherwise, it falls back to
+     * to_glm()
+     */
+    template <int N>
+    __host__ __device__ __forceinline__ vec<ComputeT, N> load(
+        const HandleT& handle) const
+    {
+        assert(N <= get_num_attributes());
+
+        constexpr int    NP    = (N == 3) ? 4 : N;
+        constexpr size_t bytes = sizeof(T) * NP;
+
+        if constexpr (bytes == 8 || bytes == 16) {
+            if (m_layout == AoSPadded) {
+                using VecT = std::conditional_t<bytes == 16, uint4, uint2>;
+
+                const VecT raw =
+                    *reinterpret_cast<const VecT*>(&this->operator()(handle));
+                const T* val = reinterpret_cast<const T*>(&raw);
+
+                vec<ComputeT, N> ret;
+                for (int i = 0; i < N; ++i) {
+                    ret[i] = ComputeT(val[i]);
+                }
+                return ret;
+            }
+        }
+        return to_glm<N>(handle);
+    }
+
+    /**
+     * @brief same as from_glm() but for AoSPadded layout where N is the number
+     * of attributes, the attributes (and the padding) are stored with a single
+     * 8- or 16-byte store (see load()). Otherwise, it falls back to from_glm()
+     */
+    template <int N>
+    __host__ __device__ __forceinline__ void store(
+        const HandleT&          handle,
+        const vec<ComputeT, N>& in)
+    {
+        assert(N <= get_num_attributes());
+
+        constexpr int    NP    = (N == 3) ? 4 : N;
+        constexpr size_t bytes = sizeof(T) * NP;
+
+        if constexpr (bytes == 8 || bytes == 16) {
+            if (m_layout == AoSPadded && N == get_num_attributes()) {
+                using VecT = std::conditional_t<bytes == 16, uint4, uint2>;
+
+                VecT raw;
+                T*   val = reinterpret_cast<T*>(&raw);
+                for (int i = 0; i < N; ++i) {
+                    val[i] = T(in[i]);
+                }
+                for (int i = N; i < NP; ++i) {
+                    val[i] = T(0);
+                }
+                *reinterpret_cast<VecT*>(&this->operator()(handle)) = raw;
+                return;
+            }
         }
+        from_glm<N>(handle, in);
     }
 
     /**
@@ -735,6 +1664,26 @@ class Attribute : public AttributeBase
         return this->operator()(pl.first, pl.second, attr);
     }
 
+    /**
+     * @brief Accessing an attribute of one sample of an ensemble attribute
+     * (see set_num_samples()) using a handle to the mesh element
+     * @param handle input handle
+     * @param attr the attribute id within the sample
+     * @param sample the sample id
+     * @return non-const reference to the attribute
+     */
+    __host__ __device__ __forceinline__ T& operator()(
+        const HandleT  handle,
+        const uint32_t attr,
+        const uint32_t sample)
+    {
+        assert(sample < m_num_samples);
+        assert(attr < get_num_sample_attributes());
+        auto pl = handle.unpack();
+        return this->operator()(
+            pl.first, pl.second, sample * get_num_sample_attributes() + attr);
+    }
+
     /**
      * @brief Access the attribute value using patch and local index in the
      * patch. This is meant to be used by XXAttribute not directly by the user
@@ -793,6 +1742,121 @@ class Attribute : public AttributeBase
 
 
    protected:
+    /**
+     * @brief copy the first num_patches patches from the device to the host
+     * through two pinned staging buffers and call write_fn(p, staging) for
+     * every patch while the next patch is being copied
+     */
+    template <typename WriteFnT>
+    bool stage_checkpoint(const uint32_t num_patches,
+                          cudaStream_t   stream,
+                          WriteFnT       write_fn) const
+    {
+        if (num_patches == 0) {
+            return true;
+        }
+
+        size_t max_bytes = 0;
+        for (uint32_t p = 0; p < num_patches; ++p) {
+            max_bytes = std::max(max_bytes, patch_num_bytes(p));
+        }
+
+        uint8_t* h_staging = nullptr;
+        CUDA_ERROR(cudaMallocHost((void**)&h_staging, 2 * max_bytes));
+
+        cudaEvent_t copied[2];
+        for (int i = 0; i < 2; ++i) {
+            CUDA_ERROR(
+                cudaEventCreateWithFlags(&copied[i], cudaEventDisableTiming));
+        }
+
+        auto issue = [&](uint32_t p) {
+            CUDA_ERROR(cudaMemcpyAsync(h_staging + (p % 2) * max_bytes,
+                                       m_h_ptr_on_device[p],
+                                       patch_num_bytes(p),
+                                       cudaMemcpyDeviceToHost,
+                                       stream));
+            CUDA_ERROR(cudaEventRecord(copied[p % 2], stream));
+        };
+
+        bool ok = true;
+
+        issue(0);
+        for (uint32_t p = 0; p < num_patches && ok; ++p) {
+            if (p + 1 < num_patches) {
+                issue(p + 1);
+            }
+            CUDA_ERROR(cudaEventSynchronize(copied[p % 2]));
+            ok = write_fn(p, h_staging + (p % 2) * max_bytes);
+        }
+
+        CUDA_ERROR(cudaStreamSynchronize(stream));
+        CUDA_ERROR(cudaEventDestroy(copied[0]));
+        CUDA_ERROR(cudaEventDestroy(copied[1]));
+        CUDA_ERROR(cudaFreeHost(h_staging));
+
+        return ok;
+    }
+
+    /**
+     * @brief split the first num_patches patches into consecutive batches of
+     * up to max_bytes (a patch larger than max_bytes is a batch by itself)
+     * where every patch is stored as its size (uint64_t) followed by its
+     * values. batch_fn(begin, end, d_packed, num_bytes) is called for every
+     * batch [begin, end) with a device buffer large enough for the batch
+     */
+    template <typename BatchFnT>
+    bool pack_checkpoint(const uint32_t num_patches,
+                         const size_t   max_bytes,
+                         BatchFnT       batch_fn) const
+    {
+        auto record_bytes = [&](uint32_t p) {
+            return sizeof(uint64_t) + patch_num_bytes(p);
+        };
+
+        size_t buffer_bytes = max_bytes;
+        for (uint32_t p = 0; p < num_patches; ++p) {
+            buffer_bytes = std::max(buffer_bytes, record_bytes(p));
+        }
+
+        char* d_packed = nullptr;
+        CUDA_ERROR(tracked_malloc(
+            (void**)&d_packed, buffer_bytes, MemoryCategory::Other));
+
+        bool     ok    = true;
+        uint32_t begin = 0;
+        while (begin < num_patches && ok) {
+            size_t   num_bytes = record_bytes(begin);
+            uint32_t end       = begin + 1;
+            while (end < num_patches &&
+                   num_bytes + record_bytes(end) <= max_bytes) {
+                num_bytes += record_bytes(end);
+                ++end;
+            }
+            ok    = batch_fn(begin, end, d_packed, num_bytes);
+            begin = end;
+        }
+
+        GPU_FREE(d_packed);
+        return ok;
+    }
+
+    /**
+     * @brief the number of stored values (including padding) of patch p
+     */
+    size_t patch_num_elements(const uint32_t p) const
+    {
+        return size_t(capacity(p)) * get_num_stored_attributes();
+    }
+
+    /**
+     * @brief the number of bytes allocated for patch p
+     */
+    size_t patch_num_bytes(const uint32_t p) const
+    {
+        return sizeof(T) * patch_num_elements(p);
+    }
+
     /**
      * @brief allocate internal memory
      */
@@ -807,8 +1871,7 @@ class Attribute : public AttributeBase
                     static_cast<T**>(malloc(sizeof(T*) * m_max_num_patches));
 
                 for (uint32_t p = 0; p < m_max_num_patches; ++p) {
-                    m_h_attr[p] = static_cast<T*>(
-                        malloc(sizeof(T) * capacity(p) * m_num_attributes));
+                    m_h_attr[p] = static_cast<T*>(malloc(patch_num_bytes(p)));
                 }
 
                 m_allocated = m_allocated | HOST;
@@ -818,8 +1881,10 @@ class Attribute : public AttributeBase
                 release(DEVICE);
 
 
-                CUDA_ERROR(cudaMalloc((void**)&(m_d_attr),
-                                      sizeof(T*) * m_max_num_patches));
+                MemoryPool& pool = m_rxmesh->get_memory_pool();
+
+                CUDA_ERROR(pool.allocate((void**)&(m_d_attr),
+                                        sizeof(T*) * m_max_num_patches));
                 m_memory_mega_bytes +=
                     BYTES_TO_MEGABYTES(sizeof(T*) * m_max_num_patches);
 
@@ -827,12 +1892,11 @@ class Attribute : public AttributeBase
                     static_cast<T**>(malloc(sizeof(T*) * m_max_num_patches));
 
                 for (uint32_t p = 0; p < m_max_num_patches; ++p) {
-                    CUDA_ERROR(
-                        cudaMalloc((void**)&(m_h_ptr_on_device[p]),
-                                   sizeof(T) * capacity(p) * m_num_attributes));
+                    CUDA_ERROR(pool.allocate((void**)&(m_h_ptr_on_device[p]),
+                                            patch_num_bytes(p)));
 
-                    m_memory_mega_bytes += BYTES_TO_MEGABYTES(
-                        sizeof(T) * capacity(p) * m_num_attributes);
+                    m_memory_mega_bytes +=
+                        BYTES_TO_MEGABYTES(patch_num_bytes(p));
                 }
                 CUDA_ERROR(cudaMemcpy(m_d_attr,
                                       m_h_ptr_on_device,
@@ -843,11 +1907,99 @@ class Attribute : public AttributeBase
         }
     }
 
+    /**
+     * @brief move the host memory to a single pinned allocation (allocating
+     * the host if needed) and allocate the state needed by mirror_to_host()
+     */
+    void init_host_mirror()
+    {
+        // start each patch at 16-byte boundary
+        std::vector<size_t> offset(m_max_num_patches + 1, 0);
+        for (uint32_t p = 0; p < m_max_num_patches; ++p) {
+            offset[p + 1] = offset[p] + DIVIDE_UP(patch_num_bytes(p), 16) * 16;
+        }
+
+        uint8_t* pinned = nullptr;
+        CUDA_ERROR(cudaMallocHost((void**)&pinned,
+                                  std::max(offset.back(), size_t(16))));
+
+        const bool had_host = is_host_allocated();
+
+        T** h_attr = static_cast<T**>(malloc(sizeof(T*) * m_max_num_patches));
+        for (uint32_t p = 0; p < m_max_num_patches; ++p) {
+            h_attr[p] = reinterpret_cast<T*>(pinned + offset[p]);
+            if (had_host) {
+                std::memcpy(h_attr[p], m_h_attr[p], patch_num_bytes(p));
+            }
+        }
+
+        release(HOST);
+
+        m_h_attr    = h_attr;
+        m_h_pinned  = pinned;
+        m_allocated = m_allocated | HOST;
+
+        std::vector<uint32_t> num_bytes(m_max_num_patches);
+        for (uint32_t p = 0; p < m_max_num_patches; ++p) {
+            num_bytes[p] = patch_num_bytes(p);
+        }
+
+        m_host_mirror = new detail::HostMirror();
+
+        CUDA_ERROR(tracked_malloc((void**)&m_host_mirror->d_host_ptr,
+                                  sizeof(uint8_t*) * m_max_num_patches,
+                                  MemoryCategory::Attribute));
+        CUDA_ERROR(tracked_malloc((void**)&m_host_mirror->d_num_bytes,
+                                  sizeof(uint32_t) * m_max_num_patches,
+                                  MemoryCategory::Attribute));
+        CUDA_ERROR(tracked_malloc((void**)&m_host_mirror->d_hash,
+                                  sizeof(uint64_t) * m_max_num_patches,
+                                  MemoryCategory::Attribute));
+        CUDA_ERROR(tracked_malloc((void**)&m_host_mirror->d_num_dirty,
+                                  sizeof(uint32_t),
+                                  MemoryCategory::Attribute));
+        CUDA_ERROR(cudaMallocHost((void**)&m_host_mirror->h_num_dirty,
+                                  sizeof(uint32_t)));
+        CUDA_ERROR(cudaEventCreateWithFlags(&m_host_mirror->done,
+                                            cudaEventDisableTiming));
+
+        m_host_mirror->h_num_dirty[0] = 0;
+
+        CUDA_ERROR(cudaMemcpy(m_host_mirror->d_host_ptr,
+                              m_h_attr,
+                              sizeof(uint8_t*) * m_max_num_patches,
+                              cudaMemcpyHostToDevice));
+        CUDA_ERROR(cudaMemcpy(m_host_mirror->d_num_bytes,
+                              num_bytes.data(),
+                              sizeof(uint32_t) * m_max_num_patches,
+                              cudaMemcpyHostToDevice));
+    }
+
+    /**
+     * @brief release the state allocated by init_host_mirror(). The host
+     * memory stays pinned until it is released
+     */
+    void release_host_mirror()
+    {
+        if (m_host_mirror != nullptr) {
+            CUDA_ERROR(cudaEventSynchronize(m_host_mirror->done));
+            CUDA_ERROR(cudaEventDestroy(m_host_mirror->done));
+            GPU_FREE(m_host_mirror->d_host_ptr);
+            GPU_FREE(m_host_mirror->d_num_bytes);
+            GPU_FREE(m_host_mirror->d_hash);
+            GPU_FREE(m_host_mirror->d_num_dirty);
+            CUDA_ERROR(cudaFreeHost(m_host_mirror->h_num_dirty));
+            delete m_host_mirror;
+            m_host_mirror = nullptr;
+        }
+    }
+
     RXMeshStatic*    m_rxmesh;
     const PatchInfo* m_h_patches_info;
     const PatchInfo* m_d_patches_info;
     char*            m_name;
     uint32_t         m_num_attributes;
+    uint32_t         m_num_samples;
     locationT        m_allocated;
     T**              m_h_attr;
     T**              m_h_ptr_on_device;
@@ -856,6 +2008,16 @@ class Attribute : public AttributeBase
     layoutT          m_layout;
     double           m_memory_mega_bytes;
 
+    // pinned host memory of all patches (if the host is mirrored)
+    uint8_t*            m_h_pinned;
+    detail::HostMirror* m_host_mirror;
+
+    // pitches and buffers if this attribute is a view (see is_view())
+    uint32_t m_view_pitch_x;
+    uint32_t m_view_pitch_y;
+    T*       m_view_d_base;
+    T*       m_view_h_base;
+
     constexpr static uint32_t m_block_size = 256;
 };
 
@@ -944,6 +2106,28 @@ class AttributeContainer
         return new_attr;
     }
 
+    /**
+     * @brief add a new attribute constructed from name and args (e.g., a view
+     * over a user buffer) to be managed by this container
+     */
+    template <typename AttrT, typename... ArgsT>
+    std::shared_ptr<AttrT> emplace(const char* name, ArgsT&&... args)
+    {
+        if (does_exist(name)) {
+            RXMESH_WARN(
+                "AttributeContainer::emplace() adding an attribute with "
+                "name {} already exists!",
+                std::string(name));
+        }
+
+        auto new_attr =
+            std::make_shared<AttrT>(name, std::forward<ArgsT>(args)...);
+        m_attr_container.push_back(
+            std::dynamic_pointer_cast<AttributeBase>(new_attr));
+
+        return new_attr;
+    }
+
     /**
      * @brief Check if an attribute exists
      * @param name of the attribute
@@ -975,6 +2159,17 @@ class AttributeContainer
         }
     }
 
+    /**
+     * @brief migrate patch p of all attributes managed by this container to
+     * the device (see Attribute::prefetch())
+     */
+    void prefetch(const uint32_t p, cudaStream_t stream = NULL) const
+    {
+        for (const auto& attr : m_attr_container) {
+            attr->prefetch(p, stream);
+        }
+    }
+
    private:
     std::vector<std::shared_ptr<AttributeBase>> m_attr_container;
 };
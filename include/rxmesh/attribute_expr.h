@@ -0,0 +1,438 @@
+#pragma once
+
+#include <stdint.h>
+#include <type_traits>
+
+#include <cub/block/block_reduce.cuh>
+
+#include "rxmesh/attribute.h"
+#include "rxmesh/rxmesh.h"
+#include "rxmesh/util/macros.h"
+
+namespace rxmesh {
+
+/**
+ * @brief Expression templates for element-wise linear algebra on attributes.
+ * An expression is built from attribute terminals (see expr()), host scalars,
+ * and device-resident scalars (see device_scalar()) combined with +, -, and *
+ * (element-wise). Nothing is computed when the expression is built. Instead,
+ * one or more assignments (see assign()) are evaluated together by a single
+ * kernel (see evaluate() and ReduceHandle::evaluate_dot_async()) that reads
+ * every attribute once per element and may also accumulate a dot product of
+ * the updated values. For example, the CG update
+ *      x = x + alpha * p;  r = r - alpha * s;  delta = <r, r>
+ * becomes one kernel and one second-stage reduction instead of three kernels
+ * and a reduction:
+ *      auto X = expr(x), P = expr(p), R = expr(r), S = expr(s);
+ *      reduce_handle.evaluate_dot_async(R, R, d_delta, stream,
+ *                                       assign(x, X + alpha * P),
+ *                                       assign(r, R - alpha * S));
+ * Expressions are evaluated on owned and active elements only. Since all
+ * operations are element-wise, a destination may also appear on the right
+ * hand side of its own (or a later) assignment. A DenseMatrix can be used in
+ * an expression by wrapping it first with RXMeshStatic::add_attribute_view()
+ */
+namespace detail {
+struct AttributeExprBase
+{
+};
+
+template <typename E>
+inline constexpr bool is_attribute_expr_v =
+    std::is_base_of_v<AttributeExprBase, std::decay_t<E>>;
+}  // namespace detail
+
+
+/**
+ * @brief expression terminal that reads an attribute
+ */
+template <typename T, typename HandleT>
+struct AttributeTerm : public detail::AttributeExprBase
+{
+    AttributeTerm(const Attribute<T, HandleT>& attr) : m_attr(attr)
+    {
+    }
+
+    __device__ __forceinline__ compute_t<T> eval(const uint32_t p,
+                                                 const uint16_t i,
+                                                 const uint32_t j) const
+    {
+        return compute_t<T>(m_attr(p, i, j));
+    }
+
+    __host__ __device__ __forceinline__ uint32_t num_attributes() const
+    {
+        return m_attr.get_num_attributes();
+    }
+
+    Attribute<T, HandleT> m_attr;
+};
+
+/**
+ * @brief expression terminal of a constant broadcast to all elements
+ */
+template <typename S>
+struct ScalarTerm : public detail::AttributeExprBase
+{
+    ScalarTerm(const S val) : m_val(val)
+    {
+    }
+
+    __device__ __forceinline__ S eval(const uint32_t,
+                                      const uint16_t,
+                                      const uint32_t) const
+    {
+        return m_val;
+    }
+
+    __host__ __device__ __forceinline__ uint32_t num_attributes() const
+    {
+        return 0;
+    }
+
+    S m_val;
+};
+
+/**
+ * @brief expression terminal of a scalar that lives on the device (e.g., the
+ * output of ReduceHandle::dot_async()) and is read by the kernel such that the
+ * host does not need to synchronize to get its value
+ */
+template <typename S>
+struct DeviceScalarTerm : public detail::AttributeExprBase
+{
+    DeviceScalarTerm(const S* d_val) : m_d_val(d_val)
+    {
+    }
+
+    __device__ __forceinline__ S eval(const uint32_t,
+                                      const uint16_t,
+                                      const uint32_t) const
+    {
+        return *m_d_val;
+    }
+
+    __host__ __device__ __forceinline__ uint32_t num_attributes() const
+    {
+        return 0;
+    }
+
+    const S* m_d_val;
+};
+
+/**
+ * @brief binary element-wise expression. OpT is one of the functors below
+ */
+template <typename LhsT, typename RhsT, typename OpT>
+struct BinaryExpr : public detail::AttributeExprBase
+{
+    BinaryExpr(const LhsT& lhs, const RhsT& rhs) : m_lhs(lhs), m_rhs(rhs)
+    {
+    }
+
+    __device__ __forceinline__ auto eval(const uint32_t p,
+                                         const uint16_t i,
+                                         const uint32_t j) const
+    {
+        return OpT::apply(m_lhs.eval(p, i, j), m_rhs.eval(p, i, j));
+    }
+
+    __host__ __device__ __forceinline__ uint32_t num_attributes() const
+    {
+        const uint32_t l = m_lhs.num_attributes();
+        const uint32_t r = m_rhs.num_attributes();
+        return (l > r) ? l : r;
+    }
+
+    LhsT m_lhs;
+    RhsT m_rhs;
+};
+
+/**
+ * @brief unary negation of an expression
+ */
+template <typename E>
+struct NegateExpr : public detail::AttributeExprBase
+{
+    NegateExpr(const E& e) : m_e(e)
+    {
+    }
+
+    __device__ __forceinline__ auto eval(const uint32_t p,
+                                         const uint16_t i,
+                                         const uint32_t j) const
+    {
+        return -m_e.eval(p, i, j);
+    }
+
+    __host__ __device__ __forceinline__ uint32_t num_attributes() const
+    {
+        return m_e.num_attributes();
+    }
+
+    E m_e;
+};
+
+namespace detail {
+struct AddOp
+{
+    template <typename A, typename B>
+    __device__ __forceinline__ static auto apply(const A a, const B b)
+    {
+        return a + b;
+    }
+};
+
+struct SubOp
+{
+    template <typename A, typename B>
+    __device__ __forceinline__ static auto apply(const A a, const B b)
+    {
+        return a - b;
+    }
+};
+
+struct MulOp
+{
+    template <typename A, typename B>
+    __device__ __forceinline__ static auto apply(const A a, const B b)
+    {
+        return a * b;
+    }
+};
+
+/**
+ * @brief wrap arithmetic scalars into ScalarTerm and leave expressions as is
+ */
+template <typename E>
+__host__ auto as_expr(const E& e)
+{
+    if constexpr (is_attribute_expr_v<E>) {
+        return e;
+    } else {
+        static_assert(std::is_arithmetic_v<E>,
+                      "Attribute expressions can only be combined with other "
+                      "expressions or arithmetic scalars. Wrap attributes "
+                      "with expr()");
+        return ScalarTerm<E>(e);
+    }
+}
+
+template <typename A, typename B>
+inline constexpr bool is_expr_operands_v =
+    (is_attribute_expr_v<A> || is_attribute_expr_v<B>) &&
+    (is_attribute_expr_v<A> || std::is_arithmetic_v<A>) &&
+    (is_attribute_expr_v<B> || std::is_arithmetic_v<B>);
+}  // namespace detail
+
+
+/**
+ * @brief wrap an attribute into an expression terminal
+ */
+template <typename T, typename HandleT>
+AttributeTerm<T, HandleT> expr(const Attribute<T, HandleT>& attr)
+{
+    return AttributeTerm<T, HandleT>(attr);
+}
+
+/**
+ * @brief wrap a device pointer to a scalar into an expression terminal
+ */
+template <typename S>
+DeviceScalarTerm<S> device_scalar(const S* d_val)
+{
+    return DeviceScalarTerm<S>(d_val);
+}
+
+template <typename A,
+          typename B,
+          std::enable_if_t<detail::is_expr_operands_v<A, B>, bool> = true>
+auto operator+(const A& a, const B& b)
+{
+    auto l = detail::as_expr(a);
+    auto r = detail::as_expr(b);
+    return BinaryExpr<decltype(l), decltype(r), detail::AddOp>(l, r);
+}
+
+template <typename A,
+          typename B,
+          std::enable_if_t<detail::is_expr_operands_v<A, B>, bool> = true>
+auto operator-(const A& a, const B& b)
+{
+    auto l = detail::as_expr(a);
+    auto r = detail::as_expr(b);
+    return BinaryExpr<decltype(l), decltype(r), detail::SubOp>(l, r);
+}
+
+template <typename A,
+          typename B,
+          std::enable_if_t<detail::is_expr_operands_v<A, B>, bool> = true>
+auto operator*(const A& a, const B& b)
+{
+    auto l = detail::as_expr(a);
+    auto r = detail::as_expr(b);
+    return BinaryExpr<decltype(l), decltype(r), detail::MulOp>(l, r);
+}
+
+template <typename E,
+          std::enable_if_t<detail::is_attribute_expr_v<E>, bool> = true>
+NegateExpr<E> operator-(const E& e)
+{
+    return NegateExpr<E>(e);
+}
+
+
+/**
+ * @brief a pending assignment of an expression into an attribute (see
+ * assign())
+ */
+template <typename T, typename HandleT, typename E>
+struct AttributeAssign
+{
+    using HandleType = HandleT;
+
+    AttributeAssign(const Attribute<T, HandleT>& dst, const E& e)
+        : m_dst(dst), m_e(e)
+    {
+    }
+
+    __device__ __forceinline__ void apply(const uint32_t p,
+                                          const uint16_t i) const
+    {
+        const uint32_t num_attr = m_dst.get_num_attributes();
+        for (uint32_t j = 0; j < num_attr; ++j) {
+            m_dst(p, i, j) = T(m_e.eval(p, i, j));
+        }
+    }
+
+    Attribute<T, HandleT> m_dst;
+    E                     m_e;
+};
+
+/**
+ * @brief create the assignment dst = e to be passed to evaluate() (or
+ * ReduceHandle::evaluate_dot_async()). e should have either the same number
+ * of attributes as dst or be a scalar expression
+ */
+template <typename T, typename HandleT, typename E>
+auto assign(Attribute<T, HandleT>& dst, const E& e)
+{
+    auto ex = detail::as_expr(e);
+    if (ex.num_attributes() != 0 &&
+        ex.num_attributes() != dst.get_num_attributes()) {
+        RXMESH_ERROR(
+            "assign() the expression has {} attributes while the "
+            "destination attribute {} has {} attributes",
+            ex.num_attributes(),
+            dst.get_name(),
+            dst.get_num_attributes());
+    }
+    return AttributeAssign<T, HandleT, decltype(ex)>(dst, ex);
+}
+
+namespace detail {
+
+/**
+ * @brief apply all assignments to every owned active element (one block per
+ * patch) and, if WithDot, write the per-patch sum of lhs*rhs (evaluated after
+ * the assignments) into d_block_output
+ */
+template <uint32_t blockSize,
+          bool     WithDot,
+          typename ComputeT,
+          typename LhsT,
+          typename RhsT,
+          typename FirstT,
+          typename... RestT>
+__launch_bounds__(blockSize) __global__
+    void fused_assign_kernel(const uint32_t num_patches,
+                             const uint32_t dot_num_attributes,
+                             const LhsT     lhs,
+                             const RhsT     rhs,
+                             ComputeT*      d_block_output,
+                             const FirstT   first,
+                             const RestT... rest)
+{
+    using LocalT = typename FirstT::HandleType::LocalT;
+
+    const uint32_t p = blockIdx.x;
+    if (p >= num_patches) {
+        return;
+    }
+
+    const PatchInfo& pi = first.m_dst.get_patch_info(p);
+
+    const uint16_t num_elements = first.m_dst.size(p);
+
+    ComputeT thread_val = 0;
+
+    for (uint16_t i = threadIdx.x; i < num_elements; i += blockSize) {
+        if (pi.is_owned(LocalT(i)) && !pi.is_deleted(LocalT(i))) {
+            first.apply(p, i);
+            (rest.apply(p, i), ...);
+
+            if constexpr (WithDot) {
+                for (uint32_t j = 0; j < dot_num_attributes; ++j) {
+                    thread_val += ComputeT(lhs.eval(p, i, j)) *
+                                  ComputeT(rhs.eval(p, i, j));
+                }
+            }
+        }
+    }
+
+    if constexpr (WithDot) {
+        typedef cub::BlockReduce<ComputeT, blockSize> BlockReduce;
+        __shared__ typename BlockReduce::TempStorage  temp_storage;
+        const ComputeT block_sum = BlockReduce(temp_storage).Sum(thread_val);
+        if (threadIdx.x == 0) {
+            d_block_output[p] = block_sum;
+        }
+    }
+}
+
+template <typename FirstT, typename... RestT>
+void check_assign(const FirstT& first, const RestT&... rest)
+{
+    auto check = [&](const auto& a) {
+        using AT = std::decay_t<decltype(a)>;
+        static_assert(std::is_same_v<typename AT::HandleType,
+                                     typename FirstT::HandleType>,
+                      "evaluate() all destination attributes should be "
+                      "defined on the same mesh element type");
+        if ((a.m_dst.get_allocated() & DEVICE) != DEVICE) {
+            RXMESH_ERROR(
+                "evaluate() destination attribute {} should be allocated on "
+                "the device",
+                a.m_dst.get_name());
+        }
+    };
+    check(first);
+    (check(rest), ...);
+}
+}  // namespace detail
+
+/**
+ * @brief evaluate all assignments in a single kernel on the device. The
+ * assignments are applied in order for every element
+ * @param rx the mesh the destination attributes are defined on
+ * @param stream the stream to launch the kernel on
+ * @param first, rest the assignments created by assign()
+ */
+template <typename FirstT, typename... RestT>
+void evaluate(const RXMesh& rx,
+              cudaStream_t  stream,
+              const FirstT& first,
+              const RestT&... rest)
+{
+    constexpr uint32_t blockThreads = 256;
+
+    detail::check_assign(first, rest...);
+
+    const ScalarTerm<float> none(0);
+
+    detail::fused_assign_kernel<blockThreads, false, float>
+        <<<rx.get_max_num_patches(), blockThreads, 0, stream>>>(
+            rx.get_max_num_patches(), 0, none, none, nullptr, first, rest...);
+}
+
+}  // namespace rxmesh
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <stdint.h>
+#include <type_traits>
+
+#include "rxmesh/attribute.h"
+
+namespace rxmesh {
+
+/**
+ * @brief how an attribute is updated when a topology change moves a mesh
+ * element to another patch or to another local index (i.e., in the cavity
+ * prologue, slice_patches(), and merge_patches()). New mesh elements are still
+ * set by the user during the cavity fill-in (e.g., using the interpolation of
+ * the batched cavity operations)
+ */
+enum class AttributeUpdate : uint8_t
+{
+    // copy the value (this is the same as passing the attribute directly)
+    Copy = 0,
+    // do not move the value. The value of the moved element is undefined
+    Skip = 1,
+    // do not move the value but mark the moved element in a dirty flag such
+    // that it is reinitialized later by RXMeshDynamic::repair_attribute()
+    Defer = 2,
+};
+
+/**
+ * @brief an attribute along with its update policy. This is passed (by value)
+ * in place of the attribute to CavityManager::prologue(),
+ * RXMeshDynamic::slice_patches(), and RXMeshDynamic::merge_patches() such that
+ * topology changes only move the data that is needed. Use skip_update() and
+ * defer_update() to create it
+ */
+template <typename AttributeT, AttributeUpdate policy>
+struct AttributeUpdatePolicy
+{
+    using HandleType = typename AttributeT::HandleType;
+    using Type       = typename AttributeT::Type;
+
+    static constexpr AttributeUpdate update = policy;
+
+    AttributeT attribute;
+};
+
+/**
+ * @brief a deferred attribute with the dirty flag of every mesh element whose
+ * value has not been moved
+ */
+template <typename AttributeT>
+struct AttributeUpdatePolicy<AttributeT, AttributeUpdate::Defer>
+{
+    using HandleType = typename AttributeT::HandleType;
+    using Type       = typename AttributeT::Type;
+
+    static constexpr AttributeUpdate update = AttributeUpdate::Defer;
+
+    AttributeT                  attribute;
+    Attribute<bool, HandleType> dirty;
+};
+
+/**
+ * @brief do not move the attribute during topology changes e.g., scratch
+ * attributes that are recomputed from scratch after the topology changes
+ */
+template <typename AttributeT>
+AttributeUpdatePolicy<AttributeT, AttributeUpdate::Skip> skip_update(
+    const AttributeT& attribute)
+{
+    return {attribute};
+}
+
+/**
+ * @brief do not move the attribute during topology changes and mark the
+ * moved elements in dirty instead. The dirty elements are reinitialized in one
+ * batch later (e.g., after the cleanup) using
+ * RXMeshDynamic::repair_attribute(). This is meant for wide attributes (e.g.,
+ * per-vertex descriptors) whose values can be recomputed. dirty should be
+ * reset to false before the topology changes
+ */
+template <typename AttributeT>
+AttributeUpdatePolicy<AttributeT, AttributeUpdate::Defer> defer_update(
+    const AttributeT&                                       attribute,
+    const Attribute<bool, typename AttributeT::HandleType>& dirty)
+{
+    return {attribute, dirty};
+}
+
+namespace detail {
+
+template <typename T>
+struct is_attribute_update_policy : std::false_type
+{
+};
+
+template <typename AttributeT, AttributeUpdate policy>
+struct is_attribute_update_policy<AttributeUpdatePolicy<AttributeT, policy>>
+    : std::true_type
+{
+};
+
+/**
+ * @brief move the value of the element src in patch src_p to the element dst
+ * in patch dst_p following the update policy of the attribute. A plain
+ * attribute is copied
+ */
+template <typename AttributeT>
+__device__ __forceinline__ void update_element(AttributeT&    attribute,
+                                               const uint32_t dst_p,
+                                               const uint16_t dst,
+                                               const uint32_t src_p,
+                                               const uint16_t src)
+{
+    using AttrT = std::remove_cv_t<std::remove_reference_t<AttributeT>>;
+
+    if constexpr (is_attribute_update_policy<AttrT>::value) {
+        if constexpr (AttrT::update == AttributeUpdate::Copy) {
+            update_element(attribute.attribute, dst_p, dst, src_p, src);
+        }
+        if constexpr (AttrT::update == AttributeUpdate::Defer) {
+            attribute.dirty(dst_p, dst, 0) = true;
+        }
+    } else {
+        const uint32_t num_attr = attribute.get_num_attributes();
+        for (uint32_t a = 0; a < num_attr; ++a) {
+            attribute(dst_p, dst, a) = attribute(src_p, src, a);
+        }
+    }
+}
+}  // namespace detail
+}  // namespace rxmesh
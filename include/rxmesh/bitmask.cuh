@@ -191,7 +191,113 @@ struct Bitmask
         const uint16_t mask_num_elements = DIVIDE_UP(size(), 32);
         for (uint16_t i = g.thread_rank(); i < mask_num_elements;
              i += g.size()) {
-            m_bitmask[i] = m_bitmask[i];
+            m_bitmask[i] = other[i];
+        }
+    }
+
+    /**
+     * @brief set the bits that are set in other (of the same size). The words
+     * are split between the threads of the group
+     */
+    __device__ __inline__ void set_union(cooperative_groups::thread_group& g,
+                                         const Bitmask& other)
+    {
+        apply_words(g, other, [](uint32_t a, uint32_t b) { return a | b; });
+    }
+
+    /**
+     * @brief clear the bits that are not set in other (of the same size). The
+     * words are split between the threads of the group
+     */
+    __device__ __inline__ void set_intersect(
+        cooperative_groups::thread_group& g,
+        const Bitmask&                    other)
+    {
+        apply_words(g, other, [](uint32_t a, uint32_t b) { return a & b; });
+    }
+
+    /**
+     * @brief clear the bits that are set in other (of the same size) i.e.,
+     * and-not. The words are split between the threads of the group
+     */
+    __device__ __inline__ void set_difference(
+        cooperative_groups::thread_group& g,
+        const Bitmask&                    other)
+    {
+        apply_words(g, other, [](uint32_t a, uint32_t b) { return a & ~b; });
+    }
+
+    /**
+     * @brief the number of set bits. This is done by a single thread with one
+     * popc per word
+     */
+    __device__ __host__ __inline__ uint16_t count() const
+    {
+        return detail::count_set_bits(size(), m_bitmask);
+    }
+
+    /**
+     * @brief the position of the first set bit at or after from. Returns
+     * INVALID16 if there is no such bit
+     */
+    __device__ __host__ __inline__ uint16_t find_next_set(
+        const uint16_t from = 0) const
+    {
+        return detail::find_next_set_bit(size(), m_bitmask, from);
+    }
+
+    /**
+     * @brief call func(bit) for every set bit. The words are split between the
+     * threads of the group and every thread walks over the set bits of its
+     * words with ffs
+     */
+    template <typename FuncT>
+    __device__ __inline__ void for_each_set(cooperative_groups::thread_group& g,
+                                            FuncT func) const
+    {
+        assert(m_bitmask != nullptr);
+        const uint16_t mask_num_elements = DIVIDE_UP(size(), 32);
+        for (uint16_t i = g.thread_rank(); i < mask_num_elements;
+             i += g.size()) {
+            uint32_t word = m_bitmask[i] & detail::word_valid_bits(size(), i);
+            while (word != 0) {
+                const uint32_t first = detail::first_set_bit(word);
+                func(static_cast<uint16_t>(32 * i + first));
+                word &= word - 1;
+            }
+        }
+    }
+
+    /**
+     * @brief evaluate pred(bit) for the first num_bits bits where every warp
+     * evaluates 32 consecutive bits at a time and combines them in one word
+     * with a ballot. Then, one lane per warp calls update(w, word) where w is
+     * the word index and word has the bits for which pred is true. Since every
+     * word is updated by a single thread, update does not need atomics
+     * (unless other threads write to the same bitmask concurrently). Should be
+     * called by all threads in the block
+     */
+    template <uint32_t blockThreads, typename PredT, typename UpdateT>
+    __device__ __inline__ void ballot(const uint16_t num_bits,
+                                      PredT          pred,
+                                      UpdateT        update)
+    {
+        static_assert(blockThreads % 32 == 0,
+                      "Bitmask::ballot() the block size should be a multiple "
+                      "of the warp size");
+        assert(num_bits <= size());
+
+        const uint16_t lane      = threadIdx.x % 32;
+        const uint16_t num_words = DIVIDE_UP(num_bits, 32);
+
+        for (uint16_t w = threadIdx.x / 32; w < num_words;
+             w += blockThreads / 32) {
+            const uint16_t bit  = 32 * w + lane;
+            const bool     pr   = bit < num_bits && pred(bit);
+            const uint32_t word = __ballot_sync(0xFFFFFFFF, pr);
+            if (lane == 0) {
+                update(w, word);
+            }
         }
     }
 
@@ -265,5 +371,20 @@ struct Bitmask
     uint16_t m_size;
 
     uint32_t* m_bitmask;
+
+   private:
+    template <typename OpT>
+    __device__ __inline__ void apply_words(cooperative_groups::thread_group& g,
+                                           const Bitmask& other,
+                                           OpT            op)
+    {
+        assert(m_bitmask != nullptr);
+        assert(size() == other.size());
+        const uint16_t mask_num_elements = DIVIDE_UP(size(), 32);
+        for (uint16_t i = g.thread_rank(); i < mask_num_elements;
+             i += g.size()) {
+            m_bitmask[i] = op(m_bitmask[i], other.m_bitmask[i]);
+        }
+    }
 };
 }  // namespace rxmesh
\ No newline at end of file
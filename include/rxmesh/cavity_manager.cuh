@@ -9,6 +9,7 @@
 #include "rxmesh/patch_info.h"
 
 #include "rxmesh/attribute.h"
+#include "rxmesh/attribute_policy.h"
 
 #include "rxmesh/kernels/shmem_mutex.cuh"
 #include "rxmesh/kernels/shmem_mutex_array.cuh"
@@ -131,7 +132,10 @@ struct CavityManager
      * @brief processes all cavities created using create() by removing elements
      * in these cavities, update the patch layout for subsequent cavity fill-in.
      * In the event of failure (due to failure of locking neighbor patches),
-     * this function returns false.
+     * this function returns false. The attributes are updated such that they
+     * can be used after the topology changes. An attribute could be passed
+     * with an update policy (see skip_update() and defer_update()) such that
+     * only the needed data is moved
      * @return
      */
     template <typename... AttributesT>
@@ -263,7 +267,8 @@ struct CavityManager
    private:
     /**
      * @brief update all attributes such that it can be used after the topology
-     * changes. This function takes as many attributes as you want
+     * changes following the update policy of each attribute. This function
+     * takes as many attributes as you want
      */
     template <typename... AttributesT>
     __device__ __forceinline__ void update_attributes(
@@ -298,6 +303,21 @@ struct CavityManager
         const LPPair*                     s_stash,
         InverseLPHashTable&               inv_lp);
 
+    /**
+     * @brief load the inverted hashtable of this patch from the global memory
+     * cache (see InverseHashtableCache) if it was built from the current
+     * version of the patch. Return false if there is no such cached table
+     */
+    __device__ __forceinline__ bool load_inverted_hashtable(
+        cooperative_groups::thread_block& block);
+
+    /**
+     * @brief cache the inverted hashtable of this patch (right after it is
+     * built by invert_hashtable()) in global memory
+     */
+    __device__ __forceinline__ void cache_inverted_hashtable(
+        cooperative_groups::thread_block& block);
+
 
     /**
      * @brief store inverted hashtable from shared memory to global memory
@@ -494,11 +514,40 @@ struct CavityManager
 
     /**
      * @brief enqueue patch in the patch scheduler so that it can be scheduled
-     * latter
+     * latter. Patches that could not be processed due to a conflict with a
+     * neighbor patch are pushed with low priority so they are retried after
+     * the other patches in the queue
      */
-    __device__ __forceinline__ void push();
+    __device__ __forceinline__ void push(const bool low_priority = false);
+
+    __device__ __forceinline__ void push(const uint32_t pid,
+                                         const bool     low_priority = false);
 
-    __device__ __forceinline__ void push(const uint32_t pid);
+    /**
+     * @brief add the number of active (or inactive) cavities to the cavity
+     * statistics counter stat (if the statistics are enabled)
+     */
+    __device__ __forceinline__ void count_cavities_stat(const CavityStat stat,
+                                                        const bool active);
+
+    /**
+     * @brief add the number of recovered cavities to the cavity statistics
+     * (if the statistics are enabled)
+     */
+    __device__ __forceinline__ void count_recovered_stat();
+
+    /**
+     * @brief append the elements created and deleted by the committed
+     * cavities to the change log (if the change log is enabled)
+     */
+    __device__ __forceinline__ void log_changes();
+
+    __device__ __forceinline__ void log_changes(const ChangeType created,
+                                                const ChangeType deleted,
+                                                const uint32_t   num_elements,
+                                                const Bitmask&   active,
+                                                const Bitmask&   in_cavity,
+                                                const Bitmask&   fill_in);
 
     /**
      * @brief release the lock of this patch
@@ -507,15 +556,45 @@ struct CavityManager
 
 
     /**
-     * @brief try to acquire the lock of the patch q. The block call this
-     * function while only one thread is needed to do the job but we broadcast
-     * the results to all threads
+     * @brief try to acquire the lock of the patch q (stored at stash_id in
+     * the patch stash) in the shared mode. Only one thread should call this
+     * function
      */
-    __device__ __forceinline__ bool lock(
+    __device__ __forceinline__ bool lock(const uint8_t  stash_id,
+                                         const uint32_t q);
+
+    /**
+     * @brief lock the patches in the patch stash that are not locked yet (and
+     * that pass the filter) in the shared mode. The patches are locked in
+     * increasing order of their patch id. The block call this function while
+     * only one thread is needed to do the job but we broadcast the results to
+     * all threads
+     */
+    template <typename FilterT>
+    __device__ __forceinline__ bool lock_in_order(
         cooperative_groups::thread_block& block,
-        const uint8_t                     stash_id,
-        const uint32_t                    q);
+        FilterT                           filter);
 
+    /**
+     * @brief upgrade the lock of the patches this patch will write to (i.e.,
+     * the owners of the elements that change their ownership and the owners
+     * of the not-owned cavity boundary vertices as these are the patches
+     * that may have a copy of the elements we are about to change) to
+     * exclusive. The rest of the locked patches are only read from and thus
+     * they stay in the shared mode. Returns false if any of these locks can
+     * not be upgraded
+     */
+    __device__ __forceinline__ bool upgrade_written_patches(
+        cooperative_groups::thread_block& block);
+
+    /**
+     * @brief set the bit of the owner patch (in m_s_exclusive_patches_mask)
+     * of every not-owned element set in s_mask
+     */
+    template <typename HandleT>
+    __device__ __forceinline__ void mark_owner_patches(
+        const Bitmask&            s_mask,
+        const InverseLPHashTable& s_inv_table);
 
     /**
      * @brief release the lock acquired earlier for the patch q.
@@ -529,7 +608,7 @@ struct CavityManager
     __device__ __forceinline__ void unlock_locked_patches();
 
     /**
-     * @brief set the dirty bit for locked patches
+     * @brief set the dirty bit for the patches that are locked exclusively
      */
     __device__ __forceinline__ void set_dirty_for_locked_patches();
 
@@ -611,7 +690,7 @@ struct CavityManager
      * @brief Add a new patch to the patch stash and return the stash id
      * Internally, if the patch is actually new (i.e., it was not stored in
      * the patch stash before), we also indicate that we have added a new patch
-     * (using m_s_new_patch_added)
+     * (using m_s_new_patch_added). Return INVALID8 if the patch stash is full
      */
     __device__ __forceinline__ uint8_t
     add_new_patch_to_patch_stash(const uint32_t new_patch);
@@ -977,6 +1056,11 @@ struct CavityManager
     // indicate which patch (in the patch stash) is actually locked
     Bitmask m_s_locked_patches_mask;
 
+    // indicate which locked patch (in the patch stash) is locked exclusively
+    // i.e., that this patch will write to. The other locked patches are
+    // locked in the shared mode
+    Bitmask m_s_exclusive_patches_mask;
+
 
     // indicate if the mesh element is in the interior of the cavity
     Bitmask m_s_in_cavity_v, m_s_in_cavity_e, m_s_in_cavity_f;
@@ -1086,8 +1170,80 @@ struct CavityManager
     LPPair* m_s_temp_inv_lp;
 
     bool* m_s_migrated;
+
+    // set if the patch could not be processed because it or one of its
+    // neighbors is dirty. In persistent mode, such a patch is deferred until
+    // the next cleanup instead of being pushed back to the queue
+    bool* m_s_deferred;
 };
 
+/**
+ * @brief persistent-kernel driver for cavity operations. Instead of one patch
+ * per block, the calling block keeps popping patches from the scheduler and
+ * calls process(cavity, shrd_alloc) on each one until the queue is empty and
+ * no other block holds a patch (that may still be pushed back to the queue).
+ * process() should create the cavities and call prologue() and epilogue() as
+ * a regular cavity kernel does. The kernel should be launched with
+ * RXMeshDynamic::run_persistent() which also takes care of the patches that
+ * need cleanup or slicing before they can be processed again
+ * @param block
+ * @param context RXMesh context as passed by RXMeshDynamic::run_persistent()
+ * @param preserve_cavity see CavityManager constructor
+ * @param process device lambda that takes the CavityManager and the
+ * ShmemAllocator of the current patch
+ * @param allow_touching_cavities see CavityManager constructor
+ */
+template <uint32_t blockThreads, CavityOp cop, typename ProcessT>
+__device__ __forceinline__ void for_each_cavity_patch(
+    cooperative_groups::thread_block& block,
+    Context&                          context,
+    bool                              preserve_cavity,
+    ProcessT                          process,
+    bool                              allow_touching_cavities = true)
+{
+    assert(context.m_patch_scheduler.persistent);
+
+    __shared__ bool s_done;
+
+    while (true) {
+        if (threadIdx.x == 0) {
+            context.m_patch_scheduler.begin_patch();
+        }
+
+        // every patch starts from the beginning of the shared memory
+        ShmemAllocator shrd_alloc;
+
+        CavityManager<blockThreads, cop> cavity(block,
+                                                context,
+                                                shrd_alloc,
+                                                preserve_cavity,
+                                                allow_touching_cavities);
+
+        const bool has_patch = cavity.patch_id() != INVALID32;
+
+        if (has_patch) {
+            process(cavity, shrd_alloc);
+        }
+        block.sync();
+
+        if (threadIdx.x == 0) {
+            context.m_patch_scheduler.end_patch();
+            s_done = !has_patch && context.m_patch_scheduler.is_done();
+#if __CUDA_ARCH__ >= 700
+            if (!has_patch && !s_done) {
+                // back-off while other blocks finish their patches
+                __nanosleep(128);
+            }
+#endif
+        }
+        block.sync();
+
+        if (s_done) {
+            break;
+        }
+    }
+}
+
 }  // namespace rxmesh
 
 #include "rxmesh/cavity_manager_impl.cuh"
\ No newline at end of file
@@ -23,12 +23,13 @@ __device__ __forceinline__ CavityManager<blockThreads, cop>::CavityManager(
     m_s_num_edges    = s_uint32 + 1;
     m_s_num_faces    = s_uint32 + 2;
 
-    __shared__ bool s_bool[5];
+    __shared__ bool s_bool[6];
     m_s_should_slice    = s_bool + 0;
     m_s_remove_fill_in  = s_bool + 1;
     m_s_recover         = s_bool + 2;
     m_s_new_patch_added = s_bool + 3;
     m_s_migrated        = s_bool + 4;
+    m_s_deferred        = s_bool + 5;
 
     __shared__ int s_int[1];
     m_s_num_cavities = s_int;
@@ -39,6 +40,7 @@ __device__ __forceinline__ CavityManager<blockThreads, cop>::CavityManager(
         m_s_recover[0]         = false;
         m_s_new_patch_added[0] = false;
         m_s_migrated[0]        = false;
+        m_s_deferred[0]        = false;
         m_s_num_cavities[0]    = 0;
 
 
@@ -57,6 +59,10 @@ __device__ __forceinline__ CavityManager<blockThreads, cop>::CavityManager(
             }
         }
 
+        if (s_patch_id != INVALID32) {
+            m_context.trace_cavity(CavityTraceType::PatchPopped, s_patch_id);
+        }
+
         // filter based on color
         // uint32_t color = INVALID32;
         // if (s_patch_id != INVALID32) {
@@ -69,13 +75,21 @@ __device__ __forceinline__ CavityManager<blockThreads, cop>::CavityManager(
 
         // try to lock the patch
         if (s_patch_id != INVALID32) {
+            // in lock-free mode (one color class at a time), no other block
+            // works on this patch or on its neighbors
             bool locked =
+                m_context.m_patch_scheduler.lock_free ||
                 m_context.m_patches_info[s_patch_id].lock.acquire_lock(
                     blockIdx.x);
 
             if (!locked) {
-                // if we can not, we add it again to the queue
-                push(s_patch_id);
+                m_context.count_cavity_stat(CavityStat::PatchLockFailed);
+                m_context.trace_cavity(CavityTraceType::PatchLockFailed,
+                                       s_patch_id);
+
+                // if we can not, we add it again to the queue (with low
+                // priority since another block is working on it)
+                push(s_patch_id, true);
 
                 // and signal other threads to also exit
                 s_patch_id = INVALID32;
@@ -85,14 +99,26 @@ __device__ __forceinline__ CavityManager<blockThreads, cop>::CavityManager(
                 // if we lock the patch but it is dirty, we should unlock and
                 // not work on it
                 if (m_context.m_patches_info[s_patch_id].is_dirty()) {
-                    push(s_patch_id);
-                    m_context.m_patches_info[s_patch_id].lock.release_lock();
+                    m_context.count_cavity_stat(CavityStat::Dirty);
+                    m_context.trace_cavity(CavityTraceType::PatchDirty,
+                                           s_patch_id);
+                    if (m_context.m_patch_scheduler.persistent) {
+                        m_context.m_patch_scheduler.defer(s_patch_id);
+                    } else {
+                        push(s_patch_id, true);
+                    }
+                    if (!m_context.m_patch_scheduler.lock_free) {
+                        m_context.m_patches_info[s_patch_id]
+                            .lock.release_lock();
+                    }
                     s_patch_id = INVALID32;
                 }
             }
         }
 
         if (s_patch_id != INVALID32) {
+            m_context.count_cavity_stat(CavityStat::Processed);
+            m_context.trace_cavity(CavityTraceType::PatchLocked, s_patch_id);
             m_s_num_vertices[0] =
                 m_context.m_patches_info[s_patch_id].num_vertices[0];
             m_s_num_edges[0] =
@@ -365,6 +391,10 @@ CavityManager<blockThreads, cop>::alloc_shared_memory(
     m_s_locked_patches_mask = Bitmask(PatchStash::stash_size, p_locked);
     m_s_locked_patches_mask.reset(block);
 
+    __shared__ uint32_t p_exclusive[PatchStash::stash_size];
+    m_s_exclusive_patches_mask = Bitmask(PatchStash::stash_size, p_exclusive);
+    m_s_exclusive_patches_mask.reset(block);
+
     // cavity boundary edges
     m_s_cavity_boundary_edges = shrd_alloc.alloc<uint16_t>(edge_cap);
     assert(m_s_cavity_boundary_edges);
@@ -735,6 +765,12 @@ __device__ __forceinline__ bool CavityManager<blockThreads, cop>::prologue(
         return false;
     }
 
+    if (threadIdx.x == 0) {
+        m_context.count_cavity_stat(CavityStat::Created, get_num_cavities());
+        m_context.trace_cavity(
+            CavityTraceType::Cavities, patch_id(), get_num_cavities());
+    }
+
     // allocate shared memory
     alloc_shared_memory(block, shrd_alloc);
 
@@ -759,6 +795,8 @@ __device__ __forceinline__ bool CavityManager<blockThreads, cop>::prologue(
     deactivate_conflicting_cavities();
     block.sync();
 
+    count_cavities_stat(CavityStat::Conflicting, false);
+
     // Clear bitmask for elements in the (active) cavity to indicate that
     // they are deleted (but only in shared memory)
     clear_bitmask_if_in_cavity();
@@ -777,8 +815,12 @@ __device__ __forceinline__ bool CavityManager<blockThreads, cop>::prologue(
     // block.sync();
 
 
-    // load hashtables
-    invert_hashtable(block);
+    // load hashtables (or the cached inverted hashtables)
+    if (!load_inverted_hashtable(block)) {
+        invert_hashtable(block);
+        block.sync();
+        cache_inverted_hashtable(block);
+    }
     block.sync();
 
     // change patch layout to accommodate all cavities created in the patch
@@ -794,6 +836,14 @@ __device__ __forceinline__ bool CavityManager<blockThreads, cop>::prologue(
     m_patch_info.set_dirty();
     set_dirty_for_locked_patches();
 
+    // their cached query outputs, inverted hashtables, and element flags (if
+    // any) are stale now
+    if (threadIdx.x == 0) {
+        m_context.invalidate_query_cache(m_patch_info.patch_id);
+        m_context.bump_patch_version(m_patch_info.patch_id);
+        m_context.invalidate_element_flags(m_patch_info.patch_id);
+    }
+
     m_write_to_gmem = true;
 
     // do ownership change
@@ -1488,19 +1538,25 @@ CavityManager<blockThreads, cop>::reactivate_elements(
     uint16_t*      element_cavity_id,
     const uint16_t num_elements)
 {
-    for (int b = threadIdx.x; b < int(num_elements); b += blockThreads) {
-        const uint16_t c = element_cavity_id[b];
-        if (c != INVALID16) {
-            assert(c < m_s_active_cavity_bitmask.size());
-            if (!m_s_active_cavity_bitmask(c)) {
-                assert(b < active_bitmask.size());
-                assert(b < in_cavity.size());
-                active_bitmask.set(b, true);
-                in_cavity.reset(b, true);
-                element_cavity_id[b] = INVALID16;
+    // the elements of the deactivated cavities are gathered one word at a time
+    // so every word of the bitmasks is updated by a single thread
+    active_bitmask.ballot<blockThreads>(
+        num_elements,
+        [&](const uint16_t b) {
+            const uint16_t c = element_cavity_id[b];
+            assert(c == INVALID16 || c < m_s_active_cavity_bitmask.size());
+            return c != INVALID16 && !m_s_active_cavity_bitmask(c);
+        },
+        [&](const uint16_t w, uint32_t word) {
+            assert(w < DIVIDE_UP(in_cavity.size(), 32));
+            active_bitmask.m_bitmask[w] |= word;
+            in_cavity.m_bitmask[w] &= ~word;
+            while (word != 0) {
+                element_cavity_id[32 * w + detail::first_set_bit(word)] =
+                    INVALID16;
+                word &= word - 1;
             }
-        }
-    }
+        });
 }
 
 template <uint32_t blockThreads, CavityOp cop>
@@ -1623,16 +1679,17 @@ CavityManager<blockThreads, cop>::clear_bitmask_if_in_cavity(
     const uint16_t* element_cavity_id,
     const uint16_t  num_elements)
 {
-    for (int b = threadIdx.x; b < int(num_elements); b += blockThreads) {
-        if (element_cavity_id[b] != INVALID16) {
-            assert(b < active_bitmask.size());
-            assert(b < in_cavity.size());
-            active_bitmask.reset(b, true);
+    // the elements in a cavity are gathered one word at a time so every word
+    // of the bitmasks is updated by a single thread
+    active_bitmask.ballot<blockThreads>(
+        num_elements,
+        [&](const uint16_t b) { return element_cavity_id[b] != INVALID16; },
+        [&](const uint16_t w, const uint32_t word) {
+            assert(w < DIVIDE_UP(in_cavity.size(), 32));
+            active_bitmask.m_bitmask[w] &= ~word;
             // we don't reset owned bitmask since we use it in find_copy
-            in_cavity.set(b, true);
-            assert(!active_bitmask(b));
-        }
-    }
+            in_cavity.m_bitmask[w] |= word;
+        });
 }
 
 
@@ -2300,6 +2357,91 @@ CavityManager<blockThreads, cop>::invert_hashtable(
 #endif
 }
 
+template <uint32_t blockThreads, CavityOp cop>
+__device__ __forceinline__ bool
+CavityManager<blockThreads, cop>::load_inverted_hashtable(
+    cooperative_groups::thread_block& block)
+{
+    __shared__ bool s_cached;
+
+    InverseHashtableCache& cache = m_context.m_inv_lp_cache;
+
+    const uint32_t p = m_patch_info.patch_id;
+
+    if (threadIdx.x == 0) {
+        // the patch is locked by this block so its version does not change
+        s_cached = cache.is_valid(p,
+                                  m_inv_lp_v.m_capacity,
+                                  m_inv_lp_e.m_capacity,
+                                  m_inv_lp_f.m_capacity);
+    }
+    block.sync();
+
+    if (!s_cached) {
+        return false;
+    }
+
+    auto load = [&](const uint32_t k, InverseLPHashTable& inv_lp, bool wait) {
+        const LPPair* table = cache.get_table(p, k);
+        detail::load_async(
+            block, table, inv_lp.m_capacity, inv_lp.m_s_table, false);
+        detail::load_async(block,
+                           table + inv_lp.m_capacity,
+                           InverseHashtableCache::stash_size,
+                           inv_lp.m_s_stash,
+                           wait);
+    };
+
+    load(0, m_inv_lp_v, false);
+    load(1, m_inv_lp_e, false);
+    load(2, m_inv_lp_f, true);
+
+    return true;
+}
+
+template <uint32_t blockThreads, CavityOp cop>
+__device__ __forceinline__ void
+CavityManager<blockThreads, cop>::cache_inverted_hashtable(
+    cooperative_groups::thread_block& block)
+{
+    InverseHashtableCache& cache = m_context.m_inv_lp_cache;
+
+    if (!cache.fits(m_inv_lp_v.m_capacity) ||
+        !cache.fits(m_inv_lp_e.m_capacity) ||
+        !cache.fits(m_inv_lp_f.m_capacity)) {
+        return;
+    }
+
+    const uint32_t p = m_patch_info.patch_id;
+
+    auto store = [&](const uint32_t k, const InverseLPHashTable& inv_lp) {
+        LPPair* table = cache.get_table(p, k);
+        for (uint32_t i = threadIdx.x; i < inv_lp.m_capacity;
+             i += blockThreads) {
+            table[i] = inv_lp.m_s_table[i];
+        }
+        for (uint32_t i = threadIdx.x; i < InverseHashtableCache::stash_size;
+             i += blockThreads) {
+            table[inv_lp.m_capacity + i] = inv_lp.m_s_stash[i];
+        }
+    };
+
+    store(0, m_inv_lp_v);
+    store(1, m_inv_lp_e);
+    store(2, m_inv_lp_f);
+
+    __threadfence();
+    block.sync();
+
+    if (threadIdx.x == 0) {
+        cache.m_capacity[3 * p + 0] = m_inv_lp_v.m_capacity;
+        cache.m_capacity[3 * p + 1] = m_inv_lp_e.m_capacity;
+        cache.m_capacity[3 * p + 2] = m_inv_lp_f.m_capacity;
+        __threadfence();
+        cache.m_cached_version[p] = cache.m_version[p];
+    }
+}
+
 template <uint32_t blockThreads, CavityOp cop>
 __device__ __forceinline__ void
 CavityManager<blockThreads, cop>::store_inverted_hashtable(
@@ -2375,43 +2517,208 @@ CavityManager<blockThreads, cop>::store_inverted_hashtable(
 }
 
 template <uint32_t blockThreads, CavityOp cop>
-__device__ __forceinline__ void CavityManager<blockThreads, cop>::push()
+__device__ __forceinline__ void CavityManager<blockThreads, cop>::push(
+    const bool low_priority)
 {
     if (threadIdx.x == 0) {
-        bool ret = m_context.m_patch_scheduler.push(m_patch_info.patch_id);
+        m_context.count_cavity_stat(CavityStat::Pushed);
+        m_context.trace_cavity(CavityTraceType::Pushed, m_patch_info.patch_id);
+        bool ret = m_context.m_patch_scheduler.push(m_patch_info.patch_id,
+                                                    low_priority);
         assert(ret);
     }
 }
 
 template <uint32_t blockThreads, CavityOp cop>
 __device__ __forceinline__ void CavityManager<blockThreads, cop>::push(
-    const uint32_t pid)
+    const uint32_t pid,
+    const bool     low_priority)
 {
     if (threadIdx.x == 0) {
-        bool ret = m_context.m_patch_scheduler.push(pid);
+        m_context.count_cavity_stat(CavityStat::Pushed);
+        m_context.trace_cavity(CavityTraceType::Pushed, pid);
+        bool ret = m_context.m_patch_scheduler.push(pid, low_priority);
         assert(ret);
     }
 }
 
+template <uint32_t blockThreads, CavityOp cop>
+__device__ __forceinline__ void
+CavityManager<blockThreads, cop>::count_cavities_stat(const CavityStat stat,
+                                                      const bool active)
+{
+    if (m_context.m_cavity_stats == nullptr) {
+        return;
+    }
+
+    const int num_cavities = get_num_cavities();
+
+    uint32_t count = 0;
+    for (int w = threadIdx.x; w < DIVIDE_UP(num_cavities, 32);
+         w += blockThreads) {
+        uint32_t bits = m_s_active_cavity_bitmask.m_bitmask[w];
+        if (!active) {
+            bits = ~bits;
+        }
+        // ignore the bits beyond the number of cavities in the last word
+        const int rem = num_cavities - 32 * w;
+        if (rem < 32) {
+            bits &= (1u << rem) - 1;
+        }
+        count += __popc(bits);
+    }
+    m_context.count_cavity_stat(stat, count);
+}
+
+template <uint32_t blockThreads, CavityOp cop>
+__device__ __forceinline__ void
+CavityManager<blockThreads, cop>::count_recovered_stat()
+{
+    if (m_context.m_cavity_stats == nullptr) {
+        return;
+    }
+
+    // the recovered cavities are marked by their seed
+    const Bitmask* recover = nullptr;
+    if constexpr (cop == CavityOp::V || cop == CavityOp::VV ||
+                  cop == CavityOp::VE || cop == CavityOp::VF) {
+        recover = &m_s_recover_v;
+    }
+    if constexpr (cop == CavityOp::E || cop == CavityOp::EV ||
+                  cop == CavityOp::EE || cop == CavityOp::EF) {
+        recover = &m_s_recover_e;
+    }
+    if constexpr (cop == CavityOp::F || cop == CavityOp::FV ||
+                  cop == CavityOp::FE || cop == CavityOp::FF) {
+        recover = &m_s_recover_f;
+    }
+
+    uint32_t count = 0;
+    for (int w = threadIdx.x; w < DIVIDE_UP(int(recover->size()), 32);
+         w += blockThreads) {
+        count += __popc(recover->m_bitmask[w]);
+    }
+    m_context.count_cavity_stat(CavityStat::Recovered, count);
+}
+
+
+template <uint32_t blockThreads, CavityOp cop>
+__device__ __forceinline__ void CavityManager<blockThreads, cop>::log_changes()
+{
+    if (!m_context.m_change_log.is_enabled()) {
+        return;
+    }
+
+    log_changes(ChangeType::CreatedVertex,
+                ChangeType::DeletedVertex,
+                m_s_num_vertices[0],
+                m_s_active_mask_v,
+                m_s_in_cavity_v,
+                m_s_fill_in_v);
+
+    log_changes(ChangeType::CreatedEdge,
+                ChangeType::DeletedEdge,
+                m_s_num_edges[0],
+                m_s_active_mask_e,
+                m_s_in_cavity_e,
+                m_s_fill_in_e);
+
+    log_changes(ChangeType::CreatedFace,
+                ChangeType::DeletedFace,
+                m_s_num_faces[0],
+                m_s_active_mask_f,
+                m_s_in_cavity_f,
+                m_s_fill_in_f);
+}
+
+template <uint32_t blockThreads, CavityOp cop>
+__device__ __forceinline__ void CavityManager<blockThreads, cop>::log_changes(
+    const ChangeType created,
+    const ChangeType deleted,
+    const uint32_t   num_elements,
+    const Bitmask&   active,
+    const Bitmask&   in_cavity,
+    const Bitmask&   fill_in)
+{
+    // an element is created if it is added during the fill-in and survived
+    // (i.e., was not removed because the fill-in failed). An element is
+    // deleted if it is inside a cavity and either stays inactive or its slot
+    // is reused by a new element
+    for (int w = threadIdx.x; w < DIVIDE_UP(int(num_elements), 32);
+         w += blockThreads) {
+        const uint32_t a  = active.m_bitmask[w];
+        const uint32_t c  = in_cavity.m_bitmask[w];
+        const uint32_t fi = fill_in.m_bitmask[w];
+
+        uint32_t created_bits = fi & a;
+        uint32_t deleted_bits = c & (~a | created_bits);
+
+        // ignore the bits beyond the number of elements in the last word
+        const int rem = int(num_elements) - 32 * w;
+        if (rem < 32) {
+            created_bits &= (1u << rem) - 1;
+            deleted_bits &= (1u << rem) - 1;
+        }
+
+        m_context.m_change_log.append(
+            deleted, m_patch_info.patch_id, w, deleted_bits);
+        m_context.m_change_log.append(
+            created, m_patch_info.patch_id, w, created_bits);
+    }
+}
+
 
 template <uint32_t blockThreads, CavityOp cop>
 __device__ __forceinline__ bool CavityManager<blockThreads, cop>::lock(
+    const uint8_t  stash_id,
+    const uint32_t q)
+{
+    assert(stash_id < m_s_locked_patches_mask.size());
+    bool okay = m_s_locked_patches_mask(stash_id);
+    if (!okay) {
+        okay =
+            m_context.m_patch_scheduler.lock_free ||
+            m_context.m_patches_info[q].lock.acquire_shared_lock(blockIdx.x);
+        if (okay) {
+            m_s_locked_patches_mask.set(stash_id);
+        }
+    }
+    return okay;
+}
+
+
+template <uint32_t blockThreads, CavityOp cop>
+template <typename FilterT>
+__device__ __forceinline__ bool CavityManager<blockThreads, cop>::lock_in_order(
     cooperative_groups::thread_block& block,
-    const uint8_t                     stash_id,
-    const uint32_t                    q)
+    FilterT                           filter)
 {
+    // locking the patches in the same (global) order by all blocks avoids
+    // the cyclic waits between the blocks that want to lock the same patches.
+    // Blocks that still collide are resolved by the spin priority of the lock
     __shared__ bool s_success;
+    block.sync();
     if (threadIdx.x == 0) {
-        assert(stash_id < m_s_locked_patches_mask.size());
-        bool okay = m_s_locked_patches_mask(stash_id);
-        if (!okay) {
-            okay = m_context.m_patches_info[q].lock.acquire_lock(blockIdx.x);
-            if (okay) {
-                assert(stash_id < m_s_locked_patches_mask.size());
-                m_s_locked_patches_mask.set(stash_id);
+        s_success = true;
+        while (true) {
+            uint8_t next = INVALID8;
+            for (int st = 0; st < PatchStash::stash_size; ++st) {
+                const uint32_t q = m_s_patch_stash.get_patch(st);
+                if (q != INVALID32 && !m_s_locked_patches_mask(st) &&
+                    filter(st) &&
+                    (next == INVALID8 ||
+                     q < m_s_patch_stash.get_patch(next))) {
+                    next = st;
+                }
+            }
+            if (next == INVALID8) {
+                break;
+            }
+            if (!lock(next, m_s_patch_stash.get_patch(next))) {
+                s_success = false;
+                break;
             }
         }
-        s_success = okay;
     }
     block.sync();
     return s_success;
@@ -2419,9 +2726,71 @@ __device__ __forceinline__ bool CavityManager<blockThreads, cop>::lock(
 
 
 template <uint32_t blockThreads, CavityOp cop>
-__device__ __forceinline__ void CavityManager<blockThreads, cop>::unlock()
+template <typename HandleT>
+__device__ __forceinline__ void
+CavityManager<blockThreads, cop>::mark_owner_patches(
+    const Bitmask&            s_mask,
+    const InverseLPHashTable& s_inv_table)
 {
+    s_inv_table.for_each<blockThreads>([&](const uint16_t local_id,
+                                           const uint16_t
+                                               local_id_in_owner_patch,
+                                           const uint8_t owner_st_id) {
+        assert(local_id < s_mask.size());
+        if (s_mask(local_id)) {
+            assert(owner_st_id != INVALID8);
+            assert(owner_st_id < m_s_exclusive_patches_mask.size());
+            if (!m_s_exclusive_patches_mask(owner_st_id)) {
+                m_s_exclusive_patches_mask.set(owner_st_id, true);
+            }
+        }
+    });
+}
+
+
+template <uint32_t blockThreads, CavityOp cop>
+__device__ __forceinline__ bool
+CavityManager<blockThreads, cop>::upgrade_written_patches(
+    cooperative_groups::thread_block& block)
+{
+    m_s_exclusive_patches_mask.reset(block);
+    block.sync();
+
+    mark_owner_patches<VertexHandle>(m_s_ownership_change_mask_v, m_inv_lp_v);
+    mark_owner_patches<VertexHandle>(m_s_not_owned_cavity_bdry_v, m_inv_lp_v);
+    mark_owner_patches<EdgeHandle>(m_s_ownership_change_mask_e, m_inv_lp_e);
+    mark_owner_patches<FaceHandle>(m_s_ownership_change_mask_f, m_inv_lp_f);
+    block.sync();
+
+    __shared__ bool s_success;
     if (threadIdx.x == 0) {
+        s_success = true;
+        for (int st = 0; st < PatchStash::stash_size; ++st) {
+            if (!m_s_exclusive_patches_mask(st)) {
+                continue;
+            }
+            assert(m_s_locked_patches_mask(st));
+            const uint32_t q = m_s_patch_stash.get_patch(st);
+            assert(q != INVALID32);
+
+            // on failure, the remaining patches stay in the shared mode
+            if (!s_success ||
+                !(m_context.m_patch_scheduler.lock_free ||
+                  m_context.m_patches_info[q].lock.upgrade_lock(blockIdx.x))) {
+                s_success = false;
+                m_s_exclusive_patches_mask.reset(st);
+            }
+        }
+    }
+    block.sync();
+    return s_success;
+}
+
+
+template <uint32_t blockThreads, CavityOp cop>
+__device__ __forceinline__ void CavityManager<blockThreads, cop>::unlock()
+{
+    if (threadIdx.x == 0 && !m_context.m_patch_scheduler.lock_free) {
         m_patch_info.lock.release_lock();
     }
 }
@@ -2432,11 +2801,15 @@ CavityManager<blockThreads, cop>::set_dirty_for_locked_patches()
 {
     if (threadIdx.x == 0) {
         for (int st = 0; st < PatchStash::stash_size; ++st) {
-            assert(st < m_s_locked_patches_mask.size());
-            if (m_s_locked_patches_mask(st)) {
+            assert(st < m_s_exclusive_patches_mask.size());
+            if (m_s_exclusive_patches_mask(st)) {
+                assert(m_s_locked_patches_mask(st));
                 uint32_t q = m_s_patch_stash.get_patch(st);
                 assert(q != INVALID32);
                 m_context.m_patches_info[q].set_dirty();
+                m_context.invalidate_query_cache(q);
+                m_context.bump_patch_version(q);
+                m_context.invalidate_element_flags(q);
             }
         }
     }
@@ -2466,8 +2839,15 @@ __device__ __forceinline__ void CavityManager<blockThreads, cop>::unlock(
     if (threadIdx.x == 0) {
         assert(stash_id < m_s_locked_patches_mask.size());
         assert(m_s_locked_patches_mask(stash_id));
-        m_context.m_patches_info[q].lock.release_lock();
+        if (!m_context.m_patch_scheduler.lock_free) {
+            if (m_s_exclusive_patches_mask(stash_id)) {
+                m_context.m_patches_info[q].lock.release_lock();
+            } else {
+                m_context.m_patches_info[q].lock.release_shared_lock();
+            }
+        }
         m_s_locked_patches_mask.reset(stash_id);
+        m_s_exclusive_patches_mask.reset(stash_id);
     }
 }
 
@@ -2582,11 +2962,13 @@ CavityManager<blockThreads, cop>::set_ownership_change_bitmask(
     m_s_ownership_change_mask_f.reset(block);
     block.sync();
 
-    for (int v = threadIdx.x; v < int(m_s_num_vertices[0]); v += blockThreads) {
-        assert(v < m_s_owned_mask_v.size());
-        if (!m_s_owned_mask_v(v) && m_s_in_cavity_v(v)) {
-            m_s_ownership_change_mask_v.set(v, true);
-        }
+    // not-owned vertices in a cavity, one word at a time
+    for (int w = threadIdx.x; w < DIVIDE_UP(int(m_s_num_vertices[0]), 32);
+         w += blockThreads) {
+        assert(w < DIVIDE_UP(m_s_owned_mask_v.size(), 32));
+        m_s_ownership_change_mask_v.m_bitmask[w] |=
+            m_s_in_cavity_v.m_bitmask[w] & ~m_s_owned_mask_v.m_bitmask[w] &
+            detail::word_valid_bits(m_s_num_vertices[0], w);
     }
 
     for (int f = threadIdx.x; f < int(m_s_num_faces[0]); f += blockThreads) {
@@ -2684,12 +3066,22 @@ __device__ __forceinline__ bool CavityManager<blockThreads, cop>::migrate(
 
     // lock all neighbors and make sure non is dirty
     if (!lock_neighbour_patches(block)) {
+        if (threadIdx.x == 0) {
+            m_context.count_cavity_stat(CavityStat::NeighborLockFailed);
+            m_context.trace_cavity(CavityTraceType::NeighborLockFailed,
+                                   patch_id());
+        }
         return false;
     }
 
 
     // make sure non of the locked q patches are dirty
     if (!ensure_locked_patches_are_not_dirty()) {
+        if (threadIdx.x == 0) {
+            m_s_deferred[0] = true;
+            m_context.count_cavity_stat(CavityStat::Dirty);
+            m_context.trace_cavity(CavityTraceType::NeighborDirty, patch_id());
+        }
         return false;
     }
 
@@ -2711,6 +3103,11 @@ __device__ __forceinline__ bool CavityManager<blockThreads, cop>::migrate(
 
     // make sure non of the locked q patches are dirty
     if (!ensure_locked_patches_are_not_dirty()) {
+        if (threadIdx.x == 0) {
+            m_s_deferred[0] = true;
+            m_context.count_cavity_stat(CavityStat::Dirty);
+            m_context.trace_cavity(CavityTraceType::NeighborDirty, patch_id());
+        }
         return false;
     }
 
@@ -2744,6 +3141,17 @@ __device__ __forceinline__ bool CavityManager<blockThreads, cop>::migrate(
         return false;
     }
 
+    // we are about to write to the patches that we have locked in the shared
+    // mode and so we need them exclusively
+    if (!upgrade_written_patches(block)) {
+        if (threadIdx.x == 0) {
+            m_context.count_cavity_stat(CavityStat::NeighborLockFailed);
+            m_context.trace_cavity(CavityTraceType::NeighborLockFailed,
+                                   patch_id());
+        }
+        return false;
+    }
+
     return true;
 }
 
@@ -2786,19 +3194,10 @@ CavityManager<blockThreads, cop>::lock_neighbour_patches(
     // return all_okay;
 
 
-    block.sync();
-    for (int st = 0; st < PatchStash::stash_size; ++st) {
-        assert(st < m_s_locked_patches_mask.size());
-        const uint32_t patch = m_s_patch_stash.get_patch(st);
-        if (patch != INVALID32) {
-            if (!lock(block, st, patch)) {
-                return false;
-            } else {
-                assert(m_s_locked_patches_mask(st));
-            }
-        }
-    }
-    return true;
+    // we only read from the neighbor patches until we know which of them we
+    // will write to (see upgrade_written_patches()) so they are locked in the
+    // shared mode
+    return lock_in_order(block, [](const uint8_t) { return true; });
 }
 
 template <uint32_t blockThreads, CavityOp cop>
@@ -2827,37 +3226,21 @@ CavityManager<blockThreads, cop>::lock_new_added_patches(
     // return true;
 
 
-    int pred = 1;
-
-    const int lid = lane_id();
-    const int wid = warp_id();
-
-    constexpr int num_warps = blockThreads / WARP_SIZE;
-
-    for (int st = wid; st < PatchStash::stash_size; st += num_warps) {
-        if (lid == 0 && m_s_patch_stash.get_patch(st) !=
-                            m_s_new_patch_stash.get_patch(st)) {
-            assert(st < m_s_locked_patches_mask.size());
-
-            // it is a new patch
-            const uint32_t q = m_s_patch_stash.get_patch(st);
-            if (q == INVALID32) {
-                continue;
-            }
+    // new patches are the ones that are in the patch stash but not in the
+    // new patch stash
+    const bool all_okay = lock_in_order(block, [&](const uint8_t st) {
+        return m_s_patch_stash.get_patch(st) !=
+               m_s_new_patch_stash.get_patch(st);
+    });
 
-            int okay =
-                m_context.m_patches_info[q].lock.acquire_lock(blockIdx.x);
-            if (okay) {
-                assert(st < m_s_locked_patches_mask.size());
-                m_s_locked_patches_mask.set(st, true);
-                m_s_new_patch_stash.m_stash[st] = q;
-            } else {
-                pred = 0;
+    if (threadIdx.x == 0) {
+        for (int st = 0; st < PatchStash::stash_size; ++st) {
+            if (m_s_locked_patches_mask(st)) {
+                m_s_new_patch_stash.m_stash[st] = m_s_patch_stash.get_patch(st);
             }
         }
     }
-
-    int all_okay = __syncthreads_and(pred);
+    block.sync();
 
     return all_okay;
 }
@@ -3388,6 +3771,11 @@ CavityManager<blockThreads, cop>::migrate_vertex(
                 // id in the stash
                 if (o_stash == INVALID8) {
                     o_stash = add_new_patch_to_patch_stash(o);
+                    if (o_stash == INVALID8) {
+                        // the patch stash is full
+                        m_s_should_slice[0] = true;
+                        return;
+                    }
                 }
 
                 assert(o_stash != INVALID8);
@@ -3490,6 +3878,11 @@ __device__ __forceinline__ void CavityManager<blockThreads, cop>::migrate_edge(
 
                 if (o_stash == INVALID8) {
                     o_stash = add_new_patch_to_patch_stash(o);
+                    if (o_stash == INVALID8) {
+                        // the patch stash is full
+                        m_s_should_slice[0] = true;
+                        return;
+                    }
                 }
                 assert(o_stash < PatchStash::stash_size);
                 assert(o_stash != INVALID8);
@@ -3589,6 +3982,11 @@ __device__ __forceinline__ void CavityManager<blockThreads, cop>::migrate_face(
 
                 if (o_stash == INVALID8) {
                     o_stash = add_new_patch_to_patch_stash(o);
+                    if (o_stash == INVALID8) {
+                        // the patch stash is full
+                        m_s_should_slice[0] = true;
+                        return;
+                    }
                 }
 
                 assert(o_stash != INVALID8);
@@ -3647,6 +4045,10 @@ CavityManager<blockThreads, cop>::add_new_patch_to_patch_stash(
     uint8_t ret =
         m_s_patch_stash.insert_patch(new_patch, m_s_patch_stash_mutex);
 
+    if (ret == INVALID8) {
+        return ret;
+    }
+
     if (m_s_new_patch_stash.get_patch(ret) == INVALID32) {
         m_s_new_patch_added[0] = true;
     }
@@ -3870,6 +4272,13 @@ CavityManager<blockThreads, cop>::change_ownership(
                     lp, nullptr, nullptr)) {
                 assert(false);
             }
+
+            if (m_context.m_change_log.is_enabled()) {
+                m_context.m_change_log.append(
+                    detail::moved_change_type<HandleT>(),
+                    detail::unique_id(local_id, m_patch_info.patch_id),
+                    detail::unique_id(local_id_in_owner_patch, owner_patch));
+            }
         }
     });
 }
@@ -3879,11 +4288,16 @@ template <typename AttributeT>
 __device__ __forceinline__ void
 CavityManager<blockThreads, cop>::update_attribute(AttributeT& attribute)
 {
-    using HandleT = typename AttributeT::HandleType;
-    using Type    = typename AttributeT::Type;
+    using AttrT   = std::remove_cv_t<AttributeT>;
+    using HandleT = typename AttrT::HandleType;
 
-    const uint32_t p        = m_patch_info.patch_id;
-    const uint32_t num_attr = attribute.get_num_attributes();
+    if constexpr (detail::is_attribute_update_policy<AttrT>::value) {
+        if constexpr (AttrT::update == AttributeUpdate::Skip) {
+            return;
+        }
+    }
+
+    const uint32_t p = m_patch_info.patch_id;
 
     auto copy_from_owner = [&](InverseLPHashTable& inv_lp,
                                const Bitmask&      s_ownership_change_mask,
@@ -3913,11 +4327,11 @@ CavityManager<blockThreads, cop>::update_attribute(AttributeT& attribute)
                     assert(local_id_in_owner_patch != INVALID16);
                     assert(owner_patch < m_context.m_max_num_patches);
 
-                    HandleT h(owner_patch, local_id_in_owner_patch);
-
-                    for (int attr = 0; attr < int(num_attr); ++attr) {
-                        attribute(p, local_id, attr) = attribute(h, attr);
-                    }
+                    detail::update_element(attribute,
+                                           p,
+                                           local_id,
+                                           owner_patch,
+                                           local_id_in_owner_patch);
                 }
             });
     };
@@ -4106,6 +4520,11 @@ __device__ __forceinline__ void CavityManager<blockThreads, cop>::epilogue(
     block.sync();
     if (m_write_to_gmem) {
 
+        count_cavities_stat(CavityStat::Committed, true);
+        if (m_s_recover[0]) {
+            count_recovered_stat();
+        }
+
         // update number of elements again since add_vertex/edge/face could have
         // changed it
         if (threadIdx.x == 0) {
@@ -4261,6 +4680,8 @@ __device__ __forceinline__ void CavityManager<blockThreads, cop>::epilogue(
             block.sync();
         }
 
+        log_changes();
+
         detail::store<blockThreads>(m_s_owned_mask_v.m_bitmask,
                                     DIVIDE_UP(m_s_num_vertices[0], 32),
                                     m_patch_info.owned_mask_v);
@@ -4288,6 +4709,8 @@ __device__ __forceinline__ void CavityManager<blockThreads, cop>::epilogue(
 
     if (m_s_should_slice[0]) {
         if (threadIdx.x == 0) {
+            m_context.count_cavity_stat(CavityStat::Sliced);
+            m_context.trace_cavity(CavityTraceType::Sliced, patch_id());
             m_context.m_patches_info[patch_id()].should_slice = true;
         }
     }
@@ -4297,7 +4720,19 @@ __device__ __forceinline__ void CavityManager<blockThreads, cop>::epilogue(
     // global memory)
     if ((m_s_should_slice[0] || !m_write_to_gmem /*|| m_s_migrated[0]*/) &&
         get_num_cavities() > 0) {
-        push();
+        // in persistent mode, patches that can only make progress after
+        // cleanup()/slice_patches() are deferred instead. Otherwise, they would
+        // be popped again by another block of the same launch
+        if (m_context.m_patch_scheduler.persistent &&
+            (m_s_should_slice[0] || m_s_deferred[0])) {
+            if (threadIdx.x == 0) {
+                m_context.m_patch_scheduler.defer(m_patch_info.patch_id);
+            }
+        } else {
+            // a patch that could not lock its neighbors is retried after the
+            // other patches in the queue
+            push(!m_s_should_slice[0]);
+        }
     }
 
     // unlock any neighbor patch we have locked
@@ -4305,6 +4740,11 @@ __device__ __forceinline__ void CavityManager<blockThreads, cop>::epilogue(
         unlock_locked_patches();
     }
 
+    if (threadIdx.x == 0) {
+        m_context.trace_cavity(
+            CavityTraceType::PatchDone, patch_id(), m_write_to_gmem ? 1 : 0);
+    }
+
     // unlock this patch
     unlock();
 }
@@ -0,0 +1,597 @@
+#pragma once
+
+#include <cooperative_groups.h>
+
+#include "rxmesh/attribute.h"
+#include "rxmesh/bitmask.cuh"
+#include "rxmesh/cavity_manager.cuh"
+#include "rxmesh/context.h"
+#include "rxmesh/handle.h"
+#include "rxmesh/kernels/collective.cuh"
+#include "rxmesh/kernels/for_each.cuh"
+#include "rxmesh/kernels/shmem_allocator.cuh"
+#include "rxmesh/query.cuh"
+
+namespace rxmesh {
+
+/**
+ * @brief Interpolation used by the batched cavity operations (see
+ * RXMeshDynamic::split_edges() and RXMeshDynamic::collapse_edges()) to set the
+ * attribute of the new vertex as the average of the two end vertices of the
+ * split/collapsed edge. Any functor/lambda with the same operator() can be used
+ * instead
+ */
+template <typename T>
+struct MidpointInterpolation
+{
+    MidpointInterpolation(const VertexAttribute<T>& attr) : m_attr(attr)
+    {
+    }
+
+    /**
+     * @param new_v the new vertex
+     * @param v0 the first end vertex of the split/collapsed edge
+     * @param v1 the second end vertex of the split/collapsed edge
+     * @param src the split/collapsed edge
+     */
+    __device__ __inline__ void operator()(const VertexHandle& new_v,
+                                          const VertexHandle& v0,
+                                          const VertexHandle& v1,
+                                          const EdgeHandle&   src) const
+    {
+        for (uint32_t i = 0; i < m_attr.get_num_attributes(); ++i) {
+            m_attr(new_v, i) = (m_attr(v0, i) + m_attr(v1, i)) * T(0.5);
+        }
+    }
+
+    VertexAttribute<T> m_attr;
+};
+
+/**
+ * @brief Interpolation that sets the attribute of the new vertex from a
+ * per-edge value e.g., the optimal collapse position computed by QSlim
+ */
+template <typename T>
+struct EdgeValueInterpolation
+{
+    EdgeValueInterpolation(const VertexAttribute<T>& attr,
+                           const EdgeAttribute<T>&   value)
+        : m_attr(attr), m_value(value)
+    {
+    }
+
+    __device__ __inline__ void operator()(const VertexHandle& new_v,
+                                          const VertexHandle& v0,
+                                          const VertexHandle& v1,
+                                          const EdgeHandle&   src) const
+    {
+        for (uint32_t i = 0; i < m_attr.get_num_attributes(); ++i) {
+            m_attr(new_v, i) = m_value(src, i);
+        }
+    }
+
+    VertexAttribute<T> m_attr;
+    EdgeAttribute<T>   m_value;
+};
+
+/**
+ * @brief the dynamic shared memory used by count_link_vertices() and
+ * link_condition() for a patch with num_vertices vertices and num_edges edges
+ * (or their capacities). Should be added to the launch box shared memory
+ */
+__host__ __device__ __inline__ uint32_t
+link_condition_shmem_bytes(const uint32_t num_vertices,
+                           const uint32_t num_edges)
+{
+    return (num_vertices + 1) * sizeof(uint32_t) +
+           2 * num_edges * sizeof(uint16_t) +
+           2 * ShmemAllocator::default_alignment;
+}
+
+/**
+ * @brief count the vertices in the link of every edge marked in edge_mask
+ * i.e., the vertices shared between the one ring of the edge two end vertices
+ * (not counting the end vertices themselves). The (patch-local) vertex-vertex
+ * adjacency of all active edges in the patch (including not-owned ones) is
+ * built once in shared memory from the output of ev_query and then every
+ * marked edge is processed by one thread by intersecting the one ring of its
+ * two end vertices, i.e., all marked edges are processed concurrently. All
+ * threads in the block should call this function. The shared memory is
+ * released before returning (see link_condition_shmem_bytes())
+ * @param ev_query a query that computed Op::EV or Op::EVDiamond
+ * @param shrd_alloc the allocator of the scratch space
+ * @param edge_mask the edges to process
+ * @param v0_index, v1_index the position of the edge two end vertices in the
+ * output of ev_query i.e., 0 and 1 for Op::EV and 0 and 2 for Op::EVDiamond
+ * @param op [&](uint16_t e, uint16_t num_shared) called on the thread that
+ * processed the edge e (a local index) with the link size
+ */
+template <uint32_t blockThreads, typename OpT>
+__device__ __inline__ void count_link_vertices(
+    cooperative_groups::thread_block& block,
+    const PatchInfo&                  patch_info,
+    Query<blockThreads>&              ev_query,
+    ShmemAllocator&                   shrd_alloc,
+    const Bitmask&                    edge_mask,
+    const int                         v0_index,
+    const int                         v1_index,
+    OpT                               op)
+{
+    const uint16_t num_v = patch_info.num_vertices[0];
+    const uint16_t num_e = patch_info.num_edges[0];
+
+    const uint32_t before = shrd_alloc.get_allocated_size_bytes();
+
+    // the one ring of vertex v is s_vv[s_offset[v - 1], s_offset[v]) once
+    // the adjacency is filled in (s_offset[-1] being 0)
+    uint32_t* s_offset = shrd_alloc.alloc<uint32_t>(num_v + 1);
+    uint16_t* s_vv     = shrd_alloc.alloc<uint16_t>(2 * num_e);
+
+    for (uint16_t v = threadIdx.x; v <= num_v; v += blockThreads) {
+        s_offset[v] = 0;
+    }
+    block.sync();
+
+    auto end_vertices = [&](const uint16_t e, uint16_t& v0, uint16_t& v1) {
+        const VertexIterator iter =
+            ev_query.template get_iterator<VertexIterator>(e);
+        v0 = iter.local(v0_index);
+        v1 = iter.local(v1_index);
+    };
+
+    // 1) valence
+    for_each_edge(
+        patch_info,
+        [&](EdgeHandle eh) {
+            uint16_t v0, v1;
+            end_vertices(eh.local_id(), v0, v1);
+            ::atomicAdd(s_offset + v0, 1u);
+            ::atomicAdd(s_offset + v1, 1u);
+        },
+        true);
+    block.sync();
+
+    detail::cub_block_exclusive_sum<uint32_t, blockThreads>(s_offset, num_v);
+    block.sync();
+
+    // 2) fill in the one rings which moves s_offset[v] to the end of v's one
+    // ring
+    for_each_edge(
+        patch_info,
+        [&](EdgeHandle eh) {
+            uint16_t v0, v1;
+            end_vertices(eh.local_id(), v0, v1);
+            s_vv[::atomicAdd(s_offset + v0, 1u)] = v1;
+            s_vv[::atomicAdd(s_offset + v1, 1u)] = v0;
+        },
+        true);
+    block.sync();
+
+    // 3) intersect the two one rings of every marked edge
+    const uint16_t num_mask =
+        edge_mask.size() < num_e ? edge_mask.size() : num_e;
+    for (uint16_t e = threadIdx.x; e < num_mask; e += blockThreads) {
+        if (!edge_mask(e) || detail::is_deleted(e, patch_info.active_mask_e)) {
+            continue;
+        }
+        uint16_t v0, v1;
+        end_vertices(e, v0, v1);
+
+        const uint32_t v0_start = (v0 == 0) ? 0 : s_offset[v0 - 1];
+        const uint32_t v1_start = (v1 == 0) ? 0 : s_offset[v1 - 1];
+
+        uint16_t num_shared = 0;
+        for (uint32_t i = v0_start; i < s_offset[v0]; ++i) {
+            const uint16_t w = s_vv[i];
+            if (w == v1) {
+                continue;
+            }
+            // skip duplicates in v0's one ring (e.g., a duplicate edge)
+            bool seen = false;
+            for (uint32_t k = v0_start; k < i && !seen; ++k) {
+                seen = s_vv[k] == w;
+            }
+            if (seen) {
+                continue;
+            }
+            for (uint32_t j = v1_start; j < s_offset[v1]; ++j) {
+                if (s_vv[j] == w) {
+                    num_shared++;
+                    break;
+                }
+            }
+        }
+        op(e, num_shared);
+    }
+    block.sync();
+
+    shrd_alloc.dealloc(shrd_alloc.get_allocated_size_bytes() - before);
+}
+
+/**
+ * @brief check the link condition (used for edge collapse and edge flip) of
+ * every edge marked in edge_mask. The edge bit is cleared if the edge two end
+ * vertices share more than two vertices in their one ring. With
+ * reject_boundary, the edge bit is also cleared if they share less than two
+ * vertices i.e., boundary edges are also rejected. See count_link_vertices()
+ * for the parameters
+ */
+template <uint32_t blockThreads>
+__device__ __inline__ void link_condition(
+    cooperative_groups::thread_block& block,
+    const PatchInfo&                  patch_info,
+    Query<blockThreads>&              ev_query,
+    ShmemAllocator&                   shrd_alloc,
+    Bitmask&                          edge_mask,
+    const int                         v0_index        = 0,
+    const int                         v1_index        = 2,
+    const bool                        reject_boundary = false)
+{
+    count_link_vertices(
+        block,
+        patch_info,
+        ev_query,
+        shrd_alloc,
+        edge_mask,
+        v0_index,
+        v1_index,
+        [&](const uint16_t e, const uint16_t num_shared) {
+            if (num_shared > 2 || (reject_boundary && num_shared != 2)) {
+                edge_mask.reset(e, true);
+            }
+        });
+}
+
+namespace detail {
+
+/**
+ * @brief check that the edge diamond stored in iter (as computed by
+ * Op::EVDiamond) is not on the boundary and is not degenerate. iter[0] and
+ * iter[2] are the edge two vertices and iter[1] and iter[3] are the two
+ * opposite vertices
+ */
+__device__ __inline__ bool is_valid_diamond(const VertexIterator& iter)
+{
+    if (!iter[1].is_valid() || !iter[3].is_valid()) {
+        return false;
+    }
+    return iter[0] != iter[1] && iter[0] != iter[2] && iter[0] != iter[3] &&
+           iter[1] != iter[2] && iter[1] != iter[3] && iter[2] != iter[3];
+}
+
+/**
+ * @brief after the epilogue, clear edge_mask for the edges whose cavities were
+ * committed and count them in d_count
+ */
+template <uint32_t blockThreads, CavityOp cop>
+__device__ __inline__ void finalize_cavity_op(
+    cooperative_groups::thread_block& block,
+    CavityManager<blockThreads, cop>& cavity,
+    EdgeAttribute<bool>&              edge_mask,
+    const Bitmask&                    done,
+    uint32_t*                         d_count)
+{
+    block.sync();
+    if (!cavity.is_successful()) {
+        return;
+    }
+    const uint32_t pid = cavity.patch_id();
+    for (uint16_t e = threadIdx.x; e < done.size(); e += blockThreads) {
+        if (done(e)) {
+            edge_mask(EdgeHandle(pid, {e})) = false;
+        }
+    }
+    if (threadIdx.x == 0 && cavity.get_num_cavities() > 0) {
+        ::atomicAdd(d_count, uint32_t(cavity.get_num_cavities()));
+    }
+}
+
+/**
+ * @brief split every (interior) edge marked in edge_mask by inserting a new
+ * vertex connected to the four vertices of the edge diamond
+ */
+template <uint32_t blockThreads, typename InterpT, typename... AttributesT>
+__global__ static void __launch_bounds__(blockThreads)
+    split_edges(Context             context,
+                EdgeAttribute<bool> edge_mask,
+                InterpT             interp,
+                uint32_t*           d_count,
+                AttributesT... attributes)
+{
+    auto           block = cooperative_groups::this_thread_block();
+    ShmemAllocator shrd_alloc;
+
+    CavityManager<blockThreads, CavityOp::E> cavity(
+        block, context, shrd_alloc, true);
+
+    if (cavity.patch_id() == INVALID32) {
+        return;
+    }
+
+    Bitmask done(cavity.patch_info().edges_capacity, shrd_alloc);
+    done.reset(block);
+
+    const uint32_t shmem_before = shrd_alloc.get_allocated_size_bytes();
+
+    Query<blockThreads> query(context, cavity.patch_id());
+    query.prologue<Op::EVDiamond>(block, shrd_alloc);
+    block.sync();
+
+    for_each_edge(cavity.patch_info(), [&](EdgeHandle eh) {
+        if (edge_mask(eh)) {
+            if (is_valid_diamond(query.template get_iterator<VertexIterator>(
+                    eh.local_id()))) {
+                cavity.create(eh);
+            } else {
+                edge_mask(eh) = false;
+            }
+        }
+    });
+    block.sync();
+
+    shrd_alloc.dealloc(shrd_alloc.get_allocated_size_bytes() - shmem_before);
+
+    if (cavity.prologue(block, shrd_alloc, edge_mask, attributes...)) {
+
+        cavity.for_each_cavity(block, [&](uint16_t c, uint16_t size) {
+            assert(size == 4);
+
+            const EdgeHandle   src = cavity.template get_creator<EdgeHandle>(c);
+            const VertexHandle v0  = cavity.get_cavity_vertex(c, 0);
+            const VertexHandle v1  = cavity.get_cavity_vertex(c, 2);
+
+            const VertexHandle new_v = cavity.add_vertex();
+            if (!new_v.is_valid()) {
+                return;
+            }
+            interp(new_v, v0, v1, src);
+
+            DEdgeHandle e0 =
+                cavity.add_edge(new_v, cavity.get_cavity_vertex(c, 0));
+            const DEdgeHandle e_init = e0;
+            if (!e0.is_valid()) {
+                return;
+            }
+            edge_mask(e0.get_edge_handle()) = false;
+
+            for (uint16_t i = 0; i < size; ++i) {
+                const DEdgeHandle e = cavity.get_cavity_edge(c, i);
+                const DEdgeHandle e1 =
+                    (i == size - 1) ?
+                        e_init.get_flip_dedge() :
+                        cavity.add_edge(cavity.get_cavity_vertex(c, i + 1),
+                                        new_v);
+                if (!e1.is_valid()) {
+                    return;
+                }
+                edge_mask(e1.get_edge_handle()) = false;
+
+                if (!cavity.add_face(e0, e, e1).is_valid()) {
+                    return;
+                }
+                e0 = e1.get_flip_dedge();
+            }
+            done.set(src.local_id(), true);
+        });
+    }
+
+    cavity.epilogue(block);
+
+    finalize_cavity_op(block, cavity, edge_mask, done, d_count);
+}
+
+/**
+ * @brief collapse every (interior) edge marked in edge_mask that passes the
+ * link condition into a new vertex
+ */
+template <uint32_t blockThreads, typename InterpT, typename... AttributesT>
+__global__ static void __launch_bounds__(blockThreads)
+    collapse_edges(Context             context,
+                   EdgeAttribute<bool> edge_mask,
+                   InterpT             interp,
+                   uint32_t*           d_count,
+                   AttributesT... attributes)
+{
+    auto           block = cooperative_groups::this_thread_block();
+    ShmemAllocator shrd_alloc;
+
+    CavityManager<blockThreads, CavityOp::EV> cavity(
+        block, context, shrd_alloc, true);
+
+    if (cavity.patch_id() == INVALID32) {
+        return;
+    }
+
+    const PatchInfo& pi = cavity.patch_info();
+
+    // the edges to collapse and later the collapsed edges
+    Bitmask done(pi.edges_capacity, shrd_alloc);
+    done.reset(block);
+
+    const uint32_t shmem_before = shrd_alloc.get_allocated_size_bytes();
+
+    Query<blockThreads> query(context, cavity.patch_id());
+    query.prologue<Op::EVDiamond>(block, shrd_alloc);
+    block.sync();
+
+    for_each_edge(pi, [&](EdgeHandle eh) {
+        if (edge_mask(eh)) {
+            if (is_valid_diamond(query.template get_iterator<VertexIterator>(
+                    eh.local_id()))) {
+                done.set(eh.local_id(), true);
+            } else {
+                edge_mask(eh) = false;
+            }
+        }
+    });
+    block.sync();
+
+    link_condition(block, pi, query, shrd_alloc, done);
+    block.sync();
+
+    for_each_edge(pi, [&](EdgeHandle eh) {
+        if (done(eh.local_id())) {
+            cavity.create(eh);
+        } else if (edge_mask(eh)) {
+            // failed the link condition
+            edge_mask(eh) = false;
+        }
+    });
+    block.sync();
+
+    shrd_alloc.dealloc(shrd_alloc.get_allocated_size_bytes() - shmem_before);
+
+    done.reset(block);
+    block.sync();
+
+    if (cavity.prologue(block, shrd_alloc, edge_mask, attributes...)) {
+
+        cavity.for_each_cavity(block, [&](uint16_t c, uint16_t size) {
+            const EdgeHandle src = cavity.template get_creator<EdgeHandle>(c);
+
+            VertexHandle v0, v1;
+            cavity.get_vertices(src, v0, v1);
+
+            const VertexHandle new_v = cavity.add_vertex();
+            if (!new_v.is_valid()) {
+                return;
+            }
+            interp(new_v, v0, v1, src);
+
+            DEdgeHandle e0 =
+                cavity.add_edge(new_v, cavity.get_cavity_vertex(c, 0));
+            const DEdgeHandle e_init = e0;
+            if (!e0.is_valid()) {
+                return;
+            }
+            edge_mask(e0.get_edge_handle()) = false;
+
+            for (uint16_t i = 0; i < size; ++i) {
+                const DEdgeHandle e = cavity.get_cavity_edge(c, i);
+                const DEdgeHandle e1 =
+                    (i == size - 1) ?
+                        e_init.get_flip_dedge() :
+                        cavity.add_edge(cavity.get_cavity_vertex(c, i + 1),
+                                        new_v);
+                if (!e1.is_valid()) {
+                    return;
+                }
+                edge_mask(e1.get_edge_handle()) = false;
+
+                if (!cavity.add_face(e0, e, e1).is_valid()) {
+                    return;
+                }
+                e0 = e1.get_flip_dedge();
+            }
+            done.set(src.local_id(), true);
+        });
+    }
+
+    cavity.epilogue(block);
+
+    finalize_cavity_op(block, cavity, edge_mask, done, d_count);
+}
+
+/**
+ * @brief flip every (interior) edge marked in edge_mask whose two end vertices
+ * have valence > 3 and that passes the link condition
+ */
+template <uint32_t blockThreads, typename... AttributesT>
+__global__ static void __launch_bounds__(blockThreads)
+    flip_edges(Context             context,
+               EdgeAttribute<bool> edge_mask,
+               uint32_t*           d_count,
+               AttributesT... attributes)
+{
+    auto           block = cooperative_groups::this_thread_block();
+    ShmemAllocator shrd_alloc;
+
+    CavityManager<blockThreads, CavityOp::E> cavity(
+        block, context, shrd_alloc, false);
+
+    if (cavity.patch_id() == INVALID32) {
+        return;
+    }
+
+    const PatchInfo& pi = cavity.patch_info();
+
+    Bitmask done(pi.edges_capacity, shrd_alloc);
+    done.reset(block);
+
+    const uint32_t shmem_before = shrd_alloc.get_allocated_size_bytes();
+
+    Query<blockThreads> query(context, cavity.patch_id());
+    query.compute_vertex_valence(block, shrd_alloc);
+    query.prologue<Op::EVDiamond>(block, shrd_alloc);
+    block.sync();
+
+    for_each_edge(pi, [&](EdgeHandle eh) {
+        if (edge_mask(eh)) {
+            const VertexIterator iter =
+                query.template get_iterator<VertexIterator>(eh.local_id());
+            if (is_valid_diamond(iter) &&
+                query.vertex_valence(iter.local(0)) > 3 &&
+                query.vertex_valence(iter.local(2)) > 3) {
+                done.set(eh.local_id(), true);
+            } else {
+                edge_mask(eh) = false;
+            }
+        }
+    });
+    block.sync();
+
+    link_condition(block, pi, query, shrd_alloc, done);
+    block.sync();
+
+    for_each_edge(pi, [&](EdgeHandle eh) {
+        if (done(eh.local_id())) {
+            cavity.create(eh);
+        } else if (edge_mask(eh)) {
+            edge_mask(eh) = false;
+        }
+    });
+    block.sync();
+
+    shrd_alloc.dealloc(shrd_alloc.get_allocated_size_bytes() - shmem_before);
+
+    done.reset(block);
+    block.sync();
+
+    if (cavity.prologue(block, shrd_alloc, edge_mask, attributes...)) {
+
+        cavity.for_each_cavity(block, [&](uint16_t c, uint16_t size) {
+            assert(size == 4);
+
+            const EdgeHandle src = cavity.template get_creator<EdgeHandle>(c);
+
+            const DEdgeHandle new_edge = cavity.add_edge(
+                cavity.get_cavity_vertex(c, 1), cavity.get_cavity_vertex(c, 3));
+            if (!new_edge.is_valid()) {
+                return;
+            }
+            edge_mask(new_edge.get_edge_handle()) = false;
+
+            if (!cavity
+                     .add_face(cavity.get_cavity_edge(c, 0),
+                               new_edge,
+                               cavity.get_cavity_edge(c, 3))
+                     .is_valid()) {
+                return;
+            }
+            if (!cavity
+                     .add_face(cavity.get_cavity_edge(c, 1),
+                               cavity.get_cavity_edge(c, 2),
+                               new_edge.get_flip_dedge())
+                     .is_valid()) {
+                return;
+            }
+            done.set(src.local_id(), true);
+        });
+    }
+
+    cavity.epilogue(block);
+
+    finalize_cavity_op(block, cavity, edge_mask, done, d_count);
+}
+}  // namespace detail
+}  // namespace rxmesh
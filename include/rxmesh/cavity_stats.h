@@ -0,0 +1,112 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "rxmesh/util/log.h"
+
+namespace rxmesh {
+
+/**
+ * @brief index of the device counters of CavityStats. The counters are updated
+ * by CavityManager when the statistics are enabled (see
+ * RXMeshDynamic::enable_cavity_stats())
+ */
+enum class CavityStat : uint32_t
+{
+    // cavities created by create()
+    Created = 0,
+    // cavities deactivated because they overlap with other cavities in the
+    // same patch (i.e., not in the maximal independent set)
+    Conflicting = 1,
+    // cavities whose changes were written to global memory
+    Committed = 2,
+    // cavities recovered (i.e., rolled back) using recover()
+    Recovered = 3,
+    // patches popped from the scheduler but could not be locked
+    PatchLockFailed = 4,
+    // patches that could not lock all their neighbor patches
+    NeighborLockFailed = 5,
+    // patches skipped because they or one of their neighbors were dirty
+    Dirty = 6,
+    // patches flagged to be sliced because they ran out of capacity
+    Sliced = 7,
+    // patches pushed again to the scheduler
+    Pushed = 8,
+    // patches processed i.e., popped and locked
+    Processed = 9,
+    Count     = 10,
+};
+
+/**
+ * @brief Statistics of the cavity operations done by dynamic kernels as
+ * returned by RXMeshDynamic::get_cavity_stats(). These are aggregated over
+ * all kernel launches since the last RXMeshDynamic::reset_cavity_stats()
+ */
+struct CavityStats
+{
+    uint64_t num_created              = 0;
+    uint64_t num_conflicting          = 0;
+    uint64_t num_committed            = 0;
+    uint64_t num_recovered            = 0;
+    uint64_t num_patch_lock_failed    = 0;
+    uint64_t num_neighbor_lock_failed = 0;
+    uint64_t num_dirty                = 0;
+    uint64_t num_sliced               = 0;
+    uint64_t num_pushed               = 0;
+    uint64_t num_processed            = 0;
+
+    /**
+     * @brief set the statistics from the device counters (indexed by
+     * CavityStat)
+     */
+    void set(const unsigned long long* counters)
+    {
+        auto get = [&](CavityStat s) {
+            return static_cast<uint64_t>(counters[uint32_t(s)]);
+        };
+        num_created              = get(CavityStat::Created);
+        num_conflicting          = get(CavityStat::Conflicting);
+        num_committed            = get(CavityStat::Committed);
+        num_recovered            = get(CavityStat::Recovered);
+        num_patch_lock_failed    = get(CavityStat::PatchLockFailed);
+        num_neighbor_lock_failed = get(CavityStat::NeighborLockFailed);
+        num_dirty                = get(CavityStat::Dirty);
+        num_sliced               = get(CavityStat::Sliced);
+        num_pushed               = get(CavityStat::Pushed);
+        num_processed            = get(CavityStat::Processed);
+    }
+
+    /**
+     * @brief ratio of the created cavities that were not committed i.e.,
+     * wasted work
+     */
+    double wasted_ratio() const
+    {
+        if (num_created == 0) {
+            return 0;
+        }
+        return 1.0 - double(num_committed) / double(num_created);
+    }
+
+    void print() const
+    {
+        RXMESH_INFO(
+            "Cavities: {} created, {} conflicting, {} committed, {} recovered "
+            "(wasted = {}%)",
+            num_created,
+            num_conflicting,
+            num_committed,
+            num_recovered,
+            100.0 * wasted_ratio());
+        RXMESH_INFO(
+            "Patches: {} processed, {} lock failed, {} neighbor lock failed, "
+            "{} dirty, {} sliced, {} re-pushed",
+            num_processed,
+            num_patch_lock_failed,
+            num_neighbor_lock_failed,
+            num_dirty,
+            num_sliced,
+            num_pushed);
+    }
+};
+}  // namespace rxmesh
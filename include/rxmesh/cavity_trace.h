@@ -0,0 +1,321 @@
+#pragma once
+
+#include <stdint.h>
+#include <algorithm>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "rxmesh/util/log.h"
+#include "rxmesh/util/macros.h"
+
+namespace rxmesh {
+
+/**
+ * @brief the type of an event recorded in the cavity trace (see
+ * RXMeshDynamic::enable_cavity_trace()). Events are recorded by thread 0 of
+ * the block that works on the patch
+ */
+enum class CavityTraceType : uint16_t
+{
+    // a patch popped from the scheduler
+    PatchPopped = 0,
+    // a popped patch that could not be locked
+    PatchLockFailed = 1,
+    // a locked patch skipped because it is dirty
+    PatchDirty = 2,
+    // a patch locked and processed i.e., the start of the patch span
+    PatchLocked = 3,
+    // the cavities created in the patch (value = number of cavities)
+    Cavities = 4,
+    // a patch that could not lock all its neighbor patches
+    NeighborLockFailed = 5,
+    // a patch with a dirty neighbor patch
+    NeighborDirty = 6,
+    // a patch flagged to be sliced because it ran out of capacity
+    Sliced = 7,
+    // a patch pushed again to the scheduler
+    Pushed = 8,
+    // the block is done with the patch i.e., the end of the patch span
+    // (value = 1 if the changes were written to global memory)
+    PatchDone = 9,
+    Count     = 10,
+};
+
+inline std::string trace_type_to_string(const CavityTraceType type)
+{
+    switch (type) {
+        case CavityTraceType::PatchPopped:
+            return "popped";
+        case CavityTraceType::PatchLockFailed:
+            return "lock_failed";
+        case CavityTraceType::PatchDirty:
+            return "dirty";
+        case CavityTraceType::PatchLocked:
+            return "locked";
+        case CavityTraceType::Cavities:
+            return "cavities";
+        case CavityTraceType::NeighborLockFailed:
+            return "neighbor_lock_failed";
+        case CavityTraceType::NeighborDirty:
+            return "neighbor_dirty";
+        case CavityTraceType::Sliced:
+            return "sliced";
+        case CavityTraceType::Pushed:
+            return "pushed";
+        case CavityTraceType::PatchDone:
+            return "done";
+        default:
+            return "unknown";
+    }
+}
+
+/**
+ * @brief one event of the cavity trace (32 bytes). clock is the SM-local
+ * clock64() and global_ns is the device-wide %globaltimer (in ns) which has
+ * a coarser resolution but is comparable across SMs
+ */
+struct CavityTraceRecord
+{
+    uint64_t global_ns;
+    uint64_t clock;
+    uint32_t patch_id;
+    uint32_t value;
+    uint32_t block;
+    uint16_t sm;
+    uint16_t type;
+};
+static_assert(sizeof(CavityTraceRecord) == 32);
+
+namespace detail {
+/**
+ * @brief the device side of the cavity trace. The records are split into
+ * num_slots ring buffers of capacity records each and a block writes to the
+ * ring buffer blockIdx.x % num_slots such that the atomic on the ring buffer
+ * counter is (mostly) not contended. The counters keep counting after a ring
+ * buffer wraps around so the host can detect the overwritten records
+ */
+struct DeviceCavityTrace
+{
+    __host__ __device__ DeviceCavityTrace()
+        : m_records(nullptr), m_count(nullptr), m_num_slots(0), m_capacity(0)
+    {
+    }
+
+    __host__ __device__ bool is_enabled() const
+    {
+        return m_records != nullptr;
+    }
+
+    __device__ __inline__ void record(const CavityTraceType type,
+                                      const uint32_t        patch_id,
+                                      const uint32_t        value)
+    {
+#ifdef __CUDA_ARCH__
+        if (m_records == nullptr) {
+            return;
+        }
+        CavityTraceRecord r;
+        asm volatile("mov.u64 %0, %%globaltimer;" : "=l"(r.global_ns));
+        r.clock = clock64();
+        uint32_t smid;
+        asm volatile("mov.u32 %0, %%smid;" : "=r"(smid));
+
+        r.patch_id = patch_id;
+        r.value    = value;
+        r.block    = blockIdx.x;
+        r.sm       = static_cast<uint16_t>(smid);
+        r.type     = static_cast<uint16_t>(type);
+
+        const uint32_t slot = blockIdx.x % m_num_slots;
+        const uint32_t pos  = ::atomicAdd(m_count + slot, 1u) % m_capacity;
+
+        m_records[slot * m_capacity + pos] = r;
+#endif
+    }
+
+    CavityTraceRecord* m_records;
+    uint32_t*          m_count;
+    uint32_t           m_num_slots;
+    uint32_t           m_capacity;
+};
+}  // namespace detail
+
+/**
+ * @brief the cavity trace as returned by RXMeshDynamic::get_cavity_trace().
+ * The records are sorted by SM and then by clock
+ */
+struct CavityTrace
+{
+    std::vector<CavityTraceRecord> records;
+
+    // the number of records overwritten because a ring buffer wrapped around
+    uint64_t num_dropped = 0;
+
+    // the SM clock rate used to convert clock64() to time
+    double clock_rate_khz = 0;
+
+    /**
+     * @brief the number of records of a given type
+     */
+    uint64_t count(const CavityTraceType type) const
+    {
+        return std::count_if(
+            records.begin(), records.end(), [&](const CavityTraceRecord& r) {
+                return r.type == uint16_t(type);
+            });
+    }
+
+    /**
+     * @brief the time of every record in ns since the first record. The clock
+     * of each SM is anchored to the globaltimer of the first record on that
+     * SM and advanced by its clock64() which has better resolution than the
+     * globaltimer. Requires the records to be sorted (as done by
+     * RXMeshDynamic::get_cavity_trace())
+     */
+    std::vector<double> timestamps_ns() const
+    {
+        std::vector<double> ts(records.size(), 0.0);
+        if (records.empty()) {
+            return ts;
+        }
+
+        const double ns_per_clock =
+            (clock_rate_khz > 0) ? 1e6 / clock_rate_khz : 1.0;
+
+        uint64_t g_min = records[0].global_ns;
+        for (const auto& r : records) {
+            g_min = std::min(g_min, r.global_ns);
+        }
+
+        size_t first = 0;
+        for (size_t i = 0; i < records.size(); ++i) {
+            if (records[i].sm != records[first].sm) {
+                first = i;
+            }
+            const CavityTraceRecord& r0 = records[first];
+            ts[i] = double(r0.global_ns - g_min) +
+                    double(int64_t(records[i].clock - r0.clock)) *
+                        ns_per_clock;
+        }
+        return ts;
+    }
+
+    /**
+     * @brief write the trace in the Chrome trace event format (JSON) that can
+     * be viewed with Perfetto (ui.perfetto.dev) or chrome://tracing. Every SM
+     * is a process and every block is a thread. The time a block spends on a
+     * patch (from PatchLocked to PatchDone) is a complete event and all other
+     * records are instant events
+     */
+    bool write_chrome_trace(const std::string& filename) const
+    {
+        std::ofstream file(filename);
+        if (!file.is_open()) {
+            RXMESH_ERROR(
+                "CavityTrace::write_chrome_trace() can not open file {}",
+                filename);
+            return false;
+        }
+
+        const std::vector<double> ts = timestamps_ns();
+
+        // the order of the records per (SM, block) by time
+        std::vector<size_t> order(records.size());
+        for (size_t i = 0; i < order.size(); ++i) {
+            order[i] = i;
+        }
+        std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+            const CavityTraceRecord& ra = records[a];
+            const CavityTraceRecord& rb = records[b];
+            if (ra.sm != rb.sm) {
+                return ra.sm < rb.sm;
+            }
+            if (ra.block != rb.block) {
+                return ra.block < rb.block;
+            }
+            return ts[a] < ts[b];
+        });
+
+        bool first_event = true;
+        auto begin_event = [&]() {
+            file << (first_event ? "\n" : ",\n");
+            first_event = false;
+        };
+
+        file << "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [";
+
+        // name the processes after the SMs
+        uint32_t last_sm = INVALID32;
+        for (size_t i : order) {
+            if (records[i].sm != last_sm) {
+                last_sm = records[i].sm;
+                begin_event();
+                file << "{\"name\": \"process_name\", \"ph\": \"M\", "
+                     << "\"pid\": " << last_sm << ", \"args\": {\"name\": "
+                     << "\"SM " << last_sm << "\"}}";
+            }
+        }
+
+        auto write_instant = [&](size_t i) {
+            const CavityTraceRecord& r = records[i];
+            begin_event();
+            file << "{\"name\": \""
+                 << trace_type_to_string(CavityTraceType(r.type))
+                 << "\", \"cat\": \"event\", \"ph\": \"i\", \"s\": \"t\", "
+                 << "\"ts\": " << ts[i] * 1e-3 << ", \"pid\": " << r.sm
+                 << ", \"tid\": " << r.block << ", \"args\": {\"patch\": "
+                 << r.patch_id << ", \"value\": " << r.value << "}}";
+        };
+
+        // the index (in records) of the PatchLocked record of the current
+        // block that is not matched with a PatchDone yet. A span that can not
+        // be matched (e.g., its record was overwritten) is written as an
+        // instant event
+        const size_t none = records.size();
+        size_t       open = none;
+
+        for (size_t k = 0; k < order.size(); ++k) {
+            const size_t             i = order[k];
+            const CavityTraceRecord& r = records[i];
+
+            if (open != none && (records[open].sm != r.sm ||
+                                 records[open].block != r.block)) {
+                write_instant(open);
+                open = none;
+            }
+
+            if (r.type == uint16_t(CavityTraceType::PatchLocked)) {
+                if (open != none) {
+                    write_instant(open);
+                }
+                open = i;
+                continue;
+            }
+
+            if (r.type == uint16_t(CavityTraceType::PatchDone) &&
+                open != none && records[open].patch_id == r.patch_id) {
+                begin_event();
+                file << "{\"name\": \"patch " << r.patch_id
+                     << "\", \"cat\": \"patch\", \"ph\": \"X\", \"ts\": "
+                     << ts[open] * 1e-3
+                     << ", \"dur\": " << (ts[i] - ts[open]) * 1e-3
+                     << ", \"pid\": " << r.sm << ", \"tid\": " << r.block
+                     << ", \"args\": {\"patch\": " << r.patch_id
+                     << ", \"value\": " << r.value << "}}";
+                open = none;
+                continue;
+            }
+
+            write_instant(i);
+        }
+        if (open != none) {
+            write_instant(open);
+        }
+
+        file << "\n]}\n";
+        file.close();
+        return true;
+    }
+};
+}  // namespace rxmesh
@@ -0,0 +1,164 @@
+#pragma once
+
+#include <stdint.h>
+#include <type_traits>
+
+#include "rxmesh/handle.h"
+#include "rxmesh/util/macros.h"
+
+namespace rxmesh {
+
+/**
+ * @brief the type of a topology change recorded in the change log (see
+ * RXMeshDynamic::enable_change_log())
+ */
+enum class ChangeType : uint32_t
+{
+    // a mesh element added by the user during the cavity fill-in
+    CreatedVertex = 0,
+    CreatedEdge   = 1,
+    CreatedFace   = 2,
+    // a mesh element deleted as part of a cavity
+    DeletedVertex = 3,
+    DeletedEdge   = 4,
+    DeletedFace   = 5,
+    // a mesh element whose owner patch has changed (because it is inside a
+    // cavity that is not owned by its owner patch). old_handle is its handle
+    // before the change and handle is its handle after the change
+    MovedVertex = 6,
+    MovedEdge   = 7,
+    MovedFace   = 8,
+};
+
+/**
+ * @brief one entry in the change log. handle and old_handle are the unique id
+ * of the mesh element handles (e.g., VertexHandle::unique_id()) with the patch
+ * id in the high bits and the local index in the low bits
+ */
+struct ChangeLogEntry
+{
+    uint64_t   handle;
+    uint64_t   old_handle;
+    ChangeType type;
+};
+
+namespace detail {
+/**
+ * @brief the ChangeType of an ownership change of HandleT
+ */
+template <typename HandleT>
+constexpr __host__ __device__ ChangeType moved_change_type()
+{
+    if constexpr (std::is_same_v<HandleT, VertexHandle>) {
+        return ChangeType::MovedVertex;
+    }
+    if constexpr (std::is_same_v<HandleT, EdgeHandle>) {
+        return ChangeType::MovedEdge;
+    }
+    return ChangeType::MovedFace;
+}
+
+/**
+ * @brief the device side of the change log. Entries are appended by
+ * CavityManager::epilogue() with one atomic operation per 32 elements. The
+ * counter keeps counting after the log is full so the host can detect
+ * overflow
+ */
+struct DeviceChangeLog
+{
+    __host__ __device__ DeviceChangeLog()
+        : m_entries(nullptr), m_count(nullptr), m_capacity(0)
+    {
+    }
+
+    __host__ __device__ bool is_enabled() const
+    {
+        return m_entries != nullptr;
+    }
+
+    /**
+     * @brief append one entry for every set bit in bits where the bits
+     * correspond to local indices 32 * word ... 32 * word + 31 in patch_id
+     */
+    __device__ __inline__ void append(const ChangeType type,
+                                      const uint32_t   patch_id,
+                                      const uint32_t   word,
+                                      uint32_t         bits)
+    {
+#ifdef __CUDA_ARCH__
+        if (bits == 0) {
+            return;
+        }
+        unsigned long long pos =
+            ::atomicAdd(m_count, static_cast<unsigned long long>(__popc(bits)));
+        while (bits != 0) {
+            const uint32_t first = __ffs(bits) - 1;
+            bits &= ~(1u << first);
+            if (pos < m_capacity) {
+                m_entries[pos].handle =
+                    unique_id(static_cast<uint16_t>(32 * word + first),
+                              patch_id);
+                m_entries[pos].old_handle = INVALID64;
+                m_entries[pos].type       = type;
+            }
+            pos++;
+        }
+#endif
+    }
+
+    /**
+     * @brief append a single entry
+     */
+    __device__ __inline__ void append(const ChangeType type,
+                                      const uint64_t   handle,
+                                      const uint64_t   old_handle)
+    {
+#ifdef __CUDA_ARCH__
+        const unsigned long long pos = ::atomicAdd(m_count, 1ull);
+        if (pos < m_capacity) {
+            m_entries[pos].handle     = handle;
+            m_entries[pos].old_handle = old_handle;
+            m_entries[pos].type       = type;
+        }
+#endif
+    }
+
+    ChangeLogEntry*     m_entries;
+    unsigned long long* m_count;
+    uint64_t            m_capacity;
+};
+}  // namespace detail
+
+/**
+ * @brief the changes drained from the device by
+ * RXMeshDynamic::drain_change_log(). The entries live in pinned host memory
+ * owned by RXMeshDynamic and are valid until the second next drain
+ */
+struct ChangeLogBatch
+{
+    // pointer to the host entries (valid after synchronizing the stream
+    // passed to drain_change_log())
+    const ChangeLogEntry* entries = nullptr;
+
+    // number of valid entries in entries
+    uint64_t num_entries = 0;
+
+    // the number of changes recorded on the device. If it is larger than
+    // num_entries, the log overflowed and some changes are missing
+    uint64_t num_changes = 0;
+
+    // if the patches were sliced, merged, or reloaded since the last drain.
+    // In this case, the handles of elements not in the log may have changed
+    // as well
+    bool patches_changed = false;
+
+    /**
+     * @brief if the log can be applied as a delta. Otherwise, the consumer
+     * should fall back to a full snapshot (e.g., update_host())
+     */
+    bool is_complete() const
+    {
+        return num_entries == num_changes && !patches_changed;
+    }
+};
+}  // namespace rxmesh
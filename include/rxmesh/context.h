@@ -1,8 +1,13 @@
 #pragma once
 
 #include <stdint.h>
+#include "rxmesh/cavity_stats.h"
+#include "rxmesh/cavity_trace.h"
+#include "rxmesh/change_log.h"
+#include "rxmesh/inverse_hashtable_cache.h"
 #include "rxmesh/patch_info.h"
 #include "rxmesh/patch_scheduler.cuh"
+#include "rxmesh/query_cache.h"
 #include "rxmesh/util/macros.h"
 
 namespace rxmesh {
@@ -16,6 +21,7 @@ class Context
 {
    public:
     friend class RXMesh;
+    friend class RXMeshStatic;
     friend class RXMeshDynamic;
 
     /**
@@ -37,7 +43,17 @@ class Context
           m_h_face_prefix(nullptr),
           m_patches_info(nullptr),
           m_capacity_factor(0.0f),
-          m_max_num_patches(0)
+          m_max_num_patches(0),
+          m_patch_begin(0),
+          m_patch_end(INVALID32),
+          m_query_cache(nullptr),
+          m_patch_subset(nullptr),
+          m_patch_subset_size(0),
+          m_cavity_stats(nullptr),
+          m_inv_lp_cache(),
+          m_element_flags_valid(nullptr),
+          m_cavity_trace(),
+          m_change_log()
     {
     }
 
@@ -97,6 +113,117 @@ class Context
         return m_num_patches[0];
     }
 
+    /**
+     * @brief check if patch p is processed by kernels launched with this
+     * context. This is all patches unless the range is restricted with
+     * RXMeshStatic::set_patch_range() (e.g., by RXMeshMultiGPU)
+     */
+    __device__ __host__ __forceinline__ bool is_patch_in_range(
+        const uint32_t p) const
+    {
+        return p >= m_patch_begin && p < m_patch_end;
+    }
+
+    /**
+     * @brief the patch processed by the i-th block (or tile). This is i
+     * unless a patch subset is set with RXMeshStatic::set_patch_subset() in
+     * which case it is the i-th patch in the subset (or INVALID32 if i is
+     * beyond the subset). Kernels should use this (or block_patch_id())
+     * instead of blockIdx.x to find their patch
+     */
+    __device__ __host__ __forceinline__ uint32_t
+    subset_patch_id(const uint32_t i) const
+    {
+        if (m_patch_subset == nullptr) {
+            return i;
+        }
+        return (i < m_patch_subset_size) ? m_patch_subset[i] : INVALID32;
+    }
+
+#ifdef __CUDACC__
+    /**
+     * @brief the patch processed by this block (see subset_patch_id())
+     */
+    __device__ __forceinline__ uint32_t block_patch_id() const
+    {
+        return subset_patch_id(blockIdx.x);
+    }
+#endif
+
+    /**
+     * @brief the materialized output of the query operation op (see
+     * RXMeshStatic::enable_query_cache()). Return nullptr if there is no cache
+     */
+    __device__ __forceinline__ const QueryCache* get_query_cache(
+        const Op op) const
+    {
+        return (m_query_cache == nullptr) ? nullptr :
+                                            m_query_cache + uint32_t(op);
+    }
+
+    /**
+     * @brief add val to the cavity statistics counter stat. This is a no-op
+     * unless the statistics are enabled (see
+     * RXMeshDynamic::enable_cavity_stats())
+     */
+    __device__ __forceinline__ void count_cavity_stat(const CavityStat stat,
+                                                      const uint32_t val = 1)
+    {
+#ifdef __CUDA_ARCH__
+        if (m_cavity_stats != nullptr && val > 0) {
+            ::atomicAdd(m_cavity_stats + uint32_t(stat),
+                        static_cast<unsigned long long>(val));
+        }
+#endif
+    }
+
+    /**
+     * @brief record an event of patch_id in the cavity trace. This is a no-op
+     * unless the trace is enabled (see RXMeshDynamic::enable_cavity_trace())
+     */
+    __device__ __forceinline__ void trace_cavity(
+        const CavityTraceType type,
+        const uint32_t        patch_id,
+        const uint32_t        value = 0)
+    {
+        m_cavity_trace.record(type, patch_id, value);
+    }
+
+    /**
+     * @brief invalidate the cached query output of patch p for all query
+     * operations. Should be called when the patch p is modified
+     */
+    __device__ __forceinline__ void invalidate_query_cache(const uint32_t p)
+    {
+        if (m_query_cache != nullptr) {
+            for (uint32_t o = 0; o < QueryCache::num_ops; ++o) {
+                m_query_cache[o].invalidate(p);
+            }
+        }
+    }
+
+    /**
+     * @brief mark the cached boundary/feature flags of patch p (if any) as
+     * stale (see RXMeshStatic::update_element_flags()). Should be called when
+     * the patch p is modified
+     */
+    __device__ __forceinline__ void invalidate_element_flags(
+        const uint32_t p) const
+    {
+        if (m_element_flags_valid != nullptr) {
+            m_element_flags_valid[p] = 0;
+        }
+    }
+
+    /**
+     * @brief mark the cached inverted hashtables of patch p (if any) as stale.
+     * Should be called whenever the patch p is marked dirty
+     */
+    __device__ __forceinline__ void bump_patch_version(const uint32_t p) const
+    {
+        m_inv_lp_cache.bump_version(p);
+    }
+
     /**
      * @brief Unpack an edge to its edge ID and direction
      * @param edge_dir The input packed edge as stored in PatchInfo and
@@ -184,6 +311,10 @@ class Context
         if (pi[owner].is_owned(LocalT(lid))) {
             return handle;
         } else {
+            const uint64_t* owner_table = pi[owner].get_owner_table<HandleT>();
+            if (owner_table != nullptr) {
+                return HandleT(owner_table[lid]);
+            }
 
             LPPair lp = pi[owner].get_lp<HandleT>().find(lid, table, stash);
 
@@ -286,7 +417,9 @@ class Context
               PatchScheduler scheduler)
     {
         uint32_t* buffer = nullptr;
-        CUDA_ERROR(cudaMalloc((void**)&buffer, 7 * sizeof(uint32_t)));
+        CUDA_ERROR(tracked_malloc((void**)&buffer,
+                                  7 * sizeof(uint32_t),
+                                  MemoryCategory::Topology));
         m_num_vertices     = buffer + 0;
         m_num_edges        = buffer + 1;
         m_num_faces        = buffer + 2;
@@ -338,7 +471,7 @@ class Context
 
     void release()
     {
-        CUDA_ERROR(cudaFree(m_num_vertices));
+        CUDA_ERROR(tracked_free(m_num_vertices));
     }
 
 
@@ -351,5 +484,30 @@ class Context
     float          m_capacity_factor;
     uint32_t       m_max_num_patches;
     PatchScheduler m_patch_scheduler;
+    uint32_t       m_patch_begin, m_patch_end;
+    QueryCache*    m_query_cache;
+
+    // the patches processed on the device (nullptr for all patches). See
+    // RXMeshStatic::set_patch_subset()
+    const uint32_t* m_patch_subset;
+    uint32_t        m_patch_subset_size;
+
+    // device counters indexed by CavityStat (nullptr if disabled)
+    unsigned long long* m_cavity_stats;
+
+    // inverted LP hashtables per patch (disabled if it has no table). See
+    // RXMeshDynamic::enable_inverse_hashtable_cache()
+    InverseHashtableCache m_inv_lp_cache;
+
+    // per-patch flag where non-zero indicates that the cached boundary/feature
+    // flags of the patch are valid (nullptr if there are no cached flags). See
+    // RXMeshStatic::update_element_flags()
+    uint8_t* m_element_flags_valid;
+
+    // per-block ring buffers of cavity events (disabled if it has no records)
+    detail::DeviceCavityTrace m_cavity_trace;
+
+    // topology change log (disabled if it has no entries)
+    detail::DeviceChangeLog m_change_log;
 };
 }  // namespace rxmesh
\ No newline at end of file
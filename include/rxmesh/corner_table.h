@@ -0,0 +1,317 @@
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+#include "rxmesh/context.h"
+#include "rxmesh/handle.h"
+#include "rxmesh/query.cuh"
+#include "rxmesh/rxmesh_static.h"
+#include "rxmesh/util/macros.h"
+
+namespace rxmesh {
+namespace detail {
+
+/**
+ * @brief write the vertex and edge of every corner (using global linear ids)
+ * and record the (at most two) corners opposite to every edge. The i-th
+ * corner of face f is 3*f+i and corresponds to the i-th vertex of f. The i-th
+ * half-edge of f is the i-th edge of f oriented from corner i to corner i+1
+ * and is opposite to corner i+2
+ */
+template <uint32_t blockThreads>
+__global__ static void corner_table_build(const Context context,
+                                          uint32_t*     corner_vertex,
+                                          uint32_t*     corner_edge,
+                                          uint32_t*     edge_count,
+                                          uint32_t*     edge_corner)
+{
+    auto           block = cooperative_groups::this_thread_block();
+    ShmemAllocator shrd_alloc;
+
+    Query<blockThreads> fe_query(context);
+    fe_query.prologue<Op::FE>(block, shrd_alloc);
+
+    auto corners = [&](const FaceHandle& fh, const VertexIterator& fv) {
+        const EdgeIterator fe =
+            fe_query.template get_iterator<EdgeIterator>(fh.local_id());
+
+        assert(fv.size() == 3);
+        assert(fe.size() == 3);
+
+        const uint32_t f = context.linear_id(fh);
+
+        for (uint32_t i = 0; i < 3; ++i) {
+            const uint32_t c = 3 * f + i;
+            const uint32_t e = context.linear_id(fe[i]);
+
+            corner_vertex[c] = context.linear_id(fv[i]);
+            corner_edge[c]   = e;
+
+            const uint32_t slot = ::atomicAdd(edge_count + e, uint32_t(1));
+            if (slot < 2) {
+                edge_corner[2 * e + slot] = 3 * f + (i + 2) % 3;
+            }
+        }
+    };
+
+    Query<blockThreads> fv_query(context);
+    fv_query.dispatch<Op::FV>(block, shrd_alloc, corners);
+}
+
+/**
+ * @brief pair up the two corners opposite to every interior manifold edge
+ */
+template <uint32_t blockThreads>
+__global__ static void corner_table_opposite(const uint32_t  num_edges,
+                                             const uint32_t* edge_count,
+                                             const uint32_t* edge_corner,
+                                             uint32_t*       corner_opposite)
+{
+    for (uint32_t e = blockIdx.x * blockThreads + threadIdx.x; e < num_edges;
+         e += gridDim.x * blockThreads) {
+        if (edge_count[e] == 2) {
+            const uint32_t c0 = edge_corner[2 * e];
+            const uint32_t c1 = edge_corner[2 * e + 1];
+
+            corner_opposite[c0] = c1;
+            corner_opposite[c1] = c0;
+        }
+    }
+}
+}  // namespace detail
+
+/**
+ * @brief Global, contiguous corner table (a.k.a. opposite-corner table) of a
+ * static triangle mesh built on the device from the patch-local topology for
+ * interoperability with kernels that expect such a layout. Faces, edges, and
+ * vertices are indexed by their linear id (see RXMeshStatic::linear_id()).
+ * The i-th corner of face f is 3*f+i. For every corner c, we store its vertex
+ * V[c], its opposite corner O[c] (INVALID32 on boundary and non-manifold
+ * edges), and the edge E[c] of the half-edge c. The half-edge c goes from V[c]
+ * to V[next(c)] such that the corner table also doubles as a half-edge
+ * structure (see twin()). CornerTable is trivially copyable and so it could be
+ * passed (by value) to a kernel or captured by a device lambda. The memory
+ * should be released explicitly by calling release()
+ */
+class CornerTable
+{
+   public:
+    CornerTable() = default;
+
+    /**
+     * @brief build the corner table of rx
+     */
+    CornerTable(const RXMeshStatic& rx)
+        : m_num_corners(3 * rx.get_num_faces()),
+          m_num_edges(rx.get_num_edges()),
+          m_num_non_manifold_edges(0),
+          m_d_vertex(nullptr),
+          m_d_opposite(nullptr),
+          m_d_edge(nullptr)
+    {
+        constexpr uint32_t blockThreads = 256;
+
+        const size_t corner_bytes = m_num_corners * sizeof(uint32_t);
+
+        CUDA_ERROR(tracked_malloc((void**)&m_d_vertex,
+                                  corner_bytes,
+                                  MemoryCategory::Topology));
+        CUDA_ERROR(tracked_malloc((void**)&m_d_opposite,
+                                  corner_bytes,
+                                  MemoryCategory::Topology));
+        CUDA_ERROR(tracked_malloc((void**)&m_d_edge,
+                                  corner_bytes,
+                                  MemoryCategory::Topology));
+        CUDA_ERROR(cudaMemset(m_d_opposite, 0xFF, corner_bytes));
+
+        uint32_t *d_edge_count, *d_edge_corner;
+        CUDA_ERROR(tracked_malloc((void**)&d_edge_count,
+                                  m_num_edges * sizeof(uint32_t),
+                                  MemoryCategory::Topology));
+        CUDA_ERROR(tracked_malloc((void**)&d_edge_corner,
+                                  2 * m_num_edges * sizeof(uint32_t),
+                                  MemoryCategory::Topology));
+        CUDA_ERROR(
+            cudaMemset(d_edge_count, 0, m_num_edges * sizeof(uint32_t)));
+
+        LaunchBox<blockThreads> lb;
+        rx.prepare_launch_box({Op::FE, Op::FV},
+                              lb,
+                              (void*)detail::corner_table_build<blockThreads>,
+                              false,
+                              false,
+                              true);
+
+        detail::corner_table_build<blockThreads>
+            <<<lb.blocks, lb.num_threads, lb.smem_bytes_dyn>>>(
+                rx.get_context(),
+                m_d_vertex,
+                m_d_edge,
+                d_edge_count,
+                d_edge_corner);
+
+        detail::corner_table_opposite<blockThreads>
+            <<<DIVIDE_UP(m_num_edges, blockThreads), blockThreads>>>(
+                m_num_edges, d_edge_count, d_edge_corner, m_d_opposite);
+
+        std::vector<uint32_t> h_edge_count(m_num_edges);
+        CUDA_ERROR(cudaMemcpy(h_edge_count.data(),
+                              d_edge_count,
+                              m_num_edges * sizeof(uint32_t),
+                              cudaMemcpyDeviceToHost));
+        for (const uint32_t c : h_edge_count) {
+            if (c > 2) {
+                m_num_non_manifold_edges++;
+            }
+        }
+        if (m_num_non_manifold_edges > 0) {
+            RXMESH_WARN(
+                "CornerTable::CornerTable() the mesh has {} non-manifold "
+                "edges whose opposite corners are set to INVALID32",
+                m_num_non_manifold_edges);
+        }
+
+        GPU_FREE(d_edge_count);
+        GPU_FREE(d_edge_corner);
+    }
+
+    /**
+     * @brief number of corners (i.e., 3 * number of faces)
+     */
+    __host__ __device__ __inline__ uint32_t get_num_corners() const
+    {
+        return m_num_corners;
+    }
+
+    /**
+     * @brief number of edges shared by more than two faces
+     */
+    __host__ __device__ __inline__ uint32_t get_num_non_manifold_edges() const
+    {
+        return m_num_non_manifold_edges;
+    }
+
+    /**
+     * @brief the face of corner c
+     */
+    __host__ __device__ __inline__ static uint32_t face(const uint32_t c)
+    {
+        return c / 3;
+    }
+
+    /**
+     * @brief the next corner of c in its face
+     */
+    __host__ __device__ __inline__ static uint32_t next(const uint32_t c)
+    {
+        return (c % 3 == 2) ? c - 2 : c + 1;
+    }
+
+    /**
+     * @brief the previous corner of c in its face
+     */
+    __host__ __device__ __inline__ static uint32_t prev(const uint32_t c)
+    {
+        return (c % 3 == 0) ? c + 2 : c - 1;
+    }
+
+    /**
+     * @brief the vertex (linear id) of corner c
+     */
+    __device__ __inline__ uint32_t vertex(const uint32_t c) const
+    {
+        assert(c < m_num_corners);
+        return m_d_vertex[c];
+    }
+
+    /**
+     * @brief the opposite corner of corner c or INVALID32 if the edge opposite
+     * to c is a boundary or non-manifold edge
+     */
+    __device__ __inline__ uint32_t opposite(const uint32_t c) const
+    {
+        assert(c < m_num_corners);
+        return m_d_opposite[c];
+    }
+
+    /**
+     * @brief the edge (linear id) of half-edge c i.e., the edge from vertex(c)
+     * to vertex(next(c))
+     */
+    __device__ __inline__ uint32_t edge(const uint32_t c) const
+    {
+        assert(c < m_num_corners);
+        return m_d_edge[c];
+    }
+
+    /**
+     * @brief the twin of half-edge h or INVALID32 if h is on the boundary or
+     * on a non-manifold edge
+     */
+    __device__ __inline__ uint32_t twin(const uint32_t h) const
+    {
+        const uint32_t o = opposite(prev(h));
+        return (o == INVALID32) ? INVALID32 : next(o);
+    }
+
+    /**
+     * @brief raw device pointers to V, O, and E arrays (each with
+     * get_num_corners() entries) to be passed to external kernels
+     */
+    const uint32_t* get_vertex_ptr() const
+    {
+        return m_d_vertex;
+    }
+    const uint32_t* get_opposite_ptr() const
+    {
+        return m_d_opposite;
+    }
+    const uint32_t* get_edge_ptr() const
+    {
+        return m_d_edge;
+    }
+
+    /**
+     * @brief copy the V, O, and E arrays to the host
+     */
+    void to_host(std::vector<uint32_t>& vertex,
+                 std::vector<uint32_t>& opposite,
+                 std::vector<uint32_t>& edge) const
+    {
+        vertex.resize(m_num_corners);
+        opposite.resize(m_num_corners);
+        edge.resize(m_num_corners);
+
+        const size_t corner_bytes = m_num_corners * sizeof(uint32_t);
+
+        CUDA_ERROR(cudaMemcpy(
+            vertex.data(), m_d_vertex, corner_bytes, cudaMemcpyDeviceToHost));
+        CUDA_ERROR(cudaMemcpy(opposite.data(),
+                              m_d_opposite,
+                              corner_bytes,
+                              cudaMemcpyDeviceToHost));
+        CUDA_ERROR(cudaMemcpy(
+            edge.data(), m_d_edge, corner_bytes, cudaMemcpyDeviceToHost));
+    }
+
+    /**
+     * @brief release the device memory
+     */
+    void release()
+    {
+        GPU_FREE(m_d_vertex);
+        GPU_FREE(m_d_opposite);
+        GPU_FREE(m_d_edge);
+    }
+
+   private:
+    uint32_t  m_num_corners            = 0;
+    uint32_t  m_num_edges              = 0;
+    uint32_t  m_num_non_manifold_edges = 0;
+    uint32_t* m_d_vertex               = nullptr;
+    uint32_t* m_d_opposite             = nullptr;
+    uint32_t* m_d_edge                 = nullptr;
+};
+
+}  // namespace rxmesh
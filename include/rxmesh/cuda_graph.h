@@ -0,0 +1,184 @@
+#pragma once
+
+#include <stdint.h>
+#include <algorithm>
+
+#include <cuda_runtime.h>
+
+#include "rxmesh/util/log.h"
+#include "rxmesh/util/macros.h"
+
+namespace rxmesh {
+
+/**
+ * @brief Capture a sequence of kernel launches (e.g., one iteration of an
+ * iterative solver made of for_each_*(), run_query_kernel(), SpMV, and
+ * ReduceHandle::*_async() reductions) into a CUDA Graph and replay it with a
+ * single launch. This removes the per-kernel launch latency that dominates
+ * small meshes. Everything issued inside the capture should be on the stream
+ * passed to the capture function and should not synchronize with the host
+ * (e.g., use ReduceHandle::dot_async() instead of ReduceHandle::dot()). Launch
+ * boxes should be prepared before capturing since only stream work is recorded
+ * i.e., host-side computation in the captured function runs once
+ */
+class CUDAGraph
+{
+   public:
+    CUDAGraph() = default;
+
+    CUDAGraph(const CUDAGraph&)            = delete;
+    CUDAGraph& operator=(const CUDAGraph&) = delete;
+
+    ~CUDAGraph()
+    {
+        release();
+    }
+
+    /**
+     * @brief capture the work issued by capture_fn on the stream. If a graph
+     * is already captured, it is updated in place when the topology of the new
+     * graph matches the previous one, otherwise it is re-instantiated
+     * @param stream a non-default stream to capture the work on
+     * @param capture_fn a function that takes the stream and issue the work on
+     * it i.e., [&](cudaStream_t st){...}
+     */
+    template <typename CaptureT>
+    void capture(cudaStream_t stream, CaptureT capture_fn)
+    {
+        if (stream == NULL) {
+            RXMESH_ERROR(
+                "CUDAGraph::capture() can not capture the legacy default "
+                "stream. Use a stream created with cudaStreamCreate()");
+            return;
+        }
+
+        CUDA_ERROR(
+            cudaStreamBeginCapture(stream, cudaStreamCaptureModeThreadLocal));
+
+        capture_fn(stream);
+
+        cudaGraph_t graph;
+        CUDA_ERROR(cudaStreamEndCapture(stream, &graph));
+
+        if (m_exec != nullptr) {
+#if CUDART_VERSION >= 12000
+            cudaGraphExecUpdateResultInfo info;
+            cudaError_t err = cudaGraphExecUpdate(m_exec, graph, &info);
+#else
+            cudaGraphNode_t           error_node;
+            cudaGraphExecUpdateResult info;
+            cudaError_t               err =
+                cudaGraphExecUpdate(m_exec, graph, &error_node, &info);
+#endif
+            if (err != cudaSuccess) {
+                // clear the error and re-instantiate
+                cudaGetLastError();
+                CUDA_ERROR(cudaGraphExecDestroy(m_exec));
+                m_exec = nullptr;
+            }
+        }
+
+        if (m_exec == nullptr) {
+            CUDA_ERROR(cudaGraphInstantiateWithFlags(&m_exec, graph, 0));
+        }
+
+        if (m_graph != nullptr) {
+            CUDA_ERROR(cudaGraphDestroy(m_graph));
+        }
+        m_graph = graph;
+    }
+
+    /**
+     * @brief check if a graph has been captured
+     */
+    bool is_captured() const
+    {
+        return m_exec != nullptr;
+    }
+
+    /**
+     * @brief replay the captured graph num_launches times on the stream
+     */
+    void launch(cudaStream_t stream = NULL, uint32_t num_launches = 1) const
+    {
+        if (!is_captured()) {
+            RXMESH_ERROR("CUDAGraph::launch() no graph has been captured");
+            return;
+        }
+        for (uint32_t i = 0; i < num_launches; ++i) {
+            CUDA_ERROR(cudaGraphLaunch(m_exec, stream));
+        }
+    }
+
+    /**
+     * @brief replay the captured graph until the device value d_value
+     * (written by the graph e.g., the output of ReduceHandle::norm2_async())
+     * drops below tol or max_launches is reached. The value is read back to
+     * the host only once every check_freq launches such that the host does
+     * not synchronize with the device on every iteration. Thus, up to
+     * check_freq - 1 extra launches may run after convergence
+     * @return the number of launches done
+     */
+    template <typename T>
+    uint32_t launch_until(const T*       d_value,
+                          const T        tol,
+                          const uint32_t max_launches,
+                          const uint32_t check_freq = 1,
+                          cudaStream_t   stream     = NULL)
+    {
+        static_assert(sizeof(T) <= sizeof(double),
+                      "CUDAGraph::launch_until() the type of the convergence "
+                      "value should be at most 8 bytes");
+
+        if (m_h_value == nullptr) {
+            CUDA_ERROR(cudaMallocHost(&m_h_value, sizeof(double)));
+        }
+
+        T* h_value = reinterpret_cast<T*>(m_h_value);
+
+        uint32_t num_launches = 0;
+
+        while (num_launches < max_launches) {
+            const uint32_t n =
+                std::min(std::max(check_freq, 1u), max_launches - num_launches);
+            launch(stream, n);
+            num_launches += n;
+
+            CUDA_ERROR(cudaMemcpyAsync(
+                h_value, d_value, sizeof(T), cudaMemcpyDeviceToHost, stream));
+            CUDA_ERROR(cudaStreamSynchronize(stream));
+
+            if (h_value[0] < tol) {
+                break;
+            }
+        }
+
+        return num_launches;
+    }
+
+    /**
+     * @brief release the captured graph
+     */
+    void release()
+    {
+        if (m_exec != nullptr) {
+            CUDA_ERROR(cudaGraphExecDestroy(m_exec));
+            m_exec = nullptr;
+        }
+        if (m_graph != nullptr) {
+            CUDA_ERROR(cudaGraphDestroy(m_graph));
+            m_graph = nullptr;
+        }
+        if (m_h_value != nullptr) {
+            CUDA_ERROR(cudaFreeHost(m_h_value));
+            m_h_value = nullptr;
+        }
+    }
+
+   private:
+    cudaGraph_t     m_graph   = nullptr;
+    cudaGraphExec_t m_exec    = nullptr;
+    void*           m_h_value = nullptr;
+};
+
+}  // namespace rxmesh
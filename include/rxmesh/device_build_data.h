@@ -0,0 +1,76 @@
+#pragma once
+#include <stdint.h>
+
+#include "rxmesh/util/macros.h"
+
+namespace rxmesh {
+
+/**
+ * @brief device copy of the input mesh and its patching used to build the
+ * per-patch topology (EV and FE) and the LP hashtables directly on the device.
+ * The local-to-global maps of all patches are stored in CSR format where the
+ * map of patch p starts at ltog_*_offset[p]. Each patch map stores the owned
+ * elements first (sorted) followed by the not-owned elements (sorted) exactly
+ * as RXMesh::m_h_patches_ltog_*
+ */
+struct DeviceBuildData
+{
+    // input face incident vertices (3*#faces)
+    uint32_t* fv = nullptr;
+
+    // input face incident edges (3*#faces) as global edge ids
+    uint32_t* fe = nullptr;
+
+    // input edge incident vertices (2*#edges)
+    uint32_t* ev = nullptr;
+
+    // the owner patch of every vertex/edge/face
+    uint32_t* vertex_patch = nullptr;
+    uint32_t* edge_patch   = nullptr;
+    uint32_t* face_patch   = nullptr;
+
+    // local-to-global map of all patches in CSR format
+    uint32_t* ltog_v        = nullptr;
+    uint32_t* ltog_e        = nullptr;
+    uint32_t* ltog_f        = nullptr;
+    uint32_t* ltog_v_offset = nullptr;
+    uint32_t* ltog_e_offset = nullptr;
+    uint32_t* ltog_f_offset = nullptr;
+
+    // the number of owned vertices/edges/faces in each patch
+    uint16_t* num_owned_v = nullptr;
+    uint16_t* num_owned_e = nullptr;
+    uint16_t* num_owned_f = nullptr;
+
+    /**
+     * @brief if the data is populated i.e., the topology should be built on
+     * the device
+     */
+    bool is_valid() const
+    {
+        return fv != nullptr;
+    }
+
+    /**
+     * @brief free all device memory and reset the pointers
+     */
+    void release()
+    {
+        GPU_FREE(fv);
+        GPU_FREE(fe);
+        GPU_FREE(ev);
+        GPU_FREE(vertex_patch);
+        GPU_FREE(edge_patch);
+        GPU_FREE(face_patch);
+        GPU_FREE(ltog_v);
+        GPU_FREE(ltog_e);
+        GPU_FREE(ltog_f);
+        GPU_FREE(ltog_v_offset);
+        GPU_FREE(ltog_e_offset);
+        GPU_FREE(ltog_f_offset);
+        GPU_FREE(num_owned_v);
+        GPU_FREE(num_owned_e);
+        GPU_FREE(num_owned_f);
+    }
+};
+}  // namespace rxmesh
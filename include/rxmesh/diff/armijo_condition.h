@@ -5,7 +5,25 @@
 namespace rxmesh {
 
 /**
- * @brief armijo/wolfe condition used line search 
+ * @brief armijo/wolfe condition used line search where dir_dot_grad is the
+ * dot product of the search direction and the gradient. Can be evaluated on
+ * the device (see BatchedLineSearch)
+ */
+template <typename T>
+__host__ __device__ __forceinline__ bool armijo_condition(
+    const T f_curr,
+    const T f_new,
+    const T s,
+    const T dir_dot_grad,
+    const T armijo_const)
+{
+    return f_new <= f_curr + armijo_const * s * dir_dot_grad;
+}
+
+/**
+ * @brief armijo/wolfe condition used line search. This computes dir.dot(grad)
+ * on stream every time it is called so line searches should rather compute
+ * it once and use the overload above
  */
 template <typename T>
 inline bool armijo_condition(const T                                f_curr,
@@ -13,10 +31,11 @@ inline bool armijo_condition(const T                                f_curr,
                              const T                                s,
                              const DenseMatrix<T, Eigen::RowMajor>& dir,
                              const DenseMatrix<T, Eigen::RowMajor>& grad,
-                             const T armijo_const)
+                             const T      armijo_const,
+                             cudaStream_t stream = NULL)
 {
-    //TODO we don't need to compute the dir.dot(grad) every time 
-    return f_new <= f_curr + armijo_const * s * dir.dot(grad);
+    return armijo_condition(
+        f_curr, f_new, s, T(dir.dot(grad, false, stream)), armijo_const);
 }
 
 }  // namespace rxmesh
\ No newline at end of file
@@ -0,0 +1,281 @@
+#pragma once
+
+#include <sstream>
+
+#include "rxmesh/diff/armijo_condition.h"
+#include "rxmesh/rxmesh_static.h"
+
+namespace rxmesh {
+
+namespace detail {
+
+/**
+ * @brief the step sizes of one batch of line search candidates. Passed by
+ * value to the kernel such that no copy to the device is needed
+ */
+template <typename T, int MaxSize>
+struct LineSearchSteps
+{
+    T   s[MaxSize];
+    int size;
+};
+
+/**
+ * @brief sum the per-term losses of every candidate and pick the first
+ * candidate (i.e., the largest step) that satisfies the Armijo condition.
+ * d_losses stores the loss of term t for candidate k at k * num_terms + t.
+ * The chosen candidate is written to d_chosen (-1 if none is accepted)
+ */
+template <typename T, int MaxSize>
+__global__ static void pick_armijo_step(
+    const T*                          d_losses,
+    const int                         num_terms,
+    const LineSearchSteps<T, MaxSize> steps,
+    const T                           f_curr,
+    const T                           dir_dot_grad,
+    const T                           armijo_const,
+    int*                              d_chosen)
+{
+    for (int k = 0; k < steps.size; ++k) {
+        T f_new = 0;
+        for (int t = 0; t < num_terms; ++t) {
+            f_new += d_losses[k * num_terms + t];
+        }
+        if (armijo_condition(
+                f_curr, f_new, steps.s[k], dir_dot_grad, armijo_const)) {
+            *d_chosen = k;
+            return;
+        }
+    }
+    *d_chosen = -1;
+}
+}  // namespace detail
+
+/**
+ * @brief batched backtracking line search. Instead of evaluating one step
+ * size at a time and synchronizing with the host to read the energy after
+ * every trial, this evaluates a batch of step sizes (following the same
+ * shrinking schedule as the sequential line search) back to back on the
+ * device where every candidate has its own objective and the energy of every
+ * term of every candidate is reduced into a device buffer. The candidate with
+ * the largest step that satisfies the Armijo condition is then picked on the
+ * device, so there is one host synchronization per batch instead of one per
+ * trial. Accepting the first candidate that satisfies the condition gives the
+ * same step as the sequential line search. The price is the memory of
+ * batch_size copies of the objective and the evaluation of trials that the
+ * sequential line search might have skipped
+ */
+template <typename T, typename ObjHandleT>
+struct BatchedLineSearch
+{
+    using DenseMatT  = DenseMatrix<T, Eigen::RowMajor>;
+    using AttributeT = Attribute<T, ObjHandleT>;
+
+    // the max number of candidates evaluated in one batch
+    static constexpr int MaxBatchSize = 16;
+
+    BatchedLineSearch()
+        : m_d_losses(nullptr),
+          m_d_chosen(nullptr),
+          m_h_chosen(nullptr),
+          m_losses_size(0)
+    {
+    }
+
+    BatchedLineSearch(const BatchedLineSearch&)            = delete;
+    BatchedLineSearch& operator=(const BatchedLineSearch&) = delete;
+
+    ~BatchedLineSearch()
+    {
+        GPU_FREE(m_d_losses);
+        GPU_FREE(m_d_chosen);
+        if (m_h_chosen) {
+            CUDA_ERROR(cudaFreeHost(m_h_chosen));
+        }
+    }
+
+    /**
+     * @brief run the line search along dir starting from problem.objective.
+     * The step sizes are s_max, s_max * shrink, s_max * shrink^2, ... (if
+     * try_one is true and s_max > 1, the step 1 is tried before going below
+     * it) for up to max_iters trials where batch_size trials are evaluated at
+     * once. If a step is accepted, the updated objective is written to result
+     * and the function returns true. Otherwise, result is not changed
+     * @param f_curr the current energy, i.e., at problem.objective
+     */
+    template <typename ProblemT>
+    bool run(ProblemT&        problem,
+             const DenseMatT& dir,
+             AttributeT&      result,
+             const T          f_curr,
+             const T          s_max,
+             const T          shrink,
+             const int        max_iters,
+             const T          armijo_const,
+             const bool       try_one,
+             int              batch_size,
+             cudaStream_t     stream)
+    {
+        if (batch_size < 1 || batch_size > MaxBatchSize) {
+            RXMESH_WARN(
+                "BatchedLineSearch::run() batch_size ({}) should be in [1, "
+                "{}]. Clamping it.",
+                batch_size,
+                MaxBatchSize);
+            batch_size = std::max(1, std::min(batch_size, MaxBatchSize));
+        }
+
+        if (problem.terms.empty()) {
+            return false;
+        }
+
+        const int num_terms = static_cast<int>(problem.terms.size());
+
+        alloc(problem, batch_size, num_terms);
+
+        // the directional derivative does not change across trials
+        const T dir_dot_grad = dir.dot(problem.grad, false, stream);
+
+        T s = s_max;
+
+        int trial = 0;
+
+        while (trial < max_iters) {
+            detail::LineSearchSteps<T, MaxBatchSize> steps;
+            steps.size = 0;
+
+            while (steps.size < batch_size && trial < max_iters) {
+
+                const T step = s;
+
+                update_candidate(
+                    problem, dir, *m_candidates[steps.size], step, stream);
+
+                problem.eval_terms_passive_async(
+                    m_candidates[steps.size].get(),
+                    m_d_losses + steps.size * num_terms,
+                    stream);
+
+                steps.s[steps.size++] = step;
+                trial++;
+
+                if (try_one && s > 1.0 && s * shrink < 1.0) {
+                    s = 1.0;
+                } else {
+                    s *= shrink;
+                }
+            }
+
+            detail::pick_armijo_step<T, MaxBatchSize>
+                <<<1, 1, 0, stream>>>(m_d_losses,
+                                      num_terms,
+                                      steps,
+                                      f_curr,
+                                      dir_dot_grad,
+                                      armijo_const,
+                                      m_d_chosen);
+
+            CUDA_ERROR(cudaMemcpyAsync(m_h_chosen,
+                                       m_d_chosen,
+                                       sizeof(int),
+                                       cudaMemcpyDeviceToHost,
+                                       stream));
+            CUDA_ERROR(cudaStreamSynchronize(stream));
+
+            const int chosen = *m_h_chosen;
+
+            if (chosen >= 0) {
+                copy(problem, *m_candidates[chosen], result, stream);
+
+                // the (per-term) losses should be the ones of the accepted
+                // step as in the sequential line search
+                if (chosen != steps.size - 1) {
+                    problem.eval_terms_passive(&result, stream);
+                }
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    /**
+     * @brief candidate = problem.objective + s * dir
+     */
+    template <typename ProblemT>
+    void update_candidate(ProblemT&        problem,
+                          const DenseMatT& dir,
+                          AttributeT&      candidate,
+                          const T          s,
+                          cudaStream_t     stream)
+    {
+        problem.rx.template for_each<ObjHandleT>(
+            DEVICE,
+            [s,
+             dir   = dir,
+             t_obj = candidate,
+             obj   = *problem.objective] __device__(const ObjHandleT& h) {
+                for (int j = 0; j < t_obj.get_num_attributes(); ++j) {
+                    t_obj(h, j) = obj(h, j) + s * dir(h, j);
+                }
+            },
+            stream);
+    }
+
+    /**
+     * @brief dst = src
+     */
+    template <typename ProblemT>
+    void copy(ProblemT&         problem,
+              const AttributeT& src,
+              AttributeT&       dst,
+              cudaStream_t      stream)
+    {
+        problem.rx.template for_each<ObjHandleT>(
+            DEVICE,
+            [src = src, dst = dst] __device__(const ObjHandleT& h) mutable {
+                for (int j = 0; j < dst.get_num_attributes(); ++j) {
+                    dst(h, j) = src(h, j);
+                }
+            },
+            stream);
+    }
+
+   protected:
+    template <typename ProblemT>
+    void alloc(ProblemT& problem, const int batch_size, const int num_terms)
+    {
+        while (static_cast<int>(m_candidates.size()) < batch_size) {
+            std::ostringstream address;
+            address << (void const*)this;
+
+            m_candidates.push_back(problem.rx.add_attribute_like(
+                "line_search_candidate" + address.str() + "_" +
+                    std::to_string(m_candidates.size()),
+                *problem.objective));
+        }
+
+        if (m_losses_size < batch_size * num_terms) {
+            GPU_FREE(m_d_losses);
+            m_losses_size = batch_size * num_terms;
+            CUDA_ERROR(tracked_malloc((void**)&m_d_losses,
+                                      m_losses_size * sizeof(T),
+                                      MemoryCategory::Solver));
+        }
+
+        if (!m_d_chosen) {
+            CUDA_ERROR(tracked_malloc((void**)&m_d_chosen,
+                                      sizeof(int),
+                                      MemoryCategory::Solver));
+            CUDA_ERROR(cudaMallocHost((void**)&m_h_chosen, sizeof(int)));
+        }
+    }
+
+    std::vector<std::shared_ptr<AttributeT>> m_candidates;
+    T*                                       m_d_losses;
+    int*                                     m_d_chosen;
+    int*                                     m_h_chosen;
+    int                                      m_losses_size;
+};
+
+}  // namespace rxmesh
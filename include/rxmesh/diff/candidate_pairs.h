@@ -1,5 +1,6 @@
 #pragma once
 
+#include "rxmesh/iterator.cuh"
 #include "rxmesh/matrix/dense_matrix.h"
 
 namespace rxmesh {
@@ -122,6 +123,19 @@ struct CandidatePairs
         return m_pairs_handle(id, 0);
     }
 
+    /**
+     * @brief return an iterator over the two handles of a candidate pair (used
+     * by the energy term that acts on the pairs)
+     */
+    __device__ PairIterator<HandleT0> get_iterator(int id) const
+    {
+        static_assert(std::is_same_v<HandleT0, HandleT1>,
+                      "CandidatePairs::get_iterator() requires pairs of the "
+                      "same handle type");
+        const PairT& pair = get_pair(id);
+        return PairIterator<HandleT0>(pair.first, pair.second);
+    }
+
     /**
      * @brief return the current number of the candidates (i.e., number of
      * handles, not indices)
@@ -202,4 +216,219 @@ struct CandidatePairs
 
 using CandidatePairsVV = CandidatePairs<VertexHandle, VertexHandle, int>;
 
+
+/**
+ * @brief Storing contact pairs whose energy depends on a stencil of four
+ * vertices, i.e., vertex-face (the vertex and the three face vertices) and
+ * edge-edge (the two vertices of each edge) pairs. The stencil vertices are
+ * stored with the pair since they are needed to evaluate the energy and to
+ * know which Hessian blocks the pair touches. As in CandidatePairs, the
+ * memory is allocated once and insertion fails if the number of pairs exceeds
+ * the capacity
+ */
+template <typename HandleT0, typename HandleT1, typename IndexT>
+struct ContactPairs
+{
+    template <typename T, int V, typename O, bool W>
+    friend struct DiffScalarProblem;
+
+    // number of vertices whose variables a pair depends on
+    static constexpr int StencilSize = 4;
+
+    // number of the off-diagonal vertex blocks a pair contributes to
+    static constexpr int NumBlocks = StencilSize * (StencilSize - 1);
+
+    using PairT     = std::pair<HandleT0, HandleT1>;
+    using IteratorT = StencilIterator<VertexHandle, StencilSize>;
+
+    __device__               ContactPairs(const ContactPairs&) = default;
+    __device__               ContactPairs(ContactPairs&&)      = default;
+    __device__ ContactPairs& operator=(const ContactPairs&)    = default;
+    __device__ ContactPairs& operator=(ContactPairs&&)         = default;
+    __device__               ContactPairs()                    = default;
+
+    virtual ~ContactPairs()
+    {
+    }
+
+    /**
+     * @brief allocate memory with max_capacity number of pairs. Each pair
+     * will insert NumBlocks blocks of size variable_dim^2 into the Hessian
+     * (the diagonal blocks are already allocated in the Hessian matrix)
+     */
+    __host__ ContactPairs(int            max_capacity,
+                          int            variable_dim,
+                          const Context& ctx)
+        : m_variable_dim(variable_dim),
+          m_pairs_id(DenseMatrix<IndexT, Eigen::ColMajor>(
+              max_capacity * variable_dim * variable_dim * NumBlocks,
+              2)),
+          m_pairs_handle(DenseMatrix<PairT, Eigen::ColMajor>(max_capacity, 1)),
+          m_stencil(DenseMatrix<IteratorT, Eigen::ColMajor>(max_capacity, 1)),
+          m_current_num_pairs(DenseMatrix<int>(1, 1)),
+          m_current_num_index(DenseMatrix<int>(1, 1)),
+          m_context(ctx)
+    {
+        reset();
+    }
+
+    /**
+     * @brief Insert a contact pair along with its stencil vertices and return
+     * true if it succeeded. Otherwise return false, i.e., in case of exceeding
+     * the max capacity. For vertex-face pairs, the stencil is the vertex
+     * followed by the face vertices. For edge-edge pairs, the stencil is the
+     * vertices of the first edge followed by the vertices of the second edge
+     */
+    __device__ __host__ bool insert(const HandleT0&  c0,
+                                    const HandleT1&  c1,
+                                    const IteratorT& stencil)
+    {
+        auto add_candidate = [&](int id) {
+            m_pairs_handle(id).first  = c0;
+            m_pairs_handle(id).second = c1;
+            m_stencil(id)             = stencil;
+
+            id *= m_variable_dim * m_variable_dim * NumBlocks;
+
+            for (int a = 0; a < StencilSize; ++a) {
+                for (int b = 0; b < StencilSize; ++b) {
+                    if (a == b) {
+                        continue;
+                    }
+                    for (int i = 0; i < m_variable_dim; ++i) {
+                        for (int j = 0; j < m_variable_dim; ++j) {
+                            m_pairs_id(id, 0) =
+                                m_context.linear_id(stencil[a]) *
+                                    m_variable_dim +
+                                i;
+                            m_pairs_id(id, 1) =
+                                m_context.linear_id(stencil[b]) *
+                                    m_variable_dim +
+                                j;
+                            id++;
+                        }
+                    }
+                }
+            }
+        };
+
+        const int num_index = m_variable_dim * m_variable_dim * NumBlocks;
+
+#ifdef __CUDA_ARCH__
+        int id = ::atomicAdd(m_current_num_pairs.data(DEVICE), 1);
+        if (id < m_pairs_handle.rows()) {
+            ::atomicAdd(m_current_num_index.data(DEVICE), num_index);
+            add_candidate(id);
+            return true;
+        } else {
+            ::atomicAdd(m_current_num_pairs.data(DEVICE), -1);
+            return false;
+        }
+#else
+        if (m_current_num_pairs(0) < m_pairs_handle.rows()) {
+            int id = m_current_num_pairs(0);
+            m_current_num_pairs(0)++;
+            m_current_num_index(0) += num_index;
+            add_candidate(id);
+            return true;
+        } else {
+            return false;
+        }
+#endif
+    }
+
+    /**
+     * @brief return a contact pair using its Id
+     */
+    __device__ __host__ const PairT& get_pair(int id) const
+    {
+        assert(id < m_pairs_handle.rows());
+        return m_pairs_handle(id, 0);
+    }
+
+    /**
+     * @brief return an iterator over the stencil vertices of a contact pair
+     */
+    __device__ __host__ const IteratorT& get_iterator(int id) const
+    {
+        assert(id < m_stencil.rows());
+        return m_stencil(id, 0);
+    }
+
+    /**
+     * @brief return the current number of the contact pairs
+     */
+    __device__ __host__ int num_pairs()
+    {
+#ifdef __CUDA_ARCH__
+        return m_current_num_pairs(0);
+#else
+        m_current_num_pairs.move(DEVICE, HOST);
+        return m_current_num_pairs(0);
+#endif
+    }
+
+    /**
+     * @brief return the current number of the new indices
+     */
+    __device__ __host__ int num_index()
+    {
+#ifdef __CUDA_ARCH__
+        return m_current_num_index(0);
+#else
+        m_current_num_index.move(DEVICE, HOST);
+        return m_current_num_index(0);
+#endif
+    }
+
+    /**
+     * @brief return the max number of contact pairs that can be stored
+     */
+    __device__ __host__ int capacity() const
+    {
+        return m_pairs_handle.rows();
+    }
+
+    /**
+     * @brief reset the number of contact pairs, i.e., make the size equal 0
+     */
+    __device__ __host__ void reset()
+    {
+        m_current_num_pairs(0) = 0;
+        m_current_num_index(0) = 0;
+
+#ifndef __CUDA_ARCH__
+        m_current_num_pairs.move(HOST, DEVICE);
+        m_current_num_index.move(HOST, DEVICE);
+#endif
+    }
+
+    /**
+     * @brief release the memory in both host and device
+     */
+    __host__ void release()
+    {
+        m_pairs_id.release();
+        m_pairs_handle.release();
+        m_stencil.release();
+        m_current_num_pairs.release();
+        m_current_num_index.release();
+    }
+
+   private:
+    DenseMatrix<IndexT, Eigen::ColMajor>    m_pairs_id;
+    DenseMatrix<PairT, Eigen::ColMajor>     m_pairs_handle;
+    DenseMatrix<IteratorT, Eigen::ColMajor> m_stencil;
+
+    // track the number of pairs (not the number of indices)
+    DenseMatrix<int> m_current_num_pairs;
+    DenseMatrix<int> m_current_num_index;
+    int              m_variable_dim;
+
+    Context m_context;
+};
+
+using CandidatePairsVF = ContactPairs<VertexHandle, FaceHandle, int>;
+using CandidatePairsEE = ContactPairs<EdgeHandle, EdgeHandle, int>;
+
 }  // namespace rxmesh
\ No newline at end of file
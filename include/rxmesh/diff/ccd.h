@@ -0,0 +1,454 @@
+#pragma once
+
+#include <functional>
+#include <limits>
+#include <sstream>
+
+#include <Eigen/Dense>
+
+#include "rxmesh/diff/candidate_pairs.h"
+#include "rxmesh/kernels/util.cuh"
+#include "rxmesh/reduce_handle.h"
+#include "rxmesh/rxmesh_static.h"
+
+namespace rxmesh {
+
+/**
+ * @brief squared distance between point p and triangle (a, b, c) (Ericson,
+ * Real-Time Collision Detection, 5.1.5)
+ */
+template <typename T>
+__device__ __host__ __inline__ T
+point_triangle_distance2(const Eigen::Vector3<T>& p,
+                         const Eigen::Vector3<T>& a,
+                         const Eigen::Vector3<T>& b,
+                         const Eigen::Vector3<T>& c)
+{
+    const Eigen::Vector3<T> ab = b - a;
+    const Eigen::Vector3<T> ac = c - a;
+    const Eigen::Vector3<T> ap = p - a;
+
+    const T d1 = ab.dot(ap);
+    const T d2 = ac.dot(ap);
+    if (d1 <= T(0) && d2 <= T(0)) {
+        return ap.squaredNorm();
+    }
+
+    const Eigen::Vector3<T> bp = p - b;
+
+    const T d3 = ab.dot(bp);
+    const T d4 = ac.dot(bp);
+    if (d3 >= T(0) && d4 <= d3) {
+        return bp.squaredNorm();
+    }
+
+    const T vc = d1 * d4 - d3 * d2;
+    if (vc <= T(0) && d1 >= T(0) && d3 <= T(0)) {
+        const T v = d1 / (d1 - d3);
+        return (p - (a + v * ab)).squaredNorm();
+    }
+
+    const Eigen::Vector3<T> cp = p - c;
+
+    const T d5 = ab.dot(cp);
+    const T d6 = ac.dot(cp);
+    if (d6 >= T(0) && d5 <= d6) {
+        return cp.squaredNorm();
+    }
+
+    const T vb = d5 * d2 - d1 * d6;
+    if (vb <= T(0) && d2 >= T(0) && d6 <= T(0)) {
+        const T w = d2 / (d2 - d6);
+        return (p - (a + w * ac)).squaredNorm();
+    }
+
+    const T va = d3 * d6 - d5 * d4;
+    if (va <= T(0) && (d4 - d3) >= T(0) && (d5 - d6) >= T(0)) {
+        const T w = (d4 - d3) / ((d4 - d3) + (d5 - d6));
+        return (p - (b + w * (c - b))).squaredNorm();
+    }
+
+    const T denom = T(1) / (va + vb + vc);
+    const T v     = vb * denom;
+    const T w     = vc * denom;
+    return (p - (a + ab * v + ac * w)).squaredNorm();
+}
+
+/**
+ * @brief squared distance between segments (p0, p1) and (q0, q1) (Ericson,
+ * Real-Time Collision Detection, 5.1.9)
+ */
+template <typename T>
+__device__ __host__ __inline__ T
+edge_edge_distance2(const Eigen::Vector3<T>& p0,
+                    const Eigen::Vector3<T>& p1,
+                    const Eigen::Vector3<T>& q0,
+                    const Eigen::Vector3<T>& q1)
+{
+    const Eigen::Vector3<T> d1 = p1 - p0;
+    const Eigen::Vector3<T> d2 = q1 - q0;
+    const Eigen::Vector3<T> r  = p0 - q0;
+
+    const T a = d1.squaredNorm();
+    const T e = d2.squaredNorm();
+    const T f = d2.dot(r);
+
+    auto clamp01 = [](T x) { return x < T(0) ? T(0) : (x > T(1) ? T(1) : x); };
+
+    T s, t;
+
+    if (a <= std::numeric_limits<T>::epsilon() &&
+        e <= std::numeric_limits<T>::epsilon()) {
+        return r.squaredNorm();
+    }
+
+    if (a <= std::numeric_limits<T>::epsilon()) {
+        s = T(0);
+        t = clamp01(f / e);
+    } else {
+        const T c = d1.dot(r);
+        if (e <= std::numeric_limits<T>::epsilon()) {
+            t = T(0);
+            s = clamp01(-c / a);
+        } else {
+            const T b     = d1.dot(d2);
+            const T denom = a * e - b * b;
+
+            // parallel segments pick s = 0
+            s = (denom != T(0)) ? clamp01((b * f - c * e) / denom) : T(0);
+            t = (b * s + f) / e;
+
+            if (t < T(0)) {
+                t = T(0);
+                s = clamp01(-c / a);
+            } else if (t > T(1)) {
+                t = T(1);
+                s = clamp01((b - c) / a);
+            }
+        }
+    }
+
+    return ((p0 + d1 * s) - (q0 + d2 * t)).squaredNorm();
+}
+
+/**
+ * @brief additive continuous collision detection (Li et al., "Codimensional
+ * Incremental Potential Contact", 2021) for a stencil of N points x moving
+ * linearly along dx over the time [0, 1]. The distance between the two
+ * primitives is given by dist2(x) and max_disp bounds the relative motion of
+ * the two primitives. The returned time of impact is conservative, i.e., the
+ * primitives are at least a fraction eta of their initial distance apart (and
+ * farther than thickness) at the returned time. Return 1 if there is no
+ * impact in [0, 1]
+ */
+template <typename T, int N, typename DistFuncT>
+__device__ __host__ __inline__ T additive_ccd(Eigen::Vector3<T> (&x)[N],
+                                              const Eigen::Vector3<T> (&dx)[N],
+                                              const T         max_disp,
+                                              const DistFuncT dist2,
+                                              const T         eta,
+                                              const T         thickness,
+                                              const int       max_iters)
+{
+    if (max_disp <= T(0)) {
+        return T(1);
+    }
+
+    const T thickness2 = thickness * thickness;
+
+    T d2 = dist2(x);
+
+    if (d2 <= thickness2) {
+        // already in contact
+        return T(0);
+    }
+
+    T d = sqrt(d2);
+
+    const T gap = eta * (d2 - thickness2) / (d + thickness);
+
+    T toi = T(0);
+
+    for (int it = 0; it < max_iters; ++it) {
+        const T toi_lower =
+            (T(1) - eta) * (d2 - thickness2) / ((d + thickness) * max_disp);
+
+        for (int i = 0; i < N; ++i) {
+            x[i] += toi_lower * dx[i];
+        }
+
+        d2 = dist2(x);
+        d  = sqrt(d2);
+
+        if (it > 0 && (d2 - thickness2) / (d + thickness) < gap) {
+            return toi;
+        }
+
+        toi += toi_lower;
+
+        if (toi > T(1)) {
+            return T(1);
+        }
+    }
+
+    // not converged. toi is still a lower bound
+    return toi;
+}
+
+/**
+ * @brief the relative displacement of the stencil points with respect to
+ * their mean, which does not change the distance but tightens the bound on
+ * the relative motion
+ */
+template <typename T, int N>
+__device__ __host__ __inline__ void center_displacement(
+    Eigen::Vector3<T> (&dx)[N])
+{
+    Eigen::Vector3<T> mean = Eigen::Vector3<T>::Zero();
+    for (int i = 0; i < N; ++i) {
+        mean += dx[i];
+    }
+    mean /= T(N);
+    for (int i = 0; i < N; ++i) {
+        dx[i] -= mean;
+    }
+}
+
+/**
+ * @brief conservative time of impact of a point p and a triangle (t0, t1,
+ * t2) moving along dp, dt0, dt1, dt2 over [0, 1]
+ */
+template <typename T>
+__device__ __host__ __inline__ T
+point_triangle_ccd(const Eigen::Vector3<T> (&x0)[4],
+                   Eigen::Vector3<T> (&dx)[4],
+                   const T   eta,
+                   const T   thickness,
+                   const int max_iters)
+{
+    center_displacement(dx);
+
+    const T max_disp =
+        dx[0].norm() +
+        sqrt(std::max(dx[1].squaredNorm(),
+                      std::max(dx[2].squaredNorm(), dx[3].squaredNorm())));
+
+    Eigen::Vector3<T> x[4] = {x0[0], x0[1], x0[2], x0[3]};
+
+    return additive_ccd<T, 4>(
+        x,
+        dx,
+        max_disp,
+        [](const Eigen::Vector3<T>(&y)[4]) {
+            return point_triangle_distance2(y[0], y[1], y[2], y[3]);
+        },
+        eta,
+        thickness,
+        max_iters);
+}
+
+/**
+ * @brief conservative time of impact of edges (ea0, ea1) and (eb0, eb1)
+ * moving along their displacements over [0, 1]
+ */
+template <typename T>
+__device__ __host__ __inline__ T edge_edge_ccd(const Eigen::Vector3<T> (&x0)[4],
+                                               Eigen::Vector3<T> (&dx)[4],
+                                               const T   eta,
+                                               const T   thickness,
+                                               const int max_iters)
+{
+    center_displacement(dx);
+
+    const T max_disp =
+        sqrt(std::max(dx[0].squaredNorm(), dx[1].squaredNorm())) +
+        sqrt(std::max(dx[2].squaredNorm(), dx[3].squaredNorm()));
+
+    Eigen::Vector3<T> x[4] = {x0[0], x0[1], x0[2], x0[3]};
+
+    return additive_ccd<T, 4>(
+        x,
+        dx,
+        max_disp,
+        [](const Eigen::Vector3<T>(&y)[4]) {
+            return edge_edge_distance2(y[0], y[1], y[2], y[3]);
+        },
+        eta,
+        thickness,
+        max_iters);
+}
+
+/**
+ * @brief conservative time of impact of two points moving along their
+ * displacements over [0, 1]
+ */
+template <typename T>
+__device__ __host__ __inline__ T
+point_point_ccd(const Eigen::Vector3<T> (&x0)[2],
+                Eigen::Vector3<T> (&dx)[2],
+                const T   eta,
+                const T   thickness,
+                const int max_iters)
+{
+    center_displacement(dx);
+
+    const T max_disp = dx[0].norm() + dx[1].norm();
+
+    Eigen::Vector3<T> x[2] = {x0[0], x0[1]};
+
+    return additive_ccd<T, 2>(
+        x,
+        dx,
+        max_disp,
+        [](const Eigen::Vector3<T>(&y)[2]) {
+            return (y[0] - y[1]).squaredNorm();
+        },
+        eta,
+        thickness,
+        max_iters);
+}
+
+/**
+ * @brief continuous collision detection (CCD) step filter for barrier-based
+ * line search. Given a search direction, it computes the time of impact of
+ * every candidate pair in the problem (vv_pairs, vf_pairs, and ee_pairs) when
+ * the (3D) objective moves along s_max * dir, accumulates the min time of
+ * impact of the pairs on the pair's first vertex and reduces them (using
+ * ReduceHandle) into the largest step in [0, s_max] that is free of
+ * intersections. The candidate pairs should cover the motion, e.g., found by
+ * a broad phase whose distance is larger than the max displacement.
+ * attach() installs the filter as the max step hook of a Newton solver such
+ * that the line search never starts from an infeasible step
+ */
+template <typename T>
+struct CCDStepFilter
+{
+    using DenseMatT = DenseMatrix<T, Eigen::RowMajor>;
+
+    /**
+     * @param eta the fraction of the initial distance that is kept at the
+     * time of impact (in (0, 1))
+     * @param thickness the min separation distance
+     * @param max_iters the max number of iterations of the additive CCD
+     */
+    CCDStepFilter(RXMeshStatic& rx,
+                  T             eta       = 0.1,
+                  T             thickness = 0,
+                  int           max_iters = 1000)
+        : m_eta(eta), m_thickness(thickness), m_max_iters(max_iters)
+    {
+        std::ostringstream address;
+        address << (void const*)this;
+
+        m_toi     = rx.add_vertex_attribute<T>("ccd_toi" + address.str(), 1);
+        m_reducer = std::make_shared<ReduceHandle<T, VertexHandle>>(*m_toi);
+    }
+
+    /**
+     * @brief the largest step in [0, s_max] along dir that is free of
+     * intersections for the candidate pairs of the problem
+     */
+    template <typename ProblemT>
+    T max_step(ProblemT&        problem,
+               const DenseMatT& dir,
+               const T          s_max,
+               cudaStream_t     stream = NULL)
+    {
+        if (problem.objective->get_num_attributes() != 3) {
+            RXMESH_ERROR(
+                "CCDStepFilter::max_step() only 3D objectives are supported. "
+                "The objective has {} attributes.",
+                problem.objective->get_num_attributes());
+            return s_max;
+        }
+
+        m_toi->reset(s_max, DEVICE, stream);
+
+        eval_pairs(problem.vv_pairs, *problem.objective, dir, s_max, stream);
+        eval_pairs(problem.vf_pairs, *problem.objective, dir, s_max, stream);
+        eval_pairs(problem.ee_pairs, *problem.objective, dir, s_max, stream);
+
+        return m_reducer->reduce(*m_toi, cub::Min(), s_max, INVALID32, stream);
+    }
+
+    /**
+     * @brief compute the time of impact of every pair in pairs and keep the
+     * min on the first vertex of the pair
+     */
+    template <typename PairsT>
+    void eval_pairs(PairsT&                           pairs,
+                    const Attribute<T, VertexHandle>& x,
+                    const DenseMatT&                  dir,
+                    const T                           s_max,
+                    cudaStream_t                      stream)
+    {
+        const int size = pairs.num_pairs();
+
+        if (size == 0) {
+            return;
+        }
+
+        constexpr bool IsVV = std::is_same_v<PairsT, CandidatePairsVV>;
+        constexpr bool IsVF = std::is_same_v<PairsT, CandidatePairsVF>;
+        constexpr int  N    = IsVV ? 2 : 4;
+
+        const T   eta       = m_eta;
+        const T   thickness = m_thickness;
+        const int max_iters = m_max_iters;
+
+        Attribute<T, VertexHandle> toi = *m_toi;
+
+        constexpr uint32_t blockThreads = 256;
+
+        for_each_item<<<DIVIDE_UP(size, blockThreads),
+                        blockThreads,
+                        0,
+                        stream>>>(size, [=] __device__(int id) mutable {
+            const auto iter = pairs.get_iterator(id);
+
+            Eigen::Vector3<T> x0[N];
+            Eigen::Vector3<T> dx[N];
+            for (int i = 0; i < N; ++i) {
+                for (int d = 0; d < 3; ++d) {
+                    x0[i][d] = x(iter[i], d);
+                    dx[i][d] = s_max * dir(iter[i], d);
+                }
+            }
+
+            T t;
+            if constexpr (IsVV) {
+                t = point_point_ccd(x0, dx, eta, thickness, max_iters);
+            } else if constexpr (IsVF) {
+                t = point_triangle_ccd(x0, dx, eta, thickness, max_iters);
+            } else {
+                t = edge_edge_ccd(x0, dx, eta, thickness, max_iters);
+            }
+
+            if (t < T(1)) {
+                atomicMin(&toi(iter[0]), t * s_max);
+            }
+        });
+    }
+
+    /**
+     * @brief install this filter as the max step hook of a Newton solver
+     */
+    template <typename NewtonSolverT>
+    void attach(NewtonSolverT& newton)
+    {
+        newton.max_step_filter = [this, &newton](const DenseMatT& dir,
+                                                 T                s_max,
+                                                 cudaStream_t     stream) {
+            return max_step(newton.problem, dir, s_max, stream);
+        };
+    }
+
+   protected:
+    std::shared_ptr<Attribute<T, VertexHandle>>    m_toi;
+    std::shared_ptr<ReduceHandle<T, VertexHandle>> m_reducer;
+    T                                              m_eta;
+    T                                              m_thickness;
+    int                                            m_max_iters;
+};
+
+}  // namespace rxmesh
@@ -35,6 +35,7 @@ __global__ static void hess_matvec_kernel(
     DenseMatrix<typename ScalarT::PassiveType, Eigen::RowMajor> output_vector,
     const Attribute<typename ScalarT::PassiveType, ObjHandleT>  objective,
     const bool                                                  oriented,
+    const PSDProjection                                         projection,
     LambdaT                                                     user_func)
 {
 
@@ -71,7 +72,7 @@ __global__ static void hess_matvec_kernel(
 
             // project Hessian to PD matrix
             if constexpr (ProjectHess) {
-                project_positive_definite(res.hess());
+                project_positive_definite(res.hess(), projection);
             }
 
             for (int local_i = 0; local_i < VariableDim; ++local_i) {
@@ -100,7 +101,7 @@ __global__ static void hess_matvec_kernel(
 
             // project Hessian to PD matrix
             if constexpr (ProjectHess) {
-                project_positive_definite(res.hess());
+                project_positive_definite(res.hess(), projection);
             }
 
             // Hessian
@@ -144,6 +145,158 @@ __global__ static void hess_matvec_kernel(
 }
 
 
+/**
+ * @brief evaluate the (projected) local Hessian of every loss element once
+ * and store it as a dense row-major (N x N) block in hess_cache where N is
+ * the number of active variables per element (ScalarT::k_). The linear id of
+ * every objective handle in the element is stored in hess_cache_ids (-1 for
+ * unused slots) so that hess_cache_matvec_kernel can do the Hessian-vector
+ * product as a gather-GEMV-scatter without re-differentiating the energy
+ */
+template <uint32_t blockThreads,
+          typename LossHandleT,
+          typename ObjHandleT,
+          Op op,
+          typename ScalarT,
+          bool ProjectHess,
+          int  VariableDim,
+          typename CacheT,
+          typename LambdaT>
+__global__ static void hess_cache_kernel(
+    const Context                                              context,
+    CacheT*                                                    hess_cache,
+    int*                                                       hess_cache_ids,
+    const Attribute<typename ScalarT::PassiveType, ObjHandleT> objective,
+    const bool                                                 oriented,
+    const PSDProjection                                        projection,
+    LambdaT                                                    user_func)
+{
+    using IteratorT = typename IteratorType<op>::type;
+
+    constexpr int N = ScalarT::k_;
+
+    constexpr int ElementValence = N / VariableDim;
+
+    assert(ScalarT::WithHessian_);
+
+    auto block = cooperative_groups::this_thread_block();
+
+    auto store_hess = [&](const ScalarT& res, const int e_id) {
+        CacheT* h = hess_cache + size_t(e_id) * N * N;
+        for (int r = 0; r < N; ++r) {
+            for (int c = 0; c < N; ++c) {
+                h[r * N + c] = static_cast<CacheT>(res.hess()(r, c));
+            }
+        }
+    };
+
+    // Unary queries
+    if constexpr (op == Op::V || op == Op::E || op == Op::F) {
+
+        for_each<op, blockThreads>(context, [&](const LossHandleT& fh) {
+            DiffHandle<ScalarT, LossHandleT> diff_handle(fh);
+
+            ScalarT res = user_func(diff_handle, objective);
+
+            if constexpr (ProjectHess) {
+                project_positive_definite(res.hess(), projection);
+            }
+
+            const int e_id = context.linear_id(fh);
+
+            hess_cache_ids[e_id] = context.linear_id(fh);
+
+            store_hess(res, e_id);
+        });
+    } else {
+        // Binary query
+        auto eval = [&](const LossHandleT& fh, const IteratorT& iter) {
+            DiffHandle<ScalarT, LossHandleT> diff_handle(fh);
+
+            ScalarT res = user_func(diff_handle, iter, objective);
+
+            if constexpr (ProjectHess) {
+                project_positive_definite(res.hess(), projection);
+            }
+
+            const int e_id = context.linear_id(fh);
+
+            for (int i = 0; i < ElementValence; ++i) {
+                hess_cache_ids[e_id * ElementValence + i] =
+                    (i < iter.size()) ? int(context.linear_id(iter[i])) : -1;
+            }
+
+            store_hess(res, e_id);
+        };
+
+        Query<blockThreads> query(context);
+
+        ShmemAllocator shrd_alloc;
+
+        query.dispatch<op>(block, shrd_alloc, eval, oriented);
+    }
+}
+
+/**
+ * @brief Hessian-vector product using the local Hessians cached by
+ * hess_cache_kernel. One thread per loss element gathers the N input values
+ * of its objective handles, multiplies them by the (N x N) local Hessian, and
+ * scatters (atomically) the result into the output
+ */
+template <uint32_t blockThreads,
+          int      N,
+          int      VariableDim,
+          typename T,
+          typename CacheT>
+__global__ static void hess_cache_matvec_kernel(
+    const int                             num_elements,
+    const CacheT*                         hess_cache,
+    const int*                            hess_cache_ids,
+    const DenseMatrix<T, Eigen::RowMajor> input_vector,
+    DenseMatrix<T, Eigen::RowMajor>       output_vector)
+{
+    static_assert(N > 0, "hess_cache_matvec_kernel() requires static N");
+
+    constexpr int ElementValence = N / VariableDim;
+
+    const int e_id = blockIdx.x * blockThreads + threadIdx.x;
+
+    if (e_id >= num_elements) {
+        return;
+    }
+
+    const int* ids = hess_cache_ids + size_t(e_id) * ElementValence;
+
+    // gather
+    T x[N];
+    for (int i = 0; i < ElementValence; ++i) {
+        const int id = ids[i];
+        for (int l = 0; l < VariableDim; ++l) {
+            // TODO we now assume solving single col vector
+            x[i * VariableDim + l] =
+                (id < 0) ? T(0) : input_vector(id * VariableDim + l, 0);
+        }
+    }
+
+    // GEMV and scatter
+    const CacheT* h = hess_cache + size_t(e_id) * N * N;
+    for (int i = 0; i < ElementValence; ++i) {
+        const int id = ids[i];
+        if (id < 0) {
+            continue;
+        }
+        for (int l = 0; l < VariableDim; ++l) {
+            const int r   = i * VariableDim + l;
+            T         sum = 0;
+            for (int c = 0; c < N; ++c) {
+                sum += static_cast<T>(h[r * N + c]) * x[c];
+            }
+            ::atomicAdd(&output_vector(id * VariableDim + l, 0), sum);
+        }
+    }
+}
+
+
 template <uint32_t blockThreads,
           typename LossHandleT,
           typename ObjHandleT,
@@ -208,6 +361,7 @@ __global__ static void diff_kernel_active(
     Attribute<typename ScalarT::PassiveType, LossHandleT>           loss,
     Attribute<typename ScalarT::PassiveType, ObjHandleT>            objective,
     const bool                                                      oriented,
+    const PSDProjection                                             projection,
     LambdaT                                                         user_func)
 {
 
@@ -244,7 +398,7 @@ __global__ static void diff_kernel_active(
             if constexpr (WithHessian) {
                 // project Hessian to PD matrix
                 if constexpr (ProjectHess) {
-                    project_positive_definite(res.hess());
+                    project_positive_definite(res.hess(), projection);
                 }
 
                 for (int local_i = 0; local_i < VariableDim; ++local_i) {
@@ -281,7 +435,7 @@ __global__ static void diff_kernel_active(
             if constexpr (WithHessian) {
                 // project Hessian to PD matrix
                 if constexpr (ProjectHess) {
-                    project_positive_definite(res.hess());
+                    project_positive_definite(res.hess(), projection);
                 }
 
                 // Hessian
@@ -319,21 +473,25 @@ __global__ static void diff_kernel_active(
 }
 
 
+/**
+ * @brief evaluate a term on candidate/contact pairs (e.g., CandidatePairs or
+ * ContactPairs) where the energy of a pair depends on the vertices returned by
+ * PairsT::get_iterator(). The loss of a pair is accumulated on the first
+ * vertex of the pair since many pairs may share the same vertex. Thus, the
+ * loss should be reset before calling this kernel
+ */
 template <uint32_t blockThreads,
           typename LossHandleT,
           typename ObjHandleT,
-          typename HandleT0,
-          typename HandleT1,
+          typename PairsT,
           typename ScalarT,
           typename LambdaT>
 __global__ static void diff_kernel_passive_pair(
-    CandidatePairs<HandleT0, HandleT1, int>               pairs,
+    PairsT                                                pairs,
     Attribute<typename ScalarT::PassiveType, LossHandleT> loss,
     Attribute<typename ScalarT::PassiveType, ObjHandleT>  objective,
     LambdaT                                               user_func)
 {
-    static_assert(std::is_same_v<HandleT0, HandleT1>);
-
     using PassiveT = typename ScalarT::PassiveType;
 
     const uint32_t stride = blockThreads * gridDim.x;
@@ -347,36 +505,31 @@ __global__ static void diff_kernel_passive_pair(
 
         DiffHandle<PassiveT, LossHandleT> diff_handle(id64);
 
-        std::pair<HandleT0, HandleT1> pair = pairs.get_pair(id);
-
-        PairIterator<HandleT0> iter(pair.first, pair.second);
+        const auto iter = pairs.get_iterator(id);
 
         PassiveT res = user_func(diff_handle, iter, objective);
 
-        //???? not sure which vertex should take the loss
-        loss(pair.first) = res;
+        ::atomicAdd(&loss(iter[0]), res);
     }
 }
 
 template <uint32_t blockThreads,
           typename LossHandleT,
           typename ObjHandleT,
-          typename HandleT0,
-          typename HandleT1,
+          typename PairsT,
           typename ScalarT,
           bool ProjectHess,
           int  VariableDim,
           typename LambdaT>
 __global__ static void diff_kernel_active_pair(
-    CandidatePairs<HandleT0, HandleT1, int>                         pairs,
+    PairsT                                                          pairs,
     DenseMatrix<typename ScalarT::PassiveType, Eigen::RowMajor>     grad,
     HessianSparseMatrix<typename ScalarT::PassiveType, VariableDim> hess,
     Attribute<typename ScalarT::PassiveType, LossHandleT>           loss,
     Attribute<typename ScalarT::PassiveType, ObjHandleT>            objective,
+    const PSDProjection                                             projection,
     LambdaT                                                         user_func)
 {
-    static_assert(std::is_same_v<HandleT0, HandleT1>);
-
     using PassiveT = typename ScalarT::PassiveType;
 
     constexpr bool WithHessian = ScalarT::WithHessian_;
@@ -395,14 +548,11 @@ __global__ static void diff_kernel_active_pair(
 
         DiffHandle<ScalarT, LossHandleT> diff_handle(id64);
 
-        std::pair<HandleT0, HandleT1> pair = pairs.get_pair(id);
-
-        PairIterator<HandleT0> iter(pair.first, pair.second);
+        const auto iter = pairs.get_iterator(id);
 
         ScalarT res = user_func(diff_handle, iter, objective);
 
-        //???? not sure which vertex should take the loss
-        loss(pair.first) = res.val();
+        ::atomicAdd(&loss(iter[0]), res.val());
 
         // gradient
         for (int i = 0; i < iter.size(); ++i) {
@@ -416,15 +566,15 @@ __global__ static void diff_kernel_active_pair(
         if constexpr (WithHessian) {
             // project Hessian to PD matrix
             if constexpr (ProjectHess) {
-                project_positive_definite(res.hess());
+                project_positive_definite(res.hess(), projection);
             }
 
             // Hessian
             for (int i = 0; i < iter.size(); ++i) {
-                const HandleT0 vi = iter[i];
+                const auto vi = iter[i];
 
                 for (int j = 0; j < iter.size(); ++j) {
-                    const HandleT0 vj = iter[j];
+                    const auto vj = iter[j];
 
                     for (int local_i = 0; local_i < VariableDim; ++local_i) {
 
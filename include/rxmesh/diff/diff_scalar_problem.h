@@ -1,5 +1,13 @@
 #pragma once
 
+#include <utility>
+
+#include <thrust/execution_policy.h>
+#include <thrust/remove.h>
+#include <thrust/sort.h>
+#include <thrust/unique.h>
+
+#include "rxmesh/kernels/util.cuh"
 #include "rxmesh/rxmesh_static.h"
 
 #include "rxmesh/diff/candidate_pairs.h"
@@ -19,6 +27,12 @@ namespace rxmesh {
  * parametrization)
  * @tparam VariableDim the dimensions of the active variable defined on each
  * mesh element under consideration (e.g., 2 for mesh parametrization)
+ * Every evaluation, reduction, and Hessian update takes a stream and the
+ * problem owns its temporaries (and its matrices own their cuBLAS/cuSPARSE
+ * handles) so independent problems (e.g., on different meshes) along with
+ * their solvers could run concurrently on separate non-blocking streams
+ * (see cudaStreamCreateWithFlags()). Allocations (e.g., when the Hessian
+ * sparsity grows) still synchronize the device
  */
 template <typename T, int VariableDim, typename ObjHandleT, bool WithHess>
 struct DiffScalarProblem
@@ -41,24 +55,54 @@ struct DiffScalarProblem
     std::shared_ptr<Attribute<T, ObjHandleT>>         objective;
     std::vector<std::shared_ptr<Term<T, ObjHandleT>>> terms;
 
-    // TODO we might need other types of candidate pairs
+    // candidate/contact pairs for terms that act on pairs (see
+    // add_pair_term())
     CandidatePairsVV vv_pairs;
+    CandidatePairsVF vf_pairs;
+    CandidatePairsEE ee_pairs;
+
+    // scratch buffers (allocated on the first need) used by update_hessian()
+    // to remove duplicated entries
+    DenseMatrix<uint64_t>                new_entries_key;
+    DenseMatrix<IndexT, Eigen::ColMajor> new_entries_id;
+
+    // element-by-element Hessian mode (see enable_hessian_cache())
+    bool hess_cache_enabled;
+    bool hess_cache_fp32;
+
+    // how terms with ProjectHess project their local Hessians (see
+    // set_hess_projection())
+    PSDProjection hess_projection;
 
 
     /**
      * @brief Constructor
      * @param rx is the instance of RXMeshStatic
      * @param assmble_hessian should allocate the Hessian
+     * @param expected_vv_candidate_pairs the capacity of vv_pairs
+     * @param expected_vf_candidate_pairs the capacity of vf_pairs
+     * @param expected_ee_candidate_pairs the capacity of ee_pairs
      */
     DiffScalarProblem(RXMeshStatic& rx,
                       bool          assmble_hessian,
-                      int           expected_vv_candidate_pairs = 0)
+                      int           expected_vv_candidate_pairs = 0,
+                      int           expected_vf_candidate_pairs = 0,
+                      int           expected_ee_candidate_pairs = 0)
         : rx(rx),
           grad(DenseMatT(rx, rx.get_num_elements<ObjHandleT>(), VariableDim)),
           objective(rx.add_vertex_attribute<T>("objective", VariableDim)),
           vv_pairs(CandidatePairsVV(expected_vv_candidate_pairs,
                                     VariableDim,
-                                    rx.get_context()))
+                                    rx.get_context())),
+          vf_pairs(CandidatePairsVF(expected_vf_candidate_pairs,
+                                    VariableDim,
+                                    rx.get_context())),
+          ee_pairs(CandidatePairsEE(expected_ee_candidate_pairs,
+                                    VariableDim,
+                                    rx.get_context())),
+          hess_cache_enabled(false),
+          hess_cache_fp32(false),
+          hess_projection(PSDProjection::Clamp)
     {
         grad.reset(0, LOCATION_ALL);
 
@@ -67,15 +111,19 @@ struct DiffScalarProblem
 
                 // every contact candidate pairs will add a 2 (because of
                 // symmetry) blocks of (VariableDim x VariableDim) into the
-                // Hessian
-                expected_vv_candidate_pairs *= VariableDim * VariableDim * 2;
-
-                hess =
-                    std::make_unique<HessMatT>(rx, expected_vv_candidate_pairs);
+                // Hessian. VF and EE pairs add the off-diagonal blocks of
+                // their four vertices
+                const int expected_nnz =
+                    VariableDim * VariableDim *
+                    (2 * expected_vv_candidate_pairs +
+                     CandidatePairsVF::NumBlocks *
+                         (expected_vf_candidate_pairs +
+                          expected_ee_candidate_pairs));
+
+                hess = std::make_unique<HessMatT>(rx, expected_nnz);
                 hess->reset(0, LOCATION_ALL);
 
-                hess_new =
-                    std::make_unique<HessMatT>(rx, expected_vv_candidate_pairs);
+                hess_new = std::make_unique<HessMatT>(rx, expected_nnz);
             }
         }
     }
@@ -109,6 +157,7 @@ struct DiffScalarProblem
                                                            VariableDim,
                                                            LambdaT>>(
                 rx, t, oreinted, grad, *hess);
+            new_term->set_hess_projection(hess_projection);
             terms.push_back(
                 std::dynamic_pointer_cast<Term<T, ObjHandleT>>(new_term));
         }
@@ -124,6 +173,7 @@ struct DiffScalarProblem
                                                            VariableDim,
                                                            LambdaT>>(
                 rx, t, oreinted, grad, *hess);
+            new_term->set_hess_projection(hess_projection);
             terms.push_back(
                 std::dynamic_pointer_cast<Term<T, ObjHandleT>>(new_term));
         }
@@ -139,6 +189,7 @@ struct DiffScalarProblem
                                                            VariableDim,
                                                            LambdaT>>(
                 rx, t, oreinted, grad, *hess);
+            new_term->set_hess_projection(hess_projection);
             terms.push_back(
                 std::dynamic_pointer_cast<Term<T, ObjHandleT>>(new_term));
         }
@@ -146,48 +197,254 @@ struct DiffScalarProblem
 
 
     /**
-     * @brief add a (energy) term to the loss function that acts on candidate
-     * pairs
-     * TODO generalize this to other type of candidate pairs. For now, we assume
-     * only VV pairs
+     * @brief add several (energy) terms that depend on the same local query
+     * operation as one fused term. Instead of launching one kernel per term
+     * (where every kernel re-runs the query, re-reads the objective, and
+     * scatters its own gradient and Hessian with atomics), the terms are
+     * evaluated in one kernel and their contributions on every element are
+     * summed locally before one scatter. Every lambda should have the same
+     * signature as in add_term(). The loss of the fused term is the sum of the
+     * terms' losses. With ProjectHess, the sum of the element Hessians is
+     * projected (instead of every term's Hessian) which is also positive
+     * (semi-)definite but may differ from adding the terms separately
+     */
+    template <Op       op,
+              bool     ProjectHess  = false,
+              uint32_t blockThreads = 256,
+              typename... LambdaTs>
+    void add_fused_term(LambdaTs... ts)
+    {
+        static_assert(sizeof...(LambdaTs) > 0,
+                      "add_fused_term() needs at least one term");
+
+        add_term<op, ProjectHess, blockThreads>(FusedTerms<LambdaTs...>(ts...));
+    }
+
+    /**
+     * @brief add a (energy) term to the loss function that acts on the
+     * candidate pairs in vv_pairs (see add_pair_term())
      */
     template <bool     ProjectHess  = false,
               uint32_t blockThreads = 256,
               typename LambdaT      = void>
     void add_term(LambdaT t)
     {
-        constexpr int ElementValence = 2;  // TODO
+        add_pair_term<VertexHandle, VertexHandle, ProjectHess, blockThreads>(
+            t);
+    }
+
+    /**
+     * @brief add a (energy) term to the loss function that acts on candidate
+     * pairs of type (HandleT0, HandleT1), i.e., vertex-vertex (vv_pairs),
+     * vertex-face (vf_pairs), or edge-edge (ee_pairs) pairs. The lambda takes
+     * the pair id, an iterator over the vertices the pair depends on, and the
+     * objective. For VV pairs, the iterator has the two vertices. For VF
+     * pairs, it has the vertex followed by the three face vertices. For EE
+     * pairs, it has the two vertices of each edge. The pairs can be filled by
+     * the user or by a broad phase (e.g., LBVHBroadPhase). After the pairs
+     * change, update_hessian() should be called before evaluating the terms
+     */
+    template <typename HandleT0,
+              typename HandleT1,
+              bool     ProjectHess  = false,
+              uint32_t blockThreads = 256,
+              typename LambdaT      = void>
+    void add_pair_term(LambdaT t)
+    {
+        auto& pairs = get_pairs<HandleT0, HandleT1>();
+
+        using PairsT = std::remove_reference_t<decltype(pairs)>;
+
+        constexpr int ElementValence =
+            std::is_same_v<PairsT, CandidatePairsVV> ? 2 :
+                                                       PairsT::StencilSize;
 
         constexpr int NElements = VariableDim * ElementValence;
 
         using ScalarT = Scalar<T, NElements, WithHessian>;
 
-
-        auto new_term =
-            std::make_shared<TemplatedTermPairs<VertexHandle,  // TODO
-                                                ObjHandleT,
-                                                blockThreads,
-                                                VertexHandle,  // TODO
-                                                VertexHandle,  // TODO
-                                                ScalarT,
-                                                ProjectHess,
-                                                VariableDim,
-                                                LambdaT>>(
-                rx, t, grad, *hess, vv_pairs);
+        auto new_term = std::make_shared<TemplatedTermPairs<VertexHandle,
+                                                            ObjHandleT,
+                                                            blockThreads,
+                                                            PairsT,
+                                                            ScalarT,
+                                                            ProjectHess,
+                                                            VariableDim,
+                                                            LambdaT>>(
+            rx, t, grad, *hess, pairs);
+        new_term->set_hess_projection(hess_projection);
 
         terms.push_back(
             std::dynamic_pointer_cast<Term<T, ObjHandleT>>(new_term));
     }
 
+    /**
+     * @brief return the container of the candidate pairs of type (HandleT0,
+     * HandleT1)
+     */
+    template <typename HandleT0, typename HandleT1>
+    auto& get_pairs()
+    {
+        if constexpr (std::is_same_v<HandleT0, VertexHandle> &&
+                      std::is_same_v<HandleT1, VertexHandle>) {
+            return vv_pairs;
+        } else if constexpr (std::is_same_v<HandleT0, VertexHandle> &&
+                             std::is_same_v<HandleT1, FaceHandle>) {
+            return vf_pairs;
+        } else {
+            static_assert(std::is_same_v<HandleT0, EdgeHandle> &&
+                              std::is_same_v<HandleT1, EdgeHandle>,
+                          "DiffScalarProblem::get_pairs() only VV, VF, and EE "
+                          "pairs are supported");
+            return ee_pairs;
+        }
+    }
+
+    /**
+     * @brief add the Hessian entries of the current candidate pairs (VV, VF,
+     * and EE) to the Hessian sparsity. Entries that are already in the
+     * Hessian (e.g., because the vertices are neighbors in the mesh or the
+     * pair was there in a previous call) or are shared by many pairs are
+     * inserted once. The Hessian object is updated in place such that the
+     * terms and the solvers that refer to it see the new sparsity
+     * @param stream the stream to run the update on
+     */
+    void update_hessian(cudaStream_t stream = NULL)
+    {
+        const int num_vv  = vv_pairs.num_index();
+        const int num_vf  = vf_pairs.num_index();
+        const int num_ee  = ee_pairs.num_index();
+        const int num_new = num_vv + num_vf + num_ee;
+
+        if (num_new == 0) {
+            return;
+        }
+
+        alloc_new_entries(num_new);
+
+        const IndexT* vv_rows = vv_pairs.m_pairs_id.col_data(0);
+        const IndexT* vv_cols = vv_pairs.m_pairs_id.col_data(1);
+        const IndexT* vf_rows = vf_pairs.m_pairs_id.col_data(0);
+        const IndexT* vf_cols = vf_pairs.m_pairs_id.col_data(1);
+        const IndexT* ee_rows = ee_pairs.m_pairs_id.col_data(0);
+        const IndexT* ee_cols = ee_pairs.m_pairs_id.col_data(1);
+
+        IndexT* d_rows = new_entries_id.col_data(0);
+        IndexT* d_cols = new_entries_id.col_data(1);
+
+        constexpr uint32_t blockThreads = 256;
+
+        const uint32_t blocks = DIVIDE_UP(num_new, blockThreads);
+
+        for_each_item<<<blocks, blockThreads, 0, stream>>>(
+            num_new, [=] __device__(int k) {
+                if (k < num_vv) {
+                    d_rows[k] = vv_rows[k];
+                    d_cols[k] = vv_cols[k];
+                } else if (k < num_vv + num_vf) {
+                    d_rows[k] = vf_rows[k - num_vv];
+                    d_cols[k] = vf_cols[k - num_vv];
+                } else {
+                    d_rows[k] = ee_rows[k - num_vv - num_vf];
+                    d_cols[k] = ee_cols[k - num_vv - num_vf];
+                }
+            });
+
+        insert_unique_entries(num_new, stream);
+    }
 
-    void update_hessian()
+    /**
+     * @brief add size new entries (given by their row and column indices on
+     * the device) to the Hessian sparsity. As in update_hessian(), existing
+     * and duplicated entries are inserted once
+     */
+    void update_hessian(const int     size,
+                        const IndexT* d_new_rows,
+                        const IndexT* d_new_cols,
+                        cudaStream_t  stream = NULL)
     {
-        hess_new->insert(rx,
-                         *hess,
-                         vv_pairs.num_index(),
-                         vv_pairs.m_pairs_id.col_data(0),
-                         vv_pairs.m_pairs_id.col_data(1));
-        hess_new.swap(hess);
+        if (size == 0) {
+            return;
+        }
+
+        alloc_new_entries(size);
+
+        CUDA_ERROR(cudaMemcpyAsync(new_entries_id.col_data(0),
+                                   d_new_rows,
+                                   size * sizeof(IndexT),
+                                   cudaMemcpyDeviceToDevice,
+                                   stream));
+        CUDA_ERROR(cudaMemcpyAsync(new_entries_id.col_data(1),
+                                   d_new_cols,
+                                   size * sizeof(IndexT),
+                                   cudaMemcpyDeviceToDevice,
+                                   stream));
+
+        insert_unique_entries(size, stream);
+    }
+
+    /**
+     * @brief insert the first size entries of new_entries_id into the
+     * Hessian after removing the ones that are already in the Hessian and the
+     * duplicates
+     */
+    void insert_unique_entries(const int size, cudaStream_t stream = NULL)
+    {
+        uint64_t* d_keys = new_entries_key.data(DEVICE);
+        IndexT*   d_rows = new_entries_id.col_data(0);
+        IndexT*   d_cols = new_entries_id.col_data(1);
+
+        const HessMatT h = *hess;
+
+        constexpr uint32_t blockThreads = 256;
+
+        const uint32_t blocks = DIVIDE_UP(size, blockThreads);
+
+        for_each_item<<<blocks, blockThreads, 0, stream>>>(
+            size, [=] __device__(int k) {
+                const IndexT r = d_rows[k];
+                const IndexT c = d_cols[k];
+
+                d_keys[k] = (h.get_val_idx(r, c) >= 0) ?
+                                INVALID64 :
+                                (uint64_t(r) << 32) | uint64_t(c);
+            });
+
+        uint64_t* d_end = thrust::remove(
+            thrust::cuda::par.on(stream), d_keys, d_keys + size, INVALID64);
+        thrust::sort(thrust::cuda::par.on(stream), d_keys, d_end);
+        d_end = thrust::unique(thrust::cuda::par.on(stream), d_keys, d_end);
+
+        const int num_unique = static_cast<int>(d_end - d_keys);
+
+        if (num_unique == 0) {
+            return;
+        }
+
+        const uint32_t unique_blocks = DIVIDE_UP(num_unique, blockThreads);
+
+        for_each_item<<<unique_blocks, blockThreads, 0, stream>>>(
+            num_unique, [=] __device__(int k) {
+                d_rows[k] = static_cast<IndexT>(d_keys[k] >> 32);
+                d_cols[k] = static_cast<IndexT>(d_keys[k] & 0xFFFFFFFFu);
+            });
+
+        hess_new->insert(rx, *hess, num_unique, d_rows, d_cols, stream);
+
+        // swap the content (not the pointers) since the terms keep a
+        // reference to the Hessian
+        std::swap(*hess, *hess_new);
+    }
+
+    void alloc_new_entries(const int size)
+    {
+        if (size > new_entries_key.rows()) {
+            new_entries_key.release();
+            new_entries_id.release();
+            new_entries_key = DenseMatrix<uint64_t>(size, 1, DEVICE);
+            new_entries_id =
+                DenseMatrix<IndexT, Eigen::ColMajor>(size, 2, DEVICE);
+        }
     }
 
     /**
@@ -220,7 +477,9 @@ struct DiffScalarProblem
     }
 
     /**
-     * @brief Hessian-vector product
+     * @brief Hessian-vector product. If the Hessian cache is enabled, the
+     * product uses the local Hessians stored by the last call to
+     * eval_hessian_cache(). Otherwise, all terms are re-differentiated
      */
     void eval_matvec(const DenseMatrix<T, Eigen::RowMajor>& input,
                      DenseMatrix<T, Eigen::RowMajor>&       output,
@@ -229,7 +488,108 @@ struct DiffScalarProblem
         output.reset(0, DEVICE, stream);
 
         for (size_t i = 0; i < terms.size(); ++i) {
-            terms[i]->eval_active_matvec(*objective, input, output, stream);
+            if (hess_cache_enabled) {
+                terms[i]->eval_cached_matvec(input, output, stream);
+            } else {
+                terms[i]->eval_active_matvec(*objective, input, output, stream);
+            }
+        }
+    }
+
+    /**
+     * @brief enable the element-by-element Hessian mode for matrix-free
+     * solvers where the (projected) local Hessian of every term element is
+     * evaluated once by eval_hessian_cache() (e.g., once per Newton iteration)
+     * and every eval_matvec() is then a gather-GEMV-scatter over these local
+     * Hessians instead of re-differentiating the energy and without
+     * assembling the global Hessian
+     * @param fp32 store the local Hessians in single precision
+     */
+    void enable_hessian_cache(bool fp32 = false)
+    {
+        if constexpr (!WithHessian) {
+            RXMESH_ERROR(
+                "DiffScalarProblem::enable_hessian_cache() the problem is "
+                "defined without Hessians.");
+            return;
+        }
+        hess_cache_enabled = true;
+        hess_cache_fp32    = fp32;
+    }
+
+    /**
+     * @brief disable the element-by-element Hessian mode and free its memory
+     */
+    void disable_hessian_cache()
+    {
+        hess_cache_enabled = false;
+        for (size_t i = 0; i < terms.size(); ++i) {
+            terms[i]->release_hessian_cache();
+        }
+    }
+
+    /**
+     * @brief if the element-by-element Hessian mode is enabled
+     */
+    bool is_hessian_cache_enabled() const
+    {
+        return hess_cache_enabled;
+    }
+
+    /**
+     * @brief evaluate and store the local Hessians of all terms at the current
+     * objective (see enable_hessian_cache())
+     */
+    void eval_hessian_cache(cudaStream_t stream = NULL)
+    {
+        if (!hess_cache_enabled) {
+            RXMESH_ERROR(
+                "DiffScalarProblem::eval_hessian_cache() the Hessian cache is "
+                "not enabled. Call enable_hessian_cache() first.");
+            return;
+        }
+
+        for (size_t i = 0; i < terms.size(); ++i) {
+            terms[i]->eval_hessian_cache(*objective, hess_cache_fp32, stream);
+        }
+    }
+
+    /**
+     * @brief set how the terms added with ProjectHess project their local
+     * Hessians to positive-definite matrices (for the existing terms and the
+     * ones added later). PSDProjection::Clamp is the default
+     */
+    void set_hess_projection(PSDProjection method)
+    {
+        hess_projection = method;
+        for (size_t i = 0; i < terms.size(); ++i) {
+            terms[i]->set_hess_projection(method);
+        }
+    }
+
+    /**
+     * @brief the resource usage (registers, local memory/spilling, and
+     * occupancy) of the kernel of every term (in the order they were added)
+     */
+    std::vector<TermReport> get_term_reports()
+    {
+        std::vector<TermReport> reports;
+        reports.reserve(terms.size());
+        for (size_t i = 0; i < terms.size(); ++i) {
+            reports.push_back(terms[i]->get_report());
+        }
+        return reports;
+    }
+
+    /**
+     * @brief print the resource usage of every term and warn for terms that
+     * spill into local memory
+     */
+    void print_term_reports()
+    {
+        std::vector<TermReport> reports = get_term_reports();
+        for (size_t i = 0; i < reports.size(); ++i) {
+            reports[i].print(std::to_string(i));
         }
     }
 
@@ -262,6 +622,21 @@ struct DiffScalarProblem
         }
     }
 
+    /**
+     * @brief evaluate all terms in passive mode on obj and write the loss of
+     * the i-th term to d_losses[i] on the device (without host
+     * synchronization). d_losses should have at least terms.size() entries
+     */
+    void eval_terms_passive_async(Attribute<T, ObjHandleT>* obj,
+                                  T*                        d_losses,
+                                  cudaStream_t              stream = NULL)
+    {
+        for (size_t i = 0; i < terms.size(); ++i) {
+            terms[i]->eval_passive(*obj, stream);
+            terms[i]->get_loss_async(d_losses + i, stream);
+        }
+    }
+
     /**
      * @brief evaluate all terms
      */
@@ -9,6 +9,8 @@
 #include <Eigen/Dense>
 #include <Eigen/Eigenvalues>
 
+#include <limits>
+
 namespace rxmesh {
 
 constexpr double default_hessian_projection_eps = 1e-9;
@@ -39,6 +41,115 @@ __inline__ __host__ __device__ bool positive_diagonally_dominant(
     return true;
 }
 
+/**
+ * @brief the method used to project the local Hessian of an energy term to a
+ * positive-definite matrix (see project_positive_definite())
+ * Clamp: clamp the negative eigenvalues to eps (the default)
+ * Abs: replace every eigenvalue by its absolute value (bounded below by eps).
+ * This keeps the curvature magnitude along the negative directions which
+ * typically needs fewer Newton iterations than clamping them
+ * DiagonalShift: add a multiple of the identity such that the Gershgorin lower
+ * bound on the smallest eigenvalue is at least eps. It needs no eigen
+ * decomposition but over-regularizes the matrix and so it may need more
+ * Newton iterations
+ */
+enum class PSDProjection
+{
+    Clamp         = 0,
+    Abs           = 1,
+    DiagonalShift = 2,
+};
+
+// matrices up to this size are decomposed using jacobi_eigen() instead of
+// Eigen's SelfAdjointEigenSolver
+constexpr int jacobi_eigen_max_size = 12;
+
+/**
+ * @brief Eigen decomposition of a small symmetric matrix using the cyclic
+ * Jacobi method such that A = V * diag(eigvals) * V^T. Every rotation zeros
+ * one off-diagonal entry and a sweep goes over all of them. The number of
+ * sweeps is typically small (< 10) since the method converges quadratically.
+ * Compared to SelfAdjointEigenSolver, it has no tridiagonalization, no
+ * branchy implicit QR, and no sorting which makes it cheaper for the small
+ * fixed-sized matrices that every thread projects independently
+ * @param A the symmetric matrix which is overwritten by the rotations
+ */
+template <int k, typename T>
+__inline__ __host__ __device__ void jacobi_eigen(
+    Eigen::Matrix<T, k, k>& A,
+    Eigen::Matrix<T, k, 1>& eigvals,
+    Eigen::Matrix<T, k, k>& V,
+    const int               max_sweeps = 20)
+{
+    V.setIdentity();
+
+    T norm2 = 0;
+    for (int i = 0; i < k; ++i) {
+        for (int j = 0; j < k; ++j) {
+            norm2 += A(i, j) * A(i, j);
+        }
+    }
+
+    const T tol = std::numeric_limits<T>::epsilon() *
+                  std::numeric_limits<T>::epsilon() * norm2;
+
+    for (int sweep = 0; sweep < max_sweeps; ++sweep) {
+        T off2 = 0;
+        for (int p = 0; p < k; ++p) {
+            for (int q = p + 1; q < k; ++q) {
+                off2 += A(p, q) * A(p, q);
+            }
+        }
+
+        if (off2 <= tol) {
+            break;
+        }
+
+        for (int p = 0; p < k; ++p) {
+            for (int q = p + 1; q < k; ++q) {
+                const T apq = A(p, q);
+                if (apq == T(0)) {
+                    continue;
+                }
+
+                // rotation (c, s) that zeros A(p, q)
+                const T theta = (A(q, q) - A(p, p)) / (T(2) * apq);
+                const T t     = (theta >= 0 ? T(1) : T(-1)) /
+                            (std::abs(theta) + std::sqrt(theta * theta + 1));
+                const T c = T(1) / std::sqrt(t * t + 1);
+                const T s = t * c;
+
+                for (int r = 0; r < k; ++r) {
+                    if (r != p && r != q) {
+                        const T arp = A(r, p);
+                        const T arq = A(r, q);
+                        A(r, p)     = c * arp - s * arq;
+                        A(p, r)     = A(r, p);
+                        A(r, q)     = s * arp + c * arq;
+                        A(q, r)     = A(r, q);
+                    }
+                }
+
+                A(p, p) -= t * apq;
+                A(q, q) += t * apq;
+                A(p, q) = 0;
+                A(q, p) = 0;
+
+                for (int r = 0; r < k; ++r) {
+                    const T vrp = V(r, p);
+                    const T vrq = V(r, q);
+                    V(r, p)     = c * vrp - s * vrq;
+                    V(r, q)     = s * vrp + c * vrq;
+                }
+            }
+        }
+    }
+
+    for (int i = 0; i < k; ++i) {
+        eigvals[i] = A(i, i);
+    }
+}
+
 /**
  * @brief Project symmetric matrix to positive-definite matrix
  * via eigen decomposition.
@@ -46,6 +157,7 @@ __inline__ __host__ __device__ bool positive_diagonally_dominant(
 template <int k, typename T>
 __inline__ __host__ __device__ void project_positive_definite(
     Eigen::Matrix<T, k, k>& H,
+    const PSDProjection     method,
     const T eigenvalue_eps = (std::is_same_v<T, double> ? 1e-9 : 1e-6))
 {
 
@@ -53,30 +165,67 @@ __inline__ __host__ __device__ void project_positive_definite(
         return;
     } else {
         using MatT = Eigen::Matrix<T, k, k>;
+        using VecT = Eigen::Matrix<T, k, 1>;
 
         // Early out if sufficient condition is fulfilled
         if (positive_diagonally_dominant<k, T>(H, eigenvalue_eps)) {
             return;
         }
 
+        if (method == PSDProjection::DiagonalShift) {
+            // Gershgorin lower bound on the smallest eigenvalue
+            T lower = std::numeric_limits<T>::max();
+            for (Eigen::Index i = 0; i < H.rows(); ++i) {
+                T off_diag_abs_sum = 0.0;
+                for (Eigen::Index j = 0; j < H.cols(); ++j) {
+                    if (i != j) {
+                        off_diag_abs_sum += std::abs(H(i, j));
+                    }
+                }
+                lower = std::min(lower, H(i, i) - off_diag_abs_sum);
+            }
+
+            const T shift = eigenvalue_eps - lower;
+            for (Eigen::Index i = 0; i < H.rows(); ++i) {
+                H(i, i) += shift;
+            }
+
+            assert(is_finite_mat(H));
+            return;
+        }
+
         // Compute eigen-decomposition (of symmetric matrix)
-        Eigen::SelfAdjointEigenSolver<MatT> eig(H);
+        VecT eigvals;
+        MatT eigvect;
 
-        //This method is buggy on the GPU. It results into all zero matrix!!
-        //MatT D = eig.eigenvalues().asDiagonal();
+        if constexpr (k > 0 && k <= jacobi_eigen_max_size) {
+            MatT A = H;
+            jacobi_eigen<k, T>(A, eigvals, eigvect);
+        } else {
+            Eigen::SelfAdjointEigenSolver<MatT> eig(H);
+            eigvals = eig.eigenvalues();
+            eigvect = eig.eigenvectors();
+        }
+
+        //asDiagonal() is buggy on the GPU. It results into all zero matrix!!
+        //MatT D = eigvals.asDiagonal();
 
         MatT D;
         D.setZero();
 
         for (Eigen::Index i = 0; i < H.rows(); ++i) {
-            D(i, i) = eig.eigenvalues()[i];
+            D(i, i) = eigvals[i];
         }
-       
-        // Clamp all eigenvalues to eps
+
+        // Clamp (or mirror) all eigenvalues to eps
         bool all_positive = true;
         for (Eigen::Index i = 0; i < H.rows(); ++i) {
             if (D(i, i) < eigenvalue_eps) {
-                D(i, i)      = eigenvalue_eps;
+                if (method == PSDProjection::Abs) {
+                    D(i, i) = std::max(std::abs(D(i, i)), eigenvalue_eps);
+                } else {
+                    D(i, i) = eigenvalue_eps;
+                }
                 all_positive = false;
             }
         }
@@ -87,11 +236,22 @@ __inline__ __host__ __device__ void project_positive_definite(
         }
 
         // Re-assemble matrix using clamped eigenvalues
-        MatT eigvect = eig.eigenvectors();
         H = eigvect * D * eigvect.transpose();
 
         assert(is_finite_mat(H));
     }
 }
 
+/**
+ * @brief Project symmetric matrix to positive-definite matrix by clamping its
+ * eigenvalues (i.e., PSDProjection::Clamp)
+ */
+template <int k, typename T>
+__inline__ __host__ __device__ void project_positive_definite(
+    Eigen::Matrix<T, k, k>& H,
+    const T eigenvalue_eps = (std::is_same_v<T, double> ? 1e-9 : 1e-6))
+{
+    project_positive_definite<k, T>(H, PSDProjection::Clamp, eigenvalue_eps);
+}
+
 }  // namespace rxmesh
@@ -0,0 +1,272 @@
+#pragma once
+
+#include <functional>
+#include <limits>
+
+#include "rxmesh/diff/newton_solver.h"
+
+namespace rxmesh {
+
+/**
+ * @brief the parameters of ImplicitIntegrator
+ */
+template <typename T>
+struct ImplicitIntegratorOptions
+{
+    // time step
+    T h = T(0.01);
+
+    // Newton stops when abs_max(dir) / h is below tol (see
+    // ImplicitIntegrator::converged)
+    T tol = T(0.01);
+
+    // max number of Newton iterations per time step
+    int max_newton_iter = 100;
+
+    // start Newton from the extrapolated state x_n + h * v_n instead of x_n
+    bool warm_start = true;
+
+    // the number of consecutive Newton iterations that reuse the last
+    // factorization of the Hessian (an inexact/lagged Newton) before it is
+    // re-evaluated and re-factorized. The lagged iterations only evaluate the
+    // gradient. With 0, every Newton iteration uses its own Hessian. The
+    // factorization is always refreshed if the residual increases
+    int hessian_lag = 0;
+
+    // keep lagging the Hessian across time steps, i.e., the first Newton
+    // iteration of a time step does not force a new factorization. Combined
+    // with a large hessian_lag, the cost becomes a factorization every few
+    // time steps
+    bool lag_across_steps = false;
+
+    // the line search shrink factor
+    T line_search_shrink = T(0.5);
+};
+
+/**
+ * @brief implicit (backward Euler) time integration where every time step
+ * minimizes the incremental potential of the problem (whose objective is the
+ * positions x) using Newton. The Newton solver, the Hessian, the linear solver
+ * (and so its symbolic factorization), and the temporaries live as long as the
+ * integrator so that every time step only pays for the numerical work. Every
+ * step does the following:
+ * 1) x_n = x and (if warm_start) x = x_n + h * v_n
+ * 2) Newton iterations where every iteration calls pre_eval, evaluates the
+ * terms (or only their gradient while the Hessian is lagged), calls post_eval
+ * (e.g., to apply the boundary conditions), computes the Newton direction,
+ * checks convergence, and then does a line search starting from max_step
+ * 3) v_{n+1} = (x - x_n) / h
+ * The energy terms that depend on x_n or v_n (e.g., the inertial term) should
+ * read them from the attributes returned by get_x_n() and get_velocity() or
+ * from the attributes the user updates right before step()
+ */
+template <typename T, int VariableDim, typename ObjHandleT, typename SolverT>
+struct ImplicitIntegrator
+{
+    using DiffProblemT = DiffScalarProblem<T, VariableDim, ObjHandleT, true>;
+    using NewtonT      = NetwtonSolver<T, VariableDim, ObjHandleT, SolverT>;
+    using AttributeT   = Attribute<T, ObjHandleT>;
+
+    DiffProblemT&                problem;
+    NewtonT                      newton;
+    ImplicitIntegratorOptions<T> options;
+
+    // the hooks below get the stream passed to step() such that independent
+    // integrators could run concurrently on separate streams
+
+    // called before every evaluation of the terms (e.g., to update the
+    // contact pairs and the Hessian sparsity)
+    std::function<void(cudaStream_t)> pre_eval;
+
+    // called after every evaluation of the terms and before computing the
+    // Newton direction (e.g., NetwtonSolver::apply_bc())
+    std::function<void(cudaStream_t)> post_eval;
+
+    // the initial step of the line search along newton.dir (e.g., the max
+    // step that keeps the barrier energies finite). Default is 1
+    std::function<T(cudaStream_t)> max_step;
+
+    // return true if Newton should stop given the residual. Default is
+    // residual <= options.tol
+    std::function<bool(T)> converged;
+
+    /**
+     * @brief the integrator of the problem p (whose objective is the
+     * positions) using the linear solver s on the problem Hessian. velocity
+     * stores v_n and it is updated at the end of every step
+     */
+    ImplicitIntegrator(DiffProblemT&                       p,
+                       SolverT*                            s,
+                       AttributeT&                         velocity,
+                       const ImplicitIntegratorOptions<T>& opt = {})
+        : problem(p),
+          newton(p, s),
+          options(opt),
+          m_velocity(velocity),
+          m_x_n(p.rx.add_attribute_like("ii_x_n", *p.objective)),
+          m_num_steps(0),
+          m_num_newton_iter(0),
+          m_num_factorizations(0),
+          m_lagged(0),
+          m_factorized(false)
+    {
+    }
+
+    /**
+     * @brief advance one time step. Return the number of Newton iterations
+     */
+    int step(cudaStream_t stream = NULL)
+    {
+        const T h = options.h;
+
+        AttributeT x   = *problem.objective;
+        AttributeT x_n = *m_x_n;
+        AttributeT v   = m_velocity;
+
+        x_n.copy_from(x, DEVICE, DEVICE, stream);
+
+        if (options.warm_start) {
+            problem.rx.template for_each<ObjHandleT>(
+                DEVICE,
+                [=] __device__(const ObjHandleT& oh) mutable {
+                    for (int i = 0; i < VariableDim; ++i) {
+                        x(oh, i) = x_n(oh, i) + h * v(oh, i);
+                    }
+                },
+                stream);
+        }
+
+        if (!options.lag_across_steps) {
+            m_factorized = false;
+        }
+
+        T   prv_residual = std::numeric_limits<T>::max();
+        int iter         = 0;
+
+        while (true) {
+            const bool refactor =
+                !m_factorized || m_lagged >= options.hessian_lag;
+
+            if (pre_eval) {
+                pre_eval(stream);
+            }
+
+            if (refactor) {
+                problem.eval_terms(stream);
+            } else {
+                problem.eval_terms_grad_only(stream);
+            }
+
+            if (post_eval) {
+                post_eval(stream);
+            }
+
+            newton.compute_direction(stream, refactor);
+
+            if (refactor) {
+                m_factorized = true;
+                m_lagged     = 0;
+                m_num_factorizations++;
+            } else {
+                m_lagged++;
+            }
+
+            const T residual = newton.dir.abs_max(stream) / h;
+
+            if (converged ? converged(residual) : residual <= options.tol) {
+                break;
+            }
+
+            if (iter >= options.max_newton_iter) {
+                RXMESH_WARN(
+                    "ImplicitIntegrator::step() Newton did not converge in {} "
+                    "iterations at time step {} (residual= {})",
+                    iter,
+                    m_num_steps,
+                    residual);
+                break;
+            }
+
+            // a lagged Hessian that does not reduce the residual is stale
+            if (!refactor && residual > prv_residual) {
+                m_factorized = false;
+            }
+            prv_residual = residual;
+
+            const T s_max = max_step ? max_step(stream) : T(1);
+
+            newton.line_search(
+                s_max, options.line_search_shrink, 64, T(1e-4), stream);
+
+            iter++;
+        }
+
+        // v = (x - x_n) / h
+        const T inv_h = T(1) / h;
+        problem.rx.template for_each<ObjHandleT>(
+            DEVICE,
+            [=] __device__(const ObjHandleT& oh) mutable {
+                for (int i = 0; i < VariableDim; ++i) {
+                    v(oh, i) = inv_h * (x(oh, i) - x_n(oh, i));
+                }
+            },
+            stream);
+
+        m_num_steps++;
+        m_num_newton_iter += iter;
+
+        return iter;
+    }
+
+    /**
+     * @brief the velocity v_n
+     */
+    AttributeT& get_velocity()
+    {
+        return m_velocity;
+    }
+
+    /**
+     * @brief the positions at the start of the current time step
+     */
+    AttributeT& get_x_n()
+    {
+        return *m_x_n;
+    }
+
+    /**
+     * @brief number of time steps taken so far
+     */
+    int num_steps() const
+    {
+        return m_num_steps;
+    }
+
+    /**
+     * @brief total number of Newton iterations in all time steps
+     */
+    int num_newton_iterations() const
+    {
+        return m_num_newton_iter;
+    }
+
+    /**
+     * @brief total number of Hessian evaluations and factorizations in all
+     * time steps
+     */
+    int num_factorizations() const
+    {
+        return m_num_factorizations;
+    }
+
+   private:
+    AttributeT                  m_velocity;
+    std::shared_ptr<AttributeT> m_x_n;
+    int                         m_num_steps;
+    int                         m_num_newton_iter;
+    int                         m_num_factorizations;
+    int                         m_lagged;
+    bool                        m_factorized;
+};
+
+}  // namespace rxmesh
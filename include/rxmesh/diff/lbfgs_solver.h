@@ -1,11 +1,206 @@
 #pragma once
 
+#include <cub/block/block_reduce.cuh>
+
 #include "rxmesh/diff/diff_scalar_problem.h"
 
 #include "rxmesh/diff/armijo_condition.h"
+#include "rxmesh/diff/batched_line_search.h"
 
 namespace rxmesh {
 
+namespace detail {
+
+/**
+ * @brief rho = 1 / (s^T.y) of one history entry. Returns 0 if the curvature
+ * condition does not hold such that the entry does not contribute
+ */
+template <typename T>
+__device__ __inline__ T lbfgs_rho(const T sy)
+{
+    return (sy > T(1e-10)) ? T(1) / sy : T(0);
+}
+
+/**
+ * @brief sum thread_val over the block and add it atomically to d_out
+ */
+template <uint32_t blockThreads, typename T>
+__device__ __inline__ void lbfgs_block_add(const T thread_val, T* d_out)
+{
+    using BlockReduce = cub::BlockReduce<T, blockThreads>;
+
+    __shared__ typename BlockReduce::TempStorage temp_storage;
+
+    T block_sum = BlockReduce(temp_storage).Sum(thread_val);
+
+    if (threadIdx.x == 0) {
+        ::atomicAdd(d_out, block_sum);
+    }
+    __syncthreads();
+}
+
+/**
+ * @brief start of the first loop of the two-loop recursion: q = -grad and
+ * accumulate alpha = rho * s^T.q of the newest history entry along with
+ * yy = y^T.y of the newest entry (used to scale the initial Hessian)
+ */
+template <uint32_t blockThreads, typename T>
+__global__ static void lbfgs_init_kernel(const int n,
+                                         const T*  grad,
+                                         T*        q,
+                                         const T*  s_cur,
+                                         const T*  y_cur,
+                                         const T*  sy_cur,
+                                         T*        alpha_cur,
+                                         T*        yy)
+{
+    const T rho = lbfgs_rho(*sy_cur);
+
+    T sq = 0;
+    T y2 = 0;
+    for (int i = threadIdx.x + blockThreads * blockIdx.x; i < n;
+         i += blockThreads * gridDim.x) {
+        const T qi = -grad[i];
+        q[i]       = qi;
+        sq += s_cur[i] * qi;
+        y2 += y_cur[i] * y_cur[i];
+    }
+
+    lbfgs_block_add<blockThreads>(rho * sq, alpha_cur);
+    lbfgs_block_add<blockThreads>(y2, yy);
+}
+
+/**
+ * @brief one step of the first loop: q = q - alpha_prev * y_prev (which needs
+ * the whole alpha_prev and so it is done here rather than in the previous
+ * kernel) and accumulate alpha_cur = rho * s_cur^T.q using the updated q
+ */
+template <uint32_t blockThreads, typename T>
+__global__ static void lbfgs_first_loop_kernel(const int n,
+                                               T*        q,
+                                               const T*  y_prev,
+                                               const T*  alpha_prev,
+                                               const T*  s_cur,
+                                               const T*  sy_cur,
+                                               T*        alpha_cur)
+{
+    const T a   = *alpha_prev;
+    const T rho = lbfgs_rho(*sy_cur);
+
+    T sq = 0;
+    for (int i = threadIdx.x + blockThreads * blockIdx.x; i < n;
+         i += blockThreads * gridDim.x) {
+        const T qi = q[i] - a * y_prev[i];
+        q[i]       = qi;
+        sq += s_cur[i] * qi;
+    }
+
+    lbfgs_block_add<blockThreads>(rho * sq, alpha_cur);
+}
+
+/**
+ * @brief end of the first loop and start of the second one: finish the last
+ * update of q, r = gamma * q where gamma = s^T.y / y^T.y of the newest entry,
+ * and accumulate beta_cur = rho * y_cur^T.r of the oldest entry
+ */
+template <uint32_t blockThreads, typename T>
+__global__ static void lbfgs_scale_kernel(const int n,
+                                          const T*  q,
+                                          const T*  y_prev,
+                                          const T*  alpha_prev,
+                                          const T*  sy_newest,
+                                          const T*  yy,
+                                          T*        r,
+                                          const T*  y_cur,
+                                          const T*  sy_cur,
+                                          T*        beta_cur)
+{
+    const T a = *alpha_prev;
+
+    const T sy    = (*sy_newest > T(1e-10)) ? *sy_newest : T(1);
+    const T gamma = (*yy > T(1e-10)) ? sy / *yy : T(1);
+
+    const T rho = lbfgs_rho(*sy_cur);
+
+    T yr = 0;
+    for (int i = threadIdx.x + blockThreads * blockIdx.x; i < n;
+         i += blockThreads * gridDim.x) {
+        const T ri = gamma * (q[i] - a * y_prev[i]);
+        r[i]       = ri;
+        yr += y_cur[i] * ri;
+    }
+
+    lbfgs_block_add<blockThreads>(rho * yr, beta_cur);
+}
+
+/**
+ * @brief one step of the second loop: r = r + (alpha_prev - beta_prev) *
+ * s_prev and accumulate beta_cur = rho * y_cur^T.r using the updated r. For
+ * the last step, y_cur is null and only the update is done
+ */
+template <uint32_t blockThreads, typename T>
+__global__ static void lbfgs_second_loop_kernel(const int n,
+                                                T*        r,
+                                                const T*  s_prev,
+                                                const T*  alpha_prev,
+                                                const T*  beta_prev,
+                                                const T*  y_cur,
+                                                const T*  sy_cur,
+                                                T*        beta_cur)
+{
+    const T c = *alpha_prev - *beta_prev;
+
+    if (y_cur == nullptr) {
+        for (int i = threadIdx.x + blockThreads * blockIdx.x; i < n;
+             i += blockThreads * gridDim.x) {
+            r[i] += c * s_prev[i];
+        }
+        return;
+    }
+
+    const T rho = lbfgs_rho(*sy_cur);
+
+    T yr = 0;
+    for (int i = threadIdx.x + blockThreads * blockIdx.x; i < n;
+         i += blockThreads * gridDim.x) {
+        const T ri = r[i] + c * s_prev[i];
+        r[i]       = ri;
+        yr += y_cur[i] * ri;
+    }
+
+    lbfgs_block_add<blockThreads>(rho * yr, beta_cur);
+}
+
+/**
+ * @brief y = grad_{k+1} - y where y holds grad_k and accumulate sy = s^T.y
+ */
+template <uint32_t blockThreads, typename T>
+__global__ static void lbfgs_history_kernel(const int n,
+                                            const T*  grad,
+                                            const T*  s,
+                                            T*        y,
+                                            T*        sy)
+{
+    T sum = 0;
+    for (int i = threadIdx.x + blockThreads * blockIdx.x; i < n;
+         i += blockThreads * gridDim.x) {
+        const T yi = grad[i] - y[i];
+        y[i]       = yi;
+        sum += s[i] * yi;
+    }
+
+    lbfgs_block_add<blockThreads>(sum, sy);
+}
+}  // namespace detail
+
+/**
+ * @brief L-BFGS solver. The history (s, y, and s^T.y) and the scalars of the
+ * two-loop recursion (alpha, beta, and y^T.y) stay on the device. Every
+ * kernel of the recursion finishes the vector update that depends on the
+ * scalar reduced by the previous kernel and reduces the scalar needed by the
+ * next one, so computing the direction takes 2 * history_size + 1 kernels
+ * and no host synchronization
+ */
 
 template <typename T, int VariableDim, typename ObjHandleT>
 struct LBFGSSolver
@@ -19,14 +214,22 @@ struct LBFGSSolver
     int                                       k;  // iteration count
     std::vector<DenseMatT>                    s_list;
     std::vector<DenseMatT>                    y_list;
-    std::vector<T>                            rho_list;
+    DenseMatrix<T>                            sy_list;
+    DenseMatrix<T>                            alpha_list;
+    DenseMatrix<T>                            beta_list;
+    DenseMatrix<T>                            yy;
     DenseMatT                                 dir, q, r;
     std::shared_ptr<Attribute<T, ObjHandleT>> temp_objective;
+    BatchedLineSearch<T, ObjHandleT>          batched_line_search;
 
     LBFGSSolver(DiffProblemT& p, int history_size)
         : problem(p),
           m(history_size),
           k(0),
+          sy_list(DenseMatrix<T>(history_size, 1, DEVICE)),
+          alpha_list(DenseMatrix<T>(history_size, 1, DEVICE)),
+          beta_list(DenseMatrix<T>(history_size, 1, DEVICE)),
+          yy(DenseMatrix<T>(1, 1, DEVICE)),
           dir(DenseMatT(p.rx, p.grad.rows(), p.grad.cols())),
           q(DenseMatT(p.rx, p.grad.rows(), p.grad.cols())),
           r(DenseMatT(p.rx, p.grad.rows(), p.grad.cols())),
@@ -40,7 +243,7 @@ struct LBFGSSolver
 
         s_list.resize(m);
         y_list.resize(m);
-        rho_list.resize(m, T(0));
+        sy_list.reset(0, DEVICE);
 
         for (int i = 0; i < m; ++i) {
             s_list[i] = DenseMatT(p.rx, p.grad.rows(), p.grad.cols());
@@ -53,48 +256,94 @@ struct LBFGSSolver
     inline void solve(cudaStream_t stream = NULL)
     {
         compute_direction(stream);
-        line_search(stream);
+        line_search(1.0, 0.8, 64, 1e-4, stream);
     }
 
     inline void compute_direction(cudaStream_t stream = NULL)
     {
-        q.copy_from(problem.grad, DEVICE, DEVICE, stream);  // q = grad
-        q.multiply(T(-1.f), stream);                        // q = -grad
+        constexpr uint32_t blockThreads = 256;
 
+        const int n = dir.rows() * dir.cols();
 
-        std::vector<T> alpha(m, T(0));
+        const int blocks = DIVIDE_UP(n, blockThreads);
 
-        for (int i = 1; i <= std::min(k, m); ++i) {
-            int idx    = (k - i) % m;
-            alpha[idx] = rho_list[idx] * s_list[idx].dot(q, false, stream);
-            q.axpy(y_list[idx], -alpha[idx], stream);  // q = -alpha * y + q
-        }
+        const int h = std::min(k, m);
 
-        if (k == 0) {
+        if (h == 0) {
             // Initial H0 = identity
-            r.copy_from(q, DEVICE, DEVICE, stream);
-        } else {
-            // scaled identity matrix
-            int last = (k - 1) % m;
-
-            T sy    = (rho_list[last] > 0) ? (1.0 / rho_list[last]) : T(1.0);
-            T yy    = y_list[last].dot(y_list[last], false, stream);
-            T gamma = (yy > 1e-10) ? sy / yy : 1.0;
+            dir.copy_from(problem.grad, DEVICE, DEVICE, stream);
+            dir.multiply(T(-1.f), stream);
+            return;
+        }
 
-            r.copy_from(q, DEVICE, DEVICE, stream);
-            r.multiply(gamma, stream);  // r = gamma * q
+        alpha_list.reset(0, DEVICE, stream);
+        beta_list.reset(0, DEVICE, stream);
+        yy.reset(0, DEVICE, stream);
+
+        T* d_alpha = alpha_list.data(DEVICE);
+        T* d_beta  = beta_list.data(DEVICE);
+        T* d_sy    = sy_list.data(DEVICE);
+
+        // first loop from the newest to the oldest entry
+        const int newest = (k - 1) % m;
+
+        detail::lbfgs_init_kernel<blockThreads>
+            <<<blocks, blockThreads, 0, stream>>>(n,
+                                                  problem.grad.data(DEVICE),
+                                                  q.data(DEVICE),
+                                                  s_list[newest].data(DEVICE),
+                                                  y_list[newest].data(DEVICE),
+                                                  d_sy + newest,
+                                                  d_alpha + newest,
+                                                  yy.data(DEVICE));
+
+        int prev = newest;
+        for (int i = 2; i <= h; ++i) {
+            int idx = (k - i) % m;
+            detail::lbfgs_first_loop_kernel<blockThreads>
+                <<<blocks, blockThreads, 0, stream>>>(n,
+                                                      q.data(DEVICE),
+                                                      y_list[prev].data(DEVICE),
+                                                      d_alpha + prev,
+                                                      s_list[idx].data(DEVICE),
+                                                      d_sy + idx,
+                                                      d_alpha + idx);
+            prev = idx;
         }
 
-        for (int i = 1; i <= std::min(k, m); ++i) {
-            int idx = (k - std::min(k, m) + i - 1) % m;
-            // beta = rho*y^T.r
-            T beta = rho_list[idx] * y_list[idx].dot(r, false, stream);
-            // r = (alpha-beta) * s + r
-            r.axpy(s_list[idx], alpha[idx] - beta, stream);
+        // scaled identity matrix and the second loop from the oldest to the
+        // newest entry (where the oldest entry is prev)
+        detail::lbfgs_scale_kernel<blockThreads>
+            <<<blocks, blockThreads, 0, stream>>>(n,
+                                                  q.data(DEVICE),
+                                                  y_list[prev].data(DEVICE),
+                                                  d_alpha + prev,
+                                                  d_sy + newest,
+                                                  yy.data(DEVICE),
+                                                  r.data(DEVICE),
+                                                  y_list[prev].data(DEVICE),
+                                                  d_sy + prev,
+                                                  d_beta + prev);
+
+        for (int i = 2; i <= h + 1; ++i) {
+            const bool last = (i == h + 1);
+
+            int idx = (k - h + i - 1) % m;
+
+            detail::lbfgs_second_loop_kernel<blockThreads>
+                <<<blocks, blockThreads, 0, stream>>>(
+                    n,
+                    r.data(DEVICE),
+                    s_list[prev].data(DEVICE),
+                    d_alpha + prev,
+                    d_beta + prev,
+                    last ? nullptr : y_list[idx].data(DEVICE),
+                    d_sy + idx,
+                    d_beta + idx);
+            prev = idx;
         }
 
         dir.copy_from(r, DEVICE, DEVICE, stream);
-        // dir.multiply(T(-1.f), stream);
     }
 
     inline void update_history(cudaStream_t stream = NULL)
@@ -102,11 +351,14 @@ struct LBFGSSolver
         // update history is called after temp_objective (x_{k+1}) is being
         // updated in line_search and before updating problem.objective (x_k)
 
+        constexpr uint32_t blockThreads = 256;
+
+        const int n = dir.rows() * dir.cols();
+
         int idx = k % m;
 
         // s_k = x_{k+1} - x_k
         // s_k = temp_objective - problem.objective
-        s_list[idx].reset(0, DEVICE);
         problem.rx.template for_each<ObjHandleT>(
             DEVICE,
             [s    = s_list[idx],
@@ -116,26 +368,26 @@ struct LBFGSSolver
                 for (int j = 0; j < s.cols(); ++j) {
                     s(h, j) = temp(h, j) - prev(h, j);
                 }
-            });
+            },
+            stream);
 
         // y_k = grad_k
         y_list[idx].copy_from(problem.grad, DEVICE, DEVICE, stream);
 
-        // y_k = -grad_k
-        y_list[idx].multiply(T(-1.f), stream);
-
         // update grad_{k+1}
         problem.eval_terms_grad_only(temp_objective.get(), stream);
 
-        // y_k = grad_{k+1} - grad_k
-        y_list[idx].axpy(problem.grad, T(1.0), stream);
-
-        T sy = s_list[idx].dot(y_list[idx], false, stream);
-        if (sy > 1e-10) {
-            rho_list[idx] = T(1) / sy;
-        } else {
-            rho_list[idx] = 0;
-        }
+        // y_k = grad_{k+1} - grad_k and sy = s_k^T.y_k
+        T* d_sy = sy_list.data(DEVICE) + idx;
+        CUDA_ERROR(cudaMemsetAsync(d_sy, 0, sizeof(T), stream));
+
+        detail::lbfgs_history_kernel<blockThreads>
+            <<<DIVIDE_UP(n, blockThreads), blockThreads, 0, stream>>>(
+                n,
+                problem.grad.data(DEVICE),
+                s_list[idx].data(DEVICE),
+                y_list[idx].data(DEVICE),
+                d_sy);
     }
 
     inline void line_search(const T      s_max        = 1.0,
@@ -158,6 +410,8 @@ struct LBFGSSolver
 
         const T current_f = problem.get_current_loss(stream);
 
+        // the direction and the gradient do not change during the line search
+        const T dir_dot_grad = dir.dot(problem.grad, false, stream);
 
         for (int i = 0; i < max_iters; ++i) {
             problem.rx.template for_each<ObjHandleT>(
@@ -169,13 +423,14 @@ struct LBFGSSolver
                     for (int j = 0; j < t_obj.get_num_attributes(); ++j) {
                         t_obj(h, j) = obj(h, j) + s * dir(h, j);
                     }
-                });
+                },
+                stream);
 
             problem.eval_terms_passive(temp_objective.get(), stream);
             T f_new = problem.get_current_loss(stream);
 
             if (armijo_condition(
-                    current_f, f_new, s, dir, problem.grad, armijo_const)) {
+                    current_f, f_new, s, dir_dot_grad, armijo_const)) {
                 update = true;
                 break;
             }
@@ -192,7 +447,53 @@ struct LBFGSSolver
                     for (int j = 0; j < t_obj.get_num_attributes(); ++j) {
                         obj(h, j) = t_obj(h, j);
                     }
-                });
+                },
+                stream);
+            ++k;
+        }
+    }
+
+    /**
+     * @brief same as line_search() (same step sizes and Armijo condition)
+     * but batch_size step sizes are evaluated at once and the accepted step
+     * is picked on the device (see BatchedLineSearch). This trades memory
+     * (batch_size copies of the objective) and possibly wasted trials for
+     * fewer host synchronizations
+     */
+    inline void line_search_batched(const T      s_max        = 1.0,
+                                    const T      shrink       = 0.8,
+                                    const int    max_iters    = 64,
+                                    const T      armijo_const = 1e-4,
+                                    const int    batch_size   = 4,
+                                    cudaStream_t stream       = NULL)
+    {
+        assert(s_max > 0.0);
+
+        const T current_f = problem.get_current_loss(stream);
+
+        const bool update = batched_line_search.run(problem,
+                                                    dir,
+                                                    *temp_objective,
+                                                    current_f,
+                                                    s_max,
+                                                    shrink,
+                                                    max_iters,
+                                                    armijo_const,
+                                                    false,
+                                                    batch_size,
+                                                    stream);
+
+        if (update) {
+            update_history(stream);
+            problem.rx.template for_each<ObjHandleT>(
+                DEVICE,
+                [t_obj = *temp_objective,
+                 obj   = *problem.objective] __device__(const ObjHandleT& h) {
+                    for (int j = 0; j < t_obj.get_num_attributes(); ++j) {
+                        obj(h, j) = t_obj(h, j);
+                    }
+                },
+                stream);
             ++k;
         }
     }
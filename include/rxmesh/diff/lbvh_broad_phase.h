@@ -0,0 +1,750 @@
+#pragma once
+
+#include <limits>
+
+#include <thrust/execution_policy.h>
+#include <thrust/reduce.h>
+#include <thrust/sequence.h>
+#include <thrust/sort.h>
+
+#include "rxmesh/attribute.h"
+#include "rxmesh/diff/candidate_pairs.h"
+#include "rxmesh/iterator.cuh"
+#include "rxmesh/kernels/util.cuh"
+#include "rxmesh/rxmesh_static.h"
+
+namespace rxmesh {
+
+namespace detail {
+
+/**
+ * @brief axis-aligned bounding box
+ */
+template <typename T>
+struct AABB
+{
+    T lo[3];
+    T hi[3];
+
+    __device__ __host__ static AABB empty()
+    {
+        AABB b;
+        for (int d = 0; d < 3; ++d) {
+            b.lo[d] = std::numeric_limits<T>::max();
+            b.hi[d] = std::numeric_limits<T>::lowest();
+        }
+        return b;
+    }
+
+    __device__ __host__ void expand(const T* p)
+    {
+        for (int d = 0; d < 3; ++d) {
+            lo[d] = (p[d] < lo[d]) ? p[d] : lo[d];
+            hi[d] = (p[d] > hi[d]) ? p[d] : hi[d];
+        }
+    }
+
+    __device__ __host__ void merge(const AABB& b)
+    {
+        expand(b.lo);
+        expand(b.hi);
+    }
+
+    __device__ __host__ void inflate(const T r)
+    {
+        for (int d = 0; d < 3; ++d) {
+            lo[d] -= r;
+            hi[d] += r;
+        }
+    }
+
+    __device__ __host__ bool overlaps(const AABB& b) const
+    {
+        for (int d = 0; d < 3; ++d) {
+            if (lo[d] > b.hi[d] || hi[d] < b.lo[d]) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+template <typename T>
+struct AABBUnion
+{
+    __device__ __host__ AABB<T> operator()(const AABB<T>& a,
+                                           const AABB<T>& b) const
+    {
+        AABB<T> ret = a;
+        ret.merge(b);
+        return ret;
+    }
+};
+
+/**
+ * @brief spread the lower 10 bits of v such that there are two zero bits
+ * between every two bits
+ */
+__device__ __host__ __inline__ uint32_t expand_bits(uint32_t v)
+{
+    v = (v * 0x00010001u) & 0xFF0000FFu;
+    v = (v * 0x00000101u) & 0x0F00F00Fu;
+    v = (v * 0x00000011u) & 0xC30C30C3u;
+    v = (v * 0x00000005u) & 0x49249249u;
+    return v;
+}
+
+/**
+ * @brief 30-bit Morton code of a point in the unit cube
+ */
+template <typename T>
+__device__ __host__ __inline__ uint32_t morton_code(const T* p)
+{
+    uint32_t code = 0;
+    for (int d = 0; d < 3; ++d) {
+        T s = p[d] * T(1024);
+        s   = (s < T(0)) ? T(0) : ((s > T(1023)) ? T(1023) : s);
+        code |= expand_bits(static_cast<uint32_t>(s)) << (2 - d);
+    }
+    return code;
+}
+
+/**
+ * @brief the length of the common prefix of the (sorted) Morton codes i and
+ * j where ties are broken by the index. Return -1 if j is out of range
+ */
+__device__ __inline__ int common_prefix(const uint32_t* d_codes,
+                                        const int       n,
+                                        const int       i,
+                                        const int       j)
+{
+    if (j < 0 || j >= n) {
+        return -1;
+    }
+    const uint64_t ki = (uint64_t(d_codes[i]) << 32) | uint32_t(i);
+    const uint64_t kj = (uint64_t(d_codes[j]) << 32) | uint32_t(j);
+    return __clzll(ki ^ kj);
+}
+}  // namespace detail
+
+/**
+ * @brief linear bounding volume hierarchy (LBVH) over the faces (FaceHandle)
+ * or edges (EdgeHandle) of the mesh. The primitives are sorted along their
+ * Morton codes and the hierarchy is built in parallel following Karras
+ * "Maximizing Parallelism in the Construction of BVHs, Octrees, and k-d
+ * Trees". The n-1 internal nodes are indexed by [0, n-1) with the root at 0
+ * and the n leaves are indexed by [n-1, 2n-1). The connectivity of the
+ * primitives is read once in the constructor. build() sorts the primitives
+ * and builds the hierarchy from the current vertex positions while refit()
+ * only updates the boxes bottom-up, keeping the hierarchy, which is cheaper
+ * but the boxes get looser if the primitives move a lot
+ */
+template <typename T, typename PrimHandleT>
+struct LBVH
+{
+    static_assert(std::is_same_v<PrimHandleT, FaceHandle> ||
+                      std::is_same_v<PrimHandleT, EdgeHandle>,
+                  "LBVH only supports FaceHandle and EdgeHandle primitives");
+
+    static constexpr Op op =
+        std::is_same_v<PrimHandleT, FaceHandle> ? Op::FV : Op::EV;
+
+    // number of vertices per primitive
+    static constexpr int NumV = (op == Op::FV) ? 3 : 2;
+
+    using AABBT     = detail::AABB<T>;
+    using IteratorT = StencilIterator<VertexHandle, NumV>;
+
+    // max depth of the traversal stack
+    static constexpr int StackSize = 64;
+
+    __device__ __host__ LBVH()
+        : m_num_prims(0),
+          m_inflate(0),
+          m_d_prim_handle(nullptr),
+          m_d_prim_vertices(nullptr),
+          m_d_sorted(nullptr),
+          m_d_codes(nullptr),
+          m_d_left(nullptr),
+          m_d_right(nullptr),
+          m_d_parent(nullptr),
+          m_d_flags(nullptr),
+          m_d_box(nullptr)
+    {
+    }
+
+    /**
+     * @brief allocate the hierarchy and store the vertices of every primitive
+     */
+    __host__ LBVH(const RXMeshStatic& rx) : LBVH()
+    {
+        m_num_prims = (op == Op::FV) ? rx.get_num_faces() : rx.get_num_edges();
+
+        const int n         = m_num_prims;
+        const int num_nodes = 2 * n - 1;
+
+        CUDA_ERROR(tracked_malloc((void**)&m_d_prim_handle,
+                                  n * sizeof(PrimHandleT),
+                                  MemoryCategory::Solver));
+        CUDA_ERROR(tracked_malloc((void**)&m_d_prim_vertices,
+                                  n * sizeof(IteratorT),
+                                  MemoryCategory::Solver));
+        CUDA_ERROR(tracked_malloc((void**)&m_d_sorted,
+                                  n * sizeof(int),
+                                  MemoryCategory::Solver));
+        CUDA_ERROR(tracked_malloc((void**)&m_d_codes,
+                                  n * sizeof(uint32_t),
+                                  MemoryCategory::Solver));
+        CUDA_ERROR(tracked_malloc((void**)&m_d_left,
+                                  num_nodes * sizeof(int),
+                                  MemoryCategory::Solver));
+        CUDA_ERROR(tracked_malloc((void**)&m_d_right,
+                                  num_nodes * sizeof(int),
+                                  MemoryCategory::Solver));
+        CUDA_ERROR(tracked_malloc((void**)&m_d_parent,
+                                  num_nodes * sizeof(int),
+                                  MemoryCategory::Solver));
+        CUDA_ERROR(tracked_malloc((void**)&m_d_flags,
+                                  num_nodes * sizeof(int),
+                                  MemoryCategory::Solver));
+        CUDA_ERROR(tracked_malloc((void**)&m_d_box,
+                                  num_nodes * sizeof(AABBT),
+                                  MemoryCategory::Solver));
+
+        init_primitives(rx);
+    }
+
+    /**
+     * @brief store the handle and the vertices of every primitive at its
+     * linear id
+     */
+    __host__ void init_primitives(const RXMeshStatic& rx)
+    {
+        const Context ctx             = rx.get_context();
+        PrimHandleT*  d_prim_handle   = m_d_prim_handle;
+        IteratorT*    d_prim_vertices = m_d_prim_vertices;
+
+        rx.run_query_kernel<op, 256>(
+            [=] __device__(const PrimHandleT&    ph,
+                           const VertexIterator& iter) mutable {
+                const uint32_t id = ctx.linear_id(ph);
+                d_prim_handle[id] = ph;
+                for (int i = 0; i < NumV; ++i) {
+                    d_prim_vertices[id][i] = iter[i];
+                }
+            });
+    }
+
+    /**
+     * @brief sort the primitives along their Morton codes and build the
+     * hierarchy from the vertex positions x where the box of every primitive
+     * is inflated by inflate
+     */
+    __host__ void build(const Attribute<T, VertexHandle>& x,
+                        const T                           inflate,
+                        cudaStream_t                      stream = NULL)
+    {
+        if (m_num_prims == 0) {
+            return;
+        }
+
+        m_inflate = inflate;
+
+        const int n = m_num_prims;
+
+        thrust::sequence(
+            thrust::cuda::par.on(stream), m_d_sorted, m_d_sorted + n);
+
+        compute_leaf_boxes(x, stream);
+
+        // the scene box to normalize the centroids
+        AABBT* d_leaf_box = m_d_box + (n - 1);
+
+        const AABBT scene = thrust::reduce(thrust::cuda::par.on(stream),
+                                           d_leaf_box,
+                                           d_leaf_box + n,
+                                           AABBT::empty(),
+                                           detail::AABBUnion<T>());
+
+        uint32_t* d_codes = m_d_codes;
+
+        for_each_item<<<DIVIDE_UP(n, 256), 256, 0, stream>>>(
+            n, [=] __device__(int k) {
+                T c[3];
+                for (int d = 0; d < 3; ++d) {
+                    const T ext = scene.hi[d] - scene.lo[d];
+                    const T mid =
+                        T(0.5) * (d_leaf_box[k].lo[d] + d_leaf_box[k].hi[d]);
+                    c[d] = (ext > T(0)) ? (mid - scene.lo[d]) / ext : T(0.5);
+                }
+                d_codes[k] = detail::morton_code(c);
+            });
+
+        thrust::sort_by_key(thrust::cuda::par.on(stream),
+                            m_d_codes,
+                            m_d_codes + n,
+                            m_d_sorted);
+
+        // the leaves in the sorted order
+        compute_leaf_boxes(x, stream);
+
+        build_internal_nodes(stream);
+
+        refit_internal_nodes(stream);
+    }
+
+    /**
+     * @brief update the boxes from the vertex positions x without changing
+     * the hierarchy. build() should be called at least once before
+     */
+    __host__ void refit(const Attribute<T, VertexHandle>& x,
+                        const T                           inflate,
+                        cudaStream_t                      stream = NULL)
+    {
+        if (m_num_prims == 0) {
+            return;
+        }
+        m_inflate = inflate;
+        compute_leaf_boxes(x, stream);
+        refit_internal_nodes(stream);
+    }
+
+    /**
+     * @brief call func(k) for every leaf k (in [0, num_prims())) whose box
+     * overlaps with the query box
+     */
+    template <typename FuncT>
+    __device__ void for_each_overlap(const AABBT& query, FuncT func) const
+    {
+        if (m_num_prims == 0) {
+            return;
+        }
+
+        const int num_internal = m_num_prims - 1;
+
+        int stack[StackSize];
+        int top = 0;
+
+        stack[top++] = 0;
+
+        while (top > 0) {
+            const int node = stack[--top];
+
+            if (!m_d_box[node].overlaps(query)) {
+                continue;
+            }
+
+            if (node >= num_internal) {
+                func(node - num_internal);
+            } else {
+                assert(top + 2 <= StackSize);
+                stack[top++] = m_d_left[node];
+                stack[top++] = m_d_right[node];
+            }
+        }
+    }
+
+    /**
+     * @brief the handle of the primitive stored in leaf k
+     */
+    __device__ PrimHandleT leaf_handle(const int k) const
+    {
+        return m_d_prim_handle[m_d_sorted[k]];
+    }
+
+    /**
+     * @brief the vertices of the primitive stored in leaf k
+     */
+    __device__ const IteratorT& leaf_vertices(const int k) const
+    {
+        return m_d_prim_vertices[m_d_sorted[k]];
+    }
+
+    /**
+     * @brief the (inflated) box of leaf k
+     */
+    __device__ const AABBT& leaf_box(const int k) const
+    {
+        return m_d_box[m_num_prims - 1 + k];
+    }
+
+    __device__ __host__ int num_prims() const
+    {
+        return m_num_prims;
+    }
+
+    __device__ __host__ T inflation() const
+    {
+        return m_inflate;
+    }
+
+    __host__ void release()
+    {
+        GPU_FREE(m_d_prim_handle);
+        GPU_FREE(m_d_prim_vertices);
+        GPU_FREE(m_d_sorted);
+        GPU_FREE(m_d_codes);
+        GPU_FREE(m_d_left);
+        GPU_FREE(m_d_right);
+        GPU_FREE(m_d_parent);
+        GPU_FREE(m_d_flags);
+        GPU_FREE(m_d_box);
+    }
+
+    /**
+     * @brief compute the box of every leaf where leaf k holds the primitive
+     * m_d_sorted[k]
+     */
+    __host__ void compute_leaf_boxes(const Attribute<T, VertexHandle>& x,
+                                     cudaStream_t                      stream)
+    {
+        const int        n               = m_num_prims;
+        const T          inflate         = m_inflate;
+        const int*       d_sorted        = m_d_sorted;
+        const IteratorT* d_prim_vertices = m_d_prim_vertices;
+        AABBT*           d_leaf_box      = m_d_box + (n - 1);
+
+        for_each_item<<<DIVIDE_UP(n, 256), 256, 0, stream>>>(
+            n, [=] __device__(int k) {
+                const IteratorT& iter = d_prim_vertices[d_sorted[k]];
+
+                AABBT box = AABBT::empty();
+                for (int i = 0; i < NumV; ++i) {
+                    const T p[3] = {
+                        x(iter[i], 0), x(iter[i], 1), x(iter[i], 2)};
+                    box.expand(p);
+                }
+                box.inflate(inflate);
+                d_leaf_box[k] = box;
+            });
+    }
+
+    /**
+     * @brief find the (two) children of every internal node from the sorted
+     * Morton codes (Karras 2012)
+     */
+    __host__ void build_internal_nodes(cudaStream_t stream)
+    {
+        const int       n        = m_num_prims;
+        const uint32_t* d_codes  = m_d_codes;
+        int*            d_left   = m_d_left;
+        int*            d_right  = m_d_right;
+        int*            d_parent = m_d_parent;
+
+        // the root has no parent
+        CUDA_ERROR(cudaMemsetAsync(d_parent, 0xFF, sizeof(int), stream));
+
+        if (n == 1) {
+            return;
+        }
+
+        for_each_item<<<DIVIDE_UP(n - 1, 256), 256, 0, stream>>>(
+            n - 1, [=] __device__(int i) {
+                using detail::common_prefix;
+
+                // the direction of the range of this node
+                const int d = (common_prefix(d_codes, n, i, i + 1) -
+                                   common_prefix(d_codes, n, i, i - 1) >
+                               0) ?
+                                  1 :
+                                  -1;
+
+                // an upper bound on the length of the range
+                const int delta_min = common_prefix(d_codes, n, i, i - d);
+
+                int l_max = 2;
+                while (common_prefix(d_codes, n, i, i + l_max * d) >
+                       delta_min) {
+                    l_max *= 2;
+                }
+
+                // the other end of the range with binary search
+                int l = 0;
+                for (int t = l_max / 2; t >= 1; t /= 2) {
+                    if (common_prefix(d_codes, n, i, i + (l + t) * d) >
+                        delta_min) {
+                        l += t;
+                    }
+                }
+                const int j = i + l * d;
+
+                // the split position with binary search
+                const int delta_node = common_prefix(d_codes, n, i, j);
+
+                int s = 0;
+                int t = l;
+                do {
+                    t = (t + 1) / 2;
+                    if (common_prefix(d_codes, n, i, i + (s + t) * d) >
+                        delta_node) {
+                        s += t;
+                    }
+                } while (t > 1);
+
+                const int gamma = i + s * d + ((d < 0) ? d : 0);
+
+                // leaves are offset by n-1
+                const int left =
+                    (((i < j) ? i : j) == gamma) ? gamma + n - 1 : gamma;
+                const int right = (((i > j) ? i : j) == gamma + 1) ?
+                                      gamma + 1 + n - 1 :
+                                      gamma + 1;
+
+                d_left[i]       = left;
+                d_right[i]      = right;
+                d_parent[left]  = i;
+                d_parent[right] = i;
+            });
+    }
+
+    /**
+     * @brief compute the boxes of the internal nodes bottom-up. Every leaf
+     * walks up the tree and the second child that reaches a node computes its
+     * box such that every node is processed once after both its children
+     */
+    __host__ void refit_internal_nodes(cudaStream_t stream)
+    {
+        const int n = m_num_prims;
+
+        if (n == 1) {
+            return;
+        }
+
+        CUDA_ERROR(
+            cudaMemsetAsync(m_d_flags, 0, (n - 1) * sizeof(int), stream));
+
+        const int* d_left   = m_d_left;
+        const int* d_right  = m_d_right;
+        const int* d_parent = m_d_parent;
+        int*       d_flags  = m_d_flags;
+        AABBT*     d_box    = m_d_box;
+
+        for_each_item<<<DIVIDE_UP(n, 256), 256, 0, stream>>>(
+            n, [=] __device__(int k) {
+                int node = d_parent[n - 1 + k];
+
+                while (node >= 0) {
+                    // make the box of the child visible before the sibling
+                    // could read it
+                    __threadfence();
+
+                    if (::atomicAdd(d_flags + node, 1) == 0) {
+                        // the other child is not ready yet
+                        return;
+                    }
+
+                    AABBT box = d_box[d_left[node]];
+                    box.merge(d_box[d_right[node]]);
+                    d_box[node] = box;
+
+                    node = d_parent[node];
+                }
+            });
+    }
+
+   protected:
+    int          m_num_prims;
+    T            m_inflate;
+    PrimHandleT* m_d_prim_handle;
+    IteratorT*   m_d_prim_vertices;
+    int*         m_d_sorted;
+    uint32_t*    m_d_codes;
+    int*         m_d_left;
+    int*         m_d_right;
+    int*         m_d_parent;
+    int*         m_d_flags;
+    AABBT*       m_d_box;
+};
+
+
+/**
+ * @brief broad phase for self-contact that finds all vertex-face and
+ * edge-edge pairs whose bounding boxes are within a distance dhat using an
+ * LBVH over the faces and another one over the edges. Pairs that share a
+ * vertex (e.g., a face and its own vertex) are skipped and every edge-edge
+ * pair is reported once. The pairs are written into the (pre-allocated)
+ * CandidatePairsVF/CandidatePairsEE with their stencil vertices so they can
+ * be used directly by DiffScalarProblem::add_pair_term(). update() should be
+ * called every step (or Newton iteration) before finding the pairs
+ */
+template <typename T>
+struct LBVHBroadPhase
+{
+    LBVHBroadPhase() : m_dhat(0), m_d_overflow(nullptr)
+    {
+    }
+
+    LBVHBroadPhase(const RXMeshStatic& rx)
+        : m_face_bvh(rx), m_edge_bvh(rx), m_dhat(0), m_d_overflow(nullptr)
+    {
+        CUDA_ERROR(tracked_malloc((void**)&m_d_overflow,
+                                  sizeof(int),
+                                  MemoryCategory::Solver));
+    }
+
+    /**
+     * @brief rebuild (i.e., re-sort) or refit the hierarchies to the vertex
+     * positions x. Rebuilding is needed at least once and whenever the
+     * primitives moved a lot since the last build
+     */
+    void update(const Attribute<T, VertexHandle>& x,
+                const T                           dhat,
+                const bool                        rebuild = true,
+                cudaStream_t                      stream  = NULL)
+    {
+        m_dhat = dhat;
+
+        // inflating both sides by dhat/2 so that two boxes overlap if they are
+        // within dhat
+        if (rebuild) {
+            m_face_bvh.build(x, T(0.5) * dhat, stream);
+            m_edge_bvh.build(x, T(0.5) * dhat, stream);
+        } else {
+            m_face_bvh.refit(x, T(0.5) * dhat, stream);
+            m_edge_bvh.refit(x, T(0.5) * dhat, stream);
+        }
+    }
+
+    /**
+     * @brief reset pairs and fill it with all vertex-face pairs where the
+     * vertex is within dhat of the face box (and not a vertex of the face).
+     * Return the number of pairs that did not fit in the pairs capacity
+     */
+    int find_vf_pairs(const RXMeshStatic&               rx,
+                      const Attribute<T, VertexHandle>& x,
+                      CandidatePairsVF&                 pairs,
+                      cudaStream_t                      stream = NULL)
+    {
+        pairs.reset();
+        CUDA_ERROR(cudaMemsetAsync(m_d_overflow, 0, sizeof(int), stream));
+
+        const LBVH<T, FaceHandle> bvh        = m_face_bvh;
+        const T                   inflate    = T(0.5) * m_dhat;
+        int*                      d_overflow = m_d_overflow;
+
+        rx.for_each_vertex(
+            DEVICE,
+            [=] __device__(const VertexHandle& vh) mutable {
+                const T p[3] = {x(vh, 0), x(vh, 1), x(vh, 2)};
+
+                detail::AABB<T> query = detail::AABB<T>::empty();
+                query.expand(p);
+                query.inflate(inflate);
+
+                bvh.for_each_overlap(query, [&](int k) {
+                    const auto& fv = bvh.leaf_vertices(k);
+
+                    if (fv[0] == vh || fv[1] == vh || fv[2] == vh) {
+                        return;
+                    }
+
+                    CandidatePairsVF::IteratorT stencil;
+                    stencil[0] = vh;
+                    stencil[1] = fv[0];
+                    stencil[2] = fv[1];
+                    stencil[3] = fv[2];
+
+                    if (!pairs.insert(vh, bvh.leaf_handle(k), stencil)) {
+                        ::atomicAdd(d_overflow, 1);
+                    }
+                });
+            },
+            stream);
+
+        return read_overflow(stream);
+    }
+
+    /**
+     * @brief reset pairs and fill it with all edge-edge pairs whose boxes are
+     * within dhat (and do not share a vertex). Return the number of pairs
+     * that did not fit in the pairs capacity
+     */
+    int find_ee_pairs(CandidatePairsEE& pairs, cudaStream_t stream = NULL)
+    {
+        pairs.reset();
+        CUDA_ERROR(cudaMemsetAsync(m_d_overflow, 0, sizeof(int), stream));
+
+        const LBVH<T, EdgeHandle> bvh        = m_edge_bvh;
+        int*                      d_overflow = m_d_overflow;
+
+        const int n = bvh.num_prims();
+
+        if (n > 0) {
+            for_each_item<<<DIVIDE_UP(n, 256), 256, 0, stream>>>(
+                n, [=] __device__(int k) mutable {
+                    const auto& ev0 = bvh.leaf_vertices(k);
+
+                    bvh.for_each_overlap(bvh.leaf_box(k), [&](int k1) {
+                        // report every pair once
+                        if (k1 <= k) {
+                            return;
+                        }
+
+                        const auto& ev1 = bvh.leaf_vertices(k1);
+
+                        if (ev0[0] == ev1[0] || ev0[0] == ev1[1] ||
+                            ev0[1] == ev1[0] || ev0[1] == ev1[1]) {
+                            return;
+                        }
+
+                        CandidatePairsEE::IteratorT stencil;
+                        stencil[0] = ev0[0];
+                        stencil[1] = ev0[1];
+                        stencil[2] = ev1[0];
+                        stencil[3] = ev1[1];
+
+                        if (!pairs.insert(bvh.leaf_handle(k),
+                                          bvh.leaf_handle(k1),
+                                          stencil)) {
+                            ::atomicAdd(d_overflow, 1);
+                        }
+                    });
+                });
+        }
+
+        return read_overflow(stream);
+    }
+
+    const LBVH<T, FaceHandle>& face_bvh() const
+    {
+        return m_face_bvh;
+    }
+
+    const LBVH<T, EdgeHandle>& edge_bvh() const
+    {
+        return m_edge_bvh;
+    }
+
+    void release()
+    {
+        m_face_bvh.release();
+        m_edge_bvh.release();
+        GPU_FREE(m_d_overflow);
+    }
+
+   protected:
+    int read_overflow(cudaStream_t stream)
+    {
+        int h_overflow = 0;
+        CUDA_ERROR(cudaMemcpyAsync(&h_overflow,
+                                   m_d_overflow,
+                                   sizeof(int),
+                                   cudaMemcpyDeviceToHost,
+                                   stream));
+        CUDA_ERROR(cudaStreamSynchronize(stream));
+        if (h_overflow > 0) {
+            RXMESH_WARN(
+                "LBVHBroadPhase: {} pairs could not be inserted because the "
+                "capacity of the candidate pairs is exceeded",
+                h_overflow);
+        }
+        return h_overflow;
+    }
+
+    LBVH<T, FaceHandle> m_face_bvh;
+    LBVH<T, EdgeHandle> m_edge_bvh;
+    T                   m_dhat;
+    int*                m_d_overflow;
+};
+
+}  // namespace rxmesh
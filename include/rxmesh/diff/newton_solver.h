@@ -1,13 +1,17 @@
 #pragma once
 
+#include <functional>
+
 #include "rxmesh/diff/diff_scalar_problem.h"
 
 #include "rxmesh/diff/armijo_condition.h"
+#include "rxmesh/diff/batched_line_search.h"
 
 #include "rxmesh/matrix/cg_mat_free_solver.h"
 #include "rxmesh/matrix/cg_solver.h"
 #include "rxmesh/matrix/cholesky_solver.h"
 #include "rxmesh/matrix/lu_solver.h"
+#include "rxmesh/matrix/mixed_precision_solver.h"
 #include "rxmesh/matrix/pcg_solver.h"
 #include "rxmesh/matrix/qr_solver.h"
 
@@ -24,8 +28,14 @@ struct NetwtonSolver
     DiffProblemT&                             problem;
     DenseMatT                                 dir;
     std::shared_ptr<Attribute<T, ObjHandleT>> temp_objective;
+    BatchedLineSearch<T, ObjHandleT>          batched_line_search;
     SolverT*                                  solver;
 
+    // optional hook that returns the max feasible step in (0, s_max] along
+    // the direction (e.g., CCDStepFilter::max_step()). If set, the line
+    // search starts from this step instead of s_max
+    std::function<T(const DenseMatT&, T, cudaStream_t)> max_step_filter;
+
     float solve_time;
 
     /**
@@ -57,13 +67,17 @@ struct NetwtonSolver
     inline void solve(cudaStream_t stream = NULL)
     {
         compute_direction(stream);
-        line_search(stream);
+        line_search(1.0, 0.8, 64, 1e-4, stream);
     }
 
     /**
-     * @brief solve to get Newton direction
+     * @brief solve to get Newton direction. With a direct solver, refactor =
+     * false solves with the factorization of the last call instead of
+     * factorizing the current Hessian (i.e., a lagged Hessian) which is only
+     * valid if the Hessian has been factorized before
      */
-    inline void compute_direction(cudaStream_t stream = NULL)
+    inline void compute_direction(cudaStream_t stream   = NULL,
+                                  const bool   refactor = true)
     {
         problem.grad.multiply(T(-1.f), stream);
 
@@ -72,35 +86,45 @@ struct NetwtonSolver
         if constexpr (std::is_base_of_v<LUSolver<HessMatT, DenseMatT::OrderT>,
                                         SolverT>) {
             problem.grad.move(DEVICE, HOST, stream);
-            problem.hess->move(DEVICE, HOST, stream);
+            if (refactor) {
+                problem.hess->move(DEVICE, HOST, stream);
+            }
 
             CPUTimer timer;
             timer.start();
 
-            solver->pre_solve(problem.rx);
-            solver->solve(problem.grad, dir);
+            if (refactor) {
+                solver->pre_solve(problem.rx);
+            }
+            solver->solve(problem.grad, dir, stream);
             timer.stop();
 
             solve_time += timer.elapsed_millis();
 
 
-            dir.move(HOST, DEVICE);
+            dir.move(HOST, DEVICE, stream);
         }
 
-        // Cholesky or QR
+        // Cholesky, QR, or mixed-precision Cholesky
         if constexpr (std::is_base_of_v<
                           CholeskySolver<HessMatT, DenseMatT::OrderT>,
                           SolverT> ||
                       std::is_base_of_v<QRSolver<HessMatT, DenseMatT::OrderT>,
-                                        SolverT>) {
+                                        SolverT> ||
+                      std::is_base_of_v<
+                          MixedPrecisionCholeskySolver<HessMatT,
+                                                       DenseMatT::OrderT>,
+                          SolverT>) {
 
             GPUTimer timer;
             timer.start();
 
             // solver->solve_hl_api(problem.grad, dir);
 
-            solver->pre_solve(problem.rx);
-            solver->solve(problem.grad, dir);
+            if (refactor) {
+                solver->pre_solve(problem.rx);
+            }
+            solver->solve(problem.grad, dir, stream);
 
             timer.stop();
             solve_time += timer.elapsed_millis();
@@ -119,8 +143,18 @@ struct NetwtonSolver
             problem.grad.reshape(r * c, 1);
             dir.reshape(r * c, 1);
 
-            solver->pre_solve(problem.grad, dir);
-            solver->solve(problem.grad, dir);
+            // element-by-element mode: evaluate the local Hessians once and
+            // reuse them in every matvec of the solve
+            if constexpr (std::is_base_of_v<
+                              CGMatFreeSolver<T, DenseMatT::OrderT>,
+                              SolverT>) {
+                if (problem.is_hessian_cache_enabled()) {
+                    problem.eval_hessian_cache(stream);
+                }
+            }
+
+            solver->pre_solve(problem.grad, dir, stream);
+            solver->solve(problem.grad, dir, stream);
 
             timer.stop();
             solve_time += timer.elapsed_millis();
@@ -159,14 +193,22 @@ struct NetwtonSolver
 
         assert(s_max > 0.0);
 
-        const bool try_one = s_max > 1.0;
+        T s_start = s_max;
+        if (!filter_step(s_start, stream)) {
+            return;
+        }
+
+        const bool try_one = s_start > 1.0;
 
-        T s = s_max;
+        T s = s_start;
 
         bool update = false;
 
         const T current_f = problem.get_current_loss(stream);
 
+        // the direction and the gradient do not change during the line search
+        const T dir_dot_grad = dir.dot(problem.grad, false, stream);
+
         for (int i = 0; i < max_iters; ++i) {
 
             // update solution
@@ -179,7 +221,8 @@ struct NetwtonSolver
                     for (int j = 0; j < t_obj.get_num_attributes(); ++j) {
                         t_obj(h, j) = obj(h, j) + s * dir(h, j);
                     }
-                });
+                },
+                stream);
 
 
             // eval new obj func
@@ -189,7 +232,7 @@ struct NetwtonSolver
             T f_new = problem.get_current_loss(stream);
 
             if (armijo_condition(
-                    current_f, f_new, s, dir, problem.grad, armijo_const)) {
+                    current_f, f_new, s, dir_dot_grad, armijo_const)) {
                 update = true;
                 break;
             }
@@ -209,11 +252,82 @@ struct NetwtonSolver
                     for (int j = 0; j < t_obj.get_num_attributes(); ++j) {
                         obj(h, j) = t_obj(h, j);
                     }
-                });
+                },
+                stream);
+        }
+    }
+
+    /**
+     * @brief same as line_search() (same step sizes and Armijo condition)
+     * but batch_size step sizes are evaluated at once and the accepted step
+     * is picked on the device (see BatchedLineSearch). This trades memory
+     * (batch_size copies of the objective) and possibly wasted trials for
+     * fewer host synchronizations
+     */
+    inline void line_search_batched(const T      s_max        = 1.0,
+                                    const T      shrink       = 0.8,
+                                    const int    max_iters    = 64,
+                                    const T      armijo_const = 1e-4,
+                                    const int    batch_size   = 4,
+                                    cudaStream_t stream       = NULL)
+    {
+        assert(s_max > 0.0);
+
+        T s_start = s_max;
+        if (!filter_step(s_start, stream)) {
+            return;
+        }
+
+        const T current_f = problem.get_current_loss(stream);
+
+        const bool update = batched_line_search.run(problem,
+                                                    dir,
+                                                    *temp_objective,
+                                                    current_f,
+                                                    s_start,
+                                                    shrink,
+                                                    max_iters,
+                                                    armijo_const,
+                                                    s_start > 1.0,
+                                                    batch_size,
+                                                    stream);
+
+        if (update) {
+            problem.rx.template for_each<ObjHandleT>(
+                DEVICE,
+                [t_obj = *temp_objective,
+                 obj   = *problem.objective] __device__(const ObjHandleT& h) {
+                    for (int j = 0; j < t_obj.get_num_attributes(); ++j) {
+                        obj(h, j) = t_obj(h, j);
+                    }
+                },
+                stream);
         }
     }
 
 
+    /**
+     * @brief clamp the initial step s of the line search with the max step
+     * hook (if set). Return false if there is no feasible step, i.e., the
+     * objective should not move along the current direction
+     */
+    inline bool filter_step(T& s, cudaStream_t stream = NULL)
+    {
+        if (!max_step_filter) {
+            return true;
+        }
+
+        s = std::min(s, max_step_filter(dir, s, stream));
+
+        if (s <= T(0)) {
+            RXMESH_WARN(
+                "NetwtonSolver::filter_step() the max step hook returned no "
+                "feasible step along the current direction.");
+            return false;
+        }
+        return true;
+    }
+
     /**
      * @brief apply boundary condition on the system by doing the following to
      *  the elements corresponding to the boundary
@@ -222,9 +336,11 @@ struct NetwtonSolver
      * 3) zeroing out the gradient
      * @param bc is an attribute storing 1/true for boundary condition and
      * 0/false otherwise.
+     * @param stream the stream to run the kernel on
      */
     template <typename bcT>
-    inline void apply_bc(Attribute<bcT, ObjHandleT>& bc)
+    inline void apply_bc(Attribute<bcT, ObjHandleT>& bc,
+                         cudaStream_t                stream = NULL)
     {
         auto g   = problem.grad;
         auto H   = *problem.hess;
@@ -270,7 +386,8 @@ struct NetwtonSolver
                         g(h, i) = 0;
                     }
                 }
-            });
+            },
+            stream);
     }
 };
 
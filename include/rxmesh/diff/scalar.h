@@ -61,6 +61,40 @@ struct Scalar
     HessType m_hess;
     //alignas(16) std::byte m_map_hess[sizeof(HessMapType)];
 
+   public:
+    // the min (static) number of variables for which the Hessian of the
+    // binary products/quotients and the chain rule is evaluated on its upper
+    // triangle only and then mirrored (see set_symmetric_hess()). The Hessian
+    // of every operation is symmetric (given symmetric inputs) but for small
+    // number of variables, exploiting the symmetry did not yield a speedup
+    // since the full (unrolled) expression is cheap. For larger number of
+    // variables (e.g., Op::VV terms), this halves the number of products and
+    // reduces the register pressure of the outer products
+    static constexpr int k_symmetric_hess = 12;
+
+    static constexpr bool use_symmetric_hess =
+        WithHessian && k != Eigen::Dynamic && k >= k_symmetric_hess;
+
+   private:
+    /**
+     * @brief H(i, j) = H(j, i) = f(i, j) for i <= j
+     */
+    template <typename FuncT>
+    __host__ __device__ __forceinline__ static void set_symmetric_hess(
+        HessType& H,
+        FuncT     f)
+    {
+        for (int i = 0; i < k; ++i) {
+            H(i, i) = f(i, i);
+            for (int j = i + 1; j < k; ++j) {
+                const PassiveT h = f(i, j);
+
+                H(i, j) = h;
+                H(j, i) = h;
+            }
+        }
+    }
+
    public:
     // ///////////////////////////////////////////////////////////////////////
     // Accessors
@@ -337,9 +371,15 @@ struct Scalar
         res.val()  = val;
         res.grad() = grad_ * a.grad();
 
-        if constexpr (WithHessian)
+        if constexpr (use_symmetric_hess) {
+            set_symmetric_hess(res.hess(), [&](int i, int j) {
+                return hess_ * a.grad()[i] * a.grad()[j] +
+                       grad_ * a.hess()(i, j);
+            });
+        } else if constexpr (WithHessian) {
             res.hess() =
                 hess_ * a.grad() * a.grad().transpose() + grad_ * a.hess();
+        }
 
         assert(is_finite_scalar(res));
         return res;
@@ -374,9 +414,15 @@ struct Scalar
         res.val()  = a.val() * a.val();
         res.grad() = 2.0 * a.val() * a.grad();
 
-        if constexpr (WithHessian)
+        if constexpr (use_symmetric_hess) {
+            set_symmetric_hess(res.hess(), [&](int i, int j) {
+                return PassiveT(2.0) * (a.val() * a.hess()(i, j) +
+                                        a.grad()[i] * a.grad()[j]);
+            });
+        } else if constexpr (WithHessian) {
             res.hess() =
                 2.0 * (a.val() * a.hess() + a.grad() * a.grad().transpose());
+        }
 
         assert(is_finite_scalar(res));
         return res;
@@ -776,25 +822,17 @@ struct Scalar
         res.val()  = a.val() * b.val();
         res.grad() = b.val() * a.grad() + a.val() * b.grad();
 
-        // Exploiting symmetry did not yield speedup in some tests
-        //        if constexpr (WithHessian)
-        //        {
-        //            for(Eigen::Index j = 0; j < k; ++j)
-        //            {
-        //                for(Eigen::Index i = j; i < k; ++i)
-        //                {
-        //                    res.Hess(i, j) = b.val * a.Hess(i, j) + a.grad[i]
-        //                    * b.grad[j] + a.grad[j] * b.grad[i] + a.val *
-        //                    b.Hess(i, j);
-        //                }
-        //            }
-        //            res.Hess = res.Hess.template
-        //            selfadjointView<Eigen::Lower>();
-        //        }
-
-        if constexpr (WithHessian)
+        // Exploiting symmetry did not yield speedup in some tests with small
+        // number of variables (see k_symmetric_hess)
+        if constexpr (use_symmetric_hess) {
+            set_symmetric_hess(res.hess(), [&](int i, int j) {
+                return b.val() * a.hess()(i, j) + a.grad()[i] * b.grad()[j] +
+                       b.grad()[i] * a.grad()[j] + a.val() * b.hess()(i, j);
+            });
+        } else if constexpr (WithHessian) {
             res.hess() = b.val() * a.hess() + a.grad() * b.grad().transpose() +
                          b.grad() * a.grad().transpose() + a.val() * b.hess();
+        }
 
         assert(is_finite_scalar(res));
         return res;
@@ -860,11 +898,19 @@ struct Scalar
         res.grad() =
             (b.val() * a.grad() - a.val() * b.grad()) / (b.val() * b.val());
 
-        if constexpr (WithHessian)
+        if constexpr (use_symmetric_hess) {
+            set_symmetric_hess(res.hess(), [&](int i, int j) {
+                return (a.hess()(i, j) - res.grad()[i] * b.grad()[j] -
+                        b.grad()[i] * res.grad()[j] -
+                        res.val() * b.hess()(i, j)) /
+                       b.val();
+            });
+        } else if constexpr (WithHessian) {
             res.hess() =
                 (a.hess() - res.grad() * b.grad().transpose() -
                  b.grad() * res.grad().transpose() - res.val() * b.hess()) /
                 b.val();
+        }
 
         assert(is_finite_scalar(res));
         return res;
@@ -897,11 +943,19 @@ struct Scalar
         res.val()  = a / b.val();
         res.grad() = (-a / (b.val() * b.val())) * b.grad();
 
-        if constexpr (WithHessian)
+        if constexpr (use_symmetric_hess) {
+            set_symmetric_hess(res.hess(), [&](int i, int j) {
+                return (-res.grad()[i] * b.grad()[j] -
+                        b.grad()[i] * res.grad()[j] -
+                        res.val() * b.hess()(i, j)) /
+                       b.val();
+            });
+        } else if constexpr (WithHessian) {
             res.hess() =
                 (-res.grad() * b.grad().transpose() -
                  b.grad() * res.grad().transpose() - res.val() * b.hess()) /
                 b.val();
+        }
 
         assert(is_finite_scalar(res));
         return res;
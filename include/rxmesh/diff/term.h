@@ -5,6 +5,7 @@
 #include "rxmesh/rxmesh_static.h"
 
 #include "rxmesh/attribute.h"
+#include "rxmesh/memory_report.h"
 #include "rxmesh/reduce_handle.h"
 
 #include "rxmesh/diff/diff_query_kernel.cuh"
@@ -14,6 +15,94 @@
 
 namespace rxmesh {
 
+/**
+ * @brief sum of several energy terms that are defined on the same query
+ * operation (see DiffScalarProblem::add_fused_term()). Calling it evaluates
+ * every term on the same element (with the same arguments) and returns the sum
+ * of their energies such that the terms share one kernel, one query, and one
+ * scatter of the gradient and Hessian
+ */
+template <typename LambdaT, typename... RestT>
+struct FusedTerms
+{
+    FusedTerms(LambdaT f, RestT... r) : first(f), rest(r...)
+    {
+    }
+
+    template <typename... ArgsT>
+    __device__ __inline__ auto operator()(ArgsT&... args)
+    {
+        return first(args...) + rest(args...);
+    }
+
+    LambdaT              first;
+    FusedTerms<RestT...> rest;
+};
+
+template <typename LambdaT>
+struct FusedTerms<LambdaT>
+{
+    FusedTerms(LambdaT f) : first(f)
+    {
+    }
+
+    template <typename... ArgsT>
+    __device__ __inline__ auto operator()(ArgsT&... args)
+    {
+        return first(args...);
+    }
+
+    LambdaT first;
+};
+
+/**
+ * @brief resource usage of the kernel that evaluates an energy term with its
+ * derivatives (see DiffScalarProblem::get_term_reports()). Every intermediate
+ * value in the energy term is an (active) Scalar that carries its gradient and
+ * Hessian and so large Scalars quickly run out of registers and spill to local
+ * memory
+ */
+struct TermReport
+{
+    LaunchReport launch;
+
+    // number of active variables of the term (-1 if dynamic)
+    int num_variables = 0;
+
+    // size of one Scalar, i.e., its value, gradient, and Hessian, in bytes
+    size_t scalar_bytes = 0;
+
+    bool spills() const
+    {
+        return launch.local_mem_per_thread > 0;
+    }
+
+    void print(const std::string& name) const
+    {
+        RXMESH_INFO(
+            "Term {}: {} variables, {} bytes/Scalar, {} registers/thread, {} "
+            "local mem/thread (bytes), {} blocks/SM, occupancy = {}% limited "
+            "by {}",
+            name,
+            num_variables,
+            scalar_bytes,
+            launch.num_registers_per_thread,
+            launch.local_mem_per_thread,
+            launch.blocks_per_sm,
+            100.0 * launch.occupancy,
+            launch.limiter);
+
+        if (spills()) {
+            RXMESH_WARN(
+                "Term {} spills {} bytes/thread to local memory. Consider "
+                "splitting the term, using fewer variables per term, or "
+                "evaluating the gradient only",
+                name,
+                launch.local_mem_per_thread);
+        }
+    }
+};
+
 /**
  * @brief pure virtual class used as interface for all energy terms (without
  * specifying the which type of mesh elements it is specified on, number of
@@ -37,7 +126,24 @@ struct Term
         DenseMatrix<T, Eigen::RowMajor>&       output,
         cudaStream_t                           stream) = 0;
 
+    virtual void eval_hessian_cache(Attribute<T, ObjHandleT>& obj,
+                                    bool                      fp32,
+                                    cudaStream_t              stream) = 0;
+
+    virtual void eval_cached_matvec(
+        const DenseMatrix<T, Eigen::RowMajor>& input,
+        DenseMatrix<T, Eigen::RowMajor>&       output,
+        cudaStream_t                           stream) = 0;
+
+    virtual void release_hessian_cache() = 0;
+
     virtual T get_loss(cudaStream_t stream) = 0;
+
+    virtual void get_loss_async(T* d_output, cudaStream_t stream) = 0;
+
+    virtual TermReport get_report() = 0;
+
+    virtual void set_hess_projection(PSDProjection method) = 0;
 };
 
 /**
@@ -67,7 +173,16 @@ struct TemplatedTerm : public Term<typename ScalarT::PassiveType, ObjHandleT>
                   bool                                 oreinted,
                   DenseMatrix<T, Eigen::RowMajor>&     grad,
                   HessianSparseMatrix<T, VariableDim>& hess)
-        : term(t), rx(rx), grad(grad), hess(hess), oreinted(oreinted)
+        : term(t),
+          rx(rx),
+          grad(grad),
+          hess(hess),
+          oreinted(oreinted),
+          d_hess_cache(nullptr),
+          d_hess_cache_fp32(nullptr),
+          d_hess_cache_ids(nullptr),
+          hess_cache_fp32(false),
+          hess_projection(PSDProjection::Clamp)
     {
         // To avoid the clash that happens from adding many losses.
         std::ostringstream address;
@@ -154,6 +269,7 @@ struct TemplatedTerm : public Term<typename ScalarT::PassiveType, ObjHandleT>
                       *loss,
                       obj,
                       oreinted,
+                      hess_projection,
                       term);
     }
 
@@ -180,6 +296,7 @@ struct TemplatedTerm : public Term<typename ScalarT::PassiveType, ObjHandleT>
                       *loss,
                       obj,
                       oreinted,
+                      hess_projection,
                       term);
     }
 
@@ -222,9 +339,133 @@ struct TemplatedTerm : public Term<typename ScalarT::PassiveType, ObjHandleT>
                       output,
                       obj,
                       oreinted,
+                      hess_projection,
                       term);
     }
 
+    /**
+     * @brief evaluate and store the (projected) local Hessian of every element
+     * of this term at the current objective so that eval_cached_matvec() can
+     * do Hessian-vector products without re-differentiating the energy. If
+     * fp32 is true, the local Hessians are stored in single precision
+     */
+    void eval_hessian_cache(Attribute<T, ObjHandleT>& obj,
+                            bool                      fp32,
+                            cudaStream_t              stream)
+    {
+        if constexpr (!ScalarT::WithHessian_ || ScalarT::k_ <= 0) {
+            RXMESH_ERROR(
+                "TemplatedTerm::eval_hessian_cache() requires a static Scalar "
+                "type with Hessians. Returning without evaluation.");
+            return;
+        } else {
+            constexpr int N = ScalarT::k_;
+
+            const size_t num_elements = rx.get_num_elements<LossHandleT>();
+
+            if (fp32 != hess_cache_fp32) {
+                release_hessian_cache();
+            }
+            hess_cache_fp32 = fp32;
+
+            const size_t ids_bytes =
+                num_elements * (N / VariableDim) * sizeof(int);
+
+            if (d_hess_cache_ids == nullptr) {
+                CUDA_ERROR(tracked_malloc((void**)&d_hess_cache_ids,
+                                          ids_bytes,
+                                          MemoryCategory::Solver));
+                if (fp32) {
+                    CUDA_ERROR(
+                        tracked_malloc((void**)&d_hess_cache_fp32,
+                                       num_elements * N * N * sizeof(float),
+                                       MemoryCategory::Solver));
+                } else {
+                    CUDA_ERROR(tracked_malloc((void**)&d_hess_cache,
+                                              num_elements * N * N * sizeof(T),
+                                              MemoryCategory::Solver));
+                }
+            }
+
+            CUDA_ERROR(
+                cudaMemsetAsync(d_hess_cache_ids, 0xFF, ids_bytes, stream));
+
+            if (fp32) {
+                launch_hessian_cache(d_hess_cache_fp32, obj, stream);
+            } else {
+                launch_hessian_cache(d_hess_cache, obj, stream);
+            }
+        }
+    }
+
+    /**
+     * @brief Hessian-vector product using the local Hessians stored by the
+     * last call to eval_hessian_cache(). The result is accumulated into output
+     */
+    void eval_cached_matvec(const DenseMatrix<T, Eigen::RowMajor>& input,
+                            DenseMatrix<T, Eigen::RowMajor>&       output,
+                            cudaStream_t                           stream)
+    {
+        if constexpr (!ScalarT::WithHessian_ || ScalarT::k_ <= 0) {
+            RXMESH_ERROR(
+                "TemplatedTerm::eval_cached_matvec() requires a static Scalar "
+                "type with Hessians. Returning without evaluation.");
+            return;
+        } else {
+            if (d_hess_cache_ids == nullptr) {
+                RXMESH_ERROR(
+                    "TemplatedTerm::eval_cached_matvec() the Hessian cache is "
+                    "empty. Call eval_hessian_cache() first.");
+                return;
+            }
+
+            constexpr int N = ScalarT::k_;
+
+            const int num_elements = rx.get_num_elements<LossHandleT>();
+
+            const int blocks = DIVIDE_UP(num_elements, blockThreads);
+
+            if (hess_cache_fp32) {
+                detail::hess_cache_matvec_kernel<blockThreads,
+                                                 N,
+                                                 VariableDim,
+                                                 T,
+                                                 float>
+                    <<<blocks, blockThreads, 0, stream>>>(num_elements,
+                                                          d_hess_cache_fp32,
+                                                          d_hess_cache_ids,
+                                                          input,
+                                                          output);
+            } else {
+                detail::hess_cache_matvec_kernel<blockThreads,
+                                                 N,
+                                                 VariableDim,
+                                                 T,
+                                                 T>
+                    <<<blocks, blockThreads, 0, stream>>>(num_elements,
+                                                          d_hess_cache,
+                                                          d_hess_cache_ids,
+                                                          input,
+                                                          output);
+            }
+        }
+    }
+
+    /**
+     * @brief free the memory used by the Hessian cache
+     */
+    void release_hessian_cache()
+    {
+        GPU_FREE(d_hess_cache);
+        GPU_FREE(d_hess_cache_fp32);
+        GPU_FREE(d_hess_cache_ids);
+    }
+
+    virtual ~TemplatedTerm()
+    {
+        release_hessian_cache();
+    }
+
     /**
      * @brief Evaluate the energy term using non-active/non-differentiable type
      */
@@ -253,6 +494,47 @@ struct TemplatedTerm : public Term<typename ScalarT::PassiveType, ObjHandleT>
         return reducer->reduce(*loss, cub::Sum(), 0, INVALID32, stream);
     }
 
+    /**
+     * @brief same as get_loss() but the loss is written to d_output on the
+     * device without host synchronization
+     */
+    void get_loss_async(T* d_output, cudaStream_t stream = NULL)
+    {
+        reducer->reduce_async(
+            *loss, cub::Sum(), 0, d_output, INVALID32, stream);
+    }
+
+    /**
+     * @brief set the method used to project the local Hessians (with
+     * ProjectHess)
+     */
+    void set_hess_projection(PSDProjection method)
+    {
+        hess_projection = method;
+    }
+
+    /**
+     * @brief report the resource usage of the kernel that evaluates the term
+     * with its derivatives
+     */
+    TermReport get_report()
+    {
+        TermReport report;
+        report.num_variables = ScalarT::k_;
+        report.scalar_bytes  = sizeof(ScalarT);
+        report.launch        = rx.get_launch_report(
+            lb_active,
+            (void*)detail::diff_kernel_active<blockThreads,
+                                              LossHandleT,
+                                              ObjHandleT,
+                                              op,
+                                              ScalarT,
+                                              ProjectHess,
+                                              VariableDim,
+                                              LambdaT>);
+        return report;
+    }
+
     LambdaT term;
 
     std::shared_ptr<Attribute<T, LossHandleT>>    loss;
@@ -268,19 +550,55 @@ struct TemplatedTerm : public Term<typename ScalarT::PassiveType, ObjHandleT>
     RXMeshStatic&                        rx;
     DenseMatrix<T, Eigen::RowMajor>&     grad;
     HessianSparseMatrix<T, VariableDim>& hess;
+
+    // local (dense) Hessian of every element stored by eval_hessian_cache()
+    // either in T or in single precision, along with the linear id of the
+    // element's objective handles
+    T*     d_hess_cache;
+    float* d_hess_cache_fp32;
+    int*   d_hess_cache_ids;
+    bool   hess_cache_fp32;
+
+    PSDProjection hess_projection;
+
+   protected:
+    template <typename CacheT>
+    void launch_hessian_cache(CacheT*                   d_cache,
+                              Attribute<T, ObjHandleT>& obj,
+                              cudaStream_t              stream)
+    {
+        rx.run_kernel(lb_active_matvec,
+                      detail::hess_cache_kernel<blockThreads,
+                                                LossHandleT,
+                                                ObjHandleT,
+                                                op,
+                                                ScalarT,
+                                                ProjectHess,
+                                                VariableDim,
+                                                CacheT,
+                                                LambdaT>,
+                      stream,
+                      d_cache,
+                      d_hess_cache_ids,
+                      obj,
+                      oreinted,
+                      hess_projection,
+                      term);
+    }
 };
 
 
 /**
  * @brief concrete class that defines energy terms for specific mesh type,
  * specific number of variable, etc. Used to define energy terms that requires
- * pairs of mesh elements
+ * pairs of mesh elements. PairsT is the container of the pairs (e.g.,
+ * CandidatePairsVV or CandidatePairsVF) that defines the vertices every pair
+ * depends on
  */
 template <typename LossHandleT,
           typename ObjHandleT,
           uint32_t blockThreads,
-          typename HandleT0,
-          typename HandleT1,
+          typename PairsT,
           typename ScalarT,
           bool ProjectHess,
           int  VariableDim,
@@ -294,12 +612,17 @@ struct TemplatedTermPairs
     // This will be the same as ScalarT if ScalarT has WithHessian=false
     using ScalarGradOnlyT = Scalar<T, ScalarT::k_, false>;
 
-    TemplatedTermPairs(RXMeshStatic&                            rx,
-                       LambdaT                                  t,
-                       DenseMatrix<T, Eigen::RowMajor>&         grad,
-                       HessianSparseMatrix<T, VariableDim>&     hess,
-                       CandidatePairs<HandleT0, HandleT1, int>& pairs)
-        : term(t), grad(grad), hess(hess), pairs(pairs)
+    TemplatedTermPairs(RXMeshStatic&                        rx,
+                       LambdaT                              t,
+                       DenseMatrix<T, Eigen::RowMajor>&     grad,
+                       HessianSparseMatrix<T, VariableDim>& hess,
+                       PairsT&                              pairs)
+        : term(t),
+          rx(rx),
+          grad(grad),
+          hess(hess),
+          pairs(pairs),
+          hess_projection(PSDProjection::Clamp)
     {
         // To avoid the clash that happens from adding many losses.
         std::ostringstream address;
@@ -323,6 +646,10 @@ struct TemplatedTermPairs
                 "supported for Hessians.");
             return;
         }
+        // the kernel accumulates the loss of the pairs (and the loss should
+        // be zero if there are no pairs)
+        loss->reset(0, DEVICE, stream);
+
         int size = pairs.num_pairs();
 
         if (size == 0) {
@@ -334,14 +661,13 @@ struct TemplatedTermPairs
         detail::diff_kernel_active_pair<blockThreads,
                                         LossHandleT,
                                         ObjHandleT,
-                                        HandleT0,
-                                        HandleT1,
+                                        PairsT,
                                         ScalarT,
                                         ProjectHess,
                                         VariableDim,
                                         LambdaT>
             <<<blocks, blockThreads, 0, stream>>>(
-                pairs, grad, hess, *loss, obj, term);
+                pairs, grad, hess, *loss, obj, hess_projection, term);
     }
 
 
@@ -352,6 +678,10 @@ struct TemplatedTermPairs
     void eval_active_grad_only(Attribute<T, ObjHandleT>& obj,
                                cudaStream_t              stream)
     {
+        // the kernel accumulates the loss of the pairs (and the loss should
+        // be zero if there are no pairs)
+        loss->reset(0, DEVICE, stream);
+
         int size = pairs.num_pairs();
 
         if (size == 0) {
@@ -363,14 +693,13 @@ struct TemplatedTermPairs
         detail::diff_kernel_active_pair<blockThreads,
                                         LossHandleT,
                                         ObjHandleT,
-                                        HandleT0,
-                                        HandleT1,
+                                        PairsT,
                                         ScalarGradOnlyT,
                                         ProjectHess,
                                         VariableDim,
                                         LambdaT>
             <<<blocks, blockThreads, 0, stream>>>(
-                pairs, grad, hess, *loss, obj, term);
+                pairs, grad, hess, *loss, obj, hess_projection, term);
     }
 
 
@@ -408,11 +737,45 @@ struct TemplatedTermPairs
             "TemplatedTermPairs::eval_active_matvec() Not implemented.");
     }
 
+    void eval_hessian_cache(Attribute<T, ObjHandleT>& obj,
+                            bool                      fp32,
+                            cudaStream_t              stream)
+    {
+        if (pairs.num_pairs() == 0) {
+            return;
+        }
+
+        // TODO
+        RXMESH_ERROR(
+            "TemplatedTermPairs::eval_hessian_cache() Not implemented.");
+    }
+
+    void eval_cached_matvec(const DenseMatrix<T, Eigen::RowMajor>& input,
+                            DenseMatrix<T, Eigen::RowMajor>&       output,
+                            cudaStream_t                           stream)
+    {
+        if (pairs.num_pairs() == 0) {
+            return;
+        }
+
+        // TODO
+        RXMESH_ERROR(
+            "TemplatedTermPairs::eval_cached_matvec() Not implemented.");
+    }
+
+    void release_hessian_cache()
+    {
+    }
+
     /**
      * @brief Evaluate the energy term using non-active/non-differentiable type
      */
     void eval_passive(Attribute<T, ObjHandleT>& obj, cudaStream_t stream)
     {
+        // the kernel accumulates the loss of the pairs (and the loss should
+        // be zero if there are no pairs)
+        loss->reset(0, DEVICE, stream);
+
         int size = pairs.num_pairs();
 
         if (size == 0) {
@@ -424,8 +787,7 @@ struct TemplatedTermPairs
         detail::diff_kernel_passive_pair<blockThreads,
                                          LossHandleT,
                                          ObjHandleT,
-                                         HandleT0,
-                                         HandleT1,
+                                         PairsT,
                                          ScalarT,
                                          LambdaT>
             <<<blocks, blockThreads, 0, stream>>>(pairs, *loss, obj, term);
@@ -440,13 +802,61 @@ struct TemplatedTermPairs
         return reducer->reduce(*loss, cub::Sum(), 0, INVALID32, stream);
     }
 
+    /**
+     * @brief same as get_loss() but the loss is written to d_output on the
+     * device without host synchronization
+     */
+    void get_loss_async(T* d_output, cudaStream_t stream = NULL)
+    {
+        reducer->reduce_async(
+            *loss, cub::Sum(), 0, d_output, INVALID32, stream);
+    }
+
+    /**
+     * @brief set the method used to project the local Hessians (with
+     * ProjectHess)
+     */
+    void set_hess_projection(PSDProjection method)
+    {
+        hess_projection = method;
+    }
+
+    /**
+     * @brief report the resource usage of the kernel that evaluates the term
+     * with its derivatives
+     */
+    TermReport get_report()
+    {
+        LaunchBox<blockThreads> lb;
+        lb.blocks         = DIVIDE_UP(pairs.num_pairs(), blockThreads);
+        lb.smem_bytes_dyn = 0;
+
+        TermReport report;
+        report.num_variables = ScalarT::k_;
+        report.scalar_bytes  = sizeof(ScalarT);
+        report.launch        = rx.get_launch_report(
+            lb,
+            (void*)detail::diff_kernel_active_pair<blockThreads,
+                                                   LossHandleT,
+                                                   ObjHandleT,
+                                                   PairsT,
+                                                   ScalarT,
+                                                   ProjectHess,
+                                                   VariableDim,
+                                                   LambdaT>);
+        return report;
+    }
+
     LambdaT term;
 
     std::shared_ptr<Attribute<T, LossHandleT>>    loss;
     std::shared_ptr<ReduceHandle<T, LossHandleT>> reducer;
 
-    DenseMatrix<T, Eigen::RowMajor>&         grad;
-    HessianSparseMatrix<T, VariableDim>&     hess;
-    CandidatePairs<HandleT0, HandleT1, int>& pairs;
+    RXMeshStatic&                        rx;
+    DenseMatrix<T, Eigen::RowMajor>&     grad;
+    HessianSparseMatrix<T, VariableDim>& hess;
+    PairsT&                              pairs;
+
+    PSDProjection hess_projection;
 };
 }  // namespace rxmesh
\ No newline at end of file
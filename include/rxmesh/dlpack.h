@@ -0,0 +1,425 @@
+#pragma once
+
+#include <stdint.h>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <type_traits>
+
+#include <cuda_bf16.h>
+#include <cuda_fp16.h>
+
+#include <dlpack/dlpack.h>
+
+#include "rxmesh/attribute.h"
+#include "rxmesh/matrix/dense_matrix.h"
+#include "rxmesh/rxmesh_static.h"
+#include "rxmesh/util/log.h"
+
+namespace rxmesh {
+
+/**
+ * @brief DLPack (https://github.com/dmlc/dlpack) export and import of
+ * DenseMatrix and attributes such that device (or host) data can be handed to
+ * other frameworks (e.g., PyTorch via torch.utils.dlpack.from_dlpack() or JAX
+ * via jax.dlpack.from_dlpack()) and back without going through the host or
+ * files. Matrices and attribute views (see RXMeshStatic::add_attribute_view())
+ * are exported and imported with no copies where the tensor strides describe
+ * the matrix order (or the view pitches). Other attributes are stored per
+ * patch with gaps (not-owned elements and the patch capacity) and so they are
+ * compacted into a new (row-major) buffer in linear_id() order using the dense
+ * index of RXMeshStatic::for_each_dense() which is built once. Exported
+ * tensors are released by calling their deleter (which the consumer framework
+ * does once it is done with the tensor). Except for the compacted attributes,
+ * the exported tensors do not own their memory and the matrix/attribute
+ * should outlive them. Likewise, imported matrices/attributes do not own their
+ * memory and the DLManagedTensor should only be deleted after the
+ * matrix/attribute is released
+ */
+
+namespace detail {
+
+/**
+ * @brief the DLPack data type of T
+ */
+template <typename T>
+inline DLDataType dlpack_dtype()
+{
+    DLDataType dtype;
+    dtype.bits  = sizeof(T) * 8;
+    dtype.lanes = 1;
+    if constexpr (std::is_same_v<T, __half>) {
+        dtype.code = kDLFloat;
+    } else if constexpr (std::is_same_v<T, __nv_bfloat16>) {
+        dtype.code = kDLBfloat;
+    } else if constexpr (std::is_same_v<T, bool>) {
+        dtype.code = kDLBool;
+    } else if constexpr (std::is_floating_point_v<T>) {
+        dtype.code = kDLFloat;
+    } else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+        dtype.code = kDLInt;
+    } else if constexpr (std::is_integral_v<T> && std::is_unsigned_v<T>) {
+        dtype.code = kDLUInt;
+    } else {
+        static_assert(sizeof(T) == 0, "dlpack_dtype() unsupported type");
+    }
+    return dtype;
+}
+
+/**
+ * @brief the shape and strides of an exported tensor along with the memory
+ * it owns (if any)
+ */
+struct DLPackContext
+{
+    int64_t shape[2];
+    int64_t strides[2];
+    void*   d_owned = nullptr;
+    void*   h_owned = nullptr;
+};
+
+inline void dlpack_deleter(DLManagedTensor* self)
+{
+    if (self == nullptr) {
+        return;
+    }
+    DLPackContext* ctx = static_cast<DLPackContext*>(self->manager_ctx);
+    if (ctx != nullptr) {
+        GPU_FREE(ctx->d_owned);
+        free(ctx->h_owned);
+        delete ctx;
+    }
+    delete self;
+}
+
+/**
+ * @brief create a 2D tensor of rows x cols where the entry (i, j) is at
+ * data[i * stride_row + j * stride_col]
+ */
+template <typename T>
+inline DLManagedTensor* dlpack_tensor(T*        data,
+                                      locationT location,
+                                      int64_t   rows,
+                                      int64_t   cols,
+                                      int64_t   stride_row,
+                                      int64_t   stride_col,
+                                      void*     d_owned = nullptr,
+                                      void*     h_owned = nullptr)
+{
+    DLPackContext* ctx = new DLPackContext;
+    ctx->shape[0]      = rows;
+    ctx->shape[1]      = cols;
+    ctx->strides[0]    = stride_row;
+    ctx->strides[1]    = stride_col;
+    ctx->d_owned       = d_owned;
+    ctx->h_owned       = h_owned;
+
+    DLManagedTensor* ret = new DLManagedTensor;
+
+    ret->dl_tensor.data = data;
+    if (location == DEVICE) {
+        int device_id = 0;
+        CUDA_ERROR(cudaGetDevice(&device_id));
+        ret->dl_tensor.device = {kDLCUDA, device_id};
+    } else {
+        ret->dl_tensor.device = {kDLCPU, 0};
+    }
+    ret->dl_tensor.ndim        = 2;
+    ret->dl_tensor.dtype       = dlpack_dtype<T>();
+    ret->dl_tensor.shape       = ctx->shape;
+    ret->dl_tensor.strides     = ctx->strides;
+    ret->dl_tensor.byte_offset = 0;
+    ret->manager_ctx           = ctx;
+    ret->deleter               = dlpack_deleter;
+    return ret;
+}
+
+/**
+ * @brief read a 1D or 2D tensor of type T as rows x cols with the strides of
+ * the two dimensions (in elements) and the location of its data. Returns
+ * false if the tensor can not be read as such
+ */
+template <typename T>
+inline bool dlpack_read(const char*            caller,
+                        const DLManagedTensor* tensor,
+                        T*&                    data,
+                        locationT&             location,
+                        int64_t&               rows,
+                        int64_t&               cols,
+                        int64_t&               stride_row,
+                        int64_t&               stride_col)
+{
+    if (tensor == nullptr) {
+        RXMESH_ERROR("{} the input tensor is null", caller);
+        return false;
+    }
+
+    const DLTensor&  t     = tensor->dl_tensor;
+    const DLDataType dtype = dlpack_dtype<T>();
+
+    if (t.dtype.code != dtype.code || t.dtype.bits != dtype.bits ||
+        t.dtype.lanes != dtype.lanes) {
+        RXMESH_ERROR("{} the tensor data type does not match the output type",
+                     caller);
+        return false;
+    }
+
+    if (t.ndim != 1 && t.ndim != 2) {
+        RXMESH_ERROR("{} only 1D and 2D tensors are supported (ndim = {})",
+                     caller,
+                     t.ndim);
+        return false;
+    }
+
+    if (t.device.device_type == kDLCUDA ||
+        t.device.device_type == kDLCUDAManaged) {
+        location = DEVICE;
+    } else if (t.device.device_type == kDLCPU ||
+               t.device.device_type == kDLCUDAHost) {
+        location = HOST;
+    } else {
+        RXMESH_ERROR("{} unsupported device type {}",
+                     caller,
+                     int(t.device.device_type));
+        return false;
+    }
+
+    rows = t.shape[0];
+    cols = (t.ndim == 2) ? t.shape[1] : 1;
+
+    // null strides means compact row-major
+    if (t.strides == nullptr) {
+        stride_row = cols;
+        stride_col = 1;
+    } else {
+        stride_row = t.strides[0];
+        stride_col = (t.ndim == 2) ? t.strides[1] : 1;
+    }
+
+    data = reinterpret_cast<T*>(static_cast<char*>(t.data) + t.byte_offset);
+    return true;
+}
+}  // namespace detail
+
+/**
+ * @brief export a DenseMatrix as a 2D DLPack tensor with no copy. The matrix
+ * (and its memory) should outlive the tensor
+ * @param mat the input matrix
+ * @param location the location of the exported data (DEVICE or HOST)
+ */
+template <typename T, int Order>
+DLManagedTensor* to_dlpack(const DenseMatrix<T, Order>& mat,
+                           locationT                    location = DEVICE)
+{
+    if (location != DEVICE && location != HOST) {
+        RXMESH_ERROR("to_dlpack() the location should be DEVICE or HOST");
+        return nullptr;
+    }
+
+    if (mat.data(location) == nullptr) {
+        RXMESH_ERROR("to_dlpack() the matrix is not allocated on {}",
+                     location_to_string(location));
+        return nullptr;
+    }
+
+    const bool col_major = Order == Eigen::ColMajor;
+
+    return detail::dlpack_tensor(mat.data(location),
+                                 location,
+                                 mat.rows(),
+                                 mat.cols(),
+                                 col_major ? 1 : mat.lead_dim(),
+                                 col_major ? mat.lead_dim() : 1);
+}
+
+/**
+ * @brief import a DLPack tensor as a (user-managed) DenseMatrix with no copy.
+ * The layout of the tensor should match the matrix order (i.e., compact
+ * column-major for ColMajor and compact row-major for RowMajor). The tensor
+ * should outlive the matrix
+ * @return the matrix or nullptr if the tensor can not be imported
+ */
+template <typename T, int Order = Eigen::ColMajor>
+std::shared_ptr<DenseMatrix<T, Order>> dense_matrix_from_dlpack(
+    const DLManagedTensor* tensor)
+{
+    T*        data;
+    locationT location;
+    int64_t   rows, cols, stride_row, stride_col;
+
+    if (!detail::dlpack_read("dense_matrix_from_dlpack()",
+                             tensor,
+                             data,
+                             location,
+                             rows,
+                             cols,
+                             stride_row,
+                             stride_col)) {
+        return nullptr;
+    }
+
+    // strides of size-1 dimensions do not matter
+    const bool col_major =
+        (rows == 1 || stride_row == 1) && (cols == 1 || stride_col == rows);
+    const bool row_major =
+        (cols == 1 || stride_col == 1) && (rows == 1 || stride_row == cols);
+
+    if ((Order == Eigen::ColMajor && !col_major) ||
+        (Order == Eigen::RowMajor && !row_major)) {
+        RXMESH_ERROR(
+            "dense_matrix_from_dlpack() the tensor strides ({}, {}) do not "
+            "match a compact matrix of the requested order",
+            stride_row,
+            stride_col);
+        return nullptr;
+    }
+
+    return std::make_shared<DenseMatrix<T, Order>>(
+        int(rows),
+        int(cols),
+        location == DEVICE ? data : nullptr,
+        location == HOST ? data : nullptr);
+}
+
+/**
+ * @brief export an attribute as a 2D DLPack tensor of (number of mesh
+ * elements) x get_num_attributes() in linear_id() order. Views are exported
+ * with no copy (and should outlive the tensor). Otherwise, the attribute is
+ * compacted into a new row-major buffer owned by the tensor
+ * @param rx the mesh the attribute is defined on
+ * @param attr the input attribute
+ * @param location the location of the exported data (DEVICE or HOST)
+ * @param stream the stream used to compact the attribute on the device
+ */
+template <typename T, typename HandleT>
+DLManagedTensor* to_dlpack(const RXMeshStatic&          rx,
+                           const Attribute<T, HandleT>& attr,
+                           locationT                    location = DEVICE,
+                           cudaStream_t                 stream   = NULL)
+{
+    if (location != DEVICE && location != HOST) {
+        RXMESH_ERROR("to_dlpack() the location should be DEVICE or HOST");
+        return nullptr;
+    }
+
+    if ((attr.get_allocated() & location) != location) {
+        RXMESH_ERROR("to_dlpack() the attribute {} is not allocated on {}",
+                     attr.get_name(),
+                     location_to_string(location));
+        return nullptr;
+    }
+
+    const uint32_t num_elements = rx.get_num_elements<HandleT>();
+    const uint32_t num_attr     = attr.get_num_attributes();
+
+    if (attr.is_view()) {
+        return detail::dlpack_tensor(attr.get_view_data(location),
+                                     location,
+                                     num_elements,
+                                     num_attr,
+                                     attr.get_view_pitch_x(),
+                                     attr.get_view_pitch_y());
+    }
+
+    const size_t bytes = size_t(num_elements) * num_attr * sizeof(T);
+
+    T* out = nullptr;
+
+    if (location == DEVICE) {
+        CUDA_ERROR(tracked_malloc(
+            (void**)&out, std::max(bytes, size_t(1)), MemoryCategory::Other));
+        rx.for_each_dense<HandleT>(
+            DEVICE,
+            [attr, out, num_attr] __device__(const HandleT  h,
+                                             const uint32_t i) {
+                for (uint32_t j = 0; j < num_attr; ++j) {
+                    out[size_t(i) * num_attr + j] = attr(h, j);
+                }
+            },
+            stream);
+        CUDA_ERROR(cudaStreamSynchronize(stream));
+    } else {
+        out = static_cast<T*>(malloc(std::max(bytes, size_t(1))));
+        rx.for_each_dense<HandleT>(
+            HOST, [&](const HandleT h, const uint32_t i) {
+                for (uint32_t j = 0; j < num_attr; ++j) {
+                    out[size_t(i) * num_attr + j] = attr(h, j);
+                }
+            });
+    }
+
+    return detail::dlpack_tensor(out,
+                                 location,
+                                 num_elements,
+                                 num_attr,
+                                 num_attr,
+                                 1,
+                                 location == DEVICE ? out : nullptr,
+                                 location == HOST ? out : nullptr);
+}
+
+/**
+ * @brief import a DLPack tensor of (number of mesh elements) x (number of
+ * attributes) in linear_id() order as an attribute view (see
+ * RXMeshStatic::add_attribute_view()) with no copy. Writing to the attribute
+ * writes in the tensor memory and vice versa. The tensor should outlive the
+ * attribute
+ * @param rx the mesh the attribute is defined on
+ * @param name of the attribute. Should not collide with other attributes
+ * names
+ * @param tensor the input tensor
+ * @return the attribute or nullptr if the tensor can not be imported
+ */
+template <typename HandleT, typename T>
+std::shared_ptr<Attribute<T, HandleT>> attribute_from_dlpack(
+    RXMeshStatic&          rx,
+    const std::string&     name,
+    const DLManagedTensor* tensor)
+{
+    T*        data;
+    locationT location;
+    int64_t   rows, cols, stride_row, stride_col;
+
+    if (!detail::dlpack_read("attribute_from_dlpack()",
+                             tensor,
+                             data,
+                             location,
+                             rows,
+                             cols,
+                             stride_row,
+                             stride_col)) {
+        return nullptr;
+    }
+
+    if (rows != int64_t(rx.get_num_elements<HandleT>())) {
+        RXMESH_ERROR(
+            "attribute_from_dlpack() the number of rows of the tensor ({}) is "
+            "different than the number of mesh elements ({})",
+            rows,
+            rx.get_num_elements<HandleT>());
+        return nullptr;
+    }
+
+    // strides of size-1 dimensions do not matter but the view needs them
+    // to be positive
+    if (cols == 1) {
+        stride_col = std::max(stride_col, int64_t(1));
+    }
+    if (stride_row <= 0 || stride_col <= 0) {
+        RXMESH_ERROR(
+            "attribute_from_dlpack() the tensor strides ({}, {}) should be "
+            "positive",
+            stride_row,
+            stride_col);
+        return nullptr;
+    }
+
+    return rx.add_attribute_view<HandleT>(name,
+                                          uint32_t(cols),
+                                          location == DEVICE ? data : nullptr,
+                                          location == HOST ? data : nullptr,
+                                          uint32_t(stride_row),
+                                          uint32_t(stride_col));
+}
+
+}  // namespace rxmesh
@@ -0,0 +1,573 @@
+#pragma once
+#include <stdint.h>
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "rxmesh/types.h"
+#include "rxmesh/util/device_memory.h"
+#include "rxmesh/util/macros.h"
+
+namespace rxmesh {
+
+/**
+ * @brief a triangle mesh generated on the device (see generate_plane(),
+ * generate_icosphere(), generate_torus(), and generate_noisy_sphere()) as
+ * flat buffers where face f is (fv[3*f], fv[3*f+1], fv[3*f+2]) and vertex v is
+ * (vertices[3*v], vertices[3*v+1], vertices[3*v+2]). The buffers are owned by
+ * the caller and should be freed using release()
+ */
+struct DeviceMesh
+{
+    uint32_t* fv           = nullptr;
+    float*    vertices     = nullptr;
+    uint32_t  num_vertices = 0;
+    uint32_t  num_faces    = 0;
+
+    /**
+     * @brief copy the mesh to the host
+     */
+    void download(std::vector<uint32_t>& h_fv, std::vector<float>& h_vertices)
+    {
+        h_fv.resize(3 * size_t(num_faces));
+        h_vertices.resize(3 * size_t(num_vertices));
+        CUDA_ERROR(cudaMemcpy(h_fv.data(),
+                              fv,
+                              h_fv.size() * sizeof(uint32_t),
+                              cudaMemcpyDeviceToHost));
+        CUDA_ERROR(cudaMemcpy(h_vertices.data(),
+                              vertices,
+                              h_vertices.size() * sizeof(float),
+                              cudaMemcpyDeviceToHost));
+    }
+
+    void release()
+    {
+        GPU_FREE(fv);
+        GPU_FREE(vertices);
+        num_vertices = 0;
+        num_faces    = 0;
+    }
+
+    void allocate(const uint32_t nv, const uint32_t nf)
+    {
+        release();
+        num_vertices = nv;
+        num_faces    = nf;
+        CUDA_ERROR(tracked_malloc((void**)&fv,
+                                  3 * size_t(nf) * sizeof(uint32_t),
+                                  MemoryCategory::Other));
+        CUDA_ERROR(tracked_malloc((void**)&vertices,
+                                  3 * size_t(nv) * sizeof(float),
+                                  MemoryCategory::Other));
+    }
+};
+
+namespace detail {
+
+/**
+ * @brief the icosahedron (vertices on the unit sphere and outward oriented
+ * faces) along with its edges (the smaller vertex first) and the edges of the
+ * sides of every face i.e., (a,b), (a,c), and (b,c) of face (a,b,c). Passed by
+ * value to the icosphere kernels
+ */
+struct Icosahedron
+{
+    float    corner[12][3];
+    uint32_t face[20][3];
+    uint32_t edge[30][2];
+    uint32_t face_edge[20][3];
+
+    Icosahedron()
+    {
+        const float t = (1.f + std::sqrt(5.f)) / 2.f;
+        const float s = 1.f / std::sqrt(1.f + t * t);
+
+        const float c[12][3] = {{-1, t, 0},
+                                {1, t, 0},
+                                {-1, -t, 0},
+                                {1, -t, 0},
+                                {0, -1, t},
+                                {0, 1, t},
+                                {0, -1, -t},
+                                {0, 1, -t},
+                                {t, 0, -1},
+                                {t, 0, 1},
+                                {-t, 0, -1},
+                                {-t, 0, 1}};
+
+        const uint32_t f[20][3] = {{0, 11, 5}, {0, 5, 1},  {0, 1, 7},
+                                   {0, 7, 10}, {0, 10, 11}, {1, 5, 9},
+                                   {5, 11, 4}, {11, 10, 2}, {10, 7, 6},
+                                   {7, 1, 8},  {3, 9, 4},  {3, 4, 2},
+                                   {3, 2, 6},  {3, 6, 8},  {3, 8, 9},
+                                   {4, 9, 5},  {2, 4, 11}, {6, 2, 10},
+                                   {8, 6, 7},  {9, 8, 1}};
+
+        for (int v = 0; v < 12; ++v) {
+            for (int i = 0; i < 3; ++i) {
+                corner[v][i] = c[v][i] * s;
+            }
+        }
+
+        uint32_t num_edges = 0;
+
+        auto edge_id = [&](uint32_t a, uint32_t b) {
+            if (a > b) {
+                std::swap(a, b);
+            }
+            for (uint32_t e = 0; e < num_edges; ++e) {
+                if (edge[e][0] == a && edge[e][1] == b) {
+                    return e;
+                }
+            }
+            edge[num_edges][0] = a;
+            edge[num_edges][1] = b;
+            return num_edges++;
+        };
+
+        for (int i = 0; i < 20; ++i) {
+            for (int j = 0; j < 3; ++j) {
+                face[i][j] = f[i][j];
+            }
+            face_edge[i][0] = edge_id(f[i][0], f[i][1]);
+            face_edge[i][1] = edge_id(f[i][0], f[i][2]);
+            face_edge[i][2] = edge_id(f[i][1], f[i][2]);
+        }
+        assert(num_edges == 30);
+    }
+};
+
+/**
+ * @brief the index of the k-th vertex (1 <= k < n) along the side of a face
+ * that starts at from and lies on the icosahedron edge e
+ */
+__device__ __forceinline__ uint32_t ico_edge_vertex(const Icosahedron& ico,
+                                                    const uint32_t     n,
+                                                    const uint32_t     e,
+                                                    const uint32_t     from,
+                                                    const uint32_t     k)
+{
+    const uint32_t kk = (from == ico.edge[e][0]) ? k : n - k;
+    return 12 + e * (n - 1) + (kk - 1);
+}
+
+/**
+ * @brief the index of the lattice point (i, j) of face f of the icosahedron
+ * subdivided with frequency n where the point is a*(n-i-j) + b*i + c*j for
+ * face (a,b,c). The corners come first followed by the vertices inside the
+ * icosahedron edges and then the vertices inside the faces
+ */
+__device__ __forceinline__ uint32_t ico_vertex(const Icosahedron& ico,
+                                               const uint32_t     n,
+                                               const uint32_t     f,
+                                               const uint32_t     i,
+                                               const uint32_t     j)
+{
+    if (i == 0 && j == 0) {
+        return ico.face[f][0];
+    }
+    if (i == n) {
+        return ico.face[f][1];
+    }
+    if (j == n) {
+        return ico.face[f][2];
+    }
+    if (j == 0) {
+        return ico_edge_vertex(ico, n, ico.face_edge[f][0], ico.face[f][0], i);
+    }
+    if (i == 0) {
+        return ico_edge_vertex(ico, n, ico.face_edge[f][1], ico.face[f][0], j);
+    }
+    if (i + j == n) {
+        return ico_edge_vertex(ico, n, ico.face_edge[f][2], ico.face[f][1], j);
+    }
+    // the interior points of row j (1 <= j <= n-2) are i = 1, ..., n-1-j
+    const uint32_t row = (j - 1) * (n - 1) - ((j - 1) * j) / 2;
+    return 12 + 30 * (n - 1) + f * (((n - 1) * (n - 2)) / 2) + row + (i - 1);
+}
+
+__device__ __forceinline__ void write_sphere_vertex(float*         vertices,
+                                                    const uint32_t v,
+                                                    float          x,
+                                                    float          y,
+                                                    float          z,
+                                                    const float    radius)
+{
+    const float s = radius / sqrtf(x * x + y * y + z * z);
+
+    vertices[3 * size_t(v) + 0] = x * s;
+    vertices[3 * size_t(v) + 1] = y * s;
+    vertices[3 * size_t(v) + 2] = z * s;
+}
+
+/**
+ * @brief the corners and the vertices inside the icosahedron edges
+ */
+__global__ static void icosphere_edge_vertices(const Icosahedron ico,
+                                               const uint32_t    n,
+                                               const float       radius,
+                                               float*            vertices)
+{
+    const uint32_t id = blockIdx.x * blockDim.x + threadIdx.x;
+
+    if (id < 12) {
+        write_sphere_vertex(vertices,
+                            id,
+                            ico.corner[id][0],
+                            ico.corner[id][1],
+                            ico.corner[id][2],
+                            radius);
+    } else if (id < 12 + 30 * (n - 1)) {
+        const uint32_t e = (id - 12) / (n - 1);
+        const uint32_t k = (id - 12) % (n - 1) + 1;
+
+        const float* u = ico.corner[ico.edge[e][0]];
+        const float* w = ico.corner[ico.edge[e][1]];
+
+        write_sphere_vertex(vertices,
+                            id,
+                            u[0] * (n - k) + w[0] * k,
+                            u[1] * (n - k) + w[1] * k,
+                            u[2] * (n - k) + w[2] * k,
+                            radius);
+    }
+}
+
+/**
+ * @brief one thread per lattice cell (i, j) of face f (i + j < n) that writes
+ * the cell faces and its interior vertex (if any)
+ */
+__global__ static void icosphere_faces(const Icosahedron ico,
+                                       const uint32_t    n,
+                                       const float       radius,
+                                       uint32_t*         fv,
+                                       float*            vertices)
+{
+    const uint64_t id = uint64_t(blockIdx.x) * blockDim.x + threadIdx.x;
+    if (id >= 20 * uint64_t(n) * n) {
+        return;
+    }
+
+    const uint32_t f = id / (uint64_t(n) * n);
+    const uint32_t r = id % (uint64_t(n) * n);
+    const uint32_t j = r / n;
+    const uint32_t i = r % n;
+
+    if (i + j >= n) {
+        return;
+    }
+
+    if (i > 0 && j > 0) {
+        const float* a = ico.corner[ico.face[f][0]];
+        const float* b = ico.corner[ico.face[f][1]];
+        const float* c = ico.corner[ico.face[f][2]];
+
+        const uint32_t w = n - i - j;
+        write_sphere_vertex(vertices,
+                            ico_vertex(ico, n, f, i, j),
+                            a[0] * w + b[0] * i + c[0] * j,
+                            a[1] * w + b[1] * i + c[1] * j,
+                            a[2] * w + b[2] * i + c[2] * j,
+                            radius);
+    }
+
+    // row j has n-j up faces and n-j-1 down faces interleaved
+    const size_t face = size_t(f) * n * n + (2 * j * n - j * j) + 2 * i;
+
+    fv[3 * face + 0] = ico_vertex(ico, n, f, i, j);
+    fv[3 * face + 1] = ico_vertex(ico, n, f, i + 1, j);
+    fv[3 * face + 2] = ico_vertex(ico, n, f, i, j + 1);
+
+    if (i + j + 1 < n) {
+        fv[3 * face + 3] = ico_vertex(ico, n, f, i + 1, j);
+        fv[3 * face + 4] = ico_vertex(ico, n, f, i + 1, j + 1);
+        fv[3 * face + 5] = ico_vertex(ico, n, f, i, j + 1);
+    }
+}
+
+/**
+ * @brief displace the vertices along their direction from the origin by a
+ * (deterministic) pseudo-random fraction in [-amplitude, amplitude]
+ */
+__global__ static void radial_noise(const uint32_t num_vertices,
+                                    const float    amplitude,
+                                    const uint32_t seed,
+                                    float*         vertices)
+{
+    const uint32_t v = blockIdx.x * blockDim.x + threadIdx.x;
+    if (v >= num_vertices) {
+        return;
+    }
+
+    uint32_t h = v ^ seed;
+    h ^= h >> 16;
+    h *= 0x85ebca6b;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35;
+    h ^= h >> 16;
+
+    const float r = 2.f * float(h) / float(UINT32_MAX) - 1.f;
+    const float s = 1.f + amplitude * r;
+    for (int i = 0; i < 3; ++i) {
+        vertices[3 * size_t(v) + i] *= s;
+    }
+}
+
+/**
+ * @brief one thread per grid point (i, j) that writes the point and the two
+ * faces of the cell whose lower corner is the point. The plane is the same as
+ * create_plane()
+ */
+__global__ static void plane_grid(const uint32_t nx,
+                                  const uint32_t ny,
+                                  const int      plane,
+                                  const float    dx,
+                                  const float    lx,
+                                  const float    ly,
+                                  const float    lz,
+                                  uint32_t*      fv,
+                                  float*         vertices)
+{
+    const uint64_t id = uint64_t(blockIdx.x) * blockDim.x + threadIdx.x;
+    if (id >= uint64_t(nx) * ny) {
+        return;
+    }
+
+    const uint32_t i = id / nx;
+    const uint32_t j = id % nx;
+
+    float x = lx, y = ly, z = lz;
+    if (plane == 0) {
+        y += dx * j;
+        z += dx * i;
+    } else if (plane == 1) {
+        x += dx * j;
+        z += dx * i;
+    } else {
+        x += dx * j;
+        y += dx * i;
+    }
+    vertices[3 * id + 0] = x;
+    vertices[3 * id + 1] = y;
+    vertices[3 * id + 2] = z;
+
+    if (i + 1 < ny && j + 1 < nx) {
+        const uint32_t a = uint32_t(id);
+        const uint32_t b = a + nx;
+        const uint32_t c = a + 1;
+        const uint32_t d = a + nx + 1;
+
+        const size_t face = 2 * (size_t(i) * (nx - 1) + j);
+
+        fv[3 * face + 0] = a;
+        fv[3 * face + 1] = b;
+        fv[3 * face + 2] = c;
+        fv[3 * face + 3] = c;
+        fv[3 * face + 4] = b;
+        fv[3 * face + 5] = d;
+    }
+}
+
+/**
+ * @brief one thread per torus grid point (i, j) that writes the point and the
+ * two faces of the (periodic) cell whose lower corner is the point
+ */
+__global__ static void torus_grid(const uint32_t nu,
+                                  const uint32_t nv,
+                                  const float    major_radius,
+                                  const float    minor_radius,
+                                  uint32_t*      fv,
+                                  float*         vertices)
+{
+    const uint64_t id = uint64_t(blockIdx.x) * blockDim.x + threadIdx.x;
+    if (id >= uint64_t(nu) * nv) {
+        return;
+    }
+
+    const uint32_t i = id / nv;
+    const uint32_t j = id % nv;
+
+    constexpr float two_pi = 6.28318530717958647692f;
+
+    const float u = two_pi * float(i) / float(nu);
+    const float v = two_pi * float(j) / float(nv);
+
+    const float ring = major_radius + minor_radius * cosf(v);
+
+    vertices[3 * id + 0] = ring * cosf(u);
+    vertices[3 * id + 1] = ring * sinf(u);
+    vertices[3 * id + 2] = minor_radius * sinf(v);
+
+    const uint32_t i1 = (i + 1) % nu;
+    const uint32_t j1 = (j + 1) % nv;
+
+    const uint32_t a = i * nv + j;
+    const uint32_t b = i1 * nv + j;
+    const uint32_t c = i * nv + j1;
+    const uint32_t d = i1 * nv + j1;
+
+    fv[6 * id + 0] = a;
+    fv[6 * id + 1] = b;
+    fv[6 * id + 2] = d;
+    fv[6 * id + 3] = a;
+    fv[6 * id + 4] = d;
+    fv[6 * id + 5] = c;
+}
+
+inline uint32_t generator_blocks(const uint64_t n, const uint32_t threads)
+{
+    return static_cast<uint32_t>(DIVIDE_UP(n, uint64_t(threads)));
+}
+}  // namespace detail
+
+/**
+ * @brief create an nx x ny grid plane on the device. Same vertices and faces
+ * as create_plane() (without the cross diagonal)
+ */
+inline DeviceMesh generate_plane(const uint32_t    nx,
+                                 const uint32_t    ny,
+                                 const int         plane      = 1,
+                                 const float       dx         = 1.0,
+                                 const vec3<float> low_corner = {0, 0, 0},
+                                 cudaStream_t      stream     = NULL)
+{
+    DeviceMesh mesh;
+    if (nx < 2 || ny < 2) {
+        RXMESH_ERROR("generate_plane() nx and ny should be at least 2");
+        return mesh;
+    }
+
+    mesh.allocate(nx * ny, 2 * (nx - 1) * (ny - 1));
+
+    constexpr uint32_t threads = 256;
+    detail::plane_grid<<<detail::generator_blocks(uint64_t(nx) * ny, threads),
+                         threads,
+                         0,
+                         stream>>>(nx,
+                                   ny,
+                                   plane,
+                                   dx,
+                                   low_corner[0],
+                                   low_corner[1],
+                                   low_corner[2],
+                                   mesh.fv,
+                                   mesh.vertices);
+    CUDA_ERROR(cudaGetLastError());
+    return mesh;
+}
+
+/**
+ * @brief create an icosphere on the device by subdividing every face of the
+ * icosahedron into n x n triangles and projecting the vertices onto the sphere
+ * with the given radius. The mesh has 10*n^2+2 vertices and 20*n^2 faces where
+ * n = 2^k gives the same mesh as k loop-like subdivisions
+ */
+inline DeviceMesh generate_icosphere(const uint32_t n,
+                                     const float    radius = 1.0,
+                                     cudaStream_t   stream = NULL)
+{
+    DeviceMesh mesh;
+    if (n < 1) {
+        RXMESH_ERROR("generate_icosphere() n should be at least 1");
+        return mesh;
+    }
+
+    mesh.allocate(10 * n * n + 2, 20 * n * n);
+
+    const detail::Icosahedron ico;
+
+    constexpr uint32_t threads = 256;
+    detail::icosphere_edge_vertices<<<
+        detail::generator_blocks(12 + 30 * (n - 1), threads),
+        threads,
+        0,
+        stream>>>(ico, n, radius, mesh.vertices);
+
+    detail::icosphere_faces<<<
+        detail::generator_blocks(20 * uint64_t(n) * n, threads),
+        threads,
+        0,
+        stream>>>(ico, n, radius, mesh.fv, mesh.vertices);
+    CUDA_ERROR(cudaGetLastError());
+    return mesh;
+}
+
+/**
+ * @brief create a nu x nv torus around the z-axis on the device with 2*nu*nv
+ * faces
+ */
+inline DeviceMesh generate_torus(const uint32_t nu,
+                                 const uint32_t nv,
+                                 const float    major_radius = 1.0,
+                                 const float    minor_radius = 0.25,
+                                 cudaStream_t   stream       = NULL)
+{
+    DeviceMesh mesh;
+    if (nu < 3 || nv < 3) {
+        RXMESH_ERROR("generate_torus() nu and nv should be at least 3");
+        return mesh;
+    }
+
+    mesh.allocate(nu * nv, 2 * nu * nv);
+
+    constexpr uint32_t threads = 256;
+    detail::torus_grid<<<detail::generator_blocks(uint64_t(nu) * nv, threads),
+                         threads,
+                         0,
+                         stream>>>(
+        nu, nv, major_radius, minor_radius, mesh.fv, mesh.vertices);
+    CUDA_ERROR(cudaGetLastError());
+    return mesh;
+}
+
+/**
+ * @brief same as generate_icosphere() where every vertex is displaced
+ * radially by a pseudo-random fraction (of the radius) in [-amplitude,
+ * amplitude]. The noise only depends on the vertex index and the seed such
+ * that the mesh is the same in every run
+ */
+inline DeviceMesh generate_noisy_sphere(const uint32_t n,
+                                        const float    radius    = 1.0,
+                                        const float    amplitude = 0.05,
+                                        const uint32_t seed      = 0,
+                                        cudaStream_t   stream    = NULL)
+{
+    DeviceMesh mesh = generate_icosphere(n, radius, stream);
+    if (mesh.num_vertices == 0) {
+        return mesh;
+    }
+
+    constexpr uint32_t threads = 256;
+    detail::radial_noise<<<detail::generator_blocks(mesh.num_vertices,
+                                                    threads),
+                           threads,
+                           0,
+                           stream>>>(
+        mesh.num_vertices, amplitude, seed, mesh.vertices);
+    CUDA_ERROR(cudaGetLastError());
+    return mesh;
+}
+
+/**
+ * @brief construct MeshT (e.g., RXMeshStatic or RXMeshDynamic) from a
+ * generated mesh using the flat face buffer constructor and add its vertex
+ * coordinates. args are passed to the constructor after the face buffer and
+ * the number of faces
+ */
+template <typename MeshT, typename... ArgsT>
+std::unique_ptr<MeshT> make_mesh(DeviceMesh& mesh, ArgsT&&... args)
+{
+    std::vector<uint32_t> h_fv;
+    std::vector<float>    h_vertices;
+    mesh.download(h_fv, h_vertices);
+
+    auto rx = std::make_unique<MeshT>(
+        h_fv.data(), mesh.num_faces, std::forward<ArgsT>(args)...);
+    rx->add_vertex_coordinates(h_vertices.data(), mesh.num_vertices);
+    return rx;
+}
+}  // namespace rxmesh
@@ -0,0 +1,313 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "rxmesh/attribute.h"
+#include "rxmesh/context.h"
+#include "rxmesh/geometry_util.cuh"
+#include "rxmesh/query.cuh"
+#include "rxmesh/rxmesh_static.h"
+
+namespace rxmesh {
+
+/**
+ * @brief Flags for the quantities computed by compute_geometry(). Flags can be
+ * combined (e.g., GEOM_NORMAL | GEOM_VORONOI_AREA)
+ */
+using geometryT = uint32_t;
+enum : geometryT
+{
+    GEOM_NONE           = 0x00,
+    // area-weighted vertex normal as in Max, Nelson. "Weights for computing
+    // vertex normals from facet normals" (normalized)
+    GEOM_NORMAL         = 0x01,
+    // the mixed Voronoi area of Meyer et al. "Discrete Differential-Geometry
+    // Operators for Triangulated 2-Manifolds"
+    GEOM_VORONOI_AREA   = 0x02,
+    // 2*pi minus the sum of the vertex angles
+    GEOM_ANGLE_DEFECT   = 0x04,
+    // (cot(a) + cot(b))/2 where a and b are the angles opposite to the edge
+    GEOM_COTAN_WEIGHT   = 0x08,
+    // the magnitude of the mean curvature normal i.e., |L(x)|/(2A) where L is
+    // the cotan Laplacian. Implies GEOM_VORONOI_AREA
+    GEOM_MEAN_CURVATURE = 0x10,
+};
+
+/**
+ * @brief The output of compute_geometry(). Only the attributes of the
+ * requested quantities are allocated (the others are nullptr). All allocated
+ * attributes live on the device
+ */
+template <typename T>
+struct GeometryAttributes
+{
+    std::shared_ptr<VertexAttribute<T>> normal;
+    std::shared_ptr<VertexAttribute<T>> voronoi_area;
+    std::shared_ptr<VertexAttribute<T>> angle_defect;
+    std::shared_ptr<VertexAttribute<T>> mean_curvature;
+    std::shared_ptr<EdgeAttribute<T>>   cotan_weight;
+};
+
+namespace detail {
+
+/**
+ * @brief one pass over the faces that computes the triangle geometry (edge
+ * vectors, squared lengths, corner dot products, angles and the unnormalized
+ * normal) once and scatters the contributions of every requested quantity to
+ * the face vertices (and edges). laplace accumulates the (3-component) cotan
+ * Laplacian of the coordinates used by GEOM_MEAN_CURVATURE
+ */
+template <geometryT quantities, typename T, uint32_t blockThreads>
+__global__ static void __launch_bounds__(blockThreads)
+    fused_face_geometry(const Context            context,
+                        const VertexAttribute<T> coords,
+                        VertexAttribute<T>       normal,
+                        VertexAttribute<T>       voronoi_area,
+                        VertexAttribute<T>       angle_defect,
+                        EdgeAttribute<T>         cotan_weight,
+                        VertexAttribute<T>       laplace)
+{
+    constexpr bool with_normal  = quantities & GEOM_NORMAL;
+    constexpr bool with_mean    = quantities & GEOM_MEAN_CURVATURE;
+    constexpr bool with_area    = (quantities & GEOM_VORONOI_AREA) || with_mean;
+    constexpr bool with_defect  = quantities & GEOM_ANGLE_DEFECT;
+    constexpr bool with_weights = quantities & GEOM_COTAN_WEIGHT;
+    constexpr bool with_cot     = with_area || with_weights || with_mean;
+
+    constexpr T half_pi = T(0.5) * T(3.14159265358979323846);
+
+    auto           block = cooperative_groups::this_thread_block();
+    ShmemAllocator shrd_alloc;
+
+    // the face edges are only needed to scatter the cotan weights
+    Query<blockThreads> fe_query(context);
+    if constexpr (with_weights) {
+        fe_query.prologue<Op::FE>(block, shrd_alloc);
+    }
+
+    auto geom_lambda = [&](const FaceHandle& fh, const VertexIterator& fv) {
+        const vec3<T> x[3] = {coords.template to_glm<3>(fv[0]),
+                              coords.template to_glm<3>(fv[1]),
+                              coords.template to_glm<3>(fv[2])};
+
+        // the unnormalized normal and twice the triangle area
+        const vec3<T> n = glm::cross(x[1] - x[0], x[2] - x[0]);
+        const T       s = glm::length(n);
+
+        // l[i] is the squared length of the edge fv[i]->fv[i+1] and c[i] is
+        // the dot product of the two edges emanating from corner i
+        T l[3], c[3], cot[3], rads[3];
+        for (int i = 0; i < 3; ++i) {
+            const vec3<T>& p = x[i];
+            const vec3<T>& q = x[(i + 1) % 3];
+            const vec3<T>& r = x[(i + 2) % 3];
+
+            l[i] = glm::distance2(p, q);
+            c[i] = glm::dot(q - p, r - p);
+
+            if constexpr (with_cot) {
+                cot[i] = (s > std::numeric_limits<T>::min()) ? c[i] / s : T(0);
+                clamp_cot(cot[i]);
+            }
+            if constexpr (with_area || with_defect) {
+                rads[i] = atan2(s, c[i]);
+            }
+        }
+
+        const bool is_ob =
+            with_area &&
+            (rads[0] > half_pi || rads[1] > half_pi || rads[2] > half_pi);
+
+        for (int v = 0; v < 3; ++v) {
+            const int v1 = (v + 1) % 3;
+            const int v2 = (v + 2) % 3;
+
+            if constexpr (with_normal) {
+                const T w = T(1) / (l[v] + l[v2]);
+                for (int i = 0; i < 3; ++i) {
+                    ::atomicAdd(&normal(fv[v], i), n[i] * w);
+                }
+            }
+
+            if constexpr (with_area) {
+                T a;
+                if (is_ob) {
+                    a = (rads[v] > half_pi) ? T(0.25) * s : T(0.125) * s;
+                } else {
+                    a = T(0.125) * (l[v2] * cot[v1] + l[v] * cot[v2]);
+                }
+                ::atomicAdd(&voronoi_area(fv[v]), a);
+            }
+
+            if constexpr (with_defect) {
+                ::atomicAdd(&angle_defect(fv[v]), -rads[v]);
+            }
+
+            if constexpr (with_mean) {
+                // the edge fv[v]->fv[v1] is opposite to corner v2
+                const vec3<T> d = T(0.5) * cot[v2] * (x[v] - x[v1]);
+                for (int i = 0; i < 3; ++i) {
+                    ::atomicAdd(&laplace(fv[v], i), d[i]);
+                    ::atomicAdd(&laplace(fv[v1], i), -d[i]);
+                }
+            }
+        }
+
+        if constexpr (with_weights) {
+            const EdgeIterator fe =
+                fe_query.template get_iterator<EdgeIterator>(fh.local_id());
+            for (int e = 0; e < 3; ++e) {
+                ::atomicAdd(&cotan_weight(fe[e]), T(0.5) * cot[(e + 2) % 3]);
+            }
+        }
+    };
+
+    Query<blockThreads> query(context);
+    query.dispatch<Op::FV>(block, shrd_alloc, geom_lambda);
+}
+}  // namespace detail
+
+/**
+ * @brief compute the requested differential-geometry quantities of a triangle
+ * mesh with a single pass over the faces followed by a (cheap) per-vertex
+ * pass that normalizes the accumulated sums. Since the quantities are selected
+ * at compile time, the triangle geometry (lengths, angles, cotangents and face
+ * normal) is computed once and shared by all of them, and the code for the
+ * ones that are not requested is compiled out. The attributes are created
+ * with the names "geomNormal", "geomVoronoiArea",
+ * "geomAngleDefect", "geomMeanCurvature" and "geomCotanWeight" and should be
+ * removed by the caller once they are not needed
+ * @param rx the input mesh
+ * @param coords the vertex coordinates
+ * @param location where the output attributes are allocated. The quantities
+ * are always computed on the device and moved to the host if location
+ * includes HOST
+ * @return the attributes of the requested quantities
+ */
+template <geometryT quantities, typename T, uint32_t blockThreads = 256>
+GeometryAttributes<T> compute_geometry(
+    RXMeshStatic&             rx,
+    const VertexAttribute<T>& coords,
+    const locationT           location = DEVICE)
+{
+    static_assert(quantities != GEOM_NONE,
+                  "compute_geometry() no quantity is requested");
+
+    constexpr bool with_normal  = quantities & GEOM_NORMAL;
+    constexpr bool with_mean    = quantities & GEOM_MEAN_CURVATURE;
+    constexpr bool with_area    = (quantities & GEOM_VORONOI_AREA) || with_mean;
+    constexpr bool with_defect  = quantities & GEOM_ANGLE_DEFECT;
+    constexpr bool with_weights = quantities & GEOM_COTAN_WEIGHT;
+
+    const locationT loc = location | DEVICE;
+
+    GeometryAttributes<T> ret;
+
+    VertexAttribute<T> normal, voronoi_area, angle_defect, mean_curvature;
+    VertexAttribute<T> laplace;
+    EdgeAttribute<T>   cotan_weight;
+
+    if constexpr (with_normal) {
+        ret.normal = rx.add_vertex_attribute<T>("geomNormal", 3, loc);
+        ret.normal->reset(0, DEVICE);
+        normal = *ret.normal;
+    }
+    if constexpr (with_area) {
+        ret.voronoi_area =
+            rx.add_vertex_attribute<T>("geomVoronoiArea", 1, loc);
+        ret.voronoi_area->reset(0, DEVICE);
+        voronoi_area = *ret.voronoi_area;
+    }
+    if constexpr (with_defect) {
+        ret.angle_defect =
+            rx.add_vertex_attribute<T>("geomAngleDefect", 1, loc);
+        ret.angle_defect->reset(T(2) * T(3.14159265358979323846), DEVICE);
+        angle_defect = *ret.angle_defect;
+    }
+    if constexpr (with_weights) {
+        ret.cotan_weight =
+            rx.add_edge_attribute<T>("geomCotanWeight", 1, loc);
+        ret.cotan_weight->reset(0, DEVICE);
+        cotan_weight = *ret.cotan_weight;
+    }
+    std::shared_ptr<VertexAttribute<T>> laplace_ptr;
+    if constexpr (with_mean) {
+        ret.mean_curvature =
+            rx.add_vertex_attribute<T>("geomMeanCurvature", 1, loc);
+        mean_curvature = *ret.mean_curvature;
+
+        laplace_ptr = rx.add_vertex_attribute<T>("geomLaplace", 3, DEVICE);
+        laplace_ptr->reset(0, DEVICE);
+        laplace = *laplace_ptr;
+    }
+
+    // the cotan weights need a second (FE) query in the same kernel
+    std::vector<Op> ops = {Op::FV};
+    if constexpr (with_weights) {
+        ops.push_back(Op::FE);
+    }
+
+    LaunchBox<blockThreads> launch_box;
+    rx.prepare_launch_box(
+        ops,
+        launch_box,
+        (void*)detail::fused_face_geometry<quantities, T, blockThreads>,
+        false,
+        false,
+        with_weights);
+
+    detail::fused_face_geometry<quantities, T, blockThreads>
+        <<<launch_box.blocks,
+           launch_box.num_threads,
+           launch_box.smem_bytes_dyn>>>(rx.get_context(),
+                                        coords,
+                                        normal,
+                                        voronoi_area,
+                                        angle_defect,
+                                        cotan_weight,
+                                        laplace);
+
+    if constexpr (with_normal || with_mean) {
+        rx.for_each_vertex(
+            DEVICE, [=] __device__(const VertexHandle& vh) mutable {
+                if constexpr (with_normal) {
+                    const vec3<T> n =
+                        glm::normalize(normal.template to_glm<3>(vh));
+                    normal.from_glm(vh, n);
+                }
+                if constexpr (with_mean) {
+                    const T a = voronoi_area(vh);
+                    const T h = glm::length(laplace.template to_glm<3>(vh));
+                    mean_curvature(vh) = (a > T(0)) ? h / (T(2) * a) : T(0);
+                }
+            });
+    }
+
+    if constexpr (with_mean) {
+        CUDA_ERROR(cudaDeviceSynchronize());
+        rx.remove_attribute("geomLaplace");
+    }
+
+    if ((location & HOST) == HOST) {
+        if constexpr (with_normal) {
+            ret.normal->move(DEVICE, HOST);
+        }
+        if constexpr (with_area) {
+            ret.voronoi_area->move(DEVICE, HOST);
+        }
+        if constexpr (with_defect) {
+            ret.angle_defect->move(DEVICE, HOST);
+        }
+        if constexpr (with_weights) {
+            ret.cotan_weight->move(DEVICE, HOST);
+        }
+        if constexpr (with_mean) {
+            ret.mean_curvature->move(DEVICE, HOST);
+        }
+    }
+
+    return ret;
+}
+
+}  // namespace rxmesh
@@ -491,6 +491,107 @@ struct FaceHandle
 };
 
 
+/**
+ * @brief cell (tetrahedron) identifier of a volume mesh (see RXMeshVolume).
+ * It is a unique handle for each cell equipped with operator==. It can be
+ * used to access cell attributes
+ */
+struct CellHandle
+{
+    using LocalT = LocalCellT;
+
+    /**
+     * @brief Default constructor
+     */
+    constexpr __device__ __host__ CellHandle() : m_handle(INVALID64)
+    {
+    }
+
+    /**
+     * @brief Constructor with known (packed) handle
+     */
+    explicit constexpr __device__ __host__ CellHandle(uint64_t handle)
+        : m_handle(handle)
+    {
+    }
+
+    /**
+     * @brief Constructor meant to be used internally by RXMeshVolume
+     * @param patch_id the patch where the cell belongs
+     * @param cell_local_id the cell local index within the patch
+     */
+    constexpr __device__ __host__ CellHandle(uint32_t   patch_id,
+                                             LocalCellT cell_local_id)
+        : m_handle(detail::unique_id(cell_local_id.id, patch_id))
+    {
+    }
+
+    /**
+     * @brief Operator ==
+     */
+    constexpr __device__ __host__ __inline__ bool operator==(
+        const CellHandle& rhs) const
+    {
+        return m_handle == rhs.m_handle;
+    }
+
+    /**
+     * @brief Operator !=
+     */
+    constexpr __device__ __host__ __inline__ bool operator!=(
+        const CellHandle& rhs) const
+    {
+        return !(*this == rhs);
+    }
+
+    /**
+     * @brief Check if the cell is valid i.e., has been initialized by
+     * RXMeshVolume
+     */
+    constexpr __device__ __host__ __inline__ bool is_valid() const
+    {
+        return m_handle != INVALID64;
+    }
+
+    /**
+     * @brief The unique identifier that represents the cell
+     */
+    constexpr __device__ __host__ __inline__ uint64_t unique_id() const
+    {
+        return m_handle;
+    }
+
+    /**
+     * @brief Unpack the handle to its patch id and cell local index within
+     * the patch
+     */
+    constexpr __device__ __host__ __inline__ std::pair<uint32_t, uint16_t>
+                         unpack() const
+    {
+        return detail::unpack(m_handle);
+    }
+
+    /**
+     * @brief return the patch id of this handle
+     */
+    constexpr __device__ __host__ __inline__ uint32_t patch_id() const
+    {
+        return unpack().first;
+    }
+
+    /**
+     * @brief return the local index stored in this handle
+     */
+    constexpr __device__ __host__ __inline__ uint16_t local_id() const
+    {
+        return unpack().second;
+    }
+
+   protected:
+    uint64_t m_handle;
+};
+
+
 /**
  * @brief Helper struct to get the input handle type based on a query operation
  */
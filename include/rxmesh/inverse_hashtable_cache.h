@@ -0,0 +1,110 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "rxmesh/lp_hashtable.cuh"
+#include "rxmesh/util/macros.h"
+
+namespace rxmesh {
+
+/**
+ * @brief The inverted LP hashtables (see InverseLPHashTable) that
+ * CavityManager builds in shared memory for every patch it processes, stored
+ * in global memory such that a patch that is processed again without being
+ * modified (e.g., because it failed to lock its neighbors) loads its inverted
+ * tables instead of re-building them. Every patch has a version that is bumped
+ * whenever the patch is marked dirty and the cached tables of a patch are
+ * valid only if they were built from its current version. This is managed by
+ * RXMeshDynamic::enable_inverse_hashtable_cache()
+ */
+struct InverseHashtableCache
+{
+    __host__ __device__ InverseHashtableCache()
+        : m_table(nullptr),
+          m_version(nullptr),
+          m_cached_version(nullptr),
+          m_capacity(nullptr),
+          m_slot_size(0),
+          m_num_patches(0)
+    {
+    }
+
+    /**
+     * @brief check if the cached tables of patch p are valid and were built
+     * with the hashtable capacities vertex/edge/face_cap
+     */
+    __device__ __inline__ bool is_valid(const uint32_t p,
+                                        const uint16_t vertex_cap,
+                                        const uint16_t edge_cap,
+                                        const uint16_t face_cap) const
+    {
+        return m_table != nullptr && p < m_num_patches &&
+               m_cached_version[p] == m_version[p] &&
+               m_capacity[3 * p + 0] == vertex_cap &&
+               m_capacity[3 * p + 1] == edge_cap &&
+               m_capacity[3 * p + 2] == face_cap;
+    }
+
+    /**
+     * @brief check if a table with capacity cap (and the stash) fits in the
+     * cache
+     */
+    __device__ __inline__ bool fits(const uint16_t cap) const
+    {
+        return m_table != nullptr && cap + stash_size <= m_slot_size;
+    }
+
+    /**
+     * @brief the cached table of patch p and element type k (0 for vertices,
+     * 1 for edges, and 2 for faces). The stash follows the table capacity
+     */
+    __device__ __inline__ LPPair* get_table(const uint32_t p, const uint32_t k)
+    {
+        return m_table + (size_t(3) * p + k) * m_slot_size;
+    }
+
+    /**
+     * @brief invalidate the cached tables of patch p e.g., after it has been
+     * marked dirty
+     */
+    __device__ __inline__ void bump_version(const uint32_t p) const
+    {
+#ifdef __CUDA_ARCH__
+        if (m_version != nullptr && p < m_num_patches) {
+            ::atomicAdd(m_version + p, 1u);
+        }
+#endif
+    }
+
+    /**
+     * @brief invalidate the cached tables of all patches e.g., after the
+     * patches have been changed on the host
+     */
+    __host__ void invalidate_all(cudaStream_t stream = NULL)
+    {
+        if (m_cached_version != nullptr) {
+            CUDA_ERROR(cudaMemsetAsync(m_cached_version,
+                                       0xFF,
+                                       m_num_patches * sizeof(uint32_t),
+                                       stream));
+        }
+    }
+
+    static constexpr uint32_t stash_size = LPHashTable::stash_size;
+
+    // one slot of m_slot_size pairs per patch and element type
+    LPPair* m_table;
+
+    // the current version of every patch
+    uint32_t* m_version;
+
+    // the version of the patch the cached tables were built from
+    uint32_t* m_cached_version;
+
+    // the hashtable capacity of every cached table (3 per patch)
+    uint16_t* m_capacity;
+
+    uint32_t m_slot_size;
+    uint32_t m_num_patches;
+};
+}  // namespace rxmesh
@@ -45,6 +45,44 @@ struct PairIterator
     HandleT h1;
 };
 
+/**
+ * @brief iterator over a fixed number (N) of handles, e.g., the four vertices
+ * of a vertex-face or edge-edge contact pair
+ */
+template <typename HandleT, int N>
+struct StencilIterator
+{
+    using LocalT = typename HandleT::LocalT;
+    using Handle = HandleT;
+
+    __device__ __host__ __inline__ StencilIterator()
+    {
+    }
+
+    StencilIterator(const StencilIterator& orig) = default;
+
+
+    __device__ __host__ __inline__ int size() const
+    {
+        return N;
+    }
+
+    __device__ __host__ __inline__ HandleT operator[](const int i) const
+    {
+        assert(i < size());
+        return m_handles[i];
+    }
+
+    __device__ __host__ __inline__ HandleT& operator[](const int i)
+    {
+        assert(i < size());
+        return m_handles[i];
+    }
+
+   private:
+    HandleT m_handles[N];
+};
+
 
 template <typename HandleT>
 struct Iterator
@@ -61,6 +99,7 @@ struct Iterator
           m_output_lp_hashtable(LPHashTable()),
           m_s_table(nullptr),
           m_patch_stash(PatchStash()),
+          m_owner_table(nullptr),
           m_begin(0),
           m_end(0),
           m_current(0),
@@ -79,6 +118,7 @@ struct Iterator
           m_output_lp_hashtable(LPHashTable()),
           m_s_table(nullptr),
           m_patch_stash(PatchStash()),
+          m_owner_table(nullptr),
           m_begin(0),
           m_end(0),
           m_current(0),
@@ -96,7 +136,8 @@ struct Iterator
                                    const LPHashTable& output_lp_hashtable,
                                    const LPPair*      s_table,
                                    const PatchStash   patch_stash,
-                                   int                shift = 0)
+                                   int                shift       = 0,
+                                   const uint64_t*    owner_table = nullptr)
         : m_context(context),
           m_local_id(local_id),
           m_patch_output(patch_output),
@@ -105,6 +146,7 @@ struct Iterator
           m_output_lp_hashtable(output_lp_hashtable),
           m_s_table(s_table),
           m_patch_stash(patch_stash),
+          m_owner_table(owner_table),
           m_shift(shift)
     {
         set(local_id, offset_size, patch_offset);
@@ -126,24 +168,62 @@ struct Iterator
         assert(m_patch_output);
         assert(i + m_begin < m_end);
         uint16_t lid = (m_patch_output[m_begin + i].id) >> m_shift;
-        if (lid == INVALID16) {
-            return HandleT();
-        }
+        return decode(lid);
+    }
 
-        if (detail::is_owned(lid, m_output_owned_bitmask)) {
-            HandleT ret(m_patch_id, lid);
-            return ret;
-        } else {
-            assert(m_s_table);
-            LPPair lp = m_output_lp_hashtable.find(lid, m_s_table);
-            if (lp.is_sentinel()) {
-                return HandleT();
-            }
-            return HandleT(m_patch_stash.get_patch(lp),
-                           {lp.local_id_in_owner_patch()});
+    /**
+     * @brief resolve the handles of (up to) N elements starting from the
+     * begin-th element into out. The local indices of all N elements are
+     * loaded first and then decoded (through the hashtable for the not-owned
+     * elements) such that the loads are independent of each other and could
+     * be overlapped. Entries past the end of the iterator are invalid handles.
+     * Iterators with more than N elements can be resolved in chunks of N
+     * @return the number of valid entries i.e., min(N, size() - begin)
+     */
+    template <int N>
+    __device__ __inline__ uint16_t resolve(HandleT (&out)[N],
+                                           const uint16_t begin = 0) const
+    {
+        uint16_t lid[N];
+#pragma unroll
+        for (int i = 0; i < N; ++i) {
+            lid[i] = local(begin + i);
+        }
+#pragma unroll
+        for (int i = 0; i < N; ++i) {
+            out[i] = decode(lid[i]);
+        }
+        if (begin >= size()) {
+            return 0;
+        }
+        const uint16_t rem = size() - begin;
+        return (rem < N) ? rem : uint16_t(N);
+    }
 
-            // return m_context.get_owner_handle(ret, nullptr, m_s_table);
+    /**
+     * @brief load the first C components of the attribute attr of (up to) N
+     * elements starting from the begin-th element into out, e.g., the
+     * positions of the one-ring of a vertex in a VV query. The handles are
+     * resolved first (see resolve()) and then all attribute values are loaded
+     * such that the loads could be overlapped instead of issuing one
+     * dependent load (and hashtable lookup) per neighbor. Entries past the end
+     * of the iterator are set to zero
+     * @return the number of valid entries i.e., min(N, size() - begin)
+     */
+    template <int N, typename T, int C, typename AttrT>
+    __device__ __inline__ uint16_t gather(const AttrT& attr,
+                                          vec<T, C> (&out)[N],
+                                          const uint16_t begin = 0) const
+    {
+        HandleT        h[N];
+        const uint16_t num = resolve(h, begin);
+#pragma unroll
+        for (int i = 0; i < N; ++i) {
+            out[i] = h[i].is_valid() ?
+                         vec<T, C>(attr.template to_glm<C>(h[i])) :
+                         vec<T, C>(T(0));
         }
+        return num;
     }
 
     __device__ __inline__ uint16_t local(const uint16_t i) const
@@ -157,6 +237,21 @@ struct Iterator
         return lid;
     }
 
+    /**
+     * @brief the relative orientation of the i-th element for the outputs
+     * that store it i.e., for FE it is 1 if the i-th edge is traversed from
+     * its second vertex to its first vertex (as returned by EV) when going
+     * around the face and 0 otherwise. It is 0 for all other queries
+     */
+    __device__ __inline__ flag_t is_flipped(const uint16_t i) const
+    {
+        if (m_shift == 0 || i + m_begin >= m_end) {
+            return 0;
+        }
+        assert(m_patch_output);
+        return (m_patch_output[m_begin + i].id) & 1;
+    }
+
     __device__ __inline__ HandleT back() const
     {
         return ((*this)[size() - 1]);
@@ -177,11 +272,41 @@ struct Iterator
     const LPHashTable m_output_lp_hashtable;
     const LPPair*     m_s_table;
     const PatchStash  m_patch_stash;
+    const uint64_t*   m_owner_table;
     uint16_t          m_begin;
     uint16_t          m_end;
     uint16_t          m_current;
     int               m_shift;
 
+    /**
+     * @brief the handle of the local index lid in the patch (i.e., the owner
+     * handle for not-owned elements)
+     */
+    __device__ __inline__ HandleT decode(const uint16_t lid) const
+    {
+        if (lid == INVALID16) {
+            return HandleT();
+        }
+
+        if (detail::is_owned(lid, m_output_owned_bitmask)) {
+            HandleT ret(m_patch_id, lid);
+            return ret;
+        } else if (m_owner_table != nullptr) {
+            const auto pl = detail::unpack(m_owner_table[lid]);
+            return HandleT(pl.first, {pl.second});
+        } else {
+            assert(m_s_table);
+            LPPair lp = m_output_lp_hashtable.find(lid, m_s_table);
+            if (lp.is_sentinel()) {
+                return HandleT();
+            }
+            return HandleT(m_patch_stash.get_patch(lp),
+                           {lp.local_id_in_owner_patch()});
+
+            // return m_context.get_owner_handle(ret, nullptr, m_s_table);
+        }
+    }
+
     __device__ void set(const uint16_t  local_id,
                         const uint32_t  offset_size,
                         const uint16_t* patch_offset)
@@ -0,0 +1,445 @@
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+#include <cub/device/device_scan.cuh>
+
+#include "rxmesh/context.h"
+#include "rxmesh/handle.h"
+#include "rxmesh/query.cuh"
+#include "rxmesh/rxmesh_static.h"
+#include "rxmesh/util/macros.h"
+
+namespace rxmesh {
+namespace detail {
+
+/**
+ * @brief count (if value is nullptr) or write the 1-ring of every vertex
+ * using linear vertex ids. Also record the handle of every linear id
+ */
+template <uint32_t blockThreads>
+__global__ static void k_ring_first_ring(const Context   context,
+                                         uint32_t*       count,
+                                         const uint32_t* offset,
+                                         uint32_t*       value,
+                                         VertexHandle*   handles)
+{
+    auto ring = [&](VertexHandle vh, VertexIterator& iter) {
+        const uint32_t v = context.linear_id(vh);
+        if (value == nullptr) {
+            count[v] = iter.size();
+        } else {
+            handles[v] = vh;
+            for (uint32_t i = 0; i < iter.size(); ++i) {
+                value[offset[v] + i] = context.linear_id(iter[i]);
+            }
+        }
+    };
+
+    auto block = cooperative_groups::this_thread_block();
+
+    Query<blockThreads> query(context);
+    ShmemAllocator      shrd_alloc;
+    query.dispatch<Op::VV>(block, shrd_alloc, ring);
+}
+
+/**
+ * @brief check if w is in value[begin, end)
+ */
+__device__ __inline__ bool k_ring_contains(const uint32_t* value,
+                                           const uint32_t  begin,
+                                           const uint32_t  end,
+                                           const uint32_t  w)
+{
+    for (uint32_t i = begin; i < end; ++i) {
+        if (value[i] == w) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief add one more ring to the current num_rings-ring of every vertex. The
+ * new ring of v is made of the 1-ring of the vertices of the last ring of v
+ * that are not v itself or in any of the previous rings. If new_value is
+ * nullptr, only the number of new vertices is computed (in count). Otherwise,
+ * the current rings are copied to the new layout (starting at new_start)
+ * followed by the new ring
+ */
+template <uint32_t blockThreads>
+__global__ static void k_ring_expand(const uint32_t  num_vertices,
+                                     const uint32_t  num_rings,
+                                     const uint32_t* ring1_offset,
+                                     const uint32_t* ring1_value,
+                                     const uint32_t* offset,
+                                     const uint32_t* value,
+                                     uint32_t*       count,
+                                     const uint32_t* new_start,
+                                     uint32_t*       new_offset,
+                                     uint32_t*       new_value)
+{
+    const uint32_t L = num_rings;
+
+    for (uint32_t v = blockIdx.x * blockThreads + threadIdx.x; v < num_vertices;
+         v += gridDim.x * blockThreads) {
+
+        const uint32_t begin          = offset[v * L];
+        const uint32_t end            = offset[v * L + L];
+        const uint32_t frontier_begin = offset[v * L + L - 1];
+
+        uint32_t c = 0;
+
+        uint32_t out = 0;
+        if (new_value != nullptr) {
+            out = new_start[v];
+            for (uint32_t j = 0; j < L; ++j) {
+                new_offset[v * (L + 1) + j] = out + offset[v * L + j] - begin;
+            }
+            for (uint32_t i = begin; i < end; ++i) {
+                new_value[out++] = value[i];
+            }
+            new_offset[v * (L + 1) + L] = out;
+        }
+        const uint32_t ring_begin = out;
+
+        for (uint32_t fu = frontier_begin; fu < end; ++fu) {
+            const uint32_t u = value[fu];
+            for (uint32_t fw = ring1_offset[u]; fw < ring1_offset[u + 1];
+                 ++fw) {
+                const uint32_t w = ring1_value[fw];
+                if (w == v || k_ring_contains(value, begin, end, w)) {
+                    continue;
+                }
+
+                if (new_value != nullptr) {
+                    if (!k_ring_contains(new_value, ring_begin, out, w)) {
+                        new_value[out++] = w;
+                    }
+                    continue;
+                }
+
+                // only count the first occurrence of w among the candidates
+                bool first = true;
+                for (uint32_t fu2 = frontier_begin; fu2 <= fu && first; ++fu2) {
+                    const uint32_t u2 = value[fu2];
+                    const uint32_t e2 =
+                        (fu2 == fu) ? fw : ring1_offset[u2 + 1];
+                    first = !k_ring_contains(
+                        ring1_value, ring1_offset[u2], e2, w);
+                }
+                if (first) {
+                    c++;
+                }
+            }
+        }
+
+        if (new_value == nullptr) {
+            count[v] = (end - begin) + c;
+        } else if (v == num_vertices - 1) {
+            new_offset[num_vertices * (L + 1)] = out;
+        }
+    }
+}
+
+/**
+ * @brief convert the linear ids to vertex handles
+ */
+template <uint32_t blockThreads>
+__global__ static void k_ring_to_handles(const uint32_t      size,
+                                         const uint32_t*     value,
+                                         const VertexHandle* handles,
+                                         VertexHandle*       output)
+{
+    for (uint32_t i = blockIdx.x * blockThreads + threadIdx.x; i < size;
+         i += gridDim.x * blockThreads) {
+        output[i] = handles[value[i]];
+    }
+}
+}  // namespace detail
+
+/**
+ * @brief Precomputed k-ring neighborhood of every vertex of a static mesh. The
+ * k-ring of a vertex v contains all vertices within k edges from v (excluding
+ * v itself) grouped by ring i.e., the 1-ring vertices come first, followed by
+ * the 2-ring vertices, and so on. The neighborhood is gathered across the
+ * patch boundaries. The output is stored in a compact (CSR-like) format on the
+ * device where every vertex has k+1 offsets shared with the next vertex.
+ * KRing is trivially copyable and so it could be passed (by value) to a kernel
+ * or captured by a device lambda. The memory should be released explicitly by
+ * calling release()
+ */
+class KRing
+{
+   public:
+    KRing() = default;
+
+    /**
+     * @brief build the k-ring of every vertex in rx
+     * @param rx the input static mesh
+     * @param k the ring depth (>= 1)
+     */
+    KRing(const RXMeshStatic& rx, const uint32_t k)
+        : m_context(rx.get_context()),
+          m_num_vertices(rx.get_num_vertices()),
+          m_num_rings(k),
+          m_size(0),
+          m_d_offset(nullptr),
+          m_d_value(nullptr)
+    {
+        if (k == 0) {
+            RXMESH_ERROR("KRing::KRing() the ring depth should be at least 1");
+            exit(EXIT_FAILURE);
+        }
+
+        constexpr uint32_t blockThreads = 256;
+
+        const uint32_t num_v = m_num_vertices;
+
+        // scan buffer with an extra element such that the total is written in
+        // the last element
+        const size_t scan_bytes = (num_v + 1) * sizeof(uint32_t);
+
+        uint32_t* d_count;
+        CUDA_ERROR(tracked_malloc((void**)&d_count,
+                                  scan_bytes,
+                                  MemoryCategory::Other));
+        CUDA_ERROR(cudaMemset(d_count, 0, scan_bytes));
+
+        uint32_t* d_start;
+        CUDA_ERROR(tracked_malloc((void**)&d_start,
+                                  scan_bytes,
+                                  MemoryCategory::Other));
+
+        void*  d_cub_temp_storage = nullptr;
+        size_t cub_temp_bytes     = 0;
+        cub::DeviceScan::ExclusiveSum(
+            d_cub_temp_storage, cub_temp_bytes, d_count, d_start, num_v + 1);
+        CUDA_ERROR(tracked_malloc((void**)&d_cub_temp_storage,
+                                  cub_temp_bytes,
+                                  MemoryCategory::Other));
+
+        auto exclusive_sum = [&]() {
+            cub::DeviceScan::ExclusiveSum(d_cub_temp_storage,
+                                          cub_temp_bytes,
+                                          d_count,
+                                          d_start,
+                                          num_v + 1);
+            uint32_t total = 0;
+            CUDA_ERROR(cudaMemcpy(&total,
+                                  d_start + num_v,
+                                  sizeof(uint32_t),
+                                  cudaMemcpyDeviceToHost));
+            return total;
+        };
+
+        // 1-ring
+        VertexHandle* d_handles;
+        CUDA_ERROR(tracked_malloc((void**)&d_handles,
+                                  num_v * sizeof(VertexHandle),
+                                  MemoryCategory::Other));
+
+        LaunchBox<blockThreads> lb;
+        rx.prepare_launch_box(
+            {Op::VV}, lb, (void*)detail::k_ring_first_ring<blockThreads>);
+
+        detail::k_ring_first_ring<blockThreads>
+            <<<lb.blocks, lb.num_threads, lb.smem_bytes_dyn>>>(
+                m_context, d_count, nullptr, nullptr, nullptr);
+
+        uint32_t total = exclusive_sum();
+
+        uint32_t* d_ring1_offset = d_start;
+        uint32_t* d_ring1_value;
+        CUDA_ERROR(tracked_malloc((void**)&d_ring1_value,
+                                  total * sizeof(uint32_t),
+                                  MemoryCategory::Other));
+
+        detail::k_ring_first_ring<blockThreads>
+            <<<lb.blocks, lb.num_threads, lb.smem_bytes_dyn>>>(
+                m_context, nullptr, d_ring1_offset, d_ring1_value, d_handles);
+
+        // the 1-ring is the initial 1-ring layout
+        uint32_t* d_offset = d_ring1_offset;
+        uint32_t* d_value  = d_ring1_value;
+        CUDA_ERROR(tracked_malloc((void**)&d_start,
+                                  scan_bytes,
+                                  MemoryCategory::Other));
+
+        const uint32_t blocks = DIVIDE_UP(num_v, blockThreads);
+
+        for (uint32_t r = 1; r < k; ++r) {
+            detail::k_ring_expand<blockThreads>
+                <<<blocks, blockThreads>>>(num_v,
+                                           r,
+                                           d_ring1_offset,
+                                           d_ring1_value,
+                                           d_offset,
+                                           d_value,
+                                           d_count,
+                                           nullptr,
+                                           nullptr,
+                                           nullptr);
+
+            total = exclusive_sum();
+
+            uint32_t *d_new_offset, *d_new_value;
+            CUDA_ERROR(tracked_malloc((void**)&d_new_offset,
+                                      (num_v * (r + 1) + 1) * sizeof(uint32_t),
+                                      MemoryCategory::Other));
+            CUDA_ERROR(tracked_malloc((void**)&d_new_value,
+                                      total * sizeof(uint32_t),
+                                      MemoryCategory::Other));
+
+            detail::k_ring_expand<blockThreads>
+                <<<blocks, blockThreads>>>(num_v,
+                                           r,
+                                           d_ring1_offset,
+                                           d_ring1_value,
+                                           d_offset,
+                                           d_value,
+                                           nullptr,
+                                           d_start,
+                                           d_new_offset,
+                                           d_new_value);
+
+            if (d_offset != d_ring1_offset) {
+                GPU_FREE(d_offset);
+                GPU_FREE(d_value);
+            }
+            d_offset = d_new_offset;
+            d_value  = d_new_value;
+        }
+
+        m_size = total;
+
+        CUDA_ERROR(tracked_malloc((void**)&m_d_value,
+                                  m_size * sizeof(VertexHandle),
+                                  MemoryCategory::Other));
+
+        detail::k_ring_to_handles<blockThreads>
+            <<<DIVIDE_UP(m_size, blockThreads), blockThreads>>>(
+                m_size, d_value, d_handles, m_d_value);
+
+        if (d_offset == d_ring1_offset) {
+            // k == 1 so the 1-ring offset is the output offset
+            m_d_offset = d_ring1_offset;
+        } else {
+            m_d_offset = d_offset;
+            GPU_FREE(d_ring1_offset);
+            GPU_FREE(d_value);
+        }
+        CUDA_ERROR(cudaDeviceSynchronize());
+
+        GPU_FREE(d_ring1_value);
+        GPU_FREE(d_handles);
+        GPU_FREE(d_count);
+        GPU_FREE(d_start);
+        GPU_FREE(d_cub_temp_storage);
+    }
+
+    /**
+     * @brief the ring depth
+     */
+    __host__ __device__ __inline__ uint32_t get_num_rings() const
+    {
+        return m_num_rings;
+    }
+
+    /**
+     * @brief the total number of vertices in the k-ring of all vertices
+     */
+    __host__ __device__ __inline__ uint32_t get_size() const
+    {
+        return m_size;
+    }
+
+    /**
+     * @brief number of vertices in the k-ring of vh
+     */
+    __device__ __inline__ uint32_t size(const VertexHandle& vh) const
+    {
+        const uint32_t v = m_context.linear_id(vh);
+        return m_d_offset[(v + 1) * m_num_rings] - m_d_offset[v * m_num_rings];
+    }
+
+    /**
+     * @brief number of vertices in the ring-th ring (1 <= ring <= k) of vh
+     * i.e., the vertices that are exactly ring edges away from vh
+     */
+    __device__ __inline__ uint32_t size(const VertexHandle& vh,
+                                        const uint32_t      ring) const
+    {
+        assert(ring >= 1 && ring <= m_num_rings);
+        const uint32_t v = m_context.linear_id(vh);
+        return m_d_offset[v * m_num_rings + ring] -
+               m_d_offset[v * m_num_rings + ring - 1];
+    }
+
+    /**
+     * @brief the i-th vertex in the k-ring of vh
+     */
+    __device__ __inline__ VertexHandle operator()(const VertexHandle& vh,
+                                                  const uint32_t      i) const
+    {
+        const uint32_t v = m_context.linear_id(vh);
+        assert(i < m_d_offset[(v + 1) * m_num_rings] -
+                       m_d_offset[v * m_num_rings]);
+        return m_d_value[m_d_offset[v * m_num_rings] + i];
+    }
+
+    /**
+     * @brief the i-th vertex in the ring-th ring (1 <= ring <= k) of vh
+     */
+    __device__ __inline__ VertexHandle operator()(const VertexHandle& vh,
+                                                  const uint32_t      ring,
+                                                  const uint32_t      i) const
+    {
+        assert(ring >= 1 && ring <= m_num_rings);
+        const uint32_t v = m_context.linear_id(vh);
+        assert(i < m_d_offset[v * m_num_rings + ring] -
+                       m_d_offset[v * m_num_rings + ring - 1]);
+        return m_d_value[m_d_offset[v * m_num_rings + ring - 1] + i];
+    }
+
+    /**
+     * @brief copy the k-ring to the host. offset has k entries per vertex
+     * (indexed by the vertex linear id) plus one where the ring-th ring of
+     * vertex v is value[offset[v*k + ring - 1], offset[v*k + ring])
+     */
+    void to_host(std::vector<uint32_t>&     offset,
+                 std::vector<VertexHandle>& value) const
+    {
+        offset.resize(m_num_vertices * m_num_rings + 1);
+        value.resize(m_size);
+        CUDA_ERROR(cudaMemcpy(offset.data(),
+                              m_d_offset,
+                              offset.size() * sizeof(uint32_t),
+                              cudaMemcpyDeviceToHost));
+        CUDA_ERROR(cudaMemcpy(value.data(),
+                              m_d_value,
+                              value.size() * sizeof(VertexHandle),
+                              cudaMemcpyDeviceToHost));
+    }
+
+    /**
+     * @brief release the device memory
+     */
+    void release()
+    {
+        GPU_FREE(m_d_offset);
+        GPU_FREE(m_d_value);
+        m_size = 0;
+    }
+
+   private:
+    Context       m_context;
+    uint32_t      m_num_vertices = 0;
+    uint32_t      m_num_rings    = 0;
+    uint32_t      m_size         = 0;
+    uint32_t*     m_d_offset     = nullptr;
+    VertexHandle* m_d_value      = nullptr;
+};
+
+}  // namespace rxmesh
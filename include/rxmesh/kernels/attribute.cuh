@@ -1,5 +1,6 @@
 #pragma once
 #include <cub/block/block_reduce.cuh>
+#include "rxmesh/types.h"
 #include "rxmesh/util/macros.h"
 
 #include "rxmesh/arg_ops.h"
@@ -40,30 +41,44 @@ __device__ __forceinline__ void cub_block_reduce(const T     thread_val,
     }
 }
 
+/**
+ * @brief the patch reduced by this block i.e., blockIdx.x or, if patch_subset
+ * is not nullptr, the blockIdx.x-th patch in the subset (see
+ * ReduceHandle::set_patch_subset()). The block output is always written at
+ * blockIdx.x such that the second stage reduces one value per block
+ */
+__device__ __forceinline__ uint32_t
+subset_block_patch(const uint32_t* patch_subset)
+{
+    return (patch_subset == nullptr) ? blockIdx.x : patch_subset[blockIdx.x];
+}
+
 template <class T, uint32_t blockSize, typename HandleT>
 __launch_bounds__(blockSize) __global__
     void norm2_kernel(const Attribute<T, HandleT> X,
                       const uint32_t              num_patches,
                       const uint32_t              num_attributes,
-                      T*                          d_block_output,
-                      uint32_t                    attribute_id)
+                      compute_t<T>*               d_block_output,
+                      uint32_t                    attribute_id,
+                      const uint32_t*             patch_subset = nullptr)
 {
-    using LocalT = typename HandleT::LocalT;
+    using LocalT   = typename HandleT::LocalT;
+    using ComputeT = compute_t<T>;
 
-    uint32_t p_id = blockIdx.x;
+    const uint32_t p_id = subset_block_patch(patch_subset);
     if (p_id < num_patches) {
         const uint16_t element_per_patch = X.size(p_id);
-        T              thread_val        = 0;
+        ComputeT       thread_val        = 0;
         for (uint16_t i = threadIdx.x; i < element_per_patch; i += blockSize) {
             if (X.get_patch_info(p_id).is_owned(LocalT(i)) &&
                 !X.get_patch_info(p_id).is_deleted(LocalT(i))) {
 
                 if (attribute_id != INVALID32) {
-                    const T val = X(p_id, i, attribute_id);
+                    const ComputeT val = X(p_id, i, attribute_id);
                     thread_val += val * val;
                 } else {
                     for (uint32_t j = 0; j < num_attributes; ++j) {
-                        const T val = X(p_id, i, j);
+                        const ComputeT val = X(p_id, i, j);
                         thread_val += val * val;
                     }
                 }
@@ -81,28 +96,31 @@ __launch_bounds__(blockSize) __global__
                     const Attribute<T, HandleT> Y,
                     const uint32_t              num_patches,
                     const uint32_t              num_attributes,
-                    T*                          d_block_output,
-                    uint32_t                    attribute_id)
+                    compute_t<T>*               d_block_output,
+                    uint32_t                    attribute_id,
+                    const uint32_t*             patch_subset = nullptr)
 {
-    using LocalT = typename HandleT::LocalT;
+    using LocalT   = typename HandleT::LocalT;
+    using ComputeT = compute_t<T>;
 
     assert(X.get_num_attributes() == Y.get_num_attributes());
 
-    uint32_t p_id = blockIdx.x;
+    const uint32_t p_id = subset_block_patch(patch_subset);
     if (p_id < num_patches) {
         const uint16_t element_per_patch = X.size(p_id);
-        T              thread_val        = 0;
+        ComputeT       thread_val        = 0;
         for (uint16_t i = threadIdx.x; i < element_per_patch; i += blockSize) {
 
             if (X.get_patch_info(p_id).is_owned(LocalT(i)) &&
                 !X.get_patch_info(p_id).is_deleted(LocalT(i))) {
 
                 if (attribute_id != INVALID32) {
-                    thread_val +=
-                        X(p_id, i, attribute_id) * Y(p_id, i, attribute_id);
+                    thread_val += ComputeT(X(p_id, i, attribute_id)) *
+                                  ComputeT(Y(p_id, i, attribute_id));
                 } else {
                     for (uint32_t j = 0; j < num_attributes; ++j) {
-                        thread_val += X(p_id, i, j) * Y(p_id, i, j);
+                        thread_val +=
+                            ComputeT(X(p_id, i, j)) * ComputeT(Y(p_id, i, j));
                     }
                 }
             }
@@ -114,19 +132,22 @@ __launch_bounds__(blockSize) __global__
 
 template <class T, uint32_t blockSize, typename HandleT, typename Operation>
 __launch_bounds__(blockSize) __global__
-    void arg_minmax_kernel(const Attribute<T, HandleT> X,
-                           uint32_t                    attribute_id,
-                           Operation                   reduction_op,
-                           const uint32_t              num_patches,
-                           const uint32_t              num_attributes,
-                           KeyValuePair<HandleT, T>*   d_block_output)
+    void arg_minmax_kernel(
+        const Attribute<T, HandleT>          X,
+        uint32_t                             attribute_id,
+        Operation                            reduction_op,
+        const uint32_t                       num_patches,
+        const uint32_t                       num_attributes,
+        KeyValuePair<HandleT, compute_t<T>>* d_block_output,
+        const uint32_t*                      patch_subset = nullptr)
 {
-    using LocalT = typename HandleT::LocalT;
+    using LocalT    = typename HandleT::LocalT;
+    using KeyValueT = KeyValuePair<HandleT, compute_t<T>>;
 
-    uint32_t p_id = blockIdx.x;
+    const uint32_t p_id = subset_block_patch(patch_subset);
     if (p_id < num_patches) {
-        const uint16_t           element_per_patch = X.size(p_id);
-        KeyValuePair<HandleT, T> thread_val;
+        const uint16_t element_per_patch = X.size(p_id);
+        KeyValueT      thread_val;
         thread_val.value = reduction_op.default_val();
         thread_val.key   = HandleT(p_id, threadIdx.x);
         for (uint16_t i = threadIdx.x; i < element_per_patch; i += blockSize) {
@@ -135,15 +156,13 @@ __launch_bounds__(blockSize) __global__
                 !X.get_patch_info(p_id).is_deleted(LocalT(i))) {
 
                 if (attribute_id != INVALID32) {
-                    HandleT                  handle(p_id, i);
-                    KeyValuePair<HandleT, T> current_pair(
-                        handle, X(p_id, i, attribute_id));
+                    HandleT   handle(p_id, i);
+                    KeyValueT current_pair(handle, X(p_id, i, attribute_id));
                     thread_val = reduction_op(thread_val, current_pair);
                 } else {
                     for (uint32_t j = 0; j < num_attributes; ++j) {
-                        HandleT                  handle(p_id, i);
-                        KeyValuePair<HandleT, T> current_pair(handle,
-                                                              X(p_id, i, j));
+                        HandleT   handle(p_id, i);
+                        KeyValueT current_pair(handle, X(p_id, i, j));
                         thread_val = reduction_op(thread_val, current_pair);
                     }
                 }
@@ -160,27 +179,29 @@ __launch_bounds__(blockSize) __global__
     void generic_reduce(const Attribute<T, HandleT> X,
                         const uint32_t              num_patches,
                         const uint32_t              num_attributes,
-                        T*                          d_block_output,
+                        compute_t<T>*               d_block_output,
                         ReductionOp                 reduction_op,
-                        T                           init,
-                        uint32_t                    attribute_id)
+                        compute_t<T>                init,
+                        uint32_t                    attribute_id,
+                        const uint32_t*             patch_subset = nullptr)
 {
-    using LocalT = typename HandleT::LocalT;
+    using LocalT   = typename HandleT::LocalT;
+    using ComputeT = compute_t<T>;
 
-    uint32_t p_id = blockIdx.x;
+    const uint32_t p_id = subset_block_patch(patch_subset);
     if (p_id < num_patches) {
         const uint16_t element_per_patch = X.size(p_id);
-        T              thread_val        = init;
+        ComputeT       thread_val        = init;
         for (uint16_t i = threadIdx.x; i < element_per_patch; i += blockSize) {
             if (X.get_patch_info(p_id).is_owned(LocalT(i)) &&
                 !X.get_patch_info(p_id).is_deleted(LocalT(i))) {
                 if (attribute_id != INVALID32) {
-                    const T val = X(p_id, i, attribute_id);
-                    thread_val  = reduction_op(thread_val, val);
+                    const ComputeT val = X(p_id, i, attribute_id);
+                    thread_val         = reduction_op(thread_val, val);
                 } else {
                     for (uint32_t j = 0; j < num_attributes; ++j) {
-                        const T val = X(p_id, i, j);
-                        thread_val  = reduction_op(thread_val, val);
+                        const ComputeT val = X(p_id, i, j);
+                        thread_val         = reduction_op(thread_val, val);
                     }
                 }
             }
@@ -191,6 +212,89 @@ __launch_bounds__(blockSize) __global__
 }
 
 
+/**
+ * @brief sum X (all attributes or only attribute_id) and count the owned mesh
+ * elements per label where labels(h) in [0, num_labels) is the label of the
+ * mesh element h. Each block (patch) accumulates its partial sums in shared
+ * memory (if use_shmem) and then adds them to d_sum (and d_count if not
+ * nullptr) with one atomic per label. Elements with label >= num_labels are
+ * skipped. d_sum and d_count should be zero-initialized
+ */
+template <class T, uint32_t blockSize, typename HandleT>
+__launch_bounds__(blockSize) __global__
+    void label_sum_kernel(const Attribute<T, HandleT>        X,
+                          const Attribute<uint32_t, HandleT> labels,
+                          const uint32_t                     num_patches,
+                          const uint32_t                     num_attributes,
+                          const uint32_t                     attribute_id,
+                          const uint32_t                     num_labels,
+                          const bool                         use_shmem,
+                          compute_t<T>*                      d_sum,
+                          uint32_t*                          d_count)
+{
+    using LocalT   = typename HandleT::LocalT;
+    using ComputeT = compute_t<T>;
+
+    const uint32_t p_id = blockIdx.x;
+    if (p_id >= num_patches) {
+        return;
+    }
+
+    extern __shared__ char s_mem[];
+
+    ComputeT* s_sum   = d_sum;
+    uint32_t* s_count = d_count;
+    if (use_shmem) {
+        s_sum   = reinterpret_cast<ComputeT*>(s_mem);
+        s_count = (d_count == nullptr) ?
+                      nullptr :
+                      reinterpret_cast<uint32_t*>(s_sum + num_labels);
+        for (uint32_t l = threadIdx.x; l < num_labels; l += blockSize) {
+            s_sum[l] = 0;
+            if (s_count != nullptr) {
+                s_count[l] = 0;
+            }
+        }
+        __syncthreads();
+    }
+
+    const uint16_t element_per_patch = X.size(p_id);
+    for (uint16_t i = threadIdx.x; i < element_per_patch; i += blockSize) {
+        if (X.get_patch_info(p_id).is_owned(LocalT(i)) &&
+            !X.get_patch_info(p_id).is_deleted(LocalT(i))) {
+            const uint32_t l = labels(p_id, i, 0);
+            if (l >= num_labels) {
+                continue;
+            }
+            ComputeT val = 0;
+            if (attribute_id != INVALID32) {
+                val = ComputeT(X(p_id, i, attribute_id));
+            } else {
+                for (uint32_t j = 0; j < num_attributes; ++j) {
+                    val += ComputeT(X(p_id, i, j));
+                }
+            }
+            ::atomicAdd(s_sum + l, val);
+            if (s_count != nullptr) {
+                ::atomicAdd(s_count + l, 1u);
+            }
+        }
+    }
+
+    if (use_shmem) {
+        __syncthreads();
+        for (uint32_t l = threadIdx.x; l < num_labels; l += blockSize) {
+            if (s_count != nullptr && s_count[l] > 0) {
+                ::atomicAdd(d_count + l, s_count[l]);
+            }
+            if (s_sum[l] != ComputeT(0)) {
+                ::atomicAdd(d_sum + l, s_sum[l]);
+            }
+        }
+    }
+}
+
+
 template <typename T, typename HandleT>
 __global__ void memset_attribute(const Attribute<T, HandleT> attr,
                                  const T                     value,
@@ -199,7 +303,7 @@ __global__ void memset_attribute(const Attribute<T, HandleT> attr,
 {
     uint32_t p_id = blockIdx.x;
     if (p_id < num_patches) {
-        const uint16_t element_per_patch = attr.capacity(p_id);
+        const uint16_t element_per_patch = attr.num_accessible(p_id);
         for (uint16_t i = threadIdx.x; i < element_per_patch; i += blockDim.x) {
             for (uint32_t j = 0; j < num_attributes; ++j) {
                 attr(p_id, i, j) = value;
@@ -208,5 +312,181 @@ __global__ void memset_attribute(const Attribute<T, HandleT> attr,
     }
 }
 
+template <typename T, typename S, typename HandleT>
+__global__ void convert_attribute(const Attribute<T, HandleT> dst,
+                                  const Attribute<S, HandleT> src,
+                                  const uint32_t              num_patches,
+                                  const uint32_t              num_attributes)
+{
+    uint32_t p_id = blockIdx.x;
+    if (p_id < num_patches) {
+        const uint16_t element_per_patch = dst.num_accessible(p_id);
+        for (uint16_t i = threadIdx.x; i < element_per_patch; i += blockDim.x) {
+            for (uint32_t j = 0; j < num_attributes; ++j) {
+                dst(p_id, i, j) = T(compute_t<S>(src(p_id, i, j)));
+            }
+        }
+    }
+}
+
+/**
+ * @brief copy the patches whose content changed since the last call from
+ * src[p] (device) to dst[p] (pinned host memory mapped to the device). A
+ * patch is considered changed if the hash of its bytes is different from
+ * the one stored in hash[p] (or if force is true). One block per patch
+ */
+template <uint32_t blockSize>
+__launch_bounds__(blockSize) __global__
+    void mirror_dirty_patches(const uint8_t* const* src,
+                              uint8_t* const*       dst,
+                              const uint32_t*       num_bytes,
+                              uint64_t*             hash,
+                              const uint32_t        num_patches,
+                              const bool            force,
+                              uint32_t*             d_num_dirty)
+{
+    const uint32_t p_id = blockIdx.x;
+    if (p_id >= num_patches) {
+        return;
+    }
+
+    const uint8_t* in    = src[p_id];
+    const uint32_t bytes = num_bytes[p_id];
+    const uint32_t words = bytes / 4;
+
+    // splitmix64 finalizer of every 32-bit word mixed with its position
+    auto mix = [](uint64_t x) {
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+        return x ^ (x >> 31);
+    };
+
+    const uint32_t* in32 = reinterpret_cast<const uint32_t*>(in);
+
+    uint64_t thread_hash = 0;
+    for (uint32_t i = threadIdx.x; i < words; i += blockSize) {
+        thread_hash += mix((uint64_t(i) << 32) | in32[i]);
+    }
+    for (uint32_t i = 4 * words + threadIdx.x; i < bytes; i += blockSize) {
+        thread_hash += mix((uint64_t(i) << 32) | in[i] | (1ull << 31));
+    }
+
+    typedef cub::BlockReduce<uint64_t, blockSize> BlockReduce;
+    __shared__ typename BlockReduce::TempStorage  temp_storage;
+    __shared__ bool                               s_dirty;
+
+    const uint64_t patch_hash = BlockReduce(temp_storage).Sum(thread_hash);
+
+    if (threadIdx.x == 0) {
+        s_dirty = force || patch_hash != hash[p_id];
+        if (s_dirty) {
+            hash[p_id] = patch_hash;
+            ::atomicAdd(d_num_dirty, 1u);
+        }
+    }
+    __syncthreads();
+
+    if (s_dirty) {
+        uint8_t*  out   = dst[p_id];
+        uint32_t* out32 = reinterpret_cast<uint32_t*>(out);
+        for (uint32_t i = threadIdx.x; i < words; i += blockSize) {
+            out32[i] = in32[i];
+        }
+        for (uint32_t i = 4 * words + threadIdx.x; i < bytes; i += blockSize) {
+            out[i] = in[i];
+        }
+    }
+}
+
+/**
+ * @brief first stage of a batch of dot products (see ReduceBatch) computed in
+ * a single pass over the patches. The partial result of the r-th reduction in
+ * patch p is written to d_block_output[r * num_patches + p]
+ */
+template <class BatchT, uint32_t blockSize>
+__launch_bounds__(blockSize) __global__
+    void batched_dot_kernel(const BatchT               batch,
+                            const uint32_t             num_patches,
+                            typename BatchT::ComputeT* d_block_output)
+{
+    using LocalT   = typename BatchT::HandleType::LocalT;
+    using ComputeT = typename BatchT::ComputeT;
+
+    const uint32_t p_id = blockIdx.x;
+    if (p_id >= num_patches) {
+        return;
+    }
+
+    ComputeT thread_val[BatchT::max_size];
+    for (uint32_t r = 0; r < BatchT::max_size; ++r) {
+        thread_val[r] = 0;
+    }
+
+    const auto&    patch_info        = batch.x(0).get_patch_info(p_id);
+    const uint16_t element_per_patch = batch.x(0).size(p_id);
+
+    for (uint16_t i = threadIdx.x; i < element_per_patch; i += blockSize) {
+        if (patch_info.is_owned(LocalT(i)) &&
+            !patch_info.is_deleted(LocalT(i))) {
+            // unrolled over max_size so thread_val stays in registers
+#pragma unroll
+            for (uint32_t r = 0; r < BatchT::max_size; ++r) {
+                if (r >= batch.size) {
+                    break;
+                }
+                const auto&    X   = batch.x(r);
+                const auto&    Y   = batch.y(r);
+                const uint32_t aid = batch.attribute_id[r];
+                if (aid != INVALID32) {
+                    thread_val[r] +=
+                        ComputeT(X(p_id, i, aid)) * ComputeT(Y(p_id, i, aid));
+                } else {
+                    for (uint32_t j = 0; j < X.get_num_attributes(); ++j) {
+                        thread_val[r] +=
+                            ComputeT(X(p_id, i, j)) * ComputeT(Y(p_id, i, j));
+                    }
+                }
+            }
+        }
+    }
+
+    typedef cub::BlockReduce<ComputeT, blockSize> BlockReduce;
+    __shared__ typename BlockReduce::TempStorage  temp_storage;
+
+#pragma unroll
+    for (uint32_t r = 0; r < BatchT::max_size; ++r) {
+        if (r >= batch.size) {
+            break;
+        }
+        const ComputeT block_sum = BlockReduce(temp_storage).Sum(thread_val[r]);
+        if (threadIdx.x == 0) {
+            d_block_output[r * num_patches + p_id] = block_sum;
+        }
+        __syncthreads();
+    }
+}
+
+/**
+ * @brief take the square root of the outputs of the norm2 reductions in a
+ * batch (see ReduceBatch)
+ */
+template <class BatchT>
+__global__ void batched_finalize(const BatchT               batch,
+                                 typename BatchT::ComputeT* d_output)
+{
+    const uint32_t r = threadIdx.x;
+    if (r < batch.size && batch.is_norm2[r]) {
+        d_output[r] = sqrt(d_output[r]);
+    }
+}
+
+template <typename T>
+__global__ void sqrt_in_place(T* d_value)
+{
+    if (threadIdx.x == 0 && blockIdx.x == 0) {
+        d_value[0] = sqrt(d_value[0]);
+    }
+}
+
 }  // namespace detail
 }  // namespace rxmesh
\ No newline at end of file
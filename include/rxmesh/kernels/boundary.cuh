@@ -7,6 +7,25 @@
 
 namespace rxmesh {
 
+/**
+ * @brief the bits of the cached vertex/edge flags (see
+ * RXMeshStatic::update_element_flags())
+ */
+enum class ElementFlag : uint8_t
+{
+    Boundary = 1,
+    Feature  = 2,
+};
+
+/**
+ * @brief check if the cached flags of a vertex/edge have the flag f
+ */
+__host__ __device__ __forceinline__ bool has_flag(const uint8_t     flags,
+                                                  const ElementFlag f)
+{
+    return (flags & uint8_t(f)) != 0;
+}
+
 namespace detail {
 template <uint32_t blockThreads, typename T>
 __global__ void identify_boundary_vertices(const Context      context,
@@ -42,6 +61,111 @@ __global__ void identify_boundary_vertices(const Context      context,
 
     query.dispatch<Op::EV>(block, shrd_alloc, boundary_vertices);
 }
+
+/**
+ * @brief check if the cached flags of the patch pi (or one of its neighbor
+ * patches) are stale. The flags of an element depend on the patch that owns it
+ * and the patches that own its incident elements which are all in the patch
+ * stash
+ */
+__device__ __forceinline__ bool element_flags_stale(const PatchInfo& pi,
+                                                    const uint8_t*   valid)
+{
+    if (pi.patch_id == INVALID32) {
+        return false;
+    }
+    if (valid[pi.patch_id] == 0) {
+        return true;
+    }
+    for (uint8_t i = 0; i < PatchStash::stash_size; ++i) {
+        const uint32_t q = pi.patch_stash.get_patch(i);
+        if (q != INVALID32 && valid[q] == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief compute the flags of the owned edges of the stale patches. An edge
+ * is a boundary edge if it has a single incident face and a feature edge if
+ * the cosine of the dihedral angle between the normals of its two faces is
+ * less than cos_feature
+ */
+template <uint32_t blockThreads, typename T>
+__global__ void identify_edge_flags(const Context            context,
+                                    const VertexAttribute<T> coords,
+                                    EdgeAttribute<uint8_t>   edge_flags,
+                                    const uint8_t*           valid,
+                                    const T                  cos_feature)
+{
+    auto block = cooperative_groups::this_thread_block();
+
+    Query<blockThreads> query(context);
+
+    if (!element_flags_stale(query.get_patch_info(), valid)) {
+        return;
+    }
+
+    ShmemAllocator shrd_alloc;
+
+    // EVDiamond returns the edge vertices at 0 and 2 while 1 and 3 are the
+    // opposite vertices in the face that has the edge oriented as 0->2 and
+    // 2->0 respectively
+    auto flag_edges = [&](EdgeHandle& eh, const VertexIterator& iter) {
+        uint8_t flags = 0;
+        if (!iter[1].is_valid() || !iter[3].is_valid()) {
+            flags |= uint8_t(ElementFlag::Boundary);
+        } else {
+            const vec3<T> v0 = coords.template to_glm<3>(iter[0]);
+            const vec3<T> v1 = coords.template to_glm<3>(iter[2]);
+            const vec3<T> a  = coords.template to_glm<3>(iter[1]);
+            const vec3<T> b  = coords.template to_glm<3>(iter[3]);
+
+            const vec3<T> n0 = glm::cross(v1 - v0, a - v0);
+            const vec3<T> n1 = glm::cross(v0 - v1, b - v1);
+
+            if (glm::dot(n0, n1) <
+                cos_feature * glm::length(n0) * glm::length(n1)) {
+                flags |= uint8_t(ElementFlag::Feature);
+            }
+        }
+        edge_flags(eh) = flags;
+    };
+
+    query.dispatch<Op::EVDiamond>(block, shrd_alloc, flag_edges);
+}
+
+/**
+ * @brief compute the flags of the owned vertices of the stale patches as the
+ * union of the flags of their incident edges
+ */
+template <uint32_t blockThreads>
+__global__ void identify_vertex_flags(const Context            context,
+                                      EdgeAttribute<uint8_t>   edge_flags,
+                                      VertexAttribute<uint8_t> vertex_flags,
+                                      const uint8_t*           valid)
+{
+    auto block = cooperative_groups::this_thread_block();
+
+    Query<blockThreads> query(context);
+
+    if (!element_flags_stale(query.get_patch_info(), valid)) {
+        return;
+    }
+
+    ShmemAllocator shrd_alloc;
+
+    auto flag_vertices = [&](VertexHandle& vh, const EdgeIterator& iter) {
+        uint8_t flags = 0;
+        for (uint16_t i = 0; i < iter.size(); ++i) {
+            flags |= edge_flags(iter[i]);
+        }
+        vertex_flags(vh) = flags;
+    };
+
+    query.dispatch<Op::VE>(block, shrd_alloc, flag_vertices);
+}
 }  // namespace detail
 
 
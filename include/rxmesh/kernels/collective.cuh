@@ -1,7 +1,10 @@
 #pragma once
 #include <assert.h>
 #define CUB_STDERR
+#include <cooperative_groups.h>
+#include <cooperative_groups/scan.h>
 #include <cub/cub.cuh>
+#include "rxmesh/kernels/shmem_allocator.cuh"
 #include "rxmesh/util/macros.h"
 
 namespace rxmesh {
@@ -94,5 +97,359 @@ __device__ __forceinline__ void cub_block_exclusive_sum(T*             data,
         data[size] = s_prv_run_aggregate;
     }*/
 }
+
+/**
+ * @brief Compute tile-wide exclusive sum where the tile is a
+ * thread_block_tile. Same as cub_block_exclusive_sum, the total sum is written
+ * in data[size]
+ */
+template <typename T, uint32_t tileSize>
+__device__ __forceinline__ void tile_exclusive_sum(
+    const cooperative_groups::thread_block_tile<tileSize>& tile,
+    T*                                                     data,
+    const uint32_t                                         size)
+{
+    namespace cg = cooperative_groups;
+
+    T prv_run_aggregate = 0;
+
+    for (uint32_t r = 0; r < size; r += tileSize) {
+        const uint32_t index = r + tile.thread_rank();
+
+        T value = (index < size) ? data[index] : T(0);
+
+        const T scan = cg::exclusive_scan(tile, value);
+
+        if (index < size) {
+            data[index] = prv_run_aggregate + scan;
+        }
+
+        prv_run_aggregate += tile.shfl(scan + value, tileSize - 1);
+    }
+
+    if (tile.thread_rank() == 0) {
+        data[size] = prv_run_aggregate;
+    }
+    tile.sync();
+}
 }  // namespace detail
-}  // namespace rxmesh
\ No newline at end of file
+/**
+ * @brief Block-wide collectives for user kernels that take their scratch
+ * space from a ShmemAllocator (held in registers i.e., all threads call the
+ * function) instead of static __shared__ memory. Every collective releases its
+ * scratch space before returning so it can be used between other
+ * allocations. The *_shmem_bytes() functions return the (max) dynamic shared
+ * memory used by a collective and should be added to the launch box
+ * shared memory (e.g., in prepare_launch_box()'s user_shmem)
+ */
+
+template <typename T, uint32_t blockThreads>
+constexpr __host__ __device__ uint32_t block_reduce_shmem_bytes()
+{
+    using TempStorage = typename cub::BlockReduce<T, blockThreads>::TempStorage;
+    return sizeof(TempStorage) + alignof(TempStorage) + sizeof(T) + alignof(T);
+}
+
+/**
+ * @brief reduce value of all threads of the block with op. The result is
+ * returned to all threads
+ */
+template <uint32_t blockThreads, typename T, typename ReductionOp>
+__device__ __inline__ T block_reduce(cooperative_groups::thread_block& block,
+                                     ShmemAllocator& shrd_alloc,
+                                     const T&        value,
+                                     ReductionOp     op)
+{
+    using BlockReduce = cub::BlockReduce<T, blockThreads>;
+    using TempStorage = typename BlockReduce::TempStorage;
+
+    assert(block.size() == blockThreads);
+
+    const uint32_t before = shrd_alloc.get_allocated_size_bytes();
+
+    TempStorage* s_temp = reinterpret_cast<TempStorage*>(
+        shrd_alloc.alloc(sizeof(TempStorage), alignof(TempStorage)));
+    T* s_result = reinterpret_cast<T*>(shrd_alloc.alloc(sizeof(T), alignof(T)));
+
+    // the result by cub is only valid for thread 0
+    T result = BlockReduce(*s_temp).Reduce(value, op);
+    if (threadIdx.x == 0) {
+        *s_result = result;
+    }
+    block.sync();
+    result = *s_result;
+    block.sync();
+
+    shrd_alloc.dealloc(shrd_alloc.get_allocated_size_bytes() - before);
+    return result;
+}
+
+/**
+ * @brief sum of value of all threads of the block returned to all threads
+ */
+template <uint32_t blockThreads, typename T>
+__device__ __inline__ T block_sum(cooperative_groups::thread_block& block,
+                                  ShmemAllocator&                   shrd_alloc,
+                                  const T&                          value)
+{
+    return block_reduce<blockThreads>(block, shrd_alloc, value, cub::Sum());
+}
+
+namespace detail {
+template <typename T>
+struct SegmentedValue
+{
+    T        value;
+    uint32_t head;
+};
+}  // namespace detail
+
+template <typename T, uint32_t blockThreads>
+constexpr __host__ __device__ uint32_t
+block_segmented_exclusive_sum_shmem_bytes(const uint32_t size)
+{
+    using TempStorage = typename cub::BlockScan<detail::SegmentedValue<T>,
+                                                blockThreads>::TempStorage;
+    return size + sizeof(TempStorage) + alignof(TempStorage) + sizeof(T) +
+           alignof(T);
+}
+
+/**
+ * @brief in-place exclusive sum of data within every segment where segment s
+ * is data[offset[s]] ... data[offset[s + 1] - 1] e.g., the output offset of a
+ * query stored in shared memory. The first value of every segment becomes
+ * zero. offset (num_segments + 1 entries) could be in shared or global memory
+ */
+template <uint32_t blockThreads, typename T, typename OffsetT>
+__device__ __inline__ void block_segmented_exclusive_sum(
+    cooperative_groups::thread_block& block,
+    ShmemAllocator&                   shrd_alloc,
+    T*                                data,
+    const OffsetT*                    offset,
+    const uint32_t                    num_segments)
+{
+    using PairT       = detail::SegmentedValue<T>;
+    using BlockScan   = cub::BlockScan<PairT, blockThreads>;
+    using TempStorage = typename BlockScan::TempStorage;
+
+    assert(block.size() == blockThreads);
+
+    const uint32_t size   = offset[num_segments];
+    const uint32_t before = shrd_alloc.get_allocated_size_bytes();
+
+    uint8_t*     s_head = shrd_alloc.alloc<uint8_t>(size);
+    TempStorage* s_temp = reinterpret_cast<TempStorage*>(
+        shrd_alloc.alloc(sizeof(TempStorage), alignof(TempStorage)));
+    T* s_carry = reinterpret_cast<T*>(shrd_alloc.alloc(sizeof(T), alignof(T)));
+
+    for (uint32_t i = threadIdx.x; i < size; i += blockThreads) {
+        s_head[i] = 0;
+    }
+    block.sync();
+    for (uint32_t s = threadIdx.x; s < num_segments; s += blockThreads) {
+        if (offset[s] < offset[s + 1]) {
+            s_head[offset[s]] = 1;
+        }
+    }
+    block.sync();
+
+    // the scan of (value, head) pairs restarts at every head
+    auto op = [](const PairT& a, const PairT& b) {
+        PairT ret;
+        ret.value = b.head ? b.value : a.value + b.value;
+        ret.head  = a.head | b.head;
+        return ret;
+    };
+
+    T carry = T(0);
+    for (uint32_t r = 0; r < size; r += blockThreads) {
+        const uint32_t i = r + threadIdx.x;
+
+        PairT in;
+        in.value = (i < size) ? data[i] : T(0);
+        in.head  = (i < size) ? s_head[i] : 0;
+
+        PairT out;
+        BlockScan(*s_temp).InclusiveScan(in, out, op);
+
+        // the values before the first head in this run continue the last
+        // segment of the previous run
+        const T inclusive = out.head ? out.value : carry + out.value;
+        if (i < size) {
+            data[i] = inclusive - in.value;
+        }
+        if (threadIdx.x == blockThreads - 1) {
+            *s_carry = inclusive;
+        }
+        block.sync();
+        carry = *s_carry;
+        block.sync();
+    }
+
+    shrd_alloc.dealloc(shrd_alloc.get_allocated_size_bytes() - before);
+}
+
+template <uint32_t blockThreads>
+constexpr __host__ __device__ uint32_t block_compact_shmem_bytes()
+{
+    using TempStorage =
+        typename cub::BlockScan<uint32_t, blockThreads>::TempStorage;
+    return sizeof(TempStorage) + alignof(TempStorage);
+}
+
+/**
+ * @brief stream compaction: write value(i) for every i in [0, size) for which
+ * pred(i) is true to out (in order) and return the number of written values
+ * to all threads. For example, the active vertices of a patch (in a Bitmask)
+ * as handles
+ * block_compact<blockThreads>(block, shrd_alloc, num_v,
+ *     [&](uint16_t v) { return s_active(v); },
+ *     [&](uint16_t v) { return VertexHandle(patch_id, v); }, s_out);
+ */
+template <uint32_t blockThreads, typename T, typename PredT, typename ValueT>
+__device__ __inline__ uint32_t
+block_compact(cooperative_groups::thread_block& block,
+              ShmemAllocator&                   shrd_alloc,
+              const uint32_t                    size,
+              PredT                             pred,
+              ValueT                            value,
+              T*                                out)
+{
+    using BlockScan   = cub::BlockScan<uint32_t, blockThreads>;
+    using TempStorage = typename BlockScan::TempStorage;
+
+    assert(block.size() == blockThreads);
+
+    const uint32_t before = shrd_alloc.get_allocated_size_bytes();
+
+    TempStorage* s_temp = reinterpret_cast<TempStorage*>(
+        shrd_alloc.alloc(sizeof(TempStorage), alignof(TempStorage)));
+
+    uint32_t total = 0;
+    for (uint32_t r = 0; r < size; r += blockThreads) {
+        const uint32_t i    = r + threadIdx.x;
+        const uint32_t flag = (i < size && pred(i)) ? 1 : 0;
+
+        uint32_t pos, run_total;
+        BlockScan(*s_temp).ExclusiveSum(flag, pos, run_total);
+        if (flag) {
+            out[total + pos] = value(i);
+        }
+        total += run_total;
+        block.sync();
+    }
+
+    shrd_alloc.dealloc(shrd_alloc.get_allocated_size_bytes() - before);
+    return total;
+}
+
+/**
+ * @brief block-local set of 32-bit keys in shared memory using open
+ * addressing with linear probing. The number of slots is the capacity rounded
+ * up to a power of two and should be larger than the max number of inserted
+ * keys (e.g., 2x) to keep the probing short. INVALID32 can not be inserted.
+ * The set has to be clear()-ed before use and the memory is released by the
+ * caller (e.g., ShmemAllocator::dealloc())
+ */
+struct BlockHashSet
+{
+    static constexpr uint32_t empty_key = INVALID32;
+
+    __device__ BlockHashSet() : m_table(nullptr), m_num_slots(0)
+    {
+    }
+
+    __device__ BlockHashSet(ShmemAllocator& shrd_alloc, const uint32_t capacity)
+        : m_num_slots(num_slots(capacity))
+    {
+        m_table = shrd_alloc.alloc<uint32_t>(m_num_slots);
+    }
+
+    static constexpr __host__ __device__ uint32_t
+    num_slots(const uint32_t capacity)
+    {
+        uint32_t n = 1;
+        while (n < capacity) {
+            n <<= 1;
+        }
+        return n;
+    }
+
+    static constexpr __host__ __device__ uint32_t
+    shmem_bytes(const uint32_t capacity)
+    {
+        return num_slots(capacity) * sizeof(uint32_t) +
+               ShmemAllocator::default_alignment;
+    }
+
+    __device__ __inline__ void clear(cooperative_groups::thread_block& block)
+    {
+        for (uint32_t i = threadIdx.x; i < m_num_slots; i += block.size()) {
+            m_table[i] = empty_key;
+        }
+        block.sync();
+    }
+
+    /**
+     * @brief insert key and return true if it was not in the set. Returns
+     * false if the key is already in the set or the set is full
+     */
+    __device__ __inline__ bool insert(const uint32_t key)
+    {
+        assert(key != empty_key);
+        uint32_t slot = hash(key);
+        for (uint32_t p = 0; p < m_num_slots; ++p) {
+            const uint32_t prv = ::atomicCAS(m_table + slot, empty_key, key);
+            if (prv == empty_key) {
+                return true;
+            }
+            if (prv == key) {
+                return false;
+            }
+            slot = (slot + 1) & (m_num_slots - 1);
+        }
+        return false;
+    }
+
+    __device__ __inline__ bool contains(const uint32_t key) const
+    {
+        uint32_t slot = hash(key);
+        for (uint32_t p = 0; p < m_num_slots; ++p) {
+            const uint32_t k = m_table[slot];
+            if (k == key) {
+                return true;
+            }
+            if (k == empty_key) {
+                return false;
+            }
+            slot = (slot + 1) & (m_num_slots - 1);
+        }
+        return false;
+    }
+
+    /**
+     * @brief direct access to the slots e.g., to iterate over the keys. Empty
+     * slots are empty_key
+     */
+    __device__ __inline__ uint32_t slot(const uint32_t i) const
+    {
+        assert(i < m_num_slots);
+        return m_table[i];
+    }
+
+    __device__ __inline__ uint32_t get_num_slots() const
+    {
+        return m_num_slots;
+    }
+
+   private:
+    __device__ __inline__ uint32_t hash(const uint32_t key) const
+    {
+        // multiplicative hashing
+        return (key * 2654435769u) & (m_num_slots - 1);
+    }
+
+    uint32_t* m_table;
+    uint32_t  m_num_slots;
+};
+}  // namespace rxmesh
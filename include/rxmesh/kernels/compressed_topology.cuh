@@ -0,0 +1,103 @@
+#pragma once
+
+#include <assert.h>
+#include <stdint.h>
+
+#include <cooperative_groups.h>
+
+#include "rxmesh/kernels/loader.cuh"
+#include "rxmesh/patch_info.h"
+#include "rxmesh/util/macros.h"
+
+namespace rxmesh {
+namespace detail {
+
+/**
+ * @brief narrow the patch ev and fe to 8-bit and store them in buffer starting
+ * at start[p] for patch p. If buffer is nullptr, the compressed topology of
+ * all patches is detached. One block per patch
+ */
+template <uint32_t blockThreads>
+__global__ static void compress_topology(PatchInfo*      patches_info,
+                                         const uint32_t  num_patches,
+                                         uint8_t*        buffer,
+                                         const uint32_t* start)
+{
+    const uint32_t p = blockIdx.x;
+    if (p >= num_patches) {
+        return;
+    }
+
+    PatchInfo& pi = patches_info[p];
+
+    if (buffer == nullptr) {
+        if (threadIdx.x == 0) {
+            pi.ev8 = nullptr;
+            pi.fe8 = nullptr;
+        }
+        return;
+    }
+
+    uint8_t* ev8 = buffer + start[p];
+    uint8_t* fe8 = ev8 + 2 * pi.edges_capacity;
+
+    const uint16_t* ev = reinterpret_cast<const uint16_t*>(pi.ev);
+    const uint16_t* fe = reinterpret_cast<const uint16_t*>(pi.fe);
+
+    const uint32_t num_ev = 2 * pi.num_edges[0];
+    const uint32_t num_fe = 3 * pi.num_faces[0];
+
+    for (uint32_t i = threadIdx.x; i < num_ev; i += blockThreads) {
+        assert(ev[i] == INVALID16 || ev[i] < INVALID8);
+        ev8[i] = (ev[i] == INVALID16) ? INVALID8 : uint8_t(ev[i]);
+    }
+
+    for (uint32_t i = threadIdx.x; i < num_fe; i += blockThreads) {
+        assert(fe[i] == INVALID16 || fe[i] < INVALID8);
+        fe8[i] = (fe[i] == INVALID16) ? INVALID8 : uint8_t(fe[i]);
+    }
+
+    if (threadIdx.x == 0) {
+        pi.ev8 = ev8;
+        pi.fe8 = fe8;
+    }
+}
+
+/**
+ * @brief load the patch topology (ev or fe) into shared memory. If in is the
+ * patch global ev (or fe) and the patch has a compressed (8-bit) copy of it,
+ * the compressed copy is read and widened to 16-bit. Otherwise, this is the
+ * same as load_async_or_copy()
+ */
+template <typename SizeT>
+__device__ __forceinline__ void load_topology(
+    cooperative_groups::thread_block& block,
+    const PatchInfo&                  patch_info,
+    const uint16_t*                   in,
+    const SizeT                       size,
+    uint16_t*                         out,
+    bool                              with_wait)
+{
+    const uint8_t* in8 = nullptr;
+    if (in == reinterpret_cast<const uint16_t*>(patch_info.ev)) {
+        in8 = patch_info.ev8;
+    } else if (in == reinterpret_cast<const uint16_t*>(patch_info.fe)) {
+        in8 = patch_info.fe8;
+    }
+
+    if (in8 == nullptr) {
+        load_async_or_copy(block, in, size, out, with_wait);
+        return;
+    }
+
+    for (uint32_t i = block.thread_rank(); i < size; i += block.size()) {
+        const uint8_t v = in8[i];
+        out[i]          = (v == INVALID8) ? INVALID16 : uint16_t(v);
+    }
+    if (with_wait) {
+        block.sync();
+    }
+}
+
+}  // namespace detail
+}  // namespace rxmesh
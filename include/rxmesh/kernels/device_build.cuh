@@ -0,0 +1,189 @@
+#pragma once
+#include <stdint.h>
+
+#include "rxmesh/device_build_data.h"
+#include "rxmesh/lp_pair.cuh"
+#include "rxmesh/patch_info.h"
+
+namespace rxmesh {
+
+namespace detail {
+
+/**
+ * @brief binary search for a global id in the sorted range ltog[start, end)
+ * @return the position of global_id relative to ltog or INVALID16 if it is not
+ * in the range
+ */
+__device__ __forceinline__ uint16_t ltog_lower_bound(const uint32_t* ltog,
+                                                     uint32_t        start,
+                                                     uint32_t        end,
+                                                     const uint32_t  global_id)
+{
+    const uint32_t range_end = end;
+    while (start < end) {
+        const uint32_t mid = start + (end - start) / 2;
+        if (ltog[mid] < global_id) {
+            start = mid + 1;
+        } else {
+            end = mid;
+        }
+    }
+    if (start == range_end || ltog[start] != global_id) {
+        return INVALID16;
+    }
+    return static_cast<uint16_t>(start);
+}
+
+/**
+ * @brief find the local index of a mesh element in a patch given its owner
+ * patch. If the element is owned by the patch, we search the owned part of the
+ * patch local-to-global map. Otherwise, we search the not-owned part
+ */
+__device__ __forceinline__ uint16_t find_local_index(
+    const uint32_t  patch_id,
+    const uint32_t  global_id,
+    const uint32_t  element_patch,
+    const uint32_t* p_ltog,
+    const uint16_t  num_owned,
+    const uint16_t  num_elements)
+{
+    if (element_patch == patch_id) {
+        return ltog_lower_bound(p_ltog, 0, num_owned, global_id);
+    } else {
+        return ltog_lower_bound(p_ltog, num_owned, num_elements, global_id);
+    }
+}
+
+/**
+ * @brief build the per-patch EV and FE directly from the input mesh and the
+ * patches local-to-global maps. Each block processes one patch. EV of local
+ * edge e stores the local id of the (max, min) global vertices and FE stores
+ * the local edge id shift by one with the first bit indicating if the edge
+ * direction is flipped w.r.t the face orientation
+ */
+template <uint32_t blockThreads>
+__global__ static void build_patch_topology(const DeviceBuildData data,
+                                            PatchInfo*            patches_info)
+{
+    const uint32_t p = blockIdx.x;
+
+    const uint32_t* p_ltog_v = data.ltog_v + data.ltog_v_offset[p];
+    const uint32_t* p_ltog_e = data.ltog_e + data.ltog_e_offset[p];
+    const uint32_t* p_ltog_f = data.ltog_f + data.ltog_f_offset[p];
+
+    const uint16_t num_v = static_cast<uint16_t>(data.ltog_v_offset[p + 1] -
+                                                 data.ltog_v_offset[p]);
+    const uint16_t num_e = static_cast<uint16_t>(data.ltog_e_offset[p + 1] -
+                                                 data.ltog_e_offset[p]);
+    const uint16_t num_f = static_cast<uint16_t>(data.ltog_f_offset[p + 1] -
+                                                 data.ltog_f_offset[p]);
+
+    const uint16_t num_owned_v = data.num_owned_v[p];
+    const uint16_t num_owned_e = data.num_owned_e[p];
+
+    LocalVertexT* ev = patches_info[p].ev;
+    LocalEdgeT*   fe = patches_info[p].fe;
+
+    for (uint16_t e = threadIdx.x; e < num_e; e += blockThreads) {
+        const uint32_t ge = p_ltog_e[e];
+        const uint32_t v0 = data.ev[2 * ge];
+        const uint32_t v1 = data.ev[2 * ge + 1];
+
+        // edge key is (max, min)
+        const uint32_t key_first  = max(v0, v1);
+        const uint32_t key_second = min(v0, v1);
+
+        ev[2 * e].id = find_local_index(p,
+                                        key_first,
+                                        data.vertex_patch[key_first],
+                                        p_ltog_v,
+                                        num_owned_v,
+                                        num_v);
+
+        ev[2 * e + 1].id = find_local_index(p,
+                                            key_second,
+                                            data.vertex_patch[key_second],
+                                            p_ltog_v,
+                                            num_owned_v,
+                                            num_v);
+    }
+
+    for (uint16_t f = threadIdx.x; f < num_f; f += blockThreads) {
+        const uint32_t gf = p_ltog_f[f];
+        for (uint32_t v = 0; v < 3; ++v) {
+            const uint32_t ge = data.fe[3 * gf + v];
+            const uint32_t v0 = data.fv[3 * gf + v];
+            const uint32_t v1 = data.fv[3 * gf + (v + 1) % 3];
+
+            // the edge key is (max, min) so the face traverses the edge in
+            // the same direction only if v0 is the max
+            const uint16_t dir = (v0 >= v1) ? 0 : 1;
+
+            uint16_t le = find_local_index(p,
+                                           ge,
+                                           data.edge_patch[ge],
+                                           p_ltog_e,
+                                           num_owned_e,
+                                           num_e);
+            le          = le << 1;
+            le          = le | (dir & 1);
+
+            fe[3 * f + v].id = le;
+        }
+    }
+}
+
+/**
+ * @brief populate the LP hashtable of every patch for one mesh element type.
+ * Each block processes one patch and each thread inserts one not-owned element
+ * in the patch hashtable (that lives in global memory). The number of failed
+ * lookups/insertions is accumulated in d_num_failed
+ */
+template <typename HandleT, uint32_t blockThreads>
+__global__ static void build_patch_lp_hashtable(
+    const uint32_t* ltog,
+    const uint32_t* ltog_offset,
+    const uint16_t* num_owned,
+    const uint32_t* element_patch,
+    PatchInfo*      patches_info,
+    uint32_t*       d_num_failed)
+{
+    const uint32_t p = blockIdx.x;
+
+    const uint32_t* p_ltog = ltog + ltog_offset[p];
+    const uint16_t  num_elements =
+        static_cast<uint16_t>(ltog_offset[p + 1] - ltog_offset[p]);
+    const uint16_t num_owned_elements = num_owned[p];
+
+    PatchInfo& pi = patches_info[p];
+
+    for (uint16_t local_id = num_owned_elements + threadIdx.x;
+         local_id < num_elements;
+         local_id += blockThreads) {
+
+        const uint32_t global_id   = p_ltog[local_id];
+        const uint32_t owner_patch = element_patch[global_id];
+
+        const uint16_t local_id_in_owner_patch =
+            ltog_lower_bound(ltog + ltog_offset[owner_patch],
+                             0,
+                             num_owned[owner_patch],
+                             global_id);
+
+        if (local_id_in_owner_patch == INVALID16) {
+            ::atomicAdd(d_num_failed, 1u);
+            continue;
+        }
+
+        const uint8_t owner_st = pi.patch_stash.find_patch_index(owner_patch);
+
+        LPPair pair(local_id, local_id_in_owner_patch, owner_st);
+
+        if (!pi.get_lp<HandleT>().insert(pair, nullptr, nullptr)) {
+            ::atomicAdd(d_num_failed, 1u);
+        }
+    }
+}
+
+}  // namespace detail
+}  // namespace rxmesh
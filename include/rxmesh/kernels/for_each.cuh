@@ -102,6 +102,126 @@ __global__ void for_each_face(const uint32_t   num_patches,
 }
 }  // namespace detail
 
+namespace detail {
+/**
+ * @brief write the handle of every owned and active mesh element of type
+ * HandleT at its linear_id() in handles (i.e., the dense index used by
+ * RXMeshStatic::for_each_dense()). One block per patch
+ */
+template <typename HandleT>
+__global__ void build_dense_index(const Context context, HandleT* handles)
+{
+    const uint32_t p_id = blockIdx.x;
+    if (p_id >= context.m_num_patches[0] ||
+        context.m_patches_info[p_id].patch_id == INVALID32) {
+        return;
+    }
+    auto store = [&](const HandleT h) { handles[context.linear_id(h)] = h; };
+    if constexpr (std::is_same_v<HandleT, VertexHandle>) {
+        for_each_vertex(context.m_patches_info[p_id], store);
+    }
+    if constexpr (std::is_same_v<HandleT, EdgeHandle>) {
+        for_each_edge(context.m_patches_info[p_id], store);
+    }
+    if constexpr (std::is_same_v<HandleT, FaceHandle>) {
+        for_each_face(context.m_patches_info[p_id], store);
+    }
+}
+
+/**
+ * @brief grid-stride loop over the dense indices [begin, end) where the
+ * lambda gets the handle of the mesh element along with its dense index.
+ * The owned and active masks are not tested since the dense index only
+ * contains owned and active mesh elements
+ */
+template <typename HandleT, typename LambdaT>
+__global__ void for_each_dense(const uint32_t begin,
+                               const uint32_t end,
+                               const HandleT* handles,
+                               LambdaT        apply)
+{
+    for (uint32_t i = begin + blockIdx.x * blockDim.x + threadIdx.x; i < end;
+         i += blockDim.x * gridDim.x) {
+        apply(handles[i], i);
+    }
+}
+
+/**
+ * @brief same as for_each_dense but over the (dense index, sample) pairs of
+ * num_samples samples of an ensemble attribute where the sample is the
+ * fastest changing index such that consecutive threads access the samples of
+ * the same mesh element (contiguous with AoS layout)
+ */
+template <typename HandleT, typename LambdaT>
+__global__ void for_each_dense_sample(const uint32_t begin,
+                                      const uint32_t end,
+                                      const uint32_t num_samples,
+                                      const HandleT* handles,
+                                      LambdaT        apply)
+{
+    const size_t size = size_t(end - begin) * num_samples;
+    for (size_t i = size_t(blockIdx.x) * blockDim.x + threadIdx.x; i < size;
+         i += size_t(blockDim.x) * gridDim.x) {
+        apply(handles[begin + i / num_samples], uint32_t(i % num_samples));
+    }
+}
+
+/**
+ * @brief apply the lambda on the owned and active mesh elements of type
+ * HandleT in the patch subset (see RXMeshStatic::set_patch_subset()). One
+ * block per patch in the subset
+ */
+template <typename HandleT, typename LambdaT>
+__global__ void for_each_patch_subset(const Context context, LambdaT apply)
+{
+    const uint32_t p_id = context.block_patch_id();
+    if (p_id >= context.m_num_patches[0] || !context.is_patch_in_range(p_id) ||
+        context.m_patches_info[p_id].patch_id == INVALID32) {
+        return;
+    }
+    if constexpr (std::is_same_v<HandleT, VertexHandle>) {
+        for_each_vertex(context.m_patches_info[p_id], apply);
+    }
+    if constexpr (std::is_same_v<HandleT, EdgeHandle>) {
+        for_each_edge(context.m_patches_info[p_id], apply);
+    }
+    if constexpr (std::is_same_v<HandleT, FaceHandle>) {
+        for_each_face(context.m_patches_info[p_id], apply);
+    }
+}
+
+/**
+ * @brief mark the patches in the list (and, if with_ring, their neighbor
+ * patches as stored in the PatchStash) in flags. One thread per patch in the
+ * list
+ */
+__global__ static void mark_patch_subset(const Context   context,
+                                         const uint32_t  num,
+                                         const uint32_t* patches,
+                                         const bool      with_ring,
+                                         uint8_t*        flags)
+{
+    const uint32_t i = threadIdx.x + blockIdx.x * blockDim.x;
+    if (i >= num) {
+        return;
+    }
+    const uint32_t p = patches[i];
+    if (p >= context.m_num_patches[0]) {
+        return;
+    }
+    flags[p] = 1;
+    if (with_ring) {
+        const PatchStash& stash = context.m_patches_info[p].patch_stash;
+        for (uint32_t s = 0; s < PatchStash::stash_size; ++s) {
+            const uint32_t q = stash.get_patch(uint8_t(s));
+            if (q != INVALID32) {
+                flags[q] = 1;
+            }
+        }
+    }
+}
+}  // namespace detail
+
 
 /**
  * @brief Apply a lambda function on all mesh elements. The type of the mesh
@@ -130,8 +250,8 @@ __device__ __inline__ void for_each(const Context& context, computeT compute_op)
     using ComputeTraits  = detail::FunctionTraits<computeT>;
     using ComputeHandleT = typename ComputeTraits::template arg<0>::type;
 
-    const uint32_t p_id = blockIdx.x;
-    if (p_id < context.m_num_patches[0]) {
+    const uint32_t p_id = context.block_patch_id();
+    if (p_id < context.m_num_patches[0] && context.is_patch_in_range(p_id)) {
         if (context.m_patches_info[p_id].patch_id == INVALID32) {
             return;
         }
@@ -0,0 +1,164 @@
+#pragma once
+#include <stdint.h>
+
+#include "rxmesh/context.h"
+#include "rxmesh/handle.h"
+#include "rxmesh/kernels/for_each.cuh"
+#include "rxmesh/patch_info.h"
+
+namespace rxmesh {
+
+/**
+ * @brief a device hash map from a pair of vertex linear ids (see
+ * Context::linear_id()) to the handle of the (owned) edge connecting them.
+ * Open addressing with linear probing where the key packs the two (sorted)
+ * vertex ids into 64 bits. The map is built and owned by RXMeshStatic (see
+ * RXMeshStatic::get_edge_handles()) and this is a view of it that could be
+ * passed to kernels by value
+ */
+struct DeviceEdgeMap
+{
+    static constexpr uint64_t empty_key = ~uint64_t(0);
+
+    __host__ __device__ DeviceEdgeMap()
+        : m_keys(nullptr), m_values(nullptr), m_capacity(0)
+    {
+    }
+
+    /**
+     * @brief the key of the undirected edge v0-v1
+     */
+    __host__ __device__ static uint64_t key(const uint32_t v0,
+                                            const uint32_t v1)
+    {
+        const uint64_t lo = v0 < v1 ? v0 : v1;
+        const uint64_t hi = v0 < v1 ? v1 : v0;
+        return (hi << 32) | lo;
+    }
+
+    /**
+     * @brief the first slot to probe for a key (splitmix64 finalizer)
+     */
+    __host__ __device__ uint32_t slot(uint64_t k) const
+    {
+        k ^= k >> 30;
+        k *= 0xbf58476d1ce4e5b9ull;
+        k ^= k >> 27;
+        k *= 0x94d049bb133111ebull;
+        k ^= k >> 31;
+        return static_cast<uint32_t>(k % m_capacity);
+    }
+
+    /**
+     * @brief insert the edge eh connecting v0 and v1. The capacity should be
+     * larger than the number of edges inserted
+     */
+    __device__ __inline__ void insert(const uint32_t   v0,
+                                      const uint32_t   v1,
+                                      const EdgeHandle eh)
+    {
+#ifdef __CUDA_ARCH__
+        const uint64_t k = key(v0, v1);
+        uint32_t       s = slot(k);
+        while (true) {
+            const unsigned long long prev =
+                ::atomicCAS(reinterpret_cast<unsigned long long*>(m_keys + s),
+                            static_cast<unsigned long long>(empty_key),
+                            static_cast<unsigned long long>(k));
+            if (prev == empty_key || prev == k) {
+                m_values[s] = eh;
+                return;
+            }
+            s = (s + 1 == m_capacity) ? 0 : s + 1;
+        }
+#endif
+    }
+
+    /**
+     * @brief the handle of the edge connecting v0 and v1 or an invalid handle
+     * if v0 and v1 are not connected
+     */
+    __device__ __inline__ EdgeHandle find(const uint32_t v0,
+                                          const uint32_t v1) const
+    {
+        const uint64_t k = key(v0, v1);
+        uint32_t       s = slot(k);
+        for (uint32_t i = 0; i < m_capacity; ++i) {
+            const uint64_t cur = m_keys[s];
+            if (cur == k) {
+                return m_values[s];
+            }
+            if (cur == empty_key) {
+                break;
+            }
+            s = (s + 1 == m_capacity) ? 0 : s + 1;
+        }
+        return EdgeHandle();
+    }
+
+    uint64_t*   m_keys;
+    EdgeHandle* m_values;
+    uint32_t    m_capacity;
+};
+
+namespace detail {
+
+/**
+ * @brief out[i] = the handle whose linear_id() is ids[i] using the dense
+ * index (see RXMeshStatic::get_dense_index()). Out of range ids are mapped to
+ * invalid handles
+ */
+template <typename HandleT>
+__global__ static void map_linear_ids(const uint32_t  num,
+                                      const uint32_t* ids,
+                                      const uint32_t  num_elements,
+                                      const HandleT*  dense,
+                                      HandleT*        out)
+{
+    const uint32_t i = threadIdx.x + blockIdx.x * blockDim.x;
+    if (i < num) {
+        const uint32_t id = ids[i];
+        out[i]            = (id < num_elements) ? dense[id] : HandleT();
+    }
+}
+
+/**
+ * @brief insert every owned and active edge into the map keyed by the linear
+ * ids of its two vertices. One block per patch
+ */
+__global__ static void build_edge_map(const Context context, DeviceEdgeMap map)
+{
+    const uint32_t p_id = blockIdx.x;
+    if (p_id >= context.m_num_patches[0] ||
+        context.m_patches_info[p_id].patch_id == INVALID32) {
+        return;
+    }
+
+    const PatchInfo& pi = context.m_patches_info[p_id];
+
+    for_each_edge(pi, [&](const EdgeHandle eh) {
+        const uint16_t     e = eh.local_id();
+        const VertexHandle v0(p_id, pi.ev[2 * e + 0].id);
+        const VertexHandle v1(p_id, pi.ev[2 * e + 1].id);
+
+        map.insert(context.linear_id(v0), context.linear_id(v1), eh);
+    });
+}
+
+/**
+ * @brief out[i] = the edge connecting the vertices whose linear ids are
+ * v0[i] and v1[i] (or an invalid handle if they are not connected)
+ */
+__global__ static void map_vertex_pairs(const uint32_t      num,
+                                        const uint32_t*     v0,
+                                        const uint32_t*     v1,
+                                        const DeviceEdgeMap map,
+                                        EdgeHandle*         out)
+{
+    const uint32_t i = threadIdx.x + blockIdx.x * blockDim.x;
+    if (i < num) {
+        out[i] = map.find(v0[i], v1[i]);
+    }
+}
+}  // namespace detail
+}  // namespace rxmesh
@@ -109,8 +109,8 @@ struct InverseLPHashTable
      * the inverse table. The key of LPHashTable is the local id. Thus, the key
      * in the InverseLPHashTable is the <patch stash id,local id in owner patch>
      * i.e., the low LIDOwnerNumBits + PatchStashNumBits bits in pair.
-     * Since we use 13 bits for LIDOwnerNumBits and 6 bits PatchStashNumBits, we
-     * return 32-bit index
+     * Since LIDOwnerNumBits + PatchStashNumBits is 19 bits, we return 32-bit
+     * index
      */
     __device__ __inline__ uint32_t get_key(const LPPair& pair) const
     {
@@ -29,6 +29,25 @@ __device__ __forceinline__ void load_async(
 }
 
 
+/**
+ * @brief same as load_async() but done by a tile (thread_block_tile) instead of
+ * the whole block
+ */
+template <uint32_t tileSize, typename T, typename SizeT>
+__device__ __forceinline__ void load_async(
+    const cooperative_groups::thread_block_tile<tileSize>& tile,
+    const T*                                               in,
+    const SizeT                                            size,
+    T*                                                     out,
+    bool                                                   with_wait)
+{
+    cooperative_groups::memcpy_async(tile, out, in, sizeof(T) * size);
+
+    if (with_wait) {
+        cooperative_groups::wait(tile);
+    }
+}
+
 template <typename T, typename SizeT>
 __device__ __forceinline__ void load_async(const T*    in,
                                            const SizeT size,
@@ -45,6 +64,32 @@ __device__ __forceinline__ void load_async(const T*    in,
     }
 }
 
+/**
+ * @brief same as load_async() but the input could also be in shared memory,
+ * e.g., the patch topology that is loaded once by a fused query to be reused by
+ * multiple query operations. In this case, the block copies it directly since
+ * memcpy_async expects its input to be in global memory
+ */
+template <typename T, typename SizeT>
+__device__ __forceinline__ void load_async_or_copy(
+    cooperative_groups::thread_block& block,
+    const T*                          in,
+    const SizeT                       size,
+    T*                                out,
+    bool                              with_wait)
+{
+    if (__isShared(in)) {
+        for (uint32_t i = block.thread_rank(); i < size; i += block.size()) {
+            out[i] = in[i];
+        }
+        if (with_wait) {
+            block.sync();
+        }
+    } else {
+        load_async(block, in, size, out, with_wait);
+    }
+}
+
 /**
  * @brief store shared memory into global memory. Optimized for uint16_t but
  * also works okay for other types
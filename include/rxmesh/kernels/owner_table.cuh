@@ -0,0 +1,84 @@
+#pragma once
+
+#include <assert.h>
+#include <stdint.h>
+
+#include "rxmesh/handle.h"
+#include "rxmesh/patch_info.h"
+#include "rxmesh/util/macros.h"
+
+namespace rxmesh {
+namespace detail {
+
+/**
+ * @brief write the unique id of the owner handle of every not-owned element of
+ * type HandleT in the patch into table (INVALID64 for owned and deleted
+ * elements)
+ */
+template <uint32_t blockThreads, typename HandleT>
+__device__ __inline__ void fill_owner_table(const PatchInfo& pi,
+                                            uint64_t*        table)
+{
+    using LocalT = typename HandleT::LocalT;
+
+    const uint16_t num_elements = pi.get_num_elements<HandleT>()[0];
+
+    for (uint16_t i = threadIdx.x; i < num_elements; i += blockThreads) {
+        if (pi.is_deleted(LocalT(i)) || pi.is_owned(LocalT(i))) {
+            table[i] = INVALID64;
+        } else {
+            const HandleT owner = pi.find<HandleT>(i);
+            assert(owner.is_valid());
+            table[i] = owner.unique_id();
+        }
+    }
+}
+
+/**
+ * @brief build the owner table of the vertices, edges, and faces of every
+ * patch in buffer starting at start[p] for patch p. If buffer is nullptr, the
+ * owner tables of all patches are detached. One block per patch
+ */
+template <uint32_t blockThreads>
+__global__ static void build_owner_table(PatchInfo*      patches_info,
+                                         const uint32_t  num_patches,
+                                         uint64_t*       buffer,
+                                         const uint32_t* start)
+{
+    const uint32_t p = blockIdx.x;
+    if (p >= num_patches) {
+        return;
+    }
+
+    PatchInfo& pi = patches_info[p];
+
+    if (buffer == nullptr) {
+        if (threadIdx.x == 0) {
+            pi.owner_v = nullptr;
+            pi.owner_e = nullptr;
+            pi.owner_f = nullptr;
+        }
+        return;
+    }
+
+    uint64_t* owner_v = buffer + start[p];
+    uint64_t* owner_e = owner_v + pi.num_vertices[0];
+    uint64_t* owner_f = owner_e + pi.num_edges[0];
+
+    fill_owner_table<blockThreads, VertexHandle>(pi, owner_v);
+    fill_owner_table<blockThreads, EdgeHandle>(pi, owner_e);
+    fill_owner_table<blockThreads, FaceHandle>(pi, owner_f);
+
+    // the lookup above goes through the hashtable as long as the patch has no
+    // owner table
+    __syncthreads();
+
+    if (threadIdx.x == 0) {
+        pi.owner_v = owner_v;
+        pi.owner_e = owner_e;
+        pi.owner_f = owner_f;
+    }
+}
+
+}  // namespace detail
+}  // namespace rxmesh
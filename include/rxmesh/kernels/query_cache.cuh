@@ -0,0 +1,142 @@
+#pragma once
+
+#include <assert.h>
+#include <stdint.h>
+
+#include <cooperative_groups.h>
+
+#include "rxmesh/context.h"
+#include "rxmesh/kernels/loader.cuh"
+#include "rxmesh/kernels/rxmesh_queries.cuh"
+#include "rxmesh/kernels/shmem_allocator.cuh"
+#include "rxmesh/query_cache.h"
+#include "rxmesh/types.h"
+
+namespace rxmesh {
+namespace detail {
+
+/**
+ * @brief the actual number of offset and value entries of the output of the
+ * query op on a patch. For ops with variable-length output, the number of
+ * values is read from the last offset (i.e., s_output_offset should be
+ * populated)
+ */
+template <Op op>
+__device__ __forceinline__ void query_output_size(
+    const PatchInfo& patch_info,
+    const uint16_t*  s_output_offset,
+    uint32_t&        num_offset,
+    uint32_t&        num_value)
+{
+    QueryCache::output_size(op,
+                            patch_info.num_vertices[0],
+                            patch_info.num_edges[0],
+                            patch_info.num_faces[0],
+                            num_offset,
+                            num_value);
+    if (num_offset > 0) {
+        num_value = s_output_offset[num_offset - 1];
+    }
+}
+
+/**
+ * @brief load the cached output of the query op on a patch into shared memory
+ * instead of computing it. The layout is the same as the one produced by
+ * query() so the output could be used to construct the same iterators
+ */
+template <uint32_t blockThreads, Op op>
+__device__ __forceinline__ void load_cached_query(
+    cooperative_groups::thread_block& block,
+    const PatchInfo&                  patch_info,
+    const QueryCache&                 cache,
+    ShmemAllocator&                   shrd_alloc,
+    uint16_t*&                        s_output_offset,
+    uint16_t*&                        s_output_value)
+{
+    const uint32_t p = patch_info.patch_id;
+
+    uint32_t num_offset, num_value;
+    QueryCache::output_size(op,
+                            patch_info.num_vertices[0],
+                            patch_info.num_edges[0],
+                            patch_info.num_faces[0],
+                            num_offset,
+                            num_value);
+
+    if (num_offset > 0) {
+        s_output_offset = shrd_alloc.alloc<uint16_t>(num_offset);
+        load_async(block,
+                   cache.m_offset + cache.m_offset_start[p],
+                   num_offset,
+                   s_output_offset,
+                   true);
+        block.sync();
+        num_value = s_output_offset[num_offset - 1];
+    }
+
+    assert(num_value <= cache.m_value_start[p + 1] - cache.m_value_start[p]);
+
+    s_output_value = shrd_alloc.alloc<uint16_t>(num_value);
+    load_async(block,
+               cache.m_value + cache.m_value_start[p],
+               num_value,
+               s_output_value,
+               true);
+}
+
+/**
+ * @brief compute the query op on every patch and store its output in the
+ * cache. One block per patch
+ */
+template <uint32_t blockThreads, Op op>
+__global__ static void materialize_query(const Context    context,
+                                         const bool       oriented,
+                                         const QueryCache cache)
+{
+    const uint32_t p = blockIdx.x;
+    if (p >= cache.m_num_patches) {
+        return;
+    }
+
+    auto block = cooperative_groups::this_thread_block();
+
+    const PatchInfo& patch_info = context.m_patches_info[p];
+
+    ShmemAllocator shrd_alloc;
+    uint16_t*      s_output_offset(nullptr);
+    uint16_t*      s_output_value(nullptr);
+
+    query<blockThreads, op>(block,
+                            patch_info,
+                            shrd_alloc,
+                            s_output_offset,
+                            s_output_value,
+                            oriented);
+    block.sync();
+
+    uint32_t num_offset, num_value;
+    query_output_size<op>(patch_info, s_output_offset, num_offset, num_value);
+
+    assert(num_offset <=
+           cache.m_offset_start[p + 1] - cache.m_offset_start[p]);
+    assert(num_value <= cache.m_value_start[p + 1] - cache.m_value_start[p]);
+
+    // the output in shared memory is not necessarily 4-byte aligned (e.g., FF)
+    // so we don't use store()
+    uint16_t* offset = cache.m_offset + cache.m_offset_start[p];
+    for (uint32_t i = threadIdx.x; i < num_offset; i += blockThreads) {
+        offset[i] = s_output_offset[i];
+    }
+
+    uint16_t* value = cache.m_value + cache.m_value_start[p];
+    for (uint32_t i = threadIdx.x; i < num_value; i += blockThreads) {
+        value[i] = s_output_value[i];
+    }
+
+    if (threadIdx.x == 0) {
+        cache.m_valid[p] = 1;
+    }
+}
+
+}  // namespace detail
+}  // namespace rxmesh
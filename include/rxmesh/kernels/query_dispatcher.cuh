@@ -11,6 +11,7 @@
 #include "rxmesh/kernels/debug.cuh"
 #include "rxmesh/kernels/dynamic_util.cuh"
 #include "rxmesh/kernels/loader.cuh"
+#include "rxmesh/kernels/query_cache.cuh"
 #include "rxmesh/kernels/rxmesh_queries.cuh"
 #include "rxmesh/kernels/shmem_allocator.cuh"
 #include "rxmesh/types.h"
@@ -21,16 +22,52 @@ namespace rxmesh {
 
 namespace detail {
 
+/**
+ * @brief the active set used when no active set is given i.e., every owned
+ * and active element is a source. The dispatcher recognizes it and does not
+ * evaluate it
+ */
+template <typename HandleT>
+struct AllActive
+{
+    __device__ __forceinline__ bool operator()(const HandleT) const
+    {
+        return true;
+    }
+};
+
+template <typename T>
+struct is_all_active : std::false_type
+{
+};
+
+template <typename HandleT>
+struct is_all_active<AllActive<HandleT>> : std::true_type
+{
+};
+
 /**
  * query_block_dispatcher()
+ * s_ev_topo and s_fe_topo are optional shared memory copies of the patch EV
+ * and FE (see Query::begin_fused()) to be used instead of the global memory.
+ * query_cache is the optional materialized output of the query (see
+ * RXMeshStatic::enable_query_cache()) that is loaded instead of running the
+ * query if it is valid for this patch. oriented and allow_not_owned are either
+ * bool or std::bool_constant (i.e., std::true_type or std::false_type). With
+ * std::bool_constant, the flags are known at compile time and only the code
+ * of the given flags is generated (e.g., the oriented VV branches)
  */
-template <Op op, uint32_t blockThreads, typename activeSetT>
+template <Op op,
+          uint32_t blockThreads,
+          typename activeSetT,
+          typename OrientedT      = bool,
+          typename AllowNotOwnedT = bool>
 __device__ __inline__ void query_block_dispatcher(
     cooperative_groups::thread_block& block,
     ShmemAllocator&                   shrd_alloc,
     const PatchInfo&                  patch_info,
     activeSetT                        compute_active_set,
-    const bool                        oriented,
+    const OrientedT                   oriented,
     uint32_t&                         num_src_in_patch,
     uint16_t*&                        s_output_offset,
     uint16_t*&                        s_output_value,
@@ -38,12 +75,17 @@ __device__ __inline__ void query_block_dispatcher(
     uint32_t*&                        s_output_owned_bitmask,
     LPHashTable&                      output_lp_hashtable,
     LPPair*&                          s_table,
-    bool                              allow_not_owned = false)
+    const AllowNotOwnedT              allow_not_owned = false,
+    const uint16_t*                   s_ev_topo       = nullptr,
+    const uint16_t*                   s_fe_topo       = nullptr,
+    const QueryCache*                 query_cache     = nullptr)
 {
     num_src_in_patch                = 0;
     uint16_t    num_output_in_patch = 0;
     uint32_t *  input_active_mask, *input_owned_mask;
     LPHashTable hashtable;
+    // the hashtable is not needed if the patch has an owner table
+    const uint64_t* owner_table = nullptr;
     if constexpr (op == Op::VV || op == Op::VE || op == Op::VF) {
         num_src_in_patch  = patch_info.num_vertices[0];
         input_active_mask = patch_info.active_mask_v;
@@ -83,6 +125,7 @@ __device__ __inline__ void query_block_dispatcher(
                    reinterpret_cast<char*>(s_output_owned_bitmask),
                    false);
         output_lp_hashtable = patch_info.lp_v;
+        owner_table         = patch_info.owner_v;
     }
     if constexpr (op == Op::VE || op == Op::EE || op == Op::FE) {
         const uint32_t mask_size = mask_num_bytes(patch_info.num_edges[0]);
@@ -93,6 +136,7 @@ __device__ __inline__ void query_block_dispatcher(
                    reinterpret_cast<char*>(s_output_owned_bitmask),
                    false);
         output_lp_hashtable = patch_info.lp_e;
+        owner_table         = patch_info.owner_e;
     }
     if constexpr (op == Op::VF || op == Op::EF || op == Op::FF) {
         const uint32_t mask_size = mask_num_bytes(patch_info.num_faces[0]);
@@ -103,6 +147,7 @@ __device__ __inline__ void query_block_dispatcher(
                    reinterpret_cast<char*>(s_output_owned_bitmask),
                    false);
         output_lp_hashtable = patch_info.lp_f;
+        owner_table         = patch_info.owner_f;
     }
 
     // load table async
@@ -130,8 +175,11 @@ __device__ __inline__ void query_block_dispatcher(
                 bool is_del = is_deleted(local_id, input_active_mask);
                 bool is_own =
                     allow_not_owned || is_owned(local_id, input_owned_mask);
-                bool is_act =
-                    compute_active_set({patch_info.patch_id, local_id});
+                bool is_act = true;
+                if constexpr (!is_all_active<activeSetT>::value) {
+                    is_act =
+                        compute_active_set({patch_info.patch_id, local_id});
+                }
                 is_par = !is_del && is_own && is_act;
             }
             is_participant     = is_participant || is_par;
@@ -152,16 +200,32 @@ __device__ __inline__ void query_block_dispatcher(
     }
 
 
-    // Perform the query operation
-    query<blockThreads, op>(block,
-                            patch_info,
-                            shrd_alloc,
-                            s_output_offset,
-                            s_output_value,
-                            oriented);
+    // Perform the query operation or load its cached output
+    if (query_cache != nullptr &&
+        query_cache->is_valid(patch_info.patch_id, oriented)) {
+        load_cached_query<blockThreads, op>(block,
+                                            patch_info,
+                                            *query_cache,
+                                            shrd_alloc,
+                                            s_output_offset,
+                                            s_output_value);
+    } else {
+        query<blockThreads, op>(block,
+                                patch_info,
+                                shrd_alloc,
+                                s_output_offset,
+                                s_output_value,
+                                oriented,
+                                s_ev_topo,
+                                s_fe_topo);
+    }
 
     block.sync();
-    alloc_then_load_table(true);
+    if (owner_table == nullptr) {
+        alloc_then_load_table(true);
+    } else {
+        s_table = nullptr;
+    }
 
     //if constexpr (op == Op::FV || op == Op::VV || op == Op::FF ||
     //              op == Op::EVDiamond || op == Op::VE || op == Op::VF) {
@@ -180,7 +244,11 @@ __device__ __inline__ void query_block_dispatcher(
 /**
  * query_block_dispatcher()
  */
-template <Op op, uint32_t blockThreads, typename computeT, typename activeSetT>
+template <Op op,
+          uint32_t blockThreads,
+          typename computeT,
+          typename activeSetT,
+          typename OrientedT = bool>
 __device__ __inline__ void query_block_dispatcher(
     cooperative_groups::thread_block& block,
     ShmemAllocator&                   shrd_alloc,
@@ -188,7 +256,7 @@ __device__ __inline__ void query_block_dispatcher(
     const uint32_t                    patch_id,
     computeT                          compute_op,
     activeSetT                        compute_active_set,
-    const bool                        oriented = false)
+    const OrientedT                   oriented = false)
 {
     // Extract the type of the input parameters of the compute lambda function.
     // The first parameter should be Vertex/Edge/FaceHandle and second parameter
@@ -231,7 +299,11 @@ __device__ __inline__ void query_block_dispatcher(
                                              s_participant_bitmask,
                                              s_output_owned_bitmask,
                                              output_lp_hashtable,
-                                             s_table);
+                                             s_table,
+                                             std::false_type{},
+                                             nullptr,
+                                             nullptr,
+                                             context.get_query_cache(op));
 
     // Call compute on the output in shared memory by looping over all
     // source elements in this patch.
@@ -259,7 +331,10 @@ __device__ __inline__ void query_block_dispatcher(
                                   output_lp_hashtable,
                                   s_table,
                                   context.m_patches_info[patch_id].patch_stash,
-                                  int(op == Op::FE));
+                                  int(op == Op::FE),
+                                  context.m_patches_info[patch_id]
+                                      .template get_owner_table<
+                                          typename ComputeIteratorT::Handle>());
 
             compute_op(handle, iter);
         }
@@ -270,12 +345,17 @@ __device__ __inline__ void query_block_dispatcher(
 /**
  * query_block_dispatcher()
  */
-template <Op op, uint32_t blockThreads, typename computeT, typename activeSetT>
-__device__ __inline__ void query_block_dispatcher(const Context& context,
-                                                  const uint32_t patch_id,
-                                                  computeT       compute_op,
-                                                  activeSetT compute_active_set,
-                                                  const bool oriented = false)
+template <Op op,
+          uint32_t blockThreads,
+          typename computeT,
+          typename activeSetT,
+          typename OrientedT = bool>
+__device__ __inline__ void query_block_dispatcher(
+    const Context&  context,
+    const uint32_t  patch_id,
+    computeT        compute_op,
+    activeSetT      compute_active_set,
+    const OrientedT oriented = false)
 {
     namespace cg           = cooperative_groups;
     cg::thread_block block = cg::this_thread_block();
@@ -316,25 +396,32 @@ __device__ __inline__ void query_block_dispatcher(const Context& context,
  * lambda function take a single parameter which is a handle of the type similar
  * to the input of the query operation (e.g., VertexHandle for VE query)
  * @param oriented specifies if the query are oriented. Currently only VV query
- * is supported for oriented queries. FV, FE and EV is oriented by default
+ * is supported for oriented queries. FV, FE and EV is oriented by default. It
+ * could also be std::true_type or std::false_type such that only the code of
+ * the given orientation is generated (see detail::query_block_dispatcher())
  */
-template <Op op, uint32_t blockThreads, typename computeT, typename activeSetT>
+template <Op op,
+          uint32_t blockThreads,
+          typename computeT,
+          typename activeSetT,
+          typename OrientedT = bool>
 __device__ __inline__ void query_block_dispatcher(
     cooperative_groups::thread_block& block,
     ShmemAllocator&                   shrd_alloc,
     const Context&                    context,
     computeT                          compute_op,
     activeSetT                        compute_active_set,
-    const bool                        oriented = false)
+    const OrientedT                   oriented = false)
 {
-    if (blockIdx.x >= context.m_num_patches[0]) {
+    const uint32_t p_id = context.block_patch_id();
+    if (p_id >= context.m_num_patches[0] || !context.is_patch_in_range(p_id)) {
         return;
     }
 
     detail::query_block_dispatcher<op, blockThreads>(block,
                                                      shrd_alloc,
                                                      context,
-                                                     blockIdx.x,
+                                                     p_id,
                                                      compute_op,
                                                      compute_active_set,
                                                      oriented);
@@ -344,18 +431,24 @@ __device__ __inline__ void query_block_dispatcher(
  * @brief same as the above function but no cooperative group or shared memory
  * allocator needed
  */
-template <Op op, uint32_t blockThreads, typename computeT, typename activeSetT>
-__device__ __inline__ void query_block_dispatcher(const Context& context,
-                                                  computeT       compute_op,
-                                                  activeSetT compute_active_set,
-                                                  const bool oriented = false)
+template <Op op,
+          uint32_t blockThreads,
+          typename computeT,
+          typename activeSetT,
+          typename OrientedT = bool>
+__device__ __inline__ void query_block_dispatcher(
+    const Context&  context,
+    computeT        compute_op,
+    activeSetT      compute_active_set,
+    const OrientedT oriented = false)
 {
-    if (blockIdx.x >= context.m_num_patches[0]) {
+    const uint32_t p_id = context.block_patch_id();
+    if (p_id >= context.m_num_patches[0] || !context.is_patch_in_range(p_id)) {
         return;
     }
 
     detail::query_block_dispatcher<op, blockThreads>(
-        context, blockIdx.x, compute_op, compute_active_set, oriented);
+        context, p_id, compute_op, compute_active_set, oriented);
 }
 
 
@@ -391,14 +484,31 @@ __device__ __inline__ void query_block_dispatcher(
     // function. It should be Vertex/Edge/FaceHandle
     using ComputeTraits  = detail::FunctionTraits<computeT>;
     using ComputeHandleT = typename ComputeTraits::template arg<0>::type;
+    using AllActiveT     = detail::AllActive<ComputeHandleT>;
+
+    query_block_dispatcher<op, blockThreads>(
+        block, shrd_alloc, context, compute_op, AllActiveT{}, oriented);
+}
+
+/**
+ * @brief same as the above function but the orientation is known at compile
+ * time (std::true_type or std::false_type) such that only its code is
+ * generated
+ */
+template <Op op, uint32_t blockThreads, typename computeT, bool orientedT>
+__device__ __inline__ void query_block_dispatcher(
+    cooperative_groups::thread_block&   block,
+    ShmemAllocator&                     shrd_alloc,
+    const Context&                      context,
+    computeT                            compute_op,
+    const std::bool_constant<orientedT> oriented)
+{
+    using ComputeTraits  = detail::FunctionTraits<computeT>;
+    using ComputeHandleT = typename ComputeTraits::template arg<0>::type;
+    using AllActiveT     = detail::AllActive<ComputeHandleT>;
 
     query_block_dispatcher<op, blockThreads>(
-        block,
-        shrd_alloc,
-        context,
-        compute_op,
-        [](ComputeHandleT) { return true; },
-        oriented);
+        block, shrd_alloc, context, compute_op, AllActiveT{}, oriented);
 }
 
 /**
@@ -416,7 +526,24 @@ __device__ __inline__ void query_block_dispatcher(const Context& context,
     using ComputeHandleT = typename ComputeTraits::template arg<0>::type;
 
     query_block_dispatcher<op, blockThreads>(
-        context, compute_op, [](ComputeHandleT) { return true; }, oriented);
+        context, compute_op, detail::AllActive<ComputeHandleT>{}, oriented);
+}
+
+/**
+ * @brief same as the above function but the orientation is known at compile
+ * time (std::true_type or std::false_type)
+ */
+template <Op op, uint32_t blockThreads, typename computeT, bool orientedT>
+__device__ __inline__ void query_block_dispatcher(
+    const Context&                      context,
+    computeT                            compute_op,
+    const std::bool_constant<orientedT> oriented)
+{
+    using ComputeTraits  = detail::FunctionTraits<computeT>;
+    using ComputeHandleT = typename ComputeTraits::template arg<0>::type;
+
+    query_block_dispatcher<op, blockThreads>(
+        context, compute_op, detail::AllActive<ComputeHandleT>{}, oriented);
 }
 
 
@@ -535,7 +662,11 @@ __device__ __inline__ void higher_query_block_dispatcher(
             s_participant_bitmask,
             s_output_owned_bitmask,
             output_lp_hashtable,
-            s_table);
+            s_table,
+            false,
+            nullptr,
+            nullptr,
+            context.get_query_cache(op));
 
 
         if (pl.first == patch_id) {
@@ -558,7 +689,10 @@ __device__ __inline__ void higher_query_block_dispatcher(
                 output_lp_hashtable,
                 s_table,
                 context.m_patches_info[patch_id].patch_stash,
-                int(op == Op::FE));
+                int(op == Op::FE),
+                context.m_patches_info[patch_id]
+                    .template get_owner_table<
+                        typename ComputeIteratorT::Handle>());
 
             compute_op(src_id, iter);
         }
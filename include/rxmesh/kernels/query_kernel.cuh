@@ -5,14 +5,24 @@
 
 #include "rxmesh/context.h"
 #include "rxmesh/iterator.cuh"
+#include "rxmesh/kernels/query_tile_dispatcher.cuh"
 #include "rxmesh/query.cuh"
 
 namespace rxmesh {
 namespace detail {
-template <uint32_t blockThreads, Op op, typename LambdaT>
-__global__ static void query_kernel(const Context context,
-                                    const bool    oriented,
-                                    LambdaT       user_lambda)
+/**
+ * @brief one block per patch that runs the query op and calls the user lambda
+ * on its output. oriented is std::true_type or std::false_type (default) such
+ * that every instantiation only has the code (and registers) of its
+ * orientation. A (runtime) bool is still accepted
+ */
+template <uint32_t blockThreads,
+          Op op,
+          typename LambdaT,
+          typename OrientedT = std::false_type>
+__global__ static void query_kernel(const Context   context,
+                                    const OrientedT oriented,
+                                    LambdaT         user_lambda)
 {
     auto block = cooperative_groups::this_thread_block();
 
@@ -22,5 +32,41 @@ __global__ static void query_kernel(const Context context,
 
     query.dispatch<op>(block, shrd_alloc, user_lambda, oriented);
 }
+
+/**
+ * @brief check if the query op has an oriented variant (see query())
+ */
+template <Op op>
+constexpr bool has_oriented_query()
+{
+    return op == Op::VV || op == Op::VE;
+}
+
+/**
+ * @brief the instantiation of query_kernel() that is launched for the given
+ * orientation (see RXMeshStatic::run_query_kernel())
+ */
+template <uint32_t blockThreads, Op op, typename LambdaT>
+const void* query_kernel_ptr(const bool oriented)
+{
+    if constexpr (has_oriented_query<op>()) {
+        if (oriented) {
+            return (const void*)
+                query_kernel<blockThreads, op, LambdaT, std::true_type>;
+        }
+    }
+    return (const void*)
+        query_kernel<blockThreads, op, LambdaT, std::false_type>;
+}
+
+template <uint32_t blockThreads, uint32_t tileSize, Op op, typename LambdaT>
+__global__ static void query_tile_kernel(const Context context,
+                                         LambdaT       user_lambda)
+{
+    auto block = cooperative_groups::this_thread_block();
+
+    query_tile_dispatcher<op, blockThreads, tileSize>(
+        block, context, user_lambda);
+}
 }  // namespace detail
 }  // namespace rxmesh
\ No newline at end of file
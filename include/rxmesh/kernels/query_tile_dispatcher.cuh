@@ -0,0 +1,200 @@
+#pragma once
+#include <assert.h>
+#include <cooperative_groups.h>
+#include <stdint.h>
+
+#include "rxmesh/context.h"
+#include "rxmesh/handle.h"
+#include "rxmesh/iterator.cuh"
+#include "rxmesh/kernels/loader.cuh"
+#include "rxmesh/kernels/rxmesh_tile_queries.cuh"
+#include "rxmesh/kernels/shmem_allocator.cuh"
+#include "rxmesh/types.h"
+#include "rxmesh/util/bitmask_util.h"
+#include "rxmesh/util/meta.h"
+
+namespace rxmesh {
+
+/**
+ * @brief Tile-level version of query_block_dispatcher() where every
+ * thread_block_tile of size tileSize in the block processes a different patch.
+ * This increases the number of patches processed concurrently on small
+ * patches where one block per patch is limited by the shared memory per block.
+ * The dynamic shared memory of the block is split evenly between its tiles
+ * (see RXMeshStatic::prepare_tile_launch_box()). Patch p is processed by tile
+ * (p % tiles_per_block) of block (p / tiles_per_block). Oriented queries,
+ * Op::EVDiamond, and Op::EE are not supported
+ * @tparam Op the type of query operation
+ * @tparam blockThreads the number of CUDA threads in the block
+ * @tparam tileSize the number of threads in the tile (at most 32)
+ * @tparam computeT the type of compute lambda function (inferred)
+ * @tparam activeSetT the type of active set lambda function (inferred)
+ * @param block cooperative group block
+ * @param context which store various parameters needed for the query
+ * operation. The context can be obtained from RXMeshStatic
+ * @param compute_op the computation lambda function (same as
+ * query_block_dispatcher())
+ * @param compute_active_set a predicate used to specify the active set (same
+ * as query_block_dispatcher())
+ */
+template <Op       op,
+          uint32_t blockThreads,
+          uint32_t tileSize,
+          typename computeT,
+          typename activeSetT>
+__device__ __inline__ void query_tile_dispatcher(
+    cooperative_groups::thread_block& block,
+    const Context&                    context,
+    computeT                          compute_op,
+    activeSetT                        compute_active_set)
+{
+    static_assert(blockThreads % tileSize == 0,
+                  "query_tile_dispatcher() blockThreads should be a multiple "
+                  "of tileSize");
+    static_assert(tileSize <= 32,
+                  "query_tile_dispatcher() tileSize should be at most 32");
+
+    using ComputeTraits    = detail::FunctionTraits<computeT>;
+    using ComputeHandleT   = typename ComputeTraits::template arg<0>::type;
+    using ComputeIteratorT = typename ComputeTraits::template arg<1>::type;
+    using LocalT           = typename ComputeIteratorT::LocalT;
+
+    constexpr uint32_t tiles_per_block = blockThreads / tileSize;
+
+    auto tile = cooperative_groups::tiled_partition<tileSize>(block);
+
+    const uint32_t tile_id  = threadIdx.x / tileSize;
+    const uint32_t patch_id =
+        context.subset_patch_id(blockIdx.x * tiles_per_block + tile_id);
+
+    if (patch_id >= context.m_num_patches[0] ||
+        !context.is_patch_in_range(patch_id)) {
+        return;
+    }
+
+    // every tile gets an equal chunk of the dynamic shared memory. The chunk
+    // size is a multiple of the alignment (see prepare_tile_launch_box())
+    const uint32_t tile_smem =
+        ShmemAllocator().get_max_size_bytes() / tiles_per_block;
+    assert(tile_smem % ShmemAllocator::default_alignment == 0);
+    ShmemAllocator shrd_alloc(tile_id * tile_smem);
+
+    const PatchInfo& patch_info = context.m_patches_info[patch_id];
+
+    uint32_t    num_src_in_patch = 0;
+    uint32_t *  input_active_mask, *input_owned_mask, *output_owned_mask;
+    uint32_t    num_output_in_patch = 0;
+    LPHashTable output_lp_hashtable;
+
+    if constexpr (op == Op::VV || op == Op::VE || op == Op::VF) {
+        num_src_in_patch  = patch_info.num_vertices[0];
+        input_active_mask = patch_info.active_mask_v;
+        input_owned_mask  = patch_info.owned_mask_v;
+    }
+    if constexpr (op == Op::EV || op == Op::EF) {
+        num_src_in_patch  = patch_info.num_edges[0];
+        input_active_mask = patch_info.active_mask_e;
+        input_owned_mask  = patch_info.owned_mask_e;
+    }
+    if constexpr (op == Op::FV || op == Op::FE || op == Op::FF) {
+        num_src_in_patch  = patch_info.num_faces[0];
+        input_active_mask = patch_info.active_mask_f;
+        input_owned_mask  = patch_info.owned_mask_f;
+    }
+
+    if constexpr (op == Op::VV || op == Op::EV || op == Op::FV) {
+        num_output_in_patch = patch_info.num_vertices[0];
+        output_owned_mask   = patch_info.owned_mask_v;
+        output_lp_hashtable = patch_info.lp_v;
+    }
+    if constexpr (op == Op::VE || op == Op::FE) {
+        num_output_in_patch = patch_info.num_edges[0];
+        output_owned_mask   = patch_info.owned_mask_e;
+        output_lp_hashtable = patch_info.lp_e;
+    }
+    if constexpr (op == Op::VF || op == Op::EF || op == Op::FF) {
+        num_output_in_patch = patch_info.num_faces[0];
+        output_owned_mask   = patch_info.owned_mask_f;
+        output_lp_hashtable = patch_info.lp_f;
+    }
+
+    // alloc and load owned mask async
+    const uint32_t mask_size = mask_num_bytes(num_output_in_patch);
+    uint32_t*      s_output_owned_bitmask =
+        reinterpret_cast<uint32_t*>(shrd_alloc.alloc(mask_size));
+    detail::load_async(tile,
+                       reinterpret_cast<char*>(output_owned_mask),
+                       mask_size,
+                       reinterpret_cast<char*>(s_output_owned_bitmask),
+                       false);
+
+    // Perform the query operation
+    uint16_t* s_output_offset(nullptr);
+    uint16_t* s_output_value(nullptr);
+    detail::tile_query<tileSize, op>(
+        tile, patch_info, shrd_alloc, s_output_offset, s_output_value);
+
+    // the hashtable is not needed if the patch has an owner table
+    using OutputHandleT = typename ComputeIteratorT::Handle;
+    const uint64_t* owner_table =
+        patch_info.template get_owner_table<OutputHandleT>();
+
+    LPPair* s_table = nullptr;
+    if (owner_table == nullptr) {
+        s_table = shrd_alloc.alloc<LPPair>(output_lp_hashtable.get_capacity());
+        output_lp_hashtable.load_in_shared_memory(tile, s_table, true);
+    }
+    tile.sync();
+
+    constexpr uint32_t fixed_offset =
+        ((op == Op::EV) ? 2 : ((op == Op::FV || op == Op::FE) ? 3 : 0));
+
+    for (uint16_t local_id = tile.thread_rank(); local_id < num_src_in_patch;
+         local_id += tileSize) {
+
+        if (is_deleted(local_id, input_active_mask) ||
+            !is_owned(local_id, input_owned_mask)) {
+            continue;
+        }
+
+        ComputeHandleT handle(patch_id, local_id);
+
+        if (!compute_active_set(handle)) {
+            continue;
+        }
+
+        ComputeIteratorT iter(context,
+                              local_id,
+                              reinterpret_cast<LocalT*>(s_output_value),
+                              s_output_offset,
+                              fixed_offset,
+                              patch_id,
+                              s_output_owned_bitmask,
+                              output_lp_hashtable,
+                              s_table,
+                              patch_info.patch_stash,
+                              int(op == Op::FE),
+                              owner_table);
+
+        compute_op(handle, iter);
+    }
+}
+
+/**
+ * @brief same as the above function but with no active set i.e., all owned
+ * and active mesh elements are processed
+ */
+template <Op op, uint32_t blockThreads, uint32_t tileSize, typename computeT>
+__device__ __inline__ void query_tile_dispatcher(
+    cooperative_groups::thread_block& block,
+    const Context&                    context,
+    computeT                          compute_op)
+{
+    using ComputeTraits  = detail::FunctionTraits<computeT>;
+    using ComputeHandleT = typename ComputeTraits::template arg<0>::type;
+
+    query_tile_dispatcher<op, blockThreads, tileSize>(
+        block, context, compute_op, [](ComputeHandleT) { return true; });
+}
+
+}  // namespace rxmesh
@@ -0,0 +1,147 @@
+#pragma once
+#include <stdint.h>
+
+#include "rxmesh/context.h"
+#include "rxmesh/handle.h"
+#include "rxmesh/kernels/for_each.cuh"
+#include "rxmesh/patch_info.h"
+
+namespace rxmesh {
+
+namespace detail {
+
+/**
+ * @brief the compact index of an owned and active mesh element given the
+ * exclusive prefix sum of the number of owned and active elements per patch.
+ * This is the same as Context::linear_id() but with a prefix that is computed
+ * on the device (see render_count_owned()) such that it is valid right after
+ * topology changes without updating the host
+ */
+template <typename HandleT>
+__device__ __inline__ uint32_t render_id(const Context&  context,
+                                         const uint32_t* prefix,
+                                         const HandleT   input)
+{
+    const HandleT owner = context.get_owner_handle(input);
+
+    const uint32_t   p_id = owner.patch_id();
+    const PatchInfo& pi   = context.m_patches_info[p_id];
+
+    return prefix[p_id] + pi.count_num_owned(pi.get_owned_mask<HandleT>(),
+                                             pi.get_active_mask<HandleT>(),
+                                             owner.local_id());
+}
+
+/**
+ * @brief the number of owned and active vertices and faces of every patch
+ * with one thread per patch. Patches that do not exist (yet) count as zero
+ */
+__global__ static void render_count_owned(const Context context,
+                                          const uint32_t max_num_patches,
+                                          uint32_t*      count_v,
+                                          uint32_t*      count_f)
+{
+    const uint32_t p_id = threadIdx.x + blockIdx.x * blockDim.x;
+    if (p_id >= max_num_patches) {
+        return;
+    }
+    uint32_t nv = 0, nf = 0;
+
+    if (p_id < context.m_num_patches[0] &&
+        context.m_patches_info[p_id].patch_id != INVALID32) {
+        const PatchInfo& pi = context.m_patches_info[p_id];
+
+        nv = pi.get_num_owned<VertexHandle>();
+        nf = pi.get_num_owned<FaceHandle>();
+    }
+    count_v[p_id] = nv;
+    count_f[p_id] = nf;
+}
+
+/**
+ * @brief write the position of every owned and active vertex at its compact
+ * index. One block per patch
+ */
+template <typename CoordT>
+__global__ static void render_compact_vertices(const Context   context,
+                                               const uint32_t* prefix_v,
+                                               CoordT          coords,
+                                               float*          pos)
+{
+    const uint32_t p_id = blockIdx.x;
+    if (p_id >= context.m_num_patches[0] ||
+        context.m_patches_info[p_id].patch_id == INVALID32) {
+        return;
+    }
+
+    for_each_vertex(context.m_patches_info[p_id], [&](const VertexHandle vh) {
+        const uint32_t id = render_id(context, prefix_v, vh);
+        for (int i = 0; i < 3; ++i) {
+            pos[3 * id + i] = static_cast<float>(coords(vh, i));
+        }
+    });
+}
+
+/**
+ * @brief write the three vertex compact indices of every owned and active
+ * face at the face compact index. One block per patch
+ */
+__global__ static void render_compact_faces(const Context   context,
+                                            const uint32_t* prefix_v,
+                                            const uint32_t* prefix_f,
+                                            uint32_t*       indices)
+{
+    const uint32_t p_id = blockIdx.x;
+    if (p_id >= context.m_num_patches[0] ||
+        context.m_patches_info[p_id].patch_id == INVALID32) {
+        return;
+    }
+
+    const PatchInfo& pi = context.m_patches_info[p_id];
+
+    for_each_face(pi, [&](const FaceHandle fh) {
+        const uint32_t id = render_id(context, prefix_f, fh);
+
+        for (uint32_t e = 0; e < 3; ++e) {
+            uint16_t edge = pi.fe[3 * fh.local_id() + e].id;
+            flag_t   dir(0);
+            Context::unpack_edge_dir(edge, edge, dir);
+            const uint16_t     e_id = (2 * edge) + dir;
+            const VertexHandle vh(p_id, pi.ev[e_id].id);
+
+            indices[3 * id + e] = render_id(context, prefix_v, vh);
+        }
+    });
+}
+
+/**
+ * @brief write one component of an attribute at the compact index of every
+ * owned and active mesh element. One block per patch
+ */
+template <typename HandleT, typename AttrT>
+__global__ static void render_compact_scalar(const Context   context,
+                                             const uint32_t* prefix,
+                                             AttrT           attr,
+                                             const uint32_t  attr_id,
+                                             float*          out)
+{
+    const uint32_t p_id = blockIdx.x;
+    if (p_id >= context.m_num_patches[0] ||
+        context.m_patches_info[p_id].patch_id == INVALID32) {
+        return;
+    }
+
+    auto store = [&](const HandleT h) {
+        out[render_id(context, prefix, h)] =
+            static_cast<float>(attr(h, attr_id));
+    };
+
+    if constexpr (std::is_same_v<HandleT, VertexHandle>) {
+        for_each_vertex(context.m_patches_info[p_id], store);
+    }
+    if constexpr (std::is_same_v<HandleT, FaceHandle>) {
+        for_each_face(context.m_patches_info[p_id], store);
+    }
+}
+}  // namespace detail
+}  // namespace rxmesh
@@ -5,30 +5,43 @@
 
 #include "rxmesh/context.h"
 #include "rxmesh/kernels/collective.cuh"
+#include "rxmesh/kernels/compressed_topology.cuh"
 #include "rxmesh/kernels/dynamic_util.cuh"
 #include "rxmesh/kernels/loader.cuh"
+#include "rxmesh/kernels/shmem_plan.cuh"
 #include "rxmesh/kernels/util.cuh"
 #include "rxmesh/types.h"
 
 namespace rxmesh {
 namespace detail {
 
-template <uint32_t rowOffset, uint32_t blockThreads>
+/**
+ * @brief transpose the matrix mat (with rowOffset non-zeros per row) in
+ * place: output holds the row ids of the transposed matrix and mat holds its
+ * offset. temp_size and temp_local are the per-column counters (see
+ * TransposeShmemPlan) whose type CounterT could be uint16_t or uint32_t
+ */
+template <uint32_t rowOffset, uint32_t blockThreads, typename CounterT>
 __device__ __forceinline__ void block_mat_transpose(
     const uint32_t  num_rows,
     const uint32_t  num_cols,
     uint16_t*       mat,
     uint16_t*       output,
-    uint16_t*       temp_size,   // size = num_cols +1
-    uint16_t*       temp_local,  // size = num_cols
+    CounterT*       temp_size,   // size = num_cols +1
+    CounterT*       temp_local,  // size = num_cols
     const uint32_t* row_active_mask,
     const uint32_t* col_active_mask,
     int             shift)
 {
+    static_assert(std::is_same_v<CounterT, uint16_t> ||
+                      std::is_same_v<CounterT, uint32_t>,
+                  "block_mat_transpose() counters should be uint16_t or "
+                  "uint32_t");
+
     const uint32_t nnz = num_rows * rowOffset;
 
-    fill_n<blockThreads>(temp_size, num_cols + 1, uint16_t(0));
-    fill_n<blockThreads>(temp_local, num_cols, uint16_t(0));
+    fill_n<blockThreads>(temp_size, num_cols + 1, CounterT(0));
+    fill_n<blockThreads>(temp_local, num_cols, CounterT(0));
     __syncthreads();
 
     // const uint32_t  half_nnz = DIVIDE_UP(nnz, 2);
@@ -63,13 +76,13 @@ __device__ __forceinline__ void block_mat_transpose(
 
             assert(c < num_cols);
             assert(!detail::is_deleted(c, col_active_mask));
-            atomicAdd(temp_size + c, 1u);
+            atomicAdd(temp_size + c, CounterT(1));
         }
     }
 
     __syncthreads();
 
-    cub_block_exclusive_sum<uint16_t, blockThreads>(temp_size, num_cols);
+    cub_block_exclusive_sum<CounterT, blockThreads>(temp_size, num_cols);
 
 
     for (int i = threadIdx.x; i < nnz; i += blockThreads) {
@@ -84,9 +97,10 @@ __device__ __forceinline__ void block_mat_transpose(
 
             assert(!detail::is_deleted(col_id, col_active_mask));
 
-            const uint16_t local_id = atomicAdd(temp_local + col_id, 1u);
+            const uint16_t local_id =
+                uint16_t(atomicAdd(temp_local + col_id, CounterT(1)));
 
-            const uint16_t prefix = temp_size[col_id];
+            const uint16_t prefix = uint16_t(temp_size[col_id]);
 
             assert(local_id < temp_size[col_id + 1] - temp_size[col_id]);
             assert(local_id < nnz);
@@ -102,7 +116,7 @@ __device__ __forceinline__ void block_mat_transpose(
 
     // assert(temp_size[num_cols] == nnz);
     for (int i = threadIdx.x; i < num_cols + 1; i += blockThreads) {
-        mat[i] = temp_size[i];
+        mat[i] = uint16_t(temp_size[i]);
     }
 }
 
@@ -214,11 +228,12 @@ __device__ __forceinline__ void e_v_diamond(
         s_output_value[e] = INVALID16;
     }
 
-    load_async(block,
-               reinterpret_cast<uint16_t*>(patch_info.fe),
-               3 * num_faces,
-               s_fe,
-               true);
+    load_topology(block,
+                  patch_info,
+                  reinterpret_cast<const uint16_t*>(patch_info.fe),
+                  3 * num_faces,
+                  s_fe,
+                  true);
 
     block.sync();
 
@@ -377,12 +392,17 @@ __device__ __forceinline__ void orient_edges_around_vertices(
     const PatchInfo& patch_info,
     ShmemAllocator&  shrd_alloc,
     uint16_t*&       s_output_offset,
-    uint16_t*&       s_output_value)
+    uint16_t*&       s_output_value,
+    const uint16_t*  fe = nullptr)
 {
     const uint16_t num_edges    = patch_info.num_edges[0];
     const uint16_t num_faces    = patch_info.num_faces[0];
     const uint16_t num_vertices = patch_info.num_vertices[0];
 
+    if (fe == nullptr) {
+        fe = reinterpret_cast<const uint16_t*>(patch_info.fe);
+    }
+
 
     // start by loading the faces while also doing transposing EV
     uint16_t* s_fe = shrd_alloc.alloc<uint16_t>(3 * num_faces);
@@ -392,10 +412,12 @@ __device__ __forceinline__ void orient_edges_around_vertices(
         s_ef[i] = INVALID16;
     }
 
-    load_async(reinterpret_cast<const uint16_t*>(patch_info.fe),
-               3 * num_faces,
-               reinterpret_cast<uint16_t*>(s_fe),
-               true);
+    load_topology(cooperative_groups::this_thread_block(),
+                  patch_info,
+                  fe,
+                  3 * num_faces,
+                  s_fe,
+                  true);
 
     // We could have used block_mat_transpose to transpose FE so we can look
     // up the "two" faces sharing an edge. But we can do better because we know
@@ -515,8 +537,10 @@ __device__ __forceinline__ void v_e(const uint16_t  num_vertices,
     // num_edges*2 (zero is stored and the end can be inferred). Thus,
     // d_output should be allocated to size = num_edges*2
 
-    uint16_t* s_temp_size  = shrd_alloc.alloc<uint16_t>(num_vertices + 1);
-    uint16_t* s_temp_local = shrd_alloc.alloc<uint16_t>(num_vertices);
+    TransposeShmemPlan temp_plan = transpose_shmem_plan(num_vertices);
+    temp_plan.carve(shrd_alloc);
+    TransposeCounterT* s_temp_size  = temp_plan.get<0>();
+    TransposeCounterT* s_temp_local = temp_plan.get<1>();
 
     block_mat_transpose<2u, blockThreads>(num_edges,
                                           num_vertices,
@@ -528,20 +552,22 @@ __device__ __forceinline__ void v_e(const uint16_t  num_vertices,
                                           active_mask_v,
                                           0);
 
-    shrd_alloc.dealloc<uint16_t>(2 * num_vertices + 1);
+    temp_plan.release(shrd_alloc);
 
     // block_mat_transpose<2u, blockThreads, itemPerThread>(
     //     num_edges, num_vertices, d_edges, d_output, active_mask_e, 0);
 }
 
-template <uint32_t blockThreads>
+template <uint32_t blockThreads, typename OrientedT = bool>
 __device__ __forceinline__ void v_v(cooperative_groups::thread_block& block,
                                     const PatchInfo& patch_info,
                                     ShmemAllocator&  shrd_alloc,
                                     uint16_t*        s_output_offset,
                                     uint16_t*        s_output_value,
-                                    bool             oriented,
-                                    bool             smem_dup)
+                                    OrientedT        oriented,
+                                    bool             smem_dup,
+                                    const uint16_t*  ev = nullptr,
+                                    const uint16_t*  fe = nullptr)
 {
     // smem_dup indicate if we should store the duplicated EV in shared memory
     // if oriented is false, we have the option to either store the duplicated
@@ -556,12 +582,19 @@ __device__ __forceinline__ void v_v(cooperative_groups::thread_block& block,
     //  incident to each vertex. After that we need to replace each edge with
     //  the other end vertex which is duplicated by writing it to
     //  s_edges_duplicate
+    //  ev (and fe for oriented) is where EV (and FE) is read from instead of
+    //  patch_info. It defaults to the global memory but could also be the
+    //  shared memory copy of the patch topology loaded once for fused queries
     const uint16_t  num_vertices   = patch_info.num_vertices[0];
     const uint16_t  num_edges      = patch_info.num_edges[0];
     const uint32_t* active_mask_e  = patch_info.active_mask_e;
     const uint32_t* active_mask_v  = patch_info.active_mask_v;
     uint16_t*       s_ev_duplicate = nullptr;
 
+    if (ev == nullptr) {
+        ev = reinterpret_cast<const uint16_t*>(patch_info.ev);
+    }
+
     // assert(2 * 2 * num_edges >= num_vertices + 1 + 2 * num_edges);
 
     if (!oriented && smem_dup) {
@@ -576,7 +609,7 @@ __device__ __forceinline__ void v_v(cooperative_groups::thread_block& block,
         // we should sync here to avoid writing to s_ev before reading it into
         // s_ev_duplicate but we rely on the sync in block_mat_transpose
     } else if (!smem_dup) {
-        s_ev_duplicate = reinterpret_cast<uint16_t*>(patch_info.ev);
+        s_ev_duplicate = const_cast<uint16_t*>(ev);
     }
 
     v_e<blockThreads>(num_vertices,
@@ -591,17 +624,14 @@ __device__ __forceinline__ void v_v(cooperative_groups::thread_block& block,
         block.sync();
 
         orient_edges_around_vertices<blockThreads>(
-            patch_info, shrd_alloc, s_output_offset, s_output_value);
+            patch_info, shrd_alloc, s_output_offset, s_output_value, fe);
 
         block.sync();
 
         s_ev_duplicate = shrd_alloc.alloc<uint16_t>(2 * num_edges);
 
-        load_async(block,
-                   reinterpret_cast<uint16_t*>(patch_info.ev),
-                   2 * num_edges,
-                   s_ev_duplicate,
-                   true);
+        load_topology(
+            block, patch_info, ev, 2 * num_edges, s_ev_duplicate, true);
     }
 
     block.sync();
@@ -710,8 +740,10 @@ __device__ __forceinline__ void v_f(const uint16_t  num_faces,
     f_v<blockThreads>(num_edges, d_edges, num_faces, d_faces, active_mask_f);
     __syncthreads();
 
-    uint16_t* s_temp_size  = shrd_alloc.alloc<uint16_t>(num_vertices + 1);
-    uint16_t* s_temp_local = shrd_alloc.alloc<uint16_t>(num_vertices);
+    TransposeShmemPlan temp_plan = transpose_shmem_plan(num_vertices);
+    temp_plan.carve(shrd_alloc);
+    TransposeCounterT* s_temp_size  = temp_plan.get<0>();
+    TransposeCounterT* s_temp_local = temp_plan.get<1>();
 
     block_mat_transpose<3u, blockThreads>(num_faces,
                                           num_vertices,
@@ -723,7 +755,7 @@ __device__ __forceinline__ void v_f(const uint16_t  num_faces,
                                           active_mask_v,
                                           0);
 
-    shrd_alloc.dealloc<uint16_t>(2 * num_vertices + 1);
+    temp_plan.release(shrd_alloc);
 
     // block_mat_transpose<3u, blockThreads>(
     //     num_faces, num_vertices, d_faces, d_edges, active_mask_f, 0);
@@ -748,8 +780,10 @@ __device__ __forceinline__ void e_f(const uint16_t  num_edges,
     // num_faces*3 (zero is stored and the end can be inferred). Thus,
     // d_output should be allocated to size = num_faces*3
 
-    uint16_t* s_temp_size  = shrd_alloc.alloc<uint16_t>(num_edges + 1);
-    uint16_t* s_temp_local = shrd_alloc.alloc<uint16_t>(num_edges);
+    TransposeShmemPlan temp_plan = transpose_shmem_plan(num_edges);
+    temp_plan.carve(shrd_alloc);
+    TransposeCounterT* s_temp_size  = temp_plan.get<0>();
+    TransposeCounterT* s_temp_local = temp_plan.get<1>();
 
     block_mat_transpose<3u, blockThreads>(num_faces,
                                           num_edges,
@@ -761,7 +795,7 @@ __device__ __forceinline__ void e_f(const uint16_t  num_edges,
                                           active_mask_e,
                                           shift);
 
-    shrd_alloc.dealloc<uint16_t>(2 * num_edges + 1);
+    temp_plan.release(shrd_alloc);
 
     // block_mat_transpose<3u, blockThreads>(
     //     num_faces, num_edges, d_faces, d_output, active_mask_f, shift);
@@ -776,18 +810,19 @@ __device__ __forceinline__ void f_f(cooperative_groups::thread_block& block,
                                     uint16_t*        s_FF_offset,
                                     uint16_t*        s_FF_output,
                                     const uint32_t*  active_mask_f,
-                                    const uint32_t*  active_mask_e)
+                                    const uint32_t*  active_mask_e,
+                                    const uint16_t*  fe = nullptr)
 {
+    if (fe == nullptr) {
+        fe = reinterpret_cast<const uint16_t*>(patch_info.fe);
+    }
+
     uint16_t* s_ef_offset =
         shrd_alloc.alloc<uint16_t>(std::max(num_edges + 1, 3 * num_faces));
 
     uint16_t* s_ef_val = shrd_alloc.alloc<uint16_t>(3 * num_faces);
 
-    load_async(block,
-               reinterpret_cast<uint16_t*>(patch_info.fe),
-               3 * num_faces,
-               s_ef_offset,
-               true);
+    load_topology(block, patch_info, fe, 3 * num_faces, s_ef_offset, true);
 
     __syncthreads();
 
@@ -804,11 +839,7 @@ __device__ __forceinline__ void f_f(cooperative_groups::thread_block& block,
 
     uint16_t* s_fe = shrd_alloc.alloc<uint16_t>(3 * num_faces);
 
-    load_async(block,
-               reinterpret_cast<uint16_t*>(patch_info.fe),
-               3 * num_faces,
-               s_fe,
-               true);
+    load_topology(block, patch_info, fe, 3 * num_faces, s_fe, true);
 
     __syncthreads();
 
@@ -857,14 +888,31 @@ __device__ __forceinline__ void f_f(cooperative_groups::thread_block& block,
     shrd_alloc.dealloc<uint16_t>(std::max(num_edges + 1, 3 * num_faces));
 }
 
-template <uint32_t blockThreads, Op op>
+/**
+ * @brief run the query op on the patch. oriented is either a bool or a
+ * std::bool_constant (i.e., std::true_type or std::false_type) in which case
+ * the branches of the other orientation are not generated
+ */
+template <uint32_t blockThreads, Op op, typename OrientedT = bool>
 __device__ __forceinline__ void query(cooperative_groups::thread_block& block,
                                       const PatchInfo& patch_info,
                                       ShmemAllocator&  shrd_alloc,
                                       uint16_t*&       s_output_offset,
                                       uint16_t*&       s_output_value,
-                                      bool             oriented)
+                                      OrientedT        oriented,
+                                      const uint16_t*  s_ev_topo = nullptr,
+                                      const uint16_t*  s_fe_topo = nullptr)
 {
+    // s_ev_topo and s_fe_topo are the patch topology already loaded in shared
+    // memory (fused queries) such that we copy it from there instead of
+    // reloading it from global memory. EVDiamond and EE always read from global
+    // memory
+    const uint16_t* ev = (s_ev_topo == nullptr) ?
+                             reinterpret_cast<const uint16_t*>(patch_info.ev) :
+                             s_ev_topo;
+    const uint16_t* fe = (s_fe_topo == nullptr) ?
+                             reinterpret_cast<const uint16_t*>(patch_info.fe) :
+                             s_fe_topo;
 
     if constexpr (op == Op::VV) {
         const uint16_t num_vertices = patch_info.num_vertices[0];
@@ -872,11 +920,7 @@ __device__ __forceinline__ void query(cooperative_groups::thread_block& block,
 
         uint16_t* s_ev = shrd_alloc.alloc<uint16_t>(
             std::max(num_vertices + 1, 2 * num_edges) + 2 * num_edges);
-        load_async(block,
-                   reinterpret_cast<uint16_t*>(patch_info.ev),
-                   2 * num_edges,
-                   s_ev,
-                   true);
+        load_topology(block, patch_info, ev, 2 * num_edges, s_ev, true);
         s_output_offset = &s_ev[0];
         s_output_value  = &s_ev[2 * num_edges];
         v_v<blockThreads>(block,
@@ -885,7 +929,9 @@ __device__ __forceinline__ void query(cooperative_groups::thread_block& block,
                           s_output_offset,
                           s_output_value,
                           oriented,
-                          true);
+                          true,
+                          ev,
+                          fe);
     }
 
     if constexpr (op == Op::VE) {
@@ -894,11 +940,7 @@ __device__ __forceinline__ void query(cooperative_groups::thread_block& block,
 
         uint16_t* s_ev = shrd_alloc.alloc<uint16_t>(
             std::max(num_vertices + 1, 2 * num_edges) + 2 * num_edges);
-        load_async(block,
-                   reinterpret_cast<uint16_t*>(patch_info.ev),
-                   2 * num_edges,
-                   s_ev,
-                   true);
+        load_topology(block, patch_info, ev, 2 * num_edges, s_ev, true);
         s_output_offset = s_ev;
         s_output_value  = &s_ev[2 * num_edges];
         v_e<blockThreads>(num_vertices,
@@ -910,7 +952,7 @@ __device__ __forceinline__ void query(cooperative_groups::thread_block& block,
                           patch_info.active_mask_v);
         if (oriented) {
             orient_edges_around_vertices<blockThreads>(
-                patch_info, shrd_alloc, s_output_offset, s_output_value);
+                patch_info, shrd_alloc, s_output_offset, s_output_value, fe);
         }
     }
 
@@ -923,16 +965,8 @@ __device__ __forceinline__ void query(cooperative_groups::thread_block& block,
             std::max(3 * num_faces, 1 + num_vertices));
         uint16_t* s_ev =
             shrd_alloc.alloc<uint16_t>(std::max(2 * num_edges, 3 * num_faces));
-        load_async(block,
-                   reinterpret_cast<uint16_t*>(patch_info.fe),
-                   3 * num_faces,
-                   s_fe,
-                   false);
-        load_async(block,
-                   reinterpret_cast<uint16_t*>(patch_info.ev),
-                   2 * num_edges,
-                   s_ev,
-                   true);
+        load_topology(block, patch_info, fe, 3 * num_faces, s_fe, false);
+        load_topology(block, patch_info, ev, 2 * num_edges, s_ev, true);
         s_output_offset = &s_fe[0];
         s_output_value  = &s_ev[0];
         v_f<blockThreads>(num_faces,
@@ -949,11 +983,8 @@ __device__ __forceinline__ void query(cooperative_groups::thread_block& block,
         const uint16_t num_edges = patch_info.num_edges[0];
 
         s_output_value = shrd_alloc.alloc<uint16_t>(2 * num_edges);
-        load_async(block,
-                   reinterpret_cast<uint16_t*>(patch_info.ev),
-                   2 * num_edges,
-                   s_output_value,
-                   true);
+        load_topology(
+            block, patch_info, ev, 2 * num_edges, s_output_value, true);
     }
 
     if constexpr (op == Op::EF) {
@@ -965,11 +996,7 @@ __device__ __forceinline__ void query(cooperative_groups::thread_block& block,
         uint16_t* s_fe = shrd_alloc.alloc<uint16_t>(
             std::max(patch_info.num_edges[0] + 1, 3 * num_faces) +
             3 * num_faces);
-        load_async(block,
-                   reinterpret_cast<uint16_t*>(patch_info.fe),
-                   3 * num_faces,
-                   s_fe,
-                   true);
+        load_topology(block, patch_info, fe, 3 * num_faces, s_fe, true);
         s_output_offset = &s_fe[0];
         s_output_value  = &s_fe[3 * num_faces];
         e_f<blockThreads>(num_edges,
@@ -992,17 +1019,9 @@ __device__ __forceinline__ void query(cooperative_groups::thread_block& block,
         uint16_t* s_fe = shrd_alloc.alloc<uint16_t>(3 * num_faces);
         uint16_t* s_ev = shrd_alloc.alloc<uint16_t>(2 * num_edges);
         s_output_value = s_fe;
-        load_async(block,
-                   reinterpret_cast<uint16_t*>(patch_info.ev),
-                   2 * num_edges,
-                   s_ev,
-                   false);
-
-        load_async(block,
-                   reinterpret_cast<uint16_t*>(patch_info.fe),
-                   3 * num_faces,
-                   s_fe,
-                   true);
+        load_topology(block, patch_info, ev, 2 * num_edges, s_ev, false);
+
+        load_topology(block, patch_info, fe, 3 * num_faces, s_fe, true);
 
         f_v<blockThreads>(
             num_edges, s_ev, num_faces, s_fe, patch_info.active_mask_f);
@@ -1014,11 +1033,8 @@ __device__ __forceinline__ void query(cooperative_groups::thread_block& block,
         const uint16_t num_faces = patch_info.num_faces[0];
 
         s_output_value = shrd_alloc.alloc<uint16_t>(3 * num_faces);
-        load_async(block,
-                   reinterpret_cast<uint16_t*>(patch_info.fe),
-                   3 * num_faces,
-                   s_output_value,
-                   true);
+        load_topology(
+            block, patch_info, fe, 3 * num_faces, s_output_value, true);
     }
 
     if constexpr (op == Op::FF) {
@@ -1038,7 +1054,8 @@ __device__ __forceinline__ void query(cooperative_groups::thread_block& block,
                           s_output_offset,
                           s_output_value,
                           patch_info.active_mask_f,
-                          patch_info.active_mask_e);
+                          patch_info.active_mask_e,
+                          fe);
     }
 
     if constexpr (op == Op::EVDiamond) {
@@ -0,0 +1,315 @@
+#pragma once
+
+#include <assert.h>
+#include <stdint.h>
+
+#include <cooperative_groups.h>
+
+#include "rxmesh/context.h"
+#include "rxmesh/kernels/collective.cuh"
+#include "rxmesh/kernels/loader.cuh"
+#include "rxmesh/kernels/shmem_allocator.cuh"
+#include "rxmesh/kernels/util.cuh"
+#include "rxmesh/types.h"
+
+namespace rxmesh {
+namespace detail {
+
+/**
+ * @brief same as block_mat_transpose() but done by a tile (thread_block_tile)
+ * so multiple patches could be processed by the same block. The order of the
+ * output within a column is not deterministic
+ */
+template <uint32_t rowOffset, uint32_t tileSize>
+__device__ __forceinline__ void tile_mat_transpose(
+    const cooperative_groups::thread_block_tile<tileSize>& tile,
+    const uint32_t                                         num_rows,
+    const uint32_t                                         num_cols,
+    uint16_t*                                              mat,
+    uint16_t*                                              output,
+    uint16_t*                                              temp_size,
+    uint16_t*                                              temp_local,
+    const uint32_t*                                        row_active_mask,
+    const uint32_t*                                        col_active_mask,
+    int                                                    shift)
+{
+    const uint32_t nnz = num_rows * rowOffset;
+
+    for (uint32_t i = tile.thread_rank(); i < num_cols + 1; i += tileSize) {
+        temp_size[i] = 0;
+        if (i < num_cols) {
+            temp_local[i] = 0;
+        }
+    }
+    tile.sync();
+
+    for (uint32_t i = tile.thread_rank(); i < nnz; i += tileSize) {
+        const uint32_t r = i / rowOffset;
+        if (!is_deleted(r, row_active_mask)) {
+            const uint16_t c = mat[i] >> shift;
+            assert(c < num_cols);
+            assert(!is_deleted(c, col_active_mask));
+            atomicAdd(temp_size + c, uint16_t(1));
+        }
+    }
+    tile.sync();
+
+    tile_exclusive_sum<uint16_t, tileSize>(tile, temp_size, num_cols);
+
+    for (uint32_t i = tile.thread_rank(); i < nnz; i += tileSize) {
+        const uint16_t row_id = i / rowOffset;
+        if (!is_deleted(row_id, row_active_mask)) {
+            const uint16_t col_id = mat[i] >> shift;
+
+            const uint16_t local_id =
+                atomicAdd(temp_local + col_id, uint16_t(1));
+
+            assert(local_id < temp_size[col_id + 1] - temp_size[col_id]);
+
+            output[temp_size[col_id] + local_id] = row_id;
+        }
+    }
+    tile.sync();
+
+    for (uint32_t i = tile.thread_rank(); i < num_cols + 1; i += tileSize) {
+        mat[i] = temp_size[i];
+    }
+    tile.sync();
+}
+
+/**
+ * @brief same as f_v() but done by a tile. M_FV = M_FE \dot M_EV computed in
+ * place in faces
+ */
+template <uint32_t tileSize>
+__device__ __forceinline__ void tile_f_v(
+    const cooperative_groups::thread_block_tile<tileSize>& tile,
+    const uint16_t*                                        edges,
+    const uint16_t                                         num_faces,
+    uint16_t*                                              faces,
+    const uint32_t*                                        active_mask_f)
+{
+    for (uint32_t f = tile.thread_rank(); f < num_faces; f += tileSize) {
+        uint16_t fv[3] = {INVALID16, INVALID16, INVALID16};
+        if (!is_deleted(f, active_mask_f)) {
+            for (uint32_t i = 0; i < 3; ++i) {
+                uint16_t e = faces[3 * f + i];
+                if (e != INVALID16) {
+                    flag_t dir(0);
+                    Context::unpack_edge_dir(e, e, dir);
+                    fv[i] = edges[2 * e + dir];
+                }
+            }
+        }
+        for (uint32_t i = 0; i < 3; ++i) {
+            faces[3 * f + i] = fv[i];
+        }
+    }
+    tile.sync();
+}
+
+/**
+ * @brief same as query() but done by a tile (thread_block_tile) on a single
+ * patch. Oriented queries, Op::EVDiamond, and Op::EE are not supported
+ */
+template <uint32_t tileSize, Op op>
+__device__ __forceinline__ void tile_query(
+    const cooperative_groups::thread_block_tile<tileSize>& tile,
+    const PatchInfo&                                       patch_info,
+    ShmemAllocator&                                        shrd_alloc,
+    uint16_t*&                                             s_output_offset,
+    uint16_t*&                                             s_output_value)
+{
+    static_assert(op != Op::EVDiamond && op != Op::EE,
+                  "tile_query() does not support Op::EVDiamond and Op::EE");
+
+    const uint16_t num_vertices = patch_info.num_vertices[0];
+    const uint16_t num_edges    = patch_info.num_edges[0];
+    const uint16_t num_faces    = patch_info.num_faces[0];
+
+    const uint16_t* ev = reinterpret_cast<const uint16_t*>(patch_info.ev);
+    const uint16_t* fe = reinterpret_cast<const uint16_t*>(patch_info.fe);
+
+    if constexpr (op == Op::VV || op == Op::VE) {
+        uint16_t* s_ev = shrd_alloc.alloc<uint16_t>(
+            std::max(num_vertices + 1, 2 * num_edges) + 2 * num_edges);
+        load_async(tile, ev, 2 * num_edges, s_ev, true);
+        tile.sync();
+        s_output_offset = s_ev;
+        s_output_value  = &s_ev[2 * num_edges];
+
+        uint16_t* s_temp_size  = shrd_alloc.alloc<uint16_t>(num_vertices + 1);
+        uint16_t* s_temp_local = shrd_alloc.alloc<uint16_t>(num_vertices);
+
+        tile_mat_transpose<2u, tileSize>(tile,
+                                         num_edges,
+                                         num_vertices,
+                                         s_output_offset,
+                                         s_output_value,
+                                         s_temp_size,
+                                         s_temp_local,
+                                         patch_info.active_mask_e,
+                                         patch_info.active_mask_v,
+                                         0);
+
+        shrd_alloc.dealloc<uint16_t>(2 * num_vertices + 1);
+
+        if constexpr (op == Op::VV) {
+            // replace every edge with its other end vertex which we read
+            // from global memory since EV is overwritten by the transpose
+            for (uint32_t v = tile.thread_rank(); v < num_vertices;
+                 v += tileSize) {
+                if (is_deleted(v, patch_info.active_mask_v)) {
+                    continue;
+                }
+                for (uint32_t e = s_output_offset[v];
+                     e < s_output_offset[v + 1];
+                     ++e) {
+                    const uint16_t edge = s_output_value[e];
+                    const uint16_t v0   = ev[2 * edge];
+                    const uint16_t v1   = ev[2 * edge + 1];
+                    assert(v0 == v || v1 == v);
+                    s_output_value[e] = (v0 == v) ? v1 : v0;
+                }
+            }
+            tile.sync();
+        }
+    }
+
+    if constexpr (op == Op::VF) {
+        uint16_t* s_fe = shrd_alloc.alloc<uint16_t>(
+            std::max(3 * num_faces, 1 + num_vertices));
+        uint16_t* s_ev =
+            shrd_alloc.alloc<uint16_t>(std::max(2 * num_edges, 3 * num_faces));
+        load_async(tile, fe, 3 * num_faces, s_fe, false);
+        load_async(tile, ev, 2 * num_edges, s_ev, true);
+        tile.sync();
+
+        tile_f_v<tileSize>(
+            tile, s_ev, num_faces, s_fe, patch_info.active_mask_f);
+
+        uint16_t* s_temp_size  = shrd_alloc.alloc<uint16_t>(num_vertices + 1);
+        uint16_t* s_temp_local = shrd_alloc.alloc<uint16_t>(num_vertices);
+
+        tile_mat_transpose<3u, tileSize>(tile,
+                                         num_faces,
+                                         num_vertices,
+                                         s_fe,
+                                         s_ev,
+                                         s_temp_size,
+                                         s_temp_local,
+                                         patch_info.active_mask_f,
+                                         patch_info.active_mask_v,
+                                         0);
+
+        shrd_alloc.dealloc<uint16_t>(2 * num_vertices + 1);
+
+        s_output_offset = s_fe;
+        s_output_value  = s_ev;
+    }
+
+    if constexpr (op == Op::EV) {
+        s_output_value = shrd_alloc.alloc<uint16_t>(2 * num_edges);
+        load_async(tile, ev, 2 * num_edges, s_output_value, true);
+        tile.sync();
+    }
+
+    if constexpr (op == Op::FE) {
+        s_output_value = shrd_alloc.alloc<uint16_t>(3 * num_faces);
+        load_async(tile, fe, 3 * num_faces, s_output_value, true);
+        tile.sync();
+    }
+
+    if constexpr (op == Op::FV) {
+        uint16_t* s_fe = shrd_alloc.alloc<uint16_t>(3 * num_faces);
+        uint16_t* s_ev = shrd_alloc.alloc<uint16_t>(2 * num_edges);
+        load_async(tile, ev, 2 * num_edges, s_ev, false);
+        load_async(tile, fe, 3 * num_faces, s_fe, true);
+        tile.sync();
+
+        tile_f_v<tileSize>(
+            tile, s_ev, num_faces, s_fe, patch_info.active_mask_f);
+
+        shrd_alloc.dealloc<uint16_t>(2 * num_edges);
+        s_output_value = s_fe;
+    }
+
+    if constexpr (op == Op::EF || op == Op::FF) {
+        // EF is the transpose of FE
+        uint16_t* s_ef_offset =
+            shrd_alloc.alloc<uint16_t>(std::max(num_edges + 1, 3 * num_faces));
+        uint16_t* s_ef_value = shrd_alloc.alloc<uint16_t>(3 * num_faces);
+        load_async(tile, fe, 3 * num_faces, s_ef_offset, true);
+        tile.sync();
+
+        uint16_t* s_temp_size  = shrd_alloc.alloc<uint16_t>(num_edges + 1);
+        uint16_t* s_temp_local = shrd_alloc.alloc<uint16_t>(num_edges);
+
+        tile_mat_transpose<3u, tileSize>(tile,
+                                         num_faces,
+                                         num_edges,
+                                         s_ef_offset,
+                                         s_ef_value,
+                                         s_temp_size,
+                                         s_temp_local,
+                                         patch_info.active_mask_f,
+                                         patch_info.active_mask_e,
+                                         1);
+
+        shrd_alloc.dealloc<uint16_t>(2 * num_edges + 1);
+
+        s_output_offset = s_ef_offset;
+        s_output_value  = s_ef_value;
+
+        if constexpr (op == Op::FF) {
+            // every face collects the faces incident to its three edges
+            uint16_t* s_ff_offset = shrd_alloc.alloc<uint16_t>(num_faces + 1);
+
+            for (uint32_t f = tile.thread_rank(); f < num_faces;
+                 f += tileSize) {
+                uint16_t num_neighbour_faces = 0;
+                if (!is_deleted(f, patch_info.active_mask_f)) {
+                    for (uint32_t i = 0; i < 3; ++i) {
+                        const uint16_t e = fe[3 * f + i] >> 1;
+                        num_neighbour_faces +=
+                            s_ef_offset[e + 1] - s_ef_offset[e] - 1;
+                    }
+                }
+                s_ff_offset[f] = num_neighbour_faces;
+            }
+            tile.sync();
+
+            tile_exclusive_sum<uint16_t, tileSize>(
+                tile, s_ff_offset, num_faces);
+
+            uint16_t* s_ff_value =
+                shrd_alloc.alloc<uint16_t>(s_ff_offset[num_faces]);
+
+            for (uint32_t f = tile.thread_rank(); f < num_faces;
+                 f += tileSize) {
+                if (is_deleted(f, patch_info.active_mask_f)) {
+                    continue;
+                }
+                uint16_t offset = s_ff_offset[f];
+                for (uint32_t i = 0; i < 3; ++i) {
+                    const uint16_t e = fe[3 * f + i] >> 1;
+                    for (uint16_t ef = s_ef_offset[e]; ef < s_ef_offset[e + 1];
+                         ++ef) {
+                        const uint16_t n = s_ef_value[ef];
+                        if (n != f) {
+                            s_ff_value[offset++] = n;
+                        }
+                    }
+                }
+                assert(offset == s_ff_offset[f + 1]);
+            }
+            tile.sync();
+
+            s_output_offset = s_ff_offset;
+            s_output_value  = s_ff_value;
+        }
+    }
+}
+
+}  // namespace detail
+}  // namespace rxmesh
@@ -20,6 +20,16 @@ struct ShmemAllocator
     {
     }
 
+    /**
+     * @brief allocator that starts offset_bytes after the start of the dynamic
+     * shared memory e.g., to partition the shared memory between the tiles of
+     * a block
+     */
+    __device__ explicit ShmemAllocator(const uint32_t offset_bytes)
+        : m_ptr(SHMEM_START + offset_bytes)
+    {
+    }
+
     /**
      * @brief deallocate by subtracting number of bytes from the base pointer
      * This is NOT true deallocation. This can only be used by deallocating the
@@ -0,0 +1,204 @@
+#pragma once
+#include <assert.h>
+#include <stdint.h>
+#include <algorithm>
+#include <tuple>
+#include <type_traits>
+
+#include "rxmesh/kernels/shmem_allocator.cuh"
+
+namespace rxmesh {
+
+/**
+ * @brief one segment of a ShmemPlan i.e., an array of T in shared memory. If
+ * padEvery is not zero, one element is inserted after every padEvery elements
+ * so that a strided access (with stride padEvery) by a warp hits different
+ * banks. With padding, the segment must be accessed through index()
+ * @tparam T the type of the elements
+ * @tparam padEvery pad one element after every padEvery elements (0 for no
+ * padding)
+ */
+template <typename T, uint32_t padEvery = 0>
+struct ShmemSegment
+{
+    using Type = T;
+
+    static constexpr uint32_t pad_every = padEvery;
+
+    static constexpr uint32_t alignment =
+        alignof(T) > ShmemAllocator::default_alignment ?
+            alignof(T) :
+            ShmemAllocator::default_alignment;
+
+    /**
+     * @brief the position of the i-th element in the (padded) segment
+     */
+    __host__ __device__ static constexpr uint32_t index(const uint32_t i)
+    {
+        if constexpr (padEvery == 0) {
+            return i;
+        } else {
+            return i + i / padEvery;
+        }
+    }
+
+    /**
+     * @brief the number of bytes of a segment with count elements
+     */
+    __host__ __device__ static constexpr uint32_t bytes(const uint32_t count)
+    {
+        return index(count) * sizeof(T);
+    }
+};
+
+/**
+ * @brief a declarative layout of (a part of) the dynamic shared memory as a
+ * list of segments whose types are known at compile time and whose number of
+ * elements are given at run time. The same plan computes the exact number of
+ * bytes on the host (to set the kernel launch shared memory) and carves the
+ * segments out of a ShmemAllocator on the device such that the two can not
+ * go out of sync. The offsets of the segments are computed assuming the plan
+ * starts at an address aligned to max_alignment which carve() enforces
+ * @tparam SegmentsT a list of ShmemSegment
+ */
+template <typename... SegmentsT>
+struct ShmemPlan
+{
+    static constexpr uint32_t num_segments = sizeof...(SegmentsT);
+
+    static_assert(num_segments > 0, "ShmemPlan needs at least one segment");
+
+    template <uint32_t i>
+    using Segment = std::tuple_element_t<i, std::tuple<SegmentsT...>>;
+
+    template <uint32_t i>
+    using Type = typename Segment<i>::Type;
+
+    static constexpr uint32_t max_alignment =
+        std::max({SegmentsT::alignment...});
+
+    /**
+     * @brief the plan given the number of elements of every segment
+     */
+    template <typename... CountT>
+    __host__ __device__ explicit ShmemPlan(const CountT... count)
+        : m_count{static_cast<uint32_t>(count)...}, m_before(0), m_base(nullptr)
+    {
+        static_assert(sizeof...(CountT) == num_segments,
+                      "ShmemPlan needs one count per segment");
+        uint32_t offset = 0;
+        uint32_t s      = 0;
+        ((offset      = align_up(offset, SegmentsT::alignment),
+          m_offset[s] = offset,
+          offset += SegmentsT::bytes(m_count[s]),
+          ++s),
+         ...);
+        m_bytes = offset;
+    }
+
+    /**
+     * @brief the exact number of bytes of the plan. It includes the padding
+     * between the segments but not the padding needed to align the start of
+     * the plan which is at most max_alignment - 1
+     */
+    __host__ __device__ uint32_t bytes() const
+    {
+        return m_bytes;
+    }
+
+    /**
+     * @brief the number of bytes to reserve for the plan when it is carved
+     * out of an allocator at an unknown position
+     */
+    __host__ __device__ uint32_t reserved_bytes() const
+    {
+        return m_bytes + max_alignment;
+    }
+
+    /**
+     * @brief the number of elements of the i-th segment
+     */
+    template <uint32_t i>
+    __host__ __device__ uint32_t count() const
+    {
+        return m_count[i];
+    }
+
+    /**
+     * @brief allocate the plan from the allocator. Should be called by all
+     * threads (or the result be shared) same as ShmemAllocator::alloc()
+     */
+    __device__ __forceinline__ void carve(ShmemAllocator& shrd_alloc)
+    {
+        m_before = shrd_alloc.get_allocated_size_bytes();
+        m_base   = shrd_alloc.alloc(m_bytes, max_alignment);
+    }
+
+    /**
+     * @brief release the plan (and the alignment padding before it) from the
+     * allocator. The plan should be the last thing allocated
+     */
+    __device__ __forceinline__ void release(ShmemAllocator& shrd_alloc)
+    {
+        assert(m_base != nullptr);
+        shrd_alloc.dealloc(shrd_alloc.get_allocated_size_bytes() - m_before);
+        m_base = nullptr;
+    }
+
+    /**
+     * @brief the pointer to the start of the i-th segment after carve()
+     */
+    template <uint32_t i>
+    __device__ __forceinline__ Type<i>* get() const
+    {
+        assert(m_base != nullptr);
+        return reinterpret_cast<Type<i>*>(m_base + m_offset[i]);
+    }
+
+   private:
+    __host__ __device__ static constexpr uint32_t align_up(
+        const uint32_t offset,
+        const uint32_t alignment)
+    {
+        return ((offset + alignment - 1) / alignment) * alignment;
+    }
+
+    uint32_t m_count[num_segments];
+    uint32_t m_offset[num_segments];
+    uint32_t m_bytes;
+    uint32_t m_before;
+    char*    m_base;
+};
+
+namespace detail {
+/**
+ * @brief the temporary buffers of block_mat_transpose(): the prefix sum of
+ * the number of non-zeros per column (num_cols + 1) and the number of
+ * non-zeros already written per column (num_cols). The two are counted with
+ * shared memory atomics and TransposeCounterT sets their type. With uint16_t
+ * (default) two adjacent columns share a 32-bit word and the atomic is
+ * emulated with a CAS loop on that word such that threads updating
+ * neighboring columns contend. Defining RXMESH_TRANSPOSE_WIDE_COUNTERS pads
+ * every counter to its own 32-bit word (and bank) which makes the atomics
+ * native at twice the shared memory of these buffers
+ */
+#ifdef RXMESH_TRANSPOSE_WIDE_COUNTERS
+using TransposeCounterT = uint32_t;
+#else
+using TransposeCounterT = uint16_t;
+#endif
+
+using TransposeShmemPlan = ShmemPlan<ShmemSegment<TransposeCounterT>,
+                                     ShmemSegment<TransposeCounterT>>;
+
+/**
+ * @brief the plan of the temporary buffers needed to transpose a matrix with
+ * num_cols columns
+ */
+__host__ __device__ __forceinline__ TransposeShmemPlan
+transpose_shmem_plan(const uint32_t num_cols)
+{
+    return TransposeShmemPlan(num_cols + 1, num_cols);
+}
+}  // namespace detail
+}  // namespace rxmesh
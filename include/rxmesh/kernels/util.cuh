@@ -42,6 +42,19 @@ __device__ __forceinline__ float atomicMin(float* address, float val)
     return __int_as_float(ret);
 }
 
+__device__ __forceinline__ double atomicMin(double* address, double val)
+{
+    unsigned long long ret = __double_as_longlong(*address);
+    while (val < __longlong_as_double(ret)) {
+        unsigned long long old = ret;
+        if ((ret = ::atomicCAS((unsigned long long*)address,
+                               old,
+                               __double_as_longlong(val))) == old)
+            break;
+    }
+    return __longlong_as_double(ret);
+}
+
 __device__ __forceinline__ float atomicMax(float* address, float val)
 {
     // from
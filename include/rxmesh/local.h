@@ -98,4 +98,32 @@ struct LocalFaceT
     uint16_t id;
 };
 
+struct LocalCellT
+{
+    /**
+     * @brief Default constructor
+     */
+    constexpr __device__ __host__ LocalCellT() : id(INVALID16)
+    {
+    }
+
+    /**
+     * @brief Constructor using local index
+     * @param id cell local index in the owner patch
+     * @return
+     */
+    constexpr __device__ __host__ LocalCellT(uint16_t id) : id(id)
+    {
+    }
+
+    /**
+     * @brief return the name of the mesh element i.e., cell
+     */
+    constexpr static __device__ __host__ __inline__ const char* name()
+    {
+        return "Cell";
+    }
+    uint16_t id;
+};
+
 }  // namespace rxmesh
\ No newline at end of file
@@ -19,11 +19,13 @@
 #include <cooperative_groups.h>
 
 #include <algorithm>
+#include <limits>
 #include <random>
 
 #include "rxmesh/hash_functions.cuh"
 #include "rxmesh/lp_pair.cuh"
 #include "rxmesh/util/macros.h"
+#include "rxmesh/util/out_of_core.h"
 #include "rxmesh/util/prime_numbers.h"
 
 #ifdef __CUDA_ARCH__
@@ -46,6 +48,14 @@ namespace rxmesh {
  * encounter a tombstone during the cuckoo chain which only means that this
  * place used to have a pair that has been deleted. In which case, this key
  * should continue its chain until it find its pair.
+ *
+ * The table has two layouts selected by the bucket size. With bucket size 1
+ * (default), every key has four candidate slots (one per hash function). With
+ * bucket size > 1, the table is divided into buckets of contiguous slots and
+ * every key has three candidate buckets (bucketed cuckoo hashing). A bucketed
+ * table has shorter cuckoo chains at high load factors and its lookups can be
+ * done cooperatively by a tile of threads (one slot per thread) using the
+ * tile find()
  */
 struct LPHashTable
 {
@@ -54,11 +64,18 @@ struct LPHashTable
 
     static constexpr uint8_t stash_size = 128;
 
+    // max bucket size of a bucketed table i.e., a bucket is at most one warp
+    static constexpr uint8_t max_bucket_size = 32;
+
+    // number of candidate buckets of a key in a bucketed table
+    static constexpr int bucket_num_hfs = 3;
+
     __device__ __host__ LPHashTable()
         : m_table(nullptr),
           m_stash(nullptr),
           m_capacity(0),
           m_max_cuckoo_chains(0),
+          m_bucket_size(1),
           m_is_on_device(false)
     {
     }
@@ -71,17 +88,35 @@ struct LPHashTable
     /**
      * @brief Constructor using the hash table capacity.This is used as
      * allocation size
+     * @param bucket_size number of slots per bucket. 1 for the (default)
+     * unbucketed layout. Otherwise, it should be a power of two that is at
+     * most max_bucket_size
      */
-    explicit LPHashTable(const uint16_t capacity, bool is_on_device)
+    explicit LPHashTable(const uint16_t capacity,
+                         bool           is_on_device,
+                         const uint8_t  bucket_size = 1)
         : m_capacity(std::max(capacity, uint16_t(2))),
+          m_bucket_size(std::max(bucket_size, uint8_t(1))),
           m_is_on_device(is_on_device)
     {
-        m_capacity = find_next_prime_number(m_capacity);
+        assert((m_bucket_size & (m_bucket_size - 1)) == 0);
+        assert(m_bucket_size <= max_bucket_size);
+
+        if (m_bucket_size == 1) {
+            m_capacity = find_next_prime_number(m_capacity);
+        } else {
+            // prime number of buckets
+            const uint16_t num_buckets = static_cast<uint16_t>(
+                std::max(DIVIDE_UP(m_capacity, m_bucket_size), 2));
+            const uint32_t cap =
+                find_next_prime_number(num_buckets) * m_bucket_size;
+            assert(cap <= std::numeric_limits<uint16_t>::max());
+            m_capacity = static_cast<uint16_t>(cap);
+        }
         if (m_is_on_device) {
-            CUDA_ERROR(cudaMalloc((void**)&m_table, num_bytes()));
+            CUDA_ERROR(device_malloc((void**)&m_table, num_bytes()));
             CUDA_ERROR(
-                cudaMalloc((void**)&m_stash, stash_size * sizeof(LPPair)));
-            
+                device_malloc((void**)&m_stash, stash_size * sizeof(LPPair)));
         } else {
             m_table = (LPPair*)malloc(num_bytes());
             m_stash = (LPPair*)malloc(stash_size * sizeof(LPPair));
@@ -112,6 +147,30 @@ struct LPHashTable
         return m_capacity;
     }
 
+    /**
+     * @brief Get the number of slots per bucket (1 for unbucketed table)
+     */
+    __host__ __device__ __inline__ uint8_t get_bucket_size() const
+    {
+        return m_bucket_size;
+    }
+
+    /**
+     * @brief check if the table uses the bucketed layout
+     */
+    __host__ __device__ __inline__ bool is_bucketed() const
+    {
+        return m_bucket_size > 1;
+    }
+
+    /**
+     * @brief Get the number of buckets
+     */
+    __host__ __device__ __inline__ uint16_t get_num_buckets() const
+    {
+        return m_capacity / m_bucket_size;
+    }
+
     /**
      * @brief Reset the hash table to sentinel key-value (tombstone). This API
      * is for the host only
@@ -149,6 +208,18 @@ struct LPHashTable
     /**
      * @brief Free the GPU allocation
      */
+    /**
+     * @brief Migrate the table to the device ahead of its use in the
+     * out-of-core mode (see device_malloc()). This API is for the host only
+     */
+    __host__ void prefetch(cudaStream_t stream = NULL) const
+    {
+        if (m_is_on_device) {
+            prefetch_to_device(m_table, num_bytes(), stream);
+            prefetch_to_device(m_stash, stash_size * sizeof(LPPair), stream);
+        }
+    }
+
     __host__ void free()
     {
         if (m_is_on_device) {
@@ -288,6 +359,21 @@ struct LPHashTable
     }
 
 
+    /**
+     * @brief same as load_in_shared_memory() but done by a tile
+     * (thread_block_tile) instead of the whole block
+     */
+    template <uint32_t tileSize>
+    __device__ __inline__ void load_in_shared_memory(
+        const cooperative_groups::thread_block_tile<tileSize>& tile,
+        LPPair*                                                s_table,
+        bool                                                   with_wait) const
+    {
+#ifdef __CUDA_ARCH__
+        detail::load_async(tile, m_table, m_capacity, s_table, with_wait);
+#endif
+    }
+
     /**
      * @brief write the content of the hash table from (likely shared memory)
      * buffer
@@ -324,6 +410,10 @@ struct LPHashTable
         assert(table == nullptr);
 #endif
 
+        if (is_bucketed()) {
+            return insert_bucketed(pair, table, stash);
+        }
+
         auto     bucket_id      = m_hasher0(pair.key()) % m_capacity;
         uint16_t cuckoo_counter = 0;
 
@@ -374,34 +464,7 @@ struct LPHashTable
             cuckoo_counter++;
         } while (cuckoo_counter < m_max_cuckoo_chains);
 
-        const auto input_key = pair.key();
-
-#ifdef __CUDA_ARCH__
-        for (uint8_t i = 0; i < stash_size; ++i) {
-            LPPair prv;
-            if (stash != nullptr) {
-                prv.m_pair =
-                    ::atomicCAS((uint32_t*)(stash + i), INVALID32, pair.m_pair);
-            } else {
-                prv.m_pair =
-                    ::atomicCAS(reinterpret_cast<uint32_t*>(m_stash + i),
-                                INVALID32,
-                                pair.m_pair);
-            }
-            if (prv.is_sentinel() || prv.key() == input_key) {
-                return true;
-            }
-        }
-#else
-        assert(stash == nullptr);
-        for (uint8_t i = 0; i < stash_size; ++i) {
-            if (m_stash[i].is_sentinel() || m_stash[i].key() == input_key) {
-                m_stash[i] = pair;
-                return true;
-            }
-        }
-#endif
-        return false;
+        return insert_in_stash(pair, stash);
     }
 
     /**
@@ -421,6 +484,83 @@ struct LPHashTable
         return find(key, bucket_id, in_stash, table, stash);
     }
 
+    /**
+     * @brief Find a pair in the hash table given its key cooperatively by a
+     * tile where all threads in the tile look for the same key. Every thread
+     * reads (at most) one slot of a candidate bucket at a time and the threads
+     * vote on the match. For the unbucketed table, the four candidate slots
+     * are read at once. All threads in the tile get the same result
+     * @param tile the tile (tileSize should be a power of two <= 32)
+     * @param key input key (same for all threads in the tile)
+     * @param table pointer to the hash table (could shared memory)
+     * @param stash pointer to the hash table stash (could shared memory)
+     * @return a LPPair pair that contains the key and its associated value
+     */
+    template <uint32_t tileSize>
+    __device__ __inline__ LPPair find(
+        const cooperative_groups::thread_block_tile<tileSize>& tile,
+        const typename LPPair::KeyT                            key,
+        const LPPair*                                          table = nullptr,
+        const LPPair*                                          stash = nullptr)
+        const
+    {
+#ifdef __CUDA_ARCH__
+        static_assert(tileSize <= 32, "LPHashTable::find() tile is > warp");
+
+        const uint32_t lane = tile.thread_rank();
+
+        // returns the pair found by the first thread that found it (or
+        // sentinel if non found it)
+        auto vote = [&](const bool is_found, const LPPair lp) -> LPPair {
+            const uint32_t ballot = tile.ballot(is_found);
+            if (ballot == 0) {
+                return LPPair::sentinel_pair();
+            }
+            const int leader = __ffs(ballot) - 1;
+            return LPPair(tile.shfl(lp.m_pair, leader));
+        };
+
+        if (is_bucketed()) {
+            for (int hf = 0; hf < bucket_num_hfs; ++hf) {
+                const uint32_t b = bucket_of(hf, key) * m_bucket_size;
+                for (uint32_t s = 0; s < m_bucket_size; s += tileSize) {
+                    LPPair lp = LPPair::sentinel_pair();
+                    if (s + lane < m_bucket_size) {
+                        lp = read_slot(table, b + s + lane);
+                    }
+                    const LPPair found = vote(lp.key() == key, lp);
+                    if (!found.is_sentinel()) {
+                        return found;
+                    }
+                }
+            }
+        } else {
+            for (uint32_t hf = 0; hf < 4; hf += tileSize) {
+                LPPair lp = LPPair::sentinel_pair();
+                if (hf + lane < 4) {
+                    lp = read_slot(table, slot_of(hf + lane, key));
+                }
+                const LPPair found = vote(lp.key() == key, lp);
+                if (!found.is_sentinel()) {
+                    return found;
+                }
+            }
+        }
+
+        for (uint32_t i = 0; i < stash_size; i += tileSize) {
+            LPPair lp = LPPair::sentinel_pair();
+            if (i + lane < stash_size) {
+                lp = (stash != nullptr) ? stash[i + lane] : m_stash[i + lane];
+            }
+            const LPPair found = vote(lp.key() == key, lp);
+            if (!found.is_sentinel()) {
+                return found;
+            }
+        }
+#endif
+        return LPPair::sentinel_pair();
+    }
+
 
     /**
      * @brief Replace an existing pair with another. We use the new_pair to
@@ -522,38 +662,23 @@ struct LPHashTable
         assert(table == nullptr);
 #endif
 
-        constexpr int num_hfs = 4;
-        in_stash              = false;
-        bucket_id             = m_hasher0(key) % m_capacity;
-        for (int hf = 0; hf < num_hfs; ++hf) {
-
-
-            LPPair found;
-            if (table != nullptr) {
-                found = table[bucket_id];
-            } else {
-#ifdef __CUDA_ARCH__
-                uint32_t* ptr =
-                    reinterpret_cast<uint32_t*>(m_table + bucket_id);
-                found = LPPair(atomic_read(ptr));
-#else
-                found = m_table[bucket_id];
-#endif
+        in_stash = false;
+        if (is_bucketed()) {
+            const LPPair found = find_in_buckets(key, bucket_id, table);
+            if (!found.is_sentinel()) {
+                return found;
             }
+        } else {
+            constexpr int num_hfs = 4;
+            for (int hf = 0; hf < num_hfs; ++hf) {
+                bucket_id          = slot_of(hf, key);
+                const LPPair found = read_slot(table, bucket_id);
 
-            if (found.key() == key) {
-                return found;
                 // since we only look for pairs that we know that they exist in
-                // the table, we skip this since the pair could be in the stash
-                //  } else if (found.m_pair == INVALID32) {
-                //    return found;
-            } else {
-                if (hf == 0) {
-                    bucket_id = m_hasher1(key) % m_capacity;
-                } else if (hf == 1) {
-                    bucket_id = m_hasher2(key) % m_capacity;
-                } else if (hf == 2) {
-                    bucket_id = m_hasher3(key) % m_capacity;
+                // the table, we don't stop at empty slots since the pair could
+                // be in the stash
+                if (found.key() == key) {
+                    return found;
                 }
             }
         }
@@ -575,6 +700,196 @@ struct LPHashTable
     }
 
 
+
+    /**
+     * @brief insert a pair in the stash after the cuckoo chain failed
+     */
+    __host__ __device__ __inline__ bool insert_in_stash(
+        const LPPair     pair,
+        volatile LPPair* stash)
+    {
+        const auto input_key = pair.key();
+
+#ifdef __CUDA_ARCH__
+        for (uint8_t i = 0; i < stash_size; ++i) {
+            LPPair prv;
+            if (stash != nullptr) {
+                prv.m_pair =
+                    ::atomicCAS((uint32_t*)(stash + i), INVALID32, pair.m_pair);
+            } else {
+                prv.m_pair =
+                    ::atomicCAS(reinterpret_cast<uint32_t*>(m_stash + i),
+                                INVALID32,
+                                pair.m_pair);
+            }
+            if (prv.is_sentinel() || prv.key() == input_key) {
+                return true;
+            }
+        }
+#else
+        assert(stash == nullptr);
+        for (uint8_t i = 0; i < stash_size; ++i) {
+            if (m_stash[i].is_sentinel() || m_stash[i].key() == input_key) {
+                m_stash[i] = pair;
+                return true;
+            }
+        }
+#endif
+        return false;
+    }
+
+    /**
+     * @brief the candidate bucket of a key using the hash function hf in a
+     * bucketed table
+     */
+    __host__ __device__ __inline__ uint32_t
+    bucket_of(const int hf, const typename LPPair::KeyT key) const
+    {
+        const uint32_t num_buckets = get_num_buckets();
+        if (hf == 0) {
+            return m_hasher0(key) % num_buckets;
+        } else if (hf == 1) {
+            return m_hasher1(key) % num_buckets;
+        } else {
+            return m_hasher2(key) % num_buckets;
+        }
+    }
+
+    /**
+     * @brief the candidate slot of a key using the hash function hf in an
+     * unbucketed table
+     */
+    __host__ __device__ __inline__ uint32_t
+    slot_of(const uint32_t hf, const typename LPPair::KeyT key) const
+    {
+        if (hf == 0) {
+            return m_hasher0(key) % m_capacity;
+        } else if (hf == 1) {
+            return m_hasher1(key) % m_capacity;
+        } else if (hf == 2) {
+            return m_hasher2(key) % m_capacity;
+        } else {
+            return m_hasher3(key) % m_capacity;
+        }
+    }
+
+    /**
+     * @brief read a slot from the table (could be in shared memory)
+     */
+    __host__ __device__ __inline__ LPPair read_slot(const LPPair*  table,
+                                                    const uint32_t slot) const
+    {
+        if (table != nullptr) {
+            return table[slot];
+        }
+#ifdef __CUDA_ARCH__
+        return LPPair(atomic_read(reinterpret_cast<uint32_t*>(m_table + slot)));
+#else
+        return m_table[slot];
+#endif
+    }
+
+    /**
+     * @brief look for a key in its candidate buckets. slot is the slot where
+     * the key is found
+     */
+    __host__ __device__ __inline__ LPPair
+    find_in_buckets(const typename LPPair::KeyT key,
+                    uint32_t&                   slot,
+                    const LPPair*               table) const
+    {
+        for (int hf = 0; hf < bucket_num_hfs; ++hf) {
+            const uint32_t b = bucket_of(hf, key) * m_bucket_size;
+            for (uint32_t s = 0; s < m_bucket_size; ++s) {
+                slot               = b + s;
+                const LPPair found = read_slot(table, slot);
+                if (found.key() == key) {
+                    return found;
+                }
+            }
+        }
+        return LPPair::sentinel_pair();
+    }
+
+    /**
+     * @brief insert in a bucketed table. We first look for the key in its
+     * candidate buckets (to update it), then for an empty slot in them. If all
+     * candidate buckets are full, a pair is evicted from one of them and is
+     * re-inserted in its next candidate bucket
+     */
+    __host__ __device__ __inline__ bool insert_bucketed(LPPair           pair,
+                                                        volatile LPPair* table,
+                                                        volatile LPPair* stash)
+    {
+        uint32_t* t =
+            (table != nullptr) ? (uint32_t*)table : (uint32_t*)m_table;
+
+        // try to write the pair in the slot if it holds expected
+        auto try_write = [&](const uint32_t slot, const uint32_t expected) {
+#ifdef __CUDA_ARCH__
+            return ::atomicCAS(t + slot, expected, pair.m_pair) == expected;
+#else
+            if (t[slot] == expected) {
+                t[slot] = pair.m_pair;
+                return true;
+            }
+            return false;
+#endif
+        };
+
+        int      hf             = 0;
+        uint16_t cuckoo_counter = 0;
+
+        do {
+            const auto key = pair.key();
+
+            // update the pair if the key already exists
+            uint32_t     slot = 0;
+            const LPPair old  = find_in_buckets(key, slot, (const LPPair*)t);
+            if (!old.is_sentinel() && try_write(slot, old.m_pair)) {
+                return true;
+            }
+
+            // look for an empty slot
+            for (int h = 0; h < bucket_num_hfs; ++h) {
+                const uint32_t b = bucket_of(h, key) * m_bucket_size;
+                for (uint32_t s = 0; s < m_bucket_size; ++s) {
+                    if (LPPair(t[b + s]).is_sentinel() &&
+                        try_write(b + s, INVALID32)) {
+                        return true;
+                    }
+                }
+            }
+
+            // evict a pair from the candidate bucket hf
+            const uint32_t b = bucket_of(hf, key);
+            slot = b * m_bucket_size + ((key + cuckoo_counter) % m_bucket_size);
+#ifdef __CUDA_ARCH__
+            pair.m_pair = ::atomicExch(t + slot, pair.m_pair);
+#else
+            const uint32_t temp = t[slot];
+            t[slot]             = pair.m_pair;
+            pair.m_pair         = temp;
+#endif
+            if (pair.is_sentinel() || pair.key() == key) {
+                return true;
+            }
+
+            // the evicted pair goes to its candidate bucket that comes after
+            // the one it was evicted from
+            hf = 0;
+            for (int h = 0; h < bucket_num_hfs; ++h) {
+                if (bucket_of(h, pair.key()) == b) {
+                    hf = (h + 1) % bucket_num_hfs;
+                    break;
+                }
+            }
+            cuckoo_counter++;
+        } while (cuckoo_counter < m_max_cuckoo_chains);
+
+        return insert_in_stash(pair, stash);
+    }
+
     LPPair*  m_table;
     LPPair*  m_stash;
     HashT    m_hasher0;
@@ -583,6 +898,7 @@ struct LPHashTable
     HashT    m_hasher3;
     uint16_t m_capacity;
     uint16_t m_max_cuckoo_chains;
+    uint8_t  m_bucket_size;
     bool     m_is_on_device;
 };
 }  // namespace rxmesh
@@ -6,6 +6,10 @@
 
 #include "rxmesh/util/bitmask_util.h"
 
+#ifndef PATCH_STASH_NUM_BITS
+#define PATCH_STASH_NUM_BITS 6
+#endif
+
 namespace rxmesh {
 /**
  * @brief This struct store the index of the not-owned mesh elements as a 32-bit
@@ -30,11 +34,19 @@ struct LPPair
     // Local index (high) number of bits within the patch
     constexpr static uint32_t LIDNumBits = 13;
 
+    // Number of bits reserved for the owner patch ID in the PatchStash i.e.,
+    // a patch can have at most 2^PatchStashNumBits neighbor patches. This is
+    // set at configure time (RX_PATCH_STASH_NUM_BITS) to trade the max number
+    // of neighbor patches for the max number of elements per patch
+    constexpr static uint32_t PatchStashNumBits = PATCH_STASH_NUM_BITS;
+
     // Local index (low) number of bits bit within the owner patch
-    constexpr static uint32_t LIDOwnerNumBits = 13;
+    constexpr static uint32_t LIDOwnerNumBits =
+        32 - LIDNumBits - PatchStashNumBits;
 
-    // Number of bits reserved for the owner patch ID in the PatchStash
-    constexpr static uint32_t PatchStashNumBits = 6;
+    static_assert(PatchStashNumBits >= 6 && PatchStashNumBits <= 7,
+                  "PATCH_STASH_NUM_BITS should be 6 or 7 since the patch stash "
+                  "index is an uint8_t where INVALID8 is reserved");
 
     /**
      * @brief Constructor using the local ID (key),
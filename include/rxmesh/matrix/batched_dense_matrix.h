@@ -0,0 +1,632 @@
+#pragma once
+#include <vector>
+
+#include "cublas_v2.h"
+#include "cusolverDn.h"
+
+#include "rxmesh/matrix/dense_matrix.h"
+
+namespace rxmesh {
+
+/**
+ * @brief a batch of small dense matrices of the same size (rows x cols) that
+ * are stored contiguously in col major with a stride of rows * cols, i.e.,
+ * matrix b starts at b * rows * cols. This is meant for many small
+ * independent problems (e.g., the rotation of every vertex in ARAP, or a local
+ * system per patch) where every operation is done on the whole batch by one
+ * strided-batched (or batched) cuBLAS/cuSOLVER call instead of one call per
+ * matrix. Only float and double are supported.
+ * When the batch is tied to the mesh (see the constructors below), matrix b
+ * can also be accessed using the handle of the mesh element whose linear id is
+ * b, e.g., one 3x3 matrix per vertex. For a per-patch layout (one matrix per
+ * patch where the patch id is the batch index), use per_patch()
+ */
+template <typename T>
+struct BatchedDenseMatrix
+{
+    static_assert(std::is_same_v<T, float> || std::is_same_v<T, double>,
+                  "BatchedDenseMatrix only supports float and double");
+
+    using IndexT = int;
+    using Type   = T;
+
+    using EigenDenseMatrix =
+        Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::ColMajor>;
+
+    using EigenDenseMatrixMap = Eigen::Map<EigenDenseMatrix>;
+
+    BatchedDenseMatrix()
+        : m_batch_size(0),
+          m_num_rows(0),
+          m_num_cols(0),
+          m_d_ptrs(nullptr),
+          m_d_info(nullptr),
+          m_d_pivots(nullptr),
+          m_cublas_handle(nullptr),
+          m_cusolver_handle(nullptr)
+    {
+    }
+
+    /**
+     * @brief allocate batch_size matrices each of size (num_rows x num_cols)
+     */
+    BatchedDenseMatrix(IndexT    batch_size,
+                       IndexT    num_rows,
+                       IndexT    num_cols,
+                       locationT location = LOCATION_ALL)
+        : m_batch_size(batch_size),
+          m_num_rows(num_rows),
+          m_num_cols(num_cols),
+          m_mat(num_rows, num_cols * batch_size, location),
+          m_d_ptrs(nullptr),
+          m_d_info(nullptr),
+          m_d_pivots(nullptr),
+          m_cublas_handle(nullptr),
+          m_cusolver_handle(nullptr)
+    {
+        init(location);
+    }
+
+    /**
+     * @brief same as above but the batch is tied to the mesh such that the
+     * matrices can be accessed using vertex/edge/face handles where the batch
+     * index is the linear id of the handle. The device memory is allocated
+     * from the mesh memory pool
+     */
+    BatchedDenseMatrix(const RXMesh& rx,
+                       IndexT        batch_size,
+                       IndexT        num_rows,
+                       IndexT        num_cols,
+                       locationT     location = LOCATION_ALL)
+        : m_batch_size(batch_size),
+          m_num_rows(num_rows),
+          m_num_cols(num_cols),
+          m_mat(rx, num_rows, num_cols * batch_size, location),
+          m_d_ptrs(nullptr),
+          m_d_info(nullptr),
+          m_d_pivots(nullptr),
+          m_cublas_handle(nullptr),
+          m_cusolver_handle(nullptr)
+    {
+        init(location);
+    }
+
+    /**
+     * @brief one matrix per mesh element of type HandleT (e.g., one 3x3
+     * rotation per vertex)
+     */
+    template <typename HandleT>
+    static BatchedDenseMatrix<T> per_element(
+        const RXMesh& rx,
+        IndexT        num_rows,
+        IndexT        num_cols,
+        locationT     location = LOCATION_ALL)
+    {
+        return BatchedDenseMatrix<T>(rx,
+                                     rx.get_num_elements<HandleT>(),
+                                     num_rows,
+                                     num_cols,
+                                     location);
+    }
+
+    /**
+     * @brief one matrix per patch where the patch id is the batch index
+     */
+    static BatchedDenseMatrix<T> per_patch(
+        const RXMesh& rx,
+        IndexT        num_rows,
+        IndexT        num_cols,
+        locationT     location = LOCATION_ALL)
+    {
+        return BatchedDenseMatrix<T>(
+            rx, rx.get_num_patches(), num_rows, num_cols, location);
+    }
+
+    __host__ __device__ IndexT batch_size() const
+    {
+        return m_batch_size;
+    }
+
+    __host__ __device__ IndexT rows() const
+    {
+        return m_num_rows;
+    }
+
+    __host__ __device__ IndexT cols() const
+    {
+        return m_num_cols;
+    }
+
+    /**
+     * @brief the distance (in number of elements) between the start of two
+     * consecutive matrices
+     */
+    __host__ __device__ IndexT stride() const
+    {
+        return m_num_rows * m_num_cols;
+    }
+
+    /**
+     * @brief access entry (row, col) of matrix b. Can be used on both host and
+     * device
+     */
+    __host__ __device__ T& operator()(const IndexT b,
+                                      const IndexT row,
+                                      const IndexT col)
+    {
+        assert(b < m_batch_size);
+        return m_mat(row, b * m_num_cols + col);
+    }
+
+    __host__ __device__ const T& operator()(const IndexT b,
+                                            const IndexT row,
+                                            const IndexT col) const
+    {
+        assert(b < m_batch_size);
+        return m_mat(row, b * m_num_cols + col);
+    }
+
+    /**
+     * @brief access entry (row, col) of the matrix of a vertex/edge/face
+     * handle. This can only be used if the batch is tied to the mesh
+     */
+    template <typename HandleT>
+    __host__ __device__ T& operator()(const HandleT handle,
+                                      const IndexT  row,
+                                      const IndexT  col)
+    {
+        return this->operator()(m_mat.get_row_id(handle), row, col);
+    }
+
+    template <typename HandleT>
+    __host__ __device__ const T& operator()(const HandleT handle,
+                                            const IndexT  row,
+                                            const IndexT  col) const
+    {
+        return this->operator()(m_mat.get_row_id(handle), row, col);
+    }
+
+    /**
+     * @brief raw pointer to the start of matrix b
+     */
+    __host__ __device__ T* data(const IndexT b        = 0,
+                                locationT    location = DEVICE) const
+    {
+        return m_mat.data(location) + size_t(b) * stride();
+    }
+
+    /**
+     * @brief Eigen map of matrix b on the host
+     */
+    __host__ EigenDenseMatrixMap to_eigen(const IndexT b)
+    {
+        return EigenDenseMatrixMap(data(b, HOST), m_num_rows, m_num_cols);
+    }
+
+    __host__ void reset(T val, locationT location, cudaStream_t stream = NULL)
+    {
+        m_mat.reset(val, location, stream);
+    }
+
+    __host__ void fill_random(double minn = -1.0, double maxx = 1.0)
+    {
+        m_mat.fill_random(minn, maxx);
+    }
+
+    __host__ void move(locationT    source,
+                       locationT    target,
+                       cudaStream_t stream = NULL)
+    {
+        m_mat.move(source, target, stream);
+    }
+
+    /**
+     * @brief deep copy from a batch of the same size (see
+     * DenseMatrix::copy_from())
+     */
+    __host__ void copy_from(BatchedDenseMatrix<T>& source,
+                            locationT              source_flag = LOCATION_ALL,
+                            locationT              target_flag = LOCATION_ALL,
+                            cudaStream_t           stream      = NULL)
+    {
+        if (batch_size() != source.batch_size()) {
+            RXMESH_ERROR(
+                "BatchedDenseMatrix::copy_from() the batch size is "
+                "different!");
+            return;
+        }
+        m_mat.copy_from(source.m_mat, source_flag, target_flag, stream);
+    }
+
+    /**
+     * @brief the underlying (rows x (cols * batch_size)) matrix
+     */
+    __host__ DenseMatrix<T>& as_dense_matrix()
+    {
+        return m_mat;
+    }
+
+    /**
+     * @brief this = alpha * op(A) * op(B) + beta * this for every matrix in the
+     * batch using one strided-batched GEMM
+     */
+    __host__ void gemm(const BatchedDenseMatrix<T>& A,
+                       const BatchedDenseMatrix<T>& B,
+                       T                            alpha  = 1,
+                       T                            beta   = 0,
+                       cublasOperation_t            op_a   = CUBLAS_OP_N,
+                       cublasOperation_t            op_b   = CUBLAS_OP_N,
+                       cudaStream_t                 stream = NULL)
+    {
+        const IndexT m  = (op_a == CUBLAS_OP_N) ? A.rows() : A.cols();
+        const IndexT k  = (op_a == CUBLAS_OP_N) ? A.cols() : A.rows();
+        const IndexT n  = (op_b == CUBLAS_OP_N) ? B.cols() : B.rows();
+        const IndexT kb = (op_b == CUBLAS_OP_N) ? B.rows() : B.cols();
+
+        if (k != kb || m != rows() || n != cols() ||
+            A.batch_size() != batch_size() || B.batch_size() != batch_size()) {
+            RXMESH_ERROR(
+                "BatchedDenseMatrix::gemm() The input matrices size does not "
+                "match. op(A) is {}x{}, op(B) is {}x{}, and this is {}x{} with "
+                "batch size {}, {}, and {}.",
+                m,
+                k,
+                kb,
+                n,
+                rows(),
+                cols(),
+                A.batch_size(),
+                B.batch_size(),
+                batch_size());
+            return;
+        }
+
+        CUBLAS_ERROR(cublasSetStream(m_cublas_handle, stream));
+
+        if constexpr (std::is_same_v<T, float>) {
+            CUBLAS_ERROR(cublasSgemmStridedBatched(m_cublas_handle,
+                                                   op_a,
+                                                   op_b,
+                                                   m,
+                                                   n,
+                                                   k,
+                                                   &alpha,
+                                                   A.data(),
+                                                   A.rows(),
+                                                   A.stride(),
+                                                   B.data(),
+                                                   B.rows(),
+                                                   B.stride(),
+                                                   &beta,
+                                                   data(),
+                                                   rows(),
+                                                   stride(),
+                                                   batch_size()));
+        }
+
+        if constexpr (std::is_same_v<T, double>) {
+            CUBLAS_ERROR(cublasDgemmStridedBatched(m_cublas_handle,
+                                                   op_a,
+                                                   op_b,
+                                                   m,
+                                                   n,
+                                                   k,
+                                                   &alpha,
+                                                   A.data(),
+                                                   A.rows(),
+                                                   A.stride(),
+                                                   B.data(),
+                                                   B.rows(),
+                                                   B.stride(),
+                                                   &beta,
+                                                   data(),
+                                                   rows(),
+                                                   stride(),
+                                                   batch_size()));
+        }
+    }
+
+    /**
+     * @brief in-place Cholesky factorization (lower triangle) of every
+     * (symmetric positive-definite) matrix in the batch. The status of every
+     * matrix can be read with get_info() where a positive value i means that
+     * the leading minor of order i is not positive-definite
+     */
+    __host__ void potrf(cudaStream_t stream = NULL)
+    {
+        if (!is_square("potrf")) {
+            return;
+        }
+
+        CUSOLVER_ERROR(cusolverDnSetStream(m_cusolver_handle, stream));
+
+        if constexpr (std::is_same_v<T, float>) {
+            CUSOLVER_ERROR(cusolverDnSpotrfBatched(m_cusolver_handle,
+                                                   CUBLAS_FILL_MODE_LOWER,
+                                                   rows(),
+                                                   m_d_ptrs,
+                                                   rows(),
+                                                   m_d_info,
+                                                   batch_size()));
+        }
+
+        if constexpr (std::is_same_v<T, double>) {
+            CUSOLVER_ERROR(cusolverDnDpotrfBatched(m_cusolver_handle,
+                                                   CUBLAS_FILL_MODE_LOWER,
+                                                   rows(),
+                                                   m_d_ptrs,
+                                                   rows(),
+                                                   m_d_info,
+                                                   batch_size()));
+        }
+    }
+
+    /**
+     * @brief solve A_b * x_b = B_b for every matrix in the batch after
+     * potrf(). B is overwritten by the solution and should have one column
+     * (cuSOLVER's batched potrs only supports one right hand side)
+     */
+    __host__ void potrs(BatchedDenseMatrix<T>& B, cudaStream_t stream = NULL)
+    {
+        if (!is_square("potrs") || !is_rhs(B, "potrs")) {
+            return;
+        }
+
+        if (B.cols() != 1) {
+            RXMESH_ERROR(
+                "BatchedDenseMatrix::potrs() only supports one right hand side "
+                "but B has {} columns.",
+                B.cols());
+            return;
+        }
+
+        CUSOLVER_ERROR(cusolverDnSetStream(m_cusolver_handle, stream));
+
+        if constexpr (std::is_same_v<T, float>) {
+            CUSOLVER_ERROR(cusolverDnSpotrsBatched(m_cusolver_handle,
+                                                   CUBLAS_FILL_MODE_LOWER,
+                                                   rows(),
+                                                   1,
+                                                   m_d_ptrs,
+                                                   rows(),
+                                                   B.m_d_ptrs,
+                                                   B.rows(),
+                                                   m_d_info,
+                                                   batch_size()));
+        }
+
+        if constexpr (std::is_same_v<T, double>) {
+            CUSOLVER_ERROR(cusolverDnDpotrsBatched(m_cusolver_handle,
+                                                   CUBLAS_FILL_MODE_LOWER,
+                                                   rows(),
+                                                   1,
+                                                   m_d_ptrs,
+                                                   rows(),
+                                                   B.m_d_ptrs,
+                                                   B.rows(),
+                                                   m_d_info,
+                                                   batch_size()));
+        }
+    }
+
+    /**
+     * @brief in-place LU factorization with partial pivoting of every matrix
+     * in the batch. The status of every matrix can be read with get_info()
+     * where a positive value i means that U(i, i) is zero
+     */
+    __host__ void getrf(cudaStream_t stream = NULL)
+    {
+        if (!is_square("getrf")) {
+            return;
+        }
+
+        if (m_d_pivots == nullptr) {
+            CUDA_ERROR(
+                tracked_malloc((void**)&m_d_pivots,
+                               size_t(batch_size()) * rows() * sizeof(int),
+                               MemoryCategory::Matrix));
+        }
+
+        CUBLAS_ERROR(cublasSetStream(m_cublas_handle, stream));
+
+        if constexpr (std::is_same_v<T, float>) {
+            CUBLAS_ERROR(cublasSgetrfBatched(m_cublas_handle,
+                                             rows(),
+                                             m_d_ptrs,
+                                             rows(),
+                                             m_d_pivots,
+                                             m_d_info,
+                                             batch_size()));
+        }
+
+        if constexpr (std::is_same_v<T, double>) {
+            CUBLAS_ERROR(cublasDgetrfBatched(m_cublas_handle,
+                                             rows(),
+                                             m_d_ptrs,
+                                             rows(),
+                                             m_d_pivots,
+                                             m_d_info,
+                                             batch_size()));
+        }
+    }
+
+    /**
+     * @brief solve A_b * X_b = B_b for every matrix in the batch after
+     * getrf(). B is overwritten by the solution
+     */
+    __host__ void getrs(BatchedDenseMatrix<T>& B, cudaStream_t stream = NULL)
+    {
+        if (!is_square("getrs") || !is_rhs(B, "getrs")) {
+            return;
+        }
+
+        if (m_d_pivots == nullptr) {
+            RXMESH_ERROR(
+                "BatchedDenseMatrix::getrs() should be called after getrf().");
+            return;
+        }
+
+        CUBLAS_ERROR(cublasSetStream(m_cublas_handle, stream));
+
+        // the info of getrs is on the host and only reports invalid params
+        int info = 0;
+
+        if constexpr (std::is_same_v<T, float>) {
+            CUBLAS_ERROR(cublasSgetrsBatched(m_cublas_handle,
+                                             CUBLAS_OP_N,
+                                             rows(),
+                                             B.cols(),
+                                             m_d_ptrs,
+                                             rows(),
+                                             m_d_pivots,
+                                             B.m_d_ptrs,
+                                             B.rows(),
+                                             &info,
+                                             batch_size()));
+        }
+
+        if constexpr (std::is_same_v<T, double>) {
+            CUBLAS_ERROR(cublasDgetrsBatched(m_cublas_handle,
+                                             CUBLAS_OP_N,
+                                             rows(),
+                                             B.cols(),
+                                             m_d_ptrs,
+                                             rows(),
+                                             m_d_pivots,
+                                             B.m_d_ptrs,
+                                             B.rows(),
+                                             &info,
+                                             batch_size()));
+        }
+
+        if (info != 0) {
+            RXMESH_ERROR(
+                "BatchedDenseMatrix::getrs() invalid parameter {}.", -info);
+        }
+    }
+
+    /**
+     * @brief return the status of the last factorization (potrf() or getrf())
+     * of every matrix in the batch where 0 means success
+     */
+    __host__ std::vector<int> get_info(cudaStream_t stream = NULL) const
+    {
+        std::vector<int> info(batch_size());
+        CUDA_ERROR(cudaMemcpyAsync(info.data(),
+                                   m_d_info,
+                                   info.size() * sizeof(int),
+                                   cudaMemcpyDeviceToHost,
+                                   stream));
+        CUDA_ERROR(cudaStreamSynchronize(stream));
+        return info;
+    }
+
+    /**
+     * @brief device array of the status of the last factorization
+     */
+    __host__ __device__ int* get_info_ptr() const
+    {
+        return m_d_info;
+    }
+
+    __host__ void release(locationT location = LOCATION_ALL)
+    {
+        m_mat.release(location);
+
+        if ((location & DEVICE) == DEVICE) {
+            GPU_FREE(m_d_ptrs);
+            GPU_FREE(m_d_info);
+            GPU_FREE(m_d_pivots);
+
+            if (m_cublas_handle) {
+                CUBLAS_ERROR(cublasDestroy(m_cublas_handle));
+                m_cublas_handle = nullptr;
+            }
+
+            if (m_cusolver_handle) {
+                CUSOLVER_ERROR(cusolverDnDestroy(m_cusolver_handle));
+                m_cusolver_handle = nullptr;
+            }
+        }
+    }
+
+   private:
+    /**
+     * @brief allocate the per-matrix pointer array (needed by the batched
+     * factorizations), the status array, and the library handles
+     */
+    __host__ void init(locationT location)
+    {
+        if ((location & DEVICE) != DEVICE) {
+            return;
+        }
+
+        std::vector<T*> h_ptrs(batch_size());
+        for (IndexT b = 0; b < batch_size(); ++b) {
+            h_ptrs[b] = data(b, DEVICE);
+        }
+
+        CUDA_ERROR(tracked_malloc((void**)&m_d_ptrs,
+                                  batch_size() * sizeof(T*),
+                                  MemoryCategory::Matrix));
+        CUDA_ERROR(cudaMemcpy(m_d_ptrs,
+                              h_ptrs.data(),
+                              batch_size() * sizeof(T*),
+                              cudaMemcpyHostToDevice));
+
+        CUDA_ERROR(tracked_malloc((void**)&m_d_info,
+                                  batch_size() * sizeof(int),
+                                  MemoryCategory::Matrix));
+        CUDA_ERROR(cudaMemset(m_d_info, 0, batch_size() * sizeof(int)));
+
+        CUBLAS_ERROR(cublasCreate(&m_cublas_handle));
+        CUBLAS_ERROR(
+            cublasSetPointerMode(m_cublas_handle, CUBLAS_POINTER_MODE_HOST));
+
+        CUSOLVER_ERROR(cusolverDnCreate(&m_cusolver_handle));
+    }
+
+    __host__ bool is_square(const char* op) const
+    {
+        if (rows() != cols()) {
+            RXMESH_ERROR(
+                "BatchedDenseMatrix::{}() requires square matrices but the "
+                "matrices are {}x{}.",
+                op,
+                rows(),
+                cols());
+            return false;
+        }
+        return true;
+    }
+
+    __host__ bool is_rhs(const BatchedDenseMatrix<T>& B, const char* op) const
+    {
+        if (B.rows() != rows() || B.batch_size() != batch_size()) {
+            RXMESH_ERROR(
+                "BatchedDenseMatrix::{}() The right hand side size does not "
+                "match. B has {} rows and batch size {} while A is {}x{} with "
+                "batch size {}.",
+                op,
+                B.rows(),
+                B.batch_size(),
+                rows(),
+                cols(),
+                batch_size());
+            return false;
+        }
+        return true;
+    }
+
+    IndexT             m_batch_size;
+    IndexT             m_num_rows;
+    IndexT             m_num_cols;
+    DenseMatrix<T>     m_mat;
+    T**                m_d_ptrs;
+    int*               m_d_info;
+    int*               m_d_pivots;
+    cublasHandle_t     m_cublas_handle;
+    cusolverDnHandle_t m_cusolver_handle;
+};
+
+}  // namespace rxmesh
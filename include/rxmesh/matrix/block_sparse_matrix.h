@@ -0,0 +1,563 @@
+#pragma once
+#include "rxmesh/matrix/sparse_matrix.h"
+
+namespace rxmesh {
+
+/**
+ * @brief Block-sparse (BSR) matrix with KxK dense blocks that represents the
+ * VV connectivity of the mesh, i.e., there is a non-zero block (i,j) if the
+ * vertex i is connected to vertex j (and on the diagonal). This is the block
+ * counterpart of HessianSparseMatrix<T, K> where the column index is stored
+ * once per block (instead of once per scalar entry) and the SpMV loads every
+ * block into registers. Block rows follow the same order as SparseMatrix rows
+ * and the diagonal block is the first block in its row. The entries within a
+ * block are stored in row-major order. For the cuDSS path (which only accepts
+ * CSR), the matrix can be expanded to a scalar CSR matrix (see get_csr())
+ */
+template <typename T, int K>
+struct BlockSparseMatrix
+{
+    static_assert(K >= 1, "BlockSparseMatrix block size should be >= 1");
+
+    using IndexT = int;
+
+    using Type = T;
+
+    static constexpr int K_ = K;
+
+    // number of scalar entries in a block
+    static constexpr int BlockNNZ = K * K;
+
+    BlockSparseMatrix()
+        : m_context(Context()),
+          m_num_block_rows(0),
+          m_nnzb(0),
+          m_d_row_ptr(nullptr),
+          m_d_col_idx(nullptr),
+          m_d_val(nullptr),
+          m_h_row_ptr(nullptr),
+          m_h_col_idx(nullptr),
+          m_h_val(nullptr),
+          m_d_csr_row_ptr(nullptr),
+          m_d_csr_col_idx(nullptr),
+          m_d_csr_val(nullptr),
+          m_h_csr_row_ptr(nullptr),
+          m_h_csr_col_idx(nullptr),
+          m_h_csr_val(nullptr),
+          m_csr(nullptr)
+    {
+    }
+
+    /**
+     * @brief Constructor using the VV query of the mesh
+     */
+    BlockSparseMatrix(const RXMeshStatic& rx) : BlockSparseMatrix()
+    {
+        constexpr uint32_t blockThreads = 256;
+
+        m_context        = rx.get_context();
+        m_num_block_rows = rx.get_num_vertices();
+
+        // the block sparsity is the scalar VV sparsity
+        CUDA_ERROR(tracked_malloc((void**)&m_d_row_ptr,
+                                  (m_num_block_rows + 1) * sizeof(IndexT),
+                                  MemoryCategory::Matrix));
+        CUDA_ERROR(cudaMemset(
+            m_d_row_ptr, 0, (m_num_block_rows + 1) * sizeof(IndexT)));
+
+        rx.run_kernel<blockThreads>(
+            {Op::VV},
+            detail::sparse_mat_prescan<Op::VV, blockThreads>,
+            m_d_row_ptr,
+            IndexT(1));
+
+        void*  d_cub_temp_storage     = nullptr;
+        size_t cub_temp_storage_bytes = 0;
+        cub::DeviceScan::ExclusiveSum(d_cub_temp_storage,
+                                      cub_temp_storage_bytes,
+                                      m_d_row_ptr,
+                                      m_d_row_ptr,
+                                      m_num_block_rows + 1);
+        CUDA_ERROR(tracked_malloc((void**)&d_cub_temp_storage,
+                                  cub_temp_storage_bytes,
+                                  MemoryCategory::Matrix));
+        cub::DeviceScan::ExclusiveSum(d_cub_temp_storage,
+                                      cub_temp_storage_bytes,
+                                      m_d_row_ptr,
+                                      m_d_row_ptr,
+                                      m_num_block_rows + 1);
+        GPU_FREE(d_cub_temp_storage);
+
+        CUDA_ERROR(cudaMemcpy(&m_nnzb,
+                              m_d_row_ptr + m_num_block_rows,
+                              sizeof(IndexT),
+                              cudaMemcpyDeviceToHost));
+
+        CUDA_ERROR(tracked_malloc((void**)&m_d_col_idx,
+                                  m_nnzb * sizeof(IndexT),
+                                  MemoryCategory::Matrix));
+
+        rx.run_kernel<blockThreads>(
+            {Op::VV},
+            detail::sparse_mat_col_fill<Op::VV, blockThreads>,
+            m_d_row_ptr,
+            m_d_col_idx,
+            IndexT(1));
+
+        CUDA_ERROR(tracked_malloc((void**)&m_d_val,
+                                  non_zeros() * sizeof(T),
+                                  MemoryCategory::Matrix));
+        CUDA_ERROR(cudaMemset(m_d_val, 0, non_zeros() * sizeof(T)));
+
+        m_h_row_ptr = static_cast<IndexT*>(
+            malloc((m_num_block_rows + 1) * sizeof(IndexT)));
+        m_h_col_idx = static_cast<IndexT*>(malloc(m_nnzb * sizeof(IndexT)));
+        m_h_val     = static_cast<T*>(malloc(non_zeros() * sizeof(T)));
+
+        CUDA_ERROR(cudaMemcpy(m_h_row_ptr,
+                              m_d_row_ptr,
+                              (m_num_block_rows + 1) * sizeof(IndexT),
+                              cudaMemcpyDeviceToHost));
+        CUDA_ERROR(cudaMemcpy(m_h_col_idx,
+                              m_d_col_idx,
+                              m_nnzb * sizeof(IndexT),
+                              cudaMemcpyDeviceToHost));
+        std::fill_n(m_h_val, non_zeros(), T(0));
+    }
+
+    /**
+     * @brief number of (scalar) rows
+     */
+    __device__ __host__ IndexT rows() const
+    {
+        return m_num_block_rows * K;
+    }
+
+    /**
+     * @brief number of (scalar) cols
+     */
+    __device__ __host__ IndexT cols() const
+    {
+        return m_num_block_rows * K;
+    }
+
+    /**
+     * @brief number of block rows (i.e., number of vertices)
+     */
+    __device__ __host__ IndexT block_rows() const
+    {
+        return m_num_block_rows;
+    }
+
+    /**
+     * @brief number of non-zero blocks
+     */
+    __device__ __host__ IndexT non_zero_blocks() const
+    {
+        return m_nnzb;
+    }
+
+    /**
+     * @brief number of (scalar) non-zero values
+     */
+    __device__ __host__ IndexT non_zeros() const
+    {
+        return m_nnzb * BlockNNZ;
+    }
+
+    /**
+     * @brief return the block row index corresponding to a vertex handle
+     */
+    __device__ __host__ IndexT get_row_id(const VertexHandle& handle) const
+    {
+        auto id = handle.unpack();
+        return m_context.template prefix<VertexHandle>()[id.first] + id.second;
+    }
+
+    /**
+     * @brief return the block row pointer
+     */
+    __device__ __host__ IndexT* row_ptr() const
+    {
+#ifdef __CUDA_ARCH__
+        return m_d_row_ptr;
+#else
+        return m_h_row_ptr;
+#endif
+    }
+
+    /**
+     * @brief return the block column index
+     */
+    __device__ __host__ IndexT* col_idx() const
+    {
+#ifdef __CUDA_ARCH__
+        return m_d_col_idx;
+#else
+        return m_h_col_idx;
+#endif
+    }
+
+    /**
+     * @brief return the value pointer where every block is stored in BlockNNZ
+     * consecutive entries
+     */
+    __device__ __host__ T* val_ptr(locationT location) const
+    {
+        if (location == HOST) {
+            return m_h_val;
+        } else if (location == DEVICE) {
+            return m_d_val;
+        } else {
+            return nullptr;
+        }
+    }
+
+    /**
+     * @brief pointer to the (row-major) block (x,y) using block row and col
+     * index
+     */
+    __device__ __host__ T* block(const IndexT x, const IndexT y) const
+    {
+        const IndexT start = row_ptr()[x];
+        const IndexT end   = row_ptr()[x + 1];
+
+        for (IndexT b = start; b < end; ++b) {
+            if (col_idx()[b] == y) {
+#ifdef __CUDA_ARCH__
+                return m_d_val + b * BlockNNZ;
+#else
+                return m_h_val + b * BlockNNZ;
+#endif
+            }
+        }
+        assert(1 != 1);
+        return nullptr;
+    }
+
+    /**
+     * @brief access the matrix using row and col as VertexHandle's along with
+     * the local indices within the block (same as HessianSparseMatrix)
+     */
+    __device__ __host__ T& operator()(const VertexHandle& row_v,
+                                      const VertexHandle& col_v,
+                                      const IndexT        local_i,
+                                      const IndexT        local_j) const
+    {
+        assert(local_i < K && local_j < K);
+        return block(get_row_id(row_v), get_row_id(col_v))[local_i * K +
+                                                           local_j];
+    }
+
+    /**
+     * @brief set all entries in the matrix to certain value
+     */
+    __host__ void reset(T val, locationT location, cudaStream_t stream = NULL)
+    {
+        const IndexT nnz = non_zeros();
+        if ((location & HOST) == HOST) {
+            std::fill_n(m_h_val, nnz, val);
+        }
+        if ((location & DEVICE) == DEVICE) {
+            const int threads = 512;
+            memset<<<DIVIDE_UP(nnz, threads), threads, 0, stream>>>(
+                m_d_val, val, nnz);
+        }
+    }
+
+    /**
+     * @brief copy the values from source to target (the sparsity is the same
+     * on both)
+     */
+    __host__ void move(locationT    source,
+                       locationT    target,
+                       cudaStream_t stream = NULL)
+    {
+        const size_t bytes = non_zeros() * sizeof(T);
+        if (source == HOST && target == DEVICE) {
+            CUDA_ERROR(cudaMemcpyAsync(
+                m_d_val, m_h_val, bytes, cudaMemcpyHostToDevice, stream));
+        } else if (source == DEVICE && target == HOST) {
+            CUDA_ERROR(cudaMemcpyAsync(
+                m_h_val, m_d_val, bytes, cudaMemcpyDeviceToHost, stream));
+        }
+    }
+
+    /**
+     * @brief multiply the matrix by a dense matrix as
+     * C = alpha.op(A) * B + beta.C
+     * where op(A) is A or its transpose (set via is_a_transpose)
+     */
+    template <int Order>
+    __host__ void multiply(const DenseMatrix<T, Order>& B_mat,
+                           DenseMatrix<T, Order>&       C_mat,
+                           bool                         is_a_transpose = false,
+                           T                            alpha          = 1.,
+                           T                            beta           = 0.,
+                           cudaStream_t                 stream         = 0)
+    {
+        assert(cols() == B_mat.rows());
+        assert(rows() == C_mat.rows());
+        assert(B_mat.cols() == C_mat.cols());
+
+        launch_multiply(
+            B_mat, C_mat, B_mat.cols(), is_a_transpose, alpha, beta, stream);
+    }
+
+    /**
+     * @brief multiply the matrix by a dense vector as
+     * Y = alpha.op(A) * X + beta.Y
+     * where op(A) is A or its transpose (set via is_a_transpose)
+     */
+    __host__ void multiply(const T*     in_arr,
+                           T*           rt_arr,
+                           bool         is_a_transpose = false,
+                           T            alpha          = 1.,
+                           T            beta           = 0.,
+                           cudaStream_t stream         = 0)
+    {
+        launch_multiply(detail::RawVector<const T>{in_arr},
+                        detail::RawVector<T>{rt_arr},
+                        1,
+                        is_a_transpose,
+                        alpha,
+                        beta,
+                        stream);
+    }
+
+    /**
+     * @brief extract the (scalar) diagonal of the matrix into a device array
+     * of size rows()
+     */
+    __host__ void get_diagonal(T* d_diag, cudaStream_t stream = 0) const
+    {
+        const int blockThreads = 512;
+        for_each_item<<<DIVIDE_UP(rows(), blockThreads),
+                        blockThreads,
+                        0,
+                        stream>>>(
+            rows(),
+            [row_ptr = m_d_row_ptr, val = m_d_val, d_diag] __device__(
+                int i) mutable {
+                const int r = i / K;
+                const int k = i % K;
+                // the diagonal block is the first block in the row
+                d_diag[i] = val[row_ptr[r] * BlockNNZ + k * K + k];
+            });
+    }
+
+    /**
+     * @brief return a scalar CSR copy of this matrix, e.g., to be used with
+     * cuDSSCholeskySolver. The CSR sparsity is built once and its values
+     * should be updated with update_csr() every time the values of this
+     * matrix change (i.e., before calling pre_solve() of the direct solver).
+     * The CSR matrix is owned by this matrix and released with it
+     */
+    __host__ SparseMatrix<T>& get_csr()
+    {
+        if (m_csr == nullptr) {
+            build_csr();
+            update_csr();
+        }
+        return *m_csr;
+    }
+
+    /**
+     * @brief copy the values of this matrix (on the device) to the scalar CSR
+     * copy (see get_csr())
+     */
+    __host__ void update_csr(cudaStream_t stream = 0)
+    {
+        if (m_csr == nullptr) {
+            build_csr();
+        }
+
+        const int blockThreads = 256;
+        for_each_item<<<DIVIDE_UP(m_num_block_rows, blockThreads),
+                        blockThreads,
+                        0,
+                        stream>>>(
+            m_num_block_rows,
+            [row_ptr = m_d_row_ptr,
+             val     = m_d_val,
+             csr_val = m_d_csr_val] __device__(int r) mutable {
+                const IndexT start = row_ptr[r];
+                const IndexT nb    = row_ptr[r + 1] - start;
+                for (int i = 0; i < K; ++i) {
+                    T* csr_row = csr_val + start * BlockNNZ + i * nb * K;
+                    for (IndexT b = 0; b < nb; ++b) {
+                        for (int j = 0; j < K; ++j) {
+                            csr_row[b * K + j] =
+                                val[(start + b) * BlockNNZ + i * K + j];
+                        }
+                    }
+                }
+            });
+    }
+
+    /**
+     * @brief release all allocated memory
+     */
+    __host__ void release()
+    {
+        GPU_FREE(m_d_row_ptr);
+        GPU_FREE(m_d_col_idx);
+        GPU_FREE(m_d_val);
+        free(m_h_row_ptr);
+        free(m_h_col_idx);
+        free(m_h_val);
+        m_h_row_ptr = nullptr;
+        m_h_col_idx = nullptr;
+        m_h_val     = nullptr;
+
+        if (m_csr != nullptr) {
+            m_csr->release();
+            delete m_csr;
+            m_csr = nullptr;
+            GPU_FREE(m_d_csr_row_ptr);
+            GPU_FREE(m_d_csr_col_idx);
+            GPU_FREE(m_d_csr_val);
+            free(m_h_csr_row_ptr);
+            free(m_h_csr_col_idx);
+            free(m_h_csr_val);
+            m_h_csr_row_ptr = nullptr;
+            m_h_csr_col_idx = nullptr;
+            m_h_csr_val     = nullptr;
+        }
+    }
+
+   protected:
+    template <typename InT, typename OutT>
+    __host__ void launch_multiply(const InT    in,
+                                  OutT         out,
+                                  const int    num_cols,
+                                  bool         is_a_transpose,
+                                  T            alpha,
+                                  T            beta,
+                                  cudaStream_t stream)
+    {
+        const int blockThreads = 256;
+        const int blocks       = DIVIDE_UP(m_num_block_rows, blockThreads);
+
+        if (!is_a_transpose) {
+            detail::bsr_spmv<T, K>
+                <<<blocks, blockThreads, 0, stream>>>(m_num_block_rows,
+                                                      m_d_row_ptr,
+                                                      m_d_col_idx,
+                                                      m_d_val,
+                                                      in,
+                                                      out,
+                                                      num_cols,
+                                                      alpha,
+                                                      beta);
+        } else {
+            const IndexT n = rows();
+            for_each_item<<<DIVIDE_UP(n, blockThreads),
+                            blockThreads,
+                            0,
+                            stream>>>(
+                n, [out, beta, num_cols] __device__(int i) mutable {
+                    for (int c = 0; c < num_cols; ++c) {
+                        out(i, c) = (beta == T(0)) ? T(0) : beta * out(i, c);
+                    }
+                });
+
+            detail::bsr_spmv_transpose<T, K>
+                <<<blocks, blockThreads, 0, stream>>>(m_num_block_rows,
+                                                      m_d_row_ptr,
+                                                      m_d_col_idx,
+                                                      m_d_val,
+                                                      in,
+                                                      out,
+                                                      num_cols,
+                                                      alpha);
+        }
+    }
+
+    /**
+     * @brief build the sparsity of the scalar CSR copy. Scalar row r*K+i
+     * holds the i-th row of all the blocks in block row r (in order)
+     */
+    __host__ void build_csr()
+    {
+        const IndexT n   = rows();
+        const IndexT nnz = non_zeros();
+
+        m_h_csr_row_ptr =
+            static_cast<IndexT*>(malloc((n + 1) * sizeof(IndexT)));
+        m_h_csr_col_idx = static_cast<IndexT*>(malloc(nnz * sizeof(IndexT)));
+        m_h_csr_val     = static_cast<T*>(malloc(nnz * sizeof(T)));
+
+        for (IndexT r = 0; r < m_num_block_rows; ++r) {
+            const IndexT start = m_h_row_ptr[r];
+            const IndexT nb    = m_h_row_ptr[r + 1] - start;
+            for (int i = 0; i < K; ++i) {
+                const IndexT row_start     = start * BlockNNZ + i * nb * K;
+                m_h_csr_row_ptr[r * K + i] = row_start;
+                for (IndexT b = 0; b < nb; ++b) {
+                    for (int j = 0; j < K; ++j) {
+                        m_h_csr_col_idx[row_start + b * K + j] =
+                            m_h_col_idx[start + b] * K + j;
+                    }
+                }
+            }
+        }
+        m_h_csr_row_ptr[n] = nnz;
+        std::fill_n(m_h_csr_val, nnz, T(0));
+
+        CUDA_ERROR(tracked_malloc((void**)&m_d_csr_row_ptr,
+                                  (n + 1) * sizeof(IndexT),
+                                  MemoryCategory::Matrix));
+        CUDA_ERROR(tracked_malloc((void**)&m_d_csr_col_idx,
+                                  nnz * sizeof(IndexT),
+                                  MemoryCategory::Matrix));
+        CUDA_ERROR(tracked_malloc((void**)&m_d_csr_val,
+                                  nnz * sizeof(T),
+                                  MemoryCategory::Matrix));
+        CUDA_ERROR(cudaMemcpy(m_d_csr_row_ptr,
+                              m_h_csr_row_ptr,
+                              (n + 1) * sizeof(IndexT),
+                              cudaMemcpyHostToDevice));
+        CUDA_ERROR(cudaMemcpy(m_d_csr_col_idx,
+                              m_h_csr_col_idx,
+                              nnz * sizeof(IndexT),
+                              cudaMemcpyHostToDevice));
+
+        m_csr = new SparseMatrix<T>(n,
+                                    n,
+                                    nnz,
+                                    m_d_csr_row_ptr,
+                                    m_d_csr_col_idx,
+                                    m_d_csr_val,
+                                    m_h_csr_row_ptr,
+                                    m_h_csr_col_idx,
+                                    m_h_csr_val);
+    }
+
+   public:
+    Context m_context;
+
+    IndexT m_num_block_rows;
+    IndexT m_nnzb;
+
+    // device bsr data
+    IndexT* m_d_row_ptr;
+    IndexT* m_d_col_idx;
+    T*      m_d_val;
+
+    // host bsr data
+    IndexT* m_h_row_ptr;
+    IndexT* m_h_col_idx;
+    T*      m_h_val;
+
+    // scalar CSR copy (see get_csr())
+    IndexT*          m_d_csr_row_ptr;
+    IndexT*          m_d_csr_col_idx;
+    T*               m_d_csr_val;
+    IndexT*          m_h_csr_row_ptr;
+    IndexT*          m_h_csr_col_idx;
+    T*               m_h_csr_val;
+    SparseMatrix<T>* m_csr;
+};
+
+}  // namespace rxmesh
@@ -2,6 +2,7 @@
 #include "rxmesh/matrix/iterative_solver.h"
 
 #include "rxmesh/attribute.h"
+#include "rxmesh/attribute_expr.h"
 #include "rxmesh/matrix/dense_matrix.h"
 #include "rxmesh/reduce_handle.h"
 
@@ -75,29 +76,33 @@ struct CGMatFreeAttrSolver : public IterativeSolver<T, Attribute<T, HandleT>>
             alpha = reduce_handle.dot(S, P, INVALID32, stream);
             alpha = delta_new / alpha;
 
-            // X =  alpha*P + X
-            axpy(X, P, alpha, T(1.), stream);
+            // delta_old = delta_new
+            delta_old = delta_new;
 
             // reset residual
             if (this->m_iter_taken > 0 &&
                 this->m_iter_taken % m_reset_residual_freq == 0) {
+                // X =  alpha*P + X
+                axpy(X, P, alpha, T(1.), stream);
                 // s= Ax
                 m_mat_vec(X, S, stream);
                 // r = b-s
                 subtract(R, B, S, stream);
+
+                // delta_new = <r,r>
+                delta_new = reduce_handle.norm2(R, INVALID32, stream);
+                delta_new *= delta_new;
             } else {
-                // r = - alpha*s + r
-                axpy(R, S, -alpha, T(1.), stream);
+                // X =  alpha*P + X, r = - alpha*s + r, and delta_new = <r,r>
+                // in a single kernel
+                delta_new = reduce_handle.evaluate_dot(
+                    expr(R),
+                    expr(R),
+                    stream,
+                    assign(X, expr(X) + alpha * expr(P)),
+                    assign(R, expr(R) - alpha * expr(S)));
             }
 
-            // delta_old = delta_new
-            CUDA_ERROR(cudaStreamSynchronize(stream));
-            delta_old = delta_new;
-
-            // delta_new = <r,r>
-            delta_new = reduce_handle.norm2(R, INVALID32, stream);
-            delta_new *= delta_new;
-
             // exit if error is getting too low across three coordinates
             if (this->is_converged(this->m_start_residual, delta_new)) {
                 this->m_final_residual = delta_new;
@@ -1,6 +1,9 @@
 #pragma once
 #include "rxmesh/matrix/iterative_solver.h"
 
+#include <functional>
+
+#include "rxmesh/matrix/block_sparse_matrix.h"
 #include "rxmesh/matrix/dense_matrix.h"
 #include "rxmesh/matrix/sparse_matrix.h"
 
@@ -27,6 +30,7 @@ struct CGSolver : public IterativeSolver<T, DenseMatrix<T, DenseMatOrder>>
           delta_new(0),
           delta_old(0),
           m_reset_residual_freq(reset_residual_freq),
+          m_num_rows(sys.rows()),
           S(DenseMatT(sys.rows(), unknown_dim, DEVICE)),
           P(DenseMatT(sys.rows(), unknown_dim, DEVICE)),
           R(DenseMatT(sys.rows(), unknown_dim, DEVICE))
@@ -34,6 +38,33 @@ struct CGSolver : public IterativeSolver<T, DenseMatrix<T, DenseMatOrder>>
         A->alloc_multiply_buffer(S, P);
     }
 
+    /**
+     * @brief CG with a block-sparse (BSR) system matrix
+     */
+    template <int K>
+    CGSolver(BlockSparseMatrix<T, K>& sys,
+             int                      unknown_dim,  // num rhs vectors
+             int                      max_iter,
+             T                        abs_tol = 1e-6,
+             T                        rel_tol = 0.0,
+             int reset_residual_freq = std::numeric_limits<int>::max())
+        : CGSolver(sys.rows(),
+                   unknown_dim,
+                   max_iter,
+                   abs_tol,
+                   rel_tol,
+                   reset_residual_freq)
+    {
+        m_block_mat_vec = [&sys](const DenseMatT& in,
+                                 DenseMatT&       out,
+                                 cudaStream_t     stream) {
+            sys.multiply(in, out, false, T(1), T(0), stream);
+        };
+        m_block_diagonal = [&sys](T* d_diag, cudaStream_t stream) {
+            sys.get_diagonal(d_diag, stream);
+        };
+    }
+
     virtual void pre_solve(const DenseMatT& B,
                            DenseMatT&       X,
                            cudaStream_t     stream = NULL) override
@@ -207,13 +238,13 @@ struct CGSolver : public IterativeSolver<T, DenseMatrix<T, DenseMatOrder>>
                          DenseMatT&       out,
                          cudaStream_t     stream)
     {
-        if (A->cols() != in.rows() || A->rows() != out.rows() ||
+        if (sys_cols() != in.rows() || sys_rows() != out.rows() ||
             in.cols() != out.cols()) {
             RXMESH_ERROR(
                 "CGSolver::mat_vec mismatch in the input/output size. A ({}, "
                 "{}), In ({}, {}), Out ({}, {})",
-                A->rows(),
-                A->cols(),
+                sys_rows(),
+                sys_cols(),
                 in.rows(),
                 in.cols(),
                 out.rows(),
@@ -221,8 +252,25 @@ struct CGSolver : public IterativeSolver<T, DenseMatrix<T, DenseMatOrder>>
             return;
         }
 
+        if (m_block_mat_vec) {
+            m_block_mat_vec(in, out, stream);
+        } else {
+            A->multiply(in, out, false, false, 1, 0, stream);
+        }
+    }
 
-        A->multiply(in, out, false, false, 1, 0, stream);
+    /**
+     * @brief number of rows/cols of the system matrix (which is either the
+     * sparse matrix A or a block-sparse matrix)
+     */
+    int sys_rows() const
+    {
+        return (A != nullptr) ? A->rows() : m_num_rows;
+    }
+
+    int sys_cols() const
+    {
+        return (A != nullptr) ? A->cols() : m_num_rows;
     }
 
     CGSolver(int num_rows,
@@ -238,6 +286,7 @@ struct CGSolver : public IterativeSolver<T, DenseMatrix<T, DenseMatOrder>>
           delta_new(0),
           delta_old(0),
           m_reset_residual_freq(reset_residual_freq),
+          m_num_rows(num_rows),
           S(DenseMatT(num_rows, unknown_dim, DEVICE)),
           P(DenseMatT(num_rows, unknown_dim, DEVICE)),
           R(DenseMatT(num_rows, unknown_dim, DEVICE))
@@ -248,6 +297,13 @@ struct CGSolver : public IterativeSolver<T, DenseMatrix<T, DenseMatOrder>>
     DenseMatT        S, P, R;
     T                alpha, beta, delta_new, delta_old;
     int              m_reset_residual_freq;
+    int              m_num_rows;
+
+    // set if the system matrix is a BlockSparseMatrix (in which case A is
+    // null)
+    std::function<void(const DenseMatT&, DenseMatT&, cudaStream_t)>
+                                          m_block_mat_vec;
+    std::function<void(T*, cudaStream_t)> m_block_diagonal;
 };
 
 }  // namespace rxmesh
@@ -16,7 +16,8 @@ struct CholeskySolver : public DirectSolver<SpMatT, DenseMatOrder>
           m_internalDataInBytes(0),
           m_workspaceInBytes(0),
           m_solver_buffer(nullptr),
-          m_first_pre_solve(true)
+          m_first_pre_solve(true),
+          m_analyzed(false)
     {
     }
 
@@ -25,7 +26,8 @@ struct CholeskySolver : public DirectSolver<SpMatT, DenseMatOrder>
           m_internalDataInBytes(0),
           m_workspaceInBytes(0),
           m_solver_buffer(nullptr),
-          m_first_pre_solve(true)
+          m_first_pre_solve(true),
+          m_analyzed(false)
     {
         CUSOLVER_ERROR(cusolverSpCreateCsrcholInfo(&m_chol_info));
     }
@@ -38,22 +40,63 @@ struct CholeskySolver : public DirectSolver<SpMatT, DenseMatOrder>
 
     /**
      * @brief pre_solve should be called before calling the solve() method.
-     * and it should be called every time the matrix is updated
+     * and it should be called every time the matrix is updated. The symbolic
+     * analysis is done only on the first call and reused afterwards since the
+     * sparsity of the matrix does not change
      */
     virtual void pre_solve(RXMeshStatic& rx) override
     {
-        if (m_first_pre_solve) {
-            m_first_pre_solve = false;
-            this->permute_alloc();
-            this->permute(rx);
+        if (!m_analyzed) {
+            analyze_pattern(rx);
+        }
+        refactorize();
+    }
+
+    /**
+     * @brief the symbolic part of pre_solve(), i.e., permute the matrix, run
+     * the symbolic analysis, and allocate the factorization buffer. This only
+     * depends on the sparsity of the matrix and is reused by all subsequent
+     * calls to refactorize(). The permutation is also reused across solvers
+     * whose matrices have the same sparsity (see PermuteCache)
+     */
+    void analyze_pattern(RXMeshStatic& rx)
+    {
+        this->permute_alloc();
+        this->permute(rx);
+        if (this->m_use_permute) {
             this->premute_value_ptr();
-            analyze_pattern();
-            post_analyze_alloc();
-            factorize();
-        } else {
+        }
+        analyze_pattern();
+        post_analyze_alloc();
+    }
+
+    /**
+     * @brief the numerical part of pre_solve(). Should be called every time
+     * the values of the matrix change (but not its sparsity) after
+     * analyze_pattern() has been called once
+     */
+    void refactorize()
+    {
+        if (!m_analyzed) {
+            RXMESH_ERROR(
+                "CholeskySolver::refactorize() analyze_pattern() should be "
+                "called before refactorize(). Returning without "
+                "factorization.");
+            return;
+        }
+
+        if (this->m_use_permute) {
             this->premute_value_ptr();
-            factorize();
         }
+        factorize();
+    }
+
+    /**
+     * @brief if the symbolic analysis has been done
+     */
+    bool is_analyzed() const
+    {
+        return m_analyzed;
     }
 
 
@@ -78,8 +121,13 @@ struct CholeskySolver : public DirectSolver<SpMatT, DenseMatOrder>
         if (this->m_mat->cols() == X_mat.rows() &&
             this->m_mat->rows() == B_mat.rows() &&
             X_mat.cols() == B_mat.cols()) {
-            for (int i = 0; i < B_mat.cols(); ++i) {
-                solve(B_mat.col_data(i, DEVICE), X_mat.col_data(i, DEVICE));
+            if (B_mat.cols() == 1) {
+                solve(B_mat.col_data(0, DEVICE), X_mat.col_data(0, DEVICE));
+            } else {
+                solve(B_mat.data(DEVICE),
+                      X_mat.data(DEVICE),
+                      B_mat.cols(),
+                      stream);
             }
         } else if (this->m_mat->cols() == X_mat.rows() * X_mat.cols() &&
                    this->m_mat->rows() == B_mat.rows() * B_mat.cols()) {
@@ -152,6 +200,7 @@ struct CholeskySolver : public DirectSolver<SpMatT, DenseMatOrder>
                                                   this->m_d_solver_row_ptr,
                                                   this->m_d_solver_col_idx,
                                                   m_chol_info));
+        m_analyzed = true;
     }
 
 
@@ -229,7 +278,9 @@ struct CholeskySolver : public DirectSolver<SpMatT, DenseMatOrder>
             "workspaceInBytes= {}",
             m_internalDataInBytes,
             m_workspaceInBytes);
-        CUDA_ERROR(cudaMalloc((void**)&m_solver_buffer, m_workspaceInBytes));
+        CUDA_ERROR(tracked_malloc((void**)&m_solver_buffer,
+                                  m_workspaceInBytes,
+                                  MemoryCategory::Solver));
     }
 
     /**
@@ -346,6 +397,62 @@ struct CholeskySolver : public DirectSolver<SpMatT, DenseMatOrder>
         }
 
 
+        chol_solve(d_solver_b, d_solver_x);
+
+
+        if (this->m_use_permute) {
+            this->permute_scatter(
+                this->m_d_permute, d_solver_x, d_x, this->m_mat->rows());
+            this->permute_scatter(
+                this->m_d_permute, d_solver_b, d_b, this->m_mat->rows());
+        }
+    }
+
+    /**
+     * @brief solve for num_rhs right-hand sides at once after factorization.
+     * d_B and d_X are (rows x num_rhs) dense matrices on the device with
+     * DenseMatOrder layout. All right-hand sides are permuted (and
+     * re-laid-out if row-major) in a single pass into a contiguous workspace,
+     * solved, and permuted back in a single pass
+     * @param d_B: right hand sides
+     * @param d_X: output solutions
+     * @param num_rhs: number of right hand sides
+     */
+    virtual void solve(const T*     d_B,
+                       T*           d_X,
+                       int          num_rhs,
+                       cudaStream_t stream = NULL)
+    {
+        const int n = this->m_mat->rows();
+
+        this->multi_rhs_alloc(num_rhs);
+
+        const auto* d_p = this->m_use_permute ? this->m_d_permute : nullptr;
+
+        this->permute_gather_multi(
+            d_p, d_B, this->m_d_multi_b, n, num_rhs, stream);
+
+        for (int j = 0; j < num_rhs; ++j) {
+            chol_solve(this->m_d_multi_b + size_t(j) * n,
+                       this->m_d_multi_x + size_t(j) * n);
+        }
+
+        this->permute_scatter_multi(
+            d_p, this->m_d_multi_x, d_X, n, num_rhs, stream);
+    }
+
+    virtual std::string name() override
+    {
+        return std::string("Cholesky");
+    }
+
+   protected:
+    /**
+     * @brief triangular solves with the Cholesky factor for a single
+     * (permuted) right-hand side
+     */
+    void chol_solve(T* d_solver_b, T* d_solver_x)
+    {
         if constexpr (std::is_same_v<T, float>) {
             CUSOLVER_ERROR(cusolverSpScsrcholSolve(this->m_cusolver_sphandle,
                                                    this->m_mat->rows(),
@@ -380,22 +487,8 @@ struct CholeskySolver : public DirectSolver<SpMatT, DenseMatOrder>
                                                    m_chol_info,
                                                    m_solver_buffer));
         }
-
-
-        if (this->m_use_permute) {
-            this->permute_scatter(
-                this->m_d_permute, d_solver_x, d_x, this->m_mat->rows());
-            this->permute_scatter(
-                this->m_d_permute, d_solver_b, d_b, this->m_mat->rows());
-        }
-    }
-
-    virtual std::string name() override
-    {
-        return std::string("Cholesky");
     }
 
-   protected:
     /**
      * @brief wrapper for cuSolver API for solving linear systems using cuSolver
      * High-level API
@@ -486,6 +579,9 @@ struct CholeskySolver : public DirectSolver<SpMatT, DenseMatOrder>
     void* m_solver_buffer;
 
     bool m_first_pre_solve;
+
+    // if the symbolic analysis (analyze_pattern()) has been done
+    bool m_analyzed;
 };
 
 }  // namespace rxmesh
\ No newline at end of file
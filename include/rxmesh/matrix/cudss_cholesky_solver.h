@@ -2,6 +2,7 @@
 #ifdef USE_CUDSS
 
 #include "rxmesh/matrix/direct_solver.h"
+#include "rxmesh/matrix/permute_cache.h"
 
 #include <cudss.h>
 
@@ -14,14 +15,21 @@ struct cuDSSCholeskySolver : public DirectSolver<SpMatT, DenseMatOrder>
     using T      = typename SpMatT::Type;
 
     cuDSSCholeskySolver()
-        : DirectSolver<SpMatT, DenseMatOrder>(), m_first_pre_solve(false)
+        : DirectSolver<SpMatT, DenseMatOrder>(),
+          m_first_pre_solve(false),
+          m_analyzed(false),
+          m_factorized(false),
+          m_d_user_perm(nullptr)
     {
     }
 
     cuDSSCholeskySolver(SpMatT* mat, PermuteMethod perm = PermuteMethod::NSTDIS)
         : DirectSolver<SpMatT, DenseMatOrder>(mat, perm),
           m_A(mat->get_cudss_matrix()),
-          m_first_pre_solve(true)
+          m_first_pre_solve(true),
+          m_analyzed(false),
+          m_factorized(false),
+          m_d_user_perm(nullptr)
     {
         CUDSS_ERROR(cudssCreate(&m_cudss_handle));
         CUDSS_ERROR(cudssConfigCreate(&m_cudss_config));
@@ -30,6 +38,7 @@ struct cuDSSCholeskySolver : public DirectSolver<SpMatT, DenseMatOrder>
 
     virtual ~cuDSSCholeskySolver()
     {
+        GPU_FREE(m_d_user_perm);
         CUDSS_ERROR(cudssConfigDestroy(m_cudss_config));
         CUDSS_ERROR(cudssDataDestroy(m_cudss_handle, m_cudss_data));
         CUDSS_ERROR(cudssDestroy(m_cudss_handle));
@@ -45,20 +54,41 @@ struct cuDSSCholeskySolver : public DirectSolver<SpMatT, DenseMatOrder>
 
     /**
      * @brief pre_solve should be called before calling the solve() method.
-     * and it should be called every time the matrix is updated
+     * and it should be called every time the matrix is updated. The
+     * reordering and symbolic factorization are done only on the first call
+     * and reused afterwards since the sparsity of the matrix does not change
      */
     virtual void pre_solve(RXMeshStatic&                  rx,
                            DenseMatrix<T, DenseMatOrder>& B_mat,
                            DenseMatrix<T, DenseMatOrder>& X_mat)
     {
-        if (m_first_pre_solve) {
-            permute(rx, B_mat, X_mat);
-            analyze_pattern();
-            factorize();
-            m_first_pre_solve = false;
-        } else {
-            factorize();
+        if (!m_analyzed) {
+            analyze_pattern(rx, B_mat, X_mat);
         }
+        factorize();
+    }
+
+    /**
+     * @brief the symbolic part of pre_solve(), i.e., reordering and symbolic
+     * factorization. This only depends on the sparsity of the matrix and is
+     * reused by all subsequent calls to factorize(). The reordering is also
+     * reused across solvers whose matrices have the same sparsity (see
+     * PermuteCache)
+     */
+    void analyze_pattern(RXMeshStatic&                  rx,
+                         DenseMatrix<T, DenseMatOrder>& B_mat,
+                         DenseMatrix<T, DenseMatOrder>& X_mat)
+    {
+        permute(rx, B_mat, X_mat);
+        analyze_pattern();
+    }
+
+    /**
+     * @brief if the symbolic analysis has been done
+     */
+    bool is_analyzed() const
+    {
+        return m_analyzed;
     }
 
     /**
@@ -72,6 +102,33 @@ struct cuDSSCholeskySolver : public DirectSolver<SpMatT, DenseMatOrder>
             m_B = B_mat.get_cudss_matrix();
             m_X = X_mat.get_cudss_matrix();
         }
+
+        // reuse the reordering of a matrix with the same sparsity (if any)
+        // by passing it to cuDSS as a user permutation
+        const IndexT num_rows = this->m_mat->rows();
+
+        const bool cacheable = this->m_perm != PermuteMethod::GPUND &&
+                               this->m_perm != PermuteMethod::AUTO &&
+                               this->m_mat->row_ptr(HOST) != nullptr &&
+                               this->m_mat->col_idx(HOST) != nullptr;
+        bool       cached    = false;
+
+        PermuteCache::Key key;
+
+        if (cacheable) {
+            key = PermuteCache::make_key(num_rows,
+                                         this->m_mat->non_zeros(),
+                                         this->m_mat->row_ptr(HOST),
+                                         this->m_mat->col_idx(HOST),
+                                         this->m_perm);
+
+            std::vector<IndexT> h_perm(num_rows);
+            if (PermuteCache::find(key, h_perm.data())) {
+                cached = true;
+                set_user_perm(h_perm.data());
+            }
+        }
+
         // set reorder type
         cudssAlgType_t reorder_alg;
         switch (this->m_perm) {
@@ -91,7 +148,8 @@ struct cuDSSCholeskySolver : public DirectSolver<SpMatT, DenseMatOrder>
                 reorder_alg = CUDSS_ALG_1;
                 break;
             }
-            case PermuteMethod::GPUND: {
+            case PermuteMethod::GPUND:
+            case PermuteMethod::AUTO: {
                 reorder_alg = CUDSS_ALG_DEFAULT;
                 DirectSolver<SpMatT, DenseMatOrder>::permute(rx);
                 CUDSS_ERROR(
@@ -99,7 +157,7 @@ struct cuDSSCholeskySolver : public DirectSolver<SpMatT, DenseMatOrder>
                                  m_cudss_data,
                                  CUDSS_DATA_USER_PERM,
                                  this->m_d_permute,
-                                 size_t(m_mat->rows() * sizeof(IndexT))));
+                                 size_t(num_rows * sizeof(IndexT))));
                 break;
             }
             case PermuteMethod::GPUMGND:
@@ -120,6 +178,18 @@ struct cuDSSCholeskySolver : public DirectSolver<SpMatT, DenseMatOrder>
                                  m_A,
                                  m_X,
                                  m_B));
+
+        if (cacheable && !cached && PermuteCache::is_enabled()) {
+            std::vector<IndexT> h_perm(num_rows);
+            size_t              written = 0;
+            CUDSS_ERROR(cudssDataGet(m_cudss_handle,
+                                     m_cudss_data,
+                                     CUDSS_DATA_PERM_REORDER_ROW,
+                                     h_perm.data(),
+                                     size_t(num_rows * sizeof(IndexT)),
+                                     &written));
+            PermuteCache::insert(key, h_perm.data());
+        }
     }
 
     /**
@@ -135,14 +205,25 @@ struct cuDSSCholeskySolver : public DirectSolver<SpMatT, DenseMatOrder>
                                  m_A,
                                  m_X,
                                  m_B));
+        m_analyzed = true;
     }
 
     /**
-     * @brief numerical (re-)factorization
+     * @brief numerical (re-)factorization. The first call after
+     * analyze_pattern() does a full numerical factorization and every later
+     * call only refactorizes with the new values of the matrix
      */
     virtual void factorize()
     {
-        if (m_first_pre_solve) {
+        if (!m_analyzed) {
+            RXMESH_ERROR(
+                "cuDSSCholeskySolver::factorize() analyze_pattern() should be "
+                "called before factorize(). Returning without "
+                "factorization.");
+            return;
+        }
+
+        if (!m_factorized) {
             // Numerical factorization
             CUDSS_ERROR(cudssExecute(m_cudss_handle,
                                      CUDSS_PHASE_FACTORIZATION,
@@ -163,6 +244,9 @@ struct cuDSSCholeskySolver : public DirectSolver<SpMatT, DenseMatOrder>
         }
 
 
+        m_factorized      = true;
+        m_first_pre_solve = false;
+
         size_t sizeInBytes = sizeof(int);
         size_t sizeWritten;
         int    singularity = 0;
@@ -209,8 +293,40 @@ struct cuDSSCholeskySolver : public DirectSolver<SpMatT, DenseMatOrder>
     }
 
    protected:
+    /**
+     * @brief pass h_perm (host) to cuDSS as the reordering permutation
+     */
+    void set_user_perm(const IndexT* h_perm)
+    {
+        const IndexT num_rows = this->m_mat->rows();
+        if (m_d_user_perm == nullptr) {
+            CUDA_ERROR(tracked_malloc((void**)&m_d_user_perm,
+                                      num_rows * sizeof(IndexT),
+                                      MemoryCategory::Solver));
+        }
+        CUDA_ERROR(cudaMemcpy(m_d_user_perm,
+                              h_perm,
+                              num_rows * sizeof(IndexT),
+                              cudaMemcpyHostToDevice));
+        CUDSS_ERROR(cudssDataSet(m_cudss_handle,
+                                 m_cudss_data,
+                                 CUDSS_DATA_USER_PERM,
+                                 m_d_user_perm,
+                                 size_t(num_rows * sizeof(IndexT))));
+    }
+
     bool m_first_pre_solve;
 
+    // if the reordering and symbolic factorization have been done
+    bool m_analyzed;
+
+    // if the first numerical factorization has been done so later
+    // factorizations are refactorizations
+    bool m_factorized;
+
+    // a cached reordering passed to cuDSS as user permutation
+    IndexT* m_d_user_perm;
+
     cudssHandle_t m_cudss_handle;
     cudssConfig_t m_cudss_config;
     cudssData_t   m_cudss_data;
@@ -0,0 +1,433 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "rxmesh/geometry_kernels.cuh"
+#include "rxmesh/matrix/dense_matrix.h"
+#include "rxmesh/matrix/laplacian_operator.h"
+#include "rxmesh/matrix/sparse_matrix.h"
+#include "rxmesh/rxmesh_static.h"
+
+namespace rxmesh {
+
+/**
+ * @brief the discrete exterior calculus (DEC) operators of a triangle mesh:
+ * the exterior derivatives d0 (0-forms on vertices to 1-forms on edges) and
+ * d1 (1-forms on edges to 2-forms on faces) along with the diagonal Hodge
+ * stars star0 (the Voronoi area of every vertex), star1 (the cotan weight
+ * (cot(a) + cot(b))/2 of every edge), and star2 (one over the area of every
+ * face), built once from the vertex coordinates. Every edge is oriented from
+ * its first to its second vertex (as returned by EV) and every face from its
+ * FV order such that (d0 u)(e) = u(v1) - u(v0) and d1 * d0 = 0. The
+ * derivatives are applied matrix-free with one EV (or FE) query per patch in
+ * shared memory and no matrix is stored. They could also be assembled into a
+ * SparseMatrix with the EV (or FE) sparsity (e.g., for direct solvers) e.g.,
+ * d0^T * star1 * d0 is the cotan Laplacian of LaplacianOperator. Every column
+ * of the inputs and outputs is one form. As for LaplacianOperator, call
+ * update() after changing the coordinates
+ */
+template <typename T>
+struct DECOperator
+{
+    /**
+     * @brief build the operator
+     * @param rx the input mesh
+     * @param coords the vertex coordinates
+     */
+    DECOperator(RXMeshStatic& rx, const VertexAttribute<T>& coords)
+        : m_rx(rx),
+          m_coords(coords),
+          m_fingerprint(0),
+          m_num_builds(0)
+    {
+        const std::string suffix(coords.get_name());
+
+        m_star0_name = "decStar0_" + suffix;
+        m_star1_name = "decStar1_" + suffix;
+        m_star2_name = "decStar2_" + suffix;
+
+        // computed on the device
+        m_star0 = m_rx.add_vertex_attribute<T>(m_star0_name, 1);
+        m_star1 = m_rx.add_edge_attribute<T>(m_star1_name, 1);
+        m_star2 = m_rx.add_face_attribute<T>(m_star2_name, 1);
+
+        rebuild();
+    }
+
+    DECOperator(const DECOperator&)            = delete;
+    DECOperator& operator=(const DECOperator&) = delete;
+
+    ~DECOperator()
+    {
+        if (m_d0) {
+            m_d0->release();
+        }
+        if (m_d1) {
+            m_d1->release();
+        }
+        m_rx.remove_attribute(m_star0_name);
+        m_rx.remove_attribute(m_star1_name);
+        m_rx.remove_attribute(m_star2_name);
+    }
+
+    /**
+     * @brief true if the coordinates have changed since the last build
+     */
+    bool is_stale() const
+    {
+        return detail::attribute_fingerprint(m_rx, m_coords) != m_fingerprint;
+    }
+
+    /**
+     * @brief rebuild the Hodge stars if the coordinates have changed
+     * @return true if the operator is rebuilt
+     */
+    bool update()
+    {
+        if (!is_stale()) {
+            return false;
+        }
+        rebuild();
+        return true;
+    }
+
+    /**
+     * @brief (re-)compute the Hodge stars from the current coordinates
+     */
+    void rebuild()
+    {
+        constexpr geometryT quantities = GEOM_COTAN_WEIGHT | GEOM_VORONOI_AREA;
+
+        GeometryAttributes<T> geom =
+            compute_geometry<quantities, T>(m_rx, m_coords);
+
+        const EdgeAttribute<T>   g_weight = *geom.cotan_weight;
+        const VertexAttribute<T> g_area   = *geom.voronoi_area;
+        const VertexAttribute<T> coords   = m_coords;
+        VertexAttribute<T>       star0    = *m_star0;
+        EdgeAttribute<T>         star1    = *m_star1;
+        FaceAttribute<T>         star2    = *m_star2;
+
+        m_rx.for_each_vertex(DEVICE,
+                             [=] __device__(const VertexHandle& vh) mutable {
+                                 star0(vh) = g_area(vh);
+                             });
+
+        m_rx.for_each_edge(DEVICE,
+                           [=] __device__(const EdgeHandle& eh) mutable {
+                               star1(eh) = g_weight(eh);
+                           });
+
+        m_rx.run_query_kernel<Op::FV, 256>(
+            [=] __device__(const FaceHandle&     fh,
+                           const VertexIterator& fv) mutable {
+                const T a = tri_area(coords.template to_glm<3>(fv[0]),
+                                     coords.template to_glm<3>(fv[1]),
+                                     coords.template to_glm<3>(fv[2]));
+                star2(fh) = (a > T(0)) ? T(1) / a : T(0);
+            });
+
+        CUDA_ERROR(cudaDeviceSynchronize());
+        m_rx.remove_attribute("geomCotanWeight");
+        m_rx.remove_attribute("geomVoronoiArea");
+
+        m_fingerprint = detail::attribute_fingerprint(m_rx, m_coords);
+        m_num_builds++;
+    }
+
+    /**
+     * @brief the number of times the operator has been (re-)built
+     */
+    uint32_t num_builds() const
+    {
+        return m_num_builds;
+    }
+
+    /**
+     * @brief the diagonal of star0 (the Voronoi area of every vertex)
+     */
+    const VertexAttribute<T>& hodge0() const
+    {
+        return *m_star0;
+    }
+
+    /**
+     * @brief the diagonal of star1 (the cotan weight of every edge)
+     */
+    const EdgeAttribute<T>& hodge1() const
+    {
+        return *m_star1;
+    }
+
+    /**
+     * @brief the diagonal of star2 (one over the area of every face)
+     */
+    const FaceAttribute<T>& hodge2() const
+    {
+        return *m_star2;
+    }
+
+    /**
+     * @brief out = d0 * in where in has one row per vertex and out has one
+     * row per edge
+     */
+    void d0(const DenseMatrix<T>& in,
+            DenseMatrix<T>&       out,
+            cudaStream_t          stream = NULL) const
+    {
+        const int cols = in.cols();
+
+        m_rx.run_query_kernel<Op::EV, 256>(
+            [=] __device__(const EdgeHandle&     eh,
+                           const VertexIterator& ev) mutable {
+                for (int c = 0; c < cols; ++c) {
+                    out(eh, c) = in(ev[1], c) - in(ev[0], c);
+                }
+            },
+            false,
+            stream);
+    }
+
+    /**
+     * @brief out = d0^T * in where in has one row per edge and out has one
+     * row per vertex
+     */
+    void d0_transpose(const DenseMatrix<T>& in,
+                      DenseMatrix<T>&       out,
+                      cudaStream_t          stream = NULL) const
+    {
+        const int cols = in.cols();
+
+        out.reset(0, DEVICE, stream);
+
+        m_rx.run_query_kernel<Op::EV, 256>(
+            [=] __device__(const EdgeHandle&     eh,
+                           const VertexIterator& ev) mutable {
+                for (int c = 0; c < cols; ++c) {
+                    const T val = in(eh, c);
+                    ::atomicAdd(&out(ev[1], c), val);
+                    ::atomicAdd(&out(ev[0], c), -val);
+                }
+            },
+            false,
+            stream);
+    }
+
+    /**
+     * @brief out = d1 * in where in has one row per edge and out has one row
+     * per face
+     */
+    void d1(const DenseMatrix<T>& in,
+            DenseMatrix<T>&       out,
+            cudaStream_t          stream = NULL) const
+    {
+        const int cols = in.cols();
+
+        m_rx.run_query_kernel<Op::FE, 256>(
+            [=] __device__(const FaceHandle&   fh,
+                           const EdgeIterator& fe) mutable {
+                for (int c = 0; c < cols; ++c) {
+                    T sum = 0;
+                    for (uint16_t i = 0; i < fe.size(); ++i) {
+                        const T val = in(fe[i], c);
+                        sum += fe.is_flipped(i) ? -val : val;
+                    }
+                    out(fh, c) = sum;
+                }
+            },
+            false,
+            stream);
+    }
+
+    /**
+     * @brief out = d1^T * in where in has one row per face and out has one
+     * row per edge
+     */
+    void d1_transpose(const DenseMatrix<T>& in,
+                      DenseMatrix<T>&       out,
+                      cudaStream_t          stream = NULL) const
+    {
+        const int cols = in.cols();
+
+        out.reset(0, DEVICE, stream);
+
+        m_rx.run_query_kernel<Op::FE, 256>(
+            [=] __device__(const FaceHandle&   fh,
+                           const EdgeIterator& fe) mutable {
+                for (int c = 0; c < cols; ++c) {
+                    const T val = in(fh, c);
+                    for (uint16_t i = 0; i < fe.size(); ++i) {
+                        ::atomicAdd(&out(fe[i], c),
+                                    fe.is_flipped(i) ? -val : val);
+                    }
+                }
+            },
+            false,
+            stream);
+    }
+
+    /**
+     * @brief out = star0 * in (or star0^-1 * in) where in and out have one
+     * row per vertex
+     */
+    void star0(const DenseMatrix<T>& in,
+               DenseMatrix<T>&       out,
+               const bool            inverse = false,
+               cudaStream_t          stream  = NULL) const
+    {
+        apply_star<VertexHandle>(*m_star0, in, out, inverse, stream);
+    }
+
+    /**
+     * @brief out = star1 * in (or star1^-1 * in) where in and out have one
+     * row per edge
+     */
+    void star1(const DenseMatrix<T>& in,
+               DenseMatrix<T>&       out,
+               const bool            inverse = false,
+               cudaStream_t          stream  = NULL) const
+    {
+        apply_star<EdgeHandle>(*m_star1, in, out, inverse, stream);
+    }
+
+    /**
+     * @brief out = star2 * in (or star2^-1 * in) where in and out have one
+     * row per face
+     */
+    void star2(const DenseMatrix<T>& in,
+               DenseMatrix<T>&       out,
+               const bool            inverse = false,
+               cudaStream_t          stream  = NULL) const
+    {
+        apply_star<FaceHandle>(*m_star2, in, out, inverse, stream);
+    }
+
+    /**
+     * @brief out = diag(star) * in (or its inverse) for the mesh elements of
+     * type HandleT. Zero entries stay zero in the inverse
+     */
+    template <typename HandleT>
+    void apply_star(const Attribute<T, HandleT>& star,
+                    const DenseMatrix<T>&        in,
+                    DenseMatrix<T>&              out,
+                    const bool                   inverse,
+                    cudaStream_t                 stream) const
+    {
+        const int cols = in.cols();
+
+        m_rx.for_each<HandleT>(
+            DEVICE,
+            [=] __device__(const HandleT& h) mutable {
+                T s = star(h);
+                if (inverse) {
+                    s = (s != T(0)) ? T(1) / s : T(0);
+                }
+                for (int c = 0; c < cols; ++c) {
+                    out(h, c) = s * in(h, c);
+                }
+            },
+            stream);
+    }
+
+    /**
+     * @brief assemble d0 into mat which should have the EV sparsity i.e.,
+     * SparseMatrix<T>(rx, Op::EV). The values are written on the device
+     */
+    void assemble_d0(SparseMatrix<T>& mat) const
+    {
+        mat.reset(0, DEVICE);
+
+        m_rx.run_query_kernel<Op::EV, 256>(
+            [=] __device__(const EdgeHandle&     eh,
+                           const VertexIterator& ev) mutable {
+                mat(eh, ev[0]) = T(-1);
+                mat(eh, ev[1]) = T(1);
+            });
+    }
+
+    /**
+     * @brief assemble d1 into mat which should have the FE sparsity i.e.,
+     * SparseMatrix<T>(rx, Op::FE). The values are written on the device
+     */
+    void assemble_d1(SparseMatrix<T>& mat) const
+    {
+        mat.reset(0, DEVICE);
+
+        m_rx.run_query_kernel<Op::FE, 256>(
+            [=] __device__(const FaceHandle&   fh,
+                           const EdgeIterator& fe) mutable {
+                for (uint16_t i = 0; i < fe.size(); ++i) {
+                    mat(fh, fe[i]) = fe.is_flipped(i) ? T(-1) : T(1);
+                }
+            });
+    }
+
+    /**
+     * @brief the assembled d0 owned by the operator. It only depends on the
+     * connectivity and is assembled once
+     */
+    SparseMatrix<T>& d0_matrix()
+    {
+        if (!m_d0) {
+            m_d0 = std::make_unique<SparseMatrix<T>>(m_rx, Op::EV);
+            assemble_d0(*m_d0);
+        }
+        return *m_d0;
+    }
+
+    /**
+     * @brief the assembled d1 owned by the operator. It only depends on the
+     * connectivity and is assembled once
+     */
+    SparseMatrix<T>& d1_matrix()
+    {
+        if (!m_d1) {
+            m_d1 = std::make_unique<SparseMatrix<T>>(m_rx, Op::FE);
+            assemble_d1(*m_d1);
+        }
+        return *m_d1;
+    }
+
+   private:
+    RXMeshStatic&                       m_rx;
+    const VertexAttribute<T>            m_coords;
+    std::string                         m_star0_name;
+    std::string                         m_star1_name;
+    std::string                         m_star2_name;
+    std::shared_ptr<VertexAttribute<T>> m_star0;
+    std::shared_ptr<EdgeAttribute<T>>   m_star1;
+    std::shared_ptr<FaceAttribute<T>>   m_star2;
+    uint64_t                            m_fingerprint;
+    uint32_t                            m_num_builds;
+    std::unique_ptr<SparseMatrix<T>>    m_d0;
+    std::unique_ptr<SparseMatrix<T>>    m_d1;
+};
+
+/**
+ * @brief return the DECOperator of the coordinates attached to rx (see
+ * RXMeshStatic::set_user_cache()). The operator is built on the first call and
+ * shared by all later calls with the same coordinates attribute. If the
+ * coordinates have changed since it was built, the Hodge stars are rebuilt
+ * before it is returned
+ */
+template <typename T>
+std::shared_ptr<DECOperator<T>> get_dec_operator(
+    RXMeshStatic&             rx,
+    const VertexAttribute<T>& coords)
+{
+    const std::string name = "DECOperator_" + std::string(coords.get_name()) +
+                             "_" + std::to_string(sizeof(T));
+
+    auto op = rx.get_user_cache<DECOperator<T>>(name);
+    if (op) {
+        op->update();
+        return op;
+    }
+
+    op = std::make_shared<DECOperator<T>>(rx, coords);
+    rx.set_user_cache(name, op);
+    return op;
+}
+
+}  // namespace rxmesh
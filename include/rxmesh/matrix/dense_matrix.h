@@ -50,7 +50,9 @@ struct DenseMatrix
           m_d_val(nullptr),
           m_h_val(nullptr),
           m_cublas_handle(nullptr),
-          m_user_managed(false)
+          m_user_managed(false),
+          m_pool(nullptr),
+          m_pooled(false)
     {
     }
 
@@ -59,20 +61,24 @@ struct DenseMatrix
      * @brief Allocating a dense matrix with a size tied to the number of
      * elements in the mesh, i.e., num_rows should be either the number
      * of vertices, edges, or faces. With constructor, the user can access
-     * the matrix using mesh handles
+     * the matrix using mesh handles. The device memory is allocated from the
+     * mesh memory pool (see RXMesh::get_memory_pool())
      */
     DenseMatrix(const RXMesh& rx,
                 IndexT        num_rows,
                 IndexT        num_cols,
                 locationT     location = LOCATION_ALL)
         : m_context(rx.get_context()),
+          m_allocated(LOCATION_NONE),
           m_num_rows(num_rows),
           m_num_cols(num_cols),
           m_dendescr(NULL),
           m_h_val(nullptr),
           m_d_val(nullptr),
           m_cublas_handle(nullptr),
-          m_user_managed(false)
+          m_user_managed(false),
+          m_pool(&rx.get_memory_pool()),
+          m_pooled(false)
     {
         allocate(location);
         init_cublas();
@@ -87,13 +93,16 @@ struct DenseMatrix
     DenseMatrix(IndexT    num_rows,
                 IndexT    num_cols,
                 locationT location = LOCATION_ALL)
-        : m_num_rows(num_rows),
+        : m_allocated(LOCATION_NONE),
+          m_num_rows(num_rows),
           m_num_cols(num_cols),
           m_dendescr(NULL),
           m_h_val(nullptr),
           m_d_val(nullptr),
           m_cublas_handle(nullptr),
-          m_user_managed(false)
+          m_user_managed(false),
+          m_pool(nullptr),
+          m_pooled(false)
     {
         allocate(location);
         init_cublas();
@@ -128,6 +137,22 @@ struct DenseMatrix
         init_cudss();
     }
 
+    /**
+     * @brief same as the user managed constructor above but tied to the mesh
+     * (i.e., num_rows is the number of vertices, edges, or faces) such that
+     * the matrix could be accessed using mesh handles. This is used to view
+     * the memory of an attribute view (see Attribute::as_matrix())
+     */
+    DenseMatrix(const RXMesh& rx,
+                IndexT        num_rows,
+                IndexT        num_cols,
+                T*            d_ptr,
+                T*            h_ptr)
+        : DenseMatrix(num_rows, num_cols, d_ptr, h_ptr)
+    {
+        m_context = rx.get_context();
+    }
+
     /**
      * @brief return the leading dimension (row by default)
      */
@@ -302,25 +327,25 @@ struct DenseMatrix
 
     /**
      * @brief access the matrix using vertex/edge/face handle as a row index.
-     * This can only be used in non user-managed mode
+     * This can only be used if the matrix is tied to the mesh
      */
     template <typename HandleT>
     __host__ __device__ T& operator()(const HandleT handle,
                                       const IndexT  col = 0)
     {
-        assert(!m_user_managed);
+        assert(m_context.m_num_patches != nullptr);
         return this->operator()(get_row_id(handle), col);
     }
 
     /**
      * @brief access the matrix using vertex/edge/face handle as a row index.
-     * This can only be used in non user-managed mode
+     * This can only be used if the matrix is tied to the mesh
      */
     template <typename HandleT>
     __host__ __device__ const T& operator()(const HandleT handle,
                                             const IndexT  col = 0) const
     {
-        assert(!m_user_managed);
+        assert(m_context.m_num_patches != nullptr);
         return this->operator()(get_row_id(handle), col);
     }
 
@@ -792,12 +817,12 @@ struct DenseMatrix
 
     /**
      * @brief return the row index corresponding to specific vertex/edge/face
-     * handle. This can only be used non user-managed mode
+     * handle. This can only be used if the matrix is tied to the mesh
      */
     template <typename HandleT>
     __host__ __device__ IndexT get_row_id(const HandleT handle) const
     {
-        assert(!m_user_managed);
+        assert(m_context.m_num_patches != nullptr);
 
         auto id = handle.unpack();
 
@@ -1074,7 +1099,8 @@ struct DenseMatrix
 
             if (((location & DEVICE) == DEVICE) &&
                 ((m_allocated & DEVICE) == DEVICE)) {
-                GPU_FREE(m_d_val);
+                MemoryPool::free(m_d_val, m_pooled);
+                m_d_val     = nullptr;
                 m_allocated = m_allocated & (~DEVICE);
             }
 
@@ -1110,7 +1136,16 @@ struct DenseMatrix
         if ((location & DEVICE) == DEVICE) {
             // release(DEVICE);
 
-            CUDA_ERROR(cudaMalloc((void**)&m_d_val, bytes()));
+            if (m_pool != nullptr) {
+                CUDA_ERROR(m_pool->allocate(
+                    (void**)&m_d_val, bytes(), NULL, MemoryCategory::Matrix));
+                m_pooled = m_pool->is_enabled();
+            } else {
+                CUDA_ERROR(tracked_malloc((void**)&m_d_val,
+                                          bytes(),
+                                          MemoryCategory::Matrix));
+                m_pooled = false;
+            }
 
             m_allocated = m_allocated | DEVICE;
         }
@@ -1186,6 +1221,11 @@ struct DenseMatrix
     T*                   m_h_val;
     bool                 m_user_managed;
 
+    // the mesh memory pool (if constructed from a mesh) and whether m_d_val
+    // was allocated from it
+    MemoryPool* m_pool;
+    bool        m_pooled;
+
 #ifdef USE_CUDSS
     cudssMatrix_t m_cudss_matrix;
 #endif
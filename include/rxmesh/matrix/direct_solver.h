@@ -1,6 +1,7 @@
 #pragma once
 #include "rxmesh/matrix/solver_base.h"
 
+#include "rxmesh/matrix/permute_cache.h"
 #include "rxmesh/matrix/permute_method.h"
 #include "rxmesh/matrix/permute_util.h"
 
@@ -27,6 +28,7 @@ struct DirectSolver : public SolverBase<SpMatT, DenseMatOrder>
     DirectSolver()
         : SolverBase<SpMatT, DenseMatOrder>(),
           m_perm(PermuteMethod::NONE),
+          m_auto_perm(PermuteMethod::NONE),
           m_h_permute(nullptr),
           m_d_permute(nullptr),
           m_h_permute_map(nullptr),
@@ -37,15 +39,22 @@ struct DirectSolver : public SolverBase<SpMatT, DenseMatOrder>
           m_h_solver_row_ptr(nullptr),
           m_h_solver_col_idx(nullptr),
           m_d_solver_b(nullptr),
-          m_d_solver_x(nullptr)
+          m_d_solver_x(nullptr),
+          m_d_multi_b(nullptr),
+          m_d_multi_x(nullptr),
+          m_multi_capacity(0)
     {
     }
 
     DirectSolver(SpMatT* mat, PermuteMethod perm)
         : SolverBase<SpMatT, DenseMatOrder>(mat),
           m_perm(perm),
+          m_auto_perm(PermuteMethod::NONE),
           m_perm_allocated(false),
-          m_use_permute(false)
+          m_use_permute(false),
+          m_d_multi_b(nullptr),
+          m_d_multi_x(nullptr),
+          m_multi_capacity(0)
     {
         // cuSparse matrix descriptor
         CUSPARSE_ERROR(cusparseCreateMatDescr(&m_descr));
@@ -62,6 +71,8 @@ struct DirectSolver : public SolverBase<SpMatT, DenseMatOrder>
 
     virtual ~DirectSolver()
     {
+        GPU_FREE(m_d_multi_b);
+        GPU_FREE(m_d_multi_x);
 
         if (m_perm_allocated) {
             GPU_FREE(m_d_solver_val);
@@ -107,43 +118,7 @@ struct DirectSolver : public SolverBase<SpMatT, DenseMatOrder>
 
         m_use_permute = true;
 
-
-        if (m_perm == PermuteMethod::SYMRCM) {
-            CUSOLVER_ERROR(cusolverSpXcsrsymrcmHost(m_cusolver_sphandle,
-                                                    this->m_mat->rows(),
-                                                    this->m_mat->non_zeros(),
-                                                    m_descr,
-                                                    m_h_solver_row_ptr,
-                                                    m_h_solver_col_idx,
-                                                    m_h_permute));
-        } else if (m_perm == PermuteMethod::SYMAMD) {
-            CUSOLVER_ERROR(cusolverSpXcsrsymamdHost(m_cusolver_sphandle,
-                                                    this->m_mat->rows(),
-                                                    this->m_mat->non_zeros(),
-                                                    m_descr,
-                                                    m_h_solver_row_ptr,
-                                                    m_h_solver_col_idx,
-                                                    m_h_permute));
-        } else if (m_perm == PermuteMethod::NSTDIS) {
-            CUSOLVER_ERROR(cusolverSpXcsrmetisndHost(m_cusolver_sphandle,
-                                                     this->m_mat->rows(),
-                                                     this->m_mat->non_zeros(),
-                                                     m_descr,
-                                                     m_h_solver_row_ptr,
-                                                     m_h_solver_col_idx,
-                                                     NULL,
-                                                     m_h_permute));
-        } else if (m_perm == PermuteMethod::GPUMGND) {
-            mgnd_permute(rx, m_h_permute);
-
-        } else if (m_perm == PermuteMethod::GPUND) {
-            nd_permute(rx, m_h_permute);
-        } else {
-            RXMESH_ERROR("DirectSolver::permute() incompatible permute method");
-        }
-
-
-        assert(is_unique_permutation(this->m_mat->rows(), m_h_permute));
+        compute_permutation(rx, m_perm, m_h_permute);
 
         // copy permutation to the device
         CUDA_ERROR(cudaMemcpyAsync(m_d_permute,
@@ -234,6 +209,53 @@ struct DirectSolver : public SolverBase<SpMatT, DenseMatOrder>
         return m_h_permute;
     }
 
+    /**
+     * @brief set the options of the GPU nested dissection permutation (used
+     * only with PermuteMethod::GPUND). Should be called before permute()
+     */
+    void set_nd_options(const NDPermuteOptions& options)
+    {
+        m_nd_options = options;
+    }
+
+    /**
+     * @brief the permutation method in use. With PermuteMethod::AUTO, this is
+     * the method selected by permute() (or AUTO if permute() has not been
+     * called yet)
+     */
+    PermuteMethod get_permute_method() const
+    {
+        if (m_perm == PermuteMethod::AUTO &&
+            m_auto_perm != PermuteMethod::NONE) {
+            return m_auto_perm;
+        }
+        return m_perm;
+    }
+
+    /**
+     * @brief the exact number of non-zeros in the Cholesky factor (including
+     * the diagonal) with the current permutation. It is computed symbolically
+     * on the host (see cholesky_fill_in()) and so it is much cheaper than the
+     * factorization. Should be called after permute()
+     */
+    size_t fill_in_estimate() const
+    {
+        if (m_perm == PermuteMethod::NONE) {
+            return cholesky_fill_in(this->m_mat->rows(),
+                                    this->m_mat->row_ptr(HOST),
+                                    this->m_mat->col_idx(HOST));
+        }
+        if (!m_perm_allocated) {
+            RXMESH_ERROR(
+                "DirectSolver::fill_in_estimate() permute() should be called "
+                "first.");
+            return 0;
+        }
+        // the solver pattern is already permuted (if permutation is used)
+        return cholesky_fill_in(
+            this->m_mat->rows(), m_h_solver_row_ptr, m_h_solver_col_idx);
+    }
+
     /**
      * @brief allocate all temp buffers needed for the solver low-level API
      */
@@ -245,12 +267,16 @@ struct DirectSolver : public SolverBase<SpMatT, DenseMatOrder>
 
         if (!m_perm_allocated) {
             m_perm_allocated = true;
-            CUDA_ERROR(cudaMalloc((void**)&m_d_solver_val,
-                                  this->m_mat->non_zeros() * sizeof(Type)));
-            CUDA_ERROR(cudaMalloc((void**)&m_d_solver_row_ptr,
-                                  (this->m_mat->rows() + 1) * sizeof(IndexT)));
-            CUDA_ERROR(cudaMalloc((void**)&m_d_solver_col_idx,
-                                  this->m_mat->non_zeros() * sizeof(IndexT)));
+            CUDA_ERROR(tracked_malloc((void**)&m_d_solver_val,
+                                      this->m_mat->non_zeros() * sizeof(Type),
+                                      MemoryCategory::Solver));
+            CUDA_ERROR(
+                tracked_malloc((void**)&m_d_solver_row_ptr,
+                               (this->m_mat->rows() + 1) * sizeof(IndexT),
+                               MemoryCategory::Solver));
+            CUDA_ERROR(tracked_malloc((void**)&m_d_solver_col_idx,
+                                      this->m_mat->non_zeros() * sizeof(IndexT),
+                                      MemoryCategory::Solver));
 
             m_h_solver_row_ptr =
                 (IndexT*)malloc((this->m_mat->rows() + 1) * sizeof(IndexT));
@@ -258,19 +284,23 @@ struct DirectSolver : public SolverBase<SpMatT, DenseMatOrder>
                 (IndexT*)malloc(this->m_mat->non_zeros() * sizeof(IndexT));
 
             m_h_permute = (IndexT*)malloc(this->m_mat->rows() * sizeof(IndexT));
-            CUDA_ERROR(cudaMalloc((void**)&m_d_permute,
-                                  this->m_mat->rows() * sizeof(IndexT)));
+            CUDA_ERROR(tracked_malloc((void**)&m_d_permute,
+                                      this->m_mat->rows() * sizeof(IndexT),
+                                      MemoryCategory::Solver));
 
             m_h_permute_map = static_cast<IndexT*>(
                 malloc(this->m_mat->non_zeros() * sizeof(IndexT)));
 
-            CUDA_ERROR(cudaMalloc((void**)&m_d_permute_map,
-                                  this->m_mat->non_zeros() * sizeof(IndexT)));
+            CUDA_ERROR(tracked_malloc((void**)&m_d_permute_map,
+                                      this->m_mat->non_zeros() * sizeof(IndexT),
+                                      MemoryCategory::Solver));
 
-            CUDA_ERROR(cudaMalloc((void**)&m_d_solver_x,
-                                  this->m_mat->cols() * sizeof(Type)));
-            CUDA_ERROR(cudaMalloc((void**)&m_d_solver_b,
-                                  this->m_mat->rows() * sizeof(Type)));
+            CUDA_ERROR(tracked_malloc((void**)&m_d_solver_x,
+                                      this->m_mat->cols() * sizeof(Type),
+                                      MemoryCategory::Solver));
+            CUDA_ERROR(tracked_malloc((void**)&m_d_solver_b,
+                                      this->m_mat->rows() * sizeof(Type),
+                                      MemoryCategory::Solver));
         }
         std::memcpy(m_h_solver_row_ptr,
                     this->m_mat->row_ptr(),
@@ -282,6 +312,129 @@ struct DirectSolver : public SolverBase<SpMatT, DenseMatOrder>
 
 
    protected:
+    /**
+     * @brief compute the permutation of the (unpermuted) solver pattern with
+     * the method perm into h_permute. The permutation only depends on the
+     * sparsity pattern so it is reused if it has been computed before for the
+     * same pattern
+     */
+    void compute_permutation(RXMeshStatic& rx,
+                             PermuteMethod perm,
+                             IndexT*       h_permute)
+    {
+        if (perm == PermuteMethod::AUTO) {
+            auto_permute(rx, h_permute);
+            return;
+        }
+
+        PermuteCache::Key key =
+            PermuteCache::make_key(this->m_mat->rows(),
+                                   this->m_mat->non_zeros(),
+                                   m_h_solver_row_ptr,
+                                   m_h_solver_col_idx,
+                                   perm);
+
+        // different GPUND options give different permutations
+        if (perm == PermuteMethod::GPUND) {
+            key.hash = m_nd_options.hash(key.hash);
+        }
+
+        const bool cached = PermuteCache::find(key, h_permute);
+
+        if (cached) {
+            RXMESH_TRACE("DirectSolver::permute() reusing cached permutation");
+        } else if (perm == PermuteMethod::SYMRCM) {
+            CUSOLVER_ERROR(cusolverSpXcsrsymrcmHost(m_cusolver_sphandle,
+                                                    this->m_mat->rows(),
+                                                    this->m_mat->non_zeros(),
+                                                    m_descr,
+                                                    m_h_solver_row_ptr,
+                                                    m_h_solver_col_idx,
+                                                    h_permute));
+        } else if (perm == PermuteMethod::SYMAMD) {
+            CUSOLVER_ERROR(cusolverSpXcsrsymamdHost(m_cusolver_sphandle,
+                                                    this->m_mat->rows(),
+                                                    this->m_mat->non_zeros(),
+                                                    m_descr,
+                                                    m_h_solver_row_ptr,
+                                                    m_h_solver_col_idx,
+                                                    h_permute));
+        } else if (perm == PermuteMethod::NSTDIS) {
+            CUSOLVER_ERROR(cusolverSpXcsrmetisndHost(m_cusolver_sphandle,
+                                                     this->m_mat->rows(),
+                                                     this->m_mat->non_zeros(),
+                                                     m_descr,
+                                                     m_h_solver_row_ptr,
+                                                     m_h_solver_col_idx,
+                                                     NULL,
+                                                     h_permute));
+        } else if (perm == PermuteMethod::GPUMGND) {
+            mgnd_permute(rx, h_permute);
+
+        } else if (perm == PermuteMethod::GPUND) {
+            nd_permute(rx, h_permute, m_nd_options);
+        } else {
+            RXMESH_ERROR("DirectSolver::permute() incompatible permute method");
+        }
+
+
+        assert(is_unique_permutation(this->m_mat->rows(), h_permute));
+
+        if (!cached) {
+            PermuteCache::insert(key, h_permute);
+        }
+    }
+
+    /**
+     * @brief compute the permutation of every candidate method and keep (in
+     * h_permute) the one whose Cholesky factorization takes the least flops.
+     * The candidates are evaluated symbolically (see cholesky_symbolic()) in
+     * parallel on the host which is much cheaper than computing the
+     * permutations themselves (that are cached per method)
+     */
+    void auto_permute(RXMeshStatic& rx, IndexT* h_permute)
+    {
+        const std::vector<PermuteMethod> candidates = {PermuteMethod::SYMAMD,
+                                                       PermuteMethod::NSTDIS,
+                                                       PermuteMethod::GPUND,
+                                                       PermuteMethod::GPUMGND};
+
+        const IndexT rows = this->m_mat->rows();
+
+        std::vector<std::vector<IndexT>> perms(candidates.size());
+        for (size_t c = 0; c < candidates.size(); ++c) {
+            perms[c].resize(rows);
+            compute_permutation(rx, candidates[c], perms[c].data());
+        }
+
+        std::vector<CholeskySymbolic> stats(candidates.size());
+#pragma omp parallel for
+        for (int c = 0; c < int(candidates.size()); ++c) {
+            stats[c] = cholesky_symbolic(
+                rows, m_h_solver_row_ptr, m_h_solver_col_idx, perms[c].data());
+        }
+
+        size_t best = 0;
+        for (size_t c = 0; c < candidates.size(); ++c) {
+            RXMESH_TRACE(
+                "DirectSolver::auto_permute() {}: nnz(L)= {}, flops= {}",
+                permute_method_to_string(candidates[c]),
+                stats[c].nnz,
+                stats[c].flops);
+            if (stats[c].flops < stats[best].flops) {
+                best = c;
+            }
+        }
+
+        m_auto_perm = candidates[best];
+
+        RXMESH_INFO("DirectSolver::auto_permute() selected {} (nnz(L)= {})",
+                    permute_method_to_string(m_auto_perm),
+                    stats[best].nnz);
+
+        std::memcpy(h_permute, perms[best].data(), rows * sizeof(IndexT));
+    }
+
     int permute_to_int() const
     {
         switch (m_perm) {
@@ -313,6 +466,95 @@ struct DirectSolver : public SolverBase<SpMatT, DenseMatOrder>
         thrust::scatter(thrust::device, t_i, t_i + size, t_p, t_o);
     }
 
+    /**
+     * @brief gather num_rhs right-hand sides stored in d_in as a (rows x
+     * num_rhs) dense matrix with DenseMatOrder layout into d_out where every
+     * right-hand side is stored contiguously, i.e.,
+     * d_out[j * rows + i] = d_in(d_p[i], j) (or d_in(i, j) if d_p is null).
+     * Permuting and changing the layout of all right-hand sides is done in
+     * one pass so row-major inputs do not need to be transposed first
+     */
+    __host__ void permute_gather_multi(const IndexT* d_p,
+                                       const Type*   d_in,
+                                       Type*         d_out,
+                                       IndexT        rows,
+                                       IndexT        num_rhs,
+                                       cudaStream_t  stream = NULL)
+    {
+        const uint32_t size         = uint32_t(rows) * uint32_t(num_rhs);
+        const int      blockThreads = 256;
+        for_each_item<<<DIVIDE_UP(size, blockThreads),
+                        blockThreads,
+                        0,
+                        stream>>>(size, [=] __device__(uint32_t id) {
+            const IndexT j = id / rows;
+            const IndexT i = id % rows;
+            const IndexT r = (d_p == nullptr) ? i : d_p[i];
+            d_out[id]      = d_in[dense_id(r, j, rows, num_rhs)];
+        });
+    }
+
+    /**
+     * @brief the inverse of permute_gather_multi(), i.e.,
+     * d_out(d_p[i], j) = d_in[j * rows + i] (or d_out(i, j) if d_p is null)
+     * where d_out is a (rows x num_rhs) dense matrix with DenseMatOrder layout
+     */
+    __host__ void permute_scatter_multi(const IndexT* d_p,
+                                        const Type*   d_in,
+                                        Type*         d_out,
+                                        IndexT        rows,
+                                        IndexT        num_rhs,
+                                        cudaStream_t  stream = NULL)
+    {
+        const uint32_t size         = uint32_t(rows) * uint32_t(num_rhs);
+        const int      blockThreads = 256;
+        for_each_item<<<DIVIDE_UP(size, blockThreads),
+                        blockThreads,
+                        0,
+                        stream>>>(size, [=] __device__(uint32_t id) {
+            const IndexT j = id / rows;
+            const IndexT i = id % rows;
+            const IndexT r = (d_p == nullptr) ? i : d_p[i];
+            d_out[dense_id(r, j, rows, num_rhs)] = d_in[id];
+        });
+    }
+
+    /**
+     * @brief the index of entry (i, j) in a (rows x cols) dense matrix with
+     * DenseMatOrder layout
+     */
+    __host__ __device__ static IndexT dense_id(IndexT i,
+                                               IndexT j,
+                                               IndexT rows,
+                                               IndexT cols)
+    {
+        if constexpr (DenseMatOrder == Eigen::ColMajor) {
+            return j * rows + i;
+        } else {
+            return i * cols + j;
+        }
+    }
+
+    /**
+     * @brief make sure the multi right-hand side workspace can hold num_rhs
+     * right-hand sides
+     */
+    void multi_rhs_alloc(IndexT num_rhs)
+    {
+        const size_t size = size_t(this->m_mat->rows()) * num_rhs;
+        if (size > m_multi_capacity) {
+            GPU_FREE(m_d_multi_b);
+            GPU_FREE(m_d_multi_x);
+            CUDA_ERROR(tracked_malloc((void**)&m_d_multi_b,
+                                      size * sizeof(Type),
+                                      MemoryCategory::Solver));
+            CUDA_ERROR(tracked_malloc((void**)&m_d_multi_x,
+                                      size * sizeof(Type),
+                                      MemoryCategory::Solver));
+            m_multi_capacity = size;
+        }
+    }
+
     __host__ void permute_gather(IndexT* d_p,
                                  Type*   d_in,
                                  Type*   d_out,
@@ -329,6 +571,11 @@ struct DirectSolver : public SolverBase<SpMatT, DenseMatOrder>
 
     PermuteMethod m_perm;
 
+    // the method selected with PermuteMethod::AUTO
+    PermuteMethod m_auto_perm;
+
+    NDPermuteOptions m_nd_options;
+
     bool m_perm_allocated;
     bool m_use_permute;
 
@@ -352,6 +599,12 @@ struct DirectSolver : public SolverBase<SpMatT, DenseMatOrder>
     // permuted lhs and rhs
     Type* m_d_solver_b;
     Type* m_d_solver_x;
+
+    // permuted multiple right-hand sides (and their solution) stored
+    // contiguously one after the other
+    Type*  m_d_multi_b;
+    Type*  m_d_multi_x;
+    size_t m_multi_capacity;
 };
 
 }  // namespace rxmesh
\ No newline at end of file
@@ -0,0 +1,450 @@
+#pragma once
+
+#include <algorithm>
+#include <complex>
+#include <functional>
+#include <vector>
+
+#include <Eigen/Dense>
+
+#include "rxmesh/matrix/cholesky_solver.h"
+#include "rxmesh/matrix/dense_matrix.h"
+#include "rxmesh/matrix/sparse_matrix.h"
+#include "rxmesh/rxmesh_static.h"
+#include "rxmesh/util/meta.h"
+
+namespace rxmesh {
+
+namespace detail {
+/**
+ * @brief C = op_a(A) * B where A is (k x m) if op_a transposes it, otherwise
+ * (m x k), B is (k x n) and all are column major on the device
+ */
+template <typename T>
+void eigen_solver_gemm(cublasHandle_t    handle,
+                       cublasOperation_t op_a,
+                       int               m,
+                       int               n,
+                       int               k,
+                       const T*          A,
+                       int               lda,
+                       const T*          B,
+                       int               ldb,
+                       T*                C,
+                       int               ldc)
+{
+    if constexpr (std::is_same_v<T, float>) {
+        const float alpha(1), beta(0);
+        CUBLAS_ERROR(cublasSgemm(handle,
+                                 op_a,
+                                 CUBLAS_OP_N,
+                                 m,
+                                 n,
+                                 k,
+                                 &alpha,
+                                 A,
+                                 lda,
+                                 B,
+                                 ldb,
+                                 &beta,
+                                 C,
+                                 ldc));
+    }
+    if constexpr (std::is_same_v<T, double>) {
+        const double alpha(1), beta(0);
+        CUBLAS_ERROR(cublasDgemm(handle,
+                                 op_a,
+                                 CUBLAS_OP_N,
+                                 m,
+                                 n,
+                                 k,
+                                 &alpha,
+                                 A,
+                                 lda,
+                                 B,
+                                 ldb,
+                                 &beta,
+                                 C,
+                                 ldc));
+    }
+    if constexpr (std::is_same_v<T, cuComplex>) {
+        const cuComplex alpha = make_cuComplex(1.f, 0.f);
+        const cuComplex beta  = make_cuComplex(0.f, 0.f);
+        CUBLAS_ERROR(cublasCgemm(handle,
+                                 op_a,
+                                 CUBLAS_OP_N,
+                                 m,
+                                 n,
+                                 k,
+                                 &alpha,
+                                 A,
+                                 lda,
+                                 B,
+                                 ldb,
+                                 &beta,
+                                 C,
+                                 ldc));
+    }
+    if constexpr (std::is_same_v<T, cuDoubleComplex>) {
+        const cuDoubleComplex alpha = make_cuDoubleComplex(1.0, 0.0);
+        const cuDoubleComplex beta  = make_cuDoubleComplex(0.0, 0.0);
+        CUBLAS_ERROR(cublasZgemm(handle,
+                                 op_a,
+                                 CUBLAS_OP_N,
+                                 m,
+                                 n,
+                                 k,
+                                 &alpha,
+                                 A,
+                                 lda,
+                                 B,
+                                 ldb,
+                                 &beta,
+                                 C,
+                                 ldc));
+    }
+}
+}  // namespace detail
+
+/**
+ * @brief computes several eigenpairs at once of the (Hermitian) generalized
+ * eigenproblem A x = lambda B x closest to a shift sigma using block
+ * shift-invert subspace iteration with Rayleigh-Ritz projection. (A - sigma B)
+ * is factorized once by the caller (e.g., with CholeskySolver) and every
+ * iteration does one multi-RHS solve with all the block vectors and one
+ * application of B. The Ritz problem is solved with the pencil
+ * (Y^H B Y, Y^H (A - sigma B) Y) which only needs (A - sigma B) to be
+ * positive definite, i.e., B may be singular. The projected (small) problem
+ * is solved on the host. The eigenvalues are returned in ascending order of
+ * their distance to sigma (i.e., ascending order if sigma is smaller than the
+ * smallest eigenvalue). The solve and the application of B are set by the
+ * user through m_solve and m_mat_vec (or use_cholesky()) such that B could
+ * also be an implicit operator (e.g., a rank-one modified matrix)
+ * @tparam T float, double, cuComplex, or cuDoubleComplex
+ */
+template <typename T>
+struct ShiftInvertEigenSolver
+{
+    using DenseMatT = DenseMatrix<T, Eigen::ColMajor>;
+    using BaseT     = BaseTypeT<T>;
+    using HostT     = std::conditional_t<std::is_same_v<T, cuComplex> ||
+                                             std::is_same_v<T, cuDoubleComplex>,
+                                         std::complex<BaseT>,
+                                         T>;
+
+    // X = (A - sigma B)^{-1} B
+    using SolveT = std::function<void(DenseMatT& B, DenseMatT& X)>;
+
+    // out = B * in. If not set, B is the identity
+    using MatVecT = std::function<void(const DenseMatT& in, DenseMatT& out)>;
+
+    SolveT  m_solve;
+    MatVecT m_mat_vec;
+
+    /**
+     * @param rx the input mesh where the eigenvectors are per-vertex
+     * @param num_eigs the number of eigenpairs to compute
+     * @param sigma the shift i.e., the matrix factorized by m_solve is
+     * (A - sigma * B)
+     * @param max_iter the maximum number of iterations
+     * @param tol the (relative) tolerance on the change of the eigenvalues
+     * @param num_guard the number of extra block vectors (that are not
+     * reported) that speed up the convergence of the wanted ones. If negative,
+     * min(num_eigs, 8) is used
+     */
+    ShiftInvertEigenSolver(RXMeshStatic& rx,
+                           int           num_eigs,
+                           BaseT         sigma     = 0,
+                           int           max_iter  = 100,
+                           BaseT         tol       = 1e-6,
+                           int           num_guard = -1)
+        : m_rx(rx),
+          m_num_eigs(num_eigs),
+          m_sigma(sigma),
+          m_max_iter(max_iter),
+          m_tol(tol),
+          m_iter_taken(0),
+          m_converged(false)
+    {
+        const int n = rx.get_num_vertices();
+
+        m_block = num_eigs + ((num_guard < 0) ? std::min(num_eigs, 8) :
+                                                num_guard);
+        m_block = std::max(1, std::min(m_block, n));
+
+        if (m_num_eigs > m_block) {
+            RXMESH_ERROR(
+                "ShiftInvertEigenSolver() the number of eigenpairs ({}) is "
+                "larger than the number of rows ({})",
+                m_num_eigs,
+                n);
+            m_num_eigs = m_block;
+        }
+
+        m_X  = DenseMatT(rx, n, m_block);
+        m_Y  = DenseMatT(rx, n, m_block, DEVICE);
+        m_Z  = DenseMatT(rx, n, m_block, DEVICE);
+        m_W  = DenseMatT(rx, n, m_block, DEVICE);
+        m_GA = DenseMatT(m_block, m_block);
+        m_GB = DenseMatT(m_block, m_block);
+        m_V  = DenseMatT(m_block, m_block);
+
+        CUBLAS_ERROR(cublasCreate(&m_cublas_handle));
+    }
+
+    ShiftInvertEigenSolver(const ShiftInvertEigenSolver&)            = delete;
+    ShiftInvertEigenSolver& operator=(const ShiftInvertEigenSolver&) = delete;
+
+    virtual ~ShiftInvertEigenSolver()
+    {
+        m_X.release();
+        m_Y.release();
+        m_Z.release();
+        m_W.release();
+        m_GA.release();
+        m_GB.release();
+        m_V.release();
+        CUBLAS_ERROR(cublasDestroy(m_cublas_handle));
+    }
+
+    /**
+     * @brief use a (pre-solved) Cholesky solver of (A - sigma B) and, if B is
+     * not nullptr, B as a sparse matrix. Both should outlive this solver
+     */
+    template <typename SpMatT>
+    void use_cholesky(CholeskySolver<SpMatT>& chol, SpMatT* B = nullptr)
+    {
+        m_solve = [&chol](DenseMatT& rhs, DenseMatT& x) { chol.solve(rhs, x); };
+        if (B) {
+            m_mat_vec = [B](const DenseMatT& in, DenseMatT& out) {
+                B->multiply(in, out);
+            };
+        } else {
+            m_mat_vec = nullptr;
+        }
+    }
+
+    /**
+     * @brief compute the eigenpairs
+     * @param eig_vecs the output eigenvectors (#vertices x num_eigs) on the
+     * device (normalized such that x^H (A - sigma B) x = 1). If
+     * use_initial_guess is true, its columns are also used as (part of) the
+     * starting block
+     * @param eig_vals the output eigenvalues
+     * @param use_initial_guess use the input eig_vecs as a starting point
+     * @return true if the eigenvalues converged
+     */
+    bool solve(DenseMatT&          eig_vecs,
+               std::vector<BaseT>& eig_vals,
+               bool                use_initial_guess = false)
+    {
+        if (!m_solve) {
+            RXMESH_ERROR(
+                "ShiftInvertEigenSolver::solve() m_solve should be set "
+                "before calling solve(). Returning without solving anything");
+            return false;
+        }
+
+        const int n = m_X.rows();
+        const int p = m_block;
+
+        if (eig_vecs.rows() != n || eig_vecs.cols() != m_num_eigs) {
+            RXMESH_ERROR(
+                "ShiftInvertEigenSolver::solve() the size of the eigenvectors "
+                "matrix ({}, {}) should be ({}, {})",
+                eig_vecs.rows(),
+                eig_vecs.cols(),
+                n,
+                m_num_eigs);
+            return false;
+        }
+
+        // starting block
+        m_X.fill_random();
+        m_X.move(HOST, DEVICE);
+        if (use_initial_guess) {
+            CUDA_ERROR(cudaMemcpy(m_X.data(DEVICE),
+                                  eig_vecs.data(DEVICE),
+                                  size_t(n) * m_num_eigs * sizeof(T),
+                                  cudaMemcpyDeviceToDevice));
+        }
+        apply_B(m_X, m_Z);
+
+        std::vector<BaseT> mu(p, 0), prv_mu(p, 0);
+
+        m_iter_taken = 0;
+        m_converged  = false;
+
+        while (m_iter_taken < m_max_iter) {
+            m_iter_taken++;
+
+            // Y = (A - sigma B)^{-1} B X where Z = B X
+            m_solve(m_Z, m_Y);
+
+            // W = B Y
+            apply_B(m_Y, m_W);
+
+            // GA = Y^H Z = Y^H (A - sigma B) Y and GB = Y^H W = Y^H B Y
+            gram(m_Y, m_Z, m_GA);
+            gram(m_Y, m_W, m_GB);
+
+            if (!ritz(mu)) {
+                break;
+            }
+
+            // X = Y V and B X = W V
+            ritz_vectors(m_Y, m_X);
+            ritz_vectors(m_W, m_Z);
+
+            BaseT change = 0;
+            for (int i = 0; i < m_num_eigs; ++i) {
+                change = std::max(change,
+                                  std::abs(mu[i] - prv_mu[i]) /
+                                      std::max(std::abs(mu[i]), BaseT(1e-30)));
+            }
+            prv_mu = mu;
+
+            if (m_iter_taken > 1 && change < m_tol) {
+                m_converged = true;
+                break;
+            }
+        }
+
+        // mu = 1 / (lambda - sigma)
+        eig_vals.resize(m_num_eigs);
+        for (int i = 0; i < m_num_eigs; ++i) {
+            eig_vals[i] = m_sigma + BaseT(1) / mu[i];
+        }
+
+        CUDA_ERROR(cudaMemcpy(eig_vecs.data(DEVICE),
+                              m_X.data(DEVICE),
+                              size_t(n) * m_num_eigs * sizeof(T),
+                              cudaMemcpyDeviceToDevice));
+
+        if (!m_converged) {
+            RXMESH_WARN(
+                "ShiftInvertEigenSolver::solve() did not converge after {} "
+                "iterations",
+                m_iter_taken);
+        }
+
+        return m_converged;
+    }
+
+    int iter_taken() const
+    {
+        return m_iter_taken;
+    }
+
+    bool is_converged() const
+    {
+        return m_converged;
+    }
+
+    std::string name()
+    {
+        return std::string("Shift-Invert Subspace Iteration");
+    }
+
+   private:
+    void apply_B(const DenseMatT& in, DenseMatT& out)
+    {
+        if (m_mat_vec) {
+            m_mat_vec(in, out);
+        } else {
+            CUDA_ERROR(cudaMemcpy(out.data(DEVICE),
+                                  in.data(DEVICE),
+                                  in.bytes(),
+                                  cudaMemcpyDeviceToDevice));
+        }
+    }
+
+    /**
+     * @brief G = A^H * B
+     */
+    void gram(const DenseMatT& A, const DenseMatT& B, DenseMatT& G)
+    {
+        detail::eigen_solver_gemm(m_cublas_handle,
+                                  CUBLAS_OP_C,
+                                  A.cols(),
+                                  B.cols(),
+                                  A.rows(),
+                                  A.data(DEVICE),
+                                  A.lead_dim(),
+                                  B.data(DEVICE),
+                                  B.lead_dim(),
+                                  G.data(DEVICE),
+                                  G.lead_dim());
+        G.move(DEVICE, HOST);
+    }
+
+    /**
+     * @brief out = in * V
+     */
+    void ritz_vectors(const DenseMatT& in, DenseMatT& out)
+    {
+        detail::eigen_solver_gemm(m_cublas_handle,
+                                  CUBLAS_OP_N,
+                                  in.rows(),
+                                  m_V.cols(),
+                                  in.cols(),
+                                  in.data(DEVICE),
+                                  in.lead_dim(),
+                                  m_V.data(DEVICE),
+                                  m_V.lead_dim(),
+                                  out.data(DEVICE),
+                                  out.lead_dim());
+    }
+
+    /**
+     * @brief solve the projected problem GB v = mu GA v on the host and store
+     * the eigenvectors of the largest mu (i.e., the closest lambda to sigma)
+     * first in V
+     */
+    bool ritz(std::vector<BaseT>& mu)
+    {
+        using MatT = Eigen::Matrix<HostT, Eigen::Dynamic, Eigen::Dynamic>;
+
+        const int p = m_block;
+
+        Eigen::Map<MatT> ga(reinterpret_cast<HostT*>(m_GA.data(HOST)), p, p);
+        Eigen::Map<MatT> gb(reinterpret_cast<HostT*>(m_GB.data(HOST)), p, p);
+
+        // remove the round-off asymmetry
+        const MatT sa = (ga + ga.adjoint()) * BaseT(0.5);
+        const MatT sb = (gb + gb.adjoint()) * BaseT(0.5);
+
+        Eigen::GeneralizedSelfAdjointEigenSolver<MatT> es(sb, sa);
+
+        if (es.info() != Eigen::Success) {
+            RXMESH_ERROR(
+                "ShiftInvertEigenSolver::solve() the projected eigenproblem "
+                "failed (the block vectors may be linearly dependent)");
+            return false;
+        }
+
+        // Eigen sorts the eigenvalues in ascending order
+        Eigen::Map<MatT> v(reinterpret_cast<HostT*>(m_V.data(HOST)), p, p);
+        for (int i = 0; i < p; ++i) {
+            mu[i]    = es.eigenvalues()(p - 1 - i);
+            v.col(i) = es.eigenvectors().col(p - 1 - i);
+        }
+        m_V.move(HOST, DEVICE);
+
+        return true;
+    }
+
+    RXMeshStatic&  m_rx;
+    int            m_num_eigs;
+    int            m_block;
+    BaseT          m_sigma;
+    int            m_max_iter;
+    BaseT          m_tol;
+    int            m_iter_taken;
+    bool           m_converged;
+    DenseMatT      m_X, m_Y, m_Z, m_W;
+    DenseMatT      m_GA, m_GB, m_V;
+    cublasHandle_t m_cublas_handle;
+};
+
+}  // namespace rxmesh
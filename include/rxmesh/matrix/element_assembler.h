@@ -0,0 +1,218 @@
+#pragma once
+
+#include <thrust/binary_search.h>
+#include <thrust/execution_policy.h>
+#include <thrust/iterator/counting_iterator.h>
+#include <thrust/sequence.h>
+#include <thrust/sort.h>
+
+#include "rxmesh/kernels/util.cuh"
+#include "rxmesh/matrix/dense_matrix.h"
+#include "rxmesh/matrix/sparse_matrix.h"
+#include "rxmesh/rxmesh_static.h"
+
+namespace rxmesh {
+
+/**
+ * @brief assemble the values of a (vertex-vertex) sparse matrix from element
+ * terms, i.e., every face (Op::FV) or edge (Op::EV) contributes a dense
+ * NumV x NumV block where NumV is the number of vertices of the element. The
+ * user writes the element blocks of all elements into a dense matrix (one row
+ * per element and NumV*NumV columns where entry (i, j) of the block of element
+ * h is at (h, i * NumV + j) and i, j index the element vertices in the order
+ * returned by the op query). Since every element writes its own entries, this
+ * needs no atomics. assemble() then sums the contributions of every non-zero
+ * entry of the sparse matrix with a gather over a precomputed map (no atomics
+ * and no column search). The map only depends on the mesh connectivity and so
+ * it is built once in the constructor and reused for every assembly, e.g.,
+ * across time steps or Newton iterations
+ */
+template <typename T, Op op>
+struct ElementAssembler
+{
+    static_assert(op == Op::FV || op == Op::EV,
+                  "ElementAssembler only supports Op::FV and Op::EV");
+
+    using ElementHandleT =
+        std::conditional_t<op == Op::FV, FaceHandle, EdgeHandle>;
+
+    // number of vertices per element
+    static constexpr int NumV = (op == Op::FV) ? 3 : 2;
+
+    // number of entries in the element block
+    static constexpr int BlockSize = NumV * NumV;
+
+    ElementAssembler()
+        : m_num_elements(0),
+          m_nnz(0),
+          m_d_nnz_ptr(nullptr),
+          m_d_slot(nullptr)
+    {
+    }
+
+    /**
+     * @brief build the map from the element blocks to the non-zero entries of
+     * A. A should be a vertex-vertex matrix (e.g., SparseMatrix(rx, Op::VV))
+     * with one row per vertex such that every pair of vertices in an element
+     * is a non-zero entry
+     */
+    ElementAssembler(const RXMeshStatic& rx, const SparseMatrix<T>& A)
+        : ElementAssembler()
+    {
+        if (A.rows() != rx.get_num_vertices()) {
+            RXMESH_ERROR(
+                "ElementAssembler::ElementAssembler() the matrix should have "
+                "one row per vertex. The matrix has {} rows while the mesh "
+                "has {} vertices",
+                A.rows(),
+                rx.get_num_vertices());
+            return;
+        }
+
+        m_num_elements = (op == Op::FV) ? rx.get_num_faces() :
+                                          rx.get_num_edges();
+        m_nnz = A.non_zeros();
+
+        build_map(rx, A);
+    }
+
+    /**
+     * @brief allocate a dense matrix to hold the element blocks
+     */
+    DenseMatrix<T> create_element_values(const RXMeshStatic& rx) const
+    {
+        return DenseMatrix<T>(rx, m_num_elements, BlockSize, DEVICE);
+    }
+
+    /**
+     * @brief A = alpha * sum of element blocks + beta * A for all non-zero
+     * entries of A (on the device). element_values should be of size
+     * (#elements x BlockSize) as created by create_element_values(). Non-zero
+     * entries of A that are not touched by any element are scaled by beta
+     */
+    void assemble(const DenseMatrix<T>& element_values,
+                  SparseMatrix<T>&      A,
+                  T                     alpha  = T(1),
+                  T                     beta   = T(0),
+                  cudaStream_t          stream = NULL) const
+    {
+        if (element_values.rows() != m_num_elements ||
+            element_values.cols() != BlockSize) {
+            RXMESH_ERROR(
+                "ElementAssembler::assemble() the element values size ({}, "
+                "{}) does not match the number of elements ({}) and the "
+                "block size ({})",
+                element_values.rows(),
+                element_values.cols(),
+                m_num_elements,
+                BlockSize);
+            return;
+        }
+
+        if (A.non_zeros() != m_nnz) {
+            RXMESH_ERROR(
+                "ElementAssembler::assemble() the matrix has {} non-zeros "
+                "while the map was built for {} non-zeros",
+                A.non_zeros(),
+                m_nnz);
+            return;
+        }
+
+        const int* d_nnz_ptr = m_d_nnz_ptr;
+        const int* d_slot    = m_d_slot;
+        const T*   d_elem    = element_values.data(DEVICE);
+        T*         d_val     = A.val_ptr(DEVICE);
+
+        constexpr uint32_t blockThreads = 256;
+
+        for_each_item<<<DIVIDE_UP(m_nnz, blockThreads),
+                        blockThreads,
+                        0,
+                        stream>>>(m_nnz, [=] __device__(int k) {
+            T sum(0);
+            for (int s = d_nnz_ptr[k]; s < d_nnz_ptr[k + 1]; ++s) {
+                sum += d_elem[d_slot[s]];
+            }
+            // avoid reading uninitialized values when beta is zero
+            d_val[k] = (beta == T(0)) ? alpha * sum :
+                                        alpha * sum + beta * d_val[k];
+        });
+    }
+
+    /**
+     * @brief the number of elements (faces or edges)
+     */
+    int num_elements() const
+    {
+        return m_num_elements;
+    }
+
+    void release()
+    {
+        GPU_FREE(m_d_nnz_ptr);
+        GPU_FREE(m_d_slot);
+    }
+
+    /**
+     * @brief build the map. For every entry (slot) of the element blocks, find
+     * its non-zero index in A (with a column search that is done only once
+     * here). Then sort the slots by the non-zero index such that the slots
+     * that contribute to the k-th non-zero are d_slot[d_nnz_ptr[k],
+     * d_nnz_ptr[k+1])
+     */
+    void build_map(const RXMeshStatic& rx, const SparseMatrix<T>& A)
+    {
+        const int num_slots = m_num_elements * BlockSize;
+
+        // the non-zero index of every slot with the same layout as the element
+        // values
+        DenseMatrix<int> slot_nnz(rx, m_num_elements, BlockSize, DEVICE);
+
+        SparseMatrix<T> a = A;
+
+        rx.run_query_kernel<op, 256>(
+            [=] __device__(const ElementHandleT& eh,
+                           const VertexIterator& iter) mutable {
+                for (int i = 0; i < NumV; ++i) {
+                    const int r = a.get_row_id(iter[i]);
+                    for (int j = 0; j < NumV; ++j) {
+                        const int c = a.get_row_id(iter[j]);
+                        slot_nnz(eh, i * NumV + j) = a.get_val_idx(r, c);
+                    }
+                }
+            });
+
+        CUDA_ERROR(tracked_malloc((void**)&m_d_slot,
+                                  num_slots * sizeof(int),
+                                  MemoryCategory::Matrix));
+        CUDA_ERROR(tracked_malloc((void**)&m_d_nnz_ptr,
+                                  (m_nnz + 1) * sizeof(int),
+                                  MemoryCategory::Matrix));
+
+        int* d_keys = slot_nnz.data(DEVICE);
+
+        thrust::sequence(thrust::device, m_d_slot, m_d_slot + num_slots);
+
+        thrust::sort_by_key(
+            thrust::device, d_keys, d_keys + num_slots, m_d_slot);
+
+        // missing entries (should not happen for VV matrices) are sorted
+        // first with key -1 and so they are skipped by the lower bound
+        thrust::lower_bound(thrust::device,
+                            d_keys,
+                            d_keys + num_slots,
+                            thrust::counting_iterator<int>(0),
+                            thrust::counting_iterator<int>(m_nnz + 1),
+                            m_d_nnz_ptr);
+
+        slot_nnz.release();
+    }
+
+   protected:
+    int  m_num_elements;
+    int  m_nnz;
+    int* m_d_nnz_ptr;
+    int* m_d_slot;
+};
+
+}  // namespace rxmesh
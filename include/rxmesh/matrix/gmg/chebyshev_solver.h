@@ -0,0 +1,195 @@
+#pragma once
+
+#include "rxmesh/rxmesh_static.h"
+
+#include "rxmesh/matrix/dense_matrix.h"
+#include "rxmesh/matrix/sparse_matrix.h"
+
+namespace rxmesh {
+
+/**
+ * @brief Chebyshev smoother, i.e., the Chebyshev polynomial of the
+ * Jacobi-preconditioned operator inv(D).A that damps the eigenvalues in
+ * [lower_fraction * lambda_max, upper_scale * lambda_max]. lambda_max is
+ * estimated in setup() using a few power iterations. Every iteration costs
+ * one SpMV (same as Jacobi) but it damps the high frequencies much better
+ * without a damping parameter. setup() should be called every time the
+ * values of the matrix change
+ */
+template <typename T>
+struct ChebyshevSolver
+{
+    DenseMatrix<T> m_inv_diag;
+    DenseMatrix<T> m_d;
+
+    // the eigenvalue estimation of inv(D).A
+    T   m_lambda_max;
+    int m_num_power_iter;
+
+    // the fraction of lambda_max that is the lower end of the damped interval
+    T m_lower_fraction;
+
+    // the safety factor for the estimation of lambda_max
+    T m_upper_scale;
+
+    __host__ ChebyshevSolver()
+        : m_lambda_max(0),
+          m_num_power_iter(10),
+          m_lower_fraction(0.3),
+          m_upper_scale(1.1)
+    {
+    }
+
+    __host__ ChebyshevSolver(int num_rows, int num_cols)
+        : m_inv_diag(num_rows, 1),
+          m_d(num_rows, num_cols),
+          m_lambda_max(0),
+          m_num_power_iter(10),
+          m_lower_fraction(0.3),
+          m_upper_scale(1.1)
+    {
+    }
+
+    /**
+     * @brief compute the inverse of the diagonal of A and estimate the max
+     * eigenvalue of inv(D).A
+     */
+    __host__ void setup(const SparseMatrix<T>& A)
+    {
+        constexpr uint32_t blockThreads = 256;
+        uint32_t           blocks       = DIVIDE_UP(A.rows(), blockThreads);
+
+        if (m_inv_diag.rows() != A.rows()) {
+            m_inv_diag = DenseMatrix<T>(A.rows(), 1);
+        }
+
+        DenseMatrix<T> inv_diag = m_inv_diag;
+
+        for_each_item<<<blocks, blockThreads>>>(
+            A.rows(), [=] __device__(int row) mutable {
+                T diag = 0;
+                for (int j = A.row_ptr()[row]; j < A.row_ptr()[row + 1]; ++j) {
+                    if (A.col_idx()[j] == row) {
+                        diag = A.get_val_at(j);
+                    }
+                }
+                inv_diag(row) = abs(diag) > 10e-8f ? T(1) / diag : T(0);
+            });
+
+        // power iteration on inv(D).A starting from a (deterministic)
+        // non-smooth vector
+        DenseMatrix<T> v(A.rows(), 1, DEVICE);
+        DenseMatrix<T> y(A.rows(), 1, DEVICE);
+
+        for_each_item<<<blocks, blockThreads>>>(
+            A.rows(), [=] __device__(int row) mutable {
+                v(row) = T(1) + T((uint32_t(row) * 2654435761u) % 1024) / 1024;
+            });
+        v.multiply(T(1) / v.norm2());
+
+        m_lambda_max = 0;
+        for (int it = 0; it < m_num_power_iter; ++it) {
+            for_each_item<<<blocks, blockThreads>>>(
+                A.rows(), [=] __device__(int row) mutable {
+                    T sum = 0;
+                    for (int j = A.row_ptr()[row]; j < A.row_ptr()[row + 1];
+                         ++j) {
+                        sum += A.get_val_at(j) * v(A.col_idx()[j]);
+                    }
+                    y(row) = inv_diag(row) * sum;
+                });
+            m_lambda_max = y.norm2();
+            if (m_lambda_max <= T(0)) {
+                break;
+            }
+            v.copy_from(y, DEVICE, DEVICE);
+            v.multiply(T(1) / m_lambda_max);
+        }
+
+        v.release();
+        y.release();
+    }
+
+    /**
+     * @brief num_iter Chebyshev iterations on A.x = b updating x
+     */
+    template <int numCol>
+    __host__ void solve(const SparseMatrix<T>& A,
+                        const DenseMatrix<T>&  b,
+                        DenseMatrix<T>&        x,
+                        int                    num_iter)
+    {
+        if (m_inv_diag.rows() != A.rows()) {
+            RXMESH_ERROR(
+                "ChebyshevSolver::solve() setup() should be called first with "
+                "the same matrix");
+            return;
+        }
+
+        if (num_iter <= 0 || m_lambda_max <= T(0)) {
+            return;
+        }
+
+        if (m_d.rows() != A.rows() || m_d.cols() != x.cols()) {
+            m_d = DenseMatrix<T>(A.rows(), x.cols());
+        }
+
+        const T upper = m_upper_scale * m_lambda_max;
+        const T lower = m_lower_fraction * m_lambda_max;
+        const T theta = (upper + lower) / 2;
+        const T delta = (upper - lower) / 2;
+        const T sigma = theta / delta;
+
+        T rho = T(1) / sigma;
+
+        update_dir<numCol>(A, b, x, T(0), T(1) / theta);
+
+        for (int iter = 0; iter < num_iter; ++iter) {
+            x.axpy(m_d, T(1));
+
+            if (iter == num_iter - 1) {
+                break;
+            }
+
+            const T rho_new = T(1) / (T(2) * sigma - rho);
+            update_dir<numCol>(A, b, x, rho_new * rho, T(2) * rho_new / delta);
+            rho = rho_new;
+        }
+    }
+
+    /**
+     * @brief d = c_d * d + c_r * inv(D).(b - A.x)
+     */
+    template <int numCol>
+    __host__ void update_dir(const SparseMatrix<T>& A,
+                             const DenseMatrix<T>&  b,
+                             const DenseMatrix<T>&  x,
+                             const T                c_d,
+                             const T                c_r)
+    {
+        constexpr uint32_t blockThreads = 256;
+        uint32_t           blocks       = DIVIDE_UP(A.rows(), blockThreads);
+
+        DenseMatrix<T> inv_diag = m_inv_diag;
+        DenseMatrix<T> d        = m_d;
+
+        for_each_item<<<blocks, blockThreads>>>(
+            A.rows(), [=] __device__(int row) mutable {
+                T r[numCol];
+                for (int c = 0; c < numCol; ++c) {
+                    r[c] = b(row, c);
+                }
+                for (int j = A.row_ptr()[row]; j < A.row_ptr()[row + 1]; ++j) {
+                    const int col = A.col_idx()[j];
+                    const T   val = A.get_val_at(j);
+                    for (int c = 0; c < numCol; ++c) {
+                        r[c] -= val * x(col, c);
+                    }
+                }
+                for (int c = 0; c < numCol; ++c) {
+                    d(row, c) = c_d * d(row, c) + c_r * inv_diag(row) * r[c];
+                }
+            });
+    }
+};
+}  // namespace rxmesh
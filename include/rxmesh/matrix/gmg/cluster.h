@@ -1,6 +1,7 @@
 #pragma once
 
 #include "rxmesh/matrix/dense_matrix.h"
+#include "rxmesh/matrix/gmg/gmg_kernels.h"
 #include "rxmesh/rxmesh_static.h"
 
 namespace rxmesh {
@@ -59,12 +60,15 @@ void clustering_1st_level(RXMeshStatic&                rx,
 
     do {
         CUDA_ERROR(cudaMemset(d_flag, 0, sizeof(int)));
-        rx.run_kernel<blockThreads>(lb,
-                                    detail::cluster_points<float, blockThreads>,
-                                    vertex_pos,
-                                    distance,
-                                    vertex_cluster,
-                                    d_flag);
+        for (int s = 0; s < detail::GMG_SWEEPS_PER_SYNC; ++s) {
+            rx.run_kernel<blockThreads>(
+                lb,
+                detail::cluster_points<float, blockThreads>,
+                vertex_pos,
+                distance,
+                vertex_cluster,
+                d_flag);
+        }
 
         h_flag = 0;
         CUDA_ERROR(
@@ -94,34 +98,36 @@ inline void clustering_nth_level(
     do {
         CUDA_ERROR(cudaMemset(d_flag, 0, sizeof(int)));
 
-        for_each_item<<<blocks, threads>>>(
-            num_samples, [=] __device__(int id) mutable {
-                const float sample_x = prev_samples_pos(id, 0);
-                const float sample_y = prev_samples_pos(id, 1);
-                const float sample_z = prev_samples_pos(id, 2);
-
-                const int start = sample_neighbor_size_prefix(id);
-                const int end   = sample_neighbor_size_prefix(id + 1);
-                for (int i = start; i < end; i++) {
-                    int         current_v = sample_neighbor(i);
-                    const float v_x       = prev_samples_pos(current_v, 0);
-                    const float v_y       = prev_samples_pos(current_v, 1);
-                    const float v_z       = prev_samples_pos(current_v, 2);
-
-                    float dist = sqrtf(powf(sample_x - v_x, 2) +
-                                       powf(sample_y - v_y, 2) +
-                                       powf(sample_z - v_z, 2)) +
-                                 distance(current_v);
-
-
-                    if (dist < distance(id) &&
-                        vertex_cluster(current_v) != -1) {
-                        distance(id)       = dist;
-                        *d_flag            = 15;
-                        vertex_cluster(id) = vertex_cluster(current_v);
+        for (int s = 0; s < detail::GMG_SWEEPS_PER_SYNC; ++s) {
+            for_each_item<<<blocks, threads>>>(
+                num_samples, [=] __device__(int id) mutable {
+                    const float sample_x = prev_samples_pos(id, 0);
+                    const float sample_y = prev_samples_pos(id, 1);
+                    const float sample_z = prev_samples_pos(id, 2);
+
+                    const int start = sample_neighbor_size_prefix(id);
+                    const int end   = sample_neighbor_size_prefix(id + 1);
+                    for (int i = start; i < end; i++) {
+                        int         current_v = sample_neighbor(i);
+                        const float v_x       = prev_samples_pos(current_v, 0);
+                        const float v_y       = prev_samples_pos(current_v, 1);
+                        const float v_z       = prev_samples_pos(current_v, 2);
+
+                        float dist = sqrtf(powf(sample_x - v_x, 2) +
+                                           powf(sample_y - v_y, 2) +
+                                           powf(sample_z - v_z, 2)) +
+                                     distance(current_v);
+
+
+                        if (dist < distance(id) &&
+                            vertex_cluster(current_v) != -1) {
+                            distance(id)       = dist;
+                            *d_flag            = 15;
+                            vertex_cluster(id) = vertex_cluster(current_v);
+                        }
                     }
-                }
-            });
+                });
+        }
         h_flag = 0;
         CUDA_ERROR(
             cudaMemcpy(&h_flag, d_flag, sizeof(int), cudaMemcpyDeviceToHost));
@@ -1,8 +1,12 @@
 #pragma once
 
+#include <algorithm>
+#include <cstring>
 #include <random>
+#include <vector>
 
 #include "rxmesh/matrix/dense_matrix.h"
+#include "rxmesh/matrix/gmg/gmg_kernels.h"
 #include "rxmesh/reduce_handle.h"
 #include "rxmesh/rxmesh_static.h"
 
@@ -37,6 +41,7 @@ __global__ static void sample_points(const Context            context,
     ShmemAllocator      shrd_alloc;
     query.dispatch<Op::VV>(block, shrd_alloc, sampler);
 }
+
 }  // namespace detail
 
 /**
@@ -99,11 +104,13 @@ void FPSSampler(RXMeshStatic&             rx,
         do {
             CUDA_ERROR(cudaMemset(d_flag, 0, sizeof(int)));
 
-            rx.run_kernel(lb,
-                          detail::sample_points<blockThreads>,
-                          vertex_pos,
-                          distance,
-                          d_flag);
+            for (int s = 0; s < detail::GMG_SWEEPS_PER_SYNC; ++s) {
+                rx.run_kernel(lb,
+                              detail::sample_points<blockThreads>,
+                              vertex_pos,
+                              distance,
+                              d_flag);
+            }
 
             h_flag = 0;
             CUDA_ERROR(cudaMemcpy(
@@ -119,4 +126,195 @@ void FPSSampler(RXMeshStatic&             rx,
     }
 }
 
-}  // namespace rxmesh
\ No newline at end of file
+/**
+ * \brief Approximate FPS Sampling in parallel. Instead of one pick per
+ * distance update (as in FPSSampler), every round takes the farthest vertex of
+ * every patch as a candidate and accepts, in decreasing distance order, the
+ * candidates whose distance is at least batch_ratio of the farthest distance
+ * and whose Euclidean distance to the candidates accepted in this round is not
+ * less than their own distance. Since the Euclidean distance is a lower bound
+ * of the geodesic distance, an accepted candidate is still at least as far
+ * from the samples as it was at the start of the round. The accepted
+ * candidates are then seeded together with a single distance update. The
+ * samples are ordered by decreasing distance (the same way FPSSampler orders
+ * them) so that the first samples are still a coarser sampling. batch_ratio=1
+ * is close to exact FPS while smaller values take more samples per round
+ */
+void FPSSamplerBatched(RXMeshStatic&             rx,
+                       VertexAttribute<float>&   distance,
+                       const DenseMatrix<float>& vertex_pos,
+                       DenseMatrix<int>&         vertex_cluster,
+                       DenseMatrix<float>&       samples_pos,
+                       float                     ratio,
+                       int                       N,
+                       int                       numberOfLevels,
+                       int                       numberOfSamplesForFirstLevel,
+                       int*                      d_flag,
+                       float                     batch_ratio = 0.5f)
+{
+    constexpr uint32_t blockThreads = 256;
+
+    const Context  context     = rx.get_context();
+    const uint32_t num_patches = rx.get_num_patches();
+
+    LaunchBox<blockThreads> lb;
+    rx.prepare_launch_box(
+        {Op::VV}, lb, (void*)detail::sample_points<blockThreads>);
+
+    unsigned long long* d_candidate = nullptr;
+    VertexHandle*       d_seeds     = nullptr;
+    CUDA_ERROR(tracked_malloc((void**)&d_candidate,
+                              num_patches * sizeof(unsigned long long),
+                              MemoryCategory::Solver));
+    CUDA_ERROR(tracked_malloc((void**)&d_seeds,
+                              num_patches * sizeof(VertexHandle),
+                              MemoryCategory::Solver));
+
+    std::vector<unsigned long long> h_candidate(num_patches);
+    std::vector<VertexHandle>       seeds;
+    std::vector<uint32_t>           order(num_patches);
+
+    // the first sample is the same as FPSSampler
+    int seed = 0;
+    rx.for_each_vertex(DEVICE, [=] __device__(const VertexHandle vh) mutable {
+        if (seed == context.linear_id(vh)) {
+            vertex_cluster(vh) = 0;
+            distance(vh)       = 0;
+
+            samples_pos(0, 0) = vertex_pos(vh, 0);
+            samples_pos(0, 1) = vertex_pos(vh, 1);
+            samples_pos(0, 2) = vertex_pos(vh, 2);
+        } else {
+            distance(vh, 0) = std::numeric_limits<float>::max();
+        }
+    });
+
+    int num_samples = 1;
+    int h_flag;
+
+    while (true) {
+        // distance update
+        do {
+            CUDA_ERROR(cudaMemset(d_flag, 0, sizeof(int)));
+
+            for (int s = 0; s < detail::GMG_SWEEPS_PER_SYNC; ++s) {
+                rx.run_kernel(lb,
+                              detail::sample_points<blockThreads>,
+                              vertex_pos,
+                              distance,
+                              d_flag);
+            }
+
+            h_flag = 0;
+            CUDA_ERROR(cudaMemcpy(
+                &h_flag, d_flag, sizeof(int), cudaMemcpyDeviceToHost));
+
+        } while (h_flag != 0);
+
+        if (num_samples >= numberOfSamplesForFirstLevel) {
+            break;
+        }
+
+        // one candidate per patch
+        CUDA_ERROR(cudaMemset(
+            d_candidate, 0, num_patches * sizeof(unsigned long long)));
+        // the candidate packs the (non-negative) distance in the high 32 bits
+        // and the local index in the low 32 bits such that atomicMax picks
+        // the farthest vertex of the patch
+        rx.for_each_vertex(
+            DEVICE, [=] __device__(const VertexHandle vh) mutable {
+                const unsigned long long key =
+                    (static_cast<unsigned long long>(
+                         __float_as_uint(distance(vh, 0)))
+                     << 32) |
+                    vh.local_id();
+                ::atomicMax(d_candidate + vh.patch_id(), key);
+            });
+        CUDA_ERROR(cudaMemcpy(h_candidate.data(),
+                              d_candidate,
+                              num_patches * sizeof(unsigned long long),
+                              cudaMemcpyDeviceToHost));
+
+        for (uint32_t p = 0; p < num_patches; ++p) {
+            order[p] = p;
+        }
+        std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+            return h_candidate[a] > h_candidate[b];
+        });
+
+        auto cand_dist = [&](uint32_t p) {
+            uint32_t bits = static_cast<uint32_t>(h_candidate[p] >> 32);
+            float    d;
+            std::memcpy(&d, &bits, sizeof(float));
+            return d;
+        };
+
+        const float max_dist = cand_dist(order[0]);
+        if (max_dist <= 0) {
+            RXMESH_WARN(
+                "FPSSamplerBatched() all vertices are sampled with only {} "
+                "out of {} samples",
+                num_samples,
+                numberOfSamplesForFirstLevel);
+            break;
+        }
+
+        seeds.clear();
+        for (uint32_t p : order) {
+            if (num_samples + int(seeds.size()) >=
+                numberOfSamplesForFirstLevel) {
+                break;
+            }
+            const float d = cand_dist(p);
+            if (d <= 0 || d < batch_ratio * max_dist) {
+                break;
+            }
+
+            const VertexHandle vh(
+                p, static_cast<uint16_t>(h_candidate[p] & 0xFFFFFFFF));
+            const uint32_t v = rx.linear_id(vh);
+
+            bool accept = true;
+            for (const VertexHandle& s : seeds) {
+                const uint32_t u  = rx.linear_id(s);
+                const float    dx = vertex_pos(v, 0) - vertex_pos(u, 0);
+                const float    dy = vertex_pos(v, 1) - vertex_pos(u, 1);
+                const float    dz = vertex_pos(v, 2) - vertex_pos(u, 2);
+                if (dx * dx + dy * dy + dz * dz < d * d) {
+                    accept = false;
+                    break;
+                }
+            }
+            if (accept) {
+                seeds.push_back(vh);
+            }
+        }
+
+        CUDA_ERROR(cudaMemcpy(d_seeds,
+                              seeds.data(),
+                              seeds.size() * sizeof(VertexHandle),
+                              cudaMemcpyHostToDevice));
+
+        const int      first     = num_samples;
+        const uint32_t num_seeds = seeds.size();
+        for_each_item<<<DIVIDE_UP(num_seeds, blockThreads), blockThreads>>>(
+            num_seeds, [=] __device__(int s) mutable {
+                const VertexHandle vh = d_seeds[s];
+                const int          i  = first + s;
+
+                vertex_cluster(vh) = i;
+                distance(vh)       = 0;
+
+                samples_pos(i, 0) = vertex_pos(vh, 0);
+                samples_pos(i, 1) = vertex_pos(vh, 1);
+                samples_pos(i, 2) = vertex_pos(vh, 2);
+            });
+
+        num_samples += num_seeds;
+    }
+
+    GPU_FREE(d_candidate);
+    GPU_FREE(d_seeds);
+}
+
+}  // namespace rxmesh
@@ -0,0 +1,174 @@
+#pragma once
+
+#include <vector>
+
+#include "rxmesh/rxmesh_static.h"
+
+#include "rxmesh/matrix/dense_matrix.h"
+#include "rxmesh/matrix/sparse_matrix.h"
+
+namespace rxmesh {
+
+/**
+ * @brief multicolor Gauss-Seidel where the rows of the matrix are colored
+ * (greedily on the host) such that two rows of the same color are not coupled
+ * by a non-zero. The rows of one color are then relaxed in parallel and in
+ * place, and processing the colors one after the other is a Gauss-Seidel
+ * sweep. Unlike Jacobi, it does not need damping and it converges faster on
+ * anisotropic matrices. setup() should be called every time the sparsity of
+ * the matrix changes
+ */
+template <typename T>
+struct GaussSeidelSolver
+{
+    __host__ GaussSeidelSolver() : m_d_rows(nullptr), m_num_rows(0)
+    {
+    }
+
+    /**
+     * @brief color the rows of A using the sparsity on the host. Return the
+     * number of colors
+     */
+    __host__ int setup(const SparseMatrix<T>& A)
+    {
+        release();
+
+        m_num_rows = A.rows();
+
+        const int* row_ptr = A.row_ptr(HOST);
+        const int* col_idx = A.col_idx(HOST);
+
+        std::vector<int> color(m_num_rows, -1);
+
+        // the last row that marked a color as used by one of its neighbors
+        std::vector<int> forbidden;
+
+        int num_colors = 0;
+
+        for (int row = 0; row < m_num_rows; ++row) {
+            for (int j = row_ptr[row]; j < row_ptr[row + 1]; ++j) {
+                const int c = color[col_idx[j]];
+                if (c >= 0) {
+                    forbidden[c] = row;
+                }
+            }
+            int c = 0;
+            while (c < num_colors && forbidden[c] == row) {
+                c++;
+            }
+            if (c == num_colors) {
+                forbidden.push_back(-1);
+                num_colors++;
+            }
+            color[row] = c;
+        }
+
+        // group the rows by color
+        m_color_offset.assign(num_colors + 1, 0);
+        for (int row = 0; row < m_num_rows; ++row) {
+            m_color_offset[color[row] + 1]++;
+        }
+        for (int c = 0; c < num_colors; ++c) {
+            m_color_offset[c + 1] += m_color_offset[c];
+        }
+
+        std::vector<int> rows(m_num_rows);
+        std::vector<int> pos(m_color_offset.begin(), m_color_offset.end() - 1);
+        for (int row = 0; row < m_num_rows; ++row) {
+            rows[pos[color[row]]++] = row;
+        }
+
+        CUDA_ERROR(tracked_malloc(
+            &m_d_rows, m_num_rows * sizeof(int), MemoryCategory::Solver));
+        CUDA_ERROR(cudaMemcpy(m_d_rows,
+                              rows.data(),
+                              m_num_rows * sizeof(int),
+                              cudaMemcpyHostToDevice));
+
+        return num_colors;
+    }
+
+    /**
+     * @brief num_iter sweeps on A.x = b updating x in place. With reverse, the
+     * colors are processed in reverse order such that a forward pre-smoothing
+     * and a reverse post-smoothing keep the V-cycle symmetric
+     */
+    template <int numCol>
+    __host__ void solve(const SparseMatrix<T>& A,
+                        const DenseMatrix<T>&  b,
+                        DenseMatrix<T>&        x,
+                        int                    num_iter,
+                        bool                   reverse = false)
+    {
+        if (m_d_rows == nullptr || m_num_rows != A.rows()) {
+            RXMESH_ERROR(
+                "GaussSeidelSolver::solve() setup() should be called first "
+                "with the same matrix");
+            return;
+        }
+
+        constexpr uint32_t blockThreads = 256;
+
+        const int num_colors = get_num_colors();
+
+        for (int iter = 0; iter < num_iter; ++iter) {
+            for (int k = 0; k < num_colors; ++k) {
+                const int color = reverse ? num_colors - 1 - k : k;
+                const int start = m_color_offset[color];
+                const int size  = m_color_offset[color + 1] - start;
+
+                const int*     rows   = m_d_rows + start;
+                DenseMatrix<T> xx     = x;
+                uint32_t       blocks = DIVIDE_UP(size, blockThreads);
+
+                for_each_item<<<blocks, blockThreads>>>(
+                    size, [=] __device__(int i) mutable {
+                        const int row = rows[i];
+
+                        T diag = 0;
+                        T sum[numCol];
+                        for (int c = 0; c < numCol; ++c) {
+                            sum[c] = 0;
+                        }
+                        for (int j = A.row_ptr()[row];
+                             j < A.row_ptr()[row + 1];
+                             ++j) {
+                            const int col = A.col_idx()[j];
+                            const T   val = A.get_val_at(j);
+                            if (col == row) {
+                                diag = val;
+                            } else {
+                                for (int c = 0; c < numCol; ++c) {
+                                    sum[c] += val * xx(col, c);
+                                }
+                            }
+                        }
+                        if (abs(diag) > 10e-8f) {
+                            for (int c = 0; c < numCol; ++c) {
+                                xx(row, c) = (b(row, c) - sum[c]) / diag;
+                            }
+                        }
+                    });
+            }
+        }
+    }
+
+    __host__ int get_num_colors() const
+    {
+        return m_color_offset.empty() ? 0 : int(m_color_offset.size()) - 1;
+    }
+
+    __host__ void release()
+    {
+        GPU_FREE(m_d_rows);
+        m_color_offset.clear();
+        m_num_rows = 0;
+    }
+
+    // the rows grouped by color where the rows of color c start at
+    // m_color_offset[c]
+    int*             m_d_rows;
+    std::vector<int> m_color_offset;
+    int              m_num_rows;
+};
+}  // namespace rxmesh
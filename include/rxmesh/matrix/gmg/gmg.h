@@ -23,10 +23,11 @@ namespace rxmesh {
 
 enum class Sampling
 {
-    None   = 0,
-    Rand   = 1,
-    FPS    = 2,
-    KMeans = 3,
+    None       = 0,
+    Rand       = 1,
+    FPS        = 2,
+    KMeans     = 3,
+    BatchedFPS = 4,
 };
 
 inline Sampling string_to_sampling(std::string samp)
@@ -41,6 +42,8 @@ inline Sampling string_to_sampling(std::string samp)
         return Sampling::FPS;
     } else if (samp == "kmeans") {
         return Sampling::KMeans;
+    } else if (samp == "bfps") {
+        return Sampling::BatchedFPS;
     } else {
         return Sampling::None;
     }
@@ -64,6 +67,12 @@ struct GMG
     int   m_num_rows;
     int*  m_d_flag;
     float memory_alloc_time = 0;
+
+    // per-phase setup time (ms)
+    float sampling_time     = 0;
+    float clustering_time   = 0;
+    float csr_time          = 0;
+    float prolongation_time = 0;
     bool  m_pruned_ptap;
 
     std::vector<int>                m_num_samples;  // fine+levels
@@ -265,7 +274,9 @@ struct GMG
         m_distance = *rx.add_vertex_attribute<float>("d", 1);
 
 
-        CUDA_ERROR(cudaMalloc((void**)&m_d_flag, sizeof(int)));
+        CUDA_ERROR(tracked_malloc((void**)&m_d_flag,
+                                  sizeof(int),
+                                  MemoryCategory::Solver));
 
         // allocate CUB stuff here
         m_cub_temp_bytes = 0;
@@ -275,7 +286,9 @@ struct GMG
             m_sample_neighbor_size[0].data(DEVICE),
             m_sample_neighbor_size_prefix[0].data(DEVICE),
             m_num_samples[1] + 1);
-        CUDA_ERROR(cudaMalloc((void**)&m_d_cub_temp_storage, m_cub_temp_bytes));
+        CUDA_ERROR(tracked_malloc((void**)&m_d_cub_temp_storage,
+                                  m_cub_temp_bytes,
+                                  MemoryCategory::Solver));
 
         if (m_pruned_ptap) {
             m_cub_temp_bytes_disk = 0;
@@ -285,8 +298,9 @@ struct GMG
                 m_sample_neighbor_size_disk[0].data(DEVICE),
                 m_sample_neighbor_size_prefix_disk[0].data(DEVICE),
                 m_num_samples[1] + 1);
-            CUDA_ERROR(cudaMalloc((void**)&m_d_cub_temp_storage_disk,
-                                  m_cub_temp_bytes_disk));
+            CUDA_ERROR(tracked_malloc((void**)&m_d_cub_temp_storage_disk,
+                                      m_cub_temp_bytes_disk,
+                                      MemoryCategory::Solver));
         }
 
         timer.stop();
@@ -324,6 +338,16 @@ struct GMG
                             gtimer.elapsed_millis());
                 break;
             }
+            case Sampling::BatchedFPS: {
+                fps_sampling(rx, true);
+                timer.stop();
+                gtimer.stop();
+                RXMESH_INFO(
+                    "GMG::GMG() Batched FPS sampling took {} (ms), {} (ms)",
+                    timer.elapsed_millis(),
+                    gtimer.elapsed_millis());
+                break;
+            }
             case Sampling::KMeans: {
                 kmeans_sampling(rx);
                 timer.stop();
@@ -335,11 +359,13 @@ struct GMG
             }
             default: {
                 RXMESH_ERROR("GMG::GMG() Invalid input Sampling");
+                timer.stop();
+                gtimer.stop();
                 break;
             }
         }
-
-        float cluster_time(0), csr_time(0);
+        sampling_time =
+            std::max(timer.elapsed_millis(), gtimer.elapsed_millis());
 
         for (int l = 0; l < m_num_levels - 1; ++l) {
 
@@ -353,7 +379,7 @@ struct GMG
 
             timer.stop();
             gtimer.stop();
-            cluster_time +=
+            clustering_time +=
                 std::max(timer.elapsed_millis(), gtimer.elapsed_millis());
 
             //============
@@ -371,7 +397,7 @@ struct GMG
                 std::max(timer.elapsed_millis(), gtimer.elapsed_millis());
         }
 
-        RXMESH_INFO("GMG::GMG() Clustering took {} (ms)", cluster_time);
+        RXMESH_INFO("GMG::GMG() Clustering took {} (ms)", clustering_time);
 
         RXMESH_INFO("GMG::GMG() Creating CSR took {} (ms)", csr_time);
 
@@ -387,6 +413,8 @@ struct GMG
 
         timer.stop();
         gtimer.stop();
+        prolongation_time =
+            std::max(timer.elapsed_millis(), gtimer.elapsed_millis());
         RXMESH_INFO(
             "GMG::GMG() Constructing prolongation operators took {} (ms), {} "
             "(ms)",
@@ -413,20 +441,35 @@ struct GMG
     }
 
     /**
-     * @brief Samples for all levels using FPS sampling
+     * @brief Samples for all levels using FPS sampling. If batched, the first
+     * level uses the approximate FPSSamplerBatched() instead of the exact
+     * FPSSampler()
      */
-    void fps_sampling(RXMeshStatic& rx)
+    void fps_sampling(RXMeshStatic& rx, bool batched = false)
     {
-        FPSSampler(rx,
-                   m_distance,
-                   m_vertex_pos,
-                   m_vertex_cluster[0],
-                   m_samples_pos[0],
-                   m_ratio,
-                   m_num_rows,
-                   m_num_levels,
-                   m_num_samples[1],
-                   m_d_flag);
+        if (batched) {
+            FPSSamplerBatched(rx,
+                              m_distance,
+                              m_vertex_pos,
+                              m_vertex_cluster[0],
+                              m_samples_pos[0],
+                              m_ratio,
+                              m_num_rows,
+                              m_num_levels,
+                              m_num_samples[1],
+                              m_d_flag);
+        } else {
+            FPSSampler(rx,
+                       m_distance,
+                       m_vertex_pos,
+                       m_vertex_cluster[0],
+                       m_samples_pos[0],
+                       m_ratio,
+                       m_num_rows,
+                       m_num_levels,
+                       m_num_samples[1],
+                       m_d_flag);
+        }
 
         constexpr uint32_t blockThreads = 256;
 
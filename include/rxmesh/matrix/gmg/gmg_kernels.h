@@ -9,6 +9,13 @@
 namespace rxmesh {
 namespace detail {
 
+// the number of relaxation sweeps (FPS distance update and clustering) that
+// are launched back-to-back before the host checks for convergence. A sweep
+// only decreases the distances so the extra sweeps after convergence are
+// no-ops, while reading the flag after every sweep serializes the host with
+// the device and exposes the launch latency of every sweep
+static constexpr int GMG_SWEEPS_PER_SYNC = 8;
+
 template <uint32_t blockThreads>
 __global__ static void populate_edge_hashtable_1st_level(
     const Context          context,
@@ -242,7 +249,9 @@ void build_n_ring_on_gpu_compute(GPUStorage<Edge>  input_edges,
 
     // 1. Build CSR from input_edges
     int* degrees;
-    cudaMalloc(&degrees, sizeof(int) * num_vertices);
+    tracked_malloc((void**)&degrees,
+                   sizeof(int) * num_vertices,
+                   MemoryCategory::Solver);
     cudaMemset(degrees, 0, sizeof(int) * num_vertices);
 
     
@@ -257,7 +266,9 @@ void build_n_ring_on_gpu_compute(GPUStorage<Edge>  input_edges,
     });
 
     int* csr_offsets;
-    cudaMalloc(&csr_offsets, sizeof(int) * (num_vertices + 1));
+    tracked_malloc((void**)&csr_offsets,
+                   sizeof(int) * (num_vertices + 1),
+                   MemoryCategory::Solver);
     cudaMemset(csr_offsets, 0, sizeof(int) * (num_vertices + 1));
 
     thrust::exclusive_scan(thrust::device, degrees, degrees + num_vertices+1, csr_offsets);
@@ -271,8 +282,12 @@ void build_n_ring_on_gpu_compute(GPUStorage<Edge>  input_edges,
 
     int* csr_neighbors;
     int* csr_insert_ptrs;
-    cudaMalloc(&csr_neighbors, sizeof(int) * total_neighbors);
-    cudaMalloc(&csr_insert_ptrs, sizeof(int) * (num_vertices + 1));
+    tracked_malloc((void**)&csr_neighbors,
+                   sizeof(int) * total_neighbors,
+                   MemoryCategory::Solver);
+    tracked_malloc((void**)&csr_insert_ptrs,
+                   sizeof(int) * (num_vertices + 1),
+                   MemoryCategory::Solver);
     cudaMemcpy(csr_insert_ptrs,
                csr_offsets,
                sizeof(int) * (num_vertices + 1),
@@ -288,8 +303,8 @@ void build_n_ring_on_gpu_compute(GPUStorage<Edge>  input_edges,
             csr_neighbors[ib] = a;
         });
 
-    cudaFree(degrees);
-    cudaFree(csr_insert_ptrs);
+    CUDA_ERROR(tracked_free(degrees));
+    CUDA_ERROR(tracked_free(csr_insert_ptrs));
     
     
 
@@ -361,8 +376,8 @@ void build_n_ring_on_gpu_compute(GPUStorage<Edge>  input_edges,
         next_frontier  = GPUStorage<Edge>(frontier_edges.get_capacity() * 2);
     }
 
-    cudaFree(csr_offsets);
-    cudaFree(csr_neighbors);
+    CUDA_ERROR(tracked_free(csr_offsets));
+    CUDA_ERROR(tracked_free(csr_neighbors));
 
     // Final result
     out_nring_edges = std::move(visited_edges);
@@ -0,0 +1,331 @@
+#pragma once
+
+#include <memory>
+
+#include "rxmesh/matrix/gmg/gmg.h"
+#include "rxmesh/matrix/gmg/v_cycle.h"
+#include "rxmesh/matrix/gmg/v_cycle_pruned.h"
+#include "rxmesh/matrix/mixed_precision_solver.h"
+
+namespace rxmesh {
+
+/**
+ * @brief Geometric multigrid used as a preconditioner, i.e., inv(M) * r is
+ * approximated by a fixed number of V-cycles on A * z = r starting from z = 0.
+ * The hierarchy (samples and prolongation operators) is built on the first
+ * call to setup() and is reused by all later calls which only rebuild the
+ * coarse (Galerkin) operators P^T * A * P. Thus, the same preconditioner can be
+ * used across solves where the matrix values change but not the mesh, e.g.,
+ * Newton iterations. Use attach() to make it the preconditioner of a PCGSolver
+ * Similar to GMGSolver, the V-cycle operates on 3 right-hand sides and with
+ * float. The number of pre- and post-smoothing iterations should be equal so
+ * that the preconditioner is symmetric
+ */
+template <typename T>
+struct GMGPreconditioner
+{
+    static_assert(std::is_same_v<T, float>,
+                  "GMGPreconditioner only supports float");
+
+    GMGPreconditioner(RXMeshStatic&    rx,
+                      SparseMatrix<T>& A,
+                      int              num_levels     = 0,
+                      int              num_pre_relax  = 2,
+                      int              num_post_relax = 2,
+                      CoarseSolver     coarse_solver  = CoarseSolver::Jacobi,
+                      Sampling         sampling       = Sampling::Rand,
+                      int              threshold      = 1000,
+                      bool             pruned_ptap    = false,
+                      int              num_cycles     = 1)
+        : m_rx(&rx),
+          m_A(&A),
+          m_num_levels(num_levels),
+          m_num_pre_relax(num_pre_relax),
+          m_num_post_relax(num_post_relax),
+          m_coarse_solver(coarse_solver),
+          m_sampling(sampling),
+          m_threshold(threshold),
+          m_pruned_ptap(pruned_ptap),
+          m_num_cycles(num_cycles)
+    {
+        if (m_coarse_solver == CoarseSolver::None) {
+            RXMESH_ERROR(
+                "GMGPreconditioner::GMGPreconditioner() invalid coarse solver "
+                "{}",
+                CoarseSolver::None);
+        }
+        if (m_num_pre_relax != m_num_post_relax) {
+            RXMESH_WARN(
+                "GMGPreconditioner::GMGPreconditioner() different number of "
+                "pre- ({}) and post-smoothing ({}) iterations makes the "
+                "preconditioner non-symmetric",
+                m_num_pre_relax,
+                m_num_post_relax);
+        }
+    }
+
+    /**
+     * @brief build the hierarchy on the first call. Later calls only rebuild
+     * the coarse operators with the current values of A. Should be called
+     * every time the values of A change
+     */
+    void setup(int num_cols, cudaStream_t stream = NULL)
+    {
+        if (m_v_cycle && m_v_cycle->m_r[0].cols() == num_cols) {
+            m_v_cycle->update_coarser_systems(m_gmg, *m_rx, *m_A);
+            return;
+        }
+
+        CPUTimer timer;
+        GPUTimer gtimer;
+        timer.start();
+        gtimer.start();
+
+        m_gmg =
+            GMG<T>(*m_rx, m_num_levels, m_threshold, m_sampling, m_pruned_ptap);
+
+        m_num_levels = m_gmg.m_num_levels;
+
+        if (!m_pruned_ptap) {
+            m_v_cycle = std::make_unique<VCycle<T>>(m_gmg,
+                                                    *m_rx,
+                                                    *m_A,
+                                                    num_cols,
+                                                    m_coarse_solver,
+                                                    m_num_pre_relax,
+                                                    m_num_post_relax,
+                                                    m_smoothers);
+        } else {
+            m_v_cycle = std::make_unique<VCyclePruned<T>>(m_gmg,
+                                                          *m_rx,
+                                                          *m_A,
+                                                          num_cols,
+                                                          m_coarse_solver,
+                                                          m_num_pre_relax,
+                                                          m_num_post_relax,
+                                                          m_smoothers);
+        }
+        m_v_cycle->coarser_systems(m_gmg, *m_rx, *m_A);
+
+        timer.stop();
+        gtimer.stop();
+        RXMESH_INFO(
+            "GMGPreconditioner::setup() hierarchy construction took {} (ms), "
+            "{} (ms)",
+            timer.elapsed_millis(),
+            gtimer.elapsed_millis());
+    }
+
+    /**
+     * @brief out = inv(M) * in where inv(M) is m_num_cycles V-cycles
+     */
+    void apply(const DenseMatrix<T>& in,
+               DenseMatrix<T>&       out,
+               cudaStream_t          stream = NULL)
+    {
+        if (!m_v_cycle) {
+            RXMESH_ERROR(
+                "GMGPreconditioner::apply() setup() should be called first");
+            return;
+        }
+
+        // the V-cycle does not modify the rhs
+        DenseMatrix<T> f = in;
+
+        out.reset(T(0), DEVICE, stream);
+
+        for (int c = 0; c < m_num_cycles; ++c) {
+            // the coarse corrections should start from zero so that the
+            // preconditioner is a fixed linear operator
+            for (auto& x : m_v_cycle->m_x) {
+                x.reset(T(0), DEVICE, stream);
+            }
+            m_v_cycle->cycle(0, m_gmg, *m_A, f, out, *m_rx);
+        }
+    }
+
+    /**
+     * @brief make this the preconditioner of solver (e.g., PCGSolver). The
+     * solver calls setup() in its pre_solve() and apply() in every iteration
+     */
+    template <typename SolverT>
+    void attach(SolverT& solver)
+    {
+        solver.set_preconditioner(
+            [this](const DenseMatrix<T>& in,
+                   DenseMatrix<T>&       out,
+                   cudaStream_t          stream) { apply(in, out, stream); },
+            [this](int num_cols, cudaStream_t stream) {
+                setup(num_cols, stream);
+            });
+    }
+
+    /**
+     * @brief force the next setup() to rebuild the hierarchy, e.g., after the
+     * mesh geometry changed significantly
+     */
+    void reset_hierarchy()
+    {
+        m_v_cycle.reset();
+    }
+
+    /**
+     * @brief the smoother of every level starting from the fine level where
+     * the last one is used for the remaining levels (default is Jacobi on all
+     * levels). The hierarchy is rebuilt with the new smoothers
+     */
+    void set_smoothers(const std::vector<Smoother>& smoothers)
+    {
+        m_smoothers = smoothers;
+        m_v_cycle.reset();
+    }
+
+    int get_num_levels() const
+    {
+        return m_num_levels;
+    }
+
+   protected:
+    RXMeshStatic*              m_rx;
+    SparseMatrix<T>*           m_A;
+    GMG<T>                     m_gmg;
+    std::unique_ptr<VCycle<T>> m_v_cycle;
+    int                        m_num_levels;
+    int                        m_num_pre_relax;
+    int                        m_num_post_relax;
+    CoarseSolver               m_coarse_solver;
+    Sampling                   m_sampling;
+    int                        m_threshold;
+    bool                       m_pruned_ptap;
+    int                        m_num_cycles;
+    std::vector<Smoother>      m_smoothers;
+};
+
+/**
+ * @brief mixed-precision GMG preconditioner for a double-precision system.
+ * The V-cycle runs in float on a float copy of A while the outer solver (e.g.,
+ * PCGSolver<double>) runs in double. So the solution is as accurate as a
+ * double-precision solve while the bulk of the work (the V-cycles) is done in
+ * float. The residual passed to apply() is converted to float and the
+ * correction is converted back to double
+ */
+template <typename T>
+struct MixedGMGPreconditioner
+{
+    static_assert(std::is_same_v<T, double>,
+                  "MixedGMGPreconditioner only supports double");
+
+    MixedGMGPreconditioner(RXMeshStatic&    rx,
+                           SparseMatrix<T>& A,
+                           int              num_levels     = 0,
+                           int              num_pre_relax  = 2,
+                           int              num_post_relax = 2,
+                           CoarseSolver coarse_solver = CoarseSolver::Jacobi,
+                           Sampling     sampling      = Sampling::Rand,
+                           int          threshold     = 1000,
+                           bool         pruned_ptap   = false,
+                           int          num_cycles    = 1)
+        : m_low(make_low(A)),
+          m_gmg(rx,
+                m_low->mat(),
+                num_levels,
+                num_pre_relax,
+                num_post_relax,
+                coarse_solver,
+                sampling,
+                threshold,
+                pruned_ptap,
+                num_cycles)
+    {
+    }
+
+    ~MixedGMGPreconditioner()
+    {
+        release_buffers();
+        m_low->release();
+    }
+
+    /**
+     * @brief convert A to float and set up the float GMG preconditioner. Should
+     * be called every time the values of A change
+     */
+    void setup(int num_cols, cudaStream_t stream = NULL)
+    {
+        m_low->update(stream);
+        m_gmg.setup(num_cols, stream);
+    }
+
+    /**
+     * @brief out = inv(M) * in where inv(M) is applied in float
+     */
+    void apply(const DenseMatrix<T>& in,
+               DenseMatrix<T>&       out,
+               cudaStream_t          stream = NULL)
+    {
+        if (m_in.rows() != in.rows() || m_in.cols() != in.cols()) {
+            release_buffers();
+            m_in  = DenseMatrix<float>(in.rows(), in.cols(), DEVICE);
+            m_out = DenseMatrix<float>(in.rows(), in.cols(), DEVICE);
+        }
+
+        detail::convert_precision(in, m_in, stream);
+        m_gmg.apply(m_in, m_out, stream);
+        detail::convert_precision(m_out, out, stream);
+    }
+
+    /**
+     * @brief make this the preconditioner of solver (e.g., PCGSolver<double>)
+     */
+    template <typename SolverT>
+    void attach(SolverT& solver)
+    {
+        solver.set_preconditioner(
+            [this](const DenseMatrix<T>& in,
+                   DenseMatrix<T>&       out,
+                   cudaStream_t          stream) { apply(in, out, stream); },
+            [this](int num_cols, cudaStream_t stream) {
+                setup(num_cols, stream);
+            });
+    }
+
+    void reset_hierarchy()
+    {
+        m_gmg.reset_hierarchy();
+    }
+
+    void set_smoothers(const std::vector<Smoother>& smoothers)
+    {
+        m_gmg.set_smoothers(smoothers);
+    }
+
+    int get_num_levels() const
+    {
+        return m_gmg.get_num_levels();
+    }
+
+   protected:
+    static std::unique_ptr<LowPrecisionSparseMatrix<T, float>> make_low(
+        SparseMatrix<T>& A)
+    {
+        auto low = std::make_unique<LowPrecisionSparseMatrix<T, float>>();
+        low->init(A);
+        low->update();
+        return low;
+    }
+
+    void release_buffers()
+    {
+        if (m_in.rows() > 0) {
+            m_in.release();
+            m_out.release();
+            m_in  = DenseMatrix<float>();
+            m_out = DenseMatrix<float>();
+        }
+    }
+
+    std::unique_ptr<LowPrecisionSparseMatrix<T, float>> m_low;
+    GMGPreconditioner<float>                            m_gmg;
+    DenseMatrix<float>                                  m_in, m_out;
+};
+
+}  // namespace rxmesh
@@ -99,8 +99,12 @@ struct GPUStorage
 
     explicit GPUStorage(const uint32_t capacity) : m_capacity(capacity)
     {
-        CUDA_ERROR(cudaMalloc((void**)&m_storage, num_bytes()));
-        CUDA_ERROR(cudaMalloc((void**)&m_count, sizeof(int)));
+        CUDA_ERROR(tracked_malloc((void**)&m_storage,
+                                  num_bytes(),
+                                  MemoryCategory::Solver));
+        CUDA_ERROR(tracked_malloc((void**)&m_count,
+                                  sizeof(int),
+                                  MemoryCategory::Solver));
         clear();
     }
 
@@ -222,8 +226,12 @@ struct GPUHashTable
 
         m_capacity = find_next_prime_number(m_capacity);
 
-        CUDA_ERROR(cudaMalloc((void**)&m_table, num_bytes()));
-        CUDA_ERROR(cudaMalloc((void**)&m_stash, stash_size * sizeof(T)));
+        CUDA_ERROR(tracked_malloc((void**)&m_table,
+                                  num_bytes(),
+                                  MemoryCategory::Solver));
+        CUDA_ERROR(tracked_malloc((void**)&m_stash,
+                                  stash_size * sizeof(T),
+                                  MemoryCategory::Solver));
 
 
         clear();
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <algorithm>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "rxmesh/matrix/gmg/chebyshev_solver.h"
+#include "rxmesh/matrix/gmg/gauss_seidel_solver.h"
+#include "rxmesh/matrix/gmg/jacobi_solver.h"
+
+namespace rxmesh {
+
+enum class Smoother
+{
+    Jacobi      = 0,
+    GaussSeidel = 1,
+    Chebyshev   = 2,
+};
+
+inline Smoother string_to_smoother(std::string smoother)
+{
+    std::transform(smoother.begin(),
+                   smoother.end(),
+                   smoother.begin(),
+                   [](unsigned char c) { return std::tolower(c); });
+
+    if (smoother == "gs") {
+        return Smoother::GaussSeidel;
+    } else if (smoother == "chebyshev") {
+        return Smoother::Chebyshev;
+    } else {
+        if (smoother != "jacobi") {
+            RXMESH_WARN(
+                "string_to_smoother() unknown smoother {}, using jacobi",
+                smoother);
+        }
+        return Smoother::Jacobi;
+    }
+}
+
+/**
+ * @brief parse a comma-separated list of smoothers (one per level starting
+ * from the fine level) e.g., "gs,gs,chebyshev"
+ */
+inline std::vector<Smoother> string_to_smoothers(const std::string& smoothers)
+{
+    std::vector<Smoother> ret;
+    std::stringstream     ss(smoothers);
+    std::string           s;
+    while (std::getline(ss, s, ',')) {
+        ret.push_back(string_to_smoother(s));
+    }
+    return ret;
+}
+
+/**
+ * @brief the smoother of one level of the V-cycle. The smoothers that depend
+ * on the matrix (Gauss-Seidel coloring and Chebyshev eigenvalue estimation)
+ * are set up in setup()
+ */
+template <typename T>
+struct GMGSmoother
+{
+    Smoother             m_type;
+    JacobiSolver<T>      m_jacobi;
+    GaussSeidelSolver<T> m_gs;
+    ChebyshevSolver<T>   m_chebyshev;
+
+    __host__ GMGSmoother() : m_type(Smoother::Jacobi)
+    {
+    }
+
+    __host__ GMGSmoother(Smoother type, int num_rows, int num_cols)
+        : m_type(type)
+    {
+        if (m_type == Smoother::Jacobi) {
+            m_jacobi = JacobiSolver<T>(num_rows, num_cols);
+        } else if (m_type == Smoother::Chebyshev) {
+            m_chebyshev = ChebyshevSolver<T>(num_rows, num_cols);
+        }
+    }
+
+    /**
+     * @brief set up the smoother for A. If only the values of A changed (and
+     * not its sparsity), the Gauss-Seidel coloring is reused
+     */
+    __host__ void setup(const SparseMatrix<T>& A, bool sparsity_changed = true)
+    {
+        if (m_type == Smoother::GaussSeidel) {
+            if (sparsity_changed || m_gs.m_num_rows != A.rows()) {
+                int num_colors = m_gs.setup(A);
+                RXMESH_INFO(
+                    "GMGSmoother::setup() Gauss-Seidel with {} colors for {} "
+                    "rows",
+                    num_colors,
+                    A.rows());
+            }
+        } else if (m_type == Smoother::Chebyshev) {
+            m_chebyshev.setup(A);
+        }
+    }
+
+    template <int numCol>
+    __host__ void solve(const SparseMatrix<T>& A,
+                        const DenseMatrix<T>&  b,
+                        DenseMatrix<T>&        x,
+                        int                    num_iter,
+                        bool                   reverse = false)
+    {
+        if (m_type == Smoother::Jacobi) {
+            m_jacobi.template solve<numCol>(A, b, x, num_iter);
+        } else if (m_type == Smoother::GaussSeidel) {
+            m_gs.template solve<numCol>(A, b, x, num_iter, reverse);
+        } else if (m_type == Smoother::Chebyshev) {
+            m_chebyshev.template solve<numCol>(A, b, x, num_iter);
+        }
+    }
+};
+}  // namespace rxmesh
@@ -1,10 +1,12 @@
 #pragma once
 
+#include <cstring>
+
 #include "rxmesh/matrix/gmg/gmg.h"
 
 #include "rxmesh/matrix/cholesky_solver.h"
 #include "rxmesh/matrix/cudss_cholesky_solver.h"
-#include "rxmesh/matrix/gmg/jacobi_solver.h"
+#include "rxmesh/matrix/gmg/smoother.h"
 
 namespace rxmesh {
 
@@ -69,6 +71,7 @@ struct VCycle
     int   m_num_pre_relax;
     int   m_num_post_relax;
     float memory_alloc_time = 0;
+    float ptap_time         = 0;
 
     // For index, the fine mesh is always indexed with 0
     // The first coarse level index is 1
@@ -82,13 +85,17 @@ struct VCycle
 
     std::vector<CoarseA<T>> m_a;  // levels
 
-    // TODO abstract away the solver type
-    std::vector<JacobiSolver<T>> m_smoother;  // fine + levels
+    // transpose of the prolongation operators (computed once)
+    std::vector<SparseMatrix<T>> m_prolong_t;  // levels
+
+    std::vector<GMGSmoother<T>> m_smoother;  // fine + levels
 
     CoarseSolver m_coarse_solver_type;
 
     JacobiSolver<T> m_coarse_solver_jacobi;
 
+    GaussSeidelSolver<T> m_coarse_solver_gs;
+
 #ifdef USE_CUDSS
     std::unique_ptr<cuDSSCholeskySolver<SparseMatrix<T>, Eigen::ColMajor>>
         m_coarse_solver_cudss_chols;
@@ -97,13 +104,19 @@ struct VCycle
     std::unique_ptr<CholeskySolver<SparseMatrix<T>, Eigen::ColMajor>>
         m_coarse_solver_chols;
 
-    VCycle(GMG<T>&          gmg,
-           RXMeshStatic&    rx,
-           SparseMatrix<T>& A,
-           int              num_cols,
-           CoarseSolver     coarse_solver  = CoarseSolver::Jacobi,
-           int              num_pre_relax  = 2,
-           int              num_post_relax = 2)
+    /**
+     * @brief allocate the V-cycle memory. smoothers is the smoother of every
+     * level starting from the fine level where the last one is used for the
+     * remaining levels (default is Jacobi on all levels)
+     */
+    VCycle(GMG<T>&               gmg,
+           RXMeshStatic&         rx,
+           SparseMatrix<T>&      A,
+           int                   num_cols,
+           CoarseSolver          coarse_solver  = CoarseSolver::Jacobi,
+           int                   num_pre_relax  = 2,
+           int                   num_post_relax = 2,
+           std::vector<Smoother> smoothers      = {Smoother::Jacobi})
         : m_coarse_solver_type(coarse_solver),
           m_num_pre_relax(num_pre_relax),
           m_num_post_relax(num_post_relax),
@@ -121,7 +134,8 @@ struct VCycle
         timer.start();
 
         // allocate memory for coarsened LHS and RHS
-        m_smoother.emplace_back(gmg.m_num_samples[0], num_cols);
+        m_smoother.emplace_back(
+            level_smoother(smoothers, 0), gmg.m_num_samples[0], num_cols);
 
         m_r.emplace_back(rx, gmg.m_num_samples[0], num_cols);
 
@@ -138,14 +152,24 @@ struct VCycle
             gmg.m_prolong_op[l - 1].alloc_multiply_buffer(m_r.back(),
                                                           m_rhs[l - 1]);
 
+            // the prolongation has a fixed number of non-zeros per row and
+            // so it uses the coalesced SELL SpMV
+            gmg.m_prolong_op[l - 1].enable_sell();
+
             if (l < gmg.m_num_levels - 1) {
-                m_smoother.emplace_back(gmg.m_num_samples[l], num_cols);
+                m_smoother.emplace_back(level_smoother(smoothers, l),
+                                        gmg.m_num_samples[l],
+                                        num_cols);
             } else {
                 // coarsest level
 
                 if (m_coarse_solver_type == CoarseSolver::Jacobi) {
                     m_coarse_solver_jacobi =
                         JacobiSolver<T>(gmg.m_num_samples[l], num_cols);
+                } else if (m_coarse_solver_type ==
+                           CoarseSolver::GaussSeidel) {
+                    // the coloring requires the coarsest A matrix, so we
+                    // initialize it during coarser_systems()
                 } else if (m_coarse_solver_type == CoarseSolver::Cholesky ||
                            m_coarse_solver_type ==
                                CoarseSolver::cuDSSCholesky) {
@@ -181,11 +205,127 @@ struct VCycle
 
         timer.stop();
         gtimer.stop();
+        ptap_time = std::max(timer.elapsed_millis(), gtimer.elapsed_millis());
         RXMESH_INFO(
             "VCycle::coarser_systems() all_Pt_A_P took {} (ms), {} (ms)",
             timer.elapsed_millis(),
             gtimer.elapsed_millis());
 
+        init_coarse_solver(rx);
+
+        setup_smoothers(A, true);
+    }
+
+    /**
+     * @brief the smoother of level l given the user smoothers
+     */
+    static Smoother level_smoother(const std::vector<Smoother>& smoothers,
+                                   int                          l)
+    {
+        if (smoothers.empty()) {
+            return Smoother::Jacobi;
+        }
+        return smoothers[std::min(l, int(smoothers.size()) - 1)];
+    }
+
+    /**
+     * @brief set up the smoothers (and the Gauss-Seidel coarse solver) with
+     * the matrix of every level. With sparsity_changed=false, only the values
+     * of the matrices changed
+     */
+    void setup_smoothers(SparseMatrix<T>& A, bool sparsity_changed)
+    {
+        for (size_t l = 0; l < m_smoother.size(); ++l) {
+            m_smoother[l].setup(l == 0 ? A : m_a[l - 1].a, sparsity_changed);
+        }
+
+        if (m_coarse_solver_type == CoarseSolver::GaussSeidel &&
+            (sparsity_changed ||
+             m_coarse_solver_gs.m_num_rows != m_a.back().a.rows())) {
+            m_coarse_solver_gs.setup(m_a.back().a);
+        }
+    }
+
+    /**
+     * @brief update the coarse (Galerkin) operators after the values of the
+     * fine matrix A changed but not its sparsity. The hierarchy (samples and
+     * prolongation operators) and the V-cycle memory are reused, and the
+     * coarse operators are updated in place so that the coarsest level direct
+     * solver only refactorizes
+     */
+    void update_coarser_systems(GMG<T>&          gmg,
+                                RXMeshStatic&    rx,
+                                SparseMatrix<T>& A)
+    {
+        CPUTimer timer;
+        GPUTimer gtimer;
+        timer.start();
+        gtimer.start();
+
+        std::vector<CoarseA<T>> old_a = m_a;
+
+        all_Pt_A_P(gmg, A);
+
+        bool sparsity_changed = false;
+
+        for (size_t l = 0; l < m_a.size(); ++l) {
+            SparseMatrix<T>& new_a = m_a[l].a;
+            SparseMatrix<T>& pre_a = old_a[l].a;
+
+            if (new_a.rows() != pre_a.rows() ||
+                new_a.non_zeros() != pre_a.non_zeros()) {
+                release_coarse_a(pre_a);
+                sparsity_changed = true;
+                continue;
+            }
+
+            CUDA_ERROR(cudaMemcpy(pre_a.val_ptr(DEVICE),
+                                  new_a.val_ptr(DEVICE),
+                                  new_a.non_zeros() * sizeof(T),
+                                  cudaMemcpyDeviceToDevice));
+            std::memcpy(pre_a.val_ptr(HOST),
+                        new_a.val_ptr(HOST),
+                        new_a.non_zeros() * sizeof(T));
+
+            release_coarse_a(new_a);
+            m_a[l] = old_a[l];
+        }
+
+        timer.stop();
+        gtimer.stop();
+        ptap_time = std::max(timer.elapsed_millis(), gtimer.elapsed_millis());
+        RXMESH_INFO(
+            "VCycle::update_coarser_systems() all_Pt_A_P took {} (ms), {} "
+            "(ms)",
+            timer.elapsed_millis(),
+            gtimer.elapsed_millis());
+
+        setup_smoothers(A, sparsity_changed);
+
+        if (sparsity_changed) {
+            init_coarse_solver(rx);
+            return;
+        }
+
+        // refactorize the coarsest level with the updated values
+        if (m_coarse_solver_type == CoarseSolver::Cholesky) {
+            m_coarse_solver_chols->pre_solve(rx);
+        } else if (m_coarse_solver_type == CoarseSolver::cuDSSCholesky) {
+#ifdef USE_CUDSS
+            m_coarse_solver_cudss_chols->pre_solve(
+                rx, m_rhs.back(), m_x.back());
+#endif
+        }
+    }
+
+    /**
+     * @brief (re-)create the coarsest level direct solver
+     */
+    void init_coarse_solver(RXMeshStatic& rx)
+    {
+        CPUTimer timer;
+        GPUTimer gtimer;
+
         if (m_coarse_solver_type == CoarseSolver::Cholesky) {
 
             timer.start();
@@ -199,8 +339,8 @@ struct VCycle
             timer.stop();
             gtimer.stop();
             RXMESH_INFO(
-                "VCycle::coarser_systems() Cholesky pre_solver took {} (ms), "
-                "{} (ms)",
+                "VCycle::init_coarse_solver() Cholesky pre_solver took {} "
+                "(ms), {} (ms)",
                 timer.elapsed_millis(),
                 gtimer.elapsed_millis());
         } else if (m_coarse_solver_type == CoarseSolver::cuDSSCholesky) {
@@ -217,8 +357,8 @@ struct VCycle
             timer.stop();
             gtimer.stop();
             RXMESH_INFO(
-                "VCycle::coarser_systems() cuDSS Cholesky pre_solver took {} "
-                "(ms), {} (ms)",
+                "VCycle::init_coarse_solver() cuDSS Cholesky pre_solver took "
+                "{} (ms), {} (ms)",
                 timer.elapsed_millis(),
                 gtimer.elapsed_millis());
 #endif
@@ -232,15 +372,49 @@ struct VCycle
     virtual void all_Pt_A_P(GMG<T>& gmg, SparseMatrix<T>& A)
     {
         // construct m_a for all levels
-        Pt_A_P(gmg.m_prolong_op[0], A, m_a[0]);
+        Pt_A_P(gmg.m_prolong_op[0], prolong_transpose(gmg, 0), A, m_a[0]);
         for (int l = 1; l < gmg.m_num_levels - 1; ++l) {
-            Pt_A_P(gmg.m_prolong_op[l], m_a[l - 1].a, m_a[l]);
+            Pt_A_P(gmg.m_prolong_op[l],
+                   prolong_transpose(gmg, l),
+                   m_a[l - 1].a,
+                   m_a[l]);
         }
     }
 
+    /**
+     * @brief the transpose of the prolongation operator of level l. The
+     * transposes are computed once and reused by every (re-)construction of
+     * the coarse operators
+     */
+    SparseMatrix<T>& prolong_transpose(GMG<T>& gmg, int l)
+    {
+        if (m_prolong_t.size() != gmg.m_prolong_op.size()) {
+            for (auto& pt : m_prolong_t) {
+                pt.release();
+            }
+            m_prolong_t.clear();
+            for (auto& p : gmg.m_prolong_op) {
+                m_prolong_t.push_back(p.transpose(DEVICE));
+            }
+        }
+        return m_prolong_t[l];
+    }
+
     void Pt_A_P(SparseMatrixConstantNNZRow<T, 3>& P,
                 SparseMatrix<T>&                  A,
                 CoarseA<T>&                       C)
+    {
+        SparseMatrix<T> Pt = P.transpose(DEVICE);
+
+        Pt_A_P(P, Pt, A, C);
+
+        Pt.release();
+    }
+
+    void Pt_A_P(SparseMatrixConstantNNZRow<T, 3>& P,
+                SparseMatrix<T>&                  Pt,
+                SparseMatrix<T>&                  A,
+                CoarseA<T>&                       C)
     {
         // S = transpose(P) * A
         // C = S * A
@@ -249,8 +423,6 @@ struct VCycle
         cusparseSpGEMMDescr_t spgemmDesc;
         CUSPARSE_ERROR(cusparseSpGEMM_createDescr(&spgemmDesc));
 
-        SparseMatrix<T> Pt = P.transpose();
-
         cusparseSpMatDescr_t S_spmat;
         cusparseSpMatDescr_t C_spmat;
 
@@ -350,7 +522,6 @@ struct VCycle
                               C.h_val);
 
         // clean up
-        Pt.release();
         GPU_FREE(s_rowPtr);
         GPU_FREE(s_colIdx);
         GPU_FREE(s_values);
@@ -360,6 +531,29 @@ struct VCycle
         CUSPARSE_ERROR(cusparseSpGEMM_destroyDescr(spgemmDesc));
     }
 
+    /**
+     * @brief release a coarse operator created by Pt_A_P() whose memory is
+     * managed by the V-cycle
+     */
+    void release_coarse_a(SparseMatrix<T>& a)
+    {
+        int* d_row_ptr = a.row_ptr(DEVICE);
+        int* d_col_idx = a.col_idx(DEVICE);
+        T*   d_val     = a.val_ptr(DEVICE);
+        int* h_row_ptr = a.row_ptr(HOST);
+        int* h_col_idx = a.col_idx(HOST);
+        T*   h_val     = a.val_ptr(HOST);
+
+        a.release();
+
+        GPU_FREE(d_row_ptr);
+        GPU_FREE(d_col_idx);
+        GPU_FREE(d_val);
+        free(h_row_ptr);
+        free(h_col_idx);
+        free(h_val);
+    }
+
     /**
      * @brief run the solver.
      */
@@ -391,7 +585,8 @@ struct VCycle
 
         if (level < gmg.m_num_levels - 1) {
             // pre-smoothing
-            m_smoother[level].template solve<numCols>(A, f, v, m_num_pre_relax);
+            m_smoother[level].template solve<numCols>(
+                A, f, v, m_num_pre_relax, false);
 
             // calc residual
             calc_residual<numCols>(A, v, f, m_r[level]);
@@ -405,18 +600,24 @@ struct VCycle
                 level + 1, gmg, m_a[level].a, m_rhs[level + 1], m_x[level], rx);
 
             // prolong
-            gmg.m_prolong_op[level].multiply(
-                m_x[level], v, false, false, T(1.0), T(1.0));
+            gmg.m_prolong_op[level].multiply_sell(
+                m_x[level], v, false, T(1.0), T(1.0));
 
 
-            // post-smoothing
+            // post-smoothing (in reverse order for Gauss-Seidel so that the
+            // V-cycle is symmetric)
             m_smoother[level].template solve<numCols>(
-                A, f, v, m_num_post_relax);
+                A, f, v, m_num_post_relax, true);
         } else {
             // the coarsest level
             if (m_coarse_solver_type == CoarseSolver::Jacobi) {
                 m_coarse_solver_jacobi.template solve<numCols>(
                     A, f, v, m_num_post_relax);
+            } else if (m_coarse_solver_type == CoarseSolver::GaussSeidel) {
+                m_coarse_solver_gs.template solve<numCols>(
+                    A, f, v, m_num_pre_relax, false);
+                m_coarse_solver_gs.template solve<numCols>(
+                    A, f, v, m_num_post_relax, true);
             } else if (m_coarse_solver_type == CoarseSolver::Cholesky) {
                 m_coarse_solver_chols->solve(f, v);
             } else if (m_coarse_solver_type == CoarseSolver::cuDSSCholesky) {
@@ -511,7 +712,8 @@ struct VCycle
                                           &bufferSize1,
                                           nullptr));
 
-        CUDA_ERROR(cudaMalloc(&dBuffer1, bufferSize1));
+        CUDA_ERROR(
+            tracked_malloc(&dBuffer1, bufferSize1, MemoryCategory::Solver));
 
         // Execute work estimation
         // inspect the matrices op(A) and B to understand the memory
@@ -547,7 +749,8 @@ struct VCycle
                                               spgemmDesc,
                                               &bufferSize2,
                                               nullptr));
-        CUDA_ERROR(cudaMalloc(&dBuffer2, bufferSize2));
+        CUDA_ERROR(
+            tracked_malloc(&dBuffer2, bufferSize2, MemoryCategory::Solver));
 
         // compute the intermediate product of A * B
         CUSPARSE_ERROR(cusparseSpGEMM_compute(handle,
@@ -572,9 +775,15 @@ struct VCycle
 
 
         // allocate matrix C
-        CUDA_ERROR(cudaMalloc(&c_rowPtr, (c_rows + 1) * sizeof(int)));
-        CUDA_ERROR(cudaMalloc(&c_colIdx, c_nnz * sizeof(int)));
-        CUDA_ERROR(cudaMalloc(&c_values, c_nnz * sizeof(T)));
+        CUDA_ERROR(tracked_malloc(&c_rowPtr,
+                                  (c_rows + 1) * sizeof(int),
+                                  MemoryCategory::Solver));
+        CUDA_ERROR(tracked_malloc(&c_colIdx,
+                                  c_nnz * sizeof(int),
+                                  MemoryCategory::Solver));
+        CUDA_ERROR(tracked_malloc(&c_values,
+                                  c_nnz * sizeof(T),
+                                  MemoryCategory::Solver));
 
         // update S_spmat with the new pointers
         CUSPARSE_ERROR(
@@ -14,28 +14,33 @@ struct VCyclePruned : public VCycle<T>
     size_t m_temp_storage_bytes = 0;
 
 
-    VCyclePruned(GMG<T>&          gmg,
-                 RXMeshStatic&    rx,
-                 SparseMatrix<T>& A,
-                 int              num_cols,
-                 CoarseSolver     coarse_solver  = CoarseSolver::Jacobi,
-                 int              num_pre_relax  = 2,
-                 int              num_post_relax = 2)
+    VCyclePruned(GMG<T>&               gmg,
+                 RXMeshStatic&         rx,
+                 SparseMatrix<T>&      A,
+                 int                   num_cols,
+                 CoarseSolver          coarse_solver  = CoarseSolver::Jacobi,
+                 int                   num_pre_relax  = 2,
+                 int                   num_post_relax = 2,
+                 std::vector<Smoother> smoothers      = {Smoother::Jacobi})
         : VCycle<T>(gmg,
                     rx,
                     A,
                     num_cols,
                     coarse_solver,
                     num_pre_relax,
-                    num_post_relax)
+                    num_post_relax,
+                    smoothers)
     {
         CPUTimer timer;
         timer.start();
 
+        CUDA_ERROR(tracked_malloc(&m_d_entries,
+                                  sizeof(int) * gmg.m_prolong_op[0].cols(),
+                                  MemoryCategory::Solver));
         CUDA_ERROR(
-            cudaMalloc(&m_d_entries, sizeof(int) * gmg.m_prolong_op[0].cols()));
-        CUDA_ERROR(cudaMalloc(&m_d_row_ptr,
-                              sizeof(int) * (gmg.m_prolong_op[0].cols() + 1)));
+            tracked_malloc(&m_d_row_ptr,
+                           sizeof(int) * (gmg.m_prolong_op[0].cols() + 1),
+                           MemoryCategory::Solver));
 
 
         cub::DeviceScan::ExclusiveSum(m_d_temp_storage,
@@ -44,7 +49,9 @@ struct VCyclePruned : public VCycle<T>
                                       m_d_row_ptr,
                                       gmg.m_prolong_op[0].cols() + 1);
 
-        CUDA_ERROR(cudaMalloc(&m_d_temp_storage, m_temp_storage_bytes));
+        CUDA_ERROR(tracked_malloc(&m_d_temp_storage,
+                                  m_temp_storage_bytes,
+                                  MemoryCategory::Solver));
 
         timer.stop();
         this->memory_alloc_time += timer.elapsed_millis();
@@ -117,7 +124,9 @@ struct VCyclePruned : public VCycle<T>
                               cudaMemcpyDeviceToHost));
 
         int* d_row_ptr;
-        CUDA_ERROR(cudaMalloc(&d_row_ptr, sizeof(int) * (num_rows + 1)));
+        CUDA_ERROR(tracked_malloc(&d_row_ptr,
+                                  sizeof(int) * (num_rows + 1),
+                                  MemoryCategory::Solver));
         CUDA_ERROR(cudaMemcpy(d_row_ptr,
                               d_row_ptr_tmp,
                               sizeof(int) * (num_rows + 1),
@@ -125,8 +134,11 @@ struct VCyclePruned : public VCycle<T>
 
         int* d_col_idx;
         T*   d_val;
-        CUDA_ERROR(cudaMalloc(&d_col_idx, h_nnz * sizeof(int)));
-        CUDA_ERROR(cudaMalloc(&d_val, h_nnz * sizeof(T)));
+        CUDA_ERROR(tracked_malloc(&d_col_idx,
+                                  h_nnz * sizeof(int),
+                                  MemoryCategory::Solver));
+        CUDA_ERROR(
+            tracked_malloc(&d_val, h_nnz * sizeof(T), MemoryCategory::Solver));
 
         // multiply
         for_each_item<<<blocks_new, blockThreads>>>(
@@ -278,7 +290,7 @@ struct VCyclePruned : public VCycle<T>
     {
         for (int i = 0; i < gmg.m_num_levels - 1; i++) {
             SparseMatrixConstantNNZRow<float, 3> p_const = gmg.m_prolong_op[i];
-            auto                                 p_t     = p_const.transpose();
+            SparseMatrix<T>& p_t = this->prolong_transpose(gmg, i);
             if (i == 0) {
                 Pt_A_P(p_const, p_t, this->m_a[i].a, A);
             } else {
@@ -43,7 +43,8 @@ struct GMGSolver : public IterativeSolver<T, DenseMatrix<T>>
           m_pruned_ptap(pruned_ptap),
           AX(DenseMatrix<T>(A.rows(), 1, DEVICE)),
           R(DenseMatrix<T>(A.rows(), 1, DEVICE)),
-          m_verify_ptap(verify_ptap)
+          m_verify_ptap(verify_ptap),
+          m_reuse_hierarchy(true)
     {
         if (m_coarse_solver == CoarseSolver::None) {
             RXMESH_ERROR("GMGSolver::GMGSolver() invalid coarse solver {}",
@@ -55,59 +56,15 @@ struct GMGSolver : public IterativeSolver<T, DenseMatrix<T>>
                            DenseMatrix<T>&       X,
                            cudaStream_t          stream = NULL) override
     {
-        CPUTimer timer;
-        GPUTimer gtimer;
-
-        // Construct GMG operator
-        timer.start();
-        gtimer.start();
-        m_gmg =
-            GMG<T>(*m_rx, m_num_levels, m_threshold, m_sampling, m_pruned_ptap);
-        timer.stop();
-        gtimer.stop();
-
-        RXMESH_INFO(
-            "GMGSolver::pre_solve() GMG construction took {} (ms), {} (ms)",
-            timer.elapsed_millis(),
-            gtimer.elapsed_millis());
-
-        m_num_levels = m_gmg.m_num_levels;
-
-
-        timer.start();
-        gtimer.start();
-
-        // Construct V-cycle
-        if (!m_pruned_ptap) {
-            m_v_cycle = std::make_unique<VCycle<T>>(m_gmg,
-                                                    *m_rx,
-                                                    *m_A,
-                                                    B.cols(),
-                                                    m_coarse_solver,
-                                                    m_num_pre_relax,
-                                                    m_num_post_relax);
-
-
+        if (m_v_cycle && m_reuse_hierarchy &&
+            m_gmg.m_num_rows == m_rx->get_num_vertices() &&
+            m_v_cycle->m_r[0].cols() == B.cols()) {
+            // only the values of A changed. Reuse the samples and
+            // prolongation operators and only rebuild the coarse operators
+            m_v_cycle->update_coarser_systems(m_gmg, *m_rx, *m_A);
         } else {
-            m_v_cycle = std::make_unique<VCyclePruned<T>>(m_gmg,
-                                                          *m_rx,
-                                                          *m_A,
-                                                          B.cols(),
-                                                          m_coarse_solver,
-                                                          m_num_pre_relax,
-                                                          m_num_post_relax);
+            build_hierarchy(B.cols());
         }
-        m_v_cycle->coarser_systems(m_gmg, *m_rx, *m_A);
-
-
-        timer.stop();
-        gtimer.stop();
-
-        RXMESH_INFO(
-            "GMGSolver::pre_solve(): V-cycle construction took {} (ms), {} "
-            "(ms)",
-            timer.elapsed_millis(),
-            gtimer.elapsed_millis());
 
         if (m_verify_ptap && m_pruned_ptap) {
             m_v_cycle->verify_coarse_system(m_gmg, *m_A);
@@ -122,6 +79,36 @@ struct GMGSolver : public IterativeSolver<T, DenseMatrix<T>>
         this->m_start_residual = m_v_cycle->m_r[0].norm2();
     }
 
+    /**
+     * @brief keep the hierarchy (samples and prolongation operators) across
+     * calls to pre_solve() so that only the coarse (Galerkin) operators are
+     * rebuilt when the values of the matrix change (default is true)
+     */
+    void set_reuse_hierarchy(bool reuse)
+    {
+        m_reuse_hierarchy = reuse;
+    }
+
+    /**
+     * @brief force the next pre_solve() to rebuild the hierarchy, e.g., after
+     * the mesh geometry changed significantly
+     */
+    void reset_hierarchy()
+    {
+        m_v_cycle.reset();
+    }
+
+    /**
+     * @brief the smoother of every level starting from the fine level where
+     * the last one is used for the remaining levels (default is Jacobi on all
+     * levels). The hierarchy is rebuilt with the new smoothers
+     */
+    void set_smoothers(const std::vector<Smoother>& smoothers)
+    {
+        m_smoothers = smoothers;
+        m_v_cycle.reset();
+    }
+
     void render_laplacian()
     {
 
@@ -134,7 +121,9 @@ struct GMGSolver : public IterativeSolver<T, DenseMatrix<T>>
 
             int* d_c;
             CUDA_ERROR(
-                cudaMalloc(&d_c, m_v_cycle->m_a[l - 1].a.rows() * sizeof(int)));
+                tracked_malloc(&d_c,
+                               m_v_cycle->m_a[l - 1].a.rows() * sizeof(int),
+                               MemoryCategory::Solver));
             auto a = m_v_cycle->m_a[l - 1].a;
             for_each_item<<<blocks_new, blockThreads>>>(
                 m_v_cycle->m_a[l - 1].a.rows(),
@@ -257,11 +246,117 @@ struct GMGSolver : public IterativeSolver<T, DenseMatrix<T>>
         return m_v_cycle->memory_alloc_time;
     }
 
+    /**
+     * @brief per-phase setup time (ms) of the hierarchy construction
+     */
+    float gmg_sampling_time() const
+    {
+        return m_gmg.sampling_time;
+    }
+
+    float gmg_clustering_time() const
+    {
+        return m_gmg.clustering_time;
+    }
+
+    float gmg_csr_time() const
+    {
+        return m_gmg.csr_time;
+    }
+
+    float gmg_prolongation_time() const
+    {
+        return m_gmg.prolongation_time;
+    }
+
+    /**
+     * @brief time (ms) of the last construction of the coarse (Galerkin)
+     * operators
+     */
+    float ptap_time() const
+    {
+        return m_v_cycle->ptap_time;
+    }
+
     virtual ~GMGSolver()
     {
     }
 
    protected:
+    /**
+     * @brief construct the GMG operator (sampling and prolongation) and the
+     * V-cycle along with the coarse operators
+     */
+    void build_hierarchy(int num_cols)
+    {
+        CPUTimer timer;
+        GPUTimer gtimer;
+
+        // Construct GMG operator
+        timer.start();
+        gtimer.start();
+        m_gmg =
+            GMG<T>(*m_rx, m_num_levels, m_threshold, m_sampling, m_pruned_ptap);
+        timer.stop();
+        gtimer.stop();
+
+        RXMESH_INFO(
+            "GMGSolver::pre_solve() GMG construction took {} (ms), {} (ms)",
+            timer.elapsed_millis(),
+            gtimer.elapsed_millis());
+
+        m_num_levels = m_gmg.m_num_levels;
+
+
+        timer.start();
+        gtimer.start();
+
+        // Construct V-cycle
+        if (!m_pruned_ptap) {
+            m_v_cycle = std::make_unique<VCycle<T>>(m_gmg,
+                                                    *m_rx,
+                                                    *m_A,
+                                                    num_cols,
+                                                    m_coarse_solver,
+                                                    m_num_pre_relax,
+                                                    m_num_post_relax,
+                                                    m_smoothers);
+
+
+        } else {
+            m_v_cycle = std::make_unique<VCyclePruned<T>>(m_gmg,
+                                                          *m_rx,
+                                                          *m_A,
+                                                          num_cols,
+                                                          m_coarse_solver,
+                                                          m_num_pre_relax,
+                                                          m_num_post_relax,
+                                                          m_smoothers);
+        }
+        m_v_cycle->coarser_systems(m_gmg, *m_rx, *m_A);
+
+
+        timer.stop();
+        gtimer.stop();
+
+        RXMESH_INFO(
+            "GMGSolver::pre_solve(): V-cycle construction took {} (ms), {} "
+            "(ms)",
+            timer.elapsed_millis(),
+            gtimer.elapsed_millis());
+
+        RXMESH_INFO(
+            "GMGSolver::pre_solve(): setup breakdown: memory allocation {} "
+            "(ms), sampling {} (ms), clustering {} (ms), CSR {} (ms), "
+            "prolongation {} (ms), PtAP {} (ms)",
+            m_gmg.memory_alloc_time + m_v_cycle->memory_alloc_time,
+            m_gmg.sampling_time,
+            m_gmg.clustering_time,
+            m_gmg.csr_time,
+            m_gmg.prolongation_time,
+            m_v_cycle->ptap_time);
+    }
+
     RXMeshStatic*              m_rx;
     SparseMatrix<T>*           m_A;
     GMG<T>                     m_gmg;
@@ -276,6 +371,8 @@ struct GMGSolver : public IterativeSolver<T, DenseMatrix<T>>
     DenseMatrix<T>             AX;
     DenseMatrix<T>             R;
     bool                       m_verify_ptap;
+    bool                       m_reuse_hierarchy;
+    std::vector<Smoother>      m_smoothers;
 };
 
 }  // namespace rxmesh
\ No newline at end of file
@@ -130,9 +130,11 @@ struct PatchKMeans
 
     /**
      * @brief partition the mesh into two parts of nearly equal size and with
+     * num_iter iterations of greedy graph growing
      */
     __device__ __inline__ void partition(
-        cooperative_groups::thread_block& block)
+        cooperative_groups::thread_block& block,
+        int                               num_iter = 10)
     {
 
 
@@ -148,7 +150,7 @@ struct PatchKMeans
                                                 m_s_next_frontier_v,
                                                 m_s_partition_a_v,
                                                 m_s_partition_b_v,
-                                                10);
+                                                num_iter);
 
 #ifndef NDEBUG
         for (int v = threadIdx.x; v < m_num_v; v += blockThreads) {
@@ -176,12 +178,18 @@ struct PatchKMeans
 
     /**
      * @brief implement FiducciaMattheyses (FM) refinement to reduce the edge
-     * cut
+     * cut. max_moves caps the number of FM moves (negative means no cap other
+     * than the number of active vertices and zero disables the refinement)
      */
     __device__ __inline__ void fm_refinement(
         cooperative_groups::thread_block& block,
-        float                             deviation_threshold = 0.1)
+        float                             deviation_threshold = 0.1,
+        int                               max_moves           = -1)
     {
+        if (max_moves == 0) {
+            return;
+        }
+
         m_s_v_locked.reset(block);
         fill_n<blockThreads>(m_s_max_gain_v, m_num_v, uint16_t(INVALID16));
         fill_n<blockThreads>(m_s_cum_gain, m_num_v, int16_t(0));
@@ -198,9 +206,12 @@ struct PatchKMeans
 
         num_active_vertices(block, num_active_v, num_a, num_b);
 
+        const int max_iter =
+            (max_moves < 0) ? num_active_v : std::min(max_moves, num_active_v);
+
         int iter = 0;
 
-        while (iter < num_active_v) {
+        while (iter < max_iter) {
 
             fill_n<blockThreads>(m_s_current_gain,
                                  m_num_v,
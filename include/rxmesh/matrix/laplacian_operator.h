@@ -0,0 +1,381 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string>
+
+#include "rxmesh/geometry_kernels.cuh"
+#include "rxmesh/matrix/dense_matrix.h"
+#include "rxmesh/matrix/sparse_matrix.h"
+#include "rxmesh/rxmesh_static.h"
+
+namespace rxmesh {
+
+/**
+ * @brief the lumped mass matrix used by LaplacianOperator
+ */
+enum class LaplacianMass
+{
+    // one third of the area of the incident faces
+    Barycentric = 0,
+    // the mixed Voronoi area (see GEOM_VORONOI_AREA)
+    Voronoi = 1,
+};
+
+namespace detail {
+/**
+ * @brief an order-independent fingerprint of the values of a vertex
+ * attribute. Used to detect that the coordinates have changed
+ */
+template <typename T>
+uint64_t attribute_fingerprint(const RXMeshStatic&       rx,
+                               const VertexAttribute<T>& attr)
+{
+    uint64_t* d_sum = nullptr;
+    CUDA_ERROR(tracked_malloc((void**)&d_sum,
+                              sizeof(uint64_t),
+                              MemoryCategory::Matrix));
+    CUDA_ERROR(cudaMemset(d_sum, 0, sizeof(uint64_t)));
+
+    const Context  context = rx.get_context();
+    const uint32_t num_att = attr.get_num_attributes();
+
+    rx.for_each_vertex(DEVICE, [=] __device__(const VertexHandle& vh) {
+        uint64_t h = (uint64_t(context.linear_id(vh)) + 1) *
+                     0x9E3779B97F4A7C15ull;
+        for (uint32_t i = 0; i < num_att; ++i) {
+            const T  val  = attr(vh, i);
+            uint64_t bits = 0;
+            memcpy(&bits, &val, sizeof(T) < 8 ? sizeof(T) : 8);
+            h ^= bits + 0x9E3779B97F4A7C15ull + (h << 6) + (h >> 2);
+        }
+        ::atomicAdd(reinterpret_cast<unsigned long long*>(d_sum),
+                    static_cast<unsigned long long>(h));
+    });
+
+    uint64_t ret = 0;
+    CUDA_ERROR(
+        cudaMemcpy(&ret, d_sum, sizeof(uint64_t), cudaMemcpyDeviceToHost));
+    GPU_FREE(d_sum);
+    return ret;
+}
+}  // namespace detail
+
+/**
+ * @brief the cotan Laplacian L (positive semi-definite i.e., L_ii is the sum
+ * of the weights of the edges incident to i and L_ij = -w_ij where w_ij is
+ * (cot(a) + cot(b))/2) and the (diagonal) lumped mass matrix M of a mesh,
+ * built once from the vertex coordinates. The operator is stored as one weight
+ * per edge and one mass per vertex from which (a*M + b*L) is either applied
+ * matrix-free (e.g., with CGMatFreeSolver through mat_vec()) or assembled into
+ * a SparseMatrix (e.g., for CholeskySolver) for any scalars a and b. Use
+ * get_laplacian_operator() to share one operator between the different stages
+ * of a pipeline. The operator does not track the coordinates on its own; call
+ * update() after changing them (which rebuilds the operator only if the
+ * coordinates actually changed)
+ */
+template <typename T>
+struct LaplacianOperator
+{
+    /**
+     * @brief build the operator
+     * @param rx the input mesh
+     * @param coords the vertex coordinates
+     * @param mass_type the lumped mass matrix
+     * @param clamp_negative if true, negative edge weights are set to zero
+     */
+    LaplacianOperator(
+        RXMeshStatic&             rx,
+        const VertexAttribute<T>& coords,
+        const LaplacianMass       mass_type      = LaplacianMass::Voronoi,
+        const bool                clamp_negative = false)
+        : m_rx(rx),
+          m_coords(coords),
+          m_mass_type(mass_type),
+          m_clamp_negative(clamp_negative),
+          m_fingerprint(0),
+          m_num_builds(0),
+          m_mat_mass_scale(0),
+          m_mat_lap_scale(0),
+          m_mat_build(0)
+    {
+        const std::string suffix = std::string(coords.get_name()) + "_" +
+                                   std::to_string(int(mass_type)) + "_" +
+                                   std::to_string(int(clamp_negative));
+
+        m_weight_name = "lapWeight_" + suffix;
+        m_mass_name   = "lapMass_" + suffix;
+
+        // computed on the device. The host copy is only updated by the
+        // caller (e.g., by moving a copy of weights() or mass())
+        m_weight = m_rx.add_edge_attribute<T>(m_weight_name, 1);
+        m_mass   = m_rx.add_vertex_attribute<T>(m_mass_name, 1);
+
+        rebuild();
+    }
+
+    LaplacianOperator(const LaplacianOperator&)            = delete;
+    LaplacianOperator& operator=(const LaplacianOperator&) = delete;
+
+    ~LaplacianOperator()
+    {
+        if (m_mat) {
+            m_mat->release();
+        }
+        m_rx.remove_attribute(m_weight_name);
+        m_rx.remove_attribute(m_mass_name);
+    }
+
+    /**
+     * @brief true if the coordinates have changed since the last build
+     */
+    bool is_stale() const
+    {
+        return detail::attribute_fingerprint(m_rx, m_coords) != m_fingerprint;
+    }
+
+    /**
+     * @brief rebuild the operator if the coordinates have changed
+     * @return true if the operator is rebuilt
+     */
+    bool update()
+    {
+        if (!is_stale()) {
+            return false;
+        }
+        rebuild();
+        return true;
+    }
+
+    /**
+     * @brief (re-)compute the edge weights and the vertex masses from the
+     * current coordinates
+     */
+    void rebuild()
+    {
+        constexpr geometryT quantities = GEOM_COTAN_WEIGHT | GEOM_VORONOI_AREA;
+
+        GeometryAttributes<T> geom =
+            compute_geometry<quantities, T>(m_rx, m_coords);
+
+        const EdgeAttribute<T>   g_weight = *geom.cotan_weight;
+        const VertexAttribute<T> g_area   = *geom.voronoi_area;
+        EdgeAttribute<T>         weight   = *m_weight;
+        VertexAttribute<T>       mass     = *m_mass;
+        const bool               clamp    = m_clamp_negative;
+
+        m_rx.for_each_edge(DEVICE,
+                           [=] __device__(const EdgeHandle& eh) mutable {
+                               const T w  = g_weight(eh);
+                               weight(eh) = (clamp && w < T(0)) ? T(0) : w;
+                           });
+
+        if (m_mass_type == LaplacianMass::Voronoi) {
+            m_rx.for_each_vertex(
+                DEVICE, [=] __device__(const VertexHandle& vh) mutable {
+                    mass(vh) = g_area(vh);
+                });
+        } else {
+            const VertexAttribute<T> coords = m_coords;
+            mass.reset(0, DEVICE);
+            m_rx.run_query_kernel<Op::FV, 256>(
+                [=] __device__(const FaceHandle&     fh,
+                               const VertexIterator& fv) mutable {
+                    const T a = tri_area(coords.template to_glm<3>(fv[0]),
+                                         coords.template to_glm<3>(fv[1]),
+                                         coords.template to_glm<3>(fv[2])) /
+                                T(3);
+                    for (int i = 0; i < 3; ++i) {
+                        ::atomicAdd(&mass(fv[i]), a);
+                    }
+                });
+        }
+
+        CUDA_ERROR(cudaDeviceSynchronize());
+        m_rx.remove_attribute("geomCotanWeight");
+        m_rx.remove_attribute("geomVoronoiArea");
+
+        m_fingerprint = detail::attribute_fingerprint(m_rx, m_coords);
+        m_num_builds++;
+    }
+
+    /**
+     * @brief the number of times the operator has been (re-)built
+     */
+    uint32_t num_builds() const
+    {
+        return m_num_builds;
+    }
+
+    /**
+     * @brief the cotan weight w_ij of every edge
+     */
+    const EdgeAttribute<T>& weights() const
+    {
+        return *m_weight;
+    }
+
+    /**
+     * @brief the diagonal of the lumped mass matrix
+     */
+    const VertexAttribute<T>& mass() const
+    {
+        return *m_mass;
+    }
+
+    /**
+     * @brief out = (mass_scale * M + lap_scale * L) * in where every column of
+     * in and out is one vector
+     */
+    void apply(const DenseMatrix<T>& in,
+               DenseMatrix<T>&       out,
+               const T               mass_scale = T(0),
+               const T               lap_scale  = T(1),
+               cudaStream_t          stream     = NULL) const
+    {
+        const EdgeAttribute<T>   weight = *m_weight;
+        const VertexAttribute<T> mass   = *m_mass;
+        const int                cols   = in.cols();
+
+        m_rx.for_each_vertex(
+            DEVICE,
+            [=] __device__(const VertexHandle& vh) mutable {
+                const T m = mass_scale * mass(vh);
+                for (int c = 0; c < cols; ++c) {
+                    out(vh, c) = m * in(vh, c);
+                }
+            },
+            stream);
+
+        m_rx.run_query_kernel<Op::EV, 256>(
+            [=] __device__(const EdgeHandle&     eh,
+                           const VertexIterator& ev) mutable {
+                const T w = lap_scale * weight(eh);
+                for (int c = 0; c < cols; ++c) {
+                    const T d = w * (in(ev[0], c) - in(ev[1], c));
+                    ::atomicAdd(&out(ev[0], c), d);
+                    ::atomicAdd(&out(ev[1], c), -d);
+                }
+            },
+            false,
+            stream);
+    }
+
+    /**
+     * @brief the matrix-free apply of (mass_scale * M + lap_scale * L) in the
+     * form expected by CGMatFreeSolver::m_mat_vec. The returned function
+     * refers to this operator
+     */
+    std::function<void(const DenseMatrix<T>&, DenseMatrix<T>&, cudaStream_t)>
+    mat_vec(const T mass_scale = T(0), const T lap_scale = T(1)) const
+    {
+        return [this, mass_scale, lap_scale](const DenseMatrix<T>& in,
+                                             DenseMatrix<T>&       out,
+                                             cudaStream_t          stream) {
+            apply(in, out, mass_scale, lap_scale, stream);
+        };
+    }
+
+    /**
+     * @brief assemble (mass_scale * M + lap_scale * L) into mat which should
+     * have the VV sparsity (e.g., SparseMatrix<T>(rx)). The values are
+     * written on the device
+     */
+    void assemble(SparseMatrix<T>& mat,
+                  const T          mass_scale = T(0),
+                  const T          lap_scale  = T(1)) const
+    {
+        const EdgeAttribute<T>   weight = *m_weight;
+        const VertexAttribute<T> mass   = *m_mass;
+
+        mat.reset(0, DEVICE);
+
+        m_rx.for_each_vertex(DEVICE,
+                             [=] __device__(const VertexHandle& vh) mutable {
+                                 mat(vh, vh) = mass_scale * mass(vh);
+                             });
+
+        m_rx.run_query_kernel<Op::EV, 256>(
+            [=] __device__(const EdgeHandle&     eh,
+                           const VertexIterator& ev) mutable {
+                const T w = lap_scale * weight(eh);
+
+                mat(ev[0], ev[1]) = -w;
+                mat(ev[1], ev[0]) = -w;
+                ::atomicAdd(&mat(ev[0], ev[0]), w);
+                ::atomicAdd(&mat(ev[1], ev[1]), w);
+            });
+    }
+
+    /**
+     * @brief the assembled (mass_scale * M + lap_scale * L) owned by the
+     * operator. It is only re-assembled if the operator is rebuilt or the
+     * scalars change
+     */
+    SparseMatrix<T>& matrix(const T mass_scale = T(0),
+                            const T lap_scale  = T(1))
+    {
+        if (!m_mat) {
+            m_mat = std::make_unique<SparseMatrix<T>>(m_rx);
+        } else if (m_mat_build == m_num_builds &&
+                   m_mat_mass_scale == mass_scale &&
+                   m_mat_lap_scale == lap_scale) {
+            return *m_mat;
+        }
+        assemble(*m_mat, mass_scale, lap_scale);
+        m_mat_build      = m_num_builds;
+        m_mat_mass_scale = mass_scale;
+        m_mat_lap_scale  = lap_scale;
+        return *m_mat;
+    }
+
+   private:
+    RXMeshStatic&                       m_rx;
+    const VertexAttribute<T>            m_coords;
+    LaplacianMass                       m_mass_type;
+    bool                                m_clamp_negative;
+    std::string                         m_weight_name;
+    std::string                         m_mass_name;
+    std::shared_ptr<EdgeAttribute<T>>   m_weight;
+    std::shared_ptr<VertexAttribute<T>> m_mass;
+    uint64_t                            m_fingerprint;
+    uint32_t                            m_num_builds;
+    std::unique_ptr<SparseMatrix<T>>    m_mat;
+    T                                   m_mat_mass_scale;
+    T                                   m_mat_lap_scale;
+    uint32_t                            m_mat_build;
+};
+
+/**
+ * @brief return the LaplacianOperator of the coordinates attached to rx (see
+ * RXMeshStatic::set_user_cache()). The operator is built on the first call and
+ * shared by all later calls with the same coordinates attribute, mass type and
+ * clamping. If the coordinates have changed since it was built, the operator
+ * is rebuilt before it is returned
+ */
+template <typename T>
+std::shared_ptr<LaplacianOperator<T>> get_laplacian_operator(
+    RXMeshStatic&             rx,
+    const VertexAttribute<T>& coords,
+    const LaplacianMass       mass_type      = LaplacianMass::Voronoi,
+    const bool                clamp_negative = false)
+{
+    const std::string name = "LaplacianOperator_" +
+                             std::string(coords.get_name()) + "_" +
+                             std::to_string(sizeof(T)) + "_" +
+                             std::to_string(int(mass_type)) + "_" +
+                             std::to_string(int(clamp_negative));
+
+    auto op = rx.get_user_cache<LaplacianOperator<T>>(name);
+    if (op) {
+        op->update();
+        return op;
+    }
+
+    op = std::make_shared<LaplacianOperator<T>>(
+        rx, coords, mass_type, clamp_negative);
+    rx.set_user_cache(name, op);
+    return op;
+}
+
+}  // namespace rxmesh
@@ -93,8 +93,9 @@ inline void mgnd_permute(const RXMeshStatic& rx, int* h_permute)
     // auto v_ordering = *rx.add_vertex_attribute<uint32_t>("v_ordering", 1);
 
     int* d_permute = nullptr;
-    CUDA_ERROR(
-        cudaMalloc((void**)&d_permute, rx.get_num_vertices() * sizeof(int)));
+    CUDA_ERROR(tracked_malloc((void**)&d_permute,
+                              rx.get_num_vertices() * sizeof(int),
+                              MemoryCategory::Solver));
 
     uint32_t v_ordering_prefix_sum_size = rx.get_num_patches() + 2;
 
@@ -108,8 +109,9 @@ inline void mgnd_permute(const RXMeshStatic& rx, int* h_permute)
     // permutation)
     uint32_t* d_v_ordering_prefix_sum(nullptr);
 
-    CUDA_ERROR(cudaMalloc((void**)&d_v_ordering_prefix_sum,
-                          v_ordering_prefix_sum_size * sizeof(uint32_t)));
+    CUDA_ERROR(tracked_malloc((void**)&d_v_ordering_prefix_sum,
+                              v_ordering_prefix_sum_size * sizeof(uint32_t),
+                              MemoryCategory::Solver));
 
     CUDA_ERROR(cudaMemset(d_v_ordering_prefix_sum,
                           0,
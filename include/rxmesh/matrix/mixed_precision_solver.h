@@ -0,0 +1,333 @@
+#pragma once
+
+#include <memory>
+
+#include "rxmesh/kernels/util.cuh"
+#include "rxmesh/matrix/cholesky_solver.h"
+#include "rxmesh/matrix/dense_matrix.h"
+#include "rxmesh/matrix/solver_base.h"
+#include "rxmesh/matrix/sparse_matrix.h"
+
+namespace rxmesh {
+
+namespace detail {
+
+/**
+ * @brief d_dst[i] = DstT(d_src[i]) for i in [0, n)
+ */
+template <typename DstT, typename SrcT>
+inline void convert_precision(const SrcT*  d_src,
+                              DstT*        d_dst,
+                              uint32_t     n,
+                              cudaStream_t stream = NULL)
+{
+    constexpr uint32_t threads = 256;
+    const uint32_t     blocks  = DIVIDE_UP(n, threads);
+
+    for_each_item<<<blocks, threads, 0, stream>>>(
+        n, [=] __device__(int i) { d_dst[i] = static_cast<DstT>(d_src[i]); });
+}
+
+/**
+ * @brief d_dst[i] += DstT(d_src[i]) for i in [0, n)
+ */
+template <typename DstT, typename SrcT>
+inline void add_converted(const SrcT*  d_src,
+                          DstT*        d_dst,
+                          uint32_t     n,
+                          cudaStream_t stream = NULL)
+{
+    constexpr uint32_t threads = 256;
+    const uint32_t     blocks  = DIVIDE_UP(n, threads);
+
+    for_each_item<<<blocks, threads, 0, stream>>>(
+        n, [=] __device__(int i) { d_dst[i] += static_cast<DstT>(d_src[i]); });
+}
+
+/**
+ * @brief convert the device data of a dense matrix into another one with the
+ * same size but different precision
+ */
+template <typename DstT, typename SrcT, int Order>
+inline void convert_precision(const DenseMatrix<SrcT, Order>& src,
+                              DenseMatrix<DstT, Order>&       dst,
+                              cudaStream_t                    stream = NULL)
+{
+    assert(src.rows() == dst.rows() && src.cols() == dst.cols());
+    convert_precision(
+        src.data(DEVICE), dst.data(DEVICE), src.rows() * src.cols(), stream);
+}
+}  // namespace detail
+
+/**
+ * @brief a low-precision (e.g., float) copy of the values of a sparse matrix.
+ * The copy shares the sparsity pattern (row pointer and column index) of the
+ * source matrix and only stores its own values. Thus, the source matrix
+ * should outlive this copy. update() should be called every time the values
+ * of the source matrix change
+ */
+template <typename T, typename LowT = float>
+struct LowPrecisionSparseMatrix
+{
+    LowPrecisionSparseMatrix()
+        : m_src(nullptr), m_d_val(nullptr), m_h_val(nullptr)
+    {
+    }
+
+    void init(const SparseMatrix<T>& src)
+    {
+        release();
+
+        m_src = &src;
+
+        CUDA_ERROR(tracked_malloc((void**)&m_d_val,
+                                  src.non_zeros() * sizeof(LowT),
+                                  MemoryCategory::Solver));
+        m_h_val = static_cast<LowT*>(malloc(src.non_zeros() * sizeof(LowT)));
+
+        m_mat = SparseMatrix<LowT>(src.rows(),
+                                   src.cols(),
+                                   src.non_zeros(),
+                                   src.row_ptr(DEVICE),
+                                   src.col_idx(DEVICE),
+                                   m_d_val,
+                                   src.row_ptr(HOST),
+                                   src.col_idx(HOST),
+                                   m_h_val);
+    }
+
+    /**
+     * @brief convert the current (device) values of the source matrix
+     */
+    void update(cudaStream_t stream = NULL)
+    {
+        assert(m_src);
+        detail::convert_precision(
+            m_src->val_ptr(DEVICE), m_d_val, m_src->non_zeros(), stream);
+    }
+
+    SparseMatrix<LowT>& mat()
+    {
+        return m_mat;
+    }
+
+    bool is_initialized() const
+    {
+        return m_src != nullptr;
+    }
+
+    void release()
+    {
+        if (m_src) {
+            m_mat.release();
+            GPU_FREE(m_d_val);
+            free(m_h_val);
+            m_src = nullptr;
+        }
+    }
+
+   protected:
+    const SparseMatrix<T>* m_src;
+    SparseMatrix<LowT>     m_mat;
+    LowT*                  m_d_val;
+    LowT*                  m_h_val;
+};
+
+/**
+ * @brief mixed-precision Cholesky solver. The matrix is factorized in low
+ * precision (LowT, e.g., float) and the solution is then improved with
+ * iterative refinement in the precision of the matrix (e.g., double), i.e.,
+ *      r = b - A*x;   solve L*L^T*d = r in low precision;   x = x + d
+ * where the residual is computed in high precision. The refinement stops when
+ * the residual drops below the absolute or relative tolerance or after
+ * max_iter refinement steps. This recovers the accuracy of a double-precision
+ * solve (as long as the matrix is not too ill-conditioned for LowT) while
+ * paying for a single-precision factorization. The matrix is expected to be
+ * double (for float matrices, this reduces to a float Cholesky solve with
+ * iterative refinement in float)
+ */
+template <typename SpMatT, int DenseMatOrder = Eigen::ColMajor>
+struct MixedPrecisionCholeskySolver : public SolverBase<SpMatT, DenseMatOrder>
+{
+    using T    = typename SpMatT::Type;
+    using LowT = float;
+
+    using DenseMatT    = DenseMatrix<T, DenseMatOrder>;
+    using LowDenseMatT = DenseMatrix<LowT, DenseMatOrder>;
+    using LowSolverT   = CholeskySolver<SparseMatrix<LowT>, DenseMatOrder>;
+
+    MixedPrecisionCholeskySolver(SpMatT*       mat,
+                                 int           max_iter = 10,
+                                 T             abs_tol  = 1e-12,
+                                 T             rel_tol  = 1e-10,
+                                 PermuteMethod perm     = PermuteMethod::NSTDIS)
+        : SolverBase<SpMatT, DenseMatOrder>(mat),
+          m_max_iter(max_iter),
+          m_abs_tol(abs_tol),
+          m_rel_tol(rel_tol),
+          m_iter_taken(0),
+          m_start_residual(0),
+          m_final_residual(0)
+    {
+        m_low.init(*mat);
+        m_low_solver = std::make_unique<LowSolverT>(&m_low.mat(), perm);
+    }
+
+    virtual ~MixedPrecisionCholeskySolver()
+    {
+        m_low_solver.reset();
+        m_low.release();
+        release_buffers();
+    }
+
+    /**
+     * @brief convert the matrix to low precision and factorize it. Should be
+     * called every time the values of the matrix change. The symbolic
+     * analysis is done only on the first call
+     */
+    virtual void pre_solve(RXMeshStatic& rx) override
+    {
+        m_low.update();
+        m_low_solver->pre_solve(rx);
+    }
+
+    virtual void solve(DenseMatT&   B_mat,
+                       DenseMatT&   X_mat,
+                       cudaStream_t stream = NULL) override
+    {
+        // views of B and X with one row per row of the matrix, i.e., B and X
+        // are flattened if they store the unknowns of the same vertex in one
+        // row
+        DenseMatT B = B_mat;
+        DenseMatT X = X_mat;
+
+        if (this->m_mat->rows() != B.rows() ||
+            this->m_mat->cols() != X.rows()) {
+            if (this->m_mat->rows() != B.rows() * B.cols() ||
+                this->m_mat->cols() != X.rows() * X.cols()) {
+                RXMESH_ERROR(
+                    "MixedPrecisionCholeskySolver::solve() The sparse matrix "
+                    "size ({}, {}) does not match with the rhs size ({}, {}) "
+                    "and the unknown size ({}, {})",
+                    this->m_mat->rows(),
+                    this->m_mat->cols(),
+                    B_mat.rows(),
+                    B_mat.cols(),
+                    X_mat.rows(),
+                    X_mat.cols());
+                return;
+            }
+            B.reshape(B.rows() * B.cols(), 1);
+            X.reshape(X.rows() * X.cols(), 1);
+        }
+
+        alloc_buffers(B.rows(), B.cols());
+
+        const uint32_t n = B.rows() * B.cols();
+
+        X.reset(T(0), DEVICE, stream);
+        m_r.copy_from(B, DEVICE, DEVICE, stream);
+
+        m_start_residual = m_r.norm2(stream);
+        m_final_residual = m_start_residual;
+        m_iter_taken     = 0;
+
+        T prv_residual = m_start_residual;
+
+        while (m_iter_taken < m_max_iter &&
+               m_final_residual > m_abs_tol &&
+               m_final_residual > m_rel_tol * m_start_residual) {
+
+            // d = inv(L*L^T) * r in low precision
+            detail::convert_precision(m_r, m_r_low, stream);
+            m_d_low.reset(LowT(0), DEVICE, stream);
+            m_low_solver->solve(m_r_low, m_d_low, stream);
+
+            // x = x + d
+            detail::add_converted(
+                m_d_low.data(DEVICE), X.data(DEVICE), n, stream);
+
+            // r = b - A*x in high precision
+            m_r.copy_from(B, DEVICE, DEVICE, stream);
+            this->m_mat->multiply(X, m_r, false, false, T(-1), T(1), stream);
+
+            m_iter_taken++;
+            m_final_residual = m_r.norm2(stream);
+
+            if (m_final_residual > prv_residual) {
+                RXMESH_WARN(
+                    "MixedPrecisionCholeskySolver::solve() iterative "
+                    "refinement diverged at iteration {} (residual {} > {}). "
+                    "The matrix may be too ill-conditioned for the "
+                    "low-precision factorization",
+                    m_iter_taken,
+                    m_final_residual,
+                    prv_residual);
+                break;
+            }
+            prv_residual = m_final_residual;
+        }
+    }
+
+    virtual std::string name() override
+    {
+        return std::string("MixedPrecisionCholesky");
+    }
+
+    /**
+     * @brief the number of refinement steps taken by the last solve
+     */
+    int iter_taken() const
+    {
+        return m_iter_taken;
+    }
+
+    /**
+     * @brief the norm of the residual b - A*x at the start (x = 0) and the end
+     * of the last solve
+     */
+    T start_residual() const
+    {
+        return m_start_residual;
+    }
+
+    T final_residual() const
+    {
+        return m_final_residual;
+    }
+
+   protected:
+    void alloc_buffers(int rows, int cols)
+    {
+        if (m_r.rows() == rows && m_r.cols() == cols) {
+            return;
+        }
+        release_buffers();
+        m_r     = DenseMatT(rows, cols, DEVICE);
+        m_r_low = LowDenseMatT(rows, cols, DEVICE);
+        m_d_low = LowDenseMatT(rows, cols, DEVICE);
+    }
+
+    void release_buffers()
+    {
+        if (m_r.rows() > 0) {
+            m_r.release();
+            m_r_low.release();
+            m_d_low.release();
+            m_r     = DenseMatT();
+            m_r_low = LowDenseMatT();
+            m_d_low = LowDenseMatT();
+        }
+    }
+
+    LowPrecisionSparseMatrix<T, LowT> m_low;
+    std::unique_ptr<LowSolverT>       m_low_solver;
+    DenseMatT                         m_r;
+    LowDenseMatT                      m_r_low, m_d_low;
+    int                               m_max_iter;
+    T                                 m_abs_tol, m_rel_tol;
+    int                               m_iter_taken;
+    T                                 m_start_residual, m_final_residual;
+};
+
+}  // namespace rxmesh
@@ -1,14 +1,20 @@
 #pragma once
 #include <stdint.h>
+#include <cstring>
 #include <functional>
 #include <queue>
 #include <set>
 #include <vector>
 
+#include <thrust/execution_policy.h>
+#include <thrust/iterator/counting_iterator.h>
+#include <thrust/scatter.h>
+
 #include "rxmesh/rxmesh_static.h"
 
 #include "rxmesh/matrix/mgnd_permute.cuh"
 #include "rxmesh/matrix/patch_permute.cuh"
+#include "rxmesh/matrix/permute_method.h"
 #include "rxmesh/matrix/permute_util.h"
 
 #include "metis.h"
@@ -1062,8 +1068,51 @@ inline void create_dfs_indexing(const int                level,
     }
 }
 
-inline void single_patch_nd_permute(RXMeshStatic&              rx,
-                                    VertexAttribute<uint16_t>& v_local_permute)
+/**
+ * @brief knobs of the GPU nested dissection (GPUND) ordering that trade the
+ * ordering time for the quality (fill-in) of the ordering. The patches are the
+ * coarsest graph: the patch graph is recursively bisected (with METIS) to get
+ * the separators between patches, and the interior of every patch is then
+ * bisected on the GPU (one block per patch) with greedy graph growing followed
+ * by FM refinement of the in-patch separator
+ */
+struct NDPermuteOptions
+{
+    // number of greedy graph growing iterations of the in-patch bisection
+    int ggp_iter = 10;
+
+    // max number of FM moves that refine the in-patch separator. Negative
+    // means no cap (other than the number of vertices in the patch) and zero
+    // skips the refinement which is the fastest but gives the most fill
+    int fm_max_moves = -1;
+
+    // the max imbalance between the two sides of the in-patch bisection
+    // allowed during FM refinement
+    float fm_imbalance = 0.1f;
+
+    /**
+     * @brief combine the options into the hash h (e.g., the hash of the
+     * sparsity pattern used by PermuteCache)
+     */
+    uint64_t hash(uint64_t h) const
+    {
+        uint32_t imbalance_bits;
+        std::memcpy(&imbalance_bits, &fm_imbalance, sizeof(float));
+
+        for (uint64_t v : {uint64_t(uint32_t(ggp_iter)),
+                           uint64_t(uint32_t(fm_max_moves)),
+                           uint64_t(imbalance_bits)}) {
+            h ^= v;
+            h *= 1099511628211ull;
+        }
+        return h;
+    }
+};
+
+inline void single_patch_nd_permute(
+    RXMeshStatic&              rx,
+    VertexAttribute<uint16_t>& v_local_permute,
+    const NDPermuteOptions&    options = NDPermuteOptions())
 {
     CPUTimer timer;
     GPUTimer gtimer;
@@ -1144,7 +1193,10 @@ inline void single_patch_nd_permute(RXMeshStatic&              rx,
         },
         NULL,
         v_local_permute,
-        100);
+        100,
+        options.ggp_iter,
+        options.fm_max_moves,
+        options.fm_imbalance);
 
     // rx.run_kernel<blockThreads>(
     //     patch_permute_min_deg<blockThreads>,
@@ -1244,14 +1296,18 @@ inline void permute_separators(RXMeshStatic&              rx,
     int count_size = 1 << (depth + 1);
 
     int *d_dfs_index(nullptr), *d_count(nullptr);
-    CUDA_ERROR(cudaMalloc((void**)&d_dfs_index, sizeof(int) * count_size));
+    CUDA_ERROR(tracked_malloc((void**)&d_dfs_index,
+                              sizeof(int) * count_size,
+                              MemoryCategory::Solver));
 
     int* d_cut_size(nullptr);
     // CUDA_ERROR(cudaMalloc((void**)&d_cut_size, sizeof(int)));
     // CUDA_ERROR(cudaMemset(d_cut_size, 0, sizeof(int)));
 
 
-    CUDA_ERROR(cudaMalloc((void**)&d_count, sizeof(int) * (count_size + 1)));
+    CUDA_ERROR(tracked_malloc((void**)&d_count,
+                              sizeof(int) * (count_size + 1),
+                              MemoryCategory::Solver));
     CUDA_ERROR(cudaMemset(d_count, 0, sizeof(int) * count_size));
 
 
@@ -1393,29 +1449,42 @@ inline void permute_separators(RXMeshStatic&              rx,
     GPU_FREE(d_count);
 }
 
-inline void nd_permute(RXMeshStatic& rx, int* h_permute)
+/**
+ * @brief GPU nested dissection permutation that uses the patches as the
+ * coarsest graph (see NDPermuteOptions). h_permute should be allocated with
+ * size equal to num of vertices of the mesh
+ */
+/**
+ * @brief compute the GPUND permutation of the vertices into d_permute (of
+ * size #vertices on the device) where d_permute[i] is the vertex at position i
+ * in the new order. v_local_permute stores the in-patch permutation (see
+ * single_patch_nd_permute()) and v_index is a work space
+ */
+inline void nd_permute_device(RXMeshStatic&              rx,
+                              VertexAttribute<int>&      v_index,
+                              VertexAttribute<uint16_t>& v_local_permute,
+                              int*                       d_permute,
+                              const NDPermuteOptions&    options)
 {
-
-    auto v_index = *rx.add_vertex_attribute<int>("index", 1);
-
-    auto v_local_permute = *rx.add_vertex_attribute<uint16_t>("local_index", 1);
-
     // for a level L in the max_match_tree, d_patch_proj stores the node at
     // level L that branch off to a given patch, i.e., the projection of the
     // the patch on to level L in the tree
     int *d_patch_proj_l(nullptr), *d_patch_proj_l1(nullptr);
-    CUDA_ERROR(cudaMalloc((void**)&d_patch_proj_l,
-                          sizeof(int) * rx.get_num_patches()));
-    CUDA_ERROR(cudaMalloc((void**)&d_patch_proj_l1,
-                          sizeof(int) * rx.get_num_patches()));
+    CUDA_ERROR(tracked_malloc((void**)&d_patch_proj_l,
+                              sizeof(int) * rx.get_num_patches(),
+                              MemoryCategory::Solver));
+    CUDA_ERROR(tracked_malloc((void**)&d_patch_proj_l1,
+                              sizeof(int) * rx.get_num_patches(),
+                              MemoryCategory::Solver));
 
 
     // stores the edge weight of the patch graph
     int*     d_patch_graph_edge_weight = nullptr;
     uint32_t edge_weight_size  = PatchStash::stash_size * rx.get_num_patches();
     uint32_t edge_weight_bytes = sizeof(int) * edge_weight_size;
-    CUDA_ERROR(
-        cudaMalloc((void**)&d_patch_graph_edge_weight, edge_weight_bytes));
+    CUDA_ERROR(tracked_malloc((void**)&d_patch_graph_edge_weight,
+                              edge_weight_bytes,
+                              MemoryCategory::Solver));
     CUDA_ERROR(cudaMemset(d_patch_graph_edge_weight, 0, edge_weight_bytes));
 
     // stores the vertex weight of the patch graph
@@ -1423,19 +1492,15 @@ inline void nd_permute(RXMeshStatic& rx, int* h_permute)
 #ifdef USE_V_WEIGHTS
     uint32_t vertex_weight_size  = rx.get_num_patches();
     uint32_t vertex_weight_bytes = sizeof(int) * vertex_weight_size;
-    CUDA_ERROR(
-        cudaMalloc((void**)&d_patch_graph_vertex_weight, vertex_weight_bytes));
+    CUDA_ERROR(tracked_malloc((void**)&d_patch_graph_vertex_weight,
+                              vertex_weight_bytes,
+                              MemoryCategory::Solver));
     CUDA_ERROR(cudaMemset(d_patch_graph_vertex_weight, 0, vertex_weight_bytes));
 #endif
 
 
     std::vector<int> h_patch_graph_edge_weight(edge_weight_size, 0);
 
-    // the new index
-    int* d_permute = nullptr;
-    CUDA_ERROR(
-        cudaMalloc((void**)&d_permute, rx.get_num_vertices() * sizeof(int)));
-
     CPUTimer timer;
     GPUTimer gtimer;
 
@@ -1544,7 +1609,7 @@ inline void nd_permute(RXMeshStatic& rx, int* h_permute)
 
     compute_projection(max_match_tree);
 
-    single_patch_nd_permute(rx, v_local_permute);
+    single_patch_nd_permute(rx, v_local_permute, options);
 
     permute_separators(rx,
                        v_index,
@@ -1554,6 +1619,23 @@ inline void nd_permute(RXMeshStatic& rx, int* h_permute)
                        d_patch_proj_l,
                        d_patch_proj_l1);
 
+    // d_permute is the new index of every vertex. Invert it on the device
+    // (see inverse_permutation()) to get the vertex at every new position
+    const int num_v    = int(rx.get_num_vertices());
+    int*      d_helper = nullptr;
+    CUDA_ERROR(tracked_malloc(
+        (void**)&d_helper, num_v * sizeof(int), MemoryCategory::Solver));
+    thrust::scatter(thrust::device,
+                    thrust::make_counting_iterator<int>(0),
+                    thrust::make_counting_iterator<int>(num_v),
+                    d_permute,
+                    d_helper);
+    CUDA_ERROR(cudaMemcpy(d_permute,
+                          d_helper,
+                          num_v * sizeof(int),
+                          cudaMemcpyDeviceToDevice));
+    GPU_FREE(d_helper);
+
     timer.stop();
     gtimer.stop();
 
@@ -1561,21 +1643,136 @@ inline void nd_permute(RXMeshStatic& rx, int* h_permute)
                 timer.elapsed_millis(),
                 gtimer.elapsed_millis());
 
-    CUDA_ERROR(cudaMemcpy(h_permute,
-                          d_permute,
-                          rx.get_num_vertices() * sizeof(int),
-                          cudaMemcpyDeviceToHost));
-
-
-    std::vector<int> helper(rx.get_num_vertices());
-    inverse_permutation(rx.get_num_vertices(), h_permute, helper.data());
-
-    GPU_FREE(d_permute);
     GPU_FREE(d_patch_proj_l);
     GPU_FREE(d_patch_proj_l1);
     GPU_FREE(d_patch_graph_edge_weight);
     GPU_FREE(d_patch_graph_vertex_weight);
 }
 
+/**
+ * @brief the GPUND permutation of the vertices of a mesh as a product of the
+ * mesh (see get_nd_permutation()) such that every direct solver built on the
+ * mesh shares it instead of re-computing it. The in-patch (k-means) bisection
+ * of all patches, the separators permutation, and the inversion run on the
+ * device where the permutation is kept (along with a host copy)
+ */
+struct NDPermutation
+{
+    NDPermutation(RXMeshStatic& rx, const NDPermuteOptions& options)
+        : m_options(options),
+          m_num_vertices(rx.get_num_vertices()),
+          m_num_patches(rx.get_num_patches()),
+          m_d_permute(nullptr),
+          m_h_permute(rx.get_num_vertices())
+    {
+        const std::string suffix = "_" + std::to_string(options.hash(0));
+
+        m_local_permute =
+            rx.add_vertex_attribute<uint16_t>("ndLocalPermute" + suffix, 1);
+        auto v_index = rx.add_vertex_attribute<int>("ndIndex" + suffix, 1);
+
+        CUDA_ERROR(tracked_malloc((void**)&m_d_permute,
+                                  m_num_vertices * sizeof(int),
+                                  MemoryCategory::Solver));
+
+        nd_permute_device(
+            rx, *v_index, *m_local_permute, m_d_permute, options);
+
+        CUDA_ERROR(cudaMemcpy(m_h_permute.data(),
+                              m_d_permute,
+                              m_num_vertices * sizeof(int),
+                              cudaMemcpyDeviceToHost));
+
+        rx.remove_attribute(v_index->get_name());
+    }
+
+    NDPermutation(const NDPermutation&) = delete;
+
+    ~NDPermutation()
+    {
+        GPU_FREE(m_d_permute);
+    }
+
+    /**
+     * @brief the permutation (of size #vertices) on the host or the device
+     * where entry i is the vertex at position i in the new order
+     */
+    const int* get_permute(locationT location) const
+    {
+        return (location == DEVICE) ? m_d_permute : m_h_permute.data();
+    }
+
+    /**
+     * @brief the in-patch permutation of the vertices (on the device)
+     */
+    const VertexAttribute<uint16_t>& get_local_permute() const
+    {
+        return *m_local_permute;
+    }
+
+    const NDPermuteOptions& get_options() const
+    {
+        return m_options;
+    }
+
+    uint32_t get_num_vertices() const
+    {
+        return m_num_vertices;
+    }
+
+    uint32_t get_num_patches() const
+    {
+        return m_num_patches;
+    }
+
+   private:
+    NDPermuteOptions                           m_options;
+    uint32_t                                   m_num_vertices;
+    uint32_t                                   m_num_patches;
+    int*                                       m_d_permute;
+    std::vector<int>                           m_h_permute;
+    std::shared_ptr<VertexAttribute<uint16_t>> m_local_permute;
+};
+
+/**
+ * @brief return the GPUND permutation of the mesh cached with the mesh (see
+ * RXMeshStatic::set_user_cache()) under the permutation method, the number of
+ * patches, and the options. It is computed on the first call and shared by all
+ * later calls e.g., every CholeskySolver and cuDSSCholeskySolver built on the
+ * mesh with the same options
+ */
+inline std::shared_ptr<NDPermutation> get_nd_permutation(
+    RXMeshStatic&           rx,
+    const NDPermuteOptions& options = NDPermuteOptions())
+{
+    const std::string name =
+        "NDPermutation_" + permute_method_to_string(PermuteMethod::GPUND) +
+        "_" + std::to_string(rx.get_num_patches()) + "_" +
+        std::to_string(options.hash(0));
+
+    auto perm = rx.get_user_cache<NDPermutation>(name);
+    if (perm && perm->get_num_vertices() == rx.get_num_vertices()) {
+        return perm;
+    }
+
+    perm = std::make_shared<NDPermutation>(rx, options);
+    rx.set_user_cache(name, perm);
+    return perm;
+}
+
+/**
+ * @brief compute (or reuse, see get_nd_permutation()) the GPUND permutation
+ * of the vertices into h_permute (of size #vertices on the host)
+ */
+inline void nd_permute(RXMeshStatic&           rx,
+                       int*                    h_permute,
+                       const NDPermuteOptions& options = NDPermuteOptions())
+{
+    auto perm = get_nd_permutation(rx, options);
+    std::memcpy(h_permute,
+                perm->get_permute(HOST),
+                rx.get_num_vertices() * sizeof(int));
+}
+
 
 }  // namespace rxmesh
\ No newline at end of file
@@ -59,9 +59,13 @@ __global__ static void patch_permute_nd(Context              context,
 
 
 template <uint32_t blockThreads>
-__global__ static void patch_permute_kmeans(Context                   context,
-                                            VertexAttribute<uint16_t> v_permute,
-                                            int                       threshold)
+__global__ static void patch_permute_kmeans(
+    Context                   context,
+    VertexAttribute<uint16_t> v_permute,
+    int                       threshold,
+    int                       ggp_iter,
+    int                       fm_max_moves,
+    float                     fm_imbalance)
 {
     if (blockIdx.x >= context.get_num_patches()) {
         return;
@@ -80,9 +84,9 @@ __global__ static void patch_permute_kmeans(Context                   context,
     //     return;
     // }
 
-    pkm.partition(block);
+    pkm.partition(block, ggp_iter);
 
-    pkm.fm_refinement(block);
+    pkm.fm_refinement(block, fm_imbalance, fm_max_moves);
 
     pkm.extract_separator(block);
 
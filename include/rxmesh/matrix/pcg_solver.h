@@ -1,19 +1,28 @@
 #pragma once
+#include <functional>
+
+#include "rxmesh/matrix/cg_solver.h"
 #include "rxmesh/matrix/iterative_solver.h"
 
 #include "rxmesh/matrix/dense_matrix.h"
+#include "rxmesh/matrix/preconditioner.h"
 #include "rxmesh/matrix/sparse_matrix.h"
 
 namespace rxmesh {
 
 /**
- * @brief Jacobi-preconditioned CG
+ * @brief preconditioned CG. The default preconditioner is Jacobi. Other
+ * preconditioners (see PrecondType) can be selected with set_preconditioner()
  */
 template <typename T, int DenseMatOrder = Eigen::ColMajor>
 struct PCGSolver : public CGSolver<T, DenseMatOrder>
 {
     using DenseMatT = DenseMatrix<T, DenseMatOrder>;
 
+    using PrecondApplyFunc =
+        std::function<void(const DenseMatT&, DenseMatT&, cudaStream_t)>;
+    using PrecondSetupFunc = std::function<void(int, cudaStream_t)>;
+
     PCGSolver(SparseMatrix<T>& sys,
               int              unknown_dim,  // num rhs vectors
               int              max_iter,
@@ -25,8 +34,122 @@ struct PCGSolver : public CGSolver<T, DenseMatOrder>
                                      max_iter,
                                      abs_tol,
                                      rel_tol,
-                                     reset_residual_freq)
+                                     reset_residual_freq),
+          m_d_diag(nullptr),
+          m_precond_type(PrecondType::Jacobi),
+          m_rx(nullptr),
+          m_cheb_degree(4),
+          m_cheb_lmax(0),
+          m_cheb_lmin(0),
+          m_cheb_estimated(false)
+    {
+    }
+
+    /**
+     * @brief Jacobi-preconditioned CG with a block-sparse (BSR) system matrix
+     */
+    template <int K>
+    PCGSolver(BlockSparseMatrix<T, K>& sys,
+              int                      unknown_dim,  // num rhs vectors
+              int                      max_iter,
+              T                        abs_tol = 1e-6,
+              T                        rel_tol = 0.0,
+              int reset_residual_freq = std::numeric_limits<int>::max())
+        : CGSolver<T, DenseMatOrder>(sys,
+                                     unknown_dim,
+                                     max_iter,
+                                     abs_tol,
+                                     rel_tol,
+                                     reset_residual_freq),
+          m_d_diag(nullptr),
+          m_precond_type(PrecondType::Jacobi),
+          m_rx(nullptr),
+          m_cheb_degree(4),
+          m_cheb_lmax(0),
+          m_cheb_lmin(0),
+          m_cheb_estimated(false)
+    {
+        CUDA_ERROR(tracked_malloc((void**)&m_d_diag,
+                                  sys.rows() * sizeof(T),
+                                  MemoryCategory::Solver));
+    }
+
+    /**
+     * @brief select the preconditioner. IC0 and PatchBlockJacobi require a
+     * SparseMatrix (CSR) system matrix and PatchBlockJacobi also requires the
+     * mesh the matrix is built on. Return false (and keep the current
+     * preconditioner) if the preconditioner is not supported for this system
+     */
+    bool set_preconditioner(PrecondType type, RXMeshStatic* rx = nullptr)
+    {
+        if (type == PrecondType::Custom) {
+            RXMESH_ERROR(
+                "PCGSolver::set_preconditioner() custom preconditioner should "
+                "be set by passing its apply and setup functions");
+            return false;
+        }
+
+        if ((type == PrecondType::IC0 ||
+             type == PrecondType::PatchBlockJacobi) &&
+            this->A == nullptr) {
+            RXMESH_ERROR(
+                "PCGSolver::set_preconditioner() {} preconditioner requires a "
+                "SparseMatrix system matrix",
+                precond_type_to_string(type));
+            return false;
+        }
+
+        if (type == PrecondType::PatchBlockJacobi && rx == nullptr) {
+            RXMESH_ERROR(
+                "PCGSolver::set_preconditioner() patch_block_jacobi "
+                "preconditioner requires the mesh (rx)");
+            return false;
+        }
+
+        release_preconditioner();
+
+        m_precond_type = type;
+        m_rx           = rx;
+        return true;
+    }
+
+    /**
+     * @brief use a custom preconditioner. apply(in, out, stream) should
+     * implement out = inv(M) * in. setup(num_cols, stream) (optional) is called
+     * in every pre_solve(), i.e., every time the system matrix may have changed
+     */
+    void set_preconditioner(PrecondApplyFunc apply,
+                            PrecondSetupFunc setup = nullptr)
+    {
+        release_preconditioner();
+
+        m_precond_type  = PrecondType::Custom;
+        m_precond_apply = apply;
+        m_precond_setup = setup;
+    }
+
+    PrecondType get_preconditioner() const
+    {
+        return m_precond_type;
+    }
+
+    /**
+     * @brief set the degree of the Chebyshev polynomial preconditioner
+     * (default is 4)
+     */
+    void set_chebyshev_degree(int degree)
+    {
+        m_cheb_degree = std::max(degree, 1);
+    }
+
+    /**
+     * @brief the eigenvalue bounds of the Jacobi-scaled system matrix are
+     * estimated (by power iteration) once for the Chebyshev preconditioner.
+     * Call this if the system matrix values changed significantly
+     */
+    void reset_chebyshev_bounds()
     {
+        m_cheb_estimated = false;
     }
 
     virtual void pre_solve(const DenseMatT& B,
@@ -38,9 +161,17 @@ struct PCGSolver : public CGSolver<T, DenseMatOrder>
         this->R.reset(0.0, rxmesh::DEVICE, stream);
 
 
+        // the diagonal of the block-sparse matrix used by the preconditioner
+        if (this->m_block_diagonal) {
+            this->m_block_diagonal(m_d_diag, stream);
+        }
+
+        // (re-)factorize the preconditioner with the current system matrix
+        setup_preconditioner(X.cols(), stream);
+
         // init S
         // S = Ax
-        this->A->multiply(X, this->S, false, false, 1, 0, stream);
+        this->mat_vec(X, this->S, stream);
 
         // init R
         // R = B - S
@@ -58,13 +189,13 @@ struct PCGSolver : public CGSolver<T, DenseMatOrder>
                        cudaStream_t stream = NULL) override
     {
 
-        if (this->A->cols() != X.rows() || this->A->rows() != B.rows() ||
+        if (this->sys_cols() != X.rows() || this->sys_rows() != B.rows() ||
             X.cols() != B.cols()) {
             RXMESH_ERROR(
                 "CGSolver::solver mismatch in the input/output size. A ({}, "
                 "{}), X ({}, {}), B ({}, {})",
-                this->A->rows(),
-                this->A->cols(),
+                this->sys_rows(),
+                this->sys_cols(),
                 X.rows(),
                 X.cols(),
                 B.rows(),
@@ -78,7 +209,7 @@ struct PCGSolver : public CGSolver<T, DenseMatOrder>
 
         while (this->m_iter_taken < this->m_max_iter) {
             // s = Ap
-            this->A->multiply(this->P, this->S, false, false, 1, 0, stream);
+            this->mat_vec(this->P, this->S, stream);
 
             // alpha = this->delta_new / <S,P>
             this->alpha = this->S.dot(this->P, false, stream);
@@ -91,7 +222,7 @@ struct PCGSolver : public CGSolver<T, DenseMatOrder>
             if (this->m_iter_taken > 0 &&
                 this->m_iter_taken % this->m_reset_residual_freq == 0) {
                 // s= Ax
-                this->A->multiply(X, this->S, false, false, 1, 0, stream);
+                this->mat_vec(X, this->S, stream);
 
                 // r = b-s
                 this->subtract(this->R, B, this->S, stream);
@@ -135,27 +266,73 @@ struct PCGSolver : public CGSolver<T, DenseMatOrder>
 
     virtual ~PCGSolver()
     {
+        release_preconditioner();
+        GPU_FREE(m_d_diag);
     }
 
     /**
      * @brief implement out = inv(M) * in
-     * where in and out are dense matrices and M is the preconditioner
-     * Here the preconditioner is Jacobi preconditioner. Thus, inv(M) is simply
-     * a diagonal matrix where M(i,i) is 1/A(i,i)
+     * where in and out are dense matrices and M is the preconditioner selected
+     * by set_preconditioner()
      */
     virtual void precond(const DenseMatT& in,
                          DenseMatT&       out,
                          cudaStream_t     stream = NULL)
+    {
+        switch (m_precond_type) {
+            case PrecondType::IC0: {
+                m_ic0.apply(in, out, stream);
+                break;
+            }
+            case PrecondType::PatchBlockJacobi: {
+                m_pbj.apply(in, out, stream);
+                break;
+            }
+            case PrecondType::Chebyshev: {
+                chebyshev_precond(in, out, stream);
+                break;
+            }
+            case PrecondType::Custom: {
+                m_precond_apply(in, out, stream);
+                break;
+            }
+            default: {
+                jacobi_precond(in, out, stream);
+                break;
+            }
+        }
+    }
+
+    /**
+     * @brief Jacobi preconditioner. inv(M) is simply a diagonal matrix where
+     * M(i,i) is 1/A(i,i)
+     */
+    void jacobi_precond(const DenseMatT& in,
+                        DenseMatT&       out,
+                        cudaStream_t     stream = NULL)
     {
         const int rows = in.rows();
         const int cols = in.cols();
 
-        SparseMatrix<T> Amat = *(this->A);
-
         const int blockThreads = 512;
 
         const int blocks = DIVIDE_UP(rows, blockThreads);
 
+        if (this->A == nullptr) {
+            const T* d_diag = m_d_diag;
+            for_each_item<<<blocks, blockThreads, 0, stream>>>(
+                rows, [in, out, d_diag, cols] __device__(int i) mutable {
+                    const T diag = T(1) / d_diag[i];
+
+                    for (int j = 0; j < cols; ++j) {
+                        out(i, j) = diag * in(i, j);
+                    }
+                });
+            return;
+        }
+
+        SparseMatrix<T> Amat = *(this->A);
+
         for_each_item<<<blocks, blockThreads, 0, stream>>>(
             rows,
             [in, out, Amat, cols] __device__(int i) mutable {
@@ -194,6 +371,238 @@ struct PCGSolver : public CGSolver<T, DenseMatOrder>
 
         );
     };
+
+   protected:
+    /**
+     * @brief allocate/factorize the selected preconditioner
+     */
+    void setup_preconditioner(int num_cols, cudaStream_t stream)
+    {
+        switch (m_precond_type) {
+            case PrecondType::IC0: {
+                if (!m_ic0.is_initialized() &&
+                    !m_ic0.init(*this->A, num_cols)) {
+                    m_precond_type = PrecondType::Jacobi;
+                    break;
+                }
+                m_ic0.factorize(*this->A, stream);
+                break;
+            }
+            case PrecondType::PatchBlockJacobi: {
+                if (!m_pbj.is_initialized() && !m_pbj.init(*m_rx, *this->A)) {
+                    m_precond_type = PrecondType::Jacobi;
+                    break;
+                }
+                m_pbj.factorize(*this->A, stream);
+                break;
+            }
+            case PrecondType::Chebyshev: {
+                if (m_pc_d.cols() != num_cols) {
+                    const int rows = this->sys_rows();
+                    release_chebyshev_buffers();
+                    m_pc_d   = DenseMatT(rows, num_cols, LOCATION_ALL);
+                    m_pc_res = DenseMatT(rows, num_cols, DEVICE);
+                    m_pc_tmp = DenseMatT(rows, num_cols, DEVICE);
+                }
+                if (m_d_diag == nullptr) {
+                    CUDA_ERROR(tracked_malloc((void**)&m_d_diag,
+                                              this->sys_rows() * sizeof(T),
+                                              MemoryCategory::Solver));
+                }
+                if (this->A != nullptr) {
+                    SparseMatrix<T> Amat   = *(this->A);
+                    T*              d_diag = m_d_diag;
+                    const int       rows   = this->sys_rows();
+                    for_each_item<<<DIVIDE_UP(rows, 512), 512, 0, stream>>>(
+                        rows, [Amat, d_diag] __device__(int i) mutable {
+                            d_diag[i] = Amat(i, i);
+                        });
+                }
+                if (!m_cheb_estimated) {
+                    estimate_chebyshev_bounds(stream);
+                }
+                break;
+            }
+            case PrecondType::Custom: {
+                if (m_precond_setup) {
+                    m_precond_setup(num_cols, stream);
+                }
+                break;
+            }
+            default:
+                break;
+        }
+    }
+
+    /**
+     * @brief estimate the largest eigenvalue of inv(D) * A with a few power
+     * iterations. The smallest eigenvalue is taken as a fixed fraction of the
+     * largest one which is the usual choice for Chebyshev smoothers
+     */
+    void estimate_chebyshev_bounds(cudaStream_t stream)
+    {
+        const int num_power_iter = 10;
+
+        m_pc_d.fill_random();
+        m_pc_d.move(HOST, DEVICE, stream);
+
+        T lmax = 1;
+
+        for (int i = 0; i < num_power_iter; ++i) {
+            T norm = m_pc_d.norm2(stream);
+            if (norm <= T(0)) {
+                break;
+            }
+            scale_rows(m_pc_d, m_pc_d, T(1) / norm, false, stream);
+
+            // res = inv(D) * A * d
+            this->mat_vec(m_pc_d, m_pc_res, stream);
+            scale_rows(m_pc_res, m_pc_res, T(1), true, stream);
+
+            // the Rayleigh quotient (d is unit length)
+            lmax = m_pc_d.dot(m_pc_res, false, stream);
+
+            scale_rows(m_pc_res, m_pc_d, T(1), false, stream);
+        }
+
+        // safety margin since power iteration underestimates the largest
+        // eigenvalue
+        m_cheb_lmax      = T(1.1) * std::abs(lmax);
+        m_cheb_lmin      = m_cheb_lmax / T(30);
+        m_cheb_estimated = true;
+    }
+
+    /**
+     * @brief out = s * in or out = s * inv(D) * in where D is the diagonal of
+     * the system matrix
+     */
+    void scale_rows(const DenseMatT& in,
+                    DenseMatT&       out,
+                    T                s,
+                    bool             use_diag,
+                    cudaStream_t     stream)
+    {
+        const int rows   = in.rows();
+        const int cols   = in.cols();
+        const T*  d_diag = m_d_diag;
+
+        const int blockThreads = 512;
+
+        for_each_item<<<DIVIDE_UP(rows, blockThreads),
+                        blockThreads,
+                        0,
+                        stream>>>(
+            rows,
+            [in, out, d_diag, s, use_diag, cols] __device__(int i) mutable {
+                const T d = use_diag ? s / d_diag[i] : s;
+                for (int j = 0; j < cols; ++j) {
+                    out(i, j) = d * in(i, j);
+                }
+            });
+    }
+
+    /**
+     * @brief Chebyshev polynomial preconditioner, i.e., out is the result of
+     * m_cheb_degree Jacobi-scaled Chebyshev iterations on A * out = in
+     * starting from zero. Since the number of iterations is fixed, this is a
+     * fixed symmetric polynomial of A and so a valid preconditioner for CG
+     */
+    void chebyshev_precond(const DenseMatT& in,
+                           DenseMatT&       out,
+                           cudaStream_t     stream)
+    {
+        const T theta = (m_cheb_lmax + m_cheb_lmin) / T(2);
+        const T delta = (m_cheb_lmax - m_cheb_lmin) / T(2);
+        const T sigma = theta / delta;
+
+        T rho = T(1) / sigma;
+
+        const int rows   = in.rows();
+        const int cols   = in.cols();
+        const T*  d_diag = m_d_diag;
+
+        const int blockThreads = 512;
+        const int blocks       = DIVIDE_UP(rows, blockThreads);
+
+        DenseMatT d   = m_pc_d;
+        DenseMatT res = m_pc_res;
+
+        // res = in, d = inv(D) * in / theta, out = d
+        for_each_item<<<blocks, blockThreads, 0, stream>>>(
+            rows,
+            [in, out, d, res, d_diag, theta, cols] __device__(int i) mutable {
+                const T inv_d = T(1) / (theta * d_diag[i]);
+                for (int j = 0; j < cols; ++j) {
+                    res(i, j) = in(i, j);
+                    d(i, j)   = inv_d * in(i, j);
+                    out(i, j) = d(i, j);
+                }
+            });
+
+        for (int k = 1; k < m_cheb_degree; ++k) {
+            // res = res - A * d
+            this->mat_vec(d, m_pc_tmp, stream);
+            this->axpy(res, m_pc_tmp, T(-1), T(1), stream);
+
+            const T rho_new = T(1) / (T(2) * sigma - rho);
+            const T cd      = rho_new * rho;
+            const T cr      = T(2) * rho_new / delta;
+
+            // d = cd * d + cr * inv(D) * res, out = out + d
+            for_each_item<<<blocks, blockThreads, 0, stream>>>(
+                rows,
+                [out, d, res, d_diag, cd, cr, cols] __device__(int i) mutable {
+                    const T inv_d = cr / d_diag[i];
+                    for (int j = 0; j < cols; ++j) {
+                        d(i, j) = cd * d(i, j) + inv_d * res(i, j);
+                        out(i, j) += d(i, j);
+                    }
+                });
+
+            rho = rho_new;
+        }
+    }
+
+    void release_preconditioner()
+    {
+        m_ic0.release();
+        m_pbj.release();
+        release_chebyshev_buffers();
+        m_cheb_estimated = false;
+        m_precond_apply  = nullptr;
+        m_precond_setup  = nullptr;
+    }
+
+    void release_chebyshev_buffers()
+    {
+        for (DenseMatT* mat : {&m_pc_d, &m_pc_res, &m_pc_tmp}) {
+            if (mat->rows() > 0) {
+                mat->release();
+            }
+            *mat = DenseMatT();
+        }
+    }
+
+    // the diagonal of the system matrix (allocated with BlockSparseMatrix or
+    // with the Chebyshev preconditioner)
+    T* m_d_diag;
+
+    PrecondType   m_precond_type;
+    RXMeshStatic* m_rx;
+
+    IC0Preconditioner<T, DenseMatOrder>              m_ic0;
+    PatchBlockJacobiPreconditioner<T, DenseMatOrder> m_pbj;
+
+    // Chebyshev preconditioner
+    int       m_cheb_degree;
+    T         m_cheb_lmax;
+    T         m_cheb_lmin;
+    bool      m_cheb_estimated;
+    DenseMatT m_pc_d, m_pc_res, m_pc_tmp;
+
+    // custom preconditioner
+    PrecondApplyFunc m_precond_apply;
+    PrecondSetupFunc m_precond_setup;
 };
 
 }  // namespace rxmesh
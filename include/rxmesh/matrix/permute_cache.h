@@ -0,0 +1,166 @@
+#pragma once
+
+#include <stdint.h>
+#include <cstring>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "rxmesh/matrix/permute_method.h"
+
+namespace rxmesh {
+
+/**
+ * @brief a process-wide cache of fill-reducing permutations keyed by the
+ * sparsity pattern of the matrix (which is derived from the mesh topology) and
+ * the permutation method. Direct solvers use it so that computing the
+ * permutation (e.g., nested dissection) is done once for all matrices that
+ * share the same sparsity, e.g., the Hessian across Newton iterations or
+ * identical meshes in a batch
+ */
+struct PermuteCache
+{
+    /**
+     * @brief the key of a sparsity pattern. The hash is computed over the CSR
+     * row pointer and column indices
+     */
+    struct Key
+    {
+        uint64_t      hash;
+        int64_t       rows;
+        int64_t       nnz;
+        PermuteMethod perm;
+
+        bool operator==(const Key& other) const
+        {
+            return hash == other.hash && rows == other.rows &&
+                   nnz == other.nnz && perm == other.perm;
+        }
+    };
+
+    /**
+     * @brief compute the key of a CSR matrix using its host row pointer and
+     * column indices
+     */
+    template <typename IndexT>
+    static Key make_key(const int64_t rows,
+                        const int64_t nnz,
+                        const IndexT* h_row_ptr,
+                        const IndexT* h_col_idx,
+                        PermuteMethod perm)
+    {
+        // FNV-1a
+        uint64_t h = 14695981039346656037ull;
+
+        auto hash_arr = [&](const IndexT* arr, int64_t size) {
+            for (int64_t i = 0; i < size; ++i) {
+                h ^= static_cast<uint64_t>(arr[i]);
+                h *= 1099511628211ull;
+            }
+        };
+
+        hash_arr(h_row_ptr, rows + 1);
+        hash_arr(h_col_idx, nnz);
+
+        return Key{h, rows, nnz, perm};
+    }
+
+    /**
+     * @brief copy the cached permutation of key into h_permute (of size
+     * key.rows). Return false if key is not in the cache
+     */
+    template <typename IndexT>
+    static bool find(const Key& key, IndexT* h_permute)
+    {
+        std::lock_guard<std::mutex> lock(mutex());
+
+        auto it = table().find(key);
+        if (it == table().end() || !is_enabled()) {
+            return false;
+        }
+        for (int64_t i = 0; i < key.rows; ++i) {
+            h_permute[i] = static_cast<IndexT>(it->second[i]);
+        }
+        return true;
+    }
+
+    /**
+     * @brief store the permutation h_permute (of size key.rows) of key
+     */
+    template <typename IndexT>
+    static void insert(const Key& key, const IndexT* h_permute)
+    {
+        std::lock_guard<std::mutex> lock(mutex());
+
+        if (!is_enabled()) {
+            return;
+        }
+
+        std::vector<int64_t>& p = table()[key];
+        p.resize(key.rows);
+        for (int64_t i = 0; i < key.rows; ++i) {
+            p[i] = static_cast<int64_t>(h_permute[i]);
+        }
+    }
+
+    /**
+     * @brief remove all cached permutations
+     */
+    static void clear()
+    {
+        std::lock_guard<std::mutex> lock(mutex());
+        table().clear();
+    }
+
+    /**
+     * @brief number of cached permutations
+     */
+    static size_t size()
+    {
+        std::lock_guard<std::mutex> lock(mutex());
+        return table().size();
+    }
+
+    /**
+     * @brief enable/disable the cache (enabled by default)
+     */
+    static void set_enabled(bool enabled)
+    {
+        enabled_flag() = enabled;
+    }
+
+    static bool is_enabled()
+    {
+        return enabled_flag();
+    }
+
+   private:
+    struct KeyHash
+    {
+        size_t operator()(const Key& key) const
+        {
+            return static_cast<size_t>(key.hash ^ (uint64_t(key.perm) << 59));
+        }
+    };
+
+    using TableT = std::unordered_map<Key, std::vector<int64_t>, KeyHash>;
+
+    static TableT& table()
+    {
+        static TableT t;
+        return t;
+    }
+
+    static std::mutex& mutex()
+    {
+        static std::mutex m;
+        return m;
+    }
+
+    static bool& enabled_flag()
+    {
+        static bool e = true;
+        return e;
+    }
+};
+}  // namespace rxmesh
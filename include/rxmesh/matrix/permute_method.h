@@ -9,7 +9,9 @@ namespace rxmesh {
  * NONE for No Reordering Applied, SYMRCM for Symmetric Reverse Cuthill-McKee
  * permutation, SYMAMD for Symmetric Approximate Minimum Degree Algorithm based
  * on Quotient Graph, NSTDIS for Nested Dissection, GPUMGND is a GPU modified
- * generalized nested dissection permutation, and GPUND is GPU nested dissection
+ * generalized nested dissection permutation, GPUND is GPU nested dissection,
+ * and AUTO picks (per matrix) the one among SYMAMD, NSTDIS, GPUND, and GPUMGND
+ * whose Cholesky factorization takes the least flops (see cholesky_symbolic())
  */
 enum class PermuteMethod
 {
@@ -18,7 +20,8 @@ enum class PermuteMethod
     SYMAMD  = 2,
     NSTDIS  = 3,
     GPUMGND = 4,
-    GPUND   = 5
+    GPUND   = 5,
+    AUTO    = 6
 };
 
 inline PermuteMethod string_to_permute_method(std::string prem)
@@ -37,6 +40,8 @@ inline PermuteMethod string_to_permute_method(std::string prem)
         return PermuteMethod::GPUMGND;
     } else if (prem == "gpund") {
         return PermuteMethod::GPUND;
+    } else if (prem == "auto") {
+        return PermuteMethod::AUTO;
     } else {
         return PermuteMethod::NONE;
     }
@@ -55,6 +60,8 @@ inline std::string permute_method_to_string(PermuteMethod prem)
         return "gpumgnd";
     } else if (prem == PermuteMethod::GPUND) {
         return "gpund";
+    } else if (prem == PermuteMethod::AUTO) {
+        return "auto";
     } else {
         return "none";
     }
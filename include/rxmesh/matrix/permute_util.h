@@ -2,6 +2,7 @@
 
 #include <stdint.h>
 #include <algorithm>
+#include <cstring>
 #include <vector>
 
 namespace rxmesh {
@@ -40,4 +41,97 @@ void inverse_permutation(uint32_t size, T* perm, T* helper)
         perm[i] = helper[i];
     }
 }
+
+/**
+ * @brief the symbolic statistics of the Cholesky factor L (see
+ * cholesky_symbolic())
+ */
+struct CholeskySymbolic
+{
+    // the number of non-zero entries in L (including the diagonal)
+    size_t nnz = 0;
+
+    // the number of floating-point operations of the factorization, i.e., the
+    // sum of the squares of the column counts of L
+    double flops = 0;
+};
+
+/**
+ * @brief the column counts of the Cholesky factor L of the symmetric matrix
+ * with the given CSR sparsity pattern after applying the permutation perm,
+ * i.e., factorizing A(perm, perm) where perm[new] = old (the convention used
+ * by the direct solvers) and return the number of non-zeros and the flops of
+ * the factorization. If perm is nullptr, the matrix is factorized as is. The
+ * counts are exact and are computed symbolically by traversing the row
+ * subtrees of the elimination tree (which is built along the way) so it costs
+ * O(nnz(L)) time and O(rows) memory. This is a cheap way to estimate the
+ * quality (fill-in) of a fill-reducing permutation without doing the
+ * numerical factorization
+ */
+template <typename IndexT>
+CholeskySymbolic cholesky_symbolic(const IndexT  rows,
+                                   const IndexT* h_row_ptr,
+                                   const IndexT* h_col_idx,
+                                   const IndexT* perm = nullptr)
+{
+    std::vector<IndexT> iperm;
+    if (perm) {
+        iperm.resize(rows);
+        for (IndexT i = 0; i < rows; ++i) {
+            iperm[perm[i]] = i;
+        }
+    }
+
+    // parent in the elimination tree
+    std::vector<IndexT> parent(rows, -1);
+
+    // the last row whose row subtree visited a node
+    std::vector<IndexT> mark(rows, -1);
+
+    // the number of non-zeros in every column of L (including the diagonal)
+    std::vector<size_t> col_count(rows, 1);
+
+    for (IndexT i = 0; i < rows; ++i) {
+        mark[i] = i;
+
+        const IndexT r = perm ? perm[i] : i;
+
+        for (IndexT e = h_row_ptr[r]; e < h_row_ptr[r + 1]; ++e) {
+            const IndexT k = perm ? iperm[h_col_idx[e]] : h_col_idx[e];
+            if (k >= i) {
+                continue;
+            }
+            // every node on the path from k to the root of its subtree is a
+            // non-zero in row i of L
+            for (IndexT j = k; mark[j] != i; j = parent[j]) {
+                if (parent[j] == -1) {
+                    parent[j] = i;
+                }
+                mark[j] = i;
+                col_count[j]++;
+            }
+        }
+    }
+
+    CholeskySymbolic ret;
+    for (IndexT j = 0; j < rows; ++j) {
+        ret.nnz += col_count[j];
+        ret.flops += double(col_count[j]) * double(col_count[j]);
+    }
+    return ret;
+}
+
+/**
+ * @brief the number of non-zero entries in the Cholesky factor L (including
+ * the diagonal) of the symmetric matrix with the given CSR sparsity pattern
+ * after applying the permutation perm (see cholesky_symbolic())
+ */
+template <typename IndexT>
+size_t cholesky_fill_in(const IndexT  rows,
+                        const IndexT* h_row_ptr,
+                        const IndexT* h_col_idx,
+                        const IndexT* perm = nullptr)
+{
+    return cholesky_symbolic(rows, h_row_ptr, h_col_idx, perm).nnz;
+}
 }  // namespace rxmesh
\ No newline at end of file
@@ -0,0 +1,675 @@
+#pragma once
+
+#include <algorithm>
+#include <numeric>
+#include <string>
+#include <vector>
+
+#include "cusparse.h"
+
+#include "rxmesh/rxmesh_static.h"
+
+#include "rxmesh/matrix/dense_matrix.h"
+#include "rxmesh/matrix/preconditioner_kernels.cuh"
+#include "rxmesh/matrix/sparse_matrix.h"
+
+#include "thrust/device_ptr.h"
+#include "thrust/execution_policy.h"
+#include "thrust/gather.h"
+
+namespace rxmesh {
+
+/**
+ * @brief The enum class for choosing the preconditioner of PCGSolver.
+ * Jacobi uses the inverse of the diagonal, IC0 is the zero fill-in incomplete
+ * Cholesky (cuSparse csric02), PatchBlockJacobi factorizes small dense
+ * diagonal blocks that do not cross patch boundaries, Chebyshev is a
+ * Jacobi-scaled Chebyshev polynomial of the system matrix, and Custom is a
+ * user-provided preconditioner (e.g., GMGPreconditioner)
+ */
+enum class PrecondType
+{
+    Jacobi           = 0,
+    IC0              = 1,
+    PatchBlockJacobi = 2,
+    Chebyshev        = 3,
+    Custom           = 4
+};
+
+inline PrecondType string_to_precond_type(std::string precond)
+{
+    std::transform(precond.begin(),
+                   precond.end(),
+                   precond.begin(),
+                   [](unsigned char c) { return std::tolower(c); });
+
+    if (precond == "ic0") {
+        return PrecondType::IC0;
+    } else if (precond == "patch_block_jacobi" || precond == "pbj") {
+        return PrecondType::PatchBlockJacobi;
+    } else if (precond == "chebyshev") {
+        return PrecondType::Chebyshev;
+    } else if (precond == "custom") {
+        return PrecondType::Custom;
+    } else {
+        return PrecondType::Jacobi;
+    }
+}
+
+inline std::string precond_type_to_string(PrecondType precond)
+{
+    if (precond == PrecondType::IC0) {
+        return "ic0";
+    } else if (precond == PrecondType::PatchBlockJacobi) {
+        return "patch_block_jacobi";
+    } else if (precond == PrecondType::Chebyshev) {
+        return "chebyshev";
+    } else if (precond == PrecondType::Custom) {
+        return "custom";
+    } else {
+        return "jacobi";
+    }
+}
+
+/**
+ * @brief zero fill-in incomplete Cholesky preconditioner M = L * L^T using
+ * cuSparse csric02 for the factorization and SpSM for the triangular solves
+ * (all right-hand sides at once). cuSparse requires sorted column indices
+ * while SparseMatrix stores the diagonal first, so the factorization works on
+ * a sorted copy of the matrix values
+ */
+template <typename T, int DenseMatOrder = Eigen::ColMajor>
+struct IC0Preconditioner
+{
+    using IndexT    = int;
+    using DenseMatT = DenseMatrix<T, DenseMatOrder>;
+
+    IC0Preconditioner()
+        : m_num_rows(0),
+          m_nnz(0),
+          m_num_cols(0),
+          m_d_row_ptr(nullptr),
+          m_d_col_idx(nullptr),
+          m_d_map(nullptr),
+          m_d_val(nullptr),
+          m_d_in(nullptr),
+          m_d_tmp(nullptr),
+          m_d_out(nullptr),
+          m_d_ic_buffer(nullptr),
+          m_d_spsm_buffer_l(nullptr),
+          m_d_spsm_buffer_lt(nullptr),
+          m_initialized(false)
+    {
+    }
+
+    /**
+     * @brief allocate and analyze the sparsity of A for num_cols right-hand
+     * sides. Return false if A is not supported
+     */
+    bool init(const SparseMatrix<T>& A, int num_cols)
+    {
+        if constexpr (!std::is_same_v<T, float> &&
+                      !std::is_same_v<T, double>) {
+            RXMESH_ERROR(
+                "IC0Preconditioner::init() only float and double are "
+                "supported");
+            return false;
+        } else {
+            release();
+
+            m_num_rows = A.rows();
+            m_nnz      = A.non_zeros();
+            m_num_cols = num_cols;
+
+            const IndexT* h_row_ptr = A.row_ptr(HOST);
+            const IndexT* h_col_idx = A.col_idx(HOST);
+
+            if (h_row_ptr == nullptr || h_col_idx == nullptr) {
+                RXMESH_ERROR(
+                    "IC0Preconditioner::init() the sparse matrix row pointer "
+                    "and column index should be allocated on the host");
+                return false;
+            }
+
+            // sort the column indices of every row and remember where every
+            // sorted entry comes from
+            std::vector<IndexT> h_map(m_nnz);
+            std::vector<IndexT> h_col(m_nnz);
+            std::iota(h_map.begin(), h_map.end(), 0);
+            for (IndexT r = 0; r < m_num_rows; ++r) {
+                std::sort(h_map.begin() + h_row_ptr[r],
+                          h_map.begin() + h_row_ptr[r + 1],
+                          [&](IndexT a, IndexT b) {
+                              return h_col_idx[a] < h_col_idx[b];
+                          });
+            }
+            for (IndexT i = 0; i < m_nnz; ++i) {
+                h_col[i] = h_col_idx[h_map[i]];
+            }
+
+            const size_t vec_bytes =
+                size_t(m_num_rows) * m_num_cols * sizeof(T);
+
+            CUDA_ERROR(tracked_malloc((void**)&m_d_row_ptr,
+                                      (m_num_rows + 1) * sizeof(IndexT),
+                                      MemoryCategory::Solver));
+            CUDA_ERROR(tracked_malloc((void**)&m_d_col_idx,
+                                      m_nnz * sizeof(IndexT),
+                                      MemoryCategory::Solver));
+            CUDA_ERROR(tracked_malloc((void**)&m_d_map,
+                                      m_nnz * sizeof(IndexT),
+                                      MemoryCategory::Solver));
+            CUDA_ERROR(tracked_malloc((void**)&m_d_val,
+                                      m_nnz * sizeof(T),
+                                      MemoryCategory::Solver));
+            CUDA_ERROR(tracked_malloc((void**)&m_d_in,
+                                      vec_bytes,
+                                      MemoryCategory::Solver));
+            CUDA_ERROR(tracked_malloc((void**)&m_d_tmp,
+                                      vec_bytes,
+                                      MemoryCategory::Solver));
+            CUDA_ERROR(tracked_malloc((void**)&m_d_out,
+                                      vec_bytes,
+                                      MemoryCategory::Solver));
+
+            CUDA_ERROR(cudaMemcpy(m_d_row_ptr,
+                                  h_row_ptr,
+                                  (m_num_rows + 1) * sizeof(IndexT),
+                                  cudaMemcpyHostToDevice));
+            CUDA_ERROR(cudaMemcpy(m_d_col_idx,
+                                  h_col.data(),
+                                  m_nnz * sizeof(IndexT),
+                                  cudaMemcpyHostToDevice));
+            CUDA_ERROR(cudaMemcpy(m_d_map,
+                                  h_map.data(),
+                                  m_nnz * sizeof(IndexT),
+                                  cudaMemcpyHostToDevice));
+
+            gather_values(A, NULL);
+
+            CUSPARSE_ERROR(cusparseCreate(&m_handle));
+            CUSPARSE_ERROR(cusparseCreateMatDescr(&m_descr));
+            CUSPARSE_ERROR(
+                cusparseSetMatType(m_descr, CUSPARSE_MATRIX_TYPE_GENERAL));
+            CUSPARSE_ERROR(
+                cusparseSetMatIndexBase(m_descr, CUSPARSE_INDEX_BASE_ZERO));
+            CUSPARSE_ERROR(cusparseCreateCsric02Info(&m_ic_info));
+
+            // csric02 buffer and analysis (only depends on the sparsity)
+            int ic_buffer_size = 0;
+            if constexpr (std::is_same_v<T, float>) {
+                CUSPARSE_ERROR(cusparseScsric02_bufferSize(m_handle,
+                                                           m_num_rows,
+                                                           m_nnz,
+                                                           m_descr,
+                                                           m_d_val,
+                                                           m_d_row_ptr,
+                                                           m_d_col_idx,
+                                                           m_ic_info,
+                                                           &ic_buffer_size));
+            } else {
+                CUSPARSE_ERROR(cusparseDcsric02_bufferSize(m_handle,
+                                                           m_num_rows,
+                                                           m_nnz,
+                                                           m_descr,
+                                                           m_d_val,
+                                                           m_d_row_ptr,
+                                                           m_d_col_idx,
+                                                           m_ic_info,
+                                                           &ic_buffer_size));
+            }
+            CUDA_ERROR(tracked_malloc((void**)&m_d_ic_buffer,
+                                      ic_buffer_size,
+                                      MemoryCategory::Solver));
+
+            if constexpr (std::is_same_v<T, float>) {
+                CUSPARSE_ERROR(
+                    cusparseScsric02_analysis(m_handle,
+                                              m_num_rows,
+                                              m_nnz,
+                                              m_descr,
+                                              m_d_val,
+                                              m_d_row_ptr,
+                                              m_d_col_idx,
+                                              m_ic_info,
+                                              CUSPARSE_SOLVE_POLICY_USE_LEVEL,
+                                              m_d_ic_buffer));
+            } else {
+                CUSPARSE_ERROR(
+                    cusparseDcsric02_analysis(m_handle,
+                                              m_num_rows,
+                                              m_nnz,
+                                              m_descr,
+                                              m_d_val,
+                                              m_d_row_ptr,
+                                              m_d_col_idx,
+                                              m_ic_info,
+                                              CUSPARSE_SOLVE_POLICY_USE_LEVEL,
+                                              m_d_ic_buffer));
+            }
+
+            // the factor L is the lower triangular part of m_d_val
+            CUSPARSE_ERROR(cusparseCreateCsr(&m_spmat_l,
+                                             m_num_rows,
+                                             m_num_rows,
+                                             m_nnz,
+                                             m_d_row_ptr,
+                                             m_d_col_idx,
+                                             m_d_val,
+                                             CUSPARSE_INDEX_32I,
+                                             CUSPARSE_INDEX_32I,
+                                             CUSPARSE_INDEX_BASE_ZERO,
+                                             cuda_type<T>()));
+            cusparseFillMode_t fill = CUSPARSE_FILL_MODE_LOWER;
+            cusparseDiagType_t diag = CUSPARSE_DIAG_TYPE_NON_UNIT;
+            CUSPARSE_ERROR(cusparseSpMatSetAttribute(
+                m_spmat_l, CUSPARSE_SPMAT_FILL_MODE, &fill, sizeof(fill)));
+            CUSPARSE_ERROR(cusparseSpMatSetAttribute(
+                m_spmat_l, CUSPARSE_SPMAT_DIAG_TYPE, &diag, sizeof(diag)));
+
+            create_dn_mat(m_dn_in, m_d_in);
+            create_dn_mat(m_dn_tmp, m_d_tmp);
+            create_dn_mat(m_dn_out, m_d_out);
+
+            CUSPARSE_ERROR(cusparseSpSM_createDescr(&m_spsm_l));
+            CUSPARSE_ERROR(cusparseSpSM_createDescr(&m_spsm_lt));
+
+            const cusparseOperation_t op_n = CUSPARSE_OPERATION_NON_TRANSPOSE;
+            const cusparseOperation_t op_t = CUSPARSE_OPERATION_TRANSPOSE;
+            const T one            = 1;
+            size_t  l_buffer_size  = 0;
+            size_t  lt_buffer_size = 0;
+            CUSPARSE_ERROR(cusparseSpSM_bufferSize(m_handle,
+                                                   op_n,
+                                                   op_n,
+                                                   &one,
+                                                   m_spmat_l,
+                                                   m_dn_in,
+                                                   m_dn_tmp,
+                                                   cuda_type<T>(),
+                                                   CUSPARSE_SPSM_ALG_DEFAULT,
+                                                   m_spsm_l,
+                                                   &l_buffer_size));
+            CUSPARSE_ERROR(cusparseSpSM_bufferSize(m_handle,
+                                                   op_t,
+                                                   op_n,
+                                                   &one,
+                                                   m_spmat_l,
+                                                   m_dn_tmp,
+                                                   m_dn_out,
+                                                   cuda_type<T>(),
+                                                   CUSPARSE_SPSM_ALG_DEFAULT,
+                                                   m_spsm_lt,
+                                                   &lt_buffer_size));
+            CUDA_ERROR(tracked_malloc((void**)&m_d_spsm_buffer_l,
+                                      l_buffer_size,
+                                      MemoryCategory::Solver));
+            CUDA_ERROR(tracked_malloc((void**)&m_d_spsm_buffer_lt,
+                                      lt_buffer_size,
+                                      MemoryCategory::Solver));
+
+            m_initialized = true;
+            return true;
+        }
+    }
+
+    /**
+     * @brief (re-)compute the incomplete factorization with the current
+     * values of A (which should have the same sparsity used in init())
+     */
+    void factorize(const SparseMatrix<T>& A, cudaStream_t stream = NULL)
+    {
+        if (!m_initialized) {
+            RXMESH_ERROR(
+                "IC0Preconditioner::factorize() init() should be called "
+                "first");
+            return;
+        }
+
+        if constexpr (std::is_same_v<T, float> || std::is_same_v<T, double>) {
+            CUSPARSE_ERROR(cusparseSetStream(m_handle, stream));
+
+            gather_values(A, stream);
+
+            if constexpr (std::is_same_v<T, float>) {
+                CUSPARSE_ERROR(cusparseScsric02(m_handle,
+                                                m_num_rows,
+                                                m_nnz,
+                                                m_descr,
+                                                m_d_val,
+                                                m_d_row_ptr,
+                                                m_d_col_idx,
+                                                m_ic_info,
+                                                CUSPARSE_SOLVE_POLICY_USE_LEVEL,
+                                                m_d_ic_buffer));
+            } else {
+                CUSPARSE_ERROR(cusparseDcsric02(m_handle,
+                                                m_num_rows,
+                                                m_nnz,
+                                                m_descr,
+                                                m_d_val,
+                                                m_d_row_ptr,
+                                                m_d_col_idx,
+                                                m_ic_info,
+                                                CUSPARSE_SOLVE_POLICY_USE_LEVEL,
+                                                m_d_ic_buffer));
+            }
+
+            int pivot = -1;
+            if (cusparseXcsric02_zeroPivot(m_handle, m_ic_info, &pivot) ==
+                CUSPARSE_STATUS_ZERO_PIVOT) {
+                RXMESH_WARN(
+                    "IC0Preconditioner::factorize() zero pivot at row {}",
+                    pivot);
+            }
+
+            // the triangular solve analysis depends on the factor values
+            const cusparseOperation_t op_n = CUSPARSE_OPERATION_NON_TRANSPOSE;
+            const cusparseOperation_t op_t = CUSPARSE_OPERATION_TRANSPOSE;
+            const T one = 1;
+            CUSPARSE_ERROR(cusparseSpSM_analysis(m_handle,
+                                                 op_n,
+                                                 op_n,
+                                                 &one,
+                                                 m_spmat_l,
+                                                 m_dn_in,
+                                                 m_dn_tmp,
+                                                 cuda_type<T>(),
+                                                 CUSPARSE_SPSM_ALG_DEFAULT,
+                                                 m_spsm_l,
+                                                 m_d_spsm_buffer_l));
+            CUSPARSE_ERROR(cusparseSpSM_analysis(m_handle,
+                                                 op_t,
+                                                 op_n,
+                                                 &one,
+                                                 m_spmat_l,
+                                                 m_dn_tmp,
+                                                 m_dn_out,
+                                                 cuda_type<T>(),
+                                                 CUSPARSE_SPSM_ALG_DEFAULT,
+                                                 m_spsm_lt,
+                                                 m_d_spsm_buffer_lt));
+        }
+    }
+
+    /**
+     * @brief out = inv(L * L^T) * in
+     */
+    void apply(const DenseMatT& in, DenseMatT& out, cudaStream_t stream = NULL)
+    {
+        if constexpr (std::is_same_v<T, float> || std::is_same_v<T, double>) {
+            const size_t vec_bytes =
+                size_t(m_num_rows) * m_num_cols * sizeof(T);
+
+            CUSPARSE_ERROR(cusparseSetStream(m_handle, stream));
+
+            CUDA_ERROR(cudaMemcpyAsync(m_d_in,
+                                       in.data(DEVICE),
+                                       vec_bytes,
+                                       cudaMemcpyDeviceToDevice,
+                                       stream));
+
+            const cusparseOperation_t op_n = CUSPARSE_OPERATION_NON_TRANSPOSE;
+            const cusparseOperation_t op_t = CUSPARSE_OPERATION_TRANSPOSE;
+            const T one = 1;
+            CUSPARSE_ERROR(cusparseSpSM_solve(m_handle,
+                                              op_n,
+                                              op_n,
+                                              &one,
+                                              m_spmat_l,
+                                              m_dn_in,
+                                              m_dn_tmp,
+                                              cuda_type<T>(),
+                                              CUSPARSE_SPSM_ALG_DEFAULT,
+                                              m_spsm_l));
+            CUSPARSE_ERROR(cusparseSpSM_solve(m_handle,
+                                              op_t,
+                                              op_n,
+                                              &one,
+                                              m_spmat_l,
+                                              m_dn_tmp,
+                                              m_dn_out,
+                                              cuda_type<T>(),
+                                              CUSPARSE_SPSM_ALG_DEFAULT,
+                                              m_spsm_lt));
+
+            CUDA_ERROR(cudaMemcpyAsync(out.data(DEVICE),
+                                       m_d_out,
+                                       vec_bytes,
+                                       cudaMemcpyDeviceToDevice,
+                                       stream));
+        }
+    }
+
+    bool is_initialized() const
+    {
+        return m_initialized;
+    }
+
+    /**
+     * @brief release all allocated memory and cuSparse objects
+     */
+    void release()
+    {
+        if (m_initialized) {
+            CUSPARSE_ERROR(cusparseSpSM_destroyDescr(m_spsm_l));
+            CUSPARSE_ERROR(cusparseSpSM_destroyDescr(m_spsm_lt));
+            CUSPARSE_ERROR(cusparseDestroyDnMat(m_dn_in));
+            CUSPARSE_ERROR(cusparseDestroyDnMat(m_dn_tmp));
+            CUSPARSE_ERROR(cusparseDestroyDnMat(m_dn_out));
+            CUSPARSE_ERROR(cusparseDestroySpMat(m_spmat_l));
+            CUSPARSE_ERROR(cusparseDestroyCsric02Info(m_ic_info));
+            CUSPARSE_ERROR(cusparseDestroyMatDescr(m_descr));
+            CUSPARSE_ERROR(cusparseDestroy(m_handle));
+        }
+        GPU_FREE(m_d_row_ptr);
+        GPU_FREE(m_d_col_idx);
+        GPU_FREE(m_d_map);
+        GPU_FREE(m_d_val);
+        GPU_FREE(m_d_in);
+        GPU_FREE(m_d_tmp);
+        GPU_FREE(m_d_out);
+        GPU_FREE(m_d_ic_buffer);
+        GPU_FREE(m_d_spsm_buffer_l);
+        GPU_FREE(m_d_spsm_buffer_lt);
+        m_initialized = false;
+    }
+
+   protected:
+    void gather_values(const SparseMatrix<T>& A, cudaStream_t stream)
+    {
+        thrust::device_ptr<IndexT> t_p(m_d_map);
+        thrust::device_ptr<T>      t_i(A.val_ptr(DEVICE));
+        thrust::device_ptr<T>      t_o(m_d_val);
+
+        thrust::gather(
+            thrust::cuda::par.on(stream), t_p, t_p + m_nnz, t_i, t_o);
+    }
+
+    void create_dn_mat(cusparseDnMatDescr_t& desc, T* d_ptr)
+    {
+        if constexpr (DenseMatOrder == Eigen::ColMajor) {
+            CUSPARSE_ERROR(cusparseCreateDnMat(&desc,
+                                               m_num_rows,
+                                               m_num_cols,
+                                               m_num_rows,
+                                               d_ptr,
+                                               cuda_type<T>(),
+                                               CUSPARSE_ORDER_COL));
+        } else {
+            CUSPARSE_ERROR(cusparseCreateDnMat(&desc,
+                                               m_num_rows,
+                                               m_num_cols,
+                                               m_num_cols,
+                                               d_ptr,
+                                               cuda_type<T>(),
+                                               CUSPARSE_ORDER_ROW));
+        }
+    }
+
+    IndexT m_num_rows;
+    IndexT m_nnz;
+    IndexT m_num_cols;
+
+    // sorted copy of the CSR matrix (m_d_val is overwritten by the factor)
+    IndexT* m_d_row_ptr;
+    IndexT* m_d_col_idx;
+    IndexT* m_d_map;
+    T*      m_d_val;
+
+    // contiguous copies of the input/output of apply()
+    T* m_d_in;
+    T* m_d_tmp;
+    T* m_d_out;
+
+    void* m_d_ic_buffer;
+    void* m_d_spsm_buffer_l;
+    void* m_d_spsm_buffer_lt;
+
+    cusparseHandle_t     m_handle;
+    cusparseMatDescr_t   m_descr;
+    csric02Info_t        m_ic_info;
+    cusparseSpMatDescr_t m_spmat_l;
+    cusparseDnMatDescr_t m_dn_in, m_dn_tmp, m_dn_out;
+    cusparseSpSMDescr_t  m_spsm_l, m_spsm_lt;
+
+    bool m_initialized;
+};
+
+
+/**
+ * @brief patch-block-Jacobi preconditioner. The rows of every patch (i.e.,
+ * the rows of its owned vertices) are split into dense diagonal blocks of up
+ * to 32 rows without splitting the rows of a single vertex. Every block is
+ * factorized (dense Cholesky) in shared memory by one warp and applied with
+ * one warp doing forward/backward substitution with shuffles
+ */
+template <typename T, int DenseMatOrder = Eigen::ColMajor>
+struct PatchBlockJacobiPreconditioner
+{
+    using IndexT    = int;
+    using DenseMatT = DenseMatrix<T, DenseMatOrder>;
+
+    static constexpr uint32_t blockThreads = 128;
+
+    PatchBlockJacobiPreconditioner()
+        : m_num_tiles(0), m_d_tile_ptr(nullptr), m_d_factor(nullptr)
+    {
+    }
+
+    /**
+     * @brief build the diagonal blocks from the patches of rx. A should be a
+     * VV sparse matrix (possibly with replicate > 1) built on rx
+     */
+    bool init(const RXMeshStatic& rx, const SparseMatrix<T>& A)
+    {
+        release();
+
+        const IndexT num_v = rx.get_num_vertices();
+
+        if (num_v == 0 || A.rows() % num_v != 0) {
+            RXMESH_ERROR(
+                "PatchBlockJacobiPreconditioner::init() the sparse matrix "
+                "rows ({}) should be a multiple of the number of vertices "
+                "({})",
+                A.rows(),
+                num_v);
+            return false;
+        }
+
+        const IndexT rep = A.rows() / num_v;
+
+        if (rep > detail::PBJ_TILE) {
+            RXMESH_ERROR(
+                "PatchBlockJacobiPreconditioner::init() more than {} rows "
+                "per vertex are not supported",
+                detail::PBJ_TILE);
+            return false;
+        }
+
+        // the max block size that does not split the rows of a vertex
+        const IndexT tile = (detail::PBJ_TILE / rep) * rep;
+
+        std::vector<IndexT> h_tile_ptr(1, 0);
+
+        IndexT row = 0;
+        for (uint32_t p = 0; p < rx.get_num_patches(); ++p) {
+            const IndexT end = row + rx.get_num_owned_vertices(p) * rep;
+            while (row < end) {
+                row = std::min(row + tile, end);
+                h_tile_ptr.push_back(row);
+            }
+        }
+
+        m_num_tiles = IndexT(h_tile_ptr.size()) - 1;
+
+        CUDA_ERROR(tracked_malloc((void**)&m_d_tile_ptr,
+                                  h_tile_ptr.size() * sizeof(IndexT),
+                                  MemoryCategory::Solver));
+        CUDA_ERROR(cudaMemcpy(m_d_tile_ptr,
+                              h_tile_ptr.data(),
+                              h_tile_ptr.size() * sizeof(IndexT),
+                              cudaMemcpyHostToDevice));
+        CUDA_ERROR(tracked_malloc(
+            (void**)&m_d_factor,
+            size_t(m_num_tiles) * detail::PBJ_TILE * detail::PBJ_TILE *
+                sizeof(T),
+            MemoryCategory::Solver));
+        return true;
+    }
+
+    /**
+     * @brief (re-)factorize the diagonal blocks with the current values of A
+     */
+    void factorize(const SparseMatrix<T>& A, cudaStream_t stream = NULL)
+    {
+        if (m_num_tiles == 0) {
+            return;
+        }
+        const int blocks =
+            DIVIDE_UP(m_num_tiles * 32, static_cast<int>(blockThreads));
+
+        detail::pbj_factorize<T, blockThreads, IndexT>
+            <<<blocks, blockThreads, 0, stream>>>(m_num_tiles,
+                                                  m_d_tile_ptr,
+                                                  A.row_ptr(DEVICE),
+                                                  A.col_idx(DEVICE),
+                                                  A.val_ptr(DEVICE),
+                                                  m_d_factor);
+    }
+
+    /**
+     * @brief out = inv(M) * in
+     */
+    void apply(const DenseMatT& in, DenseMatT& out, cudaStream_t stream = NULL)
+    {
+        if (m_num_tiles == 0) {
+            return;
+        }
+        const int blocks =
+            DIVIDE_UP(m_num_tiles * 32, static_cast<int>(blockThreads));
+
+        detail::pbj_apply<T, blockThreads, IndexT, DenseMatOrder>
+            <<<blocks, blockThreads, 0, stream>>>(
+                m_num_tiles, m_d_tile_ptr, m_d_factor, in, out);
+    }
+
+    bool is_initialized() const
+    {
+        return m_d_factor != nullptr;
+    }
+
+    void release()
+    {
+        GPU_FREE(m_d_tile_ptr);
+        GPU_FREE(m_d_factor);
+        m_num_tiles = 0;
+    }
+
+   protected:
+    IndexT  m_num_tiles;
+    IndexT* m_d_tile_ptr;
+    T*      m_d_factor;
+};
+
+}  // namespace rxmesh
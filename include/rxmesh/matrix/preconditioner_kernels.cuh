@@ -0,0 +1,158 @@
+#pragma once
+
+#include <assert.h>
+#include <stdint.h>
+
+#include "rxmesh/matrix/dense_matrix.h"
+
+namespace rxmesh {
+namespace detail {
+
+// the max number of rows in a dense diagonal block of the patch-block-Jacobi
+// preconditioner. Every block is handled by one warp
+static constexpr int PBJ_TILE = 32;
+
+/**
+ * @brief factorize the dense diagonal blocks of the patch-block-Jacobi
+ * preconditioner. Every warp loads one (up to PBJ_TILE x PBJ_TILE) diagonal
+ * block of the CSR matrix into shared memory, does a dense Cholesky
+ * factorization in place, and writes the lower-triangular factor (row-major)
+ * to d_factor
+ */
+template <typename T, uint32_t blockThreads, typename IndexT>
+__global__ static void pbj_factorize(const int     num_tiles,
+                                     const IndexT* d_tile_ptr,
+                                     const IndexT* d_row_ptr,
+                                     const IndexT* d_col_idx,
+                                     const T*      d_val,
+                                     T*            d_factor)
+{
+    constexpr int NumWarps = blockThreads / 32;
+
+    __shared__ T s_tile[NumWarps][PBJ_TILE][PBJ_TILE + 1];
+
+    const int warp_id = threadIdx.x / 32;
+    const int lane    = threadIdx.x % 32;
+    const int tile_id = blockIdx.x * NumWarps + warp_id;
+
+    if (tile_id >= num_tiles) {
+        return;
+    }
+
+    T(&s)[PBJ_TILE][PBJ_TILE + 1] = s_tile[warp_id];
+
+    const IndexT r0 = d_tile_ptr[tile_id];
+    const int    n  = d_tile_ptr[tile_id + 1] - r0;
+
+    // load the diagonal block (lane i loads row i)
+    for (int j = 0; j < PBJ_TILE; ++j) {
+        s[lane][j] = (lane == j && lane >= n) ? T(1) : T(0);
+    }
+    if (lane < n) {
+        const IndexT r = r0 + lane;
+        for (IndexT e = d_row_ptr[r]; e < d_row_ptr[r + 1]; ++e) {
+            const IndexT c = d_col_idx[e];
+            if (c >= r0 && c < r0 + n) {
+                s[lane][c - r0] = d_val[e];
+            }
+        }
+    }
+    __syncwarp();
+
+    // right-looking dense Cholesky
+    for (int k = 0; k < n; ++k) {
+        if (lane == k) {
+            const T d = s[k][k];
+            s[k][k]   = (d > T(0)) ? sqrt(d) : T(1);
+        }
+        __syncwarp();
+
+        if (lane > k && lane < n) {
+            s[lane][k] /= s[k][k];
+        }
+        __syncwarp();
+
+        if (lane > k && lane < n) {
+            const T l = s[lane][k];
+            for (int j = k + 1; j <= lane; ++j) {
+                s[lane][j] -= l * s[j][k];
+            }
+        }
+        __syncwarp();
+    }
+
+    T* f = d_factor + size_t(tile_id) * PBJ_TILE * PBJ_TILE;
+    for (int j = 0; j < PBJ_TILE; ++j) {
+        f[lane * PBJ_TILE + j] = (j <= lane) ? s[lane][j] : T(0);
+    }
+}
+
+/**
+ * @brief apply the patch-block-Jacobi preconditioner, i.e., out = inv(M) * in
+ * where M is block-diagonal with the blocks factorized by pbj_factorize().
+ * Every warp does the forward and backward substitutions of one block for all
+ * columns with one row per lane
+ */
+template <typename T, uint32_t blockThreads, typename IndexT, int Order>
+__global__ static void pbj_apply(const int                   num_tiles,
+                                 const IndexT*               d_tile_ptr,
+                                 const T*                    d_factor,
+                                 const DenseMatrix<T, Order> in,
+                                 DenseMatrix<T, Order>       out)
+{
+    constexpr int NumWarps = blockThreads / 32;
+
+    __shared__ T s_tile[NumWarps][PBJ_TILE][PBJ_TILE + 1];
+
+    const int warp_id = threadIdx.x / 32;
+    const int lane    = threadIdx.x % 32;
+    const int tile_id = blockIdx.x * NumWarps + warp_id;
+
+    if (tile_id >= num_tiles) {
+        return;
+    }
+
+    T(&s)[PBJ_TILE][PBJ_TILE + 1] = s_tile[warp_id];
+
+    const IndexT r0 = d_tile_ptr[tile_id];
+    const int    n  = d_tile_ptr[tile_id + 1] - r0;
+
+    const T* f = d_factor + size_t(tile_id) * PBJ_TILE * PBJ_TILE;
+    for (int j = 0; j < PBJ_TILE; ++j) {
+        s[lane][j] = f[lane * PBJ_TILE + j];
+    }
+    __syncwarp();
+
+    for (int c = 0; c < in.cols(); ++c) {
+        T v = (lane < n) ? in(r0 + lane, c) : T(0);
+
+        // L * y = in
+        for (int k = 0; k < n; ++k) {
+            if (lane == k) {
+                v /= s[k][k];
+            }
+            const T yk = __shfl_sync(0xFFFFFFFF, v, k);
+            if (lane > k) {
+                v -= s[lane][k] * yk;
+            }
+        }
+
+        // L^T * x = y
+        for (int k = n - 1; k >= 0; --k) {
+            if (lane == k) {
+                v /= s[k][k];
+            }
+            const T xk = __shfl_sync(0xFFFFFFFF, v, k);
+            if (lane < k) {
+                v -= s[k][lane] * xk;
+            }
+        }
+
+        if (lane < n) {
+            out(r0 + lane, c) = v;
+        }
+    }
+}
+
+}  // namespace detail
+}  // namespace rxmesh
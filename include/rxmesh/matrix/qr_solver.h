@@ -268,7 +268,9 @@ struct QRSolver : public DirectSolver<SpMatT, DenseMatOrder>
             m_internalDataInBytes,
             m_workspaceInBytes);
 
-        CUDA_ERROR(cudaMalloc((void**)&m_solver_buffer, m_workspaceInBytes));
+        CUDA_ERROR(tracked_malloc((void**)&m_solver_buffer,
+                                  m_workspaceInBytes,
+                                  MemoryCategory::Solver));
     }
 
     /**
@@ -56,7 +56,12 @@ struct SparseMatrix
           m_is_user_managed(false),
           m_op(Op::INVALID),
           m_d_cub_temp_storage(nullptr),
-          m_cub_temp_storage_bytes(0)
+          m_cub_temp_storage_bytes(0),
+          m_d_patch_v_ptr(nullptr),
+          m_d_patch_gather(nullptr),
+          m_d_patch_col(nullptr),
+          m_patch_spmv_num_patches(0),
+          m_patch_spmv_smem_bytes(0)
     {
     }
 
@@ -148,7 +153,12 @@ struct SparseMatrix
           m_d_cub_temp_storage(nullptr),
           m_cub_temp_storage_bytes(0),
           m_capacity_factor(capacity_factor),
-          m_extra_nnz_entires(extra_nnz_entries)
+          m_extra_nnz_entires(extra_nnz_entries),
+          m_d_patch_v_ptr(nullptr),
+          m_d_patch_gather(nullptr),
+          m_d_patch_col(nullptr),
+          m_patch_spmv_num_patches(0),
+          m_patch_spmv_smem_bytes(0)
     {
         constexpr uint32_t blockThreads = 256;
 
@@ -185,10 +195,12 @@ struct SparseMatrix
         m_num_cols *= m_replicate;
 
         // row pointer allocation and init with prefix sum for CSR
-        CUDA_ERROR(cudaMalloc((void**)&m_d_row_ptr,
-                              (m_num_rows + 1) * sizeof(IndexT)));
-        CUDA_ERROR(
-            cudaMalloc((void**)&m_d_row_acc, m_num_rows * sizeof(IndexT)));
+        CUDA_ERROR(tracked_malloc((void**)&m_d_row_ptr,
+                                  (m_num_rows + 1) * sizeof(IndexT),
+                                  MemoryCategory::Matrix));
+        CUDA_ERROR(tracked_malloc((void**)&m_d_row_acc,
+                                  m_num_rows * sizeof(IndexT),
+                                  MemoryCategory::Matrix));
 
         CUDA_ERROR(
             cudaMemset(m_d_row_ptr, 0, (m_num_rows + 1) * sizeof(IndexT)));
@@ -257,8 +269,9 @@ struct SparseMatrix
                                       m_d_row_ptr,
                                       m_d_row_ptr,
                                       m_num_rows + 1);
-        CUDA_ERROR(cudaMalloc((void**)&m_d_cub_temp_storage,
-                              m_cub_temp_storage_bytes));
+        CUDA_ERROR(tracked_malloc((void**)&m_d_cub_temp_storage,
+                                  m_cub_temp_storage_bytes,
+                                  MemoryCategory::Matrix));
 
         cub::DeviceScan::ExclusiveSum(m_d_cub_temp_storage,
                                       m_cub_temp_storage_bytes,
@@ -276,8 +289,9 @@ struct SparseMatrix
         update_max_nnz();
 
         // column index allocation and init
-        CUDA_ERROR(
-            cudaMalloc((void**)&m_d_col_idx, m_max_nnz * sizeof(IndexT)));
+        CUDA_ERROR(tracked_malloc((void**)&m_d_col_idx,
+                                  m_max_nnz * sizeof(IndexT),
+                                  MemoryCategory::Matrix));
 
         if (m_op == Op::VV) {
             rx.run_kernel<blockThreads>(
@@ -351,7 +365,9 @@ struct SparseMatrix
 
 
         // allocate value ptr
-        CUDA_ERROR(cudaMalloc((void**)&m_d_val, m_max_nnz * sizeof(T)));
+        CUDA_ERROR(tracked_malloc((void**)&m_d_val,
+                                  m_max_nnz * sizeof(T),
+                                  MemoryCategory::Matrix));
         CUDA_ERROR(cudaMemset(m_d_val, 0, m_nnz * sizeof(T)));
         m_allocated = m_allocated | DEVICE;
 
@@ -598,6 +614,25 @@ struct SparseMatrix
         return T(0);
     }
 
+    /**
+     * @brief return the index of the entry (x, y) in the values array, i.e.,
+     * such that get_val_at() returns the value of the entry. Return -1 if the
+     * entry is not a non-zero entry
+     */
+    __device__ __host__ IndexT get_val_idx(const IndexT x,
+                                           const IndexT y) const
+    {
+        const IndexT start = row_ptr()[x];
+        const IndexT end   = row_ptr()[x + 1];
+
+        for (IndexT i = start; i < end; ++i) {
+            if (col_idx()[i] == y) {
+                return i;
+            }
+        }
+        return -1;
+    }
+
 #ifdef USE_CUDSS
     /**
      * @brief Return cuDSS matrix
@@ -716,6 +751,7 @@ struct SparseMatrix
         GPU_FREE(m_d_cusparse_spmm_buffer);
         GPU_FREE(m_d_cusparse_spmv_buffer);
         GPU_FREE(m_d_row_acc);
+        disable_patch_spmv();
         if (m_cub_temp_storage_bytes > 0) {
             GPU_FREE(m_d_cub_temp_storage);
         }
@@ -734,13 +770,15 @@ struct SparseMatrix
      * We only allow the sparsity to change, i.e., the number of nnz values.
      * The size of the matrix should stay the same, i.e., #rows and #cols.
      * Note: d_rows and d_cols should include only new unique entries that does
-     * not exist in the in_mat
+     * not exist in the in_mat. Everything runs on stream except for the
+     * re-allocation when the new entries do not fit in the capacity
      */
     __host__ void insert(RXMeshStatic&    rx,
                          SparseMatrix<T>& in_mat,
                          const IndexT     size,
                          const IndexT*    d_new_rows,
-                         const IndexT*    d_new_cols)
+                         const IndexT*    d_new_cols,
+                         cudaStream_t     stream = NULL)
     {
         if (size == 0) {
             return;
@@ -757,15 +795,20 @@ struct SparseMatrix
                 in_mat.cols());
         }
 
+        // the new entries are not necessarily in the VV sparsity of the
+        // patches
+        disable_patch_spmv();
+
         IndexT* in_d_row_ptr = in_mat.m_d_row_ptr;
         IndexT* in_d_col_idx = in_mat.m_d_col_idx;
 
         constexpr uint32_t blockThreads = 256;
 
-        uint32_t blocks = DIVIDE_UP(rows(), blockThreads);
+        uint32_t blocks     = DIVIDE_UP(rows(), blockThreads);
+        uint32_t new_blocks = DIVIDE_UP(size, blockThreads);
 
         // read in_mat row sum
-        for_each_item<<<DIVIDE_UP(rows(), blockThreads), blockThreads>>>(
+        for_each_item<<<blocks, blockThreads, 0, stream>>>(
             rows(),
             [in_d_row_ptr = in_d_row_ptr,
              m_d_row_ptr  = m_d_row_ptr] __device__(int i) mutable {
@@ -774,7 +817,7 @@ struct SparseMatrix
         
 
         // add contribution of the new entries in the row sum
-        for_each_item<<<DIVIDE_UP(size, blockThreads), blockThreads>>>(
+        for_each_item<<<new_blocks, blockThreads, 0, stream>>>(
             size,
             [m_d_row_ptr = m_d_row_ptr,
              d_new_rows  = d_new_rows] __device__(int i) mutable {
@@ -784,20 +827,24 @@ struct SparseMatrix
             });        
 
         // prefix sum using CUB.
-        CUDA_ERROR(
-            cudaMemset(m_d_cub_temp_storage, 0, m_cub_temp_storage_bytes));
-        CUDA_ERROR(cudaMemset(m_d_row_ptr + m_num_rows, 0, sizeof(IndexT)));
+        CUDA_ERROR(cudaMemsetAsync(
+            m_d_cub_temp_storage, 0, m_cub_temp_storage_bytes, stream));
+        CUDA_ERROR(cudaMemsetAsync(
+            m_d_row_ptr + m_num_rows, 0, sizeof(IndexT), stream));
         cub::DeviceScan::ExclusiveSum(m_d_cub_temp_storage,
                                       m_cub_temp_storage_bytes,
                                       m_d_row_ptr,
                                       m_d_row_ptr,
-                                      m_num_rows + 1);
+                                      m_num_rows + 1,
+                                      stream);
 
         // get nnz
-        CUDA_ERROR(cudaMemcpy(&m_nnz,
-                              (m_d_row_ptr + m_num_rows),
-                              sizeof(IndexT),
-                              cudaMemcpyDeviceToHost));        
+        CUDA_ERROR(cudaMemcpyAsync(&m_nnz,
+                                   (m_d_row_ptr + m_num_rows),
+                                   sizeof(IndexT),
+                                   cudaMemcpyDeviceToHost,
+                                   stream));
+        CUDA_ERROR(cudaStreamSynchronize(stream));        
 
 
         if (m_nnz > m_max_nnz) {
@@ -819,9 +866,12 @@ struct SparseMatrix
             }
 
             // allocate col idx and values
-            CUDA_ERROR(cudaMalloc((void**)&m_d_val, m_max_nnz * sizeof(T)));
-            CUDA_ERROR(
-                cudaMalloc((void**)&m_d_col_idx, m_max_nnz * sizeof(IndexT)));
+            CUDA_ERROR(tracked_malloc((void**)&m_d_val,
+                                      m_max_nnz * sizeof(T),
+                                      MemoryCategory::Matrix));
+            CUDA_ERROR(tracked_malloc((void**)&m_d_col_idx,
+                                      m_max_nnz * sizeof(IndexT),
+                                      MemoryCategory::Matrix));
 
             m_h_val = static_cast<T*>(malloc(m_max_nnz * sizeof(T)));
             m_h_col_idx =
@@ -830,10 +880,11 @@ struct SparseMatrix
 
         // reset row accumulator so that we can keep track of the col_idx
         // of the new items
-        CUDA_ERROR(cudaMemset(m_d_row_acc, 0, m_num_rows * sizeof(IndexT)));
+        CUDA_ERROR(cudaMemsetAsync(
+            m_d_row_acc, 0, m_num_rows * sizeof(IndexT), stream));
 
         // fill in the col_idx with the col_idx data from in_mat
-        for_each_item<<<DIVIDE_UP(rows(), blockThreads), blockThreads>>>(
+        for_each_item<<<blocks, blockThreads, 0, stream>>>(
             rows(),
             [in_d_row_ptr = in_d_row_ptr,
              in_d_col_idx = in_d_col_idx,
@@ -864,7 +915,7 @@ struct SparseMatrix
         
 
         // fill in the col_idx with the new entries information
-        for_each_item<<<DIVIDE_UP(size, blockThreads), blockThreads>>>(
+        for_each_item<<<new_blocks, blockThreads, 0, stream>>>(
             size,
             [d_new_rows  = d_new_rows,
              d_new_cols  = d_new_cols,
@@ -883,14 +934,17 @@ struct SparseMatrix
             });
 
         // finally update the host (could be optional)
-        CUDA_ERROR(cudaMemcpy(m_h_col_idx,
-                              m_d_col_idx,
-                              m_nnz * sizeof(IndexT),
-                              cudaMemcpyDeviceToHost));
-        CUDA_ERROR(cudaMemcpy(m_h_row_ptr,
-                              m_d_row_ptr,
-                              (m_num_rows + 1) * sizeof(IndexT),
-                              cudaMemcpyDeviceToHost));
+        CUDA_ERROR(cudaMemcpyAsync(m_h_col_idx,
+                                   m_d_col_idx,
+                                   m_nnz * sizeof(IndexT),
+                                   cudaMemcpyDeviceToHost,
+                                   stream));
+        CUDA_ERROR(cudaMemcpyAsync(m_h_row_ptr,
+                                   m_d_row_ptr,
+                                   (m_num_rows + 1) * sizeof(IndexT),
+                                   cudaMemcpyDeviceToHost,
+                                   stream));
+        CUDA_ERROR(cudaStreamSynchronize(stream));
     }
 
     /*__host__ void insert(RXMeshStatic&    rx,
@@ -1068,11 +1122,14 @@ struct SparseMatrix
 
     /**
      * @brief return another SparseMatrix that is the transpose of this
-     * SparseMatrix. This function allocate memory on both host and device.
-     * Thus, it is not recommended to call it during the application multiple
-     * times
+     * SparseMatrix. The transpose is computed on the device (with cuSparse
+     * csr2csc) and is always allocated there while a host copy is made only
+     * if location includes HOST. This function allocates memory. Thus, it is
+     * not recommended to call it during the application multiple times. To
+     * refresh the values of the transpose of a matrix whose values change, use
+     * SparseTranspose (sparse_product.h)
      */
-    __host__ SparseMatrix<T> transpose() const
+    __host__ SparseMatrix<T> transpose(locationT location = LOCATION_ALL) const
     {
         if (m_op == Op::EVDiamond) {
             RXMESH_ERROR(
@@ -1088,21 +1145,20 @@ struct SparseMatrix
         ret.m_nnz             = m_nnz;
         ret.m_context         = m_context;
         ret.m_replicate       = m_replicate;
-        ret.m_allocated       = m_allocated;
+        ret.m_allocated       = DEVICE;
         ret.m_is_user_managed = false;
         ret.m_op              = transpose_op(m_op);
 
 
-        CUDA_ERROR(cudaMalloc((void**)&ret.m_d_row_ptr,
-                              (m_num_cols + 1) * sizeof(IndexT)));
-        CUDA_ERROR(
-            cudaMalloc((void**)&ret.m_d_col_idx, m_nnz * sizeof(IndexT)));
-        CUDA_ERROR(cudaMalloc((void**)&ret.m_d_val, m_nnz * sizeof(T)));
-
-        ret.m_h_val = static_cast<T*>(malloc(m_nnz * sizeof(T)));
-        ret.m_h_row_ptr =
-            static_cast<IndexT*>(malloc((m_num_cols + 1) * sizeof(IndexT)));
-        ret.m_h_col_idx = static_cast<IndexT*>(malloc(m_nnz * sizeof(IndexT)));
+        CUDA_ERROR(tracked_malloc((void**)&ret.m_d_row_ptr,
+                                  (m_num_cols + 1) * sizeof(IndexT),
+                                  MemoryCategory::Matrix));
+        CUDA_ERROR(tracked_malloc((void**)&ret.m_d_col_idx,
+                                  m_nnz * sizeof(IndexT),
+                                  MemoryCategory::Matrix));
+        CUDA_ERROR(tracked_malloc((void**)&ret.m_d_val,
+                                  m_nnz * sizeof(T),
+                                  MemoryCategory::Matrix));
 
         init_cusparse(ret);
         init_cudss(ret);
@@ -1128,7 +1184,9 @@ struct SparseMatrix
 
         void* buffer(nullptr);
 
-        CUDA_ERROR(cudaMalloc((void**)&buffer, buffer_size));
+        CUDA_ERROR(tracked_malloc((void**)&buffer,
+                                  buffer_size,
+                                  MemoryCategory::Matrix));
 
         CUSPARSE_ERROR(cusparseCsr2cscEx2(
             ret.m_cusparse_handle,
@@ -1149,7 +1207,18 @@ struct SparseMatrix
 
         GPU_FREE(buffer);
 
-        ret.move(DEVICE, HOST);
+        if ((location & HOST) == HOST) {
+            ret.allocate(HOST);
+            CUDA_ERROR(cudaMemcpy(ret.m_h_row_ptr,
+                                  ret.m_d_row_ptr,
+                                  (m_num_cols + 1) * sizeof(IndexT),
+                                  cudaMemcpyDeviceToHost));
+            CUDA_ERROR(cudaMemcpy(ret.m_h_col_idx,
+                                  ret.m_d_col_idx,
+                                  m_nnz * sizeof(IndexT),
+                                  cudaMemcpyDeviceToHost));
+            ret.move(DEVICE, HOST);
+        }
 
         return ret;
     }
@@ -1253,8 +1322,9 @@ struct SparseMatrix
                                                    cuda_type<T>(),
                                                    CUSPARSE_SPMM_ALG_DEFAULT,
                                                    &m_spmm_buffer_size));
-            CUDA_ERROR(
-                cudaMalloc(&m_d_cusparse_spmm_buffer, m_spmm_buffer_size));
+            CUDA_ERROR(tracked_malloc(&m_d_cusparse_spmm_buffer,
+                                      m_spmm_buffer_size,
+                                      MemoryCategory::Matrix));
         }
     }
 
@@ -1398,7 +1468,9 @@ struct SparseMatrix
         CUSPARSE_ERROR(cusparseDestroyDnVec(vecx));
         CUSPARSE_ERROR(cusparseDestroyDnVec(vecy));
 
-        CUDA_ERROR(cudaMalloc(&m_d_cusparse_spmv_buffer, m_spmv_buffer_size));
+        CUDA_ERROR(tracked_malloc(&m_d_cusparse_spmv_buffer,
+                                  m_spmv_buffer_size,
+                                  MemoryCategory::Matrix));
     }
 
 
@@ -1419,6 +1491,11 @@ struct SparseMatrix
      */
     __host__ void multiply(T* in_arr, T* rt_arr, cudaStream_t stream = 0)
     {
+        if (is_patch_spmv_enabled()) {
+            multiply_patch(in_arr, rt_arr, T(1), T(0), stream);
+            return;
+        }
+
         const T alpha = 1.0;
         const T beta  = 0.0;
 
@@ -1452,6 +1529,175 @@ struct SparseMatrix
         CUSPARSE_ERROR(cusparseDestroyDnVec(vecy));
     }
 
+    /**
+     * @brief build the patch-native SpMV of this matrix. The rows of a VV
+     * matrix are already ordered by patch (i.e., the owned vertices of a
+     * patch are contiguous) and so the values are stored in patch-blocked
+     * order. Here we store the column of every non-zero as its local index in
+     * the row patch so the SpMV can run with one block per patch that first
+     * loads the input vector entries of the patch (and its ribbon) into
+     * shared memory (see multiply_patch()). Once enabled, multiply() of a
+     * dense vector uses the patch SpMV instead of cuSparse. Only VV matrices
+     * of floating point type that are created from the mesh are supported.
+     * The patch SpMV is disabled by insert() since the new entries may not
+     * be in the patch VV sparsity
+     * @return true if the patch SpMV is enabled
+     */
+    __host__ bool enable_patch_spmv(const RXMeshStatic& rx)
+    {
+        if constexpr (!std::is_floating_point_v<T>) {
+            RXMESH_ERROR(
+                "SparseMatrix::enable_patch_spmv() only floating point types "
+                "are supported");
+            return false;
+        } else {
+            if (m_op != Op::VV || m_is_user_managed) {
+                RXMESH_ERROR(
+                    "SparseMatrix::enable_patch_spmv() only VV matrices "
+                    "created from the mesh are supported");
+                return false;
+            }
+
+            disable_patch_spmv();
+
+            constexpr uint32_t blockThreads = 256;
+
+            const uint32_t num_patches = rx.get_num_patches();
+
+            // per-patch offset of the vertices (owned and not-owned)
+            std::vector<IndexT> h_patch_v_ptr(num_patches + 1, 0);
+            IndexT              max_num_v = 0;
+            for (uint32_t p = 0; p < num_patches; ++p) {
+                const IndexT num_v   = rx.get_num_vertices(p);
+                h_patch_v_ptr[p + 1] = h_patch_v_ptr[p] + num_v;
+                max_num_v            = std::max(max_num_v, num_v);
+            }
+
+            if (max_num_v * m_replicate > (1 << 16)) {
+                RXMESH_ERROR(
+                    "SparseMatrix::enable_patch_spmv() the patch local "
+                    "column index does not fit in 16 bits");
+                return false;
+            }
+
+            const size_t smem_bytes =
+                size_t(max_num_v) * m_replicate * sizeof(T) +
+                ShmemAllocator::default_alignment;
+
+            int device_id;
+            CUDA_ERROR(cudaGetDevice(&device_id));
+            cudaDeviceProp devProp;
+            CUDA_ERROR(cudaGetDeviceProperties(&devProp, device_id));
+            if (smem_bytes > devProp.sharedMemPerBlockOptin) {
+                RXMESH_ERROR(
+                    "SparseMatrix::enable_patch_spmv() the patch SpMV "
+                    "requires {} bytes of shared memory which is more than "
+                    "the device limit ({} bytes)",
+                    smem_bytes,
+                    devProp.sharedMemPerBlockOptin);
+                return false;
+            }
+            CUDA_ERROR(cudaFuncSetAttribute(
+                (void*)detail::patch_spmv<T, blockThreads, IndexT>,
+                cudaFuncAttributeMaxDynamicSharedMemorySize,
+                int(smem_bytes)));
+
+            CUDA_ERROR(tracked_malloc((void**)&m_d_patch_v_ptr,
+                                      (num_patches + 1) * sizeof(IndexT),
+                                      MemoryCategory::Matrix));
+            CUDA_ERROR(tracked_malloc((void**)&m_d_patch_gather,
+                                      h_patch_v_ptr.back() * sizeof(IndexT),
+                                      MemoryCategory::Matrix));
+            CUDA_ERROR(tracked_malloc((void**)&m_d_patch_col,
+                                      m_nnz * sizeof(uint16_t),
+                                      MemoryCategory::Matrix));
+
+            CUDA_ERROR(cudaMemcpy(m_d_patch_v_ptr,
+                                  h_patch_v_ptr.data(),
+                                  (num_patches + 1) * sizeof(IndexT),
+                                  cudaMemcpyHostToDevice));
+            // vertices that are not used by any owned vertex (e.g., deleted)
+            // are marked with -1
+            CUDA_ERROR(cudaMemset(m_d_patch_gather,
+                                  INVALID8,
+                                  h_patch_v_ptr.back() * sizeof(IndexT)));
+
+            rx.run_kernel<blockThreads>(
+                {Op::VV},
+                detail::sparse_mat_patch_col_fill<blockThreads, IndexT>,
+                m_d_row_ptr,
+                m_d_patch_v_ptr,
+                m_d_patch_gather,
+                m_d_patch_col,
+                m_replicate);
+
+            m_patch_spmv_num_patches = num_patches;
+            m_patch_spmv_smem_bytes  = smem_bytes;
+
+            return true;
+        }
+    }
+
+    /**
+     * @brief free the patch SpMV data and go back to cuSparse SpMV
+     */
+    __host__ void disable_patch_spmv()
+    {
+        GPU_FREE(m_d_patch_v_ptr);
+        GPU_FREE(m_d_patch_gather);
+        GPU_FREE(m_d_patch_col);
+        m_patch_spmv_num_patches = 0;
+        m_patch_spmv_smem_bytes  = 0;
+    }
+
+    /**
+     * @brief check if the patch-native SpMV is enabled
+     */
+    __host__ bool is_patch_spmv_enabled() const
+    {
+        return m_d_patch_col != nullptr;
+    }
+
+    /**
+     * @brief multiply the sparse matrix by a dense vector using the
+     * patch-native SpMV (see enable_patch_spmv()) as
+     * Y = alpha*A*X + beta*Y
+     * This does not require any cuSparse buffer
+     */
+    __host__ void multiply_patch(const T*     in_arr,
+                                 T*           rt_arr,
+                                 T            alpha  = 1.,
+                                 T            beta   = 0.,
+                                 cudaStream_t stream = 0)
+    {
+        if constexpr (std::is_floating_point_v<T>) {
+            if (!is_patch_spmv_enabled()) {
+                RXMESH_ERROR(
+                    "SparseMatrix::multiply_patch() the patch SpMV is not "
+                    "enabled. Call enable_patch_spmv() first");
+                return;
+            }
+
+            constexpr uint32_t blockThreads = 256;
+
+            detail::patch_spmv<T, blockThreads, IndexT>
+                <<<m_patch_spmv_num_patches,
+                   blockThreads,
+                   m_patch_spmv_smem_bytes,
+                   stream>>>(m_context,
+                             m_d_row_ptr,
+                             m_d_val,
+                             m_d_patch_col,
+                             m_d_patch_v_ptr,
+                             m_d_patch_gather,
+                             m_replicate,
+                             in_arr,
+                             rt_arr,
+                             alpha,
+                             beta);
+        }
+    }
+
     /**
      * @brief multiply the sparse matrix by a dense matrix. The function
      * performs the multiplication as
@@ -1556,11 +1802,15 @@ struct SparseMatrix
         if ((location & DEVICE) == DEVICE) {
             release(DEVICE);
 
-            CUDA_ERROR(cudaMalloc((void**)&m_d_val, m_nnz * sizeof(T)));
-            CUDA_ERROR(cudaMalloc((void**)&m_d_row_ptr,
-                                  (m_num_rows + 1) * sizeof(IndexT)));
-            CUDA_ERROR(
-                cudaMalloc((void**)&m_d_col_idx, m_nnz * sizeof(IndexT)));
+            CUDA_ERROR(tracked_malloc((void**)&m_d_val,
+                                      m_nnz * sizeof(T),
+                                      MemoryCategory::Matrix));
+            CUDA_ERROR(tracked_malloc((void**)&m_d_row_ptr,
+                                      (m_num_rows + 1) * sizeof(IndexT),
+                                      MemoryCategory::Matrix));
+            CUDA_ERROR(tracked_malloc((void**)&m_d_col_idx,
+                                      m_nnz * sizeof(IndexT),
+                                      MemoryCategory::Matrix));
 
             m_allocated = m_allocated | DEVICE;
         }
@@ -1690,6 +1940,15 @@ struct SparseMatrix
 
     Op m_op;
 
+    // patch-native SpMV (see enable_patch_spmv()). Per-patch offset into
+    // m_d_patch_gather which holds the global row id of every vertex in the
+    // patch, and the patch-local column index of every non-zero
+    IndexT*   m_d_patch_v_ptr;
+    IndexT*   m_d_patch_gather;
+    uint16_t* m_d_patch_col;
+    uint32_t  m_patch_spmv_num_patches;
+    size_t    m_patch_spmv_smem_bytes;
+
 #ifdef USE_CUDSS
     cudssMatrix_t m_cudss_matrix;
 #endif
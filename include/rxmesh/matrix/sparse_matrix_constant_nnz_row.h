@@ -11,6 +11,9 @@ struct SparseMatrixConstantNNZRow : public SparseMatrix<T>
 {
     using IndexT = typename SparseMatrix<T>::IndexT;
 
+    // the number of rows per slice of the SELL-C storage (see enable_sell())
+    static constexpr int sell_slice = 32;
+
     /**
      * @brief the constructor only builds the row_ptr. The user is responsible
      * of populating the col_idx and moving it to the device/host. Pointer to
@@ -19,7 +22,7 @@ struct SparseMatrixConstantNNZRow : public SparseMatrix<T>
     SparseMatrixConstantNNZRow(const RXMeshStatic& rx,
                                IndexT              num_rows,
                                IndexT              num_cols)
-        : SparseMatrix<T>()
+        : SparseMatrix<T>(), m_d_sell_col(nullptr), m_d_sell_val(nullptr)
     {
         this->m_context   = rx.get_context();
         this->m_replicate = 1;
@@ -31,11 +34,15 @@ struct SparseMatrixConstantNNZRow : public SparseMatrix<T>
         int num_row_1 = this->m_num_rows + 1;
 
         // alloc device
-        CUDA_ERROR(cudaMalloc((void**)&this->m_d_col_idx,
-                              this->m_nnz * sizeof(IndexT)));
-        CUDA_ERROR(cudaMalloc((void**)&this->m_d_val, this->m_nnz * sizeof(T)));
-        CUDA_ERROR(
-            cudaMalloc((void**)&this->m_d_row_ptr, num_row_1 * sizeof(IndexT)));
+        CUDA_ERROR(tracked_malloc((void**)&this->m_d_col_idx,
+                                  this->m_nnz * sizeof(IndexT),
+                                  MemoryCategory::Matrix));
+        CUDA_ERROR(tracked_malloc((void**)&this->m_d_val,
+                                  this->m_nnz * sizeof(T),
+                                  MemoryCategory::Matrix));
+        CUDA_ERROR(tracked_malloc((void**)&this->m_d_row_ptr,
+                                  num_row_1 * sizeof(IndexT),
+                                  MemoryCategory::Matrix));
 
 
         this->m_allocated = this->m_allocated | DEVICE;
@@ -129,5 +136,161 @@ struct SparseMatrixConstantNNZRow : public SparseMatrix<T>
                                        stream));
         }
     }
+
+    /**
+     * @brief build the sliced ELLPACK (SELL-C with C = sell_slice) copy of
+     * the matrix on the device. Since every row has exactly RowNNZ non-zeros,
+     * no padding is needed within a slice and the rows are not sorted. The
+     * j-th non-zero of consecutive rows are stored contiguously such that a
+     * warp with one thread per row coalesces its loads of the column indices
+     * and values (which CSR does not, since consecutive rows are RowNNZ
+     * entries apart). Once enabled, use multiply_sell(). The SELL copy is not
+     * updated if the column indices or values are changed on the device
+     * afterwards. Call update_sell() to refresh it
+     */
+    __host__ void enable_sell(cudaStream_t stream = NULL)
+    {
+        if (!is_sell_enabled()) {
+            const IndexT padded_nnz =
+                DIVIDE_UP(this->m_num_rows, sell_slice) * sell_slice * RowNNZ;
+
+            CUDA_ERROR(tracked_malloc((void**)&m_d_sell_col,
+                                      padded_nnz * sizeof(IndexT),
+                                      MemoryCategory::Matrix));
+            CUDA_ERROR(tracked_malloc((void**)&m_d_sell_val,
+                                      padded_nnz * sizeof(T),
+                                      MemoryCategory::Matrix));
+        }
+        update_sell(stream);
+    }
+
+    /**
+     * @brief copy the current column indices and values on the device into
+     * the SELL copy
+     */
+    __host__ void update_sell(cudaStream_t stream = NULL)
+    {
+        if (!is_sell_enabled()) {
+            RXMESH_ERROR(
+                "SparseMatrixConstantNNZRow::update_sell() SELL is not "
+                "enabled. Call enable_sell() first");
+            return;
+        }
+
+        constexpr uint32_t blockThreads = 256;
+
+        detail::csr_to_sell<T, sell_slice, RowNNZ>
+            <<<DIVIDE_UP(this->m_nnz, blockThreads),
+               blockThreads,
+               0,
+               stream>>>(this->m_num_rows,
+                         this->m_d_col_idx,
+                         this->m_d_val,
+                         m_d_sell_col,
+                         m_d_sell_val);
+    }
+
+    /**
+     * @brief free the SELL copy
+     */
+    __host__ void disable_sell()
+    {
+        GPU_FREE(m_d_sell_col);
+        GPU_FREE(m_d_sell_val);
+    }
+
+    /**
+     * @brief check if the SELL copy is built
+     */
+    __host__ bool is_sell_enabled() const
+    {
+        return m_d_sell_col != nullptr;
+    }
+
+    /**
+     * @brief multiply the matrix by a dense matrix using the SELL copy (see
+     * enable_sell()) as
+     * C = alpha.op(A) * B + beta.C
+     * where op could be the transpose (set via is_a_transpose) which scatters
+     * the result using atomics. This does not require any cuSparse buffer
+     */
+    template <int Order>
+    __host__ void multiply_sell(const DenseMatrix<T, Order>& B_mat,
+                                DenseMatrix<T, Order>&       C_mat,
+                                bool         is_a_transpose = false,
+                                T            alpha          = 1.,
+                                T            beta           = 0.,
+                                cudaStream_t stream         = 0)
+    {
+        if (!is_sell_enabled()) {
+            RXMESH_ERROR(
+                "SparseMatrixConstantNNZRow::multiply_sell() SELL is not "
+                "enabled. Call enable_sell() first");
+            return;
+        }
+
+        assert(B_mat.cols() == C_mat.cols());
+
+        constexpr uint32_t blockThreads = 256;
+
+        const IndexT num_rows = this->m_num_rows;
+        const int    num_cols = B_mat.cols();
+        const int    blocks   = DIVIDE_UP(num_rows, blockThreads);
+
+        if (!is_a_transpose) {
+            assert(this->cols() == B_mat.rows());
+            assert(this->rows() == C_mat.rows());
+
+            detail::sell_spmv<T, sell_slice, RowNNZ>
+                <<<blocks, blockThreads, 0, stream>>>(num_rows,
+                                                      m_d_sell_col,
+                                                      m_d_sell_val,
+                                                      B_mat,
+                                                      C_mat,
+                                                      num_cols,
+                                                      alpha,
+                                                      beta);
+        } else {
+            assert(this->rows() == B_mat.rows());
+            assert(this->cols() == C_mat.rows());
+
+            DenseMatrix<T, Order> out = C_mat;
+
+            const IndexT n = this->m_num_cols;
+            for_each_item<<<DIVIDE_UP(n, blockThreads),
+                            blockThreads,
+                            0,
+                            stream>>>(
+                n, [out, beta, num_cols] __device__(int i) mutable {
+                    for (int c = 0; c < num_cols; ++c) {
+                        out(i, c) = (beta == T(0)) ? T(0) : beta * out(i, c);
+                    }
+                });
+
+            detail::sell_spmv_transpose<T, sell_slice, RowNNZ>
+                <<<blocks, blockThreads, 0, stream>>>(num_rows,
+                                                      m_d_sell_col,
+                                                      m_d_sell_val,
+                                                      B_mat,
+                                                      C_mat,
+                                                      num_cols,
+                                                      alpha);
+        }
+    }
+
+    using SparseMatrix<T>::release;
+
+    /**
+     * @brief release all allocated memory including the SELL copy
+     */
+    __host__ void release()
+    {
+        disable_sell();
+        SparseMatrix<T>::release();
+    }
+
+   protected:
+    IndexT* m_d_sell_col;
+    T*      m_d_sell_val;
 };
 }  // namespace rxmesh
\ No newline at end of file
@@ -123,6 +123,403 @@ __global__ static void sparse_mat_col_fill(const rxmesh::Context context,
     query.dispatch<op>(block, shrd_alloc, col_fillin);
 }
 
+
+/**
+ * @brief build the patch-local column index of a VV sparse matrix (see
+ * SparseMatrix::enable_patch_spmv()). Using the same VV query that fills the
+ * column index, the column of every non-zero is stored as the local index of
+ * the column vertex inside the row patch (times replicate) and the global row
+ * id of every vertex in the patch (owned or not-owned) is stored in
+ * patch_gather
+ */
+template <uint32_t blockThreads, typename IndexT = int>
+__global__ static void sparse_mat_patch_col_fill(
+    const rxmesh::Context context,
+    const IndexT*         row_ptr,
+    const IndexT*         patch_v_ptr,
+    IndexT*               patch_gather,
+    uint16_t*             patch_col,
+    IndexT                replicate)
+{
+    using namespace rxmesh;
+
+    auto col_fillin = [&](VertexHandle& v_id, const VertexIterator& iter) {
+        auto     ids      = v_id.unpack();
+        uint32_t patch_id = ids.first;
+        uint16_t local_id = ids.second;
+
+        const IndexT v_global = context.vertex_prefix()[patch_id] + local_id;
+
+        IndexT* gather = patch_gather + patch_v_ptr[patch_id];
+
+        gather[local_id] = v_global;
+
+        for (IndexT i = 0; i < replicate; ++i) {
+            IndexT v_base_offset = row_ptr[v_global * replicate + i];
+            for (IndexT j = 0; j < replicate; ++j) {
+                patch_col[v_base_offset + j] = local_id * replicate + j;
+            }
+        }
+
+        for (uint32_t q = 0; q < iter.size(); ++q) {
+            auto           q_ids   = iter[q].unpack();
+            const uint16_t q_local = iter.local(q);
+
+            // not-owned vertices appear in the iterator of multiple owned
+            // vertices but they all write the same value
+            gather[q_local] =
+                context.vertex_prefix()[q_ids.first] + q_ids.second;
+
+            for (IndexT i = 0; i < replicate; ++i) {
+                IndexT q_base_offset =
+                    row_ptr[v_global * replicate + i] + q * replicate;
+                for (IndexT j = 0; j < replicate; ++j) {
+                    patch_col[q_base_offset + j + replicate] =
+                        q_local * replicate + j;
+                }
+            }
+        }
+    };
+
+    auto                block = cooperative_groups::this_thread_block();
+    Query<blockThreads> query(context);
+    ShmemAllocator      shrd_alloc;
+    query.dispatch<Op::VV>(block, shrd_alloc, col_fillin);
+}
+
+/**
+ * @brief patch-native SpMV of a VV sparse matrix y = alpha*A*x + beta*y with
+ * one block per patch. The entries of x that are used by the patch (owned and
+ * ribbon vertices) are first gathered into shared memory and then every
+ * thread computes one row of the owned vertices of the patch using the
+ * patch-local column index
+ */
+template <typename T, uint32_t blockThreads, typename IndexT = int>
+__global__ static void patch_spmv(const rxmesh::Context context,
+                                  const IndexT*         row_ptr,
+                                  const T*              val,
+                                  const uint16_t*       patch_col,
+                                  const IndexT*         patch_v_ptr,
+                                  const IndexT*         patch_gather,
+                                  const IndexT          replicate,
+                                  const T*              x,
+                                  T*                    y,
+                                  const T               alpha,
+                                  const T               beta)
+{
+    using namespace rxmesh;
+
+    const uint32_t p = blockIdx.x;
+
+    const IndexT  num_v  = patch_v_ptr[p + 1] - patch_v_ptr[p];
+    const IndexT* gather = patch_gather + patch_v_ptr[p];
+
+    ShmemAllocator shrd_alloc;
+    T*             s_x = shrd_alloc.alloc<T>(num_v * replicate);
+
+    for (IndexT i = threadIdx.x; i < num_v * replicate; i += blockThreads) {
+        const IndexT v = gather[i / replicate];
+        s_x[i]         = (v < 0) ? T(0) : x[v * replicate + i % replicate];
+    }
+    __syncthreads();
+
+    const IndexT row_start = context.vertex_prefix()[p] * replicate;
+    const IndexT row_end   = context.vertex_prefix()[p + 1] * replicate;
+
+    for (IndexT r = row_start + threadIdx.x; r < row_end; r += blockThreads) {
+        T sum = 0;
+        for (IndexT j = row_ptr[r]; j < row_ptr[r + 1]; ++j) {
+            sum += val[j] * s_x[patch_col[j]];
+        }
+        if (beta == T(0)) {
+            y[r] = alpha * sum;
+        } else {
+            y[r] = alpha * sum + beta * y[r];
+        }
+    }
+}
+
+/**
+ * @brief view a raw device array as a one-column matrix so it can be used
+ * with the block sparse kernels the same way as DenseMatrix
+ */
+template <typename T>
+struct RawVector
+{
+    T* m_ptr;
+
+    __device__ __inline__ T& operator()(const int row, const int = 0) const
+    {
+        return m_ptr[row];
+    }
+};
+
+/**
+ * @brief BSR SpMV out = alpha*A*in + beta*out with one thread per block row.
+ * The K entries of the input for every non-zero block are loaded into
+ * registers and multiplied by the KxK (row-major) block
+ */
+template <typename T, int K, typename InT, typename OutT, typename IndexT>
+__global__ static void bsr_spmv(const IndexT  num_block_rows,
+                                const IndexT* row_ptr,
+                                const IndexT* col_idx,
+                                const T*      val,
+                                const InT     in,
+                                OutT          out,
+                                const int     num_cols,
+                                const T       alpha,
+                                const T       beta)
+{
+    const IndexT r = threadIdx.x + blockIdx.x * blockDim.x;
+    if (r >= num_block_rows) {
+        return;
+    }
+
+    for (int c = 0; c < num_cols; ++c) {
+        T acc[K];
+        for (int i = 0; i < K; ++i) {
+            acc[i] = 0;
+        }
+
+        for (IndexT b = row_ptr[r]; b < row_ptr[r + 1]; ++b) {
+            const IndexT col   = col_idx[b];
+            const T*     block = val + b * K * K;
+
+            T x[K];
+            for (int k = 0; k < K; ++k) {
+                x[k] = in(col * K + k, c);
+            }
+            for (int i = 0; i < K; ++i) {
+                for (int k = 0; k < K; ++k) {
+                    acc[i] += block[i * K + k] * x[k];
+                }
+            }
+        }
+
+        for (int i = 0; i < K; ++i) {
+            T& y = out(r * K + i, c);
+            if (beta == T(0)) {
+                y = alpha * acc[i];
+            } else {
+                y = alpha * acc[i] + beta * y;
+            }
+        }
+    }
+}
+
+/**
+ * @brief BSR transpose SpMV out += alpha*A^T*in with one thread per block row
+ * that scatters the contribution of its blocks using atomics. out should be
+ * scaled by beta before calling this kernel
+ */
+template <typename T, int K, typename InT, typename OutT, typename IndexT>
+__global__ static void bsr_spmv_transpose(const IndexT  num_block_rows,
+                                          const IndexT* row_ptr,
+                                          const IndexT* col_idx,
+                                          const T*      val,
+                                          const InT     in,
+                                          OutT          out,
+                                          const int     num_cols,
+                                          const T       alpha)
+{
+    const IndexT r = threadIdx.x + blockIdx.x * blockDim.x;
+    if (r >= num_block_rows) {
+        return;
+    }
+
+    for (int c = 0; c < num_cols; ++c) {
+        T x[K];
+        for (int i = 0; i < K; ++i) {
+            x[i] = alpha * in(r * K + i, c);
+        }
+
+        for (IndexT b = row_ptr[r]; b < row_ptr[r + 1]; ++b) {
+            const IndexT col   = col_idx[b];
+            const T*     block = val + b * K * K;
+
+            for (int k = 0; k < K; ++k) {
+                T sum = 0;
+                for (int i = 0; i < K; ++i) {
+                    sum += block[i * K + k] * x[i];
+                }
+                ::atomicAdd(&out(col * K + k, c), sum);
+            }
+        }
+    }
+}
+
+/**
+ * @brief the position of every non-zero of a CSR matrix within its transpose
+ * (whose row indices per column are sorted as written by csr2csc) with one
+ * thread per row
+ */
+template <typename IndexT>
+__global__ static void csr_transpose_permutation(const IndexT  num_rows,
+                                                 const IndexT* row_ptr,
+                                                 const IndexT* col_idx,
+                                                 const IndexT* t_row_ptr,
+                                                 const IndexT* t_col_idx,
+                                                 IndexT*       perm)
+{
+    const IndexT r = threadIdx.x + blockIdx.x * blockDim.x;
+    if (r >= num_rows) {
+        return;
+    }
+
+    for (IndexT i = row_ptr[r]; i < row_ptr[r + 1]; ++i) {
+        const IndexT c = col_idx[i];
+
+        // binary search for r among the rows of the column c
+        IndexT lo = t_row_ptr[c], hi = t_row_ptr[c + 1];
+        while (lo < hi) {
+            const IndexT mid = lo + (hi - lo) / 2;
+            if (t_col_idx[mid] < r) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        assert(lo < t_row_ptr[c + 1] && t_col_idx[lo] == r);
+        perm[i] = lo;
+    }
+}
+
+/**
+ * @brief out[perm[i]] = in[i] for every non-zero i
+ */
+template <typename T, typename IndexT>
+__global__ static void scatter_values(const IndexT  nnz,
+                                      const IndexT* perm,
+                                      const T*      in,
+                                      T*            out)
+{
+    const IndexT i = threadIdx.x + blockIdx.x * blockDim.x;
+    if (i < nnz) {
+        out[perm[i]] = in[i];
+    }
+}
+
+/**
+ * @brief the position of the j-th non-zero of row r in the sliced ELLPACK
+ * (SELL-C) storage of a matrix with RowNNZ non-zeros per row. Every slice of
+ * C consecutive rows stores the j-th non-zero of its rows contiguously so
+ * that C threads working on consecutive rows read consecutive addresses
+ */
+template <int C, int RowNNZ, typename IndexT>
+__device__ __forceinline__ IndexT sell_index(const IndexT r, const int j)
+{
+    return ((r / C) * RowNNZ + j) * C + (r % C);
+}
+
+/**
+ * @brief copy the column indices and values of a CSR matrix with RowNNZ
+ * non-zeros per row into the SELL-C storage with one thread per non-zero
+ */
+template <typename T, int C, int RowNNZ, typename IndexT>
+__global__ static void csr_to_sell(const IndexT  num_rows,
+                                   const IndexT* col_idx,
+                                   const T*      val,
+                                   IndexT*       sell_col,
+                                   T*            sell_val)
+{
+    const IndexT i = threadIdx.x + blockIdx.x * blockDim.x;
+    if (i >= num_rows * RowNNZ) {
+        return;
+    }
+    const IndexT r = i / RowNNZ;
+    const int    j = i % RowNNZ;
+
+    const IndexT s = sell_index<C, RowNNZ>(r, j);
+
+    sell_col[s] = col_idx[i];
+    sell_val[s] = val[i];
+}
+
+/**
+ * @brief SELL-C SpMV out = alpha*A*in + beta*out with one thread per row
+ */
+template <typename T,
+          int C,
+          int RowNNZ,
+          typename InT,
+          typename OutT,
+          typename IndexT>
+__global__ static void sell_spmv(const IndexT  num_rows,
+                                 const IndexT* sell_col,
+                                 const T*      sell_val,
+                                 const InT     in,
+                                 OutT          out,
+                                 const int     num_cols,
+                                 const T       alpha,
+                                 const T       beta)
+{
+    const IndexT r = threadIdx.x + blockIdx.x * blockDim.x;
+    if (r >= num_rows) {
+        return;
+    }
+
+    IndexT col[RowNNZ];
+    T      val[RowNNZ];
+    for (int j = 0; j < RowNNZ; ++j) {
+        const IndexT s = sell_index<C, RowNNZ>(r, j);
+        col[j]         = sell_col[s];
+        val[j]         = sell_val[s];
+    }
+
+    for (int c = 0; c < num_cols; ++c) {
+        T acc = 0;
+        for (int j = 0; j < RowNNZ; ++j) {
+            acc += val[j] * in(col[j], c);
+        }
+        T& y = out(r, c);
+        if (beta == T(0)) {
+            y = alpha * acc;
+        } else {
+            y = alpha * acc + beta * y;
+        }
+    }
+}
+
+/**
+ * @brief SELL-C transpose SpMV out += alpha*A^T*in with one thread per row
+ * that scatters its non-zeros using atomics. out should be scaled by beta
+ * before calling this kernel
+ */
+template <typename T,
+          int C,
+          int RowNNZ,
+          typename InT,
+          typename OutT,
+          typename IndexT>
+__global__ static void sell_spmv_transpose(const IndexT  num_rows,
+                                           const IndexT* sell_col,
+                                           const T*      sell_val,
+                                           const InT     in,
+                                           OutT          out,
+                                           const int     num_cols,
+                                           const T       alpha)
+{
+    const IndexT r = threadIdx.x + blockIdx.x * blockDim.x;
+    if (r >= num_rows) {
+        return;
+    }
+
+    IndexT col[RowNNZ];
+    T      val[RowNNZ];
+    for (int j = 0; j < RowNNZ; ++j) {
+        const IndexT s = sell_index<C, RowNNZ>(r, j);
+        col[j]         = sell_col[s];
+        val[j]         = alpha * sell_val[s];
+    }
+
+    for (int c = 0; c < num_cols; ++c) {
+        const T x = in(r, c);
+        for (int j = 0; j < RowNNZ; ++j) {
+            ::atomicAdd(&out(col[j], c), val[j] * x);
+        }
+    }
+}
+
 }  // namespace detail
 
 }  // namespace rxmesh
\ No newline at end of file
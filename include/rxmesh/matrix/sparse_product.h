@@ -0,0 +1,380 @@
+#pragma once
+
+#include "cusparse.h"
+
+#include "rxmesh/matrix/sparse_matrix.h"
+#include "rxmesh/matrix/sparse_matrix_kernels.cuh"
+
+namespace rxmesh {
+
+/**
+ * @brief the transpose of a SparseMatrix A whose sparsity pattern is computed
+ * once on the device and whose values can be refreshed with update() (one
+ * scatter kernel) every time the values of A change but its pattern does not,
+ * e.g., across Newton iterations. The transpose lives on the device only
+ */
+template <typename T>
+struct SparseTranspose
+{
+    using IndexT = typename SparseMatrix<T>::IndexT;
+
+    SparseTranspose() : m_a(nullptr), m_d_perm(nullptr)
+    {
+    }
+
+    /**
+     * @brief compute the transpose of A (pattern and values)
+     */
+    SparseTranspose(const SparseMatrix<T>& A)
+        : m_a(&A), m_at(A.transpose(DEVICE)), m_d_perm(nullptr)
+    {
+        const IndexT nnz = A.non_zeros();
+
+        CUDA_ERROR(tracked_malloc((void**)&m_d_perm,
+                                  nnz * sizeof(IndexT),
+                                  MemoryCategory::Matrix));
+
+        const int threads = 256;
+        detail::csr_transpose_permutation<<<DIVIDE_UP(A.rows(), threads),
+                                            threads>>>(A.rows(),
+                                                       A.row_ptr(DEVICE),
+                                                       A.col_idx(DEVICE),
+                                                       m_at.row_ptr(DEVICE),
+                                                       m_at.col_idx(DEVICE),
+                                                       m_d_perm);
+        CUDA_ERROR(cudaGetLastError());
+    }
+
+    /**
+     * @brief the transpose of A
+     */
+    SparseMatrix<T>& matrix()
+    {
+        return m_at;
+    }
+
+    /**
+     * @brief copy the (device) values of A into their place in the transpose.
+     * The sparsity pattern of A should not have changed since the
+     * construction
+     */
+    void update(cudaStream_t stream = NULL)
+    {
+        assert(m_a != nullptr);
+        const IndexT nnz     = m_a->non_zeros();
+        const int    threads = 256;
+        detail::scatter_values<<<DIVIDE_UP(nnz, threads), threads, 0, stream>>>(
+            nnz, m_d_perm, m_a->val_ptr(DEVICE), m_at.val_ptr(DEVICE));
+    }
+
+    /**
+     * @brief release the transpose and the permutation
+     */
+    void release()
+    {
+        if (m_a == nullptr) {
+            return;
+        }
+        m_at.release();
+        GPU_FREE(m_d_perm);
+        m_a = nullptr;
+    }
+
+   private:
+    const SparseMatrix<T>* m_a;
+    SparseMatrix<T>        m_at;
+    IndexT*                m_d_perm;
+};
+
+
+/**
+ * @brief the sparse-sparse product C = A * B on the device (with the cuSparse
+ * SpGEMM reuse API) where the symbolic phases (work estimation, the sparsity
+ * pattern of C and its allocation) are done once in the constructor and every
+ * call to multiply() only redoes the numeric phase. Thus, products of
+ * matrices with the same sparsity patterns but different values (e.g.,
+ * Galerkin operators P^T * A * P across Newton iterations) only pay for the
+ * numeric phase. A and B should not be released before this product. C is
+ * allocated on both host and device where the host holds the sparsity
+ * pattern. Use C.move(DEVICE, HOST) to get its values on the host. Chained
+ * products (e.g., P^T * A * P) are two SpGEMM where the output of the first
+ * is the input of the second
+ */
+template <typename T>
+struct SpGEMM
+{
+    using IndexT = typename SparseMatrix<T>::IndexT;
+
+    SpGEMM()
+        : m_a(nullptr),
+          m_b(nullptr),
+          m_spgemm_desc(NULL),
+          m_c_spdescr(NULL),
+          m_d_buffer4(nullptr),
+          m_d_buffer5(nullptr),
+          m_d_c_row_ptr(nullptr),
+          m_d_c_col_idx(nullptr),
+          m_d_c_val(nullptr),
+          m_h_c_row_ptr(nullptr),
+          m_h_c_col_idx(nullptr),
+          m_h_c_val(nullptr)
+    {
+    }
+
+    /**
+     * @brief run the symbolic phases and the first numeric phase of A * B
+     */
+    SpGEMM(SparseMatrix<T>& A, SparseMatrix<T>& B) : SpGEMM()
+    {
+        if (A.cols() != B.rows()) {
+            RXMESH_ERROR(
+                "SpGEMM::SpGEMM() mismatch in the matrices dimensions. A is "
+                "{}x{} and B is {}x{}",
+                A.rows(),
+                A.cols(),
+                B.rows(),
+                B.cols());
+            return;
+        }
+
+        m_a = &A;
+        m_b = &B;
+
+        const IndexT c_rows = A.rows();
+        const IndexT c_cols = B.cols();
+
+        cusparseHandle_t handle = A.m_cusparse_handle;
+
+        CUSPARSE_ERROR(cusparseSpGEMM_createDescr(&m_spgemm_desc));
+
+        CUDA_ERROR(tracked_malloc((void**)&m_d_c_row_ptr,
+                                  (c_rows + 1) * sizeof(IndexT),
+                                  MemoryCategory::Matrix));
+
+        CUSPARSE_ERROR(cusparseCreateCsr(&m_c_spdescr,
+                                         c_rows,
+                                         c_cols,
+                                         0,
+                                         m_d_c_row_ptr,
+                                         nullptr,
+                                         nullptr,
+                                         CUSPARSE_INDEX_32I,
+                                         CUSPARSE_INDEX_32I,
+                                         CUSPARSE_INDEX_BASE_ZERO,
+                                         cuda_type<T>()));
+
+        // work estimation
+        size_t buffer1_size = 0;
+        void*  d_buffer1    = nullptr;
+        CUSPARSE_ERROR(cusparseSpGEMMreuse_workEstimation(handle,
+                                                          op_a,
+                                                          op_b,
+                                                          A.m_spdescr,
+                                                          B.m_spdescr,
+                                                          m_c_spdescr,
+                                                          alg,
+                                                          m_spgemm_desc,
+                                                          &buffer1_size,
+                                                          nullptr));
+        CUDA_ERROR(
+            tracked_malloc(&d_buffer1, buffer1_size, MemoryCategory::Matrix));
+        CUSPARSE_ERROR(cusparseSpGEMMreuse_workEstimation(handle,
+                                                          op_a,
+                                                          op_b,
+                                                          A.m_spdescr,
+                                                          B.m_spdescr,
+                                                          m_c_spdescr,
+                                                          alg,
+                                                          m_spgemm_desc,
+                                                          &buffer1_size,
+                                                          d_buffer1));
+
+        // the sparsity pattern of C
+        size_t buffer2_size = 0, buffer3_size = 0, buffer4_size = 0;
+        void*  d_buffer2    = nullptr;
+        void*  d_buffer3    = nullptr;
+        CUSPARSE_ERROR(cusparseSpGEMMreuse_nnz(handle,
+                                               op_a,
+                                               op_b,
+                                               A.m_spdescr,
+                                               B.m_spdescr,
+                                               m_c_spdescr,
+                                               alg,
+                                               m_spgemm_desc,
+                                               &buffer2_size,
+                                               nullptr,
+                                               &buffer3_size,
+                                               nullptr,
+                                               &buffer4_size,
+                                               nullptr));
+        CUDA_ERROR(
+            tracked_malloc(&d_buffer2, buffer2_size, MemoryCategory::Matrix));
+        CUDA_ERROR(
+            tracked_malloc(&d_buffer3, buffer3_size, MemoryCategory::Matrix));
+        CUDA_ERROR(
+            tracked_malloc(&m_d_buffer4, buffer4_size, MemoryCategory::Matrix));
+        CUSPARSE_ERROR(cusparseSpGEMMreuse_nnz(handle,
+                                               op_a,
+                                               op_b,
+                                               A.m_spdescr,
+                                               B.m_spdescr,
+                                               m_c_spdescr,
+                                               alg,
+                                               m_spgemm_desc,
+                                               &buffer2_size,
+                                               d_buffer2,
+                                               &buffer3_size,
+                                               d_buffer3,
+                                               &buffer4_size,
+                                               m_d_buffer4));
+        GPU_FREE(d_buffer1);
+        GPU_FREE(d_buffer2);
+
+        int64_t cr, cc, c_nnz;
+        CUSPARSE_ERROR(cusparseSpMatGetSize(m_c_spdescr, &cr, &cc, &c_nnz));
+        assert(cr == c_rows);
+        assert(cc == c_cols);
+
+        CUDA_ERROR(tracked_malloc((void**)&m_d_c_col_idx,
+                                  c_nnz * sizeof(IndexT),
+                                  MemoryCategory::Matrix));
+        CUDA_ERROR(tracked_malloc((void**)&m_d_c_val,
+                                  c_nnz * sizeof(T),
+                                  MemoryCategory::Matrix));
+        CUSPARSE_ERROR(cusparseCsrSetPointers(
+            m_c_spdescr, m_d_c_row_ptr, m_d_c_col_idx, m_d_c_val));
+
+        // copy the sparsity pattern to C
+        size_t buffer5_size = 0;
+        CUSPARSE_ERROR(cusparseSpGEMMreuse_copy(handle,
+                                                op_a,
+                                                op_b,
+                                                A.m_spdescr,
+                                                B.m_spdescr,
+                                                m_c_spdescr,
+                                                alg,
+                                                m_spgemm_desc,
+                                                &buffer5_size,
+                                                nullptr));
+        CUDA_ERROR(
+            tracked_malloc(&m_d_buffer5, buffer5_size, MemoryCategory::Matrix));
+        CUSPARSE_ERROR(cusparseSpGEMMreuse_copy(handle,
+                                                op_a,
+                                                op_b,
+                                                A.m_spdescr,
+                                                B.m_spdescr,
+                                                m_c_spdescr,
+                                                alg,
+                                                m_spgemm_desc,
+                                                &buffer5_size,
+                                                m_d_buffer5));
+        GPU_FREE(d_buffer3);
+
+        // the host holds the sparsity pattern of C
+        m_h_c_row_ptr =
+            static_cast<IndexT*>(malloc((c_rows + 1) * sizeof(IndexT)));
+        m_h_c_col_idx = static_cast<IndexT*>(malloc(c_nnz * sizeof(IndexT)));
+        m_h_c_val     = static_cast<T*>(malloc(c_nnz * sizeof(T)));
+        CUDA_ERROR(cudaMemcpy(m_h_c_row_ptr,
+                              m_d_c_row_ptr,
+                              (c_rows + 1) * sizeof(IndexT),
+                              cudaMemcpyDeviceToHost));
+        CUDA_ERROR(cudaMemcpy(m_h_c_col_idx,
+                              m_d_c_col_idx,
+                              c_nnz * sizeof(IndexT),
+                              cudaMemcpyDeviceToHost));
+
+        m_c = SparseMatrix<T>(c_rows,
+                              c_cols,
+                              static_cast<IndexT>(c_nnz),
+                              m_d_c_row_ptr,
+                              m_d_c_col_idx,
+                              m_d_c_val,
+                              m_h_c_row_ptr,
+                              m_h_c_col_idx,
+                              m_h_c_val);
+
+        multiply();
+    }
+
+    /**
+     * @brief the product C
+     */
+    SparseMatrix<T>& matrix()
+    {
+        return m_c;
+    }
+
+    /**
+     * @brief the numeric phase i.e., recompute the values of C = alpha * A * B
+     * from the current (device) values of A and B. The sparsity patterns of A
+     * and B should not have changed since the construction
+     */
+    void multiply(T alpha = T(1), cudaStream_t stream = NULL)
+    {
+        if (m_a == nullptr) {
+            RXMESH_ERROR("SpGEMM::multiply() the product is not initialized");
+            return;
+        }
+        const T beta = T(0);
+
+        cusparseHandle_t handle = m_a->m_cusparse_handle;
+        CUSPARSE_ERROR(cusparseSetStream(handle, stream));
+        CUSPARSE_ERROR(cusparseSpGEMMreuse_compute(handle,
+                                                   op_a,
+                                                   op_b,
+                                                   &alpha,
+                                                   m_a->m_spdescr,
+                                                   m_b->m_spdescr,
+                                                   &beta,
+                                                   m_c_spdescr,
+                                                   cuda_type<T>(),
+                                                   alg,
+                                                   m_spgemm_desc));
+    }
+
+    /**
+     * @brief release C and the buffers of the reused phases
+     */
+    void release()
+    {
+        if (m_a == nullptr) {
+            return;
+        }
+        m_c.release();
+        CUSPARSE_ERROR(cusparseDestroySpMat(m_c_spdescr));
+        CUSPARSE_ERROR(cusparseSpGEMM_destroyDescr(m_spgemm_desc));
+        GPU_FREE(m_d_buffer4);
+        GPU_FREE(m_d_buffer5);
+        GPU_FREE(m_d_c_row_ptr);
+        GPU_FREE(m_d_c_col_idx);
+        GPU_FREE(m_d_c_val);
+        free(m_h_c_row_ptr);
+        free(m_h_c_col_idx);
+        free(m_h_c_val);
+        m_a = nullptr;
+        m_b = nullptr;
+    }
+
+   private:
+    static constexpr cusparseOperation_t op_a =
+        CUSPARSE_OPERATION_NON_TRANSPOSE;
+    static constexpr cusparseOperation_t op_b =
+        CUSPARSE_OPERATION_NON_TRANSPOSE;
+    static constexpr cusparseSpGEMMAlg_t alg = CUSPARSE_SPGEMM_DEFAULT;
+
+    SparseMatrix<T>*      m_a;
+    SparseMatrix<T>*      m_b;
+    SparseMatrix<T>       m_c;
+    cusparseSpGEMMDescr_t m_spgemm_desc;
+    cusparseSpMatDescr_t  m_c_spdescr;
+    void*                 m_d_buffer4;
+    void*                 m_d_buffer5;
+    IndexT*               m_d_c_row_ptr;
+    IndexT*               m_d_c_col_idx;
+    T*                    m_d_c_val;
+    IndexT*               m_h_c_row_ptr;
+    IndexT*               m_h_c_col_idx;
+    T*                    m_h_c_val;
+};
+}  // namespace rxmesh
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <stdint.h>
+#include <string>
+
+#include "rxmesh/util/log.h"
+#include "rxmesh/util/macros.h"
+
+namespace rxmesh {
+
+/**
+ * @brief Breakdown of the device memory used to store the mesh topology. This
+ * is populated by RXMesh::get_topology_memory_report(). All sizes are in bytes
+ * and account for the allocated capacity of all (including the extra) patches
+ */
+struct TopologyMemoryReport
+{
+    // patch topology
+    size_t ev_bytes = 0;
+    size_t fe_bytes = 0;
+
+    // active and owned bitmasks of vertices, edges, and faces
+    size_t active_mask_bytes = 0;
+    size_t owned_mask_bytes  = 0;
+
+    // LP hashtables of the not-owned vertices, edges, and faces
+    size_t lp_hashtable_bytes = 0;
+
+    // patch stash, per-patch counters and dirty flag, and the PatchInfo array
+    size_t patch_stash_bytes = 0;
+    size_t patch_info_bytes  = 0;
+
+    uint32_t num_patches     = 0;
+    uint32_t max_num_patches = 0;
+
+    // number of owned and not-owned (ribbon) mesh elements in all patches
+    uint32_t num_owned_vertices = 0, num_owned_edges = 0, num_owned_faces = 0;
+    uint32_t num_not_owned_vertices = 0, num_not_owned_edges = 0,
+             num_not_owned_faces = 0;
+
+    // the ribbon overhead as computed by the patcher (the ratio of ribbon
+    // faces to owned faces)
+    double ribbon_overhead = 0;
+
+    size_t total_bytes() const
+    {
+        return ev_bytes + fe_bytes + active_mask_bytes + owned_mask_bytes +
+               lp_hashtable_bytes + patch_stash_bytes + patch_info_bytes;
+    }
+
+    void print() const
+    {
+        auto mb = [](size_t bytes) { return BYTES_TO_MEGABYTES(bytes); };
+
+        RXMESH_INFO("Topology memory: {} patches ({} allocated), {} (MB)",
+                    num_patches,
+                    max_num_patches,
+                    mb(total_bytes()));
+        RXMESH_INFO("  EV            = {} (MB)", mb(ev_bytes));
+        RXMESH_INFO("  FE            = {} (MB)", mb(fe_bytes));
+        RXMESH_INFO("  active masks  = {} (MB)", mb(active_mask_bytes));
+        RXMESH_INFO("  owned masks   = {} (MB)", mb(owned_mask_bytes));
+        RXMESH_INFO("  LP hashtables = {} (MB)", mb(lp_hashtable_bytes));
+        RXMESH_INFO("  patch stash   = {} (MB)", mb(patch_stash_bytes));
+        RXMESH_INFO("  PatchInfo     = {} (MB)", mb(patch_info_bytes));
+        RXMESH_INFO(
+            "  ribbon: {} vertices, {} edges, {} faces not-owned vs. {} "
+            "vertices, {} edges, {} faces owned (ribbon overhead = {})",
+            num_not_owned_vertices,
+            num_not_owned_edges,
+            num_not_owned_faces,
+            num_owned_vertices,
+            num_owned_edges,
+            num_owned_faces,
+            ribbon_overhead);
+    }
+};
+
+/**
+ * @brief Resource usage and theoretical occupancy of a kernel launched with a
+ * LaunchBox. This is populated by RXMeshStatic::get_launch_report()
+ */
+struct LaunchReport
+{
+    uint32_t block_threads            = 0;
+    uint32_t blocks                   = 0;
+    size_t   smem_bytes_dyn           = 0;
+    size_t   smem_bytes_static        = 0;
+    size_t   local_mem_per_thread     = 0;
+    uint32_t num_registers_per_thread = 0;
+
+    // number of resident blocks per SM and the ratio of resident warps to the
+    // max warps per SM
+    int    blocks_per_sm = 0;
+    double occupancy     = 0;
+
+    // the resource that limits the number of resident blocks per SM i.e.,
+    // "shared memory", "registers", or "threads"
+    std::string limiter;
+
+    void print() const
+    {
+        RXMESH_INFO(
+            "Launch: {} blocks x {} threads, shared memory = {} (dynamic) + "
+            "{} (static) bytes, {} registers/thread, {} local mem/thread "
+            "(bytes), {} blocks/SM, occupancy = {}% limited by {}",
+            blocks,
+            block_threads,
+            smem_bytes_dyn,
+            smem_bytes_static,
+            num_registers_per_thread,
+            local_mem_per_thread,
+            blocks_per_sm,
+            100.0 * occupancy,
+            limiter);
+    }
+};
+}  // namespace rxmesh
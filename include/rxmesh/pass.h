@@ -24,7 +24,9 @@ struct Pass
 
     __host__ Pass(RXMeshDynamic& rx)
     {
-        CUDA_ERROR(cudaMalloc((void**)&m_d_counter, sizeof(uint32_t)));
+        CUDA_ERROR(tracked_malloc((void**)&m_d_counter,
+                                  sizeof(uint32_t),
+                                  MemoryCategory::Other));
         m_status = *rx.add_attribute<Status, HandleT>("rx:status", 1);
         m_status.reset(Status::UNSEEN, DEVICE);
     };
@@ -0,0 +1,526 @@
+#pragma once
+
+#include <stdint.h>
+#include <algorithm>
+#include <vector>
+
+#include "rxmesh/types.h"
+#include "rxmesh/util/log.h"
+#include "rxmesh/util/macros.h"
+
+namespace rxmesh {
+
+/**
+ * @brief iterator over the output of a patch-local CSR query of one source
+ * element. The indices and the local-to-owner table live in shared memory
+ */
+template <typename HandleT>
+struct PatchCSRIterator
+{
+    using Handle = HandleT;
+
+    __device__ __inline__ PatchCSRIterator(const uint16_t* values,
+                                         const uint16_t  size,
+                                         const uint64_t* table)
+        : m_values(values), m_size(size), m_table(table)
+    {
+    }
+
+    __device__ __inline__ uint16_t size() const
+    {
+        return m_size;
+    }
+
+    /**
+     * @brief the handle (in its owner patch) of the i-th output. Invalid on
+     * the boundary (e.g., for VolumeOp::CC)
+     */
+    __device__ __inline__ HandleT operator[](const uint16_t i) const
+    {
+        assert(i < m_size);
+        const uint16_t lid = m_values[i];
+        if (lid == INVALID16) {
+            return HandleT();
+        }
+        return HandleT(m_table[lid]);
+    }
+
+    /**
+     * @brief the patch-local index of the i-th output
+     */
+    __device__ __inline__ uint16_t local(const uint16_t i) const
+    {
+        assert(i < m_size);
+        return m_values[i];
+    }
+
+   private:
+    const uint16_t* m_values;
+    uint16_t        m_size;
+    const uint64_t* m_table;
+};
+
+/**
+ * @brief attribute of the elements of a mesh stored as patch-local CSRs (e.g.,
+ * RXMeshVolume) on both the host and the device in the linear order of the
+ * owned elements (i.e., patch after patch) with the num_attributes values of
+ * an element next to each other. Copies are shallow (e.g., to capture it in a
+ * lambda) and the memory is released by the owner (e.g.,
+ * RXMeshVolume::add_vertex_attribute())
+ */
+template <typename T, typename HandleT>
+class PatchCSRAttribute
+{
+   public:
+    using Type = T;
+
+    __host__ __device__ PatchCSRAttribute()
+        : m_h_data(nullptr),
+          m_d_data(nullptr),
+          m_h_prefix(nullptr),
+          m_d_prefix(nullptr),
+          m_num_elements(0),
+          m_num_attributes(0)
+    {
+    }
+
+    PatchCSRAttribute(const uint32_t  num_elements,
+                    const uint32_t  num_attributes,
+                    const uint32_t* h_prefix,
+                    const uint32_t* d_prefix)
+        : m_h_prefix(h_prefix),
+          m_d_prefix(d_prefix),
+          m_num_elements(num_elements),
+          m_num_attributes(num_attributes)
+    {
+        const size_t bytes = size_t(num_elements) * num_attributes * sizeof(T);
+        m_h_data = static_cast<T*>(malloc(std::max<size_t>(bytes, 1)));
+        CUDA_ERROR(tracked_malloc((void**)&m_d_data,
+                                  std::max<size_t>(bytes, 1),
+                                  MemoryCategory::Topology));
+    }
+
+    PatchCSRAttribute(const PatchCSRAttribute&) = default;
+
+    __host__ __device__ __inline__ uint32_t get_num_attributes() const
+    {
+        return m_num_attributes;
+    }
+
+    __host__ __device__ __inline__ uint32_t size() const
+    {
+        return m_num_elements;
+    }
+
+    __host__ __device__ __inline__ T& operator()(const HandleT& h,
+                                                 const uint32_t attr = 0)
+    {
+        return data()[index(h, attr)];
+    }
+
+    __host__ __device__ __inline__ const T& operator()(
+        const HandleT& h,
+        const uint32_t attr = 0) const
+    {
+        return data()[index(h, attr)];
+    }
+
+    /**
+     * @brief set all values to value at location
+     */
+    void reset(const T         value,
+               const locationT location,
+               cudaStream_t    stream = NULL)
+    {
+        const size_t num = size_t(m_num_elements) * m_num_attributes;
+        if ((location & HOST) == HOST) {
+            std::fill(m_h_data, m_h_data + num, value);
+        }
+        if ((location & DEVICE) == DEVICE) {
+            std::vector<T> h(num, value);
+            CUDA_ERROR(cudaMemcpyAsync(m_d_data,
+                                       h.data(),
+                                       num * sizeof(T),
+                                       cudaMemcpyHostToDevice,
+                                       stream));
+            CUDA_ERROR(cudaStreamSynchronize(stream));
+        }
+    }
+
+    /**
+     * @brief copy the values from source to target location
+     */
+    void move(const locationT source,
+              const locationT target,
+              cudaStream_t    stream = NULL)
+    {
+        const size_t bytes =
+            size_t(m_num_elements) * m_num_attributes * sizeof(T);
+        if (source == HOST && target == DEVICE) {
+            CUDA_ERROR(cudaMemcpyAsync(
+                m_d_data, m_h_data, bytes, cudaMemcpyHostToDevice, stream));
+        } else if (source == DEVICE && target == HOST) {
+            CUDA_ERROR(cudaMemcpyAsync(
+                m_h_data, m_d_data, bytes, cudaMemcpyDeviceToHost, stream));
+        }
+        CUDA_ERROR(cudaStreamSynchronize(stream));
+    }
+
+    void release()
+    {
+        free(m_h_data);
+        m_h_data = nullptr;
+        GPU_FREE(m_d_data);
+    }
+
+   private:
+    __host__ __device__ __inline__ T* data() const
+    {
+#ifdef __CUDA_ARCH__
+        return m_d_data;
+#else
+        return m_h_data;
+#endif
+    }
+
+    __host__ __device__ __inline__ size_t index(const HandleT& h,
+                                                const uint32_t attr) const
+    {
+        assert(h.is_valid());
+        assert(attr < m_num_attributes);
+        const auto pl = h.unpack();
+#ifdef __CUDA_ARCH__
+        const uint32_t id = m_d_prefix[pl.first] + pl.second;
+#else
+        const uint32_t id = m_h_prefix[pl.first] + pl.second;
+#endif
+        return size_t(id) * m_num_attributes + attr;
+    }
+
+    T*              m_h_data;
+    T*              m_d_data;
+    const uint32_t* m_h_prefix;
+    const uint32_t* m_d_prefix;
+    uint32_t        m_num_elements;
+    uint32_t        m_num_attributes;
+};
+
+namespace detail {
+
+/**
+ * @brief the device side of one element type (e.g., vertices) of a mesh
+ * stored as patch-local CSRs. The local elements of a patch are the owned
+ * ones followed by the ones owned by other patches and the table maps the
+ * local index to the unique id of the handle in the owner patch
+ */
+struct PatchCSRElements
+{
+    // per patch, the number of owned elements
+    uint32_t* m_num_owned = nullptr;
+
+    // prefix sum of the owned elements in patches (num_patches + 1)
+    uint32_t* m_prefix = nullptr;
+
+    // the local-to-owner table of patch p starts at m_table_start[p]
+    // (num_patches + 1)
+    uint32_t* m_table_start = nullptr;
+    uint64_t* m_table       = nullptr;
+};
+
+/**
+ * @brief the device side of one query operation: the CSR offset (relative to
+ * the patch's values) and values (local indices of the output elements) of
+ * the owned source elements of patch p start at m_offset_start[p] and
+ * m_value_start[p]
+ */
+struct PatchCSRQuery
+{
+    uint32_t* m_offset_start = nullptr;
+    uint32_t* m_value_start  = nullptr;
+    uint16_t* m_offset       = nullptr;
+    uint16_t* m_value        = nullptr;
+};
+
+template <typename T>
+T* upload_vector(const std::vector<T>& h)
+{
+    T* d = nullptr;
+    CUDA_ERROR(tracked_malloc((void**)&d,
+                              std::max<size_t>(h.size(), 1) * sizeof(T),
+                              MemoryCategory::Topology));
+    if (!h.empty()) {
+        CUDA_ERROR(cudaMemcpy(
+            d, h.data(), h.size() * sizeof(T), cudaMemcpyHostToDevice));
+    }
+    return d;
+}
+
+inline void release(PatchCSRElements& el)
+{
+    GPU_FREE(el.m_num_owned);
+    GPU_FREE(el.m_prefix);
+    GPU_FREE(el.m_table_start);
+    GPU_FREE(el.m_table);
+}
+
+inline void release(PatchCSRQuery& q)
+{
+    GPU_FREE(q.m_offset_start);
+    GPU_FREE(q.m_value_start);
+    GPU_FREE(q.m_offset);
+    GPU_FREE(q.m_value);
+}
+
+/**
+ * @brief the host side of PatchCSRElements along with the map between the
+ * input index and the handle of every (owned) element
+ */
+template <typename HandleT>
+struct PatchCSRHostElements
+{
+    std::vector<uint32_t> num_owned;
+    std::vector<uint32_t> prefix      = {0};
+    std::vector<uint32_t> table_start = {0};
+    std::vector<uint64_t> table;
+
+    // input index to handle and linear id to input index
+    std::vector<HandleT>  input_handle;
+    std::vector<uint32_t> input_id;
+
+    /**
+     * @brief set the owned elements (input indices in their local order) of
+     * every patch
+     */
+    void set_owned(const std::vector<std::vector<uint32_t>>& owned,
+                   const uint32_t                            num_input)
+    {
+        const uint32_t num_patches = uint32_t(owned.size());
+
+        num_owned.resize(num_patches);
+        prefix.assign(num_patches + 1, 0);
+        for (uint32_t p = 0; p < num_patches; ++p) {
+            num_owned[p]  = uint32_t(owned[p].size());
+            prefix[p + 1] = prefix[p] + num_owned[p];
+        }
+
+        input_handle.assign(num_input, HandleT());
+        input_id.resize(prefix.back());
+        for (uint32_t p = 0; p < num_patches; ++p) {
+            for (uint32_t i = 0; i < owned[p].size(); ++i) {
+                input_handle[owned[p][i]] = HandleT(p, {uint16_t(i)});
+                input_id[prefix[p] + i]   = owned[p][i];
+            }
+        }
+        table_start.assign(1, 0);
+        table.clear();
+    }
+
+    /**
+     * @brief append the table of the next patch given the input indices of
+     * its local elements (owned first)
+     */
+    void append_table(const std::vector<uint32_t>& local)
+    {
+        for (uint32_t e : local) {
+            table.push_back(input_handle[e].unique_id());
+        }
+        table_start.push_back(uint32_t(table.size()));
+    }
+
+    uint32_t size() const
+    {
+        return prefix.back();
+    }
+
+    uint32_t num_local(const uint32_t p) const
+    {
+        return table_start[p + 1] - table_start[p];
+    }
+
+    uint32_t linear_id(const HandleT& h) const
+    {
+        const auto pl = h.unpack();
+        return prefix[pl.first] + pl.second;
+    }
+
+    PatchCSRElements upload() const
+    {
+        PatchCSRElements el;
+        el.m_num_owned   = upload_vector(num_owned);
+        el.m_prefix      = upload_vector(prefix);
+        el.m_table_start = upload_vector(table_start);
+        el.m_table       = upload_vector(table);
+        return el;
+    }
+};
+
+/**
+ * @brief the host side of PatchCSRQuery. The CSR of every patch is appended
+ * in order (see append()) which also tracks the shared memory needed by
+ * patch_csr_query()
+ */
+struct PatchCSRHostQuery
+{
+    std::vector<uint32_t> offset_start = {0};
+    std::vector<uint32_t> value_start  = {0};
+    std::vector<uint16_t> offset;
+    std::vector<uint16_t> value;
+
+    // the max (over patches) dynamic shared memory of patch_csr_query()
+    size_t shmem_bytes = 0;
+
+    /**
+     * @brief append the CSR of the next patch with num_src owned source
+     * elements whose output refers to a table of num_table local elements.
+     * get_output(s, value) pushes the local indices of the output of source
+     * s to value
+     */
+    template <typename OutputF>
+    void append(const uint32_t num_src,
+                const uint32_t num_table,
+                OutputF        get_output)
+    {
+        const size_t v_begin = value.size();
+        for (uint32_t s = 0; s < num_src; ++s) {
+            offset.push_back(uint16_t(value.size() - v_begin));
+            get_output(s, value);
+        }
+        offset.push_back(uint16_t(value.size() - v_begin));
+
+        offset_start.push_back(uint32_t(offset.size()));
+        value_start.push_back(uint32_t(value.size()));
+
+        shmem_bytes = std::max(
+            shmem_bytes,
+            num_table * sizeof(uint64_t) +
+                (num_src + 1 + value.size() - v_begin) * sizeof(uint16_t));
+    }
+
+    /**
+     * @brief the CSR of a patch is indexed with 16-bit offsets
+     */
+    bool is_valid() const
+    {
+        for (size_t p = 0; p + 1 < value_start.size(); ++p) {
+            if (value_start[p + 1] - value_start[p] >= INVALID16) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    PatchCSRQuery upload() const
+    {
+        PatchCSRQuery q;
+        q.m_offset_start = upload_vector(offset_start);
+        q.m_value_start  = upload_vector(value_start);
+        q.m_offset       = upload_vector(offset);
+        q.m_value        = upload_vector(value);
+        return q;
+    }
+};
+
+/**
+ * @brief one block per patch that applies the lambda on the owned elements
+ */
+template <typename HandleT, typename LambdaT>
+__global__ void patch_csr_for_each(const uint32_t         num_patches,
+                                   const PatchCSRElements elements,
+                                   LambdaT                apply)
+{
+    const uint32_t p = blockIdx.x;
+    if (p >= num_patches) {
+        return;
+    }
+    const uint32_t num = elements.m_num_owned[p];
+    for (uint32_t l = threadIdx.x; l < num; l += blockDim.x) {
+        apply(HandleT(p, {uint16_t(l)}));
+    }
+}
+
+/**
+ * @brief one block per patch that loads the query output of all owned source
+ * elements of the patch along with the local-to-owner table of the output
+ * elements into shared memory and then applies the lambda on every owned
+ * source element
+ */
+template <uint32_t blockThreads,
+          typename InputT,
+          typename OutputT,
+          typename LambdaT>
+__global__ void patch_csr_query(const uint32_t         num_patches,
+                                const PatchCSRElements input,
+                                const PatchCSRElements output,
+                                const PatchCSRQuery    query,
+                                LambdaT                apply)
+{
+    extern __shared__ uint64_t s_patch_csr_shmem[];
+
+    const uint32_t p = blockIdx.x;
+    if (p >= num_patches) {
+        return;
+    }
+
+    const uint32_t num_src = input.m_num_owned[p];
+
+    const uint32_t t_begin  = output.m_table_start[p];
+    const uint32_t t_size   = output.m_table_start[p + 1] - t_begin;
+    const uint32_t o_begin  = query.m_offset_start[p];
+    const uint32_t v_begin  = query.m_value_start[p];
+    const uint32_t num_vals = query.m_value_start[p + 1] - v_begin;
+
+    uint64_t* s_table  = s_patch_csr_shmem;
+    uint16_t* s_offset = reinterpret_cast<uint16_t*>(s_table + t_size);
+    uint16_t* s_value  = s_offset + num_src + 1;
+
+    for (uint32_t i = threadIdx.x; i < t_size; i += blockThreads) {
+        s_table[i] = output.m_table[t_begin + i];
+    }
+    for (uint32_t i = threadIdx.x; i < num_src + 1; i += blockThreads) {
+        s_offset[i] = query.m_offset[o_begin + i];
+    }
+    for (uint32_t i = threadIdx.x; i < num_vals; i += blockThreads) {
+        s_value[i] = query.m_value[v_begin + i];
+    }
+    __syncthreads();
+
+    for (uint32_t s = threadIdx.x; s < num_src; s += blockThreads) {
+        const PatchCSRIterator<OutputT> iter(
+            s_value + s_offset[s], s_offset[s + 1] - s_offset[s], s_table);
+        apply(InputT(p, {uint16_t(s)}), iter);
+    }
+}
+
+/**
+ * @brief launch patch_csr_query() with smem bytes of dynamic shared memory
+ * opting in to more than 48KB if needed
+ */
+template <uint32_t blockThreads,
+          typename InputT,
+          typename OutputT,
+          typename LambdaT>
+void launch_patch_csr_query(const uint32_t          num_patches,
+                            const PatchCSRElements& input,
+                            const PatchCSRElements& output,
+                            const PatchCSRQuery&    query,
+                            const size_t            smem,
+                            LambdaT                 apply,
+                            cudaStream_t            stream)
+{
+    if (num_patches == 0) {
+        return;
+    }
+
+    const void* kernel =
+        (const void*)patch_csr_query<blockThreads, InputT, OutputT, LambdaT>;
+    if (smem > 48 * 1024) {
+        CUDA_ERROR(cudaFuncSetAttribute(
+            kernel, cudaFuncAttributeMaxDynamicSharedMemorySize, int(smem)));
+    }
+
+    patch_csr_query<blockThreads, InputT, OutputT>
+        <<<num_patches, blockThreads, smem, stream>>>(
+            num_patches, input, output, query, apply);
+}
+}  // namespace detail
+}  // namespace rxmesh
@@ -28,6 +28,11 @@ struct ALIGN(16) PatchInfo
     __device__ __host__ PatchInfo()
         : ev(nullptr),
           fe(nullptr),
+          ev8(nullptr),
+          fe8(nullptr),
+          owner_v(nullptr),
+          owner_e(nullptr),
+          owner_f(nullptr),
           active_mask_v(nullptr),
           active_mask_e(nullptr),
           active_mask_f(nullptr),
@@ -52,6 +57,18 @@ struct ALIGN(16) PatchInfo
     LocalVertexT* ev;
     LocalEdgeT*   fe;
 
+    // Optional 8-bit copy of ev and fe used by the query operations to load
+    // the topology with half the memory traffic. Only available on static
+    // mesh with small patches (see RXMeshStatic::enable_compressed_topology())
+    uint8_t* ev8;
+    uint8_t* fe8;
+
+    // Optional direct map from the local index of a not-owned mesh element to
+    // the unique id of its owner handle (INVALID64 for owned and deleted
+    // elements) used instead of probing the LP hashtable. Only available on
+    // static mesh (see RXMeshStatic::enable_owner_table())
+    uint64_t *owner_v, *owner_e, *owner_f;
+
 
     // Active bitmask where 1 indicates active/existing mesh element and 0
     // if the mesh element is deleted
@@ -154,6 +171,10 @@ struct ALIGN(16) PatchInfo
         if (is_owned(typename HandleT::LocalT(key))) {
             return HandleT(patch_id, key);
         }
+        const uint64_t* owner = get_owner_table<HandleT>();
+        if (owner != nullptr) {
+            return HandleT(owner[key]);
+        }
         LPPair lp = get_lp<HandleT>().find(key, table, stash);
 
         // assert(!lp.is_sentinel());
@@ -318,6 +339,29 @@ struct ALIGN(16) PatchInfo
     }
 
 
+    /**
+     * @brief return the owner table corresponding to the handle type (see
+     * owner_v) or nullptr if the patch does not have one
+     * @tparam HandleT
+     */
+    template <typename HandleT>
+    __device__ __host__ __inline__ const uint64_t* get_owner_table() const
+    {
+        if constexpr (std::is_same_v<HandleT, VertexHandle>) {
+            return owner_v;
+        }
+
+        if constexpr (std::is_same_v<HandleT, EdgeHandle> ||
+                      std::is_same_v<HandleT, DEdgeHandle>) {
+            return owner_e;
+        }
+
+        if constexpr (std::is_same_v<HandleT, FaceHandle>) {
+            return owner_f;
+        }
+    }
+
+
     /**
      * @brief return LP hashtable corresponding to the handle type
      * @tparam HandleT
@@ -441,14 +485,8 @@ struct ALIGN(16) PatchInfo
         const uint32_t* active_bitmask,
         const uint16_t  size) const
     {
-        uint16_t ret = 0;
-        for (uint16_t i = 0; i < size; ++i) {
-            if (detail::is_owned(i, owned_bitmask) &&
-                !detail::is_deleted(i, active_bitmask)) {
-                ret++;
-            }
-        }
-        return ret;
+        // owned and not deleted i.e., set in both bitmasks
+        return detail::count_set_bits_and(size, owned_bitmask, active_bitmask);
     }
 };
 }  // namespace rxmesh
\ No newline at end of file
@@ -6,7 +6,11 @@
 namespace rxmesh {
 /**
  * @brief PatchLock implements a locking mechanism for the patch. This is meant
- * to be used only on the device
+ * to be used only on the device. The lock can be acquired exclusively (for a
+ * block that will write to the patch) or shared (for blocks that only read
+ * from the patch). The lock word is FREE, LOCKED (exclusive), or the number of
+ * blocks that hold the lock in the shared mode. A block that holds the lock
+ * in the shared mode can upgrade it to exclusive if it is the only reader
  */
 struct PatchLock
 {
@@ -25,7 +29,7 @@ struct PatchLock
     {
 #ifdef __CUDA_ARCH__
         int attempt = 0;
-        while (::atomicCAS(lock, FREE, LOCKED) == LOCKED) {
+        while (::atomicCAS(lock, FREE, LOCKED) != FREE) {
             __threadfence();
             if (attempt == MAX_ATTEMPT) {
                 int other = ::atomicMin(spin, id);
@@ -42,7 +46,68 @@ struct PatchLock
 #else
         return true;
 #endif
-    
+    }
+
+    /**
+     * @brief acquire the lock in the shared mode given an id that represent
+     * the block index. Multiple blocks can hold the lock in the shared mode at
+     * the same time but not while another block holds it exclusively. Same as
+     * acquire_lock(), the block gives up if a block with a lower id is
+     * spinning on the same lock
+     */
+    __device__ bool acquire_shared_lock(uint32_t id)
+    {
+#ifdef __CUDA_ARCH__
+        int      attempt = 0;
+        uint32_t current = atomic_read(lock);
+        while (true) {
+            if (current < MAX_READERS) {
+                const uint32_t prv = ::atomicCAS(lock, current, current + 1);
+                if (prv == current) {
+                    break;
+                }
+                current = prv;
+                continue;
+            }
+            __threadfence();
+            if (attempt == MAX_ATTEMPT) {
+                int other = ::atomicMin(spin, id);
+                __threadfence();
+                if (other < id) {
+                    return false;
+                }
+                attempt = 0;
+            }
+            attempt++;
+            current = atomic_read(lock);
+        }
+        return true;
+#else
+        return true;
+#endif
+    }
+
+    /**
+     * @brief upgrade a lock held in the shared mode to exclusive. This only
+     * succeeds if the calling block is the only reader. The block does not
+     * wait for the other readers for more than MAX_ATTEMPT since they may be
+     * waiting to upgrade the same lock. On failure, the block still holds the
+     * lock in the shared mode
+     */
+    __device__ bool upgrade_lock(uint32_t id)
+    {
+#ifdef __CUDA_ARCH__
+        for (int attempt = 0; attempt < MAX_ATTEMPT; ++attempt) {
+            if (::atomicCAS(lock, 1u, LOCKED) == 1u) {
+                atomicExch(spin, id);
+                return true;
+            }
+            __threadfence();
+        }
+        return false;
+#else
+        return true;
+#endif
     }
 
     /**
@@ -59,10 +124,35 @@ struct PatchLock
     }
 
     /**
-     * @brief check if the patch is locked
+     * @brief release the lock acquired in the shared mode. Should only be
+     * called by the block/thread that has successfully acquired the lock in
+     * the shared mode
+     */
+    __device__ void release_shared_lock()
+    {
+#ifdef __CUDA_ARCH__
+        ::atomicSub(lock, 1u);
+        __threadfence();
+#endif
+    }
+
+    /**
+     * @brief check if the patch is locked (in either mode)
      */
     __device__ bool is_locked() const
     {
+#ifdef __CUDA_ARCH__
+        return atomic_read(lock) != FREE;
+#else
+        return false;
+#endif
+    }
+
+    /**
+     * @brief check if the patch is locked exclusively
+     */
+    __device__ bool is_exclusively_locked() const
+    {
 #ifdef __CUDA_ARCH__
         return atomic_read(lock) == LOCKED;
 #else
@@ -76,8 +166,12 @@ struct PatchLock
      */
     __host__ void init()
     {
-        CUDA_ERROR(cudaMalloc((void**)&lock, sizeof(uint32_t)));
-        CUDA_ERROR(cudaMalloc((void**)&spin, sizeof(uint32_t)));
+        CUDA_ERROR(tracked_malloc((void**)&lock,
+                                  sizeof(uint32_t),
+                                  MemoryCategory::Topology));
+        CUDA_ERROR(tracked_malloc((void**)&spin,
+                                  sizeof(uint32_t),
+                                  MemoryCategory::Topology));
         uint32_t h_lock = FREE, h_spin = INVALID32;
         CUDA_ERROR(cudaMemcpy(
             lock, &h_lock, sizeof(uint32_t), cudaMemcpyHostToDevice));
@@ -99,6 +193,7 @@ struct PatchLock
    private:
     static constexpr uint32_t FREE        = 0;
     static constexpr uint32_t LOCKED      = INVALID32;
+    static constexpr uint32_t MAX_READERS = LOCKED - 1;
     static constexpr int      MAX_ATTEMPT = 10;
 
     uint32_t *lock, *spin;
@@ -7,13 +7,28 @@
 // inspired/taken from
 // https://github.com/GPUPeople/Ouroboros/blob/9153c55abffb3bceb5aea4028dfcc00439b046d5/include/device/queues/Queue.h
 
+#include <algorithm>
+#include <vector>
+
 #include "rxmesh/util/util.h"
 
 namespace rxmesh {
 struct PatchScheduler
 {
     __device__ __host__ PatchScheduler()
-        : count(nullptr), capacity(0), list(nullptr){};
+        : count(nullptr),
+          sub_count(nullptr),
+          front(nullptr),
+          back(nullptr),
+          num_in_flight(nullptr),
+          num_deferred(nullptr),
+          capacity(0),
+          num_queues(1),
+          sub_capacity(0),
+          list(nullptr),
+          deferred_list(nullptr),
+          persistent(false),
+          lock_free(false){};
     __device__ __host__ PatchScheduler(const PatchScheduler& other) = default;
     __device__ __host__ PatchScheduler(PatchScheduler&&)            = default;
     __device__ __host__ PatchScheduler& operator=(const PatchScheduler&) =
@@ -23,32 +38,49 @@ struct PatchScheduler
 
 
     /**
-     * @brief add/push new patch of the list
+     * @brief add/push new patch of the list. The patch is added to its home
+     * sub-queue (patch id modulo the number of sub-queues). If low_priority is
+     * set, the patch is added to the low-priority level which is only popped
+     * from once the high-priority level of all sub-queues is empty. This is
+     * used for patches that could not be processed because of a conflict with
+     * a neighbor patch such that they are retried after the other patches
+     * (and likely after the neighbor patch is done)
      */
-    __device__ __inline__ bool push(const uint32_t pid)
+    __device__ __inline__ bool push(const uint32_t pid,
+                                   const bool     low_priority = false)
     {
 #ifdef __CUDA_ARCH__
 #ifdef PROCESS_SINGLE_PATCH
         return true;
 #else
         assert(pid != INVALID32);
-        if (::atomicAdd(count, 1) < static_cast<int>(capacity)) {
-            int pos = ::atomicAdd(back, 1) % capacity;
+        const uint32_t q = sub_queue_id(pid % num_queues, low_priority);
+
+        if (::atomicAdd(sub_count + q, 1) < static_cast<int>(sub_capacity)) {
+            int pos = ::atomicAdd(back + q, 1) % sub_capacity;
+
+            uint32_t* q_list = list + q * sub_capacity;
 
             // the loop because another thread/block may have just decremented
             // the count but has not yet finish reading from the list
-            while (::atomicCAS(list + pos, INVALID32, pid) != INVALID32) {
+            while (::atomicCAS(q_list + pos, INVALID32, pid) != INVALID32) {
                 // TODO do we really need to sleep if it is only one thread
                 // in the block doing the job??
                 //__nanosleep(10);
             }
+
+            // the patch is visible in the sub-queue before it is counted in
+            // the total such that pop() always finds a patch once it reserves
+            // one from the total
+            __threadfence();
+            ::atomicAdd(count, 1);
             return true;
         } else {
             // for our configuration, this should not happen since a block only
             // pop a patch and, if not able to process it due to dependency
             // conflict, the block push the same patch again. So at all times
-            // count is less than capacity if capacity is total number of
-            // patches
+            // the sub-queue count is less than its capacity since the capacity
+            // is the number of patches that have this sub-queue as home
             assert(0);
             return false;
         }
@@ -62,7 +94,10 @@ struct PatchScheduler
     }
 
     /**
-     * @brief get a patch from the list. If the list is empty, return INVALID32
+     * @brief get a patch from the list. If the list is empty, return INVALID32.
+     * The block first tries the sub-queue of the SM it runs on and then steals
+     * from the other sub-queues. High-priority patches are popped before
+     * low-priority ones
      */
     __device__ __inline__ uint32_t pop()
     {
@@ -70,6 +105,8 @@ struct PatchScheduler
 #ifdef PROCESS_SINGLE_PATCH
         return blockIdx.x;
 #else
+        // reserve one patch from the total. This guarantees that one of the
+        // sub-queues has (or is about to have) a patch for us
         int readable = ::atomicSub(count, 1);
 
         uint32_t pid = INVALID32;
@@ -77,16 +114,20 @@ struct PatchScheduler
         if (readable <= 0) {
             ::atomicAdd(count, 1);
         } else {
+            uint32_t smid;
+            asm volatile("mov.u32 %0, %%smid;" : "=r"(smid));
+            const uint32_t local = smid % num_queues;
 
-            int pos = ::atomicAdd(front, 1) % capacity;
-
-            // the loop because another thread/block may have just incremented
-            // the count but has not yet wrote to the list
             while (pid == INVALID32) {
-                pid = atomicExch(list + pos, INVALID32);
-                // TODO do we really need to sleep if it is only one thread
-                // in the block doing the job??
-                //__nanosleep(10);
+                for (uint32_t i = 0; i < 2 * num_queues; ++i) {
+                    const bool     low_priority = i >= num_queues;
+                    const uint32_t q            = sub_queue_id(
+                        (local + i) % num_queues, low_priority);
+                    pid = pop_sub_queue(q);
+                    if (pid != INVALID32) {
+                        break;
+                    }
+                }
             }
         }
         return pid;
@@ -98,51 +139,190 @@ struct PatchScheduler
     }
 
     /**
-     * @brief fill the list by sequential numbers
+     * @brief move a patch to the deferred list. Used by persistent kernels for
+     * patches that can not make progress until cleanup() runs (e.g., dirty
+     * patches or patches that should be sliced) so that blocks do not keep
+     * popping and re-pushing them. The deferred patches are moved back to the
+     * queue by RXMeshDynamic::run_persistent()
+     */
+    __device__ __inline__ void defer(const uint32_t pid)
+    {
+#ifdef __CUDA_ARCH__
+        assert(pid != INVALID32);
+        int pos = ::atomicAdd(num_deferred, 1);
+        assert(pos < static_cast<int>(capacity));
+        deferred_list[pos] = pid;
+#endif
+    }
+
+    /**
+     * @brief signal that the calling block is about to pop a patch. In
+     * persistent kernels, a block increments the in-flight counter before
+     * pop() and decrements it (end_patch()) once it is done with the patch and
+     * did any push()/defer() so that other blocks do not exit while a patch
+     * may still be pushed back to the queue
+     */
+    __device__ __inline__ void begin_patch()
+    {
+#ifdef __CUDA_ARCH__
+        ::atomicAdd(num_in_flight, 1);
+        __threadfence();
+#endif
+    }
+
+    /**
+     * @brief signal that the calling block is done with its patch. See
+     * begin_patch()
+     */
+    __device__ __inline__ void end_patch()
+    {
+#ifdef __CUDA_ARCH__
+        __threadfence();
+        ::atomicSub(num_in_flight, 1);
+#endif
+    }
+
+    /**
+     * @brief check if all the work is done i.e., the queue is empty and no
+     * block holds a patch that could be pushed back to the queue
+     */
+    __device__ __inline__ bool is_done() const
+    {
+#ifdef __CUDA_ARCH__
+        // read the in-flight counter first since a block pushes (or defers)
+        // its patch before decrementing it
+        const int in_flight = ::atomicAdd(num_in_flight, 0);
+        __threadfence();
+        return in_flight == 0 && ::atomicAdd(count, 0) <= 0;
+#else
+        return true;
+#endif
+    }
+
+    /**
+     * @brief fill the list by sequential numbers. All patches are added to the
+     * high-priority level of their home sub-queue
      */
     __host__ void refill(const uint32_t size)
     {
-        static std::vector<uint32_t> h_list(capacity);
-        if (h_list.size() < capacity) {
-            h_list.resize(capacity);
+        static std::vector<uint32_t> h_patches(capacity);
+        if (h_patches.size() < capacity) {
+            h_patches.resize(capacity);
         }
-        fill_with_sequential_numbers(h_list.data(), size);
-        random_shuffle(h_list.data(), size);
-        std::fill(h_list.begin() + size, h_list.end(), INVALID32);
+
+        fill_with_sequential_numbers(h_patches.data(), size);
+        random_shuffle(h_patches.data(), size);
+
+        refill(h_patches.data(), size);
+    }
+
+    /**
+     * @brief fill the list with the given patches (stored on the host). All
+     * patches are added to the high-priority level of their home sub-queue
+     */
+    __host__ void refill(const uint32_t* h_patches, const uint32_t size)
+    {
+        assert(size <= capacity);
+
+        const uint32_t num_sub_queues = 2 * num_queues;
+
+        static std::vector<uint32_t> h_list(num_sub_queues * sub_capacity);
+        if (h_list.size() < num_sub_queues * sub_capacity) {
+            h_list.resize(num_sub_queues * sub_capacity);
+        }
+        std::vector<int> h_sub_count(num_sub_queues, 0);
+
+        std::fill(h_list.begin(), h_list.end(), INVALID32);
+
+        for (uint32_t i = 0; i < size; ++i) {
+            const uint32_t q = h_patches[i] % num_queues;
+            h_list[q * sub_capacity + h_sub_count[q]] = h_patches[i];
+            h_sub_count[q]++;
+        }
+
         CUDA_ERROR(cudaMemcpy(list,
                               h_list.data(),
-                              capacity * sizeof(uint32_t),
+                              num_sub_queues * sub_capacity * sizeof(uint32_t),
+                              cudaMemcpyHostToDevice));
+        CUDA_ERROR(cudaMemcpy(sub_count,
+                              h_sub_count.data(),
+                              num_sub_queues * sizeof(int),
+                              cudaMemcpyHostToDevice));
+        CUDA_ERROR(cudaMemcpy(back,
+                              h_sub_count.data(),
+                              num_sub_queues * sizeof(int),
                               cudaMemcpyHostToDevice));
         CUDA_ERROR(
             cudaMemcpy(count, &size, sizeof(int), cudaMemcpyHostToDevice));
 
-        CUDA_ERROR(
-            cudaMemcpy(back, &size, sizeof(int), cudaMemcpyHostToDevice));
-
-        CUDA_ERROR(cudaMemset(front, 0, sizeof(int)));
+        CUDA_ERROR(cudaMemset(front, 0, num_sub_queues * sizeof(int)));
+        CUDA_ERROR(cudaMemset(num_in_flight, 0, sizeof(int)));
+        CUDA_ERROR(cudaMemset(num_deferred, 0, sizeof(int)));
     }
 
     /**
      * @brief initialize all the memories
+     * @param cap the max number of patches in the queue
+     * @param num_sub_queues number of (per-SM) sub-queues. If zero, it is set
+     * to the number of SMs of the current device
      */
-    __host__ void init(uint32_t cap)
+    __host__ void init(uint32_t cap, uint32_t num_sub_queues = 0)
     {
         capacity = cap;
-        CUDA_ERROR(cudaMalloc((void**)&count, sizeof(int)));
-        CUDA_ERROR(cudaMalloc((void**)&front, sizeof(int)));
-        CUDA_ERROR(cudaMalloc((void**)&back, sizeof(int)));
-        CUDA_ERROR(cudaMalloc((void**)&list, sizeof(uint32_t) * capacity));
+
+        if (num_sub_queues == 0) {
+            int device_id;
+            CUDA_ERROR(cudaGetDevice(&device_id));
+            int num_sms = 1;
+            CUDA_ERROR(cudaDeviceGetAttribute(
+                &num_sms, cudaDevAttrMultiProcessorCount, device_id));
+            num_sub_queues = static_cast<uint32_t>(num_sms);
+        }
+        num_queues   = std::max(1u, std::min(num_sub_queues, capacity));
+        sub_capacity = DIVIDE_UP(capacity, num_queues);
+
+        const uint32_t n = 2 * num_queues;
+
+        CUDA_ERROR(tracked_malloc((void**)&count,
+                                  sizeof(int),
+                                  MemoryCategory::Topology));
+        CUDA_ERROR(tracked_malloc((void**)&sub_count,
+                                  n * sizeof(int),
+                                  MemoryCategory::Topology));
+        CUDA_ERROR(tracked_malloc((void**)&front,
+                                  n * sizeof(int),
+                                  MemoryCategory::Topology));
+        CUDA_ERROR(tracked_malloc((void**)&back,
+                                  n * sizeof(int),
+                                  MemoryCategory::Topology));
+        CUDA_ERROR(tracked_malloc((void**)&list,
+                                  sizeof(uint32_t) * n * sub_capacity,
+                                  MemoryCategory::Topology));
+        CUDA_ERROR(tracked_malloc((void**)&num_in_flight,
+                                  sizeof(int),
+                                  MemoryCategory::Topology));
+        CUDA_ERROR(tracked_malloc((void**)&num_deferred,
+                                  sizeof(int),
+                                  MemoryCategory::Topology));
+        CUDA_ERROR(tracked_malloc((void**)&deferred_list,
+                                  sizeof(uint32_t) * capacity,
+                                  MemoryCategory::Topology));
+        CUDA_ERROR(cudaMemset(num_in_flight, 0, sizeof(int)));
+        CUDA_ERROR(cudaMemset(num_deferred, 0, sizeof(int)));
     }
 
     __host__ void print_list() const
     {
-        std::vector<uint32_t> h_list(capacity);
+        std::vector<uint32_t> h_list(2 * num_queues * sub_capacity);
         CUDA_ERROR(cudaMemcpy(h_list.data(),
                               list,
                               h_list.size() * sizeof(uint32_t),
                               cudaMemcpyDeviceToHost));
         for (uint32_t i = 0; i < h_list.size(); ++i) {
-            printf("\n list[%u]= %u", i, h_list[i]);
+            printf("\n list[%u][%u]= %u",
+                   i / sub_capacity,
+                   i % sub_capacity,
+                   h_list[i]);
         }
     }
 
@@ -153,9 +333,52 @@ struct PatchScheduler
     __host__ void free()
     {
         GPU_FREE(count);
+        GPU_FREE(sub_count);
         GPU_FREE(front);
         GPU_FREE(back);
         GPU_FREE(list);
+        GPU_FREE(num_in_flight);
+        GPU_FREE(num_deferred);
+        GPU_FREE(deferred_list);
+    }
+
+    /**
+     * @brief index of the sub-queue of a given (per-SM) queue and priority
+     */
+    __host__ __device__ __inline__ uint32_t
+    sub_queue_id(const uint32_t queue, const bool low_priority) const
+    {
+        return low_priority ? num_queues + queue : queue;
+    }
+
+    /**
+     * @brief pop a patch from one sub-queue. Return INVALID32 if it is empty
+     */
+    __device__ __inline__ uint32_t pop_sub_queue(const uint32_t q)
+    {
+        uint32_t pid = INVALID32;
+#ifdef __CUDA_ARCH__
+        if (::atomicAdd(sub_count + q, 0) <= 0) {
+            return pid;
+        }
+
+        int readable = ::atomicSub(sub_count + q, 1);
+
+        if (readable <= 0) {
+            ::atomicAdd(sub_count + q, 1);
+        } else {
+            int pos = ::atomicAdd(front + q, 1) % sub_capacity;
+
+            uint32_t* q_list = list + q * sub_capacity;
+
+            // the loop because another thread/block may have just incremented
+            // the count but has not yet wrote to the list
+            while (pid == INVALID32) {
+                pid = atomicExch(q_list + pos, INVALID32);
+            }
+        }
+#endif
+        return pid;
     }
 
     /**
@@ -183,11 +406,32 @@ struct PatchScheduler
         return size(stream) == 0;
     }
 
-    int*      count;
+    // total number of patches in all sub-queues
+    int* count;
+
+    // per sub-queue count, front, and back. The high-priority level of all
+    // sub-queues comes first followed by the low-priority level
+    int*      sub_count;
     int*      front;
     int*      back;
+    int*      num_in_flight;
+    int*      num_deferred;
     uint32_t  capacity;
+    uint32_t  num_queues;
+    uint32_t  sub_capacity;
     uint32_t* list;
+    uint32_t* deferred_list;
+
+    // set (on a copy of the context) by RXMeshDynamic::run_persistent() such
+    // that CavityManager defers patches that need cleanup instead of pushing
+    // them back to the queue
+    bool persistent;
+
+    // set (on a copy of the context) by RXMeshDynamic::run_colored() when the
+    // queue only contains patches of one color class. Since the patch graph
+    // coloring is a distance-2 coloring, such patches do not share neighbor
+    // patches and CavityManager does not need to lock them
+    bool lock_free;
 };
 
 }  // namespace rxmesh
\ No newline at end of file
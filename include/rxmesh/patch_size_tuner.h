@@ -0,0 +1,310 @@
+#pragma once
+
+#include <stdint.h>
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "rxmesh/kernels/get_arch.cuh"
+#include "rxmesh/rxmesh_static.h"
+#include "rxmesh/util/import_mesh.h"
+#include "rxmesh/util/log.h"
+#include "rxmesh/util/timer.h"
+
+namespace rxmesh {
+
+/**
+ * @brief Pick the patch size that gives the fastest query kernels for a set of
+ * query operations and a block size on the current GPU. Candidate patchings of
+ * the input mesh are built and a representative query kernel (one per query
+ * operation) is timed on each of them. Candidates that do not fit in the shared
+ * memory of the device are skipped. The winner is cached in a small on-disk
+ * database keyed by (GPU, block size, op set, mesh size class) such that later
+ * runs on meshes of similar size skip the tuning. The mesh size class is
+ * floor(log2(#faces))
+ * @tparam blockThreads the block size of the kernels
+ */
+template <uint32_t blockThreads>
+class PatchSizeTuner
+{
+   public:
+    /**
+     * @param db_file the database file. It is created if it does not exist
+     * @param candidates the candidate patch sizes
+     * @param num_run number of times each query kernel is timed
+     */
+    PatchSizeTuner(
+        const std::string           db_file    = "rxmesh_patch_size.db",
+        const std::vector<uint32_t> candidates = {128, 256, 512, 768, 1024},
+        const uint32_t              num_run    = 5)
+        : m_db_file(db_file), m_candidates(candidates), m_num_run(num_run)
+    {
+        load_db();
+    }
+
+    /**
+     * @brief return the best patch size for the mesh in file_path and the
+     * query operations ops. Look it up in the database first and only tune if
+     * there is no entry for this (GPU, block size, op set, mesh size class)
+     */
+    uint32_t tune(const std::string& file_path, const std::vector<Op>& ops)
+    {
+        std::vector<float>    vertices;
+        std::vector<uint32_t> fv, face_offset;
+        if (!import_mesh(file_path, vertices, fv, face_offset) ||
+            !face_offset.empty()) {
+            RXMESH_ERROR(
+                "PatchSizeTuner::tune() could not read the input file {} or it "
+                "has non-triangular faces",
+                file_path);
+            exit(EXIT_FAILURE);
+        }
+        return tune(fv.data(), static_cast<uint32_t>(fv.size() / 3), ops);
+    }
+
+    /**
+     * @brief same as tune() but for a flat triangle index buffer (3*num_faces)
+     */
+    uint32_t tune(const uint32_t*        fv,
+                  const uint32_t         num_faces,
+                  const std::vector<Op>& ops)
+    {
+        const std::string key = make_key(num_faces, ops);
+
+        auto it = m_db.find(key);
+        if (it != m_db.end()) {
+            RXMESH_INFO("PatchSizeTuner::tune() found patch size {} for {}",
+                        it->second,
+                        key);
+            return it->second;
+        }
+
+        float    best_time       = std::numeric_limits<float>::max();
+        uint32_t best_patch_size = 0;
+
+        for (const uint32_t patch_size : m_candidates) {
+            RXMeshStatic rx(fv, num_faces, "", patch_size);
+
+            float time = 0;
+            for (const Op op : canonical_ops(ops)) {
+                const float t = time_op(rx, op);
+                if (t < 0) {
+                    time = -1;
+                    break;
+                }
+                time += t;
+            }
+
+            if (time < 0) {
+                RXMESH_INFO(
+                    "PatchSizeTuner::tune() patch size {} does not fit in "
+                    "the shared memory",
+                    patch_size);
+                continue;
+            }
+
+            RXMESH_INFO("PatchSizeTuner::tune() patch size {} took {} (ms)",
+                        patch_size,
+                        time);
+
+            if (time < best_time) {
+                best_time       = time;
+                best_patch_size = patch_size;
+            }
+        }
+
+        if (best_patch_size == 0) {
+            RXMESH_ERROR(
+                "PatchSizeTuner::tune() none of the candidate patch sizes fits "
+                "in the shared memory");
+            exit(EXIT_FAILURE);
+        }
+
+        m_db[key] = best_patch_size;
+        save_db();
+
+        RXMESH_INFO("PatchSizeTuner::tune() best patch size for {} is {}",
+                    key,
+                    best_patch_size);
+
+        return best_patch_size;
+    }
+
+    /**
+     * @brief check if the database has an entry for a mesh with num_faces
+     * faces and the query operations ops on the current GPU
+     */
+    bool is_cached(const uint32_t num_faces, const std::vector<Op>& ops) const
+    {
+        return m_db.find(make_key(num_faces, ops)) != m_db.end();
+    }
+
+    /**
+     * @brief the database key of a mesh with num_faces faces and the query
+     * operations ops on the current GPU
+     */
+    std::string make_key(const uint32_t         num_faces,
+                         const std::vector<Op>& ops) const
+    {
+        int device_id;
+        CUDA_ERROR(cudaGetDevice(&device_id));
+        cudaDeviceProp dev_prop;
+        CUDA_ERROR(cudaGetDeviceProperties(&dev_prop, device_id));
+
+        std::string key = std::string(dev_prop.name) + "|sm" +
+                          std::to_string(cuda_arch()) + "|" +
+                          std::to_string(dev_prop.multiProcessorCount) +
+                          "SMs|b" + std::to_string(blockThreads) + "|";
+
+        for (const Op op : canonical_ops(ops)) {
+            key += op_to_string(op) + ",";
+        }
+
+        const uint32_t size_class = static_cast<uint32_t>(
+            std::floor(std::log2(double(std::max(num_faces, 1u)))));
+
+        key += "|f" + std::to_string(size_class);
+
+        return key;
+    }
+
+    /**
+     * @brief time the representative query kernel of the query operation op
+     * on rx. Return -1 if the kernel does not fit in the shared memory
+     */
+    float time_op(RXMeshStatic& rx, const Op op)
+    {
+        switch (op) {
+            case Op::VV:
+                return time_query<Op::VV>(rx);
+            case Op::VE:
+                return time_query<Op::VE>(rx);
+            case Op::VF:
+                return time_query<Op::VF>(rx);
+            case Op::EV:
+                return time_query<Op::EV>(rx);
+            case Op::EF:
+                return time_query<Op::EF>(rx);
+            case Op::FV:
+                return time_query<Op::FV>(rx);
+            case Op::FE:
+                return time_query<Op::FE>(rx);
+            case Op::FF:
+                return time_query<Op::FF>(rx);
+            case Op::EVDiamond:
+                return time_query<Op::EVDiamond>(rx);
+            default: {
+                RXMESH_ERROR(
+                    "PatchSizeTuner::time_op() unsupported query operation {}",
+                    op_to_string(op));
+                exit(EXIT_FAILURE);
+            }
+        }
+    }
+
+    /**
+     * @brief average time of a query kernel that reads all the output of the
+     * query operation op. Return -1 if the kernel does not fit in the shared
+     * memory
+     */
+    template <Op op>
+    float time_query(RXMeshStatic& rx)
+    {
+        using HandleT   = typename InputHandle<op>::type;
+        using IteratorT = typename IteratorType<op>::type;
+
+        auto attr = rx.add_attribute<uint32_t, HandleT>(
+            "rx:tuner_" + op_to_string(op), 1, DEVICE);
+
+        auto a = *attr;
+
+        auto query = [a] __device__(const HandleT&   h,
+                                    const IteratorT& iter) mutable {
+            uint32_t sum = 0;
+            for (uint32_t i = 0; i < iter.size(); ++i) {
+                sum += iter.local(i);
+            }
+            a(h) = sum;
+        };
+
+        LaunchBox<blockThreads> lb;
+        rx.prepare_launch_box(
+            {op},
+            lb,
+            (void*)detail::query_kernel<blockThreads, op, decltype(query)>);
+
+        int device_id;
+        CUDA_ERROR(cudaGetDevice(&device_id));
+        cudaDeviceProp dev_prop;
+        CUDA_ERROR(cudaGetDeviceProperties(&dev_prop, device_id));
+
+        float time = -1;
+
+        if (lb.smem_bytes_dyn + lb.smem_bytes_static <=
+            dev_prop.sharedMemPerBlockOptin) {
+            // warm up
+            rx.run_query_kernel<op>(lb, query);
+
+            GPUTimer timer;
+            timer.start();
+            for (uint32_t r = 0; r < m_num_run; ++r) {
+                rx.run_query_kernel<op>(lb, query);
+            }
+            timer.stop();
+            CUDA_ERROR(cudaDeviceSynchronize());
+            time = timer.elapsed_millis() / float(m_num_run);
+        }
+
+        rx.remove_attribute("rx:tuner_" + op_to_string(op));
+
+        return time;
+    }
+
+   private:
+    static std::vector<Op> canonical_ops(std::vector<Op> ops)
+    {
+        std::sort(ops.begin(), ops.end());
+        ops.erase(std::unique(ops.begin(), ops.end()), ops.end());
+        return ops;
+    }
+
+    void load_db()
+    {
+        std::ifstream file(m_db_file);
+        if (!file.is_open()) {
+            return;
+        }
+        std::string line;
+        while (std::getline(file, line)) {
+            const size_t tab = line.rfind('\t');
+            if (tab == std::string::npos) {
+                continue;
+            }
+            m_db[line.substr(0, tab)] =
+                static_cast<uint32_t>(std::stoul(line.substr(tab + 1)));
+        }
+    }
+
+    void save_db() const
+    {
+        std::ofstream file(m_db_file);
+        if (!file.is_open()) {
+            RXMESH_WARN("PatchSizeTuner::save_db() can not open {}",
+                        m_db_file);
+            return;
+        }
+        for (const auto& entry : m_db) {
+            file << entry.first << "\t" << entry.second << "\n";
+        }
+    }
+
+    std::string                     m_db_file;
+    std::vector<uint32_t>           m_candidates;
+    uint32_t                        m_num_run;
+    std::map<std::string, uint32_t> m_db;
+};
+}  // namespace rxmesh
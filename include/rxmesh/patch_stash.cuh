@@ -3,6 +3,7 @@
 
 #include "rxmesh/kernels/shmem_mutex.cuh"
 #include "rxmesh/lp_pair.cuh"
+#include "rxmesh/util/out_of_core.h"
 
 namespace rxmesh {
 
@@ -16,8 +17,8 @@ struct PatchStash
     explicit __host__ PatchStash(bool on_device) : m_is_on_device(on_device)
     {
         if (m_is_on_device) {
-            CUDA_ERROR(
-                cudaMalloc((void**)&m_stash, stash_size * sizeof(uint32_t)));
+            CUDA_ERROR(device_malloc((void**)&m_stash,
+                                     stash_size * sizeof(uint32_t)));
             CUDA_ERROR(
                 cudaMemset(m_stash, INVALID8, stash_size * sizeof(uint32_t)));
         } else {
@@ -149,6 +150,17 @@ struct PatchStash
     }
 
 
+    /**
+     * @brief Migrate the stash to the device ahead of its use in the
+     * out-of-core mode (see device_malloc())
+     */
+    __host__ void prefetch(cudaStream_t stream = NULL) const
+    {
+        if (m_is_on_device) {
+            prefetch_to_device(m_stash, stash_size * sizeof(uint32_t), stream);
+        }
+    }
+
     __host__ void free()
     {
         if (m_is_on_device) {
@@ -1,7 +1,9 @@
 #include <assert.h>
 #include <stdint.h>
+#include <algorithm>
 #include <functional>
 #include <iomanip>
+#include <numeric>
 #include <queue>
 #include <unordered_map>
 #include "cub/device/device_radix_sort.cuh"
@@ -31,26 +33,28 @@ Patcher::Patcher(std::string filename)
     print_statistics();
 }
 
-Patcher::Patcher(uint32_t                                        patch_size,
-                 const std::vector<uint32_t>&                    ff_offset,
-                 const std::vector<uint32_t>&                    ff_values,
-                 const std::vector<std::vector<uint32_t>>&       fv,
+Patcher::Patcher(uint32_t                                         patch_size,
+                 const std::vector<uint32_t>&                     ff_offset,
+                 const std::vector<uint32_t>&                     ff_values,
+                 const uint32_t*                                  fv,
                  const std::unordered_map<std::pair<uint32_t, uint32_t>,
                                           uint32_t,
-                                          detail::edge_key_hash> edges_map,
-                 const uint32_t                                  num_vertices,
-                 const uint32_t                                  num_edges,
-                 bool                                            use_metis)
+                                          detail::edge_key_hash>& edges_map,
+                 const uint32_t                                   num_vertices,
+                 const uint32_t                                   num_edges,
+                 bool                                             use_metis,
+                 const PatcherBudget&                             budget)
     : m_patch_size(patch_size),
       m_num_patches(0),
       m_num_vertices(num_vertices),
       m_num_edges(num_edges),
-      m_num_faces(fv.size()),
+      m_num_faces(static_cast<uint32_t>(ff_offset.size() - 1)),
       m_num_seeds(0),
       m_max_num_patches(0),
       m_num_components(0),
       m_num_lloyd_run(0),
-      m_patching_time_ms(0.0)
+      m_patching_time_ms(0.0),
+      m_budget(budget)
 
 {
 
@@ -116,6 +120,8 @@ Patcher::Patcher(uint32_t                                        patch_size,
         } else {
             if (use_metis) {
                 metis_kway(ff_offset, ff_values);
+            } else if (m_budget.num_levels > 0) {
+                multilevel_lloyd(ff_offset, ff_values);
             } else {
                 initialize_random_seeds(seeds, ff_offset, ff_values);
                 allocate_device_memory(seeds,
@@ -153,6 +159,9 @@ Patcher::Patcher(uint32_t                                        patch_size,
                           d_patches_val);
             }
         }
+#ifdef USE_PATCH_ORDERING
+        reorder_patches(ff_offset, ff_values);
+#endif
         extract_ribbons(fv, ff_offset, ff_values);
         // bfs(ff_offset, ff_values);
         assign_patch(fv, edges_map);
@@ -178,7 +187,107 @@ Patcher::Patcher(uint32_t                                        patch_size,
     GPU_FREE(d_patches_val);
 }
 
-void Patcher::grid(const std::vector<std::vector<uint32_t>>& fv)
+Patcher::Patcher(uint32_t                     patch_size,
+                 const std::vector<uint32_t>& prev_face_patch,
+                 const std::vector<uint32_t>& ff_offset,
+                 const std::vector<uint32_t>& ff_values,
+                 const uint32_t*              fv,
+                 const std::unordered_map<std::pair<uint32_t, uint32_t>,
+                                          uint32_t,
+                                          detail::edge_key_hash>& edges_map,
+                 const uint32_t num_vertices,
+                 const uint32_t num_edges)
+    : m_patch_size(patch_size),
+      m_num_patches(0),
+      m_num_vertices(num_vertices),
+      m_num_edges(num_edges),
+      m_num_faces(static_cast<uint32_t>(ff_offset.size() - 1)),
+      m_num_seeds(0),
+      m_max_num_patches(0),
+      m_num_components(0),
+      m_num_lloyd_run(0),
+      m_patching_time_ms(0.0)
+{
+    if (prev_face_patch.size() != m_num_faces) {
+        RXMESH_ERROR(
+            "Patcher::Patcher() the previous face patch has {} faces while "
+            "the mesh has {} faces",
+            prev_face_patch.size(),
+            m_num_faces);
+        exit(EXIT_FAILURE);
+    }
+
+    // number the previous patches that still have faces consecutively while
+    // preserving their relative order
+    uint32_t prev_num_patches = 0;
+    for (uint32_t f = 0; f < m_num_faces; ++f) {
+        if (prev_face_patch[f] != INVALID32) {
+            prev_num_patches =
+                std::max(prev_num_patches, prev_face_patch[f] + 1);
+        }
+    }
+    std::vector<bool> is_used(prev_num_patches, false);
+    for (uint32_t f = 0; f < m_num_faces; ++f) {
+        if (prev_face_patch[f] != INVALID32) {
+            is_used[prev_face_patch[f]] = true;
+        }
+    }
+    std::vector<uint32_t> prev_to_new(prev_num_patches, INVALID32);
+    for (uint32_t p = 0; p < prev_num_patches; ++p) {
+        if (is_used[p]) {
+            prev_to_new[p] = m_num_patches++;
+        }
+    }
+
+    m_max_num_patches =
+        5 * std::max(m_num_patches, DIVIDE_UP(m_num_faces, m_patch_size));
+    m_num_seeds = m_num_patches;
+
+    std::vector<uint32_t> seeds;
+    allocate_memory(seeds);
+
+    for (uint32_t f = 0; f < m_num_faces; ++f) {
+        if (prev_face_patch[f] != INVALID32) {
+            m_face_patch[f] = prev_to_new[prev_face_patch[f]];
+        }
+    }
+
+    CPUTimer timer;
+    timer.start();
+
+    std::vector<uint32_t> region_patches, region_faces;
+    find_affected_patches(ff_offset, ff_values, region_patches, region_faces);
+
+    m_num_repatched_faces = static_cast<uint32_t>(region_faces.size());
+
+    run_local_lloyd(ff_offset, ff_values, region_patches, region_faces);
+
+    m_num_repatched_patches = static_cast<uint32_t>(region_patches.size());
+
+    timer.stop();
+    m_patching_time_ms = timer.elapsed_millis();
+
+    m_num_seeds = m_num_patches;
+
+    std::vector<std::vector<uint32_t>> components;
+    get_multi_components(components, ff_offset, ff_values);
+    m_num_components = components.size();
+
+    compute_inital_compressed_patches();
+    extract_ribbons(fv, ff_offset, ff_values);
+    assign_patch(fv, edges_map);
+
+    calc_edge_cut(fv, ff_offset, ff_values);
+
+    RXMESH_INFO(
+        "Patcher: incremental patching re-patched {} patches ({} faces)",
+        m_num_repatched_patches,
+        m_num_repatched_faces);
+
+    print_statistics();
+}
+
+void Patcher::grid(const uint32_t* fv)
 {
     // this only work if the input is a mesh coming from create_plane()
     // where are laid out sequentially and so we can just group them using
@@ -212,9 +321,9 @@ void Patcher::grid(const std::vector<std::vector<uint32_t>>& fv)
         // for (uint32_t v = 0; v < fv[f].size(); ++v) {
         //     minn = std::min(fv[f][v], minn);
         // }
-        uint32_t id0 = calc_id(fv[f][0]);
-        uint32_t id1 = calc_id(fv[f][1]);
-        uint32_t id2 = calc_id(fv[f][2]);
+        uint32_t id0 = calc_id(fv[3 * f + 0]);
+        uint32_t id1 = calc_id(fv[3 * f + 1]);
+        uint32_t id2 = calc_id(fv[3 * f + 2]);
 
         m_face_patch[f] = std::max(id0, std::max(id1, id2));
     }
@@ -274,10 +383,12 @@ void Patcher::allocate_device_memory(const std::vector<uint32_t>& seeds,
                                      uint32_t*& d_patches_val)
 {
     // ff
-    CUDA_ERROR(
-        cudaMalloc((void**)&d_ff_values, ff_values.size() * sizeof(uint32_t)));
-    CUDA_ERROR(
-        cudaMalloc((void**)&d_ff_offset, ff_offset.size() * sizeof(uint32_t)));
+    CUDA_ERROR(tracked_malloc((void**)&d_ff_values,
+                              ff_values.size() * sizeof(uint32_t),
+                              MemoryCategory::Topology));
+    CUDA_ERROR(tracked_malloc((void**)&d_ff_offset,
+                              ff_offset.size() * sizeof(uint32_t),
+                              MemoryCategory::Topology));
 
     CUDA_ERROR(cudaMemcpy((void**)d_ff_values,
                           ff_values.data(),
@@ -289,12 +400,14 @@ void Patcher::allocate_device_memory(const std::vector<uint32_t>& seeds,
                           ff_offset.size() * sizeof(uint32_t),
                           cudaMemcpyHostToDevice));
     // face/vertex/edge patch
-    CUDA_ERROR(
-        cudaMalloc((void**)&d_face_patch, m_num_faces * sizeof(uint32_t)));
+    CUDA_ERROR(tracked_malloc((void**)&d_face_patch,
+                              m_num_faces * sizeof(uint32_t),
+                              MemoryCategory::Topology));
 
     // seeds
-    CUDA_ERROR(
-        cudaMalloc((void**)&d_seeds, m_max_num_patches * sizeof(uint32_t)));
+    CUDA_ERROR(tracked_malloc((void**)&d_seeds,
+                              m_max_num_patches * sizeof(uint32_t),
+                              MemoryCategory::Topology));
 
     CUDA_ERROR(cudaMemcpy((void**)d_seeds,
                           seeds.data(),
@@ -306,23 +419,34 @@ void Patcher::allocate_device_memory(const std::vector<uint32_t>& seeds,
     // 1-> queue end
     // 2-> next queue end
     std::vector<uint32_t> h_queue_ptr{0, m_num_patches, m_num_patches};
-    CUDA_ERROR(cudaMalloc((void**)&d_queue, m_num_faces * sizeof(uint32_t)));
-    CUDA_ERROR(cudaMalloc((void**)&d_queue_ptr, 3 * sizeof(uint32_t)));
+    CUDA_ERROR(tracked_malloc((void**)&d_queue,
+                              m_num_faces * sizeof(uint32_t),
+                              MemoryCategory::Topology));
+    CUDA_ERROR(tracked_malloc((void**)&d_queue_ptr,
+                              3 * sizeof(uint32_t),
+                              MemoryCategory::Topology));
     CUDA_ERROR(cudaMemcpy(d_queue_ptr,
                           h_queue_ptr.data(),
                           3 * sizeof(uint32_t),
                           cudaMemcpyHostToDevice));
 
     // patch offset/size/value and max patch size
-    CUDA_ERROR(cudaMalloc((void**)&d_patches_offset,
-                          m_max_num_patches * sizeof(uint32_t)));
-    CUDA_ERROR(cudaMalloc((void**)&d_patches_size,
-                          m_max_num_patches * sizeof(uint32_t)));
-    CUDA_ERROR(
-        cudaMalloc((void**)&d_patches_val, m_num_faces * sizeof(uint32_t)));
-    CUDA_ERROR(cudaMalloc((void**)&d_max_patch_size, sizeof(uint32_t)));
-
-    CUDA_ERROR(cudaMalloc((void**)&d_new_num_patches, sizeof(uint32_t)));
+    CUDA_ERROR(tracked_malloc((void**)&d_patches_offset,
+                              m_max_num_patches * sizeof(uint32_t),
+                              MemoryCategory::Topology));
+    CUDA_ERROR(tracked_malloc((void**)&d_patches_size,
+                              m_max_num_patches * sizeof(uint32_t),
+                              MemoryCategory::Topology));
+    CUDA_ERROR(tracked_malloc((void**)&d_patches_val,
+                              m_num_faces * sizeof(uint32_t),
+                              MemoryCategory::Topology));
+    CUDA_ERROR(tracked_malloc((void**)&d_max_patch_size,
+                              sizeof(uint32_t),
+                              MemoryCategory::Topology));
+
+    CUDA_ERROR(tracked_malloc((void**)&d_new_num_patches,
+                              sizeof(uint32_t),
+                              MemoryCategory::Topology));
 
     CUDA_ERROR(cudaMemcpy((void**)d_new_num_patches,
                           &m_num_patches,
@@ -344,13 +468,17 @@ void Patcher::allocate_device_memory(const std::vector<uint32_t>& seeds,
                              d_patches_size,
                              d_max_patch_size,
                              m_max_num_patches);
-    CUDA_ERROR(cudaMalloc((void**)&d_cub_temp_storage_scan, cub_scan_bytes));
-    CUDA_ERROR(cudaMalloc((void**)&d_cub_temp_storage_max, cub_max_bytes));
+    CUDA_ERROR(tracked_malloc((void**)&d_cub_temp_storage_scan,
+                              cub_scan_bytes,
+                              MemoryCategory::Topology));
+    CUDA_ERROR(tracked_malloc((void**)&d_cub_temp_storage_max,
+                              cub_max_bytes,
+                              MemoryCategory::Topology));
 }
 
-void Patcher::calc_edge_cut(const std::vector<std::vector<uint32_t>>& fv,
-                            const std::vector<uint32_t>&              ff_offset,
-                            const std::vector<uint32_t>&              ff_values)
+void Patcher::calc_edge_cut(const uint32_t*              fv,
+                            const std::vector<uint32_t>& ff_offset,
+                            const std::vector<uint32_t>& ff_values)
 {
     // given a graph where nodes represents faces in the mesh and two nodes
     // are connected in this graph if two faces share an edge, we calculate
@@ -375,10 +503,10 @@ void Patcher::calc_edge_cut(const std::vector<std::vector<uint32_t>>& fv,
     uint32_t num_edges = 0;
 
     for (uint32_t f = 0; f < m_num_faces; ++f) {
-        for (uint32_t i = 0; i < fv[f].size(); ++i) {
+        for (uint32_t i = 0; i < 3; ++i) {
 
-            uint32_t v0 = fv[f][i];
-            uint32_t v1 = fv[f][(i + 1) % fv[f].size()];
+            uint32_t v0 = fv[3 * f + i];
+            uint32_t v1 = fv[3 * f + (i + 1) % 3];
 
             std::pair<uint32_t, uint32_t> edge = detail::edge_key(v0, v1);
 
@@ -399,6 +527,98 @@ void Patcher::calc_edge_cut(const std::vector<std::vector<uint32_t>>& fv,
                 face_edge_cut,
                 vertex_edge_cut);
 }
+void Patcher::group_patches(const std::vector<uint32_t>& face_group_offset,
+                            std::vector<uint32_t>&       group_patch_offset)
+{
+    const uint32_t num_groups =
+        static_cast<uint32_t>(face_group_offset.size()) - 1;
+
+    auto face_group = [&](const uint32_t f) {
+        auto it = std::upper_bound(
+            face_group_offset.begin(), face_group_offset.end(), f);
+        return static_cast<uint32_t>(it - face_group_offset.begin()) - 1;
+    };
+
+    // the group of each patch is the group of its faces
+    std::vector<uint32_t> patch_group(m_num_patches, 0);
+    for (uint32_t p = 0; p < m_num_patches; ++p) {
+        const uint32_t p_start = (p == 0) ? 0 : m_patches_offset[p - 1];
+        const uint32_t p_end   = m_patches_offset[p];
+        if (p_start == p_end) {
+            patch_group[p] = (p == 0) ? 0 : patch_group[p - 1];
+            continue;
+        }
+        patch_group[p] = face_group(m_patches_val[p_start]);
+        for (uint32_t f = p_start + 1; f < p_end; ++f) {
+            if (face_group(m_patches_val[f]) != patch_group[p]) {
+                RXMESH_ERROR(
+                    "Patcher::group_patches() patch {} contains faces from "
+                    "different groups ({} and {})",
+                    p,
+                    patch_group[p],
+                    face_group(m_patches_val[f]));
+                exit(EXIT_FAILURE);
+            }
+        }
+    }
+
+    // new order of the patches and the new id of each (old) patch
+    std::vector<uint32_t> new_order(m_num_patches);
+    fill_with_sequential_numbers(new_order.data(), new_order.size());
+    std::stable_sort(new_order.begin(),
+                     new_order.end(),
+                     [&](const uint32_t a, const uint32_t b) {
+                         return patch_group[a] < patch_group[b];
+                     });
+
+    std::vector<uint32_t> new_id(m_num_patches);
+    for (uint32_t i = 0; i < m_num_patches; ++i) {
+        new_id[new_order[i]] = i;
+    }
+
+    group_patch_offset.clear();
+    group_patch_offset.resize(num_groups + 1, 0);
+    for (uint32_t p = 0; p < m_num_patches; ++p) {
+        group_patch_offset[patch_group[p] + 1]++;
+    }
+    std::inclusive_scan(group_patch_offset.begin(),
+                        group_patch_offset.end(),
+                        group_patch_offset.begin());
+
+    auto renumber = [&](std::vector<uint32_t>& element_patch) {
+        for (auto& p : element_patch) {
+            if (p != INVALID32) {
+                p = new_id[p];
+            }
+        }
+    };
+    renumber(m_face_patch);
+    renumber(m_vertex_patch);
+    renumber(m_edge_patch);
+
+    // reorder the compressed storage where offset[p] is the end of patch p
+    auto reorder = [&](std::vector<uint32_t>& val,
+                       std::vector<uint32_t>& offset) {
+        std::vector<uint32_t> new_val(val.size());
+        std::vector<uint32_t> new_offset(m_num_patches);
+        uint32_t              size = 0;
+        for (uint32_t i = 0; i < m_num_patches; ++i) {
+            const uint32_t p       = new_order[i];
+            const uint32_t p_start = (p == 0) ? 0 : offset[p - 1];
+            const uint32_t p_end   = offset[p];
+            std::copy(val.begin() + p_start,
+                      val.begin() + p_end,
+                      new_val.begin() + size);
+            size += p_end - p_start;
+            new_offset[i] = size;
+        }
+        std::copy(new_val.begin(), new_val.begin() + size, val.begin());
+        std::copy(new_offset.begin(), new_offset.end(), offset.begin());
+    };
+    reorder(m_patches_val, m_patches_offset);
+    reorder(m_ribbon_ext_val, m_ribbon_ext_offset);
+}
+
 void Patcher::print_statistics()
 {
     RXMESH_INFO("Patcher: num_patches = {}", m_num_patches);
@@ -579,6 +799,224 @@ void Patcher::get_multi_components(
     }
 }
 
+void Patcher::lloyd(std::vector<uint32_t>&       seeds,
+                    const std::vector<uint32_t>& ff_offset,
+                    const std::vector<uint32_t>& ff_values)
+{
+    uint32_t* d_face_patch            = nullptr;
+    uint32_t* d_queue                 = nullptr;
+    uint32_t* d_queue_ptr             = nullptr;
+    uint32_t* d_ff_values             = nullptr;
+    uint32_t* d_ff_offset             = nullptr;
+    void*     d_cub_temp_storage_scan = nullptr;
+    void*     d_cub_temp_storage_max  = nullptr;
+    size_t    cub_scan_bytes          = 0;
+    size_t    cub_max_bytes           = 0;
+    uint32_t* d_seeds                 = nullptr;
+    uint32_t* d_new_num_patches       = nullptr;
+    uint32_t* d_max_patch_size        = nullptr;
+    uint32_t* d_patches_offset        = nullptr;
+    uint32_t* d_patches_size          = nullptr;
+    uint32_t* d_patches_val           = nullptr;
+
+    allocate_device_memory(seeds,
+                           ff_offset,
+                           ff_values,
+                           d_face_patch,
+                           d_queue,
+                           d_queue_ptr,
+                           d_ff_values,
+                           d_ff_offset,
+                           d_cub_temp_storage_scan,
+                           d_cub_temp_storage_max,
+                           cub_scan_bytes,
+                           cub_max_bytes,
+                           d_seeds,
+                           d_new_num_patches,
+                           d_max_patch_size,
+                           d_patches_offset,
+                           d_patches_size,
+                           d_patches_val);
+    run_lloyd(d_face_patch,
+              d_queue,
+              d_queue_ptr,
+              d_ff_values,
+              d_ff_offset,
+              d_cub_temp_storage_scan,
+              d_cub_temp_storage_max,
+              cub_scan_bytes,
+              cub_max_bytes,
+              d_seeds,
+              d_new_num_patches,
+              d_max_patch_size,
+              d_patches_offset,
+              d_patches_size,
+              d_patches_val);
+
+    seeds.resize(m_num_patches);
+    CUDA_ERROR(cudaMemcpy(seeds.data(),
+                          d_seeds,
+                          sizeof(uint32_t) * m_num_patches,
+                          cudaMemcpyDeviceToHost));
+
+    GPU_FREE(d_face_patch);
+    GPU_FREE(d_queue);
+    GPU_FREE(d_queue_ptr);
+    GPU_FREE(d_ff_values);
+    GPU_FREE(d_ff_offset);
+    GPU_FREE(d_cub_temp_storage_scan);
+    GPU_FREE(d_cub_temp_storage_max);
+    GPU_FREE(d_seeds);
+    GPU_FREE(d_new_num_patches);
+    GPU_FREE(d_max_patch_size);
+    GPU_FREE(d_patches_offset);
+    GPU_FREE(d_patches_size);
+    GPU_FREE(d_patches_val);
+}
+
+void Patcher::multilevel_lloyd(const std::vector<uint32_t>& ff_offset,
+                               const std::vector<uint32_t>& ff_values)
+{
+    CPUTimer timer;
+    timer.start();
+
+    // the graph at the current level. node_rep is one input face in every node
+    std::vector<uint32_t> g_offset(ff_offset), g_values(ff_values);
+    std::vector<uint32_t> node_weight(m_num_faces, 1);
+    std::vector<uint32_t> node_rep(m_num_faces);
+    fill_with_sequential_numbers(node_rep.data(), node_rep.size());
+
+    std::vector<uint32_t> node_match, c_offset, c_values, c_weight, c_rep,
+        c_members, neighbours;
+
+    uint32_t num_levels = 0;
+    for (uint32_t l = 0; l < m_budget.num_levels; ++l) {
+        const uint32_t num_nodes = static_cast<uint32_t>(node_weight.size());
+
+        // match every node with its lightest unmatched neighbor
+        node_match.assign(num_nodes, INVALID32);
+        c_weight.clear();
+        c_rep.clear();
+        c_members.clear();
+        for (uint32_t u = 0; u < num_nodes; ++u) {
+            if (node_match[u] != INVALID32) {
+                continue;
+            }
+            uint32_t best = INVALID32;
+            for (uint32_t i = g_offset[u]; i < g_offset[u + 1]; ++i) {
+                const uint32_t v = g_values[i];
+                if (v != u && node_match[v] == INVALID32 &&
+                    (best == INVALID32 || node_weight[v] < node_weight[best])) {
+                    best = v;
+                }
+            }
+            const uint32_t c = static_cast<uint32_t>(c_weight.size());
+            node_match[u]    = c;
+            c_weight.push_back(node_weight[u]);
+            c_rep.push_back(node_rep[u]);
+            c_members.push_back(u);
+            if (best != INVALID32) {
+                node_match[best] = c;
+                c_weight.back() += node_weight[best];
+            }
+            c_members.push_back(best);
+        }
+
+        const uint32_t num_coarse = static_cast<uint32_t>(c_weight.size());
+
+        // stop if the graph does not shrink anymore or if it gets too small
+        // to have several nodes per patch
+        if (num_coarse == num_nodes || num_coarse < 4 * m_num_patches) {
+            break;
+        }
+
+        // coarse graph in compressed format
+        c_offset.resize(num_coarse + 1);
+        c_offset[0] = 0;
+        c_values.clear();
+        for (uint32_t c = 0; c < num_coarse; ++c) {
+            neighbours.clear();
+            for (uint32_t m = 0; m < 2; ++m) {
+                const uint32_t u = c_members[2 * c + m];
+                if (u == INVALID32) {
+                    continue;
+                }
+                for (uint32_t i = g_offset[u]; i < g_offset[u + 1]; ++i) {
+                    const uint32_t n = node_match[g_values[i]];
+                    if (n != c) {
+                        neighbours.push_back(n);
+                    }
+                }
+            }
+            std::sort(neighbours.begin(), neighbours.end());
+            neighbours.erase(std::unique(neighbours.begin(), neighbours.end()),
+                             neighbours.end());
+            c_values.insert(
+                c_values.end(), neighbours.begin(), neighbours.end());
+            c_offset[c + 1] = static_cast<uint32_t>(c_values.size());
+        }
+
+        g_offset.swap(c_offset);
+        g_values.swap(c_values);
+        node_weight.swap(c_weight);
+        node_rep.swap(c_rep);
+        num_levels++;
+    }
+
+    timer.stop();
+    const float coarsening_time_ms = timer.elapsed_millis();
+
+    const uint32_t num_nodes = static_cast<uint32_t>(node_weight.size());
+
+    // patch the coarsest graph with a patch size scaled by the average node
+    // weight
+    const uint32_t coarse_patch_size = std::max(
+        2u,
+        static_cast<uint32_t>(static_cast<double>(m_patch_size) *
+                              static_cast<double>(num_nodes) /
+                              static_cast<double>(m_num_faces)));
+
+    Patcher coarse;
+    coarse.m_num_faces        = num_nodes;
+    coarse.m_num_vertices     = 0;
+    coarse.m_num_edges        = 0;
+    coarse.m_patch_size       = coarse_patch_size;
+    coarse.m_num_patches      = m_num_patches;
+    coarse.m_num_seeds        = m_num_patches;
+    coarse.m_max_num_patches  = m_max_num_patches;
+    coarse.m_num_components   = 0;
+    coarse.m_num_lloyd_run    = 0;
+    coarse.m_patching_time_ms = 0;
+
+    std::vector<uint32_t> coarse_seeds;
+    coarse.allocate_memory(coarse_seeds);
+    coarse.initialize_random_seeds(coarse_seeds, g_offset, g_values);
+    coarse.m_num_patches = static_cast<uint32_t>(coarse_seeds.size());
+    coarse.lloyd(coarse_seeds, g_offset, g_values);
+
+    // project the coarse seeds to the input faces and refine
+    m_num_patches = coarse.m_num_patches;
+    m_num_seeds   = m_num_patches;
+    std::vector<uint32_t> seeds(m_num_patches);
+    for (uint32_t p = 0; p < m_num_patches; ++p) {
+        seeds[p] = node_rep[coarse_seeds[p]];
+    }
+    m_num_components = coarse.m_num_components;
+
+    lloyd(seeds, ff_offset, ff_values);
+
+    RXMESH_INFO(
+        "Patcher: multilevel patching with {} levels ({} coarse nodes), "
+        "coarsening time = {} (ms), coarse Lloyd = {} runs in {} (ms)",
+        num_levels,
+        num_nodes,
+        coarsening_time_ms,
+        coarse.m_num_lloyd_run,
+        coarse.m_patching_time_ms);
+
+    m_patching_time_ms += coarsening_time_ms + coarse.m_patching_time_ms;
+}
+
 void Patcher::bfs(const std::vector<uint32_t>& ff_offset,
                   const std::vector<uint32_t>& ff_values)
 {
@@ -636,7 +1074,313 @@ void Patcher::bfs(const std::vector<uint32_t>& ff_offset,
     }
 }
 
-void Patcher::extract_ribbons(const std::vector<std::vector<uint32_t>>& fv,
+void Patcher::reorder_patches(const std::vector<uint32_t>& ff_offset,
+                              const std::vector<uint32_t>& ff_values)
+{
+    // patch graph
+    std::vector<std::vector<uint32_t>> patch_neighbour(m_num_patches);
+    for (uint32_t f = 0; f < m_num_faces; ++f) {
+        const uint32_t p = m_face_patch[f];
+        for (uint32_t i = ff_offset[f]; i < ff_offset[f + 1]; ++i) {
+            const uint32_t n_patch = m_face_patch[ff_values[i]];
+            if (n_patch != p) {
+                patch_neighbour[p].push_back(n_patch);
+            }
+        }
+    }
+    for (auto& np : patch_neighbour) {
+        std::sort(np.begin(), np.end());
+        np.erase(std::unique(np.begin(), np.end()), np.end());
+    }
+
+    auto lower_degree = [&](const uint32_t a, const uint32_t b) {
+        return patch_neighbour[a].size() < patch_neighbour[b].size();
+    };
+
+    // start every connected component of the patch graph from its min-degree
+    // patch and visit the neighbors in increasing degree order
+    std::vector<uint32_t> start_order(m_num_patches);
+    fill_with_sequential_numbers(start_order.data(), start_order.size());
+    std::stable_sort(start_order.begin(), start_order.end(), lower_degree);
+
+    std::vector<uint32_t> order;
+    order.reserve(m_num_patches);
+    std::vector<bool> visited(m_num_patches, false);
+
+    for (const uint32_t start : start_order) {
+        if (visited[start]) {
+            continue;
+        }
+        visited[start] = true;
+        size_t head    = order.size();
+        order.push_back(start);
+        while (head < order.size()) {
+            const uint32_t p     = order[head++];
+            const size_t   first = order.size();
+            for (const uint32_t n : patch_neighbour[p]) {
+                if (!visited[n]) {
+                    visited[n] = true;
+                    order.push_back(n);
+                }
+            }
+            std::stable_sort(order.begin() + first, order.end(), lower_degree);
+        }
+    }
+    std::reverse(order.begin(), order.end());
+
+    std::vector<uint32_t> new_id(m_num_patches);
+    for (uint32_t i = 0; i < m_num_patches; ++i) {
+        new_id[order[i]] = i;
+    }
+
+    for (auto& p : m_face_patch) {
+        p = new_id[p];
+    }
+
+    compute_inital_compressed_patches();
+}
+
+void Patcher::find_affected_patches(const std::vector<uint32_t>& ff_offset,
+                                    const std::vector<uint32_t>& ff_values,
+                                    std::vector<uint32_t>&       region_patches,
+                                    std::vector<uint32_t>&       region_faces)
+{
+    std::vector<bool>     is_affected(m_num_patches, false);
+    std::vector<uint32_t> patch_size(m_num_patches, 0);
+    std::vector<uint32_t> patch_first_face(m_num_patches, INVALID32);
+
+    // patches adjacent to new faces
+    for (uint32_t f = 0; f < m_num_faces; ++f) {
+        const uint32_t p = m_face_patch[f];
+        if (p == INVALID32) {
+            for (uint32_t i = ff_offset[f]; i < ff_offset[f + 1]; ++i) {
+                const uint32_t n_patch = m_face_patch[ff_values[i]];
+                if (n_patch != INVALID32) {
+                    is_affected[n_patch] = true;
+                }
+            }
+        } else {
+            if (patch_size[p]++ == 0) {
+                patch_first_face[p] = f;
+            }
+        }
+    }
+
+    // patches that got too large or got split into disconnected pieces (e.g.,
+    // by removing faces). We flood every such patch from its first face
+    std::vector<bool>    visited(m_num_faces, false);
+    std::queue<uint32_t> face_queue;
+    for (uint32_t p = 0; p < m_num_patches; ++p) {
+        if (is_affected[p]) {
+            continue;
+        }
+        if (patch_size[p] > m_patch_size) {
+            is_affected[p] = true;
+            continue;
+        }
+
+        uint32_t num_reached = 1;
+        face_queue.push(patch_first_face[p]);
+        visited[patch_first_face[p]] = true;
+        while (!face_queue.empty()) {
+            const uint32_t face = face_queue.front();
+            face_queue.pop();
+            for (uint32_t i = ff_offset[face]; i < ff_offset[face + 1]; ++i) {
+                const uint32_t n_face = ff_values[i];
+                if (m_face_patch[n_face] == p && !visited[n_face]) {
+                    visited[n_face] = true;
+                    num_reached++;
+                    face_queue.push(n_face);
+                }
+            }
+        }
+        if (num_reached != patch_size[p]) {
+            is_affected[p] = true;
+        }
+    }
+
+    region_patches.clear();
+    for (uint32_t p = 0; p < m_num_patches; ++p) {
+        if (is_affected[p]) {
+            region_patches.push_back(p);
+        }
+    }
+
+    region_faces.clear();
+    for (uint32_t f = 0; f < m_num_faces; ++f) {
+        const uint32_t p = m_face_patch[f];
+        if (p == INVALID32 || is_affected[p]) {
+            region_faces.push_back(f);
+        }
+    }
+}
+
+void Patcher::run_local_lloyd(const std::vector<uint32_t>& ff_offset,
+                              const std::vector<uint32_t>& ff_values,
+                              std::vector<uint32_t>&       region_patches,
+                              const std::vector<uint32_t>& region_faces)
+{
+    m_num_lloyd_run = 0;
+
+    if (region_faces.empty()) {
+        return;
+    }
+
+    std::vector<bool> in_region(m_num_faces, false);
+    for (const uint32_t f : region_faces) {
+        in_region[f] = true;
+    }
+
+    // map a patch id to its index in region_patches
+    std::vector<uint32_t> local_id(m_max_num_patches, INVALID32);
+    for (uint32_t i = 0; i < region_patches.size(); ++i) {
+        local_id[region_patches[i]] = i;
+    }
+
+    // the faces of every region patch (in BFS order from its seed after the
+    // first propagation) and its current seed
+    std::vector<std::vector<uint32_t>> patch_faces(region_patches.size());
+    std::vector<uint32_t> region_seeds(region_patches.size(), INVALID32);
+
+    for (const uint32_t f : region_faces) {
+        if (m_face_patch[f] != INVALID32) {
+            patch_faces[local_id[m_face_patch[f]]].push_back(f);
+        }
+    }
+
+    auto add_patch = [&](const uint32_t seed) {
+        if (m_num_patches >= m_max_num_patches) {
+            RXMESH_ERROR(
+                "Patcher::run_local_lloyd() m_num_patches exceeds "
+                "m_max_num_patches");
+            exit(EXIT_FAILURE);
+        }
+        local_id[m_num_patches] = static_cast<uint32_t>(region_patches.size());
+        region_patches.push_back(m_num_patches++);
+        region_seeds.push_back(seed);
+        patch_faces.emplace_back();
+    };
+
+    std::vector<bool>    visited(m_num_faces, false);
+    std::queue<uint32_t> face_queue;
+
+    // move the seed of every region patch to its most interior face i.e., the
+    // last face reached by a BFS that starts from the patch boundary
+    auto update_seeds = [&]() {
+        for (uint32_t i = 0; i < region_patches.size(); ++i) {
+            const uint32_t p = region_patches[i];
+            for (const uint32_t f : patch_faces[i]) {
+                bool is_boundary = (ff_offset[f + 1] - ff_offset[f] < 3);
+                for (uint32_t j = ff_offset[f]; j < ff_offset[f + 1]; ++j) {
+                    if (m_face_patch[ff_values[j]] != p) {
+                        is_boundary = true;
+                    }
+                }
+                if (is_boundary) {
+                    visited[f] = true;
+                    face_queue.push(f);
+                }
+            }
+            while (!face_queue.empty()) {
+                const uint32_t face = face_queue.front();
+                face_queue.pop();
+                region_seeds[i] = face;
+                for (uint32_t j = ff_offset[face]; j < ff_offset[face + 1];
+                     ++j) {
+                    const uint32_t n_face = ff_values[j];
+                    if (m_face_patch[n_face] == p && !visited[n_face]) {
+                        visited[n_face] = true;
+                        face_queue.push(n_face);
+                    }
+                }
+            }
+            for (const uint32_t f : patch_faces[i]) {
+                visited[f] = false;
+            }
+            // a patch without boundary (e.g., a closed component) keeps its
+            // seed. Only possible for the initial seeds
+            if (region_seeds[i] == INVALID32) {
+                region_seeds[i] = patch_faces[i].front();
+            }
+        }
+    };
+
+    // grow all region patches from their seeds in parallel (one BFS ring at
+    // a time) without crossing to faces outside the region
+    auto flood = [&]() {
+        while (!face_queue.empty()) {
+            const uint32_t face = face_queue.front();
+            face_queue.pop();
+            const uint32_t p = m_face_patch[face];
+            for (uint32_t j = ff_offset[face]; j < ff_offset[face + 1]; ++j) {
+                const uint32_t n_face = ff_values[j];
+                if (in_region[n_face] && m_face_patch[n_face] == INVALID32) {
+                    m_face_patch[n_face] = p;
+                    patch_faces[local_id[p]].push_back(n_face);
+                    face_queue.push(n_face);
+                }
+            }
+        }
+    };
+
+    auto propagate = [&]() {
+        for (const uint32_t f : region_faces) {
+            m_face_patch[f] = INVALID32;
+        }
+        for (uint32_t i = 0; i < region_patches.size(); ++i) {
+            patch_faces[i].clear();
+            m_face_patch[region_seeds[i]] = region_patches[i];
+            patch_faces[i].push_back(region_seeds[i]);
+            face_queue.push(region_seeds[i]);
+        }
+        flood();
+
+        // faces that are not reachable from any seed (e.g., a new connected
+        // component) start a new patch
+        for (const uint32_t f : region_faces) {
+            if (m_face_patch[f] == INVALID32) {
+                add_patch(f);
+                m_face_patch[f] = region_patches.back();
+                patch_faces.back().push_back(f);
+                face_queue.push(f);
+                flood();
+            }
+        }
+    };
+
+    update_seeds();
+
+    while (true) {
+        ++m_num_lloyd_run;
+
+        // split patches that are too large by adding a seed at their face
+        // that is the farthest from their seed
+        if (m_num_lloyd_run % 5 == 0) {
+            const uint32_t num_region_patches =
+                static_cast<uint32_t>(region_patches.size());
+            for (uint32_t i = 0; i < num_region_patches; ++i) {
+                if (patch_faces[i].size() > m_patch_size) {
+                    add_patch(patch_faces[i].back());
+                }
+            }
+        }
+
+        propagate();
+
+        size_t max_patch_size = 0;
+        for (const auto& pf : patch_faces) {
+            max_patch_size = std::max(max_patch_size, pf.size());
+        }
+
+        if (max_patch_size <= m_patch_size) {
+            break;
+        }
+
+        update_seeds();
+    }
+}
+
+void Patcher::extract_ribbons(const uint32_t*              fv,
                               const std::vector<uint32_t>& ff_offset,
                               const std::vector<uint32_t>& ff_values)
 {
@@ -661,8 +1405,8 @@ void Patcher::extract_ribbons(const std::vector<std::vector<uint32_t>>& fv,
         vertex_incident_faces[i].clear();
     }
     for (uint32_t face = 0; face < m_num_faces; ++face) {
-        for (uint32_t v = 0; v < fv[face].size(); ++v) {
-            vertex_incident_faces[fv[face][v]].push_back(face);
+        for (uint32_t v = 0; v < 3; ++v) {
+            vertex_incident_faces[fv[3 * face + v]].push_back(face);
         }
     }
 
@@ -701,11 +1445,12 @@ void Patcher::extract_ribbons(const std::vector<std::vector<uint32_t>>& fv,
                     // that are shared between face and n
 
                     // add the common vertices in fv[face] and fv[n]
-                    for (uint32_t i = 0; i < fv[face].size(); ++i) {
-                        auto it_vf =
-                            std::find(fv[n].begin(), fv[n].end(), fv[face][i]);
-                        if (it_vf != fv[n].end()) {
-                            bd_vertices.push_back(fv[face][i]);
+                    for (uint32_t i = 0; i < 3; ++i) {
+                        const uint32_t* fv_n  = fv + 3 * n;
+                        auto            it_vf = std::find(
+                            fv_n, fv_n + 3, fv[3 * face + i]);
+                        if (it_vf != fv_n + 3) {
+                            bd_vertices.push_back(fv[3 * face + i]);
                         }
                     }
 
@@ -771,10 +1516,10 @@ void Patcher::extract_ribbons(const std::vector<std::vector<uint32_t>>& fv,
 }
 
 void Patcher::assign_patch(
-    const std::vector<std::vector<uint32_t>>&                 fv,
+    const uint32_t*                                            fv,
     const std::unordered_map<std::pair<uint32_t, uint32_t>,
                              uint32_t,
-                             ::rxmesh::detail::edge_key_hash> edges_map)
+                             ::rxmesh::detail::edge_key_hash>& edges_map)
 {
     // For every patch p, for every face in the patch, find the three edges
     // that bound that face, and assign them to the patch. For boundary vertices
@@ -790,9 +1535,9 @@ void Patcher::assign_patch(
 
             uint32_t face = m_patches_val[f];
 
-            uint32_t v1 = fv[face].back();
-            for (uint32_t v = 0; v < fv[face].size(); ++v) {
-                uint32_t v0 = fv[face][v];
+            uint32_t v1 = fv[3 * face + 2];
+            for (uint32_t v = 0; v < 3; ++v) {
+                uint32_t v0 = fv[3 * face + v];
 
                 std::pair<uint32_t, uint32_t> key =
                     ::rxmesh::detail::edge_key(v0, v1);
@@ -902,6 +1647,9 @@ void Patcher::run_lloyd(uint32_t* d_face_patch,
     GPUTimer timer;
     timer.start();
 
+    CPUTimer budget_timer;
+    budget_timer.start();
+
     m_num_lloyd_run = 0;
     while (true) {
         ++m_num_lloyd_run;
@@ -1007,10 +1755,26 @@ void Patcher::run_lloyd(uint32_t* d_face_patch,
                                                             d_ff_values,
                                                             d_queue);
 
-        if (max_patch_size < m_patch_size) {
+        budget_timer.stop();
+        const bool out_of_budget =
+            (m_budget.max_num_lloyd_run > 0 &&
+             m_num_lloyd_run >= m_budget.max_num_lloyd_run) ||
+            (m_budget.max_time_ms > 0 &&
+             budget_timer.elapsed_millis() >= m_budget.max_time_ms);
+
+        if (max_patch_size < m_patch_size || out_of_budget) {
             shift<<<blocks_f, threads_f>>>(
                 m_num_faces, d_face_patch, d_patches_val);
 
+            if (max_patch_size >= m_patch_size) {
+                RXMESH_WARN(
+                    "Patcher::run_lloyd() stopped after {} Lloyd iterations "
+                    "(out of budget) with max patch size = {} while patch "
+                    "size = {}",
+                    m_num_lloyd_run,
+                    max_patch_size,
+                    m_patch_size);
+            }
             break;
         }
     }
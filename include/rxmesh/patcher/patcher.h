@@ -20,6 +20,26 @@ class RXMeshDynamic;
 
 namespace patcher {
 
+/**
+ * @brief Time/quality budget of the Lloyd patcher. The default is single-level
+ * Lloyd iterations that run until all patches are smaller than the patch size
+ */
+struct PatcherBudget
+{
+    // number of times the face graph is coarsened (by matching adjacent
+    // faces) before patching. The coarsest graph is patched with Lloyd and
+    // its seeds are projected back to the input faces where a few Lloyd
+    // iterations refine the patches. Zero means single-level patching
+    uint32_t num_levels = 0;
+
+    // max number of Lloyd iterations on the input faces. Zero means no limit
+    uint32_t max_num_lloyd_run = 0;
+
+    // max time (in ms) spent in Lloyd iterations on the input faces. Zero
+    // means no limit
+    float max_time_ms = 0;
+};
+
 /**
  * @brief Takes an input mesh and partition it to patches using Lloyd algorithm
  * on the gpu
@@ -32,16 +52,53 @@ class Patcher
    public:
     Patcher() = default;
 
-    Patcher(uint32_t                                  patch_size,
-            const std::vector<uint32_t>&              ff_offset,
-            const std::vector<uint32_t>&              ff_values,
-            const std::vector<std::vector<uint32_t>>& fv,
+    /**
+     * @brief partition the mesh into patches
+     * @param fv face incident vertices as a flat array (3*#faces). The number
+     * of faces is taken from ff_offset
+     * @param budget time/quality budget of the Lloyd patcher. Not used with
+     * METIS. If the budget is exhausted before convergence, some patches could
+     * be larger than patch_size
+     */
+    Patcher(uint32_t                     patch_size,
+            const std::vector<uint32_t>& ff_offset,
+            const std::vector<uint32_t>& ff_values,
+            const uint32_t*              fv,
+            const std::unordered_map<std::pair<uint32_t, uint32_t>,
+                                     uint32_t,
+                                     ::rxmesh::detail::edge_key_hash>&
+                                 edges_map,
+            const uint32_t       num_vertices,
+            const uint32_t       num_edges,
+            bool                 use_metis,
+            const PatcherBudget& budget = PatcherBudget());
+
+    /**
+     * @brief incrementally partition a mesh that differs from a previously
+     * patched mesh by local edits. Patches that are not touched by the edit
+     * keep their faces. Only the faces of affected patches (patches adjacent
+     * to a new face, patches that got larger than patch_size, or patches that
+     * got split into disconnected pieces) along with the new faces are
+     * re-patched by running Lloyd iterations restricted to them. Thus, the
+     * patching cost is proportional to the size of the edit rather than the
+     * size of the mesh
+     * @param prev_face_patch the previous patch of every face of this mesh
+     * (#faces) or INVALID32 for new faces. The caller maps the faces of this
+     * mesh to the faces of the previous mesh using stable face ids. Patch ids
+     * that have no faces anymore are dropped and the remaining patches are
+     * renumbered consecutively while preserving their order
+     */
+    Patcher(uint32_t                     patch_size,
+            const std::vector<uint32_t>& prev_face_patch,
+            const std::vector<uint32_t>& ff_offset,
+            const std::vector<uint32_t>& ff_values,
+            const uint32_t*              fv,
             const std::unordered_map<std::pair<uint32_t, uint32_t>,
                                      uint32_t,
-                                     ::rxmesh::detail::edge_key_hash> edges_map,
+                                     ::rxmesh::detail::edge_key_hash>&
+                           edges_map,
             const uint32_t num_vertices,
-            const uint32_t num_edges,
-            bool           use_metis);
+            const uint32_t num_edges);
 
     Patcher(std::string filename);
 
@@ -64,6 +121,11 @@ class Patcher
         return m_face_patch;
     }
 
+    const std::vector<uint32_t>& get_face_patch() const
+    {
+        return m_face_patch;
+    }
+
     std::vector<uint32_t>& get_vertex_patch()
     {
         return m_vertex_patch;
@@ -151,6 +213,38 @@ class Patcher
         return m_num_lloyd_run;
     }
 
+    /**
+     * @brief the number of patches that were re-patched by the incremental
+     * patching (including the new patches). Zero otherwise
+     */
+    uint32_t get_num_repatched_patches() const
+    {
+        return m_num_repatched_patches;
+    }
+
+    /**
+     * @brief the number of faces that were re-patched by the incremental
+     * patching. Zero otherwise
+     */
+    uint32_t get_num_repatched_faces() const
+    {
+        return m_num_repatched_faces;
+    }
+
+    /**
+     * @brief renumber the patches such that the patches of each group of faces
+     * are consecutive. Faces are divided into consecutive groups (e.g., one
+     * group per mesh in a batch) where group g is the faces in
+     * [face_group_offset[g], face_group_offset[g+1]). Every patch should only
+     * contain faces of one group. The relative order of the patches within a
+     * group is preserved. Can only be used for Lloyd patching since METIS could
+     * mix faces of different connected components in one patch
+     * @param face_group_offset the first face of each group (#groups + 1)
+     * @param group_patch_offset output first patch of each group (#groups + 1)
+     */
+    void group_patches(const std::vector<uint32_t>& face_group_offset,
+                       std::vector<uint32_t>&       group_patch_offset);
+
     void save(std::string filename)
     {
         std::ofstream                       ss(filename, std::ios::binary);
@@ -214,7 +308,7 @@ class Patcher
                                 uint32_t*& d_patches_size,
                                 uint32_t*& d_patches_val);
 
-    void grid(const std::vector<std::vector<uint32_t>>& fv);
+    void grid(const uint32_t* fv);
 
 
     /**
@@ -224,10 +318,10 @@ class Patcher
     void compute_inital_compressed_patches();
 
     void assign_patch(
-        const std::vector<std::vector<uint32_t>>&                 fv,
+        const uint32_t*                                            fv,
         const std::unordered_map<std::pair<uint32_t, uint32_t>,
                                  uint32_t,
-                                 ::rxmesh::detail::edge_key_hash> edges_map);
+                                 ::rxmesh::detail::edge_key_hash>& edges_map);
 
     void initialize_random_seeds(std::vector<uint32_t>&       seeds,
                                  const std::vector<uint32_t>& ff_offset,
@@ -242,9 +336,9 @@ class Patcher
                                              std::vector<uint32_t>& component,
                                              uint32_t               num_seeds);
 
-    void extract_ribbons(const std::vector<std::vector<uint32_t>>& fv,
-                         const std::vector<uint32_t>&              ff_offset,
-                         const std::vector<uint32_t>&              ff_values);
+    void extract_ribbons(const uint32_t*              fv,
+                         const std::vector<uint32_t>& ff_offset,
+                         const std::vector<uint32_t>& ff_values);
 
     uint32_t construct_patches_compressed_format(uint32_t* d_face_patch,
                                                  void*  d_cub_temp_storage_scan,
@@ -272,15 +366,65 @@ class Patcher
                    uint32_t* d_patches_size,
                    uint32_t* d_patches_val);
 
+    /**
+     * @brief allocate the device memory, run Lloyd iterations starting from
+     * seeds, and free the device memory. On return, seeds stores the final
+     * seed (most interior face) of every patch
+     */
+    void lloyd(std::vector<uint32_t>&       seeds,
+               const std::vector<uint32_t>& ff_offset,
+               const std::vector<uint32_t>& ff_values);
+
+    /**
+     * @brief coarsen the face graph m_budget.num_levels times by matching
+     * adjacent nodes, patch the coarsest graph with Lloyd, then seed the Lloyd
+     * iterations on the input faces from the coarse seeds
+     */
+    void multilevel_lloyd(const std::vector<uint32_t>& ff_offset,
+                          const std::vector<uint32_t>& ff_values);
+
     void bfs(const std::vector<uint32_t>& ff_offset,
              const std::vector<uint32_t>& ff_values);
 
+    /**
+     * @brief renumber the patches in Reverse Cuthill-McKee order of the patch
+     * graph (two patches are connected if they share an edge) such that
+     * neighbor patches get close ids and so their PatchInfo (and attributes)
+     * are close in memory. Recompute the compressed storage of the patches
+     */
+    void reorder_patches(const std::vector<uint32_t>& ff_offset,
+                         const std::vector<uint32_t>& ff_values);
+
+    /**
+     * @brief find the patches that need to be re-patched after an edit i.e.,
+     * patches adjacent to a new face (with INVALID32 face patch), patches
+     * larger than the patch size, and patches that are not connected
+     * @param region_patches output the affected patches
+     * @param region_faces output the faces of the affected patches along with
+     * the new faces
+     */
+    void find_affected_patches(const std::vector<uint32_t>& ff_offset,
+                               const std::vector<uint32_t>& ff_values,
+                               std::vector<uint32_t>&       region_patches,
+                               std::vector<uint32_t>&       region_faces);
+
+    /**
+     * @brief run Lloyd iterations on the host restricted to region_faces.
+     * Patches in region_patches are re-seeded from their most interior face
+     * and new patches are added if a patch gets too large or if some faces
+     * are not reachable from any seed
+     */
+    void run_local_lloyd(const std::vector<uint32_t>& ff_offset,
+                         const std::vector<uint32_t>& ff_values,
+                         std::vector<uint32_t>&       region_patches,
+                         const std::vector<uint32_t>& region_faces);
+
     void metis_kway(const std::vector<uint32_t>& ff_offset,
                     const std::vector<uint32_t>& ff_values);
 
-    void calc_edge_cut(const std::vector<std::vector<uint32_t>>& fv,
-                       const std::vector<uint32_t>&              ff_offset,
-                       const std::vector<uint32_t>&              ff_values);
+    void calc_edge_cut(const uint32_t*              fv,
+                       const std::vector<uint32_t>& ff_offset,
+                       const std::vector<uint32_t>& ff_values);
 
     uint32_t m_patch_size, m_num_patches, m_num_vertices, m_num_edges,
         m_num_faces, m_num_seeds, m_max_num_patches, m_num_components,
@@ -298,6 +442,12 @@ class Patcher
 
     // caching the time taken to construct the patches
     float m_patching_time_ms;
+
+    // incremental patching stats (not serialized)
+    uint32_t m_num_repatched_patches = 0;
+    uint32_t m_num_repatched_faces   = 0;
+
+    PatcherBudget m_budget;
 };
 
 }  // namespace patcher
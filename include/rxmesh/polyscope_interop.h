@@ -0,0 +1,413 @@
+#pragma once
+
+#if USE_POLYSCOPE
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#endif
+#include <cuda_gl_interop.h>
+
+#include <algorithm>
+#include <array>
+#include <cub/device/device_scan.cuh>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "polyscope/surface_mesh.h"
+
+#include "rxmesh/attribute.h"
+#include "rxmesh/kernels/render_compaction.cuh"
+#include "rxmesh/rxmesh_static.h"
+
+namespace rxmesh {
+
+/**
+ * @brief visualize a (possibly changing) mesh with polyscope without going
+ * through the host. The owned and active vertices and faces are compacted on
+ * the device and their positions, face indices, and scalar quantities are
+ * written directly into the OpenGL buffers that polyscope renders from using
+ * CUDA graphics interop. Thus, unlike RXMeshDynamic::update_polyscope(), this
+ * does not require update_host() or moving attributes to the host.
+ * Polyscope does not support changing the mesh topology and so the mesh is
+ * registered once with a capacity of vertices and faces. The faces beyond the
+ * current number of faces are written as degenerate (which polyscope does not
+ * rasterize). The mesh is re-registered (with more capacity) only if the
+ * number of vertices or faces exceeds the capacity. The mesh uses flat
+ * shading since polyscope computes the vertex normals for smooth shading on
+ * the host. Only triangle meshes are supported
+ */
+class PolyscopeInterop
+{
+   public:
+    /**
+     * @param rx the mesh
+     * @param name name of the polyscope surface mesh
+     * @param capacity_factor the capacity of the vertices and faces relative
+     * to the current number of vertices and faces (applied again every time
+     * the capacity is exceeded)
+     */
+    PolyscopeInterop(const RXMeshStatic& rx,
+                     const std::string&  name,
+                     float               capacity_factor = 1.2f)
+        : m_context(rx.get_context()),
+          m_name(name),
+          m_capacity_factor(std::max(capacity_factor, 1.f)),
+          m_max_num_patches(rx.get_max_num_patches()),
+          m_num_vertices(0),
+          m_num_faces(0),
+          m_vertex_capacity(0),
+          m_face_capacity(0),
+          m_ps_mesh(nullptr),
+          m_d_prefix_v(nullptr),
+          m_d_prefix_f(nullptr),
+          m_d_cub_temp_storage(nullptr),
+          m_cub_temp_storage_bytes(0)
+    {
+        const size_t bytes = (m_max_num_patches + 1) * sizeof(uint32_t);
+        CUDA_ERROR(tracked_malloc((void**)&m_d_prefix_v,
+                                  bytes,
+                                  MemoryCategory::Other));
+        CUDA_ERROR(tracked_malloc((void**)&m_d_prefix_f,
+                                  bytes,
+                                  MemoryCategory::Other));
+        CUDA_ERROR(cudaMemset(m_d_prefix_v, 0, bytes));
+        CUDA_ERROR(cudaMemset(m_d_prefix_f, 0, bytes));
+
+        cub::DeviceScan::ExclusiveSum(m_d_cub_temp_storage,
+                                      m_cub_temp_storage_bytes,
+                                      m_d_prefix_v,
+                                      m_d_prefix_v,
+                                      m_max_num_patches + 1);
+        CUDA_ERROR(tracked_malloc((void**)&m_d_cub_temp_storage,
+                                  m_cub_temp_storage_bytes,
+                                  MemoryCategory::Other));
+
+        register_mesh(
+            std::max(1u, uint32_t(rx.get_num_vertices() * m_capacity_factor)),
+            std::max(1u, uint32_t(rx.get_num_faces() * m_capacity_factor)));
+    }
+
+    PolyscopeInterop(const PolyscopeInterop&)            = delete;
+    PolyscopeInterop& operator=(const PolyscopeInterop&) = delete;
+
+    ~PolyscopeInterop()
+    {
+        release();
+    }
+
+    /**
+     * @brief compact the owned and active vertices and faces on the device
+     * and write the vertex positions and the face indices to polyscope. This
+     * should be called after every topology change and before
+     * update_vertex_scalar() and update_face_scalar()
+     * @param coords the vertex coordinates (on the device)
+     */
+    template <typename T>
+    void update(const VertexAttribute<T>& coords, cudaStream_t stream = NULL)
+    {
+        const uint32_t P = m_max_num_patches;
+
+        detail::render_count_owned<<<DIVIDE_UP(P, 256), 256, 0, stream>>>(
+            m_context, P, m_d_prefix_v, m_d_prefix_f);
+        CUDA_ERROR(cudaMemsetAsync(
+            m_d_prefix_v + P, 0, sizeof(uint32_t), stream));
+        CUDA_ERROR(cudaMemsetAsync(
+            m_d_prefix_f + P, 0, sizeof(uint32_t), stream));
+
+        for (uint32_t* prefix : {m_d_prefix_v, m_d_prefix_f}) {
+            cub::DeviceScan::ExclusiveSum(m_d_cub_temp_storage,
+                                          m_cub_temp_storage_bytes,
+                                          prefix,
+                                          prefix,
+                                          P + 1,
+                                          stream);
+        }
+
+        CUDA_ERROR(cudaMemcpyAsync(&m_num_vertices,
+                                   m_d_prefix_v + P,
+                                   sizeof(uint32_t),
+                                   cudaMemcpyDeviceToHost,
+                                   stream));
+        CUDA_ERROR(cudaMemcpyAsync(&m_num_faces,
+                                   m_d_prefix_f + P,
+                                   sizeof(uint32_t),
+                                   cudaMemcpyDeviceToHost,
+                                   stream));
+        CUDA_ERROR(cudaStreamSynchronize(stream));
+
+        if (m_num_vertices > m_vertex_capacity ||
+            m_num_faces > m_face_capacity) {
+            register_mesh(
+                std::max(uint32_t(m_num_vertices * m_capacity_factor),
+                         m_vertex_capacity),
+                std::max(uint32_t(m_num_faces * m_capacity_factor),
+                         m_face_capacity));
+        }
+
+        float* d_pos = static_cast<float*>(
+            map(m_ps_mesh->vertexPositions, m_pos_resource, stream));
+        uint32_t* d_ind = static_cast<uint32_t*>(
+            map(m_ps_mesh->triangleVertexInds, m_ind_resource, stream));
+
+        const uint32_t num_patches = P;
+
+        detail::render_compact_vertices<<<num_patches, 256, 0, stream>>>(
+            m_context, m_d_prefix_v, coords, d_pos);
+
+        detail::render_compact_faces<<<num_patches, 256, 0, stream>>>(
+            m_context, m_d_prefix_v, m_d_prefix_f, d_ind);
+
+        // degenerate faces for the unused capacity
+        CUDA_ERROR(cudaMemsetAsync(
+            d_ind + 3 * m_num_faces,
+            0,
+            3 * size_t(m_face_capacity - m_num_faces) * sizeof(uint32_t),
+            stream));
+
+        unmap(m_pos_resource, stream);
+        unmap(m_ind_resource, stream);
+
+        m_ps_mesh->vertexPositions.markRenderAttributeBufferUpdated();
+        m_ps_mesh->triangleVertexInds.markRenderAttributeBufferUpdated();
+    }
+
+    /**
+     * @brief add (or update) a vertex scalar quantity from one component of
+     * a vertex attribute (on the device) using the compaction computed by the
+     * last call to update()
+     */
+    template <typename T>
+    polyscope::SurfaceVertexScalarQuantity* update_vertex_scalar(
+        const std::string&        name,
+        const VertexAttribute<T>& attr,
+        const uint32_t            attr_id = 0,
+        cudaStream_t              stream  = NULL)
+    {
+        return update_scalar<VertexHandle>(
+            name, attr, attr_id, m_d_prefix_v, stream);
+    }
+
+    /**
+     * @brief add (or update) a face scalar quantity from one component of a
+     * face attribute (on the device) using the compaction computed by the
+     * last call to update()
+     */
+    template <typename T>
+    polyscope::SurfaceFaceScalarQuantity* update_face_scalar(
+        const std::string&      name,
+        const FaceAttribute<T>& attr,
+        const uint32_t          attr_id = 0,
+        cudaStream_t            stream  = NULL)
+    {
+        return update_scalar<FaceHandle>(
+            name, attr, attr_id, m_d_prefix_f, stream);
+    }
+
+    /**
+     * @brief the polyscope surface mesh. This may change after update() if
+     * the capacity is exceeded
+     */
+    polyscope::SurfaceMesh* get_polyscope_mesh()
+    {
+        return m_ps_mesh;
+    }
+
+    /**
+     * @brief the number of vertices/faces as of the last update()
+     */
+    uint32_t get_num_vertices() const
+    {
+        return m_num_vertices;
+    }
+    uint32_t get_num_faces() const
+    {
+        return m_num_faces;
+    }
+
+    /**
+     * @brief the number of vertices/faces the polyscope mesh is registered
+     * with
+     */
+    uint32_t get_vertex_capacity() const
+    {
+        return m_vertex_capacity;
+    }
+    uint32_t get_face_capacity() const
+    {
+        return m_face_capacity;
+    }
+
+    /**
+     * @brief unregister the OpenGL buffers and free the device memory. The
+     * polyscope mesh is not removed
+     */
+    void release()
+    {
+        release_resources();
+        GPU_FREE(m_d_prefix_v);
+        GPU_FREE(m_d_prefix_f);
+        GPU_FREE(m_d_cub_temp_storage);
+        m_cub_temp_storage_bytes = 0;
+    }
+
+   private:
+    /**
+     * @brief an OpenGL buffer registered with CUDA along with the native id it
+     * is registered with such that it is registered again if polyscope
+     * re-creates the buffer
+     */
+    struct Resource
+    {
+        cudaGraphicsResource_t resource  = nullptr;
+        uint32_t               native_id = INVALID32;
+    };
+
+    struct Scalar
+    {
+        polyscope::SurfaceScalarQuantity* quantity;
+        Resource                          resource;
+    };
+
+    template <typename HandleT, typename AttrT>
+    auto update_scalar(const std::string& name,
+                       const AttrT&       attr,
+                       const uint32_t     attr_id,
+                       const uint32_t*    prefix,
+                       cudaStream_t       stream)
+    {
+        constexpr bool is_v = std::is_same_v<HandleT, VertexHandle>;
+
+        using QuantityT =
+            std::conditional_t<is_v,
+                               polyscope::SurfaceVertexScalarQuantity,
+                               polyscope::SurfaceFaceScalarQuantity>;
+
+        const uint32_t capacity = is_v ? m_vertex_capacity : m_face_capacity;
+
+        auto it = m_scalars.find(name);
+        if (it == m_scalars.end()) {
+            std::vector<float> zeros(capacity, 0.f);
+            polyscope::SurfaceScalarQuantity* q;
+            if constexpr (is_v) {
+                q = m_ps_mesh->addVertexScalarQuantity(name, zeros);
+            } else {
+                q = m_ps_mesh->addFaceScalarQuantity(name, zeros);
+            }
+            it = m_scalars.emplace(name, Scalar{q, Resource()}).first;
+        }
+
+        QuantityT* q = dynamic_cast<QuantityT*>(it->second.quantity);
+        if (q == nullptr) {
+            RXMESH_ERROR(
+                "PolyscopeInterop::update_scalar() quantity {} is already "
+                "added on a different mesh element",
+                name);
+            return q;
+        }
+
+        float* d_val =
+            static_cast<float*>(map(q->values, it->second.resource, stream));
+
+        detail::render_compact_scalar<HandleT>
+            <<<m_max_num_patches, 256, 0, stream>>>(
+                m_context, prefix, attr, attr_id, d_val);
+
+        unmap(it->second.resource, stream);
+
+        q->values.markRenderAttributeBufferUpdated();
+
+        return q;
+    }
+
+    /**
+     * @brief register (or re-register) the polyscope mesh with the given
+     * capacity. All scalar quantities are dropped
+     */
+    void register_mesh(uint32_t vertex_capacity, uint32_t face_capacity)
+    {
+        release_resources();
+
+        m_vertex_capacity = vertex_capacity;
+        m_face_capacity   = face_capacity;
+
+        std::vector<glm::vec3> pos(m_vertex_capacity, glm::vec3(0.f));
+        std::vector<std::array<uint32_t, 3>> fv(m_face_capacity, {0, 0, 0});
+
+        m_ps_mesh = polyscope::registerSurfaceMesh(m_name, pos, fv);
+        m_ps_mesh->setShadeStyle(polyscope::MeshShadeStyle::Flat);
+    }
+
+    /**
+     * @brief map the render buffer of a polyscope buffer and return its
+     * device pointer
+     */
+    template <typename BufferT>
+    void* map(BufferT& buffer, Resource& r, cudaStream_t stream)
+    {
+        const uint32_t native_id =
+            buffer.getRenderAttributeBuffer()->getNativeBufferID();
+
+        if (r.native_id != native_id) {
+            if (r.resource != nullptr) {
+                CUDA_ERROR(cudaGraphicsUnregisterResource(r.resource));
+            }
+            CUDA_ERROR(cudaGraphicsGLRegisterBuffer(
+                &r.resource, native_id, cudaGraphicsRegisterFlagsNone));
+            r.native_id = native_id;
+        }
+
+        CUDA_ERROR(cudaGraphicsMapResources(1, &r.resource, stream));
+        void*  ptr;
+        size_t num_bytes;
+        CUDA_ERROR(
+            cudaGraphicsResourceGetMappedPointer(&ptr, &num_bytes, r.resource));
+        return ptr;
+    }
+
+    void unmap(Resource& r, cudaStream_t stream)
+    {
+        CUDA_ERROR(cudaGraphicsUnmapResources(1, &r.resource, stream));
+    }
+
+    void release_resource(Resource& r)
+    {
+        if (r.resource != nullptr) {
+            CUDA_ERROR(cudaGraphicsUnregisterResource(r.resource));
+        }
+        r = Resource();
+    }
+
+    void release_resources()
+    {
+        release_resource(m_pos_resource);
+        release_resource(m_ind_resource);
+        for (auto& s : m_scalars) {
+            release_resource(s.second.resource);
+        }
+        m_scalars.clear();
+    }
+
+    Context     m_context;
+    std::string m_name;
+    float       m_capacity_factor;
+    uint32_t    m_max_num_patches;
+
+    uint32_t m_num_vertices, m_num_faces;
+    uint32_t m_vertex_capacity, m_face_capacity;
+
+    polyscope::SurfaceMesh*                 m_ps_mesh;
+    Resource                                m_pos_resource, m_ind_resource;
+    std::unordered_map<std::string, Scalar> m_scalars;
+
+    uint32_t* m_d_prefix_v;
+    uint32_t* m_d_prefix_f;
+    void*     m_d_cub_temp_storage;
+    size_t    m_cub_temp_storage_bytes;
+};
+}  // namespace rxmesh
+
+#endif
@@ -0,0 +1,340 @@
+#pragma once
+
+#include <cstring>
+#include <limits>
+#include <sstream>
+
+#include "rxmesh/kernels/query_kernel.cuh"
+#include "rxmesh/rxmesh_dynamic.h"
+
+namespace rxmesh {
+
+namespace detail {
+
+/**
+ * @brief the state of the radix select that lives on the device such that
+ * the passes of the select do not need to synchronize with the host
+ */
+template <typename BitsT>
+struct RadixSelectState
+{
+    // the bits of the k-th smallest key found so far (the digits that are
+    // not resolved yet are zero)
+    BitsT prefix;
+    // how many elements are still needed among the ones that match prefix
+    uint32_t k;
+    // the number of elements that will be selected, i.e., min(k, #valid keys)
+    uint32_t count;
+    // the number of ties (elements whose key is the k-th key) selected so far
+    uint32_t ties;
+};
+
+/**
+ * @brief map a float/double key to an unsigned integer such that the order of
+ * the integers is the same as the order of the keys
+ */
+template <typename KeyT>
+__device__ __host__ __inline__ auto ordered_key_bits(const KeyT key)
+{
+    if constexpr (sizeof(KeyT) == 4) {
+        uint32_t u;
+        memcpy(&u, &key, sizeof(KeyT));
+        return (u & 0x80000000u) ? ~u : (u | 0x80000000u);
+    } else {
+        uint64_t u;
+        memcpy(&u, &key, sizeof(KeyT));
+        return (u & 0x8000000000000000ull) ? ~u : (u | 0x8000000000000000ull);
+    }
+}
+
+/**
+ * @brief find the digit (at shift) of the k-th smallest key among the
+ * elements whose higher digits match the current prefix. d_hist is the
+ * histogram of this digit (and it is reset here for the next pass)
+ */
+template <typename BitsT, int NumBins>
+__global__ static void radix_select_digit(uint32_t*                d_hist,
+                                          RadixSelectState<BitsT>* d_state,
+                                          const int                shift,
+                                          const bool               first)
+{
+    if (first) {
+        uint32_t total = 0;
+        for (int d = 0; d < NumBins; ++d) {
+            total += d_hist[d];
+        }
+        d_state->count = min(d_state->k, total);
+        d_state->k     = d_state->count;
+    }
+
+    if (d_state->k != 0) {
+        uint32_t before = 0;
+        for (int d = 0; d < NumBins; ++d) {
+            if (before + d_hist[d] >= d_state->k) {
+                d_state->prefix |= BitsT(d) << shift;
+                d_state->k -= before;
+                break;
+            }
+            before += d_hist[d];
+        }
+    }
+
+    for (int d = 0; d < NumBins; ++d) {
+        d_hist[d] = 0;
+    }
+}
+}  // namespace detail
+
+/**
+ * @brief a device priority queue over the vertices, edges, or faces of a
+ * dynamic mesh, e.g., to order edges by their collapse cost in decimation.
+ * Every element has a key (smaller is higher priority) and a dirty flag
+ * stored as attributes so they follow the elements through the dynamic
+ * changes (pass keys() and dirty() to cavity.prologue() and slice_patches()).
+ * update() recomputes the key only for the dirty elements, so after a round
+ * of collapses, only the elements touched by the collapses (which the collapse
+ * kernel marks dirty) are re-prioritized. select() gives the exact k smallest
+ * keys using a radix select on the key bits (one histogram pass per 8-bit
+ * digit) with all the passes running back to back on the device. Elements
+ * with infinite (or NaN) keys are never selected which can be used to block
+ * an element. Instead of a heap that is pushed to and popped from, this fits
+ * the bulk-synchronous rounds of the dynamic mesh where many elements are
+ * taken at once and only a fraction of the keys change between rounds
+ */
+template <typename HandleT, typename KeyT = float>
+struct PriorityQueue
+{
+    static_assert(std::is_same_v<KeyT, float> || std::is_same_v<KeyT, double>,
+                  "PriorityQueue: KeyT should be float or double");
+
+    using BitsT = std::conditional_t<sizeof(KeyT) == 4, uint32_t, uint64_t>;
+
+    static constexpr int RadixBits = 8;
+    static constexpr int NumBins   = 1 << RadixBits;
+    static constexpr int NumPasses = (8 * sizeof(KeyT)) / RadixBits;
+
+    PriorityQueue(RXMeshDynamic& rx)
+        : m_rx(rx), m_d_hist(nullptr), m_d_state(nullptr), m_h_state(nullptr)
+    {
+        std::ostringstream address;
+        address << (void const*)this;
+
+        m_keys = m_rx.add_attribute<KeyT, HandleT>(
+            "pq_keys" + address.str(), 1, DEVICE);
+        m_dirty = m_rx.add_attribute<bool, HandleT>(
+            "pq_dirty" + address.str(), 1, DEVICE);
+
+        m_keys->reset(std::numeric_limits<KeyT>::infinity(), DEVICE);
+        m_dirty->reset(true, DEVICE);
+
+        CUDA_ERROR(tracked_malloc((void**)&m_d_hist,
+                                  NumBins * sizeof(uint32_t),
+                                  MemoryCategory::Other));
+        CUDA_ERROR(cudaMemset(m_d_hist, 0, NumBins * sizeof(uint32_t)));
+        CUDA_ERROR(tracked_malloc((void**)&m_d_state,
+                                  sizeof(StateT),
+                                  MemoryCategory::Other));
+        CUDA_ERROR(cudaMallocHost((void**)&m_h_state, sizeof(StateT)));
+    }
+
+    PriorityQueue(const PriorityQueue&)            = delete;
+    PriorityQueue& operator=(const PriorityQueue&) = delete;
+
+    /**
+     * @brief the key of every element. Should be passed along with dirty()
+     * to cavity.prologue() and slice_patches()
+     */
+    Attribute<KeyT, HandleT>& keys()
+    {
+        return *m_keys;
+    }
+
+    /**
+     * @brief the dirty flag of every element. A kernel that changes the mesh
+     * should set it to true for the elements whose key changed (e.g., the
+     * edges created by a collapse) such that the next update() recomputes them
+     */
+    Attribute<bool, HandleT>& dirty()
+    {
+        return *m_dirty;
+    }
+
+    /**
+     * @brief mark all the elements as dirty so the next update() recomputes
+     * all the keys
+     */
+    void mark_all_dirty(cudaStream_t stream = NULL)
+    {
+        m_dirty->reset(true, DEVICE, stream);
+    }
+
+    /**
+     * @brief recompute the key of the dirty elements where the key is
+     * computed by a query, i.e., func is [=] __device__(HandleT h,
+     * IteratorT iter) -> KeyT where iter is the output of op for h (e.g.,
+     * Op::EV to compute the edge length). The dirty flag is cleared
+     */
+    template <Op op, uint32_t blockThreads, typename FuncT>
+    void update(FuncT        func,
+                const bool   oriented = false,
+                cudaStream_t stream   = NULL)
+    {
+        auto lambda = [func, keys = *m_keys, dirty = *m_dirty] __device__(
+                          const HandleT& h,
+                          const typename IteratorType<op>::type& iter) mutable {
+            if (dirty(h)) {
+                keys(h)  = func(h, iter);
+                dirty(h) = false;
+            }
+        };
+
+        LaunchBox<blockThreads> lb;
+        m_rx.update_launch_box(
+            {op},
+            lb,
+            detail::query_kernel_ptr<blockThreads, op, decltype(lambda)>(
+                oriented),
+            false,
+            oriented);
+
+        m_rx.run_query_kernel<op, blockThreads>(lb, lambda, oriented, stream);
+    }
+
+    /**
+     * @brief recompute the key of the dirty elements where the key only needs
+     * the element itself (or attributes on it), i.e., func is
+     * [=] __device__(HandleT h) -> KeyT. The dirty flag is cleared
+     */
+    template <typename FuncT>
+    void update(FuncT func, cudaStream_t stream = NULL)
+    {
+        m_rx.for_each<HandleT>(
+            DEVICE,
+            [func, keys = *m_keys, dirty = *m_dirty] __device__(
+                const HandleT& h) mutable {
+                if (dirty(h)) {
+                    keys(h)  = func(h);
+                    dirty(h) = false;
+                }
+            },
+            stream);
+    }
+
+    /**
+     * @brief select the k elements with the smallest keys, i.e., set selected
+     * to true for them and false for all other elements. Ties at the k-th key
+     * are broken arbitrarily. Dirty elements (whose key is out of date) and
+     * elements with infinite or NaN key are not selected. Returns the number
+     * of selected elements which is min(k, #valid elements). This is the only
+     * synchronization with the host
+     */
+    uint32_t select(const uint32_t            k,
+                    Attribute<bool, HandleT>& selected,
+                    cudaStream_t              stream = NULL)
+    {
+        StateT init;
+        init.prefix = 0;
+        init.k      = k;
+        init.count  = 0;
+        init.ties   = 0;
+        CUDA_ERROR(cudaMemcpyAsync(
+            m_d_state, &init, sizeof(StateT), cudaMemcpyHostToDevice, stream));
+
+        for (int pass = 0; pass < NumPasses; ++pass) {
+            const int shift = 8 * sizeof(KeyT) - (pass + 1) * RadixBits;
+
+            // the bits above the current digit that should match the prefix
+            const BitsT mask =
+                (pass == 0) ? BitsT(0) : ~BitsT(0) << (shift + RadixBits);
+
+            m_rx.for_each<HandleT>(
+                DEVICE,
+                [keys    = *m_keys,
+                 dirty   = *m_dirty,
+                 d_hist  = m_d_hist,
+                 d_state = m_d_state,
+                 shift,
+                 mask] __device__(const HandleT& h) {
+                    const KeyT key = keys(h);
+                    if (dirty(h) ||
+                        !(key < std::numeric_limits<KeyT>::infinity())) {
+                        return;
+                    }
+                    const BitsT bits = detail::ordered_key_bits(key);
+                    if ((bits & mask) == d_state->prefix) {
+                        atomicAdd(&d_hist[(bits >> shift) & (NumBins - 1)],
+                                  1u);
+                    }
+                },
+                stream);
+
+            detail::radix_select_digit<BitsT, NumBins>
+                <<<1, 1, 0, stream>>>(m_d_hist, m_d_state, shift, pass == 0);
+        }
+
+        m_rx.for_each<HandleT>(
+            DEVICE,
+            [keys     = *m_keys,
+             dirty    = *m_dirty,
+             selected = selected,
+             d_state  = m_d_state] __device__(const HandleT& h) mutable {
+                selected(h)    = false;
+                const KeyT key = keys(h);
+                if (d_state->count == 0 || dirty(h) ||
+                    !(key < std::numeric_limits<KeyT>::infinity())) {
+                    return;
+                }
+                const BitsT bits = detail::ordered_key_bits(key);
+                if (bits < d_state->prefix) {
+                    selected(h) = true;
+                } else if (bits == d_state->prefix) {
+                    if (atomicAdd(&d_state->ties, 1u) < d_state->k) {
+                        selected(h) = true;
+                    }
+                }
+            },
+            stream);
+
+        CUDA_ERROR(cudaMemcpyAsync(m_h_state,
+                                   m_d_state,
+                                   sizeof(StateT),
+                                   cudaMemcpyDeviceToHost,
+                                   stream));
+        CUDA_ERROR(cudaStreamSynchronize(stream));
+
+        return m_h_state->count;
+    }
+
+    /**
+     * @brief free the device memory and remove the attributes
+     */
+    void release()
+    {
+        GPU_FREE(m_d_hist);
+        GPU_FREE(m_d_state);
+        if (m_h_state) {
+            CUDA_ERROR(cudaFreeHost(m_h_state));
+            m_h_state = nullptr;
+        }
+        if (m_keys) {
+            m_rx.remove_attribute(m_keys->get_name());
+            m_keys.reset();
+        }
+        if (m_dirty) {
+            m_rx.remove_attribute(m_dirty->get_name());
+            m_dirty.reset();
+        }
+    }
+
+   private:
+    using StateT = detail::RadixSelectState<BitsT>;
+
+    RXMeshDynamic&                            m_rx;
+    std::shared_ptr<Attribute<KeyT, HandleT>> m_keys;
+    std::shared_ptr<Attribute<bool, HandleT>> m_dirty;
+    uint32_t*                                 m_d_hist;
+    StateT*                                   m_d_state;
+    StateT*                                   m_h_state;
+};
+
+}  // namespace rxmesh
@@ -18,8 +18,17 @@ struct Query
     Query(const Query&)            = delete;
     Query& operator=(const Query&) = delete;
 
-    __device__ __inline__ Query(const Context& context,
-                                const uint32_t pid = blockIdx.x)
+    /**
+     * @brief the query of the patch processed by this block i.e., blockIdx.x
+     * or, with a patch subset, the blockIdx.x-th patch in the subset (see
+     * Context::block_patch_id())
+     */
+    __device__ __inline__ Query(const Context& context)
+        : Query(context, context.block_patch_id())
+    {
+    }
+
+    __device__ __inline__ Query(const Context& context, const uint32_t pid)
         : m_context(context),
           m_patch_info(context.m_patches_info[pid]),
           m_num_src_in_patch(0),
@@ -28,7 +37,9 @@ struct Query
           m_s_output_offset(nullptr),
           m_s_output_value(nullptr),
           m_s_valence(nullptr),
-          m_s_table(nullptr)
+          m_s_table(nullptr),
+          m_s_ev_topo(nullptr),
+          m_s_fe_topo(nullptr)
     {
     }
 
@@ -105,6 +116,75 @@ struct Query
         return m_s_valence[vh.local_id()];
     }
 
+    /**
+     * @brief start a fused query section. The patch topology (EV and FE) is
+     * loaded from global memory into shared memory once and all subsequent
+     * queries done with this instance (dispatch() or prologue()) derive their
+     * output (e.g., VV, VF, and FF) from this shared memory copy instead of
+     * reloading it from global memory. The section is closed by end_fused().
+     * The extra shared memory should be accounted for by using
+     * RXMeshStatic::prepare_fused_launch_box(). The topology should not change
+     * during the fused section.
+     * @param block cooperative group block
+     * @param shrd_alloc dynamic shared memory allocator
+     */
+    __device__ __inline__ void begin_fused(
+        cooperative_groups::thread_block& block,
+        ShmemAllocator&                   shrd_alloc)
+    {
+        if (get_patch_id() == INVALID32) {
+            return;
+        }
+
+        assert(m_s_ev_topo == nullptr && m_s_fe_topo == nullptr);
+
+        const uint16_t num_edges = m_patch_info.num_edges[0];
+        const uint16_t num_faces = m_patch_info.num_faces[0];
+
+        m_shmem_before_fused = shrd_alloc.get_allocated_size_bytes();
+
+        uint16_t* s_ev = shrd_alloc.alloc<uint16_t>(2 * num_edges);
+        uint16_t* s_fe = shrd_alloc.alloc<uint16_t>(3 * num_faces);
+
+        detail::load_topology(
+            block,
+            m_patch_info,
+            reinterpret_cast<const uint16_t*>(m_patch_info.ev),
+            2 * num_edges,
+            s_ev,
+            false);
+        detail::load_topology(
+            block,
+            m_patch_info,
+            reinterpret_cast<const uint16_t*>(m_patch_info.fe),
+            3 * num_faces,
+            s_fe,
+            true);
+        block.sync();
+
+        m_s_ev_topo = s_ev;
+        m_s_fe_topo = s_fe;
+    }
+
+    /**
+     * @brief close a fused query section started by begin_fused() and free the
+     * shared memory used to store the patch topology. All queries done inside
+     * the section should have called their epilogue() before this call
+     */
+    __device__ __inline__ void end_fused(
+        cooperative_groups::thread_block& block,
+        ShmemAllocator&                   shrd_alloc)
+    {
+        if (get_patch_id() == INVALID32 || m_s_ev_topo == nullptr) {
+            return;
+        }
+        block.sync();
+        shrd_alloc.dealloc(shrd_alloc.get_allocated_size_bytes() -
+                           m_shmem_before_fused);
+        m_s_ev_topo = nullptr;
+        m_s_fe_topo = nullptr;
+    }
+
     /**
      * @brief The query dispatch function to be called by the whole block. In
      * this function, threads will be assigned to mesh elements which will be
@@ -137,12 +217,34 @@ struct Query
         using ComputeTraits  = detail::FunctionTraits<computeT>;
         using ComputeHandleT = typename ComputeTraits::template arg<0>::type;
 
-        dispatch<op>(
-            block,
-            shrd_alloc,
-            compute_op,
-            [](ComputeHandleT) { return true; },
-            oriented);
+        dispatch<op>(block,
+                     shrd_alloc,
+                     compute_op,
+                     detail::AllActive<ComputeHandleT>{},
+                     oriented);
+    }
+
+    /**
+     * @brief same as the above function but the orientation is known at
+     * compile time (std::true_type or std::false_type) such that only the
+     * code of this orientation is generated
+     */
+    template <Op op, typename computeT, bool orientedT>
+    __device__ __inline__ void dispatch(
+        cooperative_groups::thread_block&   block,
+        ShmemAllocator&                     shrd_alloc,
+        computeT                            compute_op,
+        const std::bool_constant<orientedT> oriented)
+    {
+        using ComputeTraits  = detail::FunctionTraits<computeT>;
+        using ComputeHandleT = typename ComputeTraits::template arg<0>::type;
+
+        dispatch<op>(block,
+                     shrd_alloc,
+                     compute_op,
+                     detail::AllActive<ComputeHandleT>{},
+                     oriented,
+                     std::false_type{});
     }
 
 
@@ -175,14 +277,22 @@ struct Query
      * @param oriented specifies if the query are oriented. Currently only VV
      * and EV query is supported for oriented queries. FV, FE and EV is oriented
      * by default
+     * @param allow_not_owned if the not-owned elements are sources too.
+     * oriented and allow_not_owned could also be std::true_type or
+     * std::false_type such that only the code of these flags is generated
      */
-    template <Op op, typename computeT, typename activeSetT>
-    __device__ __inline__ void dispatch(cooperative_groups::thread_block& block,
-                                        ShmemAllocator& shrd_alloc,
-                                        computeT        compute_op,
-                                        activeSetT      compute_active_set,
-                                        const bool      oriented        = false,
-                                        const bool      allow_not_owned = false)
+    template <Op op,
+              typename computeT,
+              typename activeSetT,
+              typename OrientedT      = bool,
+              typename AllowNotOwnedT = bool>
+    __device__ __inline__ void dispatch(
+        cooperative_groups::thread_block& block,
+        ShmemAllocator&                   shrd_alloc,
+        computeT                          compute_op,
+        activeSetT                        compute_active_set,
+        const OrientedT                   oriented        = false,
+        const AllowNotOwnedT              allow_not_owned = false)
     {
         if (get_patch_id() == INVALID32) {
             return;
@@ -215,6 +325,72 @@ struct Query
         epilogue(block, shrd_alloc);
     }
 
+    /**
+     * @brief the query dispatch function for an ensemble of num_samples
+     * samples (see RXMeshStatic::add_ensemble_attribute()). The query is done
+     * once and the computation is run on every (source element, sample) pair
+     * such that the cost of loading the topology into shared memory and
+     * computing the query is amortized over all samples. compute_op takes
+     * three parameters: the handle, the iterator (same as in dispatch()), and
+     * the sample index (uint32_t). Consecutive threads get the consecutive
+     * samples of the same source element
+     * @param num_samples the number of samples
+     * @param compute_active_set a predicate used to specify the active set
+     * (same as in dispatch())
+     * @param oriented specifies if the query are oriented
+     */
+    template <Op op, typename computeT, typename activeSetT>
+    __device__ __inline__ void dispatch_samples(
+        cooperative_groups::thread_block& block,
+        ShmemAllocator&                   shrd_alloc,
+        const uint32_t                    num_samples,
+        computeT                          compute_op,
+        activeSetT                        compute_active_set,
+        const bool                        oriented = false)
+    {
+        if (get_patch_id() == INVALID32) {
+            return;
+        }
+
+        using ComputeTraits    = detail::FunctionTraits<computeT>;
+        using ComputeHandleT   = typename ComputeTraits::template arg<0>::type;
+        using ActiveSetTraits  = detail::FunctionTraits<activeSetT>;
+        using ActiveSetHandleT =
+            typename ActiveSetTraits::template arg<0>::type;
+        static_assert(
+            std::is_same_v<ActiveSetHandleT, ComputeHandleT>,
+            "First argument of compute_op lambda function should "
+            "match the first argument of active_set lambda function ");
+
+        prologue<op>(block, shrd_alloc, compute_active_set, oriented, false);
+
+        run_compute_samples(block, num_samples, compute_op);
+
+        epilogue(block, shrd_alloc);
+    }
+
+    /**
+     * @brief same as the above function where all source elements are active
+     */
+    template <Op op, typename computeT>
+    __device__ __inline__ void dispatch_samples(
+        cooperative_groups::thread_block& block,
+        ShmemAllocator&                   shrd_alloc,
+        const uint32_t                    num_samples,
+        computeT                          compute_op,
+        const bool                        oriented = false)
+    {
+        using ComputeTraits  = detail::FunctionTraits<computeT>;
+        using ComputeHandleT = typename ComputeTraits::template arg<0>::type;
+
+        dispatch_samples<op>(block,
+                             shrd_alloc,
+                             num_samples,
+                             compute_op,
+                             detail::AllActive<ComputeHandleT>{},
+                             oriented);
+    }
+
     /**
      * @brief run the query and prepare internal data structure to run the
      * computation on top of the queries
@@ -225,25 +401,46 @@ struct Query
                                         const bool      oriented        = false,
                                         const bool      allow_not_owned = true)
     {
-        prologue<op>(
-            block,
-            shrd_alloc,
-            [](VertexHandle) { return true; },
-            oriented,
-            allow_not_owned);
+        prologue<op>(block,
+                     shrd_alloc,
+                     detail::AllActive<VertexHandle>{},
+                     oriented,
+                     allow_not_owned);
     }
 
+    /**
+     * @brief same as the above function but the flags are known at compile
+     * time (std::true_type or std::false_type)
+     */
+    template <Op op, bool orientedT, bool allowNotOwnedT = true>
+    __device__ __inline__ void prologue(
+        cooperative_groups::thread_block&        block,
+        ShmemAllocator&                          shrd_alloc,
+        const std::bool_constant<orientedT>      oriented,
+        const std::bool_constant<allowNotOwnedT> allow_not_owned = {})
+    {
+        prologue<op>(block,
+                     shrd_alloc,
+                     detail::AllActive<VertexHandle>{},
+                     oriented,
+                     allow_not_owned);
+    }
 
     /**
      * @brief run the query and prepare internal data structure to run the
-     * computation on top of the queries
+     * computation on top of the queries. oriented and allow_not_owned could
+     * be bool or std::bool_constant (see dispatch())
      */
-    template <Op op, typename activeSetT>
-    __device__ __inline__ void prologue(cooperative_groups::thread_block& block,
-                                        ShmemAllocator& shrd_alloc,
-                                        activeSetT      compute_active_set,
-                                        const bool      oriented        = false,
-                                        const bool      allow_not_owned = true)
+    template <Op op,
+              typename activeSetT,
+              typename OrientedT      = bool,
+              typename AllowNotOwnedT = bool>
+    __device__ __inline__ void prologue(
+        cooperative_groups::thread_block& block,
+        ShmemAllocator&                   shrd_alloc,
+        activeSetT                        compute_active_set,
+        const OrientedT                   oriented        = false,
+        const AllowNotOwnedT              allow_not_owned = true)
     {
         if (get_patch_id() == INVALID32) {
             return;
@@ -265,7 +462,10 @@ struct Query
             m_s_output_owned_bitmask,
             m_output_lp_hashtable,
             m_s_table,
-            allow_not_owned);
+            allow_not_owned,
+            m_s_ev_topo,
+            m_s_fe_topo,
+            m_context.get_query_cache(op));
     }
 
 
@@ -303,6 +503,41 @@ struct Query
     }
 
 
+    /**
+     * @brief same as run_compute() but compute_op is called on every (source
+     * element, sample) pair of num_samples samples (see dispatch_samples())
+     */
+    template <typename computeT>
+    __device__ __inline__ void run_compute_samples(
+        cooperative_groups::thread_block& block,
+        const uint32_t                    num_samples,
+        computeT                          compute_op)
+    {
+        if (get_patch_id() == INVALID32 || num_samples == 0) {
+            return;
+        }
+
+        using ComputeTraits    = detail::FunctionTraits<computeT>;
+        using ComputeHandleT   = typename ComputeTraits::template arg<0>::type;
+        using ComputeIteratorT = typename ComputeTraits::template arg<1>::type;
+
+        const uint32_t size = uint32_t(m_num_src_in_patch) * num_samples;
+
+        for (uint32_t i = threadIdx.x; i < size; i += blockThreads) {
+            const uint16_t local_id = i / num_samples;
+
+            if (detail::is_set_bit(local_id, m_s_participant_bitmask)) {
+
+                assert(m_s_output_value);
+
+                ComputeHandleT   handle(m_patch_info.patch_id, local_id);
+                ComputeIteratorT iter =
+                    get_iterator<ComputeIteratorT>(local_id);
+                compute_op(handle, iter, i % num_samples);
+            }
+        }
+    }
+
     /**
      * @brief return an iterator over the queries elements give a local index of
      * a source element
@@ -329,7 +564,9 @@ struct Query
                              m_output_lp_hashtable,
                              m_s_table,
                              m_patch_info.patch_stash,
-                             int(m_op == Op::FE));
+                             int(m_op == Op::FE),
+                             m_patch_info.template get_owner_table<
+                                 typename IteratorT::Handle>());
         } else {
             return IteratorT(m_context, local_id, m_patch_info.patch_id);
         }
@@ -361,6 +598,7 @@ struct Query
     const Context&   m_context;
     const PatchInfo& m_patch_info;
     uint32_t         m_shmem_before;
+    uint32_t         m_shmem_before_fused;
     uint32_t         m_num_src_in_patch;
     uint32_t*        m_s_participant_bitmask;
     uint32_t*        m_s_output_owned_bitmask;
@@ -369,6 +607,8 @@ struct Query
     uint8_t*         m_s_valence;
     LPHashTable      m_output_lp_hashtable;
     LPPair*          m_s_table;
+    const uint16_t*  m_s_ev_topo;
+    const uint16_t*  m_s_fe_topo;
     Op               m_op;
 };
 }  // namespace rxmesh
\ No newline at end of file
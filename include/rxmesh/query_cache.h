@@ -0,0 +1,117 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "rxmesh/types.h"
+#include "rxmesh/util/macros.h"
+
+namespace rxmesh {
+
+/**
+ * @brief Materialized output of a query operation for all patches. The output
+ * of a patch is the offset and value arrays the query would build in shared
+ * memory (the not-owned elements are resolved through the patch LP hashtable
+ * which already lives in global memory). Queries launched on a patch with a
+ * valid cached output load it instead of re-computing it. This is managed by
+ * RXMeshStatic::enable_query_cache()
+ */
+struct QueryCache
+{
+    static constexpr uint32_t num_ops = uint32_t(Op::EVDiamond) + 1;
+
+    __host__ __device__ QueryCache()
+        : m_offset_start(nullptr),
+          m_value_start(nullptr),
+          m_offset(nullptr),
+          m_value(nullptr),
+          m_valid(nullptr),
+          m_num_patches(0),
+          m_oriented(false)
+    {
+    }
+
+    /**
+     * @brief check if the cached output of patch p is valid and matches the
+     * query orientation
+     */
+    __device__ __inline__ bool is_valid(const uint32_t p,
+                                        const bool     oriented) const
+    {
+        return m_valid != nullptr && p < m_num_patches &&
+               m_oriented == oriented && m_valid[p] != 0;
+    }
+
+    /**
+     * @brief invalidate the cached output of patch p e.g., after it has been
+     * modified
+     */
+    __device__ __inline__ void invalidate(const uint32_t p)
+    {
+        if (m_valid != nullptr && p < m_num_patches) {
+            m_valid[p] = 0;
+        }
+    }
+
+    /**
+     * @brief upper bound of the number of offset and value entries of the
+     * output of a query operation on a patch with (at most) num_vertices,
+     * num_edges, and num_faces. Ops with a fixed offset (e.g., EV) have no
+     * offset array
+     */
+    __host__ __device__ static void output_size(const Op       op,
+                                                const uint32_t num_vertices,
+                                                const uint32_t num_edges,
+                                                const uint32_t num_faces,
+                                                uint32_t&      num_offset,
+                                                uint32_t&      num_value)
+    {
+        num_offset = 0;
+        num_value  = 0;
+        switch (op) {
+            case Op::VV:
+            case Op::VE:
+                num_offset = num_vertices + 1;
+                num_value  = 2 * num_edges;
+                break;
+            case Op::VF:
+                num_offset = num_vertices + 1;
+                num_value  = 3 * num_faces;
+                break;
+            case Op::EF:
+                num_offset = num_edges + 1;
+                num_value  = 3 * num_faces;
+                break;
+            case Op::FF:
+                num_offset = num_faces + 1;
+                num_value  = 3 * num_faces;
+                break;
+            case Op::EV:
+                num_value = 2 * num_edges;
+                break;
+            case Op::FV:
+            case Op::FE:
+                num_value = 3 * num_faces;
+                break;
+            case Op::EE:
+            case Op::EVDiamond:
+                num_value = 4 * num_edges;
+                break;
+            default:
+                break;
+        }
+    }
+
+    // start of every patch output in m_offset and m_value (num_patches + 1)
+    uint32_t* m_offset_start;
+    uint32_t* m_value_start;
+
+    uint16_t* m_offset;
+    uint16_t* m_value;
+
+    // per-patch flag where non-zero indicates that the patch output is valid
+    uint8_t* m_valid;
+
+    uint32_t m_num_patches;
+    bool     m_oriented;
+};
+}  // namespace rxmesh
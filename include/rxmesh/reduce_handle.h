@@ -1,22 +1,123 @@
 #pragma once
 
+#include <algorithm>
+#include <new>
+#include <vector>
+
+#include <cub/device/device_segmented_reduce.cuh>
+
 #include "rxmesh/attribute.h"
+#include "rxmesh/attribute_expr.h"
 #include "rxmesh/kernels/attribute.cuh"
 
 #include "rxmesh/arg_ops.h"
 
 #include "rxmesh/rxmesh.h"
 
+#ifdef USE_MPI
+#include "rxmesh/util/mpi_util.h"
+#endif
+
 namespace rxmesh {
-namespace detail {
 
-}  // namespace detail
+/**
+ * @brief A batch of up to MaxSize dot products and L2 norms over attributes
+ * that are computed by ReduceHandle::batch_reduce() (or batch_reduce_async())
+ * in a single pass over the mesh and a single second stage, e.g., the dot
+ * products and norms of one CG or L-BFGS iteration. The batch is passed by
+ * value to the kernel and only holds shallow copies of the attributes
+ */
+template <typename T, typename HandleT, uint32_t MaxSize = 8>
+struct ReduceBatch
+{
+    using HandleType = HandleT;
+    using Type       = T;
+    using ComputeT   = compute_t<T>;
+    using AttributeT = Attribute<T, HandleT>;
+
+    static constexpr uint32_t max_size = MaxSize;
+
+    /**
+     * @brief add the dot product of attr1 and attr2 to the batch
+     * @return the index of this reduction in the output
+     */
+    uint32_t dot(const AttributeT& attr1,
+                 const AttributeT& attr2,
+                 uint32_t          attr_id = INVALID32)
+    {
+        return add(attr1, attr2, attr_id, false);
+    }
+
+    /**
+     * @brief add the L2 norm of attr to the batch
+     * @return the index of this reduction in the output
+     */
+    uint32_t norm2(const AttributeT& attr, uint32_t attr_id = INVALID32)
+    {
+        return add(attr, attr, attr_id, true);
+    }
+
+    /**
+     * @brief remove all reductions from the batch
+     */
+    void clear()
+    {
+        size = 0;
+    }
+
+    /**
+     * @brief the first/second attribute of the r-th reduction
+     */
+    __host__ __device__ __forceinline__ const AttributeT& x(uint32_t r) const
+    {
+        return *reinterpret_cast<const AttributeT*>(m_x[r].bytes);
+    }
+
+    __host__ __device__ __forceinline__ const AttributeT& y(uint32_t r) const
+    {
+        return *reinterpret_cast<const AttributeT*>(m_y[r].bytes);
+    }
+
+    // the attributes are stored as raw bytes such that the batch does not
+    // construct (or destroy) attributes
+    struct alignas(AttributeT) Storage
+    {
+        unsigned char bytes[sizeof(AttributeT)];
+    };
+
+    Storage  m_x[MaxSize];
+    Storage  m_y[MaxSize];
+    uint32_t attribute_id[MaxSize];
+    bool     is_norm2[MaxSize];
+    uint32_t size = 0;
+
+   private:
+    uint32_t add(const AttributeT& attr1,
+                 const AttributeT& attr2,
+                 uint32_t          attr_id,
+                 bool              norm)
+    {
+        if (size >= MaxSize) {
+            RXMESH_ERROR(
+                "ReduceBatch::add() the batch is full (max size = {})",
+                MaxSize);
+            return INVALID32;
+        }
+        new (m_x[size].bytes) AttributeT(attr1);
+        new (m_y[size].bytes) AttributeT(attr2);
+        attribute_id[size] = attr_id;
+        is_norm2[size]     = norm;
+        return size++;
+    }
+};
 
 /**
  * @brief This class is used to compute different reduction operations on
  * Attribute. To create a new ReduceHandle, use create_reduce_handle()
  * from Attribute
- * @tparam T The type of the attribute
+ * @tparam T The type of the attribute. Reductions on reduced-precision
+ * attributes (half and bfloat16) are accumulated and returned in float (see
+ * ComputeType)
  */
 template <typename T, typename HandleT>
 class ReduceHandle
@@ -25,7 +126,8 @@ class ReduceHandle
    public:
     using HandleType = HandleT;
     using Type       = T;
-    using KeyValue   = KeyValuePair<HandleT, T>;
+    using ComputeT   = compute_t<T>;
+    using KeyValue   = KeyValuePair<HandleT, ComputeT>;
 
     ReduceHandle()                    = default;
     ReduceHandle(const ReduceHandle&) = default;
@@ -57,15 +159,18 @@ class ReduceHandle
      */
     ReduceHandle(const uint32_t num_patches) : m_max_num_patches(num_patches)
     {
-        size_t type_size = std::max(sizeof(T), sizeof(KeyValue));
+        size_t type_size = std::max(sizeof(ComputeT), sizeof(KeyValue));
 
-        CUDA_ERROR(
-            cudaMalloc(&m_d_reduce_1st_stage, m_max_num_patches * type_size));
+        CUDA_ERROR(tracked_malloc(&m_d_reduce_1st_stage,
+                                  m_max_num_patches * type_size,
+                                  MemoryCategory::Other));
 
-        CUDA_ERROR(cudaMalloc(&m_d_reduce_2nd_stage, type_size));
+        CUDA_ERROR(tracked_malloc(&m_d_reduce_2nd_stage,
+                                  type_size,
+                                  MemoryCategory::Other));
 
-        T*     ptr_t        = NULL;
-        size_t temp_bytes_t = 0;
+        ComputeT* ptr_t        = NULL;
+        size_t    temp_bytes_t = 0;
         cub::DeviceReduce::Sum(ptr_t,
                                temp_bytes_t,
                                m_d_reduce_1st_stage,
@@ -80,15 +185,16 @@ class ReduceHandle
             reinterpret_cast<KeyValue*>(m_d_reduce_1st_stage),
             reinterpret_cast<KeyValue*>(m_d_reduce_2nd_stage),
             m_max_num_patches,
-            detail::ArgMaxOp<HandleT, T>(),
-            KeyValue(HandleT(), std::numeric_limits<T>::lowest()));
+            detail::ArgMaxOp<HandleT, ComputeT>(),
+            KeyValue(HandleT(), std::numeric_limits<ComputeT>::lowest()));
 
         m_d_reduce_temp_storage = NULL;
 
         m_reduce_temp_storage_bytes = std::max(temp_bytes_p, temp_bytes_t);
 
-        CUDA_ERROR(cudaMalloc((void**)&m_d_reduce_temp_storage,
-                              m_reduce_temp_storage_bytes));
+        CUDA_ERROR(tracked_malloc((void**)&m_d_reduce_temp_storage,
+                                  m_reduce_temp_storage_bytes,
+                                  MemoryCategory::Other));
     }
 
     ~ReduceHandle()
@@ -96,9 +202,76 @@ class ReduceHandle
         GPU_FREE(m_d_reduce_1st_stage);
         GPU_FREE(m_d_reduce_2nd_stage);
         GPU_FREE(m_d_reduce_temp_storage);
-        m_reduce_temp_storage_bytes = 0;
+        GPU_FREE(m_d_segmented_output);
+        GPU_FREE(m_d_segmented_temp_storage);
+        GPU_FREE(m_d_batch_1st_stage);
+        GPU_FREE(m_d_batch_output);
+        GPU_FREE(m_d_batch_offset);
+        GPU_FREE(m_d_label_output);
+        m_reduce_temp_storage_bytes    = 0;
+        m_segmented_temp_storage_bytes = 0;
+        m_max_num_segments             = 0;
+    }
+
+    /**
+     * @brief restrict dot(), norm2(), arg_max(), arg_min(), reduce() and
+     * their async variants to the mesh elements owned by a subset of patches
+     * e.g., the subset of RXMeshStatic::set_patch_subset() as returned by
+     * RXMeshStatic::get_patch_subset(). The first stage then launches one
+     * block per patch in the subset. The segmented, batched, per-label, and
+     * fused (evaluate_dot()) reductions still process all patches. The
+     * subset is not copied and should outlive its use by this handle
+     * @param d_patches device pointer to the patch ids
+     * @param num the number of patches in d_patches (at most the number of
+     * patches the handle was created with)
+     */
+    void set_patch_subset(const uint32_t* d_patches, const uint32_t num)
+    {
+        if (num > m_max_num_patches) {
+            RXMESH_ERROR(
+                "ReduceHandle::set_patch_subset() the subset size ({}) is "
+                "larger than the number of patches ({})",
+                num,
+                m_max_num_patches);
+            return;
+        }
+        m_d_patch_subset    = d_patches;
+        m_patch_subset_size = num;
+    }
+
+    /**
+     * @brief go back to reducing over all patches
+     */
+    void clear_patch_subset()
+    {
+        m_d_patch_subset    = nullptr;
+        m_patch_subset_size = 0;
     }
 
+#ifdef USE_MPI
+    /**
+     * @brief all-reduce the output of dot(), norm2(), and reduce() (with
+     * cub::Sum, cub::Max, or cub::Min) across the ranks of comm such that
+     * every rank gets the reduction over the whole distributed mesh. This
+     * is meant to be combined with set_patch_subset() where every rank
+     * reduces only over the patches it owns (see RXMeshDistributed). All
+     * ranks should call these reductions in the same order. The async,
+     * segmented, batched, and per-label reductions stay local
+     */
+    void set_communicator(MPI_Comm comm)
+    {
+        m_comm = comm;
+    }
+
+    /**
+     * @brief go back to local reductions
+     */
+    void clear_communicator()
+    {
+        m_comm = MPI_COMM_NULL;
+    }
+#endif
+
     /**
      * @brief compute dot product between two input attributes and return the
      * output on the host
@@ -109,10 +282,10 @@ class ReduceHandle
      * @param stream stream to run the computation on
      * @return the output of dot product on the host
      */
-    T dot(const Attribute<T, HandleT>& attr1,
-          const Attribute<T, HandleT>& attr2,
-          uint32_t                     attribute_id = INVALID32,
-          cudaStream_t                 stream       = NULL)
+    ComputeT dot(const Attribute<T, HandleT>& attr1,
+                 const Attribute<T, HandleT>& attr2,
+                 uint32_t                     attribute_id = INVALID32,
+                 cudaStream_t                 stream       = NULL)
     {
         if ((attr1.get_allocated() & DEVICE) != DEVICE ||
             (attr2.get_allocated() & DEVICE) != DEVICE) {
@@ -121,16 +294,20 @@ class ReduceHandle
                 "allocated on the device");
         }
 
-        detail::dot_kernel<T, attr1.m_block_size>
-            <<<m_max_num_patches, attr1.m_block_size, 0, stream>>>(
-                attr1,
-                attr2,
-                m_max_num_patches,
-                attr1.get_num_attributes(),
-                m_d_reduce_1st_stage,
-                attribute_id);
+        if (num_blocks() > 0) {
+            detail::dot_kernel<T, attr1.m_block_size>
+                <<<num_blocks(), attr1.m_block_size, 0, stream>>>(
+                    attr1,
+                    attr2,
+                    m_max_num_patches,
+                    attr1.get_num_attributes(),
+                    m_d_reduce_1st_stage,
+                    attribute_id,
+                    m_d_patch_subset);
+        }
 
-        return reduce_2nd_stage<T>(stream, cub::Sum(), 0);
+        return all_reduce(reduce_2nd_stage<ComputeT>(stream, cub::Sum(), 0),
+                          cub::Sum());
     }
 
     /**
@@ -142,9 +319,9 @@ class ReduceHandle
      * @param stream stream to run the computation on
      * @return the output of L2 norm on the host
      */
-    T norm2(const Attribute<T, HandleT>& attr,
-            uint32_t                     attribute_id = INVALID32,
-            cudaStream_t                 stream       = NULL)
+    ComputeT norm2(const Attribute<T, HandleT>& attr,
+                   uint32_t                     attribute_id = INVALID32,
+                   cudaStream_t                 stream       = NULL)
     {
         if ((attr.get_allocated() & DEVICE) != DEVICE) {
             RXMESH_ERROR(
@@ -153,15 +330,19 @@ class ReduceHandle
         }
 
 
-        detail::norm2_kernel<T, attr.m_block_size>
-            <<<m_max_num_patches, attr.m_block_size, 0, stream>>>(
-                attr,
-                m_max_num_patches,
-                attr.get_num_attributes(),
-                m_d_reduce_1st_stage,
-                attribute_id);
+        if (num_blocks() > 0) {
+            detail::norm2_kernel<T, attr.m_block_size>
+                <<<num_blocks(), attr.m_block_size, 0, stream>>>(
+                    attr,
+                    m_max_num_patches,
+                    attr.get_num_attributes(),
+                    m_d_reduce_1st_stage,
+                    attribute_id,
+                    m_d_patch_subset);
+        }
 
-        return std::sqrt(reduce_2nd_stage<T>(stream, cub::Sum(), 0));
+        return std::sqrt(all_reduce(
+            reduce_2nd_stage<ComputeT>(stream, cub::Sum(), 0), cub::Sum()));
     }
 
     /**
@@ -181,21 +362,24 @@ class ReduceHandle
                 "allocated on the device");
         }
 
-        detail::ArgMaxOp<HandleT, T> max_pair;
+        detail::ArgMaxOp<HandleT, ComputeT> max_pair;
 
-        detail::arg_minmax_kernel<T, attr.m_block_size, HandleT>
-            <<<m_max_num_patches, attr.m_block_size, 0, stream>>>(
-                attr,
-                attribute_id,
-                max_pair,
-                m_max_num_patches,
-                attr.get_num_attributes(),
-                reinterpret_cast<KeyValue*>(m_d_reduce_1st_stage));
+        if (num_blocks() > 0) {
+            detail::arg_minmax_kernel<T, attr.m_block_size, HandleT>
+                <<<num_blocks(), attr.m_block_size, 0, stream>>>(
+                    attr,
+                    attribute_id,
+                    max_pair,
+                    m_max_num_patches,
+                    attr.get_num_attributes(),
+                    reinterpret_cast<KeyValue*>(m_d_reduce_1st_stage),
+                    m_d_patch_subset);
+        }
 
         KeyValue init(HandleT(), max_pair.default_val());
 
         return reduce_2nd_stage<KeyValue>(
-            stream, detail::ArgMaxOp<HandleT, T>(), init);
+            stream, detail::ArgMaxOp<HandleT, ComputeT>(), init);
     }
 
 
@@ -216,21 +400,24 @@ class ReduceHandle
                 "allocated on the device");
         }
 
-        detail::ArgMinOp<HandleT, T> min_pair;
+        detail::ArgMinOp<HandleT, ComputeT> min_pair;
 
-        detail::arg_minmax_kernel<T, attr.m_block_size, HandleT>
-            <<<m_max_num_patches, attr.m_block_size, 0, stream>>>(
-                attr,
-                attribute_id,
-                min_pair,
-                m_max_num_patches,
-                attr.get_num_attributes(),
-                reinterpret_cast<KeyValue*>(m_d_reduce_1st_stage));
+        if (num_blocks() > 0) {
+            detail::arg_minmax_kernel<T, attr.m_block_size, HandleT>
+                <<<num_blocks(), attr.m_block_size, 0, stream>>>(
+                    attr,
+                    attribute_id,
+                    min_pair,
+                    m_max_num_patches,
+                    attr.get_num_attributes(),
+                    reinterpret_cast<KeyValue*>(m_d_reduce_1st_stage),
+                    m_d_patch_subset);
+        }
 
         KeyValue init(HandleT(), min_pair.default_val());
 
         return reduce_2nd_stage<KeyValue>(
-            stream, detail::ArgMinOp<HandleT, T>(), init);
+            stream, detail::ArgMinOp<HandleT, ComputeT>(), init);
     }
 
 
@@ -262,11 +449,11 @@ class ReduceHandle
      * @return the reduced output on the host
      */
     template <typename ReductionOp>
-    T reduce(const Attribute<T, HandleT>& attr,
-             ReductionOp                  reduction_op,
-             T                            init,
-             uint32_t                     attribute_id = INVALID32,
-             cudaStream_t                 stream       = NULL)
+    ComputeT reduce(const Attribute<T, HandleT>& attr,
+                    ReductionOp                  reduction_op,
+                    ComputeT                     init,
+                    uint32_t                     attribute_id = INVALID32,
+                    cudaStream_t                 stream       = NULL)
     {
         if ((attr.get_allocated() & DEVICE) != DEVICE) {
             RXMESH_ERROR(
@@ -275,6 +462,344 @@ class ReduceHandle
         }
 
 
+        if (num_blocks() > 0) {
+            detail::generic_reduce<T, attr.m_block_size>
+                <<<num_blocks(), attr.m_block_size, 0, stream>>>(
+                    attr,
+                    m_max_num_patches,
+                    attr.get_num_attributes(),
+                    m_d_reduce_1st_stage,
+                    reduction_op,
+                    init,
+                    attribute_id,
+                    m_d_patch_subset);
+        }
+
+        return all_reduce(
+            reduce_2nd_stage<ComputeT>(stream, reduction_op, init),
+            reduction_op);
+    }
+
+    /**
+     * @brief same as dot() but the output is left on the device and there is
+     * no host synchronization. This makes it possible to capture the
+     * reduction in a CUDA Graph (see CUDAGraph) and use its result in
+     * subsequent kernels or in device-side convergence checks
+     * @param attr1 first input attribute
+     * @param attr2 second input attribute
+     * @param d_output device pointer to write the output to. If nullptr, the
+     * output is written to an internal buffer that is valid until the next
+     * reduction done by this handle
+     * @param attribute_id specific attribute ID to compute its dot product.
+     * Default is INVALID32 which compute dot product for all attributes
+     * @param stream stream to run the computation on
+     * @return device pointer to the output
+     */
+    const ComputeT* dot_async(const Attribute<T, HandleT>& attr1,
+                              const Attribute<T, HandleT>& attr2,
+                              ComputeT*                    d_output = nullptr,
+                              uint32_t     attribute_id = INVALID32,
+                              cudaStream_t stream       = NULL)
+    {
+        if ((attr1.get_allocated() & DEVICE) != DEVICE ||
+            (attr2.get_allocated() & DEVICE) != DEVICE) {
+            RXMESH_ERROR(
+                "ReduceHandle::dot_async() input attributes to should be "
+                "allocated on the device");
+        }
+
+        if (num_blocks() > 0) {
+            detail::dot_kernel<T, attr1.m_block_size>
+                <<<num_blocks(), attr1.m_block_size, 0, stream>>>(
+                    attr1,
+                    attr2,
+                    m_max_num_patches,
+                    attr1.get_num_attributes(),
+                    m_d_reduce_1st_stage,
+                    attribute_id,
+                    m_d_patch_subset);
+        }
+
+        return reduce_2nd_stage_async<ComputeT>(
+            stream, cub::Sum(), 0, d_output, num_blocks());
+    }
+
+    /**
+     * @brief same as norm2() but the output is left on the device and there
+     * is no host synchronization (see dot_async())
+     * @param attr input attribute
+     * @param d_output device pointer to write the output to. If nullptr, the
+     * output is written to an internal buffer
+     * @param attribute_id specific attribute ID to compute its norm2. Default
+     * is INVALID32 which compute norm2 for all attributes
+     * @param stream stream to run the computation on
+     * @return device pointer to the output
+     */
+    const ComputeT* norm2_async(const Attribute<T, HandleT>& attr,
+                                ComputeT*    d_output     = nullptr,
+                                uint32_t     attribute_id = INVALID32,
+                                cudaStream_t stream       = NULL)
+    {
+        if ((attr.get_allocated() & DEVICE) != DEVICE) {
+            RXMESH_ERROR(
+                "ReduceHandle::norm2_async() input attribute to should be "
+                "allocated on the device");
+        }
+
+        if (num_blocks() > 0) {
+            detail::norm2_kernel<T, attr.m_block_size>
+                <<<num_blocks(), attr.m_block_size, 0, stream>>>(
+                    attr,
+                    m_max_num_patches,
+                    attr.get_num_attributes(),
+                    m_d_reduce_1st_stage,
+                    attribute_id,
+                    m_d_patch_subset);
+        }
+
+        ComputeT* out = reduce_2nd_stage_async<ComputeT>(
+            stream, cub::Sum(), 0, d_output, num_blocks());
+
+        detail::sqrt_in_place<<<1, 1, 0, stream>>>(out);
+
+        return out;
+    }
+
+    /**
+     * @brief same as reduce() but the output is left on the device and there
+     * is no host synchronization (see dot_async())
+     * @param attr input attribute
+     * @param reduction_op the binary reduction functor
+     * @param init initial value for reduction
+     * @param d_output device pointer to write the output to. If nullptr, the
+     * output is written to an internal buffer
+     * @param attribute_id specific attribute ID to compute its reduction.
+     * Default is INVALID32 which compute reduction for all attributes
+     * @param stream stream to run the computation on
+     * @return device pointer to the output
+     */
+    template <typename ReductionOp>
+    const ComputeT* reduce_async(const Attribute<T, HandleT>& attr,
+                                 ReductionOp                  reduction_op,
+                                 ComputeT                     init,
+                                 ComputeT*    d_output     = nullptr,
+                                 uint32_t     attribute_id = INVALID32,
+                                 cudaStream_t stream       = NULL)
+    {
+        if ((attr.get_allocated() & DEVICE) != DEVICE) {
+            RXMESH_ERROR(
+                "ReduceHandle::reduce_async() input attribute to should be "
+                "allocated on the device");
+        }
+
+        if (num_blocks() > 0) {
+            detail::generic_reduce<T, attr.m_block_size>
+                <<<num_blocks(), attr.m_block_size, 0, stream>>>(
+                    attr,
+                    m_max_num_patches,
+                    attr.get_num_attributes(),
+                    m_d_reduce_1st_stage,
+                    reduction_op,
+                    init,
+                    attribute_id,
+                    m_d_patch_subset);
+        }
+
+        return reduce_2nd_stage_async<ComputeT>(
+            stream, reduction_op, init, d_output, num_blocks());
+    }
+
+    /**
+     * @brief compute all the dot products and norms in a batch with a single
+     * first-stage kernel and a single second stage. There is no host
+     * synchronization. The r-th output is the result of the r-th reduction
+     * added to the batch
+     * @param batch the reductions to compute
+     * @param d_output device array (of at least batch.size) to write the
+     * output to. If nullptr, the output is written to an internal buffer that
+     * is valid until the next batched reduction done by this handle
+     * @param h_output optional host array (of at least batch.size) to which
+     * the output is copied asynchronously. Should be pinned memory for the
+     * copy to be asynchronous and is only valid after synchronizing the stream
+     * @param stream stream to run the computation on
+     * @return device pointer to the output
+     */
+    template <uint32_t MaxSize>
+    const ComputeT* batch_reduce_async(
+        const ReduceBatch<T, HandleT, MaxSize>& batch,
+        ComputeT*                               d_output = nullptr,
+        ComputeT*                               h_output = nullptr,
+        cudaStream_t                            stream   = NULL)
+    {
+        constexpr uint32_t blockSize = Attribute<T, HandleT>::m_block_size;
+
+        if (batch.size == 0) {
+            return d_output;
+        }
+
+        for (uint32_t r = 0; r < batch.size; ++r) {
+            if ((batch.x(r).get_allocated() & DEVICE) != DEVICE ||
+                (batch.y(r).get_allocated() & DEVICE) != DEVICE) {
+                RXMESH_ERROR(
+                    "ReduceHandle::batch_reduce_async() input attributes to "
+                    "should be allocated on the device");
+                return d_output;
+            }
+        }
+
+        grow_batch_buffers(MaxSize);
+
+        if (d_output == nullptr) {
+            d_output = m_d_batch_output;
+        }
+
+        detail::batched_dot_kernel<ReduceBatch<T, HandleT, MaxSize>, blockSize>
+            <<<m_max_num_patches, blockSize, 0, stream>>>(
+                batch, m_max_num_patches, m_d_batch_1st_stage);
+
+        size_t temp_bytes = 0;
+        cub::DeviceSegmentedReduce::Sum(NULL,
+                                        temp_bytes,
+                                        m_d_batch_1st_stage,
+                                        d_output,
+                                        batch.size,
+                                        m_d_batch_offset,
+                                        m_d_batch_offset + 1,
+                                        stream);
+
+        if (temp_bytes > m_segmented_temp_storage_bytes) {
+            GPU_FREE(m_d_segmented_temp_storage);
+            CUDA_ERROR(tracked_malloc((void**)&m_d_segmented_temp_storage,
+                                      temp_bytes,
+                                      MemoryCategory::Other));
+            m_segmented_temp_storage_bytes = temp_bytes;
+        }
+
+        cub::DeviceSegmentedReduce::Sum(m_d_segmented_temp_storage,
+                                        m_segmented_temp_storage_bytes,
+                                        m_d_batch_1st_stage,
+                                        d_output,
+                                        batch.size,
+                                        m_d_batch_offset,
+                                        m_d_batch_offset + 1,
+                                        stream);
+
+        detail::batched_finalize<<<1, MaxSize, 0, stream>>>(batch, d_output);
+
+        if (h_output != nullptr) {
+            CUDA_ERROR(cudaMemcpyAsync(h_output,
+                                       d_output,
+                                       batch.size * sizeof(ComputeT),
+                                       cudaMemcpyDeviceToHost,
+                                       stream));
+        }
+
+        return d_output;
+    }
+
+    /**
+     * @brief same as batch_reduce_async() but returns the output on the host
+     * with a single synchronization for the whole batch
+     */
+    template <uint32_t MaxSize>
+    std::vector<ComputeT> batch_reduce(
+        const ReduceBatch<T, HandleT, MaxSize>& batch,
+        cudaStream_t                            stream = NULL)
+    {
+        std::vector<ComputeT> h_output(batch.size);
+        if (batch.size == 0) {
+            return h_output;
+        }
+
+        const ComputeT* d_output =
+            batch_reduce_async(batch, nullptr, nullptr, stream);
+
+        CUDA_ERROR(cudaMemcpyAsync(h_output.data(),
+                                   d_output,
+                                   batch.size * sizeof(ComputeT),
+                                   cudaMemcpyDeviceToHost,
+                                   stream));
+        CUDA_ERROR(cudaStreamSynchronize(stream));
+
+        return h_output;
+    }
+
+    /**
+     * @brief compute dot product between two input attributes where the
+     * patches are divided into consecutive segments (e.g., the meshes of
+     * RXMeshBatch) and the dot product is computed for each segment. All
+     * segments are processed in a single launch
+     * @param attr1 first input attribute
+     * @param attr2 second input attribute
+     * @param d_segment_offset device array of the first patch of each segment
+     * (num_segments + 1)
+     * @param num_segments the number of segments
+     * @param attribute_id specific attribute ID to compute its dot product.
+     * Default is INVALID32 which compute dot product for all attributes
+     * @param stream stream to run the computation on
+     * @return the dot product of each segment on the host
+     */
+    std::vector<ComputeT> segmented_dot(
+        const Attribute<T, HandleT>& attr1,
+        const Attribute<T, HandleT>& attr2,
+        const uint32_t*              d_segment_offset,
+        const uint32_t               num_segments,
+        uint32_t                     attribute_id = INVALID32,
+        cudaStream_t                 stream       = NULL)
+    {
+        if ((attr1.get_allocated() & DEVICE) != DEVICE ||
+            (attr2.get_allocated() & DEVICE) != DEVICE) {
+            RXMESH_ERROR(
+                "ReduceHandle::segmented_dot() input attributes to should be "
+                "allocated on the device");
+        }
+
+        detail::dot_kernel<T, attr1.m_block_size>
+            <<<m_max_num_patches, attr1.m_block_size, 0, stream>>>(
+                attr1,
+                attr2,
+                m_max_num_patches,
+                attr1.get_num_attributes(),
+                m_d_reduce_1st_stage,
+                attribute_id);
+
+        return reduce_2nd_stage_segmented<ComputeT>(
+            stream, cub::Sum(), 0, d_segment_offset, num_segments);
+    }
+
+    /**
+     * @brief perform generic reduction operations on an input attribute where
+     * the patches are divided into consecutive segments (e.g., the meshes of
+     * RXMeshBatch) and the reduction is computed for each segment. All
+     * segments are processed in a single launch. See reduce() for the
+     * requirements on the reduction functor and the initial value
+     * @param attr input attribute
+     * @param reduction_op the binary reduction functor
+     * @param init initial value for reduction
+     * @param d_segment_offset device array of the first patch of each segment
+     * (num_segments + 1)
+     * @param num_segments the number of segments
+     * @param attribute_id specific attribute ID to compute its reduction.
+     * Default is INVALID32 which compute reduction for all attributes
+     * @param stream stream to run the computation on
+     * @return the reduced output of each segment on the host
+     */
+    template <typename ReductionOp>
+    std::vector<ComputeT> segmented_reduce(
+        const Attribute<T, HandleT>& attr,
+        ReductionOp                  reduction_op,
+        ComputeT                     init,
+        const uint32_t*              d_segment_offset,
+        const uint32_t               num_segments,
+        uint32_t                     attribute_id = INVALID32,
+        cudaStream_t                 stream       = NULL)
+    {
+        if ((attr.get_allocated() & DEVICE) != DEVICE) {
+            RXMESH_ERROR(
+                "ReduceHandle::segmented_reduce() input attribute to should "
+                "be allocated on the device");
+        }
+
         detail::generic_reduce<T, attr.m_block_size>
             <<<m_max_num_patches, attr.m_block_size, 0, stream>>>(
                 attr,
@@ -285,10 +810,413 @@ class ReduceHandle
                 init,
                 attribute_id);
 
-        return reduce_2nd_stage<T>(stream, reduction_op, init);
+        return reduce_2nd_stage_segmented<ComputeT>(
+            stream, reduction_op, init, d_segment_offset, num_segments);
+    }
+
+    /**
+     * @brief perform generic reduction operations on an input attribute per
+     * patch i.e., the output is the reduction of the owned elements of every
+     * patch (the first stage of reduce()). There is no host synchronization
+     * @param attr input attribute
+     * @param reduction_op the binary reduction functor (see reduce())
+     * @param init initial value for reduction
+     * @param d_output device array of at least the number of patches to write
+     * the output to. If nullptr, the output is written to an internal buffer
+     * that is valid until the next reduction done by this handle
+     * @param attribute_id specific attribute ID to compute its reduction.
+     * Default is INVALID32 which compute reduction for all attributes
+     * @param stream stream to run the computation on
+     * @return device pointer to the output
+     */
+    template <typename ReductionOp>
+    const ComputeT* per_patch_reduce_async(
+        const Attribute<T, HandleT>& attr,
+        ReductionOp                  reduction_op,
+        ComputeT                     init,
+        ComputeT*                    d_output     = nullptr,
+        uint32_t                     attribute_id = INVALID32,
+        cudaStream_t                 stream       = NULL)
+    {
+        if ((attr.get_allocated() & DEVICE) != DEVICE) {
+            RXMESH_ERROR(
+                "ReduceHandle::per_patch_reduce_async() input attribute to "
+                "should be allocated on the device");
+        }
+
+        if (d_output == nullptr) {
+            d_output = m_d_reduce_1st_stage;
+        }
+
+        detail::generic_reduce<T, attr.m_block_size>
+            <<<m_max_num_patches, attr.m_block_size, 0, stream>>>(
+                attr,
+                m_max_num_patches,
+                attr.get_num_attributes(),
+                d_output,
+                reduction_op,
+                init,
+                attribute_id);
+
+        return d_output;
+    }
+
+    /**
+     * @brief sum an input attribute per label where labels is an attribute on
+     * the same mesh elements that gives the label of every element in [0,
+     * num_labels) e.g., a material ID or a connected component ID. Elements
+     * with label >= num_labels are skipped. Each patch accumulates its partial
+     * sums in shared memory (when they fit) before adding them to the output.
+     * There is no host synchronization
+     * @param attr input attribute
+     * @param labels the label of every mesh element
+     * @param num_labels the number of labels
+     * @param d_sum device array of num_labels to write the sum of every label
+     * @param d_count optional device array of num_labels to write the number
+     * of mesh elements of every label
+     * @param attribute_id specific attribute ID to sum. Default is INVALID32
+     * which sums all attributes
+     * @param stream stream to run the computation on
+     */
+    void label_sum_async(const Attribute<T, HandleT>&        attr,
+                         const Attribute<uint32_t, HandleT>& labels,
+                         const uint32_t                      num_labels,
+                         ComputeT*                           d_sum,
+                         uint32_t*                           d_count = nullptr,
+                         uint32_t     attribute_id = INVALID32,
+                         cudaStream_t stream       = NULL)
+    {
+        if ((attr.get_allocated() & DEVICE) != DEVICE ||
+            (labels.get_allocated() & DEVICE) != DEVICE) {
+            RXMESH_ERROR(
+                "ReduceHandle::label_sum_async() input attributes to should "
+                "be allocated on the device");
+            return;
+        }
+
+        if (num_labels == 0) {
+            return;
+        }
+
+        CUDA_ERROR(
+            cudaMemsetAsync(d_sum, 0, num_labels * sizeof(ComputeT), stream));
+        if (d_count != nullptr) {
+            CUDA_ERROR(cudaMemsetAsync(
+                d_count, 0, num_labels * sizeof(uint32_t), stream));
+        }
+
+        const size_t smem =
+            num_labels *
+            (sizeof(ComputeT) + ((d_count != nullptr) ? sizeof(uint32_t) : 0));
+
+        // otherwise, accumulate directly in global memory
+        const bool use_shmem = smem <= m_max_label_shmem_bytes;
+
+        detail::label_sum_kernel<T, attr.m_block_size>
+            <<<m_max_num_patches,
+               attr.m_block_size,
+               use_shmem ? smem : 0,
+               stream>>>(attr,
+                         labels,
+                         m_max_num_patches,
+                         attr.get_num_attributes(),
+                         attribute_id,
+                         num_labels,
+                         use_shmem,
+                         d_sum,
+                         d_count);
+    }
+
+    /**
+     * @brief same as label_sum_async() but the sum of every label is returned
+     * on the host
+     */
+    std::vector<ComputeT> label_sum(
+        const Attribute<T, HandleT>&        attr,
+        const Attribute<uint32_t, HandleT>& labels,
+        const uint32_t                      num_labels,
+        uint32_t                            attribute_id = INVALID32,
+        cudaStream_t                        stream       = NULL)
+    {
+        std::vector<ComputeT> h_sum(num_labels);
+        if (num_labels == 0) {
+            return h_sum;
+        }
+
+        if (num_labels > m_max_num_labels) {
+            GPU_FREE(m_d_label_output);
+            CUDA_ERROR(tracked_malloc((void**)&m_d_label_output,
+                                      num_labels * sizeof(ComputeT),
+                                      MemoryCategory::Other));
+            m_max_num_labels = num_labels;
+        }
+
+        label_sum_async(attr,
+                        labels,
+                        num_labels,
+                        m_d_label_output,
+                        nullptr,
+                        attribute_id,
+                        stream);
+
+        CUDA_ERROR(cudaMemcpyAsync(h_sum.data(),
+                                   m_d_label_output,
+                                   num_labels * sizeof(ComputeT),
+                                   cudaMemcpyDeviceToHost,
+                                   stream));
+        CUDA_ERROR(cudaStreamSynchronize(stream));
+
+        return h_sum;
+    }
+
+    /**
+     * @brief evaluate the assignments (see assign() in attribute_expr.h) and
+     * compute the dot product of the lhs and rhs expressions in the same
+     * kernel. The dot product is evaluated per element after all assignments
+     * are applied to it, so it sees the updated values e.g., the CG residual
+     * update and its squared norm
+     *      evaluate_dot_async(expr(r), expr(r), d_delta, stream,
+     *                         assign(r, expr(r) - alpha * expr(s)));
+     * The output is left on the device and there is no host synchronization
+     * (see dot_async())
+     * @param lhs, rhs expressions to compute their dot product
+     * @param d_output device pointer to write the output to. If nullptr, the
+     * output is written to an internal buffer
+     * @param stream stream to run the computation on
+     * @param first, rest the assignments to evaluate
+     * @return device pointer to the output
+     */
+    template <typename LhsT, typename RhsT, typename FirstT, typename... RestT>
+    const ComputeT* evaluate_dot_async(const LhsT&   lhs,
+                                       const RhsT&   rhs,
+                                       ComputeT*     d_output,
+                                       cudaStream_t  stream,
+                                       const FirstT& first,
+                                       const RestT&... rest)
+    {
+        constexpr uint32_t blockThreads = 256;
+
+        detail::check_assign(first, rest...);
+
+        auto l = detail::as_expr(lhs);
+        auto r = detail::as_expr(rhs);
+
+        const uint32_t num_attr =
+            std::max(l.num_attributes(), r.num_attributes());
+        if (num_attr == 0) {
+            RXMESH_ERROR(
+                "ReduceHandle::evaluate_dot_async() at least one of the dot "
+                "product operands should contain an attribute");
+        }
+
+        detail::fused_assign_kernel<blockThreads, true, ComputeT>
+            <<<m_max_num_patches, blockThreads, 0, stream>>>(
+                m_max_num_patches,
+                num_attr,
+                l,
+                r,
+                m_d_reduce_1st_stage,
+                first,
+                rest...);
+
+        return reduce_2nd_stage_async<ComputeT>(
+            stream, cub::Sum(), 0, d_output, m_max_num_patches);
+    }
+
+    /**
+     * @brief same as evaluate_dot_async() but the dot product is returned on
+     * the host
+     */
+    template <typename LhsT, typename RhsT, typename FirstT, typename... RestT>
+    ComputeT evaluate_dot(const LhsT&   lhs,
+                          const RhsT&   rhs,
+                          cudaStream_t  stream,
+                          const FirstT& first,
+                          const RestT&... rest)
+    {
+        const ComputeT* d_output =
+            evaluate_dot_async(lhs, rhs, nullptr, stream, first, rest...);
+
+        ComputeT h_output;
+        CUDA_ERROR(cudaMemcpyAsync(&h_output,
+                                   d_output,
+                                   sizeof(ComputeT),
+                                   cudaMemcpyDeviceToHost,
+                                   stream));
+        CUDA_ERROR(cudaStreamSynchronize(stream));
+
+        return h_output;
     }
 
    private:
+    /**
+     * @brief make sure the batched reduction buffers fit max_size reductions
+     */
+    void grow_batch_buffers(const uint32_t max_size)
+    {
+        if (max_size <= m_max_batch_size) {
+            return;
+        }
+        GPU_FREE(m_d_batch_1st_stage);
+        GPU_FREE(m_d_batch_output);
+        GPU_FREE(m_d_batch_offset);
+
+        CUDA_ERROR(
+            tracked_malloc((void**)&m_d_batch_1st_stage,
+                           max_size * m_max_num_patches * sizeof(ComputeT),
+                           MemoryCategory::Other));
+        CUDA_ERROR(tracked_malloc((void**)&m_d_batch_output,
+                                  max_size * sizeof(ComputeT),
+                                  MemoryCategory::Other));
+        CUDA_ERROR(tracked_malloc((void**)&m_d_batch_offset,
+                                  (max_size + 1) * sizeof(uint32_t),
+                                  MemoryCategory::Other));
+
+        std::vector<uint32_t> offset(max_size + 1);
+        for (uint32_t r = 0; r <= max_size; ++r) {
+            offset[r] = r * m_max_num_patches;
+        }
+        CUDA_ERROR(cudaMemcpy(m_d_batch_offset,
+                              offset.data(),
+                              offset.size() * sizeof(uint32_t),
+                              cudaMemcpyHostToDevice));
+
+        m_max_batch_size = max_size;
+    }
+
+    template <typename U, typename ReductionOp>
+    std::vector<U> reduce_2nd_stage_segmented(cudaStream_t    stream,
+                                              ReductionOp     reduction_op,
+                                              U               init,
+                                              const uint32_t* d_segment_offset,
+                                              const uint32_t  num_segments)
+    {
+        std::vector<U> h_output(num_segments);
+        if (num_segments == 0) {
+            return h_output;
+        }
+
+        // the temp storage and the output are grown on demand and reused
+        if (num_segments > m_max_num_segments) {
+            GPU_FREE(m_d_segmented_output);
+            CUDA_ERROR(tracked_malloc((void**)&m_d_segmented_output,
+                                      num_segments * sizeof(U),
+                                      MemoryCategory::Other));
+            m_max_num_segments = num_segments;
+        }
+
+        size_t temp_bytes = 0;
+        cub::DeviceSegmentedReduce::Reduce(
+            NULL,
+            temp_bytes,
+            reinterpret_cast<U*>(m_d_reduce_1st_stage),
+            reinterpret_cast<U*>(m_d_segmented_output),
+            num_segments,
+            d_segment_offset,
+            d_segment_offset + 1,
+            reduction_op,
+            init,
+            stream);
+
+        if (temp_bytes > m_segmented_temp_storage_bytes) {
+            GPU_FREE(m_d_segmented_temp_storage);
+            CUDA_ERROR(tracked_malloc((void**)&m_d_segmented_temp_storage,
+                                      temp_bytes,
+                                      MemoryCategory::Other));
+            m_segmented_temp_storage_bytes = temp_bytes;
+        }
+
+        cub::DeviceSegmentedReduce::Reduce(
+            m_d_segmented_temp_storage,
+            m_segmented_temp_storage_bytes,
+            reinterpret_cast<U*>(m_d_reduce_1st_stage),
+            reinterpret_cast<U*>(m_d_segmented_output),
+            num_segments,
+            d_segment_offset,
+            d_segment_offset + 1,
+            reduction_op,
+            init,
+            stream);
+
+        CUDA_ERROR(cudaMemcpyAsync(h_output.data(),
+                                   m_d_segmented_output,
+                                   num_segments * sizeof(U),
+                                   cudaMemcpyDeviceToHost,
+                                   stream));
+        CUDA_ERROR(cudaStreamSynchronize(stream));
+
+        return h_output;
+    }
+
+    /**
+     * @brief the number of blocks of the first stage of the reductions that
+     * support the patch subset i.e., one block per patch in the subset (see
+     * set_patch_subset())
+     */
+    uint32_t num_blocks() const
+    {
+        return (m_d_patch_subset == nullptr) ? m_max_num_patches :
+                                               m_patch_subset_size;
+    }
+
+    template <typename U, typename ReductionOp>
+    U* reduce_2nd_stage_async(cudaStream_t   stream,
+                              ReductionOp    reduction_op,
+                              U              init,
+                              U*             d_output,
+                              const uint32_t num_items)
+    {
+        if (d_output == nullptr) {
+            d_output = reinterpret_cast<U*>(m_d_reduce_2nd_stage);
+        }
+
+        cub::DeviceReduce::Reduce(m_d_reduce_temp_storage,
+                                  m_reduce_temp_storage_bytes,
+                                  reinterpret_cast<U*>(m_d_reduce_1st_stage),
+                                  d_output,
+                                  num_items,
+                                  reduction_op,
+                                  init,
+                                  stream);
+        return d_output;
+    }
+
+    /**
+     * @brief combine the local output of a reduction across the ranks (see
+     * set_communicator()). Without a communicator, this returns the input
+     */
+    template <typename ReductionOp>
+    ComputeT all_reduce(ComputeT local, ReductionOp reduction_op)
+    {
+#ifdef USE_MPI
+        if (m_comm == MPI_COMM_NULL) {
+            return local;
+        }
+
+        MPI_Op op;
+        if constexpr (std::is_same_v<ReductionOp, cub::Sum>) {
+            op = MPI_SUM;
+        } else if constexpr (std::is_same_v<ReductionOp, cub::Max>) {
+            op = MPI_MAX;
+        } else if constexpr (std::is_same_v<ReductionOp, cub::Min>) {
+            op = MPI_MIN;
+        } else {
+            RXMESH_ERROR(
+                "ReduceHandle::all_reduce() only cub::Sum, cub::Max, and "
+                "cub::Min can be reduced across ranks. Returning the local "
+                "reduction");
+            return local;
+        }
+
+        ComputeT global;
+        MPI_ERROR(MPI_Allreduce(
+            &local, &global, 1, mpi_datatype<ComputeT>(), op, m_comm));
+        return global;
+#else
+        return local;
+#endif
+    }
+
     template <typename U, typename ReductionOp>
     U reduce_2nd_stage(cudaStream_t stream, ReductionOp reduction_op, U init)
     {
@@ -299,7 +1227,7 @@ class ReduceHandle
                                   m_reduce_temp_storage_bytes,
                                   reinterpret_cast<U*>(m_d_reduce_1st_stage),
                                   reinterpret_cast<U*>(m_d_reduce_2nd_stage),
-                                  m_max_num_patches,
+                                  num_blocks(),
                                   reduction_op,
                                   init,
                                   stream);
@@ -314,11 +1242,38 @@ class ReduceHandle
         return h_output;
     }
 
-    size_t   m_reduce_temp_storage_bytes;
-    T*       m_d_reduce_1st_stage;
-    T*       m_d_reduce_2nd_stage;
-    void*    m_d_reduce_temp_storage;
-    uint32_t m_max_num_patches;
+    size_t    m_reduce_temp_storage_bytes;
+    ComputeT* m_d_reduce_1st_stage;
+    ComputeT* m_d_reduce_2nd_stage;
+    void*     m_d_reduce_temp_storage;
+    uint32_t  m_max_num_patches;
+
+    // the patches to reduce over (see set_patch_subset())
+    const uint32_t* m_d_patch_subset    = nullptr;
+    uint32_t        m_patch_subset_size = 0;
+
+    // used only by the segmented reductions
+    size_t   m_segmented_temp_storage_bytes = 0;
+    void*    m_d_segmented_temp_storage     = nullptr;
+    void*    m_d_segmented_output           = nullptr;
+    uint32_t m_max_num_segments             = 0;
+
+    // used only by the batched reductions
+    ComputeT* m_d_batch_1st_stage = nullptr;
+    ComputeT* m_d_batch_output    = nullptr;
+    uint32_t* m_d_batch_offset    = nullptr;
+    uint32_t  m_max_batch_size    = 0;
+
+    // used only by the per-label reductions
+    ComputeT* m_d_label_output = nullptr;
+
+#ifdef USE_MPI
+    // the ranks to all-reduce across (see set_communicator())
+    MPI_Comm m_comm = MPI_COMM_NULL;
+#endif
+    uint32_t  m_max_num_labels = 0;
+
+    static constexpr size_t m_max_label_shmem_bytes = 32 * 1024;
 };
 
 template <class T>
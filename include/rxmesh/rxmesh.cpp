@@ -1,5 +1,6 @@
 #include <assert.h>
 #include <omp.h>
+#include <algorithm>
 #include <filesystem>
 #include <iostream>
 #include <memory>
@@ -12,6 +13,8 @@
 #include "rxmesh/patch_scheduler.cuh"
 #include "rxmesh/rxmesh.h"
 #include "rxmesh/util/bitmask_util.h"
+#include "rxmesh/util/mesh_cache.h"
+#include "rxmesh/util/out_of_core.h"
 #include "rxmesh/util/util.h"
 
 namespace rxmesh {
@@ -44,12 +47,15 @@ RXMesh::RXMesh(uint32_t patch_size, bool use_metis)
       m_d_face_prefix(nullptr),
       m_d_patches_info(nullptr),
       m_h_patches_info(nullptr),
+      m_h_d_patches_info(nullptr),
       m_capacity_factor(0.f),
       m_lp_hashtable_load_factor(0.f),
+      m_lp_bucket_size(1),
       m_patch_alloc_factor(0.f),
       m_topo_memory_mega_bytes(0.0),
       m_num_colors(0),
-      _use_metis(use_metis)
+      _use_metis(use_metis),
+      m_memory_pool(std::make_unique<MemoryPool>())
 {
 }
 
@@ -59,16 +65,91 @@ void RXMesh::init(const std::vector<std::vector<uint32_t>>& fv,
                   const float                               patch_alloc_factor,
                   const float lp_hashtable_load_factor)
 {
-    m_topo_memory_mega_bytes   = 0;
-    m_capacity_factor          = capacity_factor;
-    m_lp_hashtable_load_factor = lp_hashtable_load_factor;
-    m_patch_alloc_factor       = patch_alloc_factor;
+    std::vector<uint32_t> flat_fv(3 * fv.size());
+
+    for (uint32_t f = 0; f < fv.size(); ++f) {
+        if (fv[f].size() != 3) {
+            RXMESH_ERROR(
+                "RXMesh::init() Face {} is not triangle. Non-triangular faces "
+                "are not supported",
+                f);
+            exit(EXIT_FAILURE);
+        }
+        for (uint32_t v = 0; v < 3; ++v) {
+            flat_fv[3 * f + v] = fv[f][v];
+        }
+    }
+
+    init(flat_fv.data(),
+         static_cast<uint32_t>(fv.size()),
+         patcher_file,
+         capacity_factor,
+         patch_alloc_factor,
+         lp_hashtable_load_factor);
+}
 
+void RXMesh::init(const uint32_t*   fv,
+                  const uint32_t    num_faces,
+                  const std::string patcher_file,
+                  const float       capacity_factor,
+                  const float       patch_alloc_factor,
+                  const float       lp_hashtable_load_factor)
+{
     // Build everything from scratch including patches
-    if (fv.empty()) {
+    if (fv == nullptr || num_faces == 0) {
         RXMESH_ERROR(
             "RXMesh::init input fv is empty. Can not build RXMesh properly");
+        exit(EXIT_FAILURE);
+    }
+
+    init_factors(capacity_factor, patch_alloc_factor, lp_hashtable_load_factor);
+
+    // 1)
+    m_timers.add("build");
+    m_timers.start("build");
+    build(fv, num_faces, patcher_file);
+    m_timers.stop("build");
+
+    finalize_init();
+}
+
+bool RXMesh::init_from_cache(const std::string&  cache_file,
+                             std::vector<float>& vertices,
+                             const float         capacity_factor,
+                             const float         patch_alloc_factor,
+                             const float         lp_hashtable_load_factor)
+{
+    if (!std::filesystem::exists(cache_file)) {
+        return false;
+    }
+
+    init_factors(capacity_factor, patch_alloc_factor, lp_hashtable_load_factor);
+
+    // 1)
+    m_timers.add("build");
+    m_timers.start("build");
+    if (!load_cache(cache_file, vertices)) {
+        m_timers.stop("build");
+        return false;
     }
+    m_timers.stop("build");
+
+    RXMESH_INFO("RXMesh::init_from_cache() loaded {}", cache_file);
+
+    finalize_init();
+
+    return true;
+}
+
+void RXMesh::init_factors(const float capacity_factor,
+                          const float patch_alloc_factor,
+                          const float lp_hashtable_load_factor)
+{
+    m_topo_memory_mega_bytes   = 0;
+    m_capacity_factor          = capacity_factor;
+    m_lp_hashtable_load_factor = lp_hashtable_load_factor;
+    m_patch_alloc_factor       = patch_alloc_factor;
+
     if (m_capacity_factor < 1.0) {
         RXMESH_ERROR("RXMesh::init capacity factor should be at least one");
     }
@@ -91,13 +172,10 @@ void RXMesh::init(const std::vector<std::vector<uint32_t>>& fv,
     m_timers.add("hashtable.move");
     m_timers.add("cudaMemcpy");
     m_timers.add("bitmask.cudaMemcpy");
+}
 
-    // 1)
-    m_timers.add("build");
-    m_timers.start("build");
-    build(fv, patcher_file);
-    m_timers.stop("build");
-
+void RXMesh::finalize_init()
+{
     // 2)
     m_timers.add("populate_patch_stash");
     m_timers.start("populate_patch_stash");
@@ -124,7 +202,7 @@ void RXMesh::init(const std::vector<std::vector<uint32_t>>& fv,
     PatchScheduler sch;
     sch.init(get_max_num_patches());
     m_topo_memory_mega_bytes +=
-        BYTES_TO_MEGABYTES(sizeof(uint32_t) * get_max_num_patches());
+        BYTES_TO_MEGABYTES(3 * sizeof(uint32_t) * get_max_num_patches());
     sch.refill(get_num_patches());
     m_timers.stop("PatchScheduler");
 
@@ -136,6 +214,15 @@ void RXMesh::init(const std::vector<std::vector<uint32_t>>& fv,
     allocate_extra_patches();
     m_timers.stop("allocate_extra_patches");
 
+#ifdef USE_OUT_OF_CORE
+    m_h_d_patches_info =
+        (PatchInfo*)malloc(get_max_num_patches() * sizeof(PatchInfo));
+    CUDA_ERROR(cudaMemcpy(m_h_d_patches_info,
+                          m_d_patches_info,
+                          get_max_num_patches() * sizeof(PatchInfo),
+                          cudaMemcpyDeviceToHost));
+#endif
+
     // 7)
     m_timers.add("context.init");
     m_timers.start("context.init");
@@ -261,6 +348,7 @@ RXMesh::~RXMesh()
     }
     GPU_FREE(m_d_patches_info);
     free(m_h_patches_info);
+    free(m_h_d_patches_info);
     m_rxmesh_context.release();
 
     GPU_FREE(m_d_vertex_prefix);
@@ -272,21 +360,43 @@ RXMesh::~RXMesh()
     free(m_h_face_prefix);
 }
 
-void RXMesh::build(const std::vector<std::vector<uint32_t>>& fv,
-                   const std::string                         patcher_file)
+void RXMesh::build(const uint32_t*   fv,
+                   const uint32_t    num_faces,
+                   const std::string patcher_file)
 {
-    std::vector<uint32_t>              ff_values;
-    std::vector<uint32_t>              ff_offset;
-    std::vector<std::vector<uint32_t>> ef;
-    std::vector<std::vector<uint32_t>> ev;
+    std::vector<uint32_t> ff_values;
+    std::vector<uint32_t> ff_offset;
+    std::vector<uint32_t> ef_values;
+    std::vector<uint32_t> ef_offset;
+    std::vector<uint32_t> ev;
+    std::vector<uint32_t> fe;
 
     m_max_capacity_lp_v = 0;
     m_max_capacity_lp_e = 0;
     m_max_capacity_lp_f = 0;
 
-    build_supporting_structures(fv, ev, ef, ff_offset, ff_values);
+    build_supporting_structures(
+        fv, num_faces, ev, fe, ef_offset, ef_values, ff_offset, ff_values);
+
+    // ef_values is only needed to build ff
+    std::vector<uint32_t>().swap(ef_values);
+
+#ifndef USE_DEVICE_BUILD
+    // fe is only needed to build the topology on the device
+    std::vector<uint32_t>().swap(fe);
+#endif
 
-    if (!patcher_file.empty()) {
+    if (!m_prev_face_patch.empty()) {
+        m_patcher = std::make_unique<patcher::Patcher>(m_patch_size,
+                                                       m_prev_face_patch,
+                                                       ff_offset,
+                                                       ff_values,
+                                                       fv,
+                                                       m_edges_map,
+                                                       m_num_vertices,
+                                                       m_num_edges);
+        std::vector<uint32_t>().swap(m_prev_face_patch);
+    } else if (!patcher_file.empty()) {
         if (!std::filesystem::exists(patcher_file)) {
             RXMESH_ERROR(
                 "RXMesh::build patch file {} does not exit. Building unique "
@@ -299,7 +409,8 @@ void RXMesh::build(const std::vector<std::vector<uint32_t>>& fv,
                                                            m_edges_map,
                                                            m_num_vertices,
                                                            m_num_edges,
-                                                           _use_metis);
+                                                           _use_metis,
+                                                           m_patcher_budget);
         } else {
             m_patcher = std::make_unique<patcher::Patcher>(patcher_file);
         }
@@ -311,9 +422,13 @@ void RXMesh::build(const std::vector<std::vector<uint32_t>>& fv,
                                                        m_edges_map,
                                                        m_num_vertices,
                                                        m_num_edges,
-                                                       _use_metis);
+                                                       _use_metis,
+                                                       m_patcher_budget);
     }
 
+    if (!m_face_group_offset.empty()) {
+        m_patcher->group_patches(m_face_group_offset, m_group_patch_offset);
+    }
 
     m_num_patches     = m_patcher->get_num_patches();
     m_max_num_patches = static_cast<uint32_t>(
@@ -333,6 +448,25 @@ void RXMesh::build(const std::vector<std::vector<uint32_t>>& fv,
         build_single_patch_ltog(fv, ev, p);
     }
 
+    calc_patch_capacities();
+
+#ifdef USE_DEVICE_BUILD
+    upload_build_data(fv, fe, ev);
+    std::vector<uint32_t>().swap(fe);
+#else
+#pragma omp parallel for
+    for (int p = 0; p < static_cast<int>(get_num_patches()); ++p) {
+        build_single_patch_topology(fv, p);
+    }
+#endif
+
+    build_element_prefix();
+
+    calc_input_statistics(fv, ef_offset);
+}
+
+void RXMesh::calc_patch_capacities()
+{
     // calc max elements for use in build_device (which populates
     // m_h_patches_info and thus we can not use calc_max_elements now)
     m_max_vertices_per_patch = 0;
@@ -359,11 +493,23 @@ void RXMesh::build(const std::vector<std::vector<uint32_t>>& fv,
     m_max_face_capacity = static_cast<uint16_t>(std::ceil(
         m_capacity_factor * static_cast<float>(m_max_faces_per_patch)));
 
-#pragma omp parallel for
-    for (int p = 0; p < static_cast<int>(get_num_patches()); ++p) {
-        build_single_patch_topology(fv, p);
+    // the local index in the owner patch is stored in LIDOwnerNumBits bits
+    const uint32_t max_cap = std::max(
+        {m_max_vertex_capacity, m_max_edge_capacity, m_max_face_capacity});
+    if (max_cap > (1u << LPPair::LIDOwnerNumBits)) {
+        RXMESH_ERROR(
+            "RXMesh::calc_patch_capacities() the patch capacity ({}) exceeds "
+            "{} elements supported with {} patch stash bits. Use smaller "
+            "patches, a smaller capacity factor, or fewer "
+            "RX_PATCH_STASH_NUM_BITS",
+            max_cap,
+            1u << LPPair::LIDOwnerNumBits,
+            LPPair::PatchStashNumBits);
     }
+}
 
+void RXMesh::build_element_prefix()
+{
     const uint32_t patches_1_bytes =
         (get_max_num_patches() + 1) * sizeof(uint32_t);
 
@@ -412,11 +558,17 @@ void RXMesh::build(const std::vector<std::vector<uint32_t>>& fv,
     }
 
     m_timers.start("cudaMalloc");
-    CUDA_ERROR(cudaMalloc((void**)&m_d_vertex_prefix, patches_1_bytes));
+    CUDA_ERROR(tracked_malloc((void**)&m_d_vertex_prefix,
+                              patches_1_bytes,
+                              MemoryCategory::Topology));
     // m_topo_memory_mega_bytes += BYTES_TO_MEGABYTES(patches_1_bytes);
-    CUDA_ERROR(cudaMalloc((void**)&m_d_edge_prefix, patches_1_bytes));
+    CUDA_ERROR(tracked_malloc((void**)&m_d_edge_prefix,
+                              patches_1_bytes,
+                              MemoryCategory::Topology));
     // m_topo_memory_mega_bytes += BYTES_TO_MEGABYTES(patches_1_bytes);
-    CUDA_ERROR(cudaMalloc((void**)&m_d_face_prefix, patches_1_bytes));
+    CUDA_ERROR(tracked_malloc((void**)&m_d_face_prefix,
+                              patches_1_bytes,
+                              MemoryCategory::Topology));
     // m_topo_memory_mega_bytes += BYTES_TO_MEGABYTES(patches_1_bytes);
     m_timers.stop("cudaMalloc");
 
@@ -433,72 +585,143 @@ void RXMesh::build(const std::vector<std::vector<uint32_t>>& fv,
                           m_h_face_prefix,
                           patches_1_bytes,
                           cudaMemcpyHostToDevice));
-
-    calc_input_statistics(fv, ef);
 }
 
-void RXMesh::build_supporting_structures(
-    const std::vector<std::vector<uint32_t>>& fv,
-    std::vector<std::vector<uint32_t>>&       ev,
-    std::vector<std::vector<uint32_t>>&       ef,
-    std::vector<uint32_t>&                    ff_offset,
-    std::vector<uint32_t>&                    ff_values)
+void RXMesh::build_supporting_structures(const uint32_t*        fv,
+                                         const uint32_t         num_faces,
+                                         std::vector<uint32_t>& ev,
+                                         std::vector<uint32_t>& fe,
+                                         std::vector<uint32_t>& ef_offset,
+                                         std::vector<uint32_t>& ef_values,
+                                         std::vector<uint32_t>& ff_offset,
+                                         std::vector<uint32_t>& ff_values)
 {
-    m_num_faces    = static_cast<uint32_t>(fv.size());
+    m_num_faces    = num_faces;
     m_num_vertices = 0;
     m_num_edges    = 0;
     m_edges_map.clear();
 
-    // assuming manifold mesh i.e., #E = 1.5#F
-    ef.clear();
-    uint32_t reserve_size =
-        static_cast<size_t>(1.5f * static_cast<float>(m_num_faces));
-    ef.reserve(reserve_size);
-    m_edges_map.reserve(reserve_size);
-    ev.reserve(2 * reserve_size);
+    const uint32_t num_sides = 3 * m_num_faces;
+
+    // group the face sides by their edge key (max, min) without a hash map.
+    // Sides are first bucketed by the max vertex using a counting sort (which
+    // keeps the sides in fv order within each bucket) and then every bucket,
+    // which is as small as the vertex valence, is sorted by the min vertex.
+    // Ties are broken by the side index so that the first side in each run of
+    // equal keys is where the edge first appears in fv. This gives the same
+    // edge numbering as a sequential pass over the faces
+    struct SideKey
+    {
+        uint32_t second;
+        uint32_t side;
+        bool     operator<(const SideKey& other) const
+        {
+            return second < other.second ||
+                   (second == other.second && side < other.side);
+        }
+    };
 
-    std::vector<uint32_t> ff_size(m_num_faces, 0);
+    uint32_t max_vertex = 0;
+#pragma omp parallel for reduction(max : max_vertex)
+    for (int s = 0; s < static_cast<int>(num_sides); ++s) {
+        max_vertex = std::max(max_vertex, fv[s]);
+    }
+    m_num_vertices = max_vertex + 1;
 
-    for (uint32_t f = 0; f < fv.size(); ++f) {
-        if (fv[f].size() != 3) {
-            RXMESH_ERROR(
-                "rxmesh::build_supporting_structures() Face {} is not "
-                "triangle. Non-triangular faces are not supported",
-                f);
-            exit(EXIT_FAILURE);
+    auto side_vertices = [&](const uint32_t s) {
+        const uint32_t f = s / 3;
+        const uint32_t v = s % 3;
+        return detail::edge_key(fv[3 * f + v], fv[3 * f + (v + 1) % 3]);
+    };
+
+    std::vector<uint32_t> bucket_offset(m_num_vertices + 1, 0);
+    for (uint32_t s = 0; s < num_sides; ++s) {
+        bucket_offset[side_vertices(s).first + 1]++;
+    }
+    std::inclusive_scan(
+        bucket_offset.begin(), bucket_offset.end(), bucket_offset.begin());
+
+    std::vector<SideKey> sorted_side(num_sides);
+    {
+        std::vector<uint32_t> bucket_size(m_num_vertices, 0);
+        for (uint32_t s = 0; s < num_sides; ++s) {
+            const std::pair<uint32_t, uint32_t> edge = side_vertices(s);
+
+            const uint32_t pos =
+                bucket_offset[edge.first] + bucket_size[edge.first]++;
+
+            sorted_side[pos].second = edge.second;
+            sorted_side[pos].side   = s;
         }
+    }
 
-        for (uint32_t v = 0; v < fv[f].size(); ++v) {
-            uint32_t v0 = fv[f][v];
-            uint32_t v1 = fv[f][(v + 1) % 3];
+#pragma omp parallel for schedule(dynamic, 1024)
+    for (int v = 0; v < static_cast<int>(m_num_vertices); ++v) {
+        std::sort(sorted_side.begin() + bucket_offset[v],
+                  sorted_side.begin() + bucket_offset[v + 1]);
+    }
 
-            m_num_vertices = std::max(m_num_vertices, v0);
+    // the start of each run of equal keys in sorted_side
+    std::vector<uint32_t> run_start;
+    run_start.reserve(num_sides / 2 + 1);
+    for (uint32_t v = 0; v < m_num_vertices; ++v) {
+        for (uint32_t i = bucket_offset[v]; i < bucket_offset[v + 1]; ++i) {
+            if (i == bucket_offset[v] ||
+                sorted_side[i].second != sorted_side[i - 1].second) {
+                run_start.push_back(i);
+            }
+        }
+    }
+    m_num_edges = static_cast<uint32_t>(run_start.size());
+    run_start.push_back(num_sides);
 
-            std::pair<uint32_t, uint32_t> edge   = detail::edge_key(v0, v1);
-            auto                          e_iter = m_edges_map.find(edge);
-            if (e_iter == m_edges_map.end()) {
-                uint32_t edge_id = m_num_edges++;
-                m_edges_map.insert(std::make_pair(edge, edge_id));
+    std::vector<uint32_t>().swap(bucket_offset);
 
-                std::vector<uint32_t> evv = {v0, v1};
-                ev.push_back(evv);
+    // number the edges in the order they first appear in fv
+    std::vector<uint32_t> side_edge(num_sides, 0);
+#pragma omp parallel for
+    for (int r = 0; r < static_cast<int>(m_num_edges); ++r) {
+        side_edge[sorted_side[run_start[r]].side] = 1;
+    }
+    std::exclusive_scan(
+        side_edge.begin(), side_edge.end(), side_edge.begin(), uint32_t(0));
 
-                std::vector<uint32_t> tmp(1, f);
-                ef.push_back(tmp);
-            } else {
-                uint32_t edge_id = (*e_iter).second;
+    // ef_offset is first used to count the number of faces incident to each
+    // edge and then turned into offsets
+    ev.clear();
+    ev.resize(2 * m_num_edges);
+    ef_offset.clear();
+    ef_offset.resize(m_num_edges + 1, 0);
 
-                for (uint32_t f0 = 0; f0 < ef[edge_id].size(); ++f0) {
-                    uint32_t other_face = ef[edge_id][f0];
-                    ++ff_size[other_face];
-                }
-                ff_size[f] += ef[edge_id].size();
+    // the edge id of each face side so we don't query the edge map again
+    fe.clear();
+    fe.resize(num_sides);
 
-                ef[edge_id].push_back(f);
-            }
+#pragma omp parallel for
+    for (int r = 0; r < static_cast<int>(m_num_edges); ++r) {
+        const uint32_t first_side = sorted_side[run_start[r]].side;
+        const uint32_t edge_id    = side_edge[first_side];
+
+        const uint32_t f = first_side / 3;
+        const uint32_t v = first_side % 3;
+
+        ev[2 * edge_id]     = fv[3 * f + v];
+        ev[2 * edge_id + 1] = fv[3 * f + (v + 1) % 3];
+
+        ef_offset[edge_id] = run_start[r + 1] - run_start[r];
+
+        for (uint32_t i = run_start[r]; i < run_start[r + 1]; ++i) {
+            fe[sorted_side[i].side] = edge_id;
         }
     }
-    ++m_num_vertices;
+
+    // the edge map is only used for lookups and so it is populated with the
+    // unique edges only
+    m_edges_map.reserve(m_num_edges);
+    for (uint32_t e = 0; e < m_num_edges; ++e) {
+        m_edges_map.insert(
+            std::make_pair(detail::edge_key(ev[2 * e], ev[2 * e + 1]), e));
+    }
 
     if (m_num_edges != static_cast<uint32_t>(m_edges_map.size())) {
         RXMESH_ERROR(
@@ -509,6 +732,31 @@ void RXMesh::build_supporting_structures(
         exit(EXIT_FAILURE);
     }
 
+    // the number of faces adjacent to a face through one of its edges is the
+    // number of the faces incident to this edge minus one
+    std::vector<uint32_t> ff_size(m_num_faces, 0);
+#pragma omp parallel for
+    for (int f = 0; f < static_cast<int>(m_num_faces); ++f) {
+        for (uint32_t v = 0; v < 3; ++v) {
+            ff_size[f] += ef_offset[fe[3 * f + v]] - 1;
+        }
+    }
+
+    // EF in CSR format. Faces incident to an edge are stored in increasing
+    // order of their id which is the order of the sides in each sorted run
+    std::exclusive_scan(
+        ef_offset.begin(), ef_offset.end(), ef_offset.begin(), uint32_t(0));
+    ef_values.clear();
+    ef_values.resize(ef_offset.back());
+#pragma omp parallel for
+    for (int r = 0; r < static_cast<int>(m_num_edges); ++r) {
+        const uint32_t edge_id = side_edge[sorted_side[run_start[r]].side];
+        for (uint32_t i = run_start[r]; i < run_start[r + 1]; ++i) {
+            ef_values[ef_offset[edge_id] + i - run_start[r]] =
+                sorted_side[i].side / 3;
+        }
+    }
+
     ff_offset.resize(m_num_faces + 1);
     std::exclusive_scan(ff_size.begin(), ff_size.end(), ff_offset.begin(), 0);
     ff_offset[m_num_faces] =
@@ -518,10 +766,10 @@ void RXMesh::build_supporting_structures(
     std::fill(ff_size.begin(), ff_size.end(), 0);
 
     for (uint32_t e = 0; e < m_num_edges; ++e) {
-        for (uint32_t i = 0; i < ef[e].size(); ++i) {
-            uint32_t f0 = ef[e][i];
-            for (uint32_t j = i + 1; j < ef[e].size(); ++j) {
-                uint32_t f1 = ef[e][j];
+        for (uint32_t i = ef_offset[e]; i < ef_offset[e + 1]; ++i) {
+            uint32_t f0 = ef_values[i];
+            for (uint32_t j = i + 1; j < ef_offset[e + 1]; ++j) {
+                uint32_t f1 = ef_values[j];
 
                 uint32_t f0_offset = ff_size[f0]++;
                 uint32_t f1_offset = ff_size[f1]++;
@@ -535,16 +783,20 @@ void RXMesh::build_supporting_structures(
     }
 }
 
-void RXMesh::calc_input_statistics(const std::vector<std::vector<uint32_t>>& fv,
-                                   const std::vector<std::vector<uint32_t>>& ef)
+void RXMesh::calc_input_statistics(const uint32_t*              fv,
+                                   const std::vector<uint32_t>& ef_offset)
 {
     if (m_num_vertices == 0 || m_num_faces == 0 || m_num_edges == 0 ||
-        fv.size() == 0 || ef.size() == 0) {
+        fv == nullptr || ef_offset.size() == 0) {
         RXMESH_ERROR(
             "RXMesh::calc_statistics() input mesh has not been initialized");
         exit(EXIT_FAILURE);
     }
 
+    auto num_ef = [&](const uint32_t e) {
+        return ef_offset[e + 1] - ef_offset[e];
+    };
+
     // calc max valence, max ef, is input closed, and is input manifold
     m_input_max_edge_incident_faces = 0;
     m_input_max_valence             = 0;
@@ -561,27 +813,27 @@ void RXMesh::calc_input_statistics(const std::vector<std::vector<uint32_t>>& fv,
         m_input_max_valence = std::max(m_input_max_valence, vv_count[v0]);
         m_input_max_valence = std::max(m_input_max_valence, vv_count[v1]);
 
-        uint32_t edge_id                = e_iter.second;
-        m_input_max_edge_incident_faces = std::max(
-            m_input_max_edge_incident_faces, uint32_t(ef[edge_id].size()));
+        uint32_t edge_id = e_iter.second;
+        m_input_max_edge_incident_faces =
+            std::max(m_input_max_edge_incident_faces, num_ef(edge_id));
 
-        if (ef[edge_id].size() < 2) {
+        if (num_ef(edge_id) < 2) {
             m_is_input_closed = false;
         }
-        if (ef[edge_id].size() > 2) {
+        if (num_ef(edge_id) > 2) {
             m_is_input_edge_manifold = false;
         }
     }
 
     // calc max ff
     m_input_max_face_adjacent_faces = 0;
-    for (uint32_t f = 0; f < fv.size(); ++f) {
+    for (uint32_t f = 0; f < m_num_faces; ++f) {
         uint32_t ff_count = 0;
-        for (uint32_t v = 0; v < fv[f].size(); ++v) {
-            uint32_t v0       = fv[f][v];
-            uint32_t v1       = fv[f][(v + 1) % 3];
+        for (uint32_t v = 0; v < 3; ++v) {
+            uint32_t v0       = fv[3 * f + v];
+            uint32_t v1       = fv[3 * f + (v + 1) % 3];
             uint32_t edge_num = get_edge_id(v0, v1);
-            ff_count += ef[edge_num].size() - 1;
+            ff_count += num_ef(edge_num) - 1;
         }
         m_input_max_face_adjacent_faces =
             std::max(ff_count, m_input_max_face_adjacent_faces);
@@ -606,10 +858,9 @@ void RXMesh::calc_max_elements()
     }
 }
 
-void RXMesh::build_single_patch_ltog(
-    const std::vector<std::vector<uint32_t>>& fv,
-    const std::vector<std::vector<uint32_t>>& ev,
-    const uint32_t                            patch_id)
+void RXMesh::build_single_patch_ltog(const uint32_t*              fv,
+                                     const std::vector<uint32_t>& ev,
+                                     const uint32_t               patch_id)
 {
     // patch start and end
     const uint32_t p_start =
@@ -637,8 +888,8 @@ void RXMesh::build_single_patch_ltog(
         m_h_patches_ltog_f[patch_id][local_face_id] = global_face_id;
 
         for (uint32_t v = 0; v < 3; ++v) {
-            uint32_t v0 = fv[global_face_id][v];
-            uint32_t v1 = fv[global_face_id][(v + 1) % 3];
+            uint32_t v0 = fv[3 * global_face_id + v];
+            uint32_t v1 = fv[3 * global_face_id + (v + 1) % 3];
 
             uint32_t edge_id = get_edge_id(v0, v1);
 
@@ -674,7 +925,7 @@ void RXMesh::build_single_patch_ltog(
         if (m_patcher->get_edge_patch_id(e) == patch_id && !is_edge_added[e]) {
             m_h_patches_ltog_e[patch_id].push_back(e);
             for (uint32_t i = 0; i < 2; ++i) {
-                uint32_t v = ev[e][i];
+                uint32_t v = ev[2 * e + i];
                 if (!is_vertex_added[v]) {
                     m_h_patches_ltog_v[patch_id].push_back(v);
                 }
@@ -718,9 +969,8 @@ void RXMesh::build_single_patch_ltog(
         m_h_patches_ltog_v[patch_id], m_patcher->get_vertex_patch());
 }
 
-void RXMesh::build_single_patch_topology(
-    const std::vector<std::vector<uint32_t>>& fv,
-    const uint32_t                            patch_id)
+void RXMesh::build_single_patch_topology(const uint32_t* fv,
+                                         const uint32_t  patch_id)
 {
     // patch start and end
     const uint32_t p_start =
@@ -777,8 +1027,8 @@ void RXMesh::build_single_patch_topology(
         for (uint32_t v = 0; v < 3; ++v) {
 
 
-            const uint32_t global_v0 = fv[global_face_id][v];
-            const uint32_t global_v1 = fv[global_face_id][(v + 1) % 3];
+            const uint32_t global_v0 = fv[3 * global_face_id + v];
+            const uint32_t global_v1 = fv[3 * global_face_id + (v + 1) % 3];
 
             std::pair<uint32_t, uint32_t> edge_key =
                 detail::edge_key(global_v0, global_v1);
@@ -961,7 +1211,7 @@ void RXMesh::populate_patch_stash()
         }
     };
 
-    // #pragma omp parallel for
+#pragma omp parallel for
     for (int p = 0; p < static_cast<int>(get_num_patches()); ++p) {
         m_h_patches_info[p].patch_stash = PatchStash(false);
 
@@ -979,7 +1229,7 @@ void RXMesh::populate_patch_stash()
                              m_h_num_owned_f[p]);
     }
 
-    // #pragma omp parallel for
+#pragma omp parallel for
     for (int p = get_num_patches(); p < static_cast<int>(get_max_num_patches());
          ++p) {
         m_h_patches_info[p].patch_stash = PatchStash(false);
@@ -989,15 +1239,17 @@ void RXMesh::populate_patch_stash()
 void RXMesh::build_device()
 {
     m_timers.start("cudaMalloc");
-    CUDA_ERROR(cudaMalloc((void**)&m_d_patches_info,
-                          get_max_num_patches() * sizeof(PatchInfo)));
+    CUDA_ERROR(device_malloc((void**)&m_d_patches_info,
+                             get_max_num_patches() * sizeof(PatchInfo)));
     m_timers.stop("cudaMalloc");
 
     m_topo_memory_mega_bytes +=
         BYTES_TO_MEGABYTES(get_max_num_patches() * sizeof(PatchInfo));
 
 
-    // #pragma omp parallel for
+    // every patch writes only to its own host/device PatchInfo and reads the
+    // (read-only) ltog of the other patches so patches are built concurrently
+#pragma omp parallel for
     for (int p = 0; p < static_cast<int>(get_num_patches()); ++p) {
 
         const uint16_t p_num_vertices =
@@ -1024,6 +1276,10 @@ void RXMesh::build_device()
                                   m_d_patches_info[p]);
     }
 
+    if (m_d_build.is_valid()) {
+        build_device_topology();
+    }
+
 
     // make sure that if a patch stash of patch p has patch q, then q's patch
     // stash should have p in it
@@ -1062,7 +1318,13 @@ void RXMesh::build_device_single_patch(const uint32_t patch_id,
                                        PatchInfo& h_patch_info,
                                        PatchInfo& d_patch_info)
 {
+    // if the topology and hashtables are going to be built on the device (in
+    // build_device_topology), we only allocate them here
+    const bool build_on_host = !m_d_build.is_valid();
 
+    // patches could be built concurrently so the memory is accumulated
+    // locally and added to m_topo_memory_mega_bytes once at the end
+    double topo_memory_mega_bytes = 0;
 
     m_timers.start("malloc");
     uint16_t* h_counts = (uint16_t*)malloc(3 * sizeof(uint16_t));
@@ -1087,11 +1349,11 @@ void RXMesh::build_device_single_patch(const uint32_t patch_id,
     uint16_t* d_counts;
 
     m_timers.start("cudaMalloc");
-    CUDA_ERROR(cudaMalloc((void**)&d_counts, 6 * sizeof(uint16_t)));
+    CUDA_ERROR(device_malloc((void**)&d_counts, 6 * sizeof(uint16_t)));
     m_timers.stop("cudaMalloc");
 
 
-    m_topo_memory_mega_bytes += BYTES_TO_MEGABYTES(3 * sizeof(uint16_t));
+    topo_memory_mega_bytes += BYTES_TO_MEGABYTES(3 * sizeof(uint16_t));
 
     PatchInfo d_patch;
     d_patch.num_faces         = d_counts;
@@ -1107,7 +1369,7 @@ void RXMesh::build_device_single_patch(const uint32_t patch_id,
     d_patch.child_id     = INVALID32;
     d_patch.should_slice = false;
 
-    m_topo_memory_mega_bytes +=
+    topo_memory_mega_bytes +=
         BYTES_TO_MEGABYTES(PatchStash::stash_size * sizeof(uint32_t));
 
     // copy count and capacities
@@ -1130,17 +1392,17 @@ void RXMesh::build_device_single_patch(const uint32_t patch_id,
     // we realloc the host h_patch_info EV and FE to ensure that both host and
     // device has the same capacity
     m_timers.start("cudaMalloc");
-    CUDA_ERROR(cudaMalloc((void**)&d_patch.ev,
-                          p_edges_capacity * 2 * sizeof(LocalVertexT)));
+    CUDA_ERROR(device_malloc((void**)&d_patch.ev,
+                             p_edges_capacity * 2 * sizeof(LocalVertexT)));
     m_timers.stop("cudaMalloc");
 
 
-    m_topo_memory_mega_bytes +=
+    topo_memory_mega_bytes +=
         BYTES_TO_MEGABYTES(p_edges_capacity * 2 * sizeof(LocalVertexT));
     h_patch_info.ev = (LocalVertexT*)realloc(
         h_patch_info.ev, p_edges_capacity * 2 * sizeof(LocalVertexT));
 
-    if (p_num_edges > 0) {
+    if (build_on_host && p_num_edges > 0) {
         m_timers.start("cudaMemcpy");
         CUDA_ERROR(cudaMemcpy(d_patch.ev,
                               h_patch_info.ev,
@@ -1150,17 +1412,17 @@ void RXMesh::build_device_single_patch(const uint32_t patch_id,
     }
 
     m_timers.start("cudaMalloc");
-    CUDA_ERROR(cudaMalloc((void**)&d_patch.fe,
-                          p_faces_capacity * 3 * sizeof(LocalEdgeT)));
+    CUDA_ERROR(device_malloc((void**)&d_patch.fe,
+                             p_faces_capacity * 3 * sizeof(LocalEdgeT)));
     m_timers.stop("cudaMalloc");
 
 
-    m_topo_memory_mega_bytes +=
+    topo_memory_mega_bytes +=
         BYTES_TO_MEGABYTES(p_faces_capacity * 3 * sizeof(LocalEdgeT));
     h_patch_info.fe = (LocalEdgeT*)realloc(
         h_patch_info.fe, p_faces_capacity * 3 * sizeof(LocalEdgeT));
 
-    if (p_num_faces > 0) {
+    if (build_on_host && p_num_faces > 0) {
         m_timers.start("cudaMemcpy");
         CUDA_ERROR(cudaMemcpy(d_patch.fe,
                               h_patch_info.fe,
@@ -1170,11 +1432,11 @@ void RXMesh::build_device_single_patch(const uint32_t patch_id,
     }
 
     m_timers.start("cudaMalloc");
-    CUDA_ERROR(cudaMalloc((void**)&d_patch.dirty, sizeof(int)));
+    CUDA_ERROR(device_malloc((void**)&d_patch.dirty, sizeof(int)));
     m_timers.stop("cudaMalloc");
 
 
-    m_topo_memory_mega_bytes += BYTES_TO_MEGABYTES(sizeof(int));
+    topo_memory_mega_bytes += BYTES_TO_MEGABYTES(sizeof(int));
     CUDA_ERROR(cudaMemset(d_patch.dirty, 0, sizeof(int)));
 
 
@@ -1192,11 +1454,11 @@ void RXMesh::build_device_single_patch(const uint32_t patch_id,
         m_timers.stop("malloc");
 
         m_timers.start("cudaMalloc");
-        CUDA_ERROR(cudaMalloc((void**)&d_mask, num_bytes));
+        CUDA_ERROR(device_malloc((void**)&d_mask, num_bytes));
         m_timers.stop("cudaMalloc");
 
 
-        m_topo_memory_mega_bytes += BYTES_TO_MEGABYTES(num_bytes);
+        topo_memory_mega_bytes += BYTES_TO_MEGABYTES(num_bytes);
 
         for (uint16_t i = 0; i < capacity; ++i) {
             if (predicate(i)) {
@@ -1283,10 +1545,15 @@ void RXMesh::build_device_single_patch(const uint32_t patch_id,
         d_hashtable = LPHashTable(cap, true);
         m_timers.stop("LPHashTable");
 
-        m_topo_memory_mega_bytes += BYTES_TO_MEGABYTES(d_hashtable.num_bytes());
-        m_topo_memory_mega_bytes +=
+        topo_memory_mega_bytes += BYTES_TO_MEGABYTES(d_hashtable.num_bytes());
+        topo_memory_mega_bytes +=
             BYTES_TO_MEGABYTES(LPHashTable::stash_size * sizeof(LPPair));
 
+        if (!build_on_host) {
+            m_timers.stop("buildHT");
+            return;
+        }
+
         for (uint16_t i = 0; i < num_not_owned; ++i) {
             uint16_t local_id    = i + num_owned_elements;
             uint32_t global_id   = p_ltog[local_id];
@@ -1372,6 +1639,169 @@ void RXMesh::build_device_single_patch(const uint32_t patch_id,
     CUDA_ERROR(cudaMemcpy(
         &d_patch_info, &d_patch, sizeof(PatchInfo), cudaMemcpyHostToDevice));
     m_timers.stop("cudaMemcpy");
+
+#pragma omp atomic
+    m_topo_memory_mega_bytes += topo_memory_mega_bytes;
+}
+
+void RXMesh::prefetch_patch(const uint32_t p, cudaStream_t stream) const
+{
+#ifdef USE_OUT_OF_CORE
+    const PatchInfo& d_patch = m_h_d_patches_info[p];
+
+    const uint16_t v_cap = d_patch.vertices_capacity;
+    const uint16_t e_cap = d_patch.edges_capacity;
+    const uint16_t f_cap = d_patch.faces_capacity;
+
+    prefetch_to_device(d_patch.num_faces, 3 * sizeof(uint16_t), stream);
+    prefetch_to_device(d_patch.ev, e_cap * 2 * sizeof(LocalVertexT), stream);
+    prefetch_to_device(d_patch.fe, f_cap * 3 * sizeof(LocalEdgeT), stream);
+
+    prefetch_to_device(
+        d_patch.active_mask_v, detail::mask_num_bytes(v_cap), stream);
+    prefetch_to_device(
+        d_patch.active_mask_e, detail::mask_num_bytes(e_cap), stream);
+    prefetch_to_device(
+        d_patch.active_mask_f, detail::mask_num_bytes(f_cap), stream);
+    prefetch_to_device(
+        d_patch.owned_mask_v, detail::mask_num_bytes(v_cap), stream);
+    prefetch_to_device(
+        d_patch.owned_mask_e, detail::mask_num_bytes(e_cap), stream);
+    prefetch_to_device(
+        d_patch.owned_mask_f, detail::mask_num_bytes(f_cap), stream);
+
+    d_patch.lp_v.prefetch(stream);
+    d_patch.lp_e.prefetch(stream);
+    d_patch.lp_f.prefetch(stream);
+    d_patch.patch_stash.prefetch(stream);
+#endif
+}
+
+bool RXMesh::set_lp_bucket_size(const uint8_t bucket_size)
+{
+    if (bucket_size == 0 || bucket_size > LPHashTable::max_bucket_size ||
+        (bucket_size & (bucket_size - 1)) != 0) {
+        RXMESH_ERROR(
+            "RXMesh::set_lp_bucket_size() invalid bucket size {}. It should "
+            "be a power of two that is at most {}",
+            bucket_size,
+            LPHashTable::max_bucket_size);
+        return false;
+    }
+
+    if (bucket_size == m_lp_bucket_size) {
+        return true;
+    }
+
+    // rebuild one hashtable from its device copy. The new tables are only
+    // swapped in once all tables are rebuilt successfully
+    auto rebuild = [&](const LPHashTable& d_lp,
+                       LPHashTable&       h_new,
+                       LPHashTable&       d_new) {
+        // host copy of the device table with the same capacity and hash
+        // functions
+        LPHashTable h_old    = d_lp;
+        h_old.m_is_on_device = false;
+        h_old.m_table        = (LPPair*)malloc(d_lp.num_bytes());
+        h_old.m_stash =
+            (LPPair*)malloc(LPHashTable::stash_size * sizeof(LPPair));
+        h_old.move(d_lp);
+
+        h_new = LPHashTable(d_lp.get_capacity(), false, bucket_size);
+
+        auto insert = [&](const LPPair pair) {
+            if (pair.is_sentinel()) {
+                return true;
+            }
+            return h_new.insert(pair, nullptr, nullptr);
+        };
+
+        bool ok = true;
+        for (uint16_t i = 0; i < h_old.get_capacity() && ok; ++i) {
+            ok = insert(h_old.m_table[i]);
+        }
+        for (uint8_t i = 0; i < LPHashTable::stash_size && ok; ++i) {
+            ok = insert(h_old.m_stash[i]);
+        }
+        h_old.free();
+
+        if (ok) {
+            d_new = LPHashTable(d_lp.get_capacity(), true, bucket_size);
+            d_new.move(h_new);
+        }
+        return ok;
+    };
+
+    const uint32_t num_patches = get_max_num_patches();
+
+    std::vector<PatchInfo>   d_patches(num_patches);
+    std::vector<LPHashTable> h_new(3 * num_patches), d_new(3 * num_patches);
+
+    CUDA_ERROR(cudaMemcpy(d_patches.data(),
+                          m_d_patches_info,
+                          num_patches * sizeof(PatchInfo),
+                          cudaMemcpyDeviceToHost));
+
+    bool ok = true;
+    for (uint32_t p = 0; p < num_patches && ok; ++p) {
+        ok = rebuild(d_patches[p].lp_v, h_new[3 * p + 0], d_new[3 * p + 0]) &&
+             rebuild(d_patches[p].lp_e, h_new[3 * p + 1], d_new[3 * p + 1]) &&
+             rebuild(d_patches[p].lp_f, h_new[3 * p + 2], d_new[3 * p + 2]);
+    }
+
+    if (!ok) {
+        RXMESH_ERROR(
+            "RXMesh::set_lp_bucket_size() failed to rebuild the hashtables "
+            "with bucket size {}. The hashtables are unchanged",
+            bucket_size);
+        for (auto& lp : h_new) {
+            lp.free();
+        }
+        for (auto& lp : d_new) {
+            lp.free();
+        }
+        return false;
+    }
+
+    auto swap = [&](LPHashTable&   h_lp,
+                    LPHashTable&   d_lp,
+                    const uint32_t i,
+                    uint16_t&      max_capacity) {
+        m_topo_memory_mega_bytes -= BYTES_TO_MEGABYTES(d_lp.num_bytes());
+        h_lp.free();
+        d_lp.free();
+        h_lp = h_new[i];
+        d_lp = d_new[i];
+        m_topo_memory_mega_bytes += BYTES_TO_MEGABYTES(d_lp.num_bytes());
+
+        // the bucketed capacity is rounded up to a multiple of the bucket
+        // size which could be bigger than the max capacity used to allocate
+        // shared memory
+        max_capacity = std::max(max_capacity, d_lp.get_capacity());
+    };
+
+    for (uint32_t p = 0; p < num_patches; ++p) {
+        PatchInfo& h_patch = m_h_patches_info[p];
+        PatchInfo& d_patch = d_patches[p];
+        swap(h_patch.lp_v, d_patch.lp_v, 3 * p + 0, m_max_capacity_lp_v);
+        swap(h_patch.lp_e, d_patch.lp_e, 3 * p + 1, m_max_capacity_lp_e);
+        swap(h_patch.lp_f, d_patch.lp_f, 3 * p + 2, m_max_capacity_lp_f);
+#ifdef USE_OUT_OF_CORE
+        m_h_d_patches_info[p] = d_patch;
+#endif
+    }
+
+    CUDA_ERROR(cudaMemcpy(m_d_patches_info,
+                          d_patches.data(),
+                          num_patches * sizeof(PatchInfo),
+                          cudaMemcpyHostToDevice));
+
+    m_lp_bucket_size = bucket_size;
+
+    // the cached inverted hashtables (if any) use the old hash functions
+    m_rxmesh_context.m_inv_lp_cache.invalidate_all();
+
+    return true;
 }
 
 void RXMesh::allocate_extra_patches()
@@ -1477,4 +1907,220 @@ void RXMesh::patch_graph_coloring()
 
     m_num_colors++;
 }
+
+void RXMesh::save_cache(const std::string&        filename,
+                        const std::vector<float>& vertices) const
+{
+    if (vertices.size() != 3 * size_t(m_num_vertices)) {
+        RXMESH_ERROR(
+            "RXMesh::save_cache() number of input vertex coordinates ({}) does "
+            "not match the number of vertices in the mesh ({})",
+            vertices.size() / 3,
+            m_num_vertices);
+        return;
+    }
+
+    // edge map as a flat list of vertex pairs ordered by the edge id
+    std::vector<uint32_t> ev(2 * m_num_edges);
+    for (const auto& e_iter : m_edges_map) {
+        ev[2 * e_iter.second]     = e_iter.first.first;
+        ev[2 * e_iter.second + 1] = e_iter.first.second;
+    }
+
+    // per-patch topology (EV and FE) flattened into two arrays. The offset of
+    // each patch is recovered from the size of its local-to-global maps
+    size_t num_ev = 0, num_fe = 0;
+    for (uint32_t p = 0; p < m_num_patches; ++p) {
+        num_ev += 2 * m_h_patches_ltog_e[p].size();
+        num_fe += 3 * m_h_patches_ltog_f[p].size();
+    }
+    std::vector<uint16_t> patches_ev(num_ev), patches_fe(num_fe);
+    num_ev = 0;
+    num_fe = 0;
+    for (uint32_t p = 0; p < m_num_patches; ++p) {
+        for (size_t i = 0; i < 2 * m_h_patches_ltog_e[p].size(); ++i) {
+            patches_ev[num_ev++] = m_h_patches_info[p].ev[i].id;
+        }
+        for (size_t i = 0; i < 3 * m_h_patches_ltog_f[p].size(); ++i) {
+            patches_fe[num_fe++] = m_h_patches_info[p].fe[i].id;
+        }
+    }
+
+    std::vector<uint16_t> num_owned_v(m_h_num_owned_v.begin(),
+                                      m_h_num_owned_v.begin() + m_num_patches);
+    std::vector<uint16_t> num_owned_e(m_h_num_owned_e.begin(),
+                                      m_h_num_owned_e.begin() + m_num_patches);
+    std::vector<uint16_t> num_owned_f(m_h_num_owned_f.begin(),
+                                      m_h_num_owned_f.begin() + m_num_patches);
+
+    const auto parent = std::filesystem::path(filename).parent_path();
+    if (!parent.empty() && !std::filesystem::exists(parent)) {
+        std::filesystem::create_directories(parent);
+    }
+
+    std::ofstream ss(filename, std::ios::binary);
+    if (!ss.is_open()) {
+        RXMESH_ERROR("RXMesh::save_cache() can not open {}", filename);
+        return;
+    }
+    cereal::PortableBinaryOutputArchive archive(ss);
+
+    archive(MESH_CACHE_MAGIC,
+            MESH_CACHE_VERSION,
+            m_patch_size,
+            m_num_vertices,
+            m_num_edges,
+            m_num_faces,
+            m_input_max_valence,
+            m_input_max_edge_incident_faces,
+            m_input_max_face_adjacent_faces,
+            m_is_input_edge_manifold,
+            m_is_input_closed);
+    archive(ev);
+    archive(*m_patcher);
+    archive(m_h_patches_ltog_v, m_h_patches_ltog_e, m_h_patches_ltog_f);
+    archive(num_owned_v, num_owned_e, num_owned_f);
+    archive(patches_ev, patches_fe);
+    archive(vertices);
+
+    RXMESH_INFO("RXMesh::save_cache() wrote {}", filename);
+}
+
+bool RXMesh::load_cache(const std::string&  filename,
+                        std::vector<float>& vertices)
+{
+    uint32_t magic(0), version(0), patch_size(0), num_vertices(0),
+        num_edges(0), num_faces(0), max_valence(0), max_ef(0), max_ff(0);
+    bool is_edge_manifold(true), is_closed(true);
+
+    std::vector<uint32_t>              ev;
+    std::vector<std::vector<uint32_t>> ltog_v, ltog_e, ltog_f;
+    std::vector<uint16_t>              num_owned_v, num_owned_e, num_owned_f;
+    std::vector<uint16_t>              patches_ev, patches_fe;
+    std::vector<float>                 coords;
+
+    auto cached_patcher = std::make_unique<patcher::Patcher>();
+
+    try {
+        std::ifstream                      is(filename, std::ios::binary);
+        cereal::PortableBinaryInputArchive archive(is);
+
+        archive(magic, version, patch_size);
+
+        if (magic != MESH_CACHE_MAGIC || version != MESH_CACHE_VERSION ||
+            patch_size != m_patch_size) {
+            RXMESH_WARN(
+                "RXMesh::load_cache() {} is not a valid cache for this version "
+                "or patch size. It will be ignored",
+                filename);
+            return false;
+        }
+
+        archive(num_vertices,
+                num_edges,
+                num_faces,
+                max_valence,
+                max_ef,
+                max_ff,
+                is_edge_manifold,
+                is_closed);
+        archive(ev);
+        archive(*cached_patcher);
+        archive(ltog_v, ltog_e, ltog_f);
+        archive(num_owned_v, num_owned_e, num_owned_f);
+        archive(patches_ev, patches_fe);
+        archive(coords);
+    } catch (const std::exception& e) {
+        RXMESH_WARN("RXMesh::load_cache() failed to read {}: {}",
+                    filename,
+                    e.what());
+        return false;
+    }
+
+    const uint32_t num_patches = cached_patcher->get_num_patches();
+    if (ev.size() != 2 * size_t(num_edges) ||
+        coords.size() != 3 * size_t(num_vertices) ||
+        ltog_v.size() != num_patches || ltog_e.size() != num_patches ||
+        ltog_f.size() != num_patches || num_owned_v.size() != num_patches ||
+        num_owned_e.size() != num_patches ||
+        num_owned_f.size() != num_patches) {
+        RXMESH_WARN("RXMesh::load_cache() {} is corrupted. It will be ignored",
+                    filename);
+        return false;
+    }
+
+    size_t num_ev = 0, num_fe = 0;
+    for (uint32_t p = 0; p < num_patches; ++p) {
+        num_ev += 2 * ltog_e[p].size();
+        num_fe += 3 * ltog_f[p].size();
+    }
+    if (num_ev != patches_ev.size() || num_fe != patches_fe.size()) {
+        RXMESH_WARN("RXMesh::load_cache() {} is corrupted. It will be ignored",
+                    filename);
+        return false;
+    }
+
+    m_num_vertices                  = num_vertices;
+    m_num_edges                     = num_edges;
+    m_num_faces                     = num_faces;
+    m_input_max_valence             = max_valence;
+    m_input_max_edge_incident_faces = max_ef;
+    m_input_max_face_adjacent_faces = max_ff;
+    m_is_input_edge_manifold        = is_edge_manifold;
+    m_is_input_closed               = is_closed;
+
+    m_edges_map.clear();
+    m_edges_map.reserve(m_num_edges);
+    for (uint32_t e = 0; e < m_num_edges; ++e) {
+        m_edges_map.insert(
+            std::make_pair(std::make_pair(ev[2 * e], ev[2 * e + 1]), e));
+    }
+
+    m_patcher         = std::move(cached_patcher);
+    m_num_patches     = num_patches;
+    m_max_num_patches = static_cast<uint32_t>(
+        std::ceil(m_patch_alloc_factor * static_cast<float>(m_num_patches)));
+
+    m_h_patches_ltog_v = std::move(ltog_v);
+    m_h_patches_ltog_e = std::move(ltog_e);
+    m_h_patches_ltog_f = std::move(ltog_f);
+
+    m_h_num_owned_v = std::move(num_owned_v);
+    m_h_num_owned_e = std::move(num_owned_e);
+    m_h_num_owned_f = std::move(num_owned_f);
+    m_h_num_owned_v.resize(get_max_num_patches(), 0);
+    m_h_num_owned_e.resize(get_max_num_patches(), 0);
+    m_h_num_owned_f.resize(get_max_num_patches(), 0);
+
+    m_h_patches_info =
+        (PatchInfo*)malloc(get_max_num_patches() * sizeof(PatchInfo));
+
+    calc_patch_capacities();
+
+    size_t ev_offset = 0, fe_offset = 0;
+    for (uint32_t p = 0; p < m_num_patches; ++p) {
+        const size_t p_num_ev = 2 * m_h_patches_ltog_e[p].size();
+        const size_t p_num_fe = 3 * m_h_patches_ltog_f[p].size();
+
+        m_h_patches_info[p].ev = (LocalVertexT*)malloc(
+            m_max_edge_capacity * 2 * sizeof(LocalVertexT));
+        m_h_patches_info[p].fe = (LocalEdgeT*)malloc(
+            m_max_face_capacity * 3 * sizeof(LocalEdgeT));
+
+        for (size_t i = 0; i < p_num_ev; ++i) {
+            m_h_patches_info[p].ev[i].id = patches_ev[ev_offset + i];
+        }
+        for (size_t i = 0; i < p_num_fe; ++i) {
+            m_h_patches_info[p].fe[i].id = patches_fe[fe_offset + i];
+        }
+        ev_offset += p_num_ev;
+        fe_offset += p_num_fe;
+    }
+
+    build_element_prefix();
+
+    vertices = std::move(coords);
+
+    return true;
+}
 }  // namespace rxmesh
@@ -3,13 +3,16 @@
 #include <unordered_map>
 #include <vector>
 #include "rxmesh/context.h"
+#include "rxmesh/device_build_data.h"
 #include "rxmesh/handle.h"
+#include "rxmesh/memory_report.h"
 #include "rxmesh/patch_info.h"
 #include "rxmesh/patcher/patcher.h"
 #include "rxmesh/types.h"
 #include "rxmesh/util/cuda_query.h"
 #include "rxmesh/util/log.h"
 #include "rxmesh/util/macros.h"
+#include "rxmesh/util/memory_pool.h"
 #include "rxmesh/util/util.h"
 
 #include "rxmesh/util/timer.h"
@@ -161,6 +164,15 @@ class RXMesh
         return m_rxmesh_context;
     }
 
+    /**
+     * @brief the device memory pool that backs the attributes and the dense
+     * matrices created from this mesh (see MemoryPool)
+     */
+    MemoryPool& get_memory_pool() const
+    {
+        return *m_memory_pool;
+    }
+
     /**
      * @brief returns true if the input mesh is manifold
      */
@@ -311,6 +323,25 @@ class RXMesh
         return m_patcher->get_num_lloyd_run();
     }
 
+    /**
+     * @brief The number of patches that were re-patched when the mesh is
+     * constructed incrementally from a previous face patch assignment
+     */
+    uint32_t get_num_repatched_patches() const
+    {
+        return m_patcher->get_num_repatched_patches();
+    }
+
+    /**
+     * @brief The patch of every input face (indexed by the face id in the
+     * input). This could be used to incrementally patch a slightly edited
+     * version of this mesh
+     */
+    const std::vector<uint32_t>& get_face_patch() const
+    {
+        return m_patcher->get_face_patch();
+    }
+
     /**
      * @brief Return the edge id given two vertices. Edges are undirected.
      * @param v0 first input vertex
@@ -328,6 +359,19 @@ class RXMesh
         m_patcher->save(filename);
     }
 
+    /**
+     * @brief save a binary snapshot of the built mesh i.e., the edge map, the
+     * patches, the per-patch local-to-global maps and topology, along with the
+     * input vertex coordinates. This snapshot can be used later to construct
+     * RXMeshStatic without parsing the input file or patching the mesh. This
+     * should be called right after construction (before any topology changes)
+     * @param filename the output cache file
+     * @param vertices the input vertex coordinates (3*#vertices) in the same
+     * order as the input
+     */
+    void save_cache(const std::string&        filename,
+                    const std::vector<float>& vertices) const;
+
     /**
      * @brief map a global vertex index to a VertexHandle i.e., a local vertex
      * Note: The mapping is different than the mapping from the input
@@ -429,6 +473,93 @@ class RXMesh
         return m_topo_memory_mega_bytes;
     }
 
+    /**
+     * @brief return a per-buffer breakdown of the memory allocated for the
+     * topology information. Unlike get_topology_memory_mg(), this accounts for
+     * the allocated capacity of all patches (including the extra patches
+     * reserved for dynamic changes) and reports the ribbon (not-owned) elements
+     */
+    TopologyMemoryReport get_topology_memory_report() const
+    {
+        TopologyMemoryReport report;
+
+        report.num_patches     = get_num_patches();
+        report.max_num_patches = get_max_num_patches();
+        report.ribbon_overhead = get_ribbon_overhead();
+        report.patch_info_bytes =
+            size_t(get_max_num_patches()) * sizeof(PatchInfo);
+
+        for (uint32_t p = 0; p < get_max_num_patches(); ++p) {
+            const PatchInfo& pi = m_h_patches_info[p];
+
+            report.ev_bytes +=
+                size_t(pi.edges_capacity) * 2 * sizeof(LocalVertexT);
+            report.fe_bytes +=
+                size_t(pi.faces_capacity) * 3 * sizeof(LocalEdgeT);
+
+            const size_t mask_bytes =
+                detail::mask_num_bytes(pi.vertices_capacity) +
+                detail::mask_num_bytes(pi.edges_capacity) +
+                detail::mask_num_bytes(pi.faces_capacity);
+            report.active_mask_bytes += mask_bytes;
+            report.owned_mask_bytes += mask_bytes;
+
+            report.lp_hashtable_bytes +=
+                (size_t(pi.lp_v.get_capacity()) + pi.lp_e.get_capacity() +
+                 pi.lp_f.get_capacity() + 3 * LPHashTable::stash_size) *
+                sizeof(LPPair);
+
+            // patch stash + dirty flag + num_vertices/edges/faces counters
+            report.patch_stash_bytes +=
+                PatchStash::stash_size * sizeof(uint32_t) + sizeof(int) +
+                6 * sizeof(uint16_t);
+
+            if (p < get_num_patches()) {
+                report.num_owned_vertices += get_num_owned_vertices(p);
+                report.num_owned_edges += get_num_owned_edges(p);
+                report.num_owned_faces += get_num_owned_faces(p);
+
+                report.num_not_owned_vertices +=
+                    get_num_vertices(p) - get_num_owned_vertices(p);
+                report.num_not_owned_edges +=
+                    get_num_edges(p) - get_num_owned_edges(p);
+                report.num_not_owned_faces +=
+                    get_num_faces(p) - get_num_owned_faces(p);
+            }
+        }
+
+        return report;
+    }
+
+    /**
+     * @brief asynchronously migrate the topology (EV, FE, masks, hashtables,
+     * and patch stash) of patch p to the device ahead of its use. This is
+     * only effective if RXMesh is compiled with USE_OUT_OF_CORE (see
+     * device_malloc()), otherwise it is a no-op
+     */
+    void prefetch_patch(const uint32_t p, cudaStream_t stream = NULL) const;
+
+    /**
+     * @brief rebuild the (vertex, edge, and face) hashtables of all patches
+     * with a new bucket size (see LPHashTable). Bucket size 1 is the default
+     * unbucketed layout. A bucketed layout has shorter cuckoo chains at high
+     * load factors. The hashtables are rebuilt from the device and so this
+     * can be called at any point outside a kernel
+     * @param bucket_size number of slots per bucket (power of two that is at
+     * most LPHashTable::max_bucket_size)
+     * @return true if all hashtables were rebuilt. Otherwise, the hashtables
+     * are unchanged
+     */
+    bool set_lp_bucket_size(const uint8_t bucket_size);
+
+    /**
+     * @brief the bucket size used by the patches hashtables
+     */
+    uint8_t get_lp_bucket_size() const
+    {
+        return m_lp_bucket_size;
+    }
+
    protected:
     // Edge hash map that takes two vertices and return their edge id
     using EdgeMapT = std::unordered_map<std::pair<uint32_t, uint32_t>,
@@ -460,24 +591,84 @@ class RXMesh
               const float patch_alloc_factor                            = 5.0,
               const float lp_hashtable_load_factor                      = 0.5);
 
+    /**
+     * @brief init all the data structures from a flat index buffer. This is
+     * what the other init() calls after flattening its input
+     * @param fv the mesh connectivity as a flat index triangle buffer
+     * (3*num_faces) where face f is (fv[3*f], fv[3*f+1], fv[3*f+2])
+     * @param num_faces the number of faces
+     */
+    void init(const uint32_t*   fv,
+              const uint32_t    num_faces,
+              const std::string patcher_file             = "",
+              const float       capacity_factor          = 1.8,
+              const float       patch_alloc_factor       = 5.0,
+              const float       lp_hashtable_load_factor = 0.5);
+
+    /**
+     * @brief init all the data structures from a cache file written by
+     * save_cache. This skips building the supporting structures, patching, and
+     * building the per-patch topology
+     * @param cache_file the cache file
+     * @param vertices output input vertex coordinates (3*#vertices) as stored
+     * in the cache
+     * @return false if the cache file does not exist or is not valid for this
+     * version/patch size. In this case, nothing is initialized and the caller
+     * should call init() instead
+     */
+    bool init_from_cache(const std::string&  cache_file,
+                         std::vector<float>& vertices,
+                         const float         capacity_factor          = 1.8,
+                         const float         patch_alloc_factor       = 5.0,
+                         const float         lp_hashtable_load_factor = 0.5);
+
+    /**
+     * @brief set and check the different allocation factors and add the
+     * timers used during init
+     */
+    void init_factors(const float capacity_factor,
+                      const float patch_alloc_factor,
+                      const float lp_hashtable_load_factor);
+
+    /**
+     * @brief everything that comes after build() in init i.e., populate patch
+     * stash, patch graph coloring, build the device data structure, and init
+     * the context
+     */
+    void finalize_init();
+
+    /**
+     * @brief read the cache file written by save_cache and populate the same
+     * information as build()
+     */
+    bool load_cache(const std::string& filename, std::vector<float>& vertices);
+
     /**
      * @brief build different supporting data structure used to build RXMesh
      *
      * Set the number of vertices, edges, and faces, populate edge_map (which
      * takes two connected vertices and returns their edge id), build
      * face-incident-faces data structure (used to in creating patches). This is
-     * done using a single pass over FV
+     * done using a single pass over FV. All outputs are flat (CSR) arrays to
+     * avoid one allocation per element
      *
-     * @param fv input face incident vertices
-     * @param ef output edge incident faces
-     * @param ef output face adjacent faces
-     */
-    void build_supporting_structures(
-        const std::vector<std::vector<uint32_t>>& fv,
-        std::vector<std::vector<uint32_t>>&       ev,
-        std::vector<std::vector<uint32_t>>&       ef,
-        std::vector<uint32_t>&                    ff_offset,
-        std::vector<uint32_t>&                    ff_values);
+     * @param fv input face incident vertices (3*num_faces)
+     * @param num_faces number of input faces
+     * @param ev output edge incident vertices (2*#edges)
+     * @param fe output face incident edges (3*num_faces) as global edge ids
+     * @param ef_offset output offset of each edge in ef_values (#edges + 1)
+     * @param ef_values output edge incident faces
+     * @param ff_offset output offset of each face in ff_values (#faces + 1)
+     * @param ff_values output face adjacent faces
+     */
+    void build_supporting_structures(const uint32_t*        fv,
+                                     const uint32_t         num_faces,
+                                     std::vector<uint32_t>& ev,
+                                     std::vector<uint32_t>& fe,
+                                     std::vector<uint32_t>& ef_offset,
+                                     std::vector<uint32_t>& ef_values,
+                                     std::vector<uint32_t>& ff_offset,
+                                     std::vector<uint32_t>& ff_values);
 
     /**
      * @brief Calculate various statistics for the input mesh
@@ -486,11 +677,11 @@ class RXMesh
      * if the input is closed, if the input is edge manifold, and max number of
      * vertices/edges/faces per patch
      *
-     * @param fv input face incident vertices
-     * @param ef input edge incident faces
+     * @param fv input face incident vertices (3*#faces)
+     * @param ef_offset offset of each edge incident faces (#edges + 1)
      */
-    void calc_input_statistics(const std::vector<std::vector<uint32_t>>& fv,
-                               const std::vector<std::vector<uint32_t>>& ef);
+    void calc_input_statistics(const uint32_t*              fv,
+                               const std::vector<uint32_t>& ef_offset);
 
     /**
      * @brief count the max number of vertices/edges/faces per patch and
@@ -537,16 +728,49 @@ class RXMesh
         }
     }
 
-    void build(const std::vector<std::vector<uint32_t>>& fv,
-               const std::string                         patcher_file);
+    void build(const uint32_t*   fv,
+               const uint32_t    num_faces,
+               const std::string patcher_file);
 
-    void build_single_patch_ltog(const std::vector<std::vector<uint32_t>>& fv,
-                                 const std::vector<std::vector<uint32_t>>& ev,
-                                 const uint32_t patch_id);
+    /**
+     * @brief compute the max number of vertices/edges/faces per patch from the
+     * local-to-global maps and the corresponding per-patch capacities
+     */
+    void calc_patch_capacities();
+
+    /**
+     * @brief compute the prefix sum of owned vertices/edges/faces (on host and
+     * device) and the LP hashtable capacities
+     */
+    void build_element_prefix();
 
-    void build_single_patch_topology(
-        const std::vector<std::vector<uint32_t>>& fv,
-        const uint32_t                            patch_id);
+    void build_single_patch_ltog(const uint32_t*              fv,
+                                 const std::vector<uint32_t>& ev,
+                                 const uint32_t               patch_id);
+
+    void build_single_patch_topology(const uint32_t* fv,
+                                     const uint32_t  patch_id);
+
+    /**
+     * @brief copy the input mesh, its patching, and the patches
+     * local-to-global maps to the device so that the per-patch topology and
+     * LP hashtables are built on the device (in build_device_topology) instead
+     * of the host
+     * @param fv input face incident vertices (3*#faces)
+     * @param fe input face incident edges (3*#faces)
+     * @param ev input edge incident vertices (2*#edges)
+     */
+    void upload_build_data(const uint32_t*              fv,
+                           const std::vector<uint32_t>& fe,
+                           const std::vector<uint32_t>& ev);
+
+    /**
+     * @brief build the per-patch EV, FE, and LP hashtables on the device from
+     * the data uploaded by upload_build_data, mirror them on the host, and
+     * release the uploaded data. Should be called after all patches are
+     * allocated on the device and their patch stash is copied
+     */
+    void build_device_topology();
 
     // get the max vertex/edge/face capacity i.e., the max number of
     // vertices/edges/faces allowed in a patch (for allocation purposes)
@@ -578,6 +802,8 @@ class RXMesh
     uint32_t get_edge_id(const std::pair<uint32_t, uint32_t>& edge) const;
 
     friend class ::RXMeshTest;
+    friend class RXMeshMultiGPU;
+    friend class RXMeshDistributed;
 
     template <typename T, typename HandleT>
     friend class Attribute;
@@ -604,6 +830,26 @@ class RXMesh
     // patching the mesh into small pieces
     std::unique_ptr<patcher::Patcher> m_patcher;
 
+    // optional partition of the input faces into consecutive groups (e.g., the
+    // meshes of RXMeshBatch) where group g is the faces in
+    // [m_face_group_offset[g], m_face_group_offset[g+1]). If set before
+    // build(), the patches are numbered such that the patches of each group
+    // are consecutive and m_group_patch_offset stores the first patch of each
+    // group
+    std::vector<uint32_t> m_face_group_offset, m_group_patch_offset;
+
+    // time/quality budget of the Lloyd patcher used by build()
+    patcher::PatcherBudget m_patcher_budget;
+
+    // optional previous patch of every input face (or INVALID32 for new
+    // faces). If set before build(), the mesh is patched incrementally
+    // starting from this assignment
+    std::vector<uint32_t> m_prev_face_patch;
+
+    // device copy of the input used to build the topology on the device. Only
+    // valid between build() and build_device() with USE_DEVICE_BUILD
+    DeviceBuildData m_d_build;
+
     // the number of owned mesh elements per patch
     std::vector<uint16_t> m_h_num_owned_f, m_h_num_owned_e, m_h_num_owned_v;
 
@@ -631,12 +877,22 @@ class RXMesh
 
     PatchInfo *m_d_patches_info, *m_h_patches_info;
 
+    // host copy of m_d_patches_info (i.e., the device pointers of every
+    // patch) used to prefetch patches. Only allocated with USE_OUT_OF_CORE
+    PatchInfo* m_h_d_patches_info;
+
     float m_capacity_factor, m_lp_hashtable_load_factor, m_patch_alloc_factor;
 
+    // the bucket size of the patches hashtables (see set_lp_bucket_size())
+    uint8_t m_lp_bucket_size;
+
     double m_topo_memory_mega_bytes;
 
     uint32_t m_num_colors;
 
     Timers<CPUTimer> m_timers;
+
+    // should outlive the attributes allocated from it
+    std::unique_ptr<MemoryPool> m_memory_pool;
 };
 }  // namespace rxmesh
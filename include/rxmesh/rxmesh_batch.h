@@ -0,0 +1,365 @@
+#pragma once
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "rxmesh/reduce_handle.h"
+#include "rxmesh/rxmesh_static.h"
+#include "rxmesh/util/import_mesh.h"
+
+namespace rxmesh {
+
+/**
+ * @brief Pack many (small) meshes into one RXMesh such that they share one
+ * patch array and are processed together in a single launch. The meshes are
+ * concatenated into one mesh of disconnected components and patched such that
+ * no patch contains faces of two meshes and the patches of mesh m are
+ * consecutive, i.e., [get_mesh_patch_offset()[m],
+ * get_mesh_patch_offset()[m+1]). Since this is RXMeshStatic, for_each_*,
+ * run_query_kernel, attributes, and ReduceHandle work on the whole batch.
+ * Per-mesh reductions are computed in one launch using the segmented
+ * reductions of ReduceHandle with the per-mesh patch offset (see
+ * reduce_per_mesh() and dot_per_mesh())
+ */
+class RXMeshBatch : public RXMeshStatic
+{
+   public:
+    RXMeshBatch(const RXMeshBatch&) = delete;
+
+    /**
+     * @brief Constructor using paths to obj or ply files. Each file is one
+     * mesh in the batch
+     * @param file_paths path of the obj or ply file of every mesh
+     */
+    explicit RXMeshBatch(const std::vector<std::string>& file_paths,
+                         const uint32_t                  patch_size = 512,
+                         const float capacity_factor                = 1.0,
+                         const float patch_alloc_factor             = 1.0,
+                         const float lp_hashtable_load_factor       = 0.8)
+        : RXMeshStatic(patch_size, false)
+    {
+        std::vector<std::vector<uint32_t>> fv_list(file_paths.size());
+        std::vector<std::vector<float>>    vertices_list(file_paths.size());
+
+        for (size_t m = 0; m < file_paths.size(); ++m) {
+            std::vector<uint32_t> face_offset;
+            if (!import_mesh(
+                    file_paths[m], vertices_list[m], fv_list[m], face_offset)) {
+                RXMESH_ERROR(
+                    "RXMeshBatch::RXMeshBatch could not read the input file "
+                    "{}",
+                    file_paths[m]);
+                exit(EXIT_FAILURE);
+            }
+            if (!face_offset.empty()) {
+                RXMESH_ERROR(
+                    "RXMeshBatch::RXMeshBatch the input file {} has "
+                    "non-triangular faces. Non-triangular faces are not "
+                    "supported",
+                    file_paths[m]);
+                exit(EXIT_FAILURE);
+            }
+        }
+
+        build_batch(fv_list,
+                    vertices_list,
+                    capacity_factor,
+                    patch_alloc_factor,
+                    lp_hashtable_load_factor);
+    }
+
+    /**
+     * @brief Constructor using flat triangle index buffers
+     * @param fv_list face incident vertices of every mesh (3*#faces of the
+     * mesh) indexing the mesh own vertices starting from zero
+     * @param vertices_list (optional) vertex coordinates of every mesh
+     * (3*#vertices of the mesh). If not empty, the coordinates of all meshes
+     * are added to the batch as one vertex attribute
+     */
+    explicit RXMeshBatch(const std::vector<std::vector<uint32_t>>& fv_list,
+                         const std::vector<std::vector<float>>& vertices_list =
+                             std::vector<std::vector<float>>(),
+                         const uint32_t patch_size               = 512,
+                         const float    capacity_factor          = 1.0,
+                         const float    patch_alloc_factor       = 1.0,
+                         const float    lp_hashtable_load_factor = 0.8)
+        : RXMeshStatic(patch_size, false)
+    {
+        build_batch(fv_list,
+                    vertices_list,
+                    capacity_factor,
+                    patch_alloc_factor,
+                    lp_hashtable_load_factor);
+    }
+
+    virtual ~RXMeshBatch()
+    {
+        GPU_FREE(m_d_mesh_patch_offset);
+        GPU_FREE(m_d_patch_mesh);
+    }
+
+    /**
+     * @brief the number of meshes in the batch
+     */
+    uint32_t get_num_meshes() const
+    {
+        return m_num_meshes;
+    }
+
+    /**
+     * @brief the first patch of every mesh (#meshes + 1) on the host or device
+     */
+    const uint32_t* get_mesh_patch_offset(locationT location = HOST) const
+    {
+        if (location == DEVICE) {
+            return m_d_mesh_patch_offset;
+        }
+        return m_group_patch_offset.data();
+    }
+
+    /**
+     * @brief the mesh of every patch (#max patches) on the host or device.
+     * Could be used inside kernels to find the mesh of a handle from its
+     * patch id. Patches that are not used are marked with INVALID32
+     */
+    const uint32_t* get_patch_mesh(locationT location = HOST) const
+    {
+        if (location == DEVICE) {
+            return m_d_patch_mesh;
+        }
+        return m_h_patch_mesh.data();
+    }
+
+    /**
+     * @brief the mesh that a vertex/edge/face belongs to
+     */
+    template <typename HandleT>
+    uint32_t get_mesh_id(const HandleT& handle) const
+    {
+        return m_h_patch_mesh[handle.patch_id()];
+    }
+
+    /**
+     * @brief the number of patches of mesh m
+     */
+    uint32_t get_mesh_num_patches(const uint32_t m) const
+    {
+        return m_group_patch_offset[m + 1] - m_group_patch_offset[m];
+    }
+
+    /**
+     * @brief the number of vertices of mesh m
+     */
+    uint32_t get_mesh_num_vertices(const uint32_t m) const
+    {
+        return m_mesh_vertex_offset[m + 1] - m_mesh_vertex_offset[m];
+    }
+
+    /**
+     * @brief the number of faces of mesh m
+     */
+    uint32_t get_mesh_num_faces(const uint32_t m) const
+    {
+        return m_face_group_offset[m + 1] - m_face_group_offset[m];
+    }
+
+    /**
+     * @brief the global id (in the batch) of the first vertex of mesh m. The
+     * global id of vertex v of mesh m in the batch is
+     * get_mesh_vertex_offset(m) + v
+     */
+    uint32_t get_mesh_vertex_offset(const uint32_t m) const
+    {
+        return m_mesh_vertex_offset[m];
+    }
+
+    /**
+     * @brief the global id (in the batch) of the first face of mesh m. The
+     * global id of face f of mesh m in the batch is get_mesh_face_offset(m) + f
+     */
+    uint32_t get_mesh_face_offset(const uint32_t m) const
+    {
+        return m_face_group_offset[m];
+    }
+
+    /**
+     * @brief reduce an attribute for every mesh in the batch in a single
+     * launch. See ReduceHandle::reduce() for the reduction functor and init
+     * @return the reduced value of every mesh (#meshes)
+     */
+    template <typename T, typename HandleT, typename ReductionOp>
+    std::vector<T> reduce_per_mesh(ReduceHandle<T, HandleT>&    reduce_handle,
+                                   const Attribute<T, HandleT>& attr,
+                                   ReductionOp                  reduction_op,
+                                   T                            init,
+                                   uint32_t     attribute_id = INVALID32,
+                                   cudaStream_t stream       = NULL)
+    {
+        return reduce_handle.segmented_reduce(attr,
+                                              reduction_op,
+                                              init,
+                                              m_d_mesh_patch_offset,
+                                              m_num_meshes,
+                                              attribute_id,
+                                              stream);
+    }
+
+    /**
+     * @brief dot product of two attributes for every mesh in the batch in a
+     * single launch
+     * @return the dot product of every mesh (#meshes)
+     */
+    template <typename T, typename HandleT>
+    std::vector<T> dot_per_mesh(ReduceHandle<T, HandleT>&    reduce_handle,
+                                const Attribute<T, HandleT>& attr1,
+                                const Attribute<T, HandleT>& attr2,
+                                uint32_t     attribute_id = INVALID32,
+                                cudaStream_t stream       = NULL)
+    {
+        return reduce_handle.segmented_dot(attr1,
+                                           attr2,
+                                           m_d_mesh_patch_offset,
+                                           m_num_meshes,
+                                           attribute_id,
+                                           stream);
+    }
+
+   protected:
+    void build_batch(const std::vector<std::vector<uint32_t>>& fv_list,
+                     const std::vector<std::vector<float>>&    vertices_list,
+                     const float                               capacity_factor,
+                     const float patch_alloc_factor,
+                     const float lp_hashtable_load_factor)
+    {
+        m_num_meshes = static_cast<uint32_t>(fv_list.size());
+
+        if (m_num_meshes == 0) {
+            RXMESH_ERROR("RXMeshBatch::build_batch() the input has no meshes");
+            exit(EXIT_FAILURE);
+        }
+
+        if (!vertices_list.empty() && vertices_list.size() != m_num_meshes) {
+            RXMESH_ERROR(
+                "RXMeshBatch::build_batch() the number of vertex lists ({}) "
+                "does not match the number of meshes ({})",
+                vertices_list.size(),
+                m_num_meshes);
+            exit(EXIT_FAILURE);
+        }
+
+        // every mesh vertices/faces are offset by the total number of
+        // vertices/faces of the meshes before it
+        m_face_group_offset.resize(m_num_meshes + 1, 0);
+        m_mesh_vertex_offset.resize(m_num_meshes + 1, 0);
+        for (uint32_t m = 0; m < m_num_meshes; ++m) {
+            if (fv_list[m].empty() || fv_list[m].size() % 3 != 0) {
+                RXMESH_ERROR(
+                    "RXMeshBatch::build_batch() mesh {} is empty or is not a "
+                    "triangle mesh",
+                    m);
+                exit(EXIT_FAILURE);
+            }
+            const uint32_t num_v =
+                *std::max_element(fv_list[m].begin(), fv_list[m].end()) + 1;
+
+            if (!vertices_list.empty() && vertices_list[m].size() < 3 * num_v) {
+                RXMESH_ERROR(
+                    "RXMeshBatch::build_batch() mesh {} references {} vertices "
+                    "but only {} vertex coordinates are given",
+                    m,
+                    num_v,
+                    vertices_list[m].size() / 3);
+                exit(EXIT_FAILURE);
+            }
+
+            m_face_group_offset[m + 1] =
+                m_face_group_offset[m] +
+                static_cast<uint32_t>(fv_list[m].size() / 3);
+            m_mesh_vertex_offset[m + 1] = m_mesh_vertex_offset[m] + num_v;
+        }
+
+        const uint32_t num_faces = m_face_group_offset.back();
+
+        if (m_num_meshes > 1 && num_faces <= get_patch_size()) {
+            RXMESH_ERROR(
+                "RXMeshBatch::build_batch() the batch has {} faces which is "
+                "less than the patch size ({}) and thus would be a single "
+                "patch that spans different meshes. Use a smaller patch size",
+                num_faces,
+                get_patch_size());
+            exit(EXIT_FAILURE);
+        }
+
+        std::vector<uint32_t> fv(3 * size_t(num_faces));
+#pragma omp parallel for
+        for (int m = 0; m < static_cast<int>(m_num_meshes); ++m) {
+            const size_t start = 3 * size_t(m_face_group_offset[m]);
+            for (size_t i = 0; i < fv_list[m].size(); ++i) {
+                fv[start + i] = fv_list[m][i] + m_mesh_vertex_offset[m];
+            }
+        }
+
+        this->init(fv.data(),
+                   num_faces,
+                   "",
+                   capacity_factor,
+                   patch_alloc_factor,
+                   lp_hashtable_load_factor);
+
+        m_attr_container = std::make_shared<AttributeContainer>();
+
+        // per-patch mesh id
+        m_h_patch_mesh.resize(get_max_num_patches(), INVALID32);
+        for (uint32_t m = 0; m < m_num_meshes; ++m) {
+            for (uint32_t p = m_group_patch_offset[m];
+                 p < m_group_patch_offset[m + 1];
+                 ++p) {
+                m_h_patch_mesh[p] = m;
+            }
+        }
+
+        CUDA_ERROR(tracked_malloc((void**)&m_d_mesh_patch_offset,
+                                  (m_num_meshes + 1) * sizeof(uint32_t),
+                                  MemoryCategory::Topology));
+        CUDA_ERROR(cudaMemcpy(m_d_mesh_patch_offset,
+                              m_group_patch_offset.data(),
+                              (m_num_meshes + 1) * sizeof(uint32_t),
+                              cudaMemcpyHostToDevice));
+
+        CUDA_ERROR(tracked_malloc((void**)&m_d_patch_mesh,
+                                  m_h_patch_mesh.size() * sizeof(uint32_t),
+                                  MemoryCategory::Topology));
+        CUDA_ERROR(cudaMemcpy(m_d_patch_mesh,
+                              m_h_patch_mesh.data(),
+                              m_h_patch_mesh.size() * sizeof(uint32_t),
+                              cudaMemcpyHostToDevice));
+
+        if (!vertices_list.empty()) {
+            const uint32_t num_vertices = m_mesh_vertex_offset.back();
+
+            std::vector<float> vertices(3 * size_t(num_vertices));
+#pragma omp parallel for
+            for (int m = 0; m < static_cast<int>(m_num_meshes); ++m) {
+                const size_t start = 3 * size_t(m_mesh_vertex_offset[m]);
+                const size_t count = 3 * size_t(get_mesh_num_vertices(m));
+                std::copy(vertices_list[m].begin(),
+                          vertices_list[m].begin() + count,
+                          vertices.begin() + start);
+            }
+            add_vertex_coordinates(
+                vertices.data(), num_vertices, "RXMeshBatch");
+        }
+
+        RXMESH_INFO("RXMeshBatch: #Meshes = {}, #Patches = {}",
+                    m_num_meshes,
+                    get_num_patches());
+    }
+
+    uint32_t              m_num_meshes = 0;
+    std::vector<uint32_t> m_mesh_vertex_offset;
+    std::vector<uint32_t> m_h_patch_mesh;
+    uint32_t*             m_d_mesh_patch_offset = nullptr;
+    uint32_t*             m_d_patch_mesh        = nullptr;
+};
+}  // namespace rxmesh
@@ -0,0 +1,184 @@
+#include <algorithm>
+#include <type_traits>
+#include <vector>
+
+#include "rxmesh/kernels/device_build.cuh"
+#include "rxmesh/rxmesh.h"
+#include "rxmesh/util/log.h"
+#include "rxmesh/util/macros.h"
+
+namespace rxmesh {
+
+void RXMesh::upload_build_data(const uint32_t*              fv,
+                               const std::vector<uint32_t>& fe,
+                               const std::vector<uint32_t>& ev)
+{
+    m_timers.add("upload_build_data");
+    m_timers.start("upload_build_data");
+
+    auto upload = [&](auto*& d_ptr, const auto* h_ptr, const size_t count) {
+        using T = std::remove_pointer_t<decltype(h_ptr)>;
+
+        const size_t n_bytes = std::max(count, size_t(1)) * sizeof(T);
+        CUDA_ERROR(
+            tracked_malloc((void**)&d_ptr, n_bytes, MemoryCategory::Topology));
+        if (count > 0) {
+            CUDA_ERROR(cudaMemcpy(
+                d_ptr, h_ptr, count * sizeof(T), cudaMemcpyHostToDevice));
+        }
+    };
+
+    // flatten the per-patch local-to-global map into CSR
+    auto upload_ltog = [&](const std::vector<std::vector<uint32_t>>& ltog,
+                           uint32_t*&                                d_ltog,
+                           uint32_t*&                                d_offset) {
+        std::vector<uint32_t> offset(get_num_patches() + 1, 0);
+        for (uint32_t p = 0; p < get_num_patches(); ++p) {
+            offset[p + 1] = offset[p] + static_cast<uint32_t>(ltog[p].size());
+        }
+
+        std::vector<uint32_t> flat(offset.back());
+#pragma omp parallel for
+        for (int p = 0; p < static_cast<int>(get_num_patches()); ++p) {
+            std::copy(ltog[p].begin(), ltog[p].end(), flat.begin() + offset[p]);
+        }
+
+        upload(d_ltog, flat.data(), flat.size());
+        upload(d_offset, offset.data(), offset.size());
+    };
+
+    upload(m_d_build.fv, fv, 3 * size_t(m_num_faces));
+    upload(m_d_build.fe, fe.data(), fe.size());
+    upload(m_d_build.ev, ev.data(), ev.size());
+
+    upload(m_d_build.vertex_patch,
+           m_patcher->get_vertex_patch().data(),
+           m_patcher->get_vertex_patch().size());
+    upload(m_d_build.edge_patch,
+           m_patcher->get_edge_patch().data(),
+           m_patcher->get_edge_patch().size());
+    upload(m_d_build.face_patch,
+           m_patcher->get_face_patch().data(),
+           m_patcher->get_face_patch().size());
+
+    upload_ltog(m_h_patches_ltog_v, m_d_build.ltog_v, m_d_build.ltog_v_offset);
+    upload_ltog(m_h_patches_ltog_e, m_d_build.ltog_e, m_d_build.ltog_e_offset);
+    upload_ltog(m_h_patches_ltog_f, m_d_build.ltog_f, m_d_build.ltog_f_offset);
+
+    upload(m_d_build.num_owned_v, m_h_num_owned_v.data(), get_num_patches());
+    upload(m_d_build.num_owned_e, m_h_num_owned_e.data(), get_num_patches());
+    upload(m_d_build.num_owned_f, m_h_num_owned_f.data(), get_num_patches());
+
+    // the host EV and FE are allocated in build_device_single_patch and then
+    // filled from the device in build_device_topology
+    for (uint32_t p = 0; p < get_num_patches(); ++p) {
+        m_h_patches_info[p].ev = nullptr;
+        m_h_patches_info[p].fe = nullptr;
+    }
+
+    m_timers.stop("upload_build_data");
+}
+
+void RXMesh::build_device_topology()
+{
+    m_timers.add("build_device_topology");
+    m_timers.start("build_device_topology");
+
+    constexpr uint32_t blockThreads = 256;
+
+    const uint32_t num_patches = get_num_patches();
+
+    uint32_t* d_num_failed = nullptr;
+    CUDA_ERROR(tracked_malloc((void**)&d_num_failed,
+                              sizeof(uint32_t),
+                              MemoryCategory::Topology));
+    CUDA_ERROR(cudaMemset(d_num_failed, 0, sizeof(uint32_t)));
+
+    detail::build_patch_topology<blockThreads>
+        <<<num_patches, blockThreads>>>(m_d_build, m_d_patches_info);
+
+    detail::build_patch_lp_hashtable<VertexHandle, blockThreads>
+        <<<num_patches, blockThreads>>>(m_d_build.ltog_v,
+                                        m_d_build.ltog_v_offset,
+                                        m_d_build.num_owned_v,
+                                        m_d_build.vertex_patch,
+                                        m_d_patches_info,
+                                        d_num_failed);
+
+    detail::build_patch_lp_hashtable<EdgeHandle, blockThreads>
+        <<<num_patches, blockThreads>>>(m_d_build.ltog_e,
+                                        m_d_build.ltog_e_offset,
+                                        m_d_build.num_owned_e,
+                                        m_d_build.edge_patch,
+                                        m_d_patches_info,
+                                        d_num_failed);
+
+    detail::build_patch_lp_hashtable<FaceHandle, blockThreads>
+        <<<num_patches, blockThreads>>>(m_d_build.ltog_f,
+                                        m_d_build.ltog_f_offset,
+                                        m_d_build.num_owned_f,
+                                        m_d_build.face_patch,
+                                        m_d_patches_info,
+                                        d_num_failed);
+
+    CUDA_ERROR(cudaDeviceSynchronize());
+    CUDA_ERROR(cudaGetLastError());
+
+    uint32_t h_num_failed = 0;
+    CUDA_ERROR(cudaMemcpy(&h_num_failed,
+                          d_num_failed,
+                          sizeof(uint32_t),
+                          cudaMemcpyDeviceToHost));
+    GPU_FREE(d_num_failed);
+
+    if (h_num_failed > 0) {
+        RXMESH_ERROR(
+            "rxmesh::build_device_topology failed to insert {} elements in "
+            "the hashtable. Retry with smaller load factor. Load factor used "
+            "= {}",
+            h_num_failed,
+            m_lp_hashtable_load_factor);
+    }
+
+    // mirror the topology and hashtables on the host
+    PatchInfo* h_d_patches_info =
+        (PatchInfo*)malloc(num_patches * sizeof(PatchInfo));
+    CUDA_ERROR(cudaMemcpy(h_d_patches_info,
+                          m_d_patches_info,
+                          num_patches * sizeof(PatchInfo),
+                          cudaMemcpyDeviceToHost));
+
+    m_timers.start("cudaMemcpy");
+    for (uint32_t p = 0; p < num_patches; ++p) {
+        const PatchInfo& d_patch = h_d_patches_info[p];
+        PatchInfo&       h_patch = m_h_patches_info[p];
+
+        const uint16_t p_num_edges = h_patch.num_edges[0];
+        const uint16_t p_num_faces = h_patch.num_faces[0];
+
+        if (p_num_edges > 0) {
+            CUDA_ERROR(cudaMemcpy(h_patch.ev,
+                                  d_patch.ev,
+                                  p_num_edges * 2 * sizeof(LocalVertexT),
+                                  cudaMemcpyDeviceToHost));
+        }
+        if (p_num_faces > 0) {
+            CUDA_ERROR(cudaMemcpy(h_patch.fe,
+                                  d_patch.fe,
+                                  p_num_faces * 3 * sizeof(LocalEdgeT),
+                                  cudaMemcpyDeviceToHost));
+        }
+
+        h_patch.lp_v.move(d_patch.lp_v);
+        h_patch.lp_e.move(d_patch.lp_e);
+        h_patch.lp_f.move(d_patch.lp_f);
+    }
+    m_timers.stop("cudaMemcpy");
+
+    free(h_d_patches_info);
+
+    m_d_build.release();
+
+    m_timers.stop("build_device_topology");
+}
+}  // namespace rxmesh
@@ -0,0 +1,693 @@
+#pragma once
+
+#ifdef USE_MPI
+
+#include <algorithm>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <mpi.h>
+
+#include "metis.h"
+
+#include "rxmesh/attribute.h"
+#include "rxmesh/reduce_handle.h"
+#include "rxmesh/rxmesh_static.h"
+#include "rxmesh/util/mpi_util.h"
+
+namespace rxmesh {
+
+template <typename T, typename HandleT>
+class DistributedAttribute;
+
+/**
+ * @brief Distribute a static mesh across the ranks of an MPI communicator
+ * (e.g., one rank per GPU on every node of a cluster). This is the multi-node
+ * counterpart of RXMeshMultiGPU. Every rank holds a replica of the mesh
+ * topology on its GPU (built once by rank 0 and read by the other ranks from
+ * the mesh cache which should then be on a shared file system) and the
+ * patches are partitioned with METIS over the patch graph (where patches are
+ * connected if one appears in the PatchStash of the other and weighted by
+ * their owned faces) into one partition per rank that minimizes the
+ * communication volume. Each rank processes only the patches it owns i.e.,
+ * for_each_*(), run_kernel(), and run_query_kernel() on get_mesh() only
+ * launch these patches (see RXMeshStatic::set_patch_subset()). The ribbon of
+ * a partition is stored in the halo patches which are the patches of other
+ * ranks that appear in the PatchStash of the partition patches. Attributes
+ * are created with add_vertex/edge/face_attribute() and the halo patches are
+ * updated from their owner ranks with DistributedAttribute::exchange_halo()
+ * which sends device buffers directly with CUDA-aware MPI (or stages them
+ * through the host). ReduceHandle reduces over the whole distributed mesh
+ * after prepare() e.g., for the dot products of a CG solver
+ *
+ *     RXMeshDistributed dist(file_path);
+ *     auto x = dist.add_vertex_attribute<float>("x", 1);
+ *     auto a = x->get();
+ *     dist.get_mesh().for_each_vertex(
+ *         DEVICE,
+ *         [a] __device__(const VertexHandle vh) mutable { a(vh) = 1; },
+ *         dist.get_stream());
+ *     x->exchange_halo();
+ *
+ *     ReduceHandle rh(x->get());
+ *     dist.prepare(rh);
+ *     float n = rh.norm2(x->get()); // the same on all ranks
+ */
+class RXMeshDistributed
+{
+   public:
+    RXMeshDistributed(const RXMeshDistributed&) = delete;
+
+    /**
+     * @brief Constructor using path to obj or ply file. MPI should be
+     * initialized and the constructor should be called by all ranks of comm.
+     * Every rank uses the GPU local_rank % (number of devices) where
+     * local_rank is its rank within its node
+     * @param file_path path to an obj or ply file (readable by rank 0)
+     * @param comm the ranks to distribute the mesh across
+     * @param cuda_aware_mpi if true, halo exchange sends device pointers to
+     * MPI. Otherwise, it is staged through the host and the attributes should
+     * be allocated on the host as well
+     * @param cache_dir directory of the mesh cache used to build the mesh
+     * once and load it on the other ranks. It should be visible to all ranks.
+     * If empty, the system temporary directory is used
+     */
+    explicit RXMeshDistributed(
+        const std::string file_path,
+        MPI_Comm          comm                     = MPI_COMM_WORLD,
+        const bool        cuda_aware_mpi           = true,
+        const uint32_t    patch_size               = 512,
+        const float       capacity_factor          = 1.0,
+        const float       patch_alloc_factor       = 1.0,
+        const float       lp_hashtable_load_factor = 0.8,
+        std::string       cache_dir                = "")
+        : m_comm(comm),
+          m_cuda_aware(cuda_aware_mpi),
+          m_d_owned_patches(nullptr)
+    {
+        MPI_ERROR(MPI_Comm_rank(m_comm, &m_rank));
+        MPI_ERROR(MPI_Comm_size(m_comm, &m_num_ranks));
+
+        select_device();
+
+        if (cache_dir.empty()) {
+            cache_dir = (std::filesystem::temp_directory_path() /
+                         "rxmesh_distributed_cache")
+                            .string();
+        }
+
+        auto build = [&]() {
+            m_mesh = std::make_unique<RXMeshStatic>(file_path,
+                                                    "",
+                                                    false,
+                                                    patch_size,
+                                                    capacity_factor,
+                                                    patch_alloc_factor,
+                                                    lp_hashtable_load_factor,
+                                                    cache_dir);
+        };
+
+        // rank 0 builds the mesh and writes the cache which is then read by
+        // the other ranks
+        if (m_rank == 0) {
+            build();
+        }
+        MPI_ERROR(MPI_Barrier(m_comm));
+        if (m_rank != 0) {
+            build();
+        }
+
+        // all replicas should have identical patches
+        uint32_t num[2] = {m_mesh->get_num_patches(), m_mesh->get_num_faces()};
+        uint32_t num_min[2], num_max[2];
+        MPI_ERROR(
+            MPI_Allreduce(num, num_min, 2, MPI_UINT32_T, MPI_MIN, m_comm));
+        MPI_ERROR(
+            MPI_Allreduce(num, num_max, 2, MPI_UINT32_T, MPI_MAX, m_comm));
+        if (num_min[0] != num_max[0] || num_min[1] != num_max[1]) {
+            RXMESH_ERROR(
+                "RXMeshDistributed::RXMeshDistributed() the mesh replica on "
+                "rank {} does not match the other ranks. Is the mesh cache "
+                "directory {} shared by all ranks?",
+                m_rank,
+                cache_dir);
+            MPI_Abort(m_comm, EXIT_FAILURE);
+        }
+
+        CUDA_ERROR(cudaStreamCreateWithFlags(&m_stream, cudaStreamNonBlocking));
+
+        partition();
+    }
+
+    ~RXMeshDistributed()
+    {
+        CUDA_ERROR(cudaSetDevice(m_device));
+        m_mesh->clear_patch_subset();
+        GPU_FREE(m_d_owned_patches);
+        CUDA_ERROR(cudaStreamDestroy(m_stream));
+        m_mesh.reset();
+    }
+
+    /**
+     * @brief the rank of this process in the communicator
+     */
+    int get_rank() const
+    {
+        return m_rank;
+    }
+
+    /**
+     * @brief the number of ranks the mesh is distributed across
+     */
+    int get_num_ranks() const
+    {
+        return m_num_ranks;
+    }
+
+    /**
+     * @brief the communicator the mesh is distributed across
+     */
+    MPI_Comm get_comm() const
+    {
+        return m_comm;
+    }
+
+    /**
+     * @brief the CUDA device used by this rank
+     */
+    int get_device() const
+    {
+        return m_device;
+    }
+
+    /**
+     * @brief true if halo exchange passes device pointers to MPI
+     */
+    bool is_cuda_aware() const
+    {
+        return m_cuda_aware;
+    }
+
+    /**
+     * @brief the mesh replica of this rank
+     */
+    RXMeshStatic& get_mesh()
+    {
+        return *m_mesh;
+    }
+
+    /**
+     * @brief the stream used by this rank
+     */
+    cudaStream_t get_stream() const
+    {
+        return m_stream;
+    }
+
+    /**
+     * @brief the number of patches in the (whole) mesh
+     */
+    uint32_t get_num_patches() const
+    {
+        return m_mesh->get_num_patches();
+    }
+
+    /**
+     * @brief the rank that owns patch p
+     */
+    int get_patch_rank(const uint32_t p) const
+    {
+        return m_patch_rank[p];
+    }
+
+    /**
+     * @brief the (sorted) patches owned by this rank
+     */
+    const std::vector<uint32_t>& get_owned_patches() const
+    {
+        return m_owned_patches;
+    }
+
+    /**
+     * @brief the (sorted) patches owned by other ranks whose elements are in
+     * the ribbon of this rank partition
+     */
+    const std::vector<uint32_t>& get_halo_patches() const
+    {
+        return m_halo_patches;
+    }
+
+    /**
+     * @brief the patches of this rank that are in the halo of rank r i.e.,
+     * the patches sent to r by exchange_halo()
+     */
+    const std::vector<uint32_t>& get_send_patches(const int r) const
+    {
+        return m_send_patches[r];
+    }
+
+    /**
+     * @brief the patches of rank r that are in the halo of this rank i.e.,
+     * the patches received from r by exchange_halo()
+     */
+    const std::vector<uint32_t>& get_recv_patches(const int r) const
+    {
+        return m_recv_patches[r];
+    }
+
+    /**
+     * @brief restrict the mesh replica to the patches owned by this rank
+     * again e.g., after a local edit used RXMeshStatic::set_patch_subset()
+     */
+    void restore_partition()
+    {
+        m_mesh->set_patch_subset(m_d_owned_patches, m_owned_patches.size());
+    }
+
+    /**
+     * @brief make the reductions of rh reduce over the patches owned by this
+     * rank and then all-reduce across the ranks such that all ranks get the
+     * reduction over the whole mesh (see ReduceHandle::set_communicator())
+     */
+    template <typename T, typename HandleT>
+    void prepare(ReduceHandle<T, HandleT>& rh) const
+    {
+        rh.set_patch_subset(m_d_owned_patches, m_owned_patches.size());
+        rh.set_communicator(m_comm);
+    }
+
+    /**
+     * @brief add a vertex attribute on all ranks
+     */
+    template <typename T>
+    std::shared_ptr<DistributedAttribute<T, VertexHandle>>
+    add_vertex_attribute(const std::string& name,
+                         uint32_t           num_attributes,
+                         locationT          location = LOCATION_ALL,
+                         layoutT            layout   = SoA)
+    {
+        return add_attribute<T, VertexHandle>(
+            name, num_attributes, location, layout);
+    }
+
+    /**
+     * @brief add an edge attribute on all ranks
+     */
+    template <typename T>
+    std::shared_ptr<DistributedAttribute<T, EdgeHandle>> add_edge_attribute(
+        const std::string& name,
+        uint32_t           num_attributes,
+        locationT          location = LOCATION_ALL,
+        layoutT            layout   = SoA)
+    {
+        return add_attribute<T, EdgeHandle>(
+            name, num_attributes, location, layout);
+    }
+
+    /**
+     * @brief add a face attribute on all ranks
+     */
+    template <typename T>
+    std::shared_ptr<DistributedAttribute<T, FaceHandle>> add_face_attribute(
+        const std::string& name,
+        uint32_t           num_attributes,
+        locationT          location = LOCATION_ALL,
+        layoutT            layout   = SoA)
+    {
+        return add_attribute<T, FaceHandle>(
+            name, num_attributes, location, layout);
+    }
+
+    /**
+     * @brief add an attribute on all ranks where the type of the mesh element
+     * is given as a template parameter
+     */
+    template <typename T, typename HandleT>
+    std::shared_ptr<DistributedAttribute<T, HandleT>> add_attribute(
+        const std::string& name,
+        uint32_t           num_attributes,
+        locationT          location = LOCATION_ALL,
+        layoutT            layout   = SoA);
+
+   protected:
+    /**
+     * @brief pick the GPU of this rank from its rank within its node
+     */
+    void select_device()
+    {
+        MPI_Comm local_comm;
+        MPI_ERROR(MPI_Comm_split_type(
+            m_comm, MPI_COMM_TYPE_SHARED, m_rank, MPI_INFO_NULL, &local_comm));
+        int local_rank = 0;
+        MPI_ERROR(MPI_Comm_rank(local_comm, &local_rank));
+        MPI_ERROR(MPI_Comm_free(&local_comm));
+
+        int num_devices = 0;
+        CUDA_ERROR(cudaGetDeviceCount(&num_devices));
+        if (num_devices == 0) {
+            RXMESH_ERROR(
+                "RXMeshDistributed::select_device() no CUDA device on rank {}",
+                m_rank);
+            MPI_Abort(m_comm, EXIT_FAILURE);
+        }
+
+        m_device = local_rank % num_devices;
+        CUDA_ERROR(cudaSetDevice(m_device));
+    }
+
+    /**
+     * @brief partition the patch graph with METIS on rank 0 and broadcast
+     * the owner rank of every patch
+     */
+    void metis_partition()
+    {
+        const uint32_t num_patches = get_num_patches();
+
+        m_patch_rank.resize(num_patches, 0);
+
+        if (m_num_ranks == 1) {
+            return;
+        }
+
+        if (num_patches < uint32_t(m_num_ranks)) {
+            RXMESH_WARN(
+                "RXMeshDistributed::metis_partition() the number of patches "
+                "({}) is less than the number of ranks ({}). Some ranks will "
+                "be idle",
+                num_patches,
+                m_num_ranks);
+            for (uint32_t p = 0; p < num_patches; ++p) {
+                m_patch_rank[p] = p;
+            }
+            return;
+        }
+
+        if (m_rank == 0) {
+            const RXMeshStatic& rx = *m_mesh;
+
+            // the patch graph should be symmetric
+            std::vector<std::vector<uint32_t>> adj(num_patches);
+            for (uint32_t p = 0; p < num_patches; ++p) {
+                const PatchStash& stash = rx.m_h_patches_info[p].patch_stash;
+                for (uint8_t i = 0; i < PatchStash::stash_size; ++i) {
+                    const uint32_t q = stash.get_patch(i);
+                    if (q != INVALID32 && q != p && q < num_patches) {
+                        adj[p].push_back(q);
+                        adj[q].push_back(p);
+                    }
+                }
+            }
+
+            std::vector<idx_t> xadj(num_patches + 1, 0);
+            std::vector<idx_t> adjncy;
+            std::vector<idx_t> vwgt(num_patches);
+            for (uint32_t p = 0; p < num_patches; ++p) {
+                std::sort(adj[p].begin(), adj[p].end());
+                adj[p].erase(std::unique(adj[p].begin(), adj[p].end()),
+                             adj[p].end());
+                adjncy.insert(adjncy.end(), adj[p].begin(), adj[p].end());
+                xadj[p + 1] = adjncy.size();
+                vwgt[p] = std::max<idx_t>(1, rx.get_num_owned_faces(p));
+            }
+
+            idx_t options[METIS_NOPTIONS];
+            METIS_SetDefaultOptions(options);
+            options[METIS_OPTION_PTYPE]     = METIS_PTYPE_KWAY;
+            options[METIS_OPTION_OBJTYPE]   = METIS_OBJTYPE_VOL;
+            options[METIS_OPTION_NUMBERING] = 0;
+
+            idx_t              nvtxs  = num_patches;
+            idx_t              ncon   = 1;
+            idx_t              nparts = m_num_ranks;
+            idx_t              objval = 0;
+            std::vector<idx_t> part(nvtxs, 0);
+
+            int metis_status = METIS_PartGraphKway(&nvtxs,
+                                                   &ncon,
+                                                   xadj.data(),
+                                                   adjncy.data(),
+                                                   vwgt.data(),
+                                                   NULL,
+                                                   NULL,
+                                                   &nparts,
+                                                   NULL,
+                                                   NULL,
+                                                   options,
+                                                   &objval,
+                                                   part.data());
+
+            if (metis_status != METIS_OK) {
+                RXMESH_ERROR(
+                    "RXMeshDistributed::metis_partition() METIS failed with "
+                    "status {}",
+                    metis_status);
+                MPI_Abort(m_comm, EXIT_FAILURE);
+            }
+
+            for (uint32_t p = 0; p < num_patches; ++p) {
+                m_patch_rank[p] = part[p];
+            }
+        }
+
+        MPI_ERROR(MPI_Bcast(
+            m_patch_rank.data(), num_patches, MPI_UINT32_T, 0, m_comm));
+    }
+
+    /**
+     * @brief partition the patches, restrict the replica to the patches of
+     * this rank, and compute the halo patches and the send/receive lists of
+     * halo exchange
+     */
+    void partition()
+    {
+        metis_partition();
+
+        const uint32_t      num_patches = get_num_patches();
+        const RXMeshStatic& rx          = *m_mesh;
+
+        // the halo of every rank (the same on all ranks since the replicas
+        // and the partition are identical)
+        std::vector<std::vector<uint32_t>> halo(m_num_ranks);
+        for (uint32_t p = 0; p < num_patches; ++p) {
+            const uint32_t    r     = m_patch_rank[p];
+            const PatchStash& stash = rx.m_h_patches_info[p].patch_stash;
+            for (uint8_t i = 0; i < PatchStash::stash_size; ++i) {
+                const uint32_t q = stash.get_patch(i);
+                if (q != INVALID32 && m_patch_rank[q] != r) {
+                    halo[r].push_back(q);
+                }
+            }
+        }
+        for (auto& h : halo) {
+            std::sort(h.begin(), h.end());
+            h.erase(std::unique(h.begin(), h.end()), h.end());
+        }
+
+        m_halo_patches = halo[m_rank];
+
+        m_owned_patches.clear();
+        for (uint32_t p = 0; p < num_patches; ++p) {
+            if (m_patch_rank[p] == uint32_t(m_rank)) {
+                m_owned_patches.push_back(p);
+            }
+        }
+
+        // the lists are sorted by patch id such that the messages between
+        // two ranks are matched in the order they are posted
+        m_send_patches.assign(m_num_ranks, {});
+        m_recv_patches.assign(m_num_ranks, {});
+        for (int r = 0; r < m_num_ranks; ++r) {
+            if (r == m_rank) {
+                continue;
+            }
+            for (const uint32_t q : halo[r]) {
+                if (m_patch_rank[q] == uint32_t(m_rank)) {
+                    m_send_patches[r].push_back(q);
+                }
+            }
+        }
+        for (const uint32_t q : m_halo_patches) {
+            m_recv_patches[m_patch_rank[q]].push_back(q);
+        }
+
+        CUDA_ERROR(tracked_malloc((void**)&m_d_owned_patches,
+                                  std::max<size_t>(1, m_owned_patches.size()) *
+                                      sizeof(uint32_t),
+                                  MemoryCategory::Topology));
+        CUDA_ERROR(cudaMemcpy(m_d_owned_patches,
+                              m_owned_patches.data(),
+                              m_owned_patches.size() * sizeof(uint32_t),
+                              cudaMemcpyHostToDevice));
+
+        restore_partition();
+
+        RXMESH_INFO(
+            "RXMeshDistributed: rank {} (device {}) has {} patches with {} "
+            "halo patches",
+            m_rank,
+            m_device,
+            m_owned_patches.size(),
+            m_halo_patches.size());
+    }
+
+    MPI_Comm                           m_comm;
+    int                                m_rank;
+    int                                m_num_ranks;
+    int                                m_device;
+    bool                               m_cuda_aware;
+    std::unique_ptr<RXMeshStatic>      m_mesh;
+    cudaStream_t                       m_stream;
+    std::vector<uint32_t>              m_patch_rank;
+    std::vector<uint32_t>              m_owned_patches;
+    std::vector<uint32_t>              m_halo_patches;
+    std::vector<std::vector<uint32_t>> m_send_patches;
+    std::vector<std::vector<uint32_t>> m_recv_patches;
+    uint32_t*                          m_d_owned_patches;
+};
+
+
+/**
+ * @brief An attribute distributed across the ranks of RXMeshDistributed.
+ * Every rank has a full-size replica of the attribute (get()) where only the
+ * patches owned by the rank are written by it and the halo patches are
+ * updated from their owner ranks with exchange_halo()
+ */
+template <typename T, typename HandleT>
+class DistributedAttribute
+{
+   public:
+    DistributedAttribute(RXMeshDistributed* dist,
+                         const std::string& name,
+                         uint32_t           num_attributes,
+                         locationT          location,
+                         layoutT            layout)
+        : m_dist(dist)
+    {
+        m_attr = m_dist->get_mesh().template add_attribute<T, HandleT>(
+            name, num_attributes, location, layout);
+    }
+
+    /**
+     * @brief the attribute replica of this rank. This is the one to be
+     * captured by kernels/lambdas
+     */
+    Attribute<T, HandleT>& get()
+    {
+        return *m_attr;
+    }
+
+    /**
+     * @brief reset the attribute to a value
+     */
+    void reset(const T value, locationT location)
+    {
+        m_attr->reset(value, location, m_dist->get_stream());
+    }
+
+    /**
+     * @brief copy the halo patches of this rank from their owner ranks. This
+     * should be called by all ranks. It waits for the work submitted on the
+     * rank stream and blocks until the halo is received. One message is
+     * sent per patch
+     */
+    void exchange_halo()
+    {
+        const bool   cuda_aware = m_dist->is_cuda_aware();
+        cudaStream_t stream     = m_dist->get_stream();
+
+        if (!cuda_aware && (m_attr->get_allocated() & HOST) != HOST) {
+            RXMESH_ERROR(
+                "DistributedAttribute::exchange_halo() the attribute should "
+                "be allocated on the host when MPI is not CUDA-aware");
+            return;
+        }
+
+        const int num_ranks = m_dist->get_num_ranks();
+
+        if (!cuda_aware) {
+            for (int r = 0; r < num_ranks; ++r) {
+                for (const uint32_t q : m_dist->get_send_patches(r)) {
+                    CUDA_ERROR(cudaMemcpyAsync(m_attr->m_h_attr[q],
+                                               m_attr->m_h_ptr_on_device[q],
+                                               patch_bytes(q),
+                                               cudaMemcpyDeviceToHost,
+                                               stream));
+                }
+            }
+        }
+        CUDA_ERROR(cudaStreamSynchronize(stream));
+
+        std::vector<MPI_Request> requests;
+        for (int r = 0; r < num_ranks; ++r) {
+            for (const uint32_t q : m_dist->get_recv_patches(r)) {
+                requests.emplace_back();
+                MPI_ERROR(MPI_Irecv(buffer(q, cuda_aware),
+                                    patch_bytes(q),
+                                    MPI_BYTE,
+                                    r,
+                                    halo_tag,
+                                    m_dist->get_comm(),
+                                    &requests.back()));
+            }
+        }
+        for (int r = 0; r < num_ranks; ++r) {
+            for (const uint32_t q : m_dist->get_send_patches(r)) {
+                requests.emplace_back();
+                MPI_ERROR(MPI_Isend(buffer(q, cuda_aware),
+                                    patch_bytes(q),
+                                    MPI_BYTE,
+                                    r,
+                                    halo_tag,
+                                    m_dist->get_comm(),
+                                    &requests.back()));
+            }
+        }
+        MPI_ERROR(MPI_Waitall(
+            requests.size(), requests.data(), MPI_STATUSES_IGNORE));
+
+        if (!cuda_aware) {
+            for (const uint32_t q : m_dist->get_halo_patches()) {
+                CUDA_ERROR(cudaMemcpyAsync(m_attr->m_h_ptr_on_device[q],
+                                           m_attr->m_h_attr[q],
+                                           patch_bytes(q),
+                                           cudaMemcpyHostToDevice,
+                                           stream));
+            }
+            CUDA_ERROR(cudaStreamSynchronize(stream));
+        }
+    }
+
+   private:
+    static constexpr int halo_tag = 0;
+
+    void* buffer(const uint32_t p, const bool cuda_aware)
+    {
+        return cuda_aware ? static_cast<void*>(m_attr->m_h_ptr_on_device[p]) :
+                            static_cast<void*>(m_attr->m_h_attr[p]);
+    }
+
+    int patch_bytes(const uint32_t p) const
+    {
+        return sizeof(T) * m_attr->capacity(p) * m_attr->get_num_attributes();
+    }
+
+    RXMeshDistributed*                     m_dist;
+    std::shared_ptr<Attribute<T, HandleT>> m_attr;
+};
+
+
+template <typename T, typename HandleT>
+inline std::shared_ptr<DistributedAttribute<T, HandleT>>
+RXMeshDistributed::add_attribute(const std::string& name,
+                                 uint32_t           num_attributes,
+                                 locationT          location,
+                                 layoutT            layout)
+{
+    return std::make_shared<DistributedAttribute<T, HandleT>>(
+        this, name, num_attributes, location, layout);
+}
+}  // namespace rxmesh
+
+#endif
@@ -1,3 +1,5 @@
+#include <algorithm>
+#include <limits>
 #include <numeric>
 
 #include <cooperative_groups.h>
@@ -139,9 +141,10 @@ __device__ __inline__ void hashtable_calibration(const Context context,
 }
 
 template <uint32_t blockThreads>
-__global__ static void hashtable_calibration(const Context context)
+__global__ static void hashtable_calibration(const Context   context,
+                                             const uint32_t* d_patches)
 {
-    const uint32_t pid = blockIdx.x;
+    const uint32_t pid = d_patches[blockIdx.x];
     if (pid >= context.m_num_patches[0]) {
         return;
     }
@@ -154,6 +157,9 @@ __global__ static void hashtable_calibration(const Context context)
     ShmemMutex patch_stash_mutex;
     patch_stash_mutex.alloc();
 
+    if (threadIdx.x == 0) {
+        context.bump_patch_version(pid);
+    }
 
     hashtable_calibration<blockThreads, VertexHandle>(
         context, pi, patch_stash_mutex);
@@ -423,11 +429,13 @@ __inline__ __device__ void remove_idle_elements(
 #endif
 }
 template <uint32_t blockThreads>
-__global__ static void remove_surplus_elements(Context context)
+__global__ static void remove_surplus_elements(Context         context,
+                                               const uint32_t* d_patches,
+                                               uint32_t*       d_num_owned)
 {
     auto block = cooperative_groups::this_thread_block();
 
-    const uint32_t pid = blockIdx.x;
+    const uint32_t pid = d_patches[blockIdx.x];
     if (pid >= context.m_num_patches[0]) {
         return;
     }
@@ -440,6 +448,10 @@ __global__ static void remove_surplus_elements(Context context)
 
     context.m_patches_info[pid].child_id = INVALID32;
 
+    if (threadIdx.x == 0) {
+        context.bump_patch_version(pid);
+    }
+
     const uint16_t num_vertices = pi.num_vertices[0];
     const uint16_t num_edges    = pi.num_edges[0];
     const uint16_t num_faces    = pi.num_faces[0];
@@ -536,7 +548,7 @@ __global__ static void remove_surplus_elements(Context context)
 
     __shared__ uint32_t s_patch_stash[PatchStash::stash_size];
     fill_n<blockThreads>(
-        s_patch_stash, uint16_t(LPHashTable::stash_size), INVALID32);
+        s_patch_stash, uint16_t(PatchStash::stash_size), INVALID32);
 
     block.sync();
     remove_idle_elements<blockThreads>(block,
@@ -602,9 +614,19 @@ __global__ static void remove_surplus_elements(Context context)
     block.sync();
 
     if (threadIdx.x == 0) {
-        ::atomicAdd(context.m_num_vertices, s_num_owned_vertices);
-        ::atomicAdd(context.m_num_edges, s_num_owned_edges);
-        ::atomicAdd(context.m_num_faces, s_num_owned_faces);
+        // only add the change in the number of owned elements since the
+        // previous cleanup since the total is not reset by an incremental
+        // cleanup (the unsigned wrap around takes care of negative change)
+        ::atomicAdd(context.m_num_vertices,
+                    s_num_owned_vertices - d_num_owned[3 * pid + 0]);
+        ::atomicAdd(context.m_num_edges,
+                    s_num_owned_edges - d_num_owned[3 * pid + 1]);
+        ::atomicAdd(context.m_num_faces,
+                    s_num_owned_faces - d_num_owned[3 * pid + 2]);
+
+        d_num_owned[3 * pid + 0] = s_num_owned_vertices;
+        d_num_owned[3 * pid + 1] = s_num_owned_edges;
+        d_num_owned[3 * pid + 2] = s_num_owned_faces;
 
         pi.num_vertices[0] = s_num_vertices;
         pi.num_edges[0]    = s_num_edges;
@@ -1532,9 +1554,21 @@ __global__ static void calc_num_elements(const Context context,
     for_each<Op::F, blockThreads>(context, sum_f);
 }
 
+__global__ static void check_num_elements(const Context       context,
+                                          const uint32_t*     d_sum,
+                                          ValidationCounters* d_check)
+{
+    if (d_sum[0] != context.m_num_vertices[0] ||
+        d_sum[1] != context.m_num_edges[0] ||
+        d_sum[2] != context.m_num_faces[0]) {
+        ::atomicAdd(
+            d_check->num_errors + uint32_t(ValidationCheck::NumElements), 1ull);
+    }
+}
+
 template <uint32_t blockThreads>
-__global__ static void check_uniqueness(const Context           context,
-                                        unsigned long long int* d_check)
+__global__ static void check_uniqueness(const Context       context,
+                                        ValidationCounters* d_check)
 {
     auto block = cooperative_groups::this_thread_block();
 
@@ -1583,13 +1617,13 @@ __global__ static void check_uniqueness(const Context           context,
                 if (v0 >= patch_info.num_vertices[0] ||
                     v1 >= patch_info.num_vertices[0] || v0 == v1) {
                     // printf("\n 1 unqiuness = %u", patch_id);
-                    ::atomicAdd(d_check, 1);
+                    d_check->report(ValidationCheck::Uniqueness, patch_id);
                 }
 
                 if (patch_info.is_deleted(LocalVertexT(v0)) ||
                     patch_info.is_deleted(LocalVertexT(v1))) {
                     // printf("\n 2 unqiuness = %u", patch_id);
-                    ::atomicAdd(d_check, 1);
+                    d_check->report(ValidationCheck::Uniqueness, patch_id);
                 }
             }
         }
@@ -1613,14 +1647,14 @@ __global__ static void check_uniqueness(const Context           context,
                     e2 >= patch_info.num_edges[0] || e0 == e1 || e0 == e2 ||
                     e1 == e2) {
                     // printf("\n 3 unqiuness = %u", patch_id);
-                    ::atomicAdd(d_check, 1);
+                    d_check->report(ValidationCheck::Uniqueness, patch_id);
                 }
 
                 if (patch_info.is_deleted(LocalEdgeT(e0)) ||
                     patch_info.is_deleted(LocalEdgeT(e1)) ||
                     patch_info.is_deleted(LocalEdgeT(e2))) {
                     // printf("\n 4 unqiuness = %u, f= %u", patch_id, f);
-                    ::atomicAdd(d_check, 1);
+                    d_check->report(ValidationCheck::Uniqueness, patch_id);
                 }
 
                 uint16_t v0, v1, v2;
@@ -1634,14 +1668,14 @@ __global__ static void check_uniqueness(const Context           context,
                     v2 >= patch_info.num_vertices[0] || v0 == v1 || v0 == v2 ||
                     v1 == v2) {
                     // printf("\n 5 unqiuness = %u", patch_id);
-                    ::atomicAdd(d_check, 1);
+                    d_check->report(ValidationCheck::Uniqueness, patch_id);
                 }
 
                 if (patch_info.is_deleted(LocalVertexT(v0)) ||
                     patch_info.is_deleted(LocalVertexT(v1)) ||
                     patch_info.is_deleted(LocalVertexT(v2))) {
                     // printf("\n 6 unqiuness = %u, f=%u", patch_id, f);
-                    ::atomicAdd(d_check, 1);
+                    d_check->report(ValidationCheck::Uniqueness, patch_id);
                 }
             }
         }
@@ -1650,8 +1684,8 @@ __global__ static void check_uniqueness(const Context           context,
 
 
 template <uint32_t blockThreads>
-__global__ static void check_not_owned(const Context           context,
-                                       unsigned long long int* d_check)
+__global__ static void check_not_owned(const Context       context,
+                                       ValidationCounters* d_check)
 {
     auto block = cooperative_groups::this_thread_block();
 
@@ -1728,7 +1762,7 @@ __global__ static void check_not_owned(const Context           context,
                 if (!owner_patch_info.is_owned(
                         LocalFaceT(f_owned.local_id()))) {
                     // printf("\n 1 owned = %u", patch_id);
-                    ::atomicAdd(d_check, 1);
+                    d_check->report(ValidationCheck::NotOwned, patch_id);
                 }
 
                 // If a face is deleted, it should also be deleted in the other
@@ -1736,7 +1770,7 @@ __global__ static void check_not_owned(const Context           context,
                 if (owner_patch_info.is_deleted(
                         LocalFaceT(f_owned.local_id()))) {
                     // printf("\n 2 owned = %u", patch_id);
-                    ::atomicAdd(d_check, 1);
+                    d_check->report(ValidationCheck::NotOwned, patch_id);
                 } else {
                     uint16_t ew0, ew1, ew2;
                     flag_t   dw0(0), dw1(0), dw2(0);
@@ -1803,12 +1837,12 @@ __global__ static void check_not_owned(const Context           context,
                                 pw2,
                                 ew2);
                         }*/
-                        ::atomicAdd(d_check, 1);
+                        d_check->report(ValidationCheck::NotOwned, patch_id);
                     }
 
                     if (d0 != dw0 || d1 != dw1 || d2 != dw2) {
                         // printf("\n 4 owned = %u", patch_id);
-                        ::atomicAdd(d_check, 1);
+                        d_check->report(ValidationCheck::NotOwned, patch_id);
                     }
                 }
             }
@@ -1851,7 +1885,7 @@ __global__ static void check_not_owned(const Context           context,
                 if (!owner_patch_info.is_owned(
                         LocalEdgeT(e_owned.local_id()))) {
                     // printf("\n 5 owned = %u", patch_id);
-                    ::atomicAdd(d_check, 1);
+                    d_check->report(ValidationCheck::NotOwned, patch_id);
                 }
 
                 // If an edge is deleted, it should also be deleted in the other
@@ -1859,7 +1893,7 @@ __global__ static void check_not_owned(const Context           context,
                 if (owner_patch_info.is_deleted(
                         LocalEdgeT(e_owned.local_id()))) {
                     // printf("\n 6 owned = %u", patch_id);
-                    ::atomicAdd(d_check, 1);
+                    d_check->report(ValidationCheck::NotOwned, patch_id);
                 } else {
 
                     auto [vw0, vw1] =
@@ -1891,7 +1925,7 @@ __global__ static void check_not_owned(const Context           context,
                             vw1,
                             pw1,
                             owner_patch_info.ev[2 * e_owned.local_id() + 1].id);
-                        ::atomicAdd(d_check, 1);
+                        d_check->report(ValidationCheck::NotOwned, patch_id);
                     }*/
                 }
             }
@@ -1901,8 +1935,8 @@ __global__ static void check_not_owned(const Context           context,
 
 
 template <uint32_t blockThreads>
-__global__ static void check_ribbon_edges(const Context           context,
-                                          unsigned long long int* d_check)
+__global__ static void check_ribbon_edges(const Context       context,
+                                          ValidationCounters* d_check)
 {
     auto block = cooperative_groups::this_thread_block();
 
@@ -1971,7 +2005,7 @@ __global__ static void check_ribbon_edges(const Context           context,
                     //        e,
                     //        patch_info.ev[2 * e + 0].id,
                     //        patch_info.ev[2 * e + 1].id);
-                    ::atomicAdd(d_check, 1);
+                    d_check->report(ValidationCheck::RibbonEdges, patch_id);
                 }
             }
         }
@@ -2019,7 +2053,7 @@ __global__ static void compute_max_valence(const Context context,
 template <uint32_t blockThreads>
 __global__ static void check_ribbon_faces(const Context               context,
                                           VertexAttribute<FaceHandle> global_vf,
-                                          unsigned long long int*     d_check)
+                                          ValidationCounters*         d_check)
 {
     auto block = cooperative_groups::this_thread_block();
 
@@ -2150,7 +2184,8 @@ __global__ static void check_ribbon_faces(const Context               context,
                                 //     vh.local_id(),
                                 //     s_vf_offset[v_id],
                                 //     s_vf_offset[v_id + 1]);
-                                ::atomicAdd(d_check, 1);
+                                d_check->report(ValidationCheck::RibbonFaces,
+                                                patch_id);
                                 break;
                             }
                         }
@@ -2162,6 +2197,110 @@ __global__ static void check_ribbon_faces(const Context               context,
 }
 
 
+template <typename HandleT>
+__device__ __inline__ void check_hashtable_element(
+    const Context&      context,
+    const PatchInfo&    patch_info,
+    const uint16_t      local_id,
+    ValidationCounters* d_check)
+{
+    using LocalT = typename HandleT::LocalT;
+
+    const uint32_t patch_id = patch_info.patch_id;
+
+    const LocalT lid(local_id);
+    if (patch_info.is_deleted(lid) || patch_info.is_owned(lid)) {
+        return;
+    }
+
+    const HandleT h = patch_info.find<HandleT>(local_id);
+
+    if (!h.is_valid() || h.patch_id() == patch_id ||
+        h.patch_id() >= context.m_num_patches[0]) {
+        d_check->report(ValidationCheck::Hashtable, patch_id);
+        return;
+    }
+
+    const PatchInfo& owner_info = context.m_patches_info[h.patch_id()];
+
+    if (owner_info.is_deleted(LocalT(h.local_id())) ||
+        !owner_info.is_owned(LocalT(h.local_id()))) {
+        d_check->report(ValidationCheck::Hashtable, patch_id);
+    }
+}
+
+template <uint32_t blockThreads>
+__global__ static void check_hashtable(const Context       context,
+                                       ValidationCounters* d_check)
+{
+    // Every mesh element in the hash table of a patch should be mapped to an
+    // owner that lives in a different patch. Otherwise, the mesh element is
+    // actually duplicated. We also check that the owner patch has the mesh
+    // element as owned and not deleted
+    if (blockIdx.x < context.m_num_patches[0]) {
+        const PatchInfo patch_info = context.m_patches_info[blockIdx.x];
+
+        if (patch_info.patch_id == INVALID32) {
+            return;
+        }
+
+        for (uint16_t v = threadIdx.x; v < patch_info.num_vertices[0];
+             v += blockThreads) {
+            check_hashtable_element<VertexHandle>(
+                context, patch_info, v, d_check);
+        }
+
+        for (uint16_t e = threadIdx.x; e < patch_info.num_edges[0];
+             e += blockThreads) {
+            check_hashtable_element<EdgeHandle>(
+                context, patch_info, e, d_check);
+        }
+
+        for (uint16_t f = threadIdx.x; f < patch_info.num_faces[0];
+             f += blockThreads) {
+            check_hashtable_element<FaceHandle>(
+                context, patch_info, f, d_check);
+        }
+    }
+}
+
+__global__ static void check_patch_stash(const Context       context,
+                                         const bool          check_inclusion,
+                                         ValidationCounters* d_check)
+{
+    // one thread per patch stash slot
+    if (blockIdx.x >= context.m_num_patches[0] ||
+        threadIdx.x >= PatchStash::stash_size) {
+        return;
+    }
+
+    const uint32_t   p     = blockIdx.x;
+    const PatchStash stash = context.m_patches_info[p].patch_stash;
+    const uint8_t    p_sh  = threadIdx.x;
+
+    const uint32_t q = stash.get_patch(p_sh);
+    if (q == INVALID32) {
+        return;
+    }
+
+    // check that a patch is only encountered once in patch stash
+    for (uint8_t pp_sh = 0; pp_sh < PatchStash::stash_size; ++pp_sh) {
+        if (pp_sh != p_sh && stash.get_patch(pp_sh) == q) {
+            d_check->report(ValidationCheck::UniquePatchStash, p);
+            break;
+        }
+    }
+
+    // check if a patch p has q in its patch stash, then q also has p in its
+    // patch stash
+    if (check_inclusion) {
+        const PatchStash q_stash = context.m_patches_info[q].patch_stash;
+        if (q_stash.find_patch_index(p) == INVALID8) {
+            d_check->report(ValidationCheck::PatchStashInclusion, p);
+        }
+    }
+}
+
 __global__ static void reset(uint32_t* v,
                              uint32_t* e,
                              uint32_t* f,
@@ -2177,6 +2316,441 @@ __global__ static void reset(uint32_t* v,
     max_f[0] = 0;
 }
 
+/**
+ * @brief flag the patches that need to be cleaned up i.e., dirty patches,
+ * patches that were sliced, and the new patches created by slicing them. If
+ * full is true, all patches are flagged
+ */
+__global__ static void flag_cleanup_patches(const Context context,
+                                            uint32_t*     d_flags,
+                                            const bool    full)
+{
+    const uint32_t pid = threadIdx.x + blockIdx.x * blockDim.x;
+    if (pid >= context.m_num_patches[0]) {
+        return;
+    }
+
+    const PatchInfo& pi = context.m_patches_info[pid];
+    if (pi.patch_id == INVALID32) {
+        return;
+    }
+
+    if (full || pi.is_dirty() || pi.child_id != INVALID32) {
+        d_flags[pid] = 1;
+        if (pi.child_id != INVALID32) {
+            d_flags[pi.child_id] = 1;
+        }
+    }
+}
+
+/**
+ * @brief build the list of patches whose surplus elements should be removed
+ * (the flagged patches) and the list of patches whose hashtables should be
+ * calibrated (the flagged patches and the patches that have a flagged patch in
+ * their patch stash since the owner of their not-owned elements may have
+ * changed). d_num_patches[0] and d_num_patches[1] are the size of the two
+ * lists respectively
+ */
+__global__ static void build_cleanup_lists(const Context   context,
+                                           const uint32_t* d_flags,
+                                           uint32_t*       d_surplus_list,
+                                           uint32_t*       d_calibration_list,
+                                           uint32_t*       d_num_patches)
+{
+    const uint32_t pid = threadIdx.x + blockIdx.x * blockDim.x;
+    if (pid >= context.m_num_patches[0]) {
+        return;
+    }
+
+    const PatchInfo& pi = context.m_patches_info[pid];
+    if (pi.patch_id == INVALID32) {
+        return;
+    }
+
+    bool calibrate = d_flags[pid];
+
+    if (d_flags[pid]) {
+        d_surplus_list[::atomicAdd(d_num_patches, 1u)] = pid;
+    } else {
+        for (uint32_t i = 0; i < PatchStash::stash_size; ++i) {
+            const uint32_t q = pi.patch_stash.get_patch(i);
+            if (q != INVALID32 && d_flags[q]) {
+                calibrate = true;
+                break;
+            }
+        }
+    }
+
+    if (calibrate) {
+        d_calibration_list[::atomicAdd(d_num_patches + 1, 1u)] = pid;
+    }
+}
+
+/**
+ * @brief pair every underfull patch (less than max_num_owned_faces owned
+ * faces) with the neighbor patch with the fewest owned faces as its merge
+ * target. A patch is either merged or a merge target (but not both) and a
+ * patch is the target of at most one merge. This is ensured by the claims on
+ * the patches in d_claim. d_num_owned is the number of owned
+ * vertices/edges/faces per patch as computed by cleanup()
+ */
+__global__ static void select_merge_patches(const Context   context,
+                                            const uint32_t* d_num_owned,
+                                            const uint32_t  max_num_owned_faces,
+                                            uint32_t*       d_merge_target,
+                                            uint32_t*       d_claim,
+                                            uint32_t*       d_merge_slot,
+                                            uint32_t*       d_num_merges)
+{
+    const uint32_t q = threadIdx.x + blockIdx.x * blockDim.x;
+    if (q >= context.m_num_patches[0]) {
+        return;
+    }
+
+    const PatchInfo& qi = context.m_patches_info[q];
+    if (qi.patch_id == INVALID32 || qi.num_faces[0] == 0 ||
+        d_num_owned[3 * q + 2] >= max_num_owned_faces) {
+        return;
+    }
+
+    uint32_t p = INVALID32, p_num_faces = INVALID32;
+    for (uint8_t i = 0; i < PatchStash::stash_size; ++i) {
+        const uint32_t r = qi.patch_stash.get_patch(i);
+        if (r == INVALID32 || r == q) {
+            continue;
+        }
+        const PatchInfo& ri = context.m_patches_info[r];
+        if (ri.patch_id == INVALID32 || ri.num_faces[0] == 0) {
+            continue;
+        }
+        const uint32_t r_num_faces = d_num_owned[3 * r + 2];
+        if (r_num_faces < p_num_faces ||
+            (r_num_faces == p_num_faces && r < p)) {
+            p           = r;
+            p_num_faces = r_num_faces;
+        }
+    }
+
+    if (p == INVALID32) {
+        return;
+    }
+
+    if (::atomicCAS(d_claim + q, INVALID32, q) != INVALID32) {
+        return;
+    }
+
+    if (::atomicCAS(d_claim + p, INVALID32, q) != INVALID32) {
+        ::atomicExch(d_claim + q, INVALID32);
+        return;
+    }
+
+    d_merge_target[q] = p;
+    d_merge_slot[q]   = ::atomicAdd(d_num_merges, 1u);
+}
+
+template <uint32_t blockThreads, typename HandleT>
+__device__ __inline__ void redirect_merged_elements(
+    PatchInfo&      pi,
+    const uint32_t* d_merge_target,
+    const uint32_t* d_merge_slot,
+    const uint16_t* d_merge_map,
+    const uint32_t  stride,
+    const uint32_t  offset,
+    ShmemMutex&     patch_stash_mutex)
+{
+    using LocalT = typename HandleT::LocalT;
+
+    const uint16_t num_elements = *(pi.get_num_elements<HandleT>());
+
+    const uint16_t num_elements_up =
+        ROUND_UP_TO_NEXT_MULTIPLE(num_elements, blockThreads);
+
+    for (uint16_t i = threadIdx.x; i < num_elements_up; i += blockThreads) {
+        bool   replace = false;
+        LPPair lp;
+
+        if (i < num_elements && !pi.is_owned(LocalT(i)) &&
+            !pi.is_deleted(LocalT(i))) {
+            lp = pi.get_lp<HandleT>().find(i, nullptr, nullptr);
+            assert(!lp.is_sentinel());
+
+            const uint32_t owner = pi.patch_stash.get_patch(lp);
+            const uint32_t p     = d_merge_target[owner];
+
+            if (p != INVALID32) {
+                assert(p != pi.patch_id);
+                const uint16_t lid =
+                    d_merge_map[d_merge_slot[owner] * stride + offset +
+                                lp.local_id_in_owner_patch()];
+                assert(lid != INVALID16);
+
+                const uint8_t st =
+                    pi.patch_stash.insert_patch(p, patch_stash_mutex);
+                assert(st != INVALID8);
+
+                lp      = LPPair(i, lid, st);
+                replace = true;
+            }
+        }
+
+        __syncthreads();
+
+        if (replace) {
+            pi.get_lp<HandleT>().replace(lp);
+        }
+    }
+}
+
+/**
+ * @brief after merging, make the hashtables of the patches point to the patch
+ * that a merged patch was merged into. Launched with one block per patch
+ */
+template <uint32_t blockThreads>
+__global__ static void redirect_merged_patches(const Context   context,
+                                               const uint32_t* d_merge_target,
+                                               const uint32_t* d_merge_slot,
+                                               const uint16_t* d_merge_map,
+                                               const uint16_t  cap_v,
+                                               const uint16_t  cap_e,
+                                               const uint16_t  cap_f)
+{
+    const uint32_t pid = blockIdx.x;
+    if (pid >= context.m_num_patches[0]) {
+        return;
+    }
+
+    PatchInfo pi = context.m_patches_info[pid];
+    if (pi.patch_id == INVALID32 || d_merge_target[pid] != INVALID32) {
+        return;
+    }
+
+    bool has_merged_neighbor = false;
+    for (uint8_t i = 0; i < PatchStash::stash_size; ++i) {
+        const uint32_t q = pi.patch_stash.get_patch(i);
+        if (q != INVALID32 && d_merge_target[q] != INVALID32) {
+            has_merged_neighbor = true;
+            break;
+        }
+    }
+    if (!has_merged_neighbor) {
+        return;
+    }
+
+    ShmemMutex patch_stash_mutex;
+    patch_stash_mutex.alloc();
+
+    const uint32_t stride = uint32_t(cap_v) + cap_e + cap_f;
+
+    redirect_merged_elements<blockThreads, VertexHandle>(pi,
+                                                         d_merge_target,
+                                                         d_merge_slot,
+                                                         d_merge_map,
+                                                         stride,
+                                                         0,
+                                                         patch_stash_mutex);
+    redirect_merged_elements<blockThreads, EdgeHandle>(pi,
+                                                       d_merge_target,
+                                                       d_merge_slot,
+                                                       d_merge_map,
+                                                       stride,
+                                                       cap_v,
+                                                       patch_stash_mutex);
+    redirect_merged_elements<blockThreads, FaceHandle>(pi,
+                                                       d_merge_target,
+                                                       d_merge_slot,
+                                                       d_merge_map,
+                                                       stride,
+                                                       cap_v + cap_e,
+                                                       patch_stash_mutex);
+
+    if (threadIdx.x == 0) {
+        // so that cleanup() removes the merged patch from the patch stash
+        set_patch_dirty(context.m_patches_info[pid]);
+        context.bump_patch_version(pid);
+    }
+}
+
+
+/**
+ * @brief flag the patches that need a new color i.e., new patches, patches
+ * without a color, and patches that has the same color as one of their
+ * distance-2 neighbors with lower id
+ */
+__global__ static void flag_patch_color_conflicts(
+    const Context  context,
+    const uint32_t num_patches,
+    const uint32_t first_new_patch,
+    uint32_t*      d_flags)
+{
+    const uint32_t p = threadIdx.x + blockIdx.x * blockDim.x;
+    if (p >= num_patches) {
+        return;
+    }
+
+    const PatchInfo& pi = context.m_patches_info[p];
+
+    bool conflict = p >= first_new_patch || pi.color == INVALID32;
+
+    for (uint32_t i = 0; i < PatchStash::stash_size && !conflict; ++i) {
+        const uint32_t n = pi.patch_stash.get_patch(i);
+        if (n == INVALID32) {
+            continue;
+        }
+        const PatchInfo& ni = context.m_patches_info[n];
+        if (n < p && ni.color == pi.color) {
+            conflict = true;
+        }
+        for (uint32_t j = 0; j < PatchStash::stash_size && !conflict; ++j) {
+            const uint32_t nn = ni.patch_stash.get_patch(j);
+            if (nn != INVALID32 && nn < p &&
+                context.m_patches_info[nn].color == pi.color) {
+                conflict = true;
+            }
+        }
+    }
+
+    d_flags[p] = conflict;
+}
+
+/**
+ * @brief assign the min color not used by the distance-2 neighbors to the
+ * flagged patches. This is done by a single thread so the recolored patches
+ * see the new colors of each other
+ */
+__global__ static void recolor_patches(const Context   context,
+                                       const uint32_t  num_patches,
+                                       const uint32_t* d_flags,
+                                       uint32_t*       d_num_colors)
+{
+    constexpr uint32_t max_colors = 256;
+
+    if (threadIdx.x != 0 || blockIdx.x != 0) {
+        return;
+    }
+
+    for (uint32_t p = 0; p < num_patches; ++p) {
+        if (!d_flags[p]) {
+            continue;
+        }
+        PatchInfo& pi = context.m_patches_info[p];
+
+        uint32_t used[max_colors / 32];
+        for (uint32_t i = 0; i < max_colors / 32; ++i) {
+            used[i] = 0;
+        }
+
+        auto mark = [&](const uint32_t q) {
+            const uint32_t c = context.m_patches_info[q].color;
+            if (c < max_colors) {
+                used[c / 32] |= (1u << (c % 32));
+            }
+        };
+
+        for (uint32_t i = 0; i < PatchStash::stash_size; ++i) {
+            const uint32_t n = pi.patch_stash.get_patch(i);
+            if (n == INVALID32) {
+                continue;
+            }
+            mark(n);
+            const PatchInfo& ni = context.m_patches_info[n];
+            for (uint32_t j = 0; j < PatchStash::stash_size; ++j) {
+                const uint32_t nn = ni.patch_stash.get_patch(j);
+                if (nn != INVALID32 && nn != p) {
+                    mark(nn);
+                }
+            }
+        }
+
+        uint32_t color = 0;
+        while (color < max_colors &&
+               (used[color / 32] & (1u << (color % 32)))) {
+            color++;
+        }
+        assert(color < max_colors);
+
+        pi.color        = color;
+        d_num_colors[0] = max(d_num_colors[0], color + 1);
+    }
+}
+
+__global__ static void get_patch_colors(const Context  context,
+                                        const uint32_t num_patches,
+                                        uint32_t*      d_colors)
+{
+    const uint32_t p = threadIdx.x + blockIdx.x * blockDim.x;
+    if (p < num_patches) {
+        d_colors[p] = context.m_patches_info[p].color;
+    }
+}
+
+/**
+ * @brief pop all patches from the queue and defer the ones with the given
+ * color so they can be moved back to queue with requeue_deferred_patches()
+ */
+__global__ static void defer_patches_of_color(Context        context,
+                                              const uint32_t color)
+{
+    if (threadIdx.x != 0 || blockIdx.x != 0) {
+        return;
+    }
+
+    uint32_t pid;
+    while ((pid = context.m_patch_scheduler.pop()) != INVALID32) {
+        if (context.m_patches_info[pid].color == color) {
+            context.m_patch_scheduler.defer(pid);
+        }
+    }
+}
+
+/**
+ * @brief list the patches flagged to be sliced i.e., the patches that ran out
+ * of capacity and could be grown instead. d_num_patches is the size of the
+ * list
+ */
+__global__ static void list_should_slice_patches(const Context context,
+                                                 uint32_t*     d_list,
+                                                 uint32_t*     d_num_patches)
+{
+    const uint32_t pid = threadIdx.x + blockIdx.x * blockDim.x;
+    if (pid >= context.m_num_patches[0]) {
+        return;
+    }
+
+    const PatchInfo& pi = context.m_patches_info[pid];
+    if (pi.patch_id != INVALID32 && pi.should_slice) {
+        d_list[::atomicAdd(d_num_patches, 1u)] = pid;
+    }
+}
+
+/**
+ * @brief re-insert the entries of the old hashtables of the resized patches
+ * into their new (empty) hashtables. d_old_lp stores the old v/e/f hashtables
+ * of the i-th patch in d_patches at 3*i, 3*i+1, 3*i+2
+ */
+template <uint32_t blockThreads>
+__global__ static void rehash_resized_patches(const Context      context,
+                                              const uint32_t*    d_patches,
+                                              const LPHashTable* d_old_lp)
+{
+    const PatchInfo& pi = context.m_patches_info[d_patches[blockIdx.x]];
+
+    auto rehash = [&](const LPHashTable& old_lp, LPHashTable new_lp) {
+        const uint32_t cap = old_lp.get_capacity();
+        for (uint32_t i = threadIdx.x; i < cap + LPHashTable::stash_size;
+             i += blockThreads) {
+            const LPPair pair =
+                (i < cap) ? old_lp.m_table[i] : old_lp.m_stash[i - cap];
+            if (!pair.is_sentinel()) {
+                bool inserted = new_lp.insert(pair, nullptr, nullptr);
+                assert(inserted);
+            }
+        }
+    };
+
+    rehash(d_old_lp[3 * blockIdx.x + 0], pi.lp_v);
+    rehash(d_old_lp[3 * blockIdx.x + 1], pi.lp_e);
+    rehash(d_old_lp[3 * blockIdx.x + 2], pi.lp_f);
+}
 }  // namespace detail
 
 
@@ -2286,77 +2860,56 @@ void RXMeshDynamic::save(std::string filename)
 
 
 bool RXMeshDynamic::validate()
+{
+    ValidationReport report;
+    return validate(report);
+}
+
+bool RXMeshDynamic::validate(ValidationReport& report)
 {
     CUDA_ERROR(cudaDeviceSynchronize());
     RXMESH_TRACE("RXMeshDynamic validation started");
 
-    unsigned long long int* d_check;
-    CUDA_ERROR(cudaMalloc((void**)&d_check, sizeof(unsigned long long int)));
+    detail::ValidationCounters* d_check;
+    CUDA_ERROR(tracked_malloc((void**)&d_check,
+                              sizeof(detail::ValidationCounters),
+                              MemoryCategory::Topology));
+
+    report.counters.reset();
+    CUDA_ERROR(cudaMemcpy(d_check,
+                          &report.counters,
+                          sizeof(detail::ValidationCounters),
+                          cudaMemcpyHostToDevice));
 
-    auto is_okay = [&]() {
-        unsigned long long int h_check(0);
-        CUDA_ERROR(cudaMemcpy(&h_check,
+    auto read_report = [&]() {
+        CUDA_ERROR(cudaMemcpy(&report.counters,
                               d_check,
-                              sizeof(unsigned long long int),
+                              sizeof(detail::ValidationCounters),
                               cudaMemcpyDeviceToHost));
-        if (h_check != 0) {
-            return false;
-        } else {
-            return true;
-        }
     };
 
+    const uint32_t grid_size = get_max_num_patches();
+
     // check that the sum of owned vertices, edges, and faces per patch is equal
     // to the number of vertices, edges, and faces respectively
-    auto check_num_mesh_elements = [&]() -> bool {
-        uint32_t *d_sum_num_vertices, *d_sum_num_edges, *d_sum_num_faces;
-        thrust::device_vector<uint32_t> d_sum_vertices(1, 0);
-        thrust::device_vector<uint32_t> d_sum_edges(1, 0);
-        thrust::device_vector<uint32_t> d_sum_faces(1, 0);
-
+    thrust::device_vector<uint32_t> d_sum(3, 0);
+    {
         constexpr uint32_t block_size = 256;
-        const uint32_t     grid_size  = get_max_num_patches();
 
         detail::calc_num_elements<block_size>
             <<<grid_size, block_size>>>(m_rxmesh_context,
-                                        d_sum_vertices.data().get(),
-                                        d_sum_edges.data().get(),
-                                        d_sum_faces.data().get());
-        CUDA_ERROR(cudaDeviceSynchronize());
+                                        d_sum.data().get() + 0,
+                                        d_sum.data().get() + 1,
+                                        d_sum.data().get() + 2);
 
-        uint32_t num_vertices, num_edges, num_faces;
-        CUDA_ERROR(cudaMemcpy(&num_vertices,
-                              m_rxmesh_context.m_num_vertices,
-                              sizeof(uint32_t),
-                              cudaMemcpyDeviceToHost));
-        CUDA_ERROR(cudaMemcpy(&num_edges,
-                              m_rxmesh_context.m_num_edges,
-                              sizeof(uint32_t),
-                              cudaMemcpyDeviceToHost));
-        CUDA_ERROR(cudaMemcpy(&num_faces,
-                              m_rxmesh_context.m_num_faces,
-                              sizeof(uint32_t),
-                              cudaMemcpyDeviceToHost));
-        uint32_t sum_num_vertices, sum_num_edges, sum_num_faces;
-        thrust::copy(
-            d_sum_vertices.begin(), d_sum_vertices.end(), &sum_num_vertices);
-        thrust::copy(d_sum_edges.begin(), d_sum_edges.end(), &sum_num_edges);
-        thrust::copy(d_sum_faces.begin(), d_sum_faces.end(), &sum_num_faces);
-
-        if (num_vertices != sum_num_vertices || num_edges != sum_num_edges ||
-            num_faces != sum_num_faces) {
-            return false;
-        } else {
-            return true;
-        }
-    };
+        detail::check_num_elements<<<1, 1>>>(
+            m_rxmesh_context, d_sum.data().get(), d_check);
+    }
 
     // check that each edge is composed of two unique vertices and each face is
     // composed of three unique edges that give three unique vertices.
-    auto check_uniqueness = [&]() -> bool {
-        CUDA_ERROR(cudaMemset(d_check, 0, sizeof(unsigned long long int)));
+    {
         constexpr uint32_t block_size = 256;
-        const uint32_t     grid_size  = get_max_num_patches();
         const uint32_t     dynamic_smem =
             rxmesh::ShmemAllocator::default_alignment * 2 +
             (3 * get_per_patch_max_face_capacity()) * sizeof(uint16_t) +
@@ -2365,20 +2918,13 @@ bool RXMeshDynamic::validate()
         detail::check_uniqueness<block_size>
             <<<grid_size, block_size, dynamic_smem>>>(m_rxmesh_context,
                                                       d_check);
-        CUDA_ERROR(cudaDeviceSynchronize());
-
-        return is_okay();
-    };
+    }
 
     // check that every not-owned mesh elements' connectivity (faces and
     // edges) is equivalent to their connectivity in their owner patch.
     // if the mesh element is deleted in the owner patch, no check is done
-    auto check_not_owned = [&]() -> bool {
-        CUDA_ERROR(cudaMemset(d_check, 0, sizeof(unsigned long long int)));
-        CUDA_ERROR(cudaMemset(d_check, 0, sizeof(unsigned long long int)));
-
+    {
         constexpr uint32_t block_size = 256;
-        const uint32_t     grid_size  = get_max_num_patches();
         const uint32_t     dynamic_smem =
             ShmemAllocator::default_alignment * 2 +
             (3 * get_per_patch_max_face_capacity()) * sizeof(uint16_t) +
@@ -2387,19 +2933,12 @@ bool RXMeshDynamic::validate()
         detail::check_not_owned<block_size>
             <<<grid_size, block_size, dynamic_smem>>>(m_rxmesh_context,
                                                       d_check);
-        CUDA_ERROR(cudaDeviceSynchronize());
-
-        return is_okay();
-    };
+    }
 
-    // check if the ribbon construction is complete i.e., 1) each owned edge is
-    // incident to an owned face, and 2) VF of the three vertices of an owned
-    // face is inside the patch
-    auto check_ribbon = [&]() {
-        CUDA_ERROR(cudaMemset(d_check, 0, sizeof(unsigned long long int)));
+    // check that each owned edge is incident to an owned face
+    {
         constexpr uint32_t block_size = 512;
-        const uint32_t     grid_size  = get_max_num_patches();
-        uint32_t           dynamic_smem =
+        const uint32_t     dynamic_smem =
             ShmemAllocator::default_alignment * 3 +
             (3 * get_per_patch_max_face_capacity()) * sizeof(uint16_t) +
             get_per_patch_max_edge_capacity() * sizeof(uint16_t);
@@ -2407,17 +2946,32 @@ bool RXMeshDynamic::validate()
         detail::check_ribbon_edges<block_size>
             <<<grid_size, block_size, dynamic_smem>>>(m_rxmesh_context,
                                                       d_check);
-        CUDA_ERROR(cudaDeviceSynchronize());
+    }
 
-        if (!is_okay()) {
-            RXMESH_WARN("RXMeshDynamic::validate() check_ribbon_edges failed");
-            return false;
-            // CUDA_ERROR(cudaMemset(d_check, 0, sizeof(unsigned long long
-            // int)));
-        }
+    // check the not-owned elements in the hashtables against their owner
+    // patches
+    {
+        constexpr uint32_t block_size = 256;
+        detail::check_hashtable<block_size>
+            <<<grid_size, block_size>>>(m_rxmesh_context, d_check);
+    }
+
+    // check the patch stash. The inclusion check is currently disabled
+    detail::check_patch_stash<<<grid_size, PatchStash::stash_size>>>(
+        m_rxmesh_context, false, d_check);
+
+    CUDA_ERROR(cudaDeviceSynchronize());
+    read_report();
+
+    // check that VF of the three vertices of an owned face is inside the
+    // patch. This requires the ribbon edges to be valid
+    if (report.is_valid(ValidationCheck::RibbonEdges)) {
+        constexpr uint32_t block_size = 512;
 
         uint32_t* d_max_valence;
-        CUDA_ERROR(cudaMalloc((void**)&d_max_valence, sizeof(uint32_t)));
+        CUDA_ERROR(tracked_malloc((void**)&d_max_valence,
+                                  sizeof(uint32_t),
+                                  MemoryCategory::Topology));
         CUDA_ERROR(cudaMemset(d_max_valence, 0, sizeof(uint32_t)));
 
         LaunchBox<block_size> launch_box;
@@ -2450,15 +3004,15 @@ bool RXMeshDynamic::validate()
         detail::compute_vf<block_size>
             <<<launch_box.blocks, block_size, launch_box.smem_bytes_dyn>>>(
                 m_rxmesh_context, *vf_global);
-        CUDA_ERROR(cudaDeviceSynchronize());
 
-        dynamic_smem = ShmemAllocator::default_alignment * 3 +
-                       (3 * get_per_patch_max_face_capacity() +
-                        std::max(3 * get_per_patch_max_face_capacity(),
-                                 1 + get_per_patch_max_vertex_capacity()) +
-                        std::max(3 * get_per_patch_max_face_capacity(),
-                                 2 * get_per_patch_max_edge_capacity())) *
-                           sizeof(uint16_t);
+        const uint32_t dynamic_smem =
+            ShmemAllocator::default_alignment * 3 +
+            (3 * get_per_patch_max_face_capacity() +
+             std::max(3 * get_per_patch_max_face_capacity(),
+                      1 + get_per_patch_max_vertex_capacity()) +
+             std::max(3 * get_per_patch_max_face_capacity(),
+                      2 * get_per_patch_max_edge_capacity())) *
+                sizeof(uint16_t);
 
         detail::check_ribbon_faces<block_size>
             <<<grid_size, block_size, dynamic_smem>>>(
@@ -2466,194 +3020,18 @@ bool RXMeshDynamic::validate()
 
         CUDA_ERROR(cudaDeviceSynchronize());
         remove_attribute("vf");
-        return is_okay();
-    };
-
-
-    // Every mesh element in the hash table of a patch should be mapped to an
-    // owner that lives in a different patch. Otherwise, the mesh element is
-    // actually duplicated. We check on this here. We also check that when we
-    // query the hashtable for a (not-owned) mesh element, what we get is a mesh
-    // element that is owned by the owner patch
-    auto check_hashtable = [&]() {
-        for (uint32_t p = 0; p < get_num_patches(); ++p) {
-            PatchInfo pi = m_h_patches_info[p];
-
-            for (uint32_t v = 0; v < pi.num_vertices[0]; v++) {
-                const LocalVertexT vl(v);
-                if (!pi.is_deleted(vl) && !pi.is_owned(vl)) {
-                    const VertexHandle vh = pi.find<VertexHandle>(v);
-                    if (!vh.is_valid()) {
-                        return false;
-                    }
-                    if (vh.patch_id() == p) {
-                        return false;
-                    }
-                    if (vh.patch_id() > get_num_patches()) {
-                        return false;
-                    }
-                    if (m_h_patches_info[vh.patch_id()].is_deleted(
-                            LocalVertexT(vh.local_id()))) {
-                        return false;
-                    }
-                    if (!m_h_patches_info[vh.patch_id()].is_owned(
-                            LocalVertexT(vh.local_id()))) {
-                        return false;
-                    }
-                }
-            }
-
-
-            for (uint32_t e = 0; e < pi.num_edges[0]; e++) {
-                const LocalEdgeT el(e);
-                if (!pi.is_deleted(el) && !pi.is_owned(el)) {
-                    const EdgeHandle eh = pi.find<EdgeHandle>(e);
-                    if (!eh.is_valid()) {
-                        return false;
-                    }
-                    if (eh.patch_id() == p) {
-                        return false;
-                    }
-                    if (eh.patch_id() > get_num_patches()) {
-                        return false;
-                    }
-                    if (m_h_patches_info[eh.patch_id()].is_deleted(
-                            LocalEdgeT(eh.local_id()))) {
-                        return false;
-                    }
-                    if (!m_h_patches_info[eh.patch_id()].is_owned(
-                            LocalEdgeT(eh.local_id()))) {
-                        return false;
-                    }
-                }
-            }
-
-
-            for (uint32_t f = 0; f < pi.num_faces[0]; f++) {
-                const LocalFaceT fl(f);
-                if (!pi.is_deleted(fl) && !pi.is_owned(fl)) {
-                    const FaceHandle fh = pi.find<FaceHandle>(f);
-                    if (!fh.is_valid()) {
-                        return false;
-                    }
-                    if (fh.patch_id() == p) {
-                        return false;
-                    }
-                    if (fh.patch_id() > get_num_patches()) {
-                        return false;
-                    }
-                    if (m_h_patches_info[fh.patch_id()].is_deleted(
-                            LocalFaceT(fh.local_id()))) {
-                        return false;
-                    }
-                    if (!m_h_patches_info[fh.patch_id()].is_owned(
-                            LocalFaceT(fh.local_id()))) {
-                        return false;
-                    }
-                }
-            }
-        }
-
-        return true;
-    };
-
-    // check if a patch p has q in its patch stash, then q also has p in its
-    // patch stash
-    auto patch_stash_inclusion = [&]() {
-        for (uint32_t p = 0; p < get_num_patches(); ++p) {
-            for (uint8_t p_sh = 0; p_sh < PatchStash::stash_size; ++p_sh) {
-                uint32_t q = m_h_patches_info[p].patch_stash.get_patch(p_sh);
-                if (q != INVALID32) {
-                    bool found = false;
-                    for (uint8_t q_sh = 0; q_sh < PatchStash::stash_size;
-                         ++q_sh) {
-                        if (m_h_patches_info[q].patch_stash.get_patch(q_sh) ==
-                            p) {
-                            found = true;
-                            break;
-                        }
-                    }
-                    if (!found) {
-                        return false;
-                    }
-                }
-            }
-        }
-        return true;
-    };
-
-    // check that a patch is only encountered once in patch stash
-    auto unique_patch_stash = [&]() {
-        for (uint32_t p = 0; p < get_num_patches(); ++p) {
-            for (uint8_t p_sh = 0; p_sh < PatchStash::stash_size; ++p_sh) {
-                uint32_t q = m_h_patches_info[p].patch_stash.get_patch(p_sh);
-                if (q != INVALID32) {
-                    bool duplicated = false;
-
-                    for (uint8_t pp_sh = 0; pp_sh < PatchStash::stash_size;
-                         ++pp_sh) {
-                        if (pp_sh == p_sh) {
-                            continue;
-                        }
-                        if (m_h_patches_info[p].patch_stash.get_patch(pp_sh) ==
-                            q) {
-                            duplicated = true;
-                            break;
-                        }
-                    }
-                    if (duplicated) {
-                        return false;
-                    }
-                }
-            }
-        }
-        return true;
-    };
-
-    bool success = true;
-    if (!check_num_mesh_elements()) {
-        RXMESH_ERROR(
-            "RXMeshDynamic::validate() check_num_mesh_elements failed");
-        success = false;
+        read_report();
     }
 
-    if (!check_hashtable()) {
-        RXMESH_ERROR("RXMeshDynamic::validate() check_hashtable failed");
-        success = false;
-    }
+    CUDA_ERROR(tracked_free(d_check));
 
-    if (!check_uniqueness()) {
-        RXMESH_ERROR("RXMeshDynamic::validate() check_uniqueness failed");
-        success = false;
-    }
-
-    if (!check_not_owned()) {
-        RXMESH_ERROR("RXMeshDynamic::validate() check_not_owned failed");
-        success = false;
-    }
-
-    if (!check_ribbon()) {
-        RXMESH_ERROR("RXMeshDynamic::validate() check_ribbon failed");
-        success = false;
-    }
-
-    /*if (!patch_stash_inclusion()) {
-        RXMESH_ERROR("RXMeshDynamic::validate() patch_stash_inclusion failed");
-        success = false;
-    }*/
-
-    if (!unique_patch_stash()) {
-        RXMESH_ERROR("RXMeshDynamic::validate() unique_patch_stash failed");
-        success = false;
-    }
-
-    CUDA_ERROR(cudaFree(d_check));
+    report.print();
 
     RXMESH_TRACE("RXMeshDynamic validation finished");
-    return success;
+    return report.is_valid();
 }
 
-void RXMeshDynamic::cleanup()
+void RXMeshDynamic::cleanup(const bool full)
 {
     // CUDA_ERROR(cudaMemcpy(&m_num_patches,
     //                       m_rxmesh_context.m_num_patches,
@@ -2661,7 +3039,27 @@ void RXMeshDynamic::cleanup()
     //                       cudaMemcpyDeviceToHost));
 
     constexpr uint32_t block_size = 256;
-    const uint32_t     grid_size  = get_max_num_patches();
+    const uint32_t     max_p      = get_max_num_patches();
+
+    // grow the patches that ran out of capacity before they get sliced
+    m_num_grown_patches = m_adaptive_capacity ? grow_patches() : 0;
+
+    // flags, two lists, the number of owned vertices/edges/faces per patch,
+    // and the size of the two lists
+    const bool is_full = full || m_d_cleanup_buffer == nullptr;
+    if (m_d_cleanup_buffer == nullptr) {
+        CUDA_ERROR(tracked_malloc((void**)&m_d_cleanup_buffer,
+                                  (6 * max_p + 2) * sizeof(uint32_t),
+                                  MemoryCategory::Topology));
+    }
+    uint32_t* d_flags            = m_d_cleanup_buffer;
+    uint32_t* d_surplus_list     = d_flags + max_p;
+    uint32_t* d_calibration_list = d_surplus_list + max_p;
+    uint32_t* d_num_owned        = d_calibration_list + max_p;
+    uint32_t* d_num_patches      = d_num_owned + 3 * max_p;
+
+    CUDA_ERROR(cudaMemset(d_flags, 0, max_p * sizeof(uint32_t)));
+    CUDA_ERROR(cudaMemset(d_num_patches, 0, 2 * sizeof(uint32_t)));
 
     // CUDA_ERROR(cudaMemcpy(&this->m_max_vertices_per_patch,
     //                       this->m_rxmesh_context.m_max_num_vertices,
@@ -2692,12 +3090,40 @@ void RXMeshDynamic::cleanup()
     // CUDA_ERROR(
     //     cudaMemset(m_rxmesh_context.m_max_num_faces, 0, sizeof(uint32_t)));
 
-    detail::reset<<<1, 1>>>(m_rxmesh_context.m_num_vertices,
-                            m_rxmesh_context.m_num_edges,
-                            m_rxmesh_context.m_num_faces,
-                            m_rxmesh_context.m_max_num_vertices,
-                            m_rxmesh_context.m_max_num_edges,
-                            m_rxmesh_context.m_max_num_faces);
+    if (is_full) {
+        // recount everything from scratch
+        CUDA_ERROR(cudaMemset(d_num_owned, 0, 3 * max_p * sizeof(uint32_t)));
+
+        detail::reset<<<1, 1>>>(m_rxmesh_context.m_num_vertices,
+                                m_rxmesh_context.m_num_edges,
+                                m_rxmesh_context.m_num_faces,
+                                m_rxmesh_context.m_max_num_vertices,
+                                m_rxmesh_context.m_max_num_edges,
+                                m_rxmesh_context.m_max_num_faces);
+    }
+
+    // only the dirty/sliced patches (and their neighbors for the hashtable
+    // calibration) are cleaned up
+    const uint32_t flag_blocks = DIVIDE_UP(max_p, block_size);
+    detail::flag_cleanup_patches<<<flag_blocks, block_size>>>(
+        m_rxmesh_context, d_flags, is_full);
+    detail::build_cleanup_lists<<<flag_blocks, block_size>>>(
+        m_rxmesh_context,
+        d_flags,
+        d_surplus_list,
+        d_calibration_list,
+        d_num_patches);
+
+    uint32_t h_num_patches[2];
+    CUDA_ERROR(cudaMemcpy(h_num_patches,
+                          d_num_patches,
+                          2 * sizeof(uint32_t),
+                          cudaMemcpyDeviceToHost));
+    m_num_cleaned_patches = h_num_patches[0];
+
+    if (h_num_patches[1] == 0) {
+        return;
+    }
 
     uint32_t dyn_shmem = 0;
 
@@ -2727,10 +3153,17 @@ void RXMeshDynamic::cleanup()
     dyn_shmem += std::max(hash_table_shmem, connect_shmem);
 
     detail::hashtable_calibration<block_size>
-        <<<grid_size, block_size>>>(this->m_rxmesh_context);
+        <<<h_num_patches[1], block_size>>>(this->m_rxmesh_context,
+                                           d_calibration_list);
+
+    if (h_num_patches[0] > 0) {
+        detail::remove_surplus_elements<block_size>
+            <<<h_num_patches[0], block_size, dyn_shmem>>>(
+                this->m_rxmesh_context, d_surplus_list, d_num_owned);
+    }
 
-    detail::remove_surplus_elements<block_size>
-        <<<grid_size, block_size, dyn_shmem>>>(this->m_rxmesh_context);
+    // removing the surplus ribbon elements changes the query outputs
+    invalidate_query_cache();
 
     // CUDA_ERROR(cudaMemcpy(&this->m_max_vertices_per_patch,
     //                       this->m_rxmesh_context.m_max_num_vertices,
@@ -2748,6 +3181,586 @@ void RXMeshDynamic::cleanup()
     //                       cudaMemcpyDeviceToHost));
 }
 
+void RXMeshDynamic::enable_adaptive_capacity(const float headroom,
+                                             const float growth_factor)
+{
+    if (headroom < 1.0f || growth_factor <= 1.0f) {
+        RXMESH_ERROR(
+            "RXMeshDynamic::enable_adaptive_capacity() headroom should be >= 1 "
+            "and growth_factor should be > 1. Input headroom= {} and "
+            "growth_factor= {}",
+            headroom,
+            growth_factor);
+        return;
+    }
+
+    m_adaptive_capacity      = true;
+    m_capacity_growth_factor = growth_factor;
+
+    // make sure the number of owned elements per patch is up to date
+    cleanup();
+
+    uint32_t num_patches = 0;
+    CUDA_ERROR(cudaMemcpy(&num_patches,
+                          m_rxmesh_context.m_num_patches,
+                          sizeof(uint32_t),
+                          cudaMemcpyDeviceToHost));
+
+    std::vector<uint32_t> num_owned(3 * num_patches);
+    CUDA_ERROR(cudaMemcpy(num_owned.data(),
+                          m_d_cleanup_buffer + 3 * get_max_num_patches(),
+                          num_owned.size() * sizeof(uint32_t),
+                          cudaMemcpyDeviceToHost));
+
+    auto fit = [&](const uint32_t num, const uint16_t max_cap) {
+        const uint32_t cap = std::max(
+            {num, 1u, uint32_t(std::ceil(headroom * static_cast<float>(num)))});
+        return static_cast<uint16_t>(std::min(cap, uint32_t(max_cap)));
+    };
+
+    auto fit_lp = [&](const uint32_t num_not_owned, const uint16_t max_cap) {
+        return fit(uint32_t(std::ceil(static_cast<float>(num_not_owned) /
+                                      m_lp_hashtable_load_factor)),
+                   max_cap);
+    };
+
+    std::vector<uint32_t>    patches;
+    std::vector<LPHashTable> old_lp;
+
+    for (uint32_t p = 0; p < num_patches; ++p) {
+        PatchInfo d_patch;
+        CUDA_ERROR(cudaMemcpy(&d_patch,
+                              m_d_patches_info + p,
+                              sizeof(PatchInfo),
+                              cudaMemcpyDeviceToHost));
+        if (d_patch.patch_id == INVALID32) {
+            continue;
+        }
+
+        // faces, edges, vertices
+        uint16_t counts[3];
+        CUDA_ERROR(cudaMemcpy(counts,
+                              d_patch.num_faces,
+                              3 * sizeof(uint16_t),
+                              cudaMemcpyDeviceToHost));
+
+        const uint32_t num_v = counts[2];
+        const uint32_t num_e = counts[1];
+        const uint32_t num_f = counts[0];
+
+        resize_patch(
+            p,
+            d_patch,
+            fit(num_v, get_per_patch_max_vertex_capacity()),
+            fit(num_e, get_per_patch_max_edge_capacity()),
+            fit(num_f, get_per_patch_max_face_capacity()),
+            fit_lp(num_v - num_owned[3 * p + 0],
+                   max_lp_hashtable_capacity<LocalVertexT>()),
+            fit_lp(num_e - num_owned[3 * p + 1],
+                   max_lp_hashtable_capacity<LocalEdgeT>()),
+            fit_lp(num_f - num_owned[3 * p + 2],
+                   max_lp_hashtable_capacity<LocalFaceT>()),
+            old_lp);
+        patches.push_back(p);
+    }
+
+    rehash_resized_patches(patches, old_lp);
+
+    RXMESH_INFO(
+        "RXMeshDynamic::enable_adaptive_capacity() topology memory after "
+        "shrinking {} patches = {} (MB)",
+        patches.size(),
+        get_topology_memory_mg());
+}
+
+uint32_t RXMeshDynamic::grow_patches()
+{
+    constexpr uint32_t block_size = 256;
+    const uint32_t     max_p      = get_max_num_patches();
+
+    // the list and its size
+    if (m_d_grow_buffer == nullptr) {
+        CUDA_ERROR(tracked_malloc((void**)&m_d_grow_buffer,
+                                  (max_p + 1) * sizeof(uint32_t),
+                                  MemoryCategory::Topology));
+    }
+    uint32_t* d_list        = m_d_grow_buffer;
+    uint32_t* d_num_patches = m_d_grow_buffer + max_p;
+
+    CUDA_ERROR(cudaMemset(d_num_patches, 0, sizeof(uint32_t)));
+    detail::list_should_slice_patches<<<DIVIDE_UP(max_p, block_size),
+                                        block_size>>>(
+        m_rxmesh_context, d_list, d_num_patches);
+
+    uint32_t num_patches = 0;
+    CUDA_ERROR(cudaMemcpy(&num_patches,
+                          d_num_patches,
+                          sizeof(uint32_t),
+                          cudaMemcpyDeviceToHost));
+    if (num_patches == 0) {
+        return 0;
+    }
+
+    std::vector<uint32_t> list(num_patches);
+    CUDA_ERROR(cudaMemcpy(list.data(),
+                          d_list,
+                          num_patches * sizeof(uint32_t),
+                          cudaMemcpyDeviceToHost));
+
+    auto grow = [&](const uint16_t cap, const uint16_t max_cap) {
+        const uint32_t new_cap = std::max(
+            uint32_t(cap) + 1,
+            uint32_t(std::ceil(m_capacity_growth_factor *
+                               static_cast<float>(cap))));
+        return static_cast<uint16_t>(std::min(new_cap, uint32_t(max_cap)));
+    };
+
+    std::vector<uint32_t>    patches;
+    std::vector<LPHashTable> old_lp;
+
+    for (const uint32_t p : list) {
+        PatchInfo d_patch;
+        CUDA_ERROR(cudaMemcpy(&d_patch,
+                              m_d_patches_info + p,
+                              sizeof(PatchInfo),
+                              cudaMemcpyDeviceToHost));
+
+        const uint16_t v_cap = grow(d_patch.vertices_capacity,
+                                    get_per_patch_max_vertex_capacity());
+        const uint16_t e_cap =
+            grow(d_patch.edges_capacity, get_per_patch_max_edge_capacity());
+        const uint16_t f_cap =
+            grow(d_patch.faces_capacity, get_per_patch_max_face_capacity());
+
+        // the hashtable capacity is rounded up to a prime number and so it
+        // could be already bigger than the max capacity
+        const uint16_t lp_v_cap =
+            std::max(d_patch.lp_v.get_capacity(),
+                     grow(d_patch.lp_v.get_capacity(),
+                          max_lp_hashtable_capacity<LocalVertexT>()));
+        const uint16_t lp_e_cap =
+            std::max(d_patch.lp_e.get_capacity(),
+                     grow(d_patch.lp_e.get_capacity(),
+                          max_lp_hashtable_capacity<LocalEdgeT>()));
+        const uint16_t lp_f_cap =
+            std::max(d_patch.lp_f.get_capacity(),
+                     grow(d_patch.lp_f.get_capacity(),
+                          max_lp_hashtable_capacity<LocalFaceT>()));
+
+        // already at the max capacity and so it should be sliced
+        if (v_cap == d_patch.vertices_capacity &&
+            e_cap == d_patch.edges_capacity &&
+            f_cap == d_patch.faces_capacity &&
+            lp_v_cap == d_patch.lp_v.get_capacity() &&
+            lp_e_cap == d_patch.lp_e.get_capacity() &&
+            lp_f_cap == d_patch.lp_f.get_capacity()) {
+            continue;
+        }
+
+        d_patch.should_slice = false;
+        resize_patch(p,
+                     d_patch,
+                     v_cap,
+                     e_cap,
+                     f_cap,
+                     lp_v_cap,
+                     lp_e_cap,
+                     lp_f_cap,
+                     old_lp);
+        patches.push_back(p);
+    }
+
+    rehash_resized_patches(patches, old_lp);
+
+    return uint32_t(patches.size());
+}
+
+void RXMeshDynamic::resize_patch(const uint32_t            p,
+                                 PatchInfo&                d_patch,
+                                 const uint16_t            vertices_capacity,
+                                 const uint16_t            edges_capacity,
+                                 const uint16_t            faces_capacity,
+                                 const uint16_t            lp_v_capacity,
+                                 const uint16_t            lp_e_capacity,
+                                 const uint16_t            lp_f_capacity,
+                                 std::vector<LPHashTable>& old_lp)
+{
+    PatchInfo& h_patch = m_h_patches_info[p];
+
+    double mem_mega_bytes = 0;
+
+    // move the device (and host) buffer to a new allocation of new_bytes
+    // keeping the first min(old_bytes, new_bytes) and zeroing the rest
+    auto resize = [&](void** d_ptr,
+                      void** h_ptr,
+                      const size_t old_bytes,
+                      const size_t new_bytes) {
+        void* d_new = nullptr;
+        CUDA_ERROR(device_malloc(&d_new, new_bytes));
+        CUDA_ERROR(cudaMemset(d_new, 0, new_bytes));
+        CUDA_ERROR(cudaMemcpy(d_new,
+                              *d_ptr,
+                              std::min(old_bytes, new_bytes),
+                              cudaMemcpyDeviceToDevice));
+        GPU_FREE(*d_ptr);
+        *d_ptr = d_new;
+
+        // the host copy is overwritten by update_host()
+        *h_ptr = realloc(*h_ptr, new_bytes);
+
+        mem_mega_bytes += BYTES_TO_MEGABYTES(new_bytes);
+        mem_mega_bytes -= BYTES_TO_MEGABYTES(old_bytes);
+    };
+
+    auto resize_masks = [&](uint32_t*&     d_active,
+                            uint32_t*&     d_owned,
+                            uint32_t*&     h_active,
+                            uint32_t*&     h_owned,
+                            const uint16_t old_cap,
+                            const uint16_t new_cap) {
+        const size_t old_bytes = detail::mask_num_bytes(old_cap);
+        const size_t new_bytes = detail::mask_num_bytes(new_cap);
+        resize((void**)&d_active, (void**)&h_active, old_bytes, new_bytes);
+        resize((void**)&d_owned, (void**)&h_owned, old_bytes, new_bytes);
+    };
+
+    resize((void**)&d_patch.ev,
+           (void**)&h_patch.ev,
+           2 * size_t(d_patch.edges_capacity) * sizeof(LocalVertexT),
+           2 * size_t(edges_capacity) * sizeof(LocalVertexT));
+    resize((void**)&d_patch.fe,
+           (void**)&h_patch.fe,
+           3 * size_t(d_patch.faces_capacity) * sizeof(LocalEdgeT),
+           3 * size_t(faces_capacity) * sizeof(LocalEdgeT));
+
+    resize_masks(d_patch.active_mask_v,
+                 d_patch.owned_mask_v,
+                 h_patch.active_mask_v,
+                 h_patch.owned_mask_v,
+                 d_patch.vertices_capacity,
+                 vertices_capacity);
+    resize_masks(d_patch.active_mask_e,
+                 d_patch.owned_mask_e,
+                 h_patch.active_mask_e,
+                 h_patch.owned_mask_e,
+                 d_patch.edges_capacity,
+                 edges_capacity);
+    resize_masks(d_patch.active_mask_f,
+                 d_patch.owned_mask_f,
+                 h_patch.active_mask_f,
+                 h_patch.owned_mask_f,
+                 d_patch.faces_capacity,
+                 faces_capacity);
+
+    d_patch.vertices_capacity = vertices_capacity;
+    d_patch.edges_capacity    = edges_capacity;
+    d_patch.faces_capacity    = faces_capacity;
+    h_patch.vertices_capacity = vertices_capacity;
+    h_patch.edges_capacity    = edges_capacity;
+    h_patch.faces_capacity    = faces_capacity;
+
+    // the host hashtable should have the same capacity (and thus hash
+    // functions) as the device one so update_host() can copy it
+    auto resize_lp = [&](LPHashTable&   d_lp,
+                         LPHashTable&   h_lp,
+                         const uint16_t capacity) {
+        mem_mega_bytes -= BYTES_TO_MEGABYTES(d_lp.num_bytes());
+        old_lp.push_back(d_lp);
+        d_lp = LPHashTable(capacity, true, d_lp.get_bucket_size());
+        h_lp.free();
+        h_lp = LPHashTable(capacity, false, d_lp.get_bucket_size());
+        mem_mega_bytes += BYTES_TO_MEGABYTES(d_lp.num_bytes());
+    };
+
+    resize_lp(d_patch.lp_v, h_patch.lp_v, lp_v_capacity);
+    resize_lp(d_patch.lp_e, h_patch.lp_e, lp_e_capacity);
+    resize_lp(d_patch.lp_f, h_patch.lp_f, lp_f_capacity);
+
+    CUDA_ERROR(cudaMemcpy(m_d_patches_info + p,
+                          &d_patch,
+                          sizeof(PatchInfo),
+                          cudaMemcpyHostToDevice));
+#ifdef USE_OUT_OF_CORE
+    m_h_d_patches_info[p] = d_patch;
+#endif
+
+    m_topo_memory_mega_bytes += mem_mega_bytes;
+}
+
+void RXMeshDynamic::rehash_resized_patches(
+    const std::vector<uint32_t>& patches,
+    std::vector<LPHashTable>&    old_lp)
+{
+    if (patches.empty()) {
+        return;
+    }
+    assert(old_lp.size() == 3 * patches.size());
+
+    constexpr uint32_t block_size = 256;
+
+    uint32_t*    d_patches = nullptr;
+    LPHashTable* d_old_lp  = nullptr;
+    CUDA_ERROR(tracked_malloc((void**)&d_patches,
+                              patches.size() * sizeof(uint32_t),
+                              MemoryCategory::Topology));
+    CUDA_ERROR(tracked_malloc((void**)&d_old_lp,
+                              old_lp.size() * sizeof(LPHashTable),
+                              MemoryCategory::Topology));
+    CUDA_ERROR(cudaMemcpy(d_patches,
+                          patches.data(),
+                          patches.size() * sizeof(uint32_t),
+                          cudaMemcpyHostToDevice));
+    CUDA_ERROR(cudaMemcpy(d_old_lp,
+                          old_lp.data(),
+                          old_lp.size() * sizeof(LPHashTable),
+                          cudaMemcpyHostToDevice));
+
+    detail::rehash_resized_patches<block_size>
+        <<<uint32_t(patches.size()), block_size>>>(
+            m_rxmesh_context, d_patches, d_old_lp);
+
+    CUDA_ERROR(cudaDeviceSynchronize());
+
+    // the inverted hashtables depend on the capacity and hash functions
+    m_rxmesh_context.m_inv_lp_cache.invalidate_all();
+
+    for (auto& lp : old_lp) {
+        lp.free();
+    }
+    old_lp.clear();
+
+    GPU_FREE(d_patches);
+    GPU_FREE(d_old_lp);
+}
+
+uint32_t RXMeshDynamic::reset_scheduler(const uint32_t color)
+{
+    std::vector<uint32_t> patches;
+    for (uint32_t p = 0; p < get_num_patches(); ++p) {
+        if (m_h_patches_info[p].color == color) {
+            patches.push_back(p);
+        }
+    }
+    random_shuffle(patches.data(), uint32_t(patches.size()));
+
+    this->m_rxmesh_context.m_patch_scheduler.refill(patches.data(),
+                                                    uint32_t(patches.size()));
+    return uint32_t(patches.size());
+}
+
+uint32_t RXMeshDynamic::reset_scheduler(const std::vector<uint32_t>& patches)
+{
+    std::vector<uint32_t> queue;
+    queue.reserve(patches.size());
+    for (const uint32_t p : patches) {
+        if (p < get_num_patches()) {
+            queue.push_back(p);
+        }
+    }
+    random_shuffle(queue.data(), uint32_t(queue.size()));
+
+    this->m_rxmesh_context.m_patch_scheduler.refill(queue.data(),
+                                                    uint32_t(queue.size()));
+    return uint32_t(queue.size());
+}
+
+void RXMeshDynamic::repair_patch_coloring(const uint32_t first_new_patch)
+{
+    const uint32_t num_patches = get_num_patches();
+
+    uint32_t* d_buffer = nullptr;
+    CUDA_ERROR(tracked_malloc((void**)&d_buffer,
+                              (2 * num_patches + 1) * sizeof(uint32_t),
+                              MemoryCategory::Topology));
+    uint32_t* d_flags      = d_buffer;
+    uint32_t* d_colors     = d_buffer + num_patches;
+    uint32_t* d_num_colors = d_buffer + 2 * num_patches;
+
+    CUDA_ERROR(cudaMemcpy(d_num_colors,
+                          &m_num_colors,
+                          sizeof(uint32_t),
+                          cudaMemcpyHostToDevice));
+
+    const uint32_t block_size = 256;
+    const uint32_t grid_size  = DIVIDE_UP(num_patches, block_size);
+
+    detail::flag_patch_color_conflicts<<<grid_size, block_size>>>(
+        m_rxmesh_context, num_patches, first_new_patch, d_flags);
+
+    detail::recolor_patches<<<1, 1>>>(
+        m_rxmesh_context, num_patches, d_flags, d_num_colors);
+
+    detail::get_patch_colors<<<grid_size, block_size>>>(
+        m_rxmesh_context, num_patches, d_colors);
+
+    std::vector<uint32_t> colors(num_patches);
+    CUDA_ERROR(cudaMemcpy(colors.data(),
+                          d_colors,
+                          num_patches * sizeof(uint32_t),
+                          cudaMemcpyDeviceToHost));
+    CUDA_ERROR(cudaMemcpy(&m_num_colors,
+                          d_num_colors,
+                          sizeof(uint32_t),
+                          cudaMemcpyDeviceToHost));
+
+    for (uint32_t p = 0; p < num_patches; ++p) {
+        m_h_patches_info[p].color = colors[p];
+    }
+
+    GPU_FREE(d_buffer);
+}
+
+void RXMeshDynamic::keep_color_in_queue(const uint32_t color)
+{
+    detail::defer_patches_of_color<<<1, 1>>>(m_rxmesh_context, color);
+    detail::requeue_deferred_patches<256>
+        <<<1, 256>>>(m_rxmesh_context.m_patch_scheduler);
+}
+
+uint32_t RXMeshDynamic::select_merge_patches(const float fill_ratio)
+{
+    const uint32_t max_p = get_max_num_patches();
+
+    // merge target, claim, and merge slot per patch and the number of merges
+    CUDA_ERROR(tracked_malloc((void**)&m_d_merge_buffer,
+                              (3 * max_p + 1) * sizeof(uint32_t),
+                              MemoryCategory::Topology));
+    CUDA_ERROR(
+        cudaMemset(m_d_merge_buffer, 0xFF, 3 * max_p * sizeof(uint32_t)));
+    CUDA_ERROR(cudaMemset(m_d_merge_buffer + 3 * max_p, 0, sizeof(uint32_t)));
+
+    uint32_t* d_merge_target = m_d_merge_buffer;
+    uint32_t* d_claim        = m_d_merge_buffer + max_p;
+    uint32_t* d_merge_slot   = m_d_merge_buffer + 2 * max_p;
+    uint32_t* d_num_merges   = m_d_merge_buffer + 3 * max_p;
+
+    // the number of owned elements per patch as computed by cleanup()
+    const uint32_t* d_num_owned = m_d_cleanup_buffer + 3 * max_p;
+
+    const uint32_t max_num_owned_faces = static_cast<uint32_t>(
+        fill_ratio * static_cast<float>(get_patch_size()));
+
+    const uint32_t block_size = 256;
+    detail::select_merge_patches<<<DIVIDE_UP(max_p, block_size), block_size>>>(
+        m_rxmesh_context,
+        d_num_owned,
+        max_num_owned_faces,
+        d_merge_target,
+        d_claim,
+        d_merge_slot,
+        d_num_merges);
+
+    uint32_t num_merges = 0;
+    CUDA_ERROR(cudaMemcpy(&num_merges,
+                          d_num_merges,
+                          sizeof(uint32_t),
+                          cudaMemcpyDeviceToHost));
+
+    if (num_merges == 0) {
+        GPU_FREE(m_d_merge_buffer);
+        return 0;
+    }
+
+    const size_t stride = size_t(get_per_patch_max_vertex_capacity()) +
+                          get_per_patch_max_edge_capacity() +
+                          get_per_patch_max_face_capacity();
+
+    CUDA_ERROR(tracked_malloc((void**)&m_d_merge_map,
+                              num_merges * stride * sizeof(uint16_t),
+                              MemoryCategory::Topology));
+
+    return num_merges;
+}
+
+uint32_t RXMeshDynamic::finish_merge_patches()
+{
+    const uint32_t max_p       = get_max_num_patches();
+    const uint32_t num_patches = get_num_patches();
+
+    const uint32_t* d_merge_target = m_d_merge_buffer;
+    const uint32_t* d_merge_slot   = m_d_merge_buffer + 2 * max_p;
+
+    detail::redirect_merged_patches<256>
+        <<<num_patches, 256>>>(m_rxmesh_context,
+                               d_merge_target,
+                               d_merge_slot,
+                               m_d_merge_map,
+                               get_per_patch_max_vertex_capacity(),
+                               get_per_patch_max_edge_capacity(),
+                               get_per_patch_max_face_capacity());
+
+    // merges that did not fit in their target were reset by merge_patches
+    std::vector<uint32_t> h_merge_target(num_patches);
+    CUDA_ERROR(cudaMemcpy(h_merge_target.data(),
+                          d_merge_target,
+                          num_patches * sizeof(uint32_t),
+                          cudaMemcpyDeviceToHost));
+
+    const uint32_t num_merged = static_cast<uint32_t>(
+        num_patches -
+        std::count(h_merge_target.begin(), h_merge_target.end(), INVALID32));
+
+    GPU_FREE(m_d_merge_map);
+    GPU_FREE(m_d_merge_buffer);
+
+    // empty the merged patches and update the ribbons and hashtables of the
+    // merge targets and their neighbors
+    cleanup();
+
+    if (num_merged > 0) {
+        // the merge targets have new neighbor patches
+        repair_patch_coloring(num_patches);
+        m_change_log_patches_changed = true;
+    }
+
+    invalidate_query_cache();
+    m_rxmesh_context.m_inv_lp_cache.invalidate_all();
+    invalidate_element_flags();
+
+    return num_merged;
+}
+
+void RXMeshDynamic::get_max_min_avg_patch_size(uint32_t&  min_p,
+                                               uint32_t&  max_p,
+                                               uint32_t&  avg_p,
+                                               const bool from_device)
+{
+    if (!from_device || m_d_cleanup_buffer == nullptr) {
+        RXMeshStatic::get_max_min_avg_patch_size(min_p, max_p, avg_p);
+        return;
+    }
+
+    const uint32_t num_patches = get_num_patches(true);
+
+    std::vector<uint32_t> h_num_owned(3 * num_patches);
+    CUDA_ERROR(cudaMemcpy(h_num_owned.data(),
+                          m_d_cleanup_buffer + 3 * get_max_num_patches(),
+                          3 * num_patches * sizeof(uint32_t),
+                          cudaMemcpyDeviceToHost));
+
+    min_p = std::numeric_limits<uint32_t>::max();
+    max_p = 0;
+    avg_p = 0;
+
+    uint32_t num_non_empty = 0;
+    for (uint32_t p = 0; p < num_patches; ++p) {
+        const uint32_t num_faces = h_num_owned[3 * p + 2];
+        if (num_faces == 0) {
+            continue;
+        }
+        num_non_empty++;
+        min_p = std::min(min_p, num_faces);
+        max_p = std::max(max_p, num_faces);
+        avg_p += num_faces;
+    }
+
+    if (num_non_empty == 0) {
+        min_p = 0;
+        return;
+    }
+    avg_p /= num_non_empty;
+}
+
 void RXMeshDynamic::update_host()
 {
     RXMESH_TRACE("RXMeshDynamic updating host started");
@@ -2985,6 +3998,9 @@ void RXMeshDynamic::update_host()
 
     this->calc_max_elements();
 
+    // the linear ids may have changed
+    this->release_dense_index();
+
     RXMESH_TRACE("RXMeshDynamic updating host finished");
 }
 
@@ -3005,6 +4021,308 @@ void RXMeshDynamic::update_polyscope(std::string new_name)
 #endif
 }
 
+namespace {
+// magic number and version of the checkpoint written by
+// RXMeshDynamic::save_checkpoint()
+constexpr uint32_t CHECKPOINT_MAGIC   = 0x4B435852u;  // "RXCK"
+constexpr uint32_t CHECKPOINT_VERSION = 2;
+}  // namespace
+
+template <typename WriteFnT>
+void RXMeshDynamic::write_topology_checkpoint(WriteFnT write)
+{
+    // bring the host side up-to-date with the device topology
+    update_host();
+
+    const uint32_t header[10] = {CHECKPOINT_MAGIC,
+                                 CHECKPOINT_VERSION,
+                                 m_num_patches,
+                                 get_max_num_patches(),
+                                 m_num_vertices,
+                                 m_num_edges,
+                                 m_num_faces,
+                                 m_max_vertices_per_patch,
+                                 m_max_edges_per_patch,
+                                 m_max_faces_per_patch};
+    write(header, sizeof(header));
+
+    auto write_lp = [&](const LPHashTable& lp) {
+        const uint16_t capacity    = lp.get_capacity();
+        const uint8_t  bucket_size = lp.get_bucket_size();
+        write(&capacity, sizeof(uint16_t));
+        write(&bucket_size, sizeof(uint8_t));
+        write(&lp.m_hasher0, sizeof(LPHashTable::HashT));
+        write(&lp.m_hasher1, sizeof(LPHashTable::HashT));
+        write(&lp.m_hasher2, sizeof(LPHashTable::HashT));
+        write(&lp.m_hasher3, sizeof(LPHashTable::HashT));
+        write(lp.m_table, lp.num_bytes());
+        write(lp.m_stash, LPHashTable::stash_size * sizeof(LPPair));
+    };
+
+    for (uint32_t p = 0; p < m_num_patches; ++p) {
+        const PatchInfo& pi = m_h_patches_info[p];
+
+        const uint16_t num_v        = pi.num_vertices[0];
+        const uint16_t num_e        = pi.num_edges[0];
+        const uint16_t num_f        = pi.num_faces[0];
+        const uint8_t  should_slice = pi.should_slice;
+
+        write(&num_v, sizeof(uint16_t));
+        write(&num_e, sizeof(uint16_t));
+        write(&num_f, sizeof(uint16_t));
+        write(&pi.color, sizeof(uint32_t));
+        write(&pi.child_id, sizeof(uint32_t));
+        write(&should_slice, sizeof(uint8_t));
+        write(pi.dirty, sizeof(int));
+
+        write(pi.ev, 2 * num_e * sizeof(LocalVertexT));
+        write(pi.fe, 3 * num_f * sizeof(LocalEdgeT));
+
+        write(pi.active_mask_v, detail::mask_num_bytes(num_v));
+        write(pi.owned_mask_v, detail::mask_num_bytes(num_v));
+        write(pi.active_mask_e, detail::mask_num_bytes(num_e));
+        write(pi.owned_mask_e, detail::mask_num_bytes(num_e));
+        write(pi.active_mask_f, detail::mask_num_bytes(num_f));
+        write(pi.owned_mask_f, detail::mask_num_bytes(num_f));
+
+        write(pi.patch_stash.m_stash,
+              PatchStash::stash_size * sizeof(uint32_t));
+
+        write_lp(pi.lp_v);
+        write_lp(pi.lp_e);
+        write_lp(pi.lp_f);
+    }
+}
+
+bool RXMeshDynamic::save_topology_checkpoint(std::ostream& out)
+{
+    write_topology_checkpoint([&](const void* ptr, size_t num_bytes) {
+        out.write(reinterpret_cast<const char*>(ptr), num_bytes);
+    });
+    return out.good();
+}
+
+bool RXMeshDynamic::save_topology_checkpoint(GDSFile& out)
+{
+    bool ok = true;
+    write_topology_checkpoint([&](const void* ptr, size_t num_bytes) {
+        ok = ok && out.write(ptr, num_bytes, HOST);
+    });
+    return ok;
+}
+
+template <typename ReadFnT, typename ReadDeviceFnT>
+bool RXMeshDynamic::read_topology_checkpoint(ReadFnT       read,
+                                             ReadDeviceFnT read_to_device)
+{
+    uint32_t header[10] = {0};
+
+    if (!read(header, sizeof(header)) || header[0] != CHECKPOINT_MAGIC ||
+        header[1] != CHECKPOINT_VERSION) {
+        RXMESH_ERROR(
+            "RXMeshDynamic::load_checkpoint() the input is not a valid "
+            "checkpoint for this version");
+        return false;
+    }
+
+    const uint32_t num_patches = header[2];
+
+    if (header[3] != get_max_num_patches() || num_patches > header[3]) {
+        RXMESH_ERROR(
+            "RXMeshDynamic::load_checkpoint() the checkpoint was written for "
+            "a mesh with {} maximum number of patches while this mesh has {}",
+            header[3],
+            get_max_num_patches());
+        return false;
+    }
+
+    auto read_lp = [&](LPHashTable& lp) {
+        uint16_t capacity    = 0;
+        uint8_t  bucket_size = 0;
+        if (!read(&capacity, sizeof(uint16_t)) ||
+            capacity != lp.get_capacity() ||
+            !read(&bucket_size, sizeof(uint8_t)) ||
+            bucket_size != lp.get_bucket_size()) {
+            return false;
+        }
+        return read(&lp.m_hasher0, sizeof(LPHashTable::HashT)) &&
+               read(&lp.m_hasher1, sizeof(LPHashTable::HashT)) &&
+               read(&lp.m_hasher2, sizeof(LPHashTable::HashT)) &&
+               read(&lp.m_hasher3, sizeof(LPHashTable::HashT)) &&
+               read_to_device(lp.m_table, lp.num_bytes()) &&
+               read_to_device(lp.m_stash,
+                              LPHashTable::stash_size * sizeof(LPPair));
+    };
+
+    std::vector<uint32_t> colors(num_patches);
+
+    for (uint32_t p = 0; p < num_patches; ++p) {
+        PatchInfo d_patch;
+        CUDA_ERROR(cudaMemcpy(&d_patch,
+                              m_d_patches_info + p,
+                              sizeof(PatchInfo),
+                              cudaMemcpyDeviceToHost));
+
+        uint16_t num_v(0), num_e(0), num_f(0);
+        uint8_t  should_slice(0);
+        int      dirty(0);
+
+        bool ok = read(&num_v, sizeof(uint16_t)) &&
+                  read(&num_e, sizeof(uint16_t)) &&
+                  read(&num_f, sizeof(uint16_t)) &&
+                  read(&colors[p], sizeof(uint32_t)) &&
+                  read(&d_patch.child_id, sizeof(uint32_t)) &&
+                  read(&should_slice, sizeof(uint8_t)) &&
+                  read(&dirty, sizeof(int));
+
+        if (!ok || num_v > d_patch.vertices_capacity ||
+            num_e > d_patch.edges_capacity || num_f > d_patch.faces_capacity) {
+            RXMESH_ERROR(
+                "RXMeshDynamic::load_checkpoint() patch {} in the checkpoint "
+                "does not fit in the patch capacity of this mesh",
+                p);
+            return false;
+        }
+
+        ok = read_to_device(d_patch.ev, 2 * num_e * sizeof(LocalVertexT)) &&
+             read_to_device(d_patch.fe, 3 * num_f * sizeof(LocalEdgeT)) &&
+             read_to_device(d_patch.active_mask_v,
+                            detail::mask_num_bytes(num_v)) &&
+             read_to_device(d_patch.owned_mask_v,
+                            detail::mask_num_bytes(num_v)) &&
+             read_to_device(d_patch.active_mask_e,
+                            detail::mask_num_bytes(num_e)) &&
+             read_to_device(d_patch.owned_mask_e,
+                            detail::mask_num_bytes(num_e)) &&
+             read_to_device(d_patch.active_mask_f,
+                            detail::mask_num_bytes(num_f)) &&
+             read_to_device(d_patch.owned_mask_f,
+                            detail::mask_num_bytes(num_f)) &&
+             read_to_device(d_patch.patch_stash.m_stash,
+                            PatchStash::stash_size * sizeof(uint32_t)) &&
+             read_lp(d_patch.lp_v) && read_lp(d_patch.lp_e) &&
+             read_lp(d_patch.lp_f);
+
+        if (!ok) {
+            RXMESH_ERROR(
+                "RXMeshDynamic::load_checkpoint() failed to read patch {}", p);
+            return false;
+        }
+
+        CUDA_ERROR(cudaMemcpy(d_patch.num_vertices,
+                              &num_v,
+                              sizeof(uint16_t),
+                              cudaMemcpyHostToDevice));
+        CUDA_ERROR(cudaMemcpy(d_patch.num_edges,
+                              &num_e,
+                              sizeof(uint16_t),
+                              cudaMemcpyHostToDevice));
+        CUDA_ERROR(cudaMemcpy(d_patch.num_faces,
+                              &num_f,
+                              sizeof(uint16_t),
+                              cudaMemcpyHostToDevice));
+        CUDA_ERROR(cudaMemcpy(
+            d_patch.dirty, &dirty, sizeof(int), cudaMemcpyHostToDevice));
+
+        // the compressed topology (if any) does not match the restored one
+        d_patch.ev8          = nullptr;
+        d_patch.fe8          = nullptr;
+        d_patch.owner_v      = nullptr;
+        d_patch.owner_e      = nullptr;
+        d_patch.owner_f      = nullptr;
+        d_patch.color        = colors[p];
+        d_patch.should_slice = should_slice;
+
+        CUDA_ERROR(cudaMemcpy(m_d_patches_info + p,
+                              &d_patch,
+                              sizeof(PatchInfo),
+                              cudaMemcpyHostToDevice));
+    }
+
+    CUDA_ERROR(cudaMemcpy(m_rxmesh_context.m_num_patches,
+                          &header[2],
+                          sizeof(uint32_t),
+                          cudaMemcpyHostToDevice));
+    CUDA_ERROR(cudaMemcpy(m_rxmesh_context.m_num_vertices,
+                          &header[4],
+                          sizeof(uint32_t),
+                          cudaMemcpyHostToDevice));
+    CUDA_ERROR(cudaMemcpy(m_rxmesh_context.m_num_edges,
+                          &header[5],
+                          sizeof(uint32_t),
+                          cudaMemcpyHostToDevice));
+    CUDA_ERROR(cudaMemcpy(m_rxmesh_context.m_num_faces,
+                          &header[6],
+                          sizeof(uint32_t),
+                          cudaMemcpyHostToDevice));
+    CUDA_ERROR(cudaMemcpy(m_rxmesh_context.m_max_num_vertices,
+                          &header[7],
+                          sizeof(uint32_t),
+                          cudaMemcpyHostToDevice));
+    CUDA_ERROR(cudaMemcpy(m_rxmesh_context.m_max_num_edges,
+                          &header[8],
+                          sizeof(uint32_t),
+                          cudaMemcpyHostToDevice));
+    CUDA_ERROR(cudaMemcpy(m_rxmesh_context.m_max_num_faces,
+                          &header[9],
+                          sizeof(uint32_t),
+                          cudaMemcpyHostToDevice));
+
+    update_host();
+
+    for (uint32_t p = 0; p < num_patches; ++p) {
+        m_h_patches_info[p].color = colors[p];
+    }
+
+    reset_scheduler();
+
+    invalidate_query_cache();
+    m_rxmesh_context.m_inv_lp_cache.invalidate_all();
+    invalidate_element_flags();
+    m_change_log_patches_changed = true;
+
+    // the per-patch number of owned elements is stale so the next cleanup()
+    // should be a full one
+    GPU_FREE(m_d_cleanup_buffer);
+
+    return true;
+}
+
+bool RXMeshDynamic::load_topology_checkpoint(std::istream& in)
+{
+    std::vector<char> buffer;
+
+    return read_topology_checkpoint(
+        [&](void* ptr, size_t num_bytes) {
+            in.read(reinterpret_cast<char*>(ptr), num_bytes);
+            return in.good();
+        },
+        // read num_bytes from the input and copy them to the device
+        [&](void* d_ptr, size_t num_bytes) {
+            buffer.resize(num_bytes);
+            in.read(buffer.data(), num_bytes);
+            if (!in.good()) {
+                return false;
+            }
+            CUDA_ERROR(cudaMemcpy(
+                d_ptr, buffer.data(), num_bytes, cudaMemcpyHostToDevice));
+            return true;
+        });
+}
+
+bool RXMeshDynamic::load_topology_checkpoint(GDSFile& in)
+{
+    // the per-patch topology and hashtables are read directly into the
+    // device memory
+    return read_topology_checkpoint(
+        [&](void* ptr, size_t num_bytes) {
+            return in.read(ptr, num_bytes, HOST);
+        },
+        [&](void* d_ptr, size_t num_bytes) {
+            return in.read(d_ptr, num_bytes, DEVICE);
+        });
+}
+
 
 template __device__ void detail::slice<256>(Context&,
                                             cooperative_groups::thread_block&,
@@ -1,10 +1,18 @@
 #pragma once
 #include "rxmesh/rxmesh_static.h"
 
+#include <algorithm>
+#include <fstream>
+#include <string>
+
 #include <cooperative_groups.h>
 
+#include "rxmesh/attribute_policy.h"
 #include "rxmesh/bitmask.cuh"
+#include "rxmesh/cavity_ops.cuh"
 #include "rxmesh/kernels/rxmesh_queries.cuh"
+#include "rxmesh/validation_report.h"
+#include "rxmesh/util/gds_file.h"
 
 #define SLICE_GGP
 
@@ -80,7 +88,11 @@ __inline__ __device__ void post_slicing_update_attributes(
 {
     using HandleT = typename AttributeT::HandleType;
 
-    const uint32_t num_attr = attribute.get_num_attributes();
+    if constexpr (is_attribute_update_policy<AttributeT>::value) {
+        if constexpr (AttributeT::update == AttributeUpdate::Skip) {
+            return;
+        }
+    }
 
     const uint16_t num_elements = pi.get_num_elements<HandleT>()[0];
 
@@ -99,10 +111,7 @@ __inline__ __device__ void post_slicing_update_attributes(
             change = ownership_change_f(vp);
         }
         if (change) {
-            for (uint32_t attr = 0; attr < num_attr; ++attr) {
-                attribute(new_patch_id, vp, attr) =
-                    attribute(patch_id, vp, attr);
-            }
+            update_element(attribute, new_patch_id, vp, patch_id, vp);
         }
     }
 }
@@ -605,6 +614,397 @@ __global__ static void slice_patches(Context        context,
 #endif
     }
 }
+
+/**
+ * @brief set the dirty flag of a patch outside of a cavity operation (e.g.,
+ * merging) where no other block is updating the patch
+ */
+__device__ __inline__ void set_patch_dirty(PatchInfo& pi)
+{
+    if (pi.lock.acquire_lock(blockIdx.x)) {
+        pi.set_dirty();
+        pi.lock.release_lock();
+    }
+}
+
+/**
+ * @brief find the copy in the patch p of every element of the patch q that is
+ * merged into p. The copy is found by matching the owner patch and the local
+ * index in the owner patch. Elements of q that do not have a copy in p get a
+ * new local index in p (starting from the current number of elements in p).
+ * map is indexed by q's local index and s_owner/s_lid are scratch of size
+ * equal the number of elements in q. s_count is [#new, #new not-owned, #p
+ * not-owned, #q-owned that are not-owned in p]
+ */
+template <uint32_t blockThreads, typename HandleT>
+__device__ __inline__ void merge_match(
+    cooperative_groups::thread_block& block,
+    const PatchInfo&                  qi,
+    const PatchInfo&                  pi,
+    uint16_t*                         map,
+    uint32_t*                         s_owner,
+    uint16_t*                         s_lid,
+    uint32_t*                         s_count)
+{
+    using LocalT = typename HandleT::LocalT;
+
+    const uint16_t q_num = qi.get_num_elements<HandleT>()[0];
+    const uint16_t p_num = pi.get_num_elements<HandleT>()[0];
+
+    // the owner patch and the local index in the owner of q's elements
+    for (uint16_t x = threadIdx.x; x < q_num; x += blockThreads) {
+        map[x]     = INVALID16;
+        s_owner[x] = INVALID32;
+        if (!qi.is_deleted(LocalT(x))) {
+            if (qi.is_owned(LocalT(x))) {
+                s_owner[x] = qi.patch_id;
+                s_lid[x]   = x;
+            } else {
+                const LPPair lp =
+                    qi.get_lp<HandleT>().find(x, nullptr, nullptr);
+                assert(!lp.is_sentinel());
+                s_owner[x] = qi.patch_stash.get_patch(lp);
+                s_lid[x]   = lp.local_id_in_owner_patch();
+            }
+        }
+    }
+    block.sync();
+
+    // find the copies in p
+    for (uint16_t y = threadIdx.x; y < p_num; y += blockThreads) {
+        if (pi.is_deleted(LocalT(y))) {
+            continue;
+        }
+        uint32_t o = pi.patch_id;
+        uint16_t l = y;
+        if (!pi.is_owned(LocalT(y))) {
+            const LPPair lp = pi.get_lp<HandleT>().find(y, nullptr, nullptr);
+            assert(!lp.is_sentinel());
+            o = pi.patch_stash.get_patch(lp);
+            l = lp.local_id_in_owner_patch();
+            ::atomicAdd(s_count + 2, 1u);
+        }
+        if (o == qi.patch_id) {
+            map[l] = y;
+            ::atomicAdd(s_count + 3, 1u);
+        } else {
+            for (uint16_t x = 0; x < q_num; ++x) {
+                if (s_owner[x] == o && s_lid[x] == l) {
+                    map[x] = y;
+                    break;
+                }
+            }
+        }
+    }
+    block.sync();
+
+    // new local index in p for the elements that do not have a copy in p
+    for (uint16_t x = threadIdx.x; x < q_num; x += blockThreads) {
+        if (s_owner[x] != INVALID32 && map[x] == INVALID16) {
+            map[x] = p_num + ::atomicAdd(s_count, 1u);
+            if (s_owner[x] != qi.patch_id) {
+                ::atomicAdd(s_count + 1, 1u);
+            }
+        }
+    }
+    block.sync();
+}
+
+/**
+ * @brief check if the elements of q (as matched by merge_match()) fit in p
+ * i.e., the capacity of p and its hashtable are not exceeded
+ */
+template <typename HandleT>
+__device__ __inline__ bool merge_fits(const PatchInfo& pi,
+                                      const uint32_t*  s_count)
+{
+    const uint32_t p_num = pi.get_num_elements<HandleT>()[0];
+
+    // the number of not-owned elements in p after merging should keep the
+    // hashtable at most half full
+    const uint32_t num_not_owned = s_count[2] - s_count[3] + s_count[1];
+
+    return p_num + s_count[0] <= pi.get_capacity<HandleT>() &&
+           2 * num_not_owned <= pi.get_lp<HandleT>().get_capacity();
+}
+
+/**
+ * @brief write the elements of q in p using the map computed by
+ * merge_match(). The elements owned by q become owned by p. The elements that
+ * are new in p and not owned by q are added to p's hashtable
+ */
+template <uint32_t blockThreads, typename HandleT>
+__device__ __inline__ void merge_commit(
+    cooperative_groups::thread_block& block,
+    const PatchInfo&                  qi,
+    PatchInfo&                        pi,
+    const uint16_t*                   map,
+    const uint32_t*                   s_owner,
+    const uint16_t*                   s_lid,
+    ShmemMutex&                       patch_stash_mutex)
+{
+    const uint16_t q_num = qi.get_num_elements<HandleT>()[0];
+    const uint16_t p_num = pi.get_num_elements<HandleT>()[0];
+
+    uint32_t* p_owned  = pi.get_owned_mask<HandleT>();
+    uint32_t* p_active = pi.get_active_mask<HandleT>();
+
+    // remove the copies of q-owned elements from p's hashtable before
+    // inserting the new not-owned elements
+    for (uint16_t x = threadIdx.x; x < q_num; x += blockThreads) {
+        if (s_owner[x] == qi.patch_id && map[x] < p_num) {
+            pi.get_lp<HandleT>().remove(map[x], nullptr, nullptr);
+            bitmask_set_bit(map[x], p_owned, true);
+        }
+    }
+    block.sync();
+
+    for (uint16_t x = threadIdx.x; x < q_num; x += blockThreads) {
+        if (s_owner[x] == INVALID32 || map[x] < p_num) {
+            continue;
+        }
+        const uint16_t y = map[x];
+        bitmask_set_bit(y, p_active, true);
+        if (s_owner[x] == qi.patch_id) {
+            bitmask_set_bit(y, p_owned, true);
+        } else {
+            bitmask_clear_bit(y, p_owned, true);
+
+            const uint8_t st =
+                pi.patch_stash.insert_patch(s_owner[x], patch_stash_mutex);
+            assert(st != INVALID8);
+
+            bool inserted = pi.get_lp<HandleT>().insert(
+                LPPair(y, s_lid[x], st), nullptr, nullptr);
+            assert(inserted);
+        }
+    }
+}
+
+/**
+ * @brief merge every patch q with d_merge_target[q] != INVALID32 into its
+ * target patch. Launched with one block per patch. The target patch gets a
+ * copy of the elements of q that it does not already have (in its ribbon) and
+ * takes over the ownership of q's elements. q is left with no
+ * active elements and is emptied by the next cleanup(). The map from q's
+ * local indices to the target's local indices is stored in d_merge_map (at
+ * d_merge_slot[q] with a stride of cap_v + cap_e + cap_f) for the other
+ * patches to redirect their not-owned elements. If the elements do not fit in
+ * the target patch, d_merge_target[q] is reset to INVALID32
+ */
+template <uint32_t blockThreads, typename... AttributesT>
+__global__ static void merge_patches(Context         context,
+                                     uint32_t*       d_merge_target,
+                                     const uint32_t* d_merge_slot,
+                                     uint16_t*       d_merge_map,
+                                     const uint16_t  cap_v,
+                                     const uint16_t  cap_e,
+                                     const uint16_t  cap_f,
+                                     AttributesT... attributes)
+{
+    auto block = cooperative_groups::this_thread_block();
+
+    const uint32_t q = blockIdx.x;
+    if (q >= context.m_num_patches[0]) {
+        return;
+    }
+
+    const uint32_t p = d_merge_target[q];
+    if (p == INVALID32) {
+        return;
+    }
+
+    PatchInfo qi = context.m_patches_info[q];
+    PatchInfo pi = context.m_patches_info[p];
+
+    const uint16_t q_num_v = qi.num_vertices[0];
+    const uint16_t q_num_e = qi.num_edges[0];
+    const uint16_t q_num_f = qi.num_faces[0];
+
+    uint16_t* map_v =
+        d_merge_map + d_merge_slot[q] * (uint32_t(cap_v) + cap_e + cap_f);
+    uint16_t* map_e = map_v + cap_v;
+    uint16_t* map_f = map_e + cap_e;
+
+    __shared__ uint32_t s_count_v[4], s_count_e[4], s_count_f[4];
+    __shared__ bool     s_fits;
+    if (threadIdx.x < 4) {
+        s_count_v[threadIdx.x] = 0;
+        s_count_e[threadIdx.x] = 0;
+        s_count_f[threadIdx.x] = 0;
+    }
+
+    ShmemAllocator shrd_alloc;
+    uint32_t*      s_owner = shrd_alloc.alloc<uint32_t>(
+        std::max(q_num_v, std::max(q_num_e, q_num_f)));
+    uint16_t* s_lid_v = shrd_alloc.alloc<uint16_t>(q_num_v);
+    uint16_t* s_lid_e = shrd_alloc.alloc<uint16_t>(q_num_e);
+    uint16_t* s_lid_f = shrd_alloc.alloc<uint16_t>(q_num_f);
+    block.sync();
+
+    // s_owner is only needed per element type while matching. The owner of
+    // q's elements (q or not) is recovered afterwards from q's owned mask
+    merge_match<blockThreads, VertexHandle>(
+        block, qi, pi, map_v, s_owner, s_lid_v, s_count_v);
+    merge_match<blockThreads, EdgeHandle>(
+        block, qi, pi, map_e, s_owner, s_lid_e, s_count_e);
+    merge_match<blockThreads, FaceHandle>(
+        block, qi, pi, map_f, s_owner, s_lid_f, s_count_f);
+
+    if (threadIdx.x == 0) {
+        // the not-owned elements new to p are owned by patches from q's
+        // patch stash which should fit in p's patch stash
+        uint32_t num_new_patches = 0, num_free_slots = 0;
+        for (uint8_t i = 0; i < PatchStash::stash_size; ++i) {
+            const uint32_t r = qi.patch_stash.get_patch(i);
+            if (r != INVALID32 && r != p &&
+                pi.patch_stash.find_patch_index(r) == INVALID8) {
+                num_new_patches++;
+            }
+            if (pi.patch_stash.get_patch(i) == INVALID32) {
+                num_free_slots++;
+            }
+        }
+
+        s_fits = num_new_patches <= num_free_slots &&
+                 merge_fits<VertexHandle>(pi, s_count_v) &&
+                 merge_fits<EdgeHandle>(pi, s_count_e) &&
+                 merge_fits<FaceHandle>(pi, s_count_f);
+        if (!s_fits) {
+            d_merge_target[q] = INVALID32;
+        }
+    }
+    block.sync();
+
+    if (!s_fits) {
+        return;
+    }
+
+    ShmemMutex patch_stash_mutex;
+    patch_stash_mutex.alloc();
+
+    // recompute the owner for each element type before committing
+    auto commit = [&](auto handle, const uint16_t q_num, uint16_t* map,
+                      const uint16_t* s_lid) {
+        using HandleT = decltype(handle);
+        using LocalT  = typename HandleT::LocalT;
+        for (uint16_t x = threadIdx.x; x < q_num; x += blockThreads) {
+            s_owner[x] = INVALID32;
+            if (!qi.is_deleted(LocalT(x))) {
+                if (qi.is_owned(LocalT(x))) {
+                    s_owner[x] = q;
+                } else {
+                    s_owner[x] = qi.patch_stash.get_patch(
+                        qi.get_lp<HandleT>().find(x, nullptr, nullptr));
+                }
+            }
+        }
+        block.sync();
+        merge_commit<blockThreads, HandleT>(
+            block, qi, pi, map, s_owner, s_lid, patch_stash_mutex);
+        block.sync();
+    };
+
+    commit(VertexHandle(), q_num_v, map_v, s_lid_v);
+    commit(EdgeHandle(), q_num_e, map_e, s_lid_e);
+    commit(FaceHandle(), q_num_f, map_f, s_lid_f);
+
+    const uint16_t p_num_v = pi.num_vertices[0];
+    const uint16_t p_num_e = pi.num_edges[0];
+    const uint16_t p_num_f = pi.num_faces[0];
+
+    // the topology of the new elements
+    for (uint16_t e = threadIdx.x; e < q_num_e; e += blockThreads) {
+        if (!qi.is_deleted(LocalEdgeT(e)) && map_e[e] >= p_num_e) {
+            const uint16_t y = map_e[e];
+            pi.ev[2 * y + 0].id = map_v[qi.ev[2 * e + 0].id];
+            pi.ev[2 * y + 1].id = map_v[qi.ev[2 * e + 1].id];
+        }
+    }
+
+    for (uint16_t f = threadIdx.x; f < q_num_f; f += blockThreads) {
+        if (!qi.is_deleted(LocalFaceT(f)) && map_f[f] >= p_num_f) {
+            const uint16_t y = map_f[f];
+            for (int i = 0; i < 3; ++i) {
+                uint16_t e;
+                flag_t   d;
+                Context::unpack_edge_dir(qi.fe[3 * f + i].id, e, d);
+                pi.fe[3 * y + i].id = (map_e[e] << 1) | d;
+            }
+        }
+    }
+
+    // the attributes of the elements owned by q
+    (
+        [&] {
+            using HandleT = typename AttributesT::HandleType;
+            using LocalT  = typename HandleT::LocalT;
+
+            const uint16_t* map = map_v;
+            if constexpr (std::is_same_v<HandleT, EdgeHandle>) {
+                map = map_e;
+            }
+            if constexpr (std::is_same_v<HandleT, FaceHandle>) {
+                map = map_f;
+            }
+
+            const uint16_t q_num = qi.get_num_elements<HandleT>()[0];
+
+            for (uint16_t x = threadIdx.x; x < q_num; x += blockThreads) {
+                if (!qi.is_deleted(LocalT(x)) && qi.is_owned(LocalT(x))) {
+                    update_element(attributes, p, map[x], q, x);
+                }
+            }
+        }(),
+        ...);
+    block.sync();
+
+    // q does not have any element anymore
+    auto clear_masks = [&](uint16_t num, uint32_t* active, uint32_t* owned) {
+        for (uint16_t i = threadIdx.x; i < DIVIDE_UP(num, 32);
+             i += blockThreads) {
+            active[i] = 0;
+            owned[i]  = 0;
+        }
+    };
+    clear_masks(q_num_v, qi.active_mask_v, qi.owned_mask_v);
+    clear_masks(q_num_e, qi.active_mask_e, qi.owned_mask_e);
+    clear_masks(q_num_f, qi.active_mask_f, qi.owned_mask_f);
+
+    if (threadIdx.x == 0) {
+        pi.num_vertices[0] = p_num_v + s_count_v[0];
+        pi.num_edges[0]    = p_num_e + s_count_e[0];
+        pi.num_faces[0]    = p_num_f + s_count_f[0];
+
+        ::atomicMax(context.m_max_num_vertices, uint32_t(pi.num_vertices[0]));
+        ::atomicMax(context.m_max_num_edges, uint32_t(pi.num_edges[0]));
+        ::atomicMax(context.m_max_num_faces, uint32_t(pi.num_faces[0]));
+
+        set_patch_dirty(context.m_patches_info[p]);
+        set_patch_dirty(context.m_patches_info[q]);
+        context.bump_patch_version(p);
+        context.bump_patch_version(q);
+    }
+}
+
+/**
+ * @brief move the patches deferred by a persistent kernel back to the queue.
+ * Launched with a single block
+ */
+template <uint32_t blockThreads>
+__global__ static void requeue_deferred_patches(PatchScheduler scheduler)
+{
+    const int num_deferred = scheduler.num_deferred[0];
+
+    for (int i = threadIdx.x; i < num_deferred; i += blockThreads) {
+        scheduler.push(scheduler.deferred_list[i]);
+    }
+    __syncthreads();
+
+    if (threadIdx.x == 0) {
+        scheduler.num_deferred[0] = 0;
+    }
+}
 }  // namespace detail
 
 
@@ -613,9 +1013,15 @@ class RXMeshDynamic : public RXMeshStatic
    public:
     RXMeshDynamic(const RXMeshDynamic&) = delete;
 
+    // the compressed topology is not updated by topology changes
+    bool enable_compressed_topology() = delete;
+
+    // the owner table is not updated by topology changes
+    void enable_owner_table() = delete;
+
     /**
-     * @brief Constructor using path to obj file
-     * @param file_path path to an obj file
+     * @brief Constructor using path to obj or ply file
+     * @param file_path path to an obj or ply file
      */
     explicit RXMeshDynamic(const std::string file_path,
                            const std::string patcher_file             = "",
@@ -625,6 +1031,7 @@ class RXMeshDynamic : public RXMeshStatic
                            const float       lp_hashtable_load_factor = 0.5)
         : RXMeshStatic(file_path,
                        patcher_file,
+                       false,
                        patch_size,
                        capacity_factor,
                        patch_alloc_factor,
@@ -645,6 +1052,31 @@ class RXMeshDynamic : public RXMeshStatic
         : RXMeshStatic(fv,
                        patcher_file,
                        patch_size,
+                       false,
+                       capacity_factor,
+                       patch_alloc_factor,
+                       lp_hashtable_load_factor)
+    {
+    }
+
+    /**
+     * @brief Constructor using a flat triangle index buffer
+     * @param fv face incident vertices (3*num_faces) where face f is
+     * (fv[3*f], fv[3*f+1], fv[3*f+2])
+     * @param num_faces number of faces
+     */
+    explicit RXMeshDynamic(const uint32_t*   fv,
+                           const uint32_t    num_faces,
+                           const std::string patcher_file             = "",
+                           const uint32_t    patch_size               = 256,
+                           const float       capacity_factor          = 3.5,
+                           const float       patch_alloc_factor       = 5.0,
+                           const float       lp_hashtable_load_factor = 0.5)
+        : RXMeshStatic(fv,
+                       num_faces,
+                       patcher_file,
+                       patch_size,
+                       false,
                        capacity_factor,
                        patch_alloc_factor,
                        lp_hashtable_load_factor)
@@ -891,7 +1323,344 @@ class RXMeshDynamic : public RXMeshStatic
                             false);
     }
 
-    virtual ~RXMeshDynamic() = default;
+    virtual ~RXMeshDynamic()
+    {
+        GPU_FREE(m_d_cavity_stats);
+        enable_inverse_hashtable_cache(false);
+        free_cavity_trace();
+        GPU_FREE(m_d_cleanup_buffer);
+        GPU_FREE(m_d_merge_buffer);
+        GPU_FREE(m_d_merge_map);
+        GPU_FREE(m_d_grow_buffer);
+        free_change_log();
+    }
+
+    /**
+     * @brief enable (or disable) collecting statistics about the cavity
+     * operations (number of created/conflicting/committed cavities, lock
+     * failures, slicing, and re-pushed patches). The counters are updated by
+     * CavityManager with one atomic operation per block and statistic and are
+     * aggregated over all kernel launches until reset_cavity_stats(). The
+     * context (get_context()) should be taken after calling this function
+     */
+    void enable_cavity_stats(bool enable = true)
+    {
+        if (enable && m_d_cavity_stats == nullptr) {
+            CUDA_ERROR(tracked_malloc(
+                (void**)&m_d_cavity_stats,
+                uint32_t(CavityStat::Count) * sizeof(unsigned long long),
+                MemoryCategory::Topology));
+            reset_cavity_stats();
+        }
+        if (!enable) {
+            GPU_FREE(m_d_cavity_stats);
+        }
+        this->m_rxmesh_context.m_cavity_stats = m_d_cavity_stats;
+    }
+
+    /**
+     * @brief reset the cavity statistics counters to zero
+     */
+    void reset_cavity_stats(cudaStream_t stream = NULL)
+    {
+        if (m_d_cavity_stats != nullptr) {
+            CUDA_ERROR(cudaMemsetAsync(
+                m_d_cavity_stats,
+                0,
+                uint32_t(CavityStat::Count) * sizeof(unsigned long long),
+                stream));
+        }
+    }
+
+    /**
+     * @brief enable (or disable) caching the inverted LP hashtables that
+     * CavityManager builds for every patch it processes such that a patch that
+     * is processed again (in the same or a later kernel launch) without being
+     * modified in between loads them instead of re-building them. This mostly
+     * benefits patches that failed to lock their neighbor patches or to
+     * migrate their cavities. The cache uses one slot per patch and element
+     * type sized to the current max LP hashtable capacity; patches whose
+     * hashtables grow beyond it are not cached. The context (get_context())
+     * should be taken after calling this function
+     */
+    void enable_inverse_hashtable_cache(bool enable = true)
+    {
+        InverseHashtableCache& cache = this->m_rxmesh_context.m_inv_lp_cache;
+
+        if (enable && cache.m_table == nullptr) {
+            const uint32_t max_p = get_max_num_patches();
+
+            cache.m_slot_size =
+                uint32_t(std::max({max_lp_hashtable_capacity<LocalVertexT>(),
+                                   max_lp_hashtable_capacity<LocalEdgeT>(),
+                                   max_lp_hashtable_capacity<LocalFaceT>()})) +
+                InverseHashtableCache::stash_size;
+            cache.m_num_patches = max_p;
+
+            CUDA_ERROR(tracked_malloc(
+                (void**)&cache.m_table,
+                size_t(3) * max_p * cache.m_slot_size * sizeof(LPPair),
+                MemoryCategory::Topology));
+            CUDA_ERROR(tracked_malloc((void**)&cache.m_version,
+                                      max_p * sizeof(uint32_t),
+                                      MemoryCategory::Topology));
+            CUDA_ERROR(tracked_malloc((void**)&cache.m_cached_version,
+                                      max_p * sizeof(uint32_t),
+                                      MemoryCategory::Topology));
+            CUDA_ERROR(tracked_malloc((void**)&cache.m_capacity,
+                                      3 * max_p * sizeof(uint16_t),
+                                      MemoryCategory::Topology));
+            CUDA_ERROR(
+                cudaMemset(cache.m_version, 0, max_p * sizeof(uint32_t)));
+            cache.invalidate_all();
+        }
+        if (!enable) {
+            GPU_FREE(cache.m_table);
+            GPU_FREE(cache.m_version);
+            GPU_FREE(cache.m_cached_version);
+            GPU_FREE(cache.m_capacity);
+            cache = InverseHashtableCache();
+        }
+    }
+
+    /**
+     * @brief return the cavity statistics aggregated since the last
+     * reset_cavity_stats(). All counters are zero if the statistics are not
+     * enabled. This synchronizes the stream
+     */
+    CavityStats get_cavity_stats(cudaStream_t stream = NULL) const
+    {
+        CavityStats stats;
+        if (m_d_cavity_stats != nullptr) {
+            unsigned long long h_counters[uint32_t(CavityStat::Count)];
+            CUDA_ERROR(cudaMemcpyAsync(h_counters,
+                                       m_d_cavity_stats,
+                                       sizeof(h_counters),
+                                       cudaMemcpyDeviceToHost,
+                                       stream));
+            CUDA_ERROR(cudaStreamSynchronize(stream));
+            stats.set(h_counters);
+        }
+        return stats;
+    }
+
+    /**
+     * @brief enable (or disable) the cavity trace. When enabled, CavityManager
+     * records a timestamped event (CavityTraceType) whenever a patch is popped,
+     * locked, fails to lock, is found dirty, creates cavities, is sliced,
+     * pushed again, or is done. Each block writes to one of num_slots ring
+     * buffers (with capacity records each) with one atomic operation per
+     * event. The trace is aggregated over all kernel launches until
+     * reset_cavity_trace() and can be exported as a Chrome/Perfetto timeline
+     * per SM using export_cavity_trace(). The context (get_context()) should
+     * be taken after calling this function
+     */
+    void enable_cavity_trace(const uint32_t num_slots = 128,
+                             const uint32_t capacity  = 4096,
+                             bool           enable    = true)
+    {
+        free_cavity_trace();
+        if (enable) {
+            if (num_slots == 0 || capacity == 0) {
+                RXMESH_ERROR(
+                    "RXMeshDynamic::enable_cavity_trace() num_slots and "
+                    "capacity should be positive");
+                return;
+            }
+            m_cavity_trace.m_num_slots = num_slots;
+            m_cavity_trace.m_capacity  = capacity;
+            CUDA_ERROR(tracked_malloc(
+                (void**)&m_cavity_trace.m_records,
+                size_t(num_slots) * capacity * sizeof(CavityTraceRecord),
+                MemoryCategory::Topology));
+            CUDA_ERROR(tracked_malloc((void**)&m_cavity_trace.m_count,
+                                      num_slots * sizeof(uint32_t),
+                                      MemoryCategory::Topology));
+            reset_cavity_trace();
+        }
+        this->m_rxmesh_context.m_cavity_trace = m_cavity_trace;
+    }
+
+    /**
+     * @brief drop all the records of the cavity trace
+     */
+    void reset_cavity_trace(cudaStream_t stream = NULL)
+    {
+        if (m_cavity_trace.is_enabled()) {
+            CUDA_ERROR(cudaMemsetAsync(m_cavity_trace.m_count,
+                                       0,
+                                       m_cavity_trace.m_num_slots *
+                                           sizeof(uint32_t),
+                                       stream));
+        }
+    }
+
+    /**
+     * @brief return the cavity trace recorded since the last
+     * reset_cavity_trace() sorted by SM and then by clock. The trace is empty
+     * if it is not enabled. This synchronizes the stream
+     */
+    CavityTrace get_cavity_trace(cudaStream_t stream = NULL) const
+    {
+        CavityTrace trace;
+        if (!m_cavity_trace.is_enabled()) {
+            return trace;
+        }
+
+        const uint32_t num_slots = m_cavity_trace.m_num_slots;
+        const uint32_t capacity  = m_cavity_trace.m_capacity;
+
+        std::vector<uint32_t>          h_count(num_slots);
+        std::vector<CavityTraceRecord> h_records(size_t(num_slots) * capacity);
+
+        CUDA_ERROR(cudaMemcpyAsync(h_count.data(),
+                                   m_cavity_trace.m_count,
+                                   num_slots * sizeof(uint32_t),
+                                   cudaMemcpyDeviceToHost,
+                                   stream));
+        CUDA_ERROR(cudaMemcpyAsync(h_records.data(),
+                                   m_cavity_trace.m_records,
+                                   h_records.size() * sizeof(CavityTraceRecord),
+                                   cudaMemcpyDeviceToHost,
+                                   stream));
+        CUDA_ERROR(cudaStreamSynchronize(stream));
+
+        for (uint32_t s = 0; s < num_slots; ++s) {
+            const uint32_t num = std::min(h_count[s], capacity);
+            trace.num_dropped += h_count[s] - num;
+            trace.records.insert(trace.records.end(),
+                                 h_records.begin() + size_t(s) * capacity,
+                                 h_records.begin() + size_t(s) * capacity +
+                                     num);
+        }
+
+        std::sort(trace.records.begin(),
+                  trace.records.end(),
+                  [](const CavityTraceRecord& a, const CavityTraceRecord& b) {
+                      if (a.sm != b.sm) {
+                          return a.sm < b.sm;
+                      }
+                      return a.clock < b.clock;
+                  });
+
+        int device_id;
+        CUDA_ERROR(cudaGetDevice(&device_id));
+        cudaDeviceProp prop;
+        CUDA_ERROR(cudaGetDeviceProperties(&prop, device_id));
+        trace.clock_rate_khz = prop.clockRate;
+
+        return trace;
+    }
+
+    /**
+     * @brief write the cavity trace (get_cavity_trace()) to a Chrome trace
+     * JSON file that can be viewed with Perfetto (ui.perfetto.dev) or
+     * chrome://tracing. See CavityTrace::write_chrome_trace()
+     */
+    bool export_cavity_trace(const std::string& filename,
+                             cudaStream_t       stream = NULL) const
+    {
+        const CavityTrace trace = get_cavity_trace(stream);
+        if (trace.num_dropped > 0) {
+            RXMESH_WARN(
+                "RXMeshDynamic::export_cavity_trace() {} records were "
+                "overwritten. Consider increasing the capacity passed to "
+                "enable_cavity_trace()",
+                trace.num_dropped);
+        }
+        return trace.write_chrome_trace(filename);
+    }
+
+    /**
+     * @brief enable (or disable) the topology change log. When enabled,
+     * CavityManager::epilogue() appends the handles of the created and deleted
+     * vertices/edges/faces of every committed cavity (and the elements whose
+     * owner patch changed) to a device log such that consumers (e.g.,
+     * renderer, checkpoint, network sync) can apply the changes as deltas
+     * using drain_change_log() instead of taking full snapshots. The context
+     * (get_context()) should be taken after calling this function
+     * @param capacity max number of changes recorded between two drains. More
+     * changes are counted but not recorded
+     */
+    void enable_change_log(const uint64_t capacity = 1 << 20,
+                           bool           enable   = true)
+    {
+        free_change_log();
+        if (enable) {
+            m_change_log.m_capacity = capacity;
+            CUDA_ERROR(tracked_malloc((void**)&m_change_log.m_entries,
+                                      capacity * sizeof(ChangeLogEntry),
+                                      MemoryCategory::Topology));
+            CUDA_ERROR(tracked_malloc((void**)&m_change_log.m_count,
+                                      sizeof(unsigned long long),
+                                      MemoryCategory::Topology));
+            CUDA_ERROR(cudaMemset(
+                m_change_log.m_count, 0, sizeof(unsigned long long)));
+            for (int i = 0; i < 2; ++i) {
+                CUDA_ERROR(cudaMallocHost((void**)&m_h_change_log[i],
+                                          capacity * sizeof(ChangeLogEntry)));
+            }
+            m_change_log_patches_changed = false;
+        }
+        this->m_rxmesh_context.m_change_log = m_change_log;
+    }
+
+    /**
+     * @brief check if the topology change log is enabled
+     */
+    bool is_change_log_enabled() const
+    {
+        return m_change_log.is_enabled();
+    }
+
+    /**
+     * @brief drain the changes recorded since the last drain to the host. Only
+     * the number of changes is read synchronously, the entries are copied
+     * asynchronously (on the stream) into a pinned host buffer that stays
+     * valid until the second next drain so the previous batch can be consumed
+     * while this one is copied. Kernels that record changes should be done or
+     * launched on the same stream
+     * @return the drained batch. The entries can be read after synchronizing
+     * the stream. If the batch is not complete (ChangeLogBatch::is_complete())
+     * the consumer should fall back to a full snapshot
+     */
+    ChangeLogBatch drain_change_log(cudaStream_t stream = NULL)
+    {
+        ChangeLogBatch batch;
+        if (!is_change_log_enabled()) {
+            return batch;
+        }
+
+        unsigned long long h_count = 0;
+        CUDA_ERROR(cudaMemcpyAsync(&h_count,
+                                   m_change_log.m_count,
+                                   sizeof(unsigned long long),
+                                   cudaMemcpyDeviceToHost,
+                                   stream));
+        CUDA_ERROR(cudaStreamSynchronize(stream));
+
+        batch.num_changes = h_count;
+        batch.num_entries =
+            std::min(batch.num_changes, m_change_log.m_capacity);
+        batch.entries         = m_h_change_log[m_change_log_buffer];
+        batch.patches_changed = m_change_log_patches_changed;
+
+        if (batch.num_entries > 0) {
+            CUDA_ERROR(
+                cudaMemcpyAsync(m_h_change_log[m_change_log_buffer],
+                                m_change_log.m_entries,
+                                batch.num_entries * sizeof(ChangeLogEntry),
+                                cudaMemcpyDeviceToHost,
+                                stream));
+        }
+        CUDA_ERROR(cudaMemsetAsync(
+            m_change_log.m_count, 0, sizeof(unsigned long long), stream));
+
+        m_change_log_buffer ^= 1;
+        m_change_log_patches_changed = false;
+
+        return batch;
+    }
 
     /**
      * @brief check if there is remaining patches not processed yet
@@ -902,6 +1671,291 @@ class RXMeshDynamic : public RXMeshStatic
     }
 
 
+    /**
+     * @brief run a cavity kernel in persistent mode. The kernel is launched
+     * with only as many blocks as can be resident on the device and each
+     * block uses for_each_cavity_patch() to keep popping patches from the
+     * queue. A patch that fails because of a locking conflict is pushed back
+     * and picked up again within the same launch. A patch that can only make
+     * progress after cleanup() or slice_patches() (i.e., a dirty patch, a
+     * patch with a dirty neighbor, or a patch that should be sliced) is
+     * deferred. Once the queue drains, the patches are cleaned up and sliced
+     * and the deferred patches are moved back to the queue. This is repeated
+     * until nothing is left in the queue. Compared to launching a regular
+     * cavity kernel until is_queue_empty(), the locking conflicts are resolved
+     * on the device without a kernel launch and a device-to-host copy per
+     * retry. Before calling this, the queue should be filled (e.g., using
+     * reset_scheduler())
+     * @param lb launch box of the kernel as computed by update_launch_box()
+     * @param kernel the kernel used to compute the number of resident blocks
+     * @param launch host function that launches the kernel. It takes the
+     * number of blocks and the context (that should be passed to the kernel)
+     * i.e., [&](uint32_t blocks, const Context& context){ kernel<<<blocks,
+     * lb.num_threads, lb.smem_bytes_dyn>>>(context, ...); }
+     * @param attributes the attributes to be updated when patches are sliced
+     * (same as slice_patches())
+     * @return the number of kernel launches
+     */
+    template <uint32_t blockThreads, typename LaunchT, typename... AttributesT>
+    uint32_t run_persistent(const LaunchBox<blockThreads>& lb,
+                            const void*                    kernel,
+                            LaunchT                        launch,
+                            AttributesT... attributes)
+    {
+        int device_id;
+        CUDA_ERROR(cudaGetDevice(&device_id));
+        int num_sms = 0;
+        CUDA_ERROR(cudaDeviceGetAttribute(
+            &num_sms, cudaDevAttrMultiProcessorCount, device_id));
+
+        int blocks_per_sm = 0;
+        CUDA_ERROR(cudaOccupancyMaxActiveBlocksPerMultiprocessor(
+            &blocks_per_sm, kernel, blockThreads, lb.smem_bytes_dyn));
+
+        const uint32_t max_resident =
+            uint32_t(std::max(blocks_per_sm, 1) * num_sms);
+        const uint32_t num_blocks =
+            std::max(1u, std::min(lb.blocks, max_resident));
+
+        Context context                      = this->m_rxmesh_context;
+        context.m_patch_scheduler.persistent = true;
+
+        uint32_t num_launches = 0;
+
+        while (!is_queue_empty()) {
+            launch(num_blocks, context);
+            num_launches++;
+
+            cleanup_and_slice(attributes...);
+
+            detail::requeue_deferred_patches<256>
+                <<<1, 256>>>(this->m_rxmesh_context.m_patch_scheduler);
+        }
+
+        return num_launches;
+    }
+
+    /**
+     * @brief run one sweep of a cavity kernel scheduled by the patch graph
+     * coloring. The patches of one color class are processed per round. Since
+     * the coloring is a distance-2 coloring, patches of the same color do not
+     * share a neighbor patch and CavityManager processes them without locking
+     * the patches (and so without lock failures). This assumes that the
+     * cavities stay within the one ring of their patch. Within a round, the
+     * kernel is launched again on the patches of this color that could not be
+     * processed (e.g., patches that should be sliced) until there is none
+     * left. After slicing creates new patches, the coloring is repaired such
+     * that the new patches (and any patch whose color conflicts with a
+     * distance-2 neighbor) get a valid color. Patches created during the
+     * sweep are processed in their color round if it did not pass yet or in
+     * the next call to this function
+     * @param lb launch box of the kernel as computed by update_launch_box()
+     * @param launch host function that launches the kernel. It takes the
+     * number of blocks, the context (that should be passed to the kernel),
+     * and the current color i.e., [&](uint32_t blocks, const Context&
+     * context, uint32_t color){ kernel<<<blocks, lb.num_threads,
+     * lb.smem_bytes_dyn>>>(context, ...); }
+     * @param attributes the attributes to be updated when patches are sliced
+     * (same as slice_patches())
+     * @return the number of kernel launches
+     */
+    template <uint32_t blockThreads, typename LaunchT, typename... AttributesT>
+    uint32_t run_colored(const LaunchBox<blockThreads>& lb,
+                         LaunchT                        launch,
+                         AttributesT... attributes)
+    {
+        Context context                     = this->m_rxmesh_context;
+        context.m_patch_scheduler.lock_free = true;
+
+        uint32_t num_launches = 0;
+
+        for (uint32_t c = 0; c < get_num_colors(); ++c) {
+            if (reset_scheduler(c) == 0) {
+                continue;
+            }
+
+            while (!is_queue_empty()) {
+                const uint32_t num_patches = get_num_patches();
+
+                launch(lb.blocks, context, c);
+                num_launches++;
+
+                cleanup_and_slice(attributes...);
+
+                if (get_num_patches() != num_patches) {
+                    repair_patch_coloring(num_patches);
+                }
+
+                // only keep the patches of this color (i.e., drop the patches
+                // added to the queue by slicing)
+                keep_color_in_queue(c);
+            }
+        }
+
+        return num_launches;
+    }
+
+    /**
+     * @brief split every edge marked (true) in edge_mask by inserting a new
+     * vertex connected to the four vertices of the edge diamond. Boundary and
+     * degenerate edges are skipped. This runs the scheduler loop (with cleanup
+     * and slicing) until all marked edges are either split or skipped, or no
+     * edge could be split in a full sweep over the patches. On return,
+     * edge_mask is false for all edges including the new ones except for the
+     * edges that could not be split due to conflicts
+     * @param edge_mask the edges to split
+     * @param interp (device) functor that sets the attributes of the new
+     * vertex given the new vertex, the two edge end vertices, and the split
+     * edge (e.g., MidpointInterpolation)
+     * @param attributes all attributes that should be kept consistent (e.g.,
+     * the ones written by interp) when patches are modified and sliced
+     * @return the number of split edges
+     */
+    template <typename InterpT, typename... AttributesT>
+    uint32_t split_edges(EdgeAttribute<bool>& edge_mask,
+                         InterpT              interp,
+                         AttributesT... attributes)
+    {
+        constexpr uint32_t blockThreads = 256;
+
+        const void* kernel =
+            (void*)detail::split_edges<blockThreads, InterpT, AttributesT...>;
+
+        LaunchBox<blockThreads> lb;
+        update_launch_box({Op::EVDiamond},
+                          lb,
+                          kernel,
+                          true,
+                          false,
+                          false,
+                          false,
+                          [](uint32_t v, uint32_t e, uint32_t f) {
+                              return detail::mask_num_bytes(e) +
+                                     ShmemAllocator::default_alignment;
+                          });
+
+        return run_batched_cavity_op(
+            [&](const uint32_t num_blocks, uint32_t* d_count) {
+                detail::split_edges<blockThreads>
+                    <<<num_blocks, lb.num_threads, lb.smem_bytes_dyn>>>(
+                        this->m_rxmesh_context,
+                        edge_mask,
+                        interp,
+                        d_count,
+                        attributes...);
+            },
+            edge_mask,
+            attributes...);
+    }
+
+    /**
+     * @brief collapse every edge marked (true) in edge_mask into a new vertex.
+     * Boundary and degenerate edges and edges that fail the link condition are
+     * skipped. Similar to split_edges(), the scheduler loop runs until no
+     * more edges could be collapsed
+     * @param edge_mask the edges to collapse
+     * @param interp (device) functor that sets the attributes of the new
+     * vertex given the new vertex, the two edge end vertices, and the
+     * collapsed edge (e.g., MidpointInterpolation or EdgeValueInterpolation)
+     * @param attributes all attributes that should be kept consistent
+     * @return the number of collapsed edges
+     */
+    template <typename InterpT, typename... AttributesT>
+    uint32_t collapse_edges(EdgeAttribute<bool>& edge_mask,
+                            InterpT              interp,
+                            AttributesT... attributes)
+    {
+        constexpr uint32_t blockThreads = 256;
+
+        const void* kernel = (void*)
+            detail::collapse_edges<blockThreads, InterpT, AttributesT...>;
+
+        LaunchBox<blockThreads> lb;
+        update_launch_box({Op::EVDiamond},
+                          lb,
+                          kernel,
+                          true,
+                          false,
+                          false,
+                          false,
+                          [](uint32_t v, uint32_t e, uint32_t f) {
+                              return detail::mask_num_bytes(e) +
+                                     ShmemAllocator::default_alignment +
+                                     link_condition_shmem_bytes(v, e);
+                          });
+
+        return run_batched_cavity_op(
+            [&](const uint32_t num_blocks, uint32_t* d_count) {
+                detail::collapse_edges<blockThreads>
+                    <<<num_blocks, lb.num_threads, lb.smem_bytes_dyn>>>(
+                        this->m_rxmesh_context,
+                        edge_mask,
+                        interp,
+                        d_count,
+                        attributes...);
+            },
+            edge_mask,
+            attributes...);
+    }
+
+    /**
+     * @brief flip every edge marked (true) in edge_mask. Boundary and
+     * degenerate edges, edges with an end vertex of valence 3, and edges that
+     * fail the link condition are skipped. Similar to split_edges(), the
+     * scheduler loop runs until no more edges could be flipped
+     * @param edge_mask the edges to flip
+     * @param attributes all attributes that should be kept consistent
+     * @return the number of flipped edges
+     */
+    template <typename... AttributesT>
+    uint32_t flip_edges(EdgeAttribute<bool>& edge_mask,
+                        AttributesT... attributes)
+    {
+        constexpr uint32_t blockThreads = 256;
+
+        const void* kernel =
+            (void*)detail::flip_edges<blockThreads, AttributesT...>;
+
+        LaunchBox<blockThreads> lb;
+        update_launch_box({Op::EVDiamond},
+                          lb,
+                          kernel,
+                          true,
+                          false,
+                          true,
+                          false,
+                          [](uint32_t v, uint32_t e, uint32_t f) {
+                              return detail::mask_num_bytes(e) +
+                                     ShmemAllocator::default_alignment +
+                                     link_condition_shmem_bytes(v, e);
+                          });
+
+        return run_batched_cavity_op(
+            [&](const uint32_t num_blocks, uint32_t* d_count) {
+                detail::flip_edges<blockThreads>
+                    <<<num_blocks, lb.num_threads, lb.smem_bytes_dyn>>>(
+                        this->m_rxmesh_context,
+                        edge_mask,
+                        d_count,
+                        attributes...);
+            },
+            edge_mask,
+            attributes...);
+    }
+
+    /**
+     * @brief fill the queue with the patches of one color
+     * @return the number of patches added to the queue
+     */
+    uint32_t reset_scheduler(const uint32_t color);
+
+    /**
+     * @brief fill the queue with a subset of the patches, e.g., the patches
+     * that have not converged yet. Invalid patch ids are ignored
+     * @return the number of patches added to the queue
+     */
+    uint32_t reset_scheduler(const std::vector<uint32_t>& patches);
+
     /**
      * @brief reset the patches for a another kernel. This needs only to be
      * called where more than one kernel is called. For a single kernel, the
@@ -916,21 +1970,216 @@ class RXMeshDynamic : public RXMeshStatic
     /**
      * @brief Validate the topology information stored in RXMesh. All checks are
      * done on the information stored on the GPU memory and thus all checks are
-     * done on the GPU
+     * done on the GPU. There is no need to call update_host() before
+     * validation. Failed checks are reported as errors
      * @return true in case all information stored are valid
      */
     bool validate();
 
+    /**
+     * @brief Validate the topology information stored in RXMesh (see
+     * validate()) and return the number of errors found by every check along
+     * with the first patch that failed each check. Only the report is copied
+     * from the device
+     * @param report the output report
+     * @return true in case all information stored are valid
+     */
+    bool validate(ValidationReport& report);
+
     /**
      * @brief cleanup after topology changes by removing surplus elements
-     * and make sure that hashtable store owner patches. Also, reset the number
-     * of vertices/edges/faces
+     * and make sure that hashtable store owner patches. Also, update the number
+     * of vertices/edges/faces. Only the patches that were modified since the
+     * last cleanup (i.e., dirty patches, sliced patches, and the new patches
+     * created by slicing) are cleaned up along with the hashtables of their
+     * neighbor patches such that the cost is proportional to the number of
+     * modified patches. The first call (and any call with full = true)
+     * cleans up all patches and recounts the number of vertices/edges/faces
+     * from scratch. After an incremental cleanup, the per-patch max number of
+     * vertices/edges/faces is an upper bound since it does not shrink
+     */
+    void cleanup(const bool full = false);
+
+    /**
+     * @brief the number of patches whose surplus elements were removed by the
+     * last call to cleanup()
+     */
+    uint32_t get_num_cleaned_patches() const
+    {
+        return m_num_cleaned_patches;
+    }
+
+    /**
+     * @brief switch to adaptive per-patch capacity. All patches are first
+     * shrunk such that their element arrays and hashtables fit their current
+     * size (times headroom). From then on, cleanup() grows (reallocates) the
+     * element arrays and hashtables of the patches that ran out of capacity
+     * (i.e., flagged to be sliced) by growth_factor instead of leaving them to
+     * be sliced. A patch can not grow beyond the per-patch max capacity (e.g.,
+     * get_per_patch_max_vertex_capacity()) since this is what the shared
+     * memory of the kernels is sized for and so a patch at the max capacity
+     * is sliced as before. The extra patches (used by slicing) are kept at
+     * the max capacity. A checkpoint saved with adaptive capacity can only be
+     * loaded into a mesh with the same per-patch capacities
+     * @param headroom the capacity of a patch after shrinking as a factor of
+     * its current number of vertices/edges/faces/not-owned elements
+     * @param growth_factor the factor by which the capacity of a patch grows
+     */
+    void enable_adaptive_capacity(const float headroom      = 1.2f,
+                                  const float growth_factor = 2.0f);
+
+    /**
+     * @brief true if enable_adaptive_capacity() was called
+     */
+    bool is_adaptive_capacity_enabled() const
+    {
+        return m_adaptive_capacity;
+    }
+
+    /**
+     * @brief the number of patches whose capacity was grown by the last call
+     * to cleanup() (see enable_adaptive_capacity())
+     */
+    uint32_t get_num_grown_patches() const
+    {
+        return m_num_grown_patches;
+    }
+
+    /**
+     * @brief cleanup, slice the patches that should be sliced, and cleanup
+     * the sliced patches. This replaces calling cleanup(), slice_patches(),
+     * and cleanup() where the second cleanup only touches the sliced patches
+     * (and their neighbors) and is skipped if no patch was sliced
+     * @param attributes the attributes to be updated when patches are sliced
+     * (same as slice_patches())
+     */
+    template <typename... AttributesT>
+    void cleanup_and_slice(AttributesT... attributes)
+    {
+        const uint32_t num_patches = get_num_patches();
+
+        // slicing requires the neighbor patches to be clean
+        cleanup();
+        slice_patches(attributes...);
+
+        if (get_num_patches() != num_patches) {
+            cleanup();
+        }
+    }
+
+    /**
+     * @brief reinitialize the owned elements of a deferred attribute (see
+     * defer_update()) that are marked dirty and reset their dirty flag. This
+     * repairs all the elements moved by the topology changes since the last
+     * repair in one launch and is meant to be called after cleanup()
+     * @param deferred the deferred attribute
+     * @param reinit [=] __device__(const HandleT& h, AttributeT& attribute)
+     * that sets the value of h
+     * @param stream the stream to run the repair on
+     */
+    template <typename AttributeT, typename LambdaT>
+    void repair_attribute(
+        const AttributeUpdatePolicy<AttributeT, AttributeUpdate::Defer>&
+                     deferred,
+        LambdaT      reinit,
+        cudaStream_t stream = NULL)
+    {
+        using HandleT = typename AttributeT::HandleType;
+
+        AttributeT               attribute = deferred.attribute;
+        Attribute<bool, HandleT> dirty     = deferred.dirty;
+
+        this->template for_each<HandleT>(
+            DEVICE,
+            [=] __device__(const HandleT h) mutable {
+                if (dirty(h)) {
+                    reinit(h, attribute);
+                    dirty(h) = false;
+                }
+            },
+            stream);
+    }
+
+    /**
+     * @brief merge underfull patches into one of their neighbor patches. This
+     * is the reverse of slice_patches() and meant to be used after heavy
+     * decimation where many patches end up (nearly) empty. A patch with fewer
+     * owned faces than fill_ratio * get_patch_size() is merged into its
+     * neighbor patch with the fewest owned faces if the union fits in the
+     * capacity of the neighbor. The merged patch is left empty (its patch id
+     * is not reused) and so its block exits immediately in later kernels. A
+     * patch is merged or receives a merged patch at most once per call which
+     * can be called again to merge more patches. The mesh is cleaned up
+     * before and after merging
+     * @param fill_ratio the ratio of the patch size below which a patch is
+     * merged
+     * @param attributes the attributes to be moved to the patch a patch is
+     * merged into (same as slice_patches())
+     * @return the number of merged patches
+     */
+    template <typename... AttributesT>
+    uint32_t merge_patches(const float fill_ratio, AttributesT... attributes)
+    {
+        constexpr uint32_t block_size = 256;
+
+        // merging relies on up-to-date hashtables and number of owned
+        // elements per patch
+        cleanup();
+
+        if (select_merge_patches(fill_ratio) == 0) {
+            return 0;
+        }
+
+        const uint16_t cap_v = get_per_patch_max_vertex_capacity();
+        const uint16_t cap_e = get_per_patch_max_edge_capacity();
+        const uint16_t cap_f = get_per_patch_max_face_capacity();
+
+        // owner and local index in owner of the merged patch elements
+        uint32_t dyn_shmem =
+            4 * ShmemAllocator::default_alignment +
+            std::max(cap_v, std::max(cap_e, cap_f)) * sizeof(uint32_t) +
+            (cap_v + cap_e + cap_f) * sizeof(uint16_t);
+
+        CUDA_ERROR(cudaFuncSetAttribute(
+            (void*)detail::merge_patches<block_size, AttributesT...>,
+            cudaFuncAttributeMaxDynamicSharedMemorySize,
+            dyn_shmem));
+
+        const uint32_t max_p = get_max_num_patches();
+
+        detail::merge_patches<block_size>
+            <<<get_num_patches(), block_size, dyn_shmem>>>(
+                this->m_rxmesh_context,
+                m_d_merge_buffer,
+                m_d_merge_buffer + 2 * max_p,
+                m_d_merge_map,
+                cap_v,
+                cap_e,
+                cap_f,
+                attributes...);
+
+        return finish_merge_patches();
+    }
+
+    using RXMeshStatic::get_max_min_avg_patch_size;
+
+    /**
+     * @brief Return the max, min, and average patch size i.e., number of
+     * owned faces per (non-empty) patch. If from_device is true, the sizes are
+     * computed from the current patches on the device (as of the last
+     * cleanup()) instead of the input mesh
      */
-    void cleanup();
+    void get_max_min_avg_patch_size(uint32_t&  min_p,
+                                    uint32_t&  max_p,
+                                    uint32_t&  avg_p,
+                                    const bool from_device);
 
     /**
      * @brief slice a patch if the number of faces in the patch is greater
      * than a threshold
+     * @param attributes the attributes to be moved to the new patches. An
+     * attribute could be passed with an update policy (see skip_update() and
+     * defer_update()) such that only the needed data is moved
      */
     template <typename... AttributesT>
     void slice_patches(AttributesT... attributes)
@@ -999,10 +2248,19 @@ class RXMeshDynamic : public RXMeshStatic
                             (void*)detail::slice_patches<block_size>,
                             false);
 
+        const uint32_t num_patches = get_num_patches();
+
         detail::slice_patches<block_size><<<grid_size, block_size, dyn_shmem>>>(
             this->m_rxmesh_context, get_max_num_patches(), attributes...);
 
-        this->get_num_patches(true);
+        if (this->get_num_patches(true) != num_patches) {
+            m_change_log_patches_changed = true;
+            this->m_rxmesh_context.m_inv_lp_cache.invalidate_all();
+            this->invalidate_element_flags();
+        }
+
+        // sliced patches are re-indexed
+        this->invalidate_query_cache();
 
         // CUDA_ERROR(cudaGetLastError());
     }
@@ -1016,6 +2274,153 @@ class RXMeshDynamic : public RXMeshStatic
      */
     void update_host();
 
+    /**
+     * @brief write a binary checkpoint of the current (device) topology and
+     * the given attributes in patch-native layout i.e., the per-patch
+     * topology, masks, patch stash, and hashtables along with the patch
+     * layout of every attribute. This is meant for long running jobs with
+     * topology changes that need to be resumed later. The checkpoint can be
+     * restored with load_checkpoint() into an RXMeshDynamic constructed with
+     * the same input and parameters (using a mesh cache directory avoids
+     * re-patching the input during the construction)
+     * @param filename the output checkpoint file
+     * @param attributes the attributes (not pointers) to store
+     * @return false if the checkpoint could not be written
+     */
+    template <typename... AttributesT>
+    bool save_checkpoint(const std::string& filename,
+                         AttributesT&... attributes)
+    {
+        std::ofstream out(filename, std::ios::binary);
+        if (!out.is_open()) {
+            RXMESH_ERROR("RXMeshDynamic::save_checkpoint() can not open {}",
+                         filename);
+            return false;
+        }
+
+        if (!save_topology_checkpoint(out)) {
+            return false;
+        }
+
+        const uint32_t num_attributes = sizeof...(attributes);
+        out.write(reinterpret_cast<const char*>(&num_attributes),
+                  sizeof(uint32_t));
+
+        const bool ok = (attributes.save_checkpoint(out) && ...);
+
+        if (!ok || !out.good()) {
+            RXMESH_ERROR("RXMeshDynamic::save_checkpoint() failed to write {}",
+                         filename);
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief restore the topology and attributes from a checkpoint written by
+     * save_checkpoint(). The attributes should be passed in the same order
+     * they were saved. The host side is updated as well (see update_host())
+     * @param filename the checkpoint file
+     * @param attributes the attributes (not pointers) to restore
+     * @return false if the checkpoint does not exist or does not match this
+     * mesh. The mesh state is undefined if the failure happens after the
+     * topology is restored
+     */
+    template <typename... AttributesT>
+    bool load_checkpoint(const std::string& filename,
+                         AttributesT&... attributes)
+    {
+        std::ifstream in(filename, std::ios::binary);
+        if (!in.is_open()) {
+            RXMESH_ERROR("RXMeshDynamic::load_checkpoint() can not open {}",
+                         filename);
+            return false;
+        }
+
+        if (!load_topology_checkpoint(in)) {
+            return false;
+        }
+
+        uint32_t num_attributes = 0;
+        in.read(reinterpret_cast<char*>(&num_attributes), sizeof(uint32_t));
+        if (num_attributes != sizeof...(attributes)) {
+            RXMESH_ERROR(
+                "RXMeshDynamic::load_checkpoint() {} stores {} attributes "
+                "while {} attributes are requested",
+                filename,
+                num_attributes,
+                sizeof...(attributes));
+            return false;
+        }
+
+        return (attributes.load_checkpoint(in) && ...);
+    }
+
+    /**
+     * @brief write a checkpoint (in the same format as
+     * save_checkpoint(filename)) to a GDSFile. With GPUDirect Storage, the
+     * attributes are written directly from the device memory to the storage.
+     * The topology is written from the host mirror (which is brought
+     * up-to-date anyway) batched into large transfers. The number of written
+     * bytes and the time spent writing them could be reported with
+     * Report::file_io()
+     * @param out a GDSFile opened for writing
+     * @param attributes the attributes (not pointers) to store
+     * @return false if the checkpoint could not be written
+     */
+    template <typename... AttributesT>
+    bool save_checkpoint(GDSFile& out, AttributesT&... attributes)
+    {
+        if (!save_topology_checkpoint(out)) {
+            RXMESH_ERROR("RXMeshDynamic::save_checkpoint() failed to write {}",
+                         out.get_filename());
+            return false;
+        }
+
+        const uint32_t num_attributes = sizeof...(attributes);
+
+        const bool ok = out.write(&num_attributes, sizeof(uint32_t), HOST) &&
+                        (attributes.save_checkpoint(out) && ...);
+        if (!ok) {
+            RXMESH_ERROR("RXMeshDynamic::save_checkpoint() failed to write {}",
+                         out.get_filename());
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief restore the topology and attributes from a GDSFile holding a
+     * checkpoint written by save_checkpoint() (either from a GDSFile or a
+     * file name). With GPUDirect Storage, the per-patch topology, hashtables,
+     * and attributes are read directly into the device memory
+     * @param in a GDSFile opened for reading
+     * @param attributes the attributes (not pointers) to restore
+     * @return false if the checkpoint does not match this mesh (see
+     * load_checkpoint(filename))
+     */
+    template <typename... AttributesT>
+    bool load_checkpoint(GDSFile& in, AttributesT&... attributes)
+    {
+        if (!load_topology_checkpoint(in)) {
+            return false;
+        }
+
+        uint32_t num_attributes = 0;
+        if (!in.read(&num_attributes, sizeof(uint32_t), HOST) ||
+            num_attributes != sizeof...(attributes)) {
+            RXMESH_ERROR(
+                "RXMeshDynamic::load_checkpoint() {} stores {} attributes "
+                "while {} attributes are requested",
+                in.get_filename(),
+                num_attributes,
+                sizeof...(attributes));
+            return false;
+        }
+
+        return (attributes.load_checkpoint(in) && ...);
+    }
+
     /**
      * @brief update polyscope after performing dynamic changes. This function
      * is supposed to be called after a call to update_host since polyscope
@@ -1023,7 +2428,180 @@ class RXMeshDynamic : public RXMeshStatic
      * (stored in RXMesh/RXMeshStatic/RXMeshDynamic) and the input vertex
      * coordinates as well. Thus, a call to `move(DEVICE, HOST)` should be done
      * to RXMesh-stored vertex coordinates before calling this function.
+     * See PolyscopeInterop for visualizing the mesh directly from the device
+     * without update_host()
      */
     void update_polyscope(std::string new_name = "");
+
+   private:
+    /**
+     * @brief the scheduler loop of the batched cavity operations (e.g.,
+     * split_edges()). Sweeps over all patches until a sweep does not commit
+     * any cavity. launch takes the number of blocks and the device counter of
+     * the committed cavities
+     * @return the total number of committed cavities
+     */
+    template <typename LaunchT, typename... AttributesT>
+    uint32_t run_batched_cavity_op(LaunchT launch, AttributesT... attributes)
+    {
+        uint32_t* d_count = nullptr;
+        CUDA_ERROR(tracked_malloc((void**)&d_count,
+                                  sizeof(uint32_t),
+                                  MemoryCategory::Topology));
+
+        uint32_t total = 0;
+        while (true) {
+            CUDA_ERROR(cudaMemset(d_count, 0, sizeof(uint32_t)));
+
+            reset_scheduler();
+            while (!is_queue_empty()) {
+                launch(get_num_patches(), d_count);
+                cleanup_and_slice(attributes...);
+            }
+
+            uint32_t count = 0;
+            CUDA_ERROR(cudaMemcpy(
+                &count, d_count, sizeof(uint32_t), cudaMemcpyDeviceToHost));
+            total += count;
+            if (count == 0) {
+                break;
+            }
+        }
+
+        GPU_FREE(d_count);
+        return total;
+    }
+
+    /**
+     * @brief write/read the topology part of a checkpoint (see
+     * save_checkpoint())
+     */
+    bool save_topology_checkpoint(std::ostream& out);
+    bool load_topology_checkpoint(std::istream& in);
+    bool save_topology_checkpoint(GDSFile& out);
+    bool load_topology_checkpoint(GDSFile& in);
+
+    /**
+     * @brief the checkpoint topology format shared by the std::stream and the
+     * GDSFile variants. write(h_ptr, num_bytes) writes host memory.
+     * read(h_ptr, num_bytes) and read_to_device(d_ptr, num_bytes) read into
+     * host and device memory, respectively
+     */
+    template <typename WriteFnT>
+    void write_topology_checkpoint(WriteFnT write);
+    template <typename ReadFnT, typename ReadDeviceFnT>
+    bool read_topology_checkpoint(ReadFnT read, ReadDeviceFnT read_to_device);
+
+    /**
+     * @brief give a valid color to the patches with id >= first_new_patch
+     * (i.e., patches created by slicing) and to any patch whose color
+     * conflicts with one of its distance-2 neighbors. Update the host copy of
+     * the colors and the number of colors
+     */
+    void repair_patch_coloring(const uint32_t first_new_patch);
+
+    /**
+     * @brief remove the patches that do not have the given color from the
+     * queue
+     */
+    void keep_color_in_queue(const uint32_t color);
+
+    /**
+     * @brief pair the underfull patches with their merge target (see
+     * merge_patches()) and allocate the merge buffers
+     * @return the number of patches to be merged
+     */
+    uint32_t select_merge_patches(const float fill_ratio);
+
+    /**
+     * @brief redirect the hashtables to the merge targets, cleanup, repair
+     * the patch coloring, and free the merge buffers
+     * @return the number of merged patches
+     */
+    uint32_t finish_merge_patches();
+
+    /**
+     * @brief grow the capacity of the patches that ran out of capacity (see
+     * enable_adaptive_capacity()) and clear their should_slice flag
+     * @return the number of grown patches
+     */
+    uint32_t grow_patches();
+
+    /**
+     * @brief reallocate the element arrays and hashtables of patch p (whose
+     * device PatchInfo is d_patch) with the given capacities and write
+     * d_patch back to the device. The entries of the old hashtables are not
+     * moved to the new ones. Instead, the old v/e/f hashtables are appended to
+     * old_lp and should be passed to rehash_resized_patches() after all
+     * patches are resized
+     */
+    void resize_patch(const uint32_t            p,
+                      PatchInfo&                d_patch,
+                      const uint16_t            vertices_capacity,
+                      const uint16_t            edges_capacity,
+                      const uint16_t            faces_capacity,
+                      const uint16_t            lp_v_capacity,
+                      const uint16_t            lp_e_capacity,
+                      const uint16_t            lp_f_capacity,
+                      std::vector<LPHashTable>& old_lp);
+
+    /**
+     * @brief move the entries of the old hashtables (as returned by
+     * resize_patch()) to the new hashtables of the resized patches and free
+     * the old hashtables
+     */
+    void rehash_resized_patches(const std::vector<uint32_t>& patches,
+                                std::vector<LPHashTable>&    old_lp);
+
+    void free_cavity_trace()
+    {
+        GPU_FREE(m_cavity_trace.m_records);
+        GPU_FREE(m_cavity_trace.m_count);
+        m_cavity_trace.m_num_slots = 0;
+        m_cavity_trace.m_capacity  = 0;
+    }
+
+    void free_change_log()
+    {
+        GPU_FREE(m_change_log.m_entries);
+        GPU_FREE(m_change_log.m_count);
+        m_change_log.m_capacity = 0;
+        for (int i = 0; i < 2; ++i) {
+            if (m_h_change_log[i] != nullptr) {
+                CUDA_ERROR(cudaFreeHost(m_h_change_log[i]));
+                m_h_change_log[i] = nullptr;
+            }
+        }
+        m_change_log_buffer = 0;
+    }
+
+    unsigned long long* m_d_cavity_stats = nullptr;
+
+    // per-block ring buffers of the cavity trace (see enable_cavity_trace())
+    detail::DeviceCavityTrace m_cavity_trace;
+
+    // topology change log (see enable_change_log()), its double-buffered
+    // pinned host entries and the host buffer to be used by the next drain
+    detail::DeviceChangeLog m_change_log;
+    ChangeLogEntry*         m_h_change_log[2]            = {nullptr, nullptr};
+    uint32_t                m_change_log_buffer          = 0;
+    bool                    m_change_log_patches_changed = false;
+
+    // cleanup() worklists and the number of owned elements per patch as of
+    // the last cleanup(). Allocated by the first (full) cleanup()
+    uint32_t* m_d_cleanup_buffer    = nullptr;
+    uint32_t  m_num_cleaned_patches = 0;
+
+    // merge_patches() target/claim/slot per patch and the map from the local
+    // index in a merged patch to the local index in its target
+    uint32_t* m_d_merge_buffer = nullptr;
+    uint16_t* m_d_merge_map    = nullptr;
+
+    // adaptive per-patch capacity (see enable_adaptive_capacity()) and the
+    // list of patches to grow (and its size) used by grow_patches()
+    bool      m_adaptive_capacity      = false;
+    float     m_capacity_growth_factor = 2.0f;
+    uint32_t* m_d_grow_buffer          = nullptr;
+    uint32_t  m_num_grown_patches      = 0;
 };
 }  // namespace rxmesh
\ No newline at end of file
@@ -0,0 +1,540 @@
+#pragma once
+
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "rxmesh/attribute.h"
+#include "rxmesh/rxmesh_static.h"
+
+namespace rxmesh {
+
+template <typename T, typename HandleT>
+class MultiGPUAttribute;
+
+/**
+ * @brief Distribute a static mesh across multiple GPUs on one node. Every
+ * device holds a replica of the mesh topology (built once and shared across
+ * devices via the mesh cache so that all replicas have identical patches) and
+ * the patches are partitioned into contiguous ranges with (roughly) the same
+ * number of owned faces. Each replica processes only its own partition i.e.,
+ * for_each_*(), run_kernel(), and run_query_kernel() on get_mesh(d) skip
+ * patches outside of device d partition (see RXMeshStatic::set_patch_range()).
+ * The ribbon of a partition (i.e., elements owned by patches in other
+ * partitions) is stored in the halo patches which are the patches of other
+ * devices that appear in the PatchStash of the partition patches. Attributes
+ * are created with add_vertex/edge/face_attribute() and the halo patches are
+ * updated from their owner device with MultiGPUAttribute::exchange_halo().
+ * Since device lambdas can not be defined inside another lambda, kernels are
+ * launched by looping over the devices e.g.,
+ *
+ *     for (int d = 0; d < mgpu.get_num_devices(); ++d) {
+ *         mgpu.set_device(d);
+ *         auto a = attr->get(d);
+ *         mgpu.get_mesh(d).for_each_vertex(
+ *             DEVICE,
+ *             [a] __device__(const VertexHandle vh) mutable { a(vh) = 1; },
+ *             mgpu.get_stream(d));
+ *     }
+ *     attr->exchange_halo();
+ */
+class RXMeshMultiGPU
+{
+   public:
+    RXMeshMultiGPU(const RXMeshMultiGPU&) = delete;
+
+    /**
+     * @brief Constructor using path to obj or ply file
+     * @param file_path path to an obj or ply file
+     * @param devices the devices to use. If empty, all devices are used
+     * @param cache_dir directory of the mesh cache used to build the mesh
+     * once and load it on the other devices. If empty, the system temporary
+     * directory is used
+     */
+    explicit RXMeshMultiGPU(const std::string file_path,
+                            std::vector<int>  devices                  = {},
+                            const uint32_t    patch_size               = 512,
+                            const float       capacity_factor          = 1.0,
+                            const float       patch_alloc_factor       = 1.0,
+                            const float       lp_hashtable_load_factor = 0.8,
+                            std::string       cache_dir                = "")
+        : m_devices(devices)
+    {
+        if (m_devices.empty()) {
+            int num_devices = 0;
+            CUDA_ERROR(cudaGetDeviceCount(&num_devices));
+            for (int d = 0; d < num_devices; ++d) {
+                m_devices.push_back(d);
+            }
+        }
+
+        if (m_devices.empty()) {
+            RXMESH_ERROR("RXMeshMultiGPU::RXMeshMultiGPU() no CUDA device");
+            exit(EXIT_FAILURE);
+        }
+
+        if (cache_dir.empty()) {
+            cache_dir = (std::filesystem::temp_directory_path() /
+                         "rxmesh_multi_gpu_cache")
+                            .string();
+        }
+
+        // the first device builds the mesh and writes the cache which is then
+        // read by the other devices
+        for (size_t d = 0; d < m_devices.size(); ++d) {
+            CUDA_ERROR(cudaSetDevice(m_devices[d]));
+            m_meshes.push_back(
+                std::make_unique<RXMeshStatic>(file_path,
+                                               "",
+                                               false,
+                                               patch_size,
+                                               capacity_factor,
+                                               patch_alloc_factor,
+                                               lp_hashtable_load_factor,
+                                               cache_dir));
+
+            if (d > 0 && m_meshes[d]->get_num_patches() !=
+                             m_meshes[0]->get_num_patches()) {
+                RXMESH_ERROR(
+                    "RXMeshMultiGPU::RXMeshMultiGPU() the mesh replica on "
+                    "device {} does not match the one on device {}",
+                    m_devices[d],
+                    m_devices[0]);
+                exit(EXIT_FAILURE);
+            }
+
+            cudaStream_t stream;
+            CUDA_ERROR(
+                cudaStreamCreateWithFlags(&stream, cudaStreamNonBlocking));
+            m_streams.push_back(stream);
+
+            cudaEvent_t event;
+            CUDA_ERROR(
+                cudaEventCreateWithFlags(&event, cudaEventDisableTiming));
+            m_events.push_back(event);
+        }
+
+        enable_peer_access();
+
+        partition();
+    }
+
+    ~RXMeshMultiGPU()
+    {
+        for (size_t d = 0; d < m_devices.size(); ++d) {
+            CUDA_ERROR(cudaSetDevice(m_devices[d]));
+            CUDA_ERROR(cudaStreamDestroy(m_streams[d]));
+            CUDA_ERROR(cudaEventDestroy(m_events[d]));
+            m_meshes[d].reset();
+        }
+    }
+
+    /**
+     * @brief the number of devices the mesh is distributed across
+     */
+    int get_num_devices() const
+    {
+        return static_cast<int>(m_devices.size());
+    }
+
+    /**
+     * @brief the CUDA device id of the d-th device
+     */
+    int get_device(const int d) const
+    {
+        return m_devices[d];
+    }
+
+    /**
+     * @brief make the d-th device the current device
+     */
+    void set_device(const int d) const
+    {
+        CUDA_ERROR(cudaSetDevice(m_devices[d]));
+    }
+
+    /**
+     * @brief the mesh replica on the d-th device
+     */
+    RXMeshStatic& get_mesh(const int d)
+    {
+        return *m_meshes[d];
+    }
+
+    /**
+     * @brief the stream used for the d-th device
+     */
+    cudaStream_t get_stream(const int d) const
+    {
+        return m_streams[d];
+    }
+
+    /**
+     * @brief the number of patches in the mesh
+     */
+    uint32_t get_num_patches() const
+    {
+        return m_meshes[0]->get_num_patches();
+    }
+
+    /**
+     * @brief the first patch in the partition of the d-th device
+     */
+    uint32_t get_partition_begin(const int d) const
+    {
+        return m_partition_offset[d];
+    }
+
+    /**
+     * @brief one past the last patch in the partition of the d-th device
+     */
+    uint32_t get_partition_end(const int d) const
+    {
+        return m_partition_offset[d + 1];
+    }
+
+    /**
+     * @brief the device (index) that owns patch p
+     */
+    int get_patch_device(const uint32_t p) const
+    {
+        return m_patch_device[p];
+    }
+
+    /**
+     * @brief the patches owned by other devices whose elements are in the
+     * ribbon of the d-th device partition
+     */
+    const std::vector<uint32_t>& get_halo_patches(const int d) const
+    {
+        return m_halo_patches[d];
+    }
+
+    /**
+     * @brief make the streams of all devices wait for the work submitted so
+     * far on the streams of all other devices (without blocking the host)
+     */
+    void barrier() const
+    {
+        for (size_t d = 0; d < m_devices.size(); ++d) {
+            set_device(d);
+            CUDA_ERROR(cudaEventRecord(m_events[d], m_streams[d]));
+        }
+        for (size_t d = 0; d < m_devices.size(); ++d) {
+            set_device(d);
+            for (size_t o = 0; o < m_devices.size(); ++o) {
+                if (o != d) {
+                    CUDA_ERROR(cudaStreamWaitEvent(m_streams[d], m_events[o]));
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief block the host until all work on all devices is done
+     */
+    void synchronize() const
+    {
+        for (size_t d = 0; d < m_devices.size(); ++d) {
+            set_device(d);
+            CUDA_ERROR(cudaStreamSynchronize(m_streams[d]));
+        }
+    }
+
+    /**
+     * @brief add a vertex attribute on all devices
+     */
+    template <typename T>
+    std::shared_ptr<MultiGPUAttribute<T, VertexHandle>> add_vertex_attribute(
+        const std::string& name,
+        uint32_t           num_attributes,
+        locationT          location = LOCATION_ALL,
+        layoutT            layout   = SoA)
+    {
+        return add_attribute<T, VertexHandle>(
+            name, num_attributes, location, layout);
+    }
+
+    /**
+     * @brief add an edge attribute on all devices
+     */
+    template <typename T>
+    std::shared_ptr<MultiGPUAttribute<T, EdgeHandle>> add_edge_attribute(
+        const std::string& name,
+        uint32_t           num_attributes,
+        locationT          location = LOCATION_ALL,
+        layoutT            layout   = SoA)
+    {
+        return add_attribute<T, EdgeHandle>(
+            name, num_attributes, location, layout);
+    }
+
+    /**
+     * @brief add a face attribute on all devices
+     */
+    template <typename T>
+    std::shared_ptr<MultiGPUAttribute<T, FaceHandle>> add_face_attribute(
+        const std::string& name,
+        uint32_t           num_attributes,
+        locationT          location = LOCATION_ALL,
+        layoutT            layout   = SoA)
+    {
+        return add_attribute<T, FaceHandle>(
+            name, num_attributes, location, layout);
+    }
+
+    /**
+     * @brief add an attribute on all devices where the type of the mesh
+     * element is given as a template parameter
+     */
+    template <typename T, typename HandleT>
+    std::shared_ptr<MultiGPUAttribute<T, HandleT>> add_attribute(
+        const std::string& name,
+        uint32_t           num_attributes,
+        locationT          location = LOCATION_ALL,
+        layoutT            layout   = SoA);
+
+   protected:
+    /**
+     * @brief enable peer-to-peer access (e.g., over NVLink or PCIe) between
+     * all pairs of devices that support it. Otherwise, halo exchange is
+     * staged through the host by the CUDA runtime
+     */
+    void enable_peer_access()
+    {
+        for (size_t d = 0; d < m_devices.size(); ++d) {
+            set_device(d);
+            for (size_t o = 0; o < m_devices.size(); ++o) {
+                if (o == d) {
+                    continue;
+                }
+                int can_access = 0;
+                CUDA_ERROR(cudaDeviceCanAccessPeer(
+                    &can_access, m_devices[d], m_devices[o]));
+                if (can_access) {
+                    cudaError_t err =
+                        cudaDeviceEnablePeerAccess(m_devices[o], 0);
+                    if (err == cudaErrorPeerAccessAlreadyEnabled) {
+                        // clear the sticky error
+                        cudaGetLastError();
+                    } else {
+                        CUDA_ERROR(err);
+                    }
+                } else {
+                    RXMESH_WARN(
+                        "RXMeshMultiGPU::enable_peer_access() device {} can "
+                        "not access device {} directly",
+                        m_devices[d],
+                        m_devices[o]);
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief split the patches into contiguous ranges with the same number
+     * of owned faces, restrict every replica to its range, and compute the
+     * halo patches of every range
+     */
+    void partition()
+    {
+        const uint32_t num_patches = get_num_patches();
+        const uint32_t num_devices = static_cast<uint32_t>(m_devices.size());
+
+        if (num_patches < num_devices) {
+            RXMESH_WARN(
+                "RXMeshMultiGPU::partition() the number of patches ({}) is "
+                "less than the number of devices ({}). Some devices will be "
+                "idle",
+                num_patches,
+                num_devices);
+        }
+
+        const RXMeshStatic& rx = *m_meshes[0];
+
+        const double target = double(rx.get_num_faces()) / double(num_devices);
+
+        m_partition_offset.resize(num_devices + 1, num_patches);
+        m_partition_offset[0] = 0;
+
+        uint32_t d       = 0;
+        uint64_t sum_own = 0;
+        for (uint32_t p = 0; p < num_patches && d + 1 < num_devices; ++p) {
+            sum_own += rx.get_num_owned_faces(p);
+            if (double(sum_own) >= target * double(d + 1)) {
+                m_partition_offset[++d] = p + 1;
+            }
+        }
+
+        m_patch_device.resize(num_patches);
+        for (d = 0; d < num_devices; ++d) {
+            for (uint32_t p = m_partition_offset[d];
+                 p < m_partition_offset[d + 1];
+                 ++p) {
+                m_patch_device[p] = d;
+            }
+        }
+
+        m_halo_patches.resize(num_devices);
+        for (d = 0; d < num_devices; ++d) {
+            std::vector<uint32_t>& halo = m_halo_patches[d];
+            for (uint32_t p = m_partition_offset[d];
+                 p < m_partition_offset[d + 1];
+                 ++p) {
+                const PatchStash& stash = rx.m_h_patches_info[p].patch_stash;
+                for (uint8_t i = 0; i < PatchStash::stash_size; ++i) {
+                    const uint32_t q = stash.get_patch(i);
+                    if (q != INVALID32 && m_patch_device[q] != d) {
+                        halo.push_back(q);
+                    }
+                }
+            }
+            std::sort(halo.begin(), halo.end());
+            halo.erase(std::unique(halo.begin(), halo.end()), halo.end());
+
+            m_meshes[d]->set_patch_range(m_partition_offset[d],
+                                         m_partition_offset[d + 1]);
+
+            RXMESH_INFO(
+                "RXMeshMultiGPU: device {} has patches [{}, {}) with {} halo "
+                "patches",
+                m_devices[d],
+                m_partition_offset[d],
+                m_partition_offset[d + 1],
+                halo.size());
+        }
+    }
+
+    std::vector<int>                           m_devices;
+    std::vector<std::unique_ptr<RXMeshStatic>> m_meshes;
+    std::vector<cudaStream_t>                  m_streams;
+    std::vector<cudaEvent_t>                   m_events;
+    std::vector<uint32_t>                      m_partition_offset;
+    std::vector<uint32_t>                      m_patch_device;
+    std::vector<std::vector<uint32_t>>         m_halo_patches;
+};
+
+
+/**
+ * @brief An attribute distributed across the devices of RXMeshMultiGPU. Every
+ * device has a full-size replica of the attribute (get(d)) where only the
+ * patches of its partition are written by the device and the halo patches
+ * are updated from their owner devices with exchange_halo()
+ */
+template <typename T, typename HandleT>
+class MultiGPUAttribute
+{
+   public:
+    MultiGPUAttribute(RXMeshMultiGPU*    mgpu,
+                      const std::string& name,
+                      uint32_t           num_attributes,
+                      locationT          location,
+                      layoutT            layout)
+        : m_mgpu(mgpu)
+    {
+        for (int d = 0; d < m_mgpu->get_num_devices(); ++d) {
+            m_mgpu->set_device(d);
+            m_attr.push_back(
+                m_mgpu->get_mesh(d).template add_attribute<T, HandleT>(
+                    name, num_attributes, location, layout));
+        }
+    }
+
+    /**
+     * @brief the attribute replica on the d-th device. This is the one to be
+     * captured by kernels/lambdas running on the d-th device
+     */
+    Attribute<T, HandleT>& get(const int d)
+    {
+        return *m_attr[d];
+    }
+
+    /**
+     * @brief reset the attribute to a value on all devices
+     */
+    void reset(const T value, locationT location)
+    {
+        for (int d = 0; d < m_mgpu->get_num_devices(); ++d) {
+            m_mgpu->set_device(d);
+            m_attr[d]->reset(value, location, m_mgpu->get_stream(d));
+        }
+    }
+
+    /**
+     * @brief copy the halo patches of every device from their owner devices
+     * (peer-to-peer). The copy waits for all work submitted on all devices
+     * and all devices wait for the copy to finish (without blocking the host)
+     */
+    void exchange_halo()
+    {
+        m_mgpu->barrier();
+
+        for (int d = 0; d < m_mgpu->get_num_devices(); ++d) {
+            m_mgpu->set_device(d);
+            for (const uint32_t q : m_mgpu->get_halo_patches(d)) {
+                const int o = m_mgpu->get_patch_device(q);
+                CUDA_ERROR(cudaMemcpyPeerAsync(m_attr[d]->m_h_ptr_on_device[q],
+                                               m_mgpu->get_device(d),
+                                               m_attr[o]->m_h_ptr_on_device[q],
+                                               m_mgpu->get_device(o),
+                                               patch_bytes(q),
+                                               m_mgpu->get_stream(d)));
+            }
+        }
+
+        m_mgpu->barrier();
+    }
+
+    /**
+     * @brief gather the partition of every device into the host memory of
+     * the first device replica, i.e., get(0), and block until it is done
+     */
+    void move_to_host()
+    {
+        if ((m_attr[0]->get_allocated() & HOST) != HOST) {
+            RXMESH_ERROR(
+                "MultiGPUAttribute::move_to_host() the attribute is not "
+                "allocated on the host");
+            return;
+        }
+
+        for (int d = 0; d < m_mgpu->get_num_devices(); ++d) {
+            m_mgpu->set_device(d);
+            for (uint32_t p = m_mgpu->get_partition_begin(d);
+                 p < m_mgpu->get_partition_end(d);
+                 ++p) {
+                CUDA_ERROR(cudaMemcpyAsync(m_attr[0]->m_h_attr[p],
+                                           m_attr[d]->m_h_ptr_on_device[p],
+                                           patch_bytes(p),
+                                           cudaMemcpyDeviceToHost,
+                                           m_mgpu->get_stream(d)));
+            }
+        }
+
+        m_mgpu->synchronize();
+    }
+
+   private:
+    size_t patch_bytes(const uint32_t p) const
+    {
+        return sizeof(T) * m_attr[0]->capacity(p) *
+               m_attr[0]->get_num_attributes();
+    }
+
+    RXMeshMultiGPU*                                     m_mgpu;
+    std::vector<std::shared_ptr<Attribute<T, HandleT>>> m_attr;
+};
+
+
+template <typename T, typename HandleT>
+inline std::shared_ptr<MultiGPUAttribute<T, HandleT>>
+RXMeshMultiGPU::add_attribute(const std::string& name,
+                              uint32_t           num_attributes,
+                              locationT          location,
+                              layoutT            layout)
+{
+    return std::make_shared<MultiGPUAttribute<T, HandleT>>(
+        this, name, num_attributes, location, layout);
+}
+}  // namespace rxmesh
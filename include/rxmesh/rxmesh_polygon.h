@@ -0,0 +1,870 @@
+#pragma once
+
+#include <stdint.h>
+#include <algorithm>
+#include <array>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "rxmesh/handle.h"
+#include "rxmesh/patch_csr.h"
+#include "rxmesh/types.h"
+#include "rxmesh/util/import_obj.h"
+#include "rxmesh/util/log.h"
+#include "rxmesh/util/macros.h"
+
+namespace rxmesh {
+
+/**
+ * @brief query operations on polygonal meshes (see
+ * RXMeshPolygon::run_query_kernel())
+ */
+enum class PolygonOp : uint32_t
+{
+    // the vertices of a face in the input order
+    FV = 0,
+    // the edges of a face where the i-th edge connects the i-th and the
+    // (i+1)-th vertex of the face (in FV order)
+    FE = 1,
+    // the faces that share an edge with a face ordered by the edges of the
+    // face (in FE order)
+    FF = 2,
+    // the two vertices of an edge
+    EV = 3,
+    // the faces incident to a vertex
+    VF = 4,
+    // the vertices that share an edge with a vertex
+    VV = 5,
+};
+
+constexpr uint32_t num_polygon_ops = 6;
+
+inline std::string polygon_op_to_string(const PolygonOp op)
+{
+    switch (op) {
+        case PolygonOp::FV:
+            return "FV";
+        case PolygonOp::FE:
+            return "FE";
+        case PolygonOp::FF:
+            return "FF";
+        case PolygonOp::EV:
+            return "EV";
+        case PolygonOp::VF:
+            return "VF";
+        case PolygonOp::VV:
+            return "VV";
+        default:
+            return "";
+    }
+}
+
+/**
+ * @brief the handle types of the source (InputHandle) and the output
+ * (OutputHandle) of a polygon query operation
+ */
+template <PolygonOp op>
+struct PolygonOpHandles
+{
+    using InputHandle = std::conditional_t<
+        op == PolygonOp::FV || op == PolygonOp::FE || op == PolygonOp::FF,
+        FaceHandle,
+        std::conditional_t<op == PolygonOp::EV, EdgeHandle, VertexHandle>>;
+    using OutputHandle = std::conditional_t<
+        op == PolygonOp::FV || op == PolygonOp::EV || op == PolygonOp::VV,
+        VertexHandle,
+        std::conditional_t<op == PolygonOp::FE, EdgeHandle, FaceHandle>>;
+};
+
+/**
+ * @brief the device side of RXMeshPolygon. Same layout as VolumeContext with
+ * vertices, edges, and faces
+ */
+struct PolygonContext
+{
+    uint32_t m_num_patches = 0;
+
+    detail::PatchCSRElements m_vertex;
+    detail::PatchCSRElements m_edge;
+    detail::PatchCSRElements m_face;
+
+    detail::PatchCSRQuery m_query[num_polygon_ops];
+
+    template <typename HandleT>
+    __device__ __host__ __inline__ const detail::PatchCSRElements& elements()
+        const
+    {
+        if constexpr (std::is_same_v<HandleT, VertexHandle>) {
+            return m_vertex;
+        } else if constexpr (std::is_same_v<HandleT, EdgeHandle>) {
+            return m_edge;
+        } else {
+            return m_face;
+        }
+    }
+};
+
+template <typename HandleT>
+using PolygonIterator = PatchCSRIterator<HandleT>;
+
+template <typename T, typename HandleT>
+using PolygonAttribute = PatchCSRAttribute<T, HandleT>;
+
+template <typename T>
+using PolygonVertexAttribute = PolygonAttribute<T, VertexHandle>;
+
+template <typename T>
+using PolygonEdgeAttribute = PolygonAttribute<T, EdgeHandle>;
+
+template <typename T>
+using PolygonFaceAttribute = PolygonAttribute<T, FaceHandle>;
+
+/**
+ * @brief static polygonal (e.g., quad-dominant) mesh with the same
+ * patch-based layout as RXMeshStatic but without triangulating the faces.
+ * The faces are partitioned into patches of (up to) patch_size edge-connected
+ * faces by growing regions over the face-face adjacency. A vertex/edge is
+ * owned by the patch with the smallest id among its incident faces. On top of
+ * its owned faces, a patch stores the faces owned by other patches that are
+ * incident to its owned vertices or share an edge with its owned faces (i.e.,
+ * the ribbon) such that the output of all queries of the owned elements of a
+ * patch only refers to the patch's local elements. Like RXMeshVolume, the
+ * query output is stored per patch as patch-local indices (16-bit) of
+ * variable length per source element and is loaded into shared memory by
+ * run_query_kernel()
+ */
+class RXMeshPolygon
+{
+   public:
+    RXMeshPolygon(const RXMeshPolygon&) = delete;
+
+    /**
+     * @brief Constructor using path to an obj file. The faces in the file are
+     * used as is
+     * @param file_path path to the obj file
+     * @param patch_size the (max) number of faces in a patch
+     */
+    explicit RXMeshPolygon(const std::string file_path,
+                           const uint32_t    patch_size = 256)
+    {
+        std::vector<std::vector<float>>    verts;
+        std::vector<std::vector<uint32_t>> fv;
+        if (!import_obj(file_path, verts, fv)) {
+            RXMESH_ERROR("RXMeshPolygon() can not read {}", file_path);
+            return;
+        }
+        build(verts, fv, patch_size);
+    }
+
+    /**
+     * @brief Constructor using the vertex positions and the faces (three or
+     * more vertex indices each)
+     */
+    explicit RXMeshPolygon(const std::vector<std::vector<float>>&    verts,
+                           const std::vector<std::vector<uint32_t>>& fv,
+                           const uint32_t patch_size = 256)
+    {
+        build(verts, fv, patch_size);
+    }
+
+    virtual ~RXMeshPolygon()
+    {
+        m_input_vertex_coordinates.reset();
+
+        detail::release(m_context.m_vertex);
+        detail::release(m_context.m_edge);
+        detail::release(m_context.m_face);
+        for (uint32_t o = 0; o < num_polygon_ops; ++o) {
+            detail::release(m_context.m_query[o]);
+        }
+    }
+
+    uint32_t get_num_vertices() const
+    {
+        return m_h_vertex.size();
+    }
+
+    uint32_t get_num_edges() const
+    {
+        return m_h_edge.size();
+    }
+
+    uint32_t get_num_faces() const
+    {
+        return m_h_face.size();
+    }
+
+    uint32_t get_num_patches() const
+    {
+        return m_num_patches;
+    }
+
+    /**
+     * @brief the max number of vertices of a face
+     */
+    uint32_t get_max_face_degree() const
+    {
+        return m_max_face_degree;
+    }
+
+    template <typename HandleT>
+    uint32_t get_num_elements() const
+    {
+        return host_elements<HandleT>().size();
+    }
+
+    const PolygonContext& get_context() const
+    {
+        return m_context;
+    }
+
+    /**
+     * @brief the number of local (i.e., owned and not-owned) elements of
+     * patch p
+     */
+    template <typename HandleT>
+    uint32_t get_num_local(const uint32_t p) const
+    {
+        return host_elements<HandleT>().num_local(p);
+    }
+
+    /**
+     * @brief the handle of the vertex/face with index id in the input. The
+     * edges are numbered in the order they are first met when walking over
+     * the sides of the input faces
+     */
+    VertexHandle get_vertex_handle(const uint32_t id) const
+    {
+        return m_h_vertex.input_handle[id];
+    }
+
+    EdgeHandle get_edge_handle(const uint32_t id) const
+    {
+        return m_h_edge.input_handle[id];
+    }
+
+    FaceHandle get_face_handle(const uint32_t id) const
+    {
+        return m_h_face.input_handle[id];
+    }
+
+    /**
+     * @brief the index of the element in the input
+     */
+    template <typename HandleT>
+    uint32_t get_input_id(const HandleT& h) const
+    {
+        return host_elements<HandleT>().input_id[linear_id(h)];
+    }
+
+    /**
+     * @brief the index of the element in the linear order of the owned
+     * elements (i.e., the index used by PolygonAttribute)
+     */
+    template <typename HandleT>
+    uint32_t linear_id(const HandleT& h) const
+    {
+        return host_elements<HandleT>().linear_id(h);
+    }
+
+    /**
+     * @brief add a vertex/edge/face attribute with num_attributes values per
+     * element allocated on both the host and the device
+     */
+    template <typename T>
+    std::shared_ptr<PolygonVertexAttribute<T>> add_vertex_attribute(
+        const uint32_t num_attributes = 1)
+    {
+        return add_attribute<T, VertexHandle>(num_attributes);
+    }
+
+    template <typename T>
+    std::shared_ptr<PolygonEdgeAttribute<T>> add_edge_attribute(
+        const uint32_t num_attributes = 1)
+    {
+        return add_attribute<T, EdgeHandle>(num_attributes);
+    }
+
+    template <typename T>
+    std::shared_ptr<PolygonFaceAttribute<T>> add_face_attribute(
+        const uint32_t num_attributes = 1)
+    {
+        return add_attribute<T, FaceHandle>(num_attributes);
+    }
+
+    template <typename T, typename HandleT>
+    std::shared_ptr<PolygonAttribute<T, HandleT>> add_attribute(
+        const uint32_t num_attributes = 1)
+    {
+        return std::shared_ptr<PolygonAttribute<T, HandleT>>(
+            new PolygonAttribute<T, HandleT>(
+                get_num_elements<HandleT>(),
+                num_attributes,
+                host_elements<HandleT>().prefix.data(),
+                m_context.elements<HandleT>().m_prefix),
+            [](PolygonAttribute<T, HandleT>* attr) {
+                attr->release();
+                delete attr;
+            });
+    }
+
+    /**
+     * @brief the input vertex positions (3 values per vertex)
+     */
+    std::shared_ptr<PolygonVertexAttribute<float>>
+    get_input_vertex_coordinates()
+    {
+        return m_input_vertex_coordinates;
+    }
+
+    /**
+     * @brief apply a lambda on all (owned) elements. On the device, one block
+     * is launched per patch
+     */
+    template <typename HandleT, typename LambdaT>
+    void for_each(locationT location, LambdaT apply, cudaStream_t stream = NULL)
+    {
+        if ((location & HOST) == HOST) {
+            const auto& num_owned = host_elements<HandleT>().num_owned;
+            for (uint32_t p = 0; p < m_num_patches; ++p) {
+                for (uint32_t l = 0; l < num_owned[p]; ++l) {
+                    apply(HandleT(p, {uint16_t(l)}));
+                }
+            }
+        }
+
+        if ((location & DEVICE) == DEVICE && m_num_patches > 0) {
+            if constexpr (IS_HD_LAMBDA(LambdaT) || IS_D_LAMBDA(LambdaT)) {
+                detail::patch_csr_for_each<HandleT>
+                    <<<m_num_patches, 256, 0, stream>>>(
+                        m_num_patches,
+                        m_context.elements<HandleT>(),
+                        apply);
+            } else {
+                RXMESH_ERROR(
+                    "RXMeshPolygon::for_each() Input lambda function should "
+                    "be annotated with  __device__ for execution on device");
+            }
+        }
+    }
+
+    template <typename LambdaT>
+    void for_each_vertex(locationT    location,
+                         LambdaT      apply,
+                         cudaStream_t stream = NULL)
+    {
+        for_each<VertexHandle>(location, apply, stream);
+    }
+
+    template <typename LambdaT>
+    void for_each_edge(locationT    location,
+                       LambdaT      apply,
+                       cudaStream_t stream = NULL)
+    {
+        for_each<EdgeHandle>(location, apply, stream);
+    }
+
+    template <typename LambdaT>
+    void for_each_face(locationT    location,
+                       LambdaT      apply,
+                       cudaStream_t stream = NULL)
+    {
+        for_each<FaceHandle>(location, apply, stream);
+    }
+
+    /**
+     * @brief the dynamic shared memory used by run_query_kernel() for op
+     */
+    size_t get_query_shmem_bytes(const PolygonOp op) const
+    {
+        return m_h_query[uint32_t(op)].shmem_bytes;
+    }
+
+    /**
+     * @brief run the query op on all owned source elements with one block per
+     * patch. The lambda signature takes the handle of the source element and
+     * a PolygonIterator over the output, e.g., for PolygonOp::FV
+     * [=] __device__(const FaceHandle& fh,
+     *                const PolygonIterator<VertexHandle>& iter) {...}
+     */
+    template <PolygonOp op, uint32_t blockThreads = 256, typename LambdaT>
+    void run_query_kernel(LambdaT apply, cudaStream_t stream = NULL)
+    {
+        using InputT  = typename PolygonOpHandles<op>::InputHandle;
+        using OutputT = typename PolygonOpHandles<op>::OutputHandle;
+
+        if constexpr (IS_HD_LAMBDA(LambdaT) || IS_D_LAMBDA(LambdaT)) {
+            detail::launch_patch_csr_query<blockThreads, InputT, OutputT>(
+                m_num_patches,
+                m_context.elements<InputT>(),
+                m_context.elements<OutputT>(),
+                m_context.m_query[uint32_t(op)],
+                get_query_shmem_bytes(op),
+                apply,
+                stream);
+        } else {
+            RXMESH_ERROR(
+                "RXMeshPolygon::run_query_kernel() Input lambda function "
+                "should be annotated with  __device__ for execution on "
+                "device");
+        }
+    }
+
+   private:
+    template <typename HandleT>
+    const detail::PatchCSRHostElements<HandleT>& host_elements() const
+    {
+        if constexpr (std::is_same_v<HandleT, VertexHandle>) {
+            return m_h_vertex;
+        } else if constexpr (std::is_same_v<HandleT, EdgeHandle>) {
+            return m_h_edge;
+        } else {
+            return m_h_face;
+        }
+    }
+
+    void clear_host()
+    {
+        m_h_vertex = detail::PatchCSRHostElements<VertexHandle>();
+        m_h_edge   = detail::PatchCSRHostElements<EdgeHandle>();
+        m_h_face   = detail::PatchCSRHostElements<FaceHandle>();
+    }
+
+    void build(const std::vector<std::vector<float>>&    verts,
+               const std::vector<std::vector<uint32_t>>& fv,
+               const uint32_t                            patch_size)
+    {
+        const uint32_t num_in_v = uint32_t(verts.size());
+        const uint32_t num_f    = uint32_t(fv.size());
+
+        m_num_patches     = 0;
+        m_max_face_degree = 0;
+
+        if (patch_size == 0 || patch_size >= INVALID16) {
+            RXMESH_ERROR("RXMeshPolygon() invalid patch size {}", patch_size);
+            return;
+        }
+
+        // the sides of face f are f_offset[f] ... f_offset[f + 1] - 1
+        std::vector<uint32_t> f_offset(num_f + 1, 0);
+        for (uint32_t f = 0; f < num_f; ++f) {
+            const uint32_t d = uint32_t(fv[f].size());
+            if (d < 3) {
+                RXMESH_ERROR("RXMeshPolygon() face {} has less than three "
+                             "vertices",
+                             f);
+                return;
+            }
+            for (uint32_t k = 0; k < d; ++k) {
+                if (fv[f][k] >= num_in_v) {
+                    RXMESH_ERROR(
+                        "RXMeshPolygon() face {} has an invalid vertex {}",
+                        f,
+                        fv[f][k]);
+                    return;
+                }
+                if (fv[f][k] == fv[f][(k + 1) % d]) {
+                    RXMESH_ERROR(
+                        "RXMeshPolygon() face {} has a degenerate edge", f);
+                    return;
+                }
+            }
+            f_offset[f + 1]   = f_offset[f] + d;
+            m_max_face_degree = std::max(m_max_face_degree, d);
+        }
+        const uint32_t num_sides = f_offset.back();
+
+        // the unique edges: sides with the same (sorted) vertices are grouped
+        // and every group gets an edge id in the order of the first side
+        // (in face order) of the group
+        std::vector<uint32_t>                fe(num_sides);
+        std::vector<std::array<uint32_t, 2>> ev;
+        {
+            std::vector<std::array<uint32_t, 3>> sides(num_sides);
+            for (uint32_t f = 0; f < num_f; ++f) {
+                const uint32_t d = uint32_t(fv[f].size());
+                for (uint32_t k = 0; k < d; ++k) {
+                    const uint32_t a = fv[f][k];
+                    const uint32_t b = fv[f][(k + 1) % d];
+                    sides[f_offset[f] + k] = {
+                        std::min(a, b), std::max(a, b), f_offset[f] + k};
+                }
+            }
+            std::sort(sides.begin(), sides.end());
+
+            std::vector<uint32_t> side_group(num_sides);
+            uint32_t              num_groups = 0;
+            for (uint32_t i = 0; i < num_sides; ++i) {
+                if (i > 0 && (sides[i][0] != sides[i - 1][0] ||
+                              sides[i][1] != sides[i - 1][1])) {
+                    num_groups++;
+                }
+                side_group[sides[i][2]] = num_groups;
+            }
+            num_groups = (num_sides > 0) ? num_groups + 1 : 0;
+
+            std::vector<uint32_t> group_edge(num_groups, INVALID32);
+            for (uint32_t f = 0; f < num_f; ++f) {
+                const uint32_t d = uint32_t(fv[f].size());
+                for (uint32_t k = 0; k < d; ++k) {
+                    const uint32_t g = side_group[f_offset[f] + k];
+                    if (group_edge[g] == INVALID32) {
+                        group_edge[g] = uint32_t(ev.size());
+                        ev.push_back({fv[f][k], fv[f][(k + 1) % d]});
+                    }
+                    fe[f_offset[f] + k] = group_edge[g];
+                }
+            }
+        }
+        const uint32_t num_e = uint32_t(ev.size());
+
+        // build the incidence CSR of num_in elements from the (flat) list of
+        // incident (element, face) pairs
+        auto incidence = [&](uint32_t                     num_in,
+                             const std::vector<uint32_t>& element,
+                             std::vector<uint32_t>&       offset,
+                             std::vector<uint32_t>&       value) {
+            offset.assign(num_in + 1, 0);
+            for (uint32_t e : element) {
+                offset[e + 1]++;
+            }
+            for (uint32_t i = 0; i < num_in; ++i) {
+                offset[i + 1] += offset[i];
+            }
+            value.resize(offset.back());
+            std::vector<uint32_t> pos(offset.begin(), offset.end() - 1);
+            for (uint32_t f = 0; f < num_f; ++f) {
+                for (uint32_t s = f_offset[f]; s < f_offset[f + 1]; ++s) {
+                    value[pos[element[s]]++] = f;
+                }
+            }
+        };
+
+        // the vertex-face and edge-face incidence
+        std::vector<uint32_t> flat_fv(num_sides);
+        for (uint32_t f = 0; f < num_f; ++f) {
+            std::copy(
+                fv[f].begin(), fv[f].end(), flat_fv.begin() + f_offset[f]);
+        }
+        std::vector<uint32_t> vf_offset, vf_value, ef_offset, ef_value;
+        incidence(num_in_v, flat_fv, vf_offset, vf_value);
+        incidence(num_e, fe, ef_offset, ef_value);
+
+        // the face-face adjacency (through edges) in the order of the face
+        // edges without duplicates
+        std::vector<uint32_t> ff_offset(num_f + 1, 0);
+        std::vector<uint32_t> ff_value;
+        for (uint32_t f = 0; f < num_f; ++f) {
+            const size_t begin = ff_value.size();
+            for (uint32_t s = f_offset[f]; s < f_offset[f + 1]; ++s) {
+                const uint32_t e = fe[s];
+                for (uint32_t i = ef_offset[e]; i < ef_offset[e + 1]; ++i) {
+                    const uint32_t n = ef_value[i];
+                    if (n != f && std::find(ff_value.begin() + begin,
+                                            ff_value.end(),
+                                            n) == ff_value.end()) {
+                        ff_value.push_back(n);
+                    }
+                }
+            }
+            ff_offset[f + 1] = uint32_t(ff_value.size());
+        }
+
+        // grow patches over the face-face adjacency
+        std::vector<uint32_t> face_patch(num_f, INVALID32);
+        std::vector<uint32_t> queued(num_f, INVALID32);
+        std::vector<std::vector<uint32_t>> patch_faces;
+        for (uint32_t seed = 0; seed < num_f; ++seed) {
+            if (face_patch[seed] != INVALID32) {
+                continue;
+            }
+            const uint32_t p = uint32_t(patch_faces.size());
+            patch_faces.emplace_back();
+            std::deque<uint32_t> queue = {seed};
+            queued[seed]               = p;
+            while (!queue.empty() && patch_faces[p].size() < patch_size) {
+                const uint32_t f = queue.front();
+                queue.pop_front();
+                if (face_patch[f] != INVALID32) {
+                    continue;
+                }
+                face_patch[f] = p;
+                patch_faces[p].push_back(f);
+                for (uint32_t i = ff_offset[f]; i < ff_offset[f + 1]; ++i) {
+                    const uint32_t n = ff_value[i];
+                    if (face_patch[n] == INVALID32 && queued[n] != p) {
+                        queued[n] = p;
+                        queue.push_back(n);
+                    }
+                }
+            }
+        }
+        const uint32_t num_patches = uint32_t(patch_faces.size());
+
+        // the owner of a vertex/edge is the smallest patch of its incident
+        // faces
+        auto owner = [&](const std::vector<uint32_t>& offset,
+                         const std::vector<uint32_t>& value) {
+            const uint32_t        num = uint32_t(offset.size() - 1);
+            std::vector<uint32_t> patch(num, INVALID32);
+            for (uint32_t i = 0; i < num; ++i) {
+                for (uint32_t j = offset[i]; j < offset[i + 1]; ++j) {
+                    patch[i] = std::min(patch[i], face_patch[value[j]]);
+                }
+            }
+            return patch;
+        };
+        const std::vector<uint32_t> vertex_patch = owner(vf_offset, vf_value);
+        const std::vector<uint32_t> edge_patch   = owner(ef_offset, ef_value);
+
+        if (num_f > 0) {
+            const uint32_t num_isolated = uint32_t(std::count(
+                vertex_patch.begin(), vertex_patch.end(), INVALID32));
+            if (num_isolated > 0) {
+                RXMESH_WARN(
+                    "RXMeshPolygon() {} vertices are not referenced by any "
+                    "face and are dropped",
+                    num_isolated);
+            }
+        }
+
+        // the owned vertices/edges of every patch in the order they are first
+        // met in the owned faces of the patch
+        std::vector<std::vector<uint32_t>> patch_vertices(num_patches);
+        std::vector<std::vector<uint32_t>> patch_edges(num_patches);
+        {
+            std::vector<bool> v_added(num_in_v, false);
+            std::vector<bool> e_added(num_e, false);
+            for (uint32_t p = 0; p < num_patches; ++p) {
+                for (uint32_t f : patch_faces[p]) {
+                    for (uint32_t s = f_offset[f]; s < f_offset[f + 1]; ++s) {
+                        const uint32_t v = flat_fv[s];
+                        const uint32_t e = fe[s];
+                        if (vertex_patch[v] == p && !v_added[v]) {
+                            v_added[v] = true;
+                            patch_vertices[p].push_back(v);
+                        }
+                        if (edge_patch[e] == p && !e_added[e]) {
+                            e_added[e] = true;
+                            patch_edges[p].push_back(e);
+                        }
+                    }
+                }
+                if (patch_vertices[p].size() >= INVALID16 ||
+                    patch_edges[p].size() >= INVALID16) {
+                    RXMESH_ERROR(
+                        "RXMeshPolygon() patch {} has too many vertices or "
+                        "edges. Use a smaller patch size",
+                        p);
+                    return;
+                }
+            }
+        }
+
+        m_h_vertex.set_owned(patch_vertices, num_in_v);
+        m_h_edge.set_owned(patch_edges, num_e);
+        m_h_face.set_owned(patch_faces, num_f);
+        for (uint32_t o = 0; o < num_polygon_ops; ++o) {
+            m_h_query[o] = detail::PatchCSRHostQuery();
+        }
+
+        // the local index of elements in the current patch (valid if the
+        // stamp matches the patch)
+        std::vector<uint32_t> v_stamp(num_in_v, INVALID32);
+        std::vector<uint32_t> e_stamp(num_e, INVALID32);
+        std::vector<uint32_t> f_stamp(num_f, INVALID32);
+        std::vector<uint32_t> v_id(num_in_v), e_id(num_e), f_id(num_f);
+
+        auto add_local = [](uint32_t               p,
+                            uint32_t               i,
+                            std::vector<uint32_t>& stamp,
+                            std::vector<uint32_t>& id,
+                            std::vector<uint32_t>& local) {
+            if (stamp[i] != p) {
+                stamp[i] = p;
+                id[i]    = uint32_t(local.size());
+                local.push_back(i);
+            }
+        };
+
+        for (uint32_t p = 0; p < num_patches; ++p) {
+            std::vector<uint32_t> local_v, local_e, local_f;
+
+            // the owned faces then the ribbon faces
+            for (uint32_t f : patch_faces[p]) {
+                add_local(p, f, f_stamp, f_id, local_f);
+            }
+            for (uint32_t v : patch_vertices[p]) {
+                for (uint32_t i = vf_offset[v]; i < vf_offset[v + 1]; ++i) {
+                    add_local(p, vf_value[i], f_stamp, f_id, local_f);
+                }
+            }
+            for (uint32_t f : patch_faces[p]) {
+                for (uint32_t i = ff_offset[f]; i < ff_offset[f + 1]; ++i) {
+                    add_local(p, ff_value[i], f_stamp, f_id, local_f);
+                }
+            }
+
+            for (uint32_t v : patch_vertices[p]) {
+                add_local(p, v, v_stamp, v_id, local_v);
+            }
+            for (uint32_t e : patch_edges[p]) {
+                add_local(p, e, e_stamp, e_id, local_e);
+            }
+            for (uint32_t f : local_f) {
+                for (uint32_t s = f_offset[f]; s < f_offset[f + 1]; ++s) {
+                    add_local(p, flat_fv[s], v_stamp, v_id, local_v);
+                    add_local(p, fe[s], e_stamp, e_id, local_e);
+                }
+            }
+
+            if (local_v.size() >= INVALID16 || local_e.size() >= INVALID16 ||
+                local_f.size() >= INVALID16) {
+                RXMESH_ERROR(
+                    "RXMeshPolygon() patch {} has too many local elements. "
+                    "Use a smaller patch size",
+                    p);
+                clear_host();
+                return;
+            }
+
+            m_h_vertex.append_table(local_v);
+            m_h_edge.append_table(local_e);
+            m_h_face.append_table(local_f);
+
+            const uint32_t num_ov = uint32_t(patch_vertices[p].size());
+            const uint32_t num_oe = uint32_t(patch_edges[p].size());
+            const uint32_t num_of = uint32_t(patch_faces[p].size());
+            const uint32_t num_lv = uint32_t(local_v.size());
+            const uint32_t num_le = uint32_t(local_e.size());
+            const uint32_t num_lf = uint32_t(local_f.size());
+
+            auto& query = m_h_query;
+
+            query[uint32_t(PolygonOp::FV)].append(
+                num_of, num_lv, [&](uint32_t s, auto& out) {
+                    const uint32_t f = patch_faces[p][s];
+                    for (uint32_t i = f_offset[f]; i < f_offset[f + 1]; ++i) {
+                        out.push_back(uint16_t(v_id[flat_fv[i]]));
+                    }
+                });
+
+            query[uint32_t(PolygonOp::FE)].append(
+                num_of, num_le, [&](uint32_t s, auto& out) {
+                    const uint32_t f = patch_faces[p][s];
+                    for (uint32_t i = f_offset[f]; i < f_offset[f + 1]; ++i) {
+                        out.push_back(uint16_t(e_id[fe[i]]));
+                    }
+                });
+
+            query[uint32_t(PolygonOp::FF)].append(
+                num_of, num_lf, [&](uint32_t s, auto& out) {
+                    const uint32_t f = patch_faces[p][s];
+                    for (uint32_t i = ff_offset[f]; i < ff_offset[f + 1];
+                         ++i) {
+                        out.push_back(uint16_t(f_id[ff_value[i]]));
+                    }
+                });
+
+            query[uint32_t(PolygonOp::EV)].append(
+                num_oe, num_lv, [&](uint32_t s, auto& out) {
+                    const uint32_t e = patch_edges[p][s];
+                    out.push_back(uint16_t(v_id[ev[e][0]]));
+                    out.push_back(uint16_t(v_id[ev[e][1]]));
+                });
+
+            query[uint32_t(PolygonOp::VF)].append(
+                num_ov, num_lf, [&](uint32_t s, auto& out) {
+                    const uint32_t v = patch_vertices[p][s];
+                    for (uint32_t i = vf_offset[v]; i < vf_offset[v + 1];
+                         ++i) {
+                        out.push_back(uint16_t(f_id[vf_value[i]]));
+                    }
+                });
+
+            query[uint32_t(PolygonOp::VV)].append(
+                num_ov, num_lv, [&](uint32_t s, auto& out) {
+                    const uint32_t        v = patch_vertices[p][s];
+                    std::vector<uint16_t> ring;
+                    for (uint32_t i = vf_offset[v]; i < vf_offset[v + 1];
+                         ++i) {
+                        const uint32_t f = vf_value[i];
+                        const uint32_t d = f_offset[f + 1] - f_offset[f];
+                        for (uint32_t k = 0; k < d; ++k) {
+                            const uint32_t a = flat_fv[f_offset[f] + k];
+                            const uint32_t b =
+                                flat_fv[f_offset[f] + (k + 1) % d];
+                            if (a == v) {
+                                ring.push_back(uint16_t(v_id[b]));
+                            }
+                            if (b == v) {
+                                ring.push_back(uint16_t(v_id[a]));
+                            }
+                        }
+                    }
+                    std::sort(ring.begin(), ring.end());
+                    ring.erase(std::unique(ring.begin(), ring.end()),
+                               ring.end());
+                    out.insert(out.end(), ring.begin(), ring.end());
+                });
+        }
+
+        for (uint32_t o = 0; o < num_polygon_ops; ++o) {
+            if (!m_h_query[o].is_valid()) {
+                RXMESH_ERROR(
+                    "RXMeshPolygon() the output of {} overflows a patch. Use "
+                    "a smaller patch size",
+                    polygon_op_to_string(PolygonOp(o)));
+                clear_host();
+                return;
+            }
+        }
+
+        // upload to the device
+        m_num_patches           = num_patches;
+        m_context.m_num_patches = num_patches;
+        m_context.m_vertex      = m_h_vertex.upload();
+        m_context.m_edge        = m_h_edge.upload();
+        m_context.m_face        = m_h_face.upload();
+        for (uint32_t o = 0; o < num_polygon_ops; ++o) {
+            m_context.m_query[o] = m_h_query[o].upload();
+        }
+
+        // the input coordinates
+        m_input_vertex_coordinates = add_vertex_attribute<float>(3);
+        for (uint32_t v = 0; v < num_in_v; ++v) {
+            const VertexHandle vh = m_h_vertex.input_handle[v];
+            if (!vh.is_valid()) {
+                continue;
+            }
+            for (uint32_t i = 0; i < 3 && i < verts[v].size(); ++i) {
+                (*m_input_vertex_coordinates)(vh, i) = verts[v][i];
+            }
+        }
+        m_input_vertex_coordinates->move(HOST, DEVICE);
+
+        RXMESH_INFO(
+            "RXMeshPolygon: #Vertices = {}, #Edges = {}, #Faces = {}, "
+            "#Patches = {}, max face degree = {}",
+            get_num_vertices(),
+            get_num_edges(),
+            get_num_faces(),
+            get_num_patches(),
+            get_max_face_degree());
+    }
+
+    uint32_t       m_num_patches     = 0;
+    uint32_t       m_max_face_degree = 0;
+    PolygonContext m_context;
+
+    detail::PatchCSRHostElements<VertexHandle> m_h_vertex;
+    detail::PatchCSRHostElements<EdgeHandle>   m_h_edge;
+    detail::PatchCSRHostElements<FaceHandle>   m_h_face;
+
+    std::array<detail::PatchCSRHostQuery, num_polygon_ops> m_h_query;
+
+    std::shared_ptr<PolygonVertexAttribute<float>> m_input_vertex_coordinates;
+};
+}  // namespace rxmesh
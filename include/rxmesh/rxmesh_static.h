@@ -1,8 +1,14 @@
 ﻿#pragma once
 #include <assert.h>
+#include <algorithm>
+#include <array>
 #include <fstream>
 #include <functional>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <sstream>
+#include <type_traits>
 
 #include <cuda_profiler_api.h>
 
@@ -11,15 +17,22 @@
 #include "rxmesh/handle.h"
 #include "rxmesh/kernels/for_each.cuh"
 #include "rxmesh/kernels/shmem_allocator.cuh"
+#include "rxmesh/kernels/shmem_plan.cuh"
 #include "rxmesh/launch_box.h"
 #include "rxmesh/rxmesh.h"
 #include "rxmesh/types.h"
 #include "rxmesh/util/bitmask_util.h"
+#include "rxmesh/util/import_mesh.h"
 #include "rxmesh/util/import_obj.h"
+#include "rxmesh/util/kernel_profiler.h"
 #include "rxmesh/util/log.h"
+#include "rxmesh/util/mesh_cache.h"
 #include "rxmesh/util/timer.h"
 
 #include "rxmesh/kernels/boundary.cuh"
+#include "rxmesh/kernels/compressed_topology.cuh"
+#include "rxmesh/kernels/handle_lookup.cuh"
+#include "rxmesh/kernels/owner_table.cuh"
 #include "rxmesh/kernels/query_kernel.cuh"
 
 #if USE_POLYSCOPE
@@ -41,33 +54,74 @@ class RXMeshStatic : public RXMesh
     RXMeshStatic(const RXMeshStatic&) = delete;
 
     /**
-     * @brief Constructor using path to obj file
-     * @param file_path path to an obj file
+     * @brief Constructor using path to obj or ply file
+     * @param file_path path to an obj or ply file
+     * @param cache_dir if not empty, a binary snapshot of the built mesh is
+     * looked up in this directory (keyed by the input file content hash and
+     * the patch size) and used instead of parsing and patching the input. If
+     * there is no valid snapshot, the mesh is built from scratch and the
+     * snapshot is written there to be used the next time
+     * @param patcher_budget time/quality budget of the Lloyd patcher e.g., to
+     * use multilevel patching for large meshes
      */
-    explicit RXMeshStatic(const std::string file_path,
-                          const std::string patcher_file             = "",
-                          const bool        use_metis                = false,
-                          const uint32_t    patch_size               = 512,
-                          const float       capacity_factor          = 1.0,
-                          const float       patch_alloc_factor       = 1.0,
-                          const float       lp_hashtable_load_factor = 0.8)
+    explicit RXMeshStatic(
+        const std::string            file_path,
+        const std::string            patcher_file             = "",
+        const bool                   use_metis                = false,
+        const uint32_t               patch_size               = 512,
+        const float                  capacity_factor          = 1.0,
+        const float                  patch_alloc_factor       = 1.0,
+        const float                  lp_hashtable_load_factor = 0.8,
+        const std::string            cache_dir                = "",
+        const patcher::PatcherBudget patcher_budget = patcher::PatcherBudget())
         : RXMesh(patch_size, use_metis)
     {
-        this->_use_metis = use_metis;
-        std::vector<std::vector<uint32_t>> fv;
-        std::vector<std::vector<float>>    vertices;
-        if (!import_obj(file_path, vertices, fv)) {
-            RXMESH_ERROR(
-                "RXMeshStatic::RXMeshStatic could not read the input file {}",
-                file_path);
-            exit(EXIT_FAILURE);
+        this->_use_metis       = use_metis;
+        this->m_patcher_budget = patcher_budget;
+        std::vector<uint32_t> fv, face_offset;
+        std::vector<float>    vertices;
+
+        std::string cache_file;
+        if (!cache_dir.empty()) {
+            cache_file = mesh_cache_file_name(
+                cache_dir, file_path, patch_size, use_metis);
         }
 
-        this->init(fv,
-                   patcher_file,
-                   capacity_factor,
-                   patch_alloc_factor,
-                   lp_hashtable_load_factor);
+        if (cache_file.empty() ||
+            !this->init_from_cache(cache_file,
+                                   vertices,
+                                   capacity_factor,
+                                   patch_alloc_factor,
+                                   lp_hashtable_load_factor)) {
+
+            if (!import_mesh(file_path, vertices, fv, face_offset)) {
+                RXMESH_ERROR(
+                    "RXMeshStatic::RXMeshStatic could not read the input file "
+                    "{}",
+                    file_path);
+                exit(EXIT_FAILURE);
+            }
+
+            if (!face_offset.empty()) {
+                RXMESH_ERROR(
+                    "RXMeshStatic::RXMeshStatic the input file {} has "
+                    "non-triangular faces. Non-triangular faces are not "
+                    "supported",
+                    file_path);
+                exit(EXIT_FAILURE);
+            }
+
+            this->init(fv.data(),
+                       static_cast<uint32_t>(fv.size() / 3),
+                       patcher_file,
+                       capacity_factor,
+                       patch_alloc_factor,
+                       lp_hashtable_load_factor);
+
+            if (!cache_file.empty()) {
+                this->save_cache(cache_file, vertices);
+            }
+        }
 
         m_attr_container = std::make_shared<AttributeContainer>();
 
@@ -75,7 +129,8 @@ class RXMeshStatic : public RXMesh
 #if USE_POLYSCOPE
         name = polyscope::guessNiceNameFromPath(file_path);
 #endif
-        add_vertex_coordinates(vertices, name);
+        add_vertex_coordinates(
+            vertices.data(), static_cast<uint32_t>(vertices.size() / 3), name);
     };
 
     /**
@@ -99,6 +154,81 @@ class RXMeshStatic : public RXMesh
         m_attr_container = std::make_shared<AttributeContainer>();
     };
 
+    /**
+     * @brief Constructor using a flat triangle index buffer. The buffer is
+     * only read during construction and is not copied into per-face vectors
+     * @param fv face incident vertices (3*num_faces) where face f is
+     * (fv[3*f], fv[3*f+1], fv[3*f+2])
+     * @param num_faces number of faces
+     */
+    explicit RXMeshStatic(const uint32_t*   fv,
+                          const uint32_t    num_faces,
+                          const std::string patcher_file             = "",
+                          const uint32_t    patch_size               = 512,
+                          const bool        use_metis                = false,
+                          const float       capacity_factor          = 1.0,
+                          const float       patch_alloc_factor       = 1.0,
+                          const float       lp_hashtable_load_factor = 0.8)
+        : RXMesh(patch_size, use_metis), m_input_vertex_coordinates(nullptr)
+    {
+        this->init(fv,
+                   num_faces,
+                   patcher_file,
+                   capacity_factor,
+                   patch_alloc_factor,
+                   lp_hashtable_load_factor);
+        m_attr_container = std::make_shared<AttributeContainer>();
+    };
+
+    /**
+     * @brief Constructor that incrementally patches a mesh that differs from a
+     * previously constructed mesh by local edits. Only the patches touched by
+     * the edit are re-patched while all other patches keep their faces
+     * @param file_path path to an obj or ply file
+     * @param prev_face_patch the previous patch of every face in the input
+     * file (#faces) or INVALID32 for new faces. For faces that exist in both
+     * versions, this is the previous mesh get_face_patch() indexed using
+     * stable face ids
+     */
+    explicit RXMeshStatic(const std::string            file_path,
+                          const std::vector<uint32_t>& prev_face_patch,
+                          const uint32_t               patch_size      = 512,
+                          const float                  capacity_factor = 1.0,
+                          const float patch_alloc_factor               = 1.0,
+                          const float lp_hashtable_load_factor         = 0.8)
+        : RXMesh(patch_size, false)
+    {
+        std::vector<uint32_t> fv, face_offset;
+        std::vector<float>    vertices;
+
+        if (!import_mesh(file_path, vertices, fv, face_offset) ||
+            !face_offset.empty()) {
+            RXMESH_ERROR(
+                "RXMeshStatic::RXMeshStatic could not read the input file {} "
+                "or it has non-triangular faces",
+                file_path);
+            exit(EXIT_FAILURE);
+        }
+
+        m_prev_face_patch = prev_face_patch;
+
+        this->init(fv.data(),
+                   static_cast<uint32_t>(fv.size() / 3),
+                   "",
+                   capacity_factor,
+                   patch_alloc_factor,
+                   lp_hashtable_load_factor);
+
+        m_attr_container = std::make_shared<AttributeContainer>();
+
+        std::string name = extract_file_name(file_path);
+#if USE_POLYSCOPE
+        name = polyscope::guessNiceNameFromPath(file_path);
+#endif
+        add_vertex_coordinates(
+            vertices.data(), static_cast<uint32_t>(vertices.size() / 3), name);
+    };
+
     /**
      * @brief Add vertex coordinates to the input mesh. When calling
      * RXMeshStatic constructor that takes the face's vertices, this function
@@ -115,23 +245,673 @@ class RXMeshStatic : public RXMesh
             m_input_vertex_coordinates =
                 this->add_vertex_attribute<float>(vertices, "rx:vertices");
 
-#if USE_POLYSCOPE
-            // polyscope::options::autocenterStructures = true;
-            // polyscope::options::autoscaleStructures  = true;
-            // polyscope::options::automaticallyComputeSceneExtents = true;
-            polyscope::init();
-            m_polyscope_mesh_name = mesh_name.empty() ? "RXMesh" : mesh_name;
-            m_polyscope_mesh_name += std::to_string(rand());
-            this->register_polyscope();
-            render_vertex_patch();
-            render_edge_patch();
-            render_face_patch();
-#endif
+            init_polyscope(mesh_name);
+        }
+    }
+
+    /**
+     * @brief Add vertex coordinates to the input mesh from a flat buffer. Same
+     * as add_vertex_coordinates but the coordinates are read directly from
+     * a buffer where vertex v is (vertices[3*v], vertices[3*v+1],
+     * vertices[3*v+2])
+     * @param vertices vertex coordinates (3*num_vertices)
+     * @param num_vertices number of vertices in vertices. Should match the
+     * number of vertices in the mesh
+     */
+    void add_vertex_coordinates(const float*   vertices,
+                                const uint32_t num_vertices,
+                                std::string    mesh_name = "")
+    {
+        if (m_input_vertex_coordinates == nullptr) {
+
+            if (num_vertices != get_num_vertices()) {
+                RXMESH_ERROR(
+                    "RXMeshStatic::add_vertex_coordinates() input size ({}) is "
+                    "not the same as number of vertices in the input mesh "
+                    "({})",
+                    num_vertices,
+                    get_num_vertices());
+                if (num_vertices < get_num_vertices()) {
+                    return;
+                }
+            }
+
+            m_input_vertex_coordinates =
+                this->add_vertex_attribute<float>(vertices, 3, "rx:vertices");
+
+            init_polyscope(mesh_name);
         }
     }
 
     virtual ~RXMeshStatic()
     {
+        // user objects may own attributes of this mesh
+        m_user_cache.clear();
+        if (m_prefetch_stream != nullptr) {
+            CUDA_ERROR(cudaStreamDestroy(m_prefetch_stream));
+            CUDA_ERROR(cudaEventDestroy(m_prefetch_done));
+            CUDA_ERROR(cudaEventDestroy(m_compute_done));
+        }
+        for (uint32_t o = 0; o < QueryCache::num_ops; ++o) {
+            release_query_cache(m_h_query_cache[o]);
+        }
+        GPU_FREE(m_d_query_cache);
+        GPU_FREE(m_d_compressed_topology);
+        GPU_FREE(m_d_owner_table);
+        release_dense_index();
+        clear_patch_subset();
+        GPU_FREE(m_d_patch_subset);
+        GPU_FREE(m_d_patch_subset_flags);
+        GPU_FREE(m_d_element_flags_valid);
+    }
+
+    /**
+     * @brief set the number of patches processed per launch by for_each_*()
+     * on the device. With a non-zero window, patches are processed in
+     * windows of num_patches patches where the topology and attributes of the
+     * next window (along with its ribbon patches) are prefetched while the
+     * current window is being processed. This is meant for the out-of-core
+     * mode (i.e., RXMesh compiled with USE_OUT_OF_CORE) where the mesh lives
+     * in host memory and could be larger than the device memory. Zero (the
+     * default) processes all patches in a single launch
+     */
+    void set_patch_window(const uint32_t num_patches)
+    {
+        m_patch_window = num_patches;
+
+        if (m_patch_window > 0 && m_prefetch_stream == nullptr) {
+            CUDA_ERROR(cudaStreamCreateWithFlags(&m_prefetch_stream,
+                                                 cudaStreamNonBlocking));
+            CUDA_ERROR(cudaEventCreateWithFlags(&m_prefetch_done,
+                                                cudaEventDisableTiming));
+            CUDA_ERROR(cudaEventCreateWithFlags(&m_compute_done,
+                                                cudaEventDisableTiming));
+        }
+    }
+
+    /**
+     * @brief restrict the patches processed on the device by for_each_*(),
+     * run_kernel(), and run_query_kernel() to [begin, end). This is used to
+     * partition the mesh across multiple devices (see RXMeshMultiGPU). The
+     * launch size does not change for run_kernel() and run_query_kernel() but
+     * blocks assigned to patches outside the range exit immediately. Mesh
+     * elements in these patches are not processed by for_each() and the
+     * query dispatcher. The whole mesh is still processed on the host
+     */
+    void set_patch_range(const uint32_t begin, const uint32_t end)
+    {
+        if (begin > end || end > get_num_patches()) {
+            RXMESH_ERROR(
+                "RXMeshStatic::set_patch_range() invalid range [{}, {}) of {} "
+                "patches",
+                begin,
+                end,
+                get_num_patches());
+            return;
+        }
+        this->m_rxmesh_context.m_patch_begin = begin;
+        this->m_rxmesh_context.m_patch_end   = end;
+    }
+
+    /**
+     * @brief the first patch processed on the device (see set_patch_range())
+     */
+    uint32_t get_patch_range_begin() const
+    {
+        return this->m_rxmesh_context.m_patch_begin;
+    }
+
+    /**
+     * @brief one past the last patch processed on the device (see
+     * set_patch_range())
+     */
+    uint32_t get_patch_range_end() const
+    {
+        return std::min(this->m_rxmesh_context.m_patch_end,
+                        this->get_num_patches());
+    }
+
+    /**
+     * @brief restrict the patches processed on the device to a subset of
+     * patches given as a device list of patch ids e.g., the patches touched by
+     * a local edit. With with_ring, the subset is expanded by the neighbor
+     * patches of every patch in the list (as stored in its PatchStash) which
+     * is needed when the edit reads or writes the ribbon. for_each_*(),
+     * run_kernel(), and run_query_kernel() then launch one block per patch in
+     * the subset such that their cost is proportional to the subset. Query
+     * and the query dispatchers map the blocks to the patches in the subset
+     * (see Context::block_patch_id()). run_query_tile_kernel() keeps its
+     * launch size and the tiles beyond the subset exit immediately. Custom
+     * kernels that do not go through Query or the query dispatchers should
+     * use Context::block_patch_id() instead of blockIdx.x and kernels
+     * launched directly should use at most get_patch_subset_size() blocks
+     * while the subset is set. The subset could be
+     * combined with set_patch_range(). Use get_patch_subset() with
+     * ReduceHandle::set_patch_subset() to reduce over the same subset. The
+     * whole mesh is still processed on the host
+     * @param d_patches device pointer to the patch ids (duplicates and
+     * invalid ids are ignored)
+     * @param num the number of patch ids in d_patches
+     * @param with_ring add the neighbor patches of the input patches
+     */
+    void set_patch_subset(const uint32_t* d_patches,
+                          const uint32_t  num,
+                          const bool      with_ring = false)
+    {
+        const uint32_t max_p = this->get_max_num_patches();
+
+        if (m_d_patch_subset == nullptr) {
+            CUDA_ERROR(tracked_malloc((void**)&m_d_patch_subset,
+                                      max_p * sizeof(uint32_t),
+                                      MemoryCategory::Topology));
+            CUDA_ERROR(tracked_malloc((void**)&m_d_patch_subset_flags,
+                                      max_p * sizeof(uint8_t),
+                                      MemoryCategory::Topology));
+        }
+
+        CUDA_ERROR(
+            cudaMemset(m_d_patch_subset_flags, 0, max_p * sizeof(uint8_t)));
+        if (num > 0) {
+            detail::mark_patch_subset<<<DIVIDE_UP(num, 256), 256>>>(
+                this->m_rxmesh_context,
+                num,
+                d_patches,
+                with_ring,
+                m_d_patch_subset_flags);
+        }
+
+        // the subset is sorted by patch id
+        std::vector<uint8_t> flags(max_p);
+        CUDA_ERROR(cudaMemcpy(flags.data(),
+                              m_d_patch_subset_flags,
+                              max_p * sizeof(uint8_t),
+                              cudaMemcpyDeviceToHost));
+        std::vector<uint32_t> subset;
+        for (uint32_t p = 0; p < max_p; ++p) {
+            if (flags[p]) {
+                subset.push_back(p);
+            }
+        }
+        CUDA_ERROR(cudaMemcpy(m_d_patch_subset,
+                              subset.data(),
+                              subset.size() * sizeof(uint32_t),
+                              cudaMemcpyHostToDevice));
+
+        this->m_rxmesh_context.m_patch_subset      = m_d_patch_subset;
+        this->m_rxmesh_context.m_patch_subset_size = subset.size();
+    }
+
+    /**
+     * @brief go back to processing all patches on the device
+     */
+    void clear_patch_subset()
+    {
+        this->m_rxmesh_context.m_patch_subset      = nullptr;
+        this->m_rxmesh_context.m_patch_subset_size = 0;
+    }
+
+    /**
+     * @brief check if a patch subset is set (see set_patch_subset())
+     */
+    bool has_patch_subset() const
+    {
+        return this->m_rxmesh_context.m_patch_subset != nullptr;
+    }
+
+    /**
+     * @brief device pointer to the (sorted) patch ids in the subset or
+     * nullptr if there is no subset
+     */
+    const uint32_t* get_patch_subset() const
+    {
+        return this->m_rxmesh_context.m_patch_subset;
+    }
+
+    /**
+     * @brief the number of patches in the subset
+     */
+    uint32_t get_patch_subset_size() const
+    {
+        return this->m_rxmesh_context.m_patch_subset_size;
+    }
+
+    /**
+     * @brief materialize the output of the query operation op for all patches
+     * in global memory such that query kernels launched afterwards (through
+     * Query, query_block_dispatcher(), or run_query_kernel()) load it instead
+     * of re-computing it. This pays off for iterative applications that run
+     * the same query many times on a static mesh. RXMeshDynamic invalidates
+     * the cached output of a patch once the patch is modified after which the
+     * query is computed as usual. Calling this again re-computes the cache
+     * @tparam op the query operation
+     * @tparam blockThreads the block size used to compute the query outputs
+     * @param oriented if the cached query is oriented. Queries with different
+     * orientation are computed as usual
+     */
+    template <Op op, uint32_t blockThreads = 256>
+    void enable_query_cache(const bool oriented = false)
+    {
+        disable_query_cache(op);
+
+        const uint32_t num_patches = get_num_patches();
+
+        // allocate for the patch capacity so the cache could still be
+        // re-computed after dynamic changes without re-allocating
+        std::vector<uint32_t> h_offset_start(num_patches + 1, 0);
+        std::vector<uint32_t> h_value_start(num_patches + 1, 0);
+        for (uint32_t p = 0; p < num_patches; ++p) {
+            uint32_t num_offset, num_value;
+            QueryCache::output_size(op,
+                                    this->m_h_patches_info[p].vertices_capacity,
+                                    this->m_h_patches_info[p].edges_capacity,
+                                    this->m_h_patches_info[p].faces_capacity,
+                                    num_offset,
+                                    num_value);
+            h_offset_start[p + 1] = h_offset_start[p] + num_offset;
+            h_value_start[p + 1]  = h_value_start[p] + num_value;
+        }
+
+        QueryCache cache;
+        cache.m_num_patches = num_patches;
+        cache.m_oriented    = oriented;
+
+        CUDA_ERROR(tracked_malloc((void**)&cache.m_offset_start,
+                                  (num_patches + 1) * sizeof(uint32_t),
+                                  MemoryCategory::Topology));
+        CUDA_ERROR(tracked_malloc((void**)&cache.m_value_start,
+                                  (num_patches + 1) * sizeof(uint32_t),
+                                  MemoryCategory::Topology));
+        CUDA_ERROR(tracked_malloc((void**)&cache.m_offset,
+                                  h_offset_start.back() * sizeof(uint16_t),
+                                  MemoryCategory::Topology));
+        CUDA_ERROR(tracked_malloc((void**)&cache.m_value,
+                                  h_value_start.back() * sizeof(uint16_t),
+                                  MemoryCategory::Topology));
+        CUDA_ERROR(tracked_malloc((void**)&cache.m_valid,
+                                  num_patches * sizeof(uint8_t),
+                                  MemoryCategory::Topology));
+
+        CUDA_ERROR(cudaMemcpy(cache.m_offset_start,
+                              h_offset_start.data(),
+                              (num_patches + 1) * sizeof(uint32_t),
+                              cudaMemcpyHostToDevice));
+        CUDA_ERROR(cudaMemcpy(cache.m_value_start,
+                              h_value_start.data(),
+                              (num_patches + 1) * sizeof(uint32_t),
+                              cudaMemcpyHostToDevice));
+        CUDA_ERROR(cudaMemset(cache.m_valid, 0, num_patches * sizeof(uint8_t)));
+
+        LaunchBox<blockThreads> launch_box;
+        prepare_launch_box({op},
+                           launch_box,
+                           (void*)detail::materialize_query<blockThreads, op>,
+                           oriented);
+
+        detail::materialize_query<blockThreads, op>
+            <<<launch_box.blocks,
+               launch_box.num_threads,
+               launch_box.smem_bytes_dyn>>>(
+                this->m_rxmesh_context, oriented, cache);
+
+        m_h_query_cache[uint32_t(op)] = cache;
+        upload_query_cache();
+
+        RXMESH_INFO(
+            "RXMeshStatic::enable_query_cache() cached {} using {} (MB)",
+            op_to_string(op),
+            float((h_offset_start.back() + h_value_start.back()) *
+                  sizeof(uint16_t)) /
+                float(1024 * 1024));
+    }
+
+    /**
+     * @brief free the materialized output of the query operation op (see
+     * enable_query_cache())
+     */
+    void disable_query_cache(const Op op)
+    {
+        if (!is_query_cached(op)) {
+            return;
+        }
+        release_query_cache(m_h_query_cache[uint32_t(op)]);
+        upload_query_cache();
+    }
+
+    /**
+     * @brief check if the output of the query operation op is materialized
+     * (see enable_query_cache())
+     */
+    bool is_query_cached(const Op op) const
+    {
+        return m_h_query_cache[uint32_t(op)].m_valid != nullptr;
+    }
+
+    /**
+     * @brief invalidate the materialized output of all query operations on all
+     * patches. Queries are computed as usual until enable_query_cache() is
+     * called again
+     */
+    void invalidate_query_cache()
+    {
+        for (uint32_t o = 0; o < QueryCache::num_ops; ++o) {
+            const QueryCache& cache = m_h_query_cache[o];
+            if (cache.m_valid != nullptr) {
+                CUDA_ERROR(cudaMemset(
+                    cache.m_valid, 0, cache.m_num_patches * sizeof(uint8_t)));
+            }
+        }
+    }
+
+    /**
+     * @brief attach an object (e.g., a precomputed operator) to the mesh under
+     * name such that different stages of a pipeline that use the same mesh
+     * can share it instead of re-building it. Objects are released before the
+     * mesh is destroyed. Setting an object under an existing name replaces it
+     */
+    void set_user_cache(const std::string& name, std::shared_ptr<void> obj)
+    {
+        std::lock_guard<std::mutex> lock(m_user_cache_mutex);
+        m_user_cache[name] = obj;
+    }
+
+    /**
+     * @brief return the object attached to the mesh under name (see
+     * set_user_cache()) or nullptr if there is no such object. The caller is
+     * responsible for using the same CacheT that the object is stored with
+     */
+    template <typename CacheT>
+    std::shared_ptr<CacheT> get_user_cache(const std::string& name) const
+    {
+        std::lock_guard<std::mutex> lock(m_user_cache_mutex);
+        auto                        it = m_user_cache.find(name);
+        if (it == m_user_cache.end()) {
+            return nullptr;
+        }
+        return std::static_pointer_cast<CacheT>(it->second);
+    }
+
+    /**
+     * @brief remove the object attached to the mesh under name (if any)
+     */
+    void remove_user_cache(const std::string& name)
+    {
+        std::lock_guard<std::mutex> lock(m_user_cache_mutex);
+        m_user_cache.erase(name);
+    }
+
+    /**
+     * @brief time every kernel launched on the device by for_each_*(),
+     * run_kernel(), run_query_kernel(), and run_query_tile_kernel() along with
+     * its launch configuration (blocks, threads, shared memory, registers)
+     * and an estimate of the topology bytes it reads (plus the user estimate
+     * of set_profile_cost() for the roofline). Launches are keyed by
+     * the kernel (or lambda type), the launching API, the query operations,
+     * and the current profile label. The launches are not synchronized (see
+     * KernelProfiler) so profiling can be left on. Use get_kernel_profiler()
+     * to print a summary or Report::kernel_profile() to write it as JSON
+     */
+    void enable_profiling()
+    {
+        if (!m_profiler) {
+            m_profiler = std::make_unique<KernelProfiler>();
+        }
+    }
+
+    /**
+     * @brief stop profiling and drop the collected profiles
+     */
+    void disable_profiling()
+    {
+        m_profiler.reset();
+    }
+
+    /**
+     * @brief if profiling is enabled
+     */
+    bool is_profiling_enabled() const
+    {
+        return m_profiler != nullptr;
+    }
+
+    /**
+     * @brief the profiler (nullptr if profiling is not enabled)
+     */
+    KernelProfiler* get_kernel_profiler() const
+    {
+        return m_profiler.get();
+    }
+
+    /**
+     * @brief name the following launches in the profile (e.g., by the stage
+     * of the pipeline) instead of their kernel/lambda type. An empty label
+     * goes back to the kernel/lambda type
+     */
+    void set_profile_label(const std::string& label)
+    {
+        m_profile_label = label;
+    }
+
+    /**
+     * @brief the estimated attribute traffic and floating-point operations
+     * per element of the following launches (see KernelCost) used to place
+     * them on the roofline. The default (zero) cost leaves only the topology
+     * bytes
+     */
+    void set_profile_cost(const KernelCost& cost)
+    {
+        m_profile_cost = cost;
+    }
+
+    /**
+     * @brief store an 8-bit copy of the patch-local topology (EV and FE) on
+     * the device which the query operations read (and widen to 16-bit in
+     * shared memory) instead of the 16-bit topology. This halves the global
+     * memory traffic of loading the topology in query-heavy kernels. This is
+     * only possible if the per-patch vertex capacity is less than 255 and the
+     * per-patch edge capacity is less than 128 (FE stores the edge direction in
+     * the lowest bit). The 8-bit copy is not updated by topology changes and
+     * so it is only meant for static meshes
+     * @return true if the topology is compressed. Otherwise, the patch
+     * capacities are too large and the topology is left unchanged
+     */
+    bool enable_compressed_topology()
+    {
+        disable_compressed_topology();
+
+        if (get_per_patch_max_vertex_capacity() >= INVALID8 ||
+            2 * get_per_patch_max_edge_capacity() >= INVALID8) {
+            RXMESH_WARN(
+                "RXMeshStatic::enable_compressed_topology() the per-patch "
+                "capacities (vertices= {}, edges= {}) do not fit in 8-bit "
+                "local indices",
+                get_per_patch_max_vertex_capacity(),
+                get_per_patch_max_edge_capacity());
+            return false;
+        }
+
+        const uint32_t num_patches = get_num_patches();
+
+        std::vector<uint32_t> h_start(num_patches + 1, 0);
+        for (uint32_t p = 0; p < num_patches; ++p) {
+            h_start[p + 1] = h_start[p] +
+                             2 * this->m_h_patches_info[p].edges_capacity +
+                             3 * this->m_h_patches_info[p].faces_capacity;
+        }
+
+        uint32_t* d_start;
+        CUDA_ERROR(tracked_malloc((void**)&d_start,
+                                  (num_patches + 1) * sizeof(uint32_t),
+                                  MemoryCategory::Topology));
+        CUDA_ERROR(cudaMemcpy(d_start,
+                              h_start.data(),
+                              (num_patches + 1) * sizeof(uint32_t),
+                              cudaMemcpyHostToDevice));
+        CUDA_ERROR(tracked_malloc((void**)&m_d_compressed_topology,
+                                  h_start.back() * sizeof(uint8_t),
+                                  MemoryCategory::Topology));
+
+        constexpr uint32_t blockThreads = 256;
+        detail::compress_topology<blockThreads>
+            <<<num_patches, blockThreads>>>(this->m_d_patches_info,
+                                            num_patches,
+                                            m_d_compressed_topology,
+                                            d_start);
+        CUDA_ERROR(cudaDeviceSynchronize());
+        GPU_FREE(d_start);
+
+        RXMESH_INFO(
+            "RXMeshStatic::enable_compressed_topology() compressed topology "
+            "uses {} (MB)",
+            float(h_start.back()) / float(1024 * 1024));
+
+        return true;
+    }
+
+    /**
+     * @brief free the 8-bit copy of the topology (see
+     * enable_compressed_topology()) such that queries read the 16-bit topology
+     */
+    void disable_compressed_topology()
+    {
+        if (!is_topology_compressed()) {
+            return;
+        }
+        const uint32_t num_patches = get_num_patches();
+
+        detail::compress_topology<1><<<num_patches, 1>>>(
+            this->m_d_patches_info, num_patches, nullptr, nullptr);
+        CUDA_ERROR(cudaDeviceSynchronize());
+        GPU_FREE(m_d_compressed_topology);
+    }
+
+    /**
+     * @brief check if queries read the 8-bit copy of the topology (see
+     * enable_compressed_topology())
+     */
+    bool is_topology_compressed() const
+    {
+        return m_d_compressed_topology != nullptr;
+    }
+
+    /**
+     * @brief store, for every patch, a direct map from the local index of
+     * each not-owned (ribbon) mesh element to its owner handle such that
+     * iterators and get_owner_handle() read the owner with one load instead of
+     * probing the LP hashtable. Queries also skip loading the hashtable into
+     * shared memory. The map costs 8 bytes per mesh element (per patch) and
+     * is not updated by topology changes and so it is only meant for static
+     * meshes
+     */
+    void enable_owner_table()
+    {
+        disable_owner_table();
+
+        const uint32_t num_patches = get_num_patches();
+
+        std::vector<uint32_t> h_start(num_patches + 1, 0);
+        for (uint32_t p = 0; p < num_patches; ++p) {
+            const PatchInfo& pi = this->m_h_patches_info[p];
+            h_start[p + 1] = h_start[p] + pi.num_vertices[0] +
+                             pi.num_edges[0] + pi.num_faces[0];
+        }
+
+        uint32_t* d_start;
+        CUDA_ERROR(tracked_malloc((void**)&d_start,
+                                  (num_patches + 1) * sizeof(uint32_t),
+                                  MemoryCategory::Topology));
+        CUDA_ERROR(cudaMemcpy(d_start,
+                              h_start.data(),
+                              (num_patches + 1) * sizeof(uint32_t),
+                              cudaMemcpyHostToDevice));
+        CUDA_ERROR(tracked_malloc((void**)&m_d_owner_table,
+                                  h_start.back() * sizeof(uint64_t),
+                                  MemoryCategory::Topology));
+
+        constexpr uint32_t blockThreads = 256;
+        detail::build_owner_table<blockThreads>
+            <<<num_patches, blockThreads>>>(
+                this->m_d_patches_info, num_patches, m_d_owner_table, d_start);
+        CUDA_ERROR(cudaDeviceSynchronize());
+        GPU_FREE(d_start);
+
+        RXMESH_INFO(
+            "RXMeshStatic::enable_owner_table() owner table uses {} (MB)",
+            BYTES_TO_MEGABYTES(h_start.back() * sizeof(uint64_t)));
+    }
+
+    /**
+     * @brief free the owner table (see enable_owner_table()) such that the
+     * not-owned elements are resolved through the LP hashtable
+     */
+    void disable_owner_table()
+    {
+        if (!has_owner_table()) {
+            return;
+        }
+        const uint32_t num_patches = get_num_patches();
+
+        detail::build_owner_table<1><<<num_patches, 1>>>(
+            this->m_d_patches_info, num_patches, nullptr, nullptr);
+        CUDA_ERROR(cudaDeviceSynchronize());
+        GPU_FREE(m_d_owner_table);
+    }
+
+    /**
+     * @brief check if the not-owned elements are resolved through the owner
+     * table (see enable_owner_table())
+     */
+    bool has_owner_table() const
+    {
+        return m_d_owner_table != nullptr;
+    }
+
+    /**
+     * @brief return the number of patches processed per launch by
+     * for_each_*() on the device (see set_patch_window())
+     */
+    uint32_t get_patch_window() const
+    {
+        return m_patch_window;
+    }
+
+    /**
+     * @brief asynchronously migrate the topology and all attributes of the
+     * patches [begin, end) to the device. This is only effective if RXMesh is
+     * compiled with USE_OUT_OF_CORE, otherwise it is a no-op
+     * @param with_ribbon also prefetch the patches in the PatchStash of
+     * [begin, end) i.e., the owner patches of their ribbon elements
+     */
+    void prefetch_patches(const uint32_t begin,
+                          const uint32_t end,
+                          cudaStream_t   stream      = NULL,
+                          const bool     with_ribbon = true) const
+    {
+#ifdef USE_OUT_OF_CORE
+        std::vector<uint32_t> patches;
+        patches.reserve(end - begin);
+        for (uint32_t p = begin; p < end; ++p) {
+            patches.push_back(p);
+            if (with_ribbon) {
+                const PatchStash& stash = this->m_h_patches_info[p].patch_stash;
+                for (uint8_t i = 0; i < PatchStash::stash_size; ++i) {
+                    const uint32_t q = stash.get_patch(i);
+                    if (q != INVALID32 && (q < begin || q >= end)) {
+                        patches.push_back(q);
+                    }
+                }
+            }
+        }
+        std::sort(patches.begin(), patches.end());
+        patches.erase(std::unique(patches.begin(), patches.end()),
+                      patches.end());
+
+        for (const uint32_t p : patches) {
+            this->prefetch_patch(p, stream);
+            if (m_attr_container) {
+                m_attr_container->prefetch(p, stream);
+            }
+        }
+#endif
     }
 
 #if USE_POLYSCOPE
@@ -483,10 +1263,33 @@ class RXMeshStatic : public RXMesh
         if ((location & DEVICE) == DEVICE) {
             if constexpr (IS_HD_LAMBDA(LambdaT) || IS_D_LAMBDA(LambdaT)) {
 
-                const int num_patches = this->get_num_patches();
-                const int threads     = 256;
-                detail::for_each_vertex<<<num_patches, threads, 0, stream>>>(
-                    num_patches, this->m_d_patches_info, apply);
+                const int threads = 256;
+                profiled_launch<LambdaT>(
+                    "for_each_vertex",
+                    {},
+                    get_num_patches(),
+                    threads,
+                    0,
+                    (const void*)detail::for_each_vertex<LambdaT>,
+                    stream,
+                    [&]() {
+                        if (has_patch_subset()) {
+                            launch_patch_subset<VertexHandle>(apply, stream);
+                            return;
+                        }
+                        launch_windowed(stream,
+                                        [&](uint32_t     begin,
+                                            uint32_t     count,
+                                            cudaStream_t st) {
+                                            detail::for_each_vertex<<<count,
+                                                                      threads,
+                                                                      0,
+                                                                      st>>>(
+                                                count,
+                                                this->m_d_patches_info + begin,
+                                                apply);
+                                        });
+                    });
             } else {
                 RXMESH_ERROR(
                     "RXMeshStatic::for_each_vertex() Input lambda function "
@@ -545,10 +1348,33 @@ class RXMeshStatic : public RXMesh
         if ((location & DEVICE) == DEVICE) {
             if constexpr (IS_HD_LAMBDA(LambdaT) || IS_D_LAMBDA(LambdaT)) {
 
-                const int num_patches = this->get_num_patches();
-                const int threads     = 256;
-                detail::for_each_edge<<<num_patches, threads, 0, stream>>>(
-                    num_patches, this->m_d_patches_info, apply);
+                const int threads = 256;
+                profiled_launch<LambdaT>(
+                    "for_each_edge",
+                    {},
+                    get_num_patches(),
+                    threads,
+                    0,
+                    (const void*)detail::for_each_edge<LambdaT>,
+                    stream,
+                    [&]() {
+                        if (has_patch_subset()) {
+                            launch_patch_subset<EdgeHandle>(apply, stream);
+                            return;
+                        }
+                        launch_windowed(stream,
+                                        [&](uint32_t     begin,
+                                            uint32_t     count,
+                                            cudaStream_t st) {
+                                            detail::for_each_edge<<<count,
+                                                                    threads,
+                                                                    0,
+                                                                    st>>>(
+                                                count,
+                                                this->m_d_patches_info + begin,
+                                                apply);
+                                        });
+                    });
             } else {
                 RXMESH_ERROR(
                     "RXMeshStatic::for_each_edge() Input lambda function "
@@ -606,10 +1432,33 @@ class RXMeshStatic : public RXMesh
         if ((location & DEVICE) == DEVICE) {
             if constexpr (IS_HD_LAMBDA(LambdaT) || IS_D_LAMBDA(LambdaT)) {
 
-                const int num_patches = this->get_num_patches();
-                const int threads     = 256;
-                detail::for_each_face<<<num_patches, threads, 0, stream>>>(
-                    num_patches, this->m_d_patches_info, apply);
+                const int threads = 256;
+                profiled_launch<LambdaT>(
+                    "for_each_face",
+                    {},
+                    get_num_patches(),
+                    threads,
+                    0,
+                    (const void*)detail::for_each_face<LambdaT>,
+                    stream,
+                    [&]() {
+                        if (has_patch_subset()) {
+                            launch_patch_subset<FaceHandle>(apply, stream);
+                            return;
+                        }
+                        launch_windowed(stream,
+                                        [&](uint32_t     begin,
+                                            uint32_t     count,
+                                            cudaStream_t st) {
+                                            detail::for_each_face<<<count,
+                                                                    threads,
+                                                                    0,
+                                                                    st>>>(
+                                                count,
+                                                this->m_d_patches_info + begin,
+                                                apply);
+                                        });
+                    });
             } else {
                 RXMESH_ERROR(
                     "RXMeshStatic::for_each_face() Input lambda function "
@@ -628,7 +1477,7 @@ class RXMeshStatic : public RXMesh
     void for_each(locationT    location,
                   LambdaT      apply,
                   cudaStream_t stream   = NULL,
-                  bool         with_omp = true)
+                  bool         with_omp = true) const
     {
         if constexpr (std::is_same_v<HandleT, VertexHandle>) {
             for_each_vertex(location, apply, stream, with_omp);
@@ -643,41 +1492,337 @@ class RXMeshStatic : public RXMesh
         }
     }
 
-
     /**
-     * @brief Launching a kernel knowing its launch box
-     * @tparam ...ArgsT inferred
+     * @brief apply a lambda function on all owned mesh elements of type
+     * HandleT in the dense (i.e., linear_id()) order. Unlike for_each(), the
+     * device launch is a grid-stride loop over a compacted array of the
+     * handles of the owned and active elements (built on the first call) so
+     * there is no thread per unused local index and no test of the
+     * owned/active masks. This is meant for element-wise kernels on static
+     * meshes. The lambda signature takes the handle and its dense index
+     * (uint32_t) which equals linear_id() of the handle and thus could be
+     * used to index into DenseMatrix or std::vector directly. With
+     * set_patch_range(), only the (contiguous) dense indices of the owned
+     * elements of the patches in the range are processed. The patch window
+     * (set_patch_window()) is not used
+     * @param location the execution location
+     * @param apply lambda function to be applied on all elements
+     * @param stream the stream used to run the kernel in case of DEVICE
+     * execution location
+     */
+    template <typename HandleT, typename LambdaT>
+    void for_each_dense(locationT    location,
+                        LambdaT      apply,
+                        cudaStream_t stream = NULL) const
+    {
+        if ((location & HOST) == HOST) {
+            for_each<HandleT>(
+                HOST, [&](const HandleT h) { apply(h, linear_id(h)); });
+        }
+
+        if ((location & DEVICE) == DEVICE) {
+            if constexpr (IS_HD_LAMBDA(LambdaT) || IS_D_LAMBDA(LambdaT)) {
+                const HandleT* handles = get_dense_index<HandleT>();
+
+                const uint32_t* prefix = get_h_prefix<HandleT>();
+
+                const uint32_t p_end = get_patch_range_end();
+                const uint32_t p_begin =
+                    std::min(get_patch_range_begin(), p_end);
+
+                const uint32_t begin = prefix[p_begin];
+                const uint32_t end   = prefix[p_end];
+                if (end <= begin) {
+                    return;
+                }
+
+                const uint32_t threads = 256;
+
+                int device_id, num_sm;
+                CUDA_ERROR(cudaGetDevice(&device_id));
+                CUDA_ERROR(cudaDeviceGetAttribute(
+                    &num_sm, cudaDevAttrMultiProcessorCount, device_id));
+
+                // enough blocks to fill the device, the rest is done by the
+                // grid-stride loop
+                const uint32_t blocks =
+                    std::min(DIVIDE_UP(end - begin, threads),
+                             uint32_t(num_sm) * (2048 / threads));
+
+                profiled_launch<LambdaT>(
+                    for_each_dense_api<HandleT>(),
+                    {},
+                    blocks,
+                    threads,
+                    0,
+                    (const void*)detail::for_each_dense<HandleT, LambdaT>,
+                    stream,
+                    [&]() {
+                        detail::for_each_dense<HandleT>
+                            <<<blocks, threads, 0, stream>>>(
+                                begin, end, handles, apply);
+                    });
+            } else {
+                RXMESH_ERROR(
+                    "RXMeshStatic::for_each_dense() Input lambda function "
+                    "should be annotated with  __device__ for execution on "
+                    "device");
+            }
+        }
+    }
+
+    /**
+     * @brief apply a lambda function on all (owned mesh element, sample)
+     * pairs of an ensemble of num_samples samples (see
+     * add_ensemble_attribute()). This is for element-wise kernels that run
+     * the same computation on every sample such that one launch covers all
+     * samples. The lambda signature takes the handle and the sample index
+     * (uint32_t). On the device, consecutive threads get the consecutive
+     * samples of the same mesh element
+     * @param location the execution location
+     * @param num_samples the number of samples
+     * @param apply lambda function to be applied on all pairs
+     * @param stream the stream used to run the kernel in case of DEVICE
+     * execution location
+     */
+    template <typename HandleT, typename LambdaT>
+    void for_each_sample(locationT      location,
+                         const uint32_t num_samples,
+                         LambdaT        apply,
+                         cudaStream_t   stream = NULL) const
+    {
+        if (num_samples == 0) {
+            return;
+        }
+
+        if ((location & HOST) == HOST) {
+            for_each<HandleT>(HOST, [&](const HandleT h) {
+                for (uint32_t s = 0; s < num_samples; ++s) {
+                    apply(h, s);
+                }
+            });
+        }
+
+        if ((location & DEVICE) == DEVICE) {
+            if constexpr (IS_HD_LAMBDA(LambdaT) || IS_D_LAMBDA(LambdaT)) {
+                const HandleT* handles = get_dense_index<HandleT>();
+
+                const uint32_t* prefix = get_h_prefix<HandleT>();
+
+                const uint32_t p_end = get_patch_range_end();
+                const uint32_t p_begin =
+                    std::min(get_patch_range_begin(), p_end);
+
+                const uint32_t begin = prefix[p_begin];
+                const uint32_t end   = prefix[p_end];
+                if (end <= begin) {
+                    return;
+                }
+
+                const uint32_t threads = 256;
+
+                int device_id, num_sm;
+                CUDA_ERROR(cudaGetDevice(&device_id));
+                CUDA_ERROR(cudaDeviceGetAttribute(
+                    &num_sm, cudaDevAttrMultiProcessorCount, device_id));
+
+                const size_t num_pairs = size_t(end - begin) * num_samples;
+
+                const uint32_t blocks = uint32_t(
+                    std::min(DIVIDE_UP(num_pairs, size_t(threads)),
+                             size_t(num_sm) * (2048 / threads)));
+
+                profiled_launch<LambdaT>(
+                    for_each_dense_api<HandleT>(),
+                    {},
+                    blocks,
+                    threads,
+                    0,
+                    (const void*)
+                        detail::for_each_dense_sample<HandleT, LambdaT>,
+                    stream,
+                    [&]() {
+                        detail::for_each_dense_sample<HandleT>
+                            <<<blocks, threads, 0, stream>>>(
+                                begin, end, num_samples, handles, apply);
+                    });
+            } else {
+                RXMESH_ERROR(
+                    "RXMeshStatic::for_each_sample() Input lambda function "
+                    "should be annotated with  __device__ for execution on "
+                    "device");
+            }
+        }
+    }
+
+    /**
+     * @brief free the dense index used by for_each_dense() such that it is
+     * re-built on the next call. RXMeshDynamic calls this once the topology
+     * on the host is updated (update_host())
+     */
+    void release_dense_index()
+    {
+        GPU_FREE(m_d_dense_v);
+        GPU_FREE(m_d_dense_e);
+        GPU_FREE(m_d_dense_f);
+        GPU_FREE(m_edge_map.m_keys);
+        GPU_FREE(m_edge_map.m_values);
+        m_edge_map.m_capacity = 0;
+    }
+
+    /**
+     * @brief the batched (device) version of map_to_local_vertex(),
+     * map_to_local_edge(), and map_to_local_face(). Map num global indices
+     * (i.e., linear_id()) to their handles where both d_ids and d_handles are
+     * device pointers. Indices that are out of range are mapped to invalid
+     * handles. Uses the dense index (see for_each_dense()) which is built
+     * on the first call
+     */
+    template <typename HandleT>
+    void map_to_local_handles(const uint32_t* d_ids,
+                              const uint32_t  num,
+                              HandleT*        d_handles,
+                              cudaStream_t    stream = NULL) const
+    {
+        if (num == 0) {
+            return;
+        }
+        const HandleT* dense = get_dense_index<HandleT>();
+
+        const uint32_t threads = 256;
+        detail::map_linear_ids<HandleT>
+            <<<DIVIDE_UP(num, threads), threads, 0, stream>>>(
+                num, d_ids, get_num_elements<HandleT>(), dense, d_handles);
+    }
+
+    /**
+     * @brief the batched (device) version of get_edge_id(v0, v1) in the
+     * handle space i.e., find the edge connecting the vertices whose global
+     * indices (linear_id()) are d_v0[i] and d_v1[i] and write its handle in
+     * d_edges[i] (or an invalid handle if the two vertices are not
+     * connected). All pointers are device pointers. The lookup uses a device
+     * hash map (see get_edge_map()) that is built on the first call
+     */
+    void get_edge_handles(const uint32_t* d_v0,
+                          const uint32_t* d_v1,
+                          const uint32_t  num,
+                          EdgeHandle*     d_edges,
+                          cudaStream_t    stream = NULL) const
+    {
+        if (num == 0) {
+            return;
+        }
+        const DeviceEdgeMap map = get_edge_map();
+
+        const uint32_t threads = 256;
+        detail::map_vertex_pairs<<<DIVIDE_UP(num, threads),
+                                   threads,
+                                   0,
+                                   stream>>>(num, d_v0, d_v1, map, d_edges);
+    }
+
+    /**
+     * @brief the device hash map from a pair of vertex global indices
+     * (linear_id()) to the edge handle connecting them. It could be passed
+     * to kernels to do the lookup (DeviceEdgeMap::find()) on the device. The
+     * map is built on the first call and is released along with the dense
+     * index (i.e., once the topology on the host is updated)
+     */
+    const DeviceEdgeMap& get_edge_map() const
+    {
+        if (m_edge_map.m_keys == nullptr) {
+            // load factor of at most 0.5
+            m_edge_map.m_capacity = std::max(2 * get_num_edges(), 1u);
+
+            CUDA_ERROR(tracked_malloc((void**)&m_edge_map.m_keys,
+                                      m_edge_map.m_capacity * sizeof(uint64_t),
+                                      MemoryCategory::Topology));
+            CUDA_ERROR(
+                tracked_malloc((void**)&m_edge_map.m_values,
+                               m_edge_map.m_capacity * sizeof(EdgeHandle),
+                               MemoryCategory::Topology));
+            CUDA_ERROR(cudaMemset(m_edge_map.m_keys,
+                                  0xFF,
+                                  m_edge_map.m_capacity * sizeof(uint64_t)));
+
+            detail::build_edge_map<<<get_num_patches(), 256>>>(
+                this->m_rxmesh_context, m_edge_map);
+            CUDA_ERROR(cudaGetLastError());
+        }
+        return m_edge_map;
+    }
+
+
+    /**
+     * @brief Launching a kernel knowing its launch box
+     * @tparam ...ArgsT inferred
+     * @tparam blockThreads the block size
+     * @param lb launch box populated via prepare_launch_box
+     * @param kernel the kernel to launch
+     * @param stream to launch the kernel on
+     * @param ...args input parameters to the kernel
+     */
+    template <uint32_t blockThreads, typename KernelT, typename... ArgsT>
+    void run_kernel(const LaunchBox<blockThreads>& lb,
+                    const KernelT                  kernel,
+                    cudaStream_t                   stream,
+                    ArgsT... args) const
+    {
+        run_kernel(lb, kernel, std::vector<Op>{}, stream, args...);
+    }
+
+    /**
+     * @brief Launching a kernel knowing its launch box on the default stream
+     * @tparam ...ArgsT infered
      * @tparam blockThreads the block size
      * @param lb launch box populated via prepare_launch_box
      * @param kernel the kernel to launch
-     * @param stream to launch the kernel on
      * @param ...args input parameters to the kernel
      */
     template <uint32_t blockThreads, typename KernelT, typename... ArgsT>
     void run_kernel(const LaunchBox<blockThreads>& lb,
                     const KernelT                  kernel,
-                    cudaStream_t                   stream,
                     ArgsT... args) const
     {
-        kernel<<<lb.blocks, lb.num_threads, lb.smem_bytes_dyn, stream>>>(
-            get_context(), args...);
+        run_kernel(lb, kernel, std::vector<Op>{}, NULL, args...);
     }
 
     /**
-     * @brief Launching a kernel knowing its launch box on the default stream
-     * @tparam ...ArgsT infered
+     * @brief Launching a kernel knowing its launch box and the query
+     * operations used inside it (only used for profiling)
+     * @tparam ...ArgsT inferred
      * @tparam blockThreads the block size
      * @param lb launch box populated via prepare_launch_box
      * @param kernel the kernel to launch
+     * @param op list of query operations used inside the kernel
+     * @param stream to launch the kernel on
      * @param ...args input parameters to the kernel
      */
     template <uint32_t blockThreads, typename KernelT, typename... ArgsT>
     void run_kernel(const LaunchBox<blockThreads>& lb,
                     const KernelT                  kernel,
+                    const std::vector<Op>&         op,
+                    cudaStream_t                   stream,
                     ArgsT... args) const
     {
-        kernel<<<lb.blocks, lb.num_threads, lb.smem_bytes_dyn>>>(get_context(),
-                                                                 args...);
+        profiled_launch<KernelT>(
+            "run_kernel",
+            op,
+            lb.blocks,
+            lb.num_threads,
+            lb.smem_bytes_dyn,
+            (const void*)kernel,
+            stream,
+            [&]() {
+                // one block per patch in the subset (if any)
+                const uint32_t blocks =
+                    has_patch_subset() ? get_patch_subset_size() : lb.blocks;
+                if (blocks == 0) {
+                    return;
+                }
+                kernel<<<blocks, lb.num_threads, lb.smem_bytes_dyn, stream>>>(
+                    get_context(), args...);
+            });
     }
 
     /**
@@ -704,6 +1849,32 @@ class RXMeshStatic : public RXMesh
             args...);
     }
 
+    /**
+     * @brief run a kernel that will require a query operation on a stream
+     * @tparam ...ArgsT infered
+     * @tparam blockThreads the block size
+     * @param op list of query operations used inside the kernel
+     * @param kernel the kernel to run
+     * @param stream to launch the kernel on
+     * @param ...args the inputs to the kernel
+     */
+    template <uint32_t blockThreads, typename KernelT, typename... ArgsT>
+    void run_kernel(const std::vector<Op> op,
+                    KernelT               kernel,
+                    cudaStream_t          stream,
+                    ArgsT... args) const
+    {
+        run_kernel<blockThreads>(
+            kernel,
+            op,
+            false,
+            false,
+            false,
+            [](uint32_t v, uint32_t e, uint32_t f) -> size_t { return 0; },
+            stream,
+            args...);
+    }
+
     /**
      * @brief run a kernel that will require a query operation
      * @tparam ...ArgsT infered
@@ -742,7 +1913,7 @@ class RXMeshStatic : public RXMesh
                            is_concurrent,
                            user_shmem);
 
-        run_kernel(lb, kernel, args...);
+        run_kernel(lb, kernel, op, stream, args...);
     }
 
     /**
@@ -772,7 +1943,7 @@ class RXMeshStatic : public RXMesh
         prepare_launch_box(
             {op},
             lb,
-            (void*)detail::query_kernel<blockThreads, op, LambdaT>,
+            detail::query_kernel_ptr<blockThreads, op, LambdaT>(oriented),
             oriented);
 
         run_query_kernel<op>(lb, user_lambda, oriented, stream);
@@ -801,9 +1972,87 @@ class RXMeshStatic : public RXMesh
                           const bool              oriented = false,
                           cudaStream_t            stream   = NULL) const
     {
-        detail::query_kernel<blockThreads, op>
-            <<<lb.blocks, lb.num_threads, lb.smem_bytes_dyn, stream>>>(
-                get_context(), oriented, user_lambda);
+        profiled_launch<LambdaT>(
+            "run_query_kernel",
+            {op},
+            lb.blocks,
+            lb.num_threads,
+            lb.smem_bytes_dyn,
+            detail::query_kernel_ptr<blockThreads, op, LambdaT>(oriented),
+            stream,
+            [&]() {
+                // one block per patch in the subset (if any)
+                const uint32_t blocks =
+                    has_patch_subset() ? get_patch_subset_size() : lb.blocks;
+                if (blocks == 0) {
+                    return;
+                }
+                // the orientation is a template parameter of the kernel such
+                // that the non-oriented kernel has no oriented code
+                auto launch = [&](auto oriented_t) {
+                    detail::query_kernel<blockThreads, op>
+                        <<<blocks, lb.num_threads, lb.smem_bytes_dyn, stream>>>(
+                            get_context(), oriented_t, user_lambda);
+                };
+                if constexpr (detail::has_oriented_query<op>()) {
+                    if (oriented) {
+                        launch(std::true_type{});
+                        return;
+                    }
+                }
+                launch(std::false_type{});
+            });
+    }
+
+    /**
+     * @brief same as run_query_kernel() but the query is done by tiles
+     * (thread_block_tile) of size tileSize such that every block processes
+     * blockThreads/tileSize patches concurrently (see query_tile_dispatcher()).
+     * This is useful for small patches and low-valence queries where one patch
+     * per block limits the occupancy. Oriented queries, Op::EVDiamond, and
+     * Op::EE are not supported
+     * @param lb the launch box as initialized by prepare_tile_launch_box
+     * @param user_lambda the user lambda function (same as run_query_kernel())
+     * @param stream the stream to launch the kernel on
+     */
+    template <Op op, uint32_t tileSize, uint32_t blockThreads, typename LambdaT>
+    void run_query_tile_kernel(LaunchBox<blockThreads> lb,
+                               const LambdaT           user_lambda,
+                               cudaStream_t            stream = NULL) const
+    {
+        profiled_launch<LambdaT>(
+            "run_query_tile_kernel",
+            {op},
+            lb.blocks,
+            lb.num_threads,
+            lb.smem_bytes_dyn,
+            (const void*)
+                detail::query_tile_kernel<blockThreads, tileSize, op, LambdaT>,
+            stream,
+            [&]() {
+                detail::query_tile_kernel<blockThreads, tileSize, op>
+                    <<<lb.blocks, lb.num_threads, lb.smem_bytes_dyn, stream>>>(
+                        get_context(), user_lambda);
+            });
+    }
+
+    /**
+     * @brief same as run_query_tile_kernel() but the launch box is prepared
+     * internally
+     */
+    template <Op op, uint32_t blockThreads, uint32_t tileSize, typename LambdaT>
+    void run_query_tile_kernel(const LambdaT user_lambda,
+                               cudaStream_t  stream = NULL) const
+    {
+        LaunchBox<blockThreads> lb;
+
+        prepare_tile_launch_box<tileSize>(
+            {op},
+            lb,
+            (void*)
+                detail::query_tile_kernel<blockThreads, tileSize, op, LambdaT>);
+
+        run_query_tile_kernel<op, tileSize>(lb, user_lambda, stream);
     }
 
 
@@ -834,8 +2083,22 @@ class RXMeshStatic : public RXMesh
         std::function<size_t(uint32_t, uint32_t, uint32_t)> user_shmem =
             [](uint32_t v, uint32_t e, uint32_t f) { return 0; }) const
     {
+        const size_t user_smem = user_shmem(m_max_vertices_per_patch,
+                                            m_max_edges_per_patch,
+                                            m_max_faces_per_patch);
+
+        launch_box.blocks = this->m_num_patches;
+
+        std::vector<uint64_t> key = launch_cache_key(
+            op,
+            kernel,
+            blockThreads,
+            {oriented, with_vertex_valence, is_concurrent, false},
+            user_smem);
+        if (find_launch_config(key, launch_box)) {
+            return;
+        }
 
-        launch_box.blocks         = this->m_num_patches;
         launch_box.smem_bytes_dyn = 0;
 
         for (auto o : op) {
@@ -849,9 +2112,7 @@ class RXMeshStatic : public RXMesh
             }
         }
 
-        launch_box.smem_bytes_dyn += user_shmem(m_max_vertices_per_patch,
-                                                m_max_edges_per_patch,
-                                                m_max_faces_per_patch);
+        launch_box.smem_bytes_dyn += user_smem;
 
         if (with_vertex_valence) {
             if (get_input_max_valence() > 256) {
@@ -879,6 +2140,260 @@ class RXMeshStatic : public RXMesh
                             launch_box.local_mem_per_thread,
                             blockThreads,
                             kernel);
+
+        add_launch_config(std::move(key), launch_box);
+    }
+
+    /**
+     * @brief populate the launch_box with grid size and dynamic shared memory
+     * needed for a kernel that runs tile-level queries (see
+     * run_query_tile_kernel()). Every block processes blockThreads/tileSize
+     * patches and its dynamic shared memory is split evenly between them
+     * @param op List of query operations done inside this the kernel (i.e.,
+     * one after the other)
+     * @param launch_box input launch box to be populated
+     * @param kernel The kernel to be launched
+     * @param user_shmem a (lambda) function that takes the number of vertices,
+     * edges, and faces and returns additional user-desired shared memory in
+     * bytes per tile
+     */
+    template <uint32_t tileSize, uint32_t blockThreads>
+    void prepare_tile_launch_box(
+        const std::vector<Op>    op,
+        LaunchBox<blockThreads>& launch_box,
+        const void*              kernel,
+        std::function<size_t(uint32_t, uint32_t, uint32_t)> user_shmem =
+            [](uint32_t v, uint32_t e, uint32_t f) { return 0; }) const
+    {
+        static_assert(blockThreads % tileSize == 0,
+                      "RXMeshStatic::prepare_tile_launch_box() blockThreads "
+                      "should be a multiple of tileSize");
+
+        constexpr uint32_t tiles_per_block = blockThreads / tileSize;
+
+        const size_t user_smem = user_shmem(m_max_vertices_per_patch,
+                                            m_max_edges_per_patch,
+                                            m_max_faces_per_patch);
+
+        launch_box.blocks = DIVIDE_UP(this->m_num_patches, tiles_per_block);
+
+        std::vector<uint64_t> key = launch_cache_key(
+            op, kernel, blockThreads, {false, false, false, true}, user_smem);
+        key.push_back(tileSize);
+        if (find_launch_config(key, launch_box)) {
+            return;
+        }
+
+        size_t tile_smem = 0;
+        for (auto o : op) {
+            tile_smem = std::max(tile_smem, calc_tile_shared_memory(o));
+        }
+
+        tile_smem += user_smem;
+
+        // every tile's chunk should start at an aligned address
+        tile_smem = DIVIDE_UP(tile_smem, ShmemAllocator::default_alignment) *
+                    ShmemAllocator::default_alignment;
+
+        launch_box.smem_bytes_dyn = tiles_per_block * tile_smem;
+
+        RXMESH_TRACE(
+            "RXMeshStatic::prepare_tile_launch_box() launching {} blocks with "
+            "{} threads ({} patches per block) on the device",
+            launch_box.blocks,
+            blockThreads,
+            tiles_per_block);
+
+        check_shared_memory(launch_box.smem_bytes_dyn,
+                            launch_box.smem_bytes_static,
+                            launch_box.num_registers_per_thread,
+                            launch_box.local_mem_per_thread,
+                            blockThreads,
+                            kernel);
+
+        add_launch_config(std::move(key), launch_box);
+    }
+
+    /**
+     * @brief clear the cached launch configurations of prepare_launch_box()
+     * and prepare_tile_launch_box(). The cache is keyed by the kernel, block
+     * size, list of ops, launch flags, user shared memory, and the max patch
+     * sizes and so it does not need to be cleared when the patches change.
+     * This is only needed to release the (small) memory used by the cache
+     */
+    void clear_launch_cache() const
+    {
+        std::lock_guard<std::mutex> lock(m_launch_cache_mutex);
+        m_launch_cache.clear();
+    }
+
+    /**
+     * @brief report the resource usage (shared memory, registers, and local
+     * memory) and the theoretical occupancy of a kernel launched with a launch
+     * box populated by one of the prepare_*_launch_box() functions
+     * @param launch_box the launch box used to launch the kernel
+     * @param kernel the kernel to be launched
+     */
+    template <uint32_t blockThreads>
+    LaunchReport get_launch_report(const LaunchBox<blockThreads>& launch_box,
+                                   const void* kernel) const
+    {
+        LaunchReport report;
+        report.block_threads  = blockThreads;
+        report.blocks         = launch_box.blocks;
+        report.smem_bytes_dyn = launch_box.smem_bytes_dyn;
+
+        cudaFuncAttributes func_attr = cudaFuncAttributes();
+        CUDA_ERROR(cudaFuncGetAttributes(&func_attr, kernel));
+
+        report.smem_bytes_static        = func_attr.sharedSizeBytes;
+        report.num_registers_per_thread = func_attr.numRegs;
+        report.local_mem_per_thread     = func_attr.localSizeBytes;
+
+        int device_id;
+        CUDA_ERROR(cudaGetDevice(&device_id));
+        cudaDeviceProp devProp;
+        CUDA_ERROR(cudaGetDeviceProperties(&devProp, device_id));
+
+        CUDA_ERROR(cudaOccupancyMaxActiveBlocksPerMultiprocessor(
+            &report.blocks_per_sm,
+            kernel,
+            blockThreads,
+            launch_box.smem_bytes_dyn));
+
+        report.occupancy = double(report.blocks_per_sm * blockThreads) /
+                           double(devProp.maxThreadsPerMultiProcessor);
+
+        // the (approximate) number of blocks per SM allowed by every resource
+        // ignoring the allocation granularity
+        const size_t smem_per_block = report.smem_bytes_dyn +
+                                      report.smem_bytes_static +
+                                      devProp.reservedSharedMemPerBlock;
+        const size_t regs_per_block =
+            size_t(report.num_registers_per_thread) * blockThreads;
+
+        const size_t by_threads =
+            std::min(size_t(devProp.maxThreadsPerMultiProcessor / blockThreads),
+                     size_t(devProp.maxBlocksPerMultiProcessor));
+        const size_t by_smem = devProp.sharedMemPerMultiprocessor /
+                               std::max(smem_per_block, size_t(1));
+        const size_t by_regs =
+            (regs_per_block == 0) ?
+                by_threads :
+                size_t(devProp.regsPerMultiprocessor) / regs_per_block;
+
+        if (by_smem < std::min(by_threads, by_regs)) {
+            report.limiter = "shared memory";
+        } else if (by_regs < by_threads) {
+            report.limiter = "registers";
+        } else {
+            report.limiter = "threads";
+        }
+
+        return report;
+    }
+
+    /**
+     * @brief suggest the block size (from 128, 256, 512, 768, and 1024) that
+     * maximizes the number of resident threads per SM for a query kernel
+     * launched via run_query_kernel() with the given op and user lambda. The
+     * number of blocks is always the number of patches so larger blocks do not
+     * reduce the grid size and among block sizes that achieve the same
+     * occupancy, the smallest one is returned
+     * @param user_lambda the user lambda function (same as run_query_kernel())
+     * @param oriented if the query operation op is oriented
+     * @param report if not nullptr, it is populated with the launch report of
+     * the suggested block size
+     */
+    template <Op op, typename LambdaT>
+    uint32_t suggest_query_block_size(const LambdaT& user_lambda,
+                                      const bool     oriented = false,
+                                      LaunchReport*  report   = nullptr) const
+    {
+        LaunchReport best;
+
+        auto try_block = [&](auto block_threads) {
+            constexpr uint32_t B = decltype(block_threads)::value;
+
+            LaunchBox<B> lb;
+            lb.blocks         = this->m_num_patches;
+            lb.smem_bytes_dyn = this->template calc_shared_memory<B>(
+                op, oriented, false);
+
+            LaunchReport r = get_launch_report(
+                lb, (void*)detail::query_kernel<B, op, LambdaT>);
+
+            RXMESH_TRACE(
+                "RXMeshStatic::suggest_query_block_size() {} threads/block "
+                "-> {} blocks/SM, occupancy = {}% limited by {}",
+                B,
+                r.blocks_per_sm,
+                100.0 * r.occupancy,
+                r.limiter);
+
+            if (r.occupancy > best.occupancy) {
+                best = r;
+            }
+        };
+
+        try_block(std::integral_constant<uint32_t, 128>{});
+        try_block(std::integral_constant<uint32_t, 256>{});
+        try_block(std::integral_constant<uint32_t, 512>{});
+        try_block(std::integral_constant<uint32_t, 768>{});
+        try_block(std::integral_constant<uint32_t, 1024>{});
+
+        if (best.blocks_per_sm == 0) {
+            RXMESH_ERROR(
+                "RXMeshStatic::suggest_query_block_size() could not find a "
+                "block size that fits on the device for {}",
+                op_to_string(op));
+        }
+
+        if (report != nullptr) {
+            *report = best;
+        }
+
+        return best.block_threads;
+    }
+
+    /**
+     * @brief populate the launch_box with grid size and dynamic shared memory
+     * needed for a kernel that runs a fused query section i.e., the queries in
+     * op are done one after the other between Query::begin_fused() and
+     * Query::end_fused() such that they share a single shared memory copy of
+     * the patch topology. The dynamic shared memory is the max of the queries
+     * in op plus the patch topology
+     * @param op List of query operations done inside the fused section
+     * @param launch_box input launch box to be populated
+     * @param kernel The kernel to be launched
+     * @param oriented if the query is oriented. Valid only for Op::VV and
+     * Op::VE queries
+     * @param with_vertex_valence if vertex valence is requested to be
+     * pre-computed and stored in shared memory
+     * @param user_shmem a (lambda) function that takes the number of vertices,
+     * edges, and faces and returns additional user-desired shared memory in
+     * bytes
+     */
+    template <uint32_t blockThreads>
+    void prepare_fused_launch_box(
+        const std::vector<Op>    op,
+        LaunchBox<blockThreads>& launch_box,
+        const void*              kernel,
+        const bool               oriented            = false,
+        const bool               with_vertex_valence = false,
+        std::function<size_t(uint32_t, uint32_t, uint32_t)> user_shmem =
+            [](uint32_t v, uint32_t e, uint32_t f) { return 0; }) const
+    {
+        prepare_launch_box(
+            op,
+            launch_box,
+            kernel,
+            oriented,
+            with_vertex_valence,
+            false,
+            [user_shmem](uint32_t v, uint32_t e, uint32_t f) {
+                return user_shmem(v, e, f) + calc_fused_shared_memory(e, f);
+            });
     }
 
 
@@ -975,10 +2490,70 @@ class RXMeshStatic : public RXMesh
         const std::string&      name,
         const FaceAttribute<T>& other)
     {
-        return add_face_attribute<T>(name,
-                                     other.get_num_attributes(),
-                                     other.get_allocated(),
-                                     other.get_layout());
+        auto ret = add_face_attribute<T>(name,
+                                         other.get_num_attributes(),
+                                         other.get_allocated(),
+                                         other.get_layout());
+        ret->set_num_samples(other.get_num_samples());
+        return ret;
+    }
+
+    /**
+     * @brief Adding a non-owning attribute (view) over a user buffer that
+     * stores the attributes in linear_id() order such that kernels and
+     * solvers share the same memory (see Attribute for the view constructor)
+     * @tparam HandleT the mesh element type of the attribute
+     * @param name of the attribute. Should not collide with other attributes
+     * names
+     * @param num_attributes number of attributes per mesh element
+     * @param d_ptr the device buffer (could be nullptr)
+     * @param h_ptr the host buffer (could be nullptr)
+     * @param pitch_x the stride between two consecutive mesh elements
+     * @param pitch_y the stride between two consecutive attributes
+     */
+    template <typename HandleT, typename T>
+    std::shared_ptr<Attribute<T, HandleT>> add_attribute_view(
+        const std::string& name,
+        const uint32_t     num_attributes,
+        T*                 d_ptr,
+        T*                 h_ptr,
+        const uint32_t     pitch_x,
+        const uint32_t     pitch_y)
+    {
+        return m_attr_container->template emplace<Attribute<T, HandleT>>(
+            name.c_str(), num_attributes, d_ptr, h_ptr, pitch_x, pitch_y, this);
+    }
+
+    /**
+     * @brief Adding a non-owning attribute (view) over a dense matrix whose
+     * rows are the mesh elements (in linear_id() order) and columns are the
+     * attributes. Writing to the attribute (e.g., in for_each or a query)
+     * writes into the matrix memory and vice versa. The matrix should outlive
+     * the view
+     */
+    template <typename HandleT, typename T, int Order>
+    std::shared_ptr<Attribute<T, HandleT>> add_attribute_view(
+        const std::string&     name,
+        DenseMatrix<T, Order>& mat)
+    {
+        if (size_t(mat.rows()) != get_num_elements<HandleT>()) {
+            RXMESH_ERROR(
+                "RXMeshStatic::add_attribute_view() the number of rows of the "
+                "matrix ({}) is different than the number of mesh elements "
+                "({})",
+                mat.rows(),
+                get_num_elements<HandleT>());
+            return nullptr;
+        }
+
+        const bool col_major = Order == Eigen::ColMajor;
+
+        return add_attribute_view<HandleT>(name,
+                                           mat.cols(),
+                                           mat.data(DEVICE),
+                                           mat.data(HOST),
+                                           col_major ? 1 : mat.cols(),
+                                           col_major ? mat.rows() : 1);
     }
 
     /**
@@ -1093,10 +2668,12 @@ class RXMeshStatic : public RXMesh
         const std::string&      name,
         const EdgeAttribute<T>& other)
     {
-        return add_edge_attribute<T>(name,
-                                     other.get_num_attributes(),
-                                     other.get_allocated(),
-                                     other.get_layout());
+        auto ret = add_edge_attribute<T>(name,
+                                         other.get_num_attributes(),
+                                         other.get_allocated(),
+                                         other.get_layout());
+        ret->set_num_samples(other.get_num_samples());
+        return ret;
     }
 
     /**
@@ -1156,10 +2733,12 @@ class RXMeshStatic : public RXMesh
         const std::string&        name,
         const VertexAttribute<T>& other)
     {
-        return add_vertex_attribute<T>(name,
-                                       other.get_num_attributes(),
-                                       other.get_allocated(),
-                                       other.get_layout());
+        auto ret = add_vertex_attribute<T>(name,
+                                           other.get_num_attributes(),
+                                           other.get_allocated(),
+                                           other.get_layout());
+        ret->set_num_samples(other.get_num_samples());
+        return ret;
     }
 
     /**
@@ -1302,6 +2881,59 @@ class RXMeshStatic : public RXMesh
         return ret;
     }
 
+    /**
+     * @brief Adding a new vertex attribute by reading values from a flat host
+     * buffer v_attributes where the order of vertices is the same as the
+     * order of vertices given to the constructor and the num_attributes values
+     * of each vertex are stored contiguously i.e., attribute a of vertex v is
+     * v_attributes[v * num_attributes + a]. The attributes are populated on
+     * device and host
+     * @tparam T type of the attribute
+     * @param v_attributes attributes to read (num_attributes*#vertices)
+     * @param num_attributes number of attributes per vertex
+     * @param name of the attribute. Should not collide with other attributes
+     * names
+     * @param layout as SoA or AoS
+     * @return shared pointer to the created attribute
+     */
+    template <class T>
+    std::shared_ptr<VertexAttribute<T>> add_vertex_attribute(
+        const T*           v_attributes,
+        const uint32_t     num_attributes,
+        const std::string& name,
+        layoutT            layout = SoA)
+    {
+        if (v_attributes == nullptr || num_attributes == 0) {
+            RXMESH_ERROR(
+                "RXMeshStatic::add_vertex_attribute() input attribute is "
+                "empty");
+        }
+
+        auto ret = m_attr_container->template add<VertexAttribute<T>>(
+            name.c_str(), num_attributes, LOCATION_ALL, layout, this);
+
+        // populate the attribute before returning it
+        const int num_patches = this->get_num_patches();
+#pragma omp parallel for
+        for (int p = 0; p < num_patches; ++p) {
+            for (uint16_t v = 0; v < this->m_h_num_owned_v[p]; ++v) {
+
+                const VertexHandle v_handle(static_cast<uint32_t>(p), v);
+
+                const size_t global_v = m_h_patches_ltog_v[p][v];
+
+                for (uint32_t a = 0; a < num_attributes; ++a) {
+                    (*ret)(v_handle, a) =
+                        v_attributes[global_v * num_attributes + a];
+                }
+            }
+        }
+
+        // move to device
+        ret->move(rxmesh::HOST, rxmesh::DEVICE);
+        return ret;
+    }
+
     /**
      * @brief similar to add_vertex/edge/face_attribute where the mesh element
      * type is defined via template parameter
@@ -1330,6 +2962,35 @@ class RXMeshStatic : public RXMesh
         }
     }
 
+    /**
+     * @brief Adding an ensemble attribute i.e., num_samples instances of an
+     * attribute with num_attributes attributes per mesh element over the same
+     * mesh (see Attribute::set_num_samples()). The samples are accessed with
+     * attr(handle, j, s). With the default AoS layout, all the samples of one
+     * mesh element are contiguous such that for_each_sample() and
+     * Query::dispatch_samples() read them coalesced
+     * @param name of the attribute. Should not collide with other attributes
+     * names
+     * @param num_attributes number of the attributes of one sample
+     * @param num_samples number of samples
+     * @param location where to allocate the attributes
+     * @param layout as SoA or AoS
+     * @return shared pointer to the created attribute
+     */
+    template <class T, class HandleT>
+    std::shared_ptr<Attribute<T, HandleT>> add_ensemble_attribute(
+        const std::string& name,
+        uint32_t           num_attributes,
+        uint32_t           num_samples,
+        locationT          location = LOCATION_ALL,
+        layoutT            layout   = AoS)
+    {
+        auto ret = add_attribute<T, HandleT>(
+            name, num_attributes * num_samples, location, layout);
+        ret->set_num_samples(num_samples);
+        return ret;
+    }
+
     /**
      * @brief Adding a new attribute similar to another attribute in allocation,
      * number of attributes, and layout. The type of the attribute (vertex,edge,
@@ -1348,24 +3009,15 @@ class RXMeshStatic : public RXMesh
     {
 
         if constexpr (std::is_same_v<HandleT, VertexHandle>) {
-            return add_vertex_attribute<T>(name,
-                                           other.get_num_attributes(),
-                                           other.get_allocated(),
-                                           other.get_layout());
+            return add_vertex_attribute_like<T>(name, other);
         }
 
         if constexpr (std::is_same_v<HandleT, EdgeHandle>) {
-            return add_edge_attribute<T>(name,
-                                         other.get_num_attributes(),
-                                         other.get_allocated(),
-                                         other.get_layout());
+            return add_edge_attribute_like<T>(name, other);
         }
 
         if constexpr (std::is_same_v<HandleT, FaceHandle>) {
-            return add_face_attribute<T>(name,
-                                         other.get_num_attributes(),
-                                         other.get_allocated(),
-                                         other.get_layout());
+            return add_face_attribute_like<T>(name, other);
         }
     }
 
@@ -1451,6 +3103,113 @@ class RXMeshStatic : public RXMesh
         }
     }
 
+    /**
+     * @brief compute (or update) the cached boundary and feature flags of the
+     * vertices and edges (see ElementFlag, get_vertex_flags(), and
+     * get_edge_flags()). An edge is a boundary edge if it has a single incident
+     * face and a feature edge if the dihedral angle between the normals of its
+     * two faces is greater than feature_angle (in radians where a negative
+     * angle disables the feature flags). A vertex has the union of the flags
+     * of its incident edges. Only the patches that were modified since the
+     * last update (and their neighbor patches) are re-computed where the
+     * cavity operations of RXMeshDynamic mark the patches they modify. Since
+     * the feature flags depend on coords, invalidate_element_flags() should be
+     * called after moving the vertices. The context (get_context()) should be
+     * taken after the first call to this function
+     */
+    template <typename T>
+    void update_element_flags(const VertexAttribute<T>& coords,
+                              const float               feature_angle = -1.f,
+                              cudaStream_t              stream        = NULL)
+    {
+        const uint32_t max_p = get_max_num_patches();
+
+        if (m_d_element_flags_valid == nullptr) {
+            m_vertex_flags =
+                add_vertex_attribute<uint8_t>("rx:vertex_flags", 1);
+            m_edge_flags = add_edge_attribute<uint8_t>("rx:edge_flags", 1);
+            CUDA_ERROR(tracked_malloc((void**)&m_d_element_flags_valid,
+                                      max_p * sizeof(uint8_t),
+                                      MemoryCategory::Attribute));
+            m_element_flags_angle = feature_angle;
+            invalidate_element_flags(stream);
+            this->m_rxmesh_context.m_element_flags_valid =
+                m_d_element_flags_valid;
+        }
+
+        if (feature_angle != m_element_flags_angle) {
+            m_element_flags_angle = feature_angle;
+            invalidate_element_flags(stream);
+        }
+
+        // cos() of the dihedral angle is in [-1, 1] so -2 disables the
+        // feature flags
+        const T cos_feature =
+            (feature_angle < 0) ? T(-2) : T(std::cos(feature_angle));
+
+        constexpr uint32_t blockThreads = 256;
+
+        LaunchBox<blockThreads> lb_e;
+        prepare_launch_box({Op::EVDiamond},
+                           lb_e,
+                           (void*)detail::identify_edge_flags<blockThreads, T>);
+
+        detail::identify_edge_flags<blockThreads>
+            <<<lb_e.blocks, lb_e.num_threads, lb_e.smem_bytes_dyn, stream>>>(
+                get_context(),
+                coords,
+                *m_edge_flags,
+                m_d_element_flags_valid,
+                cos_feature);
+
+        LaunchBox<blockThreads> lb_v;
+        prepare_launch_box({Op::VE},
+                           lb_v,
+                           (void*)detail::identify_vertex_flags<blockThreads>);
+
+        detail::identify_vertex_flags<blockThreads>
+            <<<lb_v.blocks, lb_v.num_threads, lb_v.smem_bytes_dyn, stream>>>(
+                get_context(),
+                *m_edge_flags,
+                *m_vertex_flags,
+                m_d_element_flags_valid);
+
+        CUDA_ERROR(cudaMemsetAsync(
+            m_d_element_flags_valid, 1, max_p * sizeof(uint8_t), stream));
+    }
+
+    /**
+     * @brief mark the cached boundary/feature flags of all patches as stale
+     * such that the next update_element_flags() re-computes all of them
+     */
+    void invalidate_element_flags(cudaStream_t stream = NULL)
+    {
+        if (m_d_element_flags_valid != nullptr) {
+            CUDA_ERROR(cudaMemsetAsync(m_d_element_flags_valid,
+                                       0,
+                                       get_max_num_patches() * sizeof(uint8_t),
+                                       stream));
+        }
+    }
+
+    /**
+     * @brief the cached vertex flags as computed (on the device) by the last
+     * update_element_flags(). Return nullptr if the flags were never computed
+     */
+    std::shared_ptr<VertexAttribute<uint8_t>> get_vertex_flags() const
+    {
+        return m_vertex_flags;
+    }
+
+    /**
+     * @brief the cached edge flags as computed (on the device) by the last
+     * update_element_flags(). Return nullptr if the flags were never computed
+     */
+    std::shared_ptr<EdgeAttribute<uint8_t>> get_edge_flags() const
+    {
+        return m_edge_flags;
+    }
+
     /**
      * @brief return a shared pointer the input vertex position
      */
@@ -1732,6 +3491,228 @@ class RXMeshStatic : public RXMesh
         file.close();
     }
 
+    /**
+     * @brief export the mesh to a binary VTK XML unstructured grid (.vtu)
+     * file which can be visualized using Paraview. Unlike export_vtk(), the
+     * vertex list, face list, and attributes are compacted on the device
+     * (indexed by linear_id()) and every array is written to the file as a
+     * single contiguous block of raw appended data. The coordinates and the
+     * attributes should be allocated on the device and the mesh should be
+     * static (or compacted via cleanup() and update_host() for a dynamic
+     * mesh). This function uses parameter pack such that the user can call it
+     * with zero, one or move vertex or face attributes with any number of
+     * attributes. Edge attributes are NOT supported and are ignored
+     * @param filename the output file (typically with .vtu extension)
+     * @param coords vertices coordinates
+     * @param attributes vertex or face attributes (not pointers)
+     */
+    template <typename T, typename... AttributesT>
+    void export_vtu(const std::string&        filename,
+                    const VertexAttribute<T>& coords,
+                    AttributesT... attributes) const
+    {
+        constexpr uint32_t blockThreads = 256;
+
+        if ((coords.get_allocated() & DEVICE) != DEVICE ||
+            ((attributes.get_allocated() & DEVICE) != DEVICE || ...)) {
+            RXMESH_ERROR(
+                "RXMeshStatic::export_vtu() the coordinates and the attributes "
+                "should be allocated on the device");
+            return;
+        }
+
+        std::ofstream file(filename, std::ios::binary);
+        if (!file.is_open()) {
+            RXMESH_ERROR("RXMeshStatic::export_vtu() can not open {}",
+                         filename);
+            return;
+        }
+
+        const uint64_t num_v = get_num_vertices();
+        const uint64_t num_f = get_num_faces();
+
+        // the XML header refers to the appended blocks by their offset. Each
+        // block is preceded by its size (UInt64)
+        uint64_t offset    = 0;
+        uint64_t max_bytes = 0;
+
+        auto data_array = [&](const char*        type,
+                              const std::string& name,
+                              const uint32_t     num_comp,
+                              const uint64_t     num_bytes) {
+            std::stringstream ss;
+            ss << "        <DataArray type=\"" << type << "\"";
+            if (!name.empty()) {
+                ss << " Name=\"" << name << "\"";
+            }
+            ss << " NumberOfComponents=\"" << num_comp
+               << "\" format=\"appended\" offset=\"" << offset << "\"/>\n";
+            offset += sizeof(uint64_t) + num_bytes;
+            max_bytes = std::max(max_bytes, num_bytes);
+            return ss.str();
+        };
+
+        const std::string points_xml =
+            data_array(vtk_type_name<T>(), "", 3, 3 * num_v * sizeof(T));
+        const std::string conn_xml = data_array(
+            "Int32", "connectivity", 1, 3 * num_f * sizeof(int32_t));
+        const std::string offsets_xml =
+            data_array("Int32", "offsets", 1, num_f * sizeof(int32_t));
+        const std::string types_xml =
+            data_array("UInt8", "types", 1, num_f * sizeof(uint8_t));
+
+        std::string point_data_xml, cell_data_xml;
+        (
+            [&] {
+                using HandleT = typename decltype(attributes)::HandleType;
+                using AttrT   = typename decltype(attributes)::Type;
+                if constexpr (std::is_same_v<HandleT, VertexHandle>) {
+                    point_data_xml +=
+                        data_array(vtk_type_name<AttrT>(),
+                                   attributes.get_name(),
+                                   attributes.get_num_attributes(),
+                                   num_v * attributes.get_num_attributes() *
+                                       sizeof(AttrT));
+                } else if constexpr (std::is_same_v<HandleT, FaceHandle>) {
+                    cell_data_xml +=
+                        data_array(vtk_type_name<AttrT>(),
+                                   attributes.get_name(),
+                                   attributes.get_num_attributes(),
+                                   num_f * attributes.get_num_attributes() *
+                                       sizeof(AttrT));
+                } else {
+                    RXMESH_WARN(
+                        "RXMeshStatic::export_vtu() ignoring edge attribute {}",
+                        attributes.get_name());
+                }
+            }(),
+            ...);
+
+        file << "<?xml version=\"1.0\"?>\n";
+        file << "<VTKFile type=\"UnstructuredGrid\" version=\"1.0\" "
+                "byte_order=\"LittleEndian\" header_type=\"UInt64\">\n";
+        file << "  <UnstructuredGrid>\n";
+        file << "    <Piece NumberOfPoints=\"" << num_v
+             << "\" NumberOfCells=\"" << num_f << "\">\n";
+        file << "      <PointData>\n"
+             << point_data_xml << "      </PointData>\n";
+        file << "      <CellData>\n"
+             << cell_data_xml << "      </CellData>\n";
+        file << "      <Points>\n" << points_xml << "      </Points>\n";
+        file << "      <Cells>\n"
+             << conn_xml << offsets_xml << types_xml << "      </Cells>\n";
+        file << "    </Piece>\n";
+        file << "  </UnstructuredGrid>\n";
+        file << "  <AppendedData encoding=\"raw\">\n   _";
+
+        // every block is compacted into d_buffer and staged through h_buffer
+        MemoryPool& pool     = this->get_memory_pool();
+        char*       d_buffer = nullptr;
+        char*       h_buffer = nullptr;
+        CUDA_ERROR(pool.allocate(
+            (void**)&d_buffer, max_bytes, NULL, MemoryCategory::Other));
+        CUDA_ERROR(cudaMallocHost((void**)&h_buffer, max_bytes));
+
+        auto write_block = [&](const uint64_t num_bytes) {
+            CUDA_ERROR(cudaMemcpy(
+                h_buffer, d_buffer, num_bytes, cudaMemcpyDeviceToHost));
+            file.write(reinterpret_cast<const char*>(&num_bytes),
+                       sizeof(uint64_t));
+            file.write(h_buffer, num_bytes);
+        };
+
+        const Context context = get_context();
+
+        // points
+        attribute_to_linear(coords, reinterpret_cast<T*>(d_buffer));
+        write_block(3 * num_v * sizeof(T));
+
+        // connectivity
+        int32_t* d_conn = reinterpret_cast<int32_t*>(d_buffer);
+        run_query_kernel<Op::FV, blockThreads>(
+            [=] __device__(const FaceHandle fh, const VertexIterator& fv) {
+                const uint32_t f = context.linear_id(fh);
+                for (uint32_t i = 0; i < 3; ++i) {
+                    d_conn[3 * f + i] = int32_t(context.linear_id(fv[i]));
+                }
+            });
+        write_block(3 * num_f * sizeof(int32_t));
+
+        // offsets and cell types (all triangles)
+        {
+            std::vector<int32_t> cell_offsets(num_f);
+            for (uint64_t f = 0; f < num_f; ++f) {
+                cell_offsets[f] = int32_t(3 * (f + 1));
+            }
+            const uint64_t num_bytes = num_f * sizeof(int32_t);
+            file.write(reinterpret_cast<const char*>(&num_bytes),
+                       sizeof(uint64_t));
+            file.write(reinterpret_cast<const char*>(cell_offsets.data()),
+                       num_bytes);
+
+            // VTK_TRIANGLE
+            const std::vector<uint8_t> cell_types(num_f, 5);
+            const uint64_t             num_types = num_f * sizeof(uint8_t);
+            file.write(reinterpret_cast<const char*>(&num_types),
+                       sizeof(uint64_t));
+            file.write(reinterpret_cast<const char*>(cell_types.data()),
+                       num_types);
+        }
+
+        // attributes
+        (
+            [&] {
+                using HandleT = typename decltype(attributes)::HandleType;
+                using AttrT   = typename decltype(attributes)::Type;
+                if constexpr (!std::is_same_v<HandleT, EdgeHandle>) {
+                    attribute_to_linear(attributes,
+                                        reinterpret_cast<AttrT*>(d_buffer));
+                    const uint64_t n = std::is_same_v<HandleT, VertexHandle> ?
+                                           num_v :
+                                           num_f;
+                    write_block(n * attributes.get_num_attributes() *
+                                sizeof(AttrT));
+                }
+            }(),
+            ...);
+
+        file << "\n  </AppendedData>\n";
+        file << "</VTKFile>\n";
+
+        pool.deallocate(d_buffer);
+        CUDA_ERROR(cudaFreeHost(h_buffer));
+    }
+
+    /**
+     * @brief copy an attribute into a contiguous device array indexed by
+     * linear_id() such that the attributes of the element with linear id i
+     * are stored at [i * get_num_attributes(), (i+1) * get_num_attributes())
+     * @param attr the input attribute (allocated on the device)
+     * @param d_out the output device array with enough space for all owned
+     * elements
+     * @param stream the stream to launch the kernel on
+     */
+    template <typename AttributeT>
+    void attribute_to_linear(const AttributeT&          attr,
+                             typename AttributeT::Type* d_out,
+                             cudaStream_t               stream = NULL) const
+    {
+        using HandleT = typename AttributeT::HandleType;
+
+        const Context  context  = get_context();
+        const uint32_t num_attr = attr.get_num_attributes();
+
+        for_each<HandleT>(
+            DEVICE,
+            [=] __device__(const HandleT h) {
+                const uint32_t id = context.linear_id(h);
+                for (uint32_t i = 0; i < num_attr; ++i) {
+                    d_out[num_attr * id + i] = attr(h, i);
+                }
+            },
+            stream);
+    }
+
     /**
      * @brief convert given vertex attributes representing the coordinates into
      * std vector
@@ -1788,6 +3769,76 @@ class RXMeshStatic : public RXMesh
     }
 
    protected:
+    /**
+     * @brief Constructor that does not build the mesh. Used by derived classes
+     * that need to prepare the input before calling init() themselves
+     */
+    RXMeshStatic(const uint32_t patch_size, const bool use_metis)
+        : RXMesh(patch_size, use_metis), m_input_vertex_coordinates(nullptr)
+    {
+        this->_use_metis = use_metis;
+    }
+
+    /**
+     * @brief copy the query caches to the device and make them visible to
+     * the kernels through the context
+     */
+    void upload_query_cache()
+    {
+        if (m_d_query_cache == nullptr) {
+            CUDA_ERROR(tracked_malloc((void**)&m_d_query_cache,
+                                      QueryCache::num_ops * sizeof(QueryCache),
+                                      MemoryCategory::Topology));
+        }
+        CUDA_ERROR(cudaMemcpy(m_d_query_cache,
+                              m_h_query_cache.data(),
+                              QueryCache::num_ops * sizeof(QueryCache),
+                              cudaMemcpyHostToDevice));
+        this->m_rxmesh_context.m_query_cache = m_d_query_cache;
+    }
+
+    static void release_query_cache(QueryCache& cache)
+    {
+        GPU_FREE(cache.m_offset_start);
+        GPU_FREE(cache.m_value_start);
+        GPU_FREE(cache.m_offset);
+        GPU_FREE(cache.m_value);
+        GPU_FREE(cache.m_valid);
+        cache = QueryCache();
+    }
+
+    /**
+     * @brief the VTK XML name of the type T used by export_vtu()
+     */
+    template <typename T>
+    static constexpr const char* vtk_type_name()
+    {
+        if constexpr (std::is_same_v<T, float>) {
+            return "Float32";
+        } else if constexpr (std::is_same_v<T, double>) {
+            return "Float64";
+        } else if constexpr (std::is_same_v<T, int8_t>) {
+            return "Int8";
+        } else if constexpr (std::is_same_v<T, uint8_t>) {
+            return "UInt8";
+        } else if constexpr (std::is_same_v<T, int16_t>) {
+            return "Int16";
+        } else if constexpr (std::is_same_v<T, uint16_t>) {
+            return "UInt16";
+        } else if constexpr (std::is_same_v<T, int32_t>) {
+            return "Int32";
+        } else if constexpr (std::is_same_v<T, uint32_t>) {
+            return "UInt32";
+        } else if constexpr (std::is_same_v<T, int64_t>) {
+            return "Int64";
+        } else {
+            static_assert(std::is_same_v<T, uint64_t>,
+                          "RXMeshStatic::export_vtu() unsupported attribute "
+                          "type");
+            return "UInt64";
+        }
+    }
+
     template <typename AttributeT>
     void export_vtk(std::fstream&     file,
                     bool&             first_v_attr,
@@ -1866,6 +3917,98 @@ class RXMeshStatic : public RXMesh
         }
     }
 
+    /**
+     * @brief the shared memory needed to store the patch topology (EV and FE)
+     * in a fused query section on top of the shared memory of the individual
+     * queries
+     */
+    static size_t calc_fused_shared_memory(const uint32_t max_e,
+                                           const uint32_t max_f)
+    {
+        return (2 * max_e + 3 * max_f) * sizeof(uint16_t) +
+               2 * ShmemAllocator::default_alignment;
+    }
+
+    /**
+     * @brief the shared memory needed by a single tile to run the query op
+     * using query_tile_dispatcher(). The temporary buffers of the transpose
+     * are released before the LP hashtable is loaded so they share the same
+     * space
+     */
+    size_t calc_tile_shared_memory(const Op op) const
+    {
+        const size_t max_v(this->m_max_vertices_per_patch),
+            max_e(this->m_max_edges_per_patch),
+            max_f(this->m_max_faces_per_patch);
+
+        size_t mask_smem = 0, table_smem = 0;
+        if (op == Op::VV || op == Op::EV || op == Op::FV) {
+            mask_smem = max_bitmask_size<LocalVertexT>();
+            table_smem =
+                sizeof(LPPair) * max_lp_hashtable_capacity<LocalVertexT>();
+        } else if (op == Op::VE || op == Op::FE) {
+            mask_smem = max_bitmask_size<LocalEdgeT>();
+            table_smem =
+                sizeof(LPPair) * max_lp_hashtable_capacity<LocalEdgeT>();
+        } else if (op == Op::VF || op == Op::EF || op == Op::FF) {
+            mask_smem = max_bitmask_size<LocalFaceT>();
+            table_smem =
+                sizeof(LPPair) * max_lp_hashtable_capacity<LocalFaceT>();
+        } else {
+            RXMESH_ERROR(
+                "RXMeshStatic::calc_tile_shared_memory() unsupported query "
+                "operation {} for tile-level queries",
+                op_to_string(op));
+            exit(EXIT_FAILURE);
+        }
+
+        size_t topo_smem = 0, temp_smem = 0;
+        switch (op) {
+            case Op::VV:
+            case Op::VE:
+                topo_smem = std::max(max_v + 1, 2 * max_e) + 2 * max_e;
+                temp_smem = 2 * max_v + 1;
+                break;
+            case Op::VF:
+                topo_smem = std::max(3 * max_f, max_v + 1) +
+                            std::max(2 * max_e, 3 * max_f);
+                temp_smem = 2 * max_v + 1;
+                break;
+            case Op::EV:
+                topo_smem = 2 * max_e;
+                break;
+            case Op::FE:
+                topo_smem = 3 * max_f;
+                break;
+            case Op::FV:
+                // EV is released before the LP hashtable is loaded
+                topo_smem = 3 * max_f;
+                temp_smem = 2 * max_e;
+                break;
+            case Op::EF:
+                topo_smem = std::max(max_e + 1, 3 * max_f) + 3 * max_f;
+                temp_smem = 2 * max_e + 1;
+                break;
+            case Op::FF:
+                // FF offset and value are allocated after the transpose
+                // temporary buffers are released and are kept along with the
+                // LP hashtable
+                topo_smem = std::max(max_e + 1, 3 * max_f) + 3 * max_f;
+                temp_smem = 2 * max_e + 1;
+                table_smem += (max_f + 1 + 3 * max_f) * sizeof(uint16_t) +
+                              ShmemAllocator::default_alignment * 2;
+                break;
+            default:
+                break;
+        }
+
+        // for possible padding for alignment of every call to
+        // ShmemAllocator.alloc
+        return mask_smem + topo_smem * sizeof(uint16_t) +
+               std::max(temp_smem * sizeof(uint16_t), table_smem) +
+               ShmemAllocator::default_alignment * 6;
+    }
+
     template <uint32_t blockThreads>
     size_t calc_shared_memory(const Op   op,
                               const bool oriented,
@@ -1989,7 +4132,8 @@ class RXMeshStatic : public RXMesh
 
             // temp memory needed for block_mat_transpose to store the prefix
             // and local incremental
-            uint32_t temp_size_local = (2 * max_v + 1) * sizeof(uint16_t);
+            uint32_t temp_size_local =
+                detail::transpose_shmem_plan(max_v).bytes();
 
             // For oriented VE, we additionally need to store FE and EF
             // along with the (transposed) VE. FE needs 3*max_num_faces. Since
@@ -2024,7 +4168,8 @@ class RXMeshStatic : public RXMesh
 
             // temp memory needed for block_mat_transpose to store the prefix
             // and local incremental
-            uint32_t temp_size_local = (2 * max_e + 1) * sizeof(uint16_t);
+            uint32_t temp_size_local =
+                detail::transpose_shmem_plan(max_e).bytes();
 
             // stores the face LP hashtable
             uint32_t lp_smem =
@@ -2053,7 +4198,8 @@ class RXMeshStatic : public RXMesh
 
             // temp memory needed for block_mat_transpose to store the prefix
             // and local incremental
-            uint32_t temp_size_local = (2 * max_v + 1) * sizeof(uint16_t);
+            uint32_t temp_size_local =
+                detail::transpose_shmem_plan(max_v).bytes();
 
             // stores the face LP hashtable
             uint32_t lp_shmem =
@@ -2085,7 +4231,8 @@ class RXMeshStatic : public RXMesh
 
             // temp memory needed for block_mat_transpose to store the prefix
             // and local incremental
-            uint32_t temp_size_local = (2 * max_v + 1) * sizeof(uint16_t);
+            uint32_t temp_size_local =
+                detail::transpose_shmem_plan(max_v).bytes();
 
             // stores the vertex LP hashtable
             uint32_t lp_smem =
@@ -2128,7 +4275,8 @@ class RXMeshStatic : public RXMesh
 
             // temp memory needed for block_mat_transpose to store the prefix
             // and local incremental
-            uint32_t temp_size_local = (2 * max_e + 1) * sizeof(uint16_t);
+            uint32_t temp_size_local =
+                detail::transpose_shmem_plan(max_e).bytes();
 
             // the output FF
             dynamic_smem += 4 * max_f * sizeof(uint16_t);
@@ -2213,6 +4361,69 @@ class RXMeshStatic : public RXMesh
         return dynamic_smem;
     }
 
+    /**
+     * @brief the part of a LaunchBox that is cached by
+     * prepare_launch_box() i.e., everything but the number of blocks
+     */
+    struct LaunchConfig
+    {
+        size_t   smem_bytes_dyn, smem_bytes_static, local_mem_per_thread;
+        uint32_t num_registers_per_thread;
+    };
+
+    std::vector<uint64_t> launch_cache_key(const std::vector<Op>&    op,
+                                           const void*               kernel,
+                                           const uint32_t            threads,
+                                           const std::array<bool, 4> flags,
+                                           const size_t user_smem) const
+    {
+        std::vector<uint64_t> key;
+        key.reserve(8 + op.size());
+        key.push_back(reinterpret_cast<uint64_t>(kernel));
+        key.push_back(threads);
+        key.push_back(uint64_t(flags[0]) | uint64_t(flags[1]) << 1 |
+                      uint64_t(flags[2]) << 2 | uint64_t(flags[3]) << 3);
+        key.push_back(user_smem);
+        key.push_back(m_max_vertices_per_patch);
+        key.push_back(m_max_edges_per_patch);
+        key.push_back(m_max_faces_per_patch);
+        for (auto o : op) {
+            key.push_back(static_cast<uint64_t>(o));
+        }
+        return key;
+    }
+
+    template <uint32_t blockThreads>
+    bool find_launch_config(const std::vector<uint64_t>& key,
+                            LaunchBox<blockThreads>&     launch_box) const
+    {
+        std::lock_guard<std::mutex> lock(m_launch_cache_mutex);
+
+        auto it = m_launch_cache.find(key);
+        if (it == m_launch_cache.end()) {
+            return false;
+        }
+        const LaunchConfig& config = it->second;
+
+        launch_box.smem_bytes_dyn           = config.smem_bytes_dyn;
+        launch_box.smem_bytes_static        = config.smem_bytes_static;
+        launch_box.local_mem_per_thread     = config.local_mem_per_thread;
+        launch_box.num_registers_per_thread = config.num_registers_per_thread;
+        return true;
+    }
+
+    template <uint32_t blockThreads>
+    void add_launch_config(std::vector<uint64_t>          key,
+                           const LaunchBox<blockThreads>& launch_box) const
+    {
+        std::lock_guard<std::mutex> lock(m_launch_cache_mutex);
+
+        m_launch_cache[std::move(key)] = {launch_box.smem_bytes_dyn,
+                                          launch_box.smem_bytes_static,
+                                          launch_box.local_mem_per_thread,
+                                          launch_box.num_registers_per_thread};
+    }
+
     void check_shared_memory(const uint32_t smem_bytes_dyn,
                              size_t&        smem_bytes_static,
                              uint32_t&      num_reg_per_thread,
@@ -2401,7 +4612,307 @@ class RXMeshStatic : public RXMesh
     EdgeMapT                m_polyscope_edges_map;
 #endif
 
+    /**
+     * @brief initialize polyscope and register the mesh with it (if polyscope
+     * is active) after the input vertex coordinates are added
+     */
+    void init_polyscope(const std::string& mesh_name)
+    {
+#if USE_POLYSCOPE
+        // polyscope::options::autocenterStructures = true;
+        // polyscope::options::autoscaleStructures  = true;
+        // polyscope::options::automaticallyComputeSceneExtents = true;
+        polyscope::init();
+        m_polyscope_mesh_name = mesh_name.empty() ? "RXMesh" : mesh_name;
+        m_polyscope_mesh_name += std::to_string(rand());
+        this->register_polyscope();
+        render_vertex_patch();
+        render_edge_patch();
+        render_face_patch();
+#endif
+    }
+
+    /**
+     * @brief call launch() and, if profiling is enabled, time it under
+     * TypeT (the kernel or lambda type) and the API/query operations
+     */
+    template <typename TypeT, typename LaunchT>
+    void profiled_launch(const char*            api,
+                         const std::vector<Op>& ops,
+                         uint32_t               blocks,
+                         uint32_t               threads,
+                         size_t                 smem_bytes_dyn,
+                         const void*            kernel,
+                         cudaStream_t           stream,
+                         LaunchT                launch) const
+    {
+        if (!m_profiler) {
+            launch();
+            return;
+        }
+
+        std::string ops_str;
+        size_t      bytes = 0;
+        for (const Op o : ops) {
+            if (!ops_str.empty()) {
+                ops_str += "+";
+            }
+            ops_str += op_to_string(o);
+            bytes += query_topology_bytes(o);
+        }
+
+        const double num_elements = double(profiled_num_elements(api, ops));
+        bytes += size_t(m_profile_cost.bytes_per_element * num_elements);
+        const double flops = m_profile_cost.flops_per_element * num_elements;
+
+        m_profiler->launch(api,
+                           typeid(TypeT),
+                           m_profile_label,
+                           ops_str,
+                           blocks,
+                           threads,
+                           smem_bytes_dyn,
+                           kernel,
+                           bytes,
+                           flops,
+                           stream,
+                           launch);
+    }
+
+    /**
+     * @brief the host prefix sum of the owned elements of type HandleT in
+     * patches
+     */
+    template <typename HandleT>
+    const uint32_t* get_h_prefix() const
+    {
+        if constexpr (std::is_same_v<HandleT, VertexHandle>) {
+            return this->m_h_vertex_prefix;
+        }
+        if constexpr (std::is_same_v<HandleT, EdgeHandle>) {
+            return this->m_h_edge_prefix;
+        }
+        if constexpr (std::is_same_v<HandleT, FaceHandle>) {
+            return this->m_h_face_prefix;
+        }
+    }
+
+    /**
+     * @brief the handles of the owned and active elements of type HandleT
+     * ordered by linear_id() (see for_each_dense()). Built on the first
+     * call using the device topology
+     */
+    template <typename HandleT>
+    const HandleT* get_dense_index() const
+    {
+        HandleT** handles;
+        if constexpr (std::is_same_v<HandleT, VertexHandle>) {
+            handles = &m_d_dense_v;
+        }
+        if constexpr (std::is_same_v<HandleT, EdgeHandle>) {
+            handles = &m_d_dense_e;
+        }
+        if constexpr (std::is_same_v<HandleT, FaceHandle>) {
+            handles = &m_d_dense_f;
+        }
+
+        if (*handles == nullptr) {
+            const uint32_t num = get_num_elements<HandleT>();
+            CUDA_ERROR(tracked_malloc((void**)handles,
+                                      std::max(num, 1u) * sizeof(HandleT),
+                                      MemoryCategory::Topology));
+            detail::build_dense_index<HandleT>
+                <<<get_num_patches(), 256>>>(this->m_rxmesh_context,
+                                             *handles);
+            CUDA_ERROR(cudaGetLastError());
+        }
+        return *handles;
+    }
+
+    /**
+     * @brief the for_each_dense() API name used by the profiler
+     */
+    template <typename HandleT>
+    static const char* for_each_dense_api()
+    {
+        if constexpr (std::is_same_v<HandleT, VertexHandle>) {
+            return "for_each_dense_vertex";
+        }
+        if constexpr (std::is_same_v<HandleT, EdgeHandle>) {
+            return "for_each_dense_edge";
+        }
+        if constexpr (std::is_same_v<HandleT, FaceHandle>) {
+            return "for_each_dense_face";
+        }
+    }
+
+    /**
+     * @brief the number of elements a launch processes (used with the
+     * KernelCost), i.e., the mesh elements for for_each_* and the source
+     * elements of the first query operation otherwise
+     */
+    uint32_t profiled_num_elements(const char*            api,
+                                   const std::vector<Op>& ops) const
+    {
+        const std::string a(api);
+        if (a == "for_each_vertex" || a == "for_each_dense_vertex") {
+            return get_num_vertices();
+        }
+        if (a == "for_each_edge" || a == "for_each_dense_edge") {
+            return get_num_edges();
+        }
+        if (a == "for_each_face" || a == "for_each_dense_face") {
+            return get_num_faces();
+        }
+        if (ops.empty()) {
+            return 0;
+        }
+        switch (ops[0]) {
+            case Op::V:
+            case Op::VV:
+            case Op::VE:
+            case Op::VF:
+                return get_num_vertices();
+            case Op::F:
+            case Op::FV:
+            case Op::FE:
+            case Op::FF:
+                return get_num_faces();
+            default:
+                return get_num_edges();
+        }
+    }
+
+    /**
+     * @brief estimate of the topology bytes read by a query operation over
+     * all patches, i.e., the edges' vertices (EV) and/or the faces' edges (FE)
+     */
+    size_t query_topology_bytes(const Op op) const
+    {
+        const size_t ev = 2 * sizeof(uint16_t) * size_t(get_num_edges());
+        const size_t fe = 3 * sizeof(uint16_t) * size_t(get_num_faces());
+        switch (op) {
+            case Op::V:
+            case Op::E:
+            case Op::F:
+                return 0;
+            case Op::VV:
+            case Op::VE:
+            case Op::EV:
+                return ev;
+            case Op::FE:
+            case Op::EF:
+            case Op::FF:
+                return fe;
+            default:
+                return ev + fe;
+        }
+    }
+
+    /**
+     * @brief call launch(begin, count, stream) to process all patches (in the
+     * patch range) either at once or in windows of m_patch_window patches.
+     * The first window is prefetched on the compute stream. Then, while window
+     * w is processed, window w+1 is prefetched on m_prefetch_stream and
+     * prefetching window w+2 waits for window w to finish so only two windows
+     * are on the device
+     */
+    /**
+     * @brief launch for_each over the patch subset (see set_patch_subset())
+     */
+    template <typename HandleT, typename LambdaT>
+    void launch_patch_subset(LambdaT apply, cudaStream_t stream) const
+    {
+        const uint32_t blocks = get_patch_subset_size();
+        if (blocks == 0) {
+            return;
+        }
+        detail::for_each_patch_subset<HandleT>
+            <<<blocks, 256, 0, stream>>>(get_context(), apply);
+    }
+
+    template <typename LaunchT>
+    void launch_windowed(cudaStream_t stream, LaunchT launch) const
+    {
+        const uint32_t range_begin = get_patch_range_begin();
+        const uint32_t range_end   = get_patch_range_end();
+        const uint32_t window      = m_patch_window;
+
+        if (range_begin >= range_end) {
+            return;
+        }
+
+        if (window == 0 || window >= range_end - range_begin) {
+            launch(range_begin, range_end - range_begin, stream);
+            return;
+        }
+
+        prefetch_patches(range_begin, range_begin + window, stream);
+
+        for (uint32_t begin = range_begin; begin < range_end; begin += window) {
+            const uint32_t end      = std::min(begin + window, range_end);
+            const bool     has_next = end < range_end;
+
+            if (has_next) {
+                prefetch_patches(end,
+                                 std::min(end + window, range_end),
+                                 m_prefetch_stream);
+                CUDA_ERROR(cudaEventRecord(m_prefetch_done, m_prefetch_stream));
+            }
+
+            launch(begin, end - begin, stream);
+
+            if (has_next) {
+                CUDA_ERROR(cudaEventRecord(m_compute_done, stream));
+                CUDA_ERROR(cudaStreamWaitEvent(stream, m_prefetch_done, 0));
+                CUDA_ERROR(
+                    cudaStreamWaitEvent(m_prefetch_stream, m_compute_done, 0));
+            }
+        }
+    }
+
     std::shared_ptr<AttributeContainer>     m_attr_container;
     std::shared_ptr<VertexAttribute<float>> m_input_vertex_coordinates;
+
+    uint32_t     m_patch_window    = 0;
+    cudaStream_t m_prefetch_stream = nullptr;
+    cudaEvent_t  m_prefetch_done   = nullptr;
+    cudaEvent_t  m_compute_done    = nullptr;
+
+    std::array<QueryCache, QueryCache::num_ops> m_h_query_cache;
+    QueryCache*                                 m_d_query_cache = nullptr;
+
+    // 8-bit copy of the topology of all patches (see
+    // enable_compressed_topology())
+    uint8_t* m_d_compressed_topology = nullptr;
+    // direct map from the not-owned elements to their owner (see
+    // enable_owner_table())
+    uint64_t* m_d_owner_table = nullptr;
+    // cached launch configurations (see prepare_launch_box())
+    mutable std::map<std::vector<uint64_t>, LaunchConfig> m_launch_cache;
+    mutable std::mutex                                    m_launch_cache_mutex;
+    // objects attached to the mesh (see set_user_cache())
+    std::map<std::string, std::shared_ptr<void>> m_user_cache;
+    mutable std::mutex                           m_user_cache_mutex;
+    // times the launches (see enable_profiling())
+    std::unique_ptr<KernelProfiler> m_profiler;
+    std::string                     m_profile_label;
+    KernelCost                      m_profile_cost;
+    // the handles of the owned elements in linear_id() order (see
+    // for_each_dense())
+    mutable VertexHandle* m_d_dense_v = nullptr;
+    mutable EdgeHandle*   m_d_dense_e = nullptr;
+    mutable FaceHandle*   m_d_dense_f = nullptr;
+    // the vertex pair to edge map (see get_edge_map())
+    mutable DeviceEdgeMap m_edge_map;
+    // the patch subset and its per-patch flags (see set_patch_subset())
+    uint32_t* m_d_patch_subset       = nullptr;
+    uint8_t*  m_d_patch_subset_flags = nullptr;
+    // the cached boundary/feature flags and their per-patch valid flag (see
+    // update_element_flags())
+    std::shared_ptr<VertexAttribute<uint8_t>> m_vertex_flags;
+    std::shared_ptr<EdgeAttribute<uint8_t>>   m_edge_flags;
+    uint8_t*                                  m_d_element_flags_valid = nullptr;
+    float                                     m_element_flags_angle   = -1.f;
 };
 }  // namespace rxmesh
\ No newline at end of file
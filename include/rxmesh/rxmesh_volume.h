@@ -0,0 +1,721 @@
+#pragma once
+
+#include <stdint.h>
+#include <algorithm>
+#include <array>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "rxmesh/handle.h"
+#include "rxmesh/patch_csr.h"
+#include "rxmesh/types.h"
+#include "rxmesh/util/MshLoader.h"
+#include "rxmesh/util/log.h"
+#include "rxmesh/util/macros.h"
+
+namespace rxmesh {
+
+/**
+ * @brief query operations on volume (tetrahedral) meshes (see
+ * RXMeshVolume::run_query_kernel())
+ */
+enum class VolumeOp : uint32_t
+{
+    // the four vertices of a cell
+    CV = 0,
+    // the vertices that share a cell with a vertex
+    VV = 1,
+    // the cells incident to a vertex
+    VC = 2,
+    // the (up to) four cells that share a face with a cell. The neighbor
+    // across the face opposite to the i-th vertex of the cell (in CV order)
+    // is the i-th one and is invalid if the face is on the boundary
+    CC = 3,
+};
+
+constexpr uint32_t num_volume_ops = 4;
+
+inline std::string volume_op_to_string(const VolumeOp op)
+{
+    switch (op) {
+        case VolumeOp::CV:
+            return "CV";
+        case VolumeOp::VV:
+            return "VV";
+        case VolumeOp::VC:
+            return "VC";
+        case VolumeOp::CC:
+            return "CC";
+        default:
+            return "";
+    }
+}
+
+/**
+ * @brief the handle types of the source (InputHandle) and the output
+ * (OutputHandle) of a volume query operation
+ */
+template <VolumeOp op>
+struct VolumeOpHandles
+{
+    using InputHandle = std::conditional_t<op == VolumeOp::CV ||
+                                               op == VolumeOp::CC,
+                                           CellHandle,
+                                           VertexHandle>;
+    using OutputHandle = std::conditional_t<op == VolumeOp::CV ||
+                                                op == VolumeOp::VV,
+                                            VertexHandle,
+                                            CellHandle>;
+};
+
+/**
+ * @brief the device side of RXMeshVolume. Every patch stores, for each
+ * VolumeOp, the output of the query of its owned vertices/cells as patch-local
+ * indices into the table of the local vertices/cells of the patch (i.e., the
+ * owned ones followed by the ones owned by other patches) which maps the local
+ * index to the handle in the owner patch
+ */
+struct VolumeContext
+{
+    uint32_t m_num_patches = 0;
+
+    detail::PatchCSRElements m_vertex;
+    detail::PatchCSRElements m_cell;
+
+    detail::PatchCSRQuery m_query[num_volume_ops];
+
+    template <typename HandleT>
+    __device__ __host__ __inline__ const detail::PatchCSRElements& elements()
+        const
+    {
+        if constexpr (std::is_same_v<HandleT, VertexHandle>) {
+            return m_vertex;
+        } else {
+            return m_cell;
+        }
+    }
+};
+
+template <typename HandleT>
+using VolumeIterator = PatchCSRIterator<HandleT>;
+
+template <typename T, typename HandleT>
+using VolumeAttribute = PatchCSRAttribute<T, HandleT>;
+
+template <typename T>
+using VolumeVertexAttribute = VolumeAttribute<T, VertexHandle>;
+
+template <typename T>
+using VolumeCellAttribute = VolumeAttribute<T, CellHandle>;
+
+/**
+ * @brief tetrahedral mesh with the same patch-based layout as RXMeshStatic.
+ * The cells are partitioned into patches of (up to) patch_size face-connected
+ * cells by growing regions over the cell-cell adjacency. A vertex is owned by
+ * the patch with the smallest id among its incident cells. On top of its
+ * owned cells, a patch stores the cells owned by other patches that are
+ * incident to its owned vertices or share a face with its owned cells (i.e.,
+ * the ribbon) such that the output of VV, VC, CV, and CC of all the owned
+ * elements of a patch only refers to the patch's local vertices/cells. The
+ * query output is stored per patch as patch-local indices (16-bit) and is
+ * loaded into shared memory by run_query_kernel(). Only vertices and cells are
+ * stored; faces and edges are implicit in the cells. The mesh is static
+ */
+class RXMeshVolume
+{
+   public:
+    RXMeshVolume(const RXMeshVolume&) = delete;
+
+    /**
+     * @brief Constructor using path to a .msh file. Only the tetrahedra in
+     * the file are used
+     * @param file_path path to the .msh file
+     * @param patch_size the (max) number of cells in a patch
+     */
+    explicit RXMeshVolume(const std::string file_path,
+                          const uint32_t    patch_size = 256)
+    {
+        MshLoader msh(file_path);
+
+        const auto& nodes = msh.get_nodes();
+
+        std::vector<std::vector<float>> verts(nodes.size() / 3);
+        for (size_t v = 0; v < verts.size(); ++v) {
+            verts[v] = {nodes[3 * v], nodes[3 * v + 1], nodes[3 * v + 2]};
+        }
+
+        const auto& elements = msh.get_elements();
+        const auto& types    = msh.get_elements_types();
+        const auto& lengths  = msh.get_elements_lengths();
+
+        std::vector<std::vector<uint32_t>> cells;
+        size_t                             offset = 0;
+        for (size_t e = 0; e < types.size(); ++e) {
+            if (types[e] == MshLoader::ELEMENT_TET && lengths[e] == 4) {
+                cells.push_back({uint32_t(elements[offset]),
+                                 uint32_t(elements[offset + 1]),
+                                 uint32_t(elements[offset + 2]),
+                                 uint32_t(elements[offset + 3])});
+            }
+            offset += lengths[e];
+        }
+
+        build(verts, cells, patch_size);
+    }
+
+    /**
+     * @brief Constructor using the vertex positions and the tetrahedra (four
+     * vertex indices each)
+     */
+    explicit RXMeshVolume(const std::vector<std::vector<float>>&    verts,
+                          const std::vector<std::vector<uint32_t>>& cells,
+                          const uint32_t patch_size = 256)
+    {
+        build(verts, cells, patch_size);
+    }
+
+    virtual ~RXMeshVolume()
+    {
+        m_input_vertex_coordinates.reset();
+
+        detail::release(m_context.m_vertex);
+        detail::release(m_context.m_cell);
+        for (uint32_t o = 0; o < num_volume_ops; ++o) {
+            detail::release(m_context.m_query[o]);
+        }
+    }
+
+    uint32_t get_num_vertices() const
+    {
+        return m_h_vertex.size();
+    }
+
+    uint32_t get_num_cells() const
+    {
+        return m_h_cell.size();
+    }
+
+    uint32_t get_num_patches() const
+    {
+        return m_num_patches;
+    }
+
+    template <typename HandleT>
+    uint32_t get_num_elements() const
+    {
+        return host_elements<HandleT>().size();
+    }
+
+    const VolumeContext& get_context() const
+    {
+        return m_context;
+    }
+
+    /**
+     * @brief the number of local (i.e., owned and not-owned) vertices/cells
+     * of patch p
+     */
+    template <typename HandleT>
+    uint32_t get_num_local(const uint32_t p) const
+    {
+        return host_elements<HandleT>().num_local(p);
+    }
+
+    /**
+     * @brief the handle of the vertex/cell with index id in the input
+     */
+    VertexHandle get_vertex_handle(const uint32_t id) const
+    {
+        return m_h_vertex.input_handle[id];
+    }
+
+    CellHandle get_cell_handle(const uint32_t id) const
+    {
+        return m_h_cell.input_handle[id];
+    }
+
+    /**
+     * @brief the index of the vertex/cell in the input
+     */
+    template <typename HandleT>
+    uint32_t get_input_id(const HandleT& h) const
+    {
+        return host_elements<HandleT>().input_id[linear_id(h)];
+    }
+
+    /**
+     * @brief the index of the vertex/cell in the linear order of the owned
+     * elements (i.e., the index used by VolumeAttribute)
+     */
+    template <typename HandleT>
+    uint32_t linear_id(const HandleT& h) const
+    {
+        return host_elements<HandleT>().linear_id(h);
+    }
+
+    /**
+     * @brief add a vertex/cell attribute with num_attributes values per
+     * element allocated on both the host and the device
+     */
+    template <typename T>
+    std::shared_ptr<VolumeVertexAttribute<T>> add_vertex_attribute(
+        const uint32_t num_attributes = 1)
+    {
+        return add_attribute<T, VertexHandle>(num_attributes);
+    }
+
+    template <typename T>
+    std::shared_ptr<VolumeCellAttribute<T>> add_cell_attribute(
+        const uint32_t num_attributes = 1)
+    {
+        return add_attribute<T, CellHandle>(num_attributes);
+    }
+
+    template <typename T, typename HandleT>
+    std::shared_ptr<VolumeAttribute<T, HandleT>> add_attribute(
+        const uint32_t num_attributes = 1)
+    {
+        return std::shared_ptr<VolumeAttribute<T, HandleT>>(
+            new VolumeAttribute<T, HandleT>(
+                get_num_elements<HandleT>(),
+                num_attributes,
+                host_elements<HandleT>().prefix.data(),
+                m_context.elements<HandleT>().m_prefix),
+            [](VolumeAttribute<T, HandleT>* attr) {
+                attr->release();
+                delete attr;
+            });
+    }
+
+    /**
+     * @brief the input vertex positions (3 values per vertex)
+     */
+    std::shared_ptr<VolumeVertexAttribute<float>> get_input_vertex_coordinates()
+    {
+        return m_input_vertex_coordinates;
+    }
+
+    /**
+     * @brief apply a lambda on all (owned) vertices/cells. On the device, one
+     * block is launched per patch
+     */
+    template <typename HandleT, typename LambdaT>
+    void for_each(locationT location, LambdaT apply, cudaStream_t stream = NULL)
+    {
+        if ((location & HOST) == HOST) {
+            const auto& num_owned = host_elements<HandleT>().num_owned;
+            for (uint32_t p = 0; p < m_num_patches; ++p) {
+                for (uint32_t l = 0; l < num_owned[p]; ++l) {
+                    apply(HandleT(p, {uint16_t(l)}));
+                }
+            }
+        }
+
+        if ((location & DEVICE) == DEVICE && m_num_patches > 0) {
+            if constexpr (IS_HD_LAMBDA(LambdaT) || IS_D_LAMBDA(LambdaT)) {
+                detail::patch_csr_for_each<HandleT>
+                    <<<m_num_patches, 256, 0, stream>>>(
+                        m_num_patches,
+                        m_context.elements<HandleT>(),
+                        apply);
+            } else {
+                RXMESH_ERROR(
+                    "RXMeshVolume::for_each() Input lambda function should be "
+                    "annotated with  __device__ for execution on device");
+            }
+        }
+    }
+
+    template <typename LambdaT>
+    void for_each_vertex(locationT    location,
+                         LambdaT      apply,
+                         cudaStream_t stream = NULL)
+    {
+        for_each<VertexHandle>(location, apply, stream);
+    }
+
+    template <typename LambdaT>
+    void for_each_cell(locationT    location,
+                       LambdaT      apply,
+                       cudaStream_t stream = NULL)
+    {
+        for_each<CellHandle>(location, apply, stream);
+    }
+
+    /**
+     * @brief the dynamic shared memory used by run_query_kernel() for op
+     */
+    size_t get_query_shmem_bytes(const VolumeOp op) const
+    {
+        return m_h_query[uint32_t(op)].shmem_bytes;
+    }
+
+    /**
+     * @brief run the query op on all owned source elements (cells for CV/CC
+     * and vertices for VV/VC) with one block per patch. The lambda signature
+     * takes the handle of the source element and a VolumeIterator over the
+     * output, e.g., for VolumeOp::VV
+     * [=] __device__(const VertexHandle& vh,
+     *                const VolumeIterator<VertexHandle>& iter) {...}
+     */
+    template <VolumeOp op, uint32_t blockThreads = 256, typename LambdaT>
+    void run_query_kernel(LambdaT apply, cudaStream_t stream = NULL)
+    {
+        using InputT  = typename VolumeOpHandles<op>::InputHandle;
+        using OutputT = typename VolumeOpHandles<op>::OutputHandle;
+
+        if constexpr (IS_HD_LAMBDA(LambdaT) || IS_D_LAMBDA(LambdaT)) {
+            detail::launch_patch_csr_query<blockThreads, InputT, OutputT>(
+                m_num_patches,
+                m_context.elements<InputT>(),
+                m_context.elements<OutputT>(),
+                m_context.m_query[uint32_t(op)],
+                get_query_shmem_bytes(op),
+                apply,
+                stream);
+        } else {
+            RXMESH_ERROR(
+                "RXMeshVolume::run_query_kernel() Input lambda function "
+                "should be annotated with  __device__ for execution on "
+                "device");
+        }
+    }
+
+   private:
+    template <typename HandleT>
+    const detail::PatchCSRHostElements<HandleT>& host_elements() const
+    {
+        if constexpr (std::is_same_v<HandleT, VertexHandle>) {
+            return m_h_vertex;
+        } else {
+            return m_h_cell;
+        }
+    }
+
+    void build(const std::vector<std::vector<float>>&    verts,
+               const std::vector<std::vector<uint32_t>>& cells,
+               const uint32_t                            patch_size)
+    {
+        const uint32_t num_in_v = uint32_t(verts.size());
+        const uint32_t num_c    = uint32_t(cells.size());
+
+        m_num_patches = 0;
+
+        if (patch_size == 0 || patch_size >= INVALID16) {
+            RXMESH_ERROR("RXMeshVolume() invalid patch size {}", patch_size);
+            return;
+        }
+
+        for (uint32_t c = 0; c < num_c; ++c) {
+            if (cells[c].size() != 4) {
+                RXMESH_ERROR("RXMeshVolume() cell {} is not a tetrahedron", c);
+                return;
+            }
+            for (uint32_t v : cells[c]) {
+                if (v >= num_in_v) {
+                    RXMESH_ERROR(
+                        "RXMeshVolume() cell {} has an invalid vertex {}",
+                        c,
+                        v);
+                    return;
+                }
+            }
+        }
+
+        // the cell-cell adjacency: the neighbor across the face opposite to
+        // the k-th vertex of every cell
+        std::vector<std::array<uint32_t, 4>> cc(num_c);
+        {
+            std::vector<std::array<uint32_t, 5>> faces;
+            faces.reserve(4 * size_t(num_c));
+            for (uint32_t c = 0; c < num_c; ++c) {
+                cc[c].fill(INVALID32);
+                for (uint32_t k = 0; k < 4; ++k) {
+                    std::array<uint32_t, 3> f;
+                    for (uint32_t j = 0, i = 0; j < 4; ++j) {
+                        if (j != k) {
+                            f[i++] = cells[c][j];
+                        }
+                    }
+                    std::sort(f.begin(), f.end());
+                    faces.push_back({f[0], f[1], f[2], c, k});
+                }
+            }
+            std::sort(faces.begin(), faces.end());
+            for (size_t i = 0; i + 1 < faces.size(); ++i) {
+                const auto& a = faces[i];
+                const auto& b = faces[i + 1];
+                if (a[0] == b[0] && a[1] == b[1] && a[2] == b[2]) {
+                    cc[a[3]][a[4]] = b[3];
+                    cc[b[3]][b[4]] = a[3];
+                }
+            }
+        }
+
+        // the vertex-cell incidence
+        std::vector<uint32_t> vc_offset(num_in_v + 1, 0);
+        for (const auto& cell : cells) {
+            for (uint32_t v : cell) {
+                vc_offset[v + 1]++;
+            }
+        }
+        for (uint32_t v = 0; v < num_in_v; ++v) {
+            vc_offset[v + 1] += vc_offset[v];
+        }
+        std::vector<uint32_t> vc_value(vc_offset.back());
+        {
+            std::vector<uint32_t> pos(vc_offset.begin(), vc_offset.end() - 1);
+            for (uint32_t c = 0; c < num_c; ++c) {
+                for (uint32_t v : cells[c]) {
+                    vc_value[pos[v]++] = c;
+                }
+            }
+        }
+
+        // grow patches over the cell-cell adjacency
+        std::vector<uint32_t> cell_patch(num_c, INVALID32);
+        std::vector<uint32_t> queued(num_c, INVALID32);
+        std::vector<std::vector<uint32_t>> patch_cells;
+        for (uint32_t seed = 0; seed < num_c; ++seed) {
+            if (cell_patch[seed] != INVALID32) {
+                continue;
+            }
+            const uint32_t p = uint32_t(patch_cells.size());
+            patch_cells.emplace_back();
+            std::deque<uint32_t> queue = {seed};
+            queued[seed]               = p;
+            while (!queue.empty() && patch_cells[p].size() < patch_size) {
+                const uint32_t c = queue.front();
+                queue.pop_front();
+                if (cell_patch[c] != INVALID32) {
+                    continue;
+                }
+                cell_patch[c] = p;
+                patch_cells[p].push_back(c);
+                for (uint32_t n : cc[c]) {
+                    if (n != INVALID32 && cell_patch[n] == INVALID32 &&
+                        queued[n] != p) {
+                        queued[n] = p;
+                        queue.push_back(n);
+                    }
+                }
+            }
+        }
+        const uint32_t num_patches = uint32_t(patch_cells.size());
+
+        // the owner of a vertex is the smallest patch of its incident cells
+        std::vector<uint32_t> vertex_patch(num_in_v, INVALID32);
+        for (uint32_t v = 0; v < num_in_v; ++v) {
+            for (uint32_t i = vc_offset[v]; i < vc_offset[v + 1]; ++i) {
+                vertex_patch[v] =
+                    std::min(vertex_patch[v], cell_patch[vc_value[i]]);
+            }
+        }
+        if (vc_offset.back() > 0) {
+            const uint32_t num_isolated = uint32_t(std::count(
+                vertex_patch.begin(), vertex_patch.end(), INVALID32));
+            if (num_isolated > 0) {
+                RXMESH_WARN(
+                    "RXMeshVolume() {} vertices are not referenced by any "
+                    "cell and are dropped",
+                    num_isolated);
+            }
+        }
+
+        // the owned vertices of every patch in the order they are first met
+        // in the owned cells of the patch
+        std::vector<std::vector<uint32_t>> patch_vertices(num_patches);
+        {
+            std::vector<bool> added(num_in_v, false);
+            for (uint32_t p = 0; p < num_patches; ++p) {
+                for (uint32_t c : patch_cells[p]) {
+                    for (uint32_t v : cells[c]) {
+                        if (vertex_patch[v] == p && !added[v]) {
+                            added[v] = true;
+                            patch_vertices[p].push_back(v);
+                        }
+                    }
+                }
+                if (patch_vertices[p].size() >= INVALID16) {
+                    RXMESH_ERROR(
+                        "RXMeshVolume() patch {} has too many vertices. Use "
+                        "a smaller patch size",
+                        p);
+                    return;
+                }
+            }
+        }
+
+        m_h_vertex.set_owned(patch_vertices, num_in_v);
+        m_h_cell.set_owned(patch_cells, num_c);
+        for (uint32_t o = 0; o < num_volume_ops; ++o) {
+            m_h_query[o] = detail::PatchCSRHostQuery();
+        }
+
+        // the local index of vertices/cells in the current patch (valid if
+        // the stamp matches the patch)
+        std::vector<uint32_t> v_stamp(num_in_v, INVALID32);
+        std::vector<uint32_t> c_stamp(num_c, INVALID32);
+        std::vector<uint32_t> v_id(num_in_v), c_id(num_c);
+
+        for (uint32_t p = 0; p < num_patches; ++p) {
+            std::vector<uint32_t> local_v, local_c;
+
+            auto add_cell = [&](uint32_t c) {
+                if (c_stamp[c] != p) {
+                    c_stamp[c] = p;
+                    c_id[c]    = uint32_t(local_c.size());
+                    local_c.push_back(c);
+                }
+            };
+            auto add_vertex = [&](uint32_t v) {
+                if (v_stamp[v] != p) {
+                    v_stamp[v] = p;
+                    v_id[v]    = uint32_t(local_v.size());
+                    local_v.push_back(v);
+                }
+            };
+
+            // the owned cells then the ribbon cells
+            for (uint32_t c : patch_cells[p]) {
+                add_cell(c);
+            }
+            for (uint32_t v : patch_vertices[p]) {
+                for (uint32_t i = vc_offset[v]; i < vc_offset[v + 1]; ++i) {
+                    add_cell(vc_value[i]);
+                }
+            }
+            for (uint32_t c : patch_cells[p]) {
+                for (uint32_t n : cc[c]) {
+                    if (n != INVALID32) {
+                        add_cell(n);
+                    }
+                }
+            }
+
+            for (uint32_t v : patch_vertices[p]) {
+                add_vertex(v);
+            }
+            for (uint32_t c : local_c) {
+                for (uint32_t v : cells[c]) {
+                    add_vertex(v);
+                }
+            }
+
+            if (local_v.size() >= INVALID16 || local_c.size() >= INVALID16) {
+                RXMESH_ERROR(
+                    "RXMeshVolume() patch {} has too many local elements. Use "
+                    "a smaller patch size",
+                    p);
+                m_h_vertex = detail::PatchCSRHostElements<VertexHandle>();
+                m_h_cell   = detail::PatchCSRHostElements<CellHandle>();
+                return;
+            }
+
+            m_h_vertex.append_table(local_v);
+            m_h_cell.append_table(local_c);
+
+            const uint32_t num_ov = uint32_t(patch_vertices[p].size());
+            const uint32_t num_oc = uint32_t(patch_cells[p].size());
+            const uint32_t num_lv = uint32_t(local_v.size());
+            const uint32_t num_lc = uint32_t(local_c.size());
+
+            auto& query = m_h_query;
+
+            query[uint32_t(VolumeOp::CV)].append(
+                num_oc, num_lv, [&](uint32_t s, auto& out) {
+                    for (uint32_t v : cells[patch_cells[p][s]]) {
+                        out.push_back(uint16_t(v_id[v]));
+                    }
+                });
+
+            query[uint32_t(VolumeOp::VV)].append(
+                num_ov, num_lv, [&](uint32_t s, auto& out) {
+                    const uint32_t        v = patch_vertices[p][s];
+                    std::vector<uint16_t> ring;
+                    for (uint32_t i = vc_offset[v]; i < vc_offset[v + 1];
+                         ++i) {
+                        for (uint32_t u : cells[vc_value[i]]) {
+                            if (u != v) {
+                                ring.push_back(uint16_t(v_id[u]));
+                            }
+                        }
+                    }
+                    std::sort(ring.begin(), ring.end());
+                    ring.erase(std::unique(ring.begin(), ring.end()),
+                               ring.end());
+                    out.insert(out.end(), ring.begin(), ring.end());
+                });
+
+            query[uint32_t(VolumeOp::VC)].append(
+                num_ov, num_lc, [&](uint32_t s, auto& out) {
+                    const uint32_t v = patch_vertices[p][s];
+                    for (uint32_t i = vc_offset[v]; i < vc_offset[v + 1];
+                         ++i) {
+                        out.push_back(uint16_t(c_id[vc_value[i]]));
+                    }
+                });
+
+            query[uint32_t(VolumeOp::CC)].append(
+                num_oc, num_lc, [&](uint32_t s, auto& out) {
+                    for (uint32_t n : cc[patch_cells[p][s]]) {
+                        out.push_back(n == INVALID32 ? INVALID16 :
+                                                       uint16_t(c_id[n]));
+                    }
+                });
+        }
+
+        for (uint32_t o = 0; o < num_volume_ops; ++o) {
+            if (!m_h_query[o].is_valid()) {
+                RXMESH_ERROR(
+                    "RXMeshVolume() the output of {} overflows a patch. Use "
+                    "a smaller patch size",
+                    volume_op_to_string(VolumeOp(o)));
+                m_h_vertex = detail::PatchCSRHostElements<VertexHandle>();
+                m_h_cell   = detail::PatchCSRHostElements<CellHandle>();
+                return;
+            }
+        }
+
+        // upload to the device
+        m_num_patches           = num_patches;
+        m_context.m_num_patches = num_patches;
+        m_context.m_vertex      = m_h_vertex.upload();
+        m_context.m_cell        = m_h_cell.upload();
+        for (uint32_t o = 0; o < num_volume_ops; ++o) {
+            m_context.m_query[o] = m_h_query[o].upload();
+        }
+
+        // the input coordinates
+        m_input_vertex_coordinates = add_vertex_attribute<float>(3);
+        for (uint32_t v = 0; v < num_in_v; ++v) {
+            const VertexHandle vh = m_h_vertex.input_handle[v];
+            if (!vh.is_valid()) {
+                continue;
+            }
+            for (uint32_t i = 0; i < 3 && i < verts[v].size(); ++i) {
+                (*m_input_vertex_coordinates)(vh, i) = verts[v][i];
+            }
+        }
+        m_input_vertex_coordinates->move(HOST, DEVICE);
+
+        RXMESH_INFO(
+            "RXMeshVolume: #Vertices = {}, #Cells = {}, #Patches = {}",
+            get_num_vertices(),
+            get_num_cells(),
+            get_num_patches());
+    }
+
+    uint32_t      m_num_patches = 0;
+    VolumeContext m_context;
+
+    detail::PatchCSRHostElements<VertexHandle> m_h_vertex;
+    detail::PatchCSRHostElements<CellHandle>   m_h_cell;
+
+    std::array<detail::PatchCSRHostQuery, num_volume_ops> m_h_query;
+
+    std::shared_ptr<VolumeVertexAttribute<float>> m_input_vertex_coordinates;
+};
+}  // namespace rxmesh
@@ -3,6 +3,9 @@
 #include <string>
 #include "rxmesh/util/macros.h"
 
+#include <cuda_bf16.h>
+#include <cuda_fp16.h>
+
 #include <glm/fwd.hpp>
 
 namespace rxmesh {
@@ -37,6 +40,32 @@ using mat3x3 = mat<T, 3, 3>;
 template <typename T>
 using mat4x4 = mat<T, 4, 4>;
 
+/**
+ * @brief The type used for computation on an attribute whose values are
+ * stored as T. Reduced-precision storage types (half and bfloat16) are
+ * computed in float, otherwise storage and computation types are the same
+ */
+template <typename T>
+struct ComputeType
+{
+    using type = T;
+};
+
+template <>
+struct ComputeType<__half>
+{
+    using type = float;
+};
+
+template <>
+struct ComputeType<__nv_bfloat16>
+{
+    using type = float;
+};
+
+template <typename T>
+using compute_t = typename ComputeType<T>::type;
+
 /**
  * @brief Flags for where data resides. Used with Attributes
  */
@@ -71,13 +100,17 @@ static std::string location_to_string(const locationT location)
 }
 
 /**
- * @brief Memory layout
+ * @brief Memory layout. AoSPadded is AoS where the number of attributes per
+ * mesh element is padded to the next power of two (up to 4) such that the
+ * attributes of a mesh element could be loaded/stored with a single vector
+ * instruction (see Attribute::load() and Attribute::store())
  */
 using layoutT = uint32_t;
 enum : layoutT
 {
-    AoS = 0x00,
-    SoA = 0x01,
+    AoS       = 0x00,
+    SoA       = 0x01,
+    AoSPadded = 0x02,
 };
 /**
  * @brief convert locationT to string
@@ -89,6 +122,8 @@ static std::string layout_to_string(const layoutT layout)
             return "AoS";
         case SoA:
             return "SoA";
+        case AoSPadded:
+            return "AoSPadded";
         default: {
             RXMESH_ERROR("to_string() unknown layout");
             return "";
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <assert.h>
 #include <cuda_runtime.h>
 #include <stdint.h>
 
@@ -20,33 +21,114 @@ constexpr __host__ __device__ __inline__ bool is_set_bit(
     return mask & (one << bit);
 }
 
-__host__ __inline__ uint16_t count_set_bits(const uint16_t  size,
-                                            const uint32_t* bitmask)
+/**
+ * @brief the number of set bits in a 32-bit word (__popc on the device)
+ */
+__host__ __device__ __inline__ uint32_t popcount(uint32_t word)
+{
+#ifdef __CUDA_ARCH__
+    return __popc(word);
+#else
+    word = word - ((word >> 1) & 0x55555555u);
+    word = (word & 0x33333333u) + ((word >> 2) & 0x33333333u);
+    return (((word + (word >> 4)) & 0x0F0F0F0Fu) * 0x01010101u) >> 24;
+#endif
+}
+
+/**
+ * @brief the position of the least significant set bit in a 32-bit word
+ * (__ffs on the device). The word should not be zero
+ */
+__host__ __device__ __inline__ uint32_t first_set_bit(uint32_t word)
+{
+    assert(word != 0);
+#ifdef __CUDA_ARCH__
+    return __ffs(word) - 1;
+#else
+    uint32_t pos = 0;
+    while ((word & 1u) == 0) {
+        word >>= 1;
+        ++pos;
+    }
+    return pos;
+#endif
+}
+
+/**
+ * @brief the bits of the w-th word of a bitmask that represent one of the
+ * first size items i.e., all ones except for the last word where the bits
+ * beyond size are zero
+ */
+constexpr __host__ __device__ __inline__ uint32_t word_valid_bits(
+    const uint32_t size,
+    const uint32_t w)
+{
+    const uint32_t rem = (size > 32 * w) ? size - 32 * w : 0;
+    return (rem >= 32) ? INVALID32 : ((1u << rem) - 1);
+}
+
+__host__ __device__ __inline__ uint16_t count_set_bits(const uint16_t  size,
+                                                       const uint32_t* bitmask)
 {
     // size here is the number of item represented by this bitmask. So, if
     // the bitmask is a buffer of a single 32-bits, it could represent up to 32
     // items and thus 'size' could be up to 32
     uint16_t sum = 0;
-    for (uint16_t i = 0; i < size; ++i) {
-        sum += is_set_bit(i, bitmask);
+    for (uint32_t w = 0; w < DIVIDE_UP(size, 32); ++w) {
+        sum += popcount(bitmask[w] & word_valid_bits(size, w));
     }
     return sum;
 }
 
 
-__host__ __inline__ uint16_t count_zero_bits(const uint16_t  size,
-                                             const uint32_t* bitmask)
+__host__ __device__ __inline__ uint16_t count_zero_bits(
+    const uint16_t  size,
+    const uint32_t* bitmask)
+{
+    return size - count_set_bits(size, bitmask);
+}
+
+/**
+ * @brief count the items among the first size items whose bits are set in
+ * both bitmasks e.g., the owned and active elements of a patch
+ */
+__host__ __device__ __inline__ uint16_t count_set_bits_and(
+    const uint16_t  size,
+    const uint32_t* bitmask_a,
+    const uint32_t* bitmask_b)
 {
-    // size here is the number of item represented by this bitmask. So, if
-    // the bitmask is a buffer of a single 32-bits, it could represent up to 32
-    // items and thus 'size' could be up to 32
     uint16_t sum = 0;
-    for (uint16_t i = 0; i < size; ++i) {
-        sum += !is_set_bit(i, bitmask);
+    for (uint32_t w = 0; w < DIVIDE_UP(size, 32); ++w) {
+        sum += popcount(bitmask_a[w] & bitmask_b[w] & word_valid_bits(size, w));
     }
     return sum;
 }
 
+/**
+ * @brief the first set bit at or after the position from among the first size
+ * bits. Returns INVALID16 if there is no such bit
+ */
+__host__ __device__ __inline__ uint16_t find_next_set_bit(
+    const uint16_t  size,
+    const uint32_t* bitmask,
+    const uint16_t  from)
+{
+    if (from >= size) {
+        return INVALID16;
+    }
+    uint32_t w    = from / 32;
+    uint32_t word = bitmask[w] & (INVALID32 << (from % 32));
+    while (true) {
+        word &= word_valid_bits(size, w);
+        if (word != 0) {
+            return static_cast<uint16_t>(32 * w + first_set_bit(word));
+        }
+        if (++w >= DIVIDE_UP(size, 32)) {
+            return INVALID16;
+        }
+        word = bitmask[w];
+    }
+}
 
 __host__ __device__ __inline__ void bitmask_set_bit(const uint16_t local_id,
                                                     uint32_t*      bitmask,
@@ -0,0 +1,426 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <algorithm>
+#include <array>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <cuda_runtime_api.h>
+
+#include "rxmesh/util/log.h"
+#include "rxmesh/util/macros.h"
+
+namespace rxmesh {
+
+/**
+ * @brief what the device memory is used for. Every allocation done through
+ * DeviceMemory is accounted under one category
+ */
+enum class MemoryCategory : uint8_t
+{
+    // patches topology, hashtables, patch stash, and PatchInfo
+    Topology = 0,
+    // attributes (and their host mirrors)
+    Attribute = 1,
+    // sparse and dense matrices (and their cuSPARSE/cuBLAS buffers)
+    Matrix = 2,
+    // workspaces of the linear solvers, GMG, and the differentiable problems
+    Solver = 3,
+    // everything else e.g., query outputs and temporary buffers
+    Other = 4,
+};
+
+static constexpr int NUM_MEMORY_CATEGORIES = 5;
+
+inline const char* memory_category_name(const MemoryCategory cat)
+{
+    switch (cat) {
+        case MemoryCategory::Topology:
+            return "topology";
+        case MemoryCategory::Attribute:
+            return "attributes";
+        case MemoryCategory::Matrix:
+            return "matrices";
+        case MemoryCategory::Solver:
+            return "solvers";
+        default:
+            return "other";
+    }
+}
+
+/**
+ * @brief the device memory in use per category as returned by
+ * DeviceMemory::get_stats()
+ */
+struct DeviceMemoryStats
+{
+    std::array<size_t, NUM_MEMORY_CATEGORIES> used_bytes      = {};
+    std::array<size_t, NUM_MEMORY_CATEGORIES> used_high_bytes = {};
+
+    // the hard budget (0 for unlimited)
+    size_t budget_bytes = 0;
+
+    // the number of allocations rejected because of the budget
+    uint64_t num_rejected = 0;
+
+    size_t get_used_bytes(const MemoryCategory cat) const
+    {
+        return used_bytes[static_cast<int>(cat)];
+    }
+
+    size_t total_bytes() const
+    {
+        size_t sum = 0;
+        for (size_t b : used_bytes) {
+            sum += b;
+        }
+        return sum;
+    }
+
+    void print() const
+    {
+        RXMESH_INFO("Device memory: {} (MB) (budget = {})",
+                    BYTES_TO_MEGABYTES(total_bytes()),
+                    budget_bytes == 0 ?
+                        std::string("unlimited") :
+                        std::to_string(BYTES_TO_MEGABYTES(budget_bytes)) +
+                            " (MB)");
+        for (int c = 0; c < NUM_MEMORY_CATEGORIES; ++c) {
+            RXMESH_INFO("  {:<10} = {} (MB) (high water mark = {} (MB))",
+                        memory_category_name(MemoryCategory(c)),
+                        BYTES_TO_MEGABYTES(used_bytes[c]),
+                        BYTES_TO_MEGABYTES(used_high_bytes[c]));
+        }
+        if (num_rejected > 0) {
+            RXMESH_INFO("  {} allocations rejected by the budget",
+                        num_rejected);
+        }
+    }
+};
+
+/**
+ * @brief a user-provided device allocator (e.g., a pool allocator) that
+ * replaces cudaMalloc/cudaFree for the memory allocated with tracked_malloc()
+ */
+struct DeviceAllocator
+{
+    std::function<cudaError_t(void**, size_t, MemoryCategory)> allocate;
+    std::function<cudaError_t(void*)>                          deallocate;
+};
+
+/**
+ * @brief process-wide accounting of the device memory allocated by RXMesh
+ * with an optional hard budget. All allocations of the library go through
+ * tracked_malloc() (and GPU_FREE) or are recorded here by the memory pool and
+ * the out-of-core allocator such that the memory in use is known per category.
+ * If the budget is set, an allocation that would exceed it fails with
+ * cudaErrorMemoryAllocation before calling the allocator. Services could query
+ * get_available_bytes() (or set the budget) to reject or downscale jobs
+ * before the device runs out of memory. The allocator behind tracked_malloc()
+ * could be replaced with set_allocator(). DeviceMemory is thread-safe
+ */
+class DeviceMemory
+{
+   public:
+    static DeviceMemory& get()
+    {
+        // never destroyed such that static objects that free device memory
+        // at exit still find it
+        static DeviceMemory* instance = new DeviceMemory();
+        return *instance;
+    }
+
+    DeviceMemory(const DeviceMemory&)            = delete;
+    DeviceMemory& operator=(const DeviceMemory&) = delete;
+
+    /**
+     * @brief set the hard budget in bytes of all categories combined. 0 for
+     * unlimited (default). Memory already allocated is not affected
+     */
+    void set_budget(const size_t budget_bytes)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_budget = budget_bytes;
+    }
+
+    size_t get_budget() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_budget;
+    }
+
+    /**
+     * @brief the bytes that could still be allocated under the budget or the
+     * free device memory if there is no budget
+     */
+    size_t get_available_bytes() const
+    {
+        size_t budget, used;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            budget = m_budget;
+            used   = m_total;
+        }
+        if (budget == 0) {
+            size_t free_mem = 0, total_mem = 0;
+            CUDA_ERROR(cudaMemGetInfo(&free_mem, &total_mem));
+            return free_mem;
+        }
+        return budget > used ? budget - used : 0;
+    }
+
+    /**
+     * @brief replace the allocator used by tracked_malloc() and
+     * tracked_free(). Memory allocated before the call is still freed with
+     * the allocator that allocated it
+     */
+    void set_allocator(const DeviceAllocator& allocator)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_allocator = allocator;
+        m_custom    = static_cast<bool>(allocator.allocate) &&
+                   static_cast<bool>(allocator.deallocate);
+        if (m_custom) {
+            m_allocators.push_back(allocator);
+        }
+    }
+
+    /**
+     * @brief switch back to cudaMalloc/cudaFree
+     */
+    void reset_allocator()
+    {
+        set_allocator(DeviceAllocator());
+    }
+
+    /**
+     * @brief allocate num_bytes of device memory under the category
+     */
+    cudaError_t allocate(void**               ptr,
+                         const size_t         num_bytes,
+                         const MemoryCategory cat)
+    {
+        if (!reserve(num_bytes, cat)) {
+            *ptr = nullptr;
+            return cudaErrorMemoryAllocation;
+        }
+
+        DeviceAllocator allocator;
+        int             allocator_id = -1;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_custom) {
+                allocator    = m_allocator;
+                allocator_id = static_cast<int>(m_allocators.size()) - 1;
+            }
+        }
+
+        cudaError_t err = (allocator_id >= 0) ?
+                              allocator.allocate(ptr, num_bytes, cat) :
+                              cudaMalloc(ptr, num_bytes);
+
+        if (err != cudaSuccess) {
+            unreserve(num_bytes, cat);
+            return err;
+        }
+
+        record(*ptr, num_bytes, cat, allocator_id);
+        return err;
+    }
+
+    /**
+     * @brief free memory allocated with allocate(). Memory that is not
+     * tracked is freed with cudaFree
+     */
+    cudaError_t deallocate(void* ptr)
+    {
+        if (ptr == nullptr) {
+            return cudaSuccess;
+        }
+
+        Entry entry;
+        if (!erase(ptr, entry)) {
+            return cudaFree(ptr);
+        }
+
+        if (entry.allocator_id >= 0) {
+            DeviceAllocator allocator;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                allocator = m_allocators[entry.allocator_id];
+            }
+            return allocator.deallocate(ptr);
+        }
+        return cudaFree(ptr);
+    }
+
+    /**
+     * @brief account for num_bytes before allocating them outside of
+     * allocate() (e.g., from a memory pool). Return false (and account
+     * nothing) if this exceeds the budget
+     */
+    bool reserve(const size_t num_bytes, const MemoryCategory cat)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_budget != 0 && m_total + num_bytes > m_budget) {
+            m_num_rejected++;
+            RXMESH_ERROR(
+                "DeviceMemory::reserve() allocating {} (MB) of {} exceeds the "
+                "budget of {} (MB) ({} (MB) in use)",
+                BYTES_TO_MEGABYTES(num_bytes),
+                memory_category_name(cat),
+                BYTES_TO_MEGABYTES(m_budget),
+                BYTES_TO_MEGABYTES(m_total));
+            return false;
+        }
+        const int c = static_cast<int>(cat);
+        m_total += num_bytes;
+        m_used[c] += num_bytes;
+        m_used_high[c] = std::max(m_used_high[c], m_used[c]);
+        return true;
+    }
+
+    /**
+     * @brief undo reserve() e.g., if the allocation failed
+     */
+    void unreserve(const size_t num_bytes, const MemoryCategory cat)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_total -= num_bytes;
+        m_used[static_cast<int>(cat)] -= num_bytes;
+    }
+
+    /**
+     * @brief record the memory ptr that has been reserved and allocated
+     * outside of allocate() such that it is accounted until release()
+     */
+    void record(void* ptr, const size_t num_bytes, const MemoryCategory cat)
+    {
+        record(ptr, num_bytes, cat, -1);
+    }
+
+    /**
+     * @brief stop accounting memory recorded with record() (the memory is not
+     * freed). Return false if ptr is not tracked
+     */
+    bool release(void* ptr)
+    {
+        Entry entry;
+        return erase(ptr, entry);
+    }
+
+    /**
+     * @brief the memory in use per category
+     */
+    DeviceMemoryStats get_stats() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        DeviceMemoryStats stats;
+        stats.used_bytes      = m_used;
+        stats.used_high_bytes = m_used_high;
+        stats.budget_bytes    = m_budget;
+        stats.num_rejected    = m_num_rejected;
+        return stats;
+    }
+
+    /**
+     * @brief reset the high water marks to the memory currently in use
+     */
+    void reset_high_water_mark()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_used_high = m_used;
+    }
+
+   private:
+    struct Entry
+    {
+        size_t         num_bytes    = 0;
+        MemoryCategory cat          = MemoryCategory::Other;
+        int            allocator_id = -1;
+    };
+
+    DeviceMemory()
+        : m_budget(0), m_total(0), m_num_rejected(0), m_custom(false)
+    {
+        m_used.fill(0);
+        m_used_high.fill(0);
+    }
+
+    void record(void*                ptr,
+                const size_t         num_bytes,
+                const MemoryCategory cat,
+                const int            allocator_id)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (ptr == nullptr) {
+            // e.g., zero bytes allocation
+            m_total -= num_bytes;
+            m_used[static_cast<int>(cat)] -= num_bytes;
+            return;
+        }
+        m_entries[ptr] = {num_bytes, cat, allocator_id};
+    }
+
+    bool erase(void* ptr, Entry& entry)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto                        it = m_entries.find(ptr);
+        if (it == m_entries.end()) {
+            return false;
+        }
+        entry = it->second;
+        m_entries.erase(it);
+        m_total -= entry.num_bytes;
+        m_used[static_cast<int>(entry.cat)] -= entry.num_bytes;
+        return true;
+    }
+
+    mutable std::mutex                        m_mutex;
+    std::unordered_map<void*, Entry>          m_entries;
+    std::vector<DeviceAllocator>              m_allocators;
+    DeviceAllocator                           m_allocator;
+    std::array<size_t, NUM_MEMORY_CATEGORIES> m_used;
+    std::array<size_t, NUM_MEMORY_CATEGORIES> m_used_high;
+    size_t                                    m_budget;
+    size_t                                    m_total;
+    uint64_t                                  m_num_rejected;
+    bool                                      m_custom;
+};
+
+/**
+ * @brief allocate num_bytes of device memory accounted under the category
+ * (see DeviceMemory). This is the replacement of cudaMalloc in RXMesh
+ */
+inline cudaError_t tracked_malloc(void**               ptr,
+                                  const size_t         num_bytes,
+                                  const MemoryCategory cat)
+{
+    return DeviceMemory::get().allocate(ptr, num_bytes, cat);
+}
+
+/**
+ * @brief tracked_malloc() for typed pointers (same as the cudaMalloc template)
+ */
+template <typename T>
+inline cudaError_t tracked_malloc(T**                  ptr,
+                                  const size_t         num_bytes,
+                                  const MemoryCategory cat)
+{
+    return tracked_malloc(reinterpret_cast<void**>(ptr), num_bytes, cat);
+}
+
+/**
+ * @brief free memory allocated with tracked_malloc() or cudaMalloc. This is
+ * what GPU_FREE calls
+ */
+inline cudaError_t tracked_free(void* ptr)
+{
+    return DeviceMemory::get().deallocate(ptr);
+}
+}  // namespace rxmesh
@@ -0,0 +1,641 @@
+#pragma once
+
+#include <stdint.h>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "cuda_runtime.h"
+
+#ifdef USE_CUFILE
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cufile.h>
+#endif
+
+#include "rxmesh/types.h"
+#include "rxmesh/util/device_memory.h"
+#include "rxmesh/util/log.h"
+#include "rxmesh/util/macros.h"
+#include "rxmesh/util/timer.h"
+
+namespace rxmesh {
+
+#ifdef USE_CUFILE
+namespace detail {
+/**
+ * @brief open the cuFile driver once per process
+ * @return false if GPUDirect Storage is not available
+ */
+inline bool gds_driver_open()
+{
+    static const bool is_open = []() {
+        const CUfileError_t status = cuFileDriverOpen();
+        if (status.err != CU_FILE_SUCCESS) {
+            RXMESH_WARN(
+                "gds_driver_open() cuFileDriverOpen failed with error {}",
+                int(status.err));
+            return false;
+        }
+        return true;
+    }();
+    return is_open;
+}
+}  // namespace detail
+#endif
+
+/**
+ * @brief binary file for large device buffers (e.g., checkpoints of the
+ * topology and attributes). The file is accessed sequentially. With
+ * GPUDirect Storage (USE_CUFILE), the device buffers are transferred with
+ * cuFile i.e., DMA between the GPU memory and the storage without going
+ * through the host. The small host records (e.g., headers) are batched and
+ * written through a device bounce buffer such that the file is only accessed
+ * with cuFile. If GDS is not available (or not requested), the file falls back
+ * to a std::fstream where the device buffers are staged in chunks through two
+ * pinned buffers such that copying a chunk overlaps the file I/O of the
+ * previous one. The number of transferred bytes and the time spent in the
+ * transfers are tracked (see Report::file_io())
+ */
+class GDSFile
+{
+   public:
+    enum class Mode
+    {
+        Read  = 0,
+        Write = 1,
+    };
+
+    /**
+     * @brief open the file
+     * @param filename the file path
+     * @param mode read or write (the file is truncated)
+     * @param use_gds try to use GPUDirect Storage. Ignored if RXMesh is not
+     * compiled with cuFile (RX_USE_CUFILE)
+     * @param chunk_bytes size of the bounce/staging buffers
+     */
+    GDSFile(const std::string& filename,
+            const Mode         mode,
+            const bool         use_gds     = true,
+            const size_t       chunk_bytes = 64 * 1024 * 1024)
+        : m_filename(filename),
+          m_mode(mode),
+          m_is_gds(false),
+          m_is_open(false),
+          m_chunk_bytes(std::max(chunk_bytes, size_t(4096))),
+          m_offset(0),
+          m_num_bytes(0),
+          m_elapsed_ms(0),
+          m_h_staging(nullptr),
+          m_d_bounce(nullptr),
+          m_cache_begin(0)
+    {
+#ifdef USE_CUFILE
+        if (use_gds) {
+            m_is_gds = open_gds();
+        }
+#endif
+        if (!m_is_gds) {
+            m_stream.open(filename,
+                          std::ios::binary | (mode == Mode::Write ?
+                                                  std::ios::out :
+                                                  std::ios::in));
+            m_is_open = m_stream.is_open();
+        }
+
+        if (!m_is_open) {
+            RXMESH_ERROR("GDSFile::GDSFile() can not open {}", filename);
+        }
+    }
+
+    GDSFile(const GDSFile&) = delete;
+
+    ~GDSFile()
+    {
+        close();
+    }
+
+    /**
+     * @brief flush the pending writes and close the file
+     * @return false if the pending writes could not be written
+     */
+    bool close()
+    {
+        if (!m_is_open) {
+            return true;
+        }
+        bool ok = true;
+
+        if (m_is_gds) {
+#ifdef USE_CUFILE
+            ok = flush_pending();
+            cuFileHandleDeregister(m_handle);
+            ::close(m_fd);
+#endif
+        } else {
+            m_stream.close();
+        }
+
+        if (m_d_bounce) {
+#ifdef USE_CUFILE
+            cuFileBufDeregister(m_d_bounce);
+#endif
+            GPU_FREE(m_d_bounce);
+        }
+        if (m_h_staging) {
+            CUDA_ERROR(cudaFreeHost(m_h_staging));
+            m_h_staging = nullptr;
+            CUDA_ERROR(cudaEventDestroy(m_staged[0]));
+            CUDA_ERROR(cudaEventDestroy(m_staged[1]));
+        }
+        m_is_open = false;
+        return ok;
+    }
+
+    /**
+     * @brief append num_bytes from ptr to the file
+     * @param location where ptr lives (HOST or DEVICE)
+     * @param stream the stream of the work that produces the device buffer
+     */
+    bool write(const void*        ptr,
+               const size_t       num_bytes,
+               const locationT    location,
+               const cudaStream_t stream = NULL)
+    {
+        if (!m_is_open || m_mode != Mode::Write) {
+            RXMESH_ERROR("GDSFile::write() {} is not open for writing",
+                         m_filename);
+            return false;
+        }
+        if (num_bytes == 0) {
+            return true;
+        }
+
+        CPUTimer timer;
+        timer.start();
+
+        bool ok = true;
+        if (m_is_gds) {
+#ifdef USE_CUFILE
+            ok = (location == DEVICE) ? write_gds(ptr, num_bytes, stream) :
+                                        append_pending(ptr, num_bytes);
+#endif
+        } else {
+            ok = (location == DEVICE) ? write_staged(ptr, num_bytes, stream) :
+                                        write_stream(ptr, num_bytes);
+        }
+
+        timer.stop();
+        m_elapsed_ms += timer.elapsed_millis();
+
+        if (ok) {
+            m_offset += num_bytes;
+            m_num_bytes += num_bytes;
+        }
+        return ok;
+    }
+
+    /**
+     * @brief read the next num_bytes of the file into ptr
+     * @param location where ptr lives (HOST or DEVICE)
+     * @param stream the device buffer is ready to be used on this stream
+     * once the function returns
+     */
+    bool read(void*              ptr,
+              const size_t       num_bytes,
+              const locationT    location,
+              const cudaStream_t stream = NULL)
+    {
+        if (!m_is_open || m_mode != Mode::Read) {
+            RXMESH_ERROR("GDSFile::read() {} is not open for reading",
+                         m_filename);
+            return false;
+        }
+        if (num_bytes == 0) {
+            return true;
+        }
+
+        CPUTimer timer;
+        timer.start();
+
+        bool ok = true;
+        if (m_is_gds) {
+#ifdef USE_CUFILE
+            ok = (location == DEVICE) ? read_gds(ptr, num_bytes) :
+                                        read_cached(ptr, num_bytes);
+#endif
+        } else {
+            ok = (location == DEVICE) ? read_staged(ptr, num_bytes, stream) :
+                                        read_stream(ptr, num_bytes);
+        }
+
+        timer.stop();
+        m_elapsed_ms += timer.elapsed_millis();
+
+        if (ok) {
+            m_offset += num_bytes;
+            m_num_bytes += num_bytes;
+        }
+        return ok;
+    }
+
+    /**
+     * @brief check if the file is open
+     */
+    bool is_open() const
+    {
+        return m_is_open;
+    }
+
+    /**
+     * @brief check if the file is accessed with GPUDirect Storage
+     */
+    bool is_gds() const
+    {
+        return m_is_gds;
+    }
+
+    Mode get_mode() const
+    {
+        return m_mode;
+    }
+
+    const std::string& get_filename() const
+    {
+        return m_filename;
+    }
+
+    /**
+     * @brief size of the bounce/staging buffers. Device buffers of at least
+     * this size are transferred at the full bandwidth
+     */
+    size_t get_chunk_bytes() const
+    {
+        return m_chunk_bytes;
+    }
+
+    /**
+     * @brief the number of bytes read/written so far
+     */
+    size_t get_num_bytes() const
+    {
+        return m_num_bytes;
+    }
+
+    /**
+     * @brief the time (in ms) spent in read()/write() so far
+     */
+    float get_elapsed_millis() const
+    {
+        return m_elapsed_ms;
+    }
+
+    /**
+     * @brief the throughput of read()/write() so far in GB/s
+     */
+    double get_throughput_gbs() const
+    {
+        if (m_elapsed_ms <= 0) {
+            return 0;
+        }
+        return (double(m_num_bytes) / double(1024 * 1024 * 1024)) /
+               (double(m_elapsed_ms) / 1000.0);
+    }
+
+   private:
+    /**
+     * @brief allocate the two pinned staging buffers for the fallback path
+     */
+    void allocate_staging()
+    {
+        if (m_h_staging == nullptr) {
+            CUDA_ERROR(
+                cudaMallocHost((void**)&m_h_staging, 2 * m_chunk_bytes));
+            for (int i = 0; i < 2; ++i) {
+                CUDA_ERROR(cudaEventCreateWithFlags(&m_staged[i],
+                                                    cudaEventDisableTiming));
+            }
+        }
+    }
+
+    bool write_stream(const void* ptr, const size_t num_bytes)
+    {
+        m_stream.write(reinterpret_cast<const char*>(ptr), num_bytes);
+        return m_stream.good();
+    }
+
+    bool read_stream(void* ptr, const size_t num_bytes)
+    {
+        m_stream.read(reinterpret_cast<char*>(ptr), num_bytes);
+        return m_stream.good();
+    }
+
+    /**
+     * @brief copy the device buffer to the host chunk by chunk and write the
+     * chunk while the next one is being copied
+     */
+    bool write_staged(const void*        d_ptr,
+                      const size_t       num_bytes,
+                      const cudaStream_t stream)
+    {
+        allocate_staging();
+
+        const char*    src        = reinterpret_cast<const char*>(d_ptr);
+        const uint64_t num_chunks = DIVIDE_UP(num_bytes, m_chunk_bytes);
+
+        auto chunk_bytes = [&](uint64_t c) {
+            return std::min(m_chunk_bytes, num_bytes - c * m_chunk_bytes);
+        };
+
+        auto issue = [&](uint64_t c) {
+            CUDA_ERROR(cudaMemcpyAsync(m_h_staging + (c % 2) * m_chunk_bytes,
+                                       src + c * m_chunk_bytes,
+                                       chunk_bytes(c),
+                                       cudaMemcpyDeviceToHost,
+                                       stream));
+            CUDA_ERROR(cudaEventRecord(m_staged[c % 2], stream));
+        };
+
+        bool ok = true;
+        issue(0);
+        for (uint64_t c = 0; c < num_chunks && ok; ++c) {
+            if (c + 1 < num_chunks) {
+                issue(c + 1);
+            }
+            CUDA_ERROR(cudaEventSynchronize(m_staged[c % 2]));
+            ok = write_stream(m_h_staging + (c % 2) * m_chunk_bytes,
+                              chunk_bytes(c));
+        }
+        CUDA_ERROR(cudaStreamSynchronize(stream));
+        return ok;
+    }
+
+    /**
+     * @brief read the file chunk by chunk and copy the chunk to the device
+     * while the next one is being read
+     */
+    bool read_staged(void*              d_ptr,
+                     const size_t       num_bytes,
+                     const cudaStream_t stream)
+    {
+        allocate_staging();
+
+        char*          dst        = reinterpret_cast<char*>(d_ptr);
+        const uint64_t num_chunks = DIVIDE_UP(num_bytes, m_chunk_bytes);
+
+        bool ok = true;
+        for (uint64_t c = 0; c < num_chunks && ok; ++c) {
+            const size_t bytes =
+                std::min(m_chunk_bytes, num_bytes - c * m_chunk_bytes);
+            char* staging = m_h_staging + (c % 2) * m_chunk_bytes;
+
+            // wait for the copy that used this buffer two chunks ago
+            if (c >= 2) {
+                CUDA_ERROR(cudaEventSynchronize(m_staged[c % 2]));
+            }
+            ok = read_stream(staging, bytes);
+            if (ok) {
+                CUDA_ERROR(cudaMemcpyAsync(dst + c * m_chunk_bytes,
+                                           staging,
+                                           bytes,
+                                           cudaMemcpyHostToDevice,
+                                           stream));
+                CUDA_ERROR(cudaEventRecord(m_staged[c % 2], stream));
+            }
+        }
+        CUDA_ERROR(cudaStreamSynchronize(stream));
+        return ok;
+    }
+
+#ifdef USE_CUFILE
+    bool open_gds()
+    {
+        if (!detail::gds_driver_open()) {
+            return false;
+        }
+
+        const int flags = (m_mode == Mode::Write) ?
+                              (O_CREAT | O_RDWR | O_TRUNC | O_DIRECT) :
+                              (O_RDONLY | O_DIRECT);
+
+        m_fd = ::open(m_filename.c_str(), flags, 0664);
+        if (m_fd < 0) {
+            RXMESH_WARN(
+                "GDSFile::open_gds() can not open {} with O_DIRECT, falling "
+                "back to the pinned host path",
+                m_filename);
+            return false;
+        }
+
+        CUfileDescr_t descr;
+        std::memset(&descr, 0, sizeof(CUfileDescr_t));
+        descr.handle.fd = m_fd;
+        descr.type      = CU_FILE_HANDLE_TYPE_OPAQUE_FD;
+
+        const CUfileError_t status = cuFileHandleRegister(&m_handle, &descr);
+        if (status.err != CU_FILE_SUCCESS) {
+            RXMESH_WARN(
+                "GDSFile::open_gds() cuFileHandleRegister failed for {} with "
+                "error {}, falling back to the pinned host path",
+                m_filename,
+                int(status.err));
+            ::close(m_fd);
+            return false;
+        }
+
+        if (m_mode == Mode::Read) {
+            struct stat st;
+            fstat(m_fd, &st);
+            m_file_size = size_t(st.st_size);
+        }
+
+        CUDA_ERROR(tracked_malloc(
+            (void**)&m_d_bounce, m_chunk_bytes, MemoryCategory::Other));
+        cuFileBufRegister(m_d_bounce, m_chunk_bytes, 0);
+
+        m_is_open = true;
+        return true;
+    }
+
+    /**
+     * @brief write num_bytes from the device buffer d_ptr (which could be
+     * registered or not) at the file offset
+     */
+    bool cufile_write(const void* d_ptr, size_t num_bytes, size_t offset)
+    {
+        size_t done = 0;
+        while (done < num_bytes) {
+            const size_t  bytes = std::min(m_chunk_bytes, num_bytes - done);
+            const ssize_t ret   = cuFileWrite(
+                m_handle, d_ptr, bytes, off_t(offset + done), off_t(done));
+            if (ret <= 0) {
+                RXMESH_ERROR("GDSFile::write() cuFileWrite failed for {}",
+                             m_filename);
+                return false;
+            }
+            done += size_t(ret);
+        }
+        return true;
+    }
+
+    /**
+     * @brief read num_bytes at the file offset into the device buffer d_ptr
+     */
+    bool cufile_read(void* d_ptr, size_t num_bytes, size_t offset)
+    {
+        size_t done = 0;
+        while (done < num_bytes) {
+            const size_t  bytes = std::min(m_chunk_bytes, num_bytes - done);
+            const ssize_t ret   = cuFileRead(
+                m_handle, d_ptr, bytes, off_t(offset + done), off_t(done));
+            if (ret <= 0) {
+                RXMESH_ERROR(
+                    "GDSFile::read() cuFileRead failed or reached the end of "
+                    "{}",
+                    m_filename);
+                return false;
+            }
+            done += size_t(ret);
+        }
+        return true;
+    }
+
+    /**
+     * @brief write the batched host records through the bounce buffer. They
+     * are stored right before the current offset
+     */
+    bool flush_pending()
+    {
+        size_t offset = m_offset - m_pending.size();
+        size_t done   = 0;
+        while (done < m_pending.size()) {
+            const size_t bytes =
+                std::min(m_chunk_bytes, m_pending.size() - done);
+            CUDA_ERROR(cudaMemcpy(m_d_bounce,
+                                  m_pending.data() + done,
+                                  bytes,
+                                  cudaMemcpyHostToDevice));
+            if (!cufile_write(m_d_bounce, bytes, offset + done)) {
+                return false;
+            }
+            done += bytes;
+        }
+        m_pending.clear();
+        return true;
+    }
+
+    bool append_pending(const void* ptr, const size_t num_bytes)
+    {
+        const char* src = reinterpret_cast<const char*>(ptr);
+        m_pending.insert(m_pending.end(), src, src + num_bytes);
+        if (m_pending.size() >= m_chunk_bytes) {
+            // the pending records end at the offset after this write
+            m_offset += num_bytes;
+            const bool ok = flush_pending();
+            m_offset -= num_bytes;
+            return ok;
+        }
+        return true;
+    }
+
+    bool write_gds(const void*        d_ptr,
+                   const size_t       num_bytes,
+                   const cudaStream_t stream)
+    {
+        if (!flush_pending()) {
+            return false;
+        }
+        // cuFile is synchronous and does not know about the stream
+        CUDA_ERROR(cudaStreamSynchronize(stream));
+        return cufile_write(d_ptr, num_bytes, m_offset);
+    }
+
+    /**
+     * @brief read the host records from a host cache of the file that is
+     * filled one chunk at a time through the bounce buffer
+     */
+    bool read_cached(void* ptr, const size_t num_bytes)
+    {
+        char*  dst  = reinterpret_cast<char*>(ptr);
+        size_t done = 0;
+        while (done < num_bytes) {
+            const size_t offset = m_offset + done;
+            if (offset < m_cache_begin ||
+                offset >= m_cache_begin + m_cache.size()) {
+                if (offset >= m_file_size) {
+                    RXMESH_ERROR("GDSFile::read() reached the end of {}",
+                                 m_filename);
+                    return false;
+                }
+                const size_t bytes =
+                    std::min(m_chunk_bytes, m_file_size - offset);
+                if (!cufile_read(m_d_bounce, bytes, offset)) {
+                    return false;
+                }
+                m_cache.resize(bytes);
+                CUDA_ERROR(cudaMemcpy(m_cache.data(),
+                                      m_d_bounce,
+                                      bytes,
+                                      cudaMemcpyDeviceToHost));
+                m_cache_begin = offset;
+            }
+            const size_t in_cache = m_cache_begin + m_cache.size() - offset;
+            const size_t bytes    = std::min(in_cache, num_bytes - done);
+            std::memcpy(dst + done,
+                        m_cache.data() + (offset - m_cache_begin),
+                        bytes);
+            done += bytes;
+        }
+        return true;
+    }
+
+    /**
+     * @brief read into the device buffer. The part that is already in the
+     * host cache is copied from there and the rest is read with cuFile
+     */
+    bool read_gds(void* d_ptr, const size_t num_bytes)
+    {
+        char*  dst      = reinterpret_cast<char*>(d_ptr);
+        size_t in_cache = 0;
+        if (m_offset >= m_cache_begin &&
+            m_offset < m_cache_begin + m_cache.size()) {
+            in_cache = std::min(m_cache_begin + m_cache.size() - m_offset,
+                                num_bytes);
+            CUDA_ERROR(cudaMemcpy(dst,
+                                  m_cache.data() + (m_offset - m_cache_begin),
+                                  in_cache,
+                                  cudaMemcpyHostToDevice));
+        }
+        if (in_cache == num_bytes) {
+            return true;
+        }
+        return cufile_read(
+            dst + in_cache, num_bytes - in_cache, m_offset + in_cache);
+    }
+
+    int               m_fd        = -1;
+    size_t            m_file_size = 0;
+    CUfileHandle_t    m_handle;
+#endif
+
+    std::string       m_filename;
+    Mode              m_mode;
+    bool              m_is_gds;
+    bool              m_is_open;
+    size_t            m_chunk_bytes;
+    size_t            m_offset;
+    size_t            m_num_bytes;
+    float             m_elapsed_ms;
+    std::fstream      m_stream;
+    char*             m_h_staging;
+    cudaEvent_t       m_staged[2];
+    void*             m_d_bounce;
+    std::vector<char> m_pending;
+    std::vector<char> m_cache;
+    size_t            m_cache_begin;
+};
+}  // namespace rxmesh
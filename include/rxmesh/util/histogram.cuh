@@ -23,12 +23,17 @@ struct Histogram
           temp_storage_bytes(0)
     {
         using namespace rxmesh;
-        CUDA_ERROR(cudaMalloc((void**)&d_bins, num_bins * sizeof(int)));
+        CUDA_ERROR(tracked_malloc((void**)&d_bins,
+                                  num_bins * sizeof(int),
+                                  MemoryCategory::Other));
         cub::DeviceScan::InclusiveSum(
             d_scan_temp_storage, temp_storage_bytes, d_bins, num_bins);
-        CUDA_ERROR(
-            cudaMalloc((void**)&d_scan_temp_storage, temp_storage_bytes));
-        CUDA_ERROR(cudaMalloc((void**)&d_min_max_edge_cost, 2 * sizeof(T)));
+        CUDA_ERROR(tracked_malloc((void**)&d_scan_temp_storage,
+                                  temp_storage_bytes,
+                                  MemoryCategory::Other));
+        CUDA_ERROR(tracked_malloc((void**)&d_min_max_edge_cost,
+                                  2 * sizeof(T),
+                                  MemoryCategory::Other));
     }
 
     __host__ void scan()
@@ -40,9 +45,9 @@ struct Histogram
     __host__ void free()
     {
         using namespace rxmesh;
-        CUDA_ERROR(cudaFree(d_min_max_edge_cost));
-        CUDA_ERROR(cudaFree(d_bins));
-        CUDA_ERROR(cudaFree(d_scan_temp_storage));
+        CUDA_ERROR(tracked_free(d_min_max_edge_cost));
+        CUDA_ERROR(tracked_free(d_bins));
+        CUDA_ERROR(tracked_free(d_scan_temp_storage));
     }
 
     __host__ void init()
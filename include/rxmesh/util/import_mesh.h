@@ -0,0 +1,1022 @@
+#pragma once
+
+#include <omp.h>
+#include <stdint.h>
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "rxmesh/util/log.h"
+
+/**
+ * @brief read-only memory mapping of a file. The mapping is released when the
+ * object goes out of scope
+ */
+class MappedFile
+{
+   public:
+    explicit MappedFile(const std::string& file_name)
+        : m_data(nullptr), m_size(0), m_is_open(false)
+    {
+#ifdef _WIN32
+        m_file = CreateFileA(file_name.c_str(),
+                             GENERIC_READ,
+                             FILE_SHARE_READ,
+                             NULL,
+                             OPEN_EXISTING,
+                             FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+                             NULL);
+        m_mapping = NULL;
+        if (m_file == INVALID_HANDLE_VALUE) {
+            return;
+        }
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(m_file, &size)) {
+            return;
+        }
+        m_size = static_cast<size_t>(size.QuadPart);
+        if (m_size > 0) {
+            m_mapping =
+                CreateFileMappingA(m_file, NULL, PAGE_READONLY, 0, 0, NULL);
+            if (m_mapping == NULL) {
+                m_size = 0;
+                return;
+            }
+            m_data = static_cast<const char*>(
+                MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+            if (m_data == nullptr) {
+                m_size = 0;
+                return;
+            }
+        }
+#else
+        int fd = open(file_name.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return;
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0) {
+            close(fd);
+            return;
+        }
+        m_size = static_cast<size_t>(st.st_size);
+        if (m_size > 0) {
+            void* ptr = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (ptr == MAP_FAILED) {
+                m_size = 0;
+                close(fd);
+                return;
+            }
+            madvise(ptr, m_size, MADV_WILLNEED);
+            m_data = static_cast<const char*>(ptr);
+        }
+        // the mapping stays valid after closing the file descriptor
+        close(fd);
+#endif
+        m_is_open = true;
+    }
+
+    MappedFile(const MappedFile&)            = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    ~MappedFile()
+    {
+#ifdef _WIN32
+        if (m_data != nullptr) {
+            UnmapViewOfFile(m_data);
+        }
+        if (m_mapping != NULL) {
+            CloseHandle(m_mapping);
+        }
+        if (m_file != INVALID_HANDLE_VALUE) {
+            CloseHandle(m_file);
+        }
+#else
+        if (m_data != nullptr) {
+            munmap(const_cast<char*>(m_data), m_size);
+        }
+#endif
+    }
+
+    /**
+     * @brief true if the file was opened and mapped successfully
+     */
+    bool is_open() const
+    {
+        return m_is_open;
+    }
+
+    /**
+     * @brief pointer to the first byte of the file
+     */
+    const char* data() const
+    {
+        return m_data;
+    }
+
+    /**
+     * @brief size of the file in bytes
+     */
+    size_t size() const
+    {
+        return m_size;
+    }
+
+   private:
+    const char* m_data;
+    size_t      m_size;
+    bool        m_is_open;
+#ifdef _WIN32
+    HANDLE m_file;
+    HANDLE m_mapping;
+#endif
+};
+
+namespace import_detail {
+
+inline bool is_blank(const char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+inline const char* skip_blank(const char* p, const char* end)
+{
+    while (p < end && is_blank(*p)) {
+        ++p;
+    }
+    return p;
+}
+
+inline const char* skip_token(const char* p, const char* end)
+{
+    while (p < end && !is_blank(*p) && *p != '\n') {
+        ++p;
+    }
+    return p;
+}
+
+inline const char* next_line(const char* p, const char* end)
+{
+    const char* nl = static_cast<const char*>(memchr(p, '\n', end - p));
+    return (nl == nullptr) ? end : nl + 1;
+}
+
+/**
+ * @brief parse an integer starting at p and advance p past it. Return false
+ * if there is no integer at p
+ */
+inline bool parse_int(const char*& p, const char* end, long long& val)
+{
+    bool neg = false;
+    if (p < end && (*p == '-' || *p == '+')) {
+        neg = (*p == '-');
+        ++p;
+    }
+    if (p >= end || *p < '0' || *p > '9') {
+        return false;
+    }
+    long long v = 0;
+    while (p < end && *p >= '0' && *p <= '9') {
+        v = v * 10 + (*p - '0');
+        ++p;
+    }
+    val = neg ? -v : v;
+    return true;
+}
+
+/**
+ * @brief parse a real number starting at p and advance p past it. The mapped
+ * file is not null-terminated so the token is copied to a local buffer before
+ * calling strtod. Return false if there is no number at p
+ */
+inline bool parse_real(const char*& p, const char* end, double& val)
+{
+    const char* t_end = skip_token(p, end);
+    const auto  len   = static_cast<size_t>(t_end - p);
+
+    constexpr size_t max_len = 64;
+    if (len == 0 || len >= max_len) {
+        return false;
+    }
+    char buf[max_len];
+    memcpy(buf, p, len);
+    buf[len] = '\0';
+
+    char* num_end = nullptr;
+    val           = std::strtod(buf, &num_end);
+    if (num_end == buf) {
+        return false;
+    }
+    p += (num_end - buf);
+    return true;
+}
+
+/**
+ * @brief convert per-face vertex count to offsets (exclusive prefix sum) in
+ * place. face_offset should have #faces + 1 entries where the first #faces
+ * entries are the face sizes. If all faces are triangles, face_offset is
+ * cleared
+ */
+template <typename IndexT>
+inline void face_size_to_offset(std::vector<IndexT>& face_offset)
+{
+    const size_t num_faces = face_offset.size() - 1;
+
+    bool all_tri = true;
+    for (size_t f = 0; f < num_faces; ++f) {
+        if (face_offset[f] != 3) {
+            all_tri = false;
+            break;
+        }
+    }
+    if (all_tri) {
+        face_offset.clear();
+        return;
+    }
+
+    IndexT sum = 0;
+    for (size_t f = 0; f < num_faces; ++f) {
+        IndexT s       = face_offset[f];
+        face_offset[f] = sum;
+        sum += s;
+    }
+    face_offset[num_faces] = sum;
+}
+
+/**
+ * @brief make sure all face indices are within the vertex range
+ */
+template <typename IndexT>
+inline bool check_face_indices(const std::vector<IndexT>& faces,
+                               const size_t               num_vertices)
+{
+    bool valid = true;
+#pragma omp parallel for reduction(&& : valid)
+    for (int64_t i = 0; i < static_cast<int64_t>(faces.size()); ++i) {
+        const int64_t id = static_cast<int64_t>(faces[i]);
+        valid            = valid && id >= 0 && id < int64_t(num_vertices);
+    }
+    return valid;
+}
+}  // namespace import_detail
+
+/**
+ * @brief Read an input mesh from obj file format into flat arrays. The file is
+ * memory-mapped and split into chunks (at line boundaries) that are parsed in
+ * parallel. Only vertex positions and face vertex indices are read; texture
+ * coordinates, normals, groups, and materials are skipped.
+ * @tparam DataT coordinates type (float/double)
+ * @tparam IndexT indices type
+ * @param file_name path to the obj file
+ * @param vertices 3d vertices (3*#vertices)
+ * @param faces face index to the vertices array. For triangle meshes this is
+ * 3*#faces. Otherwise, it is the concatenation of all faces' indices
+ * @param face_offset offset of each face in faces (#faces + 1). It is left
+ * empty if all faces are triangles
+ * @return true if reading the file is successful
+ */
+template <typename DataT, typename IndexT>
+bool import_obj_flat(const std::string    file_name,
+                     std::vector<DataT>&  vertices,
+                     std::vector<IndexT>& faces,
+                     std::vector<IndexT>& face_offset)
+{
+    using namespace import_detail;
+
+    vertices.clear();
+    faces.clear();
+    face_offset.clear();
+
+    MappedFile file(file_name);
+    if (!file.is_open()) {
+        RXMESH_ERROR("import_obj_flat() can not open {}", file_name);
+        return false;
+    } else {
+        RXMESH_INFO("Reading {}", file_name);
+    }
+
+    const char*  begin = file.data();
+    const char*  end   = begin + file.size();
+    const size_t size  = file.size();
+
+    // split the file into chunks that starts at a line boundary. Small files
+    // are parsed by a single thread
+    constexpr size_t min_chunk_size = 1 << 20;
+
+    const int num_chunks = static_cast<int>(std::max<size_t>(
+        1,
+        std::min<size_t>(size / min_chunk_size,
+                         static_cast<size_t>(4 * omp_get_max_threads()))));
+
+    std::vector<const char*> chunk_start(num_chunks + 1, end);
+    chunk_start[0] = begin;
+    for (int c = 1; c < num_chunks; ++c) {
+        const char* p =
+            std::max(begin + (size * c) / num_chunks, chunk_start[c - 1]);
+        chunk_start[c] = (p == begin) ? p : next_line(p - 1, end);
+    }
+
+    // 1) count the vertices, faces and face indices in each chunk
+    std::vector<size_t> chunk_num_v(num_chunks + 1, 0);
+    std::vector<size_t> chunk_num_f(num_chunks + 1, 0);
+    std::vector<size_t> chunk_num_fv(num_chunks + 1, 0);
+
+#pragma omp parallel for schedule(dynamic, 1)
+    for (int c = 0; c < num_chunks; ++c) {
+        const char* p     = chunk_start[c];
+        const char* c_end = chunk_start[c + 1];
+        while (p < c_end) {
+            const char* l_end = next_line(p, c_end);
+            p                 = skip_blank(p, l_end);
+            if (p + 1 < l_end && is_blank(p[1])) {
+                if (p[0] == 'v') {
+                    chunk_num_v[c]++;
+                } else if (p[0] == 'f') {
+                    chunk_num_f[c]++;
+                    const char* w = skip_blank(p + 1, l_end);
+                    while (w < l_end && *w != '\n') {
+                        chunk_num_fv[c]++;
+                        w = skip_blank(skip_token(w, l_end), l_end);
+                    }
+                }
+            }
+            p = l_end;
+        }
+    }
+
+    // exclusive prefix sum to get where each chunk writes its output
+    size_t num_v = 0, num_f = 0, num_fv = 0;
+    for (int c = 0; c <= num_chunks; ++c) {
+        size_t v = chunk_num_v[c], f = chunk_num_f[c], fv = chunk_num_fv[c];
+
+        chunk_num_v[c]  = num_v;
+        chunk_num_f[c]  = num_f;
+        chunk_num_fv[c] = num_fv;
+
+        num_v += v;
+        num_f += f;
+        num_fv += fv;
+    }
+
+    vertices.resize(3 * num_v);
+    faces.resize(num_fv);
+    face_offset.resize(num_f + 1);
+
+    // 2) parse each chunk and write directly to its location in the output
+    std::vector<char> chunk_ok(num_chunks, 1);
+
+#pragma omp parallel for schedule(dynamic, 1)
+    for (int c = 0; c < num_chunks; ++c) {
+        const char* p     = chunk_start[c];
+        const char* c_end = chunk_start[c + 1];
+
+        size_t v  = chunk_num_v[c];
+        size_t f  = chunk_num_f[c];
+        size_t fv = chunk_num_fv[c];
+
+        while (p < c_end && chunk_ok[c]) {
+            const char* l_end = next_line(p, c_end);
+            p                 = skip_blank(p, l_end);
+            if (p + 1 < l_end && is_blank(p[1])) {
+                if (p[0] == 'v') {
+                    const char* w = p + 1;
+                    for (int i = 0; i < 3; ++i) {
+                        double x;
+                        w = skip_blank(w, l_end);
+                        if (!parse_real(w, l_end, x)) {
+                            chunk_ok[c] = 0;
+                            break;
+                        }
+                        vertices[3 * v + i] = static_cast<DataT>(x);
+                    }
+                    v++;
+                } else if (p[0] == 'f') {
+                    const char* w = skip_blank(p + 1, l_end);
+                    IndexT      s = 0;
+                    while (w < l_end && *w != '\n') {
+                        // read the vertex id and skip texture/normal ids
+                        long long id;
+                        if (!parse_int(w, l_end, id)) {
+                            chunk_ok[c] = 0;
+                            break;
+                        }
+                        // negative indices are relative to the vertices read
+                        // so far
+                        faces[fv++] = static_cast<IndexT>(
+                            id < 0 ? static_cast<long long>(v) + id : id - 1);
+                        s++;
+                        w = skip_blank(skip_token(w, l_end), l_end);
+                    }
+                    if (s < 3) {
+                        chunk_ok[c] = 0;
+                    }
+                    face_offset[f++] = s;
+                }
+            }
+            p = l_end;
+        }
+    }
+
+    for (int c = 0; c < num_chunks; ++c) {
+        if (!chunk_ok[c]) {
+            RXMESH_ERROR(
+                "import_obj_flat() invalid vertex or face in {} near byte {}",
+                file_name,
+                static_cast<size_t>(chunk_start[c] - begin));
+            return false;
+        }
+    }
+
+    if (!check_face_indices(faces, num_v)) {
+        RXMESH_ERROR("import_obj_flat() face index out of range in {}",
+                     file_name);
+        return false;
+    }
+
+    face_size_to_offset(face_offset);
+
+    RXMESH_INFO("import_obj_flat() #vertices= {} ", num_v);
+    RXMESH_INFO("import_obj_flat() #faces= {} ", num_f);
+
+    return true;
+}
+
+namespace import_detail {
+
+enum class PlyType
+{
+    INVALID = 0,
+    INT8,
+    UINT8,
+    INT16,
+    UINT16,
+    INT32,
+    UINT32,
+    FLOAT32,
+    FLOAT64
+};
+
+inline PlyType ply_type(const std::string& name)
+{
+    if (name == "char" || name == "int8") {
+        return PlyType::INT8;
+    } else if (name == "uchar" || name == "uint8") {
+        return PlyType::UINT8;
+    } else if (name == "short" || name == "int16") {
+        return PlyType::INT16;
+    } else if (name == "ushort" || name == "uint16") {
+        return PlyType::UINT16;
+    } else if (name == "int" || name == "int32") {
+        return PlyType::INT32;
+    } else if (name == "uint" || name == "uint32") {
+        return PlyType::UINT32;
+    } else if (name == "float" || name == "float32") {
+        return PlyType::FLOAT32;
+    } else if (name == "double" || name == "float64") {
+        return PlyType::FLOAT64;
+    }
+    return PlyType::INVALID;
+}
+
+inline size_t ply_type_size(const PlyType t)
+{
+    switch (t) {
+        case PlyType::INT8:
+        case PlyType::UINT8:
+            return 1;
+        case PlyType::INT16:
+        case PlyType::UINT16:
+            return 2;
+        case PlyType::INT32:
+        case PlyType::UINT32:
+        case PlyType::FLOAT32:
+            return 4;
+        case PlyType::FLOAT64:
+            return 8;
+        default:
+            return 0;
+    }
+}
+
+struct PlyProperty
+{
+    std::string name;
+    PlyType     type       = PlyType::INVALID;
+    bool        is_list    = false;
+    PlyType     count_type = PlyType::INVALID;
+};
+
+struct PlyElement
+{
+    std::string              name;
+    size_t                   count = 0;
+    std::vector<PlyProperty> props;
+
+    /**
+     * @brief size in bytes of one item in binary format or 0 if the element
+     * has a list property (i.e., variable size)
+     */
+    size_t stride() const
+    {
+        size_t s = 0;
+        for (const auto& pr : props) {
+            if (pr.is_list) {
+                return 0;
+            }
+            s += ply_type_size(pr.type);
+        }
+        return s;
+    }
+};
+
+/**
+ * @brief read one binary scalar of type t from p (which is not necessarily
+ * aligned) and convert it to double
+ */
+inline double ply_read_binary(const char* p, const PlyType t, const bool swap)
+{
+    unsigned char b[8];
+    const size_t  s = ply_type_size(t);
+    memcpy(b, p, s);
+    if (swap) {
+        std::reverse(b, b + s);
+    }
+    switch (t) {
+        case PlyType::INT8: {
+            int8_t v;
+            memcpy(&v, b, 1);
+            return v;
+        }
+        case PlyType::UINT8: {
+            uint8_t v;
+            memcpy(&v, b, 1);
+            return v;
+        }
+        case PlyType::INT16: {
+            int16_t v;
+            memcpy(&v, b, 2);
+            return v;
+        }
+        case PlyType::UINT16: {
+            uint16_t v;
+            memcpy(&v, b, 2);
+            return v;
+        }
+        case PlyType::INT32: {
+            int32_t v;
+            memcpy(&v, b, 4);
+            return v;
+        }
+        case PlyType::UINT32: {
+            uint32_t v;
+            memcpy(&v, b, 4);
+            return v;
+        }
+        case PlyType::FLOAT32: {
+            float v;
+            memcpy(&v, b, 4);
+            return v;
+        }
+        case PlyType::FLOAT64: {
+            double v;
+            memcpy(&v, b, 8);
+            return v;
+        }
+        default:
+            return 0;
+    }
+}
+
+/**
+ * @brief read the next whitespace-separated number from an ascii PLY body
+ */
+inline bool ply_read_ascii(const char*& p, const char* end, double& val)
+{
+    while (p < end && (is_blank(*p) || *p == '\n')) {
+        ++p;
+    }
+    return parse_real(p, end, val);
+}
+
+inline bool is_little_endian()
+{
+    const uint16_t one = 1;
+    unsigned char  b;
+    memcpy(&b, &one, 1);
+    return b == 1;
+}
+}  // namespace import_detail
+
+/**
+ * @brief Read an input mesh from ply file format (ascii, binary little endian,
+ * or binary big endian) into flat arrays. Only the vertex positions (x, y, z)
+ * and the face vertex indices (vertex_indices or vertex_index) are read and
+ * all other elements and properties are skipped. With binary format, vertices
+ * are decoded in parallel when the vertex element has a fixed size.
+ * @tparam DataT coordinates type (float/double)
+ * @tparam IndexT indices type
+ * @param file_name path to the ply file
+ * @param vertices 3d vertices (3*#vertices)
+ * @param faces face index to the vertices array. For triangle meshes this is
+ * 3*#faces. Otherwise, it is the concatenation of all faces' indices
+ * @param face_offset offset of each face in faces (#faces + 1). It is left
+ * empty if all faces are triangles
+ * @return true if reading the file is successful
+ */
+template <typename DataT, typename IndexT>
+bool import_ply_flat(const std::string    file_name,
+                     std::vector<DataT>&  vertices,
+                     std::vector<IndexT>& faces,
+                     std::vector<IndexT>& face_offset)
+{
+    using namespace import_detail;
+
+    vertices.clear();
+    faces.clear();
+    face_offset.clear();
+
+    MappedFile file(file_name);
+    if (!file.is_open()) {
+        RXMESH_ERROR("import_ply_flat() can not open {}", file_name);
+        return false;
+    } else {
+        RXMESH_INFO("Reading {}", file_name);
+    }
+
+    const char* p   = file.data();
+    const char* end = p + file.size();
+
+    auto read_line = [&](std::vector<std::string>& tokens) {
+        tokens.clear();
+        const char* l_end = next_line(p, end);
+        const char* w     = skip_blank(p, l_end);
+        while (w < l_end && *w != '\n') {
+            const char* t_end = skip_token(w, l_end);
+            tokens.emplace_back(w, t_end);
+            w = skip_blank(t_end, l_end);
+        }
+        p = l_end;
+    };
+
+    // 1) header
+    std::vector<std::string> tokens;
+    read_line(tokens);
+    if (tokens.size() != 1 || tokens[0] != "ply") {
+        RXMESH_ERROR("import_ply_flat() {} is not a ply file", file_name);
+        return false;
+    }
+
+    enum class Format
+    {
+        ASCII,
+        BINARY_LE,
+        BINARY_BE
+    } format = Format::ASCII;
+
+    std::vector<PlyElement> elements;
+    bool                    header_ended = false;
+    while (p < end) {
+        read_line(tokens);
+        if (tokens.empty() || tokens[0] == "comment" ||
+            tokens[0] == "obj_info") {
+            continue;
+        } else if (tokens[0] == "end_header") {
+            header_ended = true;
+            break;
+        } else if (tokens[0] == "format" && tokens.size() >= 2) {
+            if (tokens[1] == "ascii") {
+                format = Format::ASCII;
+            } else if (tokens[1] == "binary_little_endian") {
+                format = Format::BINARY_LE;
+            } else if (tokens[1] == "binary_big_endian") {
+                format = Format::BINARY_BE;
+            } else {
+                RXMESH_ERROR("import_ply_flat() unknown format {} in {}",
+                             tokens[1],
+                             file_name);
+                return false;
+            }
+        } else if (tokens[0] == "element" && tokens.size() == 3) {
+            PlyElement el;
+            el.name  = tokens[1];
+            el.count = std::strtoull(tokens[2].c_str(), nullptr, 10);
+            elements.push_back(el);
+        } else if (tokens[0] == "property" && !elements.empty()) {
+            PlyProperty pr;
+            if (tokens.size() == 5 && tokens[1] == "list") {
+                pr.is_list    = true;
+                pr.count_type = ply_type(tokens[2]);
+                pr.type       = ply_type(tokens[3]);
+                pr.name       = tokens[4];
+            } else if (tokens.size() == 3) {
+                pr.type = ply_type(tokens[1]);
+                pr.name = tokens[2];
+            }
+            if (pr.type == PlyType::INVALID ||
+                (pr.is_list && pr.count_type == PlyType::INVALID)) {
+                RXMESH_ERROR("import_ply_flat() invalid property in {}",
+                             file_name);
+                return false;
+            }
+            elements.back().props.push_back(pr);
+        } else {
+            RXMESH_ERROR("import_ply_flat() invalid header line in {}",
+                         file_name);
+            return false;
+        }
+    }
+
+    if (!header_ended) {
+        RXMESH_ERROR("import_ply_flat() missing end_header in {}", file_name);
+        return false;
+    }
+
+    const bool swap = (format == Format::BINARY_LE && !is_little_endian()) ||
+                      (format == Format::BINARY_BE && is_little_endian());
+
+    size_t num_v = 0;
+
+    // 2) body
+    for (const auto& el : elements) {
+        const bool is_vertex = (el.name == "vertex");
+        const bool is_face   = (el.name == "face");
+
+        // property index of x, y, z in vertex or the indices list in face
+        int xyz[3]     = {-1, -1, -1};
+        int list_index = -1;
+        for (int i = 0; i < static_cast<int>(el.props.size()); ++i) {
+            const auto& name = el.props[i].name;
+            if (is_vertex && !el.props[i].is_list) {
+                if (name == "x") {
+                    xyz[0] = i;
+                } else if (name == "y") {
+                    xyz[1] = i;
+                } else if (name == "z") {
+                    xyz[2] = i;
+                }
+            }
+            if (is_face && el.props[i].is_list &&
+                (name == "vertex_indices" || name == "vertex_index")) {
+                list_index = i;
+            }
+        }
+
+        if (is_vertex) {
+            if (xyz[0] < 0 || xyz[1] < 0 || xyz[2] < 0) {
+                RXMESH_ERROR(
+                    "import_ply_flat() vertex element does not have x, y, and "
+                    "z properties in {}",
+                    file_name);
+                return false;
+            }
+            num_v = el.count;
+            vertices.resize(3 * num_v);
+        }
+        if (is_face) {
+            if (list_index < 0) {
+                RXMESH_ERROR(
+                    "import_ply_flat() face element does not have "
+                    "vertex_indices property in {}",
+                    file_name);
+                return false;
+            }
+            faces.reserve(3 * el.count);
+            face_offset.resize(el.count + 1);
+        }
+
+        if (format == Format::ASCII) {
+            for (size_t item = 0; item < el.count; ++item) {
+                for (int i = 0; i < static_cast<int>(el.props.size()); ++i) {
+                    const auto& pr = el.props[i];
+                    double      val;
+                    size_t      count = 1;
+                    if (pr.is_list) {
+                        if (!ply_read_ascii(p, end, val)) {
+                            RXMESH_ERROR(
+                                "import_ply_flat() unexpected end of data in "
+                                "{}",
+                                file_name);
+                            return false;
+                        }
+                        count = static_cast<size_t>(val);
+                        if (is_face && i == list_index) {
+                            face_offset[item] = static_cast<IndexT>(count);
+                        }
+                    }
+                    for (size_t j = 0; j < count; ++j) {
+                        if (!ply_read_ascii(p, end, val)) {
+                            RXMESH_ERROR(
+                                "import_ply_flat() unexpected end of data in "
+                                "{}",
+                                file_name);
+                            return false;
+                        }
+                        if (is_face && i == list_index) {
+                            faces.push_back(static_cast<IndexT>(val));
+                        }
+                        for (int d = 0; d < 3; ++d) {
+                            if (is_vertex && i == xyz[d]) {
+                                vertices[3 * item + d] =
+                                    static_cast<DataT>(val);
+                            }
+                        }
+                    }
+                }
+            }
+        } else {
+            const size_t stride = el.stride();
+            if (stride > 0) {
+                // fixed size items
+                if (static_cast<size_t>(end - p) < stride * el.count) {
+                    RXMESH_ERROR(
+                        "import_ply_flat() unexpected end of data in {}",
+                        file_name);
+                    return false;
+                }
+                if (is_vertex) {
+                    size_t xyz_offset[3] = {0, 0, 0};
+                    for (int d = 0; d < 3; ++d) {
+                        for (int i = 0; i < xyz[d]; ++i) {
+                            xyz_offset[d] += ply_type_size(el.props[i].type);
+                        }
+                    }
+                    const char* base = p;
+#pragma omp parallel for
+                    for (int64_t v = 0; v < static_cast<int64_t>(el.count);
+                         ++v) {
+                        const char* item = base + v * stride;
+                        for (int d = 0; d < 3; ++d) {
+                            vertices[3 * v + d] =
+                                static_cast<DataT>(ply_read_binary(
+                                    item + xyz_offset[d],
+                                    el.props[xyz[d]].type,
+                                    swap));
+                        }
+                    }
+                }
+                p += stride * el.count;
+            } else {
+                // variable size items
+                for (size_t item = 0; item < el.count; ++item) {
+                    for (int i = 0; i < static_cast<int>(el.props.size());
+                         ++i) {
+                        const auto& pr    = el.props[i];
+                        size_t      count = 1;
+                        if (pr.is_list) {
+                            const size_t cs = ply_type_size(pr.count_type);
+                            if (static_cast<size_t>(end - p) < cs) {
+                                RXMESH_ERROR(
+                                    "import_ply_flat() unexpected end of data "
+                                    "in {}",
+                                    file_name);
+                                return false;
+                            }
+                            count = static_cast<size_t>(
+                                ply_read_binary(p, pr.count_type, swap));
+                            p += cs;
+                            if (is_face && i == list_index) {
+                                face_offset[item] = static_cast<IndexT>(count);
+                            }
+                        }
+                        const size_t ts = ply_type_size(pr.type);
+                        if (static_cast<size_t>(end - p) < ts * count) {
+                            RXMESH_ERROR(
+                                "import_ply_flat() unexpected end of data in "
+                                "{}",
+                                file_name);
+                            return false;
+                        }
+                        for (size_t j = 0; j < count; ++j) {
+                            if (is_face && i == list_index) {
+                                faces.push_back(static_cast<IndexT>(
+                                    ply_read_binary(p, pr.type, swap)));
+                            }
+                            for (int d = 0; d < 3; ++d) {
+                                if (is_vertex && i == xyz[d]) {
+                                    vertices[3 * item + d] = static_cast<DataT>(
+                                        ply_read_binary(p, pr.type, swap));
+                                }
+                            }
+                            p += ts;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    const size_t num_f = face_offset.empty() ? 0 : face_offset.size() - 1;
+    for (size_t f = 0; f < num_f; ++f) {
+        if (face_offset[f] < 3) {
+            RXMESH_ERROR(
+                "import_ply_flat() face with less than 3 vertices in {}",
+                file_name);
+            return false;
+        }
+    }
+
+    if (!check_face_indices(faces, num_v)) {
+        RXMESH_ERROR("import_ply_flat() face index out of range in {}",
+                     file_name);
+        return false;
+    }
+
+    if (!face_offset.empty()) {
+        face_size_to_offset(face_offset);
+    }
+
+    RXMESH_INFO("import_ply_flat() #vertices= {} ", num_v);
+    RXMESH_INFO("import_ply_flat() #faces= {} ", num_f);
+
+    return true;
+}
+
+/**
+ * @brief Read an input mesh from obj or ply file (based on the file extension)
+ * into flat arrays. See import_obj_flat and import_ply_flat
+ * @return true if reading the file is successful
+ */
+template <typename DataT, typename IndexT>
+bool import_mesh(const std::string    file_name,
+                 std::vector<DataT>&  vertices,
+                 std::vector<IndexT>& faces,
+                 std::vector<IndexT>& face_offset)
+{
+    std::string ext = file_name.substr(file_name.find_last_of('.') + 1);
+    std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) {
+        return static_cast<char>(std::tolower(c));
+    });
+
+    if (ext == "obj") {
+        return import_obj_flat(file_name, vertices, faces, face_offset);
+    } else if (ext == "ply") {
+        return import_ply_flat(file_name, vertices, faces, face_offset);
+    }
+
+    RXMESH_ERROR("import_mesh() unsupported file format {}", file_name);
+    return false;
+}
+
+/**
+ * @brief Read an input mesh from obj or ply file (based on the file extension)
+ * into per-vertex and per-face vectors. The file is parsed with import_mesh
+ * into flat arrays first and then converted
+ * @tparam DataT coordinates type (float/double)
+ * @tparam IndexT indices type
+ * @param file_name path to the obj/ply file
+ * @param vertices 3d vertices (3*#vertices)
+ * @param faces face index to the Vert array (3*#faces)
+ * @return true if reading the file is successful
+ */
+template <typename DataT, typename IndexT>
+bool import_mesh(const std::string                 file_name,
+                 std::vector<std::vector<DataT>>&  vertices,
+                 std::vector<std::vector<IndexT>>& faces)
+{
+    std::vector<DataT>  flat_v;
+    std::vector<IndexT> flat_f, face_offset;
+
+    if (!import_mesh(file_name, flat_v, flat_f, face_offset)) {
+        return false;
+    }
+
+    const int64_t num_v = static_cast<int64_t>(flat_v.size() / 3);
+    const int64_t num_f = face_offset.empty() ?
+                              static_cast<int64_t>(flat_f.size() / 3) :
+                              static_cast<int64_t>(face_offset.size() - 1);
+
+    vertices.resize(num_v);
+    faces.resize(num_f);
+
+#pragma omp parallel for
+    for (int64_t v = 0; v < num_v; ++v) {
+        vertices[v].assign(flat_v.begin() + 3 * v, flat_v.begin() + 3 * v + 3);
+    }
+
+#pragma omp parallel for
+    for (int64_t f = 0; f < num_f; ++f) {
+        const int64_t s = face_offset.empty() ? 3 * f : face_offset[f];
+        const int64_t e = face_offset.empty() ? 3 * f + 3 : face_offset[f + 1];
+        faces[f].assign(flat_f.begin() + s, flat_f.begin() + e);
+    }
+
+    return true;
+}
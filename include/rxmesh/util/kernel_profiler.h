@@ -0,0 +1,555 @@
+#pragma once
+
+#include <cuda_runtime_api.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <string>
+#include <typeinfo>
+#include <vector>
+
+#if defined(__GNUC__)
+#include <cxxabi.h>
+#endif
+
+#include "rxmesh/util/log.h"
+#include "rxmesh/util/macros.h"
+#ifdef __NVCC__
+#include "rxmesh/util/cuda_query.h"
+#endif
+
+namespace rxmesh {
+
+/**
+ * @brief the accumulated profile of all launches of one kernel (i.e., one
+ * kernel/lambda type launched through one API with the same query operations)
+ */
+struct KernelProfile
+{
+    // the user label (see RXMeshStatic::set_profile_label()) or the demangled
+    // kernel/lambda type name
+    std::string name;
+    // the launching API e.g., for_each_vertex or run_query_kernel
+    std::string api;
+    // the query operations (empty for for_each_*)
+    std::string ops;
+
+    uint32_t num_launches = 0;
+    double   total_ms     = 0;
+    double   min_ms       = std::numeric_limits<double>::max();
+    double   max_ms       = 0;
+
+    // launch configuration of the last launch
+    uint32_t blocks         = 0;
+    uint32_t threads        = 0;
+    size_t   smem_bytes_dyn = 0;
+
+    // from cudaFuncGetAttributes()
+    size_t smem_bytes_static = 0;
+    int    num_regs          = -1;
+
+    // theoretical occupancy of the first launch, i.e., the resident warps
+    // per SM over the maximum (from the occupancy calculator). -1 if unknown
+    double occupancy = -1;
+
+    // estimated global memory traffic of all launches, i.e., the patch
+    // topology read by the queries plus the user estimate of the attribute
+    // traffic (see KernelCost). Without KernelCost, it is only a lower bound
+    size_t bytes = 0;
+
+    // the user estimate of the floating-point operations of all launches (see
+    // KernelCost)
+    double flops = 0;
+
+    double avg_ms() const
+    {
+        return num_launches == 0 ? 0 : total_ms / double(num_launches);
+    }
+
+    // GB/s based on bytes and total_ms
+    double bandwidth() const
+    {
+        return total_ms <= 0 ? 0 : double(bytes) / (total_ms * 1.0e6);
+    }
+
+    // GFLOP/s based on flops and total_ms
+    double gflops() const
+    {
+        return total_ms <= 0 ? 0 : flops / (total_ms * 1.0e6);
+    }
+
+    // FLOP per byte
+    double arithmetic_intensity() const
+    {
+        return bytes == 0 ? 0 : flops / double(bytes);
+    }
+};
+
+/**
+ * @brief the user estimate of the global memory traffic and the
+ * floating-point operations of a kernel per processed element, i.e., per
+ * vertex/edge/face for for_each_* and per source element of the (first)
+ * query operation otherwise (see RXMeshStatic::set_profile_cost()). With
+ * it, the kernel can be placed on the roofline
+ */
+struct KernelCost
+{
+    double bytes_per_element = 0;
+    double flops_per_element = 0;
+};
+
+/**
+ * @brief what limits a kernel on the roofline
+ */
+enum class KernelBound
+{
+    // no FLOP or byte estimate
+    Unknown   = 0,
+    // far below the roofline, i.e., neither the bandwidth nor the compute is
+    // saturated (e.g., too few threads, synchronization, or long dependency
+    // chains)
+    Latency   = 1,
+    // left of the ridge point and close to the bandwidth roof
+    Bandwidth = 2,
+    // right of the ridge point and close to the compute roof
+    Compute   = 3,
+};
+
+inline std::string bound_to_string(const KernelBound b)
+{
+    switch (b) {
+        case KernelBound::Latency:
+            return "latency";
+        case KernelBound::Bandwidth:
+            return "bandwidth";
+        case KernelBound::Compute:
+            return "compute";
+        default:
+            return "unknown";
+    }
+}
+
+/**
+ * @brief the roofline model of a device, i.e., the peak DRAM bandwidth and
+ * the peak FP32 throughput (FMA on all CUDA cores at the max clock)
+ */
+struct Roofline
+{
+    double peak_bandwidth = 0;  // GB/s
+    double peak_gflops    = 0;  // GFLOP/s
+
+    Roofline() = default;
+
+    Roofline(double bandwidth, double gflops)
+        : peak_bandwidth(bandwidth), peak_gflops(gflops)
+    {
+    }
+
+#ifdef __NVCC__
+    /**
+     * @brief the roofline of the current device
+     */
+    static Roofline current_device()
+    {
+        int device_id = 0;
+        CUDA_ERROR(cudaGetDevice(&device_id));
+        cudaDeviceProp prop;
+        CUDA_ERROR(cudaGetDeviceProperties(&prop, device_id));
+
+        const double bw =
+            2.0 * prop.memoryClockRate * (prop.memoryBusWidth / 8.0) / 1.0E6;
+        const double gflops =
+            2.0 * prop.multiProcessorCount *
+            convert_SMV_to_cores(prop.major, prop.minor) * prop.clockRate *
+            1.0E-6;
+        return Roofline(bw, gflops);
+    }
+#endif
+
+    // the arithmetic intensity (FLOP/byte) where the roofs meet
+    double ridge_point() const
+    {
+        return peak_bandwidth <= 0 ? 0 : peak_gflops / peak_bandwidth;
+    }
+
+    // the attainable GFLOP/s at an arithmetic intensity
+    double attainable_gflops(double intensity) const
+    {
+        return std::min(peak_gflops, intensity * peak_bandwidth);
+    }
+
+    /**
+     * @brief the fraction of its roof that the kernel achieves (the bandwidth
+     * roof for kernels without a FLOP estimate)
+     */
+    double efficiency(const KernelProfile& p) const
+    {
+        if (p.flops > 0 && p.bytes > 0) {
+            const double roof = attainable_gflops(p.arithmetic_intensity());
+            return roof <= 0 ? 0 : p.gflops() / roof;
+        }
+        if (p.bytes > 0) {
+            return peak_bandwidth <= 0 ? 0 : p.bandwidth() / peak_bandwidth;
+        }
+        return 0;
+    }
+
+    /**
+     * @brief classify the kernel. Kernels that achieve less than
+     * latency_fraction of their roof are latency bound. Otherwise, they are
+     * bound by the roof on their side of the ridge point
+     */
+    KernelBound classify(const KernelProfile& p,
+                         const double         latency_fraction = 0.2) const
+    {
+        if (p.bytes == 0 || p.total_ms <= 0) {
+            return KernelBound::Unknown;
+        }
+        if (efficiency(p) < latency_fraction) {
+            return KernelBound::Latency;
+        }
+        return p.arithmetic_intensity() < ridge_point() ?
+                   KernelBound::Bandwidth :
+                   KernelBound::Compute;
+    }
+};
+
+/**
+ * @brief times every launch with a pair of events. Like DeferredGPUTimer, the
+ * launches are not synchronized; the events of the pending launches are
+ * resolved without blocking once enough of them are pending and with blocking
+ * when the profile is queried with get_profiles(). Events are recycled
+ */
+class KernelProfiler
+{
+   public:
+    KernelProfiler() = default;
+
+    KernelProfiler(const KernelProfiler&)            = delete;
+    KernelProfiler& operator=(const KernelProfiler&) = delete;
+
+    ~KernelProfiler()
+    {
+        for (auto& p : m_pending) {
+            m_free_events.push_back(p.start);
+            m_free_events.push_back(p.stop);
+        }
+        for (cudaEvent_t e : m_free_events) {
+            CUDA_ERROR(cudaEventDestroy(e));
+        }
+    }
+
+    /**
+     * @brief time one launch
+     * @param api the launching API
+     * @param type the kernel/lambda type used to identify the kernel
+     * @param label if not empty, used as the kernel name instead of type
+     * @param ops the query operations as string
+     * @param blocks number of blocks
+     * @param threads number of threads per block
+     * @param smem_bytes_dyn dynamic shared memory per block
+     * @param kernel the kernel function (for the registers and static
+     * shared memory). Could be nullptr
+     * @param bytes the estimated bytes moved by the launch
+     * @param flops the estimated floating-point operations of the launch
+     * @param stream the stream of the launch
+     * @param launch the function that launches the kernel(s) on stream
+     */
+    template <typename LaunchT>
+    void launch(const std::string&    api,
+                const std::type_info& type,
+                const std::string&    label,
+                const std::string&    ops,
+                uint32_t              blocks,
+                uint32_t              threads,
+                size_t                smem_bytes_dyn,
+                const void*           kernel,
+                size_t                bytes,
+                double                flops,
+                cudaStream_t          stream,
+                LaunchT               launch_fn)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        // kernels passed as function pointers share the same type so the
+        // kernel address is part of the key
+        const std::string key =
+            api + "|" + ops + "|" + label + "|" + std::string(type.name()) +
+            "|" + std::to_string(reinterpret_cast<uintptr_t>(kernel));
+
+        auto it = m_profiles.find(key);
+        if (it == m_profiles.end()) {
+            KernelProfile prof;
+            prof.name = label.empty() ? kernel_name(type, kernel) : label;
+            prof.api  = api;
+            prof.ops  = ops;
+            if (kernel != nullptr) {
+                cudaFuncAttributes attr;
+                if (cudaFuncGetAttributes(&attr, kernel) == cudaSuccess) {
+                    prof.num_regs          = attr.numRegs;
+                    prof.smem_bytes_static = attr.sharedSizeBytes;
+                }
+                prof.occupancy = occupancy(kernel, threads, smem_bytes_dyn);
+            }
+            it = m_profiles.emplace(key, prof).first;
+        }
+
+        it->second.blocks         = blocks;
+        it->second.threads        = threads;
+        it->second.smem_bytes_dyn = smem_bytes_dyn;
+        it->second.bytes += bytes;
+        it->second.flops += flops;
+
+        Pending p;
+        p.key   = &it->first;
+        p.start = get_event();
+        p.stop  = get_event();
+
+        CUDA_ERROR(cudaEventRecord(p.start, stream));
+        launch_fn();
+        CUDA_ERROR(cudaEventRecord(p.stop, stream));
+
+        m_pending.push_back(p);
+
+        if (m_pending.size() >= max_pending) {
+            resolve(false);
+        }
+    }
+
+    /**
+     * @brief wait for all pending launches and return the profiles sorted by
+     * the total time (descending)
+     */
+    std::vector<KernelProfile> get_profiles()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        resolve(true);
+
+        std::vector<KernelProfile> ret;
+        ret.reserve(m_profiles.size());
+        for (const auto& p : m_profiles) {
+            ret.push_back(p.second);
+        }
+        std::sort(ret.begin(),
+                  ret.end(),
+                  [](const KernelProfile& a, const KernelProfile& b) {
+                      return a.total_ms > b.total_ms;
+                  });
+        return ret;
+    }
+
+    /**
+     * @brief print the profiles as a table along with their place on the
+     * roofline of the current device
+     */
+    void print_summary()
+    {
+        const std::vector<KernelProfile> profs = get_profiles();
+
+        Roofline roof;
+#ifdef __NVCC__
+        roof = Roofline::current_device();
+#endif
+
+        double total = 0;
+        for (const auto& p : profs) {
+            total += p.total_ms;
+        }
+
+        RXMESH_INFO(
+            "Kernel profile ({} kernels, {} ms total, peak {:.1f} GB/s, "
+            "{:.1f} GFLOP/s):",
+            profs.size(),
+            total,
+            roof.peak_bandwidth,
+            roof.peak_gflops);
+        RXMESH_INFO(
+            "{:>10} {:>6} {:>10} {:>10} {:>9} {:>6} {:>5} {:>8} {:>8} {:>5} "
+            "{:>8} {:>9} {:<9} {:<18} {:<10} {}",
+            "total(ms)",
+            "%",
+            "#launch",
+            "avg(ms)",
+            "blocks",
+            "thrds",
+            "regs",
+            "dyn-smem",
+            "st-smem",
+            "occ",
+            "GB/s",
+            "GFLOP/s",
+            "bound",
+            "api",
+            "ops",
+            "name");
+        for (const auto& p : profs) {
+            RXMESH_INFO(
+                "{:>10.3f} {:>6.2f} {:>10} {:>10.4f} {:>9} {:>6} {:>5} {:>8} "
+                "{:>8} {:>5.2f} {:>8.2f} {:>9.2f} {:<9} {:<18} {:<10} {}",
+                p.total_ms,
+                total > 0 ? 100.0 * p.total_ms / total : 0.0,
+                p.num_launches,
+                p.avg_ms(),
+                p.blocks,
+                p.threads,
+                p.num_regs,
+                p.smem_bytes_dyn,
+                p.smem_bytes_static,
+                p.occupancy,
+                p.bandwidth(),
+                p.gflops(),
+                roof.peak_bandwidth > 0 ? bound_to_string(roof.classify(p)) :
+                                          bound_to_string(KernelBound::Unknown),
+                p.api,
+                p.ops,
+                short_name(p.name));
+        }
+    }
+
+    /**
+     * @brief drop all profiles (after waiting for the pending launches)
+     */
+    void reset()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        resolve(true);
+        m_profiles.clear();
+    }
+
+   private:
+    struct Pending
+    {
+        const std::string* key;
+        cudaEvent_t        start;
+        cudaEvent_t        stop;
+    };
+
+    static constexpr size_t max_pending = 256;
+
+    /**
+     * @brief the theoretical occupancy of the kernel with this launch
+     * configuration. -1 if it can not be computed
+     */
+    double occupancy(const void* kernel, uint32_t threads, size_t smem)
+    {
+        if (m_max_threads_per_sm == 0) {
+            int device_id = 0;
+            CUDA_ERROR(cudaGetDevice(&device_id));
+            CUDA_ERROR(cudaDeviceGetAttribute(
+                &m_max_threads_per_sm,
+                cudaDevAttrMaxThreadsPerMultiProcessor,
+                device_id));
+        }
+        int num_blocks = 0;
+        if (threads == 0 || m_max_threads_per_sm <= 0 ||
+            cudaOccupancyMaxActiveBlocksPerMultiprocessor(
+                &num_blocks, kernel, int(threads), smem) != cudaSuccess) {
+            // clear the error of the occupancy calculator
+            cudaGetLastError();
+            return -1;
+        }
+        return double(num_blocks) * double(threads) /
+               double(m_max_threads_per_sm);
+    }
+
+    cudaEvent_t get_event()
+    {
+        if (m_free_events.empty()) {
+            cudaEvent_t e;
+            CUDA_ERROR(cudaEventCreate(&e));
+            return e;
+        }
+        cudaEvent_t e = m_free_events.back();
+        m_free_events.pop_back();
+        return e;
+    }
+
+    /**
+     * @brief accumulate the pending launches in order. If blocking is false,
+     * stop at the first launch that has not completed
+     */
+    void resolve(bool blocking)
+    {
+        size_t done = 0;
+        for (; done < m_pending.size(); ++done) {
+            const Pending& p = m_pending[done];
+            if (blocking) {
+                CUDA_ERROR(cudaEventSynchronize(p.stop));
+            } else {
+                cudaError_t status = cudaEventQuery(p.stop);
+                if (status == cudaErrorNotReady) {
+                    break;
+                }
+                CUDA_ERROR(status);
+            }
+
+            float ms = 0;
+            CUDA_ERROR(cudaEventElapsedTime(&ms, p.start, p.stop));
+
+            KernelProfile& prof = m_profiles.at(*p.key);
+            prof.num_launches++;
+            prof.total_ms += ms;
+            prof.min_ms = std::min(prof.min_ms, double(ms));
+            prof.max_ms = std::max(prof.max_ms, double(ms));
+
+            m_free_events.push_back(p.start);
+            m_free_events.push_back(p.stop);
+        }
+        m_pending.erase(m_pending.begin(), m_pending.begin() + done);
+    }
+
+    /**
+     * @brief the (demangled) kernel name if the runtime can provide it.
+     * Otherwise, the type name
+     */
+    static std::string kernel_name(const std::type_info& type,
+                                   const void*           kernel)
+    {
+#if CUDART_VERSION >= 12030
+        if (kernel != nullptr) {
+            const char* name = nullptr;
+            if (cudaFuncGetName(&name, kernel) == cudaSuccess &&
+                name != nullptr) {
+                return demangle(name);
+            }
+        }
+#endif
+        return demangle(type.name());
+    }
+
+    static std::string demangle(const char* name)
+    {
+#if defined(__GNUC__)
+        int   status = 0;
+        char* res    = abi::__cxa_demangle(name, nullptr, nullptr, &status);
+        if (status == 0 && res != nullptr) {
+            std::string ret(res);
+            free(res);
+            return ret;
+        }
+#endif
+        return std::string(name);
+    }
+
+    // lambda type names are long. Keep the beginning (usually the enclosing
+    // function) for the table
+    static std::string short_name(const std::string& name)
+    {
+        constexpr size_t max_len = 96;
+        if (name.size() <= max_len) {
+            return name;
+        }
+        return name.substr(0, max_len) + "...";
+    }
+
+    std::map<std::string, KernelProfile> m_profiles;
+    std::vector<Pending>                 m_pending;
+    std::vector<cudaEvent_t>             m_free_events;
+    std::mutex                           m_mutex;
+    int                                  m_max_threads_per_sm = 0;
+};
+}  // namespace rxmesh
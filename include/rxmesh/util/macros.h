@@ -203,11 +203,12 @@ inline void cudssHandleError(cudssStatus_t status,
 #endif
 
 
-// GPU_FREE
-#define GPU_FREE(ptr)              \
-    if (ptr != nullptr) {          \
-        CUDA_ERROR(cudaFree(ptr)); \
-        ptr = nullptr;             \
+// GPU_FREE (frees memory allocated with cudaMalloc or tracked_malloc() and
+// updates the accounting of DeviceMemory)
+#define GPU_FREE(ptr)                            \
+    if (ptr != nullptr) {                        \
+        CUDA_ERROR(::rxmesh::tracked_free(ptr)); \
+        ptr = nullptr;                           \
     }
 
 // Taken from https://stackoverflow.com/a/12779757/1608232
@@ -227,4 +228,7 @@ inline void cudssHandleError(cudssStatus_t status,
 #define IS_D_LAMBDA(X) __nv_is_extended_device_lambda_closure_type(X)
 #define IS_HD_LAMBDA(X) __nv_is_extended_host_device_lambda_closure_type(X)
 
-}  // namespace rxmesh
\ No newline at end of file
+}  // namespace rxmesh
+
+// after the namespace since it uses the macros above
+#include "rxmesh/util/device_memory.h"
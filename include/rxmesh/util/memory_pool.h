@@ -0,0 +1,241 @@
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+#include <limits>
+
+#include <cuda_runtime_api.h>
+
+#include "rxmesh/util/log.h"
+#include "rxmesh/util/macros.h"
+#include "rxmesh/util/out_of_core.h"
+
+namespace rxmesh {
+
+/**
+ * @brief Statistics of a MemoryPool as returned by MemoryPool::get_stats()
+ */
+struct MemoryPoolStats
+{
+    // number of allocations and deallocations done through the pool
+    uint64_t num_allocations   = 0;
+    uint64_t num_deallocations = 0;
+
+    // number of allocations that were served from memory already reserved by
+    // the pool i.e., without allocating new device memory
+    uint64_t num_reused = 0;
+
+    // memory currently used by (and the high water mark of) live allocations
+    uint64_t used_bytes      = 0;
+    uint64_t used_high_bytes = 0;
+
+    // memory currently reserved by the pool (and its high water mark) which
+    // includes freed memory cached for reuse
+    uint64_t reserved_bytes      = 0;
+    uint64_t reserved_high_bytes = 0;
+
+    void print() const
+    {
+        RXMESH_INFO(
+            "MemoryPool: {} allocations ({} reused), {} deallocations, used = "
+            "{} (MB) (high water mark = {} (MB)), reserved = {} (MB) (high "
+            "water mark = {} (MB))",
+            num_allocations,
+            num_reused,
+            num_deallocations,
+            BYTES_TO_MEGABYTES(used_bytes),
+            BYTES_TO_MEGABYTES(used_high_bytes),
+            BYTES_TO_MEGABYTES(reserved_bytes),
+            BYTES_TO_MEGABYTES(reserved_high_bytes));
+    }
+};
+
+/**
+ * @brief Stream-ordered device memory pool (built on cudaMallocFromPoolAsync)
+ * that backs the device memory of attributes and dense matrices created from
+ * a mesh. Freed memory is kept in the pool and reused by later allocations
+ * instead of being returned to the driver, so that adding and removing
+ * temporary attributes does not call cudaMalloc/cudaFree (and cudaFree does not
+ * synchronize the device). The pool is disabled (and falls back to
+ * device_malloc()) if the device does not support memory pools or if RXMesh
+ * is compiled with USE_OUT_OF_CORE since pools can not hold managed memory.
+ * The pool is created on the current device. Destroying the pool while there
+ * are outstanding allocations defers releasing its memory until they are freed
+ */
+class MemoryPool
+{
+   public:
+    MemoryPool() : m_pool(nullptr), m_enabled(false)
+    {
+#ifndef USE_OUT_OF_CORE
+        int device, supported = 0;
+        CUDA_ERROR(cudaGetDevice(&device));
+        CUDA_ERROR(cudaDeviceGetAttribute(
+            &supported, cudaDevAttrMemoryPoolsSupported, device));
+
+        if (supported) {
+            cudaMemPoolProps props = {};
+            props.allocType        = cudaMemAllocationTypePinned;
+            props.location.type    = cudaMemLocationTypeDevice;
+            props.location.id      = device;
+            CUDA_ERROR(cudaMemPoolCreate(&m_pool, &props));
+
+            // keep the freed memory in the pool on synchronization
+            uint64_t threshold = std::numeric_limits<uint64_t>::max();
+            CUDA_ERROR(cudaMemPoolSetAttribute(
+                m_pool, cudaMemPoolAttrReleaseThreshold, &threshold));
+
+            m_enabled = true;
+        }
+#endif
+    }
+
+    MemoryPool(const MemoryPool&)            = delete;
+    MemoryPool& operator=(const MemoryPool&) = delete;
+
+    ~MemoryPool()
+    {
+        if (m_pool != nullptr) {
+            CUDA_ERROR(cudaMemPoolDestroy(m_pool));
+        }
+    }
+
+    /**
+     * @brief check if allocation goes through the pool or is forwarded to
+     * device_malloc()
+     */
+    bool is_enabled() const
+    {
+        return m_enabled;
+    }
+
+    /**
+     * @brief allocate num_bytes of device memory ordered on the stream. The
+     * memory is usable by work issued on the stream after this call (or any
+     * other stream after synchronizing with it). The memory is accounted
+     * under the category (see DeviceMemory)
+     */
+    cudaError_t allocate(
+        void**               ptr,
+        const size_t         num_bytes,
+        cudaStream_t         stream = NULL,
+        const MemoryCategory cat    = MemoryCategory::Attribute)
+    {
+        if (!m_enabled) {
+            return device_malloc(ptr, num_bytes, cat);
+        }
+
+        if (!DeviceMemory::get().reserve(num_bytes, cat)) {
+            *ptr = nullptr;
+            return cudaErrorMemoryAllocation;
+        }
+
+        const uint64_t reserved =
+            get_attribute(cudaMemPoolAttrReservedMemCurrent);
+
+        cudaError_t err =
+            cudaMallocFromPoolAsync(ptr, num_bytes, m_pool, stream);
+
+        if (err == cudaSuccess) {
+            DeviceMemory::get().record(*ptr, num_bytes, cat);
+            m_num_allocations++;
+            if (get_attribute(cudaMemPoolAttrReservedMemCurrent) == reserved) {
+                m_num_reused++;
+            }
+        } else {
+            DeviceMemory::get().unreserve(num_bytes, cat);
+        }
+        return err;
+    }
+
+    /**
+     * @brief return memory allocated with allocate() to the pool ordered on
+     * the stream
+     */
+    void deallocate(void* ptr, cudaStream_t stream = NULL)
+    {
+        if (ptr != nullptr) {
+            m_num_deallocations++;
+            free(ptr, m_enabled, stream);
+        }
+    }
+
+    /**
+     * @brief free memory allocated by a pool (if pooled is true) or by
+     * device_malloc(). This does not require the pool object to be alive
+     */
+    static void free(void* ptr, bool pooled, cudaStream_t stream = NULL)
+    {
+        if (ptr == nullptr) {
+            return;
+        }
+        if (pooled) {
+            DeviceMemory::get().release(ptr);
+            CUDA_ERROR(cudaFreeAsync(ptr, stream));
+        } else {
+            CUDA_ERROR(tracked_free(ptr));
+        }
+    }
+
+    /**
+     * @brief release the memory cached in the pool to the driver such that
+     * the pool keeps at least min_bytes_to_keep of reserved memory
+     */
+    void trim(const size_t min_bytes_to_keep = 0)
+    {
+        if (m_enabled) {
+            CUDA_ERROR(cudaDeviceSynchronize());
+            CUDA_ERROR(cudaMemPoolTrimTo(m_pool, min_bytes_to_keep));
+        }
+    }
+
+    /**
+     * @brief get the pool statistics. The memory usage is only reported if
+     * the pool is enabled
+     */
+    MemoryPoolStats get_stats() const
+    {
+        MemoryPoolStats stats;
+        stats.num_allocations   = m_num_allocations;
+        stats.num_deallocations = m_num_deallocations;
+        stats.num_reused        = m_num_reused;
+        if (m_enabled) {
+            stats.used_bytes = get_attribute(cudaMemPoolAttrUsedMemCurrent);
+            stats.used_high_bytes = get_attribute(cudaMemPoolAttrUsedMemHigh);
+            stats.reserved_bytes =
+                get_attribute(cudaMemPoolAttrReservedMemCurrent);
+            stats.reserved_high_bytes =
+                get_attribute(cudaMemPoolAttrReservedMemHigh);
+        }
+        return stats;
+    }
+
+    /**
+     * @brief reset the high water marks of the used and reserved memory
+     */
+    void reset_high_water_mark()
+    {
+        if (m_enabled) {
+            uint64_t zero = 0;
+            CUDA_ERROR(cudaMemPoolSetAttribute(
+                m_pool, cudaMemPoolAttrUsedMemHigh, &zero));
+            CUDA_ERROR(cudaMemPoolSetAttribute(
+                m_pool, cudaMemPoolAttrReservedMemHigh, &zero));
+        }
+    }
+
+   private:
+    uint64_t get_attribute(cudaMemPoolAttr attr) const
+    {
+        uint64_t val = 0;
+        CUDA_ERROR(cudaMemPoolGetAttribute(m_pool, attr, &val));
+        return val;
+    }
+
+    cudaMemPool_t         m_pool;
+    bool                  m_enabled;
+    std::atomic<uint64_t> m_num_allocations{0};
+    std::atomic<uint64_t> m_num_deallocations{0};
+    std::atomic<uint64_t> m_num_reused{0};
+};
+}  // namespace rxmesh
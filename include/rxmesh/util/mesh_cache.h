@@ -0,0 +1,83 @@
+#pragma once
+
+#include <stdint.h>
+#include <cstdio>
+#include <filesystem>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "rxmesh/util/log.h"
+#include "rxmesh/util/util.h"
+
+namespace rxmesh {
+
+/**
+ * @brief version of the binary mesh cache format. Bump this whenever the
+ * content written by RXMesh::save_cache changes so stale caches are rebuilt
+ * instead of being misread
+ */
+constexpr uint32_t MESH_CACHE_VERSION = 1;
+
+/**
+ * @brief magic number written at the start of every mesh cache file
+ */
+constexpr uint32_t MESH_CACHE_MAGIC = 0x48534D52u;  // "RMSH"
+
+/**
+ * @brief compute a 64-bit FNV-1a hash of a file's content. The file is read in
+ * large chunks without any parsing so this is a small fraction of the cost of
+ * importing the mesh
+ * @param file_path path to the file to hash
+ * @return the hash value or 0 if the file could not be opened
+ */
+inline uint64_t hash_file(const std::string& file_path)
+{
+    FILE* file = fopen(file_path.c_str(), "rb");
+    if (file == NULL) {
+        RXMESH_ERROR("hash_file() can not open {}", file_path);
+        return 0;
+    }
+
+    constexpr uint64_t fnv_offset = 14695981039346656037ull;
+    constexpr uint64_t fnv_prime  = 1099511628211ull;
+
+    uint64_t hash = fnv_offset;
+
+    std::vector<unsigned char> buffer(1 << 20);
+    size_t                     num_read = 0;
+    while ((num_read = fread(buffer.data(), 1, buffer.size(), file)) > 0) {
+        for (size_t i = 0; i < num_read; ++i) {
+            hash ^= static_cast<uint64_t>(buffer[i]);
+            hash *= fnv_prime;
+        }
+    }
+    fclose(file);
+
+    return hash;
+}
+
+/**
+ * @brief return the path of the cache file of an input mesh. The cache file
+ * name is derived from the input file name, its content hash, and the
+ * parameters that change the patching so that changing any of them leads to
+ * a different cache file
+ * @param cache_dir the directory where cache files are stored
+ * @param file_path path to the input mesh
+ * @param patch_size the patch size used to partition the mesh
+ * @param use_metis if METIS is used for patching
+ */
+inline std::string mesh_cache_file_name(const std::string& cache_dir,
+                                        const std::string& file_path,
+                                        const uint32_t     patch_size,
+                                        const bool         use_metis)
+{
+    std::stringstream ss;
+    ss << extract_file_name(file_path) << "_" << std::hex
+       << hash_file(file_path) << std::dec << "_p" << patch_size
+       << (use_metis ? "_metis" : "") << "_v" << MESH_CACHE_VERSION
+       << ".rxcache";
+
+    return (std::filesystem::path(cache_dir) / ss.str()).string();
+}
+}  // namespace rxmesh
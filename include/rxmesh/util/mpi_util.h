@@ -0,0 +1,65 @@
+#pragma once
+
+#ifdef USE_MPI
+
+#include <stdint.h>
+#include <type_traits>
+
+#include <mpi.h>
+
+#include "rxmesh/util/log.h"
+
+namespace rxmesh {
+
+#ifndef MPI_ERROR
+inline void mpiHandleError(int err, const char* file, int line)
+{
+    if (err != MPI_SUCCESS) {
+        char msg[MPI_MAX_ERROR_STRING];
+        int  len = 0;
+        MPI_Error_string(err, msg, &len);
+        Log::get_logger()->error("Line {} File {}", line, file);
+        Log::get_logger()->error("MPI ERROR: {}", msg);
+
+        MPI_Abort(MPI_COMM_WORLD, err);
+    }
+}
+#define MPI_ERROR(err) (mpiHandleError(err, __FILE__, __LINE__))
+#endif
+
+/**
+ * @brief the MPI datatype that matches the arithmetic type T
+ */
+template <typename T>
+inline MPI_Datatype mpi_datatype()
+{
+    if constexpr (std::is_same_v<T, float>) {
+        return MPI_FLOAT;
+    } else if constexpr (std::is_same_v<T, double>) {
+        return MPI_DOUBLE;
+    } else if constexpr (std::is_same_v<T, int8_t>) {
+        return MPI_INT8_T;
+    } else if constexpr (std::is_same_v<T, uint8_t>) {
+        return MPI_UINT8_T;
+    } else if constexpr (std::is_same_v<T, int16_t>) {
+        return MPI_INT16_T;
+    } else if constexpr (std::is_same_v<T, uint16_t>) {
+        return MPI_UINT16_T;
+    } else if constexpr (std::is_same_v<T, int32_t>) {
+        return MPI_INT32_T;
+    } else if constexpr (std::is_same_v<T, uint32_t>) {
+        return MPI_UINT32_T;
+    } else if constexpr (std::is_same_v<T, int64_t>) {
+        return MPI_INT64_T;
+    } else if constexpr (std::is_same_v<T, uint64_t>) {
+        return MPI_UINT64_T;
+    } else if constexpr (std::is_same_v<T, bool>) {
+        return MPI_CXX_BOOL;
+    } else {
+        static_assert(sizeof(T) == 0, "mpi_datatype() unsupported type");
+        return MPI_BYTE;
+    }
+}
+}  // namespace rxmesh
+
+#endif
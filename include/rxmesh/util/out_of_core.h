@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cuda_runtime_api.h>
+#include <stddef.h>
+
+#include "rxmesh/util/device_memory.h"
+#include "rxmesh/util/macros.h"
+
+namespace rxmesh {
+
+/**
+ * @brief allocate device memory used by the mesh topology and attributes. If
+ * RXMesh is compiled with USE_OUT_OF_CORE, this is managed memory whose
+ * preferred location is the host memory such that the mesh could be larger
+ * than the device memory. Pages are migrated to the device on demand or ahead
+ * of time with prefetch_to_device() and are evicted back to the host under
+ * memory pressure. Otherwise, this is just tracked_malloc(). Either way, the
+ * memory is accounted under the category (see DeviceMemory)
+ */
+inline cudaError_t device_malloc(
+    void**               ptr,
+    const size_t         num_bytes,
+    const MemoryCategory cat = MemoryCategory::Topology)
+{
+#ifdef USE_OUT_OF_CORE
+    if (!DeviceMemory::get().reserve(num_bytes, cat)) {
+        *ptr = nullptr;
+        return cudaErrorMemoryAllocation;
+    }
+    cudaError_t err = cudaMallocManaged(ptr, num_bytes);
+    if (err == cudaSuccess && num_bytes > 0) {
+        err = cudaMemAdvise(*ptr,
+                            num_bytes,
+                            cudaMemAdviseSetPreferredLocation,
+                            cudaCpuDeviceId);
+    }
+    if (err == cudaSuccess) {
+        DeviceMemory::get().record(*ptr, num_bytes, cat);
+    } else {
+        DeviceMemory::get().unreserve(num_bytes, cat);
+    }
+    return err;
+#else
+    return tracked_malloc(ptr, num_bytes, cat);
+#endif
+}
+
+/**
+ * @brief asynchronously migrate memory allocated with device_malloc() to the
+ * current device. This is a no-op unless RXMesh is compiled with
+ * USE_OUT_OF_CORE
+ */
+inline void prefetch_to_device(const void*  ptr,
+                               const size_t num_bytes,
+                               cudaStream_t stream = NULL)
+{
+#ifdef USE_OUT_OF_CORE
+    if (ptr != nullptr && num_bytes > 0) {
+        int device;
+        CUDA_ERROR(cudaGetDevice(&device));
+        CUDA_ERROR(cudaMemPrefetchAsync(ptr, num_bytes, device, stream));
+    }
+#endif
+}
+
+/**
+ * @brief asynchronously migrate memory allocated with device_malloc() back to
+ * the host memory to free device memory. This is a no-op unless RXMesh is
+ * compiled with USE_OUT_OF_CORE
+ */
+inline void evict_to_host(const void*  ptr,
+                          const size_t num_bytes,
+                          cudaStream_t stream = NULL)
+{
+#ifdef USE_OUT_OF_CORE
+    if (ptr != nullptr && num_bytes > 0) {
+        CUDA_ERROR(
+            cudaMemPrefetchAsync(ptr, num_bytes, cudaCpuDeviceId, stream));
+    }
+#endif
+}
+}  // namespace rxmesh
@@ -10,7 +10,10 @@
 #include <fstream>
 #include <map>
 #include <sstream>
+#include "rxmesh/cavity_stats.h"
 #include "rxmesh/rxmesh.h"
+#include "rxmesh/util/gds_file.h"
+#include "rxmesh/util/kernel_profiler.h"
 #include "rxmesh/util/util.h"
 #ifdef __NVCC__
 #include "cuda.h"
@@ -320,6 +323,143 @@ struct Report
         m_doc.AddMember(key, subdoc, m_doc.GetAllocator());
     }
 
+    // add the cavity statistics of dynamic kernels (e.g., as returned by
+    // RXMeshDynamic::get_cavity_stats())
+    void cavity_stats(const CavityStats& stats,
+                      const std::string  json_member_name = "CavityStats")
+    {
+        rapidjson::Document subdoc(&m_doc.GetAllocator());
+        subdoc.SetObject();
+
+        add_member("num_created", size_t(stats.num_created), subdoc);
+        add_member("num_conflicting", size_t(stats.num_conflicting), subdoc);
+        add_member("num_committed", size_t(stats.num_committed), subdoc);
+        add_member("num_recovered", size_t(stats.num_recovered), subdoc);
+        add_member("wasted_ratio", stats.wasted_ratio(), subdoc);
+        add_member(
+            "num_processed_patches", size_t(stats.num_processed), subdoc);
+        add_member("num_patch_lock_failed",
+                   size_t(stats.num_patch_lock_failed),
+                   subdoc);
+        add_member("num_neighbor_lock_failed",
+                   size_t(stats.num_neighbor_lock_failed),
+                   subdoc);
+        add_member("num_dirty", size_t(stats.num_dirty), subdoc);
+        add_member("num_sliced", size_t(stats.num_sliced), subdoc);
+        add_member("num_pushed", size_t(stats.num_pushed), subdoc);
+
+        rapidjson::Value key(json_member_name.c_str(), subdoc.GetAllocator());
+        m_doc.AddMember(key, subdoc, m_doc.GetAllocator());
+    }
+
+    // add the number of transferred bytes, the time, and the throughput of a
+    // GDSFile e.g., after RXMeshDynamic::save_checkpoint()/load_checkpoint()
+    void file_io(const GDSFile&    file,
+                 const std::string json_member_name = "FileIO")
+    {
+        rapidjson::Document subdoc(&m_doc.GetAllocator());
+        subdoc.SetObject();
+
+        add_member("file", file.get_filename(), subdoc);
+        add_member("mode",
+                   std::string(file.get_mode() == GDSFile::Mode::Write ?
+                                   "write" :
+                                   "read"),
+                   subdoc);
+        add_member("gds", file.is_gds(), subdoc);
+        add_member("num_bytes", file.get_num_bytes(), subdoc);
+        add_member("time_ms", double(file.get_elapsed_millis()), subdoc);
+        add_member("throughput_gbs", file.get_throughput_gbs(), subdoc);
+
+        rapidjson::Value key(json_member_name.c_str(), subdoc.GetAllocator());
+        m_doc.AddMember(key, subdoc, m_doc.GetAllocator());
+    }
+
+    // add the per-kernel profile (see RXMeshStatic::enable_profiling()) as
+    // one sub-object per kernel placed on the roofline of the current device
+    void kernel_profile(KernelProfiler&   profiler,
+                        const std::string json_member_name = "KernelProfile")
+    {
+        Roofline roof;
+#ifdef __NVCC__
+        roof = Roofline::current_device();
+#endif
+        kernel_profile(profiler, roof, json_member_name);
+    }
+
+    // same as above but with the roofline of a given (e.g., measured) device
+    void kernel_profile(KernelProfiler&   profiler,
+                        const Roofline&   roof,
+                        const std::string json_member_name = "KernelProfile")
+    {
+        rapidjson::Document subdoc(&m_doc.GetAllocator());
+        subdoc.SetObject();
+
+        {
+            rapidjson::Document rdoc(&m_doc.GetAllocator());
+            rdoc.SetObject();
+            add_member("peak_bandwidth (GB/s)", roof.peak_bandwidth, rdoc);
+            add_member("peak_fp32 (GFLOP/s)", roof.peak_gflops, rdoc);
+            add_member("ridge_point (FLOP/B)", roof.ridge_point(), rdoc);
+            subdoc.AddMember("Roofline", rdoc, subdoc.GetAllocator());
+        }
+
+        for (const KernelProfile& p : profiler.get_profiles()) {
+            rapidjson::Document kdoc(&m_doc.GetAllocator());
+            kdoc.SetObject();
+
+            add_member("api", p.api, kdoc);
+            add_member("ops", p.ops, kdoc);
+            add_member("num_launches", p.num_launches, kdoc);
+            add_member("total_time (ms)", p.total_ms, kdoc);
+            add_member("avg_time (ms)", p.avg_ms(), kdoc);
+            add_member("min_time (ms)", p.min_ms, kdoc);
+            add_member("max_time (ms)", p.max_ms, kdoc);
+            add_member("num_blocks", p.blocks, kdoc);
+            add_member("num_threads", p.threads, kdoc);
+            add_member("dynamic_shared_memory (b)", p.smem_bytes_dyn, kdoc);
+            add_member("static_shared_memory (b)", p.smem_bytes_static, kdoc);
+            add_member("num_register_per_thread", int32_t(p.num_regs), kdoc);
+            add_member("theoretical_occupancy", p.occupancy, kdoc);
+            add_member("bytes", p.bytes, kdoc);
+            add_member("flops", p.flops, kdoc);
+            add_member("bandwidth (GB/s)", p.bandwidth(), kdoc);
+            add_member("throughput (GFLOP/s)", p.gflops(), kdoc);
+            add_member("arithmetic_intensity (FLOP/B)",
+                       p.arithmetic_intensity(),
+                       kdoc);
+            add_member("roof_efficiency", roof.efficiency(p), kdoc);
+            add_member("bound",
+                       roof.peak_bandwidth > 0 ?
+                           bound_to_string(roof.classify(p)) :
+                           bound_to_string(KernelBound::Unknown),
+                       kdoc);
+
+            const std::string name = p.api + "(" + p.ops + ") " + p.name;
+            rapidjson::Value  key(name.c_str(), subdoc.GetAllocator());
+            subdoc.AddMember(key, kdoc, subdoc.GetAllocator());
+        }
+
+        rapidjson::Value key(json_member_name.c_str(), subdoc.GetAllocator());
+        m_doc.AddMember(key, subdoc, m_doc.GetAllocator());
+    }
+
+    // add a flat sub-object of numeric members (e.g., the per-phase timings
+    // of one solver)
+    void add_object(const std::string&                   json_member_name,
+                    const std::map<std::string, double>& members)
+    {
+        rapidjson::Document subdoc(&m_doc.GetAllocator());
+        subdoc.SetObject();
+
+        for (const auto& [key, val] : members) {
+            add_member(key, val, subdoc);
+        }
+
+        rapidjson::Value key(json_member_name.c_str(), subdoc.GetAllocator());
+        m_doc.AddMember(key, subdoc, m_doc.GetAllocator());
+    }
+
     // add test using TestData
     void add_test(const TestData& test_data)
     {
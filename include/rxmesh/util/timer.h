@@ -1,14 +1,27 @@
 #pragma once
 
+#include <omp.h>
 #include <chrono>
 #include <map>
+#include <vector>
 #include "rxmesh/util/macros.h"
 
+#ifdef USE_NVTX
+#include <nvtx3/nvToolsExt.h>
+#define RXMESH_NVTX_PUSH(name) nvtxRangePushA(name)
+#define RXMESH_NVTX_POP() nvtxRangePop()
+#else
+#define RXMESH_NVTX_PUSH(name)
+#define RXMESH_NVTX_POP()
+#endif
+
 
 namespace rxmesh {
 
 struct GPUTimer
 {
+    static constexpr bool is_deferred = false;
+
     GPUTimer(cudaStream_t stream = NULL) : m_stream(stream)
     {
         CUDA_ERROR(cudaEventCreate(&m_start));
@@ -41,8 +54,104 @@ struct GPUTimer
 };
 
 
+/**
+ * @brief GPU timer that does not synchronize on stop(). Every start/stop pair
+ * records a pair of events in a ring buffer and the elapsed time of the pairs
+ * is resolved lazily, i.e., a pair is accumulated once its stop event is
+ * found completed (checked without blocking on every stop()), or when
+ * the ring buffer is full (which only waits on the oldest pair), or when the
+ * total time is queried with elapsed_millis(). Unlike GPUTimer,
+ * elapsed_millis() returns the total time of all start/stop pairs
+ */
+struct DeferredGPUTimer
+{
+    static constexpr bool is_deferred = true;
+
+    DeferredGPUTimer(cudaStream_t stream = NULL, uint32_t capacity = 64)
+        : m_stream(stream),
+          m_start(capacity),
+          m_stop(capacity),
+          m_head(0),
+          m_num_pending(0),
+          m_total(0)
+    {
+        for (uint32_t i = 0; i < capacity; ++i) {
+            CUDA_ERROR(cudaEventCreate(&m_start[i]));
+            CUDA_ERROR(cudaEventCreate(&m_stop[i]));
+        }
+    }
+    ~DeferredGPUTimer()
+    {
+        for (size_t i = 0; i < m_start.size(); ++i) {
+            CUDA_ERROR(cudaEventDestroy(m_start[i]));
+            CUDA_ERROR(cudaEventDestroy(m_stop[i]));
+        }
+    }
+    void start()
+    {
+        // make room for the new pair by resolving the oldest one
+        if (m_num_pending == m_start.size()) {
+            resolve_oldest(true);
+        }
+        CUDA_ERROR(cudaEventRecord(m_start[m_head], m_stream));
+    }
+    void stop()
+    {
+        CUDA_ERROR(cudaEventRecord(m_stop[m_head], m_stream));
+        m_head = (m_head + 1) % m_start.size();
+        m_num_pending++;
+
+        // accumulate the pairs that are already completed without blocking
+        while (m_num_pending > 0 && resolve_oldest(false)) {
+        }
+    }
+    float elapsed_millis()
+    {
+        while (m_num_pending > 0) {
+            resolve_oldest(true);
+        }
+        return m_total;
+    }
+
+   private:
+    /**
+     * @brief accumulate the oldest pending pair. If blocking is false, the
+     * pair is only accumulated if its stop event has completed. Return true if
+     * the pair is accumulated
+     */
+    bool resolve_oldest(bool blocking)
+    {
+        const uint32_t cap = m_start.size();
+        const uint32_t id  = (m_head + cap - m_num_pending) % cap;
+
+        if (blocking) {
+            CUDA_ERROR(cudaEventSynchronize(m_stop[id]));
+        } else {
+            cudaError_t status = cudaEventQuery(m_stop[id]);
+            if (status == cudaErrorNotReady) {
+                return false;
+            }
+            CUDA_ERROR(status);
+        }
+
+        float elapsed = 0;
+        CUDA_ERROR(cudaEventElapsedTime(&elapsed, m_start[id], m_stop[id]));
+        m_total += elapsed;
+        m_num_pending--;
+        return true;
+    }
+
+    cudaStream_t             m_stream;
+    std::vector<cudaEvent_t> m_start, m_stop;
+    uint32_t                 m_head, m_num_pending;
+    float                    m_total;
+};
+
+
 struct CPUTimer
 {
+    static constexpr bool is_deferred = false;
+
     CPUTimer()
     {
     }
@@ -80,27 +189,61 @@ struct Timers
         m_total_time.insert(std::make_pair(name, 0));
     }
 
+    // Timers are not thread-safe. When start/stop are called from within an
+    // OpenMP parallel region, only the master thread records time so the
+    // accumulated time is that of the master thread share of the work.
+    // start/stop also push/pop an NVTX range with the timer name (when
+    // compiled with USE_NVTX) so the same names show up in Nsight Systems
     void start(std::string name)
     {
+        if (omp_get_thread_num() != 0) {
+            return;
+        }
+        RXMESH_NVTX_PUSH(name.c_str());
         m_timers.at(name)->start();
     }
 
     void stop(std::string name)
     {
+        if (omp_get_thread_num() != 0) {
+            return;
+        }
         m_timers.at(name)->stop();
+        RXMESH_NVTX_POP();
 
-        float new_time =
-            m_total_time.at(name) + m_timers.at(name)->elapsed_millis();
-
-        m_total_time.insert_or_assign(name, new_time);
+        // deferred timers accumulate on their own and are only resolved when
+        // the time is queried
+        if constexpr (!TimerT::is_deferred) {
+            float new_time =
+                m_total_time.at(name) + m_timers.at(name)->elapsed_millis();
 
+            m_total_time.insert_or_assign(name, new_time);
+        }
     }
 
     float elapsed_millis(std::string name)
     {
+        if constexpr (TimerT::is_deferred) {
+            m_total_time.insert_or_assign(name,
+                                          m_timers.at(name)->elapsed_millis());
+        }
         return m_total_time.at(name);
     }
 
+    /**
+     * @brief resolve all pending start/stop pairs of deferred timers such that
+     * m_total_time is up-to-date. No-op for other timers
+     */
+    void resolve()
+    {
+        if constexpr (TimerT::is_deferred) {
+            for (auto& t : m_timers) {
+                m_total_time.insert_or_assign(t.first,
+                                              t.second->elapsed_millis());
+            }
+        }
+    }
+
     std::unordered_map<std::string, std::shared_ptr<TimerT>> m_timers;
     std::unordered_map<std::string, float>                   m_total_time;
 };
@@ -0,0 +1,155 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "rxmesh/util/log.h"
+#include "rxmesh/util/macros.h"
+
+namespace rxmesh {
+
+/**
+ * @brief index of the topology checks done by RXMeshDynamic::validate(). All
+ * checks run on the device
+ */
+enum class ValidationCheck : uint32_t
+{
+    // the sum of owned vertices/edges/faces over all patches is equal to the
+    // number of vertices/edges/faces
+    NumElements = 0,
+    // every not-owned element in a patch hash table maps to an owned and
+    // not-deleted element in a different patch
+    Hashtable = 1,
+    // every edge has two unique vertices and every face has three unique edges
+    // that give three unique vertices
+    Uniqueness = 2,
+    // the connectivity of every not-owned element matches its connectivity in
+    // the owner patch
+    NotOwned = 3,
+    // every owned edge is incident to an owned face
+    RibbonEdges = 4,
+    // the VF of the three vertices of an owned face is inside the patch
+    RibbonFaces = 5,
+    // if p has q in its patch stash, then q has p in its patch stash
+    PatchStashInclusion = 6,
+    // a patch is encountered at most once in a patch stash
+    UniquePatchStash = 7,
+    Count            = 8,
+};
+
+inline const char* validation_check_name(const ValidationCheck check)
+{
+    switch (check) {
+        case ValidationCheck::NumElements:
+            return "check_num_mesh_elements";
+        case ValidationCheck::Hashtable:
+            return "check_hashtable";
+        case ValidationCheck::Uniqueness:
+            return "check_uniqueness";
+        case ValidationCheck::NotOwned:
+            return "check_not_owned";
+        case ValidationCheck::RibbonEdges:
+            return "check_ribbon_edges";
+        case ValidationCheck::RibbonFaces:
+            return "check_ribbon_faces";
+        case ValidationCheck::PatchStashInclusion:
+            return "patch_stash_inclusion";
+        case ValidationCheck::UniquePatchStash:
+            return "unique_patch_stash";
+        default:
+            return "unknown";
+    }
+}
+
+namespace detail {
+/**
+ * @brief device-side counters written by the validation kernels. For every
+ * check, we count the number of errors and keep the smallest patch id that
+ * failed the check
+ */
+struct ValidationCounters
+{
+    static constexpr uint32_t num_checks = uint32_t(ValidationCheck::Count);
+
+    unsigned long long num_errors[num_checks];
+    uint32_t           first_patch[num_checks];
+
+    __host__ void reset()
+    {
+        for (uint32_t i = 0; i < num_checks; ++i) {
+            num_errors[i]  = 0;
+            first_patch[i] = INVALID32;
+        }
+    }
+
+    __device__ __inline__ void report(const ValidationCheck check,
+                                      const uint32_t        patch_id)
+    {
+#ifdef __CUDA_ARCH__
+        ::atomicAdd(num_errors + uint32_t(check), 1ull);
+        ::atomicMin(first_patch + uint32_t(check), patch_id);
+#endif
+    }
+};
+}  // namespace detail
+
+/**
+ * @brief compact report of RXMeshDynamic::validate(). Only the per-check
+ * error counters (and the first failing patch) are copied from the device
+ */
+struct ValidationReport
+{
+    detail::ValidationCounters counters;
+
+    ValidationReport()
+    {
+        counters.reset();
+    }
+
+    /**
+     * @brief number of errors found by a check
+     */
+    uint64_t get_num_errors(const ValidationCheck check) const
+    {
+        return static_cast<uint64_t>(counters.num_errors[uint32_t(check)]);
+    }
+
+    /**
+     * @brief the smallest patch id that failed a check. INVALID32 if the check
+     * passed or if the check is not per-patch (i.e., NumElements)
+     */
+    uint32_t get_first_patch(const ValidationCheck check) const
+    {
+        return counters.first_patch[uint32_t(check)];
+    }
+
+    bool is_valid(const ValidationCheck check) const
+    {
+        return get_num_errors(check) == 0;
+    }
+
+    bool is_valid() const
+    {
+        for (uint32_t i = 0; i < detail::ValidationCounters::num_checks; ++i) {
+            if (!is_valid(ValidationCheck(i))) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void print() const
+    {
+        for (uint32_t i = 0; i < detail::ValidationCounters::num_checks; ++i) {
+            const ValidationCheck check = ValidationCheck(i);
+            if (!is_valid(check)) {
+                RXMESH_ERROR(
+                    "RXMeshDynamic::validate() {} failed with {} errors "
+                    "(first patch = {})",
+                    validation_check_name(check),
+                    get_num_errors(check),
+                    get_first_patch(check));
+            }
+        }
+    }
+};
+}  // namespace rxmesh
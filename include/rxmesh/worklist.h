@@ -0,0 +1,335 @@
+#pragma once
+
+#include <algorithm>
+#include <sstream>
+#include <utility>
+
+#include "rxmesh/kernels/for_each.cuh"
+#include "rxmesh/query.cuh"
+#include "rxmesh/rxmesh_static.h"
+
+namespace rxmesh {
+
+namespace detail {
+
+/**
+ * @brief query kernel where only the sources in the worklist (i.e., whose
+ * member flag is set) are evaluated
+ */
+template <uint32_t blockThreads, Op op, typename HandleT, typename LambdaT>
+__global__ static void worklist_query_kernel(
+    const Context            context,
+    Attribute<bool, HandleT> member,
+    const bool               oriented,
+    LambdaT                  user_lambda)
+{
+    auto block = cooperative_groups::this_thread_block();
+
+    Query<blockThreads> query(context);
+
+    ShmemAllocator shrd_alloc;
+
+    query.dispatch<op>(
+        block,
+        shrd_alloc,
+        user_lambda,
+        [&](const HandleT& h) { return member(h); },
+        oriented);
+}
+
+/**
+ * @brief write the patch of every item in the worklist
+ */
+template <typename HandleT>
+__global__ static void worklist_patches(const uint32_t num,
+                                        const HandleT* handles,
+                                        uint32_t*      patches)
+{
+    const uint32_t i = threadIdx.x + blockIdx.x * blockDim.x;
+    if (i < num) {
+        patches[i] = handles[i].patch_id();
+    }
+}
+}  // namespace detail
+
+/**
+ * @brief a compacted device list of the handles of the active mesh elements
+ * of type HandleT i.e., a sparse active set. Iterative kernels (e.g., edge
+ * flips or geodesic updates) that only need to process a shrinking set of
+ * mesh elements could build the worklist once from a predicate or a mask and
+ * then filter() it between launches instead of visiting every element and
+ * testing the predicate inside the lambda. for_each() launches one thread
+ * per item and run_query_kernel() only launches the patches that have items
+ * in the worklist and only evaluates the items as query sources (same as the
+ * compute_active_set of the query dispatcher). The order of the items is not
+ * deterministic. The worklist is for static meshes i.e., the topology should
+ * not change while it is in use
+ */
+template <typename HandleT>
+struct Worklist
+{
+    Worklist(RXMeshStatic& rx)
+        : m_rx(rx),
+          m_capacity(0),
+          m_size(0),
+          m_d_size(nullptr),
+          m_d_patches(nullptr)
+    {
+        std::ostringstream address;
+        address << (void const*)this;
+
+        m_member =
+            m_rx.add_attribute<bool, HandleT>("wl_member" + address.str(), 1);
+        m_member->reset(false, LOCATION_ALL);
+
+        m_d_handles[0] = nullptr;
+        m_d_handles[1] = nullptr;
+
+        CUDA_ERROR(tracked_malloc((void**)&m_d_size,
+                                  sizeof(uint32_t),
+                                  MemoryCategory::Other));
+    }
+
+    Worklist(const Worklist&)            = delete;
+    Worklist& operator=(const Worklist&) = delete;
+
+    ~Worklist()
+    {
+        GPU_FREE(m_d_handles[0]);
+        GPU_FREE(m_d_handles[1]);
+        GPU_FREE(m_d_size);
+        GPU_FREE(m_d_patches);
+    }
+
+    /**
+     * @brief the number of items in the worklist
+     */
+    uint32_t size() const
+    {
+        return m_size;
+    }
+
+    /**
+     * @brief check if the worklist has no items
+     */
+    bool empty() const
+    {
+        return m_size == 0;
+    }
+
+    /**
+     * @brief device pointer to the handles in the worklist (size() items)
+     */
+    const HandleT* handles() const
+    {
+        return m_d_handles[0];
+    }
+
+    /**
+     * @brief the membership flag of every mesh element i.e., true iff the
+     * element is in the worklist. Could be read inside kernels to check if a
+     * neighbor element is active but should not be written
+     */
+    Attribute<bool, HandleT>& member()
+    {
+        return *m_member;
+    }
+
+    /**
+     * @brief build the worklist from all the owned elements for which the
+     * predicate is true
+     * @param pred [=] __device__(const HandleT&) -> bool
+     * @param stream the stream to run the build on
+     */
+    template <typename PredT>
+    void build(PredT pred, cudaStream_t stream = NULL)
+    {
+        grow(m_rx.get_num_elements<HandleT>());
+
+        CUDA_ERROR(cudaMemsetAsync(m_d_size, 0, sizeof(uint32_t), stream));
+
+        Attribute<bool, HandleT> member  = *m_member;
+        HandleT*                 handles = m_d_handles[0];
+        uint32_t*                d_size  = m_d_size;
+
+        m_rx.for_each<HandleT>(
+            DEVICE,
+            [=] __device__(const HandleT h) mutable {
+                const bool in = pred(h);
+                member(h)     = in;
+                if (in) {
+                    handles[::atomicAdd(d_size, 1u)] = h;
+                }
+            },
+            stream);
+
+        read_size(stream);
+    }
+
+    /**
+     * @brief build the worklist from all the owned elements whose mask is
+     * true (see build())
+     */
+    void build(const Attribute<bool, HandleT>& mask, cudaStream_t stream = NULL)
+    {
+        Attribute<bool, HandleT> m = mask;
+        build([=] __device__(const HandleT& h) mutable { return m(h); },
+              stream);
+    }
+
+    /**
+     * @brief shrink the worklist to the items for which the predicate is true.
+     * The cost is proportional to the size of the worklist (not the mesh)
+     * @param pred [=] __device__(const HandleT&) -> bool
+     * @param stream the stream to run the filter on
+     */
+    template <typename PredT>
+    void filter(PredT pred, cudaStream_t stream = NULL)
+    {
+        if (m_size == 0) {
+            return;
+        }
+
+        CUDA_ERROR(cudaMemsetAsync(m_d_size, 0, sizeof(uint32_t), stream));
+
+        Attribute<bool, HandleT> member = *m_member;
+        HandleT*                 out    = m_d_handles[1];
+        uint32_t*                d_size = m_d_size;
+
+        for_each(
+            [=] __device__(const HandleT h, const uint32_t) mutable {
+                if (pred(h)) {
+                    out[::atomicAdd(d_size, 1u)] = h;
+                } else {
+                    member(h) = false;
+                }
+            },
+            stream);
+
+        std::swap(m_d_handles[0], m_d_handles[1]);
+
+        read_size(stream);
+    }
+
+    /**
+     * @brief remove all items from the worklist
+     */
+    void clear(cudaStream_t stream = NULL)
+    {
+        filter([] __device__(const HandleT&) { return false; }, stream);
+    }
+
+    /**
+     * @brief apply the lambda on every item in the worklist with one thread
+     * per item
+     * @param apply [=] __device__(const HandleT h, const uint32_t i) where i
+     * is the position of h in the worklist
+     * @param stream the stream to run the kernel on
+     */
+    template <typename LambdaT>
+    void for_each(LambdaT apply, cudaStream_t stream = NULL) const
+    {
+        if (m_size == 0) {
+            return;
+        }
+        const uint32_t threads = 256;
+        detail::for_each_dense<HandleT>
+            <<<DIVIDE_UP(m_size, threads), threads, 0, stream>>>(
+                0, m_size, m_d_handles[0], apply);
+    }
+
+    /**
+     * @brief run a query where the sources are the items in the worklist
+     * (same lambda as RXMeshStatic::run_query_kernel()). Only the patches
+     * that have items in the worklist are launched. This uses
+     * RXMeshStatic::set_patch_subset() internally and thus should not be
+     * called while a patch subset is set
+     * @param user_lambda the query lambda
+     * @param oriented if the query is oriented
+     * @param stream the stream to run the kernel on
+     */
+    template <Op op, uint32_t blockThreads, typename LambdaT>
+    void run_query_kernel(LambdaT      user_lambda,
+                          const bool   oriented = false,
+                          cudaStream_t stream   = NULL)
+    {
+        if (m_rx.has_patch_subset()) {
+            RXMESH_ERROR(
+                "Worklist::run_query_kernel() can not be used while a patch "
+                "subset is set");
+            return;
+        }
+        if (m_size == 0) {
+            return;
+        }
+
+        detail::worklist_patches<<<DIVIDE_UP(m_size, 256), 256, 0, stream>>>(
+            m_size, m_d_handles[0], m_d_patches);
+        CUDA_ERROR(cudaStreamSynchronize(stream));
+
+        m_rx.set_patch_subset(m_d_patches, m_size);
+
+        LaunchBox<blockThreads> lb;
+        m_rx.prepare_launch_box(
+            {op},
+            lb,
+            (void*)detail::
+                worklist_query_kernel<blockThreads, op, HandleT, LambdaT>,
+            oriented);
+
+        m_rx.run_kernel(
+            lb,
+            detail::worklist_query_kernel<blockThreads, op, HandleT, LambdaT>,
+            {op},
+            stream,
+            *m_member,
+            oriented,
+            user_lambda);
+
+        m_rx.clear_patch_subset();
+    }
+
+   private:
+    /**
+     * @brief make sure the buffers fit capacity items
+     */
+    void grow(const uint32_t capacity)
+    {
+        if (capacity <= m_capacity) {
+            return;
+        }
+        GPU_FREE(m_d_handles[0]);
+        GPU_FREE(m_d_handles[1]);
+        GPU_FREE(m_d_patches);
+        m_capacity = capacity;
+        CUDA_ERROR(tracked_malloc((void**)&m_d_handles[0],
+                                  m_capacity * sizeof(HandleT),
+                                  MemoryCategory::Other));
+        CUDA_ERROR(tracked_malloc((void**)&m_d_handles[1],
+                                  m_capacity * sizeof(HandleT),
+                                  MemoryCategory::Other));
+        CUDA_ERROR(tracked_malloc((void**)&m_d_patches,
+                                  m_capacity * sizeof(uint32_t),
+                                  MemoryCategory::Other));
+    }
+
+    void read_size(cudaStream_t stream)
+    {
+        CUDA_ERROR(cudaMemcpyAsync(&m_size,
+                                   m_d_size,
+                                   sizeof(uint32_t),
+                                   cudaMemcpyDeviceToHost,
+                                   stream));
+        CUDA_ERROR(cudaStreamSynchronize(stream));
+    }
+
+    RXMeshStatic&                             m_rx;
+    std::shared_ptr<Attribute<bool, HandleT>> m_member;
+    HandleT*                                  m_d_handles[2];
+    uint32_t                                  m_capacity;
+    uint32_t                                  m_size;
+    uint32_t*                                 m_d_size;
+    uint32_t*                                 m_d_patches;
+};
+
+}  // namespace rxmesh
@@ -0,0 +1,209 @@
+#include "bench_util.h"
+
+#include "rxmesh/cavity_manager.cuh"
+#include "rxmesh/kernels/for_each.cuh"
+#include "rxmesh/query.cuh"
+#include "rxmesh/rxmesh_dynamic.h"
+
+using namespace rxmesh;
+using namespace rxmesh_bench;
+
+// seeds are at least this many grid vertices away from the plane boundary
+// such that every cavity is a disk whose boundary is a single loop
+constexpr int seed_margin = 3;
+
+// seeds are (at most) one cavity in every seed_stride x seed_stride vertices
+// such that the cavities only conflict around the same grid vertex
+constexpr int seed_stride = 8;
+
+/**
+ * @brief the (i, j) grid index of a plane vertex (see make_plane())
+ */
+__device__ __forceinline__ int2 grid_index(const VertexAttribute<float>& coords,
+                                           const VertexHandle&           vh,
+                                           const int                     n)
+{
+    return make_int2(int(rintf(coords(vh, 1) * float(n - 1))),
+                     int(rintf(coords(vh, 0) * float(n - 1))));
+}
+
+__device__ __forceinline__ bool is_deep(const int2 g, const int n)
+{
+    return g.x >= seed_margin && g.x < n - seed_margin &&
+           g.y >= seed_margin && g.y < n - seed_margin;
+}
+
+__device__ __forceinline__ bool is_sparse(const int2 g)
+{
+    return g.x % seed_stride == 0 && g.y % seed_stride == 0;
+}
+
+/**
+ * @brief a generic cavity kernel: create a cavity from every seed and fill
+ * each cavity with a fan around a new vertex at the centroid of the cavity
+ * boundary i.e., an edge split for CavityOp::E and an edge collapse for
+ * CavityOp::EV (the two operations supported by CavityManager)
+ */
+template <uint32_t blockThreads, CavityOp cop>
+__global__ static void fan_fill(Context                context,
+                                VertexAttribute<float> coords,
+                                EdgeAttribute<int>     seed)
+{
+    auto           block = cooperative_groups::this_thread_block();
+    ShmemAllocator shrd_alloc;
+
+    CavityManager<blockThreads, cop> cavity(block, context, shrd_alloc, true);
+
+    if (cavity.patch_id() == INVALID32) {
+        return;
+    }
+
+    for_each_edge(cavity.patch_info(), [&](const EdgeHandle eh) {
+        if (seed(eh) == 1) {
+            cavity.create(eh);
+        }
+    });
+
+    block.sync();
+
+    if (cavity.prologue(block, shrd_alloc, coords, seed)) {
+
+        for_each_edge(cavity.patch_info(), [&](const EdgeHandle eh) {
+            if (cavity.is_successful(eh)) {
+                seed(eh) = 0;
+            }
+        });
+
+        cavity.for_each_cavity(block, [&](uint16_t c, uint16_t size) {
+            vec3<float> center(0.f, 0.f, 0.f);
+            for (uint16_t i = 0; i < size; ++i) {
+                center += coords.to_glm<3>(cavity.get_cavity_vertex(c, i));
+            }
+            center /= float(size);
+
+            const VertexHandle new_v = cavity.add_vertex();
+            if (!new_v.is_valid()) {
+                return;
+            }
+            coords.from_glm(new_v, center);
+
+            DEdgeHandle e0 =
+                cavity.add_edge(new_v, cavity.get_cavity_vertex(c, 0));
+            const DEdgeHandle e_init = e0;
+
+            if (e0.is_valid()) {
+                seed(e0.get_edge_handle()) = 0;
+                for (uint16_t i = 0; i < size; ++i) {
+                    const DEdgeHandle e = cavity.get_cavity_edge(c, i);
+                    const DEdgeHandle e1 =
+                        (i == size - 1) ?
+                            e_init.get_flip_dedge() :
+                            cavity.add_edge(cavity.get_cavity_vertex(c, i + 1),
+                                            new_v);
+                    if (!e1.is_valid()) {
+                        break;
+                    }
+                    seed(e1.get_edge_handle()) = 0;
+                    const FaceHandle f = cavity.add_face(e0, e, e1);
+                    if (!f.is_valid()) {
+                        break;
+                    }
+                    e0 = e1.get_flip_dedge();
+                }
+            }
+        });
+    }
+
+    cavity.epilogue(block);
+}
+
+/**
+ * @brief mark the seeds of the cavities: the edges away from the boundary
+ * whose smallest vertex (in the grid order) is on the sparse seed grid
+ */
+void set_seeds(RXMeshDynamic&                rx,
+               const int                     n,
+               const VertexAttribute<float>& coords,
+               EdgeAttribute<int>&           seed)
+{
+    seed.reset(0, DEVICE);
+
+    rx.run_query_kernel<Op::EV, 256>([=] __device__(
+                                         const EdgeHandle&     eh,
+                                         const VertexIterator& iter) mutable {
+        bool deep  = true;
+        int2 g_min = make_int2(n, n);
+        for (uint16_t i = 0; i < iter.size(); ++i) {
+            const int2 g = grid_index(coords, iter[i], n);
+            deep         = deep && is_deep(g, n);
+            if (g.x < g_min.x || (g.x == g_min.x && g.y < g_min.y)) {
+                g_min = g;
+            }
+        }
+        seed(eh) = (deep && is_sparse(g_min)) ? 1 : 0;
+    });
+}
+
+/**
+ * @brief the cavity operation cop (through fan_fill()) on a fresh dynamic
+ * plane on every iteration until all patches are processed including the
+ * slicing and cleanup. Only this loop is timed; building the mesh and setting
+ * the seeds are not
+ */
+template <CavityOp cop>
+void bm_cavity(benchmark::State& state)
+{
+    constexpr uint32_t blockThreads = 256;
+
+    const int n = int(state.range(0));
+
+    std::vector<std::vector<float>>    verts;
+    std::vector<std::vector<uint32_t>> fv;
+    make_plane(n, verts, fv);
+
+    for (auto _ : state) {
+        RXMeshDynamic rx(fv);
+        rx.add_vertex_coordinates(verts, "plane");
+
+        auto coords = rx.get_input_vertex_coordinates();
+        auto seed   = rx.add_edge_attribute<int>("bench_seed", 1);
+
+        set_seeds(rx, n, *coords, *seed);
+        CUDA_ERROR(cudaDeviceSynchronize());
+
+        state.counters["F_in"] = rx.get_num_faces();
+
+        int rounds = 0;
+
+        CPUTimer timer;
+        timer.start();
+        while (!rx.is_queue_empty()) {
+            LaunchBox<blockThreads> lb;
+            rx.prepare_launch_box({}, lb, (void*)fan_fill<blockThreads, cop>);
+
+            fan_fill<blockThreads, cop>
+                <<<lb.blocks, lb.num_threads, lb.smem_bytes_dyn>>>(
+                    rx.get_context(), *coords, *seed);
+
+            rx.slice_patches(*coords, *seed);
+            rx.cleanup();
+            ++rounds;
+        }
+        CUDA_ERROR(cudaDeviceSynchronize());
+        timer.stop();
+        state.SetIterationTime(timer.elapsed_millis() / 1000.0);
+
+        state.counters["F_out"]  = rx.get_num_faces();
+        state.counters["rounds"] = rounds;
+    }
+    CUDA_ERROR(cudaGetLastError());
+}
+
+// every iteration builds a dynamic mesh (untimed) so the number of
+// iterations is fixed
+BENCHMARK_TEMPLATE(bm_cavity, CavityOp::E)
+    ->Apply(small_plane_sizes)
+    ->Iterations(3);
+BENCHMARK_TEMPLATE(bm_cavity, CavityOp::EV)
+    ->Apply(small_plane_sizes)
+    ->Iterations(3);
@@ -0,0 +1,113 @@
+#include "bench_util.h"
+
+using namespace rxmesh;
+using namespace rxmesh_bench;
+
+/**
+ * @brief building RXMeshStatic from the face list (i.e., the patching, the
+ * per-patch topology, and the coordinates). The mesh destruction is not timed
+ */
+void bm_construction(benchmark::State& state)
+{
+    std::vector<std::vector<float>>    verts;
+    std::vector<std::vector<uint32_t>> fv;
+    make_plane(int(state.range(0)), verts, fv);
+
+    CPUTimer timer;
+    for (auto _ : state) {
+        timer.start();
+        auto rx = std::make_unique<RXMeshStatic>(fv);
+        rx->add_vertex_coordinates(verts, "plane");
+        CUDA_ERROR(cudaDeviceSynchronize());
+        timer.stop();
+        state.SetIterationTime(timer.elapsed_millis() / 1000.0);
+
+        set_mesh_counters(state, *rx);
+    }
+    state.SetItemsProcessed(state.iterations() * int64_t(fv.size()));
+}
+BENCHMARK(bm_construction)->Apply(plane_sizes);
+
+
+/**
+ * @brief generating an icosphere with 20*n^2 faces on the device (see
+ * generate_icosphere()) which is how the large meshes of the scaling
+ * benchmarks are created
+ */
+void bm_generate_icosphere(benchmark::State& state)
+{
+    const uint32_t n = uint32_t(state.range(0));
+
+    DeviceMesh mesh;
+    gpu_loop(state, [&]() {
+        mesh.release();
+        mesh = generate_icosphere(n);
+    });
+    state.counters["F"] = mesh.num_faces;
+    state.SetItemsProcessed(state.iterations() * int64_t(mesh.num_faces));
+    mesh.release();
+}
+BENCHMARK(bm_generate_icosphere)
+    ->RangeMultiplier(4)
+    ->Range(64, 2048)
+    ->ArgName("n")
+    ->Unit(benchmark::kMillisecond)
+    ->UseManualTime();
+
+
+/**
+ * @brief building RXMeshStatic from an icosphere generated on the device
+ * (including the generation and the download of the flat buffers)
+ */
+void bm_construction_icosphere(benchmark::State& state)
+{
+    const uint32_t n = uint32_t(state.range(0));
+
+    CPUTimer timer;
+    for (auto _ : state) {
+        timer.start();
+        DeviceMesh mesh = generate_icosphere(n);
+        auto       rx   = make_mesh<RXMeshStatic>(mesh);
+        CUDA_ERROR(cudaDeviceSynchronize());
+        timer.stop();
+        state.SetIterationTime(timer.elapsed_millis() / 1000.0);
+
+        set_mesh_counters(state, *rx);
+        mesh.release();
+    }
+    state.SetItemsProcessed(state.iterations() * int64_t(20) * n * n);
+}
+BENCHMARK(bm_construction_icosphere)
+    ->RangeMultiplier(2)
+    ->Range(64, 512)
+    ->ArgName("n")
+    ->Unit(benchmark::kMillisecond)
+    ->UseManualTime();
+
+
+/**
+ * @brief only the patching part of the construction as reported by the
+ * patcher for different patch sizes
+ */
+void bm_patching(benchmark::State& state)
+{
+    std::vector<std::vector<float>>    verts;
+    std::vector<std::vector<uint32_t>> fv;
+    make_plane(int(state.range(0)), verts, fv);
+
+    const uint32_t patch_size = uint32_t(state.range(1));
+
+    for (auto _ : state) {
+        RXMeshStatic rx(fv, "", patch_size);
+        state.SetIterationTime(rx.get_patching_time() / 1000.0);
+
+        state.counters["patches"] = rx.get_num_patches();
+    }
+    state.SetItemsProcessed(state.iterations() * int64_t(fv.size()));
+}
+BENCHMARK(bm_patching)
+    ->ArgsProduct({benchmark::CreateRange(min_plane_n, max_plane_n, 2),
+                   {128, 256, 512}})
+    ->ArgNames({"n", "patch_size"})
+    ->Unit(benchmark::kMillisecond)
+    ->UseManualTime();
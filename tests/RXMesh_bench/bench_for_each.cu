@@ -0,0 +1,36 @@
+#include "bench_util.h"
+
+using namespace rxmesh;
+using namespace rxmesh_bench;
+
+/**
+ * @brief for_each_vertex/edge/face (through for_each<HandleT>) with a lambda
+ * that reads and writes one attribute per element
+ */
+template <typename HandleT>
+void bm_for_each(benchmark::State& state)
+{
+    RXMeshStatic& rx = get_plane(int(state.range(0)));
+
+    auto attr = rx.add_attribute<float, HandleT>("bench_for_each", 1, DEVICE);
+    attr->reset(0, DEVICE);
+
+    auto a = *attr;
+
+    gpu_loop(state, [&]() {
+        rx.for_each<HandleT>(DEVICE, [a] __device__(const HandleT h) mutable {
+            a(h) += 1.f;
+        });
+    });
+
+    set_mesh_counters(state, rx);
+    state.SetItemsProcessed(state.iterations() *
+                            int64_t(rx.get_num_elements<HandleT>()));
+    state.SetBytesProcessed(state.iterations() * 2 * sizeof(float) *
+                            int64_t(rx.get_num_elements<HandleT>()));
+
+    rx.remove_attribute("bench_for_each");
+}
+BENCHMARK_TEMPLATE(bm_for_each, VertexHandle)->Apply(plane_sizes);
+BENCHMARK_TEMPLATE(bm_for_each, EdgeHandle)->Apply(plane_sizes);
+BENCHMARK_TEMPLATE(bm_for_each, FaceHandle)->Apply(plane_sizes);
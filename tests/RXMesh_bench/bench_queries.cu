@@ -0,0 +1,62 @@
+#include "bench_util.h"
+
+#include "rxmesh/query.cuh"
+
+using namespace rxmesh;
+using namespace rxmesh_bench;
+
+/**
+ * @brief a query kernel of op that reads all its output (the same kernel used
+ * by PatchSizeTuner) such that the query is not optimized away. The number of
+ * items is the number of the query source elements
+ */
+template <Op op>
+void bm_query(benchmark::State& state)
+{
+    using HandleT   = typename InputHandle<op>::type;
+    using IteratorT = typename IteratorType<op>::type;
+
+    constexpr uint32_t blockThreads = 256;
+
+    RXMeshStatic& rx = get_plane(int(state.range(0)));
+
+    const std::string name = "bench_" + op_to_string(op);
+
+    auto attr = rx.add_attribute<uint32_t, HandleT>(name, 1, DEVICE);
+
+    auto a = *attr;
+
+    auto query = [a] __device__(const HandleT&   h,
+                                const IteratorT& iter) mutable {
+        uint32_t sum = 0;
+        for (uint32_t i = 0; i < iter.size(); ++i) {
+            sum += iter.local(i);
+        }
+        a(h) = sum;
+    };
+
+    LaunchBox<blockThreads> lb;
+    rx.prepare_launch_box(
+        {op},
+        lb,
+        (void*)detail::query_kernel<blockThreads, op, decltype(query)>);
+
+    gpu_loop(state, [&]() { rx.run_query_kernel<op>(lb, query); });
+
+    state.counters["smem"] = lb.smem_bytes_dyn;
+    set_mesh_counters(state, rx);
+    state.SetItemsProcessed(state.iterations() *
+                            int64_t(rx.get_num_elements<HandleT>()));
+
+    rx.remove_attribute(name);
+}
+BENCHMARK_TEMPLATE(bm_query, Op::VV)->Apply(plane_sizes);
+BENCHMARK_TEMPLATE(bm_query, Op::VE)->Apply(plane_sizes);
+BENCHMARK_TEMPLATE(bm_query, Op::VF)->Apply(plane_sizes);
+BENCHMARK_TEMPLATE(bm_query, Op::EV)->Apply(plane_sizes);
+BENCHMARK_TEMPLATE(bm_query, Op::EE)->Apply(plane_sizes);
+BENCHMARK_TEMPLATE(bm_query, Op::EF)->Apply(plane_sizes);
+BENCHMARK_TEMPLATE(bm_query, Op::FV)->Apply(plane_sizes);
+BENCHMARK_TEMPLATE(bm_query, Op::FE)->Apply(plane_sizes);
+BENCHMARK_TEMPLATE(bm_query, Op::FF)->Apply(plane_sizes);
+BENCHMARK_TEMPLATE(bm_query, Op::EVDiamond)->Apply(plane_sizes);
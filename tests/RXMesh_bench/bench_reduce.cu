@@ -0,0 +1,74 @@
+#include "bench_util.h"
+
+#include "rxmesh/reduce_handle.h"
+
+using namespace rxmesh;
+using namespace rxmesh_bench;
+
+enum class ReduceOp
+{
+    Sum,
+    Max,
+    Dot,
+    Norm2,
+    ArgMax,
+    // one dot product and two norms in one ReduceBatch (as in a CG iteration)
+    Batch,
+};
+
+/**
+ * @brief the ReduceHandle operations over 3-component vertex attributes. The
+ * operations return the result on the host so every iteration includes the
+ * copy of the result
+ */
+template <ReduceOp rop>
+void bm_reduce(benchmark::State& state)
+{
+    RXMeshStatic& rx = get_plane(int(state.range(0)));
+
+    auto x = rx.add_vertex_attribute<float>("bench_x", 3, DEVICE);
+    auto y = rx.add_vertex_attribute<float>("bench_y", 3, DEVICE);
+    x->reset(1.f, DEVICE);
+    y->reset(2.f, DEVICE);
+
+    ReduceHandle rh(*x);
+
+    ReduceBatch<float, VertexHandle> batch;
+    batch.dot(*x, *y);
+    batch.norm2(*x);
+    batch.norm2(*y);
+
+    gpu_loop(state, [&]() {
+        if constexpr (rop == ReduceOp::Sum) {
+            benchmark::DoNotOptimize(rh.reduce(*x, cub::Sum(), 0.f));
+        }
+        if constexpr (rop == ReduceOp::Max) {
+            benchmark::DoNotOptimize(rh.reduce(*x, cub::Max(), 0.f));
+        }
+        if constexpr (rop == ReduceOp::Dot) {
+            benchmark::DoNotOptimize(rh.dot(*x, *y));
+        }
+        if constexpr (rop == ReduceOp::Norm2) {
+            benchmark::DoNotOptimize(rh.norm2(*x));
+        }
+        if constexpr (rop == ReduceOp::ArgMax) {
+            benchmark::DoNotOptimize(rh.arg_max(*x, 0));
+        }
+        if constexpr (rop == ReduceOp::Batch) {
+            benchmark::DoNotOptimize(rh.batch_reduce(batch));
+        }
+    });
+
+    set_mesh_counters(state, rx);
+    state.SetItemsProcessed(state.iterations() *
+                            int64_t(rx.get_num_vertices()));
+
+    rx.remove_attribute("bench_x");
+    rx.remove_attribute("bench_y");
+}
+BENCHMARK_TEMPLATE(bm_reduce, ReduceOp::Sum)->Apply(plane_sizes);
+BENCHMARK_TEMPLATE(bm_reduce, ReduceOp::Max)->Apply(plane_sizes);
+BENCHMARK_TEMPLATE(bm_reduce, ReduceOp::Dot)->Apply(plane_sizes);
+BENCHMARK_TEMPLATE(bm_reduce, ReduceOp::Norm2)->Apply(plane_sizes);
+BENCHMARK_TEMPLATE(bm_reduce, ReduceOp::ArgMax)->Apply(plane_sizes);
+BENCHMARK_TEMPLATE(bm_reduce, ReduceOp::Batch)->Apply(plane_sizes);
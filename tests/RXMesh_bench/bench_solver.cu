@@ -0,0 +1,170 @@
+#include "bench_util.h"
+
+#include "rxmesh/matrix/cg_solver.h"
+#include "rxmesh/matrix/cholesky_solver.h"
+#include "rxmesh/matrix/dense_matrix.h"
+#include "rxmesh/matrix/laplacian_operator.h"
+#include "rxmesh/matrix/pcg_solver.h"
+#include "rxmesh/matrix/sparse_matrix.h"
+
+using namespace rxmesh;
+using namespace rxmesh_bench;
+
+using T = float;
+
+// the SPD system (M + L) of the cotan Laplacian L and the Voronoi mass M
+constexpr T mass_scale = 1;
+constexpr T lap_scale  = 1;
+
+// the iterative solvers stop at this many iterations (or the tolerance)
+constexpr int solver_max_iter = 1000;
+constexpr T   solver_abs_tol  = 1e-6;
+
+/**
+ * @brief SpMV of the assembled (M + L) with num_cols right-hand sides
+ */
+void bm_spmv(benchmark::State& state)
+{
+    RXMeshStatic& rx = get_plane(int(state.range(0)));
+
+    const int      num_cols = int(state.range(1));
+    const uint32_t num_v    = rx.get_num_vertices();
+
+    auto lap = get_laplacian_operator(rx, *rx.get_input_vertex_coordinates());
+
+    SparseMatrix<T>& A = lap->matrix(mass_scale, lap_scale);
+
+    DenseMatrix<T> X(rx, num_v, num_cols);
+    DenseMatrix<T> Y(rx, num_v, num_cols);
+    X.fill_random();
+    X.move(HOST, DEVICE);
+
+    gpu_loop(state, [&]() { A.multiply(X, Y); });
+
+    set_mesh_counters(state, rx);
+    state.counters["nnz"] = A.non_zeros();
+    state.SetItemsProcessed(state.iterations() * int64_t(A.non_zeros()) *
+                            num_cols);
+}
+BENCHMARK(bm_spmv)
+    ->ArgsProduct({benchmark::CreateRange(min_plane_n, max_plane_n, 2), {1, 3}})
+    ->ArgNames({"n", "cols"})
+    ->Unit(benchmark::kMillisecond)
+    ->UseManualTime();
+
+
+/**
+ * @brief the matrix-free apply of (M + L) by the LaplacianOperator
+ */
+void bm_spmv_matrix_free(benchmark::State& state)
+{
+    RXMeshStatic& rx = get_plane(int(state.range(0)));
+
+    const int      num_cols = int(state.range(1));
+    const uint32_t num_v    = rx.get_num_vertices();
+
+    auto lap = get_laplacian_operator(rx, *rx.get_input_vertex_coordinates());
+
+    DenseMatrix<T> X(rx, num_v, num_cols);
+    DenseMatrix<T> Y(rx, num_v, num_cols);
+    X.fill_random();
+    X.move(HOST, DEVICE);
+
+    gpu_loop(state, [&]() { lap->apply(X, Y, mass_scale, lap_scale); });
+
+    set_mesh_counters(state, rx);
+}
+BENCHMARK(bm_spmv_matrix_free)
+    ->ArgsProduct({benchmark::CreateRange(min_plane_n, max_plane_n, 2), {1, 3}})
+    ->ArgNames({"n", "cols"})
+    ->Unit(benchmark::kMillisecond)
+    ->UseManualTime();
+
+
+/**
+ * @brief (P)CG solve of (M + L) X = B with 3 right-hand sides starting from
+ * zero. The number of iterations is reported along with the time
+ */
+template <typename SolverT>
+void bm_iterative_solver(benchmark::State& state)
+{
+    RXMeshStatic& rx = get_plane(int(state.range(0)));
+
+    const uint32_t num_v = rx.get_num_vertices();
+
+    auto lap = get_laplacian_operator(rx, *rx.get_input_vertex_coordinates());
+
+    SparseMatrix<T> A(rx);
+    lap->assemble(A, mass_scale, lap_scale);
+
+    DenseMatrix<T> X(rx, num_v, 3);
+    DenseMatrix<T> B(rx, num_v, 3);
+    B.fill_random();
+    B.move(HOST, DEVICE);
+
+    SolverT solver(A, 3, solver_max_iter, solver_abs_tol);
+
+    gpu_loop(state, [&]() {
+        X.reset(0, DEVICE);
+        solver.pre_solve(B, X);
+        solver.solve(B, X);
+    });
+
+    set_mesh_counters(state, rx);
+    state.counters["iter"] = solver.iter_taken();
+}
+BENCHMARK_TEMPLATE(bm_iterative_solver, CGSolver<T>)->Apply(small_plane_sizes);
+BENCHMARK_TEMPLATE(bm_iterative_solver, PCGSolver<T>)
+    ->Apply(small_plane_sizes);
+
+
+/**
+ * @brief the numerical factorization of (M + L) by the Cholesky solver. The
+ * permutation and the symbolic analysis are done once outside the timing
+ */
+void bm_cholesky_factorize(benchmark::State& state)
+{
+    RXMeshStatic& rx = get_plane(int(state.range(0)));
+
+    auto lap = get_laplacian_operator(rx, *rx.get_input_vertex_coordinates());
+
+    SparseMatrix<T> A(rx);
+    lap->assemble(A, mass_scale, lap_scale);
+
+    CholeskySolver solver(&A);
+    solver.analyze_pattern(rx);
+
+    gpu_loop(state, [&]() { solver.refactorize(); });
+
+    set_mesh_counters(state, rx);
+}
+BENCHMARK(bm_cholesky_factorize)->Apply(small_plane_sizes);
+
+
+/**
+ * @brief the triangular solves of the Cholesky solver with 3 right-hand sides
+ */
+void bm_cholesky_solve(benchmark::State& state)
+{
+    RXMeshStatic& rx = get_plane(int(state.range(0)));
+
+    const uint32_t num_v = rx.get_num_vertices();
+
+    auto lap = get_laplacian_operator(rx, *rx.get_input_vertex_coordinates());
+
+    SparseMatrix<T> A(rx);
+    lap->assemble(A, mass_scale, lap_scale);
+
+    DenseMatrix<T> X(rx, num_v, 3);
+    DenseMatrix<T> B(rx, num_v, 3);
+    B.fill_random();
+    B.move(HOST, DEVICE);
+
+    CholeskySolver solver(&A);
+    solver.pre_solve(rx);
+
+    gpu_loop(state, [&]() { solver.solve(B, X); });
+
+    set_mesh_counters(state, rx);
+}
+BENCHMARK(bm_cholesky_solve)->Apply(small_plane_sizes);
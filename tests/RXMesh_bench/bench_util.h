@@ -0,0 +1,132 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+
+#include "rxmesh/geometry_factory.h"
+#include "rxmesh/geometry_factory_device.cuh"
+#include "rxmesh/rxmesh_static.h"
+#include "rxmesh/util/timer.h"
+
+namespace rxmesh_bench {
+
+// the benchmarks run on an n x n plane (n*n vertices and 2*(n-1)^2 faces)
+// generated by create_plane() where n is swept from min_plane_n to max_plane_n
+constexpr int min_plane_n = 64;
+constexpr int max_plane_n = 1024;
+
+// the largest plane of the expensive benchmarks (dynamic meshes and solvers)
+constexpr int max_small_plane_n = 512;
+
+/**
+ * @brief sweep the plane resolution n. The iteration time is the manual time
+ * reported by gpu_loop() or wall_loop()
+ */
+inline void plane_sizes(benchmark::internal::Benchmark* b)
+{
+    b->RangeMultiplier(2)
+        ->Range(min_plane_n, max_plane_n)
+        ->ArgName("n")
+        ->Unit(benchmark::kMillisecond)
+        ->UseManualTime();
+}
+
+/**
+ * @brief same as plane_sizes() up to max_small_plane_n
+ */
+inline void small_plane_sizes(benchmark::internal::Benchmark* b)
+{
+    b->RangeMultiplier(2)
+        ->Range(min_plane_n, max_small_plane_n)
+        ->ArgName("n")
+        ->Unit(benchmark::kMillisecond)
+        ->UseManualTime();
+}
+
+/**
+ * @brief the n x n plane in the xy-plane with unit side length
+ */
+inline void make_plane(const int                           n,
+                       std::vector<std::vector<float>>&    verts,
+                       std::vector<std::vector<uint32_t>>& fv)
+{
+    rxmesh::create_plane(verts, fv, n, n, 2, 1.f / float(n - 1));
+}
+
+/**
+ * @brief the (static) plane of resolution n. The last built plane is shared by
+ * all benchmarks with the same n such that it is only built once per sweep
+ * value. Benchmarks should remove the attributes they add
+ */
+inline rxmesh::RXMeshStatic& get_plane(const int n)
+{
+    static std::unique_ptr<rxmesh::RXMeshStatic> rx;
+    static int                                   rx_n = -1;
+
+    if (rx_n != n) {
+        // free the previous plane before building the new one
+        rx.reset();
+
+        std::vector<std::vector<float>>    verts;
+        std::vector<std::vector<uint32_t>> fv;
+        make_plane(n, verts, fv);
+
+        rx = std::make_unique<rxmesh::RXMeshStatic>(fv);
+        rx->add_vertex_coordinates(verts, "plane");
+        rx_n = n;
+    }
+    return *rx;
+}
+
+/**
+ * @brief report the mesh size along with the benchmark
+ */
+inline void set_mesh_counters(benchmark::State&           state,
+                              const rxmesh::RXMeshStatic& rx)
+{
+    state.counters["V"]       = rx.get_num_vertices();
+    state.counters["E"]       = rx.get_num_edges();
+    state.counters["F"]       = rx.get_num_faces();
+    state.counters["patches"] = rx.get_num_patches();
+}
+
+/**
+ * @brief time func (which launches work on the default stream) with a pair of
+ * events on every iteration. func is called once before the timing to warm up
+ */
+template <typename FuncT>
+void gpu_loop(benchmark::State& state, FuncT func)
+{
+    func();
+    CUDA_ERROR(cudaDeviceSynchronize());
+
+    rxmesh::GPUTimer timer;
+    for (auto _ : state) {
+        timer.start();
+        func();
+        timer.stop();
+        state.SetIterationTime(timer.elapsed_millis() / 1000.0);
+    }
+    CUDA_ERROR(cudaGetLastError());
+}
+
+/**
+ * @brief same as gpu_loop() for work that mixes host and device code where
+ * the iteration time is the wall time until the device is idle
+ */
+template <typename FuncT>
+void wall_loop(benchmark::State& state, FuncT func)
+{
+    rxmesh::CPUTimer timer;
+    for (auto _ : state) {
+        timer.start();
+        func();
+        CUDA_ERROR(cudaDeviceSynchronize());
+        timer.stop();
+        state.SetIterationTime(timer.elapsed_millis() / 1000.0);
+    }
+    CUDA_ERROR(cudaGetLastError());
+}
+}  // namespace rxmesh_bench
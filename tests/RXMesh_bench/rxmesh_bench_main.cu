@@ -0,0 +1,41 @@
+#include "benchmark/benchmark.h"
+
+#include "rxmesh/util/cuda_query.h"
+#include "rxmesh/util/log.h"
+#include "rxmesh/util/util.h"
+
+int main(int argc, char** argv)
+{
+    using namespace rxmesh;
+    Log::init();
+
+    int device_id = 0;
+    if (cmd_option_exists(argv, argc + argv, "-device_id")) {
+        device_id = atoi(get_cmd_option(argv, argv + argc, "-device_id"));
+    }
+
+    ::benchmark::Initialize(&argc, argv);
+
+    if (cmd_option_exists(argv, argc + argv, "-h")) {
+        // clang-format off
+        RXMESH_INFO("\nUsage: RXMesh_bench.exe < -option X> <--benchmark_*>\n"
+                    " -h:          Display this massage and exit\n"
+                    " -device_id:  GPU device ID. Default is {}\n"
+                    " The --benchmark_* options (e.g., --benchmark_filter, "
+                    "--benchmark_out) are those of Google Benchmark",
+                    device_id);
+        // clang-format on
+        exit(EXIT_SUCCESS);
+    }
+
+    cuda_query(device_id);
+
+    // the construction of every mesh is verbose and would interleave with the
+    // benchmark output
+    Log::set_level(spdlog::level::warn);
+
+    ::benchmark::RunSpecifiedBenchmarks();
+    ::benchmark::Shutdown();
+
+    return 0;
+}
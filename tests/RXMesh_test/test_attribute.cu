@@ -1,5 +1,6 @@
 #include "gtest/gtest.h"
 #include "rxmesh/attribute.h"
+#include "rxmesh/attribute_expr.h"
 #include "rxmesh/reduce_handle.h"
 #include "rxmesh/rxmesh_static.h"
 #include "rxmesh/util/macros.h"
@@ -53,6 +54,34 @@ void populate(rxmesh::RXMeshStatic&       rx,
     ASSERT_EQ(cudaDeviceSynchronize(), cudaSuccess);
 }
 
+template <uint32_t blockThreads>
+__global__ static void ensemble_vv_sum(const rxmesh::Context          context,
+                                       rxmesh::VertexAttribute<float> x,
+                                       rxmesh::VertexAttribute<float> sum)
+{
+    using namespace rxmesh;
+
+    auto block = cooperative_groups::this_thread_block();
+
+    Query<blockThreads> query(context);
+
+    ShmemAllocator shrd_alloc;
+
+    query.dispatch_samples<Op::VV>(
+        block,
+        shrd_alloc,
+        x.get_num_samples(),
+        [&](const VertexHandle&   vh,
+            const VertexIterator& iter,
+            const uint32_t        s) {
+            float acc = 0;
+            for (uint16_t i = 0; i < iter.size(); ++i) {
+                acc += x(iter[i], 0, s);
+            }
+            sum(vh, 0, s) = acc;
+        });
+}
+
 TEST(Attribute, Norm2)
 {
     using namespace rxmesh;
@@ -102,6 +131,171 @@ TEST(Attribute, Dot)
     EXPECT_FLOAT_EQ(output, v1_val * v2_val * rx.get_num_vertices());
 }
 
+TEST(Attribute, BatchReduce)
+{
+    using namespace rxmesh;
+
+    RXMeshStatic rx(STRINGIFY(INPUT_DIR) "sphere3.obj");
+
+    auto v1_attr = rx.add_vertex_attribute<float>("v1", 3, rxmesh::DEVICE);
+    auto v2_attr = rx.add_vertex_attribute<float>("v2", 3, rxmesh::DEVICE);
+
+    populate<float>(rx, *v1_attr, *v2_attr, 2.f, 3.f);
+
+    ReduceHandle reduce_handle(*v1_attr);
+
+    ReduceBatch<float, VertexHandle> batch;
+
+    const uint32_t i_dot   = batch.dot(*v1_attr, *v2_attr);
+    const uint32_t i_norm1 = batch.norm2(*v1_attr);
+    const uint32_t i_norm2 = batch.norm2(*v2_attr, 1);
+
+    EXPECT_EQ(batch.size, 3);
+
+    const std::vector<float> output = reduce_handle.batch_reduce(batch);
+
+    EXPECT_FLOAT_EQ(output[i_dot], reduce_handle.dot(*v1_attr, *v2_attr));
+    EXPECT_FLOAT_EQ(output[i_norm1], reduce_handle.norm2(*v1_attr));
+    EXPECT_FLOAT_EQ(output[i_norm2], reduce_handle.norm2(*v2_attr, 1));
+
+    // the same but without blocking
+    float* h_output;
+    CUDA_ERROR(cudaMallocHost((void**)&h_output, batch.size * sizeof(float)));
+
+    const float* d_output =
+        reduce_handle.batch_reduce_async(batch, nullptr, h_output);
+    EXPECT_NE(d_output, nullptr);
+
+    CUDA_ERROR(cudaDeviceSynchronize());
+
+    for (uint32_t r = 0; r < batch.size; ++r) {
+        EXPECT_FLOAT_EQ(h_output[r], output[r]);
+    }
+
+    CUDA_ERROR(cudaFreeHost(h_output));
+
+    ASSERT_EQ(cudaDeviceSynchronize(), cudaSuccess);
+}
+
+TEST(Attribute, FusedExpression)
+{
+    using namespace rxmesh;
+
+    RXMeshStatic rx(STRINGIFY(INPUT_DIR) "sphere3.obj");
+
+    auto x = rx.add_vertex_attribute<float>("x", 3);
+    auto p = rx.add_vertex_attribute<float>("p", 3);
+    auto r = rx.add_vertex_attribute<float>("r", 3);
+
+    x->reset(2.f, DEVICE);
+    p->reset(3.f, DEVICE);
+    r->reset(1.f, DEVICE);
+
+    float* d_alpha;
+    CUDA_ERROR(cudaMalloc((void**)&d_alpha, sizeof(float)));
+    const float h_alpha = 0.5f;
+    CUDA_ERROR(
+        cudaMemcpy(d_alpha, &h_alpha, sizeof(float), cudaMemcpyHostToDevice));
+
+    // x = x + 0.5 * p = 3.5 and r = r - alpha * p = -0.5
+    evaluate(rx,
+             NULL,
+             assign(*x, expr(*x) + 0.5f * expr(*p)),
+             assign(*r, expr(*r) - device_scalar(d_alpha) * expr(*p)));
+
+    // p = 2 * p = 6 and <r, x> = -1.75 * 3 per vertex
+    ReduceHandle reduce_handle(*x);
+
+    const float dot = reduce_handle.evaluate_dot(
+        expr(*r), expr(*x), NULL, assign(*p, 2.f * expr(*p)));
+
+    EXPECT_FLOAT_EQ(dot, -1.75f * 3.f * rx.get_num_vertices());
+
+    x->move(DEVICE, HOST);
+    p->move(DEVICE, HOST);
+    r->move(DEVICE, HOST);
+
+    rx.for_each_vertex(HOST, [&](const VertexHandle vh) {
+        for (uint32_t i = 0; i < 3; ++i) {
+            EXPECT_FLOAT_EQ((*x)(vh, i), 3.5f);
+            EXPECT_FLOAT_EQ((*p)(vh, i), 6.f);
+            EXPECT_FLOAT_EQ((*r)(vh, i), -0.5f);
+        }
+    });
+
+    GPU_FREE(d_alpha);
+
+    ASSERT_EQ(cudaDeviceSynchronize(), cudaSuccess);
+}
+
+TEST(Attribute, LabelReduce)
+{
+    using namespace rxmesh;
+
+    RXMeshStatic rx(STRINGIFY(INPUT_DIR) "sphere3.obj");
+
+    auto attr   = rx.add_vertex_attribute<float>("v", 1);
+    auto labels = rx.add_vertex_attribute<uint32_t>("l", 1);
+
+    const uint32_t num_labels = 3;
+
+    std::vector<float>    expected_sum(num_labels, 0);
+    std::vector<uint32_t> expected_count(num_labels, 0);
+    std::vector<float>    expected_patch(rx.get_num_patches(), 0);
+
+    rx.for_each_vertex(HOST, [&](const VertexHandle vh) {
+        const uint32_t l = vh.patch_id() % num_labels;
+        (*labels)(vh)    = l;
+        (*attr)(vh)      = 2.f;
+        expected_sum[l] += 2.f;
+        expected_count[l]++;
+        expected_patch[vh.patch_id()] += 2.f;
+    });
+    attr->move(HOST, DEVICE);
+    labels->move(HOST, DEVICE);
+
+    ReduceHandle reduce_handle(*attr);
+
+    const std::vector<float> sum =
+        reduce_handle.label_sum(*attr, *labels, num_labels);
+
+    float*    d_sum;
+    uint32_t* d_count;
+    CUDA_ERROR(cudaMalloc((void**)&d_sum, num_labels * sizeof(float)));
+    CUDA_ERROR(cudaMalloc((void**)&d_count, num_labels * sizeof(uint32_t)));
+
+    reduce_handle.label_sum_async(*attr, *labels, num_labels, d_sum, d_count);
+
+    std::vector<uint32_t> count(num_labels);
+    CUDA_ERROR(cudaMemcpy(count.data(),
+                          d_count,
+                          num_labels * sizeof(uint32_t),
+                          cudaMemcpyDeviceToHost));
+
+    for (uint32_t l = 0; l < num_labels; ++l) {
+        EXPECT_FLOAT_EQ(sum[l], expected_sum[l]);
+        EXPECT_EQ(count[l], expected_count[l]);
+    }
+
+    const float* d_patch =
+        reduce_handle.per_patch_reduce_async(*attr, cub::Sum(), 0.f);
+
+    std::vector<float> patch(rx.get_num_patches());
+    CUDA_ERROR(cudaMemcpy(patch.data(),
+                          d_patch,
+                          patch.size() * sizeof(float),
+                          cudaMemcpyDeviceToHost));
+
+    for (uint32_t p = 0; p < rx.get_num_patches(); ++p) {
+        EXPECT_FLOAT_EQ(patch[p], expected_patch[p]);
+    }
+
+    GPU_FREE(d_sum);
+    GPU_FREE(d_count);
+
+    ASSERT_EQ(cudaDeviceSynchronize(), cudaSuccess);
+}
+
 TEST(Attribute, Reduce)
 {
     using namespace rxmesh;
@@ -202,6 +396,104 @@ TEST(Attribute, CopyFrom)
         HOST, [&](const FaceHandle fh) { EXPECT_EQ((*f_host)(fh), val); });
 }
 
+TEST(Attribute, HalfStorage)
+{
+    using namespace rxmesh;
+
+    RXMeshStatic rx(STRINGIFY(INPUT_DIR) "sphere3.obj");
+
+    auto v_float = *rx.add_vertex_attribute<float>("f", 3);
+    auto v_half  = *rx.add_vertex_attribute<__half>("h", 3);
+    auto v_out   = *rx.add_vertex_attribute<float>("o", 3);
+
+    const float val(2.0);
+
+    populate<float>(rx, v_float, val);
+
+    v_half.copy_from(v_float, DEVICE, DEVICE);
+
+    // read the half attribute as float
+    rx.for_each_vertex(
+        DEVICE, [v_half, v_out] __device__(const VertexHandle vh) mutable {
+            const vec3<float> p = v_half.to_glm<3>(vh);
+            v_out.from_glm(vh, p * 2.f);
+        });
+
+    ReduceHandle reduce_handle(v_half);
+
+    const float output = reduce_handle.norm2(v_half, 0);
+
+    EXPECT_FLOAT_EQ(output, std::sqrt(val * val * rx.get_num_vertices()));
+
+    v_out.move(DEVICE, HOST);
+    v_half.copy_from(v_out, HOST, HOST);
+    v_float.copy_from(v_half, HOST, DEVICE);
+    v_float.move(DEVICE, HOST);
+
+    rx.for_each_vertex(HOST, [&](const VertexHandle vh) {
+        EXPECT_FLOAT_EQ(v_out(vh, 0), 2.f * val);
+        EXPECT_FLOAT_EQ(v_float(vh, 0), 2.f * val);
+    });
+
+    ASSERT_EQ(cudaDeviceSynchronize(), cudaSuccess);
+}
+
+TEST(Attribute, HostMirror)
+{
+    using namespace rxmesh;
+
+    RXMeshStatic rx(STRINGIFY(INPUT_DIR) "sphere3.obj");
+
+    ASSERT_GT(rx.get_num_patches(), 1);
+
+    auto attr = rx.add_vertex_attribute<float>("v_attr", 3, DEVICE);
+
+    rx.for_each_vertex(
+        DEVICE, [attr = *attr] __device__(const VertexHandle vh) mutable {
+            for (int i = 0; i < 3; ++i) {
+                attr(vh, i) = float(vh.local_id() + i);
+            }
+        });
+
+    // the first mirroring allocates the host and transfers everything
+    attr->mirror_to_host();
+    attr->wait_host_mirror();
+    EXPECT_TRUE(attr->is_host_mirror_done());
+    EXPECT_EQ(attr->get_num_mirrored_patches(), rx.get_num_patches());
+
+    rx.for_each_vertex(HOST, [&](const VertexHandle vh) {
+        for (int i = 0; i < 3; ++i) {
+            EXPECT_EQ((*attr)(vh, i), float(vh.local_id() + i));
+        }
+    });
+
+    // nothing changed
+    attr->mirror_to_host();
+    attr->wait_host_mirror();
+    EXPECT_EQ(attr->get_num_mirrored_patches(), 0);
+
+    // only change one patch
+    rx.for_each_vertex(
+        DEVICE, [attr = *attr] __device__(const VertexHandle vh) mutable {
+            if (vh.patch_id() == 0) {
+                attr(vh, 0) = -1.f;
+            }
+        });
+
+    attr->move(DEVICE, HOST);
+    EXPECT_EQ(attr->get_num_mirrored_patches(), 1);
+
+    rx.for_each_vertex(HOST, [&](const VertexHandle vh) {
+        const float expected =
+            (vh.patch_id() == 0) ? -1.f : float(vh.local_id());
+        EXPECT_EQ((*attr)(vh, 0), expected);
+    });
+
+    ASSERT_EQ(cudaDeviceSynchronize(), cudaSuccess);
+
+    rx.remove_attribute("v_attr");
+}
+
 TEST(Attribute, AddingAndRemoving)
 {
     using namespace rxmesh;
@@ -223,4 +515,48 @@ TEST(Attribute, AddingAndRemoving)
     // this is not neccessary in general but we are just testing the
     // functionality here
     rx.remove_attribute(attr_name);
-}
\ No newline at end of file
+}
+TEST(Attribute, Ensemble)
+{
+    using namespace rxmesh;
+
+    RXMeshStatic rx(STRINGIFY(INPUT_DIR) "sphere3.obj");
+
+    constexpr uint32_t num_samples = 16;
+
+    auto x =
+        rx.add_ensemble_attribute<float, VertexHandle>("x", 1, num_samples);
+    auto sum = rx.add_attribute_like("sum", *x);
+
+    EXPECT_EQ(x->get_num_samples(), num_samples);
+    EXPECT_EQ(x->get_num_sample_attributes(), 1);
+    EXPECT_EQ(x->get_num_attributes(), num_samples);
+    EXPECT_EQ(sum->get_num_samples(), num_samples);
+
+    auto coords = *rx.get_input_vertex_coordinates();
+    auto x_d    = *x;
+
+    // sample s is the x coordinates scaled by s + 1
+    rx.for_each_sample<VertexHandle>(
+        DEVICE,
+        num_samples,
+        [coords, x_d] __device__(const VertexHandle vh,
+                                 const uint32_t     s) mutable {
+            x_d(vh, 0, s) = float(s + 1) * coords(vh, 0);
+        });
+
+    rx.run_kernel<256>({Op::VV}, ensemble_vv_sum<256>, *x, *sum);
+
+    sum->move(DEVICE, HOST);
+
+    rx.for_each_vertex(HOST, [&](const VertexHandle vh) {
+        const float s0 = (*sum)(vh, 0, 0);
+        for (uint32_t s = 0; s < num_samples; ++s) {
+            EXPECT_NEAR((*sum)(vh, 0, s),
+                        float(s + 1) * s0,
+                        1e-4f * float(s + 1) * std::max(1.f, std::abs(s0)));
+        }
+    });
+
+    ASSERT_EQ(cudaDeviceSynchronize(), cudaSuccess);
+}
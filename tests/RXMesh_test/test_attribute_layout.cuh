@@ -0,0 +1,78 @@
+#include "gtest/gtest.h"
+
+#include "rxmesh/rxmesh_static.h"
+#include "rxmesh/util/timer.h"
+
+template <uint32_t blockThreads>
+float attribute_layout_throughput(rxmesh::RXMeshStatic& rx,
+                                  rxmesh::layoutT       layout,
+                                  const uint32_t        num_run)
+{
+    using namespace rxmesh;
+
+    auto coords = rx.get_input_vertex_coordinates();
+
+    auto attr = rx.add_vertex_attribute<float>(
+        "attr_" + layout_to_string(layout), 3, DEVICE, layout);
+
+    attr->copy_from(*coords, DEVICE, DEVICE);
+
+    float total_time = 0;
+
+    for (uint32_t itr = 0; itr < num_run; itr++) {
+        GPUTimer timer;
+        timer.start();
+        rx.for_each_vertex(
+            DEVICE,
+            [attr = *attr] __device__(const VertexHandle vh) mutable {
+                vec3<float> v = attr.load<3>(vh);
+                attr.store<3>(vh, 2.f * v);
+            });
+        timer.stop();
+        CUDA_ERROR(cudaDeviceSynchronize());
+        CUDA_ERROR(cudaGetLastError());
+        total_time += timer.elapsed_millis();
+    }
+
+    // verify
+    attr->move(DEVICE, HOST);
+
+    const float scale = std::pow(2.f, float(num_run));
+
+    uint32_t num_mismatch = 0;
+    rx.for_each_vertex(HOST, [&](const VertexHandle vh) {
+        for (uint32_t i = 0; i < 3; ++i) {
+            if (std::abs((*attr)(vh, i) - scale * (*coords)(vh, i)) >
+                1e-5 * scale) {
+                num_mismatch++;
+            }
+        }
+    });
+    EXPECT_EQ(num_mismatch, 0);
+
+    rx.remove_attribute("attr_" + layout_to_string(layout));
+
+    return total_time / float(num_run);
+}
+
+TEST(Attribute, LayoutThroughput)
+{
+    using namespace rxmesh;
+
+    // make sure the scaled coordinates do not overflow
+    const uint32_t num_run = std::min(rxmesh_args.num_run, 32u);
+
+    RXMeshStatic rx(rxmesh_args.obj_file_name);
+
+    for (layoutT layout : {SoA, AoS, AoSPadded}) {
+        const float time =
+            attribute_layout_throughput<256>(rx, layout, num_run);
+
+        const float bytes = 2.f * sizeof(float) * 3 * rx.get_num_vertices();
+
+        RXMESH_INFO("{} for_each_vertex read/write vec3 = {} (ms), {} (GB/s)",
+                    layout_to_string(layout),
+                    time,
+                    bytes / (time * 1e6));
+    }
+}
@@ -0,0 +1,72 @@
+#include "gtest/gtest.h"
+
+#include "rxmesh/rxmesh_batch.h"
+
+TEST(RXMeshBatch, Batch)
+{
+    using namespace rxmesh;
+
+    CUDA_ERROR(cudaDeviceReset());
+
+    const std::vector<std::string> files = {
+        STRINGIFY(INPUT_DIR) "sphere3.obj",
+        STRINGIFY(INPUT_DIR) "bunnyhead.obj",
+        STRINGIFY(INPUT_DIR) "sphere3.obj",
+        STRINGIFY(INPUT_DIR) "torus.obj"};
+
+    RXMeshBatch rx(files, 256);
+
+    ASSERT_EQ(rx.get_num_meshes(), files.size());
+
+    const uint32_t* mesh_patch_offset = rx.get_mesh_patch_offset();
+    EXPECT_EQ(mesh_patch_offset[0], 0);
+    EXPECT_EQ(mesh_patch_offset[rx.get_num_meshes()], rx.get_num_patches());
+
+    uint32_t num_vertices(0), num_faces(0);
+    for (uint32_t m = 0; m < rx.get_num_meshes(); ++m) {
+        RXMeshStatic single(files[m]);
+        EXPECT_EQ(rx.get_mesh_num_vertices(m), single.get_num_vertices());
+        EXPECT_EQ(rx.get_mesh_num_faces(m), single.get_num_faces());
+        EXPECT_GT(rx.get_mesh_num_patches(m), 0);
+        num_vertices += rx.get_mesh_num_vertices(m);
+        num_faces += rx.get_mesh_num_faces(m);
+    }
+    EXPECT_EQ(num_vertices, rx.get_num_vertices());
+    EXPECT_EQ(num_faces, rx.get_num_faces());
+
+    // every face/vertex lives in a patch of its own mesh
+    rx.for_each_face(HOST, [&](const FaceHandle& fh) {
+        const uint32_t f = rx.map_to_global(fh);
+        const uint32_t m = rx.get_mesh_id(fh);
+        EXPECT_GE(f, rx.get_mesh_face_offset(m));
+        EXPECT_LT(f, rx.get_mesh_face_offset(m) + rx.get_mesh_num_faces(m));
+    });
+
+    rx.for_each_vertex(HOST, [&](const VertexHandle& vh) {
+        const uint32_t v = rx.map_to_global(vh);
+        const uint32_t m = rx.get_mesh_id(vh);
+        EXPECT_GE(v, rx.get_mesh_vertex_offset(m));
+        EXPECT_LT(v,
+                  rx.get_mesh_vertex_offset(m) + rx.get_mesh_num_vertices(m));
+    });
+
+    // per-mesh reduction in a single launch
+    auto attr = rx.add_vertex_attribute<float>("v", 1, DEVICE);
+    attr->reset(1.f, DEVICE);
+
+    ReduceHandle reduce_handle(*attr);
+
+    std::vector<float> num_v =
+        rx.reduce_per_mesh(reduce_handle, *attr, cub::Sum(), 0.f);
+
+    std::vector<float> dot = rx.dot_per_mesh(reduce_handle, *attr, *attr);
+
+    ASSERT_EQ(cudaDeviceSynchronize(), cudaSuccess);
+
+    ASSERT_EQ(num_v.size(), rx.get_num_meshes());
+    ASSERT_EQ(dot.size(), rx.get_num_meshes());
+    for (uint32_t m = 0; m < rx.get_num_meshes(); ++m) {
+        EXPECT_FLOAT_EQ(num_v[m], float(rx.get_mesh_num_vertices(m)));
+        EXPECT_FLOAT_EQ(dot[m], float(rx.get_mesh_num_vertices(m)));
+    }
+}
@@ -1,3 +1,5 @@
+#include <array>
+
 #include "gtest/gtest.h"
 
 #include "rxmesh/rxmesh_static.h"
@@ -31,4 +33,67 @@ TEST(RXMeshStatic, BoundaryVertex)
     // polyscope::show();
 
     EXPECT_EQ(cudaDeviceSynchronize(), cudaSuccess);
-}
\ No newline at end of file
+}
+TEST(RXMeshStatic, ElementFlags)
+{
+    using namespace rxmesh;
+
+    RXMeshStatic rx(STRINGIFY(INPUT_DIR) "bunnyhead.obj");
+
+    auto coords = rx.get_input_vertex_coordinates();
+
+    rx.update_element_flags(*coords);
+
+    auto v_flags = rx.get_vertex_flags();
+    auto e_flags = rx.get_edge_flags();
+    ASSERT_NE(v_flags, nullptr);
+    ASSERT_NE(e_flags, nullptr);
+
+    auto count = [&]() {
+        v_flags->move(DEVICE, HOST);
+        e_flags->move(DEVICE, HOST);
+
+        std::array<uint32_t, 4> ret = {0, 0, 0, 0};
+
+        rx.for_each_vertex(
+            HOST,
+            [&](const VertexHandle& vh) {
+                ret[0] += has_flag((*v_flags)(vh), ElementFlag::Boundary);
+                ret[1] += has_flag((*v_flags)(vh), ElementFlag::Feature);
+            },
+            NULL,
+            false);
+        rx.for_each_edge(
+            HOST,
+            [&](const EdgeHandle& eh) {
+                ret[2] += has_flag((*e_flags)(eh), ElementFlag::Boundary);
+                ret[3] += has_flag((*e_flags)(eh), ElementFlag::Feature);
+            },
+            NULL,
+            false);
+        return ret;
+    };
+
+    // the boundary of bunnyhead is made of closed loops
+    auto c = count();
+    EXPECT_EQ(c[0], 98);
+    EXPECT_EQ(c[2], 98);
+    EXPECT_EQ(c[1], 0);
+    EXPECT_EQ(c[3], 0);
+
+    // every interior edge is a feature edge with a zero threshold (unless its
+    // faces are exactly coplanar) and a boundary edge is never a feature edge
+    rx.update_element_flags(*coords, 0.f);
+    c = count();
+    EXPECT_EQ(c[0], 98);
+    EXPECT_EQ(c[2], 98);
+    EXPECT_GT(c[3], 0);
+    EXPECT_LE(c[3], rx.get_num_edges() - 98);
+
+    // nothing to update
+    rx.update_element_flags(*coords, 0.f);
+    auto c1 = count();
+    EXPECT_EQ(c, c1);
+
+    EXPECT_EQ(cudaDeviceSynchronize(), cudaSuccess);
+}
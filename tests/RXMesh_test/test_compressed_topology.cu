@@ -0,0 +1,128 @@
+#include "gtest/gtest.h"
+
+#include "rxmesh/rxmesh_static.h"
+
+template <rxmesh::Op op,
+          typename HandleT = typename rxmesh::InputHandle<op>::type>
+void topology_query_sum(rxmesh::RXMeshStatic&                 rx,
+                        rxmesh::Attribute<uint32_t, HandleT>& attr)
+{
+    using namespace rxmesh;
+    using IteratorT = typename IteratorType<op>::type;
+
+    auto a = attr;
+
+    // order-dependent checksum of the query output
+    rx.run_query_kernel<op, 256>(
+        [a] __device__(const HandleT& h, const IteratorT& iter) mutable {
+            uint32_t s = 0;
+            for (uint32_t i = 0; i < iter.size(); ++i) {
+                s = 31 * s + iter[i].patch_id() * 65536 + iter[i].local_id();
+            }
+            a(h) = s;
+        });
+}
+
+template <rxmesh::Op op>
+void check_compressed_topology(rxmesh::RXMeshStatic& rx)
+{
+    using namespace rxmesh;
+    using HandleT = typename InputHandle<op>::type;
+
+    auto gt         = rx.add_attribute<uint32_t, HandleT>("gt", 1);
+    auto compressed = rx.add_attribute<uint32_t, HandleT>("compressed", 1);
+
+    rx.disable_compressed_topology();
+    topology_query_sum<op>(rx, *gt);
+
+    ASSERT_TRUE(rx.enable_compressed_topology());
+    EXPECT_TRUE(rx.is_topology_compressed());
+    topology_query_sum<op>(rx, *compressed);
+
+    CUDA_ERROR(cudaDeviceSynchronize());
+
+    gt->move(DEVICE, HOST);
+    compressed->move(DEVICE, HOST);
+
+    rx.for_each<HandleT>(HOST, [&](const HandleT h) {
+        EXPECT_EQ((*gt)(h), (*compressed)(h));
+    });
+
+    rx.remove_attribute("gt");
+    rx.remove_attribute("compressed");
+}
+
+TEST(RXMeshStatic, CompressedTopology)
+{
+    using namespace rxmesh;
+
+    // small patches such that the local indices fit in 8-bit
+    RXMeshStatic rx(STRINGIFY(INPUT_DIR) "sphere3.obj", "", false, 32);
+
+    if (!rx.enable_compressed_topology()) {
+        GTEST_SKIP() << "patch capacities do not fit in 8-bit";
+    }
+
+    check_compressed_topology<Op::VV>(rx);
+    check_compressed_topology<Op::VE>(rx);
+    check_compressed_topology<Op::VF>(rx);
+    check_compressed_topology<Op::EV>(rx);
+    check_compressed_topology<Op::EF>(rx);
+    check_compressed_topology<Op::FV>(rx);
+    check_compressed_topology<Op::FE>(rx);
+    check_compressed_topology<Op::FF>(rx);
+
+    rx.disable_compressed_topology();
+    EXPECT_FALSE(rx.is_topology_compressed());
+
+    ASSERT_EQ(cudaDeviceSynchronize(), cudaSuccess);
+}
+
+template <rxmesh::Op op>
+void check_owner_table(rxmesh::RXMeshStatic& rx)
+{
+    using namespace rxmesh;
+    using HandleT = typename InputHandle<op>::type;
+
+    auto gt     = rx.add_attribute<uint32_t, HandleT>("gt", 1);
+    auto direct = rx.add_attribute<uint32_t, HandleT>("direct", 1);
+
+    rx.disable_owner_table();
+    topology_query_sum<op>(rx, *gt);
+
+    rx.enable_owner_table();
+    EXPECT_TRUE(rx.has_owner_table());
+    topology_query_sum<op>(rx, *direct);
+
+    CUDA_ERROR(cudaDeviceSynchronize());
+
+    gt->move(DEVICE, HOST);
+    direct->move(DEVICE, HOST);
+
+    rx.for_each<HandleT>(
+        HOST, [&](const HandleT h) { EXPECT_EQ((*gt)(h), (*direct)(h)); });
+
+    rx.remove_attribute("gt");
+    rx.remove_attribute("direct");
+}
+
+TEST(RXMeshStatic, OwnerTable)
+{
+    using namespace rxmesh;
+
+    RXMeshStatic rx(STRINGIFY(INPUT_DIR) "sphere3.obj");
+
+    check_owner_table<Op::VV>(rx);
+    check_owner_table<Op::VE>(rx);
+    check_owner_table<Op::VF>(rx);
+    check_owner_table<Op::EV>(rx);
+    check_owner_table<Op::EF>(rx);
+    check_owner_table<Op::FV>(rx);
+    check_owner_table<Op::FE>(rx);
+    check_owner_table<Op::FF>(rx);
+
+    rx.disable_owner_table();
+    EXPECT_FALSE(rx.has_owner_table());
+
+    ASSERT_EQ(cudaDeviceSynchronize(), cudaSuccess);
+}
@@ -0,0 +1,41 @@
+#include "gtest/gtest.h"
+
+#include "rxmesh/corner_table.h"
+#include "rxmesh/rxmesh_static.h"
+
+TEST(RXMeshStatic, CornerTable)
+{
+    using namespace rxmesh;
+
+    RXMeshStatic rx(STRINGIFY(INPUT_DIR) "sphere3.obj", "", false, 64);
+
+    CornerTable ct(rx);
+
+    ASSERT_EQ(ct.get_num_corners(), 3 * rx.get_num_faces());
+    EXPECT_EQ(ct.get_num_non_manifold_edges(), 0);
+
+    std::vector<uint32_t> V, O, E;
+    ct.to_host(V, O, E);
+
+    for (uint32_t c = 0; c < ct.get_num_corners(); ++c) {
+        EXPECT_LT(V[c], rx.get_num_vertices());
+        EXPECT_LT(E[c], rx.get_num_edges());
+        EXPECT_NE(V[c], V[CornerTable::next(c)]);
+
+        // sphere3 is closed so every corner has an opposite
+        ASSERT_NE(O[c], INVALID32);
+        EXPECT_EQ(O[O[c]], c);
+        EXPECT_NE(CornerTable::face(O[c]), CornerTable::face(c));
+
+        // the twin half-edge has the same edge in the opposite direction
+        const uint32_t h = CornerTable::next(c);
+        const uint32_t t = CornerTable::next(O[c]);
+        EXPECT_EQ(E[h], E[t]);
+        EXPECT_EQ(V[h], V[CornerTable::next(t)]);
+        EXPECT_EQ(V[CornerTable::next(h)], V[t]);
+    }
+
+    ct.release();
+
+    ASSERT_EQ(cudaDeviceSynchronize(), cudaSuccess);
+}
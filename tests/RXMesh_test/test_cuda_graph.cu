@@ -0,0 +1,61 @@
+#include "gtest/gtest.h"
+
+#include "rxmesh/cuda_graph.h"
+#include "rxmesh/reduce_handle.h"
+#include "rxmesh/rxmesh_static.h"
+
+TEST(RXMeshStatic, CUDAGraph)
+{
+    using namespace rxmesh;
+
+    RXMeshStatic rx(STRINGIFY(INPUT_DIR) "sphere3.obj");
+
+    auto x = *rx.add_vertex_attribute<float>("x", 1);
+    x.reset(1.f, DEVICE);
+
+    VertexReduceHandle<float> rh(x);
+
+    float* d_norm;
+    CUDA_ERROR(cudaMalloc((void**)&d_norm, sizeof(float)));
+
+    cudaStream_t stream;
+    CUDA_ERROR(cudaStreamCreate(&stream));
+
+    // one "iteration" halves x and computes its norm on the device
+    CUDAGraph graph;
+    graph.capture(stream, [&](cudaStream_t st) {
+        rx.for_each_vertex(
+            DEVICE,
+            [x] __device__(const VertexHandle vh) mutable { x(vh) *= 0.5f; },
+            st);
+        rh.norm2_async(x, d_norm, INVALID32, st);
+    });
+
+    ASSERT_TRUE(graph.is_captured());
+
+    graph.launch(stream, 3);
+    CUDA_ERROR(cudaStreamSynchronize(stream));
+
+    float norm = 0;
+    CUDA_ERROR(
+        cudaMemcpy(&norm, d_norm, sizeof(float), cudaMemcpyDeviceToHost));
+
+    const float n0 = std::sqrt(float(rx.get_num_vertices()));
+    EXPECT_NEAR(norm, n0 / 8.f, 1e-3f * n0);
+
+    // after k more launches the norm is n0 / 2^(3 + k)
+    const uint32_t num_launches =
+        graph.launch_until(d_norm, n0 / 100.f, 100, 1, stream);
+    EXPECT_EQ(num_launches, 4);
+
+    x.move(DEVICE, HOST);
+    rx.for_each_vertex(HOST, [&](const VertexHandle vh) {
+        EXPECT_NEAR(x(vh), 1.f / 128.f, 1e-6f);
+    });
+
+    graph.release();
+    GPU_FREE(d_norm);
+    CUDA_ERROR(cudaStreamDestroy(stream));
+
+    ASSERT_EQ(cudaDeviceSynchronize(), cudaSuccess);
+}
@@ -1,7 +1,9 @@
 #include "gtest/gtest.h"
 
+#include "rxmesh/dlpack.h"
 #include "rxmesh/rxmesh_static.h"
 
+#include "rxmesh/matrix/batched_dense_matrix.h"
 #include "rxmesh/matrix/dense_matrix.h"
 
 TEST(RXMeshStatic, DenseMatrixToEigen)
@@ -313,3 +315,222 @@ TEST(RXMeshStatic, DenseMatrixSlice)
 
     mat.release();
 }
+
+template <int Order>
+void dense_matrix_attribute_view()
+{
+    using namespace rxmesh;
+
+    RXMeshStatic rx(STRINGIFY(INPUT_DIR) "sphere3.obj");
+
+    DenseMatrix<float, Order> mat(rx, rx.get_num_vertices(), 3);
+    mat.reset(0, LOCATION_ALL);
+
+    auto view = rx.add_attribute_view<VertexHandle>("view", mat);
+
+    ASSERT_NE(view, nullptr);
+    EXPECT_TRUE(view->is_view());
+
+    rx.for_each_vertex(
+        DEVICE, [view = *view] __device__(const VertexHandle vh) mutable {
+            for (int i = 0; i < 3; ++i) {
+                view(vh, i) = float(vh.local_id() + i);
+            }
+        });
+
+    // the kernel output is in the matrix without any copy
+    mat.move(DEVICE, HOST);
+
+    rx.for_each_vertex(HOST, [&](const VertexHandle vh) {
+        for (int i = 0; i < 3; ++i) {
+            EXPECT_EQ(mat(vh, i), float(vh.local_id() + i));
+            EXPECT_EQ((*view)(vh, i), float(vh.local_id() + i));
+        }
+    });
+
+    // and the other way around
+    auto mat_view = view->template as_matrix<Order>();
+    ASSERT_NE(mat_view, nullptr);
+    EXPECT_EQ(mat_view->data(DEVICE), mat.data(DEVICE));
+    EXPECT_EQ(mat_view->data(HOST), mat.data(HOST));
+
+    rx.remove_attribute("view");
+
+    mat.release();
+
+    ASSERT_EQ(cudaDeviceSynchronize(), cudaSuccess);
+}
+
+TEST(RXMeshStatic, DenseMatrixAttributeView)
+{
+    dense_matrix_attribute_view<Eigen::ColMajor>();
+    dense_matrix_attribute_view<Eigen::RowMajor>();
+}
+
+TEST(RXMeshStatic, BatchedDenseMatrix)
+{
+    using namespace rxmesh;
+
+    using T = double;
+
+    RXMeshStatic rx(STRINGIFY(INPUT_DIR) "sphere3.obj");
+
+    constexpr int n = 4;
+
+    // one matrix per patch
+    auto R = BatchedDenseMatrix<T>::per_patch(rx, n, n);
+    auto A = BatchedDenseMatrix<T>::per_patch(rx, n, n);
+    auto L = BatchedDenseMatrix<T>::per_patch(rx, n, n);
+    auto b = BatchedDenseMatrix<T>::per_patch(rx, n, 1);
+    auto x = BatchedDenseMatrix<T>::per_patch(rx, n, 1);
+
+    const int batch = A.batch_size();
+    EXPECT_EQ(batch, int(rx.get_num_patches()));
+
+    R.fill_random();
+    b.fill_random();
+
+    // A = R^T * R + n * I is SPD
+    A.reset(0, LOCATION_ALL);
+    for (int p = 0; p < batch; ++p) {
+        for (int i = 0; i < n; ++i) {
+            A(p, i, i) = n;
+        }
+    }
+    A.move(HOST, DEVICE);
+    A.gemm(R, R, T(1), T(1), CUBLAS_OP_T, CUBLAS_OP_N);
+    A.move(DEVICE, HOST);
+
+    for (int p = 0; p < batch; ++p) {
+        Eigen::Matrix<T, n, n> ref =
+            R.to_eigen(p).transpose() * R.to_eigen(p) +
+            T(n) * Eigen::Matrix<T, n, n>::Identity();
+        EXPECT_TRUE(ref.isApprox(A.to_eigen(p)));
+    }
+
+    // Cholesky
+    L.copy_from(A, DEVICE, DEVICE);
+    x.copy_from(b, DEVICE, DEVICE);
+    L.potrf();
+    L.potrs(x);
+    x.move(DEVICE, HOST);
+
+    for (int info : L.get_info()) {
+        EXPECT_EQ(info, 0);
+    }
+
+    for (int p = 0; p < batch; ++p) {
+        Eigen::Matrix<T, n, 1> res = A.to_eigen(p) * x.to_eigen(p);
+        EXPECT_TRUE(res.isApprox(b.to_eigen(p), 1e-9));
+    }
+
+    // LU
+    L.copy_from(A, DEVICE, DEVICE);
+    x.copy_from(b, DEVICE, DEVICE);
+    L.getrf();
+    L.getrs(x);
+    x.move(DEVICE, HOST);
+
+    for (int info : L.get_info()) {
+        EXPECT_EQ(info, 0);
+    }
+
+    for (int p = 0; p < batch; ++p) {
+        Eigen::Matrix<T, n, 1> res = A.to_eigen(p) * x.to_eigen(p);
+        EXPECT_TRUE(res.isApprox(b.to_eigen(p), 1e-9));
+    }
+
+    R.release();
+    A.release();
+    L.release();
+    b.release();
+    x.release();
+
+    EXPECT_EQ(cudaDeviceSynchronize(), cudaSuccess);
+}
+
+TEST(RXMeshStatic, DLPack)
+{
+    using namespace rxmesh;
+
+    RXMeshStatic rx(STRINGIFY(INPUT_DIR) "sphere3.obj");
+
+    // dense matrix round trip with no copies
+    DenseMatrix<float> mat(rx, 10, 4);
+    mat.fill_random();
+
+    DLManagedTensor* mat_t = to_dlpack(mat, DEVICE);
+    ASSERT_NE(mat_t, nullptr);
+    EXPECT_EQ(mat_t->dl_tensor.device.device_type, kDLCUDA);
+    EXPECT_EQ(mat_t->dl_tensor.ndim, 2);
+    EXPECT_EQ(mat_t->dl_tensor.shape[0], 10);
+    EXPECT_EQ(mat_t->dl_tensor.shape[1], 4);
+    EXPECT_EQ(mat_t->dl_tensor.strides[0], 1);
+    EXPECT_EQ(mat_t->dl_tensor.strides[1], 10);
+    EXPECT_EQ(mat_t->dl_tensor.data, mat.data(DEVICE));
+
+    auto mat_in = dense_matrix_from_dlpack<float>(mat_t);
+    ASSERT_NE(mat_in, nullptr);
+    EXPECT_EQ(mat_in->rows(), 10);
+    EXPECT_EQ(mat_in->cols(), 4);
+    EXPECT_EQ(mat_in->data(DEVICE), mat.data(DEVICE));
+
+    // the layout does not match
+    EXPECT_EQ((dense_matrix_from_dlpack<float, Eigen::RowMajor>(mat_t)),
+              nullptr);
+    // the type does not match
+    EXPECT_EQ(dense_matrix_from_dlpack<double>(mat_t), nullptr);
+
+    mat_in->release();
+    mat_t->deleter(mat_t);
+
+    // attributes are compacted in linear_id() order
+    auto coords = rx.get_input_vertex_coordinates();
+
+    DLManagedTensor* h_t = to_dlpack(rx, *coords, HOST);
+    DLManagedTensor* d_t = to_dlpack(rx, *coords, DEVICE);
+    ASSERT_NE(h_t, nullptr);
+    ASSERT_NE(d_t, nullptr);
+    EXPECT_EQ(h_t->dl_tensor.shape[0], rx.get_num_vertices());
+    EXPECT_EQ(h_t->dl_tensor.shape[1], 3);
+
+    const size_t num = size_t(rx.get_num_vertices()) * 3;
+
+    std::vector<float> d_values(num);
+    CUDA_ERROR(cudaMemcpy(d_values.data(),
+                          d_t->dl_tensor.data,
+                          num * sizeof(float),
+                          cudaMemcpyDeviceToHost));
+
+    const float* h_values = static_cast<const float*>(h_t->dl_tensor.data);
+
+    rx.for_each_vertex(HOST, [&](const VertexHandle vh) {
+        const uint32_t i = rx.linear_id(vh);
+        for (uint32_t j = 0; j < 3; ++j) {
+            EXPECT_EQ(h_values[i * 3 + j], (*coords)(vh, j));
+            EXPECT_EQ(d_values[i * 3 + j], (*coords)(vh, j));
+        }
+    });
+
+    // import the compacted tensor as an attribute view
+    auto view = attribute_from_dlpack<VertexHandle, float>(rx, "view", h_t);
+    ASSERT_NE(view, nullptr);
+    EXPECT_TRUE(view->is_view());
+
+    rx.for_each_vertex(HOST, [&](const VertexHandle vh) {
+        for (uint32_t j = 0; j < 3; ++j) {
+            EXPECT_EQ((*view)(vh, j), (*coords)(vh, j));
+        }
+    });
+
+    // views are exported with no copies
+    DLManagedTensor* v_t = to_dlpack(rx, *view, HOST);
+    ASSERT_NE(v_t, nullptr);
+    EXPECT_EQ(v_t->dl_tensor.data, h_t->dl_tensor.data);
+
+    rx.remove_attribute("view");
+
+    v_t->deleter(v_t);
+    h_t->deleter(h_t);
+    d_t->deleter(d_t);
+}
@@ -1,8 +1,11 @@
 #include <assert.h>
+#include <filesystem>
 #include "gtest/gtest.h"
 
+#include "rxmesh/algo/make_delaunay.cuh"
 #include "rxmesh/cavity_manager.cuh"
 #include "rxmesh/kernels/for_each.cuh"
+#include "rxmesh/priority_queue.h"
 #include "rxmesh/query.cuh"
 #include "rxmesh/rxmesh_dynamic.h"
 
@@ -25,22 +28,26 @@ __global__ static void set_should_slice(rxmesh::Context context)
     }
 }
 
-template <uint32_t blockThreads>
-__global__ static void random_flips(rxmesh::Context                context,
-                                    rxmesh::VertexAttribute<float> coords,
-                                    rxmesh::EdgeAttribute<int>     to_flip)
+__global__ static void make_degenerate_edge(rxmesh::Context context,
+                                            const uint32_t  p,
+                                            const uint16_t  e)
 {
-    using namespace rxmesh;
-    auto           block = cooperative_groups::this_thread_block();
-    ShmemAllocator shrd_alloc;
-
-    CavityManager<blockThreads, CavityOp::E> cavity(
-        block, context, shrd_alloc, false);
-
+    // make the edge's two vertices the same
+    context.m_patches_info[p].ev[2 * e + 1].id =
+        context.m_patches_info[p].ev[2 * e + 0].id;
+}
 
-    if (cavity.patch_id() == INVALID32) {
-        return;
-    }
+template <uint32_t blockThreads, typename... AttributesT>
+__device__ __inline__ void flip_patch(
+    cooperative_groups::thread_block&                         block,
+    rxmesh::Context&                                          context,
+    rxmesh::CavityManager<blockThreads, rxmesh::CavityOp::E>& cavity,
+    rxmesh::ShmemAllocator&                                   shrd_alloc,
+    rxmesh::VertexAttribute<float>&                           coords,
+    rxmesh::EdgeAttribute<int>&                               to_flip,
+    AttributesT&... attributes)
+{
+    using namespace rxmesh;
 
     Query<blockThreads> query(context, cavity.patch_id());
     query.compute_vertex_valence(block, shrd_alloc);
@@ -60,7 +67,7 @@ __global__ static void random_flips(rxmesh::Context                context,
 
     block.sync();
 
-    if (cavity.prologue(block, shrd_alloc, coords, to_flip)) {
+    if (cavity.prologue(block, shrd_alloc, coords, to_flip, attributes...)) {
 
         // so that we don't flip them again
         for_each_edge(cavity.patch_info(), [&](const EdgeHandle eh) {
@@ -91,6 +98,70 @@ __global__ static void random_flips(rxmesh::Context                context,
     cavity.epilogue(block);
 }
 
+template <uint32_t blockThreads>
+__global__ static void random_flips(rxmesh::Context                context,
+                                    rxmesh::VertexAttribute<float> coords,
+                                    rxmesh::EdgeAttribute<int>     to_flip)
+{
+    using namespace rxmesh;
+    auto           block = cooperative_groups::this_thread_block();
+    ShmemAllocator shrd_alloc;
+
+    CavityManager<blockThreads, CavityOp::E> cavity(
+        block, context, shrd_alloc, false);
+
+
+    if (cavity.patch_id() == INVALID32) {
+        return;
+    }
+
+    flip_patch<blockThreads>(
+        block, context, cavity, shrd_alloc, coords, to_flip);
+}
+
+template <uint32_t blockThreads, typename... AttributesT>
+__global__ static void random_flips_with_policy(
+    rxmesh::Context                context,
+    rxmesh::VertexAttribute<float> coords,
+    rxmesh::EdgeAttribute<int>     to_flip,
+    AttributesT... attributes)
+{
+    using namespace rxmesh;
+    auto           block = cooperative_groups::this_thread_block();
+    ShmemAllocator shrd_alloc;
+
+    CavityManager<blockThreads, CavityOp::E> cavity(
+        block, context, shrd_alloc, false);
+
+
+    if (cavity.patch_id() == INVALID32) {
+        return;
+    }
+
+    flip_patch<blockThreads>(
+        block, context, cavity, shrd_alloc, coords, to_flip, attributes...);
+}
+
+template <uint32_t blockThreads>
+__global__ static void random_flips_persistent(
+    rxmesh::Context                context,
+    rxmesh::VertexAttribute<float> coords,
+    rxmesh::EdgeAttribute<int>     to_flip)
+{
+    using namespace rxmesh;
+    auto block = cooperative_groups::this_thread_block();
+
+    for_each_cavity_patch<blockThreads, CavityOp::E>(
+        block,
+        context,
+        false,
+        [&](CavityManager<blockThreads, CavityOp::E>& cavity,
+            ShmemAllocator&                           shrd_alloc) {
+            flip_patch<blockThreads>(
+                block, context, cavity, shrd_alloc, coords, to_flip);
+        });
+}
+
 
 template <uint32_t blockThreads>
 __global__ static void random_collapses(rxmesh::Context                context,
@@ -382,7 +453,7 @@ TEST(RXMeshDynamic, RandomFlips)
 }
 
 
-TEST(RXMeshDynamic, RandomCollapse)
+TEST(RXMeshDynamic, AttributeUpdatePolicy)
 {
     using namespace rxmesh;
 
@@ -393,95 +464,1073 @@ TEST(RXMeshDynamic, RandomCollapse)
 
     auto coords = rx.get_input_vertex_coordinates();
 
-    auto to_collapse = rx.add_edge_attribute<int>("to_collapse", 1);
-    to_collapse->reset(0, HOST);
-
-    auto v_attr = rx.add_vertex_attribute<int>("vAttr", 1);
-    v_attr->reset(0, HOST);
-
-    auto e_attr = rx.add_edge_attribute<int>("eAttr", 1);
-    e_attr->reset(0, HOST);
-
-    auto f_attr = rx.add_face_attribute<int>("fAttr", 1);
-    f_attr->reset(0, HOST);
+    auto to_flip = rx.add_edge_attribute<int>("to_flip", 1);
+    to_flip->reset(0, HOST);
 
-    // these config names makes better sense for edge flips but it is possible
-    // that some of the non-conflicting cavities becomes conflicting for edge
-    // collapse
     const Config config = InteriorNotConflicting | InteriorConflicting |
                           OnRibbonNotConflicting | OnRibbonConflicting;
+    set_edge_tag(rx, *to_flip, config);
+    to_flip->move(HOST, DEVICE);
 
+    // a wide per-vertex attribute that is derived from the coordinates and
+    // thus is recomputed instead of being moved
+    constexpr uint32_t num_desc = 16;
 
-    set_edge_tag(rx, *to_collapse, config);
+    auto desc  = rx.add_vertex_attribute<float>("desc", num_desc);
+    auto dirty = rx.add_vertex_attribute<bool>("dirty", 1);
+    auto tmp   = rx.add_vertex_attribute<float>("tmp", num_desc);
+    dirty->reset(false, DEVICE);
 
-    to_collapse->move(HOST, DEVICE);
+    VertexAttribute<float> c = *coords;
 
-    EXPECT_TRUE(rx.validate());
+    auto reinit = [=] __device__(const VertexHandle&      vh,
+                                 VertexAttribute<float>& d) mutable {
+        for (uint32_t i = 0; i < num_desc; ++i) {
+            d(vh, i) = c(vh, i % 3) * float(i + 1);
+        }
+    };
 
-#if USE_POLYSCOPE
-    rx.render_vertex_patch();
-    rx.render_edge_patch();
-    rx.render_face_patch();
-    rx.get_polyscope_mesh()
-        ->addEdgeScalarQuantity("toCollapse", *to_collapse)
-        ->setMapRange({0, 2});
-    for (uint32_t p = 0; p < rx.get_num_patches(); ++p) {
-        rx.render_patch(p)->setEnabled(false);
-    }
-    // polyscope::show();
-#endif
+    VertexAttribute<float> d = *desc;
+    rx.for_each_vertex(DEVICE,
+                       [=] __device__(const VertexHandle vh) mutable {
+                           reinit(vh, d);
+                       });
 
+    auto deferred = defer_update(*desc, *dirty);
+    auto skipped  = skip_update(*tmp);
+
+    set_should_slice<<<rx.get_num_patches(), 1>>>(rx.get_context());
+    rx.slice_patches(*coords, *to_flip, deferred, skipped);
+    rx.cleanup();
 
     constexpr uint32_t blockThreads = 256;
 
-    int iter = 0;
     while (!rx.is_queue_empty()) {
-        RXMESH_INFO("iter = {}", ++iter);
         LaunchBox<blockThreads> launch_box;
         rx.prepare_launch_box(
-            {}, launch_box, (void*)random_collapses<blockThreads>);
-        random_collapses<blockThreads><<<launch_box.blocks,
-                                         launch_box.num_threads,
-                                         launch_box.smem_bytes_dyn>>>(
-            rx.get_context(), *coords, *to_collapse, *v_attr, *e_attr, *f_attr);
-
-        rx.slice_patches(*coords, *to_collapse);
+            {},
+            launch_box,
+            (void*)random_flips_with_policy<blockThreads,
+                                            decltype(deferred),
+                                            decltype(skipped)>,
+            true,
+            false,
+            true);
+        random_flips_with_policy<blockThreads>
+            <<<launch_box.blocks,
+               launch_box.num_threads,
+               launch_box.smem_bytes_dyn>>>(
+                rx.get_context(), *coords, *to_flip, deferred, skipped);
+
+        rx.slice_patches(*coords, *to_flip, deferred, skipped);
         rx.cleanup();
     }
 
+    rx.repair_attribute(deferred, reinit);
+
     CUDA_ERROR(cudaDeviceSynchronize());
 
     rx.update_host();
+    EXPECT_TRUE(rx.validate());
 
     coords->move(DEVICE, HOST);
+    desc->move(DEVICE, HOST);
+    dirty->move(DEVICE, HOST);
+
+    rx.for_each_vertex(HOST, [&](const VertexHandle vh) {
+        EXPECT_FALSE((*dirty)(vh));
+        for (uint32_t i = 0; i < num_desc; ++i) {
+            EXPECT_FLOAT_EQ((*desc)(vh, i),
+                            (*coords)(vh, i % 3) * float(i + 1));
+        }
+    });
+}
 
-    v_attr->move(DEVICE, HOST);
-    e_attr->move(DEVICE, HOST);
-    f_attr->move(DEVICE, HOST);
 
+TEST(RXMeshDynamic, PersistentRandomFlips)
+{
+    using namespace rxmesh;
+
+    RXMeshDynamic rx(STRINGIFY(INPUT_DIR) "sphere3.obj",
+                     STRINGIFY(INPUT_DIR) "sphere3_patches",
+                     256,
+                     1.8);
+
+    const uint32_t num_vertices = rx.get_num_vertices();
+    const uint32_t num_edges    = rx.get_num_edges();
+    const uint32_t num_faces    = rx.get_num_faces();
+
+    auto coords = rx.get_input_vertex_coordinates();
+
+    auto to_flip = rx.add_edge_attribute<int>("to_flip", 1);
+    to_flip->reset(0, HOST);
+
+    const Config config = InteriorNotConflicting | InteriorConflicting |
+                          OnRibbonNotConflicting | OnRibbonConflicting;
+
+    set_edge_tag(rx, *to_flip, config);
+
+    to_flip->move(HOST, DEVICE);
+
+    constexpr uint32_t blockThreads = 256;
+
+    LaunchBox<blockThreads> launch_box;
+    rx.prepare_launch_box({},
+                          launch_box,
+                          (void*)random_flips_persistent<blockThreads>,
+                          true,
+                          false,
+                          true);
+
+    rx.enable_cavity_stats();
+    rx.reset_scheduler();
+
+    const uint32_t num_launches = rx.run_persistent(
+        launch_box,
+        (void*)random_flips_persistent<blockThreads>,
+        [&](uint32_t blocks, const Context& context) {
+            random_flips_persistent<blockThreads>
+                <<<blocks, launch_box.num_threads, launch_box.smem_bytes_dyn>>>(
+                    context, *coords, *to_flip);
+        },
+        *coords,
+        *to_flip);
+
+    CUDA_ERROR(cudaDeviceSynchronize());
+    EXPECT_GE(num_launches, 1u);
+    EXPECT_TRUE(rx.is_queue_empty());
 
+    const CavityStats stats = rx.get_cavity_stats();
+    EXPECT_GT(stats.num_created, 0u);
+    EXPECT_GT(stats.num_committed, 0u);
+    EXPECT_LE(stats.num_committed + stats.num_conflicting, stats.num_created);
+    EXPECT_GE(stats.num_processed, uint64_t(rx.get_num_patches()));
+
+    rx.update_host();
+
+    EXPECT_EQ(num_vertices, rx.get_num_vertices());
+    EXPECT_EQ(num_edges, rx.get_num_edges());
+    EXPECT_EQ(num_faces, rx.get_num_faces());
     EXPECT_TRUE(rx.validate());
+}
 
-    // rx.export_obj(STRINGIFY(OUTPUT_DIR) "sphere3_33.obj", *coords);
+TEST(RXMeshDynamic, ColoredRandomFlips)
+{
+    using namespace rxmesh;
 
-#if USE_POLYSCOPE
-    rx.update_polyscope();
-    rx.render_vertex_patch();
-    rx.render_edge_patch();
-    rx.render_face_patch();
+    RXMeshDynamic rx(STRINGIFY(INPUT_DIR) "sphere3.obj",
+                     STRINGIFY(INPUT_DIR) "sphere3_patches",
+                     256,
+                     1.8);
 
-    for (uint32_t p = 0; p < rx.get_num_patches(); ++p) {
-        rx.render_patch(p)->setEnabled(false);
+    const uint32_t num_vertices = rx.get_num_vertices();
+    const uint32_t num_edges    = rx.get_num_edges();
+    const uint32_t num_faces    = rx.get_num_faces();
+
+    auto coords = rx.get_input_vertex_coordinates();
+
+    auto to_flip = rx.add_edge_attribute<int>("to_flip", 1);
+    to_flip->reset(0, HOST);
+
+    const Config config = InteriorNotConflicting | InteriorConflicting |
+                          OnRibbonNotConflicting | OnRibbonConflicting;
+
+    set_edge_tag(rx, *to_flip, config);
+
+    to_flip->move(HOST, DEVICE);
+
+    constexpr uint32_t blockThreads = 256;
+
+    LaunchBox<blockThreads> launch_box;
+    rx.prepare_launch_box({},
+                          launch_box,
+                          (void*)random_flips<blockThreads>,
+                          true,
+                          false,
+                          true);
+
+    rx.enable_cavity_stats();
+
+    const uint32_t num_launches = rx.run_colored(
+        launch_box,
+        [&](uint32_t blocks, const Context& context, uint32_t color) {
+            random_flips<blockThreads>
+                <<<blocks, launch_box.num_threads, launch_box.smem_bytes_dyn>>>(
+                    context, *coords, *to_flip);
+        },
+        *coords,
+        *to_flip);
+
+    CUDA_ERROR(cudaDeviceSynchronize());
+    EXPECT_GE(num_launches, 1u);
+    EXPECT_TRUE(rx.is_queue_empty());
+
+    // no patch lock is taken when one color is processed at a time
+    const CavityStats stats = rx.get_cavity_stats();
+    EXPECT_EQ(stats.num_patch_lock_failed, 0u);
+    EXPECT_EQ(stats.num_neighbor_lock_failed, 0u);
+
+    rx.update_host();
+
+    EXPECT_EQ(num_vertices, rx.get_num_vertices());
+    EXPECT_EQ(num_edges, rx.get_num_edges());
+    EXPECT_EQ(num_faces, rx.get_num_faces());
+    EXPECT_TRUE(rx.validate());
+}
+
+TEST(RXMeshDynamic, CavityTrace)
+{
+    using namespace rxmesh;
+
+    RXMeshDynamic rx(STRINGIFY(INPUT_DIR) "sphere3.obj",
+                     STRINGIFY(INPUT_DIR) "sphere3_patches",
+                     256,
+                     1.8);
+
+    auto coords = rx.get_input_vertex_coordinates();
+
+    auto to_flip = rx.add_edge_attribute<int>("to_flip", 1);
+    to_flip->reset(0, HOST);
+
+    const Config config = InteriorNotConflicting | InteriorConflicting |
+                          OnRibbonNotConflicting | OnRibbonConflicting;
+
+    set_edge_tag(rx, *to_flip, config);
+
+    to_flip->move(HOST, DEVICE);
+
+    constexpr uint32_t blockThreads = 256;
+
+    rx.enable_cavity_stats();
+    rx.enable_cavity_trace();
+
+    while (!rx.is_queue_empty()) {
+        LaunchBox<blockThreads> launch_box;
+        rx.prepare_launch_box({},
+                              launch_box,
+                              (void*)random_flips<blockThreads>,
+                              true,
+                              false,
+                              true);
+        random_flips<blockThreads><<<launch_box.blocks,
+                                     launch_box.num_threads,
+                                     launch_box.smem_bytes_dyn>>>(
+            rx.get_context(), *coords, *to_flip);
+
+        rx.slice_patches(*coords, *to_flip);
+        rx.cleanup();
     }
 
-    auto ps_mesh = rx.get_polyscope_mesh();
-    ps_mesh->updateVertexPositions(*coords);
-    ps_mesh->setEnabled(false);
-    ps_mesh->addVertexScalarQuantity("vAttr", *v_attr);
-    ps_mesh->addEdgeScalarQuantity("eAttr", *e_attr);
-    ps_mesh->addFaceScalarQuantity("fAttr", *f_attr);
-    // polyscope::show();
-#endif
+    CUDA_ERROR(cudaDeviceSynchronize());
 
-    // polyscope::removeAllStructures();
-}
\ No newline at end of file
+    const CavityStats stats = rx.get_cavity_stats();
+    const CavityTrace trace = rx.get_cavity_trace();
+
+    EXPECT_EQ(trace.num_dropped, 0u);
+    EXPECT_GT(trace.clock_rate_khz, 0);
+
+    // every popped patch is either locked, not locked, or dirty and every
+    // locked patch is done
+    EXPECT_EQ(trace.count(CavityTraceType::PatchPopped),
+              trace.count(CavityTraceType::PatchLocked) +
+                  trace.count(CavityTraceType::PatchLockFailed) +
+                  trace.count(CavityTraceType::PatchDirty));
+    EXPECT_EQ(trace.count(CavityTraceType::PatchLocked),
+              trace.count(CavityTraceType::PatchDone));
+
+    // the trace agrees with the statistics
+    EXPECT_EQ(trace.count(CavityTraceType::PatchLocked), stats.num_processed);
+    EXPECT_EQ(trace.count(CavityTraceType::Pushed), stats.num_pushed);
+    EXPECT_EQ(trace.count(CavityTraceType::Sliced), stats.num_sliced);
+
+    uint64_t num_created = 0;
+    for (const auto& r : trace.records) {
+        if (r.type == uint16_t(CavityTraceType::Cavities)) {
+            num_created += r.value;
+        }
+    }
+    EXPECT_EQ(num_created, stats.num_created);
+
+    // the records are sorted by SM and then by clock
+    for (size_t i = 1; i < trace.records.size(); ++i) {
+        const auto& a = trace.records[i - 1];
+        const auto& b = trace.records[i];
+        EXPECT_TRUE(a.sm < b.sm || (a.sm == b.sm && a.clock <= b.clock));
+    }
+
+    std::filesystem::create_directories(STRINGIFY(OUTPUT_DIR));
+    const std::string filename =
+        STRINGIFY(OUTPUT_DIR) "RXMeshDynamic_CavityTrace.json";
+    EXPECT_TRUE(rx.export_cavity_trace(filename));
+    EXPECT_TRUE(std::filesystem::exists(filename));
+
+    rx.reset_cavity_trace();
+    EXPECT_TRUE(rx.get_cavity_trace().records.empty());
+
+    rx.update_host();
+    EXPECT_TRUE(rx.validate());
+}
+
+TEST(RXMeshDynamic, InverseHashtableCache)
+{
+    using namespace rxmesh;
+
+    RXMeshDynamic rx(STRINGIFY(INPUT_DIR) "sphere3.obj",
+                     STRINGIFY(INPUT_DIR) "sphere3_patches",
+                     256,
+                     1.8);
+
+    const uint32_t num_vertices = rx.get_num_vertices();
+    const uint32_t num_edges    = rx.get_num_edges();
+    const uint32_t num_faces    = rx.get_num_faces();
+
+    auto coords = rx.get_input_vertex_coordinates();
+
+    auto to_flip = rx.add_edge_attribute<int>("to_flip", 1);
+    to_flip->reset(0, HOST);
+
+    const Config config = InteriorNotConflicting | InteriorConflicting |
+                          OnRibbonNotConflicting | OnRibbonConflicting;
+
+    set_edge_tag(rx, *to_flip, config);
+
+    to_flip->move(HOST, DEVICE);
+
+    constexpr uint32_t blockThreads = 256;
+
+    // the conflicting cavities make patches fail to lock their neighbors
+    // and re-use their cached inverted hashtables in the next iterations
+    rx.enable_inverse_hashtable_cache();
+
+    while (!rx.is_queue_empty()) {
+        LaunchBox<blockThreads> launch_box;
+        rx.prepare_launch_box({},
+                              launch_box,
+                              (void*)random_flips<blockThreads>,
+                              true,
+                              false,
+                              true);
+        random_flips<blockThreads><<<launch_box.blocks,
+                                     launch_box.num_threads,
+                                     launch_box.smem_bytes_dyn>>>(
+            rx.get_context(), *coords, *to_flip);
+
+        rx.slice_patches(*coords, *to_flip);
+        rx.cleanup();
+    }
+
+    CUDA_ERROR(cudaDeviceSynchronize());
+
+    rx.enable_inverse_hashtable_cache(false);
+
+    rx.update_host();
+
+    EXPECT_EQ(num_vertices, rx.get_num_vertices());
+    EXPECT_EQ(num_edges, rx.get_num_edges());
+    EXPECT_EQ(num_faces, rx.get_num_faces());
+    EXPECT_TRUE(rx.validate());
+}
+
+TEST(RXMeshDynamic, IncrementalCleanup)
+{
+    using namespace rxmesh;
+
+    RXMeshDynamic rx(STRINGIFY(INPUT_DIR) "sphere3.obj",
+                     STRINGIFY(INPUT_DIR) "sphere3_patches",
+                     256,
+                     1.8);
+
+    const uint32_t num_vertices = rx.get_num_vertices();
+    const uint32_t num_edges    = rx.get_num_edges();
+    const uint32_t num_faces    = rx.get_num_faces();
+
+    // the first cleanup is a full one and a second one has nothing to do
+    rx.cleanup();
+    EXPECT_EQ(rx.get_num_cleaned_patches(), rx.get_num_patches());
+    rx.cleanup();
+    EXPECT_EQ(rx.get_num_cleaned_patches(), 0u);
+
+    auto coords = rx.get_input_vertex_coordinates();
+
+    auto to_flip = rx.add_edge_attribute<int>("to_flip", 1);
+    to_flip->reset(0, HOST);
+
+    const Config config = InteriorNotConflicting | OnRibbonNotConflicting;
+
+    set_edge_tag(rx, *to_flip, config);
+
+    to_flip->move(HOST, DEVICE);
+
+    constexpr uint32_t blockThreads = 256;
+
+    LaunchBox<blockThreads> launch_box;
+    rx.prepare_launch_box({},
+                          launch_box,
+                          (void*)random_flips<blockThreads>,
+                          true,
+                          false,
+                          true);
+
+    while (!rx.is_queue_empty()) {
+        random_flips<blockThreads><<<launch_box.blocks,
+                                     launch_box.num_threads,
+                                     launch_box.smem_bytes_dyn>>>(
+            rx.get_context(), *coords, *to_flip);
+
+        rx.cleanup_and_slice(*coords, *to_flip);
+        EXPECT_LE(rx.get_num_cleaned_patches(), rx.get_num_patches());
+    }
+
+    CUDA_ERROR(cudaDeviceSynchronize());
+    rx.update_host();
+
+    EXPECT_EQ(num_vertices, rx.get_num_vertices());
+    EXPECT_EQ(num_edges, rx.get_num_edges());
+    EXPECT_EQ(num_faces, rx.get_num_faces());
+    EXPECT_TRUE(rx.validate());
+
+    // the incremental counts should match the ones recounted from scratch
+    rx.cleanup(true);
+    EXPECT_EQ(rx.get_num_cleaned_patches(), rx.get_num_patches());
+    rx.update_host();
+
+    EXPECT_EQ(num_vertices, rx.get_num_vertices());
+    EXPECT_EQ(num_edges, rx.get_num_edges());
+    EXPECT_EQ(num_faces, rx.get_num_faces());
+    EXPECT_TRUE(rx.validate());
+}
+
+TEST(RXMeshDynamic, MergePatches)
+{
+    using namespace rxmesh;
+
+    RXMeshDynamic rx(STRINGIFY(INPUT_DIR) "sphere3.obj",
+                     STRINGIFY(INPUT_DIR) "sphere3_patches",
+                     256,
+                     1.8);
+
+    const uint32_t num_vertices = rx.get_num_vertices();
+    const uint32_t num_edges    = rx.get_num_edges();
+    const uint32_t num_faces    = rx.get_num_faces();
+
+    auto coords = rx.get_input_vertex_coordinates();
+
+    // slice all patches so they are (roughly) half-full
+    set_should_slice<<<rx.get_num_patches(), 1>>>(rx.get_context());
+    rx.slice_patches(*coords);
+    rx.cleanup();
+
+    uint32_t min_before(0), max_before(0), avg_before(0);
+    rx.get_max_min_avg_patch_size(min_before, max_before, avg_before, true);
+
+    // everything is underfull w.r.t. this fill ratio
+    const uint32_t num_merged = rx.merge_patches(1.0f, *coords);
+
+    EXPECT_GT(num_merged, 0u);
+
+    uint32_t min_after(0), max_after(0), avg_after(0);
+    rx.get_max_min_avg_patch_size(min_after, max_after, avg_after, true);
+    EXPECT_GE(avg_after, avg_before);
+
+    rx.update_host();
+    coords->move(DEVICE, HOST);
+
+    EXPECT_EQ(num_vertices, rx.get_num_vertices());
+    EXPECT_EQ(num_edges, rx.get_num_edges());
+    EXPECT_EQ(num_faces, rx.get_num_faces());
+    EXPECT_TRUE(rx.validate());
+}
+
+TEST(RXMeshDynamic, AdaptiveCapacity)
+{
+    using namespace rxmesh;
+
+    RXMeshDynamic rx(STRINGIFY(INPUT_DIR) "sphere3.obj",
+                     STRINGIFY(INPUT_DIR) "sphere3_patches",
+                     256,
+                     1.8);
+
+    const uint32_t num_vertices = rx.get_num_vertices();
+    const uint32_t num_edges    = rx.get_num_edges();
+    const uint32_t num_faces    = rx.get_num_faces();
+
+    const double memory_before = rx.get_topology_memory_mg();
+
+    // no headroom so the flips have to grow the patches
+    rx.enable_adaptive_capacity(1.0f);
+    EXPECT_TRUE(rx.is_adaptive_capacity_enabled());
+    EXPECT_LT(rx.get_topology_memory_mg(), memory_before);
+
+    rx.update_host();
+    EXPECT_TRUE(rx.validate());
+
+    auto coords = rx.get_input_vertex_coordinates();
+
+    auto to_flip = rx.add_edge_attribute<int>("to_flip", 1);
+    to_flip->reset(0, HOST);
+
+    const Config config = InteriorNotConflicting | OnRibbonNotConflicting;
+
+    set_edge_tag(rx, *to_flip, config);
+
+    to_flip->move(HOST, DEVICE);
+
+    constexpr uint32_t blockThreads = 256;
+
+    LaunchBox<blockThreads> launch_box;
+    rx.prepare_launch_box({},
+                          launch_box,
+                          (void*)random_flips<blockThreads>,
+                          true,
+                          false,
+                          true);
+
+    while (!rx.is_queue_empty()) {
+        random_flips<blockThreads><<<launch_box.blocks,
+                                     launch_box.num_threads,
+                                     launch_box.smem_bytes_dyn>>>(
+            rx.get_context(), *coords, *to_flip);
+
+        rx.cleanup_and_slice(*coords, *to_flip);
+    }
+
+    CUDA_ERROR(cudaDeviceSynchronize());
+    rx.update_host();
+
+    EXPECT_EQ(num_vertices, rx.get_num_vertices());
+    EXPECT_EQ(num_edges, rx.get_num_edges());
+    EXPECT_EQ(num_faces, rx.get_num_faces());
+    EXPECT_TRUE(rx.validate());
+}
+
+TEST(RXMeshDynamic, BatchedCavityOps)
+{
+    using namespace rxmesh;
+
+    RXMeshDynamic rx(STRINGIFY(INPUT_DIR) "sphere3.obj",
+                     STRINGIFY(INPUT_DIR) "sphere3_patches",
+                     256,
+                     1.8);
+
+    auto coords = rx.get_input_vertex_coordinates();
+
+    auto edge_mask = rx.add_edge_attribute<bool>("mask", 1);
+
+    auto mark_edges = [&](const uint32_t stride) {
+        rx.for_each_edge(HOST, [&](const EdgeHandle eh) {
+            (*edge_mask)(eh) = (eh.local_id() % stride == 0);
+        });
+        edge_mask->move(HOST, DEVICE);
+    };
+
+    auto check = [&](const int64_t  dv,
+                     const int64_t  de,
+                     const int64_t  df,
+                     const uint32_t num_v,
+                     const uint32_t num_e,
+                     const uint32_t num_f) {
+        rx.update_host();
+        EXPECT_EQ(int64_t(rx.get_num_vertices()), int64_t(num_v) + dv);
+        EXPECT_EQ(int64_t(rx.get_num_edges()), int64_t(num_e) + de);
+        EXPECT_EQ(int64_t(rx.get_num_faces()), int64_t(num_f) + df);
+        EXPECT_TRUE(rx.validate());
+    };
+
+    // split
+    uint32_t num_v = rx.get_num_vertices();
+    uint32_t num_e = rx.get_num_edges();
+    uint32_t num_f = rx.get_num_faces();
+
+    mark_edges(5);
+    const int64_t num_split = rx.split_edges(
+        *edge_mask, MidpointInterpolation<float>(*coords), *coords);
+    EXPECT_GT(num_split, 0);
+    check(num_split, 3 * num_split, 2 * num_split, num_v, num_e, num_f);
+
+    // flip
+    num_v = rx.get_num_vertices();
+    num_e = rx.get_num_edges();
+    num_f = rx.get_num_faces();
+
+    mark_edges(7);
+    EXPECT_GT(rx.flip_edges(*edge_mask, *coords), 0u);
+    check(0, 0, 0, num_v, num_e, num_f);
+
+    // collapse
+    num_v = rx.get_num_vertices();
+    num_e = rx.get_num_edges();
+    num_f = rx.get_num_faces();
+
+    mark_edges(5);
+    const int64_t num_collapse = rx.collapse_edges(
+        *edge_mask, MidpointInterpolation<float>(*coords), *coords);
+    EXPECT_GT(num_collapse, 0);
+    check(-num_collapse,
+          -3 * num_collapse,
+          -2 * num_collapse,
+          num_v,
+          num_e,
+          num_f);
+}
+
+TEST(RXMeshDynamic, ChangeLog)
+{
+    using namespace rxmesh;
+
+    RXMeshDynamic rx(STRINGIFY(INPUT_DIR) "sphere3.obj",
+                     STRINGIFY(INPUT_DIR) "sphere3_patches",
+                     256,
+                     1.8);
+
+    rx.enable_change_log();
+    EXPECT_TRUE(rx.is_change_log_enabled());
+
+    auto coords = rx.get_input_vertex_coordinates();
+
+    auto edge_mask = rx.add_edge_attribute<bool>("mask", 1);
+
+    auto mark_edges = [&](const uint32_t stride) {
+        rx.for_each_edge(HOST, [&](const EdgeHandle eh) {
+            (*edge_mask)(eh) = (eh.local_id() % stride == 0);
+        });
+        edge_mask->move(HOST, DEVICE);
+    };
+
+    // number of changes per ChangeType in the drained batch
+    auto drain = [&]() {
+        ChangeLogBatch batch = rx.drain_change_log();
+        CUDA_ERROR(cudaDeviceSynchronize());
+        EXPECT_EQ(batch.num_entries, batch.num_changes);
+
+        std::vector<int64_t> count(9, 0);
+        for (uint64_t i = 0; i < batch.num_entries; ++i) {
+            count[uint32_t(batch.entries[i].type)]++;
+        }
+        return count;
+    };
+
+    // nothing is logged before any topology change
+    EXPECT_EQ(rx.drain_change_log().num_changes, 0u);
+
+    // split
+    mark_edges(5);
+    const int64_t num_split = rx.split_edges(
+        *edge_mask, MidpointInterpolation<float>(*coords), *coords);
+    EXPECT_GT(num_split, 0);
+
+    std::vector<int64_t> count = drain();
+    auto get = [&](ChangeType t) { return count[uint32_t(t)]; };
+
+    EXPECT_EQ(get(ChangeType::CreatedVertex), num_split);
+    EXPECT_EQ(get(ChangeType::DeletedVertex), 0);
+    EXPECT_EQ(get(ChangeType::CreatedEdge) - get(ChangeType::DeletedEdge),
+              3 * num_split);
+    EXPECT_EQ(get(ChangeType::CreatedFace) - get(ChangeType::DeletedFace),
+              2 * num_split);
+
+    // flip
+    mark_edges(7);
+    const int64_t num_flip = rx.flip_edges(*edge_mask, *coords);
+    EXPECT_GT(num_flip, 0);
+
+    count = drain();
+    EXPECT_EQ(get(ChangeType::CreatedVertex), 0);
+    EXPECT_EQ(get(ChangeType::DeletedVertex), 0);
+    EXPECT_EQ(get(ChangeType::CreatedEdge), num_flip);
+    EXPECT_EQ(get(ChangeType::DeletedEdge), num_flip);
+    EXPECT_EQ(get(ChangeType::CreatedFace), 2 * num_flip);
+    EXPECT_EQ(get(ChangeType::DeletedFace), 2 * num_flip);
+
+    // the log is empty after draining
+    EXPECT_EQ(rx.drain_change_log().num_changes, 0u);
+
+    rx.enable_change_log(0, false);
+    EXPECT_FALSE(rx.is_change_log_enabled());
+}
+
+TEST(RXMeshDynamic, LPBucketSize)
+{
+    using namespace rxmesh;
+
+    RXMeshDynamic rx(STRINGIFY(INPUT_DIR) "sphere3.obj",
+                     STRINGIFY(INPUT_DIR) "sphere3_patches");
+
+    EXPECT_EQ(rx.get_lp_bucket_size(), 1);
+
+    // not a power of two
+    EXPECT_FALSE(rx.set_lp_bucket_size(3));
+    EXPECT_EQ(rx.get_lp_bucket_size(), 1);
+
+    EXPECT_TRUE(rx.set_lp_bucket_size(8));
+    EXPECT_EQ(rx.get_lp_bucket_size(), 8);
+    EXPECT_TRUE(rx.validate());
+
+    EXPECT_TRUE(rx.set_lp_bucket_size(1));
+    EXPECT_TRUE(rx.validate());
+}
+
+TEST(RXMeshDynamic, ValidationReport)
+{
+    using namespace rxmesh;
+
+    RXMeshDynamic rx(STRINGIFY(INPUT_DIR) "sphere3.obj",
+                     STRINGIFY(INPUT_DIR) "sphere3_patches");
+
+    ASSERT_GT(rx.get_num_patches(), 1);
+
+    // validation runs on the device so there is no need to update the host
+    ValidationReport report;
+    EXPECT_TRUE(rx.validate(report));
+    EXPECT_TRUE(report.is_valid());
+    for (uint32_t i = 0; i < uint32_t(ValidationCheck::Count); ++i) {
+        EXPECT_EQ(report.get_num_errors(ValidationCheck(i)), 0);
+        EXPECT_EQ(report.get_first_patch(ValidationCheck(i)), INVALID32);
+    }
+
+    // corrupt one edge in the second patch
+    make_degenerate_edge<<<1, 1>>>(rx.get_context(), 1, 0);
+    CUDA_ERROR(cudaDeviceSynchronize());
+
+    EXPECT_FALSE(rx.validate(report));
+    EXPECT_FALSE(report.is_valid());
+    EXPECT_FALSE(report.is_valid(ValidationCheck::Uniqueness));
+    EXPECT_GE(report.get_num_errors(ValidationCheck::Uniqueness), 1);
+    EXPECT_EQ(report.get_first_patch(ValidationCheck::Uniqueness), 1);
+}
+
+TEST(RXMeshDynamic, Checkpoint)
+{
+    using namespace rxmesh;
+
+    const std::string checkpoint = "rxmesh_test_checkpoint.rxck";
+
+    RXMeshDynamic rx(STRINGIFY(INPUT_DIR) "sphere3.obj",
+                     STRINGIFY(INPUT_DIR) "sphere3_patches",
+                     256,
+                     1.8);
+
+    auto coords = rx.get_input_vertex_coordinates();
+
+    // change the patch layout before writing the checkpoint
+    set_should_slice<<<rx.get_num_patches(), 1>>>(rx.get_context());
+    rx.slice_patches(*coords);
+    rx.cleanup();
+    CUDA_ERROR(cudaDeviceSynchronize());
+    rx.update_host();
+    coords->move(DEVICE, HOST);
+
+    EXPECT_TRUE(rx.save_checkpoint(checkpoint, *coords));
+
+    RXMeshDynamic restored(STRINGIFY(INPUT_DIR) "sphere3.obj",
+                           STRINGIFY(INPUT_DIR) "sphere3_patches",
+                           256,
+                           1.8);
+
+    auto restored_coords = restored.get_input_vertex_coordinates();
+    restored_coords->reset(0, DEVICE);
+
+    EXPECT_TRUE(restored.load_checkpoint(checkpoint, *restored_coords));
+
+    EXPECT_EQ(restored.get_num_patches(), rx.get_num_patches());
+    EXPECT_EQ(restored.get_num_vertices(), rx.get_num_vertices());
+    EXPECT_EQ(restored.get_num_edges(), rx.get_num_edges());
+    EXPECT_EQ(restored.get_num_faces(), rx.get_num_faces());
+    EXPECT_TRUE(restored.validate());
+
+    restored_coords->move(DEVICE, HOST);
+    restored.for_each_vertex(HOST, [&](const VertexHandle vh) {
+        for (uint32_t i = 0; i < 3; ++i) {
+            EXPECT_EQ((*restored_coords)(vh, i), (*coords)(vh, i));
+        }
+    });
+
+    // the attribute should match the stored one
+    auto other = restored.add_vertex_attribute<float>("other", 3);
+    EXPECT_FALSE(restored.load_checkpoint(checkpoint, *other));
+
+    std::filesystem::remove(checkpoint);
+}
+
+TEST(RXMeshDynamic, CheckpointGDS)
+{
+    using namespace rxmesh;
+
+    const std::string checkpoint = "rxmesh_test_checkpoint_gds.rxck";
+
+    RXMeshDynamic rx(STRINGIFY(INPUT_DIR) "sphere3.obj",
+                     STRINGIFY(INPUT_DIR) "sphere3_patches",
+                     256,
+                     1.8);
+
+    auto coords = rx.get_input_vertex_coordinates();
+    coords->move(HOST, DEVICE);
+
+    // a small chunk size such that the attributes are written in several
+    // batches and staged in several chunks
+    const size_t chunk_bytes = 4096;
+    {
+        GDSFile out(checkpoint, GDSFile::Mode::Write, true, chunk_bytes);
+        ASSERT_TRUE(out.is_open());
+        EXPECT_TRUE(rx.save_checkpoint(out, *coords));
+        EXPECT_TRUE(out.close());
+        EXPECT_GT(out.get_num_bytes(), 0);
+    }
+
+    auto check = [&](RXMeshDynamic& restored, VertexAttribute<float>& attr) {
+        EXPECT_EQ(restored.get_num_patches(), rx.get_num_patches());
+        EXPECT_EQ(restored.get_num_vertices(), rx.get_num_vertices());
+        EXPECT_EQ(restored.get_num_edges(), rx.get_num_edges());
+        EXPECT_EQ(restored.get_num_faces(), rx.get_num_faces());
+        EXPECT_TRUE(restored.validate());
+
+        attr.move(DEVICE, HOST);
+        restored.for_each_vertex(HOST, [&](const VertexHandle vh) {
+            for (uint32_t i = 0; i < 3; ++i) {
+                EXPECT_EQ(attr(vh, i), (*coords)(vh, i));
+            }
+        });
+    };
+
+    // restore through GDSFile
+    {
+        RXMeshDynamic restored(STRINGIFY(INPUT_DIR) "sphere3.obj",
+                               STRINGIFY(INPUT_DIR) "sphere3_patches",
+                               256,
+                               1.8);
+        auto restored_coords = restored.get_input_vertex_coordinates();
+        restored_coords->reset(0, DEVICE);
+
+        GDSFile in(checkpoint, GDSFile::Mode::Read, true, chunk_bytes);
+        ASSERT_TRUE(in.is_open());
+        EXPECT_TRUE(restored.load_checkpoint(in, *restored_coords));
+        EXPECT_GT(in.get_num_bytes(), 0);
+        check(restored, *restored_coords);
+    }
+
+    // the format is the same as the std::ostream checkpoint
+    {
+        RXMeshDynamic restored(STRINGIFY(INPUT_DIR) "sphere3.obj",
+                               STRINGIFY(INPUT_DIR) "sphere3_patches",
+                               256,
+                               1.8);
+        auto restored_coords = restored.get_input_vertex_coordinates();
+        restored_coords->reset(0, DEVICE);
+
+        EXPECT_TRUE(restored.load_checkpoint(checkpoint, *restored_coords));
+        check(restored, *restored_coords);
+    }
+
+    std::filesystem::remove(checkpoint);
+}
+
+inline void pq_edge_length(rxmesh::PriorityQueue<rxmesh::EdgeHandle>& pq,
+                           const rxmesh::VertexAttribute<float>&      coords)
+{
+    using namespace rxmesh;
+
+    pq.update<Op::EV, 256>(
+        [coords] __device__(const EdgeHandle& eh, const VertexIterator& iter) {
+            const vec3<float> p0 = coords.to_glm<3>(iter[0]);
+            const vec3<float> p1 = coords.to_glm<3>(iter[1]);
+            return glm::distance2(p0, p1);
+        });
+}
+
+inline void pq_block_edges(rxmesh::PriorityQueue<rxmesh::EdgeHandle>& pq)
+{
+    using namespace rxmesh;
+
+    pq.update([] __device__(const EdgeHandle& eh) {
+        return std::numeric_limits<float>::infinity();
+    });
+}
+
+TEST(RXMeshDynamic, RandomCollapse)
+{
+    using namespace rxmesh;
+
+    RXMeshDynamic rx(STRINGIFY(INPUT_DIR) "sphere3.obj",
+                     STRINGIFY(INPUT_DIR) "sphere3_patches",
+                     256,
+                     1.8);
+
+    auto coords = rx.get_input_vertex_coordinates();
+
+    auto to_collapse = rx.add_edge_attribute<int>("to_collapse", 1);
+    to_collapse->reset(0, HOST);
+
+    auto v_attr = rx.add_vertex_attribute<int>("vAttr", 1);
+    v_attr->reset(0, HOST);
+
+    auto e_attr = rx.add_edge_attribute<int>("eAttr", 1);
+    e_attr->reset(0, HOST);
+
+    auto f_attr = rx.add_face_attribute<int>("fAttr", 1);
+    f_attr->reset(0, HOST);
+
+    // these config names makes better sense for edge flips but it is possible
+    // that some of the non-conflicting cavities becomes conflicting for edge
+    // collapse
+    const Config config = InteriorNotConflicting | InteriorConflicting |
+                          OnRibbonNotConflicting | OnRibbonConflicting;
+
+
+    set_edge_tag(rx, *to_collapse, config);
+
+    to_collapse->move(HOST, DEVICE);
+
+    EXPECT_TRUE(rx.validate());
+
+#if USE_POLYSCOPE
+    rx.render_vertex_patch();
+    rx.render_edge_patch();
+    rx.render_face_patch();
+    rx.get_polyscope_mesh()
+        ->addEdgeScalarQuantity("toCollapse", *to_collapse)
+        ->setMapRange({0, 2});
+    for (uint32_t p = 0; p < rx.get_num_patches(); ++p) {
+        rx.render_patch(p)->setEnabled(false);
+    }
+    // polyscope::show();
+#endif
+
+
+    constexpr uint32_t blockThreads = 256;
+
+    int iter = 0;
+    while (!rx.is_queue_empty()) {
+        RXMESH_INFO("iter = {}", ++iter);
+        LaunchBox<blockThreads> launch_box;
+        rx.prepare_launch_box(
+            {}, launch_box, (void*)random_collapses<blockThreads>);
+        random_collapses<blockThreads><<<launch_box.blocks,
+                                         launch_box.num_threads,
+                                         launch_box.smem_bytes_dyn>>>(
+            rx.get_context(), *coords, *to_collapse, *v_attr, *e_attr, *f_attr);
+
+        rx.slice_patches(*coords, *to_collapse);
+        rx.cleanup();
+    }
+
+    CUDA_ERROR(cudaDeviceSynchronize());
+
+    rx.update_host();
+
+    coords->move(DEVICE, HOST);
+
+    v_attr->move(DEVICE, HOST);
+    e_attr->move(DEVICE, HOST);
+    f_attr->move(DEVICE, HOST);
+
+
+    EXPECT_TRUE(rx.validate());
+
+    // rx.export_obj(STRINGIFY(OUTPUT_DIR) "sphere3_33.obj", *coords);
+
+#if USE_POLYSCOPE
+    rx.update_polyscope();
+    rx.render_vertex_patch();
+    rx.render_edge_patch();
+    rx.render_face_patch();
+
+    for (uint32_t p = 0; p < rx.get_num_patches(); ++p) {
+        rx.render_patch(p)->setEnabled(false);
+    }
+
+    auto ps_mesh = rx.get_polyscope_mesh();
+    ps_mesh->updateVertexPositions(*coords);
+    ps_mesh->setEnabled(false);
+    ps_mesh->addVertexScalarQuantity("vAttr", *v_attr);
+    ps_mesh->addEdgeScalarQuantity("eAttr", *e_attr);
+    ps_mesh->addFaceScalarQuantity("fAttr", *f_attr);
+    // polyscope::show();
+#endif
+
+    // polyscope::removeAllStructures();
+}
+
+
+TEST(RXMeshDynamic, PriorityQueue)
+{
+    using namespace rxmesh;
+
+    RXMeshDynamic rx(STRINGIFY(INPUT_DIR) "sphere3.obj");
+
+    auto coords = rx.get_input_vertex_coordinates();
+
+    auto selected = rx.add_edge_attribute<bool>("selected", 1);
+
+    PriorityQueue<EdgeHandle> pq(rx);
+
+    pq_edge_length(pq, *coords);
+
+    const uint32_t k = rx.get_num_edges() / 7;
+
+    EXPECT_EQ(pq.select(k, *selected), k);
+
+    pq.keys().move(DEVICE, HOST);
+    selected->move(DEVICE, HOST);
+
+    std::vector<float> keys;
+    rx.for_each_edge(
+        HOST,
+        [&](const EdgeHandle& eh) { keys.push_back(pq.keys()(eh)); },
+        NULL,
+        false);
+    std::sort(keys.begin(), keys.end());
+    const float kth = keys[k - 1];
+
+    uint32_t num_selected = 0;
+    rx.for_each_edge(
+        HOST,
+        [&](const EdgeHandle& eh) {
+            if ((*selected)(eh)) {
+                num_selected++;
+                EXPECT_LE(pq.keys()(eh), kth);
+            } else {
+                EXPECT_GE(pq.keys()(eh), kth);
+            }
+        },
+        NULL,
+        false);
+    EXPECT_EQ(num_selected, k);
+
+    // no edge is dirty so blocking the edges should not change any key
+    pq_block_edges(pq);
+    EXPECT_EQ(pq.select(k, *selected), k);
+
+    // with all edges dirty, all edges get blocked and none is selected
+    pq.mark_all_dirty();
+    pq_block_edges(pq);
+    EXPECT_EQ(pq.select(k, *selected), 0);
+
+    pq.release();
+}
+
+
+TEST(RXMeshDynamic, MakeDelaunay)
+{
+    using namespace rxmesh;
+
+    RXMeshDynamic rx(STRINGIFY(INPUT_DIR) "sphere3.obj");
+
+    const uint32_t num_vertices = rx.get_num_vertices();
+    const uint32_t num_edges    = rx.get_num_edges();
+    const uint32_t num_faces    = rx.get_num_faces();
+
+    auto coords = rx.get_input_vertex_coordinates();
+
+    DelaunayStats stats = make_delaunay(rx, *coords);
+    EXPECT_GE(stats.num_rounds, 2);
+
+    // once converged, there is nothing left to flip
+    DelaunayStats again = make_delaunay(rx, *coords);
+    EXPECT_EQ(again.num_flips, 0);
+
+    rx.update_host();
+
+    EXPECT_EQ(num_vertices, rx.get_num_vertices());
+    EXPECT_EQ(num_edges, rx.get_num_edges());
+    EXPECT_EQ(num_faces, rx.get_num_faces());
+    EXPECT_TRUE(rx.validate());
+}
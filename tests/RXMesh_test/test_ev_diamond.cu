@@ -1,11 +1,64 @@
 #include <cmath>
+#include <set>
 #include "gtest/gtest.h"
 
+#include "rxmesh/algo/stencil_coloring.h"
+#include "rxmesh/cavity_ops.cuh"
 #include "rxmesh/geometry_util.cuh"
 #include "rxmesh/rxmesh_static.h"
+#include "rxmesh/util/import_obj.h"
 
 #include "query_kernel.cuh"
 
+template <uint32_t blockThreads>
+__global__ static void link_size_kernel(
+    const rxmesh::Context                       context,
+    rxmesh::EdgeAttribute<uint32_t>             link,
+    rxmesh::EdgeAttribute<rxmesh::VertexHandle> ends)
+{
+    using namespace rxmesh;
+
+    auto block = cooperative_groups::this_thread_block();
+
+    ShmemAllocator shrd_alloc;
+
+    Query<blockThreads> query(context);
+    const PatchInfo&    pi = query.get_patch_info();
+
+    Bitmask edge_mask(pi.num_edges[0], shrd_alloc);
+    edge_mask.reset(block);
+    block.sync();
+
+    for_each_edge(pi,
+                  [&](EdgeHandle eh) { edge_mask.set(eh.local_id(), true); });
+    block.sync();
+
+    query.prologue<Op::EVDiamond>(block, shrd_alloc);
+    block.sync();
+
+    count_link_vertices(
+        block,
+        pi,
+        query,
+        shrd_alloc,
+        edge_mask,
+        0,
+        2,
+        [&](const uint16_t e, const uint16_t num_shared) {
+            const VertexIterator iter =
+                query.template get_iterator<VertexIterator>(e);
+            const EdgeHandle eh(pi.patch_id, e);
+
+            // the one ring of a vertex is only complete in the patch that
+            // owns it
+            const bool owned = pi.is_owned(LocalVertexT(iter.local(0))) &&
+                               pi.is_owned(LocalVertexT(iter.local(2)));
+            link(eh)    = owned ? num_shared : INVALID32;
+            ends(eh, 0) = iter[0];
+            ends(eh, 1) = iter[2];
+        });
+}
+
 TEST(RXMeshStatic, EVDiamond)
 {
     using namespace rxmesh;
@@ -73,4 +126,124 @@ TEST(RXMeshStatic, EVDiamond)
             EXPECT_NEAR(t0 + t1, 1, 0.00001);
         }
     });
-}
\ No newline at end of file
+}
+
+TEST(RXMeshStatic, EVDiamondColoring)
+{
+    using namespace rxmesh;
+
+    RXMeshStatic rx(STRINGIFY(INPUT_DIR) "sphere3.obj");
+
+    auto color = *rx.add_edge_attribute<uint32_t>("color", 1);
+
+    const uint32_t num_colors = stencil_coloring<Op::EVDiamond>(rx, color);
+
+    EXPECT_GT(num_colors, 0);
+
+    // the diamond of every edge
+    auto input  = *rx.add_edge_attribute<EdgeHandle>("input", 1);
+    auto output = *rx.add_edge_attribute<VertexHandle>("output", 4);
+
+    output.reset(VertexHandle(), DEVICE);
+
+    constexpr uint32_t      blockThreads = 320;
+    LaunchBox<blockThreads> launch_box;
+    rx.prepare_launch_box({Op::EVDiamond},
+                          launch_box,
+                          (void*)query_kernel<blockThreads,
+                                              Op::EVDiamond,
+                                              EdgeHandle,
+                                              VertexHandle,
+                                              EdgeAttribute<EdgeHandle>,
+                                              EdgeAttribute<VertexHandle>>);
+
+    query_kernel<blockThreads, Op::EVDiamond, EdgeHandle, VertexHandle>
+        <<<launch_box.blocks, blockThreads, launch_box.smem_bytes_dyn>>>(
+            rx.get_context(), input, output);
+
+    CUDA_ERROR(cudaDeviceSynchronize());
+
+    output.move(DEVICE, HOST);
+
+    // no two edges of the same color share a vertex in their diamonds
+    std::vector<std::set<uint32_t>> v_colors(rx.get_num_vertices());
+
+    rx.for_each_edge(
+        HOST,
+        [&](const EdgeHandle& eh) {
+            EXPECT_LT(color(eh), num_colors);
+            for (int i = 0; i < 4; ++i) {
+                VertexHandle vh = output(eh, i);
+                if (vh.is_valid()) {
+                    auto ret = v_colors[rx.linear_id(vh)].insert(color(eh));
+                    EXPECT_TRUE(ret.second);
+                }
+            }
+        },
+        NULL,
+        false);
+}
+
+TEST(RXMeshStatic, LinkCondition)
+{
+    using namespace rxmesh;
+
+    std::vector<std::vector<float>>    verts;
+    std::vector<std::vector<uint32_t>> fv;
+    ASSERT_TRUE(import_obj(STRINGIFY(INPUT_DIR) "sphere3.obj", verts, fv));
+
+    RXMeshStatic rx(fv, "", 64);
+
+    // the one ring of every vertex
+    std::vector<std::set<uint32_t>> vv(rx.get_num_vertices());
+    for (const auto& f : fv) {
+        for (uint32_t i = 0; i < 3; ++i) {
+            vv[f[i]].insert(f[(i + 1) % 3]);
+            vv[f[(i + 1) % 3]].insert(f[i]);
+        }
+    }
+
+    auto link = *rx.add_edge_attribute<uint32_t>("link", 1);
+    auto ends = *rx.add_edge_attribute<VertexHandle>("ends", 2);
+
+    constexpr uint32_t      blockThreads = 256;
+    LaunchBox<blockThreads> launch_box;
+    rx.prepare_launch_box(
+        {Op::EVDiamond},
+        launch_box,
+        (void*)link_size_kernel<blockThreads>,
+        false,
+        false,
+        false,
+        [](uint32_t v, uint32_t e, uint32_t f) {
+            return detail::mask_num_bytes(e) +
+                   ShmemAllocator::default_alignment +
+                   link_condition_shmem_bytes(v, e);
+        });
+
+    link_size_kernel<blockThreads>
+        <<<launch_box.blocks, blockThreads, launch_box.smem_bytes_dyn>>>(
+            rx.get_context(), link, ends);
+
+    EXPECT_EQ(cudaDeviceSynchronize(), cudaSuccess);
+
+    link.move(DEVICE, HOST);
+    ends.move(DEVICE, HOST);
+
+    uint32_t num_tested = 0;
+    rx.for_each_edge(HOST, [&](const EdgeHandle& eh) {
+        if (link(eh) == INVALID32) {
+            return;
+        }
+        const uint32_t v0 = rx.map_to_global(ends(eh, 0));
+        const uint32_t v1 = rx.map_to_global(ends(eh, 1));
+
+        uint32_t expected = 0;
+        for (uint32_t w : vv[v0]) {
+            expected += (w != v1 && vv[v1].count(w) > 0);
+        }
+        EXPECT_EQ(link(eh), expected);
+        num_tested++;
+    });
+    EXPECT_GT(num_tested, 0);
+}
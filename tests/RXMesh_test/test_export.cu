@@ -1,3 +1,8 @@
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+
 #include "gtest/gtest.h"
 
 #include "rxmesh/rxmesh_static.h"
@@ -58,4 +63,54 @@ TEST(RXMeshStatic, Export)
 
 
     ASSERT_EQ(cudaDeviceSynchronize(), cudaSuccess);
-}
\ No newline at end of file
+}
+TEST(RXMeshStatic, ExportVTU)
+{
+    using namespace rxmesh;
+
+    RXMeshStatic rx(STRINGIFY(INPUT_DIR) "sphere3.obj");
+
+    auto coords = rx.get_input_vertex_coordinates();
+
+    auto v_attr = *rx.add_vertex_attribute<float>("vVector4", 4);
+    auto f_attr = *rx.add_face_attribute<int>("fScalar", 1);
+
+    v_attr.reset(1.f, DEVICE);
+    f_attr.reset(2, DEVICE);
+
+    rx.export_vtu("sphere3.vtu", *coords, v_attr, f_attr);
+
+    std::ifstream file("sphere3.vtu", std::ios::binary);
+    ASSERT_TRUE(file.is_open());
+    const std::string content((std::istreambuf_iterator<char>(file)),
+                              std::istreambuf_iterator<char>());
+
+    EXPECT_EQ(content.rfind("<?xml", 0), 0);
+    EXPECT_NE(content.find("NumberOfPoints=\"" +
+                           std::to_string(rx.get_num_vertices()) + "\""),
+              std::string::npos);
+    EXPECT_NE(content.find("Name=\"vVector4\" NumberOfComponents=\"4\""),
+              std::string::npos);
+
+    // the first appended block is the vertex coordinates
+    const size_t start = content.find("encoding=\"raw\">") + 20;
+    ASSERT_EQ(content[start - 1], '_');
+
+    uint64_t num_bytes = 0;
+    std::memcpy(&num_bytes, content.data() + start, sizeof(uint64_t));
+    EXPECT_EQ(num_bytes, 3 * sizeof(float) * rx.get_num_vertices());
+
+    const float* points =
+        reinterpret_cast<const float*>(content.data() + start + 8);
+
+    rx.for_each_vertex(HOST, [&](const VertexHandle vh) {
+        const uint32_t v = rx.linear_id(vh);
+        for (uint32_t i = 0; i < 3; ++i) {
+            float p;
+            std::memcpy(&p, points + 3 * v + i, sizeof(float));
+            EXPECT_EQ(p, (*coords)(vh, i));
+        }
+    });
+
+    ASSERT_EQ(cudaDeviceSynchronize(), cudaSuccess);
+}
@@ -1,8 +1,11 @@
 #include "gtest/gtest.h"
 
+#include "rxmesh/algo/level_sets.h"
+#include "rxmesh/reduce_handle.h"
 #include "rxmesh/rxmesh_static.h"
 #include "rxmesh/util/cuda_query.h"
 #include "rxmesh/util/import_obj.h"
+#include "rxmesh/worklist.h"
 
 #include "rxmesh/kernels/for_each.cuh"
 
@@ -79,4 +82,513 @@ TEST(RXMeshStatic, ForEachOnDevice)
         <<<launch_box.blocks, blockThreads, launch_box.smem_bytes_dyn>>>(
             rx.get_context());
     EXPECT_EQ(cudaDeviceSynchronize(), cudaSuccess);
-}
\ No newline at end of file
+}
+
+TEST(RXMeshStatic, ForEachPatchWindow)
+{
+    using namespace rxmesh;
+
+    RXMeshStatic rx(STRINGIFY(INPUT_DIR) "sphere3.obj", "", false, 64);
+
+    ASSERT_GT(rx.get_num_patches(), 3);
+
+    // process the mesh in windows of 3 patches (the last window is partial)
+    rx.set_patch_window(3);
+
+    auto v_attr = rx.add_vertex_attribute<uint32_t>("v", 1);
+    auto f_attr = rx.add_face_attribute<uint32_t>("f", 1);
+    v_attr->reset(0, LOCATION_ALL);
+    f_attr->reset(0, LOCATION_ALL);
+
+    rx.for_each_vertex(
+        DEVICE,
+        [v_attr = *v_attr] __device__(const VertexHandle vh) mutable {
+            v_attr(vh) += 1;
+        });
+
+    rx.for_each_face(
+        DEVICE,
+        [f_attr = *f_attr] __device__(const FaceHandle fh) mutable {
+            f_attr(fh) += 1;
+        });
+
+    EXPECT_EQ(cudaDeviceSynchronize(), cudaSuccess);
+
+    v_attr->move(DEVICE, HOST);
+    f_attr->move(DEVICE, HOST);
+
+    // every vertex/face is visited exactly once
+    rx.for_each_vertex(
+        HOST, [&](const VertexHandle vh) { EXPECT_EQ((*v_attr)(vh), 1); });
+
+    rx.for_each_face(
+        HOST, [&](const FaceHandle fh) { EXPECT_EQ((*f_attr)(fh), 1); });
+}
+
+TEST(RXMeshStatic, ForEachPatchSubset)
+{
+    using namespace rxmesh;
+
+    RXMeshStatic rx(STRINGIFY(INPUT_DIR) "sphere3.obj", "", false, 64);
+
+    ASSERT_GT(rx.get_num_patches(), 3);
+
+    auto v_attr = *rx.add_vertex_attribute<uint32_t>("v", 1);
+
+    uint32_t* d_patches;
+    CUDA_ERROR(cudaMalloc((void**)&d_patches, sizeof(uint32_t)));
+    CUDA_ERROR(cudaMemset(d_patches, 0, sizeof(uint32_t)));
+
+    VertexReduceHandle<uint32_t> reduce(v_attr);
+
+    for (bool with_ring : {false, true}) {
+        v_attr.reset(0, LOCATION_ALL);
+
+        rx.set_patch_subset(d_patches, 1, with_ring);
+        ASSERT_TRUE(rx.has_patch_subset());
+
+        const uint32_t num = rx.get_patch_subset_size();
+        if (with_ring) {
+            EXPECT_GT(num, 1);
+        } else {
+            EXPECT_EQ(num, 1);
+        }
+
+        std::vector<uint32_t> h_subset(num);
+        CUDA_ERROR(cudaMemcpy(h_subset.data(),
+                              rx.get_patch_subset(),
+                              num * sizeof(uint32_t),
+                              cudaMemcpyDeviceToHost));
+        EXPECT_EQ(h_subset[0], 0);
+        EXPECT_TRUE(std::is_sorted(h_subset.begin(), h_subset.end()));
+
+        rx.for_each_vertex(
+            DEVICE,
+            [=] __device__(const VertexHandle vh) mutable { v_attr(vh) += 1; });
+
+        rx.run_query_kernel<Op::VV, 256>(
+            [=] __device__(const VertexHandle&   vh,
+                           const VertexIterator& iter) mutable {
+                v_attr(vh) += 1;
+            });
+
+        EXPECT_EQ(cudaDeviceSynchronize(), cudaSuccess);
+
+        // only the vertices owned by the subset are visited (by both)
+        reduce.set_patch_subset(rx.get_patch_subset(), num);
+        const uint32_t subset_sum = reduce.reduce(v_attr, cub::Sum(), 0);
+        reduce.clear_patch_subset();
+        const uint32_t total_sum = reduce.reduce(v_attr, cub::Sum(), 0);
+        EXPECT_EQ(subset_sum, total_sum);
+
+        v_attr.move(DEVICE, HOST);
+
+        uint32_t num_visited = 0;
+        rx.for_each_vertex(HOST, [&](const VertexHandle vh) {
+            const bool in_subset =
+                std::binary_search(h_subset.begin(),
+                                   h_subset.end(),
+                                   vh.patch_id());
+            EXPECT_EQ(v_attr(vh), in_subset ? 2 : 0);
+            num_visited += in_subset;
+        });
+        EXPECT_EQ(total_sum, 2 * num_visited);
+
+        rx.clear_patch_subset();
+        EXPECT_FALSE(rx.has_patch_subset());
+    }
+
+    GPU_FREE(d_patches);
+}
+
+TEST(RXMeshStatic, Worklist)
+{
+    using namespace rxmesh;
+
+    RXMeshStatic rx(STRINGIFY(INPUT_DIR) "sphere3.obj");
+
+    auto v_attr = *rx.add_vertex_attribute<uint32_t>("v", 1);
+    v_attr.reset(0, LOCATION_ALL);
+
+    uint32_t* d_count;
+    CUDA_ERROR(cudaMalloc((void**)&d_count, sizeof(uint32_t)));
+    CUDA_ERROR(cudaMemset(d_count, 0, sizeof(uint32_t)));
+
+    // the vertices of the first patch and every other vertex of the rest
+    auto is_active = [] __device__(const VertexHandle& vh) {
+        return vh.patch_id() == 0 || vh.local_id() % 2 == 0;
+    };
+
+    Worklist<VertexHandle> wl(rx);
+    EXPECT_TRUE(wl.empty());
+
+    wl.build(is_active);
+
+    uint32_t expected = 0;
+    rx.for_each_vertex(HOST, [&](const VertexHandle vh) {
+        expected += (vh.patch_id() == 0 || vh.local_id() % 2 == 0);
+    });
+    EXPECT_EQ(wl.size(), expected);
+
+    // every item is visited once by for_each and by the query
+    wl.for_each([=] __device__(const VertexHandle vh, const uint32_t) mutable {
+        v_attr(vh) += 1;
+        ::atomicAdd(d_count, 1u);
+    });
+
+    wl.run_query_kernel<Op::VV, 256>(
+        [=] __device__(const VertexHandle&   vh,
+                       const VertexIterator& iter) mutable {
+            v_attr(vh) += 1;
+        });
+
+    EXPECT_EQ(cudaDeviceSynchronize(), cudaSuccess);
+    EXPECT_FALSE(rx.has_patch_subset());
+
+    uint32_t h_count = 0;
+    CUDA_ERROR(cudaMemcpy(
+        &h_count, d_count, sizeof(uint32_t), cudaMemcpyDeviceToHost));
+    EXPECT_EQ(h_count, expected);
+
+    v_attr.move(DEVICE, HOST);
+    rx.for_each_vertex(HOST, [&](const VertexHandle vh) {
+        const bool active = vh.patch_id() == 0 || vh.local_id() % 2 == 0;
+        EXPECT_EQ(v_attr(vh), active ? 2 : 0);
+    });
+
+    // shrink to the first patch
+    wl.filter(
+        [] __device__(const VertexHandle& vh) { return vh.patch_id() == 0; });
+
+    uint32_t num_first = 0;
+    rx.for_each_vertex(
+        HOST, [&](const VertexHandle vh) { num_first += vh.patch_id() == 0; });
+    EXPECT_EQ(wl.size(), num_first);
+
+    wl.member().move(DEVICE, HOST);
+    rx.for_each_vertex(HOST, [&](const VertexHandle vh) {
+        EXPECT_EQ(wl.member()(vh), vh.patch_id() == 0);
+    });
+
+    wl.clear();
+    EXPECT_TRUE(wl.empty());
+
+    GPU_FREE(d_count);
+}
+
+TEST(RXMeshStatic, LevelSets)
+{
+    using namespace rxmesh;
+
+    std::vector<std::vector<float>>    verts;
+    std::vector<std::vector<uint32_t>> fv;
+    ASSERT_TRUE(import_obj(STRINGIFY(INPUT_DIR) "sphere3.obj", verts, fv));
+
+    RXMeshStatic rx(fv, "", 64);
+    ASSERT_GT(rx.get_num_patches(), 3);
+
+    const uint32_t num_vertices = rx.get_num_vertices();
+
+    // host BFS from the same seeds
+    std::vector<std::vector<uint32_t>> vv(num_vertices);
+    for (const auto& f : fv) {
+        for (uint32_t i = 0; i < 3; ++i) {
+            vv[f[i]].push_back(f[(i + 1) % 3]);
+            vv[f[(i + 1) % 3]].push_back(f[i]);
+        }
+    }
+
+    const std::vector<uint32_t> h_seeds = {0, num_vertices / 2, 0};
+
+    std::vector<uint32_t> expected(num_vertices, INVALID32);
+    std::vector<uint32_t> frontier;
+    for (uint32_t s : h_seeds) {
+        if (expected[s] == INVALID32) {
+            expected[s] = 0;
+            frontier.push_back(s);
+        }
+    }
+    for (size_t i = 0; i < frontier.size(); ++i) {
+        for (uint32_t n : vv[frontier[i]]) {
+            if (expected[n] == INVALID32) {
+                expected[n] = expected[frontier[i]] + 1;
+                frontier.push_back(n);
+            }
+        }
+    }
+
+    std::vector<VertexHandle> seeds;
+    for (uint32_t s : h_seeds) {
+        seeds.push_back(rx.map_to_local_vertex(s));
+    }
+
+    LevelSets      ls(rx);
+    const uint32_t num_levels = ls.compute(seeds);
+
+    EXPECT_EQ(cudaDeviceSynchronize(), cudaSuccess);
+    EXPECT_EQ(num_levels, expected[frontier.back()] + 1);
+    EXPECT_EQ(ls.get_num_reached(), num_vertices);
+    ASSERT_EQ(ls.offset().size(), num_levels + 1);
+    EXPECT_EQ(ls.offset()[1], 2u);
+
+    rx.for_each_vertex(HOST, [&](const VertexHandle vh) {
+        EXPECT_EQ(ls.level()(vh), expected[rx.map_to_global(vh)]);
+    });
+
+    // every vertex is in the range of its level
+    std::vector<VertexHandle> sorted(ls.get_num_reached());
+    CUDA_ERROR(cudaMemcpy(sorted.data(),
+                          ls.sorted(),
+                          sorted.size() * sizeof(VertexHandle),
+                          cudaMemcpyDeviceToHost));
+    std::vector<uint32_t> count(num_vertices, 0);
+    for (uint32_t l = 0; l < num_levels; ++l) {
+        for (uint32_t i = ls.offset()[l]; i < ls.offset()[l + 1]; ++i) {
+            EXPECT_EQ(ls.level()(sorted[i]), l);
+            count[rx.map_to_global(sorted[i])]++;
+        }
+    }
+    for (uint32_t c : count) {
+        EXPECT_EQ(c, 1u);
+    }
+
+    // no seeds
+    EXPECT_EQ(ls.compute({}), 0u);
+    EXPECT_EQ(ls.get_num_reached(), 0u);
+}
+
+TEST(RXMeshStatic, ForEachDense)
+{
+    using namespace rxmesh;
+
+    RXMeshStatic rx(STRINGIFY(INPUT_DIR) "sphere3.obj", "", false, 64);
+
+    ASSERT_GT(rx.get_num_patches(), 3);
+
+    auto e_attr = rx.add_edge_attribute<uint32_t>("e", 2);
+    e_attr->reset(INVALID32, LOCATION_ALL);
+
+    // the lambda gets the dense index along with the handle
+    rx.for_each_dense<EdgeHandle>(
+        DEVICE,
+        [e_attr = *e_attr] __device__(const EdgeHandle eh,
+                                      const uint32_t   id) mutable {
+            e_attr(eh, 0) = id;
+            atomicAdd(&e_attr(eh, 1), 1u);
+        });
+
+    EXPECT_EQ(cudaDeviceSynchronize(), cudaSuccess);
+
+    e_attr->move(DEVICE, HOST);
+
+    // every edge is visited exactly once and its dense index is its linear id
+    rx.for_each_edge(HOST, [&](const EdgeHandle eh) {
+        EXPECT_EQ((*e_attr)(eh, 0), rx.linear_id(eh));
+        EXPECT_EQ((*e_attr)(eh, 1), 1u);
+    });
+
+    std::atomic_uint32_t num_host = 0;
+    rx.for_each_dense<EdgeHandle>(
+        HOST, [&](const EdgeHandle eh, const uint32_t id) {
+            EXPECT_EQ(id, rx.linear_id(eh));
+            num_host++;
+        });
+    EXPECT_EQ(num_host, rx.get_num_edges());
+
+    // only the owned vertices of the patches in the range are processed
+    auto v_attr = rx.add_vertex_attribute<uint32_t>("v", 1);
+    v_attr->reset(0, LOCATION_ALL);
+
+    rx.set_patch_range(1, 3);
+    rx.for_each_dense<VertexHandle>(
+        DEVICE,
+        [v_attr = *v_attr] __device__(const VertexHandle vh,
+                                      const uint32_t) mutable {
+            v_attr(vh) += 1;
+        });
+    rx.set_patch_range(0, rx.get_num_patches());
+
+    EXPECT_EQ(cudaDeviceSynchronize(), cudaSuccess);
+
+    v_attr->move(DEVICE, HOST);
+
+    rx.for_each_vertex(HOST, [&](const VertexHandle vh) {
+        const uint32_t p = vh.patch_id();
+        EXPECT_EQ((*v_attr)(vh), (p >= 1 && p < 3) ? 1u : 0u);
+    });
+}
+
+TEST(RXMeshStatic, BatchedHandleLookup)
+{
+    using namespace rxmesh;
+
+    RXMeshStatic rx(STRINGIFY(INPUT_DIR) "sphere3.obj", "", false, 64);
+
+    const uint32_t num_v = rx.get_num_vertices();
+    const uint32_t num_e = rx.get_num_edges();
+
+    // the global indices of all vertices (reversed) and one out of range
+    std::vector<uint32_t> h_ids(num_v + 1);
+    for (uint32_t i = 0; i < num_v; ++i) {
+        h_ids[i] = num_v - 1 - i;
+    }
+    h_ids[num_v] = num_v;
+
+    uint32_t*     d_ids;
+    VertexHandle* d_vh;
+    CUDA_ERROR(cudaMalloc((void**)&d_ids, h_ids.size() * sizeof(uint32_t)));
+    CUDA_ERROR(cudaMalloc((void**)&d_vh, h_ids.size() * sizeof(VertexHandle)));
+    CUDA_ERROR(cudaMemcpy(d_ids,
+                          h_ids.data(),
+                          h_ids.size() * sizeof(uint32_t),
+                          cudaMemcpyHostToDevice));
+
+    rx.map_to_local_handles<VertexHandle>(d_ids, h_ids.size(), d_vh);
+
+    std::vector<VertexHandle> h_vh(h_ids.size());
+    CUDA_ERROR(cudaMemcpy(h_vh.data(),
+                          d_vh,
+                          h_vh.size() * sizeof(VertexHandle),
+                          cudaMemcpyDeviceToHost));
+    for (uint32_t i = 0; i < num_v; ++i) {
+        EXPECT_EQ(h_vh[i], rx.map_to_local_vertex(h_ids[i]));
+    }
+    EXPECT_FALSE(h_vh[num_v].is_valid());
+
+    // the global indices of the two vertices of every edge
+    auto ev_id = rx.add_edge_attribute<uint32_t>("ev_id", 2);
+
+    const Context ctx   = rx.get_context();
+    auto          ev_at = *ev_id;
+    rx.run_query_kernel<Op::EV, 256>(
+        [=] __device__(const EdgeHandle& eh, const VertexIterator& ev) mutable {
+            ev_at(eh, 0) = ctx.linear_id(ev[0]);
+            ev_at(eh, 1) = ctx.linear_id(ev[1]);
+        });
+    CUDA_ERROR(cudaDeviceSynchronize());
+    ev_id->move(DEVICE, HOST);
+
+    // the edges in linear_id() order with the vertices swapped for every
+    // other edge and one pair of vertices that is not an edge
+    std::vector<uint32_t>   h_v0(num_e + 1), h_v1(num_e + 1);
+    std::vector<EdgeHandle> expected(num_e + 1);
+    rx.for_each_edge(HOST, [&](const EdgeHandle eh) {
+        const uint32_t i = rx.linear_id(eh);
+        const bool     s = i % 2;
+        h_v0[i]          = (*ev_id)(eh, s ? 1 : 0);
+        h_v1[i]          = (*ev_id)(eh, s ? 0 : 1);
+        expected[i]      = eh;
+    });
+    h_v0[num_e] = 0;
+    h_v1[num_e] = 0;
+
+    uint32_t *  d_v0, *d_v1;
+    EdgeHandle* d_eh;
+    CUDA_ERROR(cudaMalloc((void**)&d_v0, h_v0.size() * sizeof(uint32_t)));
+    CUDA_ERROR(cudaMalloc((void**)&d_v1, h_v1.size() * sizeof(uint32_t)));
+    CUDA_ERROR(cudaMalloc((void**)&d_eh, h_v0.size() * sizeof(EdgeHandle)));
+    CUDA_ERROR(cudaMemcpy(d_v0,
+                          h_v0.data(),
+                          h_v0.size() * sizeof(uint32_t),
+                          cudaMemcpyHostToDevice));
+    CUDA_ERROR(cudaMemcpy(d_v1,
+                          h_v1.data(),
+                          h_v1.size() * sizeof(uint32_t),
+                          cudaMemcpyHostToDevice));
+
+    rx.get_edge_handles(d_v0, d_v1, h_v0.size(), d_eh);
+
+    std::vector<EdgeHandle> h_eh(h_v0.size());
+    CUDA_ERROR(cudaMemcpy(h_eh.data(),
+                          d_eh,
+                          h_eh.size() * sizeof(EdgeHandle),
+                          cudaMemcpyDeviceToHost));
+    for (uint32_t i = 0; i < num_e; ++i) {
+        EXPECT_EQ(h_eh[i], expected[i]);
+    }
+    EXPECT_FALSE(h_eh[num_e].is_valid());
+
+    GPU_FREE(d_ids);
+    GPU_FREE(d_vh);
+    GPU_FREE(d_v0);
+    GPU_FREE(d_v1);
+    GPU_FREE(d_eh);
+}
+
+TEST(RXMeshStatic, KernelProfiling)
+{
+    using namespace rxmesh;
+
+    RXMeshStatic rx(STRINGIFY(INPUT_DIR) "sphere3.obj");
+
+    EXPECT_FALSE(rx.is_profiling_enabled());
+    rx.enable_profiling();
+    ASSERT_TRUE(rx.is_profiling_enabled());
+
+    auto v_attr = *rx.add_vertex_attribute<uint32_t>("v", 1);
+    v_attr.reset(0, DEVICE);
+
+    constexpr int num_iter = 5;
+
+    auto count_v = [v_attr] __device__(const VertexHandle vh) mutable {
+        v_attr(vh) += 1;
+    };
+
+    // one read and one write of a uint32_t and (nominally) one FLOP per
+    // vertex
+    rx.set_profile_cost({2 * sizeof(uint32_t), 1});
+    for (int i = 0; i < num_iter; ++i) {
+        rx.for_each_vertex(DEVICE, count_v);
+    }
+    rx.set_profile_cost({});
+
+    rx.set_profile_label("valence");
+    rx.run_query_kernel<Op::VV, 256>(
+        [v_attr] __device__(const VertexHandle&   vh,
+                            const VertexIterator& iter) mutable {
+            v_attr(vh) = iter.size();
+        });
+    rx.set_profile_label("");
+
+    std::vector<KernelProfile> profs =
+        rx.get_kernel_profiler()->get_profiles();
+
+    ASSERT_EQ(profs.size(), 2);
+
+    bool found_for_each = false, found_query = false;
+    for (const auto& p : profs) {
+        EXPECT_GT(p.total_ms, 0);
+        EXPECT_GT(p.blocks, 0);
+        EXPECT_GT(p.threads, 0);
+        EXPECT_GE(p.num_regs, 0);
+        if (p.api == "for_each_vertex") {
+            found_for_each = true;
+            EXPECT_EQ(p.num_launches, num_iter);
+            EXPECT_EQ(p.blocks, rx.get_num_patches());
+            EXPECT_DOUBLE_EQ(p.flops, double(num_iter) * rx.get_num_vertices());
+            EXPECT_EQ(p.bytes,
+                      size_t(num_iter) * 2 * sizeof(uint32_t) *
+                          rx.get_num_vertices());
+            EXPECT_GT(p.occupancy, 0);
+            EXPECT_LE(p.occupancy, 1);
+        }
+        if (p.api == "run_query_kernel") {
+            found_query = true;
+            EXPECT_EQ(p.num_launches, 1);
+            EXPECT_EQ(p.name, "valence");
+            EXPECT_EQ(p.ops, "VV");
+            EXPECT_GT(p.smem_bytes_dyn, 0);
+            EXPECT_GT(p.bytes, 0);
+            EXPECT_EQ(p.flops, 0);
+        }
+    }
+    EXPECT_TRUE(found_for_each);
+    EXPECT_TRUE(found_query);
+
+    rx.get_kernel_profiler()->print_summary();
+
+    rx.disable_profiling();
+    EXPECT_EQ(rx.get_kernel_profiler(), nullptr);
+
+    rx.remove_attribute("v");
+}
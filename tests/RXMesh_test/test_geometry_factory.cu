@@ -0,0 +1,116 @@
+#include "gtest/gtest.h"
+
+#include <cmath>
+
+#include "rxmesh/geometry_factory.h"
+#include "rxmesh/geometry_factory_device.cuh"
+#include "rxmesh/rxmesh_dynamic.h"
+
+TEST(GeometryFactory, DevicePlane)
+{
+    using namespace rxmesh;
+
+    const uint32_t nx = 17, ny = 9;
+
+    std::vector<std::vector<float>>    verts;
+    std::vector<std::vector<uint32_t>> tris;
+    create_plane(verts, tris, nx, ny, 2, 0.5f);
+
+    DeviceMesh mesh = generate_plane(nx, ny, 2, 0.5f);
+
+    std::vector<uint32_t> fv;
+    std::vector<float>    vertices;
+    mesh.download(fv, vertices);
+
+    ASSERT_EQ(mesh.num_vertices, verts.size());
+    ASSERT_EQ(mesh.num_faces, tris.size());
+
+    for (size_t v = 0; v < verts.size(); ++v) {
+        for (size_t i = 0; i < 3; ++i) {
+            EXPECT_FLOAT_EQ(vertices[3 * v + i], verts[v][i]);
+        }
+    }
+    for (size_t f = 0; f < tris.size(); ++f) {
+        for (size_t i = 0; i < 3; ++i) {
+            EXPECT_EQ(fv[3 * f + i], tris[f][i]);
+        }
+    }
+
+    mesh.release();
+}
+
+TEST(GeometryFactory, DeviceIcosphere)
+{
+    using namespace rxmesh;
+
+    for (uint32_t n : {1u, 2u, 5u, 16u}) {
+        DeviceMesh mesh = generate_icosphere(n, 2.f);
+
+        EXPECT_EQ(mesh.num_vertices, 10 * n * n + 2);
+        EXPECT_EQ(mesh.num_faces, 20 * n * n);
+
+        std::vector<uint32_t> fv;
+        std::vector<float>    vertices;
+        mesh.download(fv, vertices);
+
+        for (uint32_t v = 0; v < mesh.num_vertices; ++v) {
+            const float* p = vertices.data() + 3 * v;
+            const float  r = std::sqrt(p[0] * p[0] + p[1] * p[1] + p[2] * p[2]);
+            EXPECT_NEAR(r, 2.f, 1e-5f);
+        }
+
+        auto rx = make_mesh<RXMeshStatic>(mesh);
+
+        EXPECT_TRUE(rx->is_closed());
+        EXPECT_TRUE(rx->is_edge_manifold());
+        EXPECT_EQ(rx->get_num_vertices(), 10 * n * n + 2);
+        EXPECT_EQ(rx->get_num_edges(), 30 * n * n);
+        EXPECT_EQ(rx->get_num_faces(), 20 * n * n);
+
+        mesh.release();
+    }
+}
+
+TEST(GeometryFactory, DeviceTorusAndNoisySphere)
+{
+    using namespace rxmesh;
+
+    const uint32_t nu = 32, nv = 12;
+
+    DeviceMesh torus = generate_torus(nu, nv);
+
+    auto rx = make_mesh<RXMeshDynamic>(torus);
+
+    // genus one i.e., V - E + F = 0
+    EXPECT_TRUE(rx->is_closed());
+    EXPECT_EQ(rx->get_num_vertices(), nu * nv);
+    EXPECT_EQ(rx->get_num_faces(), 2 * nu * nv);
+    EXPECT_EQ(rx->get_num_edges(), 3 * nu * nv);
+    EXPECT_TRUE(rx->validate());
+
+    torus.release();
+
+    // the noise is the same in every run
+    DeviceMesh a = generate_noisy_sphere(8, 1.f, 0.1f, 7);
+    DeviceMesh b = generate_noisy_sphere(8, 1.f, 0.1f, 7);
+
+    std::vector<uint32_t> fa, fb;
+    std::vector<float>    va, vb;
+    a.download(fa, va);
+    b.download(fb, vb);
+
+    EXPECT_EQ(fa, fb);
+    EXPECT_EQ(va, vb);
+
+    for (uint32_t v = 0; v < a.num_vertices; ++v) {
+        const float* p = va.data() + 3 * v;
+        const float  r = std::sqrt(p[0] * p[0] + p[1] * p[1] + p[2] * p[2]);
+        EXPECT_LE(r, 1.1f + 1e-5f);
+        EXPECT_GE(r, 0.9f - 1e-5f);
+    }
+
+    a.release();
+    b.release();
+
+    EXPECT_EQ(cudaDeviceSynchronize(), cudaSuccess);
+}
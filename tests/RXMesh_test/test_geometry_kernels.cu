@@ -0,0 +1,104 @@
+#include "gtest/gtest.h"
+
+#include "rxmesh/geometry_kernels.cuh"
+#include "rxmesh/rxmesh_static.h"
+
+TEST(RXMeshStatic, GeometryKernels)
+{
+    using namespace rxmesh;
+
+    constexpr double PI = 3.14159265358979323846;
+
+    RXMeshStatic rx(STRINGIFY(INPUT_DIR) "sphere3.obj");
+
+    auto coords = *rx.get_input_vertex_coordinates();
+
+    auto geom = compute_geometry<GEOM_NORMAL | GEOM_VORONOI_AREA |
+                                     GEOM_ANGLE_DEFECT | GEOM_COTAN_WEIGHT |
+                                     GEOM_MEAN_CURVATURE,
+                                 float>(rx, coords, LOCATION_ALL);
+
+    ASSERT_NE(geom.normal, nullptr);
+    ASSERT_NE(geom.voronoi_area, nullptr);
+    ASSERT_NE(geom.angle_defect, nullptr);
+    ASSERT_NE(geom.cotan_weight, nullptr);
+    ASSERT_NE(geom.mean_curvature, nullptr);
+
+    // the total surface area and the edges' squared lengths (which, weighted
+    // by the cotan weights, also sum up to twice the surface area)
+    auto f_area = rx.add_face_attribute<float>("fArea", 1);
+    auto e_len2 = rx.add_edge_attribute<float>("eLen2", 1);
+
+    rx.run_query_kernel<Op::FV, 256>(
+        [coords, a = *f_area] __device__(const FaceHandle&     fh,
+                                         const VertexIterator& fv) mutable {
+            a(fh) = tri_area(coords.to_glm<3>(fv[0]),
+                             coords.to_glm<3>(fv[1]),
+                             coords.to_glm<3>(fv[2]));
+        });
+
+    rx.run_query_kernel<Op::EV, 256>(
+        [coords, l = *e_len2] __device__(const EdgeHandle&     eh,
+                                         const VertexIterator& ev) mutable {
+            l(eh) = glm::distance2(coords.to_glm<3>(ev[0]),
+                                   coords.to_glm<3>(ev[1]));
+        });
+    CUDA_ERROR(cudaDeviceSynchronize());
+
+    f_area->move(DEVICE, HOST);
+    e_len2->move(DEVICE, HOST);
+
+    double total_area = 0;
+    rx.for_each_face(
+        HOST, [&](const FaceHandle fh) { total_area += (*f_area)(fh); });
+
+    // the sphere center
+    glm::dvec3 center(0, 0, 0);
+    rx.for_each_vertex(HOST, [&](const VertexHandle vh) {
+        center += glm::dvec3(coords.to_glm<3>(vh));
+    });
+    center /= double(rx.get_num_vertices());
+
+    double sum_area = 0, sum_defect = 0, sum_mean = 0, sum_radius = 0;
+
+    rx.for_each_vertex(HOST, [&](const VertexHandle vh) {
+        sum_area += (*geom.voronoi_area)(vh);
+        sum_defect += (*geom.angle_defect)(vh);
+
+        const glm::dvec3 r = glm::dvec3(coords.to_glm<3>(vh)) - center;
+
+        sum_radius += glm::length(r);
+        sum_mean += (*geom.mean_curvature)(vh);
+
+        // the normals should be unit and point outward
+        const glm::dvec3 n(geom.normal->to_glm<3>(vh));
+        EXPECT_NEAR(glm::length(n), 1.0, 1e-4);
+        EXPECT_GT(glm::dot(n, glm::normalize(r)), 0.9);
+    });
+
+    double sum_weights = 0;
+    rx.for_each_edge(HOST, [&](const EdgeHandle eh) {
+        sum_weights += (*geom.cotan_weight)(eh) * (*e_len2)(eh);
+    });
+
+    // the mixed Voronoi areas partition the surface
+    EXPECT_NEAR(sum_area, total_area, 1e-3 * total_area);
+
+    // Gauss-Bonnet of a closed genus-0 surface
+    EXPECT_NEAR(sum_defect, 4.0 * PI, 1e-2);
+
+    EXPECT_NEAR(sum_weights, 2.0 * total_area, 1e-3 * total_area);
+
+    // the mean curvature of a sphere is 1/r
+    const double num_v  = double(rx.get_num_vertices());
+    const double radius = sum_radius / num_v;
+    EXPECT_NEAR(sum_mean / num_v, 1.0 / radius, 0.05 / radius);
+
+    rx.remove_attribute("fArea");
+    rx.remove_attribute("eLen2");
+    rx.remove_attribute("geomNormal");
+    rx.remove_attribute("geomVoronoiArea");
+    rx.remove_attribute("geomAngleDefect");
+    rx.remove_attribute("geomCotanWeight");
+    rx.remove_attribute("geomMeanCurvature");
+}
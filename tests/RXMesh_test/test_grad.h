@@ -1,11 +1,16 @@
 #pragma once
 
+#include <set>
+
 #include "gtest/gtest.h"
 
 #include "rxmesh/rxmesh_static.h"
+#include "rxmesh/util/import_obj.h"
 
+#include "rxmesh/diff/ccd.h"
 #include "rxmesh/diff/diff_scalar_problem.h"
 #include "rxmesh/diff/gradient_descent.h"
+#include "rxmesh/diff/lbvh_broad_phase.h"
 #include "rxmesh/diff/newton_solver.h"
 
 
@@ -34,6 +39,45 @@ inline void add_term(ProblemT& problem)
         });
 }
 
+template <typename ProblemT>
+inline void add_two_terms(ProblemT& problem, bool fused)
+{
+    using namespace rxmesh;
+
+    auto dist_sq = [=] __device__(
+                       const auto& eh, const auto& iter, auto& objective) {
+        using ActiveT = ACTIVE_TYPE(eh);
+
+        Eigen::Vector3<ActiveT> d0 =
+            iter_val<ActiveT, 3>(eh, iter, objective, 0);
+        Eigen::Vector3<ActiveT> d1 =
+            iter_val<ActiveT, 3>(eh, iter, objective, 1);
+
+        return (d0 - d1).squaredNorm();
+    };
+
+    auto dist_quad = [=] __device__(
+                         const auto& eh, const auto& iter, auto& objective) {
+        using ActiveT = ACTIVE_TYPE(eh);
+
+        Eigen::Vector3<ActiveT> d0 =
+            iter_val<ActiveT, 3>(eh, iter, objective, 0);
+        Eigen::Vector3<ActiveT> d1 =
+            iter_val<ActiveT, 3>(eh, iter, objective, 1);
+
+        ActiveT l = (d0 - d1).squaredNorm();
+
+        return 0.5 * l * l;
+    };
+
+    if (fused) {
+        problem.template add_fused_term<Op::EV>(dist_sq, dist_quad);
+    } else {
+        problem.template add_term<Op::EV>(dist_sq);
+        problem.template add_term<Op::EV>(dist_quad);
+    }
+}
+
 TEST(Diff, SmoothingNewton)
 {
     using namespace rxmesh;
@@ -112,3 +156,432 @@ TEST(Diff, SmoothingNewton)
         }
     });
 }
+
+TEST(Diff, BatchedLineSearch)
+{
+    // the batched line search should accept the same step as the sequential
+    // line search
+    using namespace rxmesh;
+
+    RXMeshStatic rx(STRINGIFY(INPUT_DIR) "bunnyhead.obj");
+
+    using T = float;
+
+    constexpr int VariableDim = 3;
+
+    using ProblemT = DiffScalarProblem<T, VariableDim, VertexHandle, true>;
+
+    ProblemT problem(rx, true);
+
+    auto v_input_pos = *rx.get_input_vertex_coordinates();
+
+    add_term(problem);
+
+    using HessMatT = typename ProblemT::HessMatT;
+
+    LUSolver<HessMatT, ProblemT::DenseMatT::OrderT> solver(problem.hess.get());
+
+    NetwtonSolver newton(problem, &solver);
+
+    auto sequential = rx.add_attribute_like("sequential", *problem.objective);
+
+    for (int batch_size : {1, 3, 16}) {
+        // a large initial step such that a few steps are rejected
+        const T s_max = 8;
+
+        problem.objective->copy_from(v_input_pos, DEVICE, DEVICE);
+        problem.eval_terms();
+        newton.compute_direction();
+        newton.line_search(s_max, 0.5);
+        const T f_sequential = problem.get_current_loss();
+        sequential->copy_from(*problem.objective, DEVICE, DEVICE);
+
+        problem.objective->copy_from(v_input_pos, DEVICE, DEVICE);
+        problem.eval_terms();
+        newton.compute_direction();
+        newton.line_search_batched(s_max, 0.5, 64, 1e-4, batch_size);
+        const T f_batched = problem.get_current_loss();
+
+        EXPECT_NEAR(f_sequential, f_batched, 1e-3 * std::abs(f_sequential));
+
+        problem.objective->move(DEVICE, HOST);
+        sequential->move(DEVICE, HOST);
+
+        rx.for_each_vertex(HOST, [&](const VertexHandle vh) {
+            for (int i = 0; i < VariableDim; ++i) {
+                EXPECT_NEAR(
+                    (*problem.objective)(vh, i), (*sequential)(vh, i), 1e-5);
+            }
+        });
+    }
+}
+
+TEST(Diff, TermReport)
+{
+    using namespace rxmesh;
+
+    RXMeshStatic rx(STRINGIFY(INPUT_DIR) "bunnyhead.obj");
+
+    using T = float;
+
+    using ProblemT = DiffScalarProblem<T, 3, VertexHandle, true>;
+
+    ProblemT problem(rx, true);
+
+    add_term(problem);
+
+    std::vector<TermReport> reports = problem.get_term_reports();
+
+    ASSERT_EQ(reports.size(), 1);
+
+    // an EV term on 3D vertex variables has 6 variables
+    EXPECT_EQ(reports[0].num_variables, 6);
+    EXPECT_EQ(reports[0].scalar_bytes, sizeof(Scalar<T, 6, true>));
+    EXPECT_GT(reports[0].launch.blocks_per_sm, 0);
+    EXPECT_GT(reports[0].launch.num_registers_per_thread, 0);
+
+    problem.print_term_reports();
+}
+
+TEST(Diff, FusedTerms)
+{
+    // the fused terms should give the same energy, gradient, and Hessian as
+    // adding the terms separately
+    using namespace rxmesh;
+
+    RXMeshStatic rx(STRINGIFY(INPUT_DIR) "bunnyhead.obj");
+
+    using T = double;
+
+    using ProblemT = DiffScalarProblem<T, 3, VertexHandle, true>;
+
+    ProblemT separate(rx, true);
+    ProblemT fused(rx, true);
+
+    auto v_input_pos = *rx.get_input_vertex_coordinates();
+
+    separate.objective->copy_from(v_input_pos, DEVICE, DEVICE);
+    fused.objective->copy_from(v_input_pos, DEVICE, DEVICE);
+
+    add_two_terms(separate, false);
+    add_two_terms(fused, true);
+
+    EXPECT_EQ(separate.terms.size(), 2);
+    EXPECT_EQ(fused.terms.size(), 1);
+
+    separate.eval_terms();
+    fused.eval_terms();
+
+    const T f_separate = separate.get_current_loss();
+    const T f_fused    = fused.get_current_loss();
+
+    EXPECT_NEAR(f_separate, f_fused, 1e-9 * std::abs(f_separate));
+
+    separate.grad.move(DEVICE, HOST);
+    fused.grad.move(DEVICE, HOST);
+
+    for (int i = 0; i < separate.grad.rows(); ++i) {
+        for (int j = 0; j < separate.grad.cols(); ++j) {
+            EXPECT_NEAR(separate.grad(i, j), fused.grad(i, j), 1e-9);
+        }
+    }
+
+    separate.hess->move(DEVICE, HOST);
+    fused.hess->move(DEVICE, HOST);
+
+    ASSERT_EQ(separate.hess->non_zeros(), fused.hess->non_zeros());
+
+    for (int i = 0; i < separate.hess->non_zeros(); ++i) {
+        EXPECT_NEAR(separate.hess->val_ptr(HOST)[i],
+                    fused.hess->val_ptr(HOST)[i],
+                    1e-9);
+    }
+}
+
+template <typename ProblemT>
+inline void add_vf_centroid_term(ProblemT& problem)
+{
+    using namespace rxmesh;
+
+    // 9 * |p - centroid(a, b, c)|^2 for every vertex-face pair
+    problem.template add_pair_term<VertexHandle, FaceHandle>(
+        [=] __device__(const auto& id, const auto& iter, const auto& obj) {
+            using ActiveT = ACTIVE_TYPE(id);
+
+            const Eigen::Vector3<ActiveT> p =
+                iter_val<ActiveT, 3>(id, iter, obj, 0);
+            const Eigen::Vector3<ActiveT> a =
+                iter_val<ActiveT, 3>(id, iter, obj, 1);
+            const Eigen::Vector3<ActiveT> b =
+                iter_val<ActiveT, 3>(id, iter, obj, 2);
+            const Eigen::Vector3<ActiveT> c =
+                iter_val<ActiveT, 3>(id, iter, obj, 3);
+
+            const Eigen::Vector3<ActiveT> d = p + p + p - a - b - c;
+
+            return d.squaredNorm();
+        });
+}
+
+TEST(Diff, LBVHBroadPhase)
+{
+    // the broad phase should find the same vertex-face and edge-edge pairs as
+    // a brute force search and the pair term should be evaluated on them
+    using namespace rxmesh;
+
+    using T = float;
+
+    std::vector<std::vector<T>>        Verts;
+    std::vector<std::vector<uint32_t>> Faces;
+    ASSERT_TRUE(import_obj(STRINGIFY(INPUT_DIR) "sphere3.obj", Verts, Faces));
+
+    RXMeshStatic rx(STRINGIFY(INPUT_DIR) "sphere3.obj");
+
+    // dhat relative to the bounding box
+    detail::AABB<T> bbox = detail::AABB<T>::empty();
+    for (const auto& v : Verts) {
+        bbox.expand(v.data());
+    }
+    T diag = 0;
+    for (int d = 0; d < 3; ++d) {
+        diag += (bbox.hi[d] - bbox.lo[d]) * (bbox.hi[d] - bbox.lo[d]);
+    }
+    const T dhat = T(0.1) * std::sqrt(diag);
+
+    auto box = [&](const std::vector<uint32_t>& ids) {
+        detail::AABB<T> b = detail::AABB<T>::empty();
+        for (uint32_t id : ids) {
+            b.expand(Verts[id].data());
+        }
+        b.inflate(T(0.5) * dhat);
+        return b;
+    };
+
+    auto shared = [](const std::vector<uint32_t>& a,
+                     const std::vector<uint32_t>& b) {
+        for (uint32_t i : a) {
+            for (uint32_t j : b) {
+                if (i == j) {
+                    return true;
+                }
+            }
+        }
+        return false;
+    };
+
+    // brute force vertex-face pairs along with the energy of the term
+    int    num_vf = 0;
+    double f_vf   = 0;
+    for (uint32_t v = 0; v < Verts.size(); ++v) {
+        const std::vector<uint32_t> vid = {v};
+        const detail::AABB<T>       vb  = box(vid);
+        for (const auto& f : Faces) {
+            if (shared(vid, f) || !vb.overlaps(box(f))) {
+                continue;
+            }
+            num_vf++;
+            for (int d = 0; d < 3; ++d) {
+                const double x = 3.0 * Verts[v][d] - Verts[f[0]][d] -
+                                 Verts[f[1]][d] - Verts[f[2]][d];
+                f_vf += x * x;
+            }
+        }
+    }
+
+    // brute force edge-edge pairs
+    std::set<std::pair<uint32_t, uint32_t>> edge_set;
+    for (const auto& f : Faces) {
+        for (int i = 0; i < 3; ++i) {
+            const uint32_t a = f[i];
+            const uint32_t b = f[(i + 1) % 3];
+            edge_set.insert({std::min(a, b), std::max(a, b)});
+        }
+    }
+    std::vector<std::vector<uint32_t>> edges;
+    for (const auto& e : edge_set) {
+        edges.push_back({e.first, e.second});
+    }
+    int num_ee = 0;
+    for (size_t i = 0; i < edges.size(); ++i) {
+        const detail::AABB<T> bi = box(edges[i]);
+        for (size_t j = i + 1; j < edges.size(); ++j) {
+            if (!shared(edges[i], edges[j]) && bi.overlaps(box(edges[j]))) {
+                num_ee++;
+            }
+        }
+    }
+
+    ASSERT_GT(num_vf, 0);
+    ASSERT_GT(num_ee, 0);
+
+    using ProblemT = DiffScalarProblem<T, 3, VertexHandle, true>;
+
+    ProblemT problem(rx, true, 0, num_vf, num_ee);
+
+    auto x = rx.get_input_vertex_coordinates();
+
+    problem.objective->copy_from(*x, DEVICE, DEVICE);
+
+    LBVHBroadPhase<T> broad_phase(rx);
+
+    broad_phase.update(*x, dhat);
+
+    EXPECT_EQ(broad_phase.find_vf_pairs(rx, *x, problem.vf_pairs), 0);
+    EXPECT_EQ(broad_phase.find_ee_pairs(problem.ee_pairs), 0);
+
+    EXPECT_EQ(problem.vf_pairs.num_pairs(), num_vf);
+    EXPECT_EQ(problem.ee_pairs.num_pairs(), num_ee);
+
+    // refitting to the same positions gives the same pairs
+    broad_phase.update(*x, dhat, false);
+
+    EXPECT_EQ(broad_phase.find_vf_pairs(rx, *x, problem.vf_pairs), 0);
+    EXPECT_EQ(broad_phase.find_ee_pairs(problem.ee_pairs), 0);
+
+    EXPECT_EQ(problem.vf_pairs.num_pairs(), num_vf);
+    EXPECT_EQ(problem.ee_pairs.num_pairs(), num_ee);
+
+    add_vf_centroid_term(problem);
+
+    problem.update_hessian();
+
+    problem.eval_terms();
+
+    const T f = problem.get_current_loss();
+
+    EXPECT_NEAR(f, f_vf, 1e-3 * f_vf);
+
+    // every entry should be inserted once in the Hessian
+    problem.hess->move(DEVICE, HOST);
+
+    const int* row_ptr = problem.hess->row_ptr(HOST);
+    const int* col_idx = problem.hess->col_idx(HOST);
+
+    for (int r = 0; r < problem.hess->rows(); ++r) {
+        std::set<int> cols(col_idx + row_ptr[r], col_idx + row_ptr[r + 1]);
+        EXPECT_EQ(cols.size(), size_t(row_ptr[r + 1] - row_ptr[r]));
+    }
+
+    broad_phase.release();
+}
+
+TEST(Diff, CCD)
+{
+    using namespace rxmesh;
+
+    using T = double;
+
+    using VecT = Eigen::Vector3<T>;
+
+    const T eta = 0.1;
+
+    // a point 1 unit above a triangle moving down by 2, i.e., the impact is
+    // at 0.5
+    {
+        const VecT x0[4] = {
+            VecT(0.2, 0.2, 1), VecT(0, 0, 0), VecT(1, 0, 0), VecT(0, 1, 0)};
+        VecT       dx[4] = {
+            VecT(0, 0, -2), VecT(0, 0, 0), VecT(0, 0, 0), VecT(0, 0, 0)};
+
+        const T toi = point_triangle_ccd(x0, dx, eta, T(0), 1000);
+        EXPECT_LE(toi, 0.5);
+        EXPECT_GT(toi, 0.5 * (1 - 2 * eta));
+    }
+
+    // moving away from the triangle
+    {
+        const VecT x0[4] = {
+            VecT(0.2, 0.2, 1), VecT(0, 0, 0), VecT(1, 0, 0), VecT(0, 1, 0)};
+        VecT       dx[4] = {
+            VecT(0, 0, 2), VecT(0, 0, 0), VecT(0, 0, 0), VecT(0, 0, 0)};
+
+        EXPECT_EQ(point_triangle_ccd(x0, dx, eta, T(0), 1000), T(1));
+    }
+
+    // two crossing edges one unit apart moving toward each other
+    {
+        const VecT x0[4] = {VecT(-1, 0, 1),
+                            VecT(1, 0, 1),
+                            VecT(0, -1, 0),
+                            VecT(0, 1, 0)};
+        VecT       dx[4] = {VecT(0, 0, -1),
+                            VecT(0, 0, -1),
+                            VecT(0, 0, 1),
+                            VecT(0, 0, 1)};
+
+        const T toi = edge_edge_ccd(x0, dx, eta, T(0), 1000);
+        EXPECT_LE(toi, 0.5);
+        EXPECT_GT(toi, 0.5 * (1 - 2 * eta));
+    }
+
+    EXPECT_NEAR(
+        edge_edge_distance2(
+            VecT(-1, 0, 1), VecT(1, 0, 1), VecT(0, -1, 0), VecT(0, 1, 0)),
+        1.0,
+        1e-12);
+    EXPECT_NEAR(point_triangle_distance2(
+                    VecT(2, 0, 0), VecT(0, 0, 0), VecT(1, 0, 0), VecT(0, 1, 0)),
+                1.0,
+                1e-12);
+}
+
+TEST(Diff, CCDStepFilter)
+{
+    // shrinking the sphere to its center brings every pair into contact at
+    // the step 1 and so the max feasible step should be less than 1
+    using namespace rxmesh;
+
+    using T = float;
+
+    RXMeshStatic rx(STRINGIFY(INPUT_DIR) "sphere3.obj");
+
+    using ProblemT = DiffScalarProblem<T, 3, VertexHandle, true>;
+
+    const int capacity = 64 * rx.get_num_vertices();
+
+    // no Hessian is needed for the step filter
+    ProblemT problem(rx, false, 0, capacity, 0);
+
+    auto x = rx.get_input_vertex_coordinates();
+
+    problem.objective->copy_from(*x, DEVICE, DEVICE);
+
+    // dhat relative to the bounding box
+    detail::AABB<T> bbox = detail::AABB<T>::empty();
+    rx.for_each_vertex(HOST, [&](const VertexHandle vh) {
+        const T p[3] = {(*x)(vh, 0), (*x)(vh, 1), (*x)(vh, 2)};
+        bbox.expand(p);
+    });
+    const T dhat = T(0.05) * (bbox.hi[0] - bbox.lo[0]);
+
+    LBVHBroadPhase<T> broad_phase(rx);
+
+    broad_phase.update(*x, dhat);
+    EXPECT_EQ(broad_phase.find_vf_pairs(rx, *x, problem.vf_pairs), 0);
+
+    ASSERT_GT(problem.vf_pairs.num_pairs(), 0);
+
+    DenseMatrix<T, Eigen::RowMajor> dir(rx, rx.get_num_vertices(), 3);
+
+    rx.for_each_vertex(HOST, [&](const VertexHandle vh) {
+        for (int i = 0; i < 3; ++i) {
+            const T center = T(0.5) * (bbox.lo[i] + bbox.hi[i]);
+            dir(vh, i)     = center - (*x)(vh, i);
+        }
+    });
+    dir.move(HOST, DEVICE);
+
+    CCDStepFilter<T> ccd(rx);
+
+    const T step = ccd.max_step(problem, dir, T(1));
+
+    EXPECT_GT(step, T(0));
+    EXPECT_LT(step, T(1));
+
+    // no motion, no impact
+    dir.reset(0, DEVICE);
+    EXPECT_EQ(ccd.max_step(problem, dir, T(1)), T(1));
+
+    broad_phase.release();
+    dir.release();
+}
@@ -165,4 +165,166 @@ TEST(Diff, HessUpdate)
 
     GPU_FREE(d_new_rows);
     GPU_FREE(d_new_cols);
-}
\ No newline at end of file
+}
+TEST(Diff, HessCache)
+{
+    // the element-by-element (cached) Hessian-vector product should match
+    // the one that re-differentiates the energy
+    using namespace rxmesh;
+
+    using T = float;
+
+    std::vector<std::vector<T>>        verts;
+    std::vector<std::vector<uint32_t>> fv;
+
+    int n = 16;
+
+    T dx = 1 / T(n - 1);
+
+    create_plane(verts, fv, n, n, 2, dx, true);
+
+    RXMeshStatic rx(fv);
+    rx.add_vertex_coordinates(verts, "Coords");
+
+    constexpr int VariableDim = 3;
+
+    using ProblemT = DiffScalarProblem<T, VariableDim, VertexHandle, true>;
+
+    ProblemT problem(rx, false);
+
+    T mass = 0.01;
+
+    auto x = *rx.get_input_vertex_coordinates();
+
+    add_term(problem, x, mass);
+
+    // spring-like energy on the face edges
+    problem.template add_term<Op::FV, true>(
+        [x] __device__(const auto& fh, const auto& iter, auto& obj) mutable {
+            using ActiveT = ACTIVE_TYPE(fh);
+
+            ActiveT E(0);
+            for (int i = 0; i < 3; ++i) {
+                int j = (i + 1) % 3;
+
+                Eigen::Vector3<ActiveT> a =
+                    iter_val<ActiveT, 3>(fh, iter, obj, i);
+                Eigen::Vector3<ActiveT> b =
+                    iter_val<ActiveT, 3>(fh, iter, obj, j);
+
+                Eigen::Vector3<T> xa = x.to_eigen<3>(iter[i]);
+                Eigen::Vector3<T> xb = x.to_eigen<3>(iter[j]);
+
+                T rest = (xa - xb).squaredNorm();
+
+                ActiveT l = (a - b).squaredNorm() - rest;
+
+                E += l * l;
+            }
+            return E;
+        });
+
+    // perturb the objective away from the rest shape
+    rx.for_each_vertex(DEVICE,
+                       [x, obj = *problem.objective] __device__(
+                           const VertexHandle& vh) mutable {
+                           for (int i = 0; i < VariableDim; ++i) {
+                               obj(vh, i) = x(vh, i) * T(1.1) + T(0.01) * i;
+                           }
+                       });
+
+    const int num_rows = VariableDim * rx.get_num_vertices();
+
+    DenseMatrix<T, Eigen::RowMajor> in(num_rows, 1);
+    DenseMatrix<T, Eigen::RowMajor> out_ref(num_rows, 1);
+    DenseMatrix<T, Eigen::RowMajor> out(num_rows, 1);
+
+    in.fill_random();
+    in.move(HOST, DEVICE);
+
+    problem.eval_matvec(in, out_ref);
+    out_ref.move(DEVICE, HOST);
+
+    for (bool fp32 : {false, true}) {
+        problem.enable_hessian_cache(fp32);
+        EXPECT_TRUE(problem.is_hessian_cache_enabled());
+
+        problem.eval_hessian_cache();
+        problem.eval_matvec(in, out);
+        out.move(DEVICE, HOST);
+
+        for (int i = 0; i < num_rows; ++i) {
+            EXPECT_NEAR(out(i, 0), out_ref(i, 0), 1e-3);
+        }
+    }
+
+    problem.disable_hessian_cache();
+    EXPECT_FALSE(problem.is_hessian_cache_enabled());
+
+    in.release();
+    out_ref.release();
+    out.release();
+}
+
+TEST(Diff, HessProjection)
+{
+    using namespace rxmesh;
+
+    using T = double;
+
+    constexpr int k = 12;
+
+    using MatT = Eigen::Matrix<T, k, k>;
+    using VecT = Eigen::Matrix<T, k, 1>;
+
+    const T eps = 1e-9;
+
+    std::srand(0);
+
+    for (int test = 0; test < 20; ++test) {
+        MatT R = MatT::Random();
+        MatT H = 0.5 * (R + R.transpose());
+
+        Eigen::SelfAdjointEigenSolver<MatT> eig(H);
+
+        // Jacobi eigenvalues should match Eigen's
+        MatT A = H;
+        VecT eigvals;
+        MatT V;
+        jacobi_eigen<k, T>(A, eigvals, V);
+
+        EXPECT_TRUE((V * eigvals.asDiagonal() * V.transpose()).isApprox(H));
+
+        std::sort(eigvals.data(), eigvals.data() + k);
+        for (int i = 0; i < k; ++i) {
+            EXPECT_NEAR(eigvals[i], eig.eigenvalues()[i], 1e-9);
+        }
+
+        // clamp
+        MatT ref = eig.eigenvectors() *
+                   eig.eigenvalues().cwiseMax(eps).asDiagonal() *
+                   eig.eigenvectors().transpose();
+
+        MatT clamp = H;
+        project_positive_definite<k, T>(clamp, PSDProjection::Clamp, eps);
+        EXPECT_TRUE(clamp.isApprox(ref, 1e-8));
+
+        // abs
+        ref = eig.eigenvectors() *
+              eig.eigenvalues().cwiseAbs().cwiseMax(eps).asDiagonal() *
+              eig.eigenvectors().transpose();
+
+        MatT abs = H;
+        project_positive_definite<k, T>(abs, PSDProjection::Abs, eps);
+        EXPECT_TRUE(abs.isApprox(ref, 1e-8));
+
+        // diagonal shift
+        MatT shift = H;
+        project_positive_definite<k, T>(
+            shift, PSDProjection::DiagonalShift, eps);
+        EXPECT_TRUE((shift - H).isDiagonal());
+
+        Eigen::SelfAdjointEigenSolver<MatT> eig_shift(shift);
+        EXPECT_GE(eig_shift.eigenvalues()[0], eps - 1e-9);
+    }
+}
@@ -0,0 +1,116 @@
+#include "gtest/gtest.h"
+
+#include <filesystem>
+#include <fstream>
+
+#include "rxmesh/rxmesh_static.h"
+#include "rxmesh/util/import_mesh.h"
+#include "rxmesh/util/import_obj.h"
+
+TEST(Util, ImportMesh)
+{
+    std::vector<std::vector<float>>    vertices;
+    std::vector<std::vector<uint32_t>> faces;
+
+    ASSERT_TRUE(
+        import_obj(STRINGIFY(INPUT_DIR) "sphere3.obj", vertices, faces));
+
+    std::vector<float>    flat_v;
+    std::vector<uint32_t> flat_f, face_offset;
+
+    ASSERT_TRUE(import_mesh(
+        STRINGIFY(INPUT_DIR) "sphere3.obj", flat_v, flat_f, face_offset));
+
+    // sphere3 is a triangle mesh and thus there is no offset
+    EXPECT_TRUE(face_offset.empty());
+    ASSERT_EQ(flat_v.size(), 3 * vertices.size());
+    ASSERT_EQ(flat_f.size(), 3 * faces.size());
+
+    for (size_t v = 0; v < vertices.size(); ++v) {
+        for (size_t i = 0; i < 3; ++i) {
+            EXPECT_EQ(flat_v[3 * v + i], vertices[v][i]);
+        }
+    }
+    for (size_t f = 0; f < faces.size(); ++f) {
+        for (size_t i = 0; i < 3; ++i) {
+            EXPECT_EQ(flat_f[3 * f + i], faces[f][i]);
+        }
+    }
+
+    // write the same mesh as binary ply and read it back
+    const std::string ply_file =
+        (std::filesystem::temp_directory_path() / "rxmesh_import_mesh.ply")
+            .string();
+    {
+        std::ofstream file(ply_file, std::ios::binary);
+        file << "ply\nformat binary_little_endian 1.0\nelement vertex "
+             << vertices.size()
+             << "\nproperty float x\nproperty float y\nproperty float z\n"
+             << "element face " << faces.size()
+             << "\nproperty list uchar int vertex_indices\nend_header\n";
+        for (const auto& v : vertices) {
+            file.write(reinterpret_cast<const char*>(v.data()),
+                       3 * sizeof(float));
+        }
+        for (const auto& f : faces) {
+            const uint8_t n = 3;
+            file.write(reinterpret_cast<const char*>(&n), 1);
+            file.write(reinterpret_cast<const char*>(f.data()),
+                       3 * sizeof(uint32_t));
+        }
+    }
+
+    std::vector<float>    ply_v;
+    std::vector<uint32_t> ply_f, ply_offset;
+    ASSERT_TRUE(import_mesh(ply_file, ply_v, ply_f, ply_offset));
+
+    EXPECT_TRUE(ply_offset.empty());
+    EXPECT_EQ(ply_v, flat_v);
+    EXPECT_EQ(ply_f, flat_f);
+
+    std::filesystem::remove(ply_file);
+}
+
+TEST(RXMeshStatic, FlatConstructor)
+{
+    using namespace rxmesh;
+
+    CUDA_ERROR(cudaDeviceReset());
+
+    std::vector<std::vector<float>>    vertices;
+    std::vector<std::vector<uint32_t>> faces;
+
+    ASSERT_TRUE(
+        import_obj(STRINGIFY(INPUT_DIR) "sphere3.obj", vertices, faces));
+
+    std::vector<float>    flat_v;
+    std::vector<uint32_t> flat_f, face_offset;
+
+    ASSERT_TRUE(import_mesh(
+        STRINGIFY(INPUT_DIR) "sphere3.obj", flat_v, flat_f, face_offset));
+
+    RXMeshStatic rx_nested(faces);
+    rx_nested.add_vertex_coordinates(vertices);
+
+    RXMeshStatic rx_flat(flat_f.data(), uint32_t(flat_f.size() / 3));
+    rx_flat.add_vertex_coordinates(flat_v.data(), uint32_t(flat_v.size() / 3));
+
+    EXPECT_EQ(rx_nested.get_num_vertices(), rx_flat.get_num_vertices());
+    EXPECT_EQ(rx_nested.get_num_edges(), rx_flat.get_num_edges());
+    EXPECT_EQ(rx_nested.get_num_faces(), rx_flat.get_num_faces());
+    EXPECT_EQ(rx_nested.get_num_patches(), rx_flat.get_num_patches());
+    EXPECT_EQ(rx_nested.is_edge_manifold(), rx_flat.is_edge_manifold());
+    EXPECT_EQ(rx_nested.is_closed(), rx_flat.is_closed());
+    EXPECT_EQ(rx_nested.get_input_max_valence(),
+              rx_flat.get_input_max_valence());
+
+    auto coord = *rx_flat.get_input_vertex_coordinates();
+    rx_flat.for_each_vertex(HOST, [&](const VertexHandle& vh) {
+        const uint32_t v = rx_flat.map_to_global(vh);
+        for (uint32_t i = 0; i < 3; ++i) {
+            EXPECT_EQ(coord(vh, i), vertices[v][i]);
+        }
+    });
+
+    ASSERT_EQ(cudaDeviceSynchronize(), cudaSuccess);
+}
@@ -0,0 +1,53 @@
+#include "gtest/gtest.h"
+
+#include "rxmesh/rxmesh_static.h"
+
+TEST(RXMeshStatic, IncrementalPatching)
+{
+    using namespace rxmesh;
+
+    CUDA_ERROR(cudaDeviceReset());
+
+    const std::string file       = STRINGIFY(INPUT_DIR) "sphere3.obj";
+    const uint32_t    patch_size = 64;
+
+    RXMeshStatic rx(file, "", false, patch_size);
+
+    std::vector<uint32_t> face_patch = rx.get_face_patch();
+
+    // unchanged mesh: nothing is re-patched
+    {
+        RXMeshStatic rx_same(file, face_patch, patch_size);
+        EXPECT_EQ(rx_same.get_num_repatched_patches(), 0);
+        EXPECT_EQ(rx_same.get_num_patches(), rx.get_num_patches());
+        EXPECT_EQ(rx_same.get_face_patch(), face_patch);
+    }
+
+    // mark the faces of one patch as new faces. Only this patch's neighbors
+    // should be re-patched
+    for (auto& p : face_patch) {
+        if (p == 0) {
+            p = INVALID32;
+        }
+    }
+
+    RXMeshStatic rx_edit(file, face_patch, patch_size);
+
+    EXPECT_GT(rx_edit.get_num_repatched_patches(), 0);
+    EXPECT_LT(rx_edit.get_num_repatched_patches(), rx_edit.get_num_patches());
+    EXPECT_EQ(rx_edit.get_num_faces(), rx.get_num_faces());
+
+    uint32_t min_p(0), max_p(0), avg_p(0);
+    rx_edit.get_max_min_avg_patch_size(min_p, max_p, avg_p);
+    EXPECT_GT(min_p, 0);
+
+    // every face belongs to a valid patch that matches the patch that owns it
+    const auto& new_face_patch = rx_edit.get_face_patch();
+    for (uint32_t f = 0; f < rx_edit.get_num_faces(); ++f) {
+        EXPECT_LT(new_face_patch[f], rx_edit.get_num_patches());
+    }
+
+    rx_edit.for_each_face(HOST, [&](const FaceHandle& fh) {
+        EXPECT_EQ(fh.patch_id(), new_face_patch[rx_edit.map_to_global(fh)]);
+    });
+}
@@ -1,5 +1,6 @@
 #include "gtest/gtest.h"
 #include "rxmesh/iterator.cuh"
+#include "rxmesh/rxmesh_static.h"
 #include "rxmesh/util/util.h"
 
 template <typename HandleT>
@@ -100,4 +101,58 @@ TEST(RXMesh, Iterator)
     CUDA_ERROR(cudaFree(d_suceess));
     CUDA_ERROR(cudaDeviceSynchronize());
     CUDA_ERROR(cudaDeviceReset());
-}
\ No newline at end of file
+}
+
+TEST(RXMeshStatic, IteratorGather)
+{
+    using namespace rxmesh;
+
+    RXMeshStatic rx(STRINGIFY(INPUT_DIR) "sphere3.obj");
+
+    auto coords = *rx.get_input_vertex_coordinates();
+
+    auto match = rx.add_vertex_attribute<int>("match", 1);
+    match->reset(0, LOCATION_ALL);
+
+    // the sum of the one-ring positions gathered in chunks of 4 (i.e., most
+    // vertices need more than one chunk) should match the one computed one
+    // neighbor at a time
+    rx.run_query_kernel<Op::VV, 256>(
+        [coords, m = *match] __device__(const VertexHandle&   vh,
+                                        const VertexIterator& iter) mutable {
+            vec3<float> expected(0.f, 0.f, 0.f);
+            for (uint16_t i = 0; i < iter.size(); ++i) {
+                expected += coords.to_glm<3>(iter[i]);
+            }
+
+            constexpr int N = 4;
+
+            vec3<float>  sum(0.f, 0.f, 0.f);
+            VertexHandle h[N];
+            bool         ok = true;
+            for (uint16_t begin = 0; begin < iter.size(); begin += N) {
+                vec3<float>    p[N];
+                const uint16_t num = iter.gather(coords, p, begin);
+                ok = ok && num == min(N, iter.size() - begin);
+                ok = ok && iter.resolve(h, begin) == num;
+                for (int i = 0; i < N; ++i) {
+                    sum += p[i];
+                    if (i < num) {
+                        ok = ok && h[i] == iter[begin + i];
+                    } else {
+                        ok = ok && !h[i].is_valid();
+                    }
+                }
+            }
+            ok = ok && glm::length(sum - expected) < 1e-5f;
+
+            m(vh) = ok ? 1 : 0;
+        });
+
+    EXPECT_EQ(cudaDeviceSynchronize(), cudaSuccess);
+
+    match->move(DEVICE, HOST);
+
+    rx.for_each_vertex(
+        HOST, [&](const VertexHandle vh) { EXPECT_EQ((*match)(vh), 1); });
+}
@@ -0,0 +1,96 @@
+#include <set>
+
+#include "gtest/gtest.h"
+
+#include "rxmesh/k_ring.h"
+#include "rxmesh/rxmesh_static.h"
+
+TEST(RXMeshStatic, KRing)
+{
+    using namespace rxmesh;
+
+    // small patches so that the rings cross the patch boundaries
+    RXMeshStatic rx(STRINGIFY(INPUT_DIR) "sphere3.obj", "", false, 64);
+
+    const uint32_t num_v = rx.get_num_vertices();
+
+    // 1-ring should match VV
+    KRing ring1(rx, 1);
+    EXPECT_EQ(ring1.get_num_rings(), 1);
+
+    auto valence = rx.add_vertex_attribute<uint32_t>("valence", 1);
+    auto match   = rx.add_vertex_attribute<uint32_t>("match", 1);
+
+    rx.run_query_kernel<Op::VV, 256>(
+        [v = *valence, m = *match, ring1] __device__(
+            const VertexHandle& vh, const VertexIterator& iter) mutable {
+            v(vh) = iter.size();
+            m(vh) = (ring1.size(vh) == iter.size() &&
+                     ring1.size(vh, 1) == iter.size());
+            for (uint16_t i = 0; i < iter.size(); ++i) {
+                if (ring1(vh, i) != iter[i]) {
+                    m(vh) = 0;
+                }
+            }
+        });
+    CUDA_ERROR(cudaDeviceSynchronize());
+
+    match->move(DEVICE, HOST);
+    rx.for_each_vertex(
+        HOST, [&](const VertexHandle vh) { EXPECT_EQ((*match)(vh), 1); });
+
+    std::vector<uint32_t>     r1_offset;
+    std::vector<VertexHandle> r1_value;
+    ring1.to_host(r1_offset, r1_value);
+    ASSERT_EQ(r1_offset.size(), num_v + 1);
+
+    auto neighbours = [&](const uint32_t v) {
+        std::set<uint32_t> ret;
+        for (uint32_t i = r1_offset[v]; i < r1_offset[v + 1]; ++i) {
+            ret.insert(rx.linear_id(r1_value[i]));
+        }
+        return ret;
+    };
+
+    // 3-ring should match a BFS on the 1-ring
+    const uint32_t k = 3;
+    KRing          ring3(rx, k);
+    EXPECT_EQ(ring3.get_num_rings(), k);
+
+    std::vector<uint32_t>     offset;
+    std::vector<VertexHandle> value;
+    ring3.to_host(offset, value);
+    ASSERT_EQ(offset.size(), num_v * k + 1);
+    EXPECT_EQ(offset.back(), ring3.get_size());
+
+    for (uint32_t v = 0; v < num_v; ++v) {
+        std::set<uint32_t> visited  = {v};
+        std::set<uint32_t> frontier = {v};
+        for (uint32_t r = 1; r <= k; ++r) {
+            std::set<uint32_t> next;
+            for (uint32_t u : frontier) {
+                for (uint32_t w : neighbours(u)) {
+                    if (visited.find(w) == visited.end()) {
+                        next.insert(w);
+                    }
+                }
+            }
+            visited.insert(next.begin(), next.end());
+
+            std::set<uint32_t> ring;
+            for (uint32_t i = offset[v * k + r - 1]; i < offset[v * k + r];
+                 ++i) {
+                ring.insert(rx.linear_id(value[i]));
+            }
+            EXPECT_EQ(ring.size(), offset[v * k + r] - offset[v * k + r - 1]);
+            EXPECT_EQ(ring, next);
+
+            frontier = next;
+        }
+    }
+
+    ring1.release();
+    ring3.release();
+
+    ASSERT_EQ(cudaDeviceSynchronize(), cudaSuccess);
+}
@@ -2,8 +2,83 @@
 
 #include "rxmesh/lp_hashtable.cuh"
 #include "rxmesh/lp_pair.cuh"
+#include "rxmesh/util/timer.h"
 #include "rxmesh/util/util.h"
 
+namespace {
+
+// per-thread insert where block b inserts num_keys pairs in tables[b]
+__global__ static void lp_insert(rxmesh::LPHashTable*  tables,
+                                 const rxmesh::LPPair* pairs,
+                                 const uint32_t        num_keys,
+                                 int*                  num_failed)
+{
+    rxmesh::LPHashTable& table = tables[blockIdx.x];
+    for (uint32_t i = threadIdx.x; i < num_keys; i += blockDim.x) {
+        if (!table.insert(pairs[i], nullptr, nullptr)) {
+            ::atomicAdd(num_failed, 1);
+        }
+    }
+}
+
+// per-thread find where block b looks for num_keys keys in tables[b]
+__global__ static void lp_find(const rxmesh::LPHashTable* tables,
+                               const uint16_t*            keys,
+                               const uint32_t             num_keys,
+                               uint32_t*                  out)
+{
+    const rxmesh::LPHashTable& table = tables[blockIdx.x];
+    for (uint32_t i = threadIdx.x; i < num_keys; i += blockDim.x) {
+        out[blockIdx.x * num_keys + i] =
+            table.find(keys[i], nullptr, nullptr).m_pair;
+    }
+}
+
+// tile-cooperative find where every tile looks for one key at a time
+template <uint32_t tileSize>
+__global__ static void lp_tile_find(const rxmesh::LPHashTable* tables,
+                                    const uint16_t*            keys,
+                                    const uint32_t             num_keys,
+                                    uint32_t*                  out)
+{
+    namespace cg = cooperative_groups;
+
+    const rxmesh::LPHashTable& table = tables[blockIdx.x];
+
+    auto tile = cg::tiled_partition<tileSize>(cg::this_thread_block());
+
+    const uint32_t num_tiles = blockDim.x / tileSize;
+
+    for (uint32_t i = threadIdx.x / tileSize; i < num_keys; i += num_tiles) {
+        const rxmesh::LPPair p = table.find(tile, keys[i]);
+        if (tile.thread_rank() == 0) {
+            out[blockIdx.x * num_keys + i] = p.m_pair;
+        }
+    }
+}
+
+// num_keys pairs with unique keys
+void make_unique_pairs(const uint32_t               num_keys,
+                       std::vector<uint16_t>&       keys,
+                       std::vector<rxmesh::LPPair>& pairs)
+{
+    using namespace rxmesh;
+
+    std::vector<uint16_t> all(1 << LPPair::LIDNumBits);
+    fill_with_sequential_numbers(all.data(), all.size());
+    random_shuffle(all.data(), all.size());
+
+    keys.resize(num_keys);
+    pairs.resize(num_keys);
+    for (uint32_t i = 0; i < num_keys; ++i) {
+        keys[i]  = all[i];
+        pairs[i] = LPPair(keys[i],
+                          i % (1 << LPPair::LIDOwnerNumBits),
+                          i % (1 << LPPair::PatchStashNumBits));
+    }
+}
+}  // namespace
+
 TEST(RXMesh, LPPair)
 {
     using namespace rxmesh;
@@ -145,4 +220,224 @@ TEST(RXMesh, DISABLED_BenchmarkLPHashTable)
         RXMESH_INFO(
             "size= {}, cap= {}, num_failed = {}", size, cap, num_failed);
     }
-}
\ No newline at end of file
+}
+TEST(RXMesh, LPHashTableBucketed)
+{
+    using namespace rxmesh;
+
+    const uint32_t size        = 256;
+    const float    load_factor = 0.9;
+
+    std::vector<uint16_t> keys;
+    std::vector<LPPair>   pairs;
+    make_unique_pairs(size, keys, pairs);
+
+    for (uint8_t bucket_size = 2; bucket_size <= LPHashTable::max_bucket_size;
+         bucket_size *= 2) {
+        LPHashTable table(
+            static_cast<uint16_t>(static_cast<float>(size) / load_factor),
+            false,
+            bucket_size);
+
+        EXPECT_TRUE(table.is_bucketed());
+        EXPECT_EQ(table.get_bucket_size(), bucket_size);
+        EXPECT_EQ(table.get_capacity() % bucket_size, 0);
+        EXPECT_GE(table.get_capacity(), size);
+
+        for (auto& p : pairs) {
+            EXPECT_TRUE(table.insert(p, nullptr, nullptr));
+        }
+
+        // re-inserting a key updates its pair
+        EXPECT_TRUE(table.insert(pairs[0], nullptr, nullptr));
+
+        for (uint32_t i = 0; i < size; ++i) {
+            auto p = table.find(keys[i], nullptr, nullptr);
+            EXPECT_EQ(p.m_pair, pairs[i].m_pair);
+        }
+
+        for (uint32_t i = 0; i < size; ++i) {
+            table.remove(keys[i], nullptr, nullptr);
+            auto p = table.find(keys[i], nullptr, nullptr);
+            EXPECT_TRUE(p.is_sentinel());
+        }
+
+        table.free();
+    }
+}
+
+TEST(RXMesh, LPHashTableTileFind)
+{
+    using namespace rxmesh;
+
+    const uint32_t size        = 256;
+    const float    load_factor = 0.8;
+
+    std::vector<uint16_t> keys;
+    std::vector<LPPair>   pairs;
+    make_unique_pairs(size, keys, pairs);
+
+    uint16_t* d_keys = nullptr;
+    uint32_t* d_out  = nullptr;
+    CUDA_ERROR(cudaMalloc((void**)&d_keys, size * sizeof(uint16_t)));
+    CUDA_ERROR(cudaMalloc((void**)&d_out, size * sizeof(uint32_t)));
+    CUDA_ERROR(cudaMemcpy(
+        d_keys, keys.data(), size * sizeof(uint16_t), cudaMemcpyHostToDevice));
+
+    LPHashTable* d_table = nullptr;
+    CUDA_ERROR(cudaMalloc((void**)&d_table, sizeof(LPHashTable)));
+
+    std::vector<uint32_t> out(size);
+
+    for (uint8_t bucket_size : {1, 8, 32}) {
+        const uint16_t cap =
+            static_cast<uint16_t>(static_cast<float>(size) / load_factor);
+
+        LPHashTable h_table(cap, false, bucket_size);
+        for (auto& p : pairs) {
+            EXPECT_TRUE(h_table.insert(p, nullptr, nullptr));
+        }
+
+        LPHashTable table(cap, true, bucket_size);
+        ASSERT_EQ(table.get_capacity(), h_table.get_capacity());
+        table.move(h_table);
+        CUDA_ERROR(cudaMemcpy(
+            d_table, &table, sizeof(LPHashTable), cudaMemcpyHostToDevice));
+
+        auto check = [&]() {
+            CUDA_ERROR(cudaDeviceSynchronize());
+            CUDA_ERROR(cudaMemcpy(out.data(),
+                                  d_out,
+                                  size * sizeof(uint32_t),
+                                  cudaMemcpyDeviceToHost));
+            for (uint32_t i = 0; i < size; ++i) {
+                EXPECT_EQ(out[i], pairs[i].m_pair);
+            }
+        };
+
+        lp_tile_find<32><<<1, 256>>>(d_table, d_keys, size, d_out);
+        check();
+
+        lp_tile_find<8><<<1, 256>>>(d_table, d_keys, size, d_out);
+        check();
+
+        h_table.free();
+        table.free();
+    }
+
+    GPU_FREE(d_table);
+    GPU_FREE(d_keys);
+    GPU_FREE(d_out);
+}
+
+TEST(RXMesh, DISABLED_BenchmarkLPHashTableBucketed)
+{
+    using namespace rxmesh;
+
+    // every block operates on its own table similar to patches
+    const uint32_t num_tables     = 1024;
+    const uint32_t size           = 512;
+    const uint32_t block_size     = 256;
+    const int      num_run        = 10;
+    const float    load_factors[] = {0.5, 0.7, 0.8, 0.9, 0.95};
+
+    std::vector<uint16_t> keys;
+    std::vector<LPPair>   pairs;
+    make_unique_pairs(size, keys, pairs);
+
+    uint16_t* d_keys       = nullptr;
+    LPPair*   d_pairs      = nullptr;
+    uint32_t* d_out        = nullptr;
+    int*      d_num_failed = nullptr;
+    CUDA_ERROR(cudaMalloc((void**)&d_keys, size * sizeof(uint16_t)));
+    CUDA_ERROR(cudaMalloc((void**)&d_pairs, size * sizeof(LPPair)));
+    CUDA_ERROR(
+        cudaMalloc((void**)&d_out, num_tables * size * sizeof(uint32_t)));
+    CUDA_ERROR(cudaMalloc((void**)&d_num_failed, sizeof(int)));
+    CUDA_ERROR(cudaMemcpy(
+        d_keys, keys.data(), size * sizeof(uint16_t), cudaMemcpyHostToDevice));
+    CUDA_ERROR(cudaMemcpy(
+        d_pairs, pairs.data(), size * sizeof(LPPair), cudaMemcpyHostToDevice));
+
+    LPHashTable* d_tables = nullptr;
+    CUDA_ERROR(
+        cudaMalloc((void**)&d_tables, num_tables * sizeof(LPHashTable)));
+
+    const double num_ops = double(num_tables) * double(size) * num_run;
+
+    for (float load_factor : load_factors) {
+        for (uint8_t bucket_size : {1, 4, 8, 16, 32}) {
+
+            std::vector<LPHashTable> tables(num_tables);
+            for (auto& t : tables) {
+                t = LPHashTable(
+                    static_cast<uint16_t>(static_cast<float>(size) /
+                                          load_factor),
+                    true,
+                    bucket_size);
+            }
+            CUDA_ERROR(cudaMemcpy(d_tables,
+                                  tables.data(),
+                                  num_tables * sizeof(LPHashTable),
+                                  cudaMemcpyHostToDevice));
+
+            int num_failed = 0;
+
+            GPUTimer insert_timer;
+            insert_timer.start();
+            for (int r = 0; r < num_run; ++r) {
+                for (auto& t : tables) {
+                    t.clear();
+                }
+                CUDA_ERROR(cudaMemset(d_num_failed, 0, sizeof(int)));
+                lp_insert<<<num_tables, block_size>>>(
+                    d_tables, d_pairs, size, d_num_failed);
+            }
+            insert_timer.stop();
+            CUDA_ERROR(cudaMemcpy(&num_failed,
+                                  d_num_failed,
+                                  sizeof(int),
+                                  cudaMemcpyDeviceToHost));
+
+            GPUTimer find_timer;
+            find_timer.start();
+            for (int r = 0; r < num_run; ++r) {
+                lp_find<<<num_tables, block_size>>>(
+                    d_tables, d_keys, size, d_out);
+            }
+            find_timer.stop();
+
+            GPUTimer tile_timer;
+            tile_timer.start();
+            for (int r = 0; r < num_run; ++r) {
+                lp_tile_find<32><<<num_tables, block_size>>>(
+                    d_tables, d_keys, size, d_out);
+            }
+            tile_timer.stop();
+            CUDA_ERROR(cudaDeviceSynchronize());
+
+            // the insert time includes clearing the tables
+            RXMESH_INFO(
+                "load_factor= {}, bucket_size= {}, cap= {}, num_failed= {}, "
+                "insert= {:.2f} Mkeys/s, find= {:.2f} Mkeys/s, "
+                "tile find= {:.2f} Mkeys/s",
+                load_factor,
+                bucket_size,
+                tables[0].get_capacity(),
+                num_failed,
+                num_ops / (insert_timer.elapsed_millis() * 1000.0),
+                num_ops / (find_timer.elapsed_millis() * 1000.0),
+                num_ops / (tile_timer.elapsed_millis() * 1000.0));
+
+            for (auto& t : tables) {
+                t.free();
+            }
+        }
+    }
+
+    GPU_FREE(d_tables);
+    GPU_FREE(d_keys);
+    GPU_FREE(d_pairs);
+    GPU_FREE(d_out);
+    GPU_FREE(d_num_failed);
+}
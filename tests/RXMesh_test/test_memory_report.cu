@@ -0,0 +1,241 @@
+#include "gtest/gtest.h"
+
+#include "rxmesh/matrix/dense_matrix.h"
+#include "rxmesh/rxmesh_static.h"
+
+TEST(RXMeshStatic, MemoryReport)
+{
+    using namespace rxmesh;
+
+    RXMeshStatic rx(STRINGIFY(INPUT_DIR) "sphere3.obj");
+
+    const TopologyMemoryReport topo = rx.get_topology_memory_report();
+
+    EXPECT_EQ(topo.num_patches, rx.get_num_patches());
+    EXPECT_GT(topo.ev_bytes, 0);
+    EXPECT_GT(topo.fe_bytes, 0);
+    EXPECT_EQ(topo.active_mask_bytes, topo.owned_mask_bytes);
+    EXPECT_GE(topo.ev_bytes,
+              size_t(2) * rx.get_num_edges() * sizeof(LocalVertexT));
+    EXPECT_GE(topo.fe_bytes,
+              size_t(3) * rx.get_num_faces() * sizeof(LocalEdgeT));
+
+    EXPECT_EQ(topo.num_owned_vertices, rx.get_num_vertices());
+    EXPECT_EQ(topo.num_owned_edges, rx.get_num_edges());
+    EXPECT_EQ(topo.num_owned_faces, rx.get_num_faces());
+
+    topo.print();
+
+    auto user_lambda = [] __device__(const VertexHandle& vh,
+                                     const VertexIterator& iter) {};
+
+    constexpr uint32_t blockThreads = 256;
+
+    using LambdaT = decltype(user_lambda);
+
+    const void* kernel =
+        (void*)detail::query_kernel<blockThreads, Op::VV, LambdaT>;
+
+    LaunchBox<blockThreads> lb;
+    rx.prepare_launch_box({Op::VV}, lb, kernel);
+
+    const LaunchReport launch = rx.get_launch_report(lb, kernel);
+
+    EXPECT_EQ(launch.blocks, rx.get_num_patches());
+    EXPECT_EQ(launch.smem_bytes_dyn, lb.smem_bytes_dyn);
+    EXPECT_EQ(launch.num_registers_per_thread, lb.num_registers_per_thread);
+    EXPECT_GT(launch.blocks_per_sm, 0);
+    EXPECT_GT(launch.occupancy, 0);
+    EXPECT_LE(launch.occupancy, 1);
+
+    launch.print();
+
+    LaunchReport best;
+    const uint32_t block_size =
+        rx.suggest_query_block_size<Op::VV>(user_lambda, false, &best);
+
+    EXPECT_EQ(block_size, best.block_threads);
+    EXPECT_GE(best.occupancy, launch.occupancy);
+
+    ASSERT_EQ(cudaDeviceSynchronize(), cudaSuccess);
+}
+
+TEST(RXMeshStatic, LaunchCache)
+{
+    using namespace rxmesh;
+
+    RXMeshStatic rx(STRINGIFY(INPUT_DIR) "sphere3.obj");
+
+    auto user_lambda = [] __device__(const FaceHandle&     fh,
+                                     const VertexIterator& iter) {};
+
+    constexpr uint32_t blockThreads = 256;
+
+    using LambdaT = decltype(user_lambda);
+
+    const void* kernel =
+        (void*)detail::query_kernel<blockThreads, Op::FV, LambdaT>;
+
+    LaunchBox<blockThreads> lb0, lb1;
+    rx.prepare_launch_box({Op::FV}, lb0, kernel);
+    rx.prepare_launch_box({Op::FV}, lb1, kernel);
+
+    EXPECT_EQ(lb0.blocks, lb1.blocks);
+    EXPECT_EQ(lb0.smem_bytes_dyn, lb1.smem_bytes_dyn);
+    EXPECT_EQ(lb0.smem_bytes_static, lb1.smem_bytes_static);
+    EXPECT_EQ(lb0.num_registers_per_thread, lb1.num_registers_per_thread);
+    EXPECT_EQ(lb0.local_mem_per_thread, lb1.local_mem_per_thread);
+
+    // different flags should not hit the same cache entry
+    LaunchBox<blockThreads> lb2;
+    rx.prepare_launch_box({Op::FV}, lb2, kernel, false, true);
+    EXPECT_GT(lb2.smem_bytes_dyn, lb0.smem_bytes_dyn);
+
+    cudaStream_t stream;
+    CUDA_ERROR(cudaStreamCreate(&stream));
+    rx.run_query_kernel<Op::FV>(lb1, user_lambda, false, stream);
+    CUDA_ERROR(cudaStreamSynchronize(stream));
+    CUDA_ERROR(cudaStreamDestroy(stream));
+
+    rx.clear_launch_cache();
+
+    ASSERT_EQ(cudaDeviceSynchronize(), cudaSuccess);
+}
+
+TEST(RXMeshStatic, MemoryPool)
+{
+    using namespace rxmesh;
+
+    RXMeshStatic rx(STRINGIFY(INPUT_DIR) "sphere3.obj");
+
+    MemoryPool& pool = rx.get_memory_pool();
+
+    auto coords = rx.get_input_vertex_coordinates();
+
+    const MemoryPoolStats before = pool.get_stats();
+
+    for (int i = 0; i < 10; ++i) {
+        auto tmp = rx.add_vertex_attribute_like("tmp", *coords);
+
+        rx.for_each_vertex(
+            DEVICE, [tmp = *tmp] __device__(const VertexHandle vh) mutable {
+                tmp(vh, 0) = float(vh.local_id());
+            });
+
+        tmp->move(DEVICE, HOST);
+
+        uint32_t num_mismatch = 0;
+        rx.for_each_vertex(HOST, [&](const VertexHandle vh) {
+            if ((*tmp)(vh, 0) != float(vh.local_id())) {
+                num_mismatch++;
+            }
+        });
+        EXPECT_EQ(num_mismatch, 0);
+
+        rx.remove_attribute("tmp");
+
+        DenseMatrix<float> mat(rx, rx.get_num_vertices(), 3, DEVICE);
+        mat.release();
+    }
+
+    ASSERT_EQ(cudaDeviceSynchronize(), cudaSuccess);
+
+    const MemoryPoolStats after = pool.get_stats();
+
+    after.print();
+
+    if (pool.is_enabled()) {
+        EXPECT_GT(after.num_allocations, before.num_allocations);
+        // everything after the first iteration should be served by the memory
+        // already reserved by the pool
+        EXPECT_GT(after.num_reused, before.num_reused);
+        EXPECT_EQ(after.used_bytes, before.used_bytes);
+        EXPECT_GE(after.used_high_bytes, after.used_bytes);
+        EXPECT_GE(after.reserved_high_bytes, after.reserved_bytes);
+
+        pool.trim();
+    }
+}
+
+TEST(RXMeshStatic, DeviceMemory)
+{
+    using namespace rxmesh;
+
+    DeviceMemory& mem = DeviceMemory::get();
+
+    RXMeshStatic rx(STRINGIFY(INPUT_DIR) "sphere3.obj");
+
+    const DeviceMemoryStats init = mem.get_stats();
+    init.print();
+
+    EXPECT_GT(init.get_used_bytes(MemoryCategory::Topology), size_t(0));
+
+    // attributes and matrices are accounted under their category and
+    // released when they are freed
+    {
+        auto attr = rx.add_vertex_attribute<float>("attr", 3, DEVICE);
+        DenseMatrix<float> mat(rx, rx.get_num_vertices(), 3, DEVICE);
+
+        const DeviceMemoryStats stats = mem.get_stats();
+
+        EXPECT_GE(stats.get_used_bytes(MemoryCategory::Attribute),
+                  init.get_used_bytes(MemoryCategory::Attribute) +
+                      rx.get_num_vertices() * 3 * sizeof(float));
+        EXPECT_GE(stats.get_used_bytes(MemoryCategory::Matrix),
+                  init.get_used_bytes(MemoryCategory::Matrix) +
+                      rx.get_num_vertices() * 3 * sizeof(float));
+
+        mat.release();
+        rx.remove_attribute("attr");
+    }
+    ASSERT_EQ(cudaDeviceSynchronize(), cudaSuccess);
+
+    DeviceMemoryStats stats = mem.get_stats();
+    EXPECT_EQ(stats.get_used_bytes(MemoryCategory::Attribute),
+              init.get_used_bytes(MemoryCategory::Attribute));
+    EXPECT_EQ(stats.get_used_bytes(MemoryCategory::Matrix),
+              init.get_used_bytes(MemoryCategory::Matrix));
+
+    // allocations that exceed the budget are rejected
+    const size_t mb = 1024 * 1024;
+    mem.set_budget(stats.total_bytes() + mb);
+    EXPECT_EQ(mem.get_available_bytes(), mb);
+
+    void* ptr = nullptr;
+    EXPECT_EQ(tracked_malloc(&ptr, 2 * mb, MemoryCategory::Solver),
+              cudaErrorMemoryAllocation);
+    EXPECT_EQ(ptr, nullptr);
+    EXPECT_EQ(mem.get_stats().num_rejected, stats.num_rejected + 1);
+
+    EXPECT_EQ(tracked_malloc(&ptr, mb / 2, MemoryCategory::Solver),
+              cudaSuccess);
+    EXPECT_EQ(mem.get_stats().get_used_bytes(MemoryCategory::Solver),
+              stats.get_used_bytes(MemoryCategory::Solver) + mb / 2);
+    GPU_FREE(ptr);
+    EXPECT_EQ(mem.get_stats().get_used_bytes(MemoryCategory::Solver),
+              stats.get_used_bytes(MemoryCategory::Solver));
+
+    mem.set_budget(0);
+
+    // custom allocator
+    int             num_alloc = 0, num_free = 0;
+    DeviceAllocator allocator;
+    allocator.allocate = [&](void** p, size_t n, MemoryCategory) {
+        num_alloc++;
+        return cudaMalloc(p, n);
+    };
+    allocator.deallocate = [&](void* p) {
+        num_free++;
+        return cudaFree(p);
+    };
+    mem.set_allocator(allocator);
+
+    EXPECT_EQ(tracked_malloc(&ptr, mb, MemoryCategory::Other), cudaSuccess);
+    mem.reset_allocator();
+    GPU_FREE(ptr);
+
+    EXPECT_EQ(num_alloc, 1);
+    EXPECT_EQ(num_free, 1);
+    EXPECT_EQ(mem.get_stats().get_used_bytes(MemoryCategory::Other),
+              stats.get_used_bytes(MemoryCategory::Other));
+}
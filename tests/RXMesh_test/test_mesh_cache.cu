@@ -0,0 +1,56 @@
+#include "gtest/gtest.h"
+
+#include "rxmesh/rxmesh_static.h"
+
+TEST(RXMeshStatic, MeshCache)
+{
+    using namespace rxmesh;
+
+    CUDA_ERROR(cudaDeviceReset());
+
+    const std::string cache_dir =
+        (std::filesystem::temp_directory_path() / "rxmesh_cache_test")
+            .string();
+
+    std::filesystem::remove_all(cache_dir);
+
+    // first construction builds the mesh and writes the cache
+    RXMeshStatic rx_build(STRINGIFY(INPUT_DIR) "sphere3.obj",
+                          "",
+                          false,
+                          512,
+                          1.0,
+                          1.0,
+                          0.8,
+                          cache_dir);
+
+    EXPECT_FALSE(std::filesystem::is_empty(cache_dir));
+
+    // second construction reads the cache
+    RXMeshStatic rx_cache(STRINGIFY(INPUT_DIR) "sphere3.obj",
+                          "",
+                          false,
+                          512,
+                          1.0,
+                          1.0,
+                          0.8,
+                          cache_dir);
+
+    EXPECT_EQ(rx_build.get_num_vertices(), rx_cache.get_num_vertices());
+    EXPECT_EQ(rx_build.get_num_edges(), rx_cache.get_num_edges());
+    EXPECT_EQ(rx_build.get_num_faces(), rx_cache.get_num_faces());
+    EXPECT_EQ(rx_build.get_num_patches(), rx_cache.get_num_patches());
+
+    auto coord_build = *rx_build.get_input_vertex_coordinates();
+    auto coord_cache = *rx_cache.get_input_vertex_coordinates();
+
+    rx_cache.for_each_vertex(HOST, [&](const VertexHandle& vh) {
+        for (uint32_t i = 0; i < 3; ++i) {
+            EXPECT_EQ(coord_build(vh, i), coord_cache(vh, i));
+        }
+    });
+
+    std::filesystem::remove_all(cache_dir);
+
+    ASSERT_EQ(cudaDeviceSynchronize(), cudaSuccess);
+}
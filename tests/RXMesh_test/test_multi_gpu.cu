@@ -0,0 +1,120 @@
+#include "gtest/gtest.h"
+
+#include "rxmesh/rxmesh_distributed.h"
+#include "rxmesh/rxmesh_multi_gpu.h"
+
+TEST(RXMeshMultiGPU, HaloExchange)
+{
+    using namespace rxmesh;
+
+    CUDA_ERROR(cudaDeviceReset());
+
+    // two partitions on the same device exercise the same code path as two
+    // devices
+    RXMeshMultiGPU mgpu(STRINGIFY(INPUT_DIR) "sphere3.obj", {0, 0}, 64);
+
+    ASSERT_EQ(mgpu.get_num_devices(), 2);
+
+    EXPECT_EQ(mgpu.get_partition_begin(0), 0);
+    EXPECT_EQ(mgpu.get_partition_end(0), mgpu.get_partition_begin(1));
+    EXPECT_EQ(mgpu.get_partition_end(1), mgpu.get_num_patches());
+    EXPECT_FALSE(mgpu.get_halo_patches(0).empty());
+
+    auto attr = mgpu.add_vertex_attribute<uint32_t>("v", 1);
+    attr->reset(0, LOCATION_ALL);
+
+    // every device writes its index (+1) to the vertices of its partition
+    for (int d = 0; d < mgpu.get_num_devices(); ++d) {
+        mgpu.set_device(d);
+        auto           a   = attr->get(d);
+        const uint32_t val = d + 1;
+        mgpu.get_mesh(d).for_each_vertex(
+            DEVICE,
+            [a, val] __device__(const VertexHandle vh) mutable { a(vh) = val; },
+            mgpu.get_stream(d));
+    }
+
+    attr->exchange_halo();
+
+    mgpu.synchronize();
+
+    // the partition and halo patches of every device have the value written
+    // by their owner device
+    for (int d = 0; d < mgpu.get_num_devices(); ++d) {
+        mgpu.set_device(d);
+        attr->get(d).move(DEVICE, HOST);
+
+        const auto& halo = mgpu.get_halo_patches(d);
+
+        mgpu.get_mesh(d).for_each_vertex(
+            HOST,
+            [&](const VertexHandle vh) {
+                const uint32_t p = vh.patch_id();
+                if (mgpu.get_patch_device(p) == d ||
+                    std::binary_search(halo.begin(), halo.end(), p)) {
+                    EXPECT_EQ(attr->get(d)(vh), mgpu.get_patch_device(p) + 1);
+                }
+            },
+            NULL,
+            false);
+    }
+
+    // gather all partitions on the host
+    attr->move_to_host();
+
+    mgpu.get_mesh(0).for_each_vertex(
+        HOST,
+        [&](const VertexHandle vh) {
+            EXPECT_EQ(attr->get(0)(vh),
+                      mgpu.get_patch_device(vh.patch_id()) + 1);
+        },
+        NULL,
+        false);
+
+    mgpu.set_device(0);
+    ASSERT_EQ(cudaDeviceSynchronize(), cudaSuccess);
+}
+
+#ifdef USE_MPI
+TEST(RXMeshDistributed, SingleRank)
+{
+    using namespace rxmesh;
+
+    int initialized = 0;
+    MPI_ERROR(MPI_Initialized(&initialized));
+    if (!initialized) {
+        MPI_ERROR(MPI_Init(nullptr, nullptr));
+        std::atexit([]() { MPI_Finalize(); });
+    }
+
+    // a single rank owns all patches and has no halo
+    RXMeshDistributed dist(
+        STRINGIFY(INPUT_DIR) "sphere3.obj", MPI_COMM_SELF, true, 64);
+
+    ASSERT_EQ(dist.get_num_ranks(), 1);
+    EXPECT_EQ(dist.get_owned_patches().size(), dist.get_num_patches());
+    EXPECT_TRUE(dist.get_halo_patches().empty());
+    EXPECT_TRUE(dist.get_send_patches(0).empty());
+    EXPECT_EQ(dist.get_mesh().get_patch_subset_size(), dist.get_num_patches());
+
+    auto attr = dist.add_vertex_attribute<float>("v", 1);
+    attr->reset(0, LOCATION_ALL);
+
+    auto a = attr->get();
+    dist.get_mesh().for_each_vertex(
+        DEVICE,
+        [a] __device__(const VertexHandle vh) mutable { a(vh) = 1; },
+        dist.get_stream());
+
+    attr->exchange_halo();
+
+    ReduceHandle rh(attr->get());
+    dist.prepare(rh);
+
+    EXPECT_NEAR(rh.norm2(attr->get(), INVALID32, dist.get_stream()),
+                std::sqrt(float(dist.get_mesh().get_num_vertices())),
+                1e-3);
+
+    ASSERT_EQ(cudaDeviceSynchronize(), cudaSuccess);
+}
+#endif
@@ -150,4 +150,130 @@ TEST(RXMeshStatic, MultiQueries)
     rx.for_each_vertex(HOST, [&](const VertexHandle vh) {
         ASSERT_NEAR((*vertex_sum_gt)(vh), (*vertex_sum)(vh), 0.0001);
     });
-}
\ No newline at end of file
+}
+
+template <uint32_t blockThreads, rxmesh::Op op>
+__global__ static void count_query(
+    const rxmesh::Context                                               context,
+    rxmesh::Attribute<uint32_t, typename rxmesh::InputHandle<op>::type> count)
+{
+    using namespace rxmesh;
+    using HandleT   = typename InputHandle<op>::type;
+    using IteratorT = typename IteratorType<op>::type;
+
+    auto           block = cooperative_groups::this_thread_block();
+    ShmemAllocator shrd_alloc;
+
+    Query<blockThreads> query(context);
+    query.dispatch<op>(block,
+                       shrd_alloc,
+                       [&](const HandleT& h, const IteratorT& iter) {
+                           count(h) = iter.size();
+                       });
+}
+
+
+template <uint32_t blockThreads>
+__global__ static void count_fused_queries(
+    const rxmesh::Context             context,
+    rxmesh::VertexAttribute<uint32_t> vv_count,
+    rxmesh::VertexAttribute<uint32_t> vf_count,
+    rxmesh::FaceAttribute<uint32_t>   ff_count)
+{
+    // VV, VF, and FF are all derived from a single shared memory copy of the
+    // patch topology
+    using namespace rxmesh;
+    auto           block = cooperative_groups::this_thread_block();
+    ShmemAllocator shrd_alloc;
+
+    Query<blockThreads> query(context);
+    query.begin_fused(block, shrd_alloc);
+
+    query.dispatch<Op::VV>(
+        block,
+        shrd_alloc,
+        [&](const VertexHandle& vh, const VertexIterator& iter) {
+            vv_count(vh) = iter.size();
+        });
+
+    query.dispatch<Op::VF>(
+        block,
+        shrd_alloc,
+        [&](const VertexHandle& vh, const FaceIterator& iter) {
+            vf_count(vh) = iter.size();
+        });
+
+    query.dispatch<Op::FF>(
+        block,
+        shrd_alloc,
+        [&](const FaceHandle& fh, const FaceIterator& iter) {
+            ff_count(fh) = iter.size();
+        });
+
+    query.end_fused(block, shrd_alloc);
+}
+
+TEST(RXMeshStatic, FusedQueries)
+{
+    // The output of VV, VF, and FF queries done in a single fused section
+    // should match the output of the same queries done separately
+
+    using namespace rxmesh;
+    constexpr uint32_t blockThreads = 256;
+
+    RXMeshStatic rx(STRINGIFY(INPUT_DIR) "sphere3.obj");
+
+    auto vv    = rx.add_vertex_attribute<uint32_t>("vv", 1);
+    auto vf    = rx.add_vertex_attribute<uint32_t>("vf", 1);
+    auto ff    = rx.add_face_attribute<uint32_t>("ff", 1);
+    auto vv_gt = rx.add_vertex_attribute<uint32_t>("vv_gt", 1);
+    auto vf_gt = rx.add_vertex_attribute<uint32_t>("vf_gt", 1);
+    auto ff_gt = rx.add_face_attribute<uint32_t>("ff_gt", 1);
+
+    LaunchBox<blockThreads> launch_box;
+
+    // ground truth
+    rx.prepare_launch_box(
+        {Op::VV}, launch_box, (void*)count_query<blockThreads, Op::VV>);
+    count_query<blockThreads, Op::VV>
+        <<<launch_box.blocks, blockThreads, launch_box.smem_bytes_dyn>>>(
+            rx.get_context(), *vv_gt);
+
+    rx.prepare_launch_box(
+        {Op::VF}, launch_box, (void*)count_query<blockThreads, Op::VF>);
+    count_query<blockThreads, Op::VF>
+        <<<launch_box.blocks, blockThreads, launch_box.smem_bytes_dyn>>>(
+            rx.get_context(), *vf_gt);
+
+    rx.prepare_launch_box(
+        {Op::FF}, launch_box, (void*)count_query<blockThreads, Op::FF>);
+    count_query<blockThreads, Op::FF>
+        <<<launch_box.blocks, blockThreads, launch_box.smem_bytes_dyn>>>(
+            rx.get_context(), *ff_gt);
+
+    // fused
+    rx.prepare_fused_launch_box({Op::VV, Op::VF, Op::FF},
+                                launch_box,
+                                (void*)count_fused_queries<blockThreads>);
+    count_fused_queries<blockThreads>
+        <<<launch_box.blocks, blockThreads, launch_box.smem_bytes_dyn>>>(
+            rx.get_context(), *vv, *vf, *ff);
+
+    CUDA_ERROR(cudaDeviceSynchronize());
+
+    vv->move(DEVICE, HOST);
+    vf->move(DEVICE, HOST);
+    ff->move(DEVICE, HOST);
+    vv_gt->move(DEVICE, HOST);
+    vf_gt->move(DEVICE, HOST);
+    ff_gt->move(DEVICE, HOST);
+
+    rx.for_each_vertex(HOST, [&](const VertexHandle vh) {
+        EXPECT_EQ((*vv)(vh), (*vv_gt)(vh));
+        EXPECT_EQ((*vf)(vh), (*vf_gt)(vh));
+    });
+
+    rx.for_each_face(HOST, [&](const FaceHandle fh) {
+        EXPECT_EQ((*ff)(fh), (*ff_gt)(fh));
+    });
+}
@@ -0,0 +1,40 @@
+#include "gtest/gtest.h"
+
+#include "rxmesh/rxmesh_static.h"
+
+TEST(RXMeshStatic, MultilevelPatching)
+{
+    using namespace rxmesh;
+
+    CUDA_ERROR(cudaDeviceReset());
+
+    patcher::PatcherBudget budget;
+    budget.num_levels        = 2;
+    budget.max_num_lloyd_run = 10;
+
+    RXMeshStatic rx(STRINGIFY(INPUT_DIR) "sphere3.obj",
+                    "",
+                    false,
+                    64,
+                    1.0,
+                    1.0,
+                    0.8,
+                    "",
+                    budget);
+
+    EXPECT_GT(rx.get_num_patches(), 1);
+    EXPECT_LE(rx.get_num_lloyd_run(), budget.max_num_lloyd_run);
+
+    uint32_t min_p(0), max_p(0), avg_p(0);
+    rx.get_max_min_avg_patch_size(min_p, max_p, avg_p);
+    EXPECT_GT(min_p, 0);
+
+    // every face is owned by exactly one patch
+    auto count = rx.add_face_attribute<uint32_t>("count", 1);
+    count->reset(0, HOST);
+    rx.for_each_face(HOST, [&](const FaceHandle& fh) { (*count)(fh)++; });
+    rx.for_each_face(HOST, [&](const FaceHandle& fh) {
+        EXPECT_EQ((*count)(fh), 1);
+        EXPECT_EQ(fh.patch_id(), rx.get_face_patch()[rx.map_to_global(fh)]);
+    });
+}
@@ -106,3 +106,94 @@ TEST(RXMeshDynamic, PatchLock)
     GPU_FREE(d_block_patch);
     GPU_FREE(d_status);
 }
+
+__global__ static void shared_lock_kernel(rxmesh::Context context,
+                                          uint32_t*       d_status)
+{
+    using namespace rxmesh;
+
+    const uint32_t num_patches = context.m_num_patches[0];
+
+    if (threadIdx.x == 0) {
+        bool st = true;
+
+        // readers never block each other
+        for (uint32_t p = 0; p < num_patches; ++p) {
+            if (!context.m_patches_info[p].lock.acquire_shared_lock(
+                    blockIdx.x)) {
+                st = false;
+            }
+            if (!context.m_patches_info[p].lock.is_locked() ||
+                context.m_patches_info[p].lock.is_exclusively_locked()) {
+                st = false;
+            }
+        }
+
+        for (uint32_t p = 0; p < num_patches; ++p) {
+            context.m_patches_info[p].lock.release_shared_lock();
+        }
+        d_status[blockIdx.x] = st;
+    }
+}
+
+__global__ static void upgrade_lock_kernel(rxmesh::Context context,
+                                           uint32_t*       d_status)
+{
+    using namespace rxmesh;
+
+    const uint32_t num_patches = context.m_num_patches[0];
+
+    if (threadIdx.x == 0) {
+        bool st = true;
+        for (uint32_t p = 0; p < num_patches; ++p) {
+            PatchLock& lock = context.m_patches_info[p].lock;
+
+            // two readers can not upgrade
+            st = st && !lock.is_locked();
+            st = st && lock.acquire_shared_lock(0);
+            st = st && lock.acquire_shared_lock(1);
+            st = st && !lock.upgrade_lock(0);
+            lock.release_shared_lock();
+
+            // the only reader can upgrade and then no one else can read
+            st = st && lock.upgrade_lock(0);
+            st = st && lock.is_exclusively_locked();
+            lock.release_lock();
+            st = st && !lock.is_locked();
+        }
+        d_status[0] = st;
+    }
+}
+
+TEST(RXMeshDynamic, SharedPatchLock)
+{
+    using namespace rxmesh;
+
+    RXMeshDynamic rx(STRINGIFY(INPUT_DIR) "cloth.obj");
+
+    const uint32_t num_blocks = 2 * rx.get_num_patches();
+
+    uint32_t* d_status;
+    CUDA_ERROR(cudaMalloc((void**)&d_status, num_blocks * sizeof(uint32_t)));
+    CUDA_ERROR(cudaMemset(d_status, 0, num_blocks * sizeof(uint32_t)));
+
+    std::vector<uint32_t> h_status(num_blocks);
+
+    shared_lock_kernel<<<num_blocks, 256>>>(rx.get_context(), d_status);
+
+    CUDA_ERROR(cudaMemcpy(h_status.data(),
+                          d_status,
+                          h_status.size() * sizeof(uint32_t),
+                          cudaMemcpyDeviceToHost));
+
+    uint32_t sum = std::accumulate(h_status.begin(), h_status.end(), 0);
+    EXPECT_EQ(sum, num_blocks);
+
+    upgrade_lock_kernel<<<1, 32>>>(rx.get_context(), d_status);
+
+    CUDA_ERROR(cudaMemcpy(
+        h_status.data(), d_status, sizeof(uint32_t), cudaMemcpyDeviceToHost));
+    EXPECT_EQ(h_status[0], 1);
+
+    GPU_FREE(d_status);
+}
@@ -29,6 +29,39 @@ __global__ void schedule_kernel(uint32_t* d_status, rxmesh::PatchScheduler sch)
     }
 }
 
+__global__ void pop_kernel(uint32_t* d_pids, rxmesh::PatchScheduler sch)
+{
+    using namespace rxmesh;
+    if (threadIdx.x == 0) {
+        d_pids[blockIdx.x] = sch.pop();
+    }
+}
+
+__global__ void push_low_priority_kernel(const uint32_t*        d_pids,
+                                         rxmesh::PatchScheduler sch)
+{
+    // even patches are pushed back with low priority
+    using namespace rxmesh;
+    if (threadIdx.x == 0) {
+        const uint32_t pid = d_pids[blockIdx.x];
+        if (pid != INVALID32) {
+            sch.push(pid, pid % 2 == 0);
+        }
+    }
+}
+
+__global__ void drain_kernel(uint32_t* d_order, rxmesh::PatchScheduler sch)
+{
+    using namespace rxmesh;
+    if (threadIdx.x == 0 && blockIdx.x == 0) {
+        uint32_t i = 0;
+        uint32_t pid;
+        while ((pid = sch.pop()) != INVALID32) {
+            d_order[i++] = pid;
+        }
+    }
+}
+
 TEST(RXMeshDynamic, PatchScheduler)
 {
     using namespace rxmesh;
@@ -66,3 +99,45 @@ TEST(RXMeshDynamic, PatchScheduler)
     GPU_FREE(d_status);
     sch.free();
 }
+
+TEST(RXMeshDynamic, PatchSchedulerPriority)
+{
+    using namespace rxmesh;
+
+    const uint32_t num_patches = 1000;
+
+    PatchScheduler sch;
+    sch.init(num_patches, 7);
+    sch.refill(num_patches);
+
+    uint32_t* d_order;
+    CUDA_ERROR(cudaMalloc((void**)&d_order, num_patches * sizeof(uint32_t)));
+
+    pop_kernel<<<num_patches, 32>>>(d_order, sch);
+    push_low_priority_kernel<<<num_patches, 32>>>(d_order, sch);
+
+    CUDA_ERROR(cudaMemset(d_order, 0xFF, num_patches * sizeof(uint32_t)));
+
+    drain_kernel<<<1, 1>>>(d_order, sch);
+
+    std::vector<uint32_t> h_order(num_patches);
+    CUDA_ERROR(cudaMemcpy(h_order.data(),
+                          d_order,
+                          num_patches * sizeof(uint32_t),
+                          cudaMemcpyDeviceToHost));
+
+    EXPECT_TRUE(sch.is_empty());
+
+    // all high-priority (odd) patches come out before the low-priority (even)
+    // ones and no patch is lost or duplicated
+    std::vector<bool> seen(num_patches, false);
+    for (uint32_t i = 0; i < num_patches; ++i) {
+        ASSERT_LT(h_order[i], num_patches);
+        EXPECT_FALSE(seen[h_order[i]]);
+        seen[h_order[i]] = true;
+        EXPECT_EQ(h_order[i] % 2, uint32_t(i < num_patches / 2));
+    }
+
+    GPU_FREE(d_order);
+    sch.free();
+}
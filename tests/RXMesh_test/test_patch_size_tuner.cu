@@ -0,0 +1,45 @@
+#include "gtest/gtest.h"
+
+#include "rxmesh/patch_size_tuner.h"
+
+TEST(RXMeshStatic, PatchSizeTuner)
+{
+    using namespace rxmesh;
+
+    CUDA_ERROR(cudaDeviceReset());
+
+    const std::string db_file =
+        (std::filesystem::temp_directory_path() / "rxmesh_patch_size_test.db")
+            .string();
+    std::filesystem::remove(db_file);
+
+    const std::vector<uint32_t> candidates = {128, 256};
+    const std::vector<Op>       ops        = {Op::VV, Op::FV};
+
+    const std::string file = STRINGIFY(INPUT_DIR) "sphere3.obj";
+
+    uint32_t num_faces = 0;
+    {
+        RXMeshStatic rx(file);
+        num_faces = rx.get_num_faces();
+    }
+
+    PatchSizeTuner<256> tuner(db_file, candidates, 2);
+    EXPECT_FALSE(tuner.is_cached(num_faces, ops));
+
+    const uint32_t patch_size = tuner.tune(file, ops);
+    EXPECT_NE(std::find(candidates.begin(), candidates.end(), patch_size),
+              candidates.end());
+    EXPECT_TRUE(tuner.is_cached(num_faces, ops));
+
+    // the op set is order-independent and the winner is read back from disk
+    PatchSizeTuner<256> tuner_reload(db_file, candidates, 2);
+    EXPECT_TRUE(tuner_reload.is_cached(num_faces, {Op::FV, Op::VV}));
+    EXPECT_EQ(tuner_reload.tune(file, ops), patch_size);
+
+    // a different block size is a different entry
+    PatchSizeTuner<512> tuner_512(db_file, candidates, 2);
+    EXPECT_FALSE(tuner_512.is_cached(num_faces, ops));
+
+    std::filesystem::remove(db_file);
+}
@@ -0,0 +1,196 @@
+#include "gtest/gtest.h"
+
+#include "rxmesh/rxmesh_polygon.h"
+
+using namespace rxmesh;
+
+/**
+ * @brief n x n grid of quads where the quads of the last row are split into
+ * two triangles each
+ */
+static void make_quad_grid(const uint32_t                      n,
+                           std::vector<std::vector<float>>&    verts,
+                           std::vector<std::vector<uint32_t>>& fv)
+{
+    for (uint32_t j = 0; j <= n; ++j) {
+        for (uint32_t i = 0; i <= n; ++i) {
+            verts.push_back({float(i), float(j), 0.f});
+        }
+    }
+    auto id = [&](uint32_t i, uint32_t j) { return j * (n + 1) + i; };
+    for (uint32_t j = 0; j < n; ++j) {
+        for (uint32_t i = 0; i < n; ++i) {
+            if (j == n - 1) {
+                fv.push_back({id(i, j), id(i + 1, j), id(i + 1, j + 1)});
+                fv.push_back({id(i, j), id(i + 1, j + 1), id(i, j + 1)});
+            } else {
+                fv.push_back(
+                    {id(i, j), id(i + 1, j), id(i + 1, j + 1), id(i, j + 1)});
+            }
+        }
+    }
+}
+
+TEST(RXMeshPolygon, Queries)
+{
+    constexpr uint32_t n = 24;
+
+    std::vector<std::vector<float>>    verts;
+    std::vector<std::vector<uint32_t>> fv;
+    make_quad_grid(n, verts, fv);
+
+    // small patches so the mesh has many patches and ribbons
+    RXMeshPolygon rx(verts, fv, 32);
+
+    const uint32_t num_v = (n + 1) * (n + 1);
+    const uint32_t num_e = 2 * n * (n + 1) + n;
+
+    ASSERT_EQ(rx.get_num_vertices(), num_v);
+    ASSERT_EQ(rx.get_num_edges(), num_e);
+    ASSERT_EQ(rx.get_num_faces(), fv.size());
+    EXPECT_EQ(rx.get_max_face_degree(), 4);
+    EXPECT_GT(rx.get_num_patches(), 1);
+
+    // input ids as attributes
+    auto v_id = rx.add_vertex_attribute<uint32_t>();
+    auto e_id = rx.add_edge_attribute<uint32_t>();
+    auto f_id = rx.add_face_attribute<uint32_t>();
+    rx.for_each_vertex(HOST, [&](const VertexHandle& vh) {
+        (*v_id)(vh) = rx.get_input_id(vh);
+    });
+    rx.for_each_edge(HOST, [&](const EdgeHandle& eh) {
+        (*e_id)(eh) = rx.get_input_id(eh);
+    });
+    rx.for_each_face(HOST, [&](const FaceHandle& fh) {
+        (*f_id)(fh) = rx.get_input_id(fh);
+    });
+    v_id->move(HOST, DEVICE);
+    e_id->move(HOST, DEVICE);
+    f_id->move(HOST, DEVICE);
+
+    // shallow copies captured by the device lambdas
+    PolygonVertexAttribute<uint32_t> d_v_id = *v_id;
+    PolygonEdgeAttribute<uint32_t>   d_e_id = *e_id;
+    PolygonFaceAttribute<uint32_t>   d_f_id = *f_id;
+
+    // FV and FE (up to 4 per face)
+    auto f_v = rx.add_face_attribute<uint32_t>(4);
+    auto f_e = rx.add_face_attribute<uint32_t>(4);
+    f_v->reset(INVALID32, DEVICE);
+    f_e->reset(INVALID32, DEVICE);
+
+    PolygonFaceAttribute<uint32_t> d_f_v = *f_v;
+    PolygonFaceAttribute<uint32_t> d_f_e = *f_e;
+
+    rx.run_query_kernel<PolygonOp::FV>(
+        [=] __device__(const FaceHandle&                    fh,
+                       const PolygonIterator<VertexHandle>& iter) mutable {
+            for (uint16_t i = 0; i < iter.size(); ++i) {
+                d_f_v(fh, i) = d_v_id(iter[i]);
+            }
+        });
+    rx.run_query_kernel<PolygonOp::FE>(
+        [=] __device__(const FaceHandle&                  fh,
+                       const PolygonIterator<EdgeHandle>& iter) mutable {
+            for (uint16_t i = 0; i < iter.size(); ++i) {
+                d_f_e(fh, i) = d_e_id(iter[i]);
+            }
+        });
+
+    // EV
+    auto e_v = rx.add_edge_attribute<uint32_t>(2);
+
+    PolygonEdgeAttribute<uint32_t> d_e_v = *e_v;
+    rx.run_query_kernel<PolygonOp::EV>(
+        [=] __device__(const EdgeHandle&                    eh,
+                       const PolygonIterator<VertexHandle>& iter) mutable {
+            d_e_v(eh, 0) = d_v_id(iter[0]);
+            d_e_v(eh, 1) = d_v_id(iter[1]);
+        });
+
+    // the number of outputs of FF, VF, and VV
+    auto f_ff = rx.add_face_attribute<uint32_t>();
+    auto v_vf = rx.add_vertex_attribute<uint32_t>();
+    auto v_vv = rx.add_vertex_attribute<uint32_t>();
+
+    PolygonFaceAttribute<uint32_t>   d_f_ff = *f_ff;
+    PolygonVertexAttribute<uint32_t> d_v_vf = *v_vf;
+    PolygonVertexAttribute<uint32_t> d_v_vv = *v_vv;
+    rx.run_query_kernel<PolygonOp::FF>(
+        [=] __device__(const FaceHandle&                  fh,
+                       const PolygonIterator<FaceHandle>& iter) mutable {
+            d_f_ff(fh) = iter.size();
+        });
+    rx.run_query_kernel<PolygonOp::VF>(
+        [=] __device__(const VertexHandle&                vh,
+                       const PolygonIterator<FaceHandle>& iter) mutable {
+            d_v_vf(vh) = iter.size();
+        });
+    rx.run_query_kernel<PolygonOp::VV>(
+        [=] __device__(const VertexHandle&                  vh,
+                       const PolygonIterator<VertexHandle>& iter) mutable {
+            d_v_vv(vh) = iter.size();
+        });
+
+    CUDA_ERROR(cudaDeviceSynchronize());
+    CUDA_ERROR(cudaGetLastError());
+
+    f_v->move(DEVICE, HOST);
+    f_e->move(DEVICE, HOST);
+    e_v->move(DEVICE, HOST);
+    f_ff->move(DEVICE, HOST);
+    v_vf->move(DEVICE, HOST);
+    v_vv->move(DEVICE, HOST);
+
+    // the reference incidence
+    std::vector<uint32_t> vf(num_v, 0);
+    for (const auto& f : fv) {
+        for (uint32_t v : f) {
+            vf[v]++;
+        }
+    }
+
+    for (uint32_t f = 0; f < fv.size(); ++f) {
+        const FaceHandle fh = rx.get_face_handle(f);
+        const uint32_t   d  = uint32_t(fv[f].size());
+        for (uint32_t k = 0; k < d; ++k) {
+            EXPECT_EQ((*f_v)(fh, k), fv[f][k]);
+
+            // the k-th edge connects the k-th and (k+1)-th vertex
+            const uint32_t   e  = (*f_e)(fh, k);
+            const EdgeHandle eh = rx.get_edge_handle(e);
+            const uint32_t   a  = fv[f][k];
+            const uint32_t   b  = fv[f][(k + 1) % d];
+            const uint32_t   v0 = (*e_v)(eh, 0);
+            const uint32_t   v1 = (*e_v)(eh, 1);
+            EXPECT_TRUE((v0 == a && v1 == b) || (v0 == b && v1 == a));
+        }
+    }
+
+    // interior faces have one neighbor per edge
+    for (uint32_t f = 0; f < fv.size(); ++f) {
+        uint32_t num_boundary = 0;
+        for (uint32_t v : fv[f]) {
+            const float x = verts[v][0];
+            const float y = verts[v][1];
+            if (x == 0 || y == 0 || x == n || y == n) {
+                num_boundary++;
+            }
+        }
+        if (num_boundary == 0) {
+            EXPECT_EQ((*f_ff)(rx.get_face_handle(f)), fv[f].size());
+        }
+    }
+
+    for (uint32_t v = 0; v < num_v; ++v) {
+        const VertexHandle vh = rx.get_vertex_handle(v);
+        EXPECT_EQ((*v_vf)(vh), vf[v]);
+
+        const float x = verts[v][0];
+        const float y = verts[v][1];
+        if (x > 0 && y > 0 && x < n && y < n - 1) {
+            // interior vertices of the quad rows have valence 4
+            EXPECT_EQ((*v_vv)(vh), 4);
+        }
+    }
+}
@@ -223,4 +223,50 @@ TEST(RXMeshStatic, Oriented_VV_Closed)
             }
         }
     });
-}
\ No newline at end of file
+}
+TEST(RXMeshStatic, Oriented_VV_CompileTimeFlag)
+{
+    using namespace rxmesh;
+
+    RXMeshStatic rx(STRINGIFY(INPUT_DIR) "sphere3.obj");
+
+    auto v_attr = *rx.add_vertex_attribute<uint32_t>("v", 2);
+    v_attr.reset(0, LOCATION_ALL);
+
+    // the oriented and non-oriented VV give the same valence
+    auto valence = [=] __device__(const VertexHandle&   vh,
+                                  const VertexIterator& iter) mutable {
+        v_attr(vh, 0) = iter.size();
+    };
+    auto oriented_valence = [=] __device__(const VertexHandle&   vh,
+                                           const VertexIterator& iter) mutable {
+        v_attr(vh, 1) = iter.size();
+    };
+
+    rx.run_query_kernel<Op::VV, 256>(valence, false);
+    rx.run_query_kernel<Op::VV, 256>(oriented_valence, true);
+
+    EXPECT_EQ(cudaDeviceSynchronize(), cudaSuccess);
+
+    v_attr.move(DEVICE, HOST);
+    rx.for_each_vertex(HOST, [&](const VertexHandle vh) {
+        EXPECT_GT(v_attr(vh, 0), 0);
+        EXPECT_EQ(v_attr(vh, 0), v_attr(vh, 1));
+    });
+
+    // the non-oriented instantiation has none of the oriented code so it
+    // should not need more registers than the one with the runtime flag
+    using LambdaT = decltype(valence);
+
+    cudaFuncAttributes runtime_attr, static_attr;
+    CUDA_ERROR(cudaFuncGetAttributes(
+        &runtime_attr, detail::query_kernel<256, Op::VV, LambdaT, bool>));
+    CUDA_ERROR(cudaFuncGetAttributes(
+        &static_attr,
+        detail::query_kernel<256, Op::VV, LambdaT, std::false_type>));
+
+    RXMESH_INFO("VV query_kernel registers: runtime flag = {}, static = {}",
+                runtime_attr.numRegs,
+                static_attr.numRegs);
+    EXPECT_LE(static_attr.numRegs, runtime_attr.numRegs);
+}
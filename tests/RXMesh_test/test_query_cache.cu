@@ -0,0 +1,77 @@
+#include "gtest/gtest.h"
+
+#include "rxmesh/rxmesh_static.h"
+
+template <rxmesh::Op op,
+          typename HandleT = typename rxmesh::InputHandle<op>::type>
+void query_sum(rxmesh::RXMeshStatic&                  rx,
+               rxmesh::Attribute<uint32_t, HandleT>& attr)
+{
+    using namespace rxmesh;
+    using IteratorT = typename IteratorType<op>::type;
+
+    constexpr uint32_t blockThreads = 256;
+
+    auto a = attr;
+
+    // order-dependent checksum of the query output
+    auto sum = [a] __device__(const HandleT& h, const IteratorT& iter) mutable {
+        uint32_t s = 0;
+        for (uint32_t i = 0; i < iter.size(); ++i) {
+            s = 31 * s + iter[i].patch_id() * 65536 + iter[i].local_id();
+        }
+        a(h) = s;
+    };
+
+    LaunchBox<blockThreads> lb;
+    rx.prepare_launch_box(
+        {op}, lb, (void*)detail::query_kernel<blockThreads, op, decltype(sum)>);
+    rx.run_query_kernel<op>(lb, sum);
+}
+
+template <rxmesh::Op op>
+void check_query_cache(rxmesh::RXMeshStatic& rx)
+{
+    using namespace rxmesh;
+    using HandleT = typename InputHandle<op>::type;
+
+    auto gt     = rx.add_attribute<uint32_t, HandleT>("gt", 1);
+    auto cached = rx.add_attribute<uint32_t, HandleT>("cached", 1);
+
+    EXPECT_FALSE(rx.is_query_cached(op));
+    query_sum<op>(rx, *gt);
+
+    rx.enable_query_cache<op>();
+    EXPECT_TRUE(rx.is_query_cached(op));
+    query_sum<op>(rx, *cached);
+
+    CUDA_ERROR(cudaDeviceSynchronize());
+
+    gt->move(DEVICE, HOST);
+    cached->move(DEVICE, HOST);
+
+    rx.for_each<HandleT>(HOST, [&](const HandleT h) {
+        EXPECT_EQ((*gt)(h), (*cached)(h));
+    });
+
+    rx.disable_query_cache(op);
+    EXPECT_FALSE(rx.is_query_cached(op));
+
+    rx.remove_attribute("gt");
+    rx.remove_attribute("cached");
+}
+
+TEST(RXMeshStatic, QueryCache)
+{
+    using namespace rxmesh;
+
+    RXMeshStatic rx(STRINGIFY(INPUT_DIR) "sphere3.obj");
+
+    check_query_cache<Op::VV>(rx);
+    check_query_cache<Op::VF>(rx);
+    check_query_cache<Op::FF>(rx);
+    check_query_cache<Op::EV>(rx);
+    check_query_cache<Op::FE>(rx);
+
+    ASSERT_EQ(cudaDeviceSynchronize(), cudaSuccess);
+}
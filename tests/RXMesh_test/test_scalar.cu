@@ -1196,4 +1196,67 @@ TEST(Diff, ScalarSphere)
     ASSERT_EQ(h_err, 0);
 
     GPU_FREE(d_err);
-}
\ No newline at end of file
+}
+template <typename T, int k>
+__inline__ __device__ rxmesh::Scalar<T, k, true> symmetric_hess_func()
+{
+    using namespace rxmesh;
+    using RealK = Scalar<T, k, true>;
+
+    // only uses the first 11 variables
+    RealK x[11];
+    for (int i = 0; i < 11; ++i) {
+        x[i] = RealK(T(0.1) * T(i + 1), i);
+    }
+
+    RealK a = sqr(x[0] * x[1] + x[2]) / (1.0 + x[3] * x[3]);
+    RealK b = sqrt(x[4] * x[5] + 2.0) * x[6];
+    RealK c = 1.0 / (x[7] + x[8] * x[9] + x[10]);
+
+    return a * b + c;
+}
+
+template <typename T>
+__global__ static void test_symmetric_hess(int* d_err, T eps)
+{
+    using namespace rxmesh;
+
+    // 12 variables use the symmetric Hessian evaluation while 11 do not
+    static_assert(Scalar<T, 12, true>::k_symmetric_hess == 12);
+
+    const auto sym  = symmetric_hess_func<T, 12>();
+    const auto full = symmetric_hess_func<T, 11>();
+
+    RX_ASSERT_NEAR(sym.val(), full.val(), eps, d_err);
+
+    for (int i = 0; i < 11; ++i) {
+        RX_ASSERT_NEAR(sym.grad()(i), full.grad()(i), eps, d_err);
+        for (int j = 0; j < 11; ++j) {
+            RX_ASSERT_NEAR(sym.hess()(i, j), full.hess()(i, j), eps, d_err);
+        }
+        RX_ASSERT_NEAR(sym.hess()(i, 11), 0.0, eps, d_err);
+        RX_ASSERT_NEAR(sym.hess()(11, i), 0.0, eps, d_err);
+    }
+    RX_ASSERT_TRUE(is_sym(sym.hess(), eps), d_err);
+}
+
+TEST(Diff, ScalarSymmetricHessian)
+{
+    using namespace rxmesh;
+
+    int* d_err;
+    CUDA_ERROR(cudaMalloc((void**)&d_err, sizeof(int)));
+    CUDA_ERROR(cudaMemset(d_err, 0, sizeof(int)));
+
+    test_symmetric_hess<float><<<1, 1>>>(d_err, 1e-4);
+    test_symmetric_hess<double><<<1, 1>>>(d_err, 1e-9);
+
+    EXPECT_EQ(cudaDeviceSynchronize(), cudaSuccess);
+
+    int h_err;
+    CUDA_ERROR(cudaMemcpy(&h_err, d_err, sizeof(int), cudaMemcpyDeviceToHost));
+
+    ASSERT_EQ(h_err, 0);
+
+    GPU_FREE(d_err);
+}
@@ -6,13 +6,20 @@
 #include "rxmesh/matrix/sparse_matrix.h"
 
 #include "rxmesh/query.cuh"
+#include "rxmesh/algo/tutte_embedding.h"
+#include "rxmesh/util/timer.h"
 
 
 #include "rxmesh/matrix/cg_mat_free_solver.h"
 #include "rxmesh/matrix/cg_solver.h"
 #include "rxmesh/matrix/cholesky_solver.h"
 #include "rxmesh/matrix/cudss_cholesky_solver.h"
+#include "rxmesh/matrix/dec_operator.h"
+#include "rxmesh/matrix/eigen_solver.h"
+#include "rxmesh/matrix/gmg/smoother.h"
+#include "rxmesh/matrix/laplacian_operator.h"
 #include "rxmesh/matrix/lu_solver.h"
+#include "rxmesh/matrix/mixed_precision_solver.h"
 #include "rxmesh/matrix/pcg_solver.h"
 #include "rxmesh/matrix/qr_solver.h"
 
@@ -209,6 +216,393 @@ TEST(Solver, Cholesky)
     B.release();
 }
 
+TEST(Solver, CholeskyPatternReuse)
+{
+    // a second solver on a matrix with the same sparsity should reuse the
+    // permutation of the first one and the explicit analyze/refactorize split
+    // should give the same results as pre_solve()
+    RXMeshStatic rx(STRINGIFY(INPUT_DIR) "sphere3.obj");
+
+    uint32_t num_vertices = rx.get_num_vertices();
+
+    PermuteCache::clear();
+
+    SparseMatrix<float> A(rx, Op::VV);
+    SparseMatrix<float> A2(rx, Op::VV);
+    DenseMatrix<float>  X(rx, num_vertices, 3);
+    DenseMatrix<float>  B(rx, num_vertices, 3);
+
+    CholeskySolver solver(&A);
+
+    EXPECT_FALSE(solver.is_analyzed());
+
+    test_direct_solver(
+        rx, solver, A, B, X, true, [&]() { solver.pre_solve(rx); });
+
+    EXPECT_TRUE(solver.is_analyzed());
+    EXPECT_EQ(PermuteCache::size(), size_t(1));
+
+    CholeskySolver solver2(&A2);
+
+    test_direct_solver(rx, solver2, A2, B, X, true, [&]() {
+        solver2.analyze_pattern(rx);
+        solver2.refactorize();
+    });
+
+    EXPECT_EQ(PermuteCache::size(), size_t(1));
+
+    // only new values
+    test_direct_solver(
+        rx,
+        solver2,
+        A2,
+        B,
+        X,
+        true,
+        [&]() { solver2.refactorize(); },
+        2.888f,
+        55.109f,
+        3.464f,
+        70.f);
+
+    PermuteCache::clear();
+
+    A.release();
+    A2.release();
+    X.release();
+    B.release();
+}
+
+TEST(Solver, CholeskyFillIn)
+{
+    // the symbolic fill-in count should match the number of non-zeros in the
+    // factor computed by Eigen on the same permuted matrix
+    RXMeshStatic rx(STRINGIFY(INPUT_DIR) "sphere3.obj");
+
+    uint32_t num_vertices = rx.get_num_vertices();
+
+    SparseMatrix<float> A(rx, Op::VV);
+    DenseMatrix<float>  X(rx, num_vertices, 3);
+    DenseMatrix<float>  B(rx, num_vertices, 3);
+
+    rx.run_kernel<256>({Op::VV},
+                       setup<float, 256>,
+                       *rx.get_input_vertex_coordinates(),
+                       A,
+                       X,
+                       B,
+                       7.4f,
+                       2.6f,
+                       10.3f,
+                       100.f);
+    A.move(DEVICE, HOST);
+
+    for (auto perm : {PermuteMethod::NSTDIS, PermuteMethod::GPUND}) {
+        CholeskySolver solver(&A, perm);
+
+        NDPermuteOptions options;
+        options.fm_max_moves = 0;
+        solver.set_nd_options(options);
+
+        solver.permute_alloc();
+        solver.permute(rx);
+
+        const int* h_permute = solver.get_h_permute();
+
+        EXPECT_TRUE(is_unique_permutation(num_vertices, h_permute));
+
+        Eigen::PermutationMatrix<Eigen::Dynamic, Eigen::Dynamic> p(
+            num_vertices);
+        for (uint32_t i = 0; i < num_vertices; ++i) {
+            p.indices()[h_permute[i]] = i;
+        }
+
+        Eigen::SparseMatrix<float> eigen_a = A.to_eigen_copy();
+        Eigen::SparseMatrix<float> eigen_pa =
+            (p * eigen_a * p.transpose()).eval();
+
+        Eigen::SimplicialLLT<Eigen::SparseMatrix<float>,
+                             Eigen::Lower,
+                             Eigen::NaturalOrdering<int>>
+            llt;
+        llt.analyzePattern(eigen_pa);
+        llt.factorize(eigen_pa);
+
+        Eigen::SparseMatrix<float> L = llt.matrixL();
+
+        EXPECT_EQ(solver.fill_in_estimate(), size_t(L.nonZeros()));
+
+        EXPECT_EQ(cholesky_fill_in(int(num_vertices),
+                                   A.row_ptr(HOST),
+                                   A.col_idx(HOST),
+                                   h_permute),
+                  size_t(L.nonZeros()));
+    }
+
+    A.release();
+    X.release();
+    B.release();
+}
+
+TEST(Solver, CholeskyAutoPermute)
+{
+    // the automatic permutation should solve the system and pick the
+    // candidate with the least flops
+    RXMeshStatic rx(STRINGIFY(INPUT_DIR) "sphere3.obj");
+
+    uint32_t num_vertices = rx.get_num_vertices();
+
+    SparseMatrix<float> A(rx, Op::VV);
+    DenseMatrix<float>  X(rx, num_vertices, 3);
+    DenseMatrix<float>  B(rx, num_vertices, 3);
+
+    CholeskySolver solver(&A, PermuteMethod::AUTO);
+
+    test_direct_solver(
+        rx, solver, A, B, X, true, [&]() { solver.pre_solve(rx); });
+
+    const PermuteMethod selected = solver.get_permute_method();
+    EXPECT_NE(selected, PermuteMethod::AUTO);
+
+    const double selected_flops = cholesky_symbolic(int(num_vertices),
+                                                    A.row_ptr(HOST),
+                                                    A.col_idx(HOST),
+                                                    solver.get_h_permute())
+                                      .flops;
+
+    double min_flops = std::numeric_limits<double>::max();
+
+    for (auto perm : {PermuteMethod::SYMAMD,
+                      PermuteMethod::NSTDIS,
+                      PermuteMethod::GPUND,
+                      PermuteMethod::GPUMGND}) {
+        CholeskySolver other(&A, perm);
+        other.permute_alloc();
+        other.permute(rx);
+
+        const CholeskySymbolic stats = cholesky_symbolic(int(num_vertices),
+                                                         A.row_ptr(HOST),
+                                                         A.col_idx(HOST),
+                                                         other.get_h_permute());
+
+        EXPECT_EQ(stats.nnz, other.fill_in_estimate());
+
+        min_flops = std::min(min_flops, stats.flops);
+    }
+
+    EXPECT_EQ(selected_flops, min_flops);
+
+    PermuteCache::clear();
+
+    A.release();
+    X.release();
+    B.release();
+}
+
+TEST(Solver, NDPermutationReuse)
+{
+    // the GPUND permutation is computed once per mesh and shared by every
+    // solver built on it
+    RXMeshStatic rx(STRINGIFY(INPUT_DIR) "sphere3.obj");
+
+    uint32_t num_vertices = rx.get_num_vertices();
+
+    SparseMatrix<float> A(rx, Op::VV);
+    DenseMatrix<float>  X(rx, num_vertices, 3);
+    DenseMatrix<float>  B(rx, num_vertices, 3);
+
+    rx.run_kernel<256>({Op::VV},
+                       setup<float, 256>,
+                       *rx.get_input_vertex_coordinates(),
+                       A,
+                       X,
+                       B,
+                       7.4f,
+                       2.6f,
+                       10.3f,
+                       100.f);
+    A.move(DEVICE, HOST);
+
+    auto perm = get_nd_permutation(rx);
+    EXPECT_EQ(perm.get(), get_nd_permutation(rx).get());
+    EXPECT_EQ(perm->get_num_patches(), rx.get_num_patches());
+    EXPECT_TRUE(is_unique_permutation(num_vertices, perm->get_permute(HOST)));
+
+    std::vector<int> d_copy(num_vertices);
+    CUDA_ERROR(cudaMemcpy(d_copy.data(),
+                          perm->get_permute(DEVICE),
+                          num_vertices * sizeof(int),
+                          cudaMemcpyDeviceToHost));
+
+    for (int s = 0; s < 2; ++s) {
+        // bypass the sparsity-keyed cache such that the solver goes to the
+        // mesh
+        PermuteCache::clear();
+
+        CholeskySolver solver(&A, PermuteMethod::GPUND);
+        solver.permute_alloc();
+        solver.permute(rx);
+
+        for (uint32_t i = 0; i < num_vertices; ++i) {
+            EXPECT_EQ(solver.get_h_permute()[i], perm->get_permute(HOST)[i]);
+            EXPECT_EQ(d_copy[i], perm->get_permute(HOST)[i]);
+        }
+    }
+
+    EXPECT_EQ(perm.get(), get_nd_permutation(rx).get());
+
+    // different options are a different product
+    NDPermuteOptions options;
+    options.fm_max_moves = 0;
+    EXPECT_NE(perm.get(), get_nd_permutation(rx, options).get());
+
+    PermuteCache::clear();
+
+    A.release();
+    X.release();
+    B.release();
+}
+
+TEST(Solver, CholeskyMultiRHS)
+{
+    // many right-hand sides with column- and row-major layout
+    RXMeshStatic rx(STRINGIFY(INPUT_DIR) "sphere3.obj");
+
+    using T = float;
+
+    const int num_vertices = rx.get_num_vertices();
+    const int num_rhs      = 7;
+
+    SparseMatrix<T> A(rx, Op::VV);
+    DenseMatrix<T>  X3(rx, num_vertices, 3);
+    DenseMatrix<T>  B3(rx, num_vertices, 3);
+
+    rx.run_kernel<256>({Op::VV},
+                       setup<T, 256>,
+                       *rx.get_input_vertex_coordinates(),
+                       A,
+                       X3,
+                       B3,
+                       7.4f,
+                       2.6f,
+                       10.3f,
+                       100.f);
+    A.move(DEVICE, HOST);
+
+    DenseMatrix<T, Eigen::ColMajor> B_col(num_vertices, num_rhs);
+    DenseMatrix<T, Eigen::ColMajor> X_col(num_vertices, num_rhs);
+    DenseMatrix<T, Eigen::RowMajor> B_row(num_vertices, num_rhs);
+    DenseMatrix<T, Eigen::RowMajor> X_row(num_vertices, num_rhs);
+
+    B_col.fill_random();
+    for (int i = 0; i < num_vertices; ++i) {
+        for (int j = 0; j < num_rhs; ++j) {
+            B_row(i, j) = B_col(i, j);
+        }
+    }
+    B_col.move(HOST, DEVICE);
+    B_row.move(HOST, DEVICE);
+    X_col.reset(0, LOCATION_ALL);
+    X_row.reset(0, LOCATION_ALL);
+
+    CholeskySolver<SparseMatrix<T>, Eigen::ColMajor> solver_col(&A);
+    CholeskySolver<SparseMatrix<T>, Eigen::RowMajor> solver_row(&A);
+
+    solver_col.pre_solve(rx);
+    solver_col.solve(B_col, X_col);
+
+    solver_row.pre_solve(rx);
+    solver_row.solve(B_row, X_row);
+
+    DenseMatrix<T, Eigen::ColMajor> AX(num_vertices, num_rhs);
+    A.multiply(X_col, AX);
+
+    AX.move(DEVICE, HOST);
+    X_col.move(DEVICE, HOST);
+    X_row.move(DEVICE, HOST);
+
+    for (int i = 0; i < num_vertices; ++i) {
+        for (int j = 0; j < num_rhs; ++j) {
+            EXPECT_NEAR(AX(i, j), B_col(i, j), 1e-3);
+            EXPECT_NEAR(X_row(i, j), X_col(i, j), 1e-5);
+        }
+    }
+
+    A.release();
+    X3.release();
+    B3.release();
+    B_col.release();
+    X_col.release();
+    B_row.release();
+    X_row.release();
+    AX.release();
+}
+
+TEST(Solver, MixedPrecisionCholesky)
+{
+    // double system factorized in float and refined in double should reach a
+    // residual well below what a float factorization alone gives
+    RXMeshStatic rx(STRINGIFY(INPUT_DIR) "sphere3.obj");
+
+    using T = double;
+
+    uint32_t num_vertices = rx.get_num_vertices();
+
+    auto in_coords = *rx.get_input_vertex_coordinates();
+    auto coords    = *rx.add_vertex_attribute<T>("coords", 3);
+    rx.for_each_vertex(HOST, [&](const VertexHandle vh) {
+        for (int i = 0; i < 3; ++i) {
+            coords(vh, i) = in_coords(vh, i);
+        }
+    });
+    coords.move(HOST, DEVICE);
+
+    SparseMatrix<T> A(rx, Op::VV);
+    DenseMatrix<T>  X(rx, num_vertices, 3);
+    DenseMatrix<T>  B(rx, num_vertices, 3);
+
+    rx.run_kernel<256>({Op::VV},
+                       setup<T, 256>,
+                       coords,
+                       A,
+                       X,
+                       B,
+                       7.4,
+                       2.6,
+                       10.3,
+                       100.);
+    A.move(DEVICE, HOST);
+    B.move(DEVICE, HOST);
+
+    MixedPrecisionCholeskySolver solver(&A, 10, 1e-20, 1e-12);
+
+    solver.pre_solve(rx);
+    solver.solve(B, X);
+
+    EXPECT_GT(solver.iter_taken(), 0);
+    EXPECT_LT(solver.final_residual(), 1e-10 * solver.start_residual());
+
+    X.move(DEVICE, HOST);
+
+    DenseMatrix<T> Ax(rx, A.rows(), X.cols());
+
+    A.multiply(X, Ax);
+
+    Ax.move(DEVICE, HOST);
+
+    for (int i = 0; i < Ax.rows(); ++i) {
+        for (int j = 0; j < Ax.cols(); ++j) {
+            EXPECT_NEAR(Ax(i, j), B(i, j), 1e-8);
+        }
+    }
+
+    rx.remove_attribute("coords");
+    A.release();
+    X.release();
+    B.release();
+    Ax.release();
+}
+
 #ifdef USE_CUDSS
 TEST(Solver, cuDSSCholesky)
 {
@@ -423,6 +817,112 @@ TEST(Solver, PCG)
     B.release();
 }
 
+TEST(Solver, PCGPreconditioners)
+{
+    RXMeshStatic rx(STRINGIFY(INPUT_DIR) "sphere3.obj");
+
+    uint32_t num_vertices = rx.get_num_vertices();
+
+    using T = float;
+
+    SparseMatrix<T> A(rx, Op::VV);
+    DenseMatrix<T>  X(rx, num_vertices, 3);
+    DenseMatrix<T>  B(rx, num_vertices, 3);
+
+    for (PrecondType type : {PrecondType::Jacobi,
+                             PrecondType::IC0,
+                             PrecondType::PatchBlockJacobi,
+                             PrecondType::Chebyshev}) {
+        PCGSolver<T> solver(A, 3, 5000, T(1e-7));
+
+        EXPECT_TRUE(solver.set_preconditioner(type, &rx));
+
+        GPUTimer timer;
+        timer.start();
+
+        test_iterative_solver(rx, solver, A, B, X);
+
+        timer.stop();
+
+        RXMESH_INFO(" {}: iter taken = {}, time = {} (ms)",
+                    precond_type_to_string(type),
+                    solver.iter_taken(),
+                    timer.elapsed_millis());
+    }
+
+    A.release();
+    X.release();
+    B.release();
+}
+
+TEST(Solver, GMGSmoothers)
+{
+    RXMeshStatic rx(STRINGIFY(INPUT_DIR) "sphere3.obj");
+
+    uint32_t num_vertices = rx.get_num_vertices();
+
+    using T = float;
+
+    SparseMatrix<T> A(rx, Op::VV);
+    DenseMatrix<T>  X(rx, num_vertices, 3);
+    DenseMatrix<T>  B(rx, num_vertices, 3);
+    DenseMatrix<T>  X0(rx, num_vertices, 3);
+    DenseMatrix<T>  AX(rx, num_vertices, 3);
+
+    rx.run_kernel<256>({Op::VV},
+                       setup<T, 256>,
+                       *rx.get_input_vertex_coordinates(),
+                       A,
+                       X0,
+                       B,
+                       7.4f,
+                       2.6f,
+                       10.3f,
+                       100.f);
+
+    // the Gauss-Seidel coloring is computed on the host
+    A.move(DEVICE, HOST);
+
+    auto residual = [&]() {
+        A.multiply(X, AX);
+        AX.axpy(B, T(-1));
+        return AX.norm2() / B.norm2();
+    };
+
+    for (Smoother type :
+         {Smoother::Jacobi, Smoother::GaussSeidel, Smoother::Chebyshev}) {
+        GMGSmoother<T> smoother(type, num_vertices, 3);
+        smoother.setup(A);
+
+        X.copy_from(X0, DEVICE, DEVICE);
+        const T start_res = residual();
+
+        smoother.solve<3>(A, B, X, 20, false);
+        smoother.solve<3>(A, B, X, 20, true);
+
+        const T final_res = residual();
+
+        RXMESH_INFO(" smoother {}: start_res = {}, final_res = {}",
+                    int(type),
+                    start_res,
+                    final_res);
+
+        EXPECT_LT(final_res, 1e-4 * start_res);
+    }
+
+    // every row is assigned a color
+    GaussSeidelSolver<T> gs;
+    EXPECT_GT(gs.setup(A), 1);
+    EXPECT_EQ(gs.m_color_offset.back(), int(num_vertices));
+    gs.release();
+
+    A.release();
+    X.release();
+    B.release();
+    X0.release();
+    AX.release();
+}
+
 TEST(Solver, CGMatFree)
 {
     RXMeshStatic rx(STRINGIFY(INPUT_DIR) "sphere3.obj");
@@ -457,4 +957,523 @@ TEST(Solver, CGMatFree)
     A.release();
     X.release();
     B.release();
-}
\ No newline at end of file
+}
+template <typename T>
+void scale_coordinates(RXMeshStatic&      rx,
+                       VertexAttribute<T> coords,
+                       const T            scale)
+{
+    rx.for_each_vertex(DEVICE, [=] __device__(const VertexHandle& vh) mutable {
+        for (int i = 0; i < 3; ++i) {
+            coords(vh, i) *= scale;
+        }
+    });
+    CUDA_ERROR(cudaDeviceSynchronize());
+}
+
+TEST(Solver, LaplacianOperator)
+{
+    RXMeshStatic rx(STRINGIFY(INPUT_DIR) "sphere3.obj");
+
+    uint32_t num_vertices = rx.get_num_vertices();
+
+    using T = float;
+
+    auto coords = rx.get_input_vertex_coordinates();
+
+    auto lap = get_laplacian_operator(rx, *coords);
+    EXPECT_EQ(lap->num_builds(), 1);
+
+    // the second request shares the same operator without rebuilding it
+    EXPECT_EQ(get_laplacian_operator(rx, *coords), lap);
+    EXPECT_EQ(lap->num_builds(), 1);
+
+    DenseMatrix<T> X(rx, num_vertices, 3);
+    DenseMatrix<T> B(rx, num_vertices, 3);
+    DenseMatrix<T> AX(rx, num_vertices, 3);
+    DenseMatrix<T> AX_mat(rx, num_vertices, 3);
+
+    // the matrix-free apply should match the assembled matrix
+    X.fill_random();
+    X.move(HOST, DEVICE);
+
+    lap->apply(X, AX, T(1), T(1));
+    lap->matrix(T(1), T(1)).multiply(X, AX_mat);
+
+    AX.move(DEVICE, HOST);
+    AX_mat.move(DEVICE, HOST);
+    for (uint32_t i = 0; i < num_vertices; ++i) {
+        for (int j = 0; j < 3; ++j) {
+            EXPECT_NEAR(AX(i, j), AX_mat(i, j), 1e-4);
+        }
+    }
+
+    // the Laplacian of a constant is zero
+    B.reset(T(1), DEVICE);
+    lap->apply(B, AX);
+    AX.move(DEVICE, HOST);
+    for (uint32_t i = 0; i < num_vertices; ++i) {
+        EXPECT_NEAR(AX(i, 0), 0, 1e-4);
+    }
+
+    // solve (M + L) X = B matrix-free
+    B.fill_random();
+    B.move(HOST, DEVICE);
+    X.reset(0, DEVICE);
+
+    CGMatFreeSolver solver(num_vertices, 3, 5000, T(1e-7));
+    solver.m_mat_vec = lap->mat_vec(T(1), T(1));
+    solver.pre_solve(B, X);
+    solver.solve(B, X);
+
+    lap->apply(X, AX, T(1), T(1));
+    AX.move(DEVICE, HOST);
+    for (uint32_t i = 0; i < num_vertices; ++i) {
+        for (int j = 0; j < 3; ++j) {
+            EXPECT_NEAR(AX(i, j), B(i, j), 1e-3);
+        }
+    }
+
+    // changing the coordinates rebuilds the operator: the cotan weights are
+    // scale invariant while the mass scales with the area
+    VertexAttribute<T> mass = lap->mass();
+    mass.move(DEVICE, HOST);
+    std::vector<T> mass_before;
+    rx.for_each_vertex(
+        HOST,
+        [&](const VertexHandle& vh) { mass_before.push_back(mass(vh)); },
+        NULL,
+        false);
+
+    scale_coordinates(rx, *coords, T(2));
+
+    EXPECT_EQ(get_laplacian_operator(rx, *coords), lap);
+    EXPECT_EQ(lap->num_builds(), 2);
+
+    mass = lap->mass();
+    mass.move(DEVICE, HOST);
+    uint32_t v = 0;
+    rx.for_each_vertex(
+        HOST,
+        [&](const VertexHandle& vh) {
+            EXPECT_NEAR(mass(vh), T(4) * mass_before[v], 1e-3 * mass_before[v]);
+            v++;
+        },
+        NULL,
+        false);
+
+    scale_coordinates(rx, *coords, T(0.5));
+
+    X.release();
+    B.release();
+    AX.release();
+    AX_mat.release();
+}
+
+TEST(Solver, DECOperator)
+{
+    RXMeshStatic rx(STRINGIFY(INPUT_DIR) "sphere3.obj");
+
+    using T = float;
+
+    const uint32_t num_vertices = rx.get_num_vertices();
+    const uint32_t num_edges    = rx.get_num_edges();
+    const uint32_t num_faces    = rx.get_num_faces();
+
+    auto coords = rx.get_input_vertex_coordinates();
+
+    auto dec = get_dec_operator(rx, *coords);
+    EXPECT_EQ(dec->num_builds(), 1);
+    EXPECT_EQ(get_dec_operator(rx, *coords), dec);
+
+    DenseMatrix<T> X(rx, num_vertices, 2);
+    DenseMatrix<T> LX(rx, num_vertices, 2);
+    DenseMatrix<T> LX_lap(rx, num_vertices, 2);
+    DenseMatrix<T> E0(rx, num_edges, 2);
+    DenseMatrix<T> E1(rx, num_edges, 2);
+    DenseMatrix<T> F0(rx, num_faces, 2);
+    DenseMatrix<T> F1(rx, num_faces, 2);
+
+    X.fill_random();
+    X.move(HOST, DEVICE);
+
+    // d1 * d0 = 0
+    dec->d0(X, E0);
+    dec->d1(E0, F0);
+    F0.move(DEVICE, HOST);
+    for (uint32_t i = 0; i < num_faces; ++i) {
+        for (int j = 0; j < 2; ++j) {
+            EXPECT_NEAR(F0(i, j), 0, 1e-5);
+        }
+    }
+
+    // d0^T * star1 * d0 is the cotan Laplacian
+    dec->star1(E0, E1);
+    dec->d0_transpose(E1, LX);
+    get_laplacian_operator(rx, *coords)->apply(X, LX_lap);
+
+    LX.move(DEVICE, HOST);
+    LX_lap.move(DEVICE, HOST);
+    for (uint32_t i = 0; i < num_vertices; ++i) {
+        for (int j = 0; j < 2; ++j) {
+            EXPECT_NEAR(LX(i, j), LX_lap(i, j), 1e-4);
+        }
+    }
+
+    // the Hodge star and its inverse cancel out
+    dec->star0(X, LX);
+    dec->star0(LX, LX_lap, true);
+    LX_lap.move(DEVICE, HOST);
+    for (uint32_t i = 0; i < num_vertices; ++i) {
+        for (int j = 0; j < 2; ++j) {
+            EXPECT_NEAR(LX_lap(i, j), X(i, j), 1e-4);
+        }
+    }
+
+    // the matrix-free operators match the assembled ones
+    dec->d0_matrix().multiply(X, E1);
+    E0.move(DEVICE, HOST);
+    E1.move(DEVICE, HOST);
+    for (uint32_t i = 0; i < num_edges; ++i) {
+        for (int j = 0; j < 2; ++j) {
+            EXPECT_NEAR(E0(i, j), E1(i, j), 1e-5);
+        }
+    }
+
+    E0.fill_random();
+    E0.move(HOST, DEVICE);
+    dec->d1(E0, F0);
+    dec->d1_matrix().multiply(E0, F1);
+    F0.move(DEVICE, HOST);
+    F1.move(DEVICE, HOST);
+    for (uint32_t i = 0; i < num_faces; ++i) {
+        for (int j = 0; j < 2; ++j) {
+            EXPECT_NEAR(F0(i, j), F1(i, j), 1e-5);
+        }
+    }
+
+    // d1^T is the adjoint of d1 i.e., <d1 e, f> = <e, d1^T f>
+    F1.fill_random();
+    F1.move(HOST, DEVICE);
+    dec->d1_transpose(F1, E1);
+    E1.move(DEVICE, HOST);
+    double lhs = 0, rhs = 0;
+    for (uint32_t i = 0; i < num_faces; ++i) {
+        for (int j = 0; j < 2; ++j) {
+            lhs += F0(i, j) * F1(i, j);
+        }
+    }
+    for (uint32_t i = 0; i < num_edges; ++i) {
+        for (int j = 0; j < 2; ++j) {
+            rhs += E0(i, j) * E1(i, j);
+        }
+    }
+    EXPECT_NEAR(lhs, rhs, 1e-3 * std::abs(lhs) + 1e-3);
+
+    X.release();
+    LX.release();
+    LX_lap.release();
+    E0.release();
+    E1.release();
+    F0.release();
+    F1.release();
+}
+
+TEST(Solver, TutteEmbedding)
+{
+    RXMeshStatic rx(STRINGIFY(INPUT_DIR) "bunnyhead.obj");
+
+    using T = float;
+
+    auto coords = *rx.get_input_vertex_coordinates();
+
+    auto uv       = *rx.add_vertex_attribute<T>("uv", 2);
+    auto uv_warm  = *rx.add_vertex_attribute<T>("uvWarm", 2);
+    auto v_fixed  = *rx.add_vertex_attribute<bool>("vFixed", 1);
+    auto residual = *rx.add_vertex_attribute<T>("residual", 2);
+
+    // direct solve
+    {
+        TutteEmbedding<T> tutte(rx);
+        tutte.embed(coords, uv);
+
+        EXPECT_EQ(tutte.num_charts(), 1);
+
+        v_fixed.copy_from(tutte.fixed_vertices(), HOST, HOST);
+        v_fixed.copy_from(tutte.fixed_vertices(), DEVICE, DEVICE);
+    }
+
+    // every interior vertex is the average of its neighbors and the boundary
+    // is on the unit circle
+    rx.run_query_kernel<Op::VV, 256>(
+        [uv, v_fixed, residual] __device__(const VertexHandle&   vh,
+                                           const VertexIterator& iter) mutable {
+            for (int i = 0; i < 2; ++i) {
+                T sum = 0;
+                for (uint16_t j = 0; j < iter.size(); ++j) {
+                    sum += uv(iter[j], i) - uv(vh, i);
+                }
+                residual(vh, i) = v_fixed(vh) ? T(0) : sum / iter.size();
+            }
+        });
+    residual.move(DEVICE, HOST);
+
+    uint32_t num_fixed = 0;
+    rx.for_each_vertex(HOST, [&](const VertexHandle& vh) {
+        EXPECT_NEAR(residual(vh, 0), 0, 1e-4);
+        EXPECT_NEAR(residual(vh, 1), 0, 1e-4);
+        if (v_fixed(vh)) {
+            num_fixed++;
+            EXPECT_NEAR(uv(vh, 0) * uv(vh, 0) + uv(vh, 1) * uv(vh, 1), 1, 1e-4);
+        }
+    });
+    EXPECT_GT(num_fixed, 0);
+
+    // iterative solve which is then warm-started after slightly rotating the
+    // boundary such that the solution is the rotated embedding
+    {
+        TutteEmbedding<T> tutte(rx, TutteSolver::PCG, 5000, T(1e-7));
+        tutte.map_boundary_to_circle(coords, uv_warm);
+        const int cold_iters = tutte.solve(uv_warm);
+
+        const T c = std::cos(T(0.05));
+        const T s = std::sin(T(0.05));
+
+        rx.for_each_vertex(HOST, [&](const VertexHandle& vh) {
+            EXPECT_NEAR(uv_warm(vh, 0), uv(vh, 0), 1e-3);
+            EXPECT_NEAR(uv_warm(vh, 1), uv(vh, 1), 1e-3);
+            if (v_fixed(vh)) {
+                const T x      = uv_warm(vh, 0);
+                const T y      = uv_warm(vh, 1);
+                uv_warm(vh, 0) = c * x - s * y;
+                uv_warm(vh, 1) = s * x + c * y;
+            }
+        });
+        uv_warm.move(HOST, DEVICE);
+
+        const int warm_iters = tutte.solve(uv_warm, true);
+
+        EXPECT_LT(warm_iters, cold_iters);
+
+        rx.for_each_vertex(HOST, [&](const VertexHandle& vh) {
+            EXPECT_NEAR(uv_warm(vh, 0), c * uv(vh, 0) - s * uv(vh, 1), 1e-3);
+            EXPECT_NEAR(uv_warm(vh, 1), s * uv(vh, 0) + c * uv(vh, 1), 1e-3);
+        });
+    }
+
+    rx.remove_attribute("uv");
+    rx.remove_attribute("uvWarm");
+    rx.remove_attribute("vFixed");
+    rx.remove_attribute("residual");
+}
+
+TEST(Solver, ShiftInvertEigen)
+{
+    RXMeshStatic rx(STRINGIFY(INPUT_DIR) "sphere3.obj");
+
+    uint32_t num_vertices = rx.get_num_vertices();
+
+    using T = float;
+
+    auto coords = rx.get_input_vertex_coordinates();
+    auto lap    = get_laplacian_operator(rx, *coords);
+
+    // (L + M) x = lambda M x whose smallest eigenvalue is 1 (the constant
+    // vector) followed by three (almost) equal eigenvalues on a sphere
+    SparseMatrix<T> A(rx);
+    SparseMatrix<T> B(rx);
+    lap->assemble(A, T(1), T(1));
+    lap->assemble(B, T(1), T(0));
+
+    CholeskySolver chol(&A);
+    chol.pre_solve(rx);
+
+    constexpr int num_eigs = 4;
+
+    ShiftInvertEigenSolver<T> solver(rx, num_eigs, T(0), 200, T(1e-6));
+    solver.use_cholesky(chol, &B);
+
+    DenseMatrix<T> X(rx, num_vertices, num_eigs);
+    DenseMatrix<T> AX(rx, num_vertices, num_eigs);
+    DenseMatrix<T> BX(rx, num_vertices, num_eigs);
+
+    std::vector<T> eig_vals;
+    EXPECT_TRUE(solver.solve(X, eig_vals));
+    ASSERT_EQ(eig_vals.size(), num_eigs);
+
+    EXPECT_NEAR(eig_vals[0], T(1), 1e-3);
+    for (int i = 1; i < num_eigs; ++i) {
+        EXPECT_GE(eig_vals[i], eig_vals[i - 1] - 1e-4);
+        EXPECT_NEAR(eig_vals[i], eig_vals[1], 0.05 * eig_vals[1]);
+    }
+
+    // residual
+    A.multiply(X, AX);
+    B.multiply(X, BX);
+    AX.move(DEVICE, HOST);
+    BX.move(DEVICE, HOST);
+
+    for (int j = 0; j < num_eigs; ++j) {
+        T max_ax = 0;
+        for (uint32_t i = 0; i < num_vertices; ++i) {
+            max_ax = std::max(max_ax, std::abs(AX(i, j)));
+        }
+        for (uint32_t i = 0; i < num_vertices; ++i) {
+            EXPECT_NEAR(AX(i, j), eig_vals[j] * BX(i, j), 1e-2 * max_ax);
+        }
+    }
+
+    A.release();
+    B.release();
+    X.release();
+    AX.release();
+    BX.release();
+}
+
+template <typename T, int K, uint32_t blockThreads>
+__global__ static void setup_block(const Context                 context,
+                                   const BlockSparseMatrix<T, K> A,
+                                   const T                       shift)
+{
+    using namespace rxmesh;
+
+    auto set = [&](VertexHandle& v_row, const VertexIterator& iter) {
+        // diagonally dominant SPD block matrix: diagonal blocks are
+        // symmetric with a small intra-block coupling, off-diagonal blocks
+        // are -I
+        for (int i = 0; i < K; ++i) {
+            for (int j = 0; j < K; ++j) {
+                A(v_row, v_row, i, j) =
+                    (i == j) ? T(iter.size()) + shift : T(0.5) / T(K);
+            }
+        }
+
+        for (uint32_t v = 0; v < iter.size(); ++v) {
+            for (int i = 0; i < K; ++i) {
+                for (int j = 0; j < K; ++j) {
+                    A(v_row, iter[v], i, j) = (i == j) ? T(-1) : T(0);
+                }
+            }
+        }
+    };
+
+    auto                block = cooperative_groups::this_thread_block();
+    Query<blockThreads> query(context);
+    ShmemAllocator      shrd_alloc;
+    query.dispatch<Op::VV>(block, shrd_alloc, set);
+}
+
+template <typename T, int K, typename SolverT>
+void test_block_iterative_solver(RXMeshStatic&            rx,
+                                 SolverT&                 solver,
+                                 BlockSparseMatrix<T, K>& A,
+                                 DenseMatrix<T>&          B,
+                                 DenseMatrix<T>&          X)
+{
+    rx.run_kernel<256>({Op::VV}, setup_block<T, K, 256>, A, T(1.5));
+
+    for (int i = 0; i < B.rows(); ++i) {
+        for (int j = 0; j < B.cols(); ++j) {
+            B(i, j) = T(1) + T((i * 7 + j * 3) % 11) / T(11);
+        }
+    }
+    B.move(HOST, DEVICE);
+    X.reset(0, DEVICE);
+
+    solver.pre_solve(B, X);
+
+    solver.solve(B, X);
+
+    RXMESH_INFO(" iter taken = {}, final_res = {}",
+                solver.iter_taken(),
+                solver.final_residual());
+
+    DenseMatrix<T> Ax(A.rows(), X.cols());
+
+    A.multiply(X, Ax);
+
+    Ax.move(DEVICE, HOST);
+
+    for (int i = 0; i < Ax.rows(); ++i) {
+        for (int j = 0; j < Ax.cols(); ++j) {
+            EXPECT_NEAR(Ax(i, j), B(i, j), 1e-3);
+        }
+    }
+
+    Ax.release();
+}
+
+TEST(Solver, BlockCG)
+{
+    RXMeshStatic rx(STRINGIFY(INPUT_DIR) "sphere3.obj");
+
+    using T = float;
+
+    BlockSparseMatrix<T, 3> A(rx);
+    DenseMatrix<T>          X(A.rows(), 2);
+    DenseMatrix<T>          B(A.rows(), 2);
+
+    CGSolver solver(A, 2, 5000, T(1e-7));
+
+    test_block_iterative_solver(rx, solver, A, B, X);
+
+    A.release();
+    X.release();
+    B.release();
+}
+
+TEST(Solver, BlockPCG)
+{
+    RXMeshStatic rx(STRINGIFY(INPUT_DIR) "sphere3.obj");
+
+    using T = float;
+
+    BlockSparseMatrix<T, 3> A(rx);
+    DenseMatrix<T>          X(A.rows(), 2);
+    DenseMatrix<T>          B(A.rows(), 2);
+
+    PCGSolver solver(A, 2, 5000, T(1e-7));
+
+    test_block_iterative_solver(rx, solver, A, B, X);
+
+    A.release();
+    X.release();
+    B.release();
+}
+
+#ifdef USE_CUDSS
+TEST(Solver, BlockcuDSSCholesky)
+{
+    RXMeshStatic rx(STRINGIFY(INPUT_DIR) "sphere3.obj");
+
+    using T = float;
+
+    BlockSparseMatrix<T, 3> A(rx);
+    DenseMatrix<T>          X(A.rows(), 1);
+    DenseMatrix<T>          B(A.rows(), 1);
+    DenseMatrix<T>          Ax(A.rows(), 1);
+
+    rx.run_kernel<256>({Op::VV}, setup_block<T, 3, 256>, A, T(1.5));
+
+    B.fill_random();
+    B.move(HOST, DEVICE);
+
+    A.update_csr();
+
+    cuDSSCholeskySolver solver(&A.get_csr());
+    solver.pre_solve(rx, B, X);
+    solver.solve(B, X);
+
+    A.multiply(X, Ax);
+    Ax.move(DEVICE, HOST);
+
+    for (int i = 0; i < Ax.rows(); ++i) {
+        EXPECT_NEAR(Ax(i, 0), B(i, 0), 1e-3);
+    }
+
+    A.release();
+    X.release();
+    B.release();
+    Ax.release();
+}
+#endif
@@ -1,10 +1,16 @@
 #include "gtest/gtest.h"
 
 #include "rxmesh/attribute.h"
+#include "rxmesh/diff/hessian_sparse_matrix.h"
+#include "rxmesh/matrix/block_sparse_matrix.h"
 #include "rxmesh/matrix/dense_matrix.h"
+#include "rxmesh/matrix/element_assembler.h"
 #include "rxmesh/matrix/sparse_matrix.h"
+#include "rxmesh/matrix/sparse_matrix_constant_nnz_row.h"
+#include "rxmesh/matrix/sparse_product.h"
 #include "rxmesh/query.cuh"
 #include "rxmesh/rxmesh_static.h"
+#include "rxmesh/util/timer.h"
 
 #include <Eigen/Sparse>
 
@@ -360,4 +366,468 @@ TEST(RXMeshStatic, SparseMatrixTranspose)
     mat.release();
     mat_trans.release();
     GPU_FREE(d_err_count);
-}
\ No newline at end of file
+}
+TEST(RXMeshStatic, SparseProduct)
+{
+    using namespace rxmesh;
+    using T = float;
+
+    std::mt19937                      gen(17);
+    std::uniform_real_distribution<T> value_dist(0.0, 1.0);
+
+    RXMeshStatic rx(STRINGIFY(INPUT_DIR) "sphere3.obj");
+
+    SparseMatrix<T> mat(rx);
+
+    auto randomize = [&]() {
+        for (int i = 0; i < mat.non_zeros(); ++i) {
+            mat.get_val_at(i) = value_dist(gen);
+        }
+        mat.move(HOST, DEVICE);
+    };
+    randomize();
+
+    SparseTranspose<T> trans(mat);
+    SpGEMM<T>          prod(mat, trans.matrix());
+
+    int* d_err_count(nullptr);
+    CUDA_ERROR(cudaMalloc((void**)&d_err_count, sizeof(int)));
+
+    auto check = [&]() {
+        // the transpose
+        CUDA_ERROR(cudaMemset(d_err_count, 0, sizeof(int)));
+        rx.run_kernel<256>({Op::V},
+                           test_transpose<256, T>,
+                           mat,
+                           trans.matrix(),
+                           d_err_count);
+        int h_err_count = 0;
+        CUDA_ERROR(cudaMemcpy(
+            &h_err_count, d_err_count, sizeof(int), cudaMemcpyDeviceToHost));
+        EXPECT_EQ(h_err_count, 0);
+
+        // the product against Eigen
+        SparseMatrix<T>& C = prod.matrix();
+        C.move(DEVICE, HOST);
+        CUDA_ERROR(cudaDeviceSynchronize());
+
+        using EigenT = Eigen::SparseMatrix<T, Eigen::RowMajor>;
+        EigenT A    = mat.to_eigen_copy();
+        EigenT AT   = A.transpose();
+        EigenT gold = A * AT;
+
+        EXPECT_EQ(C.rows(), gold.rows());
+        EXPECT_EQ(C.cols(), gold.cols());
+        EXPECT_EQ(C.non_zeros(), gold.nonZeros());
+        for (int r = 0; r < gold.outerSize(); ++r) {
+            for (EigenT::InnerIterator it(gold, r); it; ++it) {
+                EXPECT_NEAR(C(it.row(), it.col()), it.value(), 1e-4);
+            }
+        }
+    };
+
+    check();
+
+    // same sparsity pattern with new values: only the numeric phases run
+    randomize();
+    trans.update();
+    prod.multiply();
+    check();
+
+    prod.release();
+    trans.release();
+    mat.release();
+    GPU_FREE(d_err_count);
+}
+
+namespace {
+// compare the patch SpMV against cuSparse SpMV for a matrix with random values
+template <typename MatT>
+void check_patch_spmv(rxmesh::RXMeshStatic& rx, MatT& mat)
+{
+    using namespace rxmesh;
+    using T = typename MatT::Type;
+
+    std::mt19937                      gen(17);
+    std::uniform_real_distribution<T> value_dist(-1.0, 1.0);
+
+    for (int i = 0; i < mat.non_zeros(); ++i) {
+        mat.get_val_at(i) = value_dist(gen);
+    }
+    mat.move(HOST, DEVICE);
+
+    const int n = mat.rows();
+
+    std::vector<T> h_x(n);
+    for (auto& x : h_x) {
+        x = value_dist(gen);
+    }
+
+    T *d_x, *d_y, *d_y_ref;
+    CUDA_ERROR(cudaMalloc((void**)&d_x, n * sizeof(T)));
+    CUDA_ERROR(cudaMalloc((void**)&d_y, n * sizeof(T)));
+    CUDA_ERROR(cudaMalloc((void**)&d_y_ref, n * sizeof(T)));
+    CUDA_ERROR(
+        cudaMemcpy(d_x, h_x.data(), n * sizeof(T), cudaMemcpyHostToDevice));
+
+    mat.multiply(d_x, d_y_ref);
+
+    ASSERT_TRUE(mat.enable_patch_spmv(rx));
+    EXPECT_TRUE(mat.is_patch_spmv_enabled());
+
+    // multiply() dispatches to the patch SpMV
+    mat.multiply(d_x, d_y);
+
+    std::vector<T> h_y(n), h_y_ref(n);
+    CUDA_ERROR(
+        cudaMemcpy(h_y.data(), d_y, n * sizeof(T), cudaMemcpyDeviceToHost));
+    CUDA_ERROR(cudaMemcpy(
+        h_y_ref.data(), d_y_ref, n * sizeof(T), cudaMemcpyDeviceToHost));
+    for (int i = 0; i < n; ++i) {
+        EXPECT_NEAR(h_y[i], h_y_ref[i], 1e-4);
+    }
+
+    // y = 2*A*x - y
+    mat.multiply_patch(d_x, d_y, T(2), T(-1));
+    CUDA_ERROR(
+        cudaMemcpy(h_y.data(), d_y, n * sizeof(T), cudaMemcpyDeviceToHost));
+    for (int i = 0; i < n; ++i) {
+        EXPECT_NEAR(h_y[i], h_y_ref[i], 1e-4);
+    }
+
+    mat.disable_patch_spmv();
+    EXPECT_FALSE(mat.is_patch_spmv_enabled());
+
+    GPU_FREE(d_x);
+    GPU_FREE(d_y);
+    GPU_FREE(d_y_ref);
+}
+}  // namespace
+
+TEST(RXMeshStatic, SparseMatrixPatchSpMV)
+{
+    using namespace rxmesh;
+
+    RXMeshStatic rx(STRINGIFY(INPUT_DIR) "sphere3.obj");
+
+    SparseMatrix<float> mat(rx);
+    check_patch_spmv(rx, mat);
+    mat.release();
+
+    HessianSparseMatrix<float, 3> hess(rx, 0);
+    check_patch_spmv(rx, hess);
+    hess.release();
+
+    // only VV matrices are supported
+    SparseMatrix<float> ef(rx, Op::EF);
+    EXPECT_FALSE(ef.enable_patch_spmv(rx));
+    ef.release();
+}
+
+TEST(RXMeshStatic, DISABLED_BenchmarkPatchSpMV)
+{
+    using namespace rxmesh;
+    using T = float;
+
+    const int num_run = 100;
+
+    for (const char* name : {"sphere3.obj",
+                             "bunnyhead.obj",
+                             "dragon.obj",
+                             "giraffe.obj",
+                             "torus.obj",
+                             "bumpy-cube.obj"}) {
+        RXMeshStatic rx(std::string(STRINGIFY(INPUT_DIR)) + name);
+
+        SparseMatrix<T> mat(rx);
+        mat.reset(1.f, LOCATION_ALL);
+
+        const int n = mat.rows();
+
+        T *d_x, *d_y;
+        CUDA_ERROR(cudaMalloc((void**)&d_x, n * sizeof(T)));
+        CUDA_ERROR(cudaMalloc((void**)&d_y, n * sizeof(T)));
+        CUDA_ERROR(cudaMemset(d_x, 0, n * sizeof(T)));
+
+        // warm up and buffer allocation
+        mat.multiply(d_x, d_y);
+
+        GPUTimer cusparse_timer;
+        cusparse_timer.start();
+        for (int r = 0; r < num_run; ++r) {
+            mat.multiply(d_x, d_y);
+        }
+        cusparse_timer.stop();
+
+        ASSERT_TRUE(mat.enable_patch_spmv(rx));
+        mat.multiply_patch(d_x, d_y);
+
+        GPUTimer patch_timer;
+        patch_timer.start();
+        for (int r = 0; r < num_run; ++r) {
+            mat.multiply_patch(d_x, d_y);
+        }
+        patch_timer.stop();
+        CUDA_ERROR(cudaDeviceSynchronize());
+
+        RXMESH_INFO(
+            "{}: #V= {}, nnz= {}, cuSparse SpMV= {:.4f} ms, patch SpMV= "
+            "{:.4f} ms",
+            name,
+            rx.get_num_vertices(),
+            mat.non_zeros(),
+            cusparse_timer.elapsed_millis() / num_run,
+            patch_timer.elapsed_millis() / num_run);
+
+        GPU_FREE(d_x);
+        GPU_FREE(d_y);
+        mat.release();
+    }
+}
+
+TEST(RXMeshStatic, SparseMatrixSELL)
+{
+    using namespace rxmesh;
+
+    using T = float;
+
+    RXMeshStatic rx(STRINGIFY(INPUT_DIR) "sphere3.obj");
+
+    // the number of rows is not a multiple of the slice size
+    const int num_rows = rx.get_num_vertices();
+    const int num_cols = num_rows / 3 + 1;
+    ASSERT_NE(num_rows % SparseMatrixConstantNNZRow<T, 3>::sell_slice, 0);
+
+    SparseMatrixConstantNNZRow<T, 3> p(rx, num_rows, num_cols);
+
+    for (int i = 0; i < p.non_zeros(); ++i) {
+        p.col_idx()[i]  = rand() % num_cols;
+        p.get_val_at(i) = T(rand()) / T(RAND_MAX);
+    }
+    p.move_col_idx(HOST, DEVICE);
+    p.move(HOST, DEVICE);
+
+    p.enable_sell();
+    EXPECT_TRUE(p.is_sell_enabled());
+
+    DenseMatrix<T> x(num_cols, 3), y_sell(num_rows, 3), y_csr(num_rows, 3);
+    DenseMatrix<T> r(num_rows, 3), z_sell(num_cols, 3), z_csr(num_cols, 3);
+    x.fill_random();
+    x.move(HOST, DEVICE);
+    r.fill_random();
+    r.move(HOST, DEVICE);
+
+    auto compare = [](DenseMatrix<T>& a, DenseMatrix<T>& b) {
+        a.move(DEVICE, HOST);
+        b.move(DEVICE, HOST);
+        for (int i = 0; i < a.rows(); ++i) {
+            for (int j = 0; j < a.cols(); ++j) {
+                EXPECT_NEAR(a(i, j), b(i, j), 1e-4);
+            }
+        }
+    };
+
+    // prolongation-like y = P*x
+    p.multiply_sell(x, y_sell);
+    p.multiply(x, y_csr);
+    compare(y_sell, y_csr);
+
+    // accumulate y = 2*P*x + 3*y
+    p.multiply_sell(x, y_sell, false, T(2), T(3));
+    p.multiply(x, y_csr, false, false, T(2), T(3));
+    compare(y_sell, y_csr);
+
+    // restriction-like z = P^T*r
+    z_sell.reset(1, DEVICE);
+    z_csr.reset(1, DEVICE);
+    p.multiply_sell(r, z_sell, true, T(1), T(0.5));
+    p.multiply(r, z_csr, true, false, T(1), T(0.5));
+    compare(z_sell, z_csr);
+
+    x.release();
+    y_sell.release();
+    y_csr.release();
+    r.release();
+    z_sell.release();
+    z_csr.release();
+    p.release();
+    EXPECT_FALSE(p.is_sell_enabled());
+}
+
+TEST(RXMeshStatic, DISABLED_BenchmarkSELL)
+{
+    using namespace rxmesh;
+    using T = float;
+
+    const int num_run = 100;
+
+    for (const char* name :
+         {"sphere3.obj", "bunnyhead.obj", "dragon.obj", "giraffe.obj"}) {
+        RXMeshStatic rx(std::string(STRINGIFY(INPUT_DIR)) + name);
+
+        const int num_rows = rx.get_num_vertices();
+        const int num_cols = num_rows / 4 + 1;
+
+        SparseMatrixConstantNNZRow<T, 3> p(rx, num_rows, num_cols);
+        for (int i = 0; i < p.non_zeros(); ++i) {
+            p.col_idx()[i]  = rand() % num_cols;
+            p.get_val_at(i) = T(1);
+        }
+        p.move_col_idx(HOST, DEVICE);
+        p.move(HOST, DEVICE);
+
+        DenseMatrix<T> x(num_cols, 3), y(num_rows, 3);
+        x.reset(1, DEVICE);
+
+        // warm up and buffer allocation
+        p.multiply(x, y);
+
+        GPUTimer csr_timer;
+        csr_timer.start();
+        for (int r = 0; r < num_run; ++r) {
+            p.multiply(x, y);
+        }
+        csr_timer.stop();
+
+        p.enable_sell();
+        p.multiply_sell(x, y);
+
+        GPUTimer sell_timer;
+        sell_timer.start();
+        for (int r = 0; r < num_run; ++r) {
+            p.multiply_sell(x, y);
+        }
+        sell_timer.stop();
+        CUDA_ERROR(cudaDeviceSynchronize());
+
+        RXMESH_INFO("{}: rows= {}, cuSparse SpMM= {:.4f} ms, SELL= {:.4f} ms",
+                    name,
+                    num_rows,
+                    csr_timer.elapsed_millis() / num_run,
+                    sell_timer.elapsed_millis() / num_run);
+
+        x.release();
+        y.release();
+        p.release();
+    }
+}
+
+TEST(RXMeshStatic, SparseMatrixElementAssembly)
+{
+    // assemble a matrix from face blocks with the ElementAssembler and
+    // compare it against scattering the same blocks with atomics
+    using namespace rxmesh;
+
+    using T = float;
+
+    RXMeshStatic rx(STRINGIFY(INPUT_DIR) "sphere3.obj");
+
+    SparseMatrix<T> ref(rx);
+    SparseMatrix<T> mat(rx);
+    ref.reset(T(0), LOCATION_ALL);
+    mat.reset(T(1), LOCATION_ALL);
+
+    ElementAssembler<T, Op::FV> assembler(rx, mat);
+    EXPECT_EQ(assembler.num_elements(), rx.get_num_faces());
+
+    DenseMatrix<T> elem = assembler.create_element_values(rx);
+
+    rx.run_query_kernel<Op::FV, 256>(
+        [=] __device__(const FaceHandle& fh, const VertexIterator& fv) mutable {
+            for (int i = 0; i < 3; ++i) {
+                for (int j = 0; j < 3; ++j) {
+                    const T v = (i == j) ? T(2) : T(-1) * T(i + 2 * j);
+
+                    elem(fh, i * 3 + j) = v;
+                    ::atomicAdd(&ref(fv[i], fv[j]), v);
+                }
+            }
+        });
+
+    // the matrix is initialized to one so beta is tested as well
+    assembler.assemble(elem, mat, T(2), T(1));
+
+    // the map is reused across assemblies
+    assembler.assemble(elem, mat, T(1), T(0.5));
+
+    ref.move(DEVICE, HOST);
+    mat.move(DEVICE, HOST);
+
+    const T* h_ref = ref.val_ptr(HOST);
+    const T* h_mat = mat.val_ptr(HOST);
+    for (int i = 0; i < ref.non_zeros(); ++i) {
+        // (2 * ref + 1) * 0.5 + ref
+        EXPECT_NEAR(h_mat[i], T(2) * h_ref[i] + T(0.5), 1e-4);
+    }
+
+    elem.release();
+    assembler.release();
+    ref.release();
+    mat.release();
+}
+
+TEST(RXMeshStatic, BlockSparseMatrix)
+{
+    using namespace rxmesh;
+
+    using T = float;
+
+    RXMeshStatic rx(STRINGIFY(INPUT_DIR) "sphere3.obj");
+
+    BlockSparseMatrix<T, 3> bsr(rx);
+
+    EXPECT_EQ(bsr.rows(), 3 * rx.get_num_vertices());
+    EXPECT_EQ(bsr.non_zeros(), 9 * bsr.non_zero_blocks());
+
+    // non-symmetric random values so the transpose is tested as well
+    T* h_val = bsr.val_ptr(HOST);
+    for (int i = 0; i < bsr.non_zeros(); ++i) {
+        h_val[i] = T(rand()) / T(RAND_MAX) - T(0.5);
+    }
+    bsr.move(HOST, DEVICE);
+
+    SparseMatrix<T>& csr = bsr.get_csr();
+    EXPECT_EQ(csr.rows(), bsr.rows());
+    EXPECT_EQ(csr.non_zeros(), bsr.non_zeros());
+
+    DenseMatrix<T> B(bsr.rows(), 2);
+    DenseMatrix<T> C_bsr(bsr.rows(), 2);
+    DenseMatrix<T> C_csr(bsr.rows(), 2);
+    B.fill_random();
+    B.move(HOST, DEVICE);
+
+    auto compare = [&]() {
+        C_bsr.move(DEVICE, HOST);
+        C_csr.move(DEVICE, HOST);
+        for (int i = 0; i < C_bsr.rows(); ++i) {
+            for (int j = 0; j < C_bsr.cols(); ++j) {
+                EXPECT_NEAR(C_bsr(i, j), C_csr(i, j), 1e-4);
+            }
+        }
+    };
+
+    // dense matrix
+    bsr.multiply(B, C_bsr);
+    csr.multiply(B, C_csr);
+    compare();
+
+    // transpose
+    bsr.multiply(B, C_bsr, true);
+    csr.multiply(B, C_csr, true);
+    compare();
+
+    // vector with alpha and beta
+    C_bsr.reset(1, DEVICE);
+    C_csr.reset(1, DEVICE);
+    for (int j = 0; j < B.cols(); ++j) {
+        bsr.multiply(
+            B.col_data(j, DEVICE), C_bsr.col_data(j, DEVICE), false, 2, 3);
+    }
+    csr.multiply(B, C_csr, false, false, 2, 3);
+    compare();
+
+    B.release();
+    C_bsr.release();
+    C_csr.release();
+    bsr.release();
+}
@@ -1,5 +1,6 @@
 #include "gtest/gtest.h"
 
+#include "rxmesh/rxmesh_volume.h"
 #include "rxmesh/util/MshLoader.h"
 #include "rxmesh/util/macros.h"
 #include "rxmesh/util/log.h"
@@ -15,4 +16,184 @@ TEST(Util, Tet)
     RXMESH_INFO("#Nodes = {}", mshload.get_nodes().size());    
 
     //polyscope::registerTetMesh("my mesh", V, T);
-}
\ No newline at end of file
+}
+
+TEST(RXMeshVolume, Queries)
+{
+    using namespace rxmesh;
+
+    MshLoader mshload(STRINGIFY(INPUT_DIR) "car.msh");
+
+    std::vector<std::vector<uint32_t>> tets;
+    const auto& elements = mshload.get_elements();
+    size_t      offset   = 0;
+    for (size_t e = 0; e < mshload.get_elements_types().size(); ++e) {
+        const int len = mshload.get_elements_lengths()[e];
+        if (mshload.get_elements_types()[e] == MshLoader::ELEMENT_TET &&
+            len == 4) {
+            tets.push_back({uint32_t(elements[offset]),
+                            uint32_t(elements[offset + 1]),
+                            uint32_t(elements[offset + 2]),
+                            uint32_t(elements[offset + 3])});
+        }
+        offset += len;
+    }
+    ASSERT_GT(tets.size(), 0);
+
+    // small patches so the mesh has many patches and ribbons
+    RXMeshVolume vol(STRINGIFY(INPUT_DIR) "car.msh", 64);
+
+    ASSERT_EQ(vol.get_num_cells(), tets.size());
+    EXPECT_GT(vol.get_num_patches(), 1);
+
+    const uint32_t num_in_v = uint32_t(mshload.get_nodes().size() / 3);
+
+    // the reference vertex-cell incidence and one-ring size
+    std::vector<std::vector<uint32_t>> v_cells(num_in_v);
+    for (uint32_t c = 0; c < tets.size(); ++c) {
+        for (uint32_t v : tets[c]) {
+            v_cells[v].push_back(c);
+        }
+    }
+
+    // input ids as attributes
+    auto v_id = vol.add_vertex_attribute<uint32_t>();
+    auto c_id = vol.add_cell_attribute<uint32_t>();
+    for (uint32_t v = 0; v < num_in_v; ++v) {
+        if (!v_cells[v].empty()) {
+            (*v_id)(vol.get_vertex_handle(v)) = v;
+        }
+    }
+    for (uint32_t c = 0; c < tets.size(); ++c) {
+        (*c_id)(vol.get_cell_handle(c)) = c;
+    }
+    v_id->move(HOST, DEVICE);
+    c_id->move(HOST, DEVICE);
+
+    // shallow copies captured by the device lambdas
+    VolumeVertexAttribute<uint32_t> d_v_id = *v_id;
+    VolumeCellAttribute<uint32_t>   d_c_id = *c_id;
+
+    // for_each
+    uint32_t* d_count;
+    CUDA_ERROR(cudaMalloc((void**)&d_count, 2 * sizeof(uint32_t)));
+    CUDA_ERROR(cudaMemset(d_count, 0, 2 * sizeof(uint32_t)));
+    vol.for_each_vertex(DEVICE, [=] __device__(const VertexHandle& vh) {
+        ::atomicAdd(d_count, 1u);
+    });
+    vol.for_each_cell(DEVICE, [=] __device__(const CellHandle& ch) {
+        ::atomicAdd(d_count + 1, 1u);
+    });
+    uint32_t h_count[2];
+    CUDA_ERROR(cudaMemcpy(
+        h_count, d_count, 2 * sizeof(uint32_t), cudaMemcpyDeviceToHost));
+    GPU_FREE(d_count);
+    EXPECT_EQ(h_count[0], vol.get_num_vertices());
+    EXPECT_EQ(h_count[1], vol.get_num_cells());
+
+    // CV: the input vertices of every cell in order
+    auto                          cv   = vol.add_cell_attribute<uint32_t>(4);
+    VolumeCellAttribute<uint32_t> d_cv = *cv;
+    vol.run_query_kernel<VolumeOp::CV>(
+        [=] __device__(const CellHandle&                   ch,
+                       const VolumeIterator<VertexHandle>& iter) mutable {
+            for (uint16_t i = 0; i < iter.size(); ++i) {
+                d_cv(ch, i) = d_v_id(iter[i]);
+            }
+        });
+    cv->move(DEVICE, HOST);
+    for (uint32_t c = 0; c < tets.size(); ++c) {
+        for (uint32_t i = 0; i < 4; ++i) {
+            EXPECT_EQ((*cv)(vol.get_cell_handle(c), i), tets[c][i]);
+        }
+    }
+
+    // VV and VC: the size of the one-ring and the number of incident cells
+    // and that the incident cells are the ones in the input
+    auto vv_size = vol.add_vertex_attribute<uint32_t>();
+    auto vc_ok   = vol.add_vertex_attribute<uint32_t>(2);
+
+    VolumeVertexAttribute<uint32_t> d_vv_size = *vv_size;
+    VolumeVertexAttribute<uint32_t> d_vc_ok   = *vc_ok;
+    vol.run_query_kernel<VolumeOp::VV>(
+        [=] __device__(const VertexHandle&                 vh,
+                       const VolumeIterator<VertexHandle>& iter) mutable {
+            d_vv_size(vh) = iter.size();
+        });
+    vol.run_query_kernel<VolumeOp::VC>(
+        [=] __device__(const VertexHandle&               vh,
+                       const VolumeIterator<CellHandle>& iter) mutable {
+            uint32_t ok = 1;
+            for (uint16_t i = 0; i < iter.size(); ++i) {
+                const CellHandle ch = iter[i];
+                bool             in = false;
+                for (uint32_t j = 0; j < 4; ++j) {
+                    in = in || d_cv(ch, j) == d_v_id(vh);
+                }
+                ok = ok && in;
+            }
+            d_vc_ok(vh, 0) = iter.size();
+            d_vc_ok(vh, 1) = ok;
+        });
+    vv_size->move(DEVICE, HOST);
+    vc_ok->move(DEVICE, HOST);
+
+    for (uint32_t v = 0; v < num_in_v; ++v) {
+        if (v_cells[v].empty()) {
+            continue;
+        }
+        std::vector<uint32_t> ring;
+        for (uint32_t c : v_cells[v]) {
+            for (uint32_t u : tets[c]) {
+                if (u != v) {
+                    ring.push_back(u);
+                }
+            }
+        }
+        std::sort(ring.begin(), ring.end());
+        ring.erase(std::unique(ring.begin(), ring.end()), ring.end());
+
+        const VertexHandle vh = vol.get_vertex_handle(v);
+        EXPECT_EQ((*vv_size)(vh), ring.size());
+        EXPECT_EQ((*vc_ok)(vh, 0), v_cells[v].size());
+        EXPECT_EQ((*vc_ok)(vh, 1), 1);
+    }
+
+    // CC: the neighbor across the face opposite to the i-th vertex shares
+    // the other three vertices
+    auto                          cc   = vol.add_cell_attribute<uint32_t>(4);
+    VolumeCellAttribute<uint32_t> d_cc = *cc;
+    vol.run_query_kernel<VolumeOp::CC>(
+        [=] __device__(const CellHandle&                 ch,
+                       const VolumeIterator<CellHandle>& iter) mutable {
+            for (uint16_t i = 0; i < iter.size(); ++i) {
+                const CellHandle n = iter[i];
+                d_cc(ch, i)        = n.is_valid() ? d_c_id(n) : INVALID32;
+            }
+        });
+    cc->move(DEVICE, HOST);
+
+    uint32_t num_boundary = 0;
+    for (uint32_t c = 0; c < tets.size(); ++c) {
+        for (uint32_t i = 0; i < 4; ++i) {
+            const uint32_t n = (*cc)(vol.get_cell_handle(c), i);
+            if (n == INVALID32) {
+                num_boundary++;
+                continue;
+            }
+            ASSERT_LT(n, tets.size());
+            for (uint32_t j = 0; j < 4; ++j) {
+                if (j == i) {
+                    continue;
+                }
+                EXPECT_NE(
+                    std::find(tets[n].begin(), tets[n].end(), tets[c][j]),
+                    tets[n].end());
+            }
+        }
+    }
+    EXPECT_GT(num_boundary, 0);
+
+    CUDA_ERROR(cudaDeviceSynchronize());
+    CUDA_ERROR(cudaGetLastError());
+}
@@ -0,0 +1,89 @@
+#include "gtest/gtest.h"
+
+#include "rxmesh/rxmesh_static.h"
+
+template <rxmesh::Op op,
+          uint32_t   tileSize,
+          typename HandleT = typename rxmesh::InputHandle<op>::type>
+void tile_query_sum(rxmesh::RXMeshStatic&                 rx,
+                    rxmesh::Attribute<uint32_t, HandleT>& attr,
+                    bool                                  with_tiles)
+{
+    using namespace rxmesh;
+    using IteratorT = typename IteratorType<op>::type;
+
+    constexpr uint32_t blockThreads = 256;
+
+    auto a = attr;
+
+    // order-independent checksum of the query output since the tile-level
+    // queries do not preserve the order of the block-level ones (e.g., VV)
+    auto sum = [a] __device__(const HandleT& h, const IteratorT& iter) mutable {
+        uint32_t s = iter.size();
+        for (uint32_t i = 0; i < iter.size(); ++i) {
+            const uint32_t id = iter[i].patch_id() * 65536 + iter[i].local_id();
+            s += id * id;
+        }
+        a(h) = s;
+    };
+
+    LaunchBox<blockThreads> lb;
+    if (with_tiles) {
+        rx.prepare_tile_launch_box<tileSize>(
+            {op},
+            lb,
+            (void*)detail::
+                query_tile_kernel<blockThreads, tileSize, op, decltype(sum)>);
+        rx.run_query_tile_kernel<op, tileSize>(lb, sum);
+    } else {
+        rx.prepare_launch_box(
+            {op},
+            lb,
+            (void*)detail::query_kernel<blockThreads, op, decltype(sum)>);
+        rx.run_query_kernel<op>(lb, sum);
+    }
+}
+
+template <rxmesh::Op op, uint32_t tileSize>
+void check_tile_query(rxmesh::RXMeshStatic& rx)
+{
+    using namespace rxmesh;
+    using HandleT = typename InputHandle<op>::type;
+
+    auto gt   = rx.add_attribute<uint32_t, HandleT>("gt", 1);
+    auto tile = rx.add_attribute<uint32_t, HandleT>("tile", 1);
+
+    tile_query_sum<op, tileSize>(rx, *gt, false);
+    tile_query_sum<op, tileSize>(rx, *tile, true);
+
+    CUDA_ERROR(cudaDeviceSynchronize());
+
+    gt->move(DEVICE, HOST);
+    tile->move(DEVICE, HOST);
+
+    rx.for_each<HandleT>(HOST, [&](const HandleT h) {
+        EXPECT_EQ((*gt)(h), (*tile)(h));
+    });
+
+    rx.remove_attribute("gt");
+    rx.remove_attribute("tile");
+}
+
+TEST(RXMeshStatic, TileQueries)
+{
+    using namespace rxmesh;
+
+    // small patches so that many patches are processed by the same block
+    RXMeshStatic rx(STRINGIFY(INPUT_DIR) "sphere3.obj", "", false, 64);
+
+    check_tile_query<Op::VV, 32>(rx);
+    check_tile_query<Op::VE, 32>(rx);
+    check_tile_query<Op::VF, 32>(rx);
+    check_tile_query<Op::EV, 32>(rx);
+    check_tile_query<Op::EF, 16>(rx);
+    check_tile_query<Op::FV, 32>(rx);
+    check_tile_query<Op::FE, 32>(rx);
+    check_tile_query<Op::FF, 16>(rx);
+
+    ASSERT_EQ(cudaDeviceSynchronize(), cudaSuccess);
+}
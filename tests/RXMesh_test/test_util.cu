@@ -2,11 +2,15 @@
 
 #include <algorithm>
 
+#include "rxmesh/bitmask.cuh"
 #include "rxmesh/kernels/collective.cuh"
 #include "rxmesh/kernels/rxmesh_queries.cuh"
 #include "rxmesh/kernels/shmem_allocator.cuh"
+#include "rxmesh/kernels/shmem_plan.cuh"
 #include "rxmesh/kernels/util.cuh"
+#include "rxmesh/util/kernel_profiler.h"
 #include "rxmesh/util/macros.h"
+#include "rxmesh/util/timer.h"
 #include "rxmesh/util/util.h"
 
 template <uint32_t rowOffset, uint32_t blockThreads, uint32_t itemPerThread>
@@ -34,18 +38,23 @@ __global__ static void test_block_mat_transpose_kernel_shmem(
 
     ShmemAllocator shrd_alloc;
 
-    uint16_t* s_temp_size  = shrd_alloc.alloc<uint16_t>(num_cols + 1);
-    uint16_t* s_temp_local = shrd_alloc.alloc<uint16_t>(num_cols);
-
-    rxmesh::detail::block_mat_transpose<rowOffset, blockThreads>(num_rows,
-                                                                 num_cols,
-                                                                 d_src,
-                                                                 d_output,
-                                                                 s_temp_size,
-                                                                 s_temp_local,
-                                                                 d_row_bitmask,
-                                                                 d_col_bitmask,
-                                                                 0);
+    detail::TransposeShmemPlan temp_plan =
+        detail::transpose_shmem_plan(num_cols);
+    temp_plan.carve(shrd_alloc);
+
+    rxmesh::detail::block_mat_transpose<rowOffset, blockThreads>(
+        num_rows,
+        num_cols,
+        d_src,
+        d_output,
+        temp_plan.get<0>(),
+        temp_plan.get<1>(),
+        d_row_bitmask,
+        d_col_bitmask,
+        0);
+
+    temp_plan.release(shrd_alloc);
+    assert(shrd_alloc.get_allocated_size_bytes() == 0);
 }
 
 template <typename T, uint32_t blockThreads>
@@ -55,6 +64,72 @@ __global__ static void test_block_exclusive_sum_kernel(T*             d_src,
     rxmesh::detail::cub_block_exclusive_sum<T, blockThreads>(d_src, size);
 }
 
+template <uint32_t blockThreads>
+__global__ static void test_block_collectives_kernel(const uint32_t  size,
+                                                     const uint32_t* d_in,
+                                                     const uint32_t* d_offset,
+                                                     const uint32_t  num_seg,
+                                                     uint32_t*       d_scan,
+                                                     uint32_t*       d_compact,
+                                                     uint32_t*       d_result)
+{
+    using namespace rxmesh;
+    auto           block = cooperative_groups::this_thread_block();
+    ShmemAllocator shrd_alloc;
+
+    const uint32_t sum =
+        block_sum<blockThreads>(block, shrd_alloc, uint32_t(threadIdx.x));
+    const uint32_t max = block_reduce<blockThreads>(
+        block, shrd_alloc, uint32_t(threadIdx.x), cub::Max());
+
+    uint32_t* s_data = shrd_alloc.alloc<uint32_t>(size);
+    for (uint32_t i = threadIdx.x; i < size; i += blockThreads) {
+        s_data[i] = d_in[i];
+    }
+    block.sync();
+    block_segmented_exclusive_sum<blockThreads>(
+        block, shrd_alloc, s_data, d_offset, num_seg);
+    for (uint32_t i = threadIdx.x; i < size; i += blockThreads) {
+        d_scan[i] = s_data[i];
+    }
+
+    const uint32_t num_odd = block_compact<blockThreads>(
+        block,
+        shrd_alloc,
+        size,
+        [&](uint32_t i) { return d_in[i] % 2 == 1; },
+        [&](uint32_t i) { return i; },
+        d_compact);
+
+    __shared__ uint32_t s_num_inserted, s_contains;
+    if (threadIdx.x == 0) {
+        s_num_inserted = 0;
+        s_contains     = 1;
+    }
+    BlockHashSet set(shrd_alloc, 2 * size);
+    set.clear(block);
+    for (uint32_t i = threadIdx.x; i < size; i += blockThreads) {
+        if (set.insert(d_in[i])) {
+            ::atomicAdd(&s_num_inserted, 1u);
+        }
+    }
+    block.sync();
+    for (uint32_t i = threadIdx.x; i < size; i += blockThreads) {
+        if (!set.contains(d_in[i]) || set.contains(d_in[i] + size)) {
+            s_contains = 0;
+        }
+    }
+    block.sync();
+
+    if (threadIdx.x == 0) {
+        d_result[0] = sum;
+        d_result[1] = max;
+        d_result[2] = num_odd;
+        d_result[3] = s_num_inserted;
+        d_result[4] = s_contains;
+    }
+}
+
 template <typename T>
 __global__ static void test_atomicMin_kernel(T* d_in, T* d_out)
 {
@@ -75,6 +150,61 @@ __global__ static void test_atomicAdd_kernel(T* d_val)
     }*/
 }
 
+template <uint32_t blockThreads>
+__global__ static void test_bitmask_kernel(const uint16_t size,
+                                           uint32_t*      d_union,
+                                           uint32_t*      d_intersect,
+                                           uint32_t*      d_difference,
+                                           uint32_t*      d_result)
+{
+    using namespace rxmesh;
+    auto           block = cooperative_groups::this_thread_block();
+    ShmemAllocator shrd_alloc;
+
+    Bitmask a(size, shrd_alloc), b(size, shrd_alloc), c(size, shrd_alloc);
+
+    // a has multiples of 3 and b has multiples of 5
+    a.ballot<blockThreads>(
+        size,
+        [](uint16_t i) { return i % 3 == 0; },
+        [&](uint16_t w, uint32_t word) { a.m_bitmask[w] = word; });
+    b.ballot<blockThreads>(
+        size,
+        [](uint16_t i) { return i % 5 == 0; },
+        [&](uint16_t w, uint32_t word) { b.m_bitmask[w] = word; });
+    block.sync();
+
+    c.copy(block, a);
+    block.sync();
+    c.set_union(block, b);
+    block.sync();
+    c.store<blockThreads>(d_union);
+    block.sync();
+
+    c.copy(block, a);
+    block.sync();
+    c.set_intersect(block, b);
+    block.sync();
+    c.store<blockThreads>(d_intersect);
+    c.for_each_set(block, [&](uint16_t i) {
+        ::atomicAdd(d_result, 1u);
+        ::atomicAdd(d_result + 1, uint32_t(i));
+    });
+    block.sync();
+
+    c.copy(block, a);
+    block.sync();
+    c.set_difference(block, b);
+    block.sync();
+    c.store<blockThreads>(d_difference);
+
+    if (threadIdx.x == 0) {
+        d_result[2] = a.count();
+        d_result[3] = a.find_next_set(1);
+        d_result[4] = b.find_next_set(size - 1);
+    }
+}
+
 TEST(Util, Scan)
 {
     using namespace rxmesh;
@@ -103,6 +233,101 @@ TEST(Util, Scan)
     GPU_FREE(d_src);
 }
 
+TEST(Util, BlockCollectives)
+{
+    using namespace rxmesh;
+
+    constexpr uint32_t blockThreads = 256;
+    const uint32_t     size         = 1000;
+
+    std::vector<uint32_t> h_in(size);
+    for (uint32_t i = 0; i < size; ++i) {
+        h_in[i] = i % 97;
+    }
+
+    // segments of length 0, 1, ..., 6, 0, 1, ...
+    std::vector<uint32_t> h_offset(1, 0);
+    while (h_offset.back() < size) {
+        const uint32_t len = (h_offset.size() - 1) % 7;
+        h_offset.push_back(std::min(size, h_offset.back() + len));
+    }
+    const uint32_t num_seg = uint32_t(h_offset.size() - 1);
+
+    uint32_t *d_in, *d_offset, *d_scan, *d_compact, *d_result;
+    CUDA_ERROR(cudaMalloc((void**)&d_in, size * sizeof(uint32_t)));
+    CUDA_ERROR(
+        cudaMalloc((void**)&d_offset, h_offset.size() * sizeof(uint32_t)));
+    CUDA_ERROR(cudaMalloc((void**)&d_scan, size * sizeof(uint32_t)));
+    CUDA_ERROR(cudaMalloc((void**)&d_compact, size * sizeof(uint32_t)));
+    CUDA_ERROR(cudaMalloc((void**)&d_result, 5 * sizeof(uint32_t)));
+    CUDA_ERROR(cudaMemcpy(
+        d_in, h_in.data(), size * sizeof(uint32_t), cudaMemcpyHostToDevice));
+    CUDA_ERROR(cudaMemcpy(d_offset,
+                          h_offset.data(),
+                          h_offset.size() * sizeof(uint32_t),
+                          cudaMemcpyHostToDevice));
+
+    const uint32_t smem =
+        size * sizeof(uint32_t) + ShmemAllocator::default_alignment +
+        std::max(
+            {block_reduce_shmem_bytes<uint32_t, blockThreads>(),
+             block_segmented_exclusive_sum_shmem_bytes<uint32_t, blockThreads>(
+                 size),
+             block_compact_shmem_bytes<blockThreads>()}) +
+        BlockHashSet::shmem_bytes(2 * size);
+
+    test_block_collectives_kernel<blockThreads><<<1, blockThreads, smem>>>(
+        size, d_in, d_offset, num_seg, d_scan, d_compact, d_result);
+
+    CUDA_ERROR(cudaDeviceSynchronize());
+    CUDA_ERROR(cudaGetLastError());
+
+    std::vector<uint32_t> h_scan(size), h_compact(size), h_result(5);
+    CUDA_ERROR(cudaMemcpy(h_scan.data(),
+                          d_scan,
+                          size * sizeof(uint32_t),
+                          cudaMemcpyDeviceToHost));
+    CUDA_ERROR(cudaMemcpy(h_compact.data(),
+                          d_compact,
+                          size * sizeof(uint32_t),
+                          cudaMemcpyDeviceToHost));
+    CUDA_ERROR(cudaMemcpy(h_result.data(),
+                          d_result,
+                          5 * sizeof(uint32_t),
+                          cudaMemcpyDeviceToHost));
+
+    EXPECT_EQ(h_result[0], blockThreads * (blockThreads - 1) / 2);
+    EXPECT_EQ(h_result[1], blockThreads - 1);
+
+    for (uint32_t s = 0; s < num_seg; ++s) {
+        uint32_t sum = 0;
+        for (uint32_t i = h_offset[s]; i < h_offset[s + 1]; ++i) {
+            EXPECT_EQ(h_scan[i], sum);
+            sum += h_in[i];
+        }
+    }
+
+    std::vector<uint32_t> odd;
+    for (uint32_t i = 0; i < size; ++i) {
+        if (h_in[i] % 2 == 1) {
+            odd.push_back(i);
+        }
+    }
+    ASSERT_EQ(h_result[2], odd.size());
+    for (uint32_t i = 0; i < odd.size(); ++i) {
+        EXPECT_EQ(h_compact[i], odd[i]);
+    }
+
+    EXPECT_EQ(h_result[3], 97);
+    EXPECT_EQ(h_result[4], 1);
+
+    GPU_FREE(d_in);
+    GPU_FREE(d_offset);
+    GPU_FREE(d_scan);
+    GPU_FREE(d_compact);
+    GPU_FREE(d_result);
+}
+
 template <typename T>
 bool test_atomicAdd(const uint32_t threads = 1024)
 {
@@ -183,6 +408,91 @@ bool test_atomicMin(const uint32_t threads = 1024)
 
     return passed;
 }
+TEST(Util, Bitmask)
+{
+    using namespace rxmesh;
+
+    constexpr uint32_t blockThreads = 256;
+    const uint16_t     size         = 1000;
+    const uint32_t     num_words    = DIVIDE_UP(size, 32);
+
+    // host-side word operations
+    std::vector<uint32_t> h_a(num_words, 0), h_b(num_words, 0);
+    for (uint16_t i = 0; i < size; ++i) {
+        if (i % 3 == 0) {
+            detail::bitmask_set_bit(i, h_a.data());
+        }
+        if (i % 5 == 0) {
+            detail::bitmask_set_bit(i, h_b.data());
+        }
+    }
+    EXPECT_EQ(detail::popcount(0xF0F0F0F1u), 17u);
+    EXPECT_EQ(detail::first_set_bit(0x00010000u), 16u);
+    EXPECT_EQ(detail::count_set_bits(size, h_a.data()), 334);
+    EXPECT_EQ(detail::count_zero_bits(size, h_a.data()), 666);
+    EXPECT_EQ(detail::count_set_bits_and(size, h_a.data(), h_b.data()), 67);
+    EXPECT_EQ(detail::find_next_set_bit(size, h_a.data(), 1), 3);
+    EXPECT_EQ(detail::find_next_set_bit(size, h_b.data(), 996), INVALID16);
+
+    uint32_t *d_union, *d_intersect, *d_difference, *d_result;
+    CUDA_ERROR(cudaMalloc((void**)&d_union, num_words * sizeof(uint32_t)));
+    CUDA_ERROR(cudaMalloc((void**)&d_intersect, num_words * sizeof(uint32_t)));
+    CUDA_ERROR(
+        cudaMalloc((void**)&d_difference, num_words * sizeof(uint32_t)));
+    CUDA_ERROR(cudaMalloc((void**)&d_result, 5 * sizeof(uint32_t)));
+    CUDA_ERROR(cudaMemset(d_result, 0, 5 * sizeof(uint32_t)));
+
+    const uint32_t smem =
+        3 * (Bitmask::num_bytes(size) + ShmemAllocator::default_alignment);
+
+    test_bitmask_kernel<blockThreads><<<1, blockThreads, smem>>>(
+        size, d_union, d_intersect, d_difference, d_result);
+
+    CUDA_ERROR(cudaDeviceSynchronize());
+    CUDA_ERROR(cudaGetLastError());
+
+    std::vector<uint32_t> h_union(num_words), h_intersect(num_words),
+        h_difference(num_words), h_result(5);
+    CUDA_ERROR(cudaMemcpy(h_union.data(),
+                          d_union,
+                          num_words * sizeof(uint32_t),
+                          cudaMemcpyDeviceToHost));
+    CUDA_ERROR(cudaMemcpy(h_intersect.data(),
+                          d_intersect,
+                          num_words * sizeof(uint32_t),
+                          cudaMemcpyDeviceToHost));
+    CUDA_ERROR(cudaMemcpy(h_difference.data(),
+                          d_difference,
+                          num_words * sizeof(uint32_t),
+                          cudaMemcpyDeviceToHost));
+    CUDA_ERROR(cudaMemcpy(h_result.data(),
+                          d_result,
+                          5 * sizeof(uint32_t),
+                          cudaMemcpyDeviceToHost));
+
+    uint32_t num_15 = 0, sum_15 = 0;
+    for (uint16_t i = 0; i < size; ++i) {
+        const bool in_a = (i % 3 == 0), in_b = (i % 5 == 0);
+        EXPECT_EQ(detail::is_set_bit(i, h_union.data()), in_a || in_b);
+        EXPECT_EQ(detail::is_set_bit(i, h_intersect.data()), in_a && in_b);
+        EXPECT_EQ(detail::is_set_bit(i, h_difference.data()), in_a && !in_b);
+        if (in_a && in_b) {
+            num_15++;
+            sum_15 += i;
+        }
+    }
+    EXPECT_EQ(h_result[0], num_15);
+    EXPECT_EQ(h_result[1], sum_15);
+    EXPECT_EQ(h_result[2], 334u);
+    EXPECT_EQ(h_result[3], 3u);
+    EXPECT_EQ(h_result[4], uint32_t(INVALID16));
+
+    GPU_FREE(d_union);
+    GPU_FREE(d_intersect);
+    GPU_FREE(d_difference);
+    GPU_FREE(d_result);
+}
+
 TEST(Util, AtomicMin)
 {
     EXPECT_TRUE(test_atomicMin<uint16_t>()) << "uint16_t failed";
@@ -217,6 +527,71 @@ TEST(Util, Align)
     EXPECT_EQ(ptr_aligned, ptr_aligned_gt);
 }
 
+__global__ static void spin_kernel(long long int num_cycles)
+{
+    const long long int start = clock64();
+    while (clock64() - start < num_cycles) {
+    }
+}
+
+TEST(Util, DeferredGPUTimer)
+{
+    using namespace rxmesh;
+
+    // more start/stop pairs than the ring buffer capacity such that the
+    // oldest pairs are resolved while the newer ones are recorded
+    constexpr int num_pairs = 200;
+
+    Timers<GPUTimer>         timers;
+    Timers<DeferredGPUTimer> deferred;
+
+    timers.add("Spin");
+    deferred.add("Spin");
+
+    for (int i = 0; i < num_pairs; ++i) {
+        deferred.start("Spin");
+        timers.start("Spin");
+        spin_kernel<<<1, 1>>>(10000);
+        timers.stop("Spin");
+        deferred.stop("Spin");
+    }
+    CUDA_ERROR(cudaDeviceSynchronize());
+
+    const float gpu_time      = timers.elapsed_millis("Spin");
+    const float deferred_time = deferred.elapsed_millis("Spin");
+
+    EXPECT_GT(deferred_time, 0.f);
+    EXPECT_GE(deferred_time, 0.9f * gpu_time);
+
+    deferred.resolve();
+    EXPECT_EQ(deferred.m_total_time.at("Spin"), deferred_time);
+}
+
+TEST(Util, ShmemPlan)
+{
+    using namespace rxmesh;
+
+    using PaddedSegment = ShmemSegment<float, 32>;
+    EXPECT_EQ(PaddedSegment::index(31), 31u);
+    EXPECT_EQ(PaddedSegment::index(32), 33u);
+    EXPECT_EQ(PaddedSegment::bytes(64), 66u * sizeof(float));
+
+    // 5 uint16_t (10 bytes) followed by 3 uint64_t aligned to 8 bytes and 64
+    // padded floats
+    ShmemPlan<ShmemSegment<uint16_t>, ShmemSegment<uint64_t>, PaddedSegment>
+        plan(5, 3, 64);
+    EXPECT_EQ(plan.count<0>(), 5u);
+    EXPECT_EQ(plan.count<2>(), 64u);
+    EXPECT_EQ(plan.bytes(), 16u + 3u * 8u + 66u * 4u);
+    EXPECT_EQ(plan.reserved_bytes(),
+              plan.bytes() + ShmemAllocator::default_alignment);
+
+    detail::TransposeShmemPlan temp_plan = detail::transpose_shmem_plan(7);
+    EXPECT_EQ(temp_plan.bytes(),
+              8u * sizeof(detail::TransposeCounterT) +
+                  7u * sizeof(detail::TransposeCounterT));
+}
+
 TEST(Util, BlockMatrixTranspose)
 {
     constexpr uint32_t numRows   = 542;
@@ -282,8 +657,7 @@ TEST(Util, BlockMatrixTranspose)
     //     <<<blocks, threads, 0>>>(d_src, numRows, numCols, d_offset,
     //     d_bitmask);
 
-    const size_t shmem = 2 * (numCols + 1) * sizeof(uint16_t) +
-                         2 * ShmemAllocator::default_alignment;
+    const size_t shmem = detail::transpose_shmem_plan(numCols).bytes();
     test_block_mat_transpose_kernel_shmem<rowOffset, threads>
         <<<blocks, threads, shmem>>>(
             d_src, numRows, numCols, d_offset, d_bitmask, d_bitmask);
@@ -356,4 +730,47 @@ TEST(Util, BlockMatrixTranspose)
 
     EXPECT_TRUE(is_offset_okay);
     EXPECT_TRUE(is_value_okay);
-}
\ No newline at end of file
+}
+
+
+TEST(Util, Roofline)
+{
+    using namespace rxmesh;
+
+    // 1000 GB/s and 10000 GFLOP/s i.e., the ridge point is at 10 FLOP/B
+    const Roofline roof(1000, 10000);
+    EXPECT_DOUBLE_EQ(roof.ridge_point(), 10);
+    EXPECT_DOUBLE_EQ(roof.attainable_gflops(1), 1000);
+    EXPECT_DOUBLE_EQ(roof.attainable_gflops(100), 10000);
+
+    // 1 GB in 2 ms i.e., 500 GB/s
+    KernelProfile p;
+    p.total_ms = 2;
+    p.bytes    = size_t(1e9);
+
+    // no FLOPs
+    EXPECT_DOUBLE_EQ(p.bandwidth(), 500);
+    EXPECT_DOUBLE_EQ(roof.efficiency(p), 0.5);
+    EXPECT_EQ(roof.classify(p), KernelBound::Bandwidth);
+
+    // 1 FLOP/B (500 GFLOP/s) is left of the ridge point
+    p.flops = 1e9;
+    EXPECT_DOUBLE_EQ(p.arithmetic_intensity(), 1);
+    EXPECT_DOUBLE_EQ(p.gflops(), 500);
+    EXPECT_EQ(roof.classify(p), KernelBound::Bandwidth);
+
+    // 100 FLOP/B (50000 GFLOP/s is above the peak but the classification
+    // only looks at the side of the ridge point)
+    p.flops = 1e11;
+    EXPECT_EQ(roof.classify(p), KernelBound::Compute);
+
+    // 1 FLOP/B but 100x slower i.e., 5 GB/s
+    p.flops    = 1e9;
+    p.total_ms = 200;
+    EXPECT_EQ(roof.classify(p), KernelBound::Latency);
+
+    // without estimates
+    p.bytes = 0;
+    p.flops = 0;
+    EXPECT_EQ(roof.classify(p), KernelBound::Unknown);
+}